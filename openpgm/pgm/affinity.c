@@ -0,0 +1,511 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * CPU, scheduling and NUMA placement of internal threads.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#ifndef _GNU_SOURCE
+#	define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#	include <sched.h>
+#	include <pthread.h>
+#endif
+#ifdef __linux__
+#	include <unistd.h>
+#	include <sys/syscall.h>
+#endif
+#include <impl/i18n.h>
+#include <impl/framework.h>
+
+
+//#define AFFINITY_DEBUG
+
+/* Placement is recorded per class of thread and applied by each thread to
+ * itself as it starts, threads already running keep their placement.  The
+ * environment sets the initial placement at pgm_init():
+ *
+ *   PGM_THREAD_CPUS, PGM_THREAD_<CLASS>_CPUS	CPU list, e.g. "2-3,6"
+ *   PGM_THREAD_SCHED, PGM_THREAD_<CLASS>_SCHED	"other", "fifo:<priority>" or "rr:<priority>"
+ *   PGM_THREAD_NODE, PGM_THREAD_<CLASS>_NODE	NUMA node
+ *
+ * where CLASS is one of TIMER, FEC, HTTP, SNMP, SHMSTATS or IO, and the class
+ * variables take precedence.
+ */
+
+#define AFFINITY_WORD_BITS	(8 * sizeof (unsigned long))
+#define AFFINITY_MAX_NODES	1024
+
+#ifdef __linux__
+#	ifndef MPOL_PREFERRED
+#		define MPOL_PREFERRED	1
+#	endif
+#endif
+
+struct affinity_state_t {
+	bool			has_cpus;
+	unsigned long		cpus[ PGM_AFFINITY_MAX_CPUS / AFFINITY_WORD_BITS ];
+	int			sched;
+	int			priority;
+	int			node;
+};
+
+static volatile uint32_t	affinity_ref_count = 0;
+static pgm_mutex_t		affinity_mutex;
+static struct affinity_state_t	affinity[ PGM_THREAD_MAX ];
+
+static const char* const affinity_names[ PGM_THREAD_MAX ] = {
+	"TIMER",
+	"FEC",
+	"HTTP",
+	"SNMP",
+	"SHMSTATS",
+	"IO"
+};
+
+static bool affinity_parse_cpus (const char*restrict, unsigned long*restrict, unsigned*restrict);
+static bool affinity_parse (const pgm_affinity_t*restrict, struct affinity_state_t*restrict, pgm_error_t**restrict);
+static void affinity_reset (struct affinity_state_t*);
+static void affinity_from_env (const int);
+
+
+static
+void
+affinity_reset (
+	struct affinity_state_t*	state
+	)
+{
+	memset (state, 0, sizeof (struct affinity_state_t));
+	state->sched = PGM_SCHED_INHERIT;
+	state->node  = -1;
+}
+
+/* parse a comma separated list of CPUs and ranges into a mask, trailing white
+ * space is accepted as found in sysfs.
+ *
+ * returns TRUE on success with the highest CPU listed, returns FALSE if the
+ * list is empty, malformed or names a CPU beyond PGM_AFFINITY_MAX_CPUS.
+ */
+
+static
+bool
+affinity_parse_cpus (
+	const char*	restrict list,
+	unsigned long*	restrict mask,
+	unsigned*	restrict highest
+	)
+{
+	const char* p = list;
+	bool has_cpus = FALSE;
+
+	memset (mask, 0, (PGM_AFFINITY_MAX_CPUS / AFFINITY_WORD_BITS) * sizeof (unsigned long));
+	*highest = 0;
+	while ('\0' != *p && ' ' != *p && '\n' != *p)
+	{
+		char* end;
+		unsigned long first, last;
+
+		if (*p < '0' || *p > '9')
+			return FALSE;
+		first = last = strtoul (p, &end, 10);
+		p = end;
+		if ('-' == *p) {
+			p++;
+			if (*p < '0' || *p > '9')
+				return FALSE;
+			last = strtoul (p, &end, 10);
+			p = end;
+		}
+		if (last < first || last >= PGM_AFFINITY_MAX_CPUS)
+			return FALSE;
+		for (unsigned long cpu = first; cpu <= last; cpu++)
+			mask[ cpu / AFFINITY_WORD_BITS ] |= 1UL << (cpu % AFFINITY_WORD_BITS);
+		if (last > *highest)
+			*highest = (unsigned)last;
+		has_cpus = TRUE;
+		if (',' == *p) {
+			if (*++p < '0' || *p > '9')
+				return FALSE;
+		} else if ('\0' != *p && ' ' != *p && '\n' != *p)
+			return FALSE;
+	}
+	while (' ' == *p || '\n' == *p)
+		p++;
+	return has_cpus && '\0' == *p;
+}
+
+/* validate a placement request against the platform.
+ *
+ * on success, returns TRUE, on failure returns FALSE and sets error appropriately.
+ */
+
+static
+bool
+affinity_parse (
+	const pgm_affinity_t*		restrict attr,
+	struct affinity_state_t*	restrict state,
+	pgm_error_t**			restrict error
+	)
+{
+	affinity_reset (state);
+
+	if (NULL != attr->cpus)
+	{
+		unsigned highest;
+		if (!affinity_parse_cpus (attr->cpus, state->cpus, &highest)) {
+			pgm_set_error (error,
+				     PGM_ERROR_DOMAIN_ENGINE,
+				     PGM_ERROR_INVAL,
+				     _("Invalid CPU list \"%s\"."),
+				     attr->cpus);
+			return FALSE;
+		}
+#if defined( _WIN32 )
+		if (highest >= 8 * sizeof (DWORD_PTR)) {
+			pgm_set_error (error,
+				     PGM_ERROR_DOMAIN_ENGINE,
+				     PGM_ERROR_INVAL,
+				     _("CPU %u is outside the processor group."),
+				     highest);
+			return FALSE;
+		}
+#elif !defined( __linux__ )
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_ENGINE,
+			     PGM_ERROR_NOSYS,
+			     _("CPU affinity is not supported on this platform."));
+		return FALSE;
+#else
+		(void)highest;
+#endif
+		state->has_cpus = TRUE;
+	}
+
+	switch (attr->sched) {
+	case PGM_SCHED_INHERIT:
+	case PGM_SCHED_OTHER:
+		break;
+
+	case PGM_SCHED_FIFO:
+	case PGM_SCHED_RR:
+#ifndef _WIN32
+	{
+		const int policy = PGM_SCHED_FIFO == attr->sched ? SCHED_FIFO : SCHED_RR;
+		const int min_priority = sched_get_priority_min (policy);
+		const int max_priority = sched_get_priority_max (policy);
+		if (attr->priority < min_priority || attr->priority > max_priority) {
+			pgm_set_error (error,
+				     PGM_ERROR_DOMAIN_ENGINE,
+				     PGM_ERROR_INVAL,
+				     _("Priority %d outside of range %d-%d."),
+				     attr->priority, min_priority, max_priority);
+			return FALSE;
+		}
+	}
+#endif
+		state->priority = attr->priority;
+		break;
+
+	default:
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_ENGINE,
+			     PGM_ERROR_INVAL,
+			     _("Invalid scheduling class %d."),
+			     attr->sched);
+		return FALSE;
+	}
+	state->sched = attr->sched;
+
+	if (attr->node >= 0)
+	{
+#ifdef __linux__
+		if (attr->node >= AFFINITY_MAX_NODES) {
+			pgm_set_error (error,
+				     PGM_ERROR_DOMAIN_ENGINE,
+				     PGM_ERROR_INVAL,
+				     _("Invalid NUMA node %d."),
+				     attr->node);
+			return FALSE;
+		}
+		state->node = attr->node;
+#else
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_ENGINE,
+			     PGM_ERROR_NOSYS,
+			     _("NUMA placement is not supported on this platform."));
+		return FALSE;
+#endif
+	}
+	return TRUE;
+}
+
+/* class variable if present, otherwise the variable for all classes.
+ */
+
+static
+char*
+affinity_getenv (
+	const int		role,
+	const char*		suffix
+	)
+{
+	char name[64], *value;
+	size_t len;
+
+	pgm_snprintf_s (name, sizeof (name), _TRUNCATE, "PGM_THREAD_%s_%s", affinity_names[ role ], suffix);
+	if (0 == pgm_dupenv_s (&value, &len, name) && len > 0)
+		return value;
+	pgm_snprintf_s (name, sizeof (name), _TRUNCATE, "PGM_THREAD_%s", suffix);
+	if (0 == pgm_dupenv_s (&value, &len, name) && len > 0)
+		return value;
+	return NULL;
+}
+
+static
+void
+affinity_from_env (
+	const int		role
+	)
+{
+	char* cpus  = affinity_getenv (role, "CPUS");
+	char* sched = affinity_getenv (role, "SCHED");
+	char* node  = affinity_getenv (role, "NODE");
+	pgm_affinity_t attr;
+	pgm_error_t* error = NULL;
+
+	if (NULL == cpus && NULL == sched && NULL == node)
+		return;
+
+	attr.cpus	= cpus;
+	attr.sched	= PGM_SCHED_INHERIT;
+	attr.priority	= 0;
+	attr.node	= (NULL != node) ? atoi (node) : -1;
+	if (NULL != sched) {
+		const char* priority = strchr (sched, ':');
+		const size_t len = priority ? (size_t)(priority - sched) : strlen (sched);
+		if (5 == len && 0 == strncmp (sched, "other", len))
+			attr.sched = PGM_SCHED_OTHER;
+		else if (4 == len && 0 == strncmp (sched, "fifo", len))
+			attr.sched = PGM_SCHED_FIFO;
+		else if (2 == len && 0 == strncmp (sched, "rr", len))
+			attr.sched = PGM_SCHED_RR;
+		else
+			attr.sched = -1;
+		attr.priority = priority ? atoi (priority + 1) : 1;
+	}
+
+	if (!affinity_parse (&attr, &affinity[ role ], &error)) {
+		pgm_warn (_("Ignoring %s thread placement from environment: %s"),
+			affinity_names[ role ], error->message);
+		pgm_error_free (error);
+		affinity_reset (&affinity[ role ]);
+	}
+	if (cpus)  pgm_free (cpus);
+	if (sched) pgm_free (sched);
+	if (node)  pgm_free (node);
+}
+
+PGM_GNUC_INTERNAL
+void
+pgm_affinity_init (void)
+{
+	if (pgm_atomic_exchange_and_add32 (&affinity_ref_count, 1) > 0)
+		return;
+
+	pgm_mutex_init (&affinity_mutex);
+	for (int role = 0; role < PGM_THREAD_MAX; role++) {
+		affinity_reset (&affinity[ role ]);
+		affinity_from_env (role);
+	}
+}
+
+PGM_GNUC_INTERNAL
+void
+pgm_affinity_shutdown (void)
+{
+	pgm_return_if_fail (pgm_atomic_read32 (&affinity_ref_count) > 0);
+
+	if (pgm_atomic_exchange_and_add32 (&affinity_ref_count, (uint32_t)-1) != 1)
+		return;
+
+	pgm_mutex_free (&affinity_mutex);
+}
+
+/* set the placement of a class of thread created from now on, NULL restores
+ * the inherited placement.
+ *
+ * on success, returns TRUE, on failure returns FALSE and sets error appropriately.
+ */
+
+bool
+pgm_affinity_set (
+	int				role,
+	const pgm_affinity_t*		attr,
+	pgm_error_t**			error
+	)
+{
+	struct affinity_state_t state;
+
+	pgm_return_val_if_fail (pgm_atomic_read32 (&affinity_ref_count) > 0, FALSE);
+	pgm_return_val_if_fail (role >= 0 && role < PGM_THREAD_MAX, FALSE);
+
+	if (NULL == attr)
+		affinity_reset (&state);
+	else if (!affinity_parse (attr, &state, error))
+		return FALSE;
+
+	pgm_mutex_lock (&affinity_mutex);
+	affinity[ role ] = state;
+	pgm_mutex_unlock (&affinity_mutex);
+	return TRUE;
+}
+
+#ifdef __linux__
+/* processors local to a NUMA node from sysfs.
+ */
+
+static
+bool
+affinity_node_cpus (
+	const int		node,
+	unsigned long*		mask
+	)
+{
+	char path[64], list[4096];
+	unsigned highest;
+	FILE* fp;
+	bool has_cpus = FALSE;
+
+	pgm_snprintf_s (path, sizeof (path), _TRUNCATE, "/sys/devices/system/node/node%d/cpulist", node);
+	fp = fopen (path, "r");
+	if (NULL == fp)
+		return FALSE;
+	if (NULL != fgets (list, sizeof (list), fp))
+		has_cpus = affinity_parse_cpus (list, mask, &highest);
+	fclose (fp);
+	return has_cpus;
+}
+#endif /* __linux__ */
+
+/* apply the placement of a class to the calling thread, called first by every
+ * library thread.  failures are logged and the thread continues unplaced.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_affinity_apply (
+	const int		role
+	)
+{
+	struct affinity_state_t state;
+	char errbuf[1024];
+
+	pgm_assert (role >= 0 && role < PGM_THREAD_MAX);
+
+/* engine not started, e.g. unit tests */
+	if (0 == pgm_atomic_read32 (&affinity_ref_count))
+		return;
+
+	pgm_mutex_lock (&affinity_mutex);
+	state = affinity[ role ];
+	pgm_mutex_unlock (&affinity_mutex);
+
+	if (!state.has_cpus && PGM_SCHED_INHERIT == state.sched && -1 == state.node)
+		return;
+
+#ifdef __linux__
+	if (state.node >= 0)
+	{
+		unsigned long nodemask[ AFFINITY_MAX_NODES / AFFINITY_WORD_BITS ];
+		memset (nodemask, 0, sizeof (nodemask));
+		nodemask[ state.node / AFFINITY_WORD_BITS ] |= 1UL << (state.node % AFFINITY_WORD_BITS);
+		if (0 != syscall (SYS_set_mempolicy, MPOL_PREFERRED, nodemask, (unsigned long)AFFINITY_MAX_NODES + 1)) {
+			const int save_errno = errno;
+			pgm_warn (_("Failed to prefer NUMA node %d for %s thread: %s"),
+				state.node, affinity_names[ role ], pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		}
+		if (!state.has_cpus)
+			state.has_cpus = affinity_node_cpus (state.node, state.cpus);
+	}
+	if (state.has_cpus)
+	{
+		cpu_set_t cpu_set;
+		CPU_ZERO (&cpu_set);
+		for (unsigned cpu = 0; cpu < PGM_AFFINITY_MAX_CPUS && cpu < CPU_SETSIZE; cpu++)
+			if (state.cpus[ cpu / AFFINITY_WORD_BITS ] & (1UL << (cpu % AFFINITY_WORD_BITS)))
+				CPU_SET (cpu, &cpu_set);
+		const int err = pthread_setaffinity_np (pthread_self(), sizeof (cpu_set), &cpu_set);
+		if (0 != err)
+			pgm_warn (_("Failed to set CPU affinity of %s thread: %s"),
+				affinity_names[ role ], pgm_strerror_s (errbuf, sizeof (errbuf), err));
+	}
+#elif defined( _WIN32 )
+	if (state.has_cpus)
+	{
+		DWORD_PTR mask = 0;
+		for (unsigned cpu = 0; cpu < 8 * sizeof (DWORD_PTR); cpu++)
+			if (state.cpus[ cpu / AFFINITY_WORD_BITS ] & (1UL << (cpu % AFFINITY_WORD_BITS)))
+				mask |= (DWORD_PTR)1 << cpu;
+		if (0 == SetThreadAffinityMask (GetCurrentThread(), mask)) {
+			const int save_errno = GetLastError();
+			pgm_warn (_("Failed to set CPU affinity of %s thread: %s"),
+				affinity_names[ role ], pgm_win_strerror (errbuf, sizeof (errbuf), save_errno));
+		}
+	}
+#endif
+
+	if (PGM_SCHED_INHERIT != state.sched)
+	{
+#ifndef _WIN32
+		struct sched_param param;
+		int policy;
+		memset (&param, 0, sizeof (param));
+		switch (state.sched) {
+		case PGM_SCHED_FIFO:	policy = SCHED_FIFO; param.sched_priority = state.priority; break;
+		case PGM_SCHED_RR:	policy = SCHED_RR; param.sched_priority = state.priority; break;
+		default:		policy = SCHED_OTHER; break;
+		}
+		const int err = pthread_setschedparam (pthread_self(), policy, &param);
+		if (0 != err)
+			pgm_warn (_("Failed to set scheduling class of %s thread: %s"),
+				affinity_names[ role ], pgm_strerror_s (errbuf, sizeof (errbuf), err));
+#else
+		const int priority = PGM_SCHED_OTHER == state.sched ? THREAD_PRIORITY_NORMAL : THREAD_PRIORITY_TIME_CRITICAL;
+		if (!SetThreadPriority (GetCurrentThread(), priority)) {
+			const int save_errno = GetLastError();
+			pgm_warn (_("Failed to set priority of %s thread: %s"),
+				affinity_names[ role ], pgm_win_strerror (errbuf, sizeof (errbuf), save_errno));
+		}
+#endif
+	}
+
+#ifdef AFFINITY_DEBUG
+	pgm_debug ("Applied %s thread placement.", affinity_names[ role ]);
+#endif
+}
+
+/* eof */
@@ -0,0 +1,214 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * unit tests for internal thread placement.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <check.h>
+
+#define AFFINITY_DEBUG
+#include "affinity.c"
+
+#ifdef _WIN32
+#	define PGM_CHECK_NOFORK		1
+#endif
+
+
+/* target:
+ *	bool
+ *	affinity_parse_cpus (
+ *		const char*		list,
+ *		unsigned long*		mask,
+ *		unsigned*		highest
+ *	)
+ */
+
+START_TEST (test_parse_cpus_pass_001)
+{
+	unsigned long mask[ PGM_AFFINITY_MAX_CPUS / AFFINITY_WORD_BITS ];
+	unsigned highest;
+	fail_unless (TRUE == affinity_parse_cpus ("2-3,6", mask, &highest), "parse failed");
+	fail_unless (6 == highest, "highest mismatch");
+	fail_unless ((1UL << 2 | 1UL << 3 | 1UL << 6) == mask[0], "mask mismatch");
+/* sysfs format */
+	fail_unless (TRUE == affinity_parse_cpus ("0-1,70\n", mask, &highest), "parse failed");
+	fail_unless (70 == highest, "highest mismatch");
+	fail_unless (mask[ 70 / AFFINITY_WORD_BITS ] & (1UL << (70 % AFFINITY_WORD_BITS)), "cpu 70 missing");
+}
+END_TEST
+
+START_TEST (test_parse_cpus_fail_001)
+{
+	unsigned long mask[ PGM_AFFINITY_MAX_CPUS / AFFINITY_WORD_BITS ];
+	unsigned highest;
+	fail_unless (FALSE == affinity_parse_cpus ("", mask, &highest), "empty list accepted");
+	fail_unless (FALSE == affinity_parse_cpus ("3-1", mask, &highest), "reversed range accepted");
+	fail_unless (FALSE == affinity_parse_cpus ("1,", mask, &highest), "trailing comma accepted");
+	fail_unless (FALSE == affinity_parse_cpus ("a", mask, &highest), "garbage accepted");
+	fail_unless (FALSE == affinity_parse_cpus ("1024", mask, &highest), "cpu beyond maximum accepted");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_affinity_set (
+ *		int			role,
+ *		const pgm_affinity_t*	attr,
+ *		pgm_error_t**		error
+ *	)
+ */
+
+START_TEST (test_set_pass_001)
+{
+	const pgm_affinity_t attr = { "0", PGM_SCHED_OTHER, 0, -1 };
+	pgm_error_t* err = NULL;
+	pgm_affinity_init ();
+	fail_unless (TRUE == pgm_affinity_set (PGM_THREAD_HTTP, &attr, &err), "set failed");
+	fail_unless (NULL == err, "error set");
+	fail_unless (TRUE == affinity[ PGM_THREAD_HTTP ].has_cpus, "cpus not recorded");
+	fail_unless (PGM_SCHED_OTHER == affinity[ PGM_THREAD_HTTP ].sched, "sched not recorded");
+	fail_unless (FALSE == affinity[ PGM_THREAD_SNMP ].has_cpus, "other class changed");
+/* restore inherited placement */
+	fail_unless (TRUE == pgm_affinity_set (PGM_THREAD_HTTP, NULL, &err), "reset failed");
+	fail_unless (FALSE == affinity[ PGM_THREAD_HTTP ].has_cpus, "cpus not reset");
+	pgm_affinity_shutdown ();
+}
+END_TEST
+
+START_TEST (test_set_fail_001)
+{
+	const pgm_affinity_t bad_cpus  = { "0-", PGM_SCHED_INHERIT, 0, -1 };
+	const pgm_affinity_t bad_sched = { NULL, PGM_SCHED_RR + 1, 0, -1 };
+	pgm_error_t* err = NULL;
+	pgm_affinity_init ();
+	fail_unless (FALSE == pgm_affinity_set (PGM_THREAD_TIMER, &bad_cpus, &err), "set succeeded");
+	fail_if (NULL == err, "error not set");
+	pgm_error_free (err); err = NULL;
+	fail_unless (FALSE == pgm_affinity_set (PGM_THREAD_TIMER, &bad_sched, &err), "set succeeded");
+	fail_if (NULL == err, "error not set");
+	pgm_error_free (err);
+	fail_unless (FALSE == affinity[ PGM_THREAD_TIMER ].has_cpus, "failed set recorded");
+	pgm_affinity_shutdown ();
+}
+END_TEST
+
+START_TEST (test_set_fail_002)
+{
+	const pgm_affinity_t attr = { "0", PGM_SCHED_INHERIT, 0, -1 };
+	pgm_affinity_init ();
+	fail_unless (FALSE == pgm_affinity_set (PGM_THREAD_MAX, &attr, NULL), "set succeeded");
+	pgm_affinity_shutdown ();
+}
+END_TEST
+
+/* target:
+ *	void
+ *	pgm_affinity_apply (
+ *		const int		role
+ *	)
+ */
+
+#ifdef __linux__
+START_TEST (test_apply_pass_001)
+{
+	const pgm_affinity_t attr = { "0", PGM_SCHED_INHERIT, 0, -1 };
+	cpu_set_t cpu_set;
+	pgm_affinity_init ();
+	fail_unless (TRUE == pgm_affinity_set (PGM_THREAD_FEC, &attr, NULL), "set failed");
+	pgm_affinity_apply (PGM_THREAD_FEC);
+	fail_unless (0 == pthread_getaffinity_np (pthread_self(), sizeof (cpu_set), &cpu_set), "getaffinity failed");
+	fail_unless (1 == CPU_COUNT (&cpu_set), "not pinned to one cpu");
+	fail_unless (CPU_ISSET (0, &cpu_set), "not pinned to cpu 0");
+	pgm_affinity_shutdown ();
+}
+END_TEST
+#endif
+
+START_TEST (test_apply_pass_002)
+{
+/* environment placement */
+	g_setenv ("PGM_THREAD_CPUS", "0", TRUE);
+	g_setenv ("PGM_THREAD_SNMP_SCHED", "other", TRUE);
+	pgm_affinity_init ();
+	fail_unless (TRUE == affinity[ PGM_THREAD_HTTP ].has_cpus, "default not applied");
+	fail_unless (PGM_SCHED_INHERIT == affinity[ PGM_THREAD_HTTP ].sched, "class variable leaked");
+	fail_unless (PGM_SCHED_OTHER == affinity[ PGM_THREAD_SNMP ].sched, "class variable not applied");
+	pgm_affinity_apply (PGM_THREAD_SNMP);
+	pgm_affinity_shutdown ();
+	g_unsetenv ("PGM_THREAD_CPUS");
+	g_unsetenv ("PGM_THREAD_SNMP_SCHED");
+}
+END_TEST
+
+
+static
+Suite*
+make_test_suite (void)
+{
+	Suite* s;
+
+	s = suite_create (__FILE__);
+
+	TCase* tc_parse_cpus = tcase_create ("parse-cpus");
+	suite_add_tcase (s, tc_parse_cpus);
+	tcase_add_test (tc_parse_cpus, test_parse_cpus_pass_001);
+	tcase_add_test (tc_parse_cpus, test_parse_cpus_fail_001);
+
+	TCase* tc_set = tcase_create ("set");
+	suite_add_tcase (s, tc_set);
+	tcase_add_test (tc_set, test_set_pass_001);
+	tcase_add_test (tc_set, test_set_fail_001);
+	tcase_add_test (tc_set, test_set_fail_002);
+
+	TCase* tc_apply = tcase_create ("apply");
+	suite_add_tcase (s, tc_apply);
+#ifdef __linux__
+	tcase_add_test (tc_apply, test_apply_pass_001);
+#endif
+	tcase_add_test (tc_apply, test_apply_pass_002);
+	return s;
+}
+
+static
+Suite*
+make_master_suite (void)
+{
+	Suite* s = suite_create ("Master");
+	return s;
+}
+
+int
+main (void)
+{
+	pgm_messages_init();
+	SRunner* sr = srunner_create (make_master_suite ());
+	srunner_add_suite (sr, make_test_suite ());
+	srunner_run_all (sr, CK_ENV);
+	int number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	pgm_messages_shutdown();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof */
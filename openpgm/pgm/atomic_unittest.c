@@ -54,6 +54,25 @@ START_TEST (test_int32_exchange_and_add_pass_001)
 }
 END_TEST
 
+/* target:
+ *	uint32_t
+ *	pgm_atomic_exchange32 (
+ *		volatile uint32_t*	atomic,
+ *		const uint32_t		val
+ *	)
+ */
+
+START_TEST (test_int32_exchange_pass_001)
+{
+	volatile uint32_t atomic = 0;
+	fail_unless (0 == pgm_atomic_exchange32 (&atomic, 1), "xchg failed");
+	fail_unless (1 == atomic, "xchg failed");
+	fail_unless (1 == pgm_atomic_exchange32 (&atomic, 1), "xchg failed");
+	fail_unless (1 == pgm_atomic_exchange32 (&atomic, (uint32_t)-1), "xchg failed");
+	fail_unless ((uint32_t)-1 == atomic, "xchg failed");
+}
+END_TEST
+
 /* target:
  *	void
  *	pgm_atomic_add32 (
@@ -128,6 +147,10 @@ make_test_suite (void)
 	suite_add_tcase (s, tc_exchange_and_add);
 	tcase_add_test (tc_exchange_and_add, test_int32_exchange_and_add_pass_001);
 
+	TCase* tc_exchange = tcase_create ("exchange");
+	suite_add_tcase (s, tc_exchange);
+	tcase_add_test (tc_exchange, test_int32_exchange_pass_001);
+
 	TCase* tc_add = tcase_create ("add");
 	suite_add_tcase (s, tc_add);
 	tcase_add_test (tc_add, test_int32_add_pass_001);
@@ -0,0 +1,163 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * Memory budgets of window packet buffers: skbuff pools charge each socket's
+ * budget and through it the process budget, an exceeded budget applies
+ * back-pressure to the windows of the socket.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <impl/i18n.h>
+#include <impl/framework.h>
+
+
+//#define BUDGET_DEBUG
+
+#ifndef BUDGET_DEBUG
+#	define PGM_DISABLE_ASSERT
+#endif
+
+/* root of every socket budget */
+pgm_budget_t pgm_budget_process;
+
+PGM_GNUC_INTERNAL
+void
+pgm_budget_init (
+	pgm_budget_t* const restrict	budget,
+	pgm_budget_t* const restrict	parent		/* NULL = root */
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != budget);
+	pgm_assert (budget != parent);
+
+	budget->used   = 0;
+	budget->limit  = 0;
+	budget->parent = parent;
+}
+
+/* limits beyond the counter range are clamped, 0 = unlimited.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_budget_set_limit (
+	pgm_budget_t* const	budget,
+	const uint64_t		bytes
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != budget);
+
+	const uint64_t units = (bytes / PGM_BUDGET_UNIT) + (0 != bytes % PGM_BUDGET_UNIT);
+	budget->limit = (uint32_t)MIN(units, UINT32_MAX);
+}
+
+PGM_GNUC_INTERNAL
+uint64_t
+pgm_budget_limit (
+	const pgm_budget_t* const	budget
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != budget);
+
+	return (uint64_t)budget->limit * PGM_BUDGET_UNIT;
+}
+
+PGM_GNUC_INTERNAL
+uint64_t
+pgm_budget_used (
+	const pgm_budget_t* const	budget
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != budget);
+
+	return (uint64_t)pgm_atomic_read32 (&budget->used) * PGM_BUDGET_UNIT;
+}
+
+/* charge units to the budget and every parent, a charge is never refused: the
+ * owner of the budget applies back-pressure on pgm_budget_is_exceeded().
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_budget_charge (
+	pgm_budget_t*		budget,
+	const uint32_t		units
+	)
+{
+	for (; NULL != budget; budget = budget->parent)
+		pgm_atomic_add32 (&budget->used, units);
+}
+
+PGM_GNUC_INTERNAL
+void
+pgm_budget_uncharge (
+	pgm_budget_t*		budget,
+	const uint32_t		units
+	)
+{
+	for (; NULL != budget; budget = budget->parent) {
+		pgm_assert_cmpuint (pgm_atomic_read32 (&budget->used), >=, units);
+		pgm_atomic_add32 (&budget->used, (uint32_t)-units);
+	}
+}
+
+/* returns TRUE when the budget or any parent has reached its limit.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_budget_is_exceeded (
+	const pgm_budget_t*	budget
+	)
+{
+	for (; NULL != budget; budget = budget->parent)
+		if (budget->limit && pgm_atomic_read32 (&budget->used) >= budget->limit)
+			return TRUE;
+	return FALSE;
+}
+
+/* process-wide budget of window memory, shared by every socket.
+ */
+
+void
+pgm_mem_set_budget (
+	const uint64_t		bytes		/* 0 = unlimited */
+	)
+{
+	pgm_budget_set_limit (&pgm_budget_process, bytes);
+}
+
+uint64_t
+pgm_mem_get_budget (void)
+{
+	return pgm_budget_limit (&pgm_budget_process);
+}
+
+uint64_t
+pgm_mem_get_used (void)
+{
+	return pgm_budget_used (&pgm_budget_process);
+}
+
+/* eof */
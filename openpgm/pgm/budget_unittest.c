@@ -0,0 +1,196 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * unit tests for memory budgets.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <check.h>
+
+#define BUDGET_DEBUG
+#include "budget.c"
+
+#ifdef _WIN32
+#	define PGM_CHECK_NOFORK		1
+#endif
+
+
+/* target:
+ *	void
+ *	pgm_budget_charge (
+ *		pgm_budget_t*		budget,
+ *		const uint32_t		units
+ *	)
+ *
+ *	void
+ *	pgm_budget_uncharge (
+ *		pgm_budget_t*		budget,
+ *		const uint32_t		units
+ *	)
+ */
+
+/* charges reach every parent */
+START_TEST (test_charge_pass_001)
+{
+	pgm_budget_t root, budget;
+	pgm_budget_init (&root, NULL);
+	pgm_budget_init (&budget, &root);
+	pgm_budget_charge (&budget, 10);
+	pgm_budget_charge (&root, 5);
+	fail_unless (10 * PGM_BUDGET_UNIT == pgm_budget_used (&budget), "budget usage mismatch");
+	fail_unless (15 * PGM_BUDGET_UNIT == pgm_budget_used (&root), "root usage mismatch");
+	pgm_budget_uncharge (&budget, 10);
+	fail_unless (0 == pgm_budget_used (&budget), "budget not released");
+	fail_unless (5 * PGM_BUDGET_UNIT == pgm_budget_used (&root), "root not released");
+	pgm_budget_charge (NULL, 1);
+	pgm_budget_uncharge (NULL, 1);
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_budget_is_exceeded (
+ *		const pgm_budget_t*	budget
+ *	)
+ */
+
+/* a parent limit applies to the child */
+START_TEST (test_is_exceeded_pass_001)
+{
+	pgm_budget_t root, budget;
+	pgm_budget_init (&root, NULL);
+	pgm_budget_init (&budget, &root);
+	fail_unless (FALSE == pgm_budget_is_exceeded (NULL), "no budget exceeded");
+	pgm_budget_charge (&budget, 1000);
+	fail_unless (FALSE == pgm_budget_is_exceeded (&budget), "unlimited exceeded");
+	pgm_budget_set_limit (&root, 1000 * PGM_BUDGET_UNIT);
+	fail_unless (TRUE == pgm_budget_is_exceeded (&budget), "parent limit ignored");
+	pgm_budget_set_limit (&root, 0);
+	pgm_budget_set_limit (&budget, 1001 * PGM_BUDGET_UNIT);
+	fail_unless (FALSE == pgm_budget_is_exceeded (&budget), "below limit exceeded");
+	pgm_budget_charge (&budget, 1);
+	fail_unless (TRUE == pgm_budget_is_exceeded (&budget), "limit ignored");
+	fail_unless (FALSE == pgm_budget_is_exceeded (&root), "child limit applied to parent");
+}
+END_TEST
+
+/* target:
+ *	void
+ *	pgm_budget_set_limit (
+ *		pgm_budget_t*		budget,
+ *		const uint64_t		bytes
+ *	)
+ */
+
+/* limits round up to a unit and clamp to the counter range */
+START_TEST (test_set_limit_pass_001)
+{
+	pgm_budget_t budget;
+	pgm_budget_init (&budget, NULL);
+	pgm_budget_set_limit (&budget, 1);
+	fail_unless (PGM_BUDGET_UNIT == pgm_budget_limit (&budget), "limit not rounded");
+	pgm_budget_set_limit (&budget, UINT64_MAX);
+	fail_unless ((uint64_t)UINT32_MAX * PGM_BUDGET_UNIT == pgm_budget_limit (&budget), "limit not clamped");
+}
+END_TEST
+
+/* target:
+ *	void
+ *	pgm_skb_pool_set_budget (
+ *		pgm_skb_pool_t*		pool,
+ *		pgm_budget_t*		budget
+ *	)
+ */
+
+/* outstanding skbuffs are charged, destruction releases the remainder */
+START_TEST (test_skb_pool_pass_001)
+{
+	pgm_budget_t budget;
+	pgm_budget_init (&budget, NULL);
+	pgm_skb_pool_t* pool = pgm_skb_pool_new (1500, NULL);
+	struct pgm_sk_buff_t* skb[2];
+	skb[0] = pgm_skb_pool_alloc (pool, 1500);
+	pgm_skb_pool_set_budget (pool, &budget);
+	const uint64_t charge = (uint64_t)PGM_BUDGET_UNITS(pool->stride) * PGM_BUDGET_UNIT;
+	fail_unless (charge == pgm_budget_used (&budget), "outstanding not charged");
+	skb[1] = pgm_skb_pool_alloc (pool, 1500);
+	fail_unless (2 * charge == pgm_budget_used (&budget), "allocation not charged");
+	pgm_free_skb (skb[0]);
+	fail_unless (charge == pgm_budget_used (&budget), "release not uncharged");
+	pgm_skb_pool_destroy (pool);
+	fail_unless (0 == pgm_budget_used (&budget), "destroy not uncharged");
+	pgm_free_skb (skb[1]);
+	fail_unless (0 == pgm_budget_used (&budget), "released after destroy");
+}
+END_TEST
+
+
+static
+Suite*
+make_test_suite (void)
+{
+	Suite* s;
+
+	s = suite_create (__FILE__);
+
+	TCase* tc_charge = tcase_create ("charge");
+	suite_add_tcase (s, tc_charge);
+	tcase_add_test (tc_charge, test_charge_pass_001);
+
+	TCase* tc_is_exceeded = tcase_create ("is-exceeded");
+	suite_add_tcase (s, tc_is_exceeded);
+	tcase_add_test (tc_is_exceeded, test_is_exceeded_pass_001);
+
+	TCase* tc_set_limit = tcase_create ("set-limit");
+	suite_add_tcase (s, tc_set_limit);
+	tcase_add_test (tc_set_limit, test_set_limit_pass_001);
+
+	TCase* tc_skb_pool = tcase_create ("skb-pool");
+	suite_add_tcase (s, tc_skb_pool);
+	tcase_add_test (tc_skb_pool, test_skb_pool_pass_001);
+	return s;
+}
+
+static
+Suite*
+make_master_suite (void)
+{
+	Suite* s = suite_create ("Master");
+	return s;
+}
+
+int
+main (void)
+{
+	pgm_messages_init();
+	SRunner* sr = srunner_create (make_master_suite ());
+	srunner_add_suite (sr, make_test_suite ());
+	srunner_run_all (sr, CK_ENV);
+	int number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	pgm_messages_shutdown();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof */
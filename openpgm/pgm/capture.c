@@ -0,0 +1,955 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * pcapng packet capture ring and replay driver.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#	include <fcntl.h>
+#	include <time.h>
+#	include <unistd.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <sys/time.h>
+#endif
+#include <impl/i18n.h>
+#include <impl/framework.h>
+#include <impl/socket.h>
+
+
+//#define CAPTURE_DEBUG
+
+/* The ring file is a valid pcapng section at every instant: a section header and
+ * one LINKTYPE_RAW interface with nanosecond time stamps, then Enhanced Packet
+ * Blocks.  Datagrams without an IP header, UDP encapsulated and IPv6, are given a
+ * synthesised IP and UDP header so captures open in standard tools.  Once the
+ * file is full writing restarts after the interface block, the remainder of a
+ * partially overwritten block is covered with a local use padding block which
+ * readers skip.  Packet order is therefore recovered from epb_packetid.
+ */
+
+#define PCAPNG_SHB			0x0a0d0d0aU
+#define PCAPNG_IDB			0x00000001U
+#define PCAPNG_EPB			0x00000006U
+#define PCAPNG_BYTE_ORDER_MAGIC		0x1a2b3c4dU
+
+#define PCAPNG_LINKTYPE_ETHERNET	1
+#define PCAPNG_LINKTYPE_RAW		101
+
+#define PCAPNG_OPT_ENDOFOPT		0
+#define PCAPNG_OPT_SHB_USERAPPL		4
+#define PCAPNG_OPT_IF_TSRESOL		9
+#define PCAPNG_OPT_EPB_FLAGS		2
+#define PCAPNG_OPT_EPB_PACKETID		5
+
+#define PCAPNG_EPB_INBOUND		0x1
+#define PCAPNG_EPB_OUTBOUND		0x2
+#define PCAPNG_EPB_DIRECTION_MASK	0x3
+
+/* block type with the most significant bit set is reserved for local use */
+#define CAPTURE_PAD_BLOCK		0x80504144U
+#define CAPTURE_MIN_BLOCK		12
+/* EPB header, flags and packet id options, end of options and trailer */
+#define CAPTURE_EPB_OVERHEAD		56
+#define CAPTURE_MAX_HEADER		(sizeof(struct pgm_ip6_hdr) + sizeof(struct pgm_udphdr))
+#define CAPTURE_MAX_INTERFACES		16
+#define CAPTURE_USERAPPL		"OpenPGM"
+
+#define CAPTURE_ALIGN4(x)		(((x) + 3) & ~(size_t)3)
+
+struct pgm_capture_t {
+	pgm_spinlock_t		lock;		/* source and receiver contexts */
+	char*			base;
+	size_t			size;
+	size_t			ring;		/* offset of first packet block */
+	size_t			head;		/* offset of next packet block */
+	size_t			tail;		/* offset of oldest intact block */
+	uint64_t		packet_id;
+#ifdef _WIN32
+	HANDLE			file;
+	HANDLE			mapping;
+#endif
+};
+
+/* recorded inbound datagram to replay */
+struct capture_record_t {
+	uint64_t		key;		/* packet id or file order */
+	uint64_t		timestamp;	/* nanoseconds */
+	const char*		data;
+	uint32_t		len;
+	uint32_t		linktype;
+};
+
+struct capture_interface_t {
+	uint32_t		linktype;
+	uint8_t			tsresol;
+};
+
+
+static inline
+void
+capture_put16 (
+	char*		p,
+	const uint16_t	v
+	)
+{
+	memcpy (p, &v, sizeof(v));
+}
+
+static inline
+void
+capture_put32 (
+	char*		p,
+	const uint32_t	v
+	)
+{
+	memcpy (p, &v, sizeof(v));
+}
+
+static inline
+void
+capture_put64 (
+	char*		p,
+	const uint64_t	v
+	)
+{
+	memcpy (p, &v, sizeof(v));
+}
+
+static inline
+uint16_t
+capture_get16 (
+	const char*	p
+	)
+{
+	uint16_t v;
+	memcpy (&v, p, sizeof(v));
+	return v;
+}
+
+static inline
+uint32_t
+capture_get32 (
+	const char*	p
+	)
+{
+	uint32_t v;
+	memcpy (&v, p, sizeof(v));
+	return v;
+}
+
+static inline
+uint64_t
+capture_get64 (
+	const char*	p
+	)
+{
+	uint64_t v;
+	memcpy (&v, p, sizeof(v));
+	return v;
+}
+
+/* system clock in nanoseconds since the epoch.
+ */
+
+static
+uint64_t
+capture_now (void)
+{
+#if defined(_WIN32)
+	FILETIME ft;
+	GetSystemTimeAsFileTime (&ft);
+	const uint64_t intervals = ((uint64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+	return (intervals - UINT64_C(116444736000000000)) * 100;
+#elif defined(HAVE_CLOCK_GETTIME)
+	struct timespec ts;
+	clock_gettime (CLOCK_REALTIME, &ts);
+	return (uint64_t)ts.tv_sec * UINT64_C(1000000000) + (uint64_t)ts.tv_nsec;
+#else
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return (uint64_t)tv.tv_sec * UINT64_C(1000000000) + (uint64_t)tv.tv_usec * 1000;
+#endif
+}
+
+/* write the section header and interface blocks, returns bytes written.
+ */
+
+static
+size_t
+capture_write_header (
+	char*		p
+	)
+{
+	const size_t shb_len = 28 + 4 + CAPTURE_ALIGN4(sizeof(CAPTURE_USERAPPL) - 1) + 4 + 4;
+	capture_put32 (p +  0, PCAPNG_SHB);
+	capture_put32 (p +  4, (uint32_t)shb_len);
+	capture_put32 (p +  8, PCAPNG_BYTE_ORDER_MAGIC);
+	capture_put16 (p + 12, 1);				/* major version */
+	capture_put16 (p + 14, 0);				/* minor version */
+	capture_put64 (p + 16, UINT64_MAX);			/* section length unspecified */
+	capture_put16 (p + 24, PCAPNG_OPT_SHB_USERAPPL);
+	capture_put16 (p + 26, sizeof(CAPTURE_USERAPPL) - 1);
+	memset (p + 28, 0, CAPTURE_ALIGN4(sizeof(CAPTURE_USERAPPL) - 1));
+	memcpy (p + 28, CAPTURE_USERAPPL, sizeof(CAPTURE_USERAPPL) - 1);
+	capture_put32 (p + shb_len - 8, PCAPNG_OPT_ENDOFOPT);
+	capture_put32 (p + shb_len - 4, (uint32_t)shb_len);
+
+	char* idb = p + shb_len;
+	const size_t idb_len = 32;
+	capture_put32 (idb +  0, PCAPNG_IDB);
+	capture_put32 (idb +  4, (uint32_t)idb_len);
+	capture_put16 (idb +  8, PCAPNG_LINKTYPE_RAW);
+	capture_put16 (idb + 10, 0);
+	capture_put32 (idb + 12, 0);				/* no snap length */
+	capture_put16 (idb + 16, PCAPNG_OPT_IF_TSRESOL);
+	capture_put16 (idb + 18, 1);
+	capture_put32 (idb + 20, 0);
+	idb[20] = 9;						/* 10^-9 seconds */
+	capture_put32 (idb + 24, PCAPNG_OPT_ENDOFOPT);
+	capture_put32 (idb + 28, (uint32_t)idb_len);
+	return shb_len + idb_len;
+}
+
+/* cover len bytes at offset with a padding block.
+ */
+
+static inline
+void
+capture_pad (
+	struct pgm_capture_t*const	capture,
+	const size_t		offset,
+	const size_t		len
+	)
+{
+	pgm_assert (len >= CAPTURE_MIN_BLOCK);
+	char* p = capture->base + offset;
+	capture_put32 (p, CAPTURE_PAD_BLOCK);
+	capture_put32 (p + 4, (uint32_t)len);
+	capture_put32 (p + len - 4, (uint32_t)len);
+}
+
+/* create or truncate the ring file of size bytes and map it writable.
+ *
+ * returns new capture ring, or NULL on error and sets error appropriately.
+ */
+
+PGM_GNUC_INTERNAL
+struct pgm_capture_t*
+pgm_capture_new (
+	const char*   restrict	path,
+	size_t			size,
+	pgm_error_t** restrict	error
+	)
+{
+	struct pgm_capture_t* capture;
+	void* base;
+
+/* pre-conditions */
+	pgm_assert (NULL != path);
+
+	if (0 == size)
+		size = PGM_CAPTURE_DEFAULT_SIZE;
+	if (size < PGM_CAPTURE_MIN_SIZE)
+		size = PGM_CAPTURE_MIN_SIZE;
+	size &= ~(size_t)3;
+
+	capture = pgm_new0 (struct pgm_capture_t, 1);
+#ifndef _WIN32
+	const int fd = open (path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (-1 == fd) {
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_errno (save_errno),
+			     _("Opening capture file %s: %s"),
+			     path,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		goto err_free;
+	}
+	if (-1 == ftruncate (fd, size)) {
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_errno (save_errno),
+			     _("Sizing capture file %s: %s"),
+			     path,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		close (fd);
+		goto err_free;
+	}
+	base = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close (fd);
+	if (MAP_FAILED == base) {
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_errno (save_errno),
+			     _("Mapping capture file %s: %s"),
+			     path,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		goto err_free;
+	}
+#else
+	capture->file = CreateFileA (path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL,
+				     CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (INVALID_HANDLE_VALUE == capture->file) {
+		const DWORD save_errno = GetLastError();
+		char winstr[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_win_errno (save_errno),
+			     _("Opening capture file %s: %s"),
+			     path,
+			     pgm_win_strerror (winstr, sizeof (winstr), save_errno));
+		goto err_free;
+	}
+	capture->mapping = CreateFileMappingA (capture->file, NULL, PAGE_READWRITE,
+					       (DWORD)((uint64_t)size >> 32), (DWORD)size, NULL);
+	if (NULL == capture->mapping) {
+		const DWORD save_errno = GetLastError();
+		char winstr[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_win_errno (save_errno),
+			     _("Creating file mapping %s: %s"),
+			     path,
+			     pgm_win_strerror (winstr, sizeof (winstr), save_errno));
+		CloseHandle (capture->file);
+		goto err_free;
+	}
+	base = MapViewOfFile (capture->mapping, FILE_MAP_WRITE, 0, 0, size);
+	if (NULL == base) {
+		const DWORD save_errno = GetLastError();
+		char winstr[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_win_errno (save_errno),
+			     _("Mapping view of file %s: %s"),
+			     path,
+			     pgm_win_strerror (winstr, sizeof (winstr), save_errno));
+		CloseHandle (capture->mapping);
+		CloseHandle (capture->file);
+		goto err_free;
+	}
+#endif /* _WIN32 */
+
+	capture->base	= base;
+	capture->size	= size;
+	capture->ring	= capture_write_header (capture->base);
+	capture->head	= capture->ring;
+	capture->tail	= capture->size;
+	capture_pad (capture, capture->head, capture->size - capture->head);
+	pgm_spinlock_init (&capture->lock);
+	pgm_trace (PGM_LOG_ROLE_NETWORK,_("Capturing packets to %s in %" PRIzu " bytes."), path, size);
+	return capture;
+
+err_free:
+	pgm_free (capture);
+	return NULL;
+}
+
+PGM_GNUC_INTERNAL
+void
+pgm_capture_destroy (
+	struct pgm_capture_t*		capture
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != capture);
+
+	pgm_spinlock_free (&capture->lock);
+#ifndef _WIN32
+	munmap (capture->base, capture->size);
+#else
+	UnmapViewOfFile (capture->base);
+	CloseHandle (capture->mapping);
+	CloseHandle (capture->file);
+#endif
+	pgm_free (capture);
+}
+
+/* IP and UDP header for a datagram received or sent without one, UDP if either
+ * port is set.
+ *
+ * returns header length, or 0 for an unsupported address family.
+ */
+
+static
+size_t
+capture_synthesise (
+	char*		       restrict	header,
+	const size_t			len,
+	const struct sockaddr* restrict	src,
+	const struct sockaddr* restrict	dst,
+	const in_port_t			sport,
+	const in_port_t			dport
+	)
+{
+	const bool is_udp = (0 != sport || 0 != dport);
+	const size_t udp_len = is_udp ? sizeof(struct pgm_udphdr) : 0;
+	size_t ip_len;
+
+	if (AF_INET == dst->sa_family)
+	{
+		struct pgm_ip ip;
+		memset (&ip, 0, sizeof(ip));
+		ip.ip_v		= 4;
+		ip.ip_hl	= sizeof(struct pgm_ip) / 4;
+		ip.ip_len	= pgm_htons ((uint16_t)(sizeof(struct pgm_ip) + udp_len + len));
+		ip.ip_ttl	= 64;
+		ip.ip_p		= is_udp ? IPPROTO_UDP : IPPROTO_PGM;
+		if (NULL != src && AF_INET == src->sa_family)
+			ip.ip_src = ((const struct sockaddr_in*)src)->sin_addr;
+		ip.ip_dst	= ((const struct sockaddr_in*)dst)->sin_addr;
+		ip.ip_sum	= pgm_inet_checksum (&ip, sizeof(ip), 0);
+		memcpy (header, &ip, sizeof(ip));
+		ip_len = sizeof(ip);
+	}
+	else if (AF_INET6 == dst->sa_family)
+	{
+		struct pgm_ip6_hdr ip6;
+		memset (&ip6, 0, sizeof(ip6));
+		ip6.ip6_vfc	= pgm_htonl (UINT32_C(6) << 28);
+		ip6.ip6_plen	= pgm_htons ((uint16_t)(udp_len + len));
+		ip6.ip6_nxt	= is_udp ? IPPROTO_UDP : IPPROTO_PGM;
+		ip6.ip6_hops	= 64;
+		if (NULL != src && AF_INET6 == src->sa_family)
+			ip6.ip6_src = ((const struct sockaddr_in6*)src)->sin6_addr;
+		ip6.ip6_dst	= ((const struct sockaddr_in6*)dst)->sin6_addr;
+		memcpy (header, &ip6, sizeof(ip6));
+		ip_len = sizeof(ip6);
+	}
+	else
+		return 0;
+
+	if (is_udp) {
+/* checksum not calculated, zero is permitted for IPv4 */
+		struct pgm_udphdr udp;
+		udp.uh_sport	= sport;
+		udp.uh_dport	= dport;
+		udp.uh_ulen	= pgm_htons ((uint16_t)(udp_len + len));
+		udp.uh_sum	= 0;
+		memcpy (header + ip_len, &udp, sizeof(udp));
+	}
+	return ip_len + udp_len;
+}
+
+/* record one datagram, has_iphdr for raw IPv4 datagrams as received, otherwise the
+ * addresses and network order ports build an IP header, ports of 0 for PGM over IP.
+ * called under either sock::source_mutex or sock::receiver_mutex.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_capture_packet (
+	struct pgm_capture_t*	       const restrict capture,
+	const bool			      is_outbound,
+	const void*		     restrict tpdu,
+	const size_t			      len,
+	const bool			      has_iphdr,
+	const struct sockaddr*	     restrict src,
+	const struct sockaddr*	     restrict dst,
+	const in_port_t			      sport,
+	const in_port_t			      dport
+	)
+{
+	char header[ CAPTURE_MAX_HEADER ];
+	size_t header_len = 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != capture);
+	pgm_assert (NULL != tpdu);
+	pgm_assert (has_iphdr || NULL != dst);
+
+	if (!has_iphdr) {
+		header_len = capture_synthesise (header, len, src, dst, sport, dport);
+		if (PGM_UNLIKELY(0 == header_len))
+			return;
+	}
+	const size_t caplen	= header_len + len;
+	const size_t block_len	= CAPTURE_EPB_OVERHEAD + CAPTURE_ALIGN4(caplen);
+	if (PGM_UNLIKELY(block_len + CAPTURE_MIN_BLOCK > capture->size - capture->ring))
+		return;
+	const uint64_t timestamp = capture_now();
+
+	pgm_spinlock_lock (&capture->lock);
+/* never leave less than a padding block before the end of the file */
+	if (capture->head + block_len != capture->size &&
+	    capture->head + block_len + CAPTURE_MIN_BLOCK > capture->size)
+	{
+		if (capture->head != capture->size)
+			capture_pad (capture, capture->head, capture->size - capture->head);
+		capture->head = capture->tail = capture->ring;
+	}
+	const size_t next = capture->head + block_len;
+/* retire overwritten blocks */
+	while (capture->tail < next ||
+	       (capture->tail != next && capture->tail - next < CAPTURE_MIN_BLOCK))
+	{
+		const uint32_t tail_len = capture_get32 (capture->base + capture->tail + 4);
+		pgm_assert (tail_len >= CAPTURE_MIN_BLOCK);
+		capture->tail += tail_len;
+	}
+
+	char* p = capture->base + capture->head;
+	capture_put32 (p +  0, PCAPNG_EPB);
+	capture_put32 (p +  4, (uint32_t)block_len);
+	capture_put32 (p +  8, 0);					/* interface id */
+	capture_put32 (p + 12, (uint32_t)(timestamp >> 32));
+	capture_put32 (p + 16, (uint32_t)timestamp);
+	capture_put32 (p + 20, (uint32_t)caplen);
+	capture_put32 (p + 24, (uint32_t)caplen);
+	memcpy (p + 28, header, header_len);
+	memcpy (p + 28 + header_len, tpdu, len);
+	memset (p + 28 + caplen, 0, CAPTURE_ALIGN4(caplen) - caplen);
+	char* opt = p + 28 + CAPTURE_ALIGN4(caplen);
+	capture_put16 (opt +  0, PCAPNG_OPT_EPB_FLAGS);
+	capture_put16 (opt +  2, 4);
+	capture_put32 (opt +  4, is_outbound ? PCAPNG_EPB_OUTBOUND : PCAPNG_EPB_INBOUND);
+	capture_put16 (opt +  8, PCAPNG_OPT_EPB_PACKETID);
+	capture_put16 (opt + 10, 8);
+	capture_put64 (opt + 12, capture->packet_id++);
+	capture_put32 (opt + 20, PCAPNG_OPT_ENDOFOPT);
+	capture_put32 (opt + 24, (uint32_t)block_len);
+
+	capture->head = next;
+	if (capture->tail != next)
+		capture_pad (capture, next, capture->tail - next);
+	pgm_spinlock_unlock (&capture->lock);
+}
+
+/* convert a time stamp of resolution if_tsresol to nanoseconds.
+ */
+
+static
+uint64_t
+capture_to_nsecs (
+	const uint64_t		timestamp,
+	const uint8_t		tsresol
+	)
+{
+	if (tsresol & 0x80) {
+		const unsigned shift = tsresol & 0x7f;
+		if (shift >= 64)
+			return 0;
+		const uint64_t mask = (UINT64_C(1) << shift) - 1;
+		return (timestamp >> shift) * UINT64_C(1000000000) + (((timestamp & mask) * UINT64_C(1000000000)) >> shift);
+	}
+	uint64_t nsecs = timestamp;
+	for (unsigned i = tsresol; i < 9; i++)
+		nsecs *= 10;
+	for (unsigned i = 9; i < tsresol; i++)
+		nsecs /= 10;
+	return nsecs;
+}
+
+static
+int
+capture_record_compare (
+	const void*		a,
+	const void*		b
+	)
+{
+	const struct capture_record_t* ra = a;
+	const struct capture_record_t* rb = b;
+	if (ra->key != rb->key)
+		return ra->key < rb->key ? -1 : 1;
+	return ra->data < rb->data ? -1 : (ra->data > rb->data);
+}
+
+/* read the complete file into memory.
+ *
+ * returns TRUE on success, or FALSE on error and sets error appropriately.
+ */
+
+static
+bool
+capture_read_file (
+	const char*   restrict	path,
+	char**	      restrict	data,
+	size_t*	      restrict	len,
+	pgm_error_t** restrict	error
+	)
+{
+	FILE* fp = fopen (path, "rb");
+	if (NULL == fp) {
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_errno (save_errno),
+			     _("Opening capture file %s: %s"),
+			     path,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		return FALSE;
+	}
+	size_t alloc = PGM_CAPTURE_MIN_SIZE;
+	*data = pgm_malloc (alloc);
+	*len = 0;
+	for (;;) {
+		if (*len == alloc) {
+			alloc *= 2;
+			*data = pgm_realloc (*data, alloc);
+		}
+		const size_t bytes_read = fread (*data + *len, 1, alloc - *len, fp);
+		if (0 == bytes_read)
+			break;
+		*len += bytes_read;
+	}
+	const bool is_error = (0 != ferror (fp));
+	fclose (fp);
+	if (is_error) {
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     PGM_ERROR_FAILED,
+			     _("Reading capture file %s failed."),
+			     path);
+		pgm_free (*data);
+		*data = NULL;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/* index the inbound packets of every section in packet order, blocks other than
+ * section headers, interfaces and enhanced packets are skipped.
+ *
+ * returns TRUE on success, or FALSE on a malformed file and sets error appropriately.
+ */
+
+static
+bool
+capture_index (
+	const char*		       restrict	path,
+	const char*		       restrict	data,
+	const size_t				len,
+	struct capture_record_t**      restrict	records,
+	unsigned*		       restrict	records_len,
+	pgm_error_t**		       restrict	error
+	)
+{
+	struct capture_interface_t interfaces[ CAPTURE_MAX_INTERFACES ];
+	unsigned interfaces_len = 0;
+	unsigned alloc = 0;
+	uint64_t file_order = 0;
+	size_t offset = 0;
+
+	*records = NULL;
+	*records_len = 0;
+	if (len < CAPTURE_MIN_BLOCK ||
+	    PCAPNG_SHB != capture_get32 (data) ||
+	    len < 12 ||
+	    PCAPNG_BYTE_ORDER_MAGIC != capture_get32 (data + 8))
+	{
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     PGM_ERROR_INVAL,
+			     _("%s is not a native byte order pcapng file."),
+			     path);
+		return FALSE;
+	}
+	while (offset + CAPTURE_MIN_BLOCK <= len)
+	{
+		const char* block = data + offset;
+		const uint32_t type = capture_get32 (block);
+		const uint32_t block_len = capture_get32 (block + 4);
+		if (block_len < CAPTURE_MIN_BLOCK || 0 != (block_len & 3) || block_len > len - offset)
+		{
+			pgm_set_error (error,
+				     PGM_ERROR_DOMAIN_SOCKET,
+				     PGM_ERROR_INVAL,
+				     _("Malformed block at offset %" PRIzu " of %s."),
+				     offset, path);
+			pgm_free (*records);
+			*records = NULL;
+			*records_len = 0;
+			return FALSE;
+		}
+		offset += block_len;
+
+		switch (type) {
+		case PCAPNG_SHB:
+			interfaces_len = 0;
+			break;
+
+		case PCAPNG_IDB:
+			if (block_len < 20 || interfaces_len == CAPTURE_MAX_INTERFACES)
+				break;
+			{
+				struct capture_interface_t* interface = &interfaces[ interfaces_len++ ];
+				interface->linktype = capture_get16 (block + 8);
+				interface->tsresol  = 6;
+				for (const char* opt = block + 16;
+				     opt + 4 <= block + block_len - 4;
+				     opt += 4 + CAPTURE_ALIGN4(capture_get16 (opt + 2)))
+				{
+					const uint16_t code = capture_get16 (opt);
+					if (PCAPNG_OPT_ENDOFOPT == code)
+						break;
+					if (PCAPNG_OPT_IF_TSRESOL == code && capture_get16 (opt + 2) >= 1)
+						interface->tsresol = (uint8_t)opt[4];
+				}
+			}
+			break;
+
+		case PCAPNG_EPB:
+			if (block_len < 32)
+				break;
+			{
+				const uint32_t interface_id = capture_get32 (block + 8);
+				const uint32_t caplen = capture_get32 (block + 20);
+				if (interface_id >= interfaces_len || caplen > block_len - 32)
+					break;
+				uint64_t key = file_order++;
+				uint32_t flags = PCAPNG_EPB_INBOUND;
+				for (const char* opt = block + 28 + CAPTURE_ALIGN4(caplen);
+				     opt + 4 <= block + block_len - 4;
+				     opt += 4 + CAPTURE_ALIGN4(capture_get16 (opt + 2)))
+				{
+					const uint16_t code = capture_get16 (opt);
+					const uint16_t opt_len = capture_get16 (opt + 2);
+					if (PCAPNG_OPT_ENDOFOPT == code)
+						break;
+					if (PCAPNG_OPT_EPB_FLAGS == code && 4 == opt_len)
+						flags = capture_get32 (opt + 4);
+					else if (PCAPNG_OPT_EPB_PACKETID == code && 8 == opt_len)
+						key = capture_get64 (opt + 4);
+				}
+				if (PCAPNG_EPB_OUTBOUND == (flags & PCAPNG_EPB_DIRECTION_MASK))
+					break;
+				if (*records_len == alloc) {
+					alloc = alloc ? (2 * alloc) : 1024;
+					*records = pgm_realloc (*records, alloc * sizeof(struct capture_record_t));
+				}
+				const uint64_t timestamp = ((uint64_t)capture_get32 (block + 12) << 32) | capture_get32 (block + 16);
+				struct capture_record_t* record = &(*records)[ (*records_len)++ ];
+				record->key		= key;
+				record->timestamp	= capture_to_nsecs (timestamp, interfaces[ interface_id ].tsresol);
+				record->data		= block + 28;
+				record->len		= caplen;
+				record->linktype	= interfaces[ interface_id ].linktype;
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+	if (*records_len > 1)
+		qsort (*records, *records_len, sizeof(struct capture_record_t), capture_record_compare);
+	return TRUE;
+}
+
+/* locate the PGM datagram within a recorded packet and its addresses, IPv4 PGM
+ * retains the IP header for pgm_parse_raw().
+ *
+ * returns TRUE if the packet carries PGM, FALSE otherwise.
+ */
+
+static
+bool
+capture_decode (
+	const struct capture_record_t* restrict	record,
+	const char**		       restrict	tpdu,
+	size_t*			       restrict	len,
+	struct sockaddr_storage*       restrict	src,
+	struct sockaddr_storage*       restrict	dst,
+	bool*			       restrict	is_udp_encap
+	)
+{
+	const char* p = record->data;
+	size_t remaining = record->len;
+	unsigned protocol;
+
+	if (PCAPNG_LINKTYPE_ETHERNET == record->linktype) {
+		if (remaining < 14)
+			return FALSE;
+		uint16_t ethertype = pgm_ntohs (capture_get16 (p + 12));
+		p += 14; remaining -= 14;
+		if (0x8100 == ethertype) {			/* 802.1Q */
+			if (remaining < 4)
+				return FALSE;
+			ethertype = pgm_ntohs (capture_get16 (p + 2));
+			p += 4; remaining -= 4;
+		}
+		if (0x0800 != ethertype && 0x86dd != ethertype)
+			return FALSE;
+	} else if (PCAPNG_LINKTYPE_RAW != record->linktype)
+		return FALSE;
+
+	memset (src, 0, sizeof(struct sockaddr_storage));
+	memset (dst, 0, sizeof(struct sockaddr_storage));
+	if (remaining >= sizeof(struct pgm_ip) && 4 == ((uint8_t)p[0] >> 4))
+	{
+		struct pgm_ip ip;
+		memcpy (&ip, p, sizeof(ip));
+		const size_t ip_len = ip.ip_hl * 4;
+		if (ip_len < sizeof(ip) || ip_len > remaining)
+			return FALSE;
+		struct sockaddr_in* s4 = (struct sockaddr_in*)src;
+		struct sockaddr_in* d4 = (struct sockaddr_in*)dst;
+		s4->sin_family = d4->sin_family = AF_INET;
+		s4->sin_addr = ip.ip_src;
+		d4->sin_addr = ip.ip_dst;
+		protocol = ip.ip_p;
+		if (IPPROTO_PGM == protocol) {
+			*tpdu = p;
+			*len = remaining;
+			*is_udp_encap = FALSE;
+			return TRUE;
+		}
+		p += ip_len; remaining -= ip_len;
+	}
+	else if (remaining >= sizeof(struct pgm_ip6_hdr) && 6 == ((uint8_t)p[0] >> 4))
+	{
+		struct pgm_ip6_hdr ip6;
+		memcpy (&ip6, p, sizeof(ip6));
+		struct sockaddr_in6* s6 = (struct sockaddr_in6*)src;
+		struct sockaddr_in6* d6 = (struct sockaddr_in6*)dst;
+		s6->sin6_family = d6->sin6_family = AF_INET6;
+		s6->sin6_addr = ip6.ip6_src;
+		d6->sin6_addr = ip6.ip6_dst;
+		protocol = ip6.ip6_nxt;
+		p += sizeof(ip6); remaining -= sizeof(ip6);
+	}
+	else
+		return FALSE;
+
+	if (IPPROTO_UDP == protocol) {
+		if (remaining < sizeof(struct pgm_udphdr))
+			return FALSE;
+		struct pgm_udphdr udp;
+		memcpy (&udp, p, sizeof(udp));
+		((struct sockaddr_in*)src)->sin_port = udp.uh_sport;	/* same offset for sockaddr_in6 */
+		((struct sockaddr_in*)dst)->sin_port = udp.uh_dport;
+		p += sizeof(udp); remaining -= sizeof(udp);
+	} else if (IPPROTO_PGM != protocol)
+		return FALSE;
+	*tpdu = p;
+	*len = remaining;
+	*is_udp_encap = TRUE;
+	return TRUE;
+}
+
+/* wait until the local time due.
+ */
+
+static
+void
+capture_wait_until (
+	const pgm_time_t	due
+	)
+{
+	pgm_time_t now;
+	while ((now = pgm_time_update_now()) < due)
+	{
+		const pgm_time_t remaining = due - now;
+		if (remaining > 2000) {
+#ifndef _WIN32
+			const struct timespec req = { 0, (long)((remaining - 1000) * 1000) % 1000000000L };
+			nanosleep (&req, NULL);
+#else
+			Sleep ((DWORD)(remaining / 1000) - 1);
+#endif
+		} else
+			pgm_thread_yield();
+	}
+}
+
+/* feed the inbound datagrams of a pcapng capture file through the receive path
+ * of a bound socket in recorded order, spaced as recorded unless
+ * PGM_REPLAY_MAX_SPEED is set.  Received data is read with the receive calls
+ * from another thread.  Timers continue to run so NAKs are sent to the recorded
+ * source addresses, replay on an isolated network.
+ *
+ * returns TRUE on success, or FALSE on error and sets error appropriately.
+ */
+
+bool
+pgm_capture_replay (
+	pgm_sock_t*   const restrict	sock,
+	const char*	    restrict	path,
+	int				flags,
+	pgm_error_t**	    restrict	error
+	)
+{
+	char* data;
+	size_t len;
+	struct capture_record_t* records;
+	unsigned records_len;
+	unsigned replayed = 0;
+
+	pgm_return_val_if_fail (NULL != sock, FALSE);
+	pgm_return_val_if_fail (NULL != path, FALSE);
+	pgm_return_val_if_fail (0 == (flags & ~PGM_REPLAY_MAX_SPEED), FALSE);
+
+	if (!capture_read_file (path, &data, &len, error))
+		return FALSE;
+	if (!capture_index (path, data, len, &records, &records_len, error)) {
+		pgm_free (data);
+		return FALSE;
+	}
+
+	if (PGM_UNLIKELY(!pgm_rwlock_reader_trylock (&sock->lock))) {
+		pgm_free (records);
+		pgm_free (data);
+		pgm_return_val_if_reached (FALSE);
+	}
+	if (PGM_UNLIKELY(!sock->is_bound || sock->is_destroyed || !sock->can_recv_data)) {
+		pgm_rwlock_reader_unlock (&sock->lock);
+		pgm_free (records);
+		pgm_free (data);
+		pgm_return_val_if_reached (FALSE);
+	}
+
+	const pgm_time_t start = pgm_time_update_now();
+	for (unsigned i = 0; i < records_len; i++)
+	{
+		const char* tpdu;
+		size_t tpdu_len;
+		struct sockaddr_storage src, dst;
+		bool is_udp_encap;
+
+		if (!capture_decode (&records[ i ], &tpdu, &tpdu_len, &src, &dst, &is_udp_encap))
+			continue;
+		if (!(flags & PGM_REPLAY_MAX_SPEED) && records[ i ].timestamp > records[ 0 ].timestamp)
+			capture_wait_until (start + (pgm_time_t)((records[ i ].timestamp - records[ 0 ].timestamp) / 1000));
+		pgm_mutex_lock (&sock->receiver_mutex);
+		(void)pgm_recv_replay (sock, tpdu, tpdu_len, (struct sockaddr*)&src, (struct sockaddr*)&dst, is_udp_encap);
+		pgm_mutex_unlock (&sock->receiver_mutex);
+		replayed++;
+	}
+	pgm_rwlock_reader_unlock (&sock->lock);
+	pgm_trace (PGM_LOG_ROLE_NETWORK,_("Replayed %u of %u inbound packets from %s."), replayed, records_len, path);
+	pgm_free (records);
+	pgm_free (data);
+	return TRUE;
+}
+
+/* eof */
@@ -0,0 +1,340 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * unit tests for packet capture ring and replay.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <check.h>
+
+#include "impl/framework.h"
+
+#ifdef _WIN32
+#	define PGM_CHECK_NOFORK		1
+#endif
+
+
+/* mock state */
+#define TEST_FILE		"capture-unittest.pcapng"
+
+static unsigned			mock_replayed = 0;
+static bool			mock_is_udp_encap = FALSE;
+static uint16_t			mock_sport = 0;
+static pgm_time_t _mock_pgm_time_update_now (void);
+pgm_time_update_func mock_pgm_time_update_now = _mock_pgm_time_update_now;
+PGM_GNUC_INTERNAL bool mock_pgm_recv_replay (struct pgm_sock_t*const restrict, const void*restrict, const size_t, const struct sockaddr*restrict, const struct sockaddr*restrict, const bool);
+
+/* mock functions for external references */
+
+#define pgm_time_update_now	mock_pgm_time_update_now
+#define pgm_recv_replay		mock_pgm_recv_replay
+
+#define CAPTURE_DEBUG
+#include "capture.c"
+
+static
+pgm_time_t
+_mock_pgm_time_update_now (void)
+{
+	return 0x1000;
+}
+
+PGM_GNUC_INTERNAL
+bool
+mock_pgm_recv_replay (
+	PGM_GNUC_UNUSED struct pgm_sock_t*const restrict sock,
+	PGM_GNUC_UNUSED const void*		restrict packet,
+	PGM_GNUC_UNUSED const size_t		len,
+	const struct sockaddr*			restrict src,
+	PGM_GNUC_UNUSED const struct sockaddr*	restrict dst,
+	const bool				is_udp_encap
+	)
+{
+	mock_replayed++;
+	mock_is_udp_encap = is_udp_encap;
+	mock_sport = ((const struct sockaddr_in*)src)->sin_port;
+	return TRUE;
+}
+
+static
+void
+generate_addresses (
+	struct sockaddr_in*	src,
+	struct sockaddr_in*	dst
+	)
+{
+	memset (src, 0, sizeof(*src));
+	memset (dst, 0, sizeof(*dst));
+	src->sin_family = dst->sin_family = AF_INET;
+	src->sin_addr.s_addr = inet_addr ("172.12.90.1");
+	dst->sin_addr.s_addr = inet_addr ("239.192.0.1");
+}
+
+/* index the current contents of the capture file */
+static
+unsigned
+read_records (
+	struct capture_record_t**	records,
+	char**				data
+	)
+{
+	size_t len;
+	unsigned records_len;
+	fail_unless (TRUE == capture_read_file (TEST_FILE, data, &len, NULL), "read failed");
+	fail_unless (TRUE == capture_index (TEST_FILE, *data, len, records, &records_len, NULL), "malformed file");
+	return records_len;
+}
+
+/* target:
+ *	struct pgm_capture_t*
+ *	pgm_capture_new (
+ *		const char*	path,
+ *		size_t		size,
+ *		pgm_error_t**	error
+ *	)
+ */
+
+START_TEST (test_new_pass_001)
+{
+	pgm_error_t* err = NULL;
+	struct pgm_capture_t* capture = pgm_capture_new (TEST_FILE, 0, &err);
+	fail_if (NULL == capture, "new failed");
+	fail_unless (PGM_CAPTURE_DEFAULT_SIZE == capture->size, "default size");
+	struct capture_record_t* records;
+	char* data;
+	fail_unless (0 == read_records (&records, &data), "empty ring has records");
+	pgm_free (records);
+	pgm_free (data);
+	pgm_capture_destroy (capture);
+	unlink (TEST_FILE);
+}
+END_TEST
+
+START_TEST (test_new_fail_001)
+{
+	pgm_error_t* err = NULL;
+	fail_unless (NULL == pgm_capture_new ("/nonexistent/capture.pcapng", 0, &err), "new succeeded");
+	fail_if (NULL == err, "error not set");
+	pgm_error_free (err);
+}
+END_TEST
+
+/* target:
+ *	void
+ *	pgm_capture_packet (
+ *		struct pgm_capture_t*	capture,
+ *		const bool		is_outbound,
+ *		const void*		tpdu,
+ *		const size_t		len,
+ *		const bool		has_iphdr,
+ *		const struct sockaddr*	src,
+ *		const struct sockaddr*	dst,
+ *		const in_port_t		sport,
+ *		const in_port_t		dport
+ *	)
+ */
+
+/* file remains valid and ordered as the ring wraps */
+START_TEST (test_packet_pass_001)
+{
+	struct sockaddr_in src, dst;
+	char tpdu[ 1500 ];
+	generate_addresses (&src, &dst);
+	memset (tpdu, 0x5a, sizeof(tpdu));
+	struct pgm_capture_t* capture = pgm_capture_new (TEST_FILE, PGM_CAPTURE_MIN_SIZE, NULL);
+	fail_if (NULL == capture, "new failed");
+	for (unsigned i = 0; i < 2000; i++) {
+		pgm_capture_packet (capture, FALSE, tpdu, 24 + (i * 37) % 1400, FALSE,
+				    (struct sockaddr*)&src, (struct sockaddr*)&dst,
+				    pgm_htons (3056), pgm_htons (3055));
+		if (0 != (i % 97))
+			continue;
+		struct capture_record_t* records;
+		char* data;
+		const unsigned records_len = read_records (&records, &data);
+		fail_unless (records_len > 0, "no records");
+		fail_unless (i == records[ records_len - 1 ].key, "newest packet missing");
+		for (unsigned j = 1; j < records_len; j++)
+			fail_unless (records[ j - 1 ].key + 1 == records[ j ].key, "packets not contiguous");
+		pgm_free (records);
+		pgm_free (data);
+	}
+	pgm_capture_destroy (capture);
+	unlink (TEST_FILE);
+}
+END_TEST
+
+/* synthesised headers decode to the original datagram */
+START_TEST (test_packet_pass_002)
+{
+	struct sockaddr_in src, dst;
+	char tpdu[ 64 ];
+	generate_addresses (&src, &dst);
+	for (unsigned i = 0; i < sizeof(tpdu); i++)
+		tpdu[ i ] = (char)i;
+	struct pgm_capture_t* capture = pgm_capture_new (TEST_FILE, PGM_CAPTURE_MIN_SIZE, NULL);
+	fail_if (NULL == capture, "new failed");
+	pgm_capture_packet (capture, FALSE, tpdu, sizeof(tpdu), FALSE,
+			    (struct sockaddr*)&src, (struct sockaddr*)&dst,
+			    pgm_htons (3056), pgm_htons (3055));
+	struct capture_record_t* records;
+	char* data;
+	fail_unless (1 == read_records (&records, &data), "record count");
+	fail_unless (sizeof(struct pgm_ip) + sizeof(struct pgm_udphdr) + sizeof(tpdu) == records[0].len, "length");
+	fail_unless (0 == pgm_inet_checksum (records[0].data, sizeof(struct pgm_ip), 0), "IP checksum");
+	const char* decoded;
+	size_t decoded_len;
+	struct sockaddr_storage dsrc, ddst;
+	bool is_udp_encap;
+	fail_unless (TRUE == capture_decode (&records[0], &decoded, &decoded_len, &dsrc, &ddst, &is_udp_encap), "decode failed");
+	fail_unless (TRUE == is_udp_encap, "not UDP");
+	fail_unless (sizeof(tpdu) == decoded_len, "decoded length");
+	fail_unless (0 == memcmp (tpdu, decoded, sizeof(tpdu)), "decoded data");
+	fail_unless (src.sin_addr.s_addr == ((struct sockaddr_in*)&dsrc)->sin_addr.s_addr, "source address");
+	fail_unless (dst.sin_addr.s_addr == ((struct sockaddr_in*)&ddst)->sin_addr.s_addr, "group address");
+	fail_unless (pgm_htons (3056) == ((struct sockaddr_in*)&dsrc)->sin_port, "source port");
+	pgm_free (records);
+	pgm_free (data);
+	pgm_capture_destroy (capture);
+	unlink (TEST_FILE);
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_capture_replay (
+ *		pgm_sock_t*	sock,
+ *		const char*	path,
+ *		int		flags,
+ *		pgm_error_t**	error
+ *	)
+ */
+
+START_TEST (test_replay_pass_001)
+{
+	struct sockaddr_in src, dst;
+	char tpdu[ 100 ];
+	generate_addresses (&src, &dst);
+	memset (tpdu, 0, sizeof(tpdu));
+	struct pgm_capture_t* capture = pgm_capture_new (TEST_FILE, PGM_CAPTURE_MIN_SIZE, NULL);
+	fail_if (NULL == capture, "new failed");
+	for (unsigned i = 0; i < 10; i++)
+		pgm_capture_packet (capture, 0 == (i % 2), tpdu, sizeof(tpdu), FALSE,
+				    (struct sockaddr*)&src, (struct sockaddr*)&dst,
+				    pgm_htons (3056), pgm_htons (3055));
+	pgm_capture_destroy (capture);
+
+	pgm_sock_t* sock = g_new0 (pgm_sock_t, 1);
+	pgm_rwlock_init (&sock->lock);
+	pgm_mutex_init (&sock->receiver_mutex);
+	sock->is_bound = TRUE;
+	sock->can_recv_data = TRUE;
+	mock_replayed = 0;
+	pgm_error_t* err = NULL;
+	fail_unless (TRUE == pgm_capture_replay (sock, TEST_FILE, PGM_REPLAY_MAX_SPEED, &err), "replay failed");
+	fail_unless (5 == mock_replayed, "outbound packets replayed");
+	fail_unless (TRUE == mock_is_udp_encap, "not UDP");
+	fail_unless (pgm_htons (3056) == mock_sport, "source port");
+	unlink (TEST_FILE);
+}
+END_TEST
+
+START_TEST (test_replay_fail_001)
+{
+	pgm_error_t* err = NULL;
+	fail_unless (FALSE == pgm_capture_replay (NULL, TEST_FILE, 0, &err), "replay succeeded");
+}
+END_TEST
+
+/* not a pcapng file */
+START_TEST (test_replay_fail_002)
+{
+	FILE* fp = fopen (TEST_FILE, "wb");
+	fail_if (NULL == fp, "fopen failed");
+	fputs ("not a capture file at all", fp);
+	fclose (fp);
+	pgm_sock_t* sock = g_new0 (pgm_sock_t, 1);
+	pgm_rwlock_init (&sock->lock);
+	pgm_mutex_init (&sock->receiver_mutex);
+	sock->is_bound = TRUE;
+	sock->can_recv_data = TRUE;
+	pgm_error_t* err = NULL;
+	fail_unless (FALSE == pgm_capture_replay (sock, TEST_FILE, 0, &err), "replay succeeded");
+	fail_if (NULL == err, "error not set");
+	pgm_error_free (err);
+	unlink (TEST_FILE);
+}
+END_TEST
+
+
+static
+Suite*
+make_test_suite (void)
+{
+	Suite* s;
+
+	s = suite_create (__FILE__);
+
+	TCase* tc_new = tcase_create ("new");
+	suite_add_tcase (s, tc_new);
+	tcase_add_test (tc_new, test_new_pass_001);
+	tcase_add_test (tc_new, test_new_fail_001);
+
+	TCase* tc_packet = tcase_create ("packet");
+	suite_add_tcase (s, tc_packet);
+	tcase_add_test (tc_packet, test_packet_pass_001);
+	tcase_add_test (tc_packet, test_packet_pass_002);
+
+	TCase* tc_replay = tcase_create ("replay");
+	suite_add_tcase (s, tc_replay);
+	tcase_add_test (tc_replay, test_replay_pass_001);
+	tcase_add_test (tc_replay, test_replay_fail_001);
+	tcase_add_test (tc_replay, test_replay_fail_002);
+	return s;
+}
+
+static
+Suite*
+make_master_suite (void)
+{
+	Suite* s = suite_create ("Master");
+	return s;
+}
+
+int
+main (void)
+{
+	pgm_cpu_t cpu;
+	pgm_messages_init();
+	pgm_cpuid (&cpu);
+	pgm_checksum_init (&cpu);
+	SRunner* sr = srunner_create (make_master_suite ());
+	srunner_add_suite (sr, make_test_suite ());
+	srunner_run_all (sr, CK_ENV);
+	int number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	pgm_messages_shutdown();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof */
@@ -0,0 +1,597 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * topics sharded over a pool of multicast groups and ports.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <impl/i18n.h>
+#include <impl/framework.h>
+#include <impl/net.h>
+#include <pgm/channel.h>
+
+
+//#define CHANNEL_DEBUG
+
+/* A topic hashes to one shard, a data-destination port on a group of the pool.  Every
+ * published shard is a source socket of its own TSI and transmit window, joined to the
+ * stream group of the first so the send sockets and rate are shared.  One receive socket
+ * joins the groups and ports of the subscribed shards only, its sessions are demultiplexed
+ * on TSI as any other.  Shards of one group are still delivered to the host together and
+ * discarded by port, see PGM_RECV_FILTER to drop them in the kernel.
+ *
+ * Each APDU leads with the topic, one byte of length then the name, so topics colliding on
+ * a shard are separated at the receiver.
+ */
+
+struct pgm_topic_t {
+	pgm_sock_t*			sock;
+	uint32_t			shard;
+	uint8_t				header[1 + PGM_CHANNEL_MAX_TOPIC + 1];	/* length, name, terminator */
+};
+
+struct channel_sub_t {
+	uint32_t			shard;
+	char				name[PGM_CHANNEL_MAX_TOPIC + 1];
+};
+
+struct pgm_channel_t {
+	struct pgm_channel_info_t	info;
+	pgm_rwlock_t			lock;
+	pgm_sock_t**			sources;	/* per shard, NULL = not published */
+	pgm_sock_t*			stream_sock;	/* first source, PGM_STREAM_GROUP of the others */
+	pgm_sock_t*			recv_sock;	/* NULL = no subscriptions yet */
+	uint32_t			recv_shard;	/* bound port of recv_sock */
+	uint32_t*			shard_subs;	/* topics subscribed per shard */
+	uint32_t*			group_subs;	/* shards subscribed per group */
+	pgm_hashtable_t*		topics;		/* name to pgm_topic_t */
+	pgm_hashtable_t*		subs;		/* name to channel_sub_t */
+	pgm_slist_t*			topic_list;
+	pgm_slist_t*			sub_list;
+};
+
+static
+bool
+channel_is_topic (
+	const char*	topic
+	)
+{
+	if (PGM_UNLIKELY(NULL == topic || '\0' == topic[0]))
+		return FALSE;
+	return NULL != memchr (topic, '\0', PGM_CHANNEL_MAX_TOPIC + 1);
+}
+
+/* group of a shard, the low 32 bits of the first group advanced by the group index.
+ */
+
+static
+void
+channel_group (
+	const pgm_channel_t*const	  restrict channel,
+	const uint32_t				   shard,
+	struct pgm_group_source_req*const restrict gsr
+	)
+{
+	const uint32_t offset = shard % channel->info.ci_groups;
+
+	memset (gsr, 0, sizeof (struct pgm_group_source_req));
+	gsr->gsr_interface = channel->info.ci_interface.ir_interface;
+	memcpy (&gsr->gsr_group, &channel->info.ci_group, sizeof (struct sockaddr_storage));
+	if (AF_INET6 == gsr->gsr_group.ss_family) {
+		struct sockaddr_in6* sin6 = (struct sockaddr_in6*)&gsr->gsr_group;
+		uint32_t low;
+		memcpy (&low, &sin6->sin6_addr.s6_addr[12], sizeof (low));
+		low = htonl (ntohl (low) + offset);
+		memcpy (&sin6->sin6_addr.s6_addr[12], &low, sizeof (low));
+	} else {
+		struct sockaddr_in* sin = (struct sockaddr_in*)&gsr->gsr_group;
+		sin->sin_addr.s_addr = htonl (ntohl (sin->sin_addr.s_addr) + offset);
+	}
+	memcpy (&gsr->gsr_source, &gsr->gsr_group, sizeof (struct sockaddr_storage));
+	memcpy (&gsr->gsr_addr, &channel->info.ci_interface.ir_address, sizeof (struct sockaddr_storage));
+}
+
+/* shard of a topic, 32-bit FNV-1a of the name as unsigned bytes so that hosts of any
+ * char signedness agree.
+ */
+
+uint32_t
+pgm_channel_shard (
+	const pgm_channel_t* restrict channel,
+	const char*	     restrict topic
+	)
+{
+	uint32_t hash = UINT32_C(2166136261);
+
+	pgm_return_val_if_fail (NULL != channel, 0);
+	pgm_return_val_if_fail (NULL != topic, 0);
+
+	for (const unsigned char* p = (const unsigned char*)topic; *p; p++) {
+		hash ^= *p;
+		hash *= UINT32_C(16777619);
+	}
+	return hash % channel->info.ci_shards;
+}
+
+/* create a channel over the pool of ci.  no sockets are opened until the first
+ * publish or subscribe.
+ *
+ * returns TRUE on success, returns FALSE on invalid pool with error set.
+ */
+
+bool
+pgm_channel_create (
+	pgm_channel_t**			  restrict channel,
+	const struct pgm_channel_info_t*  restrict ci,
+	pgm_error_t**			  restrict error
+	)
+{
+	pgm_channel_t* new_channel;
+	uint32_t groups;
+
+	pgm_return_val_if_fail (NULL != channel, FALSE);
+	pgm_return_val_if_fail (NULL != ci, FALSE);
+
+	groups = ci->ci_groups ? ci->ci_groups : 1;
+	if (PGM_UNLIKELY((AF_INET != ci->ci_group.ss_family && AF_INET6 != ci->ci_group.ss_family) ||
+			 !pgm_sockaddr_is_addr_multicast ((const struct sockaddr*)&ci->ci_group) ||
+			 ci->ci_shards < groups ||
+			 0 == ci->ci_port ||
+			 (uint32_t)ci->ci_port + ci->ci_shards - 1 > UINT16_MAX ||
+			 (IPPROTO_PGM != ci->ci_protocol && IPPROTO_UDP != ci->ci_protocol)))
+	{
+		pgm_set_error (error,
+			       PGM_ERROR_DOMAIN_SOCKET,
+			       PGM_ERROR_INVAL,
+			       _("Invalid channel group or port pool."));
+		return FALSE;
+	}
+
+	new_channel = pgm_new0 (pgm_channel_t, 1);
+	memcpy (&new_channel->info, ci, sizeof (struct pgm_channel_info_t));
+	new_channel->info.ci_groups = groups;
+	pgm_rwlock_init (&new_channel->lock);
+	new_channel->sources	= pgm_new0 (pgm_sock_t*, ci->ci_shards);
+	new_channel->shard_subs	= pgm_new0 (uint32_t, ci->ci_shards);
+	new_channel->group_subs	= pgm_new0 (uint32_t, groups);
+	new_channel->topics	= pgm_hashtable_new (pgm_str_hash, pgm_str_equal);
+	new_channel->subs	= pgm_hashtable_new (pgm_str_hash, pgm_str_equal);
+	*channel = new_channel;
+	return TRUE;
+}
+
+/* close every shard socket, sources of the stream group before its first source.
+ *
+ * returns TRUE on success, returns FALSE on invalid parameters.
+ */
+
+bool
+pgm_channel_destroy (
+	pgm_channel_t*	channel,
+	bool		flush
+	)
+{
+	pgm_return_val_if_fail (NULL != channel, FALSE);
+
+	for (uint32_t i = 0; i < channel->info.ci_shards; i++)
+		if (NULL != channel->sources[i] && channel->stream_sock != channel->sources[i])
+			pgm_close (channel->sources[i], flush);
+	if (NULL != channel->stream_sock)
+		pgm_close (channel->stream_sock, flush);
+	if (NULL != channel->recv_sock)
+		pgm_close (channel->recv_sock, FALSE);
+
+	for (pgm_slist_t* list = channel->topic_list; NULL != list; list = list->next)
+		pgm_free (list->data);
+	for (pgm_slist_t* list = channel->sub_list; NULL != list; list = list->next)
+		pgm_free (list->data);
+	pgm_slist_free (channel->topic_list);
+	pgm_slist_free (channel->sub_list);
+	pgm_hashtable_destroy (channel->topics);
+	pgm_hashtable_destroy (channel->subs);
+	pgm_free (channel->group_subs);
+	pgm_free (channel->shard_subs);
+	pgm_free (channel->sources);
+	pgm_rwlock_free (&channel->lock);
+	pgm_free (channel);
+	return TRUE;
+}
+
+/* open the socket of a shard, a source sending to its group or the receive socket
+ * bound to its port.  called with the channel writer lock.
+ *
+ * returns TRUE on success, returns FALSE on failure with error set.
+ */
+
+static
+bool
+channel_open (
+	pgm_channel_t*const restrict	channel,
+	const uint32_t			shard,
+	const bool			is_recv,
+	pgm_sock_t**	    restrict	sock,
+	pgm_error_t**	    restrict	error
+	)
+{
+	const struct pgm_channel_info_t* ci = &channel->info;
+	struct pgm_group_source_req gsr;
+	struct pgm_sockaddr_t addr;
+	pgm_sock_t* new_sock = NULL;
+
+	if (!pgm_socket (&new_sock, ci->ci_group.ss_family, SOCK_SEQPACKET, ci->ci_protocol, error))
+		return FALSE;
+	if (IPPROTO_UDP == ci->ci_protocol) {
+		const int encap_port = ci->ci_udp_encap_port;
+		pgm_setsockopt (new_sock, IPPROTO_PGM, PGM_UDP_ENCAP_UCAST_PORT, &encap_port, sizeof (encap_port));
+		pgm_setsockopt (new_sock, IPPROTO_PGM, PGM_UDP_ENCAP_MCAST_PORT, &encap_port, sizeof (encap_port));
+	}
+	if (is_recv) {
+		const int recv_only = 1;
+		pgm_setsockopt (new_sock, IPPROTO_PGM, PGM_RECV_ONLY, &recv_only, sizeof (recv_only));
+	}
+	if (NULL != ci->ci_setup && !ci->ci_setup (new_sock, shard, is_recv, ci->ci_setup_arg)) {
+		pgm_set_error (error,
+			       PGM_ERROR_DOMAIN_SOCKET,
+			       PGM_ERROR_FAILED,
+			       _("Channel shard %u setup failed."), (unsigned)shard);
+		goto err_close;
+	}
+	if (!is_recv && NULL != channel->stream_sock) {
+		struct pgm_stream_req_t sr;
+		memset (&sr, 0, sizeof (sr));
+		sr.sr_sock = channel->stream_sock;
+		pgm_setsockopt (new_sock, IPPROTO_PGM, PGM_STREAM_GROUP, &sr, sizeof (sr));
+	}
+
+	memset (&addr, 0, sizeof (addr));
+	addr.sa_port = (uint16_t)(ci->ci_port + shard);
+	addr.sa_addr.sport = 0;				/* random */
+	memcpy (&addr.sa_addr.gsi, &ci->ci_gsi, sizeof (pgm_gsi_t));
+	if (!pgm_bind3 (new_sock,
+			&addr, sizeof (addr),
+			&ci->ci_interface, sizeof (struct pgm_interface_req_t),
+			&ci->ci_interface, sizeof (struct pgm_interface_req_t),
+			error))
+		goto err_close;
+
+	channel_group (channel, shard, &gsr);
+	if (!pgm_setsockopt (new_sock, IPPROTO_PGM, PGM_JOIN_GROUP, &gsr, sizeof (gsr)) ||
+	    !pgm_setsockopt (new_sock, IPPROTO_PGM, PGM_SEND_GROUP, &gsr, sizeof (gsr)))
+	{
+		pgm_set_error (error,
+			       PGM_ERROR_DOMAIN_SOCKET,
+			       PGM_ERROR_FAILED,
+			       _("Channel shard %u cannot join its group."), (unsigned)shard);
+		goto err_close;
+	}
+	if (!pgm_connect (new_sock, error))
+		goto err_close;
+	*sock = new_sock;
+	return TRUE;
+
+err_close:
+	pgm_close (new_sock, FALSE);
+	return FALSE;
+}
+
+/* send handle of a topic, opening the source of its shard on first use.  the handle is
+ * valid until the channel is destroyed.
+ *
+ * returns TRUE on success, returns FALSE on failure with error set.
+ */
+
+bool
+pgm_channel_publish (
+	pgm_channel_t*	restrict channel,
+	const char*	restrict topic,
+	pgm_topic_t**	restrict handle,
+	pgm_error_t**	restrict error
+	)
+{
+	pgm_topic_t* new_topic;
+	uint32_t shard;
+	size_t len;
+
+	pgm_return_val_if_fail (NULL != channel, FALSE);
+	pgm_return_val_if_fail (channel_is_topic (topic), FALSE);
+	pgm_return_val_if_fail (NULL != handle, FALSE);
+
+	pgm_rwlock_writer_lock (&channel->lock);
+	new_topic = pgm_hashtable_lookup (channel->topics, topic);
+	if (NULL != new_topic) {
+		pgm_rwlock_writer_unlock (&channel->lock);
+		*handle = new_topic;
+		return TRUE;
+	}
+	shard = pgm_channel_shard (channel, topic);
+	if (NULL == channel->sources[shard]) {
+		if (!channel_open (channel, shard, FALSE, &channel->sources[shard], error)) {
+			pgm_rwlock_writer_unlock (&channel->lock);
+			return FALSE;
+		}
+		if (NULL == channel->stream_sock)
+			channel->stream_sock = channel->sources[shard];
+	}
+
+	len = strlen (topic);
+	new_topic = pgm_new0 (pgm_topic_t, 1);
+	new_topic->sock = channel->sources[shard];
+	new_topic->shard = shard;
+	new_topic->header[0] = (uint8_t)len;
+	memcpy (&new_topic->header[1], topic, len + 1);
+	pgm_hashtable_insert (channel->topics, &new_topic->header[1], new_topic);
+	channel->topic_list = pgm_slist_prepend (channel->topic_list, new_topic);
+	pgm_rwlock_writer_unlock (&channel->lock);
+	*handle = new_topic;
+	return TRUE;
+}
+
+/* send one APDU on a topic, as pgm_send() of the topic and APDU.  bytes_written
+ * counts APDU bytes only.
+ *
+ * on success, returns PGM_IO_STATUS_NORMAL.
+ */
+
+int
+pgm_topic_send (
+	pgm_topic_t* const restrict topic,
+	const void*	   restrict apdu,
+	const size_t		    apdu_length,
+	size_t*		   restrict bytes_written
+	)
+{
+	struct pgm_iovec vector[2];
+	size_t bytes_sent = 0;
+	int status;
+
+	pgm_return_val_if_fail (NULL != topic, PGM_IO_STATUS_ERROR);
+	if (PGM_LIKELY(apdu_length)) pgm_return_val_if_fail (NULL != apdu, PGM_IO_STATUS_ERROR);
+
+	vector[0].iov_base = (void*)topic->header;
+	vector[0].iov_len  = 1 + topic->header[0];
+	vector[1].iov_base = pgm_send_ptr (apdu);
+	vector[1].iov_len  = apdu_length;
+	status = pgm_sendv (topic->sock, vector, apdu_length ? 2 : 1, TRUE, &bytes_sent);
+	if (PGM_IO_STATUS_NORMAL == status && NULL != bytes_written)
+		*bytes_written = bytes_sent - vector[0].iov_len;
+	return status;
+}
+
+/* source socket of a topic, for pgm_poll_info() and pgm_getsockopt().
+ */
+
+pgm_sock_t*
+pgm_topic_sock (
+	const pgm_topic_t* const	topic
+	)
+{
+	pgm_return_val_if_fail (NULL != topic, NULL);
+	return topic->sock;
+}
+
+/* receive a topic, joining the group and port of its shard.  the receive socket is
+ * opened on the first subscription and bound to that shard's port.
+ *
+ * returns TRUE on success, returns FALSE on failure with error set.
+ */
+
+bool
+pgm_channel_subscribe (
+	pgm_channel_t*	restrict channel,
+	const char*	restrict topic,
+	pgm_error_t**	restrict error
+	)
+{
+	struct channel_sub_t* sub;
+	uint32_t shard, group;
+
+	pgm_return_val_if_fail (NULL != channel, FALSE);
+	pgm_return_val_if_fail (channel_is_topic (topic), FALSE);
+
+	pgm_rwlock_writer_lock (&channel->lock);
+	if (NULL != pgm_hashtable_lookup (channel->subs, topic)) {
+		pgm_rwlock_writer_unlock (&channel->lock);
+		return TRUE;
+	}
+	shard = pgm_channel_shard (channel, topic);
+	group = shard % channel->info.ci_groups;
+	if (NULL == channel->recv_sock) {
+		if (!channel_open (channel, shard, TRUE, &channel->recv_sock, error)) {
+			pgm_rwlock_writer_unlock (&channel->lock);
+			return FALSE;
+		}
+		channel->recv_shard = shard;
+		channel->group_subs[ group ]++;
+	} else if (0 == channel->shard_subs[ shard ] &&
+		   shard != channel->recv_shard)
+	{
+		const int dport = channel->info.ci_port + shard;
+		if (0 == channel->group_subs[ group ]) {
+			struct pgm_group_source_req gsr;
+			channel_group (channel, shard, &gsr);
+			if (!pgm_setsockopt (channel->recv_sock, IPPROTO_PGM, PGM_JOIN_GROUP, &gsr, sizeof (gsr))) {
+				pgm_rwlock_writer_unlock (&channel->lock);
+				pgm_set_error (error,
+					       PGM_ERROR_DOMAIN_SOCKET,
+					       PGM_ERROR_FAILED,
+					       _("Channel shard %u cannot join its group."), (unsigned)shard);
+				return FALSE;
+			}
+		}
+		pgm_setsockopt (channel->recv_sock, IPPROTO_PGM, PGM_JOIN_DPORT, &dport, sizeof (dport));
+		channel->group_subs[ group ]++;
+	}
+	channel->shard_subs[ shard ]++;
+
+	sub = pgm_new0 (struct channel_sub_t, 1);
+	sub->shard = shard;
+	strcpy (sub->name, topic);
+	pgm_hashtable_insert (channel->subs, sub->name, sub);
+	channel->sub_list = pgm_slist_prepend (channel->sub_list, sub);
+	pgm_rwlock_writer_unlock (&channel->lock);
+	return TRUE;
+}
+
+/* stop receiving a topic, leaving the port and group of its shard when no other
+ * subscription remains on them.  sessions of the bound port remain, filtered by topic.
+ * the name returned by pgm_channel_recv() for this topic is invalid after the call.
+ *
+ * returns TRUE on success, returns FALSE if the topic is not subscribed.
+ */
+
+bool
+pgm_channel_unsubscribe (
+	pgm_channel_t*	restrict channel,
+	const char*	restrict topic
+	)
+{
+	struct channel_sub_t* sub;
+	uint32_t shard, group;
+
+	pgm_return_val_if_fail (NULL != channel, FALSE);
+	pgm_return_val_if_fail (channel_is_topic (topic), FALSE);
+
+	pgm_rwlock_writer_lock (&channel->lock);
+	sub = pgm_hashtable_lookup (channel->subs, topic);
+	if (NULL == sub) {
+		pgm_rwlock_writer_unlock (&channel->lock);
+		return FALSE;
+	}
+	shard = sub->shard;
+	group = shard % channel->info.ci_groups;
+	pgm_hashtable_remove (channel->subs, sub->name);
+	channel->sub_list = pgm_slist_remove (channel->sub_list, sub);
+	pgm_free (sub);
+	if (0 == --channel->shard_subs[ shard ] &&
+	    shard != channel->recv_shard)
+	{
+		const int dport = channel->info.ci_port + shard;
+		pgm_setsockopt (channel->recv_sock, IPPROTO_PGM, PGM_LEAVE_DPORT, &dport, sizeof (dport));
+		if (0 == --channel->group_subs[ group ]) {
+			struct pgm_group_source_req gsr;
+			struct group_req gr;
+			channel_group (channel, shard, &gsr);
+			memset (&gr, 0, sizeof (gr));
+			gr.gr_interface = gsr.gsr_interface;
+			memcpy (&gr.gr_group, &gsr.gsr_group, sizeof (struct sockaddr_storage));
+			pgm_setsockopt (channel->recv_sock, IPPROTO_PGM, PGM_LEAVE_GROUP, &gr, sizeof (gr));
+		}
+	}
+	pgm_rwlock_writer_unlock (&channel->lock);
+	return TRUE;
+}
+
+/* receive one APDU of a subscribed topic, as pgm_recv() without the topic header.
+ * APDUs of other topics sharing a shard are discarded.  topic is set to the subscribed
+ * name, valid until unsubscribed.
+ *
+ * on success, returns PGM_IO_STATUS_NORMAL, otherwise the status of pgm_recvmsg().
+ */
+
+int
+pgm_channel_recv (
+	pgm_channel_t* const restrict	channel,
+	void*		     restrict	buf,
+	const size_t			buflen,
+	const int			flags,		/* MSG_DONTWAIT for non-blocking */
+	size_t*	       const restrict	bytes_read,	/* may be NULL */
+	const char**	     restrict	topic,		/* may be NULL */
+	pgm_error_t**	     restrict	error
+	)
+{
+	pgm_sock_t* sock;
+
+	pgm_return_val_if_fail (NULL != channel, PGM_IO_STATUS_ERROR);
+	if (PGM_LIKELY(buflen)) pgm_return_val_if_fail (NULL != buf, PGM_IO_STATUS_ERROR);
+
+	pgm_rwlock_reader_lock (&channel->lock);
+	sock = channel->recv_sock;
+	pgm_rwlock_reader_unlock (&channel->lock);
+	pgm_return_val_if_fail (NULL != sock, PGM_IO_STATUS_ERROR);
+
+	for (;;)
+	{
+		struct pgm_msgv_t msgv;
+		const struct channel_sub_t* sub;
+		char name[PGM_CHANNEL_MAX_TOPIC + 1];
+		size_t apdu_length, offset, bytes_copied = 0;
+		const int status = pgm_recvmsg (sock, &msgv, flags, &apdu_length, error);
+		if (PGM_IO_STATUS_NORMAL != status)
+			return status;
+
+		const struct pgm_sk_buff_t* skb = msgv.msgv_skb[0];
+		const uint8_t* header = skb->data;
+		if (PGM_UNLIKELY(0 == skb->len || 0 == header[0] || skb->len < 1u + header[0])) {
+			pgm_trace (PGM_LOG_ROLE_SESSION,_("Discarded APDU without channel topic."));
+			continue;
+		}
+		memcpy (name, &header[1], header[0]);
+		name[ header[0] ] = '\0';
+
+		pgm_rwlock_reader_lock (&channel->lock);
+		sub = pgm_hashtable_lookup (channel->subs, name);
+/* a publisher of another pool, or a topic sent on the wrong shard */
+		if (NULL != sub && channel->info.ci_port + sub->shard != pgm_ntohs (skb->pgm_header->pgm_dport))
+			sub = NULL;
+		if (NULL != topic && NULL != sub)
+			*topic = sub->name;
+		pgm_rwlock_reader_unlock (&channel->lock);
+		if (NULL == sub)
+			continue;
+
+		offset = 1 + header[0];
+		for (uint32_t i = 0; i < msgv.msgv_len && bytes_copied < buflen; i++) {
+			skb = msgv.msgv_skb[i];
+			size_t copy_len = skb->len - offset;
+			if (bytes_copied + copy_len > buflen) {
+				pgm_warn (_("APDU truncated, original length %" PRIzu " bytes."),
+					apdu_length - (1 + header[0]));
+				copy_len = buflen - bytes_copied;
+			}
+			memcpy ((char*)buf + bytes_copied, (const char*)skb->data + offset, copy_len);
+			bytes_copied += copy_len;
+			offset = 0;
+		}
+		if (NULL != bytes_read)
+			*bytes_read = bytes_copied;
+		return PGM_IO_STATUS_NORMAL;
+	}
+}
+
+/* receive socket of the channel, NULL before the first subscription.  for
+ * pgm_poll_info(), pgm_select_info() and pgm_getsockopt().
+ */
+
+pgm_sock_t*
+pgm_channel_recv_sock (
+	pgm_channel_t* const		channel
+	)
+{
+	pgm_sock_t* sock;
+
+	pgm_return_val_if_fail (NULL != channel, NULL);
+
+	pgm_rwlock_reader_lock (&channel->lock);
+	sock = channel->recv_sock;
+	pgm_rwlock_reader_unlock (&channel->lock);
+	return sock;
+}
+
+/* eof */
@@ -0,0 +1,582 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * unit tests for topics sharded over a pool of multicast groups and ports.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <check.h>
+
+#ifdef _WIN32
+#	define PGM_CHECK_NOFORK		1
+#endif
+
+
+/* mock state */
+
+#define MOCK_SOCKS		16
+
+struct mock_sock_t {
+	void*				sock;
+	uint16_t			dport;
+	bool				is_recv_only;
+	bool				is_connected;
+	void*				stream_sock;
+	struct sockaddr_storage		send_group;
+	unsigned			joins;
+	unsigned			leaves;
+	unsigned			join_dports;
+	unsigned			leave_dports;
+};
+
+static struct mock_sock_t mock_socks[MOCK_SOCKS];
+static unsigned mock_socks_len = 0;
+static char mock_sent[1024];
+static size_t mock_sent_len = 0;
+static const char* mock_recv_apdus[8];
+static uint16_t mock_recv_dports[8];
+static unsigned mock_recv_head = 0, mock_recv_tail = 0;
+
+#define pgm_socket		mock_pgm_socket
+#define pgm_bind3		mock_pgm_bind3
+#define pgm_setsockopt		mock_pgm_setsockopt
+#define pgm_connect		mock_pgm_connect
+#define pgm_close		mock_pgm_close
+#define pgm_sendv		mock_pgm_sendv
+#define pgm_recvmsg		mock_pgm_recvmsg
+
+#define CHANNEL_DEBUG
+#include "channel.c"
+
+
+static
+void
+mock_setup (void)
+{
+	memset (mock_socks, 0, sizeof (mock_socks));
+	mock_socks_len = 0;
+	mock_sent_len = 0;
+	mock_recv_head = mock_recv_tail = 0;
+}
+
+static
+void
+mock_teardown (void)
+{
+// null
+}
+
+static
+struct mock_sock_t*
+mock_find (
+	const pgm_sock_t*	sock
+	)
+{
+	for (unsigned i = 0; i < mock_socks_len; i++)
+		if (sock == mock_socks[i].sock)
+			return &mock_socks[i];
+	return NULL;
+}
+
+static
+void
+mock_queue (
+	const char*	apdu,		/* length, topic, payload */
+	const uint16_t	dport
+	)
+{
+	mock_recv_apdus[ mock_recv_tail ] = apdu;
+	mock_recv_dports[ mock_recv_tail++ ] = dport;
+}
+
+/* first of a list of generated topic names on the wanted shard.
+ */
+
+static
+const char*
+mock_topic (
+	const pgm_channel_t*	channel,
+	const uint32_t		shard,
+	const unsigned		skip,
+	char*			name
+	)
+{
+	unsigned found = 0;
+	for (unsigned i = 0; i < 100000; i++) {
+		sprintf (name, "topic.%u", i);
+		if (shard == pgm_channel_shard (channel, name) && found++ == skip)
+			return name;
+	}
+	return NULL;
+}
+
+static
+pgm_channel_t*
+generate_channel (
+	const uint32_t		groups,
+	const uint32_t		shards
+	)
+{
+	struct pgm_channel_info_t ci;
+	struct sockaddr_in* sin = (struct sockaddr_in*)&ci.ci_group;
+	pgm_channel_t* channel = NULL;
+
+	memset (&ci, 0, sizeof (ci));
+	sin->sin_family = AF_INET;
+	sin->sin_addr.s_addr = inet_addr ("239.192.0.1");
+	ci.ci_groups = groups;
+	ci.ci_shards = shards;
+	ci.ci_port = 7500;
+	ci.ci_protocol = IPPROTO_PGM;
+	fail_unless (TRUE == pgm_channel_create (&channel, &ci, NULL), "create failed");
+	return channel;
+}
+
+/* mock functions for external references */
+
+bool
+mock_pgm_socket (
+	pgm_sock_t**	 restrict sock,
+	const sa_family_t	  family,
+	const int		  pgm_sock_type,
+	const int		  protocol,
+	pgm_error_t**	 restrict error
+	)
+{
+	struct mock_sock_t* mock = &mock_socks[ mock_socks_len++ ];
+	mock->sock = pgm_malloc0 (sizeof (int));	/* opaque */
+	*sock = mock->sock;
+	return TRUE;
+}
+
+bool
+mock_pgm_bind3 (
+	pgm_sock_t*			 restrict sock,
+	const struct pgm_sockaddr_t*const restrict sockaddr,
+	const socklen_t				   sockaddrlen,
+	const struct pgm_interface_req_t*const	   send_req,
+	const socklen_t				   send_req_len,
+	const struct pgm_interface_req_t*const	   recv_req,
+	const socklen_t				   recv_req_len,
+	pgm_error_t**			 restrict error
+	)
+{
+	mock_find (sock)->dport = sockaddr->sa_port;
+	return TRUE;
+}
+
+bool
+mock_pgm_setsockopt (
+	pgm_sock_t* const restrict	sock,
+	const int			level,
+	const int			optname,
+	const void*	  restrict	optval,
+	const socklen_t			optlen
+	)
+{
+	struct mock_sock_t* mock = mock_find (sock);
+	switch (optname) {
+	case PGM_RECV_ONLY:	mock->is_recv_only = *(const int*)optval; break;
+	case PGM_STREAM_GROUP:	mock->stream_sock = ((const struct pgm_stream_req_t*)optval)->sr_sock; break;
+	case PGM_SEND_GROUP:	memcpy (&mock->send_group, &((const struct pgm_group_source_req*)optval)->gsr_group, sizeof (struct sockaddr_storage)); break;
+	case PGM_JOIN_GROUP:	mock->joins++; break;
+	case PGM_LEAVE_GROUP:	mock->leaves++; break;
+	case PGM_JOIN_DPORT:	mock->join_dports++; break;
+	case PGM_LEAVE_DPORT:	mock->leave_dports++; break;
+	default: break;
+	}
+	return TRUE;
+}
+
+bool
+mock_pgm_connect (
+	pgm_sock_t*   restrict sock,
+	pgm_error_t** restrict error
+	)
+{
+	mock_find (sock)->is_connected = TRUE;
+	return TRUE;
+}
+
+bool
+mock_pgm_close (
+	pgm_sock_t*	sock,
+	bool		flush
+	)
+{
+	pgm_free (sock);
+	return TRUE;
+}
+
+int
+mock_pgm_sendv (
+	pgm_sock_t*		const restrict sock,
+	const struct pgm_iovec* const restrict vector,
+	const unsigned			       count,
+	const bool			       is_one_apdu,
+	size_t*			      restrict bytes_written
+	)
+{
+	mock_sent_len = 0;
+	for (unsigned i = 0; i < count; i++) {
+		memcpy (mock_sent + mock_sent_len, vector[i].iov_base, vector[i].iov_len);
+		mock_sent_len += vector[i].iov_len;
+	}
+	*bytes_written = mock_sent_len;
+	return PGM_IO_STATUS_NORMAL;
+}
+
+int
+mock_pgm_recvmsg (
+	pgm_sock_t*	   const restrict sock,
+	struct pgm_msgv_t* const restrict msgv,
+	const int			  flags,
+	size_t*			 restrict bytes_read,
+	pgm_error_t**		 restrict error
+	)
+{
+	static struct pgm_sk_buff_t skb;
+	static struct pgm_header header;
+
+	if (mock_recv_head == mock_recv_tail)
+		return PGM_IO_STATUS_WOULD_BLOCK;
+	memset (&skb, 0, sizeof (skb));
+	header.pgm_dport = htons (mock_recv_dports[ mock_recv_head ]);
+	skb.pgm_header = &header;
+	skb.data = (void*)mock_recv_apdus[ mock_recv_head ];
+	skb.len = (uint16_t)strlen (mock_recv_apdus[ mock_recv_head++ ]);
+	msgv->msgv_len = 1;
+	msgv->msgv_skb[0] = &skb;
+	*bytes_read = skb.len;
+	return PGM_IO_STATUS_NORMAL;
+}
+
+
+/* target:
+ *	uint32_t
+ *	pgm_channel_shard (
+ *		const pgm_channel_t*	channel,
+ *		const char*		topic
+ *	)
+ */
+
+START_TEST (test_shard_pass_001)
+{
+	pgm_channel_t* channel = generate_channel (4, 1000);
+/* 32-bit FNV-1a "a" = 0xe40c292c */
+	fail_unless (0xe40c292c % 1000 == pgm_channel_shard (channel, "a"), "shard mismatch");
+	fail_unless (0x811c9dc5 % 1000 == pgm_channel_shard (channel, ""), "shard mismatch");
+	for (unsigned i = 0; i < 1000; i++) {
+		char name[32];
+		sprintf (name, "topic.%u", i);
+		fail_unless (pgm_channel_shard (channel, name) < 1000, "shard out of range");
+	}
+	fail_unless (TRUE == pgm_channel_destroy (channel, FALSE), "destroy failed");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_channel_create (
+ *		pgm_channel_t**				channel,
+ *		const struct pgm_channel_info_t*	ci,
+ *		pgm_error_t**				error
+ *	)
+ */
+
+START_TEST (test_create_fail_001)
+{
+	struct pgm_channel_info_t ci;
+	struct sockaddr_in* sin = (struct sockaddr_in*)&ci.ci_group;
+	pgm_channel_t* channel = NULL;
+	pgm_error_t* err = NULL;
+
+	memset (&ci, 0, sizeof (ci));
+	sin->sin_family = AF_INET;
+	sin->sin_addr.s_addr = inet_addr ("192.168.0.1");
+	ci.ci_groups = 1;
+	ci.ci_shards = 4;
+	ci.ci_port = 7500;
+	ci.ci_protocol = IPPROTO_PGM;
+	fail_unless (FALSE == pgm_channel_create (&channel, &ci, &err), "create succeeded on unicast");
+	fail_unless (NULL != err, "error not set");
+	pgm_error_free (err);
+	sin->sin_addr.s_addr = inet_addr ("239.192.0.1");
+	ci.ci_groups = 8;
+	fail_unless (FALSE == pgm_channel_create (&channel, &ci, NULL), "create succeeded with fewer shards than groups");
+	ci.ci_groups = 1;
+	ci.ci_port = UINT16_MAX - 2;
+	fail_unless (FALSE == pgm_channel_create (&channel, &ci, NULL), "create succeeded past last port");
+	fail_unless (NULL == channel, "channel set");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_channel_publish (
+ *		pgm_channel_t*		channel,
+ *		const char*		topic,
+ *		pgm_topic_t**		handle,
+ *		pgm_error_t**		error
+ *	)
+ */
+
+/* one source per shard, later sources join the stream group of the first */
+START_TEST (test_publish_pass_001)
+{
+	pgm_channel_t* channel = generate_channel (4, 16);
+	pgm_topic_t *t1, *t2, *t3;
+	char n1[32], n2[32], n3[32];
+
+	fail_if (NULL == mock_topic (channel, 5, 0, n1), "no topic");
+	fail_if (NULL == mock_topic (channel, 5, 1, n2), "no topic");
+	fail_if (NULL == mock_topic (channel, 6, 0, n3), "no topic");
+	fail_unless (TRUE == pgm_channel_publish (channel, n1, &t1, NULL), "publish failed");
+	fail_unless (TRUE == pgm_channel_publish (channel, n2, &t2, NULL), "publish failed");
+	fail_unless (1 == mock_socks_len, "shard opened twice");
+	fail_unless (pgm_topic_sock (t1) == pgm_topic_sock (t2), "shard socket mismatch");
+	fail_unless (7505 == mock_socks[0].dport, "port mismatch");
+	fail_unless (!mock_socks[0].is_recv_only && mock_socks[0].is_connected, "source not connected");
+	fail_unless (NULL == mock_socks[0].stream_sock, "first source in a stream group");
+	fail_unless (htonl (ntohl (inet_addr ("239.192.0.1")) + 1) == ((struct sockaddr_in*)&mock_socks[0].send_group)->sin_addr.s_addr, "group mismatch");
+	fail_unless (TRUE == pgm_channel_publish (channel, n3, &t3, NULL), "publish failed");
+	fail_unless (2 == mock_socks_len, "shard not opened");
+	fail_unless (mock_socks[0].sock == mock_socks[1].stream_sock, "stream group mismatch");
+	fail_unless (7506 == mock_socks[1].dport, "port mismatch");
+	fail_unless (TRUE == pgm_channel_publish (channel, n1, &t2, NULL), "publish failed");
+	fail_unless (t1 == t2, "handle not reused");
+	fail_unless (TRUE == pgm_channel_destroy (channel, FALSE), "destroy failed");
+}
+END_TEST
+
+START_TEST (test_publish_fail_001)
+{
+	pgm_channel_t* channel = generate_channel (1, 1);
+	pgm_topic_t* topic;
+	char name[PGM_CHANNEL_MAX_TOPIC + 2];
+	memset (name, 'x', sizeof (name) - 1);
+	name[ sizeof (name) - 1 ] = '\0';
+	fail_unless (FALSE == pgm_channel_publish (channel, "", &topic, NULL), "publish succeeded");
+	fail_unless (FALSE == pgm_channel_publish (channel, name, &topic, NULL), "publish succeeded");
+	fail_unless (0 == mock_socks_len, "shard opened");
+	fail_unless (TRUE == pgm_channel_destroy (channel, FALSE), "destroy failed");
+}
+END_TEST
+
+/* target:
+ *	int
+ *	pgm_topic_send (
+ *		pgm_topic_t*		topic,
+ *		const void*		apdu,
+ *		const size_t		apdu_length,
+ *		size_t*			bytes_written
+ *	)
+ */
+
+START_TEST (test_send_pass_001)
+{
+	pgm_channel_t* channel = generate_channel (1, 4);
+	pgm_topic_t* topic;
+	size_t bytes_written = 0;
+
+	fail_unless (TRUE == pgm_channel_publish (channel, "VOD.L", &topic, NULL), "publish failed");
+	fail_unless (PGM_IO_STATUS_NORMAL == pgm_topic_send (topic, "123.4", 5, &bytes_written), "send failed");
+	fail_unless (5 == bytes_written, "bytes mismatch");
+	fail_unless (11 == mock_sent_len, "APDU length mismatch");
+	fail_unless (0 == memcmp ("\005VOD.L123.4", mock_sent, 11), "APDU mismatch");
+	fail_unless (PGM_IO_STATUS_NORMAL == pgm_topic_send (topic, NULL, 0, &bytes_written), "send failed");
+	fail_unless (0 == bytes_written, "bytes mismatch");
+	fail_unless (6 == mock_sent_len, "APDU length mismatch");
+	fail_unless (TRUE == pgm_channel_destroy (channel, FALSE), "destroy failed");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_channel_subscribe (
+ *		pgm_channel_t*		channel,
+ *		const char*		topic,
+ *		pgm_error_t**		error
+ *	)
+ */
+
+/* groups and ports are joined only for subscribed shards */
+START_TEST (test_subscribe_pass_001)
+{
+	pgm_channel_t* channel = generate_channel (4, 16);
+	char n1[32], n2[32], n3[32], n4[32];
+
+	fail_if (NULL == mock_topic (channel, 1, 0, n1), "no topic");
+	fail_if (NULL == mock_topic (channel, 1, 1, n2), "no topic");
+	fail_if (NULL == mock_topic (channel, 5, 0, n3), "no topic");	/* group of shard 1 */
+	fail_if (NULL == mock_topic (channel, 6, 0, n4), "no topic");
+	fail_unless (TRUE == pgm_channel_subscribe (channel, n1, NULL), "subscribe failed");
+	fail_unless (1 == mock_socks_len, "receive socket not opened");
+	fail_unless (pgm_channel_recv_sock (channel) == mock_socks[0].sock, "receive socket mismatch");
+	fail_unless (mock_socks[0].is_recv_only && mock_socks[0].is_connected, "receive socket not connected");
+	fail_unless (7501 == mock_socks[0].dport, "port mismatch");
+	fail_unless (1 == mock_socks[0].joins, "joins mismatch");
+	fail_unless (TRUE == pgm_channel_subscribe (channel, n2, NULL), "subscribe failed");
+	fail_unless (TRUE == pgm_channel_subscribe (channel, n1, NULL), "subscribe failed");
+	fail_unless (1 == mock_socks[0].joins && 0 == mock_socks[0].join_dports, "shard joined twice");
+	fail_unless (TRUE == pgm_channel_subscribe (channel, n3, NULL), "subscribe failed");
+	fail_unless (1 == mock_socks[0].joins && 1 == mock_socks[0].join_dports, "joins mismatch");
+	fail_unless (TRUE == pgm_channel_subscribe (channel, n4, NULL), "subscribe failed");
+	fail_unless (2 == mock_socks[0].joins && 2 == mock_socks[0].join_dports, "joins mismatch");
+	fail_unless (1 == mock_socks_len, "socket opened per shard");
+
+/* target:
+ *	bool
+ *	pgm_channel_unsubscribe (
+ *		pgm_channel_t*		channel,
+ *		const char*		topic
+ *	)
+ */
+	fail_unless (TRUE == pgm_channel_unsubscribe (channel, n4), "unsubscribe failed");
+	fail_unless (1 == mock_socks[0].leaves && 1 == mock_socks[0].leave_dports, "leaves mismatch");
+	fail_unless (FALSE == pgm_channel_unsubscribe (channel, n4), "unsubscribe succeeded");
+	fail_unless (TRUE == pgm_channel_unsubscribe (channel, n3), "unsubscribe failed");
+	fail_unless (1 == mock_socks[0].leaves && 2 == mock_socks[0].leave_dports, "group of bound port left");
+	fail_unless (TRUE == pgm_channel_unsubscribe (channel, n1), "unsubscribe failed");
+	fail_unless (TRUE == pgm_channel_unsubscribe (channel, n2), "unsubscribe failed");
+	fail_unless (1 == mock_socks[0].leaves && 2 == mock_socks[0].leave_dports, "bound port left");
+	fail_unless (TRUE == pgm_channel_destroy (channel, FALSE), "destroy failed");
+}
+END_TEST
+
+/* target:
+ *	int
+ *	pgm_channel_recv (
+ *		pgm_channel_t*		channel,
+ *		void*			buf,
+ *		const size_t		buflen,
+ *		const int		flags,
+ *		size_t*			bytes_read,
+ *		const char**		topic,
+ *		pgm_error_t**		error
+ *	)
+ */
+
+/* unsubscribed topics and topics on a foreign port are discarded */
+START_TEST (test_recv_pass_001)
+{
+	pgm_channel_t* channel = generate_channel (1, 1);
+	const char* topic = NULL;
+	char buf[64];
+	size_t bytes_read = 0;
+
+	fail_unless (TRUE == pgm_channel_subscribe (channel, "VOD.L", NULL), "subscribe failed");
+	mock_queue ("\004BP.L100", 7500);
+	mock_queue ("\005VOD.L123.4", 7501);
+	mock_queue ("\005VOD.L", 7500);
+	mock_queue ("\005VOD.L123.4", 7500);
+	fail_unless (PGM_IO_STATUS_NORMAL == pgm_channel_recv (channel, buf, sizeof (buf), MSG_DONTWAIT, &bytes_read, &topic, NULL), "recv failed");
+	fail_unless (0 == bytes_read, "bytes mismatch");
+	fail_unless (0 == strcmp ("VOD.L", topic), "topic mismatch");
+	fail_unless (PGM_IO_STATUS_NORMAL == pgm_channel_recv (channel, buf, sizeof (buf), MSG_DONTWAIT, &bytes_read, &topic, NULL), "recv failed");
+	fail_unless (5 == bytes_read, "bytes mismatch");
+	fail_unless (0 == memcmp ("123.4", buf, 5), "APDU mismatch");
+	fail_unless (PGM_IO_STATUS_WOULD_BLOCK == pgm_channel_recv (channel, buf, sizeof (buf), MSG_DONTWAIT, &bytes_read, &topic, NULL), "recv not blocked");
+/* truncated */
+	mock_queue ("\005VOD.L123.4", 7500);
+	fail_unless (PGM_IO_STATUS_NORMAL == pgm_channel_recv (channel, buf, 2, MSG_DONTWAIT, &bytes_read, NULL, NULL), "recv failed");
+	fail_unless (2 == bytes_read, "bytes mismatch");
+	fail_unless (TRUE == pgm_channel_destroy (channel, FALSE), "destroy failed");
+}
+END_TEST
+
+START_TEST (test_recv_fail_001)
+{
+	pgm_channel_t* channel = generate_channel (1, 1);
+	char buf[64];
+	fail_unless (PGM_IO_STATUS_ERROR == pgm_channel_recv (channel, buf, sizeof (buf), MSG_DONTWAIT, NULL, NULL, NULL), "recv succeeded without subscription");
+	fail_unless (TRUE == pgm_channel_destroy (channel, FALSE), "destroy failed");
+}
+END_TEST
+
+
+static
+Suite*
+make_test_suite (void)
+{
+	Suite* s;
+
+	s = suite_create (__FILE__);
+
+	TCase* tc_shard = tcase_create ("shard");
+	suite_add_tcase (s, tc_shard);
+	tcase_add_checked_fixture (tc_shard, mock_setup, mock_teardown);
+	tcase_add_test (tc_shard, test_shard_pass_001);
+
+	TCase* tc_create = tcase_create ("create");
+	suite_add_tcase (s, tc_create);
+	tcase_add_checked_fixture (tc_create, mock_setup, mock_teardown);
+	tcase_add_test (tc_create, test_create_fail_001);
+
+	TCase* tc_publish = tcase_create ("publish");
+	suite_add_tcase (s, tc_publish);
+	tcase_add_checked_fixture (tc_publish, mock_setup, mock_teardown);
+	tcase_add_test (tc_publish, test_publish_pass_001);
+	tcase_add_test (tc_publish, test_publish_fail_001);
+
+	TCase* tc_send = tcase_create ("send");
+	suite_add_tcase (s, tc_send);
+	tcase_add_checked_fixture (tc_send, mock_setup, mock_teardown);
+	tcase_add_test (tc_send, test_send_pass_001);
+
+	TCase* tc_subscribe = tcase_create ("subscribe");
+	suite_add_tcase (s, tc_subscribe);
+	tcase_add_checked_fixture (tc_subscribe, mock_setup, mock_teardown);
+	tcase_add_test (tc_subscribe, test_subscribe_pass_001);
+
+	TCase* tc_recv = tcase_create ("recv");
+	suite_add_tcase (s, tc_recv);
+	tcase_add_checked_fixture (tc_recv, mock_setup, mock_teardown);
+	tcase_add_test (tc_recv, test_recv_pass_001);
+	tcase_add_test (tc_recv, test_recv_fail_001);
+	return s;
+}
+
+static
+Suite*
+make_master_suite (void)
+{
+	Suite* s = suite_create ("Master");
+	return s;
+}
+
+int
+main (void)
+{
+	pgm_messages_init();
+	SRunner* sr = srunner_create (make_master_suite ());
+	srunner_add_suite (sr, make_test_suite ());
+	srunner_run_all (sr, CK_ENV);
+	int number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	pgm_messages_shutdown();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof */
@@ -41,9 +41,12 @@
 
 #ifdef _MSC_VER
 #	include <intrin.h>
-#else
+#elif defined(__i386__) || defined(__x86_64__)
 #	include <x86intrin.h>
 #endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#	include <arm_neon.h>
+#endif
 
 
 /* locals */
@@ -87,10 +90,24 @@ static uint16_t do_csum_avx2 (const void*, uint16_t, uint32_t) PGM_GNUC_PURE;
 /* F16C (SSE5) - Floating point conversion. */
 /* XOP - Extended operations. including integer FMA. horizontal arithmetic. */
 /* FMA - Fused multiply-add. */
-/* AVX-512 - Adds 512-bit operands. */
+/* AVX-512 - Adds 512-bit operands, BW extends byte and word operations to them. */
+#if defined(__AVX512BW__) || (defined(_MSC_VER) && (_MSC_VER >= 1920) && defined(_M_X64))
+static uint16_t do_csum_avx512 (const void*, uint16_t, uint32_t) PGM_GNUC_PURE;
+#endif
+/* NEON - ARM Advanced SIMD, mandatory on AArch64. */
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+static uint16_t do_csum_neon (const void*, uint16_t, uint32_t) PGM_GNUC_PURE;
+#endif
 
 static uint16_t (*do_csum) (const void*, uint16_t, uint32_t) = NULL;
-static uint32_t (*do_csumcpy) (const void* restrict src, void* restrict dst, uint16_t len, uint32_t csum) = NULL;
+/* checksums of at most PGM_CSUM_SMALL_LEN bytes, do_csum unless calibrated */
+static uint16_t (*do_csum_small) (const void*, uint16_t, uint32_t) = NULL;
+static uint16_t (*do_csumcpy) (const void* restrict src, void* restrict dst, uint16_t len, uint32_t csum) = NULL;
+/* streaming store checksum-copy, NULL where unsupported */
+static uint16_t (*do_csumcpy_nt) (const void* restrict src, void* restrict dst, uint16_t len, uint32_t csum) = NULL;
+
+/* copies from this size bypass the cache, smaller copies are left to do_csumcpy */
+#define PGM_CSUM_NT_THRESHOLD	1024
 
 /* Explicitly protecting against alignment issues, so hush compiler. */
 #if (__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 6) || defined(__clang__)
@@ -1411,7 +1428,7 @@ do_csumcpy_avx2 (
 
 		sum = _mm256_add_epi32 (sum, lo);
 		sum = _mm256_add_epi32 (sum, hi);
-		_mm256_store_si256((__m256i*)dstbuf, tmp);
+		_mm256_storeu_si256((__m256i*)dstbuf, tmp);		// destination alignment may differ
 		srcbuf = &srcbuf[ 32 ];
 		dstbuf = &dstbuf[ 32 ];
 	}
@@ -1449,19 +1466,446 @@ do_csumcpy_avx2 (
 		acc = ((acc & 0xff) << 8) | ((acc & 0xff00) >> 8);
 	return (uint16_t)acc;
 }
+/* as do_csumcpy_avx2 with non-temporal stores: the destination is aligned
+ * rather than the source, and stores are fenced before the buffer is handed
+ * to the kernel or another thread.
+ */
+
+static
+uint16_t
+do_csumcpy_nt_avx2 (
+	const void* restrict srcaddr,
+	void* restrict	     dstaddr,
+	uint16_t	     len,
+	uint32_t	     csum
+	)
+{
+	uint64_t acc = csum;		/* fixed size for asm */
+	const uint8_t*restrict srcbuf = (const uint8_t*restrict)srcaddr;
+	uint8_t*restrict dstbuf = (uint8_t*restrict)dstaddr;
+	uint16_t remainder = 0;		/* fixed size for endian swap */
+	uint_fast16_t count2;
+	uint_fast16_t count32;
+	bool is_odd;
+
+	if (PGM_UNLIKELY(len == 0))
+		return (uint16_t)acc;
+	pgm_prefetch (srcbuf);
+/* align first byte */
+	is_odd = ((uintptr_t)dstbuf & 1);
+	if (PGM_UNLIKELY(is_odd)) {
+		((uint8_t*restrict)&remainder)[1] = *dstbuf++ = *srcbuf++;
+		len--;
+	}
+/* drain upto 30-bytes to align destination on 256-bit strides */
+	count2 = ((0x20 - ((uintptr_t)dstbuf & 0x1f)) & 0x1f) >> 1;
+	while (len > 1 && count2--) {
+		acc += ((uint16_t*restrict)dstbuf)[ 0 ] = ((const uint16_t*restrict)srcbuf)[ 0 ];
+		srcbuf = &srcbuf[ 2 ];
+		dstbuf = &dstbuf[ 2 ];
+		len -= 2;
+	}
+/* 256-bit, 32-byte stride */
+	count32 = len >> 5;
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i sum = zero;
+	while (count32--) {
+		const __m256i tmp = _mm256_loadu_si256 ((const __m256i*)srcbuf);
+		sum = _mm256_add_epi32 (sum, _mm256_unpacklo_epi16 (tmp, zero));
+		sum = _mm256_add_epi32 (sum, _mm256_unpackhi_epi16 (tmp, zero));
+		_mm256_stream_si256 ((__m256i*)dstbuf, tmp);
+		srcbuf = &srcbuf[ 32 ];
+		dstbuf = &dstbuf[ 32 ];
+	}
+	_mm_sfence();
+
+// add all 32-bit components together
+	sum = _mm256_add_epi32 (sum, _mm256_srli_si256 (sum, 8));
+	sum = _mm256_add_epi32 (sum, _mm256_srli_si256 (sum, 4));
+#ifndef _MSC_VER
+	acc += _mm256_extract_epi32 (sum, 0) + _mm256_extract_epi32 (sum, 4);
+#else
+	{
+		__m128i __Y1 = _mm256_extractf128_si256 (sum, 0 >> 2);
+		__m128i __Y2 = _mm256_extractf128_si256 (sum, 4 >> 2);
+		acc += _mm_extract_epi32 (__Y1, 0 % 4) + _mm_extract_epi32 (__Y2, 4 % 4);
+	}
+#endif
+	len %= 32;
+/* final 31 bytes */
+	count2 = len >> 1;
+	while (count2--) {
+		acc += ((uint16_t*restrict)dstbuf)[ 0 ] = ((const uint16_t*restrict)srcbuf)[ 0 ];
+		srcbuf = &srcbuf[ 2 ];
+		dstbuf = &dstbuf[ 2 ];
+	}
+/* trailing odd byte */
+	if (len & 1) {
+		((uint8_t*restrict)&remainder)[0] = *dstbuf = *srcbuf;
+	}
+	acc += remainder;
+	acc  = (acc >> 32) + (acc & 0xffffffff);
+	acc  = (acc >> 16) + (acc & 0xffff);
+	acc  = (acc >> 16) + (acc & 0xffff);
+	acc += (acc >> 16);
+	if (PGM_UNLIKELY(is_odd))
+		acc = ((acc & 0xff) << 8) | ((acc & 0xff00) >> 8);
+	return (uint16_t)acc;
+}
 #endif
 
-/* TBD: AVX-512 for Skylake and newer architectures.
- *
- *	_mm512_setzero_si512()
- *	_mm512_load_si512()		- 64-byte alignment
- *	_mm512_unpacklo_epi16()
- *	_mm512_unpackhi_epi16()
- *	_mm512_add_epi32()
- *	_mm512_srli_si512()
- *	_mm512_extract_epi32()
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+static
+uint16_t
+do_csum_neon (
+	const void*	addr,
+	uint16_t	len,
+	uint32_t	csum
+	)
+{
+	uint_fast64_t acc = csum;
+	const uint8_t* buf = (const uint8_t*)addr;
+	uint16_t remainder = 0;			/* fixed size for endian swap */
+	uint_fast16_t count2;
+	uint_fast16_t count16;
+	bool is_odd;
+
+	if (PGM_UNLIKELY(len == 0))
+		return (uint16_t)acc;
+/* align first byte */
+	is_odd = ((uintptr_t)buf & 1);
+	if (PGM_UNLIKELY(is_odd)) {
+		((uint8_t*)&remainder)[1] = *buf++;
+		len--;
+	}
+/* drain upto 14-bytes to align on 128-bit strides */
+	count2 = (0x10 - ((uintptr_t)buf & 0xf)) >> 1;
+	while (len > 1 && count2--) {
+		acc += ((const uint16_t*)buf)[ 0 ];
+		buf += 2;
+		len -= 2;
+	}
+/* 128-bit, 16-byte stride */
+	count16 = len >> 4;
+	uint32x4_t sum = vdupq_n_u32 (0);
+	while (count16--) {
+		const uint16x8_t tmp = vld1q_u16 ((const uint16_t*)buf);	// load 8×16-bit
+		sum = vpadalq_u16 (sum, tmp);	// pairwise add 8×16-bit into 4×32-bit
+		buf += 16;
+	}
+/* add all 32-bit components together, widening to avoid overflow */
+	const uint64x2_t sum64 = vpaddlq_u32 (sum);
+	acc += vgetq_lane_u64 (sum64, 0) + vgetq_lane_u64 (sum64, 1);
+	len %= 16;
+/* final 15 bytes */
+	count2 = len >> 1;
+	while (count2--) {
+		acc += ((const uint16_t*)buf)[ 0 ];
+		buf += 2;
+	}
+/* trailing odd byte */
+	if (len & 1) {
+		((uint8_t*)&remainder)[0] = *buf;
+	}
+	acc += remainder;
+	acc  = (acc >> 32) + (acc & 0xffffffff);
+	acc  = (acc >> 16) + (acc & 0xffff);
+	acc  = (acc >> 16) + (acc & 0xffff);
+	acc += (acc >> 16);
+	if (PGM_UNLIKELY(is_odd))
+		acc = ((acc & 0xff) << 8) | ((acc & 0xff00) >> 8);
+	return (uint16_t)acc;
+}
+
+static
+uint16_t
+do_csumcpy_neon (
+	const void* restrict srcaddr,
+	void* restrict	     dstaddr,
+	uint16_t	     len,
+	uint32_t	     csum
+	)
+{
+	uint_fast64_t acc = csum;
+	const uint8_t*restrict srcbuf = (const uint8_t*restrict)srcaddr;
+	uint8_t*restrict dstbuf = (uint8_t*restrict)dstaddr;
+	uint16_t remainder = 0;			/* fixed size for endian swap */
+	uint_fast16_t count2;
+	uint_fast16_t count16;
+	bool is_odd;
+
+	if (PGM_UNLIKELY(len == 0))
+		return (uint16_t)acc;
+	pgm_prefetch (srcbuf);
+	pgm_prefetchw (dstbuf);
+/* align first byte */
+	is_odd = ((uintptr_t)srcbuf & 1);
+	if (PGM_UNLIKELY(is_odd)) {
+		((uint8_t*restrict)&remainder)[1] = *dstbuf++ = *srcbuf++;
+		len--;
+	}
+/* drain upto 14-bytes to align on 128-bit strides */
+	count2 = (0x10 - ((uintptr_t)srcbuf & 0xf)) >> 1;
+	while (len > 1 && count2--) {
+		acc += ((uint16_t*restrict)dstbuf)[ 0 ] = ((const uint16_t*restrict)srcbuf)[ 0 ];
+		srcbuf = &srcbuf[ 2 ];
+		dstbuf = &dstbuf[ 2 ];
+		len -= 2;
+	}
+/* 128-bit, 16-byte stride */
+	count16 = len >> 4;
+	uint32x4_t sum = vdupq_n_u32 (0);
+	while (count16--) {
+		const uint16x8_t tmp = vld1q_u16 ((const uint16_t*)srcbuf);
+		sum = vpadalq_u16 (sum, tmp);
+		vst1q_u16 ((uint16_t*)dstbuf, tmp);
+		srcbuf = &srcbuf[ 16 ];
+		dstbuf = &dstbuf[ 16 ];
+	}
+	const uint64x2_t sum64 = vpaddlq_u32 (sum);
+	acc += vgetq_lane_u64 (sum64, 0) + vgetq_lane_u64 (sum64, 1);
+	len %= 16;
+/* final 15 bytes */
+	count2 = len >> 1;
+	while (count2--) {
+		acc += ((uint16_t*restrict)dstbuf)[ 0 ] = ((const uint16_t*restrict)srcbuf)[ 0 ];
+		srcbuf = &srcbuf[ 2 ];
+		dstbuf = &dstbuf[ 2 ];
+	}
+/* trailing odd byte */
+	if (len & 1) {
+		((uint8_t*restrict)&remainder)[0] = *dstbuf = *srcbuf;
+	}
+	acc += remainder;
+	acc  = (acc >> 32) + (acc & 0xffffffff);
+	acc  = (acc >> 16) + (acc & 0xffff);
+	acc  = (acc >> 16) + (acc & 0xffff);
+	acc += (acc >> 16);
+	if (PGM_UNLIKELY(is_odd))
+		acc = ((acc & 0xff) << 8) | ((acc & 0xff00) >> 8);
+	return (uint16_t)acc;
+}
+#endif
+
+#if defined(__AVX512BW__) || (defined(_MSC_VER) && (_MSC_VER >= 1920) && defined(_M_X64))
+/* 512-bit, 64-byte stride.  16-bit words are zero extended into 32-bit lanes,
+ * at most 2048 additions per lane for a 64KB buffer so lanes cannot overflow.
+ */
+
+static inline
+uint64_t
+_pgm_csum_reduce_avx512 (
+	const __m512i	sum
+	)
+{
+/* widen before the horizontal add, the lane total may exceed 32 bits */
+	const __m512i lo = _mm512_cvtepu32_epi64 (_mm512_castsi512_si256 (sum));
+	const __m512i hi = _mm512_cvtepu32_epi64 (_mm512_extracti64x4_epi64 (sum, 1));
+	return (uint64_t)_mm512_reduce_add_epi64 (_mm512_add_epi64 (lo, hi));
+}
+
+static
+uint16_t
+do_csum_avx512 (
+	const void*	addr,
+	uint16_t	len,
+	uint32_t	csum
+	)
+{
+	uint_fast64_t acc = csum;
+	const uint8_t* buf = (const uint8_t*)addr;
+	uint16_t remainder = 0;			/* fixed size for endian swap */
+	uint_fast16_t count2;
+	uint_fast16_t count64;
+	bool is_odd;
+
+	if (PGM_UNLIKELY(len == 0))
+		return (uint16_t)acc;
+/* align first byte */
+	is_odd = ((uintptr_t)buf & 1);
+	if (PGM_UNLIKELY(is_odd)) {
+		((uint8_t*)&remainder)[1] = *buf++;
+		len--;
+	}
+/* drain upto 62-bytes to align on cache line strides */
+	count2 = (0x40 - ((uintptr_t)buf & 0x3f)) >> 1;
+	while (len > 1 && count2--) {
+		acc += ((const uint16_t*)buf)[ 0 ];
+		buf += 2;
+		len -= 2;
+	}
+	count64 = len >> 6;
+	const __m512i zero = _mm512_setzero_si512();
+	__m512i sum = zero;
+	while (count64--) {
+		const __m512i tmp = _mm512_load_si512 ((const void*)buf);
+		sum = _mm512_add_epi32 (sum, _mm512_unpacklo_epi16 (tmp, zero));
+		sum = _mm512_add_epi32 (sum, _mm512_unpackhi_epi16 (tmp, zero));
+		buf += 64;
+	}
+	acc += _pgm_csum_reduce_avx512 (sum);
+	len %= 64;
+/* final 63 bytes */
+	count2 = len >> 1;
+	while (count2--) {
+		acc += ((const uint16_t*)buf)[ 0 ];
+		buf += 2;
+	}
+/* trailing odd byte */
+	if (len & 1) {
+		((uint8_t*)&remainder)[0] = *buf;
+	}
+	acc += remainder;
+	acc  = (acc >> 32) + (acc & 0xffffffff);
+	acc  = (acc >> 16) + (acc & 0xffff);
+	acc  = (acc >> 16) + (acc & 0xffff);
+	acc += (acc >> 16);
+	if (PGM_UNLIKELY(is_odd))
+		acc = ((acc & 0xff) << 8) | ((acc & 0xff00) >> 8);
+	return (uint16_t)acc;
+}
+
+static
+uint16_t
+do_csumcpy_avx512 (
+	const void* restrict srcaddr,
+	void* restrict	     dstaddr,
+	uint16_t	     len,
+	uint32_t	     csum
+	)
+{
+	uint_fast64_t acc = csum;
+	const uint8_t*restrict srcbuf = (const uint8_t*restrict)srcaddr;
+	uint8_t*restrict dstbuf = (uint8_t*restrict)dstaddr;
+	uint16_t remainder = 0;			/* fixed size for endian swap */
+	uint_fast16_t count2;
+	uint_fast16_t count64;
+	bool is_odd;
+
+	if (PGM_UNLIKELY(len == 0))
+		return (uint16_t)acc;
+	pgm_prefetch (srcbuf);
+	pgm_prefetchw (dstbuf);
+/* align first byte */
+	is_odd = ((uintptr_t)srcbuf & 1);
+	if (PGM_UNLIKELY(is_odd)) {
+		((uint8_t*restrict)&remainder)[1] = *dstbuf++ = *srcbuf++;
+		len--;
+	}
+/* drain upto 62-bytes to align source on cache line strides */
+	count2 = (0x40 - ((uintptr_t)srcbuf & 0x3f)) >> 1;
+	while (len > 1 && count2--) {
+		acc += ((uint16_t*restrict)dstbuf)[ 0 ] = ((const uint16_t*restrict)srcbuf)[ 0 ];
+		srcbuf = &srcbuf[ 2 ];
+		dstbuf = &dstbuf[ 2 ];
+		len -= 2;
+	}
+	count64 = len >> 6;
+	const __m512i zero = _mm512_setzero_si512();
+	__m512i sum = zero;
+	while (count64--) {
+		const __m512i tmp = _mm512_load_si512 ((const void*)srcbuf);
+		sum = _mm512_add_epi32 (sum, _mm512_unpacklo_epi16 (tmp, zero));
+		sum = _mm512_add_epi32 (sum, _mm512_unpackhi_epi16 (tmp, zero));
+		_mm512_storeu_si512 ((void*)dstbuf, tmp);		// destination alignment may differ
+		srcbuf = &srcbuf[ 64 ];
+		dstbuf = &dstbuf[ 64 ];
+	}
+	acc += _pgm_csum_reduce_avx512 (sum);
+	len %= 64;
+/* final 63 bytes */
+	count2 = len >> 1;
+	while (count2--) {
+		acc += ((uint16_t*restrict)dstbuf)[ 0 ] = ((const uint16_t*restrict)srcbuf)[ 0 ];
+		srcbuf = &srcbuf[ 2 ];
+		dstbuf = &dstbuf[ 2 ];
+	}
+/* trailing odd byte */
+	if (len & 1) {
+		((uint8_t*restrict)&remainder)[0] = *dstbuf = *srcbuf;
+	}
+	acc += remainder;
+	acc  = (acc >> 32) + (acc & 0xffffffff);
+	acc  = (acc >> 16) + (acc & 0xffff);
+	acc  = (acc >> 16) + (acc & 0xffff);
+	acc += (acc >> 16);
+	if (PGM_UNLIKELY(is_odd))
+		acc = ((acc & 0xff) << 8) | ((acc & 0xff00) >> 8);
+	return (uint16_t)acc;
+}
+/* as do_csumcpy_avx512 with non-temporal stores of whole cache lines.
  */
 
+static
+uint16_t
+do_csumcpy_nt_avx512 (
+	const void* restrict srcaddr,
+	void* restrict	     dstaddr,
+	uint16_t	     len,
+	uint32_t	     csum
+	)
+{
+	uint_fast64_t acc = csum;
+	const uint8_t*restrict srcbuf = (const uint8_t*restrict)srcaddr;
+	uint8_t*restrict dstbuf = (uint8_t*restrict)dstaddr;
+	uint16_t remainder = 0;			/* fixed size for endian swap */
+	uint_fast16_t count2;
+	uint_fast16_t count64;
+	bool is_odd;
+
+	if (PGM_UNLIKELY(len == 0))
+		return (uint16_t)acc;
+	pgm_prefetch (srcbuf);
+/* align first byte */
+	is_odd = ((uintptr_t)dstbuf & 1);
+	if (PGM_UNLIKELY(is_odd)) {
+		((uint8_t*restrict)&remainder)[1] = *dstbuf++ = *srcbuf++;
+		len--;
+	}
+/* drain upto 62-bytes to align destination on cache line strides */
+	count2 = ((0x40 - ((uintptr_t)dstbuf & 0x3f)) & 0x3f) >> 1;
+	while (len > 1 && count2--) {
+		acc += ((uint16_t*restrict)dstbuf)[ 0 ] = ((const uint16_t*restrict)srcbuf)[ 0 ];
+		srcbuf = &srcbuf[ 2 ];
+		dstbuf = &dstbuf[ 2 ];
+		len -= 2;
+	}
+	count64 = len >> 6;
+	const __m512i zero = _mm512_setzero_si512();
+	__m512i sum = zero;
+	while (count64--) {
+		const __m512i tmp = _mm512_loadu_si512 ((const void*)srcbuf);
+		sum = _mm512_add_epi32 (sum, _mm512_unpacklo_epi16 (tmp, zero));
+		sum = _mm512_add_epi32 (sum, _mm512_unpackhi_epi16 (tmp, zero));
+		_mm512_stream_si512 ((void*)dstbuf, tmp);
+		srcbuf = &srcbuf[ 64 ];
+		dstbuf = &dstbuf[ 64 ];
+	}
+	_mm_sfence();
+	acc += _pgm_csum_reduce_avx512 (sum);
+	len %= 64;
+/* final 63 bytes */
+	count2 = len >> 1;
+	while (count2--) {
+		acc += ((uint16_t*restrict)dstbuf)[ 0 ] = ((const uint16_t*restrict)srcbuf)[ 0 ];
+		srcbuf = &srcbuf[ 2 ];
+		dstbuf = &dstbuf[ 2 ];
+	}
+/* trailing odd byte */
+	if (len & 1) {
+		((uint8_t*restrict)&remainder)[0] = *dstbuf = *srcbuf;
+	}
+	acc += remainder;
+	acc  = (acc >> 32) + (acc & 0xffffffff);
+	acc  = (acc >> 16) + (acc & 0xffff);
+	acc  = (acc >> 16) + (acc & 0xffff);
+	acc += (acc >> 16);
+	if (PGM_UNLIKELY(is_odd))
+		acc = ((acc & 0xff) << 8) | ((acc & 0xff00) >> 8);
+	return (uint16_t)acc;
+}
+#endif
+
 static
 uint16_t
 do_csum_memcpy (
@@ -1475,15 +1919,153 @@ do_csum_memcpy (
 	return pgm_csum_partial (dstaddr, len, csum);
 }
 
-PGM_GNUC_INTERNAL
+/* checksum kernels supported by the CPU, fastest by feature set first.
+ */
+
+struct csum_kernel_t {
+	const char*	name;
+	uint16_t	(*csum) (const void*, uint16_t, uint32_t);
+};
+
+#define CSUM_MAX_KERNELS	12
+
+/* lengths timed for each bucket of pgm_checksum_calibrate(): a small control
+ * packet and an Ethernet sized TPDU.
+ */
+#define CSUM_CALIBRATE_SMALL_LEN	128
+#define CSUM_CALIBRATE_LARGE_LEN	1500
+#define CSUM_CALIBRATE_CALLS		4096
+#define CSUM_CALIBRATE_ROUNDS		3
+
+static const char* csum_kernel_name[2];		/* small, large */
+static uint64_t csum_kernel_nsecs[2];		/* per call, 0 = not calibrated */
+static bool csum_is_pinned = FALSE;
+
+static
+unsigned
+csum_kernels (
+	const pgm_cpu_t*		cpu,
+	struct csum_kernel_t*		kernels
+	)
+{
+	unsigned len = 0;
+
+#if defined(__AVX512BW__) || (defined(_MSC_VER) && (_MSC_VER >= 1920) && defined(_M_X64))
+	if (cpu->has_avx512bw) {
+		kernels[len].name = "AVX512";
+		kernels[len++].csum = do_csum_avx512;
+	}
+#endif
+#if defined(__AVX2__) || defined(_M_AMD64) || defined(_M_X64)
+	if (cpu->has_avx2) {
+		kernels[len].name = "AVX2";
+		kernels[len++].csum = do_csum_avx2;
+	}
+#endif
+#if defined(__SSE4_1__) || defined(_M_AMD64) || defined(_M_X64)
+	if (cpu->has_sse41) {
+		kernels[len].name = "SSE41";
+		kernels[len++].csum = do_csum_sse41;
+	}
+#endif
+#if defined(__SSE3__) || defined(_M_AMD64) || defined(_M_X64)
+	if (cpu->has_sse3) {
+		kernels[len].name = "SSE3";
+		kernels[len++].csum = do_csum_sse3;
+	}
+#endif
+#if defined(__SSE2__) || defined(_M_AMD64) || defined(_M_X64)
+	if (cpu->has_sse2) {
+		kernels[len].name = "SSE2";
+		kernels[len++].csum = do_csum_sse2;
+	}
+#endif
+#if defined(WITH_MMX)
+#if defined(__MMX__) || defined(_M_AMD64) || defined(_M_X64)
+	if (cpu->has_mmx) {
+		kernels[len].name = "MMX";
+		kernels[len++].csum = do_csum_mmx;
+	}
+#endif
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+	if (cpu->has_neon) {
+		kernels[len].name = "NEON";
+		kernels[len++].csum = do_csum_neon;
+	}
+#endif
+#if defined(__amd64) || defined(__x86_64__)
+	kernels[len].name = "VECTOR";
+	kernels[len++].csum = do_csum_vector;
+#endif
+	kernels[len].name = "64BIT";
+	kernels[len++].csum = do_csum_64bit;
+	kernels[len].name = "32BIT";
+	kernels[len++].csum = do_csum_32bit;
+	kernels[len].name = "16BIT";
+	kernels[len++].csum = do_csum_16bit;
+	pgm_assert (len <= CSUM_MAX_KERNELS);
+	return len;
+}
+
+static
+const char*
+csum_kernel_lookup (
+	const struct csum_kernel_t*	kernels,
+	const unsigned			len,
+	uint16_t			(*csum) (const void*, uint16_t, uint32_t)
+	)
+{
+	for (unsigned i = 0; i < len; i++)
+		if (kernels[i].csum == csum)
+			return kernels[i].name;
+	return "UNKNOWN";
+}
+
+/* microseconds for the fastest round of calls of csum over len bytes.
+ */
+
+static
+pgm_time_t
+csum_time (
+	uint16_t		(*csum) (const void*, uint16_t, uint32_t),
+	const void*		buf,
+	const uint16_t		len
+	)
+{
+	pgm_time_t best = UINT64_MAX;
+	volatile uint32_t sink = 0;
+
+	for (unsigned round = 0; round < CSUM_CALIBRATE_ROUNDS; round++)
+	{
+		const pgm_time_t start = pgm_time_update_now();
+		for (unsigned i = 0; i < CSUM_CALIBRATE_CALLS; i++)
+			sink += csum (buf, len, i);
+		const pgm_time_t elapsed = pgm_time_update_now() - start;
+		best = MIN(best, elapsed);
+	}
+	return best;
+}
+
+static
 void
-pgm_checksum_init (const pgm_cpu_t* cpu)
+csum_select (const pgm_cpu_t* cpu)
 {
+#if defined(__AVX512BW__) || (defined(_MSC_VER) && (_MSC_VER >= 1920) && defined(_M_X64))
+	if (cpu->has_avx512bw) {
+		pgm_minor (_("Using AVX-512 instructions for checksum."));
+		do_csum = do_csum_avx512;
+		do_csumcpy = do_csumcpy_avx512;
+		do_csumcpy_nt = do_csumcpy_nt_avx512;
+		return;
+	}
+#endif
 #if defined(__AVX2__) || defined(_M_AMD64) || defined(_M_X64)
 	if (cpu->has_avx2) {
 		pgm_minor (_("Using AVX2 instructions for checksum."));
 		do_csum = do_csum_avx2;
 		do_csumcpy = do_csumcpy_avx2;
+		do_csumcpy_nt = do_csumcpy_nt_avx2;
 		return;
 	}
 #endif
@@ -1521,6 +2103,14 @@ pgm_checksum_init (const pgm_cpu_t* cpu)
 	}
 #endif
 #endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+	if (cpu->has_neon) {
+		pgm_minor (_("Using NEON instructions for checksum."));
+		do_csum = do_csum_neon;
+		do_csumcpy = do_csumcpy_neon;
+		return;
+	}
+#endif
 
 /* defaults to 16-bit checksum and memcpy for SPARC. */
 	do_csum = do_csum_16bit;
@@ -1533,6 +2123,123 @@ pgm_checksum_init (const pgm_cpu_t* cpu)
 #endif
 }
 
+/* select the checksum kernels per the CPU feature set, unless PGM_CSUM names the
+ * kernels for small and large checksums, e.g. export PGM_CSUM=SSE2,AVX2 as
+ * reported by a previous pgm_checksum_calibrate().
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_checksum_init (const pgm_cpu_t* cpu)
+{
+	struct csum_kernel_t kernels[ CSUM_MAX_KERNELS ];
+
+	pgm_assert (NULL != cpu);
+
+	csum_select (cpu);
+	do_csum_small = do_csum;
+	csum_is_pinned = FALSE;
+	csum_kernel_nsecs[0] = csum_kernel_nsecs[1] = 0;
+
+	const unsigned len = csum_kernels (cpu, kernels);
+	csum_kernel_name[0] = csum_kernel_name[1] = csum_kernel_lookup (kernels, len, do_csum);
+
+	char* pgm_csum;
+	size_t envlen;
+	const errno_t err = pgm_dupenv_s (&pgm_csum, &envlen, "PGM_CSUM");
+	if (0 == err && envlen > 0) {
+		char* large = strchr (pgm_csum, ',');
+		if (NULL != large)
+			*large++ = '\0';
+		else
+			large = pgm_csum;
+		int small_index = -1, large_index = -1;
+		for (unsigned i = 0; i < len; i++) {
+			if (0 == strcmp (kernels[i].name, pgm_csum))
+				small_index = i;
+			if (0 == strcmp (kernels[i].name, large))
+				large_index = i;
+		}
+		if (small_index >= 0 && large_index >= 0) {
+			do_csum_small = kernels[small_index].csum;
+			do_csum = kernels[large_index].csum;
+			csum_kernel_name[0] = kernels[small_index].name;
+			csum_kernel_name[1] = kernels[large_index].name;
+			csum_is_pinned = TRUE;
+			pgm_minor (_("Using %s checksum for small packets and %s otherwise per PGM_CSUM."),
+				   csum_kernel_name[0], csum_kernel_name[1]);
+		} else {
+			pgm_warn (_("Ignoring PGM_CSUM naming a checksum kernel not supported by this processor."));
+		}
+		pgm_free (pgm_csum);
+	}
+}
+
+/* time every supported checksum kernel at a small and a TPDU sized length and
+ * dispatch each length bucket to the fastest, as the feature set alone can
+ * mislead, e.g. wide vector units clocking down or warming up on small packets.
+ * kernels named by PGM_CSUM are kept.  checksum-copy kernels are unchanged.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_checksum_calibrate (const pgm_cpu_t* cpu)
+{
+	static const uint16_t lengths[2] = { CSUM_CALIBRATE_SMALL_LEN, CSUM_CALIBRATE_LARGE_LEN };
+	struct csum_kernel_t kernels[ CSUM_MAX_KERNELS ];
+
+	pgm_assert (NULL != cpu);
+
+	if (csum_is_pinned)
+		return;
+
+	const unsigned len = csum_kernels (cpu, kernels);
+	uint8_t* buf = pgm_malloc (CSUM_CALIBRATE_LARGE_LEN);
+	for (unsigned i = 0; i < CSUM_CALIBRATE_LARGE_LEN; i++)
+		buf[i] = (uint8_t)(i * 31);
+
+	for (unsigned bucket = 0; bucket < 2; bucket++)
+	{
+		unsigned best_index = 0;
+		pgm_time_t best = UINT64_MAX;
+		for (unsigned i = 0; i < len; i++) {
+			const pgm_time_t elapsed = csum_time (kernels[i].csum, buf, lengths[bucket]);
+			if (elapsed < best) {
+				best = elapsed;
+				best_index = i;
+			}
+		}
+		csum_kernel_name[bucket] = kernels[best_index].name;
+		csum_kernel_nsecs[bucket] = MAX(UINT64_C(1), (best * 1000) / CSUM_CALIBRATE_CALLS);
+		if (0 == bucket)
+			do_csum_small = kernels[best_index].csum;
+		else
+			do_csum = kernels[best_index].csum;
+	}
+	pgm_free (buf);
+	pgm_minor (_("Calibrated checksum kernels %s at %" PRIu64 "ns/%u bytes and %s at %" PRIu64 "ns/%u bytes, "
+		     "export PGM_CSUM=%s,%s to skip calibration."),
+		   csum_kernel_name[0], csum_kernel_nsecs[0], (unsigned)CSUM_CALIBRATE_SMALL_LEN,
+		   csum_kernel_name[1], csum_kernel_nsecs[1], (unsigned)CSUM_CALIBRATE_LARGE_LEN,
+		   csum_kernel_name[0], csum_kernel_name[1]);
+}
+
+/* returns name of the checksum kernel for small or large lengths, with nsecs
+ * the calibrated time per call or 0 if not calibrated.
+ */
+
+PGM_GNUC_INTERNAL
+const char*
+pgm_checksum_kernel (
+	const bool		is_small,
+	uint64_t*		nsecs
+	)
+{
+	if (NULL != nsecs)
+		*nsecs = csum_kernel_nsecs[ is_small ? 0 : 1 ];
+	return csum_kernel_name[ is_small ? 0 : 1 ];
+}
+
 /* Calculate an IP header style checksum
  */
 
@@ -1547,7 +2254,7 @@ pgm_inet_checksum (
 	pgm_assert (NULL != addr);
 
 /* invert to get the ones-complement. */
-	return ~do_csum (addr, len, csum);
+	return ~(len <= PGM_CSUM_SMALL_LEN ? do_csum_small : do_csum) (addr, len, csum);
 }
 
 /* Calculate a partial (unfolded) checksum
@@ -1564,7 +2271,7 @@ pgm_compat_csum_partial (
 	pgm_assert (NULL != addr);
 
 	csum  = (csum >> 16) + (csum & 0xffff);
-	csum += do_csum (addr, len, 0);
+	csum += (len <= PGM_CSUM_SMALL_LEN ? do_csum_small : do_csum) (addr, len, 0);
 	csum  = (csum >> 16) + (csum & 0xffff);
 
 	return csum;
@@ -1590,6 +2297,30 @@ pgm_compat_csum_partial_copy (
 	return do_csumcpy (src, dst, len, csum);
 }
 
+/* Calculate & copy a partial PGM checksum to a buffer that will not be read
+ * again soon, such as a transmit window entry only revisited on repair.
+ *
+ * Large copies use streaming stores where available so the payload does not
+ * displace the caller's working set.
+ */
+
+uint32_t
+pgm_compat_csum_partial_copy_nt (
+	const void* restrict src,
+	void*	    restrict dst,
+	uint16_t	     len,
+	uint32_t	     csum
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != src);
+	pgm_assert (NULL != dst);
+
+	if (len >= PGM_CSUM_NT_THRESHOLD && NULL != do_csumcpy_nt)
+		return do_csumcpy_nt (src, dst, len, csum);
+	return do_csumcpy (src, dst, len, csum);
+}
+
 /* Fold 32 bit checksum accumulator into 16 bit final value.
  */
 
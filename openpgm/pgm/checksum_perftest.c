@@ -972,6 +972,190 @@ START_TEST (test_avx2_csumcpy)
 END_TEST
 #endif
 
+#ifdef __AVX512BW__
+START_TEST (test_avx512)
+{
+	const unsigned iterations = 1000;
+	char* source = alloca (perf_testsize);
+	for (unsigned i = 0, j = 0; i < perf_testsize; i++) {
+		j = j * 1103515245 + 12345;
+		source[i] = j;
+	}
+	const guint16 answer = perf_answer;		/* network order */
+
+	guint16 csum;
+	pgm_time_t start, check;
+
+	start = pgm_time_update_now();
+	for (unsigned i = iterations; i; i--) {
+		csum = ~do_csum_avx512 (source, perf_testsize, 0);
+/* function calculates answer in host order */
+		csum = g_htons (csum);
+		fail_unless (answer == csum, "checksum mismatch 0x%04x (0x%04x)", csum, answer);
+	}
+
+	check = pgm_time_update_now();
+	g_message ("avx512/%u: elapsed time %" PGM_TIME_FORMAT " us, unit time %" PGM_TIME_FORMAT " us",
+		perf_testsize,
+		(guint64)(check - start),
+		(guint64)((check - start) / iterations));
+}
+END_TEST
+
+START_TEST (test_avx512_memcpy)
+{
+	const unsigned iterations = 1000;
+	char* source = alloca (perf_testsize);
+	char* target = alloca (perf_testsize);
+	for (unsigned i = 0, j = 0; i < perf_testsize; i++) {
+		j = j * 1103515245 + 12345;
+		source[i] = j;
+	}
+	const guint16 answer = perf_answer;		/* network order */
+
+	guint16 csum;
+	pgm_time_t start, check;
+
+	start = pgm_time_update_now();
+	for (unsigned i = iterations; i; i--) {
+		memcpy (target, source, perf_testsize);
+		csum = ~do_csum_avx512 (target, perf_testsize, 0);
+/* function calculates answer in host order */
+		csum = g_htons (csum);
+		fail_unless (answer == csum, "checksum mismatch 0x%04x (0x%04x)", csum, answer);
+	}
+
+	check = pgm_time_update_now();
+	g_message ("avx512/%u: elapsed time %" PGM_TIME_FORMAT " us, unit time %" PGM_TIME_FORMAT " us",
+		perf_testsize,
+		(guint64)(check - start),
+		(guint64)((check - start) / iterations));
+}
+END_TEST
+
+START_TEST (test_avx512_csumcpy)
+{
+	const unsigned iterations = 1000;
+	char* source = alloca (perf_testsize);
+	char* target = alloca (perf_testsize);
+	for (unsigned i = 0, j = 0; i < perf_testsize; i++) {
+		j = j * 1103515245 + 12345;
+		source[i] = j;
+	}
+	const guint16 answer = perf_answer;		/* network order */
+
+	guint16 csum;
+	pgm_time_t start, check;
+
+	start = pgm_time_update_now();
+	for (unsigned i = iterations; i; i--) {
+		csum = ~do_csumcpy_avx512 (source, target, perf_testsize, 0);
+/* function calculates answer in host order */
+		csum = g_htons (csum);
+		fail_unless (answer == csum, "checksum mismatch 0x%04x (0x%04x)", csum, answer);
+	}
+
+	check = pgm_time_update_now();
+	g_message ("avx512/%u: elapsed time %" PGM_TIME_FORMAT " us, unit time %" PGM_TIME_FORMAT " us",
+		perf_testsize,
+		(guint64)(check - start),
+		(guint64)((check - start) / iterations));
+}
+END_TEST
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+START_TEST (test_neon)
+{
+	const unsigned iterations = 1000;
+	char* source = alloca (perf_testsize);
+	for (unsigned i = 0, j = 0; i < perf_testsize; i++) {
+		j = j * 1103515245 + 12345;
+		source[i] = j;
+	}
+	const guint16 answer = perf_answer;		/* network order */
+
+	guint16 csum;
+	pgm_time_t start, check;
+
+	start = pgm_time_update_now();
+	for (unsigned i = iterations; i; i--) {
+		csum = ~do_csum_neon (source, perf_testsize, 0);
+/* function calculates answer in host order */
+		csum = g_htons (csum);
+		fail_unless (answer == csum, "checksum mismatch 0x%04x (0x%04x)", csum, answer);
+	}
+
+	check = pgm_time_update_now();
+	g_message ("neon/%u: elapsed time %" PGM_TIME_FORMAT " us, unit time %" PGM_TIME_FORMAT " us",
+		perf_testsize,
+		(guint64)(check - start),
+		(guint64)((check - start) / iterations));
+}
+END_TEST
+
+START_TEST (test_neon_memcpy)
+{
+	const unsigned iterations = 1000;
+	char* source = alloca (perf_testsize);
+	char* target = alloca (perf_testsize);
+	for (unsigned i = 0, j = 0; i < perf_testsize; i++) {
+		j = j * 1103515245 + 12345;
+		source[i] = j;
+	}
+	const guint16 answer = perf_answer;		/* network order */
+
+	guint16 csum;
+	pgm_time_t start, check;
+
+	start = pgm_time_update_now();
+	for (unsigned i = iterations; i; i--) {
+		memcpy (target, source, perf_testsize);
+		csum = ~do_csum_neon (target, perf_testsize, 0);
+/* function calculates answer in host order */
+		csum = g_htons (csum);
+		fail_unless (answer == csum, "checksum mismatch 0x%04x (0x%04x)", csum, answer);
+	}
+
+	check = pgm_time_update_now();
+	g_message ("neon/%u: elapsed time %" PGM_TIME_FORMAT " us, unit time %" PGM_TIME_FORMAT " us",
+		perf_testsize,
+		(guint64)(check - start),
+		(guint64)((check - start) / iterations));
+}
+END_TEST
+
+START_TEST (test_neon_csumcpy)
+{
+	const unsigned iterations = 1000;
+	char* source = alloca (perf_testsize);
+	char* target = alloca (perf_testsize);
+	for (unsigned i = 0, j = 0; i < perf_testsize; i++) {
+		j = j * 1103515245 + 12345;
+		source[i] = j;
+	}
+	const guint16 answer = perf_answer;		/* network order */
+
+	guint16 csum;
+	pgm_time_t start, check;
+
+	start = pgm_time_update_now();
+	for (unsigned i = iterations; i; i--) {
+		csum = ~do_csumcpy_neon (source, target, perf_testsize, 0);
+/* function calculates answer in host order */
+		csum = g_htons (csum);
+		fail_unless (answer == csum, "checksum mismatch 0x%04x (0x%04x)", csum, answer);
+	}
+
+	check = pgm_time_update_now();
+	g_message ("neon/%u: elapsed time %" PGM_TIME_FORMAT " us, unit time %" PGM_TIME_FORMAT " us",
+		perf_testsize,
+		(guint64)(check - start),
+		(guint64)((check - start) / iterations));
+}
+END_TEST
+#endif
+
 static
 Suite*
 make_csum_performance_suite (void)
@@ -1006,6 +1190,12 @@ make_csum_performance_suite (void)
 #ifdef __AVX2__
 	tcase_add_test (tc_100b, test_avx2);
 #endif
+#ifdef __AVX512BW__
+	tcase_add_test (tc_100b, test_avx512);
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	tcase_add_test (tc_100b, test_neon);
+#endif
 
 	TCase* tc_200b = tcase_create ("200b");
 	suite_add_tcase (s, tc_200b);
@@ -1033,6 +1223,12 @@ make_csum_performance_suite (void)
 #ifdef __AVX2__
 	tcase_add_test (tc_200b, test_avx2);
 #endif
+#ifdef __AVX512BW__
+	tcase_add_test (tc_200b, test_avx512);
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	tcase_add_test (tc_200b, test_neon);
+#endif
 
 	TCase* tc_1500b = tcase_create ("1500b");
 	suite_add_tcase (s, tc_1500b);
@@ -1060,6 +1256,12 @@ make_csum_performance_suite (void)
 #ifdef __AVX2__
 	tcase_add_test (tc_1500b, test_avx2);
 #endif
+#ifdef __AVX512BW__
+	tcase_add_test (tc_1500b, test_avx512);
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	tcase_add_test (tc_1500b, test_neon);
+#endif
 
 	TCase* tc_9kb = tcase_create ("9KB");
 	suite_add_tcase (s, tc_9kb);
@@ -1087,6 +1289,12 @@ make_csum_performance_suite (void)
 #ifdef __AVX2__
 	tcase_add_test (tc_9kb, test_avx2);
 #endif
+#ifdef __AVX512BW__
+	tcase_add_test (tc_9kb, test_avx512);
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	tcase_add_test (tc_9kb, test_neon);
+#endif
 
 	TCase* tc_64kb = tcase_create ("64KB");
 	suite_add_tcase (s, tc_64kb);
@@ -1114,6 +1322,12 @@ make_csum_performance_suite (void)
 #ifdef __AVX2__
 	tcase_add_test (tc_64kb, test_avx2);
 #endif
+#ifdef __AVX512BW__
+	tcase_add_test (tc_64kb, test_avx512);
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	tcase_add_test (tc_64kb, test_neon);
+#endif
 
 	return s;
 }
@@ -1152,6 +1366,12 @@ make_csum_memcpy_performance_suite (void)
 #ifdef __AVX2__
 	tcase_add_test (tc_100b, test_avx2_memcpy);
 #endif
+#ifdef __AVX512BW__
+	tcase_add_test (tc_100b, test_avx512_memcpy);
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	tcase_add_test (tc_100b, test_neon_memcpy);
+#endif
 
 	TCase* tc_200b = tcase_create ("200b");
 	suite_add_tcase (s, tc_200b);
@@ -1179,6 +1399,12 @@ make_csum_memcpy_performance_suite (void)
 #ifdef __AVX2__
 	tcase_add_test (tc_200b, test_avx2_memcpy);
 #endif
+#ifdef __AVX512BW__
+	tcase_add_test (tc_200b, test_avx512_memcpy);
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	tcase_add_test (tc_200b, test_neon_memcpy);
+#endif
 
 	TCase* tc_1500b = tcase_create ("1500b");
 	suite_add_tcase (s, tc_1500b);
@@ -1206,6 +1432,12 @@ make_csum_memcpy_performance_suite (void)
 #ifdef __AVX2__
 	tcase_add_test (tc_1500b, test_avx2_memcpy);
 #endif
+#ifdef __AVX512BW__
+	tcase_add_test (tc_1500b, test_avx512_memcpy);
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	tcase_add_test (tc_1500b, test_neon_memcpy);
+#endif
 
 	TCase* tc_9kb = tcase_create ("9KB");
 	suite_add_tcase (s, tc_9kb);
@@ -1233,6 +1465,12 @@ make_csum_memcpy_performance_suite (void)
 #ifdef __AVX2__
 	tcase_add_test (tc_9kb, test_avx2_memcpy);
 #endif
+#ifdef __AVX512BW__
+	tcase_add_test (tc_9kb, test_avx512_memcpy);
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	tcase_add_test (tc_9kb, test_neon_memcpy);
+#endif
 
 	TCase* tc_64kb = tcase_create ("64KB");
 	suite_add_tcase (s, tc_64kb);
@@ -1260,6 +1498,12 @@ make_csum_memcpy_performance_suite (void)
 #ifdef __AVX2__
 	tcase_add_test (tc_64kb, test_avx2_memcpy);
 #endif
+#ifdef __AVX512BW__
+	tcase_add_test (tc_64kb, test_avx512_memcpy);
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	tcase_add_test (tc_64kb, test_neon_memcpy);
+#endif
 
 	return s;
 }
@@ -1292,6 +1536,12 @@ make_csumcpy_performance_suite (void)
 #ifdef __AVX2__
 	tcase_add_test (tc_100b, test_avx2_csumcpy);
 #endif
+#ifdef __AVX512BW__
+	tcase_add_test (tc_100b, test_avx512_csumcpy);
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	tcase_add_test (tc_100b, test_neon_csumcpy);
+#endif
 
 	TCase* tc_200b = tcase_create ("200b");
 	suite_add_tcase (s, tc_200b);
@@ -1313,6 +1563,12 @@ make_csumcpy_performance_suite (void)
 #ifdef __AVX2__
 	tcase_add_test (tc_200b, test_avx2_csumcpy);
 #endif
+#ifdef __AVX512BW__
+	tcase_add_test (tc_200b, test_avx512_csumcpy);
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	tcase_add_test (tc_200b, test_neon_csumcpy);
+#endif
 
 	TCase* tc_1500b = tcase_create ("1500b");
 	suite_add_tcase (s, tc_1500b);
@@ -1334,6 +1590,12 @@ make_csumcpy_performance_suite (void)
 #ifdef __AVX2__
 	tcase_add_test (tc_1500b, test_avx2_csumcpy);
 #endif
+#ifdef __AVX512BW__
+	tcase_add_test (tc_1500b, test_avx512_csumcpy);
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	tcase_add_test (tc_1500b, test_neon_csumcpy);
+#endif
 
 	TCase* tc_9kb = tcase_create ("9KB");
 	suite_add_tcase (s, tc_9kb);
@@ -1355,6 +1617,12 @@ make_csumcpy_performance_suite (void)
 #ifdef __AVX2__
 	tcase_add_test (tc_9kb, test_avx2_csumcpy);
 #endif
+#ifdef __AVX512BW__
+	tcase_add_test (tc_9kb, test_avx512_csumcpy);
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	tcase_add_test (tc_9kb, test_neon_csumcpy);
+#endif
 
 	TCase* tc_64kb = tcase_create ("64KB");
 	suite_add_tcase (s, tc_64kb);
@@ -1376,6 +1644,12 @@ make_csumcpy_performance_suite (void)
 #ifdef __AVX2__
 	tcase_add_test (tc_64kb, test_avx2_csumcpy);
 #endif
+#ifdef __AVX512BW__
+	tcase_add_test (tc_64kb, test_avx512_csumcpy);
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	tcase_add_test (tc_64kb, test_neon_csumcpy);
+#endif
 
 	return s;
 }
@@ -61,7 +61,9 @@ void
 mock_setup (void)
 {
 	do_csum = do_csum_16bit;
+	do_csum_small = do_csum_16bit;
 	do_csumcpy = do_csum_memcpy;
+	do_csumcpy_nt = NULL;
 }
 
 /* target:
@@ -210,6 +212,40 @@ START_TEST (test_partial_copy_fail_001)
 }
 END_TEST
 
+/* target:
+ *	guint32
+ *	pgm_csum_partial_copy_nt (
+ *		const void*		src,
+ *		void*			dst,
+ *		guint			len,
+ *		guint32			sum
+ *	)
+ */
+
+/* streaming store copies match the cached copy at every destination alignment */
+START_TEST (test_partial_copy_nt_pass_001)
+{
+	guint8 source[2048 + 3], dest[2048 + 64];
+	for (unsigned i = 0; i < G_N_ELEMENTS(source); i++)
+		source[i] = (guint8)g_random_int();
+#if defined(__AVX512BW__)
+	do_csumcpy_nt = do_csumcpy_nt_avx512;
+#elif defined(__AVX2__)
+	do_csumcpy_nt = do_csumcpy_nt_avx2;
+#endif
+	for (guint16 len = PGM_CSUM_NT_THRESHOLD - 3; len <= 2048; len += 7)
+	{
+		for (unsigned offset = 0; offset < 3; offset++)
+		{
+			const guint32 answer = pgm_csum_partial (&source[offset], len, 0);
+			const guint32 csum = pgm_csum_partial_copy_nt (&source[offset], &dest[offset * 13], len, 0);
+			fail_unless (answer == csum, "checksum mismatch in partial-copy");
+			fail_unless (0 == memcmp (&source[offset], &dest[offset * 13], len), "copy mismatch in partial-copy");
+		}
+	}
+}
+END_TEST
+
 /* target:
  *	guint32
  *	pgm_csum_block_add (
@@ -239,6 +275,58 @@ START_TEST (test_block_add_pass_001)
 }
 END_TEST
 
+/* target:
+ *	void
+ *	pgm_checksum_calibrate (
+ *		const pgm_cpu_t*	cpu
+ *	)
+ */
+
+/* calibrated kernels match the 16-bit reference either side of the small length */
+START_TEST (test_calibrate_pass_001)
+{
+	pgm_cpu_t cpu;
+	guint8 source[1500 + 1];
+	uint64_t nsecs;
+	for (unsigned i = 0; i < G_N_ELEMENTS(source); i++)
+		source[i] = (guint8)g_random_int();
+	fail_unless (TRUE == pgm_time_init (NULL), "time_init failed");
+	pgm_cpuid (&cpu);
+	g_unsetenv ("PGM_CSUM");
+	pgm_checksum_init (&cpu);
+	pgm_checksum_calibrate (&cpu);
+	for (guint16 len = PGM_CSUM_SMALL_LEN - 7; len <= PGM_CSUM_SMALL_LEN + 7; len++)
+	{
+		const guint16 answer = do_csum_16bit (&source[1], len, 0);
+		fail_unless (answer == pgm_compat_csum_partial (&source[1], len, 0), "checksum mismatch");
+	}
+	fail_unless (NULL != pgm_checksum_kernel (TRUE, &nsecs), "no small kernel");
+	fail_unless (nsecs > 0, "small kernel not calibrated");
+	fail_unless (NULL != pgm_checksum_kernel (FALSE, &nsecs), "no large kernel");
+	fail_unless (nsecs > 0, "large kernel not calibrated");
+	fail_unless (TRUE == pgm_time_shutdown (), "time_shutdown failed");
+}
+END_TEST
+
+/* kernels named by PGM_CSUM are kept by calibration */
+START_TEST (test_calibrate_pass_002)
+{
+	pgm_cpu_t cpu;
+	uint64_t nsecs;
+	fail_unless (TRUE == pgm_time_init (NULL), "time_init failed");
+	pgm_cpuid (&cpu);
+	g_setenv ("PGM_CSUM", "16BIT,32BIT", TRUE);
+	pgm_checksum_init (&cpu);
+	pgm_checksum_calibrate (&cpu);
+	fail_unless (0 == strcmp ("16BIT", pgm_checksum_kernel (TRUE, &nsecs)), "small kernel not pinned");
+	fail_unless (0 == nsecs, "pinned kernel calibrated");
+	fail_unless (0 == strcmp ("32BIT", pgm_checksum_kernel (FALSE, &nsecs)), "large kernel not pinned");
+	g_unsetenv ("PGM_CSUM");
+	pgm_checksum_init (&cpu);
+	fail_unless (TRUE == pgm_time_shutdown (), "time_shutdown failed");
+}
+END_TEST
+
 
 static
 Suite*
@@ -278,9 +366,15 @@ make_test_suite (void)
 	suite_add_tcase (s, tc_partial_copy);
 	tcase_add_checked_fixture (tc_partial_copy, mock_setup, NULL);
 	tcase_add_test (tc_partial_copy, test_partial_copy_pass_001);
+	tcase_add_test (tc_partial_copy, test_partial_copy_nt_pass_001);
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_partial_copy, test_partial_copy_fail_001, SIGABRT);
 #endif
+
+	TCase* tc_calibrate = tcase_create ("calibrate");
+	suite_add_tcase (s, tc_calibrate);
+	tcase_add_test (tc_calibrate, test_calibrate_pass_001);
+	tcase_add_test (tc_calibrate, test_calibrate_pass_002);
 	return s;
 }
 
@@ -0,0 +1,357 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * APDU payload compression: each APDU is compressed whole and independently
+ * of the others, as receivers may join late or lose data, primed with a
+ * dictionary shared out of band by sources and receivers to find redundancy
+ * across messages.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <impl/i18n.h>
+#include <impl/framework.h>
+#ifdef HAVE_ZLIB_H
+#	define ZLIB_CONST		/* const z_stream::next_in */
+#	include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD_H
+#	include <zstd.h>
+#endif
+
+
+//#define COMPRESS_DEBUG
+
+#ifndef COMPRESS_DEBUG
+#	define PGM_DISABLE_ASSERT
+#endif
+
+/* raw deflate, no header or trailer as the option carries type and length */
+#define COMPRESS_ZLIB_WINDOW_BITS	(-15)
+#define COMPRESS_ZLIB_MEM_LEVEL		8
+
+/* one context per socket, the encoder is used by the source under its lock and
+ * the decoders by the receive windows under the receiver lock.  decoders of
+ * every built type are created on first use.
+ */
+
+struct pgm_compress_t {
+	unsigned		type;		/* encoder PGM_COMPRESS_* */
+	int			level;
+	uint16_t		dict_id;
+	const void*		dict;		/* owned by the socket */
+	size_t			dict_len;
+#ifdef HAVE_ZLIB_H
+	z_stream		deflate;
+	z_stream		inflate;
+	unsigned		has_deflate:1;
+	unsigned		has_inflate:1;
+#endif
+#ifdef HAVE_ZSTD_H
+	ZSTD_CCtx*		cctx;
+	ZSTD_CDict*		cdict;
+	ZSTD_DCtx*		dctx;
+	ZSTD_DDict*		ddict;
+#endif
+};
+
+PGM_GNUC_INTERNAL
+bool
+pgm_compress_is_supported (
+	const unsigned		type
+	)
+{
+	switch (type) {
+#ifdef HAVE_ZLIB_H
+	case PGM_COMPRESS_ZLIB:	return TRUE;
+#endif
+#ifdef HAVE_ZSTD_H
+	case PGM_COMPRESS_ZSTD:	return TRUE;
+#endif
+	default:		return FALSE;
+	}
+}
+
+/* create a context for the encoder of cr_type with the dictionary of the request,
+ * which must remain valid until the context is destroyed.
+ *
+ * on success returns the new context, on failure returns NULL setting error.
+ */
+
+PGM_GNUC_INTERNAL
+struct pgm_compress_t*
+pgm_compress_new (
+	const struct pgm_compress_req_t* const restrict cr,
+	pgm_error_t**			       restrict error
+	)
+{
+	struct pgm_compress_t* compress;
+
+/* pre-conditions */
+	pgm_assert (NULL != cr);
+
+	if (!pgm_compress_is_supported (cr->cr_type)) {
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     PGM_ERROR_NOSYS,
+			     _("Compression type %u not available."),
+			     (unsigned)cr->cr_type);
+		return NULL;
+	}
+
+	compress = pgm_new0 (struct pgm_compress_t, 1);
+	compress->type		= cr->cr_type;
+	compress->level		= cr->cr_level;
+	compress->dict_id	= (uint16_t)cr->cr_dict_id;
+	compress->dict		= cr->cr_dict;
+	compress->dict_len	= cr->cr_dict_len;
+
+	switch (compress->type) {
+#ifdef HAVE_ZLIB_H
+	case PGM_COMPRESS_ZLIB:
+		if (Z_OK != deflateInit2 (&compress->deflate,
+					  compress->level ? compress->level : Z_DEFAULT_COMPRESSION,
+					  Z_DEFLATED,
+					  COMPRESS_ZLIB_WINDOW_BITS,
+					  COMPRESS_ZLIB_MEM_LEVEL,
+					  Z_DEFAULT_STRATEGY))
+			goto err_nomem;
+		compress->has_deflate = 1;
+		break;
+#endif
+#ifdef HAVE_ZSTD_H
+	case PGM_COMPRESS_ZSTD:
+		compress->cctx = ZSTD_createCCtx();
+		if (NULL == compress->cctx)
+			goto err_nomem;
+		if (compress->dict_len) {
+			compress->cdict = ZSTD_createCDict (compress->dict, compress->dict_len,
+							    compress->level ? compress->level : ZSTD_CLEVEL_DEFAULT);
+			if (NULL == compress->cdict)
+				goto err_nomem;
+		}
+		break;
+#endif
+	default:
+		pgm_assert_not_reached();
+		break;
+	}
+	pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Compressing APDUs with type %u, dictionary %u of %" PRIzu " bytes."),
+		   compress->type, compress->dict_id, compress->dict_len);
+	return compress;
+
+#if defined(HAVE_ZLIB_H) || defined(HAVE_ZSTD_H)
+err_nomem:
+	pgm_set_error (error,
+		     PGM_ERROR_DOMAIN_SOCKET,
+		     PGM_ERROR_NOMEM,
+		     _("Creating compression context."));
+	pgm_compress_destroy (compress);
+	return NULL;
+#endif
+}
+
+PGM_GNUC_INTERNAL
+void
+pgm_compress_destroy (
+	struct pgm_compress_t*	compress
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != compress);
+
+#ifdef HAVE_ZLIB_H
+	if (compress->has_deflate)
+		deflateEnd (&compress->deflate);
+	if (compress->has_inflate)
+		inflateEnd (&compress->inflate);
+#endif
+#ifdef HAVE_ZSTD_H
+	if (compress->cctx)
+		ZSTD_freeCCtx (compress->cctx);
+	if (compress->cdict)
+		ZSTD_freeCDict (compress->cdict);
+	if (compress->dctx)
+		ZSTD_freeDCtx (compress->dctx);
+	if (compress->ddict)
+		ZSTD_freeDDict (compress->ddict);
+#endif
+	pgm_free (compress);
+}
+
+/* compress src into at most dst_len bytes of dst.
+ *
+ * returns compressed length, or 0 if the result does not fit.
+ */
+
+PGM_GNUC_INTERNAL
+size_t
+pgm_compress (
+	struct pgm_compress_t* const restrict compress,
+	const void*		     restrict src,
+	const size_t			      src_len,
+	void*			     restrict dst,
+	const size_t			      dst_len
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != compress);
+	pgm_assert (NULL != src);
+	pgm_assert (NULL != dst);
+
+	switch (compress->type) {
+#ifdef HAVE_ZLIB_H
+	case PGM_COMPRESS_ZLIB: {
+		z_stream* zs = &compress->deflate;
+		if (Z_OK != deflateReset (zs))
+			return 0;
+		if (compress->dict_len &&
+		    Z_OK != deflateSetDictionary (zs, compress->dict, (uInt)compress->dict_len))
+			return 0;
+		zs->next_in	= src;
+		zs->avail_in	= (uInt)src_len;
+		zs->next_out	= dst;
+		zs->avail_out	= (uInt)dst_len;
+		if (Z_STREAM_END != deflate (zs, Z_FINISH))
+			return 0;
+		return zs->total_out;
+	}
+#endif
+#ifdef HAVE_ZSTD_H
+	case PGM_COMPRESS_ZSTD: {
+		const size_t len = compress->cdict ?
+			ZSTD_compress_usingCDict (compress->cctx, dst, dst_len, src, src_len, compress->cdict) :
+			ZSTD_compressCCtx (compress->cctx, dst, dst_len, src, src_len,
+					   compress->level ? compress->level : ZSTD_CLEVEL_DEFAULT);
+		return ZSTD_isError (len) ? 0 : len;
+	}
+#endif
+	default:
+#if !defined(HAVE_ZLIB_H) && !defined(HAVE_ZSTD_H)
+		(void)src;
+		(void)src_len;
+		(void)dst;
+		(void)dst_len;
+#endif
+		return 0;
+	}
+}
+
+/* decompress the APDU gathered from count buffers of src into exactly dst_len
+ * bytes of dst, with the dictionary of dict_id or none for 0.
+ *
+ * returns TRUE on success, or FALSE for an unavailable type, another dictionary
+ * or corrupt data.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_decompress (
+	struct pgm_compress_t*	const restrict compress,
+	const unsigned			       type,
+	const uint16_t			       dict_id,
+	const struct pgm_iovec*	      restrict src,
+	const unsigned			       count,
+	void*			      restrict dst,
+	const size_t			       dst_len
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != compress);
+	pgm_assert (NULL != src);
+	pgm_assert_cmpuint (count, >, 0);
+	pgm_assert (NULL != dst);
+
+	if (0 != dict_id && dict_id != compress->dict_id)
+		return FALSE;
+
+	switch (type) {
+#ifdef HAVE_ZLIB_H
+	case PGM_COMPRESS_ZLIB: {
+		z_stream* zs = &compress->inflate;
+		int status = Z_OK;
+		if (!compress->has_inflate) {
+			if (Z_OK != inflateInit2 (zs, COMPRESS_ZLIB_WINDOW_BITS))
+				return FALSE;
+			compress->has_inflate = 1;
+		} else if (Z_OK != inflateReset (zs))
+			return FALSE;
+		if (0 != dict_id &&
+		    Z_OK != inflateSetDictionary (zs, compress->dict, (uInt)compress->dict_len))
+			return FALSE;
+		zs->next_out	= dst;
+		zs->avail_out	= (uInt)dst_len;
+		for (unsigned i = 0; i < count; i++) {
+/* trailing data after the stream end */
+			if (Z_STREAM_END == status)
+				return FALSE;
+			zs->next_in	= src[i].iov_base;
+			zs->avail_in	= (uInt)src[i].iov_len;
+			status = inflate (zs, Z_NO_FLUSH);
+			if (Z_OK != status && Z_STREAM_END != status)
+				return FALSE;
+		}
+		return (Z_STREAM_END == status && 0 == zs->avail_in && dst_len == zs->total_out);
+	}
+#endif
+#ifdef HAVE_ZSTD_H
+	case PGM_COMPRESS_ZSTD: {
+		ZSTD_outBuffer out = { dst, dst_len, 0 };
+		size_t remaining = 1;
+		if (NULL == compress->dctx) {
+			compress->dctx = ZSTD_createDCtx();
+			if (NULL == compress->dctx)
+				return FALSE;
+		}
+		if (0 != dict_id && NULL == compress->ddict) {
+			compress->ddict = ZSTD_createDDict (compress->dict, compress->dict_len);
+			if (NULL == compress->ddict)
+				return FALSE;
+		}
+		ZSTD_DCtx_reset (compress->dctx, ZSTD_reset_session_and_parameters);
+		if (0 != dict_id)
+			ZSTD_DCtx_refDDict (compress->dctx, compress->ddict);
+		for (unsigned i = 0; i < count; i++) {
+			ZSTD_inBuffer in = { src[i].iov_base, src[i].iov_len, 0 };
+			while (in.pos < in.size) {
+				const size_t in_pos = in.pos, out_pos = out.pos;
+/* trailing data after the frame end */
+				if (0 == remaining)
+					return FALSE;
+				remaining = ZSTD_decompressStream (compress->dctx, &out, &in);
+				if (ZSTD_isError (remaining) ||
+				    (in_pos == in.pos && out_pos == out.pos))
+					return FALSE;
+			}
+		}
+		return (0 == remaining && dst_len == out.pos);
+	}
+#endif
+	default:
+#if !defined(HAVE_ZLIB_H) && !defined(HAVE_ZSTD_H)
+		(void)src;
+		(void)count;
+		(void)dst;
+		(void)dst_len;
+#endif
+		return FALSE;
+	}
+}
+
+/* eof */
@@ -0,0 +1,236 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * unit tests for APDU payload compression.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <check.h>
+
+#define COMPRESS_DEBUG
+#include "compress.c"
+
+#ifdef _WIN32
+#	define PGM_CHECK_NOFORK		1
+#endif
+
+#define TEST_DICT_ID		7
+
+static const char mock_dict[] = "{\"symbol\":\"VOD\",\"price\":,\"quantity\":,\"side\":\"buy\"}";
+
+/* repetitive message sharing fields with the dictionary */
+static
+size_t
+generate_apdu (
+	char*		buf,
+	const size_t	len
+	)
+{
+	size_t offset = 0;
+	unsigned i = 0;
+	while (offset < len) {
+		const int n = snprintf (buf + offset, len - offset, "{\"symbol\":\"VOD\",\"price\":%u,\"quantity\":%u,\"side\":\"buy\"}", i, i * 7);
+		offset += MIN((size_t)n, len - offset);
+		i++;
+	}
+	return len;
+}
+
+static
+struct pgm_compress_t*
+generate_compress (
+	const unsigned		type,
+	const uint16_t		dict_id
+	)
+{
+	struct pgm_compress_req_t cr;
+	memset (&cr, 0, sizeof(cr));
+	cr.cr_type = type;
+	if (dict_id) {
+		cr.cr_dict_id  = dict_id;
+		cr.cr_dict     = mock_dict;
+		cr.cr_dict_len = sizeof(mock_dict);
+	}
+	return pgm_compress_new (&cr, NULL);
+}
+
+#ifdef HAVE_ZLIB_H
+
+/* target:
+ *	size_t
+ *	pgm_compress (
+ *		struct pgm_compress_t*	compress,
+ *		const void*		src,
+ *		const size_t		src_len,
+ *		void*			dst,
+ *		const size_t		dst_len
+ *	)
+ *
+ *	bool
+ *	pgm_decompress (
+ *		struct pgm_compress_t*	compress,
+ *		const unsigned		type,
+ *		const uint16_t		dict_id,
+ *		const struct pgm_iovec*	src,
+ *		const unsigned		count,
+ *		void*			dst,
+ *		const size_t		dst_len
+ *	)
+ */
+
+/* round trip with the dictionary, input gathered from fragments */
+START_TEST (test_compress_pass_001)
+{
+	char apdu[4000], packed[4000], unpacked[4000];
+	struct pgm_compress_t* compress = generate_compress (PGM_COMPRESS_ZLIB, TEST_DICT_ID);
+	fail_if (NULL == compress, "new failed");
+	generate_apdu (apdu, sizeof(apdu));
+	const size_t len = pgm_compress (compress, apdu, sizeof(apdu), packed, sizeof(packed));
+	fail_unless (len > 0 && len < sizeof(apdu), "compress failed");
+	struct pgm_iovec src[3];
+	src[0].iov_base = packed;		src[0].iov_len = 1;
+	src[1].iov_base = packed + 1;		src[1].iov_len = len / 2;
+	src[2].iov_base = packed + 1 + len / 2;	src[2].iov_len = len - 1 - len / 2;
+	fail_unless (TRUE == pgm_decompress (compress, PGM_COMPRESS_ZLIB, TEST_DICT_ID, src, G_N_ELEMENTS(src), unpacked, sizeof(unpacked)), "decompress failed");
+	fail_unless (0 == memcmp (apdu, unpacked, sizeof(apdu)), "data mismatch");
+/* repeated on the same context */
+	fail_unless (len == pgm_compress (compress, apdu, sizeof(apdu), packed, sizeof(packed)), "compress failed");
+	fail_unless (TRUE == pgm_decompress (compress, PGM_COMPRESS_ZLIB, TEST_DICT_ID, src, G_N_ELEMENTS(src), unpacked, sizeof(unpacked)), "decompress failed");
+	pgm_compress_destroy (compress);
+}
+END_TEST
+
+/* the dictionary makes a difference to short messages */
+START_TEST (test_compress_pass_002)
+{
+	char apdu[200], packed[200];
+	struct pgm_compress_t* plain = generate_compress (PGM_COMPRESS_ZLIB, 0);
+	struct pgm_compress_t* primed = generate_compress (PGM_COMPRESS_ZLIB, TEST_DICT_ID);
+	generate_apdu (apdu, sizeof(apdu));
+	const size_t plain_len = pgm_compress (plain, apdu, sizeof(apdu), packed, sizeof(packed));
+	const size_t primed_len = pgm_compress (primed, apdu, sizeof(apdu), packed, sizeof(packed));
+	fail_unless (primed_len > 0 && primed_len < plain_len, "dictionary not used");
+	pgm_compress_destroy (plain);
+	pgm_compress_destroy (primed);
+}
+END_TEST
+
+/* output that does not fit */
+START_TEST (test_compress_fail_001)
+{
+	char apdu[1000], packed[16];
+	struct pgm_compress_t* compress = generate_compress (PGM_COMPRESS_ZLIB, 0);
+	for (unsigned i = 0; i < sizeof(apdu); i++)
+		apdu[i] = (char)(i * 2654435761U >> 13);
+	fail_unless (0 == pgm_compress (compress, apdu, sizeof(apdu), packed, sizeof(packed)), "compress succeeded");
+	pgm_compress_destroy (compress);
+}
+END_TEST
+
+/* another dictionary, wrong length, unavailable type or trailing data */
+START_TEST (test_decompress_fail_001)
+{
+	char apdu[1000], packed[1100], unpacked[1000];
+	struct pgm_compress_t* compress = generate_compress (PGM_COMPRESS_ZLIB, TEST_DICT_ID);
+	generate_apdu (apdu, sizeof(apdu));
+	const size_t len = pgm_compress (compress, apdu, sizeof(apdu), packed, sizeof(packed));
+	struct pgm_iovec src = { .iov_base = packed, .iov_len = len };
+	fail_unless (FALSE == pgm_decompress (compress, PGM_COMPRESS_ZLIB, TEST_DICT_ID + 1, &src, 1, unpacked, sizeof(unpacked)), "other dictionary");
+	fail_unless (FALSE == pgm_decompress (compress, PGM_COMPRESS_ZLIB, 0, &src, 1, unpacked, sizeof(unpacked)), "no dictionary");
+	fail_unless (FALSE == pgm_decompress (compress, PGM_COMPRESS_ZLIB, TEST_DICT_ID, &src, 1, unpacked, sizeof(unpacked) - 1), "short length");
+	fail_unless (FALSE == pgm_decompress (compress, PGM_COMPRESS_NONE, TEST_DICT_ID, &src, 1, unpacked, sizeof(unpacked)), "unavailable type");
+	packed[len] = 0;
+	src.iov_len = len + 1;
+	fail_unless (FALSE == pgm_decompress (compress, PGM_COMPRESS_ZLIB, TEST_DICT_ID, &src, 1, unpacked, sizeof(unpacked)), "trailing data");
+	pgm_compress_destroy (compress);
+}
+END_TEST
+#endif /* HAVE_ZLIB_H */
+
+/* target:
+ *	struct pgm_compress_t*
+ *	pgm_compress_new (
+ *		const struct pgm_compress_req_t*	cr,
+ *		pgm_error_t**				error
+ *	)
+ */
+
+START_TEST (test_new_fail_001)
+{
+	pgm_error_t* err = NULL;
+	struct pgm_compress_req_t cr;
+	memset (&cr, 0, sizeof(cr));
+	cr.cr_type = PGM_COMPRESS_NONE;
+	fail_unless (NULL == pgm_compress_new (&cr, &err), "new succeeded");
+	fail_if (NULL == err, "error not set");
+	pgm_error_free (err);
+}
+END_TEST
+
+
+static
+Suite*
+make_test_suite (void)
+{
+	Suite* s;
+
+	s = suite_create (__FILE__);
+
+	TCase* tc_new = tcase_create ("new");
+	suite_add_tcase (s, tc_new);
+	tcase_add_test (tc_new, test_new_fail_001);
+
+	TCase* tc_compress = tcase_create ("compress");
+	suite_add_tcase (s, tc_compress);
+#ifdef HAVE_ZLIB_H
+	tcase_add_test (tc_compress, test_compress_pass_001);
+	tcase_add_test (tc_compress, test_compress_pass_002);
+	tcase_add_test (tc_compress, test_compress_fail_001);
+	tcase_add_test (tc_compress, test_decompress_fail_001);
+#endif
+	return s;
+}
+
+static
+Suite*
+make_master_suite (void)
+{
+	Suite* s = suite_create ("Master");
+	return s;
+}
+
+int
+main (void)
+{
+	pgm_messages_init();
+	SRunner* sr = srunner_create (make_master_suite ());
+	srunner_add_suite (sr, make_test_suite ());
+	srunner_run_all (sr, CK_ENV);
+	int number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	pgm_messages_shutdown();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof */
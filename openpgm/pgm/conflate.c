@@ -0,0 +1,202 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * Conflation of last-value feeds: each APDU carries a key, only the newest
+ * APDU of a key is of interest.  A table maps each key to the sequence number
+ * of its most recent APDU, for the source to link an APDU to its predecessor
+ * and for the receive window to supersede undelivered data.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <impl/i18n.h>
+#include <impl/framework.h>
+
+
+//#define CONFLATE_DEBUG
+
+#ifndef CONFLATE_DEBUG
+#	define PGM_DISABLE_ASSERT
+#endif
+
+#define CONFLATE_MIN_SLOTS	64
+#define CONFLATE_MAX_KEY_LEN	sizeof(uint64_t)
+
+/* open addressing with linear probing, the table doubles at three quarters
+ * load.  keys are never removed, a stale sequence number is recognised by the
+ * caller against its window.
+ */
+
+struct pgm_conflate_entry_t {
+	uint64_t		key;
+	uint32_t		sequence;
+	uint32_t		is_used;
+};
+
+struct pgm_conflate_t {
+	struct pgm_conflate_entry_t* entries;
+	unsigned		alloc;		/* slots, a power of two */
+	unsigned		len;		/* keys */
+};
+
+static inline
+unsigned
+conflate_hash (
+	const uint64_t		key,
+	const unsigned		alloc
+	)
+{
+	return (unsigned)((key * UINT64_C(0x9e3779b97f4a7c15)) >> 32) & (alloc - 1);
+}
+
+static
+struct pgm_conflate_entry_t*
+conflate_find (
+	const struct pgm_conflate_t* const	conflate,
+	const uint64_t				key
+	)
+{
+	unsigned i = conflate_hash (key, conflate->alloc);
+	while (conflate->entries[i].is_used) {
+		if (key == conflate->entries[i].key)
+			return &conflate->entries[i];
+		i = (i + 1) & (conflate->alloc - 1);
+	}
+	return &conflate->entries[i];
+}
+
+static
+void
+conflate_grow (
+	struct pgm_conflate_t* const	conflate
+	)
+{
+	struct pgm_conflate_entry_t* old_entries = conflate->entries;
+	const unsigned old_alloc = conflate->alloc;
+
+	conflate->alloc *= 2;
+	conflate->entries = pgm_new0 (struct pgm_conflate_entry_t, conflate->alloc);
+	for (unsigned i = 0; i < old_alloc; i++)
+		if (old_entries[i].is_used)
+			*conflate_find (conflate, old_entries[i].key) = old_entries[i];
+	pgm_free (old_entries);
+}
+
+PGM_GNUC_INTERNAL
+struct pgm_conflate_t*
+pgm_conflate_new (void)
+{
+	struct pgm_conflate_t* conflate = pgm_new0 (struct pgm_conflate_t, 1);
+	conflate->alloc = CONFLATE_MIN_SLOTS;
+	conflate->entries = pgm_new0 (struct pgm_conflate_entry_t, conflate->alloc);
+	return conflate;
+}
+
+PGM_GNUC_INTERNAL
+void
+pgm_conflate_destroy (
+	struct pgm_conflate_t* const	conflate
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != conflate);
+
+	pgm_free (conflate->entries);
+	pgm_free (conflate);
+}
+
+/* extract the key of an APDU of len bytes per request cr.
+ *
+ * returns TRUE on success, FALSE if the APDU is too short to hold a key.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_conflate_key (
+	const struct pgm_conflate_req_t* const restrict cr,
+	const void*			       restrict apdu,
+	const size_t					apdu_length,
+	uint64_t*			       restrict key
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != cr);
+	pgm_assert (NULL != key);
+	pgm_assert_cmpuint (cr->cf_len, >, 0);
+	pgm_assert_cmpuint (cr->cf_len, <=, CONFLATE_MAX_KEY_LEN);
+
+	if (NULL == apdu || (size_t)cr->cf_offset + cr->cf_len > apdu_length)
+		return FALSE;
+	*key = 0;
+	memcpy (key, (const char*)apdu + cr->cf_offset, cr->cf_len);
+	return TRUE;
+}
+
+/* returns TRUE setting sequence to the last sequence number of key, FALSE if
+ * the key has not been seen.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_conflate_lookup (
+	const struct pgm_conflate_t* const restrict conflate,
+	const uint64_t				    key,
+	uint32_t*		       restrict	    sequence
+	)
+{
+	const struct pgm_conflate_entry_t* entry;
+
+/* pre-conditions */
+	pgm_assert (NULL != conflate);
+	pgm_assert (NULL != sequence);
+
+	entry = conflate_find (conflate, key);
+	if (!entry->is_used)
+		return FALSE;
+	*sequence = entry->sequence;
+	return TRUE;
+}
+
+PGM_GNUC_INTERNAL
+void
+pgm_conflate_insert (
+	struct pgm_conflate_t* const	conflate,
+	const uint64_t			key,
+	const uint32_t			sequence
+	)
+{
+	struct pgm_conflate_entry_t* entry;
+
+/* pre-conditions */
+	pgm_assert (NULL != conflate);
+
+	entry = conflate_find (conflate, key);
+	if (!entry->is_used) {
+		if (4 * (conflate->len + 1) > 3 * conflate->alloc) {
+			conflate_grow (conflate);
+			entry = conflate_find (conflate, key);
+		}
+		entry->key = key;
+		entry->is_used = 1;
+		conflate->len++;
+	}
+	entry->sequence = sequence;
+}
+
+/* eof */
@@ -0,0 +1,162 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * unit tests for conflation keys.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <check.h>
+
+#define CONFLATE_DEBUG
+#include "conflate.c"
+
+#ifdef _WIN32
+#	define PGM_CHECK_NOFORK		1
+#endif
+
+
+/* target:
+ *	bool
+ *	pgm_conflate_key (
+ *		const struct pgm_conflate_req_t*	cr,
+ *		const void*				apdu,
+ *		const size_t				apdu_length,
+ *		uint64_t*				key
+ *	)
+ */
+
+START_TEST (test_key_pass_001)
+{
+	const char apdu[] = "VOD.L 123.4";
+	const struct pgm_conflate_req_t cr = { .cf_offset = 0, .cf_len = 5 };
+	uint64_t key = ~UINT64_C(0), expected = 0;
+	memcpy (&expected, "VOD.L", 5);
+	fail_unless (TRUE == pgm_conflate_key (&cr, apdu, strlen (apdu), &key), "key failed");
+	fail_unless (expected == key, "key mismatch");
+}
+END_TEST
+
+/* key beyond the end of the APDU */
+START_TEST (test_key_fail_001)
+{
+	const char apdu[] = "VOD.L";
+	const struct pgm_conflate_req_t cr = { .cf_offset = 2, .cf_len = 4 };
+	uint64_t key;
+	fail_unless (FALSE == pgm_conflate_key (&cr, apdu, strlen (apdu), &key), "key succeeded");
+	fail_unless (FALSE == pgm_conflate_key (&cr, NULL, 0, &key), "key succeeded");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_conflate_lookup (
+ *		const struct pgm_conflate_t*	conflate,
+ *		const uint64_t			key,
+ *		uint32_t*			sequence
+ *	)
+ *
+ *	void
+ *	pgm_conflate_insert (
+ *		struct pgm_conflate_t*		conflate,
+ *		const uint64_t			key,
+ *		const uint32_t			sequence
+ *	)
+ */
+
+/* zero is a key, a key is updated in place */
+START_TEST (test_insert_pass_001)
+{
+	struct pgm_conflate_t* conflate = pgm_conflate_new ();
+	uint32_t sequence;
+	fail_unless (FALSE == pgm_conflate_lookup (conflate, 0, &sequence), "lookup succeeded");
+	pgm_conflate_insert (conflate, 0, 10);
+	pgm_conflate_insert (conflate, 0, 11);
+	fail_unless (TRUE == pgm_conflate_lookup (conflate, 0, &sequence), "lookup failed");
+	fail_unless (11 == sequence, "sequence mismatch");
+	fail_unless (1 == conflate->len, "key duplicated");
+	pgm_conflate_destroy (conflate);
+}
+END_TEST
+
+/* growth keeps every key */
+START_TEST (test_insert_pass_002)
+{
+	struct pgm_conflate_t* conflate = pgm_conflate_new ();
+	uint32_t sequence;
+	for (uint32_t i = 0; i < 1000; i++)
+		pgm_conflate_insert (conflate, (uint64_t)i << 32, i);
+	fail_unless (conflate->alloc > CONFLATE_MIN_SLOTS, "not grown");
+	fail_unless (4 * conflate->len <= 3 * conflate->alloc, "overloaded");
+	for (uint32_t i = 0; i < 1000; i++) {
+		fail_unless (TRUE == pgm_conflate_lookup (conflate, (uint64_t)i << 32, &sequence), "lookup failed");
+		fail_unless (i == sequence, "sequence mismatch");
+	}
+	fail_unless (FALSE == pgm_conflate_lookup (conflate, 1, &sequence), "lookup succeeded");
+	pgm_conflate_destroy (conflate);
+}
+END_TEST
+
+
+static
+Suite*
+make_test_suite (void)
+{
+	Suite* s;
+
+	s = suite_create (__FILE__);
+
+	TCase* tc_key = tcase_create ("key");
+	suite_add_tcase (s, tc_key);
+	tcase_add_test (tc_key, test_key_pass_001);
+	tcase_add_test (tc_key, test_key_fail_001);
+
+	TCase* tc_insert = tcase_create ("insert");
+	suite_add_tcase (s, tc_insert);
+	tcase_add_test (tc_insert, test_insert_pass_001);
+	tcase_add_test (tc_insert, test_insert_pass_002);
+	return s;
+}
+
+static
+Suite*
+make_master_suite (void)
+{
+	Suite* s = suite_create ("Master");
+	return s;
+}
+
+int
+main (void)
+{
+	pgm_messages_init();
+	SRunner* sr = srunner_create (make_master_suite ());
+	srunner_add_suite (sr, make_test_suite ());
+	srunner_run_all (sr, CK_ENV);
+	int number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	pgm_messages_shutdown();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof */
@@ -0,0 +1,450 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * Congestion control algorithms driven by ACKer feedback.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <impl/framework.h>
+#include <impl/socket.h>
+
+
+//#define CONGESTION_DEBUG
+
+/* PGMCC, one elected ACKer clocks a TCP-like window: slow-start to ssthresh,
+ * linear increase thereafter and halving on loss.
+ */
+
+static
+void
+pgmcc_init (
+	pgm_sock_t*const	sock
+	)
+{
+/* start PGMCC with one token */
+	sock->tokens = sock->cwnd_size = pgm_fp8 (1);
+
+/* slow start threshold */
+	sock->ssthresh = pgm_fp8 (4);
+}
+
+static
+void
+pgmcc_on_ack (
+	pgm_sock_t*const	sock,
+	const pgm_time_t	now,
+	const unsigned		new_acks,
+	const uint32_t		rtt,
+	const bool		is_recovery
+	)
+{
+	uint_fast32_t n, token_inc;
+
+	(void)now;
+	(void)rtt;
+
+/* after loss detection cancel any further manipulation of the window
+ * until feedback is received for the next transmitted packet.
+ */
+	if (is_recovery)
+	{
+		pgm_trace (PGM_LOG_ROLE_CONGESTION_CONTROL,_("PGMCC window token manipulation suspended due to congestion (T:%u W:%u)"),
+			   pgm_fp8tou (sock->tokens), pgm_fp8tou (sock->cwnd_size));
+		token_inc = pgm_fp8mul (pgm_fp8 (new_acks), pgm_fp8 (1) + pgm_fp8div (pgm_fp8 (1), sock->cwnd_size));
+		sock->tokens = MIN( sock->tokens + token_inc, sock->cwnd_size );
+		return;
+	}
+
+/* no detected data loss at ACKer, increase congestion window size */
+	n = pgm_fp8 (new_acks);
+	token_inc = 0;
+
+/* slow-start phase, exponential increase to SSTHRESH */
+	if (sock->cwnd_size < sock->ssthresh) {
+		const uint_fast32_t d = MIN( n, sock->ssthresh - sock->cwnd_size );
+		n -= d;
+		token_inc	 = d + d;
+		sock->cwnd_size += d;
+	}
+
+	const uint_fast32_t iw = pgm_fp8div (pgm_fp8 (1), sock->cwnd_size);
+
+/* linear window increase */
+	token_inc	+= pgm_fp8mul (n, pgm_fp8 (1) + iw);
+	sock->cwnd_size += pgm_fp8mul (n, iw);
+	sock->tokens	 = MIN( sock->tokens + token_inc, sock->cwnd_size );
+//	pgm_trace (PGM_LOG_ROLE_CONGESTION_CONTROL,_("PGMCC++ (T:%u W:%u)"),
+//		   pgm_fp8tou (sock->tokens), pgm_fp8tou (sock->cwnd_size));
+}
+
+static
+void
+pgmcc_on_loss (
+	pgm_sock_t*const	sock,
+	const unsigned		acks
+	)
+{
+	(void)acks;
+
+	sock->cwnd_size = pgm_fp8div (sock->cwnd_size, pgm_fp8 (2));
+	if (sock->cwnd_size > sock->tokens)
+		sock->tokens = 0;
+	else
+		sock->tokens -= sock->cwnd_size;
+	pgm_trace (PGM_LOG_ROLE_CONGESTION_CONTROL,_("PGMCC congestion, half window size (T:%u W:%u)"),
+		   pgm_fp8tou (sock->tokens), pgm_fp8tou (sock->cwnd_size));
+}
+
+static
+void
+pgmcc_on_send (
+	pgm_sock_t*const	sock
+	)
+{
+	sock->tokens -= pgm_fp8 (1);
+}
+
+static
+void
+pgmcc_on_timeout (
+	pgm_sock_t*const	sock
+	)
+{
+	sock->tokens = sock->cwnd_size = pgm_fp8 (1);
+}
+
+static
+ssize_t
+pgmcc_pacing_rate (
+	const pgm_sock_t*const	sock
+	)
+{
+	(void)sock;
+	return 0;
+}
+
+/* BBR-style model, the window follows twice the bandwidth-delay product of the
+ * maximum delivery rate over the last PGM_CC_BBR_BW_ROUNDS round trips and the
+ * minimum ACKer round trip time, loss does not shrink the window.  startup
+ * doubles the window each round trip until the delivery rate stops growing by
+ * a quarter for three rounds.  original data is paced at the gain cycled
+ * delivery rate when ODATA rate regulation is enabled.
+ */
+
+#define PGM_CC_BBR_STARTUP_GAIN		739		/* 2/ln(2) in 8-bit fixed point */
+#define PGM_CC_BBR_CWND_GAIN		pgm_fp8 (2)
+#define PGM_CC_BBR_MIN_CWND		pgm_fp8 (4)
+#define PGM_CC_BBR_MAX_CWND		pgm_fp8 (UINT16_MAX)
+
+static const uint_fast32_t bbr_pacing_gain[] = {
+	320, 192, 256, 256, 256, 256, 256, 256		/* ⁵⁄₄ probe, ³⁄₄ drain, then cruise */
+};
+
+static
+void
+bbr_init (
+	pgm_sock_t*const	sock
+	)
+{
+	memset (&sock->bbr, 0, sizeof (sock->bbr));
+	sock->tokens = sock->cwnd_size = pgm_fp8 (1);
+	sock->ssthresh = PGM_CC_BBR_MAX_CWND;
+}
+
+static
+void
+bbr_update_model (
+	pgm_sock_t*const	sock,
+	const pgm_time_t	now,
+	const unsigned		new_acks,
+	const uint32_t		rtt
+	)
+{
+	struct pgm_cc_bbr_t* bbr = &sock->bbr;
+
+/* sub-millisecond loopback feedback counts as one millisecond */
+	const uint32_t rtt_sample = MAX(rtt, 1);
+	if (0 == bbr->min_rtt ||
+	    rtt_sample <= bbr->min_rtt ||
+	    pgm_time_after (now, bbr->min_rtt_stamp + PGM_CC_BBR_MIN_RTT_WIN))
+	{
+		bbr->min_rtt = rtt_sample;
+		bbr->min_rtt_stamp = now;
+	}
+
+/* acknowledgements are timed from the first ACK */
+	if (0 == bbr->round_start) {
+		bbr->round_start = now;
+		return;
+	}
+	bbr->round_acks += new_acks;
+	const pgm_time_t elapsed = now - bbr->round_start;
+	if (elapsed < pgm_msecs (bbr->min_rtt))
+		return;
+
+/* one round trip complete, take a delivery rate sample */
+	const uint64_t sample = ((uint64_t)pgm_fp8 (bbr->round_acks) * 1000) / elapsed;
+	bbr->bw[ bbr->bw_index ] = (uint32_t)MIN(sample, UINT32_MAX);
+	bbr->bw_index = (bbr->bw_index + 1) % PGM_CC_BBR_BW_ROUNDS;
+	bbr->max_bw = 0;
+	for (unsigned i = 0; i < PGM_CC_BBR_BW_ROUNDS; i++)
+		bbr->max_bw = MAX(bbr->max_bw, bbr->bw[ i ]);
+	bbr->round_start = now;
+	bbr->round_acks = 0;
+
+	if (!bbr->is_filled_pipe)
+	{
+		if ((uint64_t)bbr->max_bw * 4 >= (uint64_t)bbr->full_bw * 5) {
+			bbr->full_bw = bbr->max_bw;
+			bbr->full_bw_rounds = 0;
+		} else if (++bbr->full_bw_rounds >= 3) {
+			bbr->is_filled_pipe = TRUE;
+			pgm_trace (PGM_LOG_ROLE_CONGESTION_CONTROL,_("BBR pipe filled at %u packets per second, RTT %ums."),
+				   pgm_fp8tou (bbr->max_bw * 1000), bbr->min_rtt);
+		}
+	}
+	else
+		bbr->cycle_index = (bbr->cycle_index + 1) % PGM_N_ELEMENTS(bbr_pacing_gain);
+}
+
+static
+void
+bbr_on_ack (
+	pgm_sock_t*const	sock,
+	const pgm_time_t	now,
+	const unsigned		new_acks,
+	const uint32_t		rtt,
+	const bool		is_recovery
+	)
+{
+	const struct pgm_cc_bbr_t* bbr = &sock->bbr;
+	uint_fast32_t target, token_inc;
+
+	(void)is_recovery;
+
+	bbr_update_model (sock, now, new_acks, rtt);
+
+	token_inc = pgm_fp8 (new_acks);
+	if (!bbr->is_filled_pipe) {
+		target = PGM_CC_BBR_MAX_CWND;
+	} else {
+		const uint64_t bdp = (uint64_t)bbr->max_bw * bbr->min_rtt;
+		target = (uint_fast32_t)MIN(pgm_fp8mul (PGM_CC_BBR_CWND_GAIN, MIN(bdp, PGM_CC_BBR_MAX_CWND)), PGM_CC_BBR_MAX_CWND);
+		target = MAX(target, PGM_CC_BBR_MIN_CWND);
+	}
+
+/* grow towards the target by the acknowledged packets, shrink immediately */
+	if (sock->cwnd_size < target) {
+		const uint_fast32_t d = MIN(token_inc, target - sock->cwnd_size);
+		sock->cwnd_size += d;
+		token_inc += d;
+	} else {
+		sock->cwnd_size = target;
+	}
+	sock->tokens = MIN( sock->tokens + token_inc, sock->cwnd_size );
+}
+
+static
+void
+bbr_on_loss (
+	pgm_sock_t*const	sock,
+	const unsigned		acks
+	)
+{
+/* acknowledgements held back pending loss detection still release tokens */
+	sock->tokens = MIN( sock->tokens + pgm_fp8 (acks), sock->cwnd_size );
+	pgm_trace (PGM_LOG_ROLE_CONGESTION_CONTROL,_("BBR loss ignored (T:%u W:%u)"),
+		   pgm_fp8tou (sock->tokens), pgm_fp8tou (sock->cwnd_size));
+}
+
+static
+void
+bbr_on_send (
+	pgm_sock_t*const	sock
+	)
+{
+	sock->tokens -= pgm_fp8 (1);
+}
+
+static
+ssize_t
+bbr_pacing_rate (
+	const pgm_sock_t*const	sock
+	)
+{
+	const struct pgm_cc_bbr_t* bbr = &sock->bbr;
+
+	if (0 == bbr->max_bw)
+		return 0;
+	const uint_fast32_t gain = bbr->is_filled_pipe ? bbr_pacing_gain[ bbr->cycle_index ] : PGM_CC_BBR_STARTUP_GAIN;
+	const uint64_t rate = ((uint64_t)bbr->max_bw * gain * 1000 * sock->max_tpdu) >> 16;
+	return (ssize_t)MIN(rate, INT32_MAX);
+}
+
+static const struct pgm_cc_ops_t pgm_cc_pgmcc = {
+	pgmcc_init,
+	pgmcc_on_ack,
+	pgmcc_on_loss,
+	pgmcc_on_send,
+	pgmcc_on_timeout,
+	pgmcc_pacing_rate
+};
+
+static const struct pgm_cc_ops_t pgm_cc_bbr = {
+	bbr_init,
+	bbr_on_ack,
+	bbr_on_loss,
+	bbr_on_send,
+	bbr_init,
+	bbr_pacing_rate
+};
+
+/* ACKer candidate has not reported within the ACK expiry interval.
+ */
+
+static inline
+bool
+acker_is_stale (
+	const pgm_sock_t*const		restrict sock,
+	const struct pgm_acker_t*const	restrict candidate,
+	const pgm_time_t			 now
+	)
+{
+	return pgm_time_after (now, candidate->last_feedback + sock->ack_expiry_ivl);
+}
+
+/* ACKer election on receiver feedback, a fixed PGM_ACKER_TABLE_SIZE scan per
+ * report.  the table holds the receivers with the worst throughput estimate,
+ * feedback from an untracked receiver only displaces a free, silent or better
+ * candidate.  estimates are smoothed so one report does not trigger handover,
+ * the ACKer changes when a candidate exceeds it by PGM_ACKER_HYSTERESIS or
+ * when the ACKer has been silent for the ACK expiry interval.
+ *
+ * returns TRUE if peer is the elected ACKer.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_cc_on_feedback (
+	pgm_sock_t*const	     restrict sock,
+	const struct sockaddr*const restrict peer_nla,
+	const pgm_time_t		      now,
+	const uint32_t			      rtt,
+	const uint16_t			      loss_rate
+	)
+{
+	struct pgm_acker_t *peer = NULL, *acker = NULL, *victim = NULL;
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != peer_nla);
+
+	const bool has_acker = !pgm_sockaddr_is_addr_unspecified ((const struct sockaddr*)&sock->acker_nla);
+
+	for (unsigned i = 0; i < PGM_ACKER_TABLE_SIZE; i++)
+	{
+		struct pgm_acker_t* candidate = &sock->acker_table[ i ];
+		if (0 != candidate->last_feedback)
+		{
+			if (0 == pgm_sockaddr_cmp (peer_nla, (const struct sockaddr*)&candidate->nla))
+				peer = candidate;
+			if (has_acker &&
+			    0 == pgm_sockaddr_cmp ((const struct sockaddr*)&sock->acker_nla, (const struct sockaddr*)&candidate->nla))
+			{
+				acker = candidate;
+				continue;		/* never displace the ACKer */
+			}
+		}
+/* replacement preference: free slot, silent receiver, lowest estimate */
+		if (NULL == victim ||
+		    (0 != victim->last_feedback &&
+		     (0 == candidate->last_feedback ||
+		      (!acker_is_stale (sock, victim, now) &&
+		       (acker_is_stale (sock, candidate, now) || candidate->loss < victim->loss)))))
+		{
+			victim = candidate;
+		}
+	}
+
+	if (NULL == peer)
+	{
+		const uint64_t peer_loss = (uint64_t)rtt * rtt * loss_rate;
+		if (NULL == victim)
+			return FALSE;
+/* not amongst the worst receivers */
+		if (0 != victim->last_feedback &&
+		    !acker_is_stale (sock, victim, now) &&
+		    peer_loss <= victim->loss)
+		{
+			return FALSE;
+		}
+		peer = victim;
+		memcpy (&peer->nla, peer_nla, pgm_sockaddr_len (peer_nla));
+		peer->rtt = rtt;
+		peer->loss_rate = loss_rate;
+	}
+	else
+	{
+/* exponentially weighted moving average, α = ⅛ */
+		peer->rtt	= (uint32_t)((int64_t)peer->rtt + ((int64_t)rtt - (int64_t)peer->rtt) / 8);
+		peer->loss_rate = (uint32_t)((int32_t)peer->loss_rate + ((int32_t)loss_rate - (int32_t)peer->loss_rate) / 8);
+	}
+	peer->loss = (uint64_t)peer->rtt * peer->rtt * peer->loss_rate;
+	peer->last_feedback = now;
+
+/* ACKer elections */
+	if (PGM_UNLIKELY(NULL == acker))
+	{
+		pgm_trace (PGM_LOG_ROLE_CONGESTION_CONTROL,_("Elected first ACKer"));
+		memcpy (&sock->acker_nla, peer_nla, pgm_sockaddr_len (peer_nla));
+		acker = peer;
+	}
+	else if (peer != acker &&
+		 (peer->loss > PGM_ACKER_HYSTERESIS(acker->loss) || acker_is_stale (sock, acker, now)))
+	{
+		pgm_trace (PGM_LOG_ROLE_CONGESTION_CONTROL,_("Elected new ACKer"));
+		memcpy (&sock->acker_nla, peer_nla, pgm_sockaddr_len (peer_nla));
+		acker = peer;
+	}
+
+	if (peer != acker)
+		return FALSE;
+
+/* update ACKer state */
+	sock->acker_loss = peer->loss;
+	return TRUE;
+}
+
+/* returns operations of PGM_CC_* algorithm.
+ */
+
+PGM_GNUC_INTERNAL
+const struct pgm_cc_ops_t*
+pgm_cc_get (
+	const unsigned		algorithm
+	)
+{
+	switch (algorithm) {
+	case PGM_CC_BBR:	return &pgm_cc_bbr;
+	default:		return &pgm_cc_pgmcc;
+	}
+}
+
+/* eof */
@@ -0,0 +1,268 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * unit tests for congestion control algorithms.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#ifndef _WIN32
+#	include <netinet/in.h>
+#	include <arpa/inet.h>
+#endif
+#include <glib.h>
+#include <check.h>
+
+#ifdef _WIN32
+#	define PGM_CHECK_NOFORK		1
+#endif
+
+
+/* mock state */
+
+#define TEST_MAX_TPDU		1500
+
+
+/* mock functions for external references */
+
+#define CONGESTION_DEBUG
+#include "congestion.c"
+
+static
+struct pgm_sock_t*
+generate_sock (
+	const unsigned		algorithm
+	)
+{
+	struct pgm_sock_t* sock = g_new0 (struct pgm_sock_t, 1);
+	sock->max_tpdu = TEST_MAX_TPDU;
+	sock->acker_nla.ss_family = AF_INET;
+	sock->ack_expiry_ivl = pgm_secs (3);
+	sock->cc_algorithm = algorithm;
+	sock->cc = pgm_cc_get (algorithm);
+	sock->cc->init (sock);
+	return sock;
+}
+
+/* receiver address 127.0.0.n
+ */
+
+static
+const struct sockaddr*
+generate_nla (
+	const unsigned		n
+	)
+{
+	struct sockaddr_in* sin = g_new0 (struct sockaddr_in, 1);
+	sin->sin_family = AF_INET;
+	sin->sin_addr.s_addr = htonl (INADDR_LOOPBACK + n);
+	return (const struct sockaddr*)sin;
+}
+
+/* target:
+ *	const struct pgm_cc_ops_t*
+ *	pgm_cc_get (
+ *		const unsigned		algorithm
+ *	)
+ */
+
+START_TEST (test_get_pass_001)
+{
+	fail_unless (&pgm_cc_pgmcc == pgm_cc_get (PGM_CC_PGMCC), "pgmcc not found");
+	fail_unless (&pgm_cc_bbr == pgm_cc_get (PGM_CC_BBR), "bbr not found");
+/* unknown algorithms fall back to PGMCC */
+	fail_unless (&pgm_cc_pgmcc == pgm_cc_get (PGM_CC_BBR + 1), "unknown not pgmcc");
+}
+END_TEST
+
+/* target:
+ *	PGMCC operations
+ */
+
+/* slow start to ssthresh then half window on loss */
+START_TEST (test_pgmcc_pass_001)
+{
+	pgm_sock_t* sock = generate_sock (PGM_CC_PGMCC);
+	fail_unless (pgm_fp8 (1) == sock->tokens, "initial tokens");
+	fail_unless (pgm_fp8 (1) == sock->cwnd_size, "initial window");
+	sock->cc->on_send (sock);
+	fail_unless (0 == sock->tokens, "token not consumed");
+	sock->cc->on_ack (sock, pgm_secs (1), 3, 10, FALSE);
+	fail_unless (pgm_fp8 (4) == sock->cwnd_size, "window not at ssthresh");
+	fail_unless (pgm_fp8 (4) == sock->tokens, "tokens not at window");
+	sock->cc->on_loss (sock, 3);
+	fail_unless (pgm_fp8 (2) == sock->cwnd_size, "window not halved");
+	fail_unless (pgm_fp8 (2) == sock->tokens, "tokens not reduced");
+/* recovery releases tokens without growing the window */
+	sock->cc->on_ack (sock, pgm_secs (1), 1, 10, TRUE);
+	fail_unless (pgm_fp8 (2) == sock->cwnd_size, "window grew in recovery");
+	fail_unless (0 == sock->cc->pacing_rate (sock), "pgmcc paced");
+	sock->cc->on_timeout (sock);
+	fail_unless (pgm_fp8 (1) == sock->cwnd_size, "window not reset");
+}
+END_TEST
+
+/* target:
+ *	BBR operations
+ */
+
+/* constant delivery of 10 packets per millisecond at a 10ms round trip
+ * settles the window at twice the 100 packet bandwidth-delay product.
+ */
+START_TEST (test_bbr_pass_001)
+{
+	pgm_sock_t* sock = generate_sock (PGM_CC_BBR);
+	pgm_time_t now = pgm_secs (1);
+	fail_unless (0 == sock->cc->pacing_rate (sock), "paced without a model");
+	for (unsigned i = 0; i < 200; i++) {
+		now += pgm_msecs (1);
+		sock->cc->on_ack (sock, now, 10, 10, FALSE);
+	}
+	fail_unless (sock->bbr.is_filled_pipe, "startup not complete");
+	fail_unless (10 == sock->bbr.min_rtt, "min rtt");
+	fail_unless (pgm_fp8 (10) == sock->bbr.max_bw, "max bandwidth");
+	fail_unless (pgm_fp8 (200) == sock->cwnd_size, "window not at 2 bdp");
+	const ssize_t rate = sock->cc->pacing_rate (sock);
+	fail_unless (rate >= (10000 * TEST_MAX_TPDU * 3) / 4 && rate <= (10000 * TEST_MAX_TPDU * 5) / 4, "pacing rate");
+}
+END_TEST
+
+/* loss releases held tokens and keeps the window */
+START_TEST (test_bbr_pass_002)
+{
+	pgm_sock_t* sock = generate_sock (PGM_CC_BBR);
+	sock->cc->on_ack (sock, pgm_secs (1), 7, 10, FALSE);
+	const uint32_t cwnd_size = sock->cwnd_size;
+	sock->tokens = 0;
+	sock->cc->on_loss (sock, 3);
+	fail_unless (cwnd_size == sock->cwnd_size, "window changed on loss");
+	fail_unless (pgm_fp8 (3) == sock->tokens, "tokens not released");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_cc_on_feedback (
+ *		pgm_sock_t*const		sock,
+ *		const struct sockaddr*const	peer_nla,
+ *		const pgm_time_t		now,
+ *		const uint32_t			rtt,
+ *		const uint16_t			loss_rate
+ *	)
+ */
+
+/* handover only beyond the hysteresis margin */
+START_TEST (test_on_feedback_pass_001)
+{
+	pgm_sock_t* sock = generate_sock (PGM_CC_PGMCC);
+	const struct sockaddr* a = generate_nla (1);
+	const struct sockaddr* b = generate_nla (2);
+	pgm_time_t now = pgm_secs (1);
+	fail_unless (TRUE == pgm_cc_on_feedback (sock, a, now, 10, 100), "first acker not elected");
+	fail_unless (0 == pgm_sockaddr_cmp (a, (struct sockaddr*)&sock->acker_nla), "acker address");
+	fail_unless (10 * 10 * 100 == sock->acker_loss, "acker loss");
+	fail_unless (FALSE == pgm_cc_on_feedback (sock, b, now, 10, 110), "handover within margin");
+	fail_unless (TRUE == pgm_cc_on_feedback (sock, a, now, 10, 100), "acker lost election");
+	fail_unless (TRUE == pgm_cc_on_feedback (sock, b, now, 20, 100), "worse receiver not elected");
+	fail_unless (0 == pgm_sockaddr_cmp (b, (struct sockaddr*)&sock->acker_nla), "acker address");
+	fail_unless (FALSE == pgm_cc_on_feedback (sock, a, now, 10, 100), "previous acker still elected");
+}
+END_TEST
+
+/* silent acker replaced by next report */
+START_TEST (test_on_feedback_pass_002)
+{
+	pgm_sock_t* sock = generate_sock (PGM_CC_PGMCC);
+	const struct sockaddr* a = generate_nla (1);
+	const struct sockaddr* b = generate_nla (2);
+	pgm_time_t now = pgm_secs (1);
+	fail_unless (TRUE == pgm_cc_on_feedback (sock, a, now, 100, 1000), "first acker not elected");
+	fail_unless (FALSE == pgm_cc_on_feedback (sock, b, now, 1, 0), "better receiver elected");
+	now += sock->ack_expiry_ivl + 1;
+	fail_unless (TRUE == pgm_cc_on_feedback (sock, b, now, 1, 0), "silent acker kept");
+}
+END_TEST
+
+/* table of worse receivers ignores better report */
+START_TEST (test_on_feedback_pass_003)
+{
+	pgm_sock_t* sock = generate_sock (PGM_CC_PGMCC);
+	pgm_time_t now = pgm_secs (1);
+	for (unsigned i = 0; i < PGM_ACKER_TABLE_SIZE; i++)
+		(void)pgm_cc_on_feedback (sock, generate_nla (i + 1), now, 10, 100);
+	const struct sockaddr* c = generate_nla (PGM_ACKER_TABLE_SIZE + 1);
+	fail_unless (FALSE == pgm_cc_on_feedback (sock, c, now, 10, 10), "better receiver elected");
+	for (unsigned i = 0; i < PGM_ACKER_TABLE_SIZE; i++)
+		fail_if (0 == pgm_sockaddr_cmp (c, (struct sockaddr*)&sock->acker_table[ i ].nla), "better receiver tracked");
+/* worse receiver displaces a candidate */
+	fail_unless (TRUE == pgm_cc_on_feedback (sock, c, now, 100, 100), "worse receiver not elected");
+}
+END_TEST
+
+static
+Suite*
+make_test_suite (void)
+{
+	Suite* s;
+
+	s = suite_create (__FILE__);
+
+	TCase* tc_get = tcase_create ("get");
+	suite_add_tcase (s, tc_get);
+	tcase_add_test (tc_get, test_get_pass_001);
+
+	TCase* tc_pgmcc = tcase_create ("pgmcc");
+	suite_add_tcase (s, tc_pgmcc);
+	tcase_add_test (tc_pgmcc, test_pgmcc_pass_001);
+
+	TCase* tc_bbr = tcase_create ("bbr");
+	suite_add_tcase (s, tc_bbr);
+	tcase_add_test (tc_bbr, test_bbr_pass_001);
+	tcase_add_test (tc_bbr, test_bbr_pass_002);
+
+	TCase* tc_on_feedback = tcase_create ("on-feedback");
+	suite_add_tcase (s, tc_on_feedback);
+	tcase_add_test (tc_on_feedback, test_on_feedback_pass_001);
+	tcase_add_test (tc_on_feedback, test_on_feedback_pass_002);
+	tcase_add_test (tc_on_feedback, test_on_feedback_pass_003);
+	return s;
+}
+
+static
+Suite*
+make_master_suite (void)
+{
+	Suite* s = suite_create ("Master");
+	return s;
+}
+
+int
+main (void)
+{
+	SRunner* sr = srunner_create (make_master_suite ());
+	srunner_add_suite (sr, make_test_suite ());
+	srunner_run_all (sr, CK_ENV);
+	int number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof */
@@ -23,20 +23,36 @@
 #	include <config.h>
 #endif
 
-#if defined(_MSC_VER)
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#	define CPU_X86
+#endif
+
+#if defined(_MSC_VER) && defined(CPU_X86)
 #	include <intrin.h>
 #	include <immintrin.h>  // For _xgetbv()
 #endif
+#if defined(__arm__) && defined(__linux__)
+#	include <sys/auxv.h>
+#endif
 
 #include <impl/framework.h>
 
 //#define CPU_DEBUG
 
 
-#ifndef _MSC_VER
+#if defined(CPU_X86) && !defined(_MSC_VER)
 static
 void
 __cpuidex (int cpu_info[4], int function_id, int subfunction_id) {
+#if defined(__x86_64__)
+// the 32-bit xchg below would zero the upper half of RBX.
+  __asm__ volatile (
+    "cpuid\n"
+    : "=a"(cpu_info[0]), "=b"(cpu_info[1]), "=c"(cpu_info[2]), "=d"(cpu_info[3])
+    : "a"(function_id), "c"(subfunction_id)
+  );
+#else
+// EBX is reserved for the GOT pointer in 32-bit PIC.
   __asm__ volatile (
     "mov %%ebx, %%edi\n"
     "cpuid\n"
@@ -44,6 +60,7 @@ __cpuidex (int cpu_info[4], int function_id, int subfunction_id) {
     : "=a"(cpu_info[0]), "=D"(cpu_info[1]), "=c"(cpu_info[2]), "=d"(cpu_info[3])
     : "a"(function_id), "c"(subfunction_id)
   );
+#endif
 }
 
 // _xgetbv returns the value of an Intel Extended Control Register (XCR).
@@ -65,6 +82,14 @@ pgm_cpuid (pgm_cpu_t* cpu)
 {
 	memset (cpu, 0, sizeof (pgm_cpu_t));
 
+#if defined(__aarch64__) || defined(_M_ARM64)
+/* Advanced SIMD is part of the base AArch64 architecture */
+	cpu->has_neon = TRUE;
+#elif defined(__arm__)
+#	if defined(__linux__) && defined(AT_HWCAP)
+	cpu->has_neon = (getauxval (AT_HWCAP) & (1 << 12) /* HWCAP_NEON */) != 0;
+#	endif
+#elif defined(CPU_X86)
 	int cpu_info[4] = {-1};
 // Calling __cpuid with 0x0 as the function_id argument
 // gets the number of the highest valid function ID.
@@ -92,6 +117,44 @@ pgm_cpuid (pgm_cpu_t* cpu)
 			(cpu_info[2] & 0x08000000) != 0 /* OSXSAVE */ &&
 			(_xgetbv(0) & 6) == 6 /* XSAVE enabled by kernel */;
 	cpu->has_avx2 = cpu->has_avx && (cpu_info7[1] & 0x00000020) != 0;
+	cpu->has_avx512f = cpu->has_avx && (cpu_info7[1] & 0x00010000) != 0 &&
+			(_xgetbv(0) & 0xe6) == 0xe6 /* opmask and ZMM state enabled by kernel */;
+	cpu->has_avx512bw = cpu->has_avx512f && (cpu_info7[1] & 0x40000000) != 0;
+	cpu->has_gfni = (cpu_info7[2] & 0x00000100) != 0;
+
+/* TSC to core crystal clock ratio and the crystal frequency, older processors enumerate
+ * the ratio without the crystal which is then derived from the base frequency.
+ */
+	if (num_ids >= 0x15) {
+		int cpu_info15[4] = {0};
+		__cpuidex (cpu_info15, 0x15, 0x0);
+		const uint32_t denominator = (uint32_t)cpu_info15[0];
+		const uint32_t numerator   = (uint32_t)cpu_info15[1];
+		uint64_t crystal_hz        = (uint32_t)cpu_info15[2];
+		if (0 != denominator && 0 != numerator) {
+			if (0 == crystal_hz && num_ids >= 0x16) {
+				int cpu_info16[4] = {0};
+				__cpuidex (cpu_info16, 0x16, 0x0);
+				crystal_hz = (uint64_t)(cpu_info16[0] & 0xffff) * 1000000 * denominator / numerator;
+			}
+			cpu->tsc_khz = (uint32_t)(crystal_hz * numerator / denominator / 1000);
+		}
+	}
+
+/* extended function ids: RDTSCP, and a TSC that ticks at a constant rate
+ * through frequency and deep C-state changes.
+ */
+	__cpuidex (cpu_info, (int)0x80000000, 0x0);
+	const unsigned num_ext_ids = (unsigned)cpu_info[0];
+	if (num_ext_ids >= 0x80000001) {
+		__cpuidex (cpu_info, (int)0x80000001, 0x0);
+		cpu->has_rdtscp = (cpu_info[3] & 0x08000000) != 0;
+	}
+	if (num_ext_ids >= 0x80000007) {
+		__cpuidex (cpu_info, (int)0x80000007, 0x0);
+		cpu->has_invariant_tsc = (cpu_info[3] & 0x00000100) != 0;
+	}
+#endif
 }
 
 /* eof */
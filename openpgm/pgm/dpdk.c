@@ -0,0 +1,674 @@
+/* vim:ts=8:sts=4:sw=4:noai:noexpandtab
+ *
+ * DPDK poll-mode transport.
+ *
+ * Copyright (c) 2006-2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <impl/framework.h>
+#include <impl/socket.h>
+
+#ifdef HAVE_RTE_ETHDEV_H
+#	include <errno.h>
+#	include <rte_arp.h>
+#	include <rte_ether.h>
+#	include <rte_errno.h>
+#	include <rte_ethdev.h>
+#	include <rte_mbuf.h>
+#	include <rte_mempool.h>
+
+
+//#define DPDK_DEBUG
+
+#ifndef DPDK_DEBUG
+#	define PGM_DISABLE_ASSERT
+#endif
+
+/* frames dequeued or enqueued per burst */
+#define PGM_DPDK_BURST			32
+
+/* learnt link addresses of unicast peers, power of 2 */
+#define PGM_DPDK_NEIGHBOURS		256
+
+/* interval between solicitations of one unresolved peer */
+#define PGM_DPDK_SOLICIT_IVL		pgm_secs(1)
+
+/* unicast time to live, multicast takes the socket hop limit */
+#define PGM_DPDK_UCAST_TTL		64
+
+struct pgm_dpdk_neighbour_t {
+	uint32_t			addr;			/* network order, 0 = unused */
+	bool				is_resolved;
+	struct rte_ether_addr		mac;
+	pgm_time_t			solicited;
+};
+
+/* The socket polls one receive and transmit queue of an ethdev port without
+ * the kernel, building and parsing Ethernet, IPv4 and UDP headers itself.  The
+ * port is configured and started with that one queue when PGM_DPDK_CONFIGURE is
+ * requested, otherwise the application owns the port and each socket polls a
+ * separate queue, one per lcore.
+ *
+ * Received frames are copied into the skbuff of the caller and returned to the
+ * pool immediately, as the receive window holds skbuffs indefinitely and would
+ * otherwise exhaust the descriptors of the queue.  Frames to the socket groups
+ * or the interface address are accepted, everything else is dropped but ARP,
+ * which is answered for the interface address such that peers may address
+ * unicast NAKs to the port.  Link addresses of unicast destinations are learnt
+ * from received frames and ARP.
+ */
+
+struct pgm_dpdk_t {
+	uint16_t			port_id;
+	uint16_t			queue_id;
+	bool				is_configured;		/* port started by the socket */
+	bool				is_udp_encap;
+	struct rte_mempool*		pool;			/* transmit frames, and receive when configured */
+	struct rte_mempool*		own_pool;		/* pool created by the socket */
+	struct rte_ether_addr		mac;
+	uint32_t			addr;			/* interface address, network order */
+	in_port_t			ucast_port;		/* network order */
+	in_port_t			mcast_port;
+	unsigned			hops;
+
+/* groups appended and removed under tx_lock, a stale read admits one datagram */
+	uint32_t			groups[IP_MAX_MEMBERSHIPS];
+	volatile unsigned		groups_len;
+
+/* receive */
+	struct rte_mbuf*		rx_pkts[PGM_DPDK_BURST];
+	unsigned			rx_len;
+	unsigned			rx_index;
+
+/* send, from the application, receive and timer threads */
+	pgm_spinlock_t			tx_lock;
+	uint16_t			ip_id;
+	struct pgm_dpdk_neighbour_t	neighbours[PGM_DPDK_NEIGHBOURS];
+};
+
+
+static inline
+unsigned
+dpdk_neighbour_hash (
+	const uint32_t			addr
+	)
+{
+	return (unsigned)((ntohl (addr) * 2654435761u) >> 24) & (PGM_DPDK_NEIGHBOURS - 1);
+}
+
+static inline
+void
+dpdk_group_to_mac (
+	const uint32_t			group,
+	struct rte_ether_addr*		mac
+	)
+{
+	const uint32_t g = ntohl (group);
+	mac->addr_bytes[0] = 0x01;
+	mac->addr_bytes[1] = 0x00;
+	mac->addr_bytes[2] = 0x5e;
+	mac->addr_bytes[3] = (uint8_t)((g >> 16) & 0x7f);
+	mac->addr_bytes[4] = (uint8_t)(g >> 8);
+	mac->addr_bytes[5] = (uint8_t)g;
+}
+
+static inline
+bool
+dpdk_is_group (
+	const struct pgm_dpdk_t* const	dpdk,
+	const uint32_t			addr
+	)
+{
+	const unsigned len = dpdk->groups_len;
+	for (unsigned i = 0; i < len; i++)
+		if (dpdk->groups[i] == addr)
+			return TRUE;
+	return FALSE;
+}
+
+/* transmit frames under tx_lock, returns frames enqueued, the remainder are freed.
+ */
+
+static
+unsigned
+dpdk_tx (
+	struct pgm_dpdk_t* const	dpdk,
+	struct rte_mbuf**		pkts,
+	const unsigned			count
+	)
+{
+	const unsigned sent = rte_eth_tx_burst (dpdk->port_id, dpdk->queue_id, pkts, (uint16_t)count);
+	if (PGM_UNLIKELY(sent < count))
+		rte_pktmbuf_free_bulk (pkts + sent, count - sent);
+	return sent;
+}
+
+/* record the link address of a unicast peer, the table is read without the lock
+ * first as a peer is normally unchanged.
+ */
+
+static
+void
+dpdk_learn (
+	struct pgm_dpdk_t* const	dpdk,
+	const uint32_t			addr,
+	const struct rte_ether_addr*	mac
+	)
+{
+	if (0 == addr || addr == dpdk->addr || rte_is_multicast_ether_addr (mac))
+		return;
+	struct pgm_dpdk_neighbour_t* n = &dpdk->neighbours[dpdk_neighbour_hash (addr)];
+	if (n->addr == addr && n->is_resolved && rte_is_same_ether_addr (&n->mac, mac))
+		return;
+	pgm_spinlock_lock (&dpdk->tx_lock);
+	n->addr		= addr;
+	n->is_resolved	= TRUE;
+	rte_ether_addr_copy (mac, &n->mac);
+	pgm_spinlock_unlock (&dpdk->tx_lock);
+}
+
+/* broadcast a request for the link address of addr, under tx_lock.
+ */
+
+static
+void
+dpdk_solicit (
+	struct pgm_dpdk_t* const	dpdk,
+	const uint32_t			addr
+	)
+{
+	struct rte_mbuf* m = rte_pktmbuf_alloc (dpdk->pool);
+	if (PGM_UNLIKELY(NULL == m))
+		return;
+	char* frame = rte_pktmbuf_append (m, sizeof(struct rte_ether_hdr) + sizeof(struct rte_arp_hdr));
+	if (PGM_UNLIKELY(NULL == frame)) {
+		rte_pktmbuf_free (m);
+		return;
+	}
+	struct rte_ether_hdr* eth = (struct rte_ether_hdr*)frame;
+	struct rte_arp_hdr* arp = (struct rte_arp_hdr*)(eth + 1);
+	memset (&eth->dst_addr, 0xff, sizeof(eth->dst_addr));
+	rte_ether_addr_copy (&dpdk->mac, &eth->src_addr);
+	eth->ether_type			= rte_cpu_to_be_16 (RTE_ETHER_TYPE_ARP);
+	arp->arp_hardware		= rte_cpu_to_be_16 (RTE_ARP_HRD_ETHER);
+	arp->arp_protocol		= rte_cpu_to_be_16 (RTE_ETHER_TYPE_IPV4);
+	arp->arp_hlen			= RTE_ETHER_ADDR_LEN;
+	arp->arp_plen			= sizeof(uint32_t);
+	arp->arp_opcode			= rte_cpu_to_be_16 (RTE_ARP_OP_REQUEST);
+	rte_ether_addr_copy (&dpdk->mac, &arp->arp_data.arp_sha);
+	arp->arp_data.arp_sip		= dpdk->addr;
+	memset (&arp->arp_data.arp_tha, 0, sizeof(arp->arp_data.arp_tha));
+	arp->arp_data.arp_tip		= addr;
+	dpdk_tx (dpdk, &m, 1);
+}
+
+/* learn from any ARP frame and answer a request for the interface address in
+ * place, consumes m.
+ */
+
+static
+void
+dpdk_arp (
+	struct pgm_dpdk_t* const	dpdk,
+	struct rte_mbuf*		m
+	)
+{
+	struct rte_ether_hdr* eth = rte_pktmbuf_mtod (m, struct rte_ether_hdr*);
+	struct rte_arp_hdr* arp = (struct rte_arp_hdr*)(eth + 1);
+	if (PGM_UNLIKELY(rte_pktmbuf_data_len (m) < sizeof(struct rte_ether_hdr) + sizeof(struct rte_arp_hdr) ||
+			 rte_cpu_to_be_16 (RTE_ARP_HRD_ETHER) != arp->arp_hardware ||
+			 rte_cpu_to_be_16 (RTE_ETHER_TYPE_IPV4) != arp->arp_protocol))
+	{
+		rte_pktmbuf_free (m);
+		return;
+	}
+	dpdk_learn (dpdk, arp->arp_data.arp_sip, &arp->arp_data.arp_sha);
+	if (rte_cpu_to_be_16 (RTE_ARP_OP_REQUEST) != arp->arp_opcode ||
+	    dpdk->addr != arp->arp_data.arp_tip)
+	{
+		rte_pktmbuf_free (m);
+		return;
+	}
+	rte_ether_addr_copy (&arp->arp_data.arp_sha, &eth->dst_addr);
+	rte_ether_addr_copy (&dpdk->mac, &eth->src_addr);
+	arp->arp_opcode			= rte_cpu_to_be_16 (RTE_ARP_OP_REPLY);
+	rte_ether_addr_copy (&arp->arp_data.arp_sha, &arp->arp_data.arp_tha);
+	arp->arp_data.arp_tip		= arp->arp_data.arp_sip;
+	rte_ether_addr_copy (&dpdk->mac, &arp->arp_data.arp_sha);
+	arp->arp_data.arp_sip		= dpdk->addr;
+	pgm_spinlock_lock (&dpdk->tx_lock);
+	dpdk_tx (dpdk, &m, 1);
+	pgm_spinlock_unlock (&dpdk->tx_lock);
+}
+
+/* attach to queue dr_queue of ethdev dr_device, configuring and starting the
+ * port when requested.  the EAL must be initialised by the application.
+ *
+ * returns new transport, or NULL on failure setting errno.
+ */
+
+PGM_GNUC_INTERNAL
+struct pgm_dpdk_t*
+pgm_dpdk_new (
+	const pgm_sock_t* const			sock,
+	const struct pgm_dpdk_req_t* const	req
+	)
+{
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != req);
+	pgm_assert ('\0' != req->dr_device[0]);
+
+	if (AF_INET != sock->family || AF_INET != sock->send_addr.ss_family) {
+		errno = EAFNOSUPPORT;
+		return NULL;
+	}
+	struct sockaddr_in s4;
+	memcpy (&s4, &sock->send_addr, sizeof(s4));
+	if (INADDR_ANY == s4.sin_addr.s_addr) {
+		errno = EADDRNOTAVAIL;
+		return NULL;
+	}
+
+	uint16_t port_id;
+	if (0 != rte_eth_dev_get_port_by_name (req->dr_device, &port_id)) {
+		errno = ENODEV;
+		return NULL;
+	}
+
+	struct pgm_dpdk_t* dpdk = pgm_new0 (struct pgm_dpdk_t, 1);
+	pgm_spinlock_init (&dpdk->tx_lock);
+	dpdk->port_id		= port_id;
+	dpdk->queue_id		= (uint16_t)req->dr_queue;
+	dpdk->addr		= s4.sin_addr.s_addr;
+	dpdk->is_udp_encap	= (0 != sock->udp_encap_ucast_port);
+	dpdk->ucast_port	= htons (sock->udp_encap_ucast_port);
+	dpdk->mcast_port	= htons (sock->udp_encap_mcast_port);
+	dpdk->hops		= sock->hops;
+	int retval = rte_eth_macaddr_get (port_id, &dpdk->mac);
+	if (0 != retval)
+		goto err_destroy;
+
+	int socket_id = rte_eth_dev_socket_id (port_id);
+	if (socket_id < 0)
+		socket_id = SOCKET_ID_ANY;
+	uint16_t rx_depth = (uint16_t)(req->dr_depth ? req->dr_depth : PGM_DPDK_DEFAULT_DEPTH);
+	uint16_t tx_depth = rx_depth;
+
+	if (req->dr_flags & PGM_DPDK_CONFIGURE)
+	{
+/* receive descriptors, transmit descriptors and the bursts held on either side */
+		char name[RTE_MEMPOOL_NAMESIZE];
+		const unsigned n = 4 * (unsigned)rx_depth - 1;
+		const unsigned data_room = MAX(RTE_MBUF_DEFAULT_BUF_SIZE,
+					       RTE_PKTMBUF_HEADROOM + RTE_ETHER_HDR_LEN + sock->max_tpdu);
+		pgm_snprintf_s (name, sizeof (name), _TRUNCATE, "pgm%p", (void*)dpdk);
+		dpdk->own_pool = rte_pktmbuf_pool_create (name, n, MIN(256, rx_depth / 2), 0, (uint16_t)data_room, socket_id);
+		if (NULL == dpdk->own_pool) {
+			retval = -rte_errno;
+			goto err_destroy;
+		}
+		dpdk->pool = dpdk->own_pool;
+
+		struct rte_eth_conf conf;
+		memset (&conf, 0, sizeof(conf));
+		conf.rxmode.mtu = sock->max_tpdu;
+		if (0 != (retval = rte_eth_dev_configure (port_id, 1, 1, &conf)) ||
+		    0 != (retval = rte_eth_dev_adjust_nb_rx_tx_desc (port_id, &rx_depth, &tx_depth)) ||
+		    0 != (retval = rte_eth_rx_queue_setup (port_id, 0, rx_depth, (unsigned)socket_id, NULL, dpdk->pool)) ||
+		    0 != (retval = rte_eth_tx_queue_setup (port_id, 0, tx_depth, (unsigned)socket_id, NULL)) ||
+		    0 != (retval = rte_eth_dev_start (port_id)))
+			goto err_destroy;
+		dpdk->is_configured = TRUE;
+/* groups are filtered in software, a device without the mode may still pass them */
+		rte_eth_allmulticast_enable (port_id);
+	}
+	else
+	{
+/* transmit frames are drawn from the pool of the receive queue, such that
+ * frames still queued for transmit outlive the socket.
+ */
+		struct rte_eth_rxq_info qinfo;
+		if (0 != (retval = rte_eth_rx_queue_info_get (port_id, dpdk->queue_id, &qinfo)))
+			goto err_destroy;
+		dpdk->pool = qinfo.mp;
+	}
+/* groups joined ahead of connect */
+	for (unsigned i = 0; i < sock->recv_gsr_len; i++)
+		pgm_dpdk_join (dpdk, (const struct sockaddr*)&sock->recv_gsr[i].gsr_group);
+	return dpdk;
+
+err_destroy:
+	pgm_dpdk_destroy (dpdk);
+	errno = (retval < 0) ? -retval : EIO;
+	return NULL;
+}
+
+/* a port configured by the socket is stopped and closed before the pool of
+ * its receive queue is freed.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_dpdk_destroy (
+	struct pgm_dpdk_t* const	dpdk
+	)
+{
+	pgm_assert (NULL != dpdk);
+
+	if (dpdk->rx_index < dpdk->rx_len)
+		rte_pktmbuf_free_bulk (dpdk->rx_pkts + dpdk->rx_index, dpdk->rx_len - dpdk->rx_index);
+	if (dpdk->is_configured) {
+		rte_eth_dev_stop (dpdk->port_id);
+		rte_eth_dev_close (dpdk->port_id);
+	}
+	if (dpdk->own_pool)
+		rte_mempool_free (dpdk->own_pool);
+	pgm_spinlock_free (&dpdk->tx_lock);
+	pgm_free (dpdk);
+}
+
+PGM_GNUC_INTERNAL
+bool
+pgm_dpdk_join (
+	struct pgm_dpdk_t*     const restrict	dpdk,
+	const struct sockaddr* const restrict	group
+	)
+{
+	pgm_assert (NULL != dpdk);
+	pgm_assert (NULL != group);
+
+	if (AF_INET != group->sa_family) {
+		errno = EAFNOSUPPORT;
+		return FALSE;
+	}
+	struct sockaddr_in s4;
+	memcpy (&s4, group, sizeof(s4));
+	bool status = TRUE;
+	pgm_spinlock_lock (&dpdk->tx_lock);
+	if (!dpdk_is_group (dpdk, s4.sin_addr.s_addr)) {
+		if (dpdk->groups_len < IP_MAX_MEMBERSHIPS) {
+			dpdk->groups[dpdk->groups_len] = s4.sin_addr.s_addr;
+			__atomic_store_n (&dpdk->groups_len, dpdk->groups_len + 1, __ATOMIC_RELEASE);
+		} else {
+			errno = ENOBUFS;
+			status = FALSE;
+		}
+	}
+	pgm_spinlock_unlock (&dpdk->tx_lock);
+	return status;
+}
+
+PGM_GNUC_INTERNAL
+bool
+pgm_dpdk_leave (
+	struct pgm_dpdk_t*     const restrict	dpdk,
+	const struct sockaddr* const restrict	group
+	)
+{
+	pgm_assert (NULL != dpdk);
+	pgm_assert (NULL != group);
+
+	if (AF_INET != group->sa_family)
+		return FALSE;
+	struct sockaddr_in s4;
+	memcpy (&s4, group, sizeof(s4));
+	bool status = FALSE;
+	pgm_spinlock_lock (&dpdk->tx_lock);
+	for (unsigned i = 0; i < dpdk->groups_len; i++)
+		if (dpdk->groups[i] == s4.sin_addr.s_addr) {
+			dpdk->groups[i] = dpdk->groups[dpdk->groups_len - 1];
+			__atomic_store_n (&dpdk->groups_len, dpdk->groups_len - 1, __ATOMIC_RELEASE);
+			status = TRUE;
+			break;
+		}
+	pgm_spinlock_unlock (&dpdk->tx_lock);
+	return status;
+}
+
+/* frame count datagrams to IPv4 destination to, each in one frame of the pool
+ * with an IPv4 header of time to live hops and traffic class tos, -1 for the
+ * socket defaults, and UDP header for an encapsulated socket.  a unicast
+ * destination of unknown link address is solicited and refused.
+ *
+ * returns datagrams enqueued, or -1 setting PGM_SOCK_EAGAIN when none were.
+ */
+
+PGM_GNUC_INTERNAL
+ssize_t
+pgm_dpdk_sendv (
+	struct pgm_dpdk_t*     const restrict	dpdk,
+	const struct sockaddr* const restrict	to,
+	const int				hops,
+	const int				tos,
+	const bool				use_router_alert,
+	const struct pgm_iovec*	const restrict	vector,
+	const unsigned				count
+	)
+{
+	pgm_assert (NULL != dpdk);
+	pgm_assert (NULL != to);
+	pgm_assert (NULL != vector);
+	pgm_assert (count > 0);
+
+	if (PGM_UNLIKELY(AF_INET != to->sa_family)) {
+		pgm_set_last_sock_error (PGM_SOCK_EAGAIN);
+		return -1;
+	}
+	struct sockaddr_in dst;
+	memcpy (&dst, to, sizeof(dst));
+	const bool is_multicast = IN_MULTICAST (ntohl (dst.sin_addr.s_addr));
+	in_port_t dport = dst.sin_port;
+	if (0 == dport)
+		dport = is_multicast ? dpdk->mcast_port : dpdk->ucast_port;
+	const unsigned ip_hlen = sizeof(struct pgm_ip) + (use_router_alert ? 4 : 0);
+	const unsigned hlen = RTE_ETHER_HDR_LEN + ip_hlen + (dpdk->is_udp_encap ? sizeof(struct pgm_udphdr) : 0);
+	const uint8_t ttl = (uint8_t)((-1 != hops) ? hops : (is_multicast ? (int)dpdk->hops : PGM_DPDK_UCAST_TTL));
+
+	struct rte_mbuf* pkts[PGM_DPDK_BURST];
+	const unsigned n = MIN(count, PGM_DPDK_BURST);
+	if (PGM_UNLIKELY(0 != rte_pktmbuf_alloc_bulk (dpdk->pool, pkts, n))) {
+		pgm_set_last_sock_error (PGM_SOCK_EAGAIN);
+		return -1;
+	}
+
+	pgm_spinlock_lock (&dpdk->tx_lock);
+	struct rte_ether_addr dst_mac;
+	if (is_multicast)
+		dpdk_group_to_mac (dst.sin_addr.s_addr, &dst_mac);
+	else {
+		struct pgm_dpdk_neighbour_t* nb = &dpdk->neighbours[dpdk_neighbour_hash (dst.sin_addr.s_addr)];
+		if (PGM_UNLIKELY(nb->addr != dst.sin_addr.s_addr || !nb->is_resolved)) {
+			const pgm_time_t now = pgm_time_update_now();
+			if (nb->addr != dst.sin_addr.s_addr || now >= nb->solicited + PGM_DPDK_SOLICIT_IVL) {
+				nb->addr	= dst.sin_addr.s_addr;
+				nb->is_resolved	= FALSE;
+				nb->solicited	= now;
+				dpdk_solicit (dpdk, dst.sin_addr.s_addr);
+			}
+			pgm_spinlock_unlock (&dpdk->tx_lock);
+			rte_pktmbuf_free_bulk (pkts, n);
+			pgm_set_last_sock_error (PGM_SOCK_EAGAIN);
+			return -1;
+		}
+		rte_ether_addr_copy (&nb->mac, &dst_mac);
+	}
+
+	unsigned i;
+	for (i = 0; i < n; i++)
+	{
+		const size_t len = vector[i].iov_len;
+		char* frame = rte_pktmbuf_append (pkts[i], (uint16_t)(hlen + len));
+		if (PGM_UNLIKELY(NULL == frame))
+			break;
+		struct rte_ether_hdr* eth = (struct rte_ether_hdr*)frame;
+		rte_ether_addr_copy (&dst_mac, &eth->dst_addr);
+		rte_ether_addr_copy (&dpdk->mac, &eth->src_addr);
+		eth->ether_type = rte_cpu_to_be_16 (RTE_ETHER_TYPE_IPV4);
+
+		struct pgm_ip* ip = (struct pgm_ip*)(frame + RTE_ETHER_HDR_LEN);
+		memset (ip, 0, ip_hlen);
+		ip->ip_v	= 4;
+		ip->ip_hl	= ip_hlen / 4;
+		ip->ip_tos	= (-1 != tos) ? (unsigned)tos : 0;
+		ip->ip_len	= htons ((uint16_t)(hlen - RTE_ETHER_HDR_LEN + len));
+		ip->ip_id	= htons (dpdk->ip_id++);
+		ip->ip_ttl	= ttl;
+		ip->ip_p	= dpdk->is_udp_encap ? IPPROTO_UDP : IPPROTO_PGM;
+		ip->ip_src.s_addr = dpdk->addr;
+		ip->ip_dst	= dst.sin_addr;
+		if (use_router_alert) {
+			uint8_t* opt = (uint8_t*)(ip + 1);
+			opt[0] = PGM_IPOPT_RA;
+			opt[1] = 4;
+		}
+		ip->ip_sum	= pgm_inet_checksum (ip, (uint16_t)ip_hlen, 0);
+
+		char* data = (char*)ip + ip_hlen;
+		if (dpdk->is_udp_encap) {
+			struct pgm_udphdr* udp = (struct pgm_udphdr*)data;
+			udp->uh_sport	= dpdk->ucast_port;
+			udp->uh_dport	= dport;
+			udp->uh_ulen	= htons ((uint16_t)(sizeof(struct pgm_udphdr) + len));
+			udp->uh_sum	= 0;
+			data += sizeof(struct pgm_udphdr);
+		}
+		memcpy (data, vector[i].iov_base, len);
+	}
+	if (PGM_UNLIKELY(i < n))
+		rte_pktmbuf_free_bulk (pkts + i, n - i);
+	const unsigned sent = (i > 0) ? dpdk_tx (dpdk, pkts, i) : 0;
+	pgm_spinlock_unlock (&dpdk->tx_lock);
+	if (0 == sent) {
+		pgm_set_last_sock_error (PGM_SOCK_EAGAIN);
+		return -1;
+	}
+	return (ssize_t)sent;
+}
+
+/* parse the next frame of the current burst, dequeuing another burst when
+ * exhausted.  the datagram is copied into skb from the PGM header for UDP
+ * encapsulation or the IP header otherwise, as the receive sockets provide.
+ *
+ * on success returns packet length, with no datagram returns -1 setting
+ * PGM_SOCK_EAGAIN.
+ */
+
+PGM_GNUC_INTERNAL
+ssize_t
+pgm_dpdk_recv (
+	struct pgm_dpdk_t*	const restrict	dpdk,
+	struct pgm_sk_buff_t*	const restrict	skb,
+	struct sockaddr*	const restrict	src_addr,
+	struct sockaddr*	const restrict	dst_addr
+	)
+{
+	pgm_assert (NULL != dpdk);
+	pgm_assert (NULL != skb);
+	pgm_assert (NULL != src_addr);
+	pgm_assert (NULL != dst_addr);
+
+	for (;;)
+	{
+		if (dpdk->rx_index == dpdk->rx_len) {
+			dpdk->rx_index = 0;
+			dpdk->rx_len = rte_eth_rx_burst (dpdk->port_id, dpdk->queue_id, dpdk->rx_pkts, PGM_DPDK_BURST);
+			if (0 == dpdk->rx_len) {
+				pgm_set_last_sock_error (PGM_SOCK_EAGAIN);
+				return -1;
+			}
+		}
+		struct rte_mbuf* m = dpdk->rx_pkts[ dpdk->rx_index++ ];
+		if (dpdk->rx_index < dpdk->rx_len)
+			rte_prefetch0 (rte_pktmbuf_mtod (dpdk->rx_pkts[ dpdk->rx_index ], void*));
+
+		const struct rte_ether_hdr* eth = rte_pktmbuf_mtod (m, const struct rte_ether_hdr*);
+		const size_t len = rte_pktmbuf_data_len (m);
+		if (PGM_UNLIKELY(1 != m->nb_segs || len < RTE_ETHER_HDR_LEN + sizeof(struct pgm_ip))) {
+			rte_pktmbuf_free (m);
+			continue;
+		}
+		if (rte_cpu_to_be_16 (RTE_ETHER_TYPE_IPV4) != eth->ether_type) {
+			if (rte_cpu_to_be_16 (RTE_ETHER_TYPE_ARP) == eth->ether_type)
+				dpdk_arp (dpdk, m);
+			else
+				rte_pktmbuf_free (m);
+			continue;
+		}
+
+		const struct pgm_ip* ip = (const struct pgm_ip*)(eth + 1);
+		const size_t ip_hlen = ip->ip_hl * 4;
+		const size_t ip_len = MIN(len - RTE_ETHER_HDR_LEN, (size_t)ntohs (ip->ip_len));
+		ssize_t copied = -1;
+
+/* unfragmented datagrams of the socket protocol to a socket group or the interface */
+		if (PGM_LIKELY(4 == ip->ip_v && ip_hlen >= sizeof(struct pgm_ip) && ip_len >= ip_hlen) &&
+		    0 == (ntohs (ip->ip_off) & 0x3fff) &&
+		    (dpdk->is_udp_encap ? IPPROTO_UDP : IPPROTO_PGM) == ip->ip_p &&
+		    (ip->ip_dst.s_addr == dpdk->addr || dpdk_is_group (dpdk, ip->ip_dst.s_addr)))
+		{
+			const char* data = (const char*)ip;
+			size_t data_len = ip_len;
+			struct sockaddr_in s4;
+			memset (&s4, 0, sizeof(s4));
+			s4.sin_family		= AF_INET;
+			s4.sin_addr		= ip->ip_src;
+			if (dpdk->is_udp_encap) {
+				const struct pgm_udphdr* udp = (const struct pgm_udphdr*)(data + ip_hlen);
+				if (ip_len >= ip_hlen + sizeof(struct pgm_udphdr) &&
+				    (udp->uh_dport == dpdk->ucast_port || udp->uh_dport == dpdk->mcast_port))
+				{
+					s4.sin_port	= udp->uh_sport;
+					data		= (const char*)(udp + 1);
+					data_len	= ip_len - ip_hlen - sizeof(struct pgm_udphdr);
+				} else
+					data_len	= 0;
+			}
+			if (data_len > 0) {
+				if (!IN_MULTICAST (ntohl (ip->ip_src.s_addr)))
+					dpdk_learn (dpdk, ip->ip_src.s_addr, &eth->src_addr);
+				data_len = MIN(data_len, (size_t)((char*)skb->end - (char*)skb->head));
+				memcpy (skb->head, data, data_len);
+				copied = (ssize_t)data_len;
+				memcpy (src_addr, &s4, sizeof(s4));
+				s4.sin_port	= 0;
+				s4.sin_addr	= ip->ip_dst;
+				memcpy (dst_addr, &s4, sizeof(s4));
+			}
+		}
+
+		rte_pktmbuf_free (m);
+		if (PGM_LIKELY(copied > 0))
+			return copied;
+	}
+}
+
+PGM_GNUC_INTERNAL
+bool
+pgm_dpdk_is_pending (
+	const struct pgm_dpdk_t* const	dpdk
+	)
+{
+	pgm_assert (NULL != dpdk);
+	return dpdk->rx_index < dpdk->rx_len;
+}
+
+#endif /* HAVE_RTE_ETHDEV_H */
+
+/* eof */
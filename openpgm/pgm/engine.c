@@ -102,7 +102,10 @@ pgm_init (
 			pgm_build_date, pgm_build_time, pgm_build_system, pgm_build_machine);
 
 	pgm_thread_init();
+	pgm_spinlock_init (&pgm_histograms_lock);
+	pgm_affinity_init();
 	pgm_mem_init();
+	pgm_ifaddrs_init();
 	pgm_rand_init();
     pgm_send_recv_init();
 
@@ -202,18 +205,55 @@ pgm_init (
 	}
 #endif
 
+/* test impairment of new sockets, any build */
+	{
+		char* impair_env;
+		size_t impair_envlen;
+
+		const errno_t impair_err = pgm_dupenv_s (&impair_env, &impair_envlen, "PGM_IMPAIR");
+		if (0 == impair_err && impair_envlen > 0) {
+			if (pgm_impair_parse (impair_env, &pgm_impair_env))
+				pgm_minor (_("Impairing PGM datagrams per PGM_IMPAIR \"%s\"."), impair_env);
+			else
+				pgm_warn (_("Ignoring invalid PGM_IMPAIR \"%s\"."), impair_env);
+			pgm_free (impair_env);
+		}
+	}
+
 /* create global sock list lock */
 	pgm_rwlock_init (&pgm_sock_list_lock);
 
 /* set preferred checksum algorithm */
 	pgm_checksum_init (&pgm_cpu);
 
+/* set preferred Reed-Solomon vector multiply */
+	pgm_rs_init (&pgm_cpu);
+
+/* time each supported kernel rather than trusting the CPU feature set */
+	{
+		char* calibrate_env;
+		size_t calibrate_envlen;
+
+		const errno_t calibrate_err = pgm_dupenv_s (&calibrate_env, &calibrate_envlen, "PGM_CALIBRATE");
+		if (0 == calibrate_err && calibrate_envlen > 0) {
+			const bool is_calibrate = (0 != strcmp (calibrate_env, "0"));
+			pgm_free (calibrate_env);
+			if (is_calibrate) {
+				pgm_checksum_calibrate (&pgm_cpu);
+				pgm_rs_calibrate (&pgm_cpu);
+			}
+		}
+	}
+
 	pgm_is_supported = TRUE;
 	return TRUE;
 
 err_shutdown:
 	pgm_rand_shutdown();
+	pgm_ifaddrs_shutdown();
 	pgm_mem_shutdown();
+	pgm_affinity_shutdown();
+	pgm_spinlock_free (&pgm_histograms_lock);
 	pgm_thread_shutdown();
 	pgm_messages_shutdown();
 	pgm_atomic_dec32 (&pgm_ref_count);
@@ -244,7 +284,8 @@ pgm_shutdown (void)
 
 	pgm_is_supported = FALSE;
 
-/* destroy all open socks */
+/* finish asynchronous closes, then destroy all open socks */
+	pgm_reaper_shutdown();
 	while (pgm_sock_list) {
 		pgm_close ((pgm_sock_t*)pgm_sock_list->data, FALSE);
 	}
@@ -258,7 +299,10 @@ pgm_shutdown (void)
 #endif
 
 	pgm_rand_shutdown();
+	pgm_ifaddrs_shutdown();
 	pgm_mem_shutdown();
+	pgm_affinity_shutdown();
+	pgm_spinlock_free (&pgm_histograms_lock);
 	pgm_thread_shutdown();
 	pgm_messages_shutdown();
 	return TRUE;
@@ -0,0 +1,409 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * binary protocol event trace.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#	include <sys/time.h>
+#endif
+#include <impl/i18n.h>
+#include <impl/framework.h>
+#include <pgm/evtrace.h>
+
+
+//#define EVTRACE_DEBUG
+
+/* Every recording thread owns a ring of fixed size events, created on its
+ * first event and written without locks or formatting.  Readers copy a ring
+ * and keep only events the writer cannot have overwritten during the copy,
+ * the rings of all threads are merged by timestamp.  Rings are freed at
+ * shutdown, recording must have stopped by then.
+ */
+
+#if defined(_MSC_VER)
+#	define EVTRACE_TLS	__declspec(thread)
+#else
+#	define EVTRACE_TLS	__thread
+#endif
+
+struct evtrace_ring_t {
+	struct evtrace_ring_t*	next;
+	uint32_t		thread;
+	volatile uint32_t	head;		/* events ever recorded */
+	pgm_evtrace_event_t	events[];
+};
+
+bool pgm_evtrace_enabled PGM_GNUC_READ_MOSTLY = FALSE;
+
+static volatile uint32_t		evtrace_ref_count = 0;
+static uint32_t				evtrace_len PGM_GNUC_READ_MOSTLY;
+static volatile uint32_t		evtrace_generation = 0;
+static uint32_t				evtrace_threads;
+static pgm_mutex_t			evtrace_mutex;
+static struct evtrace_ring_t*		evtrace_rings = NULL;
+
+static EVTRACE_TLS struct evtrace_ring_t*	evtrace_ring = NULL;
+static EVTRACE_TLS uint32_t			evtrace_ring_generation = 0;
+
+static const char* const evtrace_names[PGM_EV_MAX] = {
+	"none",
+	"peer_new",
+	"peer_expired",
+	"nak_sent",
+	"ncf_received",
+	"rdata_received",
+	"data_lost",
+	"reset",
+	"nak_received",
+	"rdata_sent",
+	"ack_timeout",
+	"window_jump"
+};
+
+static void evtrace_barrier (void);
+static struct evtrace_ring_t* evtrace_ring_new (void);
+static unsigned evtrace_ring_copy (const struct evtrace_ring_t*restrict, pgm_evtrace_event_t*restrict);
+static int evtrace_compare (const void*, const void*);
+static uint64_t evtrace_wall_usecs (void);
+
+
+/* full fence between event contents and the head update.
+ */
+
+static inline
+void
+evtrace_barrier (void)
+{
+#if defined( __GNUC__ ) && ( __GNUC__ * 100 + __GNUC_MINOR__ >= 401 )
+	__sync_synchronize();
+#elif defined( __sun )
+	membar_producer();
+	membar_consumer();
+#elif defined( _WIN32 )
+	MemoryBarrier();
+#endif
+}
+
+/* start recording with rings of events per thread rounded up to a power of
+ * two, zero selects the default.
+ *
+ * on success, returns TRUE, on failure returns FALSE and sets error appropriately.
+ */
+
+bool
+pgm_evtrace_init (
+	unsigned		events,
+	pgm_error_t**		error
+	)
+{
+	if (pgm_atomic_exchange_and_add32 (&evtrace_ref_count, 1) > 0)
+		return TRUE;
+
+	if (0 == events)
+		events = PGM_EVTRACE_DEFAULT_EVENTS;
+	if (events > (1U << 24)) {
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_ENGINE,
+			     PGM_ERROR_INVAL,
+			     _("Event trace of %u events per thread exceeds maximum of %u."),
+			     events, 1U << 24);
+		pgm_atomic_dec32 (&evtrace_ref_count);
+		return FALSE;
+	}
+	evtrace_len = 1;
+	while (evtrace_len < events)
+		evtrace_len <<= 1;
+	evtrace_threads = 0;
+	pgm_mutex_init (&evtrace_mutex);
+	pgm_atomic_inc32 (&evtrace_generation);
+	evtrace_barrier();
+	pgm_evtrace_enabled = TRUE;
+	return TRUE;
+}
+
+/* stop recording and free every ring.
+ */
+
+bool
+pgm_evtrace_shutdown (void)
+{
+	pgm_return_val_if_fail (pgm_atomic_read32 (&evtrace_ref_count) > 0, FALSE);
+
+	if (pgm_atomic_exchange_and_add32 (&evtrace_ref_count, (uint32_t)-1) != 1)
+		return TRUE;
+
+	pgm_evtrace_enabled = FALSE;
+	pgm_atomic_inc32 (&evtrace_generation);
+	evtrace_barrier();
+	pgm_mutex_lock (&evtrace_mutex);
+	while (evtrace_rings) {
+		struct evtrace_ring_t* next = evtrace_rings->next;
+		pgm_free (evtrace_rings);
+		evtrace_rings = next;
+	}
+	pgm_mutex_unlock (&evtrace_mutex);
+	pgm_mutex_free (&evtrace_mutex);
+	return TRUE;
+}
+
+/* ring of the calling thread for the current trace, the thread local pointer
+ * is only followed when its generation matches so rings of a previous trace
+ * are never touched.
+ */
+
+static
+struct evtrace_ring_t*
+evtrace_ring_new (void)
+{
+	struct evtrace_ring_t* ring = pgm_malloc0 (sizeof (struct evtrace_ring_t) + (evtrace_len * sizeof (pgm_evtrace_event_t)));
+	pgm_mutex_lock (&evtrace_mutex);
+	ring->thread = evtrace_threads++;
+	ring->next = evtrace_rings;
+	evtrace_rings = ring;
+	pgm_mutex_unlock (&evtrace_mutex);
+	evtrace_ring = ring;
+	evtrace_ring_generation = pgm_atomic_read32 (&evtrace_generation);
+	return ring;
+}
+
+/* record one event, callers test pgm_evtrace_enabled through pgm_evtrace().
+ */
+
+void
+pgm__evtrace (
+	const unsigned		id,
+	const pgm_tsi_t*const	tsi,
+	const uint32_t		sqn,
+	const unsigned		arg
+	)
+{
+	struct evtrace_ring_t* ring;
+
+	if (PGM_LIKELY(evtrace_ring_generation == evtrace_generation))
+		ring = evtrace_ring;
+	else
+		ring = evtrace_ring_new ();
+
+	const uint32_t head = ring->head;
+	pgm_evtrace_event_t* event = &ring->events[ head & (evtrace_len - 1) ];
+	event->tstamp = pgm_time_update_now();
+	if (NULL != tsi)
+		memcpy (&event->tsi, tsi, sizeof (pgm_tsi_t));
+	else
+		memset (&event->tsi, 0, sizeof (pgm_tsi_t));
+	event->sqn	= sqn;
+	event->id	= (uint16_t)id;
+	event->arg	= (uint16_t)(arg > UINT16_MAX ? UINT16_MAX : arg);
+	event->thread	= ring->thread;
+	event->reserved	= 0;
+	evtrace_barrier();
+	ring->head = head + 1;
+}
+
+/* copy the events of one ring oldest first, returns events copied.
+ */
+
+static
+unsigned
+evtrace_ring_copy (
+	const struct evtrace_ring_t*restrict ring,
+	pgm_evtrace_event_t*	    restrict dst
+	)
+{
+	const uint32_t first_head = ring->head;
+	evtrace_barrier();
+	const uint32_t count = first_head < evtrace_len ? first_head : evtrace_len;
+	const uint32_t first = first_head - count;
+	for (uint32_t i = first; i != first_head; i++)
+		memcpy (&dst[i - first], &ring->events[ i & (evtrace_len - 1) ], sizeof (pgm_evtrace_event_t));
+	evtrace_barrier();
+/* the writer may be part way through event last_head, which shares a slot
+ * with last_head - len.
+ */
+	const uint32_t last_head = ring->head;
+	uint32_t valid_from = first;
+	if (last_head - first >= evtrace_len)
+		valid_from = last_head - evtrace_len + 1;
+	if (valid_from - first >= count)
+		return 0;
+	const uint32_t skip = valid_from - first;
+	memmove (dst, &dst[skip], (count - skip) * sizeof (pgm_evtrace_event_t));
+	return count - skip;
+}
+
+static
+int
+evtrace_compare (
+	const void*	a,
+	const void*	b
+	)
+{
+	const pgm_evtrace_event_t* ea = a;
+	const pgm_evtrace_event_t* eb = b;
+	if (ea->tstamp != eb->tstamp)
+		return ea->tstamp < eb->tstamp ? -1 : 1;
+	if (ea->thread != eb->thread)
+		return ea->thread < eb->thread ? -1 : 1;
+	return 0;
+}
+
+/* copy up to len of the most recent events of all threads into events,
+ * oldest first.  safe against concurrent recording.
+ *
+ * returns number of events copied.
+ */
+
+unsigned
+pgm_evtrace_read (
+	pgm_evtrace_event_t*	events,
+	unsigned		len
+	)
+{
+	pgm_return_val_if_fail (NULL != events || 0 == len, 0);
+
+	if (0 == len || 0 == pgm_atomic_read32 (&evtrace_ref_count))
+		return 0;
+
+	pgm_mutex_lock (&evtrace_mutex);
+	unsigned total = 0;
+	for (const struct evtrace_ring_t* ring = evtrace_rings; NULL != ring; ring = ring->next)
+		total += evtrace_len;
+	pgm_evtrace_event_t* all = pgm_new (pgm_evtrace_event_t, total ? total : 1);
+	unsigned count = 0;
+	for (const struct evtrace_ring_t* ring = evtrace_rings; NULL != ring; ring = ring->next)
+		count += evtrace_ring_copy (ring, &all[count]);
+	pgm_mutex_unlock (&evtrace_mutex);
+
+	qsort (all, count, sizeof (pgm_evtrace_event_t), evtrace_compare);
+	const unsigned skip = count > len ? count - len : 0;
+	memcpy (events, &all[skip], (count - skip) * sizeof (pgm_evtrace_event_t));
+	pgm_free (all);
+	return count - skip;
+}
+
+/* system clock in microseconds since the epoch.
+ */
+
+static
+uint64_t
+evtrace_wall_usecs (void)
+{
+#if defined(_WIN32)
+	FILETIME ft;
+	GetSystemTimeAsFileTime (&ft);
+	const uint64_t intervals = ((uint64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+	return (intervals - UINT64_C(116444736000000000)) / 10;
+#elif defined(HAVE_CLOCK_GETTIME)
+	struct timespec ts;
+	clock_gettime (CLOCK_REALTIME, &ts);
+	return (uint64_t)ts.tv_sec * UINT64_C(1000000) + (uint64_t)ts.tv_nsec / 1000;
+#else
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return (uint64_t)tv.tv_sec * UINT64_C(1000000) + (uint64_t)tv.tv_usec;
+#endif
+}
+
+/* write up to len of the most recent events to path for decoding offline,
+ * zero saves every buffered event.
+ *
+ * on success, returns TRUE, on failure returns FALSE and sets error appropriately.
+ */
+
+bool
+pgm_evtrace_save (
+	const char*		path,
+	unsigned		len,
+	pgm_error_t**		error
+	)
+{
+	pgm_return_val_if_fail (NULL != path, FALSE);
+	pgm_return_val_if_fail (pgm_atomic_read32 (&evtrace_ref_count) > 0, FALSE);
+
+	if (0 == len) {
+		pgm_mutex_lock (&evtrace_mutex);
+		for (const struct evtrace_ring_t* ring = evtrace_rings; NULL != ring; ring = ring->next)
+			len += evtrace_len;
+		pgm_mutex_unlock (&evtrace_mutex);
+	}
+
+	pgm_evtrace_event_t* events = pgm_new (pgm_evtrace_event_t, len ? len : 1);
+	pgm_evtrace_header_t header;
+	memset (&header, 0, sizeof (header));
+	header.magic		= PGM_EVTRACE_MAGIC;
+	header.version		= PGM_EVTRACE_VERSION;
+	header.event_size	= sizeof (pgm_evtrace_event_t);
+	header.count		= pgm_evtrace_read (events, len);
+	header.tstamp		= pgm_time_update_now();
+	header.wall_usecs	= evtrace_wall_usecs();
+
+	FILE* fp = fopen (path, "wb");
+	if (NULL == fp) {
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_ENGINE,
+			     pgm_error_from_errno (save_errno),
+			     _("Opening event trace %s: %s"),
+			     path,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		pgm_free (events);
+		return FALSE;
+	}
+	if (1 != fwrite (&header, sizeof (header), 1, fp) ||
+	    header.count != fwrite (events, sizeof (pgm_evtrace_event_t), header.count, fp))
+	{
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_ENGINE,
+			     pgm_error_from_errno (save_errno),
+			     _("Writing event trace %s: %s"),
+			     path,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		fclose (fp);
+		pgm_free (events);
+		return FALSE;
+	}
+	fclose (fp);
+	pgm_free (events);
+	return TRUE;
+}
+
+/* name of an event identifier, NULL when unknown.
+ */
+
+const char*
+pgm_evtrace_name (
+	unsigned	id
+	)
+{
+	if (id >= PGM_EV_MAX)
+		return NULL;
+	return evtrace_names[ id ];
+}
+
+/* eof */
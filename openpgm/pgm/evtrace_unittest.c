@@ -0,0 +1,262 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * unit tests for the binary event trace.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+#include <check.h>
+
+#include "impl/framework.h"
+
+#ifdef _WIN32
+#	define PGM_CHECK_NOFORK		1
+#endif
+
+
+/* mock state */
+#define TEST_PATH		"evtrace_unittest.trace"
+
+static pgm_time_t mock_pgm_time_now = 0x1000;
+static pgm_time_t _mock_pgm_time_update_now (void);
+pgm_time_update_func mock_pgm_time_update_now = _mock_pgm_time_update_now;
+
+/* mock functions for external references */
+
+#define pgm_time_update_now	mock_pgm_time_update_now
+
+#define EVTRACE_DEBUG
+#include "evtrace.c"
+
+static
+pgm_time_t
+_mock_pgm_time_update_now (void)
+{
+	return mock_pgm_time_now++;
+}
+
+static const pgm_tsi_t test_tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+
+/* target:
+ *	bool
+ *	pgm_evtrace_init (
+ *		unsigned	events,
+ *		pgm_error_t**	error
+ *	)
+ */
+
+START_TEST (test_init_pass_001)
+{
+	pgm_error_t* err = NULL;
+	fail_unless (TRUE == pgm_evtrace_init (1000, &err), "init failed");
+	fail_unless (NULL == err, "init failed");
+	fail_unless (1024 == evtrace_len, "length not rounded to power of two");
+	fail_unless (TRUE == pgm_evtrace_enabled, "not enabled");
+	fail_unless (TRUE == pgm_evtrace_shutdown (), "shutdown failed");
+	fail_unless (FALSE == pgm_evtrace_enabled, "still enabled");
+	fail_unless (FALSE == pgm_evtrace_shutdown (), "shutdown failed");
+}
+END_TEST
+
+START_TEST (test_init_fail_001)
+{
+	pgm_error_t* err = NULL;
+	fail_unless (FALSE == pgm_evtrace_init (1U << 25, &err), "init succeeded");
+	fail_if (NULL == err, "error not set");
+	pgm_error_free (err);
+	fail_unless (FALSE == pgm_evtrace_enabled, "enabled");
+}
+END_TEST
+
+/* target:
+ *	unsigned
+ *	pgm_evtrace_read (
+ *		pgm_evtrace_event_t*	events,
+ *		unsigned		len
+ *	)
+ */
+
+START_TEST (test_read_pass_001)
+{
+	pgm_error_t* err = NULL;
+	pgm_evtrace_event_t events[16];
+	fail_unless (TRUE == pgm_evtrace_init (16, &err), "init failed");
+	pgm_evtrace (PGM_EV_NAK_SENT, &test_tsi, 100, 3);
+	pgm_evtrace (PGM_EV_NCF_RECEIVED, &test_tsi, 100, 3);
+	pgm_evtrace (PGM_EV_RDATA_RECEIVED, &test_tsi, 101, 0);
+	fail_unless (3 == pgm_evtrace_read (events, G_N_ELEMENTS(events)), "read failed");
+	fail_unless (PGM_EV_NAK_SENT == events[0].id, "id mismatch");
+	fail_unless (PGM_EV_RDATA_RECEIVED == events[2].id, "id mismatch");
+	fail_unless (101 == events[2].sqn, "sqn mismatch");
+	fail_unless (3 == events[1].arg, "arg mismatch");
+	fail_unless (pgm_tsi_equal (&test_tsi, &events[0].tsi), "tsi mismatch");
+	fail_unless (events[0].tstamp < events[1].tstamp, "not in time order");
+/* most recent events */
+	fail_unless (1 == pgm_evtrace_read (events, 1), "read failed");
+	fail_unless (PGM_EV_RDATA_RECEIVED == events[0].id, "id mismatch");
+	fail_unless (TRUE == pgm_evtrace_shutdown (), "shutdown failed");
+}
+END_TEST
+
+/* ring wraps keeping the newest events */
+START_TEST (test_read_pass_002)
+{
+	pgm_error_t* err = NULL;
+	pgm_evtrace_event_t events[64];
+	fail_unless (TRUE == pgm_evtrace_init (16, &err), "init failed");
+	for (uint32_t i = 0; i < 40; i++)
+		pgm_evtrace (PGM_EV_DATA_LOST, &test_tsi, i, 0);
+	const unsigned count = pgm_evtrace_read (events, G_N_ELEMENTS(events));
+	fail_unless (count > 0 && count <= 16, "count mismatch");
+	fail_unless (39 == events[count - 1].sqn, "newest event missing");
+	for (unsigned i = 1; i < count; i++)
+		fail_unless (events[i - 1].sqn + 1 == events[i].sqn, "events out of order");
+	fail_unless (TRUE == pgm_evtrace_shutdown (), "shutdown failed");
+/* a new trace starts empty */
+	fail_unless (TRUE == pgm_evtrace_init (16, &err), "init failed");
+	fail_unless (0 == pgm_evtrace_read (events, G_N_ELEMENTS(events)), "read failed");
+	fail_unless (TRUE == pgm_evtrace_shutdown (), "shutdown failed");
+}
+END_TEST
+
+START_TEST (test_read_fail_001)
+{
+	pgm_evtrace_event_t events[4];
+	fail_unless (0 == pgm_evtrace_read (events, G_N_ELEMENTS(events)), "read succeeded");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_evtrace_save (
+ *		const char*	path,
+ *		unsigned	len,
+ *		pgm_error_t**	error
+ *	)
+ */
+
+START_TEST (test_save_pass_001)
+{
+	pgm_error_t* err = NULL;
+	pgm_evtrace_header_t header;
+	pgm_evtrace_event_t event;
+	fail_unless (TRUE == pgm_evtrace_init (0, &err), "init failed");
+	pgm_evtrace (PGM_EV_PEER_NEW, &test_tsi, 0, 0);
+	pgm_evtrace (PGM_EV_RESET, &test_tsi, 5, 2);
+	fail_unless (TRUE == pgm_evtrace_save (TEST_PATH, 0, &err), "save failed");
+	FILE* fp = fopen (TEST_PATH, "rb");
+	fail_if (NULL == fp, "open failed");
+	fail_unless (1 == fread (&header, sizeof (header), 1, fp), "read failed");
+	fail_unless (PGM_EVTRACE_MAGIC == header.magic, "magic mismatch");
+	fail_unless (sizeof (pgm_evtrace_event_t) == header.event_size, "size mismatch");
+	fail_unless (2 == header.count, "count mismatch");
+	fail_unless (1 == fread (&event, sizeof (event), 1, fp), "read failed");
+	fail_unless (1 == fread (&event, sizeof (event), 1, fp), "read failed");
+	fail_unless (PGM_EV_RESET == event.id, "id mismatch");
+	fclose (fp);
+	unlink (TEST_PATH);
+	fail_unless (TRUE == pgm_evtrace_shutdown (), "shutdown failed");
+}
+END_TEST
+
+START_TEST (test_save_fail_001)
+{
+	pgm_error_t* err = NULL;
+	fail_unless (TRUE == pgm_evtrace_init (0, &err), "init failed");
+	fail_unless (FALSE == pgm_evtrace_save ("/nonexistent/" TEST_PATH, 0, &err), "save succeeded");
+	fail_if (NULL == err, "error not set");
+	pgm_error_free (err);
+	fail_unless (TRUE == pgm_evtrace_shutdown (), "shutdown failed");
+}
+END_TEST
+
+/* target:
+ *	const char*
+ *	pgm_evtrace_name (
+ *		unsigned	id
+ *	)
+ */
+
+START_TEST (test_name_pass_001)
+{
+	for (unsigned i = 0; i < PGM_EV_MAX; i++)
+		fail_if (NULL == pgm_evtrace_name (i), "event unnamed");
+	fail_unless (0 == strcmp ("nak_sent", pgm_evtrace_name (PGM_EV_NAK_SENT)), "name mismatch");
+	fail_unless (NULL == pgm_evtrace_name (PGM_EV_MAX), "name of unknown event");
+}
+END_TEST
+
+
+static
+Suite*
+make_test_suite (void)
+{
+	Suite* s;
+
+	s = suite_create (__FILE__);
+
+	TCase* tc_init = tcase_create ("init");
+	suite_add_tcase (s, tc_init);
+	tcase_add_test (tc_init, test_init_pass_001);
+	tcase_add_test (tc_init, test_init_fail_001);
+
+	TCase* tc_read = tcase_create ("read");
+	suite_add_tcase (s, tc_read);
+	tcase_add_test (tc_read, test_read_pass_001);
+	tcase_add_test (tc_read, test_read_pass_002);
+	tcase_add_test (tc_read, test_read_fail_001);
+
+	TCase* tc_save = tcase_create ("save");
+	suite_add_tcase (s, tc_save);
+	tcase_add_test (tc_save, test_save_pass_001);
+	tcase_add_test (tc_save, test_save_fail_001);
+
+	TCase* tc_name = tcase_create ("name");
+	suite_add_tcase (s, tc_name);
+	tcase_add_test (tc_name, test_name_pass_001);
+	return s;
+}
+
+static
+Suite*
+make_master_suite (void)
+{
+	Suite* s = suite_create ("Master");
+	return s;
+}
+
+int
+main (void)
+{
+	pgm_messages_init();
+	SRunner* sr = srunner_create (make_master_suite ());
+	srunner_add_suite (sr, make_test_suite ());
+	srunner_run_all (sr, CK_ENV);
+	int number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	pgm_messages_shutdown();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof */
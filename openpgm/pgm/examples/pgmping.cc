@@ -10,6 +10,10 @@
  *
  * With no arguments, one message is sent per second.
  *
+ * Open-loop mode publishes on a fixed schedule from several threads, each
+ * message stamped with its intended send time so that latency includes any
+ * queueing behind the schedule (coordinated omission).
+ *
  * Copyright (c) 2006-2010 Miru Limited.
  *
  * This library is free software; you can redistribute it and/or
@@ -80,6 +84,8 @@
 #	define MSG_ERRQUEUE		0x2000
 #endif
 
+#define usecs_to_msecs(t)	( ((t) + 999) / 1000 )
+
 /* PGM internal time keeper */
 extern "C" {
 	typedef pgm_time_t (*pgm_time_update_func)(void);
@@ -118,6 +124,9 @@ static gboolean		g_use_fec = FALSE;
 static int		g_rs_k = 8;
 static int		g_rs_n = 255;
 
+static int		g_open_loop_threads = 0;	/* 0 = closed loop */
+static const char*	g_json_path = NULL;		/* "-" = stdout */
+
 static enum {
 	PGMPING_MODE_SOURCE,
 	PGMPING_MODE_RECEIVER,
@@ -127,9 +136,37 @@ static enum {
 
 static pgm_sock_t*	g_sock = NULL;
 
+/* HDR-style log-linear histogram of microsecond values: values under
+ * HDR_SUB_COUNT are exact, above each power of two is split into
+ * HDR_SUB_COUNT/2 buckets for under 1% relative error.
+ */
+#define HDR_SUB_BITS		7
+#define HDR_SUB_COUNT		(1 << HDR_SUB_BITS)
+#define HDR_SUB_HALF		(HDR_SUB_COUNT / 2)
+#define HDR_MAX_BITS		40		/* ~12 days */
+#define HDR_BUCKETS		((HDR_MAX_BITS - HDR_SUB_BITS + 2) * HDR_SUB_HALF)
+
+struct hdr_histogram_t {
+	guint64			counts[HDR_BUCKETS];
+	guint64			total;
+	guint64			min;
+	guint64			max;
+	double			sum;
+};
+
+/* one per sending thread, counters only written by the owner */
+struct sender_t {
+	pgm_sock_t*		sock;
+	unsigned		index;
+	GThread*		thread;
+	volatile guint64	msg_sent;
+	volatile guint64	out_total;
+	struct hdr_histogram_t	lag;		/* actual minus intended send time */
+};
+
 /* stats */
-static guint64		g_msg_sent = 0;
 static guint64		g_msg_received = 0;
+static guint64		g_in_bytes = 0;
 static pgm_time_t	g_interval_start = 0;
 static pgm_time_t	g_latency_current = 0;
 static guint64		g_latency_seqno = 0;
@@ -144,8 +181,11 @@ static double		g_latency_min = INFINITY;
 static double		g_latency_min = (double)INT64_MAX;
 #endif
 static double		g_latency_running_average = 0.0;
-static guint64		g_out_total = 0;
+static guint64		g_out_last = 0;	/* sender out_total at last mark */
 static guint64		g_in_total = 0;
+static pgm_time_t	g_run_start = 0;
+static struct hdr_histogram_t g_latency;	/* receive minus actual send time */
+static struct hdr_histogram_t g_corrected;	/* receive minus intended send time */
 
 #ifdef CONFIG_WITH_HEATMAP
 static FILE*		g_heatmap_file = NULL;
@@ -155,7 +195,8 @@ static guint		g_heatmap_resolution = 10;	/* microseconds */
 #endif
 
 static GMainLoop*	g_loop = NULL;
-static GThread*		g_sender_thread = NULL;
+static struct sender_t*	g_senders = NULL;
+static unsigned		g_senders_len = 0;
 static GThread*		g_receiver_thread = NULL;
 static gboolean		g_quit = FALSE;
 #ifdef G_OS_UNIX
@@ -169,6 +210,9 @@ static BOOL on_console_ctrl (DWORD);
 static gboolean on_startup (gpointer);
 static gboolean on_shutdown (gpointer);
 static gboolean on_mark (gpointer);
+static void write_summary (FILE*);
+static void hdr_init (struct hdr_histogram_t*);
+static void hdr_record (struct hdr_histogram_t*, guint64);
 
 static void send_odata (void);
 static int on_msgv (struct pgm_msgv_t*, size_t);
@@ -199,6 +243,8 @@ usage (const char* bin)
 #ifdef CONFIG_WITH_HEATMAP
 	fprintf (stderr, "  -M <filename>   : Generate latency heap map\n");
 #endif
+	fprintf (stderr, "  -t <threads>    : Open-loop mode, publish at -m rate on a fixed schedule\n");
+	fprintf (stderr, "  -j <filename>   : Write latency and throughput summary as JSON, - for stdout\n");
         fprintf (stderr, "  -H              : Enable HTTP administrative interface\n");
         fprintf (stderr, "  -S              : Enable SNMP interface\n");
 	exit (1);
@@ -238,7 +284,7 @@ main (
 /* parse program arguments */
 	const char* binary_name = g_get_prgname();
 	int c;
-	while ((c = getopt (argc, argv, "s:n:p:m:old:r:O:D:cfeK:N:M:HSh")) != -1)
+	while ((c = getopt (argc, argv, "s:n:p:m:old:r:O:D:cfeK:N:M:t:j:HSh")) != -1)
 	{
 		switch (c) {
 		case 'n':	g_network = optarg; break;
@@ -260,6 +306,9 @@ main (
 		case 'M':	g_warning ("Heat map support not compiled in."); break;
 #endif
 
+		case 't':	g_open_loop_threads = atoi (optarg); break;
+		case 'j':	g_json_path = optarg; break;
+
 		case 'H':	enable_http = TRUE; break;
 		case 'S':	enable_snmpx = TRUE; break;
 
@@ -281,6 +330,14 @@ main (
 		usage (binary_name);
 	}
 
+/* an open loop needs a schedule */
+	if (g_open_loop_threads < 0 || (g_open_loop_threads > 0 && g_odata_rate <= 0)) {
+		g_error ("Open-loop mode requires threads and a message rate.");
+		usage (binary_name);
+	}
+	hdr_init (&g_latency);
+	hdr_init (&g_corrected);
+
 #ifdef CONFIG_WITH_HEATMAP
 	if (NULL != g_heatmap_file) {
 		g_heatmap_slice = g_hash_table_new (g_direct_hash, g_direct_equal);
@@ -362,16 +419,16 @@ main (
 #ifdef G_OS_UNIX
 	const char one = '1';
 	write (g_quit_pipe[1], &one, sizeof(one));
-	if (PGMPING_MODE_SOURCE == g_mode || PGMPING_MODE_INITIATOR == g_mode)
-		g_thread_join (g_sender_thread);
+	for (unsigned i = 0; i < g_senders_len; i++)
+		g_thread_join (g_senders[i].thread);
 	g_thread_join (g_receiver_thread);
 	close (g_quit_pipe[0]);
 	close (g_quit_pipe[1]);
 #else
 	const char one = '1';
 	send (g_quit_socket[1], &one, sizeof(one), 0);
-	if (PGMPING_MODE_SOURCE == g_mode || PGMPING_MODE_INITIATOR == g_mode)
-		g_thread_join (g_sender_thread);
+	for (unsigned i = 0; i < g_senders_len; i++)
+		g_thread_join (g_senders[i].thread);
 	g_thread_join (g_receiver_thread);
 	closesocket (g_quit_socket[0]);
 	closesocket (g_quit_socket[1]);
@@ -380,6 +437,22 @@ main (
 	g_main_loop_unref (g_loop);
 	g_loop = NULL;
 
+	if (NULL != g_json_path) {
+		if (0 == strcmp (g_json_path, "-"))
+			write_summary (stdout);
+		else {
+			FILE* fp = fopen (g_json_path, "w");
+			if (NULL == fp)
+				g_warning ("opening %s failed errno %i: \"%s\"", g_json_path, errno, strerror(errno));
+			else {
+				write_summary (fp);
+				fclose (fp);
+			}
+		}
+	}
+	g_free (g_senders);
+	g_senders = NULL;
+
 	if (g_sock) {
 		g_message ("closing PGM socket.");
 		pgm_close (g_sock, TRUE);
@@ -789,18 +862,28 @@ on_startup (
 // TODO: Gnome 2.14: replace with g_timeout_add_seconds()
 	g_timeout_add (2 * 1000, (GSourceFunc)on_mark, NULL);
 
+	g_run_start = pgm_time_update_now();
 	if (PGMPING_MODE_SOURCE == g_mode || PGMPING_MODE_INITIATOR == g_mode)
 	{
-		g_sender_thread = g_thread_create_full (sender_thread,
-							g_sock,
-							0,
-							TRUE,
-							TRUE,
-							G_THREAD_PRIORITY_NORMAL,
-							&err);
-		if (!g_sender_thread) {
-			g_critical ("g_thread_create_full failed errno %i: \"%s\"", err->code, err->message);
-			goto err_abort;
+		g_senders_len = g_open_loop_threads > 0 ? g_open_loop_threads : 1;
+		g_senders = g_new0 (struct sender_t, g_senders_len);
+		for (unsigned i = 0; i < g_senders_len; i++)
+		{
+			g_senders[i].sock  = g_sock;
+			g_senders[i].index = i;
+			hdr_init (&g_senders[i].lag);
+			g_senders[i].thread = g_thread_create_full (sender_thread,
+								    &g_senders[i],
+								    0,
+								    TRUE,
+								    TRUE,
+								    G_THREAD_PRIORITY_NORMAL,
+								    &err);
+			if (!g_senders[i].thread) {
+				g_critical ("g_thread_create_full failed errno %i: \"%s\"", err->code, err->message);
+				g_senders_len = i;
+				goto err_abort;
+			}
 		}
 	}
 
@@ -843,7 +926,8 @@ sender_thread (
 	gpointer	user_data
 	)
 {
-	pgm_sock_t* tx_sock = (pgm_sock_t*)user_data;
+	struct sender_t* sender = (struct sender_t*)user_data;
+	pgm_sock_t* tx_sock = sender->sock;
 	example::Ping ping;
 	string subject("PING.PGM.TEST.");
 	char hostname[NI_MAXHOST + 1];
@@ -851,6 +935,7 @@ sender_thread (
 	char payload[payload_len];
 	gpointer buffer = NULL;
 	guint64 latency, now, last = 0;
+	guint64 seqno = sender->index;
 
 #ifdef CONFIG_HAVE_EPOLL
 	const long ev_len = 1;
@@ -926,15 +1011,17 @@ sender_thread (
 	ping.mutable_market_data_header()->set_rec_type (example::MarketDataHeader::PING);
 	ping.mutable_market_data_header()->set_rec_status (example::MarketDataHeader::STATUS_OK);
 	ping.set_time (last);
+	if (g_open_loop_threads > 0)
+		ping.set_intended_time (last);
 
 	last = now = pgm_time_update_now();
 	do {
-		if (g_msg_sent && g_latency_seqno + 1 == g_msg_sent)
+		if (sender->msg_sent && g_latency_seqno + 1 == sender->msg_sent)
 			latency = g_latency_current;
 		else
 			latency = g_odata_interval;
 
-		ping.set_seqno (g_msg_sent);
+		ping.set_seqno (seqno);
 		ping.set_latency (latency);
 		ping.set_payload (payload, sizeof(payload));
 
@@ -944,13 +1031,31 @@ sender_thread (
 		pgm_skb_reserve (skb, header_size);
 		pgm_skb_put (skb, apdu_size);
 
+/* open loop: messages of all threads interleave on one schedule from the
+ * start of the run, a late message is sent at once and keeps its slot.
+ */
+		if (g_open_loop_threads > 0) {
+			const pgm_time_t intended = g_run_start + (seqno * 1000000) / g_odata_rate;
+			now = pgm_time_update_now();
+			if (intended > now) {
+#ifndef _WIN32
+				usleep ((useconds_t)(intended - now));
+#else
+				const DWORD msec = (DWORD)usecs_to_msecs (intended - now);
+				if (msec > 0)
+					Sleep (msec);
+#endif
+				now = pgm_time_update_now();
+			}
+			ping.set_intended_time (intended);
+			hdr_record (&sender->lag, now > intended ? now - intended : 0);
+		}
 /* wait on packet rate limit */
-		if ((last + g_odata_interval) > now) {
+		else if ((last + g_odata_interval) > now) {
 #ifndef _WIN32
 			const unsigned int usec = g_odata_interval - (now - last);
 			usleep (usec);
 #else
-#	define usecs_to_msecs(t)	( ((t) + 999) / 1000 )
 			const DWORD msec = (DWORD)usecs_to_msecs (g_odata_interval - (now - last));
 /* Avoid yielding on Windows XP/2000 */ 
 			if (msec > 0)
@@ -1122,8 +1227,9 @@ again:
 			g_main_loop_quit (g_loop);
 			return NULL;
 		}
-		g_out_total += bytes_written;
-		g_msg_sent++;
+		sender->out_total += bytes_written;
+		sender->msg_sent++;
+		seqno += g_senders_len;
 	} while (G_LIKELY(!g_quit));
 
 #if defined(CONFIG_HAVE_EPOLL)
@@ -1427,12 +1533,14 @@ g_message ("reflector congestion");
 			const guint64 seqno		= ping.seqno();
 			const guint64 latency		= ping.latency();
 
-			if (seqno < g_latency_seqno) {
+/* open-loop threads interleave so sequence numbers may arrive out of order */
+			if (seqno < g_latency_seqno && !ping.has_intended_time()) {
 				g_message ("seqno replay?");
 				goto next_msg;
 			}
 
 			g_in_total += pskb->len;
+			g_in_bytes += apdu_len;
 			g_msg_received++;
 
 /* handle ping */
@@ -1450,7 +1558,12 @@ g_message ("reflector congestion");
 				goto next_msg;
 			}
 			g_latency_current	= pgm_to_secs (recv_time - send_time);
-			g_latency_seqno		= seqno;
+			if (seqno > g_latency_seqno)
+				g_latency_seqno	= seqno;
+
+			hdr_record (&g_latency, pgm_to_usecs (recv_time - send_time));
+			if (ping.has_intended_time())
+				hdr_record (&g_corrected, pgm_to_usecs (recv_time - ping.intended_time()));
 
 			const double elapsed    = pgm_to_usecsf (recv_time - send_time);
 			g_latency_total	       += elapsed;
@@ -1502,8 +1615,12 @@ on_mark (
 {
 	const pgm_time_t now = pgm_time_update_now ();
 	const double interval = pgm_to_secsf(now - g_interval_start);
+	guint64 out_total = 0;
 	g_interval_start = now;
 
+	for (unsigned i = 0; i < g_senders_len; i++)
+		out_total += g_senders[i].out_total;
+
 /* receiving a ping */
 	if (g_latency_count)
 	{
@@ -1524,7 +1641,7 @@ on_mark (
 		else
 		{
 			double seq_rate = (g_latency_seqno - g_last_seqno) / interval;
-			double out_rate = g_out_total * 8.0 / 1000000.0 / interval;
+			double out_rate = (out_total - g_out_last) * 8.0 / 1000000.0 / interval;
 			double  in_rate = g_in_total  * 8.0 / 1000000.0 / interval;
 			if (g_latency_min < 1000.0)
 				g_message ("s=%.01f avg=%.01f min=%.01f max=%.01f stddev=%0.1f us o=%.2f i=%.2f mbit",
@@ -1545,7 +1662,7 @@ on_mark (
 		g_latency_min		= (double)INT64_MAX;
 #endif
 		g_latency_max		= 0.0;
-		g_out_total		= 0;
+		g_out_last		= out_total;
 		g_in_total		= 0;
 
 #ifdef CONFIG_WITH_HEATMAP
@@ -1575,4 +1692,171 @@ on_mark (
 	return TRUE;
 }
 
+static
+void
+hdr_init (
+	struct hdr_histogram_t*	h
+	)
+{
+	memset (h, 0, sizeof (struct hdr_histogram_t));
+	h->min = G_MAXUINT64;
+}
+
+static
+unsigned
+hdr_index (
+	guint64		value
+	)
+{
+	unsigned shift = 0;
+
+	if (value >= (G_GUINT64_CONSTANT(1) << HDR_MAX_BITS))
+		value = (G_GUINT64_CONSTANT(1) << HDR_MAX_BITS) - 1;
+	while ((value >> shift) >= HDR_SUB_COUNT)
+		shift++;
+	return (shift * HDR_SUB_HALF) + (unsigned)(value >> shift);
+}
+
+/* highest value recorded into the bucket at index */
+
+static
+guint64
+hdr_value (
+	unsigned	index
+	)
+{
+	if (index < HDR_SUB_COUNT)
+		return index;
+	const unsigned shift = (index / HDR_SUB_HALF) - 1;
+	const guint64 sub = index - (shift * HDR_SUB_HALF);
+	return ((sub + 1) << shift) - 1;
+}
+
+static
+void
+hdr_record (
+	struct hdr_histogram_t*	h,
+	guint64			value
+	)
+{
+	h->counts[ hdr_index (value) ]++;
+	h->total++;
+	h->sum += (double)value;
+	if (value < h->min)
+		h->min = value;
+	if (value > h->max)
+		h->max = value;
+}
+
+static
+void
+hdr_merge (
+	struct hdr_histogram_t*		dst,
+	const struct hdr_histogram_t*	src
+	)
+{
+	for (unsigned i = 0; i < HDR_BUCKETS; i++)
+		dst->counts[i] += src->counts[i];
+	dst->total += src->total;
+	dst->sum   += src->sum;
+	if (src->min < dst->min)
+		dst->min = src->min;
+	if (src->max > dst->max)
+		dst->max = src->max;
+}
+
+static
+guint64
+hdr_percentile (
+	const struct hdr_histogram_t*	h,
+	double				percentile
+	)
+{
+	const guint64 target = (guint64)ceil ((percentile / 100.0) * h->total);
+	guint64 count = 0;
+
+	if (0 == h->total)
+		return 0;
+	for (unsigned i = 0; i < HDR_BUCKETS; i++) {
+		count += h->counts[i];
+		if (count >= MAX(target, 1))
+			return MIN(hdr_value (i), h->max);
+	}
+	return h->max;
+}
+
+static
+void
+hdr_write_json (
+	FILE*				fp,
+	const char*			name,
+	const struct hdr_histogram_t*	h
+	)
+{
+	fprintf (fp, "\t\"%s\": { \"count\": %" G_GUINT64_FORMAT, name, h->total);
+	if (h->total > 0)
+		fprintf (fp, ", \"min\": %" G_GUINT64_FORMAT
+			     ", \"mean\": %.1f"
+			     ", \"p50\": %" G_GUINT64_FORMAT
+			     ", \"p90\": %" G_GUINT64_FORMAT
+			     ", \"p99\": %" G_GUINT64_FORMAT
+			     ", \"p999\": %" G_GUINT64_FORMAT
+			     ", \"p9999\": %" G_GUINT64_FORMAT
+			     ", \"max\": %" G_GUINT64_FORMAT,
+			 h->min,
+			 h->sum / h->total,
+			 hdr_percentile (h, 50.0),
+			 hdr_percentile (h, 90.0),
+			 hdr_percentile (h, 99.0),
+			 hdr_percentile (h, 99.9),
+			 hdr_percentile (h, 99.99),
+			 h->max);
+	fprintf (fp, " },\n");
+}
+
+/* run summary, latencies in microseconds.
+ */
+
+static
+void
+write_summary (
+	FILE*		fp
+	)
+{
+	static const char* modes[] = { "source", "receiver", "initiator", "reflector" };
+	const double elapsed = pgm_to_secsf (pgm_time_update_now() - g_run_start);
+	struct hdr_histogram_t* lag = g_new (struct hdr_histogram_t, 1);
+	guint64 msg_sent = 0, out_total = 0;
+
+	hdr_init (lag);
+	for (unsigned i = 0; i < g_senders_len; i++) {
+		msg_sent  += g_senders[i].msg_sent;
+		out_total += g_senders[i].out_total;
+		hdr_merge (lag, &g_senders[i].lag);
+	}
+
+	fprintf (fp, "{\n");
+	fprintf (fp, "\t\"mode\": \"%s\",\n", modes[ g_mode ]);
+	fprintf (fp, "\t\"open_loop\": %s,\n", g_open_loop_threads > 0 ? "true" : "false");
+	fprintf (fp, "\t\"threads\": %u,\n", g_senders_len);
+	fprintf (fp, "\t\"target_rate\": %d,\n", g_odata_rate);
+	fprintf (fp, "\t\"elapsed\": %.3f,\n", elapsed);
+	fprintf (fp, "\t\"sent\": { \"messages\": %" G_GUINT64_FORMAT ", \"bytes\": %" G_GUINT64_FORMAT
+		     ", \"rate\": %.1f, \"mbit\": %.3f },\n",
+		 msg_sent, out_total,
+		 elapsed > 0.0 ? msg_sent / elapsed : 0.0,
+		 elapsed > 0.0 ? out_total * 8.0 / 1000000.0 / elapsed : 0.0);
+	fprintf (fp, "\t\"received\": { \"messages\": %" G_GUINT64_FORMAT ", \"bytes\": %" G_GUINT64_FORMAT
+		     ", \"rate\": %.1f, \"mbit\": %.3f },\n",
+		 g_msg_received, g_in_bytes,
+		 elapsed > 0.0 ? g_msg_received / elapsed : 0.0,
+		 elapsed > 0.0 ? g_in_bytes * 8.0 / 1000000.0 / elapsed : 0.0);
+	hdr_write_json (fp, "send_lag", lag);
+	hdr_write_json (fp, "latency", &g_latency);
+	hdr_write_json (fp, "corrected_latency", &g_corrected);
+	fprintf (fp, "\t\"units\": \"usec\"\n");
+	fprintf (fp, "}\n");
+	g_free (lag);
+}
+
 /* eof */
@@ -0,0 +1,158 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * Display the statistics segment of a PGM process.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* MSVC secure CRT */
+#define _CRT_SECURE_NO_WARNINGS		1
+
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#	include <unistd.h>
+#	include <getopt.h>
+#else
+#	include "getopt.h"
+#	define usleep(x)	Sleep((x)/1000)
+#endif
+#include <pgm/pgm.h>
+
+
+/* globals */
+
+static const char*	segment = "/pgm";
+static int		interval = 1000;	/* milliseconds */
+static int		count = 0;
+
+#ifndef _MSC_VER
+static void usage (const char*) __attribute__((__noreturn__));
+#else
+static void usage (const char*);
+#endif
+
+static void print_slots (const pgm_shmstats_header_t*);
+
+
+static void
+usage (
+	const char*	bin
+	)
+{
+	fprintf (stderr, "Usage: %s [options]\n", bin);
+	fprintf (stderr, "  -n, --name NAME          : Statistics segment name (/pgm)\n");
+	fprintf (stderr, "  -i, --interval MSECS     : Display interval (1000)\n");
+	fprintf (stderr, "  -c, --count COUNT        : Number of displays, 0 for continuous\n");
+	exit (EXIT_SUCCESS);
+}
+
+int
+main (
+	int		argc,
+	char*		argv[]
+	)
+{
+	pgm_error_t* pgm_err = NULL;
+
+	setlocale (LC_ALL, "");
+
+/* parse program arguments */
+#ifdef _WIN32
+	const char* binary_name = strrchr (argv[0], '\\');
+#else
+	const char* binary_name = strrchr (argv[0], '/');
+#endif
+	if (NULL == binary_name)	binary_name = argv[0];
+	else				binary_name++;
+
+	static struct option long_options[] = {
+		{ "name",           required_argument, NULL, 'n' },
+		{ "interval",       required_argument, NULL, 'i' },
+		{ "count",          required_argument, NULL, 'c' },
+		{ "help",           no_argument,       NULL, 'h' },
+		{ NULL, 0, NULL, 0 }
+	};
+
+	int c;
+	while ((c = getopt_long (argc, argv, "n:i:c:h", long_options, NULL)) != -1)
+	{
+		switch (c) {
+		case 'n':	segment = optarg; break;
+		case 'i':	interval = atoi (optarg); break;
+		case 'c':	count = atoi (optarg); break;
+
+		case 'h':
+		case '?': usage (binary_name);
+		}
+	}
+
+/* segments are read without starting the PGM engine */
+	pgm_shmstats_header_t* header = pgm_shmstats_attach (segment, &pgm_err);
+	if (NULL == header) {
+		fprintf (stderr, "Unable to attach statistics segment: %s\n", pgm_err->message);
+		pgm_error_free (pgm_err);
+		return EXIT_FAILURE;
+	}
+
+	printf ("Statistics segment %s of pid %u, %u slots published every %uus.\n",
+		segment, (unsigned)header->pid, (unsigned)header->slot_count, (unsigned)header->interval);
+	for (int i = 0; 0 == count || i < count; i++) {
+		if (i > 0)
+			usleep (interval * 1000);
+		print_slots (header);
+	}
+
+	pgm_shmstats_detach (header);
+	return EXIT_SUCCESS;
+}
+
+/* one line per slot with every non-zero counter.
+ */
+
+static
+void
+print_slots (
+	const pgm_shmstats_header_t*	header
+	)
+{
+	pgm_shmstats_slot_t slot;
+	char tsi[PGM_TSISTRLEN];
+
+	printf ("-- pass %u: %u rows", (unsigned)header->passes, (unsigned)header->slot_len);
+	if (header->truncated)
+		printf (", %u without slots", (unsigned)header->truncated);
+	putchar ('\n');
+	for (unsigned i = 0; i < header->slot_len; i++) {
+		if (!pgm_shmstats_read (header, i, &slot))
+			continue;
+		const char (*names)[PGM_SHMSTATS_NAMELEN] = (PGM_SHMSTATS_SLOT_SOURCE == slot.type) ?
+							     header->source_names : header->receiver_names;
+		pgm_tsi_print_r (&slot.tsi, tsi, sizeof (tsi));
+		printf ("%s %s", (PGM_SHMSTATS_SLOT_SOURCE == slot.type) ? "source" : "receiver", tsi);
+		for (unsigned j = 0; j < PGM_SHMSTATS_COUNTERS && '\0' != names[j][0]; j++) {
+			if (slot.counters[j])
+				printf (" %s=%llu", names[j], (unsigned long long)slot.counters[j]);
+		}
+		putchar ('\n');
+	}
+	fflush (stdout);
+}
+
+/* eof */
@@ -0,0 +1,178 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * Decode an event trace saved by pgm_evtrace_save().
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* MSVC secure CRT */
+#define _CRT_SECURE_NO_WARNINGS		1
+
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifndef _WIN32
+#	include <unistd.h>
+#	include <getopt.h>
+#else
+#	include "getopt.h"
+#endif
+#include <pgm/pgm.h>
+
+
+/* globals */
+
+static const char*	event_name = NULL;
+static unsigned		last = 0;
+
+#ifndef _MSC_VER
+static void usage (const char*) __attribute__((__noreturn__));
+#else
+static void usage (const char*);
+#endif
+
+static void print_event (const pgm_evtrace_header_t*, const pgm_evtrace_event_t*);
+
+
+static void
+usage (
+	const char*	bin
+	)
+{
+	fprintf (stderr, "Usage: %s [options] FILE\n", bin);
+	fprintf (stderr, "  -e, --event NAME         : Only show events of this name\n");
+	fprintf (stderr, "  -l, --last COUNT         : Only show the most recent events\n");
+	exit (EXIT_SUCCESS);
+}
+
+int
+main (
+	int		argc,
+	char*		argv[]
+	)
+{
+	setlocale (LC_ALL, "");
+
+/* parse program arguments */
+#ifdef _WIN32
+	const char* binary_name = strrchr (argv[0], '\\');
+#else
+	const char* binary_name = strrchr (argv[0], '/');
+#endif
+	if (NULL == binary_name)	binary_name = argv[0];
+	else				binary_name++;
+
+	static struct option long_options[] = {
+		{ "event",          required_argument, NULL, 'e' },
+		{ "last",           required_argument, NULL, 'l' },
+		{ "help",           no_argument,       NULL, 'h' },
+		{ NULL, 0, NULL, 0 }
+	};
+
+	int c;
+	while ((c = getopt_long (argc, argv, "e:l:h", long_options, NULL)) != -1)
+	{
+		switch (c) {
+		case 'e':	event_name = optarg; break;
+		case 'l':	last = atoi (optarg); break;
+
+		case 'h':
+		case '?': usage (binary_name);
+		}
+	}
+	if (optind != argc - 1)
+		usage (binary_name);
+
+/* traces are decoded without starting the PGM engine */
+	FILE* fp = fopen (argv[optind], "rb");
+	if (NULL == fp) {
+		perror (argv[optind]);
+		return EXIT_FAILURE;
+	}
+	pgm_evtrace_header_t header;
+	if (1 != fread (&header, sizeof (header), 1, fp) ||
+	    PGM_EVTRACE_MAGIC != header.magic)
+	{
+		fprintf (stderr, "%s: not an event trace.\n", argv[optind]);
+		fclose (fp);
+		return EXIT_FAILURE;
+	}
+	if (PGM_EVTRACE_VERSION != header.version ||
+	    sizeof (pgm_evtrace_event_t) != header.event_size)
+	{
+		fprintf (stderr, "%s: unsupported trace version %u with %u byte events.\n",
+			 argv[optind], (unsigned)header.version, (unsigned)header.event_size);
+		fclose (fp);
+		return EXIT_FAILURE;
+	}
+
+	printf ("Event trace of %u events saved at ", (unsigned)header.count);
+	const time_t saved = (time_t)(header.wall_usecs / 1000000);
+	char timestamp[64];
+	strftime (timestamp, sizeof (timestamp), "%Y-%m-%d %H:%M:%S", localtime (&saved));
+	printf ("%s.\n", timestamp);
+
+	const unsigned skip = (last && last < header.count) ? header.count - last : 0;
+	for (unsigned i = 0; i < header.count; i++) {
+		pgm_evtrace_event_t event;
+		if (1 != fread (&event, sizeof (event), 1, fp)) {
+			fprintf (stderr, "%s: truncated after %u events.\n", argv[optind], i);
+			fclose (fp);
+			return EXIT_FAILURE;
+		}
+		if (i < skip)
+			continue;
+		const char* name = pgm_evtrace_name (event.id);
+		if (NULL != event_name && (NULL == name || 0 != strcmp (event_name, name)))
+			continue;
+		print_event (&header, &event);
+	}
+
+	fclose (fp);
+	return EXIT_SUCCESS;
+}
+
+/* one line per event, the wall clock is derived from both clocks read at save.
+ */
+
+static
+void
+print_event (
+	const pgm_evtrace_header_t*	header,
+	const pgm_evtrace_event_t*	event
+	)
+{
+	const uint64_t age = header->tstamp > event->tstamp ? header->tstamp - event->tstamp : 0;
+	const uint64_t usecs = header->wall_usecs - age;
+	const time_t secs = (time_t)(usecs / 1000000);
+	char timestamp[64], tsi[PGM_TSISTRLEN];
+	strftime (timestamp, sizeof (timestamp), "%H:%M:%S", localtime (&secs));
+	pgm_tsi_print_r (&event->tsi, tsi, sizeof (tsi));
+	const char* name = pgm_evtrace_name (event->id);
+
+	printf ("%s.%06u %2u %-14s %-29s %10u %5u\n",
+		timestamp, (unsigned)(usecs % 1000000),
+		(unsigned)event->thread,
+		name ? name : "unknown",
+		tsi,
+		(unsigned)event->sqn,
+		(unsigned)event->arg);
+}
+
+/* eof */
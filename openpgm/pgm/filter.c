@@ -0,0 +1,224 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * In-kernel receive socket filter: a classic BPF program on the receive
+ * sockets discards datagrams of other sessions, sources and unwanted packet
+ * types before they are queued, saving a system call and a parse for each.
+ *
+ * Copyright (c) 2006-2011 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <impl/framework.h>
+#include <impl/socket.h>
+
+#ifdef PGM_HAVE_RECV_FILTER
+#	include <stddef.h>
+#	include <sys/socket.h>
+#	include <netinet/in.h>
+#	include <linux/filter.h>
+
+
+//#define FILTER_DEBUG
+
+#ifndef FILTER_DEBUG
+#	define PGM_DISABLE_ASSERT
+#endif
+
+#define PGM_FILTER_UDP_HLEN		8
+#define PGM_FILTER_MAX_INSNS		1024
+
+/* assemble the program, all loads are relative to X holding the offset of the
+ * PGM header: after the UDP header for encapsulation, after the variable
+ * length IPv4 header for raw sockets, raw IPv6 sockets see no IP header.
+ *
+ * packet types are matched first, then the data-destination port, carried as
+ * the source port upstream, then GSIs denied by PGM_SOURCE_FILTER, and
+ * finally the GSI against the allow list of fr_gsi, or otherwise the sources
+ * of PGM_SOURCE_FILTER, extended by the socket's own for NAKs and SPMRs to a
+ * source.  Sessions of one GSI are told apart in user space.
+ *
+ * a GSI is matched in five instructions ending with its own return, keeping
+ * every jump short.  a TPACKET_V3 ring sees every IPv4 datagram of the
+ * interface and is first narrowed to PGM/IP by its own prefix.
+ *
+ * returns count of instructions.
+ */
+
+static
+unsigned
+filter_assemble (
+	const pgm_sock_t* const			sock,
+	const struct pgm_filter_req_t* const	fr,
+	struct sock_filter* const		insns
+	)
+{
+	static const uint8_t upstream[] = { PGM_NAK, PGM_NNAK, PGM_SPMR, PGM_POLR, PGM_ACK };
+	const struct pgm_source_filter_req_t* sf = &sock->rx_source_filter;
+	unsigned to_sport[sizeof(upstream)], n = 0;
+	pgm_gsi_t gsi[PGM_SOURCE_FILTER_MAX + 1], deny[PGM_SOURCE_FILTER_MAX];
+	unsigned gsi_len = 0, deny_len = 0;
+	bool has_type = FALSE;
+
+#ifdef HAVE_LINUX_IF_PACKET_H
+	if (NULL != sock->rx_tpacket)
+		n = pgm_recv_tpacket_filter_prefix (insns);
+#endif
+	if (fr->fr_gsi_len > 0) {
+		gsi_len = MIN(fr->fr_gsi_len, PGM_FILTER_MAX_GSI);
+		memcpy (gsi, fr->fr_gsi, gsi_len * sizeof (pgm_gsi_t));
+	}
+/* sorted list, sessions of one GSI are adjacent */
+	for (unsigned i = 0; i < sf->sf_len; i++) {
+		if (i > 0 && pgm_gsi_equal (&sf->sf_tsi[i].gsi, &sf->sf_tsi[i - 1].gsi))
+			continue;
+		if (PGM_SOURCE_DENY == sf->sf_mode) {
+			if (0 == sf->sf_tsi[i].sport)
+				memcpy (&deny[deny_len++], &sf->sf_tsi[i].gsi, sizeof (pgm_gsi_t));
+		} else if (0 == fr->fr_gsi_len)
+			memcpy (&gsi[gsi_len++], &sf->sf_tsi[i].gsi, sizeof (pgm_gsi_t));
+	}
+	if (gsi_len > 0 && sock->can_send_data) {
+		unsigned i = 0;
+		while (i < gsi_len && !pgm_gsi_equal (&gsi[i], &sock->tsi.gsi))
+			i++;
+		if (i == gsi_len)
+			memcpy (&gsi[gsi_len++], &sock->tsi.gsi, sizeof (pgm_gsi_t));
+	}
+
+#define STMT(c, k)		(insns[n++] = (struct sock_filter)BPF_STMT((c), (k)))
+#define JUMP(c, k, t, f)	(insns[n++] = (struct sock_filter)BPF_JUMP((c), (k), (t), (f)))
+#define LABEL(i)		(insns[(i)].jt = (uint8_t)(n - (i) - 1))
+
+	if (0 != sock->udp_encap_ucast_port)
+		STMT (BPF_LDX | BPF_W | BPF_IMM, PGM_FILTER_UDP_HLEN);
+	else if (AF_INET == sock->family)
+		STMT (BPF_LDX | BPF_B | BPF_MSH, 0);
+	else
+		STMT (BPF_LDX | BPF_W | BPF_IMM, 0);
+
+/* packet type */
+	if (0 != fr->fr_types)
+	{
+		unsigned types[16], m = 0;
+		for (unsigned t = 0; t < 16; t++)
+			if (fr->fr_types & PGM_FILTER_TYPE(t))
+				types[m++] = t;
+		STMT (BPF_LD | BPF_B | BPF_IND, offsetof (struct pgm_header, pgm_type));
+		STMT (BPF_ALU | BPF_AND | BPF_K, 0x0f);
+		for (unsigned i = 0; i < m; i++)
+			JUMP (BPF_JMP | BPF_JEQ | BPF_K, types[i], m - i, 0);
+		STMT (BPF_RET | BPF_K, 0);
+		has_type = TRUE;
+	}
+
+/* data-destination port, sessions of PGM_JOIN_DPORT included */
+	if (sock->rx_dports_len < PGM_FILTER_MAX_DPORTS)
+	{
+		in_port_t dports[PGM_FILTER_MAX_DPORTS];
+		unsigned q = 0;
+		dports[q++] = sock->dport;
+		for (unsigned i = 0; i < sock->rx_dports_len; i++)
+			if (sock->rx_dports[i] != sock->dport)
+				dports[q++] = sock->rx_dports[i];
+		if (!has_type) {
+			STMT (BPF_LD | BPF_B | BPF_IND, offsetof (struct pgm_header, pgm_type));
+			STMT (BPF_ALU | BPF_AND | BPF_K, 0x0f);
+		}
+		for (unsigned i = 0; i < sizeof(upstream); i++) {
+			to_sport[i] = n;
+			JUMP (BPF_JMP | BPF_JEQ | BPF_K, upstream[i], 0, 0);
+		}
+		STMT (BPF_LD | BPF_H | BPF_IND, offsetof (struct pgm_header, pgm_dport));
+		JUMP (BPF_JMP | BPF_JA, 1, 0, 0);
+		for (unsigned i = 0; i < sizeof(upstream); i++)
+			LABEL (to_sport[i]);
+		STMT (BPF_LD | BPF_H | BPF_IND, offsetof (struct pgm_header, pgm_sport));
+		for (unsigned i = 0; i < q; i++)
+			JUMP (BPF_JMP | BPF_JEQ | BPF_K, ntohs (dports[i]), q - i, 0);
+		STMT (BPF_RET | BPF_K, 0);
+	}
+
+/* global source identifier, loaded in network order */
+#define GSI(id, ret) \
+	do { \
+		STMT (BPF_LD | BPF_W | BPF_IND, offsetof (struct pgm_header, pgm_gsi)); \
+		JUMP (BPF_JMP | BPF_JEQ | BPF_K, (uint32_t)(id)[0] << 24 | (uint32_t)(id)[1] << 16 | (uint32_t)(id)[2] << 8 | (id)[3], 0, 3); \
+		STMT (BPF_LD | BPF_H | BPF_IND, offsetof (struct pgm_header, pgm_gsi) + 4); \
+		JUMP (BPF_JMP | BPF_JEQ | BPF_K, (uint32_t)(id)[4] << 8 | (id)[5], 0, 1); \
+		STMT (BPF_RET | BPF_K, (ret)); \
+	} while (0)
+
+	for (unsigned i = 0; i < deny_len; i++)
+		GSI (deny[i].identifier, 0);
+	if (gsi_len > 0) {
+		for (unsigned i = 0; i < gsi_len; i++)
+			GSI (gsi[i].identifier, UINT32_MAX);
+		STMT (BPF_RET | BPF_K, 0);
+	} else
+		STMT (BPF_RET | BPF_K, UINT32_MAX);
+#undef GSI
+#undef LABEL
+#undef JUMP
+#undef STMT
+	pgm_assert (n <= PGM_FILTER_MAX_INSNS);
+	return n;
+}
+
+/* attach the program for the socket's ports, PGM_RECV_FILTER request and
+ * PGM_SOURCE_FILTER list to every receive socket, detaching all on failure,
+ * or to the TPACKET_V3 ring alone whilst the receive sockets are closed.
+ *
+ * on success returns TRUE, on failure returns FALSE setting errno.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_recv_filter_attach (
+	pgm_sock_t* const	sock
+	)
+{
+	struct sock_filter insns[PGM_FILTER_MAX_INSNS];
+	struct sock_fprog prog;
+
+	pgm_assert (NULL != sock);
+
+	prog.len	= (unsigned short)filter_assemble (sock, &sock->rx_filter_req, insns);
+	prog.filter	= insns;
+#ifdef HAVE_LINUX_IF_PACKET_H
+	if (NULL != sock->rx_tpacket)
+		return (SOCKET_ERROR != setsockopt (pgm_recv_tpacket_get_socket (sock->rx_tpacket), SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)));
+#endif
+	for (unsigned i = 0; i <= sock->recv_sock_extra_len; i++)
+	{
+		const SOCKET recv_sock = (0 == i) ? sock->recv_sock : sock->recv_sock_extra[i - 1];
+		if (SOCKET_ERROR == setsockopt (recv_sock, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog))) {
+			const int save_errno = errno;
+			const int v = 0;
+			while (i--)
+				setsockopt ((0 == i) ? sock->recv_sock : sock->recv_sock_extra[i - 1], SOL_SOCKET, SO_DETACH_FILTER, &v, sizeof(v));
+			errno = save_errno;
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+#endif /* PGM_HAVE_RECV_FILTER */
+
+/* eof */
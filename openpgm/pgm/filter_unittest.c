@@ -0,0 +1,225 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * unit tests for the in-kernel receive socket filter.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+#include <check.h>
+
+#define FILTER_DEBUG
+#include "filter.c"
+
+#ifdef _WIN32
+#	define PGM_CHECK_NOFORK		1
+#endif
+
+#ifdef PGM_HAVE_RECV_FILTER
+
+#define TEST_DPORT		7500
+
+static const pgm_gsi_t mock_gsi = {{ 1, 2, 3, 4, 5, 6 }};
+static const pgm_gsi_t mock_own_gsi = {{ 6, 5, 4, 3, 2, 1 }};
+static int mock_send_fd = -1;
+static struct sockaddr_in mock_addr;
+
+/* UDP encapsulated socket bound to loopback
+ */
+
+static
+pgm_sock_t*
+generate_sock (void)
+{
+	pgm_sock_t* sock = g_malloc0 (sizeof(pgm_sock_t));
+	socklen_t addrlen = sizeof(mock_addr);
+	sock->family = AF_INET;
+	sock->dport = htons (TEST_DPORT);
+	memcpy (&sock->tsi.gsi, &mock_own_gsi, sizeof (pgm_gsi_t));
+	sock->recv_sock = socket (AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	memset (&mock_addr, 0, sizeof(mock_addr));
+	mock_addr.sin_family		= AF_INET;
+	mock_addr.sin_addr.s_addr	= htonl (INADDR_LOOPBACK);
+	bind (sock->recv_sock, (struct sockaddr*)&mock_addr, sizeof(mock_addr));
+	getsockname (sock->recv_sock, (struct sockaddr*)&mock_addr, &addrlen);
+	sock->udp_encap_ucast_port = mock_addr.sin_port;
+	mock_send_fd = socket (AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	return sock;
+}
+
+static
+void
+free_sock (
+	pgm_sock_t*	sock
+	)
+{
+	close (sock->recv_sock);
+	close (mock_send_fd);
+	g_free (sock);
+}
+
+/* send a PGM header and report whether it passed the filter
+ */
+
+static
+bool
+mock_passes (
+	pgm_sock_t*		sock,
+	const uint8_t		type,
+	const uint16_t		sport,
+	const uint16_t		dport,
+	const pgm_gsi_t*	gsi
+	)
+{
+	struct pgm_header header, received;
+	memset (&header, 0, sizeof(header));
+	header.pgm_sport = htons (sport);
+	header.pgm_dport = htons (dport);
+	header.pgm_type  = type;
+	memcpy (header.pgm_gsi, gsi, sizeof (pgm_gsi_t));
+	sendto (mock_send_fd, &header, sizeof(header), 0, (struct sockaddr*)&mock_addr, sizeof(mock_addr));
+	const ssize_t len = recv (sock->recv_sock, &received, sizeof(received), MSG_DONTWAIT);
+	return (sizeof(header) == len && 0 == memcmp (&header, &received, sizeof(header)));
+}
+
+/* target:
+ *	bool
+ *	pgm_recv_filter_attach (
+ *		pgm_sock_t*		sock
+ *	)
+ */
+
+START_TEST (test_attach_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	sock->rx_filter_req.fr_types = PGM_FILTER_TYPE(PGM_SPM) | PGM_FILTER_TYPE(PGM_ODATA);
+	sock->rx_filter_req.fr_gsi_len = 1;
+	memcpy (&sock->rx_filter_req.fr_gsi[0], &mock_gsi, sizeof (pgm_gsi_t));
+	fail_unless (TRUE == pgm_recv_filter_attach (sock), "attach failed");
+	fail_unless (TRUE == mock_passes (sock, PGM_ODATA, 1000, TEST_DPORT, &mock_gsi), "ODATA dropped");
+	fail_unless (TRUE == mock_passes (sock, PGM_SPM, 1000, TEST_DPORT, &mock_gsi), "SPM dropped");
+	fail_unless (FALSE == mock_passes (sock, PGM_RDATA, 1000, TEST_DPORT, &mock_gsi), "RDATA passed");
+	fail_unless (FALSE == mock_passes (sock, PGM_ODATA, 1000, TEST_DPORT + 1, &mock_gsi), "other port passed");
+	fail_unless (FALSE == mock_passes (sock, PGM_ODATA, 1000, TEST_DPORT, &mock_own_gsi), "other source passed");
+	free_sock (sock);
+}
+END_TEST
+
+/* upstream packets carry the port as source, a sending socket admits its own GSI */
+START_TEST (test_attach_pass_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	const in_port_t rx_dport = htons (TEST_DPORT + 2);
+	sock->can_send_data = TRUE;
+	sock->rx_dports = (in_port_t*)&rx_dport;
+	sock->rx_dports_len = 1;
+	sock->rx_filter_req.fr_gsi_len = 1;
+	memcpy (&sock->rx_filter_req.fr_gsi[0], &mock_gsi, sizeof (pgm_gsi_t));
+	fail_unless (TRUE == pgm_recv_filter_attach (sock), "attach failed");
+	fail_unless (TRUE == mock_passes (sock, PGM_NAK, TEST_DPORT, 1000, &mock_own_gsi), "NAK dropped");
+	fail_unless (FALSE == mock_passes (sock, PGM_NAK, TEST_DPORT + 1, 1000, &mock_own_gsi), "NAK of other port passed");
+	fail_unless (FALSE == mock_passes (sock, PGM_NAK, 1000, TEST_DPORT, &mock_own_gsi), "NAK on data port passed");
+	fail_unless (TRUE == mock_passes (sock, PGM_RDATA, 1000, TEST_DPORT + 2, &mock_gsi), "joined port dropped");
+	fail_unless (TRUE == mock_passes (sock, PGM_NCF, 1000, TEST_DPORT, &mock_gsi), "NCF dropped");
+	sock->rx_dports = NULL;
+	free_sock (sock);
+}
+END_TEST
+
+/* sources denied by GSI are dropped in the kernel, sessions are left to user space */
+START_TEST (test_attach_pass_003)
+{
+	pgm_sock_t* sock = generate_sock ();
+	struct pgm_source_filter_req_t* sf = &sock->rx_source_filter;
+	sf->sf_mode = PGM_SOURCE_DENY;
+	sf->sf_len = 2;
+	memcpy (&sf->sf_tsi[0].gsi, &mock_gsi, sizeof (pgm_gsi_t));
+	memcpy (&sf->sf_tsi[1].gsi, &mock_own_gsi, sizeof (pgm_gsi_t));
+	sf->sf_tsi[1].sport = htons (1000);
+	fail_unless (TRUE == pgm_recv_filter_attach (sock), "attach failed");
+	fail_unless (FALSE == mock_passes (sock, PGM_ODATA, 1000, TEST_DPORT, &mock_gsi), "denied GSI passed");
+	fail_unless (TRUE == mock_passes (sock, PGM_ODATA, 1000, TEST_DPORT, &mock_own_gsi), "denied session dropped");
+/* allow list */
+	sf->sf_mode = PGM_SOURCE_ALLOW;
+	fail_unless (TRUE == pgm_recv_filter_attach (sock), "attach failed");
+	fail_unless (TRUE == mock_passes (sock, PGM_ODATA, 1000, TEST_DPORT, &mock_gsi), "allowed GSI dropped");
+	const pgm_gsi_t other_gsi = {{ 9, 9, 9, 9, 9, 9 }};
+	fail_unless (FALSE == mock_passes (sock, PGM_ODATA, 1000, TEST_DPORT, &other_gsi), "unlisted GSI passed");
+	free_sock (sock);
+}
+END_TEST
+
+START_TEST (test_attach_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	close (sock->recv_sock);
+	sock->recv_sock = -1;
+	fail_unless (FALSE == pgm_recv_filter_attach (sock), "attach succeeded");
+	sock->recv_sock = socket (AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	free_sock (sock);
+}
+END_TEST
+#endif /* PGM_HAVE_RECV_FILTER */
+
+
+static
+Suite*
+make_test_suite (void)
+{
+	Suite* s;
+
+	s = suite_create (__FILE__);
+
+	TCase* tc_attach = tcase_create ("attach");
+	suite_add_tcase (s, tc_attach);
+#ifdef PGM_HAVE_RECV_FILTER
+	tcase_add_test (tc_attach, test_attach_pass_001);
+	tcase_add_test (tc_attach, test_attach_pass_002);
+	tcase_add_test (tc_attach, test_attach_pass_003);
+	tcase_add_test (tc_attach, test_attach_fail_001);
+#endif
+	return s;
+}
+
+static
+Suite*
+make_master_suite (void)
+{
+	Suite* s = suite_create ("Master");
+	return s;
+}
+
+int
+main (void)
+{
+	pgm_messages_init();
+	SRunner* sr = srunner_create (make_master_suite ());
+	srunner_add_suite (sr, make_test_suite ());
+	srunner_run_all (sr, CK_ENV);
+	int number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	pgm_messages_shutdown();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof */
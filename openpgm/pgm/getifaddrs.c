@@ -49,6 +49,14 @@
 #	include <ws2tcpip.h>
 #	include <iphlpapi.h>		/* must be after Winsock2.h on early SDKs */
 #endif
+#if defined( __linux__ )
+#	include <linux/netlink.h>
+#	include <linux/rtnetlink.h>
+#	define PGM_HAVE_IFCACHE	1
+#elif defined( __FreeBSD__ ) || defined( __NetBSD__ ) || defined( __OpenBSD__ ) || defined( __APPLE__ )
+#	include <net/route.h>
+#	define PGM_HAVE_IFCACHE	1
+#endif
 #include <impl/i18n.h>
 #include <impl/framework.h>
 
@@ -64,6 +72,17 @@ struct _pgm_ifaddrs_t
 	struct sockaddr_storage		_netmask;
 };
 
+#ifdef PGM_HAVE_IFCACHE
+/* process-wide interface table, dropped when the kernel announces a link or
+ * address change.
+ */
+static volatile uint32_t	ifcache_ref_count = 0;
+static pgm_mutex_t		ifcache_mutex;
+static SOCKET			ifcache_sock = INVALID_SOCKET;
+static struct pgm_ifaddrs_t*	ifcache = NULL;
+static bool			ifcache_is_valid = FALSE;
+#endif
+
 /* Number of attempts to try enumerating the interface list */
 #define MAX_TRIES		3
 #ifdef _WIN32
@@ -1047,21 +1066,144 @@ _pgm_getifaddrs (
 }
 #endif /* HAVE_GETIFADDRS */
 
-/* returns TRUE on success setting ifap to a linked list of system interfaces,
- * returns FALSE on failure and sets error appropriately.
+#ifdef PGM_HAVE_IFCACHE
+/* open a non-blocking socket subscribed to interface change notifications.
+ */
+
+static
+SOCKET
+ifcache_open (void)
+{
+#	if defined( __linux__ )
+	const SOCKET s = socket (AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+	if (INVALID_SOCKET == s)
+		return INVALID_SOCKET;
+	struct sockaddr_nl snl;
+	memset (&snl, 0, sizeof (snl));
+	snl.nl_family = AF_NETLINK;
+	snl.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR;
+	if (SOCKET_ERROR == bind (s, (struct sockaddr*)&snl, sizeof (snl))) {
+		closesocket (s);
+		return INVALID_SOCKET;
+	}
+#	else
+/* routing socket, route changes are not filtered and also drop the table */
+	const SOCKET s = socket (PF_ROUTE, SOCK_RAW, AF_UNSPEC);
+	if (INVALID_SOCKET == s)
+		return INVALID_SOCKET;
+#	endif
+	pgm_sockaddr_nonblocking (s, TRUE);
+	return s;
+}
+
+/* drain pending notifications, returns TRUE if any arrived or some were lost.
  */
 
+static
 bool
-pgm_getifaddrs (
+ifcache_is_changed (void)
+{
+	char buf[4096];
+	bool is_changed = FALSE;
+	for (;;) {
+		const ssize_t len = recv (ifcache_sock, buf, sizeof (buf), 0);
+		if (len > 0) {
+			is_changed = TRUE;
+			continue;
+		}
+		if (len < 0 && PGM_SOCK_EINTR == pgm_get_last_sock_error())
+			continue;
+/* overrun of the socket receive buffer */
+		if (len < 0 && PGM_SOCK_ENOBUFS == pgm_get_last_sock_error())
+			is_changed = TRUE;
+		return is_changed;
+	}
+}
+
+/* copy of the cached table as one allocation, as returned by the system
+ * enumeration.
+ */
+
+static
+struct pgm_ifaddrs_t*
+ifcache_dup (void)
+{
+	size_t n = 0;
+	for (const struct pgm_ifaddrs_t* ifa = ifcache; ifa; ifa = ifa->ifa_next)
+		++n;
+	if (0 == n)
+		return NULL;
+
+	const struct _pgm_ifaddrs_t* src = (const struct _pgm_ifaddrs_t*)ifcache;
+	struct _pgm_ifaddrs_t* ifa = pgm_new (struct _pgm_ifaddrs_t, n);
+	memcpy (ifa, src, n * sizeof (struct _pgm_ifaddrs_t));
+	for (size_t i = 0; i < n; i++) {
+		if (NULL != src[i]._ifa.ifa_name)	ifa[i]._ifa.ifa_name	= ifa[i]._name;
+		if (NULL != src[i]._ifa.ifa_addr)	ifa[i]._ifa.ifa_addr	= (void*)&ifa[i]._addr;
+		if (NULL != src[i]._ifa.ifa_netmask)	ifa[i]._ifa.ifa_netmask	= (void*)&ifa[i]._netmask;
+		ifa[i]._ifa.ifa_next = (i + 1 < n) ? (struct pgm_ifaddrs_t*)&ifa[i + 1] : NULL;
+	}
+	return (struct pgm_ifaddrs_t*)ifa;
+}
+
+/* enable the interface table cache, without a notification socket every
+ * call enumerates the system.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_ifaddrs_init (void)
+{
+	if (pgm_atomic_exchange_and_add32 (&ifcache_ref_count, 1) > 0)
+		return;
+
+	pgm_mutex_init (&ifcache_mutex);
+	ifcache_sock = ifcache_open ();
+	if (INVALID_SOCKET == ifcache_sock)
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Interface change notifications unavailable, interface table not cached."));
+}
+
+PGM_GNUC_INTERNAL
+void
+pgm_ifaddrs_shutdown (void)
+{
+	pgm_return_if_fail (pgm_atomic_read32 (&ifcache_ref_count) > 0);
+
+	if (pgm_atomic_exchange_and_add32 (&ifcache_ref_count, (uint32_t)-1) != 1)
+		return;
+
+	if (INVALID_SOCKET != ifcache_sock) {
+		closesocket (ifcache_sock);
+		ifcache_sock = INVALID_SOCKET;
+	}
+	if (NULL != ifcache) {
+		pgm_free (ifcache);
+		ifcache = NULL;
+	}
+	ifcache_is_valid = FALSE;
+	pgm_mutex_free (&ifcache_mutex);
+}
+#else
+PGM_GNUC_INTERNAL
+void
+pgm_ifaddrs_init (void)
+{
+}
+
+PGM_GNUC_INTERNAL
+void
+pgm_ifaddrs_shutdown (void)
+{
+}
+#endif /* PGM_HAVE_IFCACHE */
+
+static
+bool
+_pgm_enumifaddrs (
 	struct pgm_ifaddrs_t** restrict ifap,
 	pgm_error_t**	       restrict error
 	)
 {
-	pgm_assert (NULL != ifap);
-
-	pgm_debug ("pgm_getifaddrs (ifap:%p error:%p)",
-		(void*)ifap, (void*)error);
-
 #if defined( HAVE_GETIFADDRS )
 	return _pgm_getifaddrs (ifap, error);
 #elif defined( _WIN32 )
@@ -1075,6 +1217,52 @@ pgm_getifaddrs (
 #endif /* !HAVE_GETIFADDRS */
 }
 
+/* returns TRUE on success setting ifap to a linked list of system interfaces,
+ * returns FALSE on failure and sets error appropriately.
+ *
+ * after pgm_init() the list is copied from a process-wide table refreshed on
+ * kernel link and address change notifications.
+ */
+
+bool
+pgm_getifaddrs (
+	struct pgm_ifaddrs_t** restrict ifap,
+	pgm_error_t**	       restrict error
+	)
+{
+	pgm_assert (NULL != ifap);
+
+	pgm_debug ("pgm_getifaddrs (ifap:%p error:%p)",
+		(void*)ifap, (void*)error);
+
+#ifdef PGM_HAVE_IFCACHE
+	if (pgm_atomic_read32 (&ifcache_ref_count) > 0 && INVALID_SOCKET != ifcache_sock)
+	{
+		pgm_mutex_lock (&ifcache_mutex);
+		if (ifcache_is_changed() && ifcache_is_valid) {
+			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Interface change notified, refreshing interface table."));
+			if (NULL != ifcache)
+				pgm_free (ifcache);
+			ifcache = NULL;
+			ifcache_is_valid = FALSE;
+		}
+		if (!ifcache_is_valid) {
+/* subscribed before enumerating so no change is missed */
+			if (!_pgm_enumifaddrs (&ifcache, error)) {
+				ifcache = NULL;
+				pgm_mutex_unlock (&ifcache_mutex);
+				return FALSE;
+			}
+			ifcache_is_valid = TRUE;
+		}
+		*ifap = ifcache_dup ();
+		pgm_mutex_unlock (&ifcache_mutex);
+		return TRUE;
+	}
+#endif
+	return _pgm_enumifaddrs (ifap, error);
+}
+
 void
 pgm_freeifaddrs (
 	struct pgm_ifaddrs_t*	ifa
@@ -199,6 +199,35 @@ START_TEST (test_getifaddrs_pass_001)
 }
 END_TEST
 
+/* cached table matches the system enumeration */
+START_TEST (test_getifaddrs_pass_002)
+{
+	struct pgm_ifaddrs_t *ifap = NULL, *ifap2 = NULL, *ifa, *ifa2;
+	pgm_error_t* err = NULL;
+	fail_unless (TRUE == pgm_getifaddrs (&ifap, &err), "getifaddrs failed");
+	pgm_ifaddrs_init ();
+	fail_unless (TRUE == pgm_getifaddrs (&ifap2, &err), "getifaddrs failed");
+	pgm_freeifaddrs (ifap2);
+	fail_unless (TRUE == pgm_getifaddrs (&ifap2, &err), "getifaddrs failed");
+	for (ifa = ifap, ifa2 = ifap2; ifa && ifa2; ifa = ifa->ifa_next, ifa2 = ifa2->ifa_next)
+	{
+		fail_unless (ifa != ifa2, "shared entry");
+		fail_unless (ifa->ifa_flags == ifa2->ifa_flags, "flags mismatch");
+		if (NULL == ifa->ifa_addr) {
+			fail_unless (NULL == ifa2->ifa_addr, "address mismatch");
+			continue;
+		}
+		fail_unless (0 == strcmp (ifa->ifa_name, ifa2->ifa_name), "name mismatch");
+		fail_unless (0 == pgm_sockaddr_cmp (ifa->ifa_addr, ifa2->ifa_addr), "address mismatch");
+		fail_unless (0 == pgm_sockaddr_cmp (ifa->ifa_netmask, ifa2->ifa_netmask), "netmask mismatch");
+	}
+	fail_unless (NULL == ifa && NULL == ifa2, "length mismatch");
+	pgm_freeifaddrs (ifap2);
+	pgm_ifaddrs_shutdown ();
+	pgm_freeifaddrs (ifap);
+}
+END_TEST
+
 START_TEST (test_getifaddrs_fail_001)
 {
 	fail_unless (FALSE == pgm_getifaddrs (NULL, NULL), "getifaddrs failed");
@@ -241,6 +270,7 @@ make_test_suite (void)
 	TCase* tc_getifaddrs = tcase_create ("getifaddrs");
 	suite_add_tcase (s, tc_getifaddrs);
 	tcase_add_test (tc_getifaddrs, test_getifaddrs_pass_001);
+	tcase_add_test (tc_getifaddrs, test_getifaddrs_pass_002);
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_getifaddrs, test_getifaddrs_fail_001, SIGABRT);
 #endif
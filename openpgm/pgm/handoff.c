@@ -0,0 +1,268 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * Lock-free handoff of complete APDUs from the timer thread to application
+ * threads.  The timer thread publishes each APDU as a descriptor holding a
+ * reference on its skbuffs, consumers take descriptors from any thread and
+ * give them back through a matching release ring that the timer thread
+ * drains into the pools on its next pass.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <impl/i18n.h>
+#include <impl/framework.h>
+
+
+//#define HANDOFF_DEBUG
+
+#ifndef HANDOFF_DEBUG
+#	define PGM_DISABLE_ASSERT
+#endif
+
+/* each slot counts the laps of the cursors: a slot at position pos is free for
+ * enqueue when its sequence is pos and holds data for dequeue when it is pos + 1.
+ * either end claims a position with a compare-and-exchange on its cursor, so
+ * both rings serve one or many threads at each end without a lock.
+ */
+
+static
+void
+handoff_queue_init (
+	struct pgm_handoff_queue_t*	queue,
+	const unsigned			len
+	)
+{
+	queue->slots = pgm_new0 (struct pgm_handoff_slot_t, len);
+	queue->mask = len - 1;
+	for (unsigned i = 0; i < len; i++)
+		queue->slots[i].sequence = i;
+	queue->enqueue_pos = queue->dequeue_pos = 0;
+}
+
+static
+bool
+handoff_enqueue (
+	struct pgm_handoff_queue_t*	 const restrict	queue,
+	const struct pgm_msgv_t*	 const restrict	msgv,
+	const pgm_tsi_t*		 const restrict	tsi
+	)
+{
+	struct pgm_handoff_slot_t* slot;
+	for (;;)
+	{
+		const uint32_t pos = pgm_atomic_read32 (&queue->enqueue_pos);
+		slot = &queue->slots[ pos & queue->mask ];
+		const int32_t dif = (int32_t)(pgm_atomic_read32 (&slot->sequence) - pos);
+		if (0 == dif) {
+			if (pgm_atomic_compare_and_exchange32 (&queue->enqueue_pos, pos + 1, pos))
+				break;
+		} else if (dif < 0)
+			return FALSE;
+/* position taken by another thread */
+	}
+	if (NULL != tsi)
+		slot->tsi = *tsi;
+	slot->msgv.msgv_len = msgv->msgv_len;
+	memcpy (slot->msgv.msgv_skb, msgv->msgv_skb, msgv->msgv_len * sizeof (struct pgm_sk_buff_t*));
+/* publish to dequeue */
+	pgm_atomic_inc32 (&slot->sequence);
+	return TRUE;
+}
+
+static
+bool
+handoff_dequeue (
+	struct pgm_handoff_queue_t*	const restrict	queue,
+	struct pgm_msgv_t*		const restrict	msgv,
+	pgm_tsi_t*			const restrict	tsi
+	)
+{
+	struct pgm_handoff_slot_t* slot;
+	for (;;)
+	{
+		const uint32_t pos = pgm_atomic_read32 (&queue->dequeue_pos);
+		slot = &queue->slots[ pos & queue->mask ];
+		const int32_t dif = (int32_t)(pgm_atomic_read32 (&slot->sequence) - (pos + 1));
+		if (0 == dif) {
+			if (pgm_atomic_compare_and_exchange32 (&queue->dequeue_pos, pos + 1, pos))
+				break;
+		} else if (dif < 0)
+			return FALSE;
+	}
+	if (NULL != tsi)
+		*tsi = slot->tsi;
+	msgv->msgv_len = slot->msgv.msgv_len;
+	memcpy (msgv->msgv_skb, slot->msgv.msgv_skb, slot->msgv.msgv_len * sizeof (struct pgm_sk_buff_t*));
+/* free the slot for the next lap, pos + 1 + mask = pos + len */
+	pgm_atomic_add32 (&slot->sequence, queue->mask);
+	return TRUE;
+}
+
+/* drop the ring references of every descriptor still queued, returning
+ * skbuffs that have no other user to their pools in one release.
+ */
+
+static
+void
+handoff_queue_drain (
+	struct pgm_handoff_queue_t*	queue
+	)
+{
+	struct pgm_sk_buff_t* released = NULL;
+	struct pgm_msgv_t msgv;
+	while (handoff_dequeue (queue, &msgv, NULL))
+		for (unsigned i = 0; i < msgv.msgv_len; i++)
+			pgm_free_skb_deferred (msgv.msgv_skb[i], &released);
+	pgm_skb_pool_release_list (released);
+}
+
+/* create a handoff of len slots each way, a power of two of at least two as one
+ * slot cannot tell a free lap from a full one.
+ */
+
+PGM_GNUC_INTERNAL
+struct pgm_handoff_t*
+pgm_handoff_new (
+	const unsigned		len
+	)
+{
+/* pre-conditions */
+	pgm_assert (len > 1);
+	pgm_assert (len <= PGM_HANDOFF_MAX_SLOTS);
+	pgm_assert (0 == (len & (len - 1)));
+
+	struct pgm_handoff_t* handoff = pgm_new0 (struct pgm_handoff_t, 1);
+	handoff_queue_init (&handoff->delivery, len);
+	handoff_queue_init (&handoff->release, len);
+	return handoff;
+}
+
+/* destroy after the timer thread has stopped and consumers have returned,
+ * references on undelivered and unreclaimed skbuffs are dropped.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_handoff_destroy (
+	struct pgm_handoff_t*	handoff
+	)
+{
+	pgm_assert (NULL != handoff);
+
+	handoff_queue_drain (&handoff->delivery);
+	handoff_queue_drain (&handoff->release);
+	pgm_free (handoff->delivery.slots);
+	pgm_free (handoff->release.slots);
+	pgm_free (handoff);
+}
+
+/* returns slots the single publishing thread may fill.  a slot just taken may
+ * still be copied out by its consumer, pgm_handoff_publish() waits for it.
+ */
+
+PGM_GNUC_INTERNAL
+unsigned
+pgm_handoff_space (
+	const struct pgm_handoff_t*	handoff
+	)
+{
+	pgm_assert (NULL != handoff);
+
+	const uint32_t used = pgm_atomic_read32 (&handoff->delivery.enqueue_pos) - pgm_atomic_read32 (&handoff->delivery.dequeue_pos);
+	return handoff->delivery.mask + 1 - used;
+}
+
+/* publish one APDU taking a reference on each skbuff, or with an empty msgv the
+ * loss of tsi.  caller is the single publishing thread and has checked space.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_handoff_publish (
+	struct pgm_handoff_t*	 const restrict	handoff,
+	const struct pgm_msgv_t* const restrict	msgv,
+	const pgm_tsi_t*	 const restrict	tsi
+	)
+{
+	pgm_assert (NULL != handoff);
+	pgm_assert (NULL != msgv);
+	pgm_assert (msgv->msgv_len > 0 || NULL != tsi);
+
+	pgm_msgv_borrow (msgv);
+	while (!handoff_enqueue (&handoff->delivery, msgv, tsi))
+		pgm_thread_yield();
+}
+
+/* take one descriptor from any thread, an empty msgv is the loss of tsi.
+ *
+ * returns TRUE on success, FALSE if the ring is empty.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_handoff_take (
+	struct pgm_handoff_t*	const restrict	handoff,
+	struct pgm_msgv_t*	const restrict	msgv,
+	pgm_tsi_t*		const restrict	tsi
+	)
+{
+	pgm_assert (NULL != handoff);
+	pgm_assert (NULL != msgv);
+
+	return handoff_dequeue (&handoff->delivery, msgv, tsi);
+}
+
+/* give a taken descriptor back from any thread for the next reclaim.
+ *
+ * returns TRUE on success, FALSE if the release ring is full and the caller
+ * must release the skbuffs itself.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_handoff_give (
+	struct pgm_handoff_t*	 const restrict	handoff,
+	const struct pgm_msgv_t* const restrict	msgv
+	)
+{
+	pgm_assert (NULL != handoff);
+	pgm_assert (NULL != msgv);
+
+	if (0 == msgv->msgv_len)
+		return TRUE;
+	return handoff_enqueue (&handoff->release, msgv, NULL);
+}
+
+/* drop the references of every given back descriptor, called by the
+ * publishing thread.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_handoff_reclaim (
+	struct pgm_handoff_t*	handoff
+	)
+{
+	pgm_assert (NULL != handoff);
+
+	handoff_queue_drain (&handoff->release);
+}
+
+/* eof */
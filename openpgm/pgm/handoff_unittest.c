@@ -0,0 +1,195 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * unit tests for the APDU handoff ring.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <check.h>
+
+#define HANDOFF_DEBUG
+#include "handoff.c"
+
+#ifdef _WIN32
+#	define PGM_CHECK_NOFORK		1
+#endif
+
+
+static
+void
+make_msgv (
+	struct pgm_msgv_t*	msgv,
+	const unsigned		len
+	)
+{
+	msgv->msgv_len = len;
+	for (unsigned i = 0; i < len; i++)
+		msgv->msgv_skb[i] = pgm_alloc_skb (64);
+}
+
+/* target:
+ *	void
+ *	pgm_handoff_publish (
+ *		struct pgm_handoff_t*		handoff,
+ *		const struct pgm_msgv_t*	msgv,
+ *		const pgm_tsi_t*		tsi
+ *	)
+ *
+ *	bool
+ *	pgm_handoff_take (
+ *		struct pgm_handoff_t*		handoff,
+ *		struct pgm_msgv_t*		msgv,
+ *		pgm_tsi_t*			tsi
+ *	)
+ */
+
+/* in order, each skbuff referenced by the ring */
+START_TEST (test_publish_pass_001)
+{
+	struct pgm_handoff_t* handoff = pgm_handoff_new (4);
+	struct pgm_msgv_t msgv[3], taken;
+	pgm_tsi_t tsi;
+	make_msgv (&msgv[0], 1);
+	make_msgv (&msgv[1], 2);
+	make_msgv (&msgv[2], 1);
+	fail_unless (4 == pgm_handoff_space (handoff), "space mismatch");
+	for (unsigned i = 0; i < 3; i++)
+		pgm_handoff_publish (handoff, &msgv[i], NULL);
+	fail_unless (1 == pgm_handoff_space (handoff), "space mismatch");
+	fail_unless (2 == pgm_atomic_read32 (&msgv[1].msgv_skb[1]->users), "reference not taken");
+	for (unsigned i = 0; i < 3; i++) {
+		fail_unless (TRUE == pgm_handoff_take (handoff, &taken, &tsi), "take failed");
+		fail_unless (msgv[i].msgv_len == taken.msgv_len, "length mismatch");
+		fail_unless (msgv[i].msgv_skb[0] == taken.msgv_skb[0], "order mismatch");
+	}
+	fail_unless (FALSE == pgm_handoff_take (handoff, &taken, &tsi), "take succeeded");
+	fail_unless (4 == pgm_handoff_space (handoff), "space mismatch");
+	pgm_handoff_destroy (handoff);
+}
+END_TEST
+
+/* loss of a source, the slots wrap over laps */
+START_TEST (test_publish_pass_002)
+{
+	struct pgm_handoff_t* handoff = pgm_handoff_new (2);
+	const struct pgm_msgv_t loss = { .msgv_len = 0 };
+	struct pgm_msgv_t taken;
+	pgm_tsi_t tsi, expected;
+	memset (&expected, 0xa5, sizeof (expected));
+	for (unsigned lap = 0; lap < 5; lap++) {
+		expected.sport = (uint16_t)lap;
+		pgm_handoff_publish (handoff, &loss, &expected);
+		fail_unless (TRUE == pgm_handoff_take (handoff, &taken, &tsi), "take failed");
+		fail_unless (0 == taken.msgv_len, "length mismatch");
+		fail_unless (0 == memcmp (&expected, &tsi, sizeof (tsi)), "tsi mismatch");
+	}
+	pgm_handoff_destroy (handoff);
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_handoff_give (
+ *		struct pgm_handoff_t*		handoff,
+ *		const struct pgm_msgv_t*	msgv
+ *	)
+ *
+ *	void
+ *	pgm_handoff_reclaim (
+ *		struct pgm_handoff_t*		handoff
+ *	)
+ */
+
+START_TEST (test_give_pass_001)
+{
+	struct pgm_handoff_t* handoff = pgm_handoff_new (2);
+	struct pgm_msgv_t msgv, taken;
+	make_msgv (&msgv, 2);
+	pgm_skb_get (msgv.msgv_skb[0]);
+	pgm_handoff_publish (handoff, &msgv, NULL);
+	fail_unless (TRUE == pgm_handoff_take (handoff, &taken, NULL), "take failed");
+	fail_unless (TRUE == pgm_handoff_give (handoff, &taken), "give failed");
+	fail_unless (3 == pgm_atomic_read32 (&msgv.msgv_skb[0]->users), "reference dropped early");
+	pgm_handoff_reclaim (handoff);
+	fail_unless (2 == pgm_atomic_read32 (&msgv.msgv_skb[0]->users), "reference not dropped");
+	fail_unless (1 == pgm_atomic_read32 (&msgv.msgv_skb[1]->users), "reference not dropped");
+	pgm_handoff_destroy (handoff);
+}
+END_TEST
+
+/* full release ring leaves the skbuffs to the caller */
+START_TEST (test_give_fail_001)
+{
+	struct pgm_handoff_t* handoff = pgm_handoff_new (2);
+	struct pgm_msgv_t msgv;
+	make_msgv (&msgv, 1);
+	pgm_skb_get (msgv.msgv_skb[0]);
+	fail_unless (TRUE == pgm_handoff_give (handoff, &msgv), "give failed");
+	fail_unless (TRUE == pgm_handoff_give (handoff, &msgv), "give failed");
+	fail_unless (FALSE == pgm_handoff_give (handoff, &msgv), "give succeeded");
+	pgm_handoff_destroy (handoff);
+}
+END_TEST
+
+
+static
+Suite*
+make_test_suite (void)
+{
+	Suite* s;
+
+	s = suite_create (__FILE__);
+
+	TCase* tc_publish = tcase_create ("publish");
+	suite_add_tcase (s, tc_publish);
+	tcase_add_test (tc_publish, test_publish_pass_001);
+	tcase_add_test (tc_publish, test_publish_pass_002);
+
+	TCase* tc_give = tcase_create ("give");
+	suite_add_tcase (s, tc_give);
+	tcase_add_test (tc_give, test_give_pass_001);
+	tcase_add_test (tc_give, test_give_fail_001);
+	return s;
+}
+
+static
+Suite*
+make_master_suite (void)
+{
+	Suite* s = suite_create ("Master");
+	return s;
+}
+
+int
+main (void)
+{
+	pgm_messages_init();
+	SRunner* sr = srunner_create (make_master_suite ());
+	srunner_add_suite (sr, make_test_suite ());
+	srunner_run_all (sr, CK_ENV);
+	int number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	pgm_messages_shutdown();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -76,12 +76,12 @@ pgm_hashtable_new (
 
 	pgm_hashtable_t *hash_table;
   
-	hash_table = pgm_new (pgm_hashtable_t, 1);
+	hash_table = pgm_new_subsys (pgm_hashtable_t, 1, PGM_MEM_SUBSYS_HASHTABLE);
 	hash_table->size               = HASHTABLE_MIN_SIZE;
 	hash_table->nnodes             = 0;
 	hash_table->hash_func          = hash_func;
 	hash_table->key_equal_func     = key_equal_func;
-	hash_table->nodes              = pgm_new0 (pgm_hashnode_t*, hash_table->size);
+	hash_table->nodes              = pgm_new0_subsys (pgm_hashnode_t*, hash_table->size, PGM_MEM_SUBSYS_HASHTABLE);
   
 	return hash_table;
 }
@@ -232,7 +232,7 @@ pgm_hashtable_resize (
 {
 	const unsigned new_size = CLAMP (pgm_spaced_primes_closest (hash_table->nnodes),
 					 HASHTABLE_MIN_SIZE, HASHTABLE_MAX_SIZE);
-	pgm_hashnode_t** new_nodes = pgm_new0 (pgm_hashnode_t*, new_size);
+	pgm_hashnode_t** new_nodes = pgm_new0_subsys (pgm_hashnode_t*, new_size, PGM_MEM_SUBSYS_HASHTABLE);
   
 	for (unsigned i = 0; i < hash_table->size; i++)
 		for (pgm_hashnode_t *node = hash_table->nodes[i], *next; node; node = next)
@@ -256,7 +256,7 @@ pgm_hash_node_new (
 	const pgm_hash_t     key_hash
 	)
 {
-	pgm_hashnode_t *hash_node = pgm_new (pgm_hashnode_t, 1);
+	pgm_hashnode_t *hash_node = pgm_new_subsys (pgm_hashnode_t, 1, PGM_MEM_SUBSYS_HASHTABLE);
 	hash_node->key = key;
 	hash_node->value = value;
 	hash_node->key_hash = key_hash;
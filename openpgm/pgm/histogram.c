@@ -34,200 +34,315 @@
 
 pgm_slist_t* pgm_histograms = NULL;
 
-
-static void sample_set_accumulate (pgm_sample_set_t*, pgm_sample_t, pgm_count_t, unsigned);
-static pgm_count_t sample_set_total_count (const pgm_sample_set_t*) PGM_GNUC_PURE;
-
-static void set_bucket_range (pgm_histogram_t*, unsigned, pgm_sample_t);
-static void initialize_bucket_range (pgm_histogram_t*);
-static unsigned bucket_index (const pgm_histogram_t*, const pgm_sample_t);
-static void accumulate (pgm_histogram_t*, pgm_sample_t, pgm_count_t, unsigned);
-static double get_peak_bucket_size (const pgm_histogram_t*restrict, const pgm_sample_set_t*restrict);
-static double get_bucket_size (const pgm_histogram_t*, const pgm_count_t, const unsigned);
+/* serialises registration, the list is only ever pushed at the head */
+pgm_spinlock_t pgm_histograms_lock;
+
+struct histogram_snapshot_t {
+	uint64_t	counts[ PGM_HISTOGRAM_BUCKETS ];
+	uint64_t	count;
+	uint64_t	sum;
+	uint64_t	max;
+};
+
+typedef struct histogram_snapshot_t histogram_snapshot_t;
+
+static unsigned bucket_index (const uint64_t) PGM_GNUC_CONST;
+static uint64_t bucket_lowest (const unsigned) PGM_GNUC_CONST;
+static uint64_t bucket_width (const unsigned) PGM_GNUC_CONST;
+static unsigned shard_index (void);
+static void atomic_add64 (volatile uint64_t*, const uint64_t);
+static void atomic_max64 (volatile uint64_t*, const uint64_t);
+static pgm_slist_t* histograms_head (void);
+static void take_snapshot (const pgm_histogram_t*restrict, histogram_snapshot_t*restrict);
+static uint64_t snapshot_percentile (const histogram_snapshot_t*, const unsigned);
+static void snapshot_summary (const histogram_snapshot_t*restrict, pgm_histogram_summary_t*restrict);
+static double get_peak_bucket_size (const histogram_snapshot_t*);
+static double get_bucket_size (const uint64_t, const unsigned);
 
 static void pgm_histogram_write_html_graph (pgm_histogram_t*restrict, pgm_string_t*restrict);
 static void write_ascii (pgm_histogram_t*restrict, const char*restrict, pgm_string_t*restrict);
-static void write_ascii_header (pgm_histogram_t*restrict, pgm_sample_set_t*restrict, pgm_count_t, pgm_string_t*restrict);
+static void write_ascii_header (pgm_histogram_t*restrict, histogram_snapshot_t*restrict, pgm_string_t*restrict);
 static void write_ascii_bucket_graph (double, double, pgm_string_t*);
-static void write_ascii_bucket_context (int64_t, pgm_count_t, int64_t, unsigned, pgm_string_t*);
-static void write_ascii_bucket_value (pgm_count_t, double, pgm_string_t*);
-static pgm_string_t* get_ascii_bucket_range (pgm_histogram_t*, unsigned);
+static void write_ascii_bucket_context (uint64_t, uint64_t, uint64_t, unsigned, pgm_string_t*);
+static void write_ascii_bucket_value (uint64_t, double, pgm_string_t*);
+static pgm_string_t* get_ascii_bucket_range (unsigned);
 
 
-void
-pgm_histogram_add (
-	pgm_histogram_t*	histogram,
-	int			value
+static inline
+unsigned
+msb64 (
+	const uint64_t		word
 	)
 {
-	if (value > INT_MAX)
-		value = INT_MAX - 1;
-	if (value < 0)
-		value = 0;
-	const unsigned i = bucket_index (histogram, value);
-	pgm_assert_cmpint (value, >=, histogram->ranges[ i ]);
-	pgm_assert_cmpint (value,  <, histogram->ranges[ i + 1 ]);
-	accumulate (histogram, value, 1, i);
+#if (__GNUC__ > 3) || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4)
+	return 63U - (unsigned)__builtin_clzll (word);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanReverse64 (&index, word);
+	return (unsigned)index;
+#else
+	unsigned i = 63;
+	while (0 == (word & (UINT64_C(1) << i)))
+		i--;
+	return i;
+#endif
 }
 
-void
-pgm_histogram_write_html_graph_all (
-	pgm_string_t*		string
+/* values below the sub-bucket count index directly, above that the exponent
+ * selects a run of half as many linear buckets, e.g. with 64 sub-buckets
+ * 64..127 are in steps of 2, 128..255 in steps of 4.
+ */
+
+static
+unsigned
+bucket_index (
+	const uint64_t		value
 	)
 {
-	if (!pgm_histograms)
-		return;
-	pgm_slist_t* snapshot = pgm_histograms;
-	while (snapshot) {
-		pgm_histogram_t* histogram = snapshot->data;
-		pgm_histogram_write_html_graph (histogram, string);
-		snapshot = snapshot->next;
-	}
+	if (value < PGM_HISTOGRAM_SUB_BUCKETS)
+		return (unsigned)value;
+	const unsigned exponent = msb64 (value) - (PGM_HISTOGRAM_SUB_BUCKET_BITS - 1);
+	return (exponent * (PGM_HISTOGRAM_SUB_BUCKETS / 2)) + (unsigned)(value >> exponent);
 }
 
 static
-void
-pgm_histogram_write_html_graph (
-	pgm_histogram_t* restrict histogram,
-	pgm_string_t*	 restrict string
+uint64_t
+bucket_lowest (
+	const unsigned		i
 	)
 {
-	pgm_string_append (string, "<PRE>");
-	write_ascii (histogram, "<BR/>", string);
-	pgm_string_append (string, "</PRE>");
+	if (i < PGM_HISTOGRAM_SUB_BUCKETS)
+		return i;
+	const unsigned exponent = (i / (PGM_HISTOGRAM_SUB_BUCKETS / 2)) - 1;
+	const uint64_t mantissa = i - (exponent * (PGM_HISTOGRAM_SUB_BUCKETS / 2));
+	return mantissa << exponent;
+}
+
+static
+uint64_t
+bucket_width (
+	const unsigned		i
+	)
+{
+	if (i < PGM_HISTOGRAM_SUB_BUCKETS)
+		return 1;
+	const unsigned exponent = (i / (PGM_HISTOGRAM_SUB_BUCKETS / 2)) - 1;
+	return UINT64_C(1) << exponent;
+}
+
+/* no thread-local storage, threads hash by identifier: Fibonacci hashing
+ * takes the high bits as thread descriptors are page aligned.  Threads that
+ * collide share a shard and only contend on the cache lines.
+ */
+
+static
+unsigned
+shard_index (void)
+{
+#ifndef _WIN32
+	const uint64_t id = (uint64_t)(uintptr_t)pthread_self();
+#else
+	const uint64_t id = GetCurrentThreadId();
+#endif
+	return (unsigned)((id * UINT64_C(0x9e3779b97f4a7c15)) >> (64 - PGM_HISTOGRAM_SHARD_BITS));
 }
 
 static
 void
-sample_set_accumulate (
-	pgm_sample_set_t*	sample_set,
-	pgm_sample_t		value,
-	pgm_count_t		count,
-	unsigned		i
+atomic_add64 (
+	volatile uint64_t*	atomic,
+	const uint64_t		val
 	)
 {
-	pgm_assert (1 == count || -1 == count);
-	sample_set->counts[ i ] += count;
-	sample_set->sum += count * value;
-	sample_set->square_sum += (count * value) * (int64_t)value;
-	pgm_assert_cmpint (sample_set->counts[ i ], >=, 0);
-	pgm_assert_cmpint (sample_set->sum, >=, 0);
-	pgm_assert_cmpint (sample_set->square_sum, >=, 0);
+	uint64_t oldval;
+	do {
+		oldval = pgm_atomic_read64 (atomic);
+	} while (!pgm_atomic_compare_and_exchange64 (atomic, oldval + val, oldval));
 }
 
 static
-pgm_count_t
-sample_set_total_count (
-	const pgm_sample_set_t*	sample_set
+void
+atomic_max64 (
+	volatile uint64_t*	atomic,
+	const uint64_t		val
 	)
 {
-	pgm_count_t total = 0;
-	for (unsigned i = 0; i < sample_set->counts_len; i++)
-		total += sample_set->counts[ i ];
-	return total;
+	uint64_t oldval;
+	do {
+		oldval = pgm_atomic_read64 (atomic);
+		if (oldval >= val)
+			return;
+	} while (!pgm_atomic_compare_and_exchange64 (atomic, val, oldval));
 }
 
+void
+pgm_histogram_add (
+	pgm_histogram_t*	histogram,
+	uint64_t		value
+	)
+{
+	if (PGM_UNLIKELY(PGM_HISTOGRAM_REGISTERED != pgm_atomic_read32 (&histogram->state))) {
+		pgm_histogram_init (histogram);
+/* another thread is initializing, drop the sample */
+		if (PGM_HISTOGRAM_REGISTERED != pgm_atomic_read32 (&histogram->state))
+			return;
+	}
+	if (value >= (UINT64_C(1) << PGM_HISTOGRAM_VALUE_BITS))
+		value = (UINT64_C(1) << PGM_HISTOGRAM_VALUE_BITS) - 1;
+	const unsigned i = bucket_index (value);
+	pgm_assert_cmpuint (i, <, PGM_HISTOGRAM_BUCKETS);
+	pgm_assert_cmpuint (value, >=, bucket_lowest (i));
+	pgm_assert_cmpuint (value, <, bucket_lowest (i) + bucket_width (i));
+	pgm_histogram_shard_t* shard = &histogram->shards[ shard_index() ];
+	atomic_add64 (&shard->counts[ i ], 1);
+	atomic_add64 (&shard->sum, value);
+	atomic_max64 (&shard->max, value);
+}
+
+/* first sample allocates the shards and registers with the global list.
+ */
+
 void
 pgm_histogram_init (
 	pgm_histogram_t*	histogram
 	)
 {
-	if (histogram->declared_min <= 0)
-		histogram->declared_min = 1;
-	pgm_assert_cmpint (histogram->declared_min, >, 0);
-	histogram->declared_max = INT_MAX - 1;
-	pgm_assert_cmpint (histogram->declared_min, <=, histogram->declared_max);
-	pgm_assert_cmpuint (1, <, histogram->bucket_count);
-	set_bucket_range (histogram, histogram->bucket_count, INT_MAX);
-	initialize_bucket_range (histogram);
-
-/* register with global list */
+	if (!pgm_atomic_compare_and_exchange32 (&histogram->state, PGM_HISTOGRAM_INITIALIZING, PGM_HISTOGRAM_UNREGISTERED))
+		return;
+	histogram->shards = pgm_new0 (pgm_histogram_shard_t, PGM_HISTOGRAM_SHARDS);
 	histogram->histograms_link.data = histogram;
+	pgm_spinlock_lock (&pgm_histograms_lock);
 	histogram->histograms_link.next = pgm_histograms;
 	pgm_histograms = &histogram->histograms_link;
-	histogram->is_registered = TRUE;
+	pgm_spinlock_unlock (&pgm_histograms_lock);
+	pgm_atomic_write32 (&histogram->state, PGM_HISTOGRAM_REGISTERED);
 }
 
+static
+pgm_slist_t*
+histograms_head (void)
+{
+	pgm_spinlock_lock (&pgm_histograms_lock);
+	pgm_slist_t* head = pgm_histograms;
+	pgm_spinlock_unlock (&pgm_histograms_lock);
+	return head;
+}
+
+/* merge shards, concurrent recording can skew the totals by in-flight
+ * samples which is harmless for reporting.
+ */
+
 static
 void
-set_bucket_range (
-	pgm_histogram_t*	histogram,
-	unsigned		i,
-	pgm_sample_t		value
+take_snapshot (
+	const pgm_histogram_t* restrict histogram,
+	histogram_snapshot_t*  restrict snapshot
 	)
 {
-	histogram->ranges[ i ] = value;
+	memset (snapshot, 0, sizeof(histogram_snapshot_t));
+	for (unsigned j = 0; j < PGM_HISTOGRAM_SHARDS; j++) {
+		const pgm_histogram_shard_t* shard = &histogram->shards[ j ];
+		for (unsigned i = 0; i < PGM_HISTOGRAM_BUCKETS; i++) {
+			const uint64_t count = pgm_atomic_read64 (&shard->counts[ i ]);
+			snapshot->counts[ i ] += count;
+			snapshot->count += count;
+		}
+		snapshot->sum += pgm_atomic_read64 (&shard->sum);
+		const uint64_t max = pgm_atomic_read64 (&shard->max);
+		if (max > snapshot->max)
+			snapshot->max = max;
+	}
 }
 
+/* returns highest value of the bucket holding the rank, per-mille.
+ */
+
 static
-void
-initialize_bucket_range (
-	pgm_histogram_t*	histogram
+uint64_t
+snapshot_percentile (
+	const histogram_snapshot_t*	snapshot,
+	const unsigned			permille
 	)
 {
-	const double log_max = log ((double)histogram->declared_max);
-	double log_ratio;
-	double log_next;
-	unsigned i = 1;
-	pgm_sample_t current = histogram->declared_min;
-
-	set_bucket_range (histogram, i, current);
-	while (histogram->bucket_count > ++i) {
-		const double log_current = log ((double)current);
-		log_ratio = (log_max - log_current) / (histogram->bucket_count - i);
-		log_next = log_current + log_ratio;
-#ifdef __GNUC__	
-		const int next = floor (exp (log_next) + 0.5);
-#else
-/* bad-function-cast warning in GCC */
-		const int next = (int)(floor (exp (log_next) + 0.5));
-#endif
-		if (next > current)
-			current = next;
-		else
-			current++;
-		set_bucket_range (histogram, i, current);
+	if (0 == snapshot->count)
+		return 0;
+	uint64_t rank = (snapshot->count * permille + 999) / 1000;
+	if (0 == rank)
+		rank = 1;
+	uint64_t past = 0;
+	for (unsigned i = 0; i < PGM_HISTOGRAM_BUCKETS; i++) {
+		past += snapshot->counts[ i ];
+		if (past >= rank) {
+			const uint64_t highest = bucket_lowest (i) + bucket_width (i) - 1;
+			return highest < snapshot->max ? highest : snapshot->max;
+		}
 	}
-	pgm_assert_cmpuint (histogram->bucket_count, ==, i);
+	return snapshot->max;
 }
 
 static
-unsigned
-bucket_index (
-	const pgm_histogram_t*	histogram,
-	const pgm_sample_t	value
+void
+snapshot_summary (
+	const histogram_snapshot_t*	restrict snapshot,
+	pgm_histogram_summary_t*	restrict summary
 	)
 {
-	pgm_assert_cmpint (histogram->ranges[0], <=, value);
-	pgm_assert_cmpint (histogram->ranges[ histogram->bucket_count ], >, value);
-	unsigned under = 0;
-	unsigned over = histogram->bucket_count;
-	unsigned mid;
+	summary->count	= snapshot->count;
+	summary->p50	= snapshot_percentile (snapshot, 500);
+	summary->p99	= snapshot_percentile (snapshot, 990);
+	summary->p999	= snapshot_percentile (snapshot, 999);
+	summary->max	= snapshot->max;
+}
 
-	do {
-		pgm_assert_cmpuint (over, >=, under);
-		mid = ((unsigned)under + (unsigned)over) >> 1;
-		if (mid == under)
-			break;
-		if (histogram->ranges[ mid ] <= value)
-			under = mid;
-		else
-			over = mid;
-	} while (TRUE);
-	pgm_assert (histogram->ranges[ mid ] <= value && histogram->ranges[ mid + 1] > value);
-	return mid;
+/* summary of the named histogram, returns FALSE if nothing is recorded
+ * under that name.
+ */
+
+bool
+pgm_histogram_summary (
+	const char*		 restrict name,
+	pgm_histogram_summary_t* restrict summary
+	)
+{
+	pgm_return_val_if_fail (NULL != name, FALSE);
+	pgm_return_val_if_fail (NULL != summary, FALSE);
+
+	for (pgm_slist_t* list = histograms_head(); list; list = list->next) {
+		const pgm_histogram_t* histogram = list->data;
+		if (0 != strcmp (histogram->histogram_name, name))
+			continue;
+		histogram_snapshot_t* snapshot = pgm_new (histogram_snapshot_t, 1);
+		take_snapshot (histogram, snapshot);
+		snapshot_summary (snapshot, summary);
+		pgm_free (snapshot);
+		return TRUE;
+	}
+	return FALSE;
+}
+
+void
+pgm_histogram_write_html_graph_all (
+	pgm_string_t*		string
+	)
+{
+	pgm_slist_t* snapshot = histograms_head();
+	while (snapshot) {
+		pgm_histogram_t* histogram = snapshot->data;
+		pgm_histogram_write_html_graph (histogram, string);
+		snapshot = snapshot->next;
+	}
 }
 
 static
 void
-accumulate (
-	pgm_histogram_t*	histogram,
-	pgm_sample_t		value,
-	pgm_count_t		count,
-	unsigned		i
+pgm_histogram_write_html_graph (
+	pgm_histogram_t* restrict histogram,
+	pgm_string_t*	 restrict string
 	)
 {
-	sample_set_accumulate (&histogram->sample, value, count, i);
+	pgm_string_append (string, "<PRE>");
+	write_ascii (histogram, "<BR/>", string);
+	pgm_string_append (string, "</PRE>");
 }
 
 static
@@ -238,37 +353,29 @@ write_ascii (
 	pgm_string_t*	 restrict output
 	)
 {
-#ifndef _MSC_VER
-	pgm_count_t snapshot_counts[ histogram->sample.counts_len ];
-#else
-	pgm_count_t* snapshot_counts = pgm_newa (pgm_count_t, histogram->sample.counts_len);
-#endif
-	pgm_sample_set_t snapshot = {
-		.counts		= snapshot_counts,
-		.counts_len	= histogram->sample.counts_len,
-		.sum		= histogram->sample.sum,
-		.square_sum	= histogram->sample.square_sum
-	};
-	memcpy (snapshot_counts, histogram->sample.counts, sizeof(pgm_count_t) * histogram->sample.counts_len);
-
-	pgm_count_t sample_count = sample_set_total_count (&snapshot);
-	write_ascii_header (histogram, &snapshot, sample_count, output);
+	histogram_snapshot_t* snapshot = pgm_new (histogram_snapshot_t, 1);
+	take_snapshot (histogram, snapshot);
+
+	write_ascii_header (histogram, snapshot, output);
 	pgm_string_append (output, newline);
 
-	double max_size = get_peak_bucket_size (histogram, &snapshot);
-	unsigned largest_non_empty_bucket = histogram->bucket_count - 1;
-	while (0 == snapshot.counts[ largest_non_empty_bucket ])
-	{
-		if (0 == largest_non_empty_bucket)
-			break;
-		largest_non_empty_bucket--;
+	if (0 == snapshot->count) {
+		pgm_free (snapshot);
+		return;
 	}
 
+	const double max_size = get_peak_bucket_size (snapshot);
+	unsigned smallest_bucket = 0, largest_bucket = PGM_HISTOGRAM_BUCKETS - 1;
+	while (0 == snapshot->counts[ smallest_bucket ])
+		smallest_bucket++;
+	while (0 == snapshot->counts[ largest_bucket ])
+		largest_bucket--;
+
 	int print_width = 1;
-	for (unsigned i = 0; i < histogram->bucket_count; ++i)
+	for (unsigned i = smallest_bucket; i <= largest_bucket; ++i)
 	{
-		if (snapshot.counts[ i ]) {
-			pgm_string_t* bucket_range = get_ascii_bucket_range (histogram, i);
+		if (snapshot->counts[ i ]) {
+			pgm_string_t* bucket_range = get_ascii_bucket_range (i);
 			const int width = (int)(bucket_range->len + 1);
 			pgm_string_free (bucket_range, TRUE);
 			if (width > print_width)
@@ -276,58 +383,68 @@ write_ascii (
 		}
 	}
 
-	int64_t remaining = sample_count;
-	int64_t past = 0;
-	for (unsigned i = 0; i < histogram->bucket_count; ++i)
+	uint64_t remaining = snapshot->count;
+	uint64_t past = 0;
+	for (unsigned i = smallest_bucket; i <= largest_bucket; ++i)
 	{
-		pgm_count_t current = snapshot.counts[ i ];
+		const uint64_t current = snapshot->counts[ i ];
 		remaining -= current;
-		pgm_string_t* bucket_range = get_ascii_bucket_range (histogram, i);
+		pgm_string_t* bucket_range = get_ascii_bucket_range (i);
 		pgm_string_append_printf (output, "%*s ", print_width, bucket_range->str);
 		pgm_string_free (bucket_range, TRUE);
 		if (0 == current &&
-		    i < histogram->bucket_count - 1 &&
-		    0 == snapshot.counts[ i + 1 ])
+		    0 == snapshot->counts[ i + 1 ])
 		{
-			while (i < histogram->bucket_count - 1 &&
-			       0 == snapshot.counts[ i + 1 ])
-			{
+			while (0 == snapshot->counts[ i + 1 ])
 				i++;
-			}
 			pgm_string_append (output, "... ");
 			pgm_string_append (output, newline);
 			continue;
 		}
 
-		const double current_size = get_bucket_size (histogram, current, i);
+		const double current_size = get_bucket_size (current, i);
 		write_ascii_bucket_graph (current_size, max_size, output);
 		write_ascii_bucket_context (past, current, remaining, i, output);
 		pgm_string_append (output, newline);
 		past += current;
 	}
+	pgm_free (snapshot);
 }
 
+/* standard deviation is estimated from bucket midpoints.
+ */
+
 static
 void
 write_ascii_header (
-	pgm_histogram_t*  restrict histogram,
-	pgm_sample_set_t* restrict sample_set,
-	pgm_count_t		   sample_count,
-	pgm_string_t*	  restrict output
+	pgm_histogram_t*      restrict histogram,
+	histogram_snapshot_t* restrict snapshot,
+	pgm_string_t*	      restrict output
 	)
 {
 	pgm_string_append_printf (output,
-				 "Histogram: %s recorded %d samples",
+				 "Histogram: %s recorded %" PRIu64 " samples",
 				 histogram->histogram_name ? histogram->histogram_name : "(null)",
-				 sample_count);
-	if (sample_count > 0) {
-		const double average  = (float)(sample_set->sum) / sample_count;
-		const double variance = (float)(sample_set->square_sum) / sample_count
-						- average * average;
+				 snapshot->count);
+	if (snapshot->count > 0) {
+		const double average = (double)snapshot->sum / (double)snapshot->count;
+		double variance = 0.0;
+		for (unsigned i = 0; i < PGM_HISTOGRAM_BUCKETS; i++) {
+			if (0 == snapshot->counts[ i ])
+				continue;
+			const uint64_t lowest = bucket_lowest (i), width = bucket_width (i);
+			const double midpoint = (double)lowest + ((double)width - 1.0) / 2.0;
+			variance += (double)snapshot->counts[ i ] * (midpoint - average) * (midpoint - average);
+		}
+		variance /= (double)snapshot->count;
 		const double standard_deviation = sqrt (variance);
+		pgm_histogram_summary_t summary;
+		snapshot_summary (snapshot, &summary);
 		pgm_string_append_printf (output,
-					 ", average = %.1f, standard deviation = %.1f",
-					 average, standard_deviation);
+					 ", average = %.1f, standard deviation = %.1f"
+					 ", p50 = %" PRIu64 ", p99 = %" PRIu64 ", p99.9 = %" PRIu64 ", max = %" PRIu64,
+					 average, standard_deviation,
+					 summary.p50, summary.p99, summary.p999, summary.max);
 	}
 }
 
@@ -352,17 +469,17 @@ write_ascii_bucket_graph (
 static
 void
 write_ascii_bucket_context (
-	int64_t			past,
-	pgm_count_t		current,
-	int64_t			remaining,
+	uint64_t		past,
+	uint64_t		current,
+	uint64_t		remaining,
 	unsigned		i,
 	pgm_string_t*		output
 	)
 {
-	const double scaled_sum = (past + current + remaining) / 100.0;
+	const double scaled_sum = (double)(past + current + remaining) / 100.0;
 	write_ascii_bucket_value (current, scaled_sum, output);
 	if (0 < i) {
-		const double percentage = past / scaled_sum;
+		const double percentage = (double)past / scaled_sum;
 		pgm_string_append_printf (output, " {%3.1f%%}", percentage);
 	}
 }
@@ -370,24 +487,23 @@ write_ascii_bucket_context (
 static
 void
 write_ascii_bucket_value (
-	pgm_count_t		current,
+	uint64_t		current,
 	double			scaled_sum,
 	pgm_string_t*		output
 	)
 {
-	pgm_string_append_printf (output, " (%d = %3.1f%%)", current, current/scaled_sum);
+	pgm_string_append_printf (output, " (%" PRIu64 " = %3.1f%%)", current, (double)current / scaled_sum);
 }
 
 static
 double
 get_peak_bucket_size (
-	const pgm_histogram_t*	restrict histogram,
-	const pgm_sample_set_t* restrict sample_set
+	const histogram_snapshot_t*	snapshot
 	)
 {
 	double max_size = 0;
-	for (unsigned i = 0; i < histogram->bucket_count; i++) {
-		const double current_size = get_bucket_size (histogram, sample_set->counts[ i ], i);
+	for (unsigned i = 0; i < PGM_HISTOGRAM_BUCKETS; i++) {
+		const double current_size = get_bucket_size (snapshot->counts[ i ], i);
 		if (current_size > max_size)
 			max_size = current_size;
 	}
@@ -397,28 +513,26 @@ get_peak_bucket_size (
 static
 double
 get_bucket_size (
-	const pgm_histogram_t*	histogram,
-	const pgm_count_t	current,
+	const uint64_t		current,
 	const unsigned		i
 	)
 {
-	pgm_assert_cmpint (histogram->ranges[ i + 1 ], >, histogram->ranges[ i ]);
 	static const double kTransitionWidth = 5;
-	double denominator = histogram->ranges[ i + 1 ] - histogram->ranges[ i ];
+	const uint64_t width = bucket_width (i);
+	double denominator = (double)width;
 	if (denominator > kTransitionWidth)
 		denominator = kTransitionWidth;
-	return current / denominator;
+	return (double)current / denominator;
 }
 
 static
 pgm_string_t*
 get_ascii_bucket_range (
-	pgm_histogram_t*	histogram,
 	unsigned		i
 	)
 {
 	pgm_string_t* result = pgm_string_new (NULL);
-	pgm_string_printf (result, "%d", histogram->ranges[ i ]);
+	pgm_string_printf (result, "%" PRIu64, bucket_lowest (i));
 	return result;
 }
 
@@ -0,0 +1,190 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * unit tests for histograms.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <glib.h>
+#include <check.h>
+
+#ifdef _WIN32
+#	define PGM_CHECK_NOFORK		1
+#endif
+
+
+/* mock state */
+
+
+/* mock functions for external references */
+
+
+#define HISTOGRAM_DEBUG
+#include "histogram.c"
+
+
+/* target:
+ *	unsigned
+ *	bucket_index (
+ *		const uint64_t		value
+ *	)
+ */
+
+START_TEST (test_bucket_pass_001)
+{
+	for (unsigned i = 0; i < PGM_HISTOGRAM_BUCKETS; i++) {
+		const uint64_t lowest = bucket_lowest (i);
+		const uint64_t highest = lowest + bucket_width (i) - 1;
+		fail_unless (i == bucket_index (lowest), "lowest value not in bucket");
+		fail_unless (i == bucket_index (highest), "highest value not in bucket");
+		if (i + 1 < PGM_HISTOGRAM_BUCKETS)
+			fail_unless (highest + 1 == bucket_lowest (i + 1), "bucket ranges not contiguous");
+		if (i >= PGM_HISTOGRAM_SUB_BUCKETS)
+			fail_unless (bucket_width (i) * (PGM_HISTOGRAM_SUB_BUCKETS / 2) <= lowest, "bucket wider than precision");
+	}
+	fail_unless ((PGM_HISTOGRAM_BUCKETS - 1) == bucket_index ((UINT64_C(1) << PGM_HISTOGRAM_VALUE_BITS) - 1), "maximum value not in last bucket");
+}
+END_TEST
+
+/* target:
+ *	void
+ *	pgm_histogram_add (
+ *		pgm_histogram_t*	histogram,
+ *		uint64_t		value
+ *	)
+ *
+ *	bool
+ *	pgm_histogram_summary (
+ *		const char*			name,
+ *		pgm_histogram_summary_t*	summary
+ *	)
+ */
+
+START_TEST (test_summary_pass_001)
+{
+	PGM_HISTOGRAM_DEFINE("Test.Uniform");
+	pgm_histogram_summary_t summary;
+	for (unsigned i = 1; i <= 1000; i++)
+		pgm_histogram_add (&counter, i);
+	fail_unless (PGM_HISTOGRAM_REGISTERED == counter.state, "not registered");
+	fail_unless (TRUE == pgm_histogram_summary ("Test.Uniform", &summary), "summary failed");
+	fail_unless (1000 == summary.count, "count mismatch");
+	fail_unless (summary.p50 >= 500 && summary.p50 < 500 + 500 / 32, "p50 out of range");
+	fail_unless (summary.p99 >= 990 && summary.p99 < 990 + 990 / 32, "p99 out of range");
+	fail_unless (summary.p999 >= 999 && summary.p999 <= 1000, "p99.9 out of range");
+	fail_unless (1000 == summary.max, "max mismatch");
+}
+END_TEST
+
+/* sub-bucket values are exact, beyond range values clamp */
+START_TEST (test_summary_pass_002)
+{
+	PGM_HISTOGRAM_DEFINE("Test.Exact");
+	pgm_histogram_summary_t summary;
+	for (unsigned i = 0; i < 99; i++)
+		pgm_histogram_add (&counter, 7);
+	pgm_histogram_add (&counter, UINT64_MAX);
+	fail_unless (TRUE == pgm_histogram_summary ("Test.Exact", &summary), "summary failed");
+	fail_unless (100 == summary.count, "count mismatch");
+	fail_unless (7 == summary.p50, "p50 not exact");
+	fail_unless (7 == summary.p99, "p99 not exact");
+	fail_unless ((UINT64_C(1) << PGM_HISTOGRAM_VALUE_BITS) - 1 == summary.p999, "p99.9 not clamped");
+	fail_unless ((UINT64_C(1) << PGM_HISTOGRAM_VALUE_BITS) - 1 == summary.max, "max not clamped");
+}
+END_TEST
+
+START_TEST (test_summary_fail_001)
+{
+	pgm_histogram_summary_t summary;
+	fail_unless (FALSE == pgm_histogram_summary ("Test.Unknown", &summary), "summary succeeded");
+	fail_unless (FALSE == pgm_histogram_summary (NULL, &summary), "summary succeeded");
+	fail_unless (FALSE == pgm_histogram_summary ("Test.Unknown", NULL), "summary succeeded");
+}
+END_TEST
+
+/* target:
+ *	void
+ *	pgm_histogram_write_html_graph_all (
+ *		pgm_string_t*		string
+ *	)
+ */
+
+START_TEST (test_write_pass_001)
+{
+	PGM_HISTOGRAM_DEFINE("Test.Graph");
+	for (unsigned i = 0; i < 100; i++)
+		pgm_histogram_add (&counter, i * i);
+	pgm_string_t* string = pgm_string_new (NULL);
+	pgm_histogram_write_html_graph_all (string);
+	fail_unless (NULL != strstr (string->str, "Histogram: Test.Graph recorded 100 samples"), "header missing");
+	fail_unless (NULL != strstr (string->str, "p99.9 = "), "percentiles missing");
+	pgm_string_free (string, TRUE);
+}
+END_TEST
+
+
+static
+Suite*
+make_test_suite (void)
+{
+	Suite* s;
+
+	s = suite_create (__FILE__);
+
+	TCase* tc_bucket = tcase_create ("bucket");
+	suite_add_tcase (s, tc_bucket);
+	tcase_add_test (tc_bucket, test_bucket_pass_001);
+
+	TCase* tc_summary = tcase_create ("summary");
+	suite_add_tcase (s, tc_summary);
+	tcase_add_test (tc_summary, test_summary_pass_001);
+	tcase_add_test (tc_summary, test_summary_pass_002);
+	tcase_add_test (tc_summary, test_summary_fail_001);
+
+	TCase* tc_write = tcase_create ("write");
+	suite_add_tcase (s, tc_write);
+	tcase_add_test (tc_write, test_write_pass_001);
+	return s;
+}
+
+static
+Suite*
+make_master_suite (void)
+{
+	Suite* s = suite_create ("Master");
+	return s;
+}
+
+int
+main (void)
+{
+	pgm_spinlock_init (&pgm_histograms_lock);
+	SRunner* sr = srunner_create (make_master_suite ());
+	srunner_add_suite (sr, make_test_suite ());
+	srunner_run_all (sr, CK_ENV);
+	int number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	pgm_spinlock_free (&pgm_histograms_lock);
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof */
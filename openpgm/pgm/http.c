@@ -31,7 +31,9 @@
 #	include <lmcons.h>
 #	include <process.h>
 #endif
+#include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <time.h>
 #include <impl/i18n.h>
 #include <impl/framework.h>
@@ -71,10 +73,180 @@
 
 #define HTTP_BACKLOG			10 /* connections */
 #define HTTP_TIMEOUT			60 /* seconds */
+#define HTTP_KEEPALIVE_TIMEOUT		15 /* seconds idle between requests */
+#define HTTP_MAX_REQUEST		8192 /* bytes of request line and headers */
+#define HTTP_METRICS_CHUNK		16384 /* bytes rendered per write */
+#define HTTP_EVENTS_DEFAULT		256 /* trace events per page */
+#define HTTP_EVENTS_MAX			65536
 
 
 /* locals */
 
+/* OpenMetrics exposition, counters are copied while walking the socket and
+ * peer lists then rendered family by family a chunk at a time as the client
+ * drains the connection.
+ */
+
+struct http_metrics_source_t {
+	char		labels[ sizeof("tsi=\"\"") + PGM_TSISTRLEN ];
+	pgm_tsi_t	tsi;
+	uint64_t	cumulative_stats[PGM_STATS_COUNTERS];
+	uint64_t	bytes_buffered;
+	uint64_t	packets_buffered;
+	uint64_t	mem_used;
+};
+
+struct http_metrics_peer_t {
+	char		labels[ sizeof("tsi=\"\",transport=\"\"") + (2 * PGM_TSISTRLEN) ];
+	pgm_tsi_t	tsi;
+	pgm_tsi_t	transport_tsi;
+	uint64_t	cumulative_stats[PGM_STATS_COUNTERS];
+	uint64_t	cumulative_losses;
+	uint64_t	bytes_delivered;
+	uint64_t	msgs_delivered;
+	uint64_t	outstanding_naks;
+	uint64_t	min_fill_time;
+	uint64_t	max_fill_time;
+	uint64_t	min_fail_time;
+	uint64_t	max_fail_time;
+};
+
+struct http_metrics_memory_t {
+	char		labels[ sizeof("subsystem=\"placeholder\"") ];
+	uint64_t	calls;
+	uint64_t	bytes;
+};
+
+struct http_metrics_kernel_t {
+	char		labels[ sizeof("function=\"reed_solomon\",max_len=\"65535\",kernel=\"\"") + 16 ];
+	uint64_t	nsecs;
+};
+
+enum {
+	HTTP_KERNEL_CHECKSUM_SMALL,
+	HTTP_KERNEL_CHECKSUM_LARGE,
+	HTTP_KERNEL_REED_SOLOMON,
+	HTTP_KERNEL_MAX
+};
+
+struct http_metrics_t {
+	struct http_metrics_source_t*	sources;
+	unsigned			source_len;
+	struct http_metrics_peer_t*	peers;
+	unsigned			peer_len;
+	struct http_metrics_memory_t	memory[PGM_MEM_SUBSYS_MAX];
+	struct http_metrics_kernel_t	kernels[HTTP_KERNEL_MAX];
+/* rendering cursor */
+	unsigned			family;
+	unsigned			row;
+};
+
+struct http_metric_t {
+	const char*	name;
+	const char*	help;
+	bool		is_gauge;
+	size_t		offset;
+};
+
+#define SOURCE_COUNTER(name, help, index) \
+	{ (name), (help), FALSE, offsetof(struct http_metrics_source_t, cumulative_stats) + ((index) * sizeof(uint64_t)) }
+#define SOURCE_GAUGE(name, help, member) \
+	{ (name), (help), TRUE, offsetof(struct http_metrics_source_t, member) }
+#define PEER_COUNTER(name, help, index) \
+	{ (name), (help), FALSE, offsetof(struct http_metrics_peer_t, cumulative_stats) + ((index) * sizeof(uint64_t)) }
+#define PEER_WINDOW_COUNTER(name, help, member) \
+	{ (name), (help), FALSE, offsetof(struct http_metrics_peer_t, member) }
+#define PEER_GAUGE(name, help, index) \
+	{ (name), (help), TRUE, offsetof(struct http_metrics_peer_t, cumulative_stats) + ((index) * sizeof(uint64_t)) }
+#define PEER_WINDOW_GAUGE(name, help, member) \
+	{ (name), (help), TRUE, offsetof(struct http_metrics_peer_t, member) }
+#define MEMORY_COUNTER(name, help, member) \
+	{ (name), (help), FALSE, offsetof(struct http_metrics_memory_t, member) }
+
+static const struct http_metric_t http_source_metrics[] = {
+	SOURCE_COUNTER ("pgm_source_data_bytes", "Data bytes sent", PGM_PC_SOURCE_DATA_BYTES_SENT),
+	SOURCE_COUNTER ("pgm_source_data_packets", "Data packets sent", PGM_PC_SOURCE_DATA_MSGS_SENT),
+	SOURCE_COUNTER ("pgm_source_bytes", "Bytes sent", PGM_PC_SOURCE_BYTES_SENT),
+	SOURCE_COUNTER ("pgm_source_checksum_errors", "Checksum errors", PGM_PC_SOURCE_CKSUM_ERRORS),
+	SOURCE_COUNTER ("pgm_source_malformed_naks", "Malformed NAKs", PGM_PC_SOURCE_MALFORMED_NAKS),
+	SOURCE_COUNTER ("pgm_source_packets_discarded", "Packets discarded", PGM_PC_SOURCE_PACKETS_DISCARDED),
+	SOURCE_COUNTER ("pgm_source_bytes_retransmitted", "Bytes retransmitted", PGM_PC_SOURCE_SELECTIVE_BYTES_RETRANSMITTED),
+	SOURCE_COUNTER ("pgm_source_packets_retransmitted", "Packets retransmitted", PGM_PC_SOURCE_SELECTIVE_MSGS_RETRANSMITTED),
+	SOURCE_COUNTER ("pgm_source_parity_bytes_retransmitted", "Parity bytes retransmitted", PGM_PC_SOURCE_PARITY_BYTES_RETRANSMITTED),
+	SOURCE_COUNTER ("pgm_source_parity_packets_retransmitted", "Parity packets retransmitted", PGM_PC_SOURCE_PARITY_MSGS_RETRANSMITTED),
+	SOURCE_COUNTER ("pgm_source_nak_packets", "NAK packets received", PGM_PC_SOURCE_SELECTIVE_NAK_PACKETS_RECEIVED),
+	SOURCE_COUNTER ("pgm_source_naks", "NAKs received", PGM_PC_SOURCE_SELECTIVE_NAKS_RECEIVED),
+	SOURCE_COUNTER ("pgm_source_naks_ignored", "NAKs ignored", PGM_PC_SOURCE_SELECTIVE_NAKS_IGNORED),
+	SOURCE_COUNTER ("pgm_source_parity_nak_packets", "Parity NAK packets received", PGM_PC_SOURCE_PARITY_NAK_PACKETS_RECEIVED),
+	SOURCE_COUNTER ("pgm_source_parity_naks", "Parity NAKs received", PGM_PC_SOURCE_PARITY_NAKS_RECEIVED),
+	SOURCE_COUNTER ("pgm_source_nnak_packets", "NNAK packets received", PGM_PC_SOURCE_SELECTIVE_NNAK_PACKETS_RECEIVED),
+	SOURCE_COUNTER ("pgm_source_nnaks", "NNAKs received", PGM_PC_SOURCE_SELECTIVE_NNAKS_RECEIVED),
+	SOURCE_COUNTER ("pgm_source_nnak_errors", "Malformed NNAKs", PGM_PC_SOURCE_NNAK_ERRORS),
+	SOURCE_COUNTER ("pgm_source_ack_packets", "ACK packets received", PGM_PC_SOURCE_ACK_PACKETS_RECEIVED),
+	SOURCE_COUNTER ("pgm_source_ack_errors", "Malformed ACKs", PGM_PC_SOURCE_ACK_ERRORS),
+	SOURCE_COUNTER ("pgm_source_rxq_drops", "Datagrams dropped on receive queue overrun", PGM_PC_SOURCE_RXQ_DROPS),
+	SOURCE_COUNTER ("pgm_source_peers_refused", "Packets of new peers refused on the memory budget", PGM_PC_SOURCE_PEERS_REFUSED),
+	SOURCE_COUNTER ("pgm_source_naks_rate_limited", "Sequences NAKed over a receiver limit", PGM_PC_SOURCE_NAKS_RATE_LIMITED),
+	SOURCE_COUNTER ("pgm_source_receivers_demoted", "Receivers demoted on chronic NAKs", PGM_PC_SOURCE_RECEIVERS_DEMOTED),
+	{ "pgm_source_transmission_rate_bytes", "Transmission rate in bytes per second", TRUE,
+	  offsetof(struct http_metrics_source_t, cumulative_stats) + (PGM_PC_SOURCE_TRANSMISSION_CURRENT_RATE * sizeof(uint64_t)) },
+	SOURCE_GAUGE ("pgm_source_buffered_bytes", "Bytes buffered in the transmit window", bytes_buffered),
+	SOURCE_GAUGE ("pgm_source_buffered_packets", "Packets buffered in the transmit window", packets_buffered),
+	SOURCE_GAUGE ("pgm_source_memory_bytes", "Bytes of window packet buffers charged to the socket", mem_used)
+};
+
+static const struct http_metric_t http_peer_metrics[] = {
+	PEER_COUNTER ("pgm_receiver_data_bytes", "Data bytes received", PGM_PC_RECEIVER_DATA_BYTES_RECEIVED),
+	PEER_COUNTER ("pgm_receiver_data_packets", "Data packets received", PGM_PC_RECEIVER_DATA_MSGS_RECEIVED),
+	PEER_COUNTER ("pgm_receiver_bytes", "Bytes received", PGM_PC_RECEIVER_BYTES_RECEIVED),
+	PEER_COUNTER ("pgm_receiver_malformed_spms", "Malformed SPMs", PGM_PC_RECEIVER_MALFORMED_SPMS),
+	PEER_COUNTER ("pgm_receiver_malformed_odata", "Malformed ODATA", PGM_PC_RECEIVER_MALFORMED_ODATA),
+	PEER_COUNTER ("pgm_receiver_malformed_rdata", "Malformed RDATA", PGM_PC_RECEIVER_MALFORMED_RDATA),
+	PEER_COUNTER ("pgm_receiver_malformed_ncfs", "Malformed NCFs", PGM_PC_RECEIVER_MALFORMED_NCFS),
+	PEER_COUNTER ("pgm_receiver_packets_discarded", "Packets discarded", PGM_PC_RECEIVER_PACKETS_DISCARDED),
+	PEER_WINDOW_COUNTER ("pgm_receiver_losses", "Detected missed packets", cumulative_losses),
+	PEER_WINDOW_COUNTER ("pgm_receiver_delivered_bytes", "Bytes delivered to application", bytes_delivered),
+	PEER_WINDOW_COUNTER ("pgm_receiver_delivered_messages", "Messages delivered to application", msgs_delivered),
+	PEER_COUNTER ("pgm_receiver_duplicate_spms", "Duplicate SPMs", PGM_PC_RECEIVER_DUP_SPMS),
+	PEER_COUNTER ("pgm_receiver_duplicate_data", "Duplicate ODATA and RDATA", PGM_PC_RECEIVER_DUP_DATAS),
+	PEER_COUNTER ("pgm_receiver_nak_packets", "NAK packets sent", PGM_PC_RECEIVER_SELECTIVE_NAK_PACKETS_SENT),
+	PEER_COUNTER ("pgm_receiver_naks", "NAKs sent", PGM_PC_RECEIVER_SELECTIVE_NAKS_SENT),
+	PEER_COUNTER ("pgm_receiver_naks_retransmitted", "NAKs retransmitted", PGM_PC_RECEIVER_SELECTIVE_NAKS_RETRANSMITTED),
+	PEER_COUNTER ("pgm_receiver_naks_failed", "NAKs failed", PGM_PC_RECEIVER_SELECTIVE_NAKS_FAILED),
+	PEER_COUNTER ("pgm_receiver_naks_failed_rxw_advanced", "NAKs failed due to RXW advance", PGM_PC_RECEIVER_NAKS_FAILED_RXW_ADVANCED),
+	PEER_COUNTER ("pgm_receiver_naks_failed_ncf_retries", "NAKs failed due to NCF retries", PGM_PC_RECEIVER_NAKS_FAILED_NCF_RETRIES_EXCEEDED),
+	PEER_COUNTER ("pgm_receiver_naks_failed_data_retries", "NAKs failed due to DATA retries", PGM_PC_RECEIVER_NAKS_FAILED_DATA_RETRIES_EXCEEDED),
+	PEER_COUNTER ("pgm_receiver_naks_failed_deadline", "NAKs failed due to delivery deadline", PGM_PC_RECEIVER_NAKS_FAILED_GEN_EXPIRED),
+	PEER_COUNTER ("pgm_receiver_nak_failures", "NAK failures", PGM_PC_RECEIVER_NAK_FAILURES),
+	PEER_COUNTER ("pgm_receiver_nak_failures_delivered", "NAK failures delivered to application", PGM_PC_RECEIVER_NAK_FAILURES_DELIVERED),
+	PEER_COUNTER ("pgm_receiver_naks_suppressed", "NAKs suppressed", PGM_PC_RECEIVER_SELECTIVE_NAKS_SUPPRESSED),
+	PEER_COUNTER ("pgm_receiver_nak_errors", "Malformed NAKs", PGM_PC_RECEIVER_NAK_ERRORS),
+	PEER_COUNTER ("pgm_receiver_acks", "ACKs sent", PGM_PC_RECEIVER_ACKS_SENT),
+	PEER_WINDOW_GAUGE ("pgm_receiver_outstanding_naks", "Outstanding NAKs", outstanding_naks),
+	PEER_WINDOW_GAUGE ("pgm_receiver_nak_repair_min_microseconds", "NAK repair minimum time", min_fill_time),
+	PEER_GAUGE ("pgm_receiver_nak_repair_mean_microseconds", "NAK repair mean time", PGM_PC_RECEIVER_NAK_SVC_TIME_MEAN),
+	PEER_WINDOW_GAUGE ("pgm_receiver_nak_repair_max_microseconds", "NAK repair maximum time", max_fill_time),
+	PEER_WINDOW_GAUGE ("pgm_receiver_nak_fail_min_microseconds", "NAK fail minimum time", min_fail_time),
+	PEER_GAUGE ("pgm_receiver_nak_fail_mean_microseconds", "NAK fail mean time", PGM_PC_RECEIVER_NAK_FAIL_TIME_MEAN),
+	PEER_WINDOW_GAUGE ("pgm_receiver_nak_fail_max_microseconds", "NAK fail maximum time", max_fail_time),
+	PEER_GAUGE ("pgm_receiver_nak_transmit_mean", "NAK mean retransmit count", PGM_PC_RECEIVER_TRANSMIT_MEAN)
+};
+
+static const struct http_metric_t http_memory_metrics[] = {
+	MEMORY_COUNTER ("pgm_memory_allocations", "Heap allocations by subsystem", calls),
+	MEMORY_COUNTER ("pgm_memory_allocated_bytes", "Bytes of heap allocations by subsystem", bytes)
+};
+
+static const struct http_metric_t http_kernel_metrics[] = {
+	{ "pgm_kernel_call_nanoseconds", "Calibrated time per call of the selected kernel, 0 when not calibrated", TRUE,
+	  offsetof(struct http_metrics_kernel_t, nsecs) }
+};
+
+enum {
+	HTTP_MEMORY_STATIC,
+	HTTP_MEMORY_TAKE
+};
+
 struct http_connection_t {
 	pgm_list_t	link_;
 	SOCKET		sock;
@@ -83,20 +255,51 @@ struct http_connection_t {
 		HTTP_STATE_WRITE,
 		HTTP_STATE_FINWAIT
 	}		state;
+	pgm_time_t	expiry;			/* closed when idle until */
+	bool		is_keep_alive;
 
+/* request, may run into the next of a pipeline */
+	char*		req;
+	size_t		reqlen;
+	size_t		reqoff;
+
+/* response */
 	char*		buf;
 	size_t		buflen;
 	size_t		bufoff;
+	int		bufmem;			/* HTTP_MEMORY_STATIC is not freed */
 	unsigned	status_code;
 	const char*	status_text;
 	const char*	content_type;
+
+	struct http_metrics_t*	metrics;	/* pending rendering */
 };
 
+/* fixed pages are rendered with their headers once at startup, for either
+ * keep-alive or closing connections, and sent straight from memory.
+ */
+
 enum {
-	HTTP_MEMORY_STATIC,
-	HTTP_MEMORY_TAKE
+	HTTP_STATIC_ROBOTS_TXT,
+	HTTP_STATIC_BASE_CSS,
+	HTTP_STATIC_404_HTML,
+	HTTP_STATIC_MAX
+};
+
+static const struct {
+	unsigned	status_code;
+	const char*	status_text;
+	const char*	content_type;
+	const char*	content;
+} http_static_content[ HTTP_STATIC_MAX ] = {
+	{ 200, "OK",		"text/plain",	WWW_ROBOTS_TXT },
+	{ 200, "OK",		"text/css",	WWW_BASE_CSS },
+	{ 404, "Not Found",	"text/html",	WWW_404_HTML }
 };
 
+static char*		http_static[ HTTP_STATIC_MAX ][ 2 ];	/* by is_keep_alive */
+static size_t		http_static_len[ HTTP_STATIC_MAX ][ 2 ];
+
 static char		http_hostname[NI_MAXHOST];
 static char		http_address[INET6_ADDRSTRLEN];
 static char		http_username[LOGIN_NAME_MAX + 1];
@@ -128,6 +331,13 @@ static void index_callback (struct http_connection_t*restrict, const char*restri
 static void interfaces_callback (struct http_connection_t*restrict, const char*restrict);
 static void transports_callback (struct http_connection_t*restrict, const char*restrict);
 static void histograms_callback (struct http_connection_t*restrict, const char*restrict);
+static void metrics_callback (struct http_connection_t*restrict, const char*restrict);
+static void events_callback (struct http_connection_t*restrict, const char*restrict);
+static void profile_callback (struct http_connection_t*restrict, const char*restrict);
+
+static struct http_metrics_t* http_metrics_snapshot (void);
+static void http_metrics_free (struct http_metrics_t*);
+static void http_metrics_render (struct http_connection_t*);
 
 static struct {
 	const char*	path;
@@ -137,47 +347,70 @@ static struct {
 	{ "/base.css",		css_callback },
 	{ "/",			index_callback },
 	{ "/interfaces",	interfaces_callback },
-	{ "/transports",	transports_callback }
+	{ "/transports",	transports_callback },
+	{ "/metrics",		metrics_callback },
+	{ "/events",		events_callback },
+	{ "/profile",		profile_callback }
 #ifdef USE_HISTOGRAMS
        ,{ "/histograms",	histograms_callback }
 #endif
 };
 
 
+/* connection header by is_keep_alive */
+
 static
-int
-http_sock_rcvtimeo (
-	SOCKET			sock,
-	int			seconds
+const char*
+http_connection_header (
+	const bool		is_keep_alive
 	)
 {
-#if defined( __sun )
-	return 0;
-#elif !defined( _WIN32 )
-	const struct timeval timeout = { .tv_sec = seconds, .tv_usec = 0 };
-	return setsockopt (sock, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
-#else
-	const int optval = seconds * 1000;
-	return setsockopt (sock, SOL_SOCKET, SO_RCVTIMEO, (const char*)&optval, sizeof(optval));
-#endif
+	return is_keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
 }
 
+/* render the fixed pages with their headers.
+ */
+
 static
-int
-http_sock_sndtimeo (
-	SOCKET			sock,
-	int			seconds
-	)
+void
+http_static_init (void)
 {
-#if defined( __sun )
-	return 0;
-#elif !defined( _WIN32 )
-	const struct timeval timeout = { .tv_sec = seconds, .tv_usec = 0 };
-	return setsockopt (sock, SOL_SOCKET, SO_SNDTIMEO, (const char*)&timeout, sizeof(timeout));
-#else
-	const int optval = seconds * 1000;
-	return setsockopt (sock, SOL_SOCKET, SO_SNDTIMEO, (const char*)&optval, sizeof(optval));
-#endif
+	for (unsigned i = 0; i < HTTP_STATIC_MAX; i++)
+	{
+		const size_t content_length = strlen (http_static_content[i].content);
+		for (unsigned j = 0; j < 2; j++)
+		{
+			pgm_string_t* response = pgm_string_new (NULL);
+			pgm_string_printf (response, "HTTP/1.1 %u %s\r\n"
+						     "Server: OpenPGM HTTP Server %u.%u.%u\r\n"
+						     "Last-Modified: Fri, 1 Jan 2010, 00:00:01 GMT\r\n"
+						     "Content-Length: %" PRIzd "\r\n"
+						     "Content-Type: %s\r\n"
+						     "%s"
+						     "\r\n",
+					   http_static_content[i].status_code,
+					   http_static_content[i].status_text,
+					   pgm_major_version, pgm_minor_version, pgm_micro_version,
+					   content_length,
+					   http_static_content[i].content_type,
+					   http_connection_header (j)
+					);
+			pgm_string_append (response, http_static_content[i].content);
+			http_static_len[i][j] = response->len;
+			http_static[i][j] = pgm_string_free (response, FALSE);
+		}
+	}
+}
+
+static
+void
+http_static_shutdown (void)
+{
+	for (unsigned i = 0; i < HTTP_STATIC_MAX; i++)
+		for (unsigned j = 0; j < 2; j++) {
+			pgm_free (http_static[i][j]);
+			http_static[i][j] = NULL;
+		}
 }
 
 bool
@@ -286,17 +519,6 @@ pgm_http_init (
 				pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
 		goto err_cleanup;
 	}
-	if (0 != http_sock_rcvtimeo (http_sock, HTTP_TIMEOUT) ||
-	    0 != http_sock_sndtimeo (http_sock, HTTP_TIMEOUT)) {
-		const int save_errno = pgm_get_last_sock_error();
-		char errbuf[1024];
-		pgm_set_error (error,
-				PGM_ERROR_DOMAIN_HTTP,
-				pgm_error_from_sock_errno (save_errno),
-				_("Setting socket timeout: %s"),
-				pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
-		goto err_cleanup;
-	}
 	struct sockaddr_in http_addr;
 	memset (&http_addr, 0, sizeof(http_addr));
 	http_addr.sin_family = AF_INET;
@@ -341,6 +563,8 @@ pgm_http_init (
 		goto err_cleanup;
 	}
 
+	http_static_init();
+
 /* spawn thread to handle HTTP requests */
 #ifndef _WIN32
 	const int status = pthread_create (&http_thread, NULL, &http_routine, NULL);
@@ -380,6 +604,7 @@ err_cleanup:
 	if (pgm_notify_is_valid (&http_notify)) {
 		pgm_notify_destroy (&http_notify);
 	}
+	http_static_shutdown();
 	pgm_atomic_dec32 (&http_ref_count);
 	return FALSE;
 }
@@ -407,6 +632,7 @@ pgm_http_shutdown (void)
 		http_sock = INVALID_SOCKET;
 	}
 	pgm_notify_destroy (&http_notify);
+	http_static_shutdown();
 	return TRUE;
 }
 
@@ -447,6 +673,7 @@ http_accept (
 	struct http_connection_t* connection = pgm_new0 (struct http_connection_t, 1);
 	connection->sock = new_sock;
 	connection->state = HTTP_STATE_READ;
+	connection->expiry = pgm_time_update_now() + pgm_secs (HTTP_TIMEOUT);
 	http_socks = pgm_list_prepend_link (http_socks, &connection->link_);
 	FD_SET( new_sock, &http_readfds );
 	FD_SET( new_sock, &http_exceptfds );
@@ -454,6 +681,23 @@ http_accept (
 		http_max_sock = new_sock;
 }
 
+/* release the response buffer unless pre-built.
+ */
+
+static
+void
+http_free_response (
+	struct http_connection_t*	connection
+	)
+{
+	if (HTTP_MEMORY_TAKE == connection->bufmem && connection->buflen > 0)
+		pgm_free (connection->buf);
+	connection->buf = NULL;
+	connection->buflen = 0;
+	connection->bufoff = 0;
+	connection->bufmem = HTTP_MEMORY_TAKE;
+}
+
 static
 void
 http_close (
@@ -477,10 +721,11 @@ http_close (
 	}
 	FD_CLR( connection->sock, &http_exceptfds );
 	http_socks = pgm_list_remove_link (http_socks, &connection->link_);
-	if (connection->buflen > 0) {
-		pgm_free (connection->buf);
-		connection->buf = NULL;
-		connection->buflen = 0;
+	http_free_response (connection);
+	pgm_free (connection->req);
+	if (connection->metrics) {
+		http_metrics_free (connection->metrics);
+		connection->metrics = NULL;
 	}
 /* find new highest fd */
 	if (connection->sock == http_max_sock)
@@ -496,49 +741,77 @@ http_close (
 	pgm_free (connection);
 }
 
-/* non-blocking read an incoming HTTP request
+/* case-insensitive prefix comparison of ASCII header text.
  */
 
 static
-void
-http_read (
-	struct http_connection_t*	connection
+bool
+http_prefix_equal (
+	const char*	restrict s,
+	const char*	restrict prefix
 	)
 {
-	for (;;)
-	{
-/* grow buffer as needed */
-		if (connection->bufoff + 1024  > connection->buflen) {
-			connection->buf = pgm_realloc (connection->buf, connection->buflen + 1024);
-			connection->buflen += 1024;
-		}
-		const ssize_t bytes_read = recv (connection->sock, &connection->buf[ connection->bufoff ], connection->buflen - connection->bufoff, 0);
-		if (bytes_read < 0) {
-			const int save_errno = pgm_get_last_sock_error();
-			char errbuf[1024];
-			if (PGM_SOCK_EINTR == save_errno || PGM_SOCK_EAGAIN == save_errno)
-				return;
-			pgm_warn (_("HTTP client read: %s"),
-				pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
-			http_close (connection);
-			return;
-		}
+	for (; *prefix; s++, prefix++) {
+		const char c = ('A' <= *s && *s <= 'Z') ? *s + ('a' - 'A') : *s;
+		if (c != *prefix)
+			return FALSE;
+	}
+	return TRUE;
+}
 
-/* complete */
-		if (strstr (connection->buf, "\r\n\r\n"))
-			break;
+/* HTTP/1.1 connections persist unless closed by a Connection header,
+ * HTTP/1.0 connections only when asked to keep-alive.
+ */
+
+static
+bool
+http_is_keep_alive (
+	const char*		request		/* NUL terminated request line and headers */
+	)
+{
+	const char* eol = strstr (request, "\r\n");
+	bool is_keep_alive = (eol - request > 8 && 0 == memcmp (eol - 8, "HTTP/1.1", 8));
+
+	for (const char* header = eol + 2;
+	     '\r' != *header && '\0' != *header;
+	     header = strstr (header, "\r\n") + 2)
+	{
+		if (!http_prefix_equal (header, "connection:"))
+			continue;
+		const char* value = header + strlen ("connection:");
+		while (' ' == *value || '\t' == *value)
+			value++;
+		if (http_prefix_equal (value, "close"))
+			is_keep_alive = FALSE;
+		else if (http_prefix_equal (value, "keep-alive"))
+			is_keep_alive = TRUE;
 	}
+	return is_keep_alive;
+}
 
-/* process request, e.g. GET /index.html HTTP/1.1\r\n
+/* parse a complete request, e.g. GET /index.html HTTP/1.1\r\n, and render
+ * the response.  bytes after the request are kept for the next.
  */
-	connection->buf[ connection->buflen - 1 ] = '\0';
-	if (0 != memcmp (connection->buf, "GET ", strlen("GET "))) {
+
+static
+void
+http_request (
+	struct http_connection_t*	connection,
+	const size_t			request_len
+	)
+{
+	char* request = connection->req;
+	request[ request_len - 2 ] = '\0';	/* keep one CRLF ending the last header */
+
+	if (0 != memcmp (request, "GET ", strlen("GET "))) {
 /* 501 (not implemented) */
 		http_close (connection);
 		return;
 	}
 
-	char* request_uri = connection->buf + strlen("GET ");
+	connection->is_keep_alive = http_is_keep_alive (request);
+
+	char* request_uri = request + strlen("GET ");
 	char* p = request_uri;
 	do {
 		if (*p == '?' || *p == ' ') {
@@ -547,10 +820,10 @@ http_read (
 		}
 	} while (*(++p));
 
+	http_free_response (connection);
 	connection->status_code	 = 200;	/* OK */
 	connection->status_text  = "OK";
 	connection->content_type = "text/html";
-	connection->bufoff       = 0;
 	for (unsigned i = 0; i < PGM_N_ELEMENTS(http_directory); i++)
 	{
 		if (0 == strcmp (request_uri, http_directory[i].path))
@@ -562,34 +835,106 @@ http_read (
 	default_callback (connection, request_uri);
 
 complete:
+/* the body of an unbounded response is framed by closing */
+	if (NULL != connection->metrics)
+		connection->is_keep_alive = FALSE;
+	connection->reqoff -= request_len;
+	memmove (connection->req, connection->req + request_len, connection->reqoff);
+	connection->req[ connection->reqoff ] = '\0';
 	connection->state = HTTP_STATE_WRITE;
 	FD_CLR( connection->sock, &http_readfds );
 	FD_SET( connection->sock, &http_writefds );
 }
 
-/* non-blocking write a HTTP response
+/* non-blocking read an incoming HTTP request
  */
 
 static
 void
-http_write (
+http_read (
 	struct http_connection_t*	connection
 	)
 {
-	do {
-		const ssize_t bytes_written = send (connection->sock, &connection->buf[ connection->bufoff ], connection->buflen - connection->bufoff, 0);
-		if (bytes_written < 0) {
+	const char* end;
+
+	while (NULL == connection->req || NULL == (end = strstr (connection->req, "\r\n\r\n")))
+	{
+/* grow buffer as needed, reserving the terminating NUL */
+		if (connection->reqoff + 1 >= connection->reqlen) {
+			if (connection->reqlen >= HTTP_MAX_REQUEST) {
+				pgm_warn (_("HTTP request exceeds %u bytes."), HTTP_MAX_REQUEST);
+				http_close (connection);
+				return;
+			}
+			connection->req = pgm_realloc (connection->req, connection->reqlen + 1024);
+			connection->reqlen += 1024;
+		}
+		const ssize_t bytes_read = recv (connection->sock, &connection->req[ connection->reqoff ], connection->reqlen - connection->reqoff - 1, 0);
+		if (bytes_read < 0) {
 			const int save_errno = pgm_get_last_sock_error();
 			char errbuf[1024];
 			if (PGM_SOCK_EINTR == save_errno || PGM_SOCK_EAGAIN == save_errno)
 				return;
-			pgm_warn (_("HTTP client write: %s"),
+			pgm_warn (_("HTTP client read: %s"),
 				pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
 			http_close (connection);
 			return;
 		}
-		connection->bufoff += bytes_written;
-	} while (connection->bufoff < connection->buflen);
+/* closed by client */
+		if (0 == bytes_read) {
+			http_close (connection);
+			return;
+		}
+		connection->reqoff += bytes_read;
+		connection->req[ connection->reqoff ] = '\0';
+		connection->expiry = pgm_time_update_now() + pgm_secs (HTTP_TIMEOUT);
+	}
+
+	http_request (connection, (end + strlen ("\r\n\r\n")) - connection->req);
+}
+
+/* non-blocking write a HTTP response
+ */
+
+static
+void
+http_write (
+	struct http_connection_t*	connection
+	)
+{
+	for (;;) {
+		while (connection->bufoff < connection->buflen) {
+			const ssize_t bytes_written = send (connection->sock, &connection->buf[ connection->bufoff ], connection->buflen - connection->bufoff, 0);
+			if (bytes_written < 0) {
+				const int save_errno = pgm_get_last_sock_error();
+				char errbuf[1024];
+				if (PGM_SOCK_EINTR == save_errno || PGM_SOCK_EAGAIN == save_errno)
+					return;
+				pgm_warn (_("HTTP client write: %s"),
+					pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+				http_close (connection);
+				return;
+			}
+			connection->bufoff += bytes_written;
+			connection->expiry = pgm_time_update_now() + pgm_secs (HTTP_TIMEOUT);
+		}
+/* render next chunk once the last has drained */
+		if (NULL == connection->metrics)
+			break;
+		http_metrics_render (connection);
+	}
+
+/* wait for the next request, which may already be buffered */
+	if (connection->is_keep_alive) {
+		http_free_response (connection);
+		connection->state = HTTP_STATE_READ;
+		connection->expiry = pgm_time_update_now() + pgm_secs (HTTP_KEEPALIVE_TIMEOUT);
+		FD_CLR( connection->sock, &http_writefds );
+		FD_SET( connection->sock, &http_readfds );
+		if (connection->reqoff > 0)
+			http_read (connection);
+		return;
+	}
 
 	if (0 == shutdown (connection->sock, SHUT_WR)) {
 		http_close (connection);
@@ -633,59 +978,54 @@ http_process (
 	}
 }
 
-static
-void
-http_set_status (
-	struct http_connection_t*restrict connection,
-	int				  status_code,
-	const char*		 restrict status_text
-	)
-{
-	connection->status_code = status_code;
-	connection->status_text = status_text;
-}
+/* close connections idle past their expiry so that a stalled client holds
+ * nothing but its own descriptor for long.
+ *
+ * returns the next expiry, or 0 without connections.
+ */
 
 static
-void
-http_set_content_type (
-	struct http_connection_t*restrict connection,
-	const char*		 restrict content_type
+pgm_time_t
+http_expire (
+	const pgm_time_t		now
 	)
 {
-	connection->content_type = content_type;
+	pgm_time_t next_expiry = 0;
+
+	for (pgm_list_t* list = http_socks; list;)
+	{
+		struct http_connection_t* c = (void*)list;
+		list = list->next;
+		if (pgm_time_after_eq (now, c->expiry)) {
+			pgm_debug ("HTTP connection idle timeout.");
+			http_close (c);
+			continue;
+		}
+		if (0 == next_expiry || pgm_time_after (next_expiry, c->expiry))
+			next_expiry = c->expiry;
+	}
+	return next_expiry;
 }
 
-/* finalise response buffer with headers and content */
+/* point the response at a page pre-built by http_static_init() */
 
 static
 void
 http_set_static_response (
 	struct http_connection_t*restrict connection,
-	const char*		 restrict content,
-	size_t				  content_length
+	const unsigned			  page
 	)
 {
-	pgm_string_t* response = pgm_string_new (NULL);
-	pgm_string_printf (response, "HTTP/1.0 %d %s\r\n"
-				     "Server: OpenPGM HTTP Server %u.%u.%u\r\n"
-			   	     "Last-Modified: Fri, 1 Jan 2010, 00:00:01 GMT\r\n"
-				     "Content-Length: %" PRIzd "\r\n"
-				     "Content-Type: %s\r\n"
-				     "Connection: close\r\n"
-				     "\r\n",
-			   connection->status_code,
-			   connection->status_text,
-			   pgm_major_version, pgm_minor_version, pgm_micro_version,
-			   content_length,
-			   connection->content_type
-			);
-	pgm_string_append (response, content);
-	if (connection->buflen)
-		pgm_free (connection->buf);
-	connection->buflen = response->len;
-	connection->buf = pgm_string_free (response, FALSE);
+	pgm_assert (page < HTTP_STATIC_MAX);
+
+	http_free_response (connection);
+	connection->bufmem = HTTP_MEMORY_STATIC;
+	connection->buflen = http_static_len[ page ][ connection->is_keep_alive ];
+	connection->buf    = http_static[ page ][ connection->is_keep_alive ];
 }
 
+/* finalise response buffer with headers and content */
+
 static
 void
 http_set_response (
@@ -695,22 +1035,22 @@ http_set_response (
 	)
 {
 	pgm_string_t* response = pgm_string_new (NULL);
-	pgm_string_printf (response, "HTTP/1.0 %d %s\r\n"
+	pgm_string_printf (response, "HTTP/1.1 %d %s\r\n"
 				     "Server: OpenPGM HTTP Server %u.%u.%u\r\n"
 				     "Content-Length: %" PRIzd "\r\n"
 				     "Content-Type: %s\r\n"
-				     "Connection: close\r\n"
+				     "%s"
 				     "\r\n",
 			   connection->status_code,
 			   connection->status_text,
 			   pgm_major_version, pgm_minor_version, pgm_micro_version,
 			   content_length,
-			   connection->content_type
+			   connection->content_type,
+			   http_connection_header (connection->is_keep_alive)
 			);
 	pgm_string_append (response, content);
 	pgm_free (content);
-	if (connection->buflen)
-		pgm_free (connection->buf);
+	http_free_response (connection);
 	connection->buflen = response->len;
 	connection->buf = pgm_string_free (response, FALSE);
 }
@@ -732,6 +1072,8 @@ http_routine (
 	const SOCKET notify_fd = pgm_notify_get_socket (&http_notify);
 	const int max_fd = MAX( notify_fd, http_sock );
 
+	pgm_affinity_apply (PGM_THREAD_HTTP);
+
 	FD_ZERO( &http_readfds );
 	FD_ZERO( &http_writefds );
 	FD_ZERO( &http_exceptfds );
@@ -742,25 +1084,34 @@ http_routine (
 	{
 		int fds = MAX( http_max_sock, max_fd ) + 1;
 		fd_set readfds = http_readfds, writefds = http_writefds, exceptfds = http_exceptfds;
-
-		fds = select (fds, &readfds, &writefds, &exceptfds, NULL);
+		const pgm_time_t now = pgm_time_update_now();
+		const pgm_time_t next_expiry = http_expire (now);
+		struct timeval tv;
+
+		if (next_expiry) {
+			const pgm_time_t timeout = next_expiry - now;
+			tv.tv_sec  = (long)pgm_to_secs (timeout);
+			tv.tv_usec = (long)(timeout % 1000000UL);
+		}
+		fds = select (fds, &readfds, &writefds, &exceptfds, next_expiry ? &tv : NULL);
 /* signal interrupt */
 		if (PGM_UNLIKELY(SOCKET_ERROR == fds && PGM_SOCK_EINTR == pgm_get_last_sock_error()))
 			continue;
 /* terminate */
 		if (PGM_UNLIKELY(FD_ISSET( notify_fd, &readfds )))
 			break;
+/* idle timeout */
+		if (0 == fds)
+			continue;
 /* new connection */
-		if (FD_ISSET( http_sock, &readfds )) {
+		if (FD_ISSET( http_sock, &readfds ))
 			http_accept (http_sock);
-			continue;
-		}
-/* existing connection */
+/* existing connections, each served as far as it is ready */
 		for (pgm_list_t* list = http_socks; list;)
 		{
 			struct http_connection_t* c = (void*)list;
 			list = list->next;
-			if ((FD_ISSET( c->sock, &readfds )  && HTTP_STATE_READ  == c->state) ||
+			if ((FD_ISSET( c->sock, &readfds )  && HTTP_STATE_WRITE != c->state) ||
 			    (FD_ISSET( c->sock, &writefds ) && HTTP_STATE_WRITE == c->state) ||
 			    (FD_ISSET( c->sock, &exceptfds )))
 			{
@@ -770,6 +1121,8 @@ http_routine (
 	}
 
 /* cleanup */
+	while (http_socks)
+		http_close ((struct http_connection_t*)http_socks);
 #ifndef _WIN32
 	return NULL;
 #else
@@ -785,6 +1138,8 @@ typedef enum {
 	HTTP_TAB_GENERAL_INFORMATION,
 	HTTP_TAB_INTERFACES,
 	HTTP_TAB_TRANSPORTS,
+	HTTP_TAB_EVENTS,
+	HTTP_TAB_PROFILE,
 	HTTP_TAB_HISTOGRAMS
 } http_tab_e;
 
@@ -799,6 +1154,8 @@ http_create_response (
 	pgm_assert (tab == HTTP_TAB_GENERAL_INFORMATION ||
 		    tab == HTTP_TAB_INTERFACES ||
 		    tab == HTTP_TAB_TRANSPORTS ||
+		    tab == HTTP_TAB_EVENTS ||
+		    tab == HTTP_TAB_PROFILE ||
 		    tab == HTTP_TAB_HISTOGRAMS);
 
 /* surprising deficiency of GLib is no support of display locale time */
@@ -830,6 +1187,8 @@ http_create_response (
 						"<a href=\"/\"><span class=\"tab\" id=\"tab%s\">General Information</span></a>"
 						"<a href=\"/interfaces\"><span class=\"tab\" id=\"tab%s\">Interfaces</span></a>"
 						"<a href=\"/transports\"><span class=\"tab\" id=\"tab%s\">Transports</span></a>"
+						"<a href=\"/events\"><span class=\"tab\" id=\"tab%s\">Events</span></a>"
+						"<a href=\"/profile\"><span class=\"tab\" id=\"tab%s\">Profile</span></a>"
 #ifdef USE_HISTOGRAMS
 						"<a href=\"/histograms\"><span class=\"tab\" id=\"tab%s\">Histograms</span></a>"
 #endif
@@ -843,7 +1202,9 @@ http_create_response (
 				timestamp,
 				tab == HTTP_TAB_GENERAL_INFORMATION ? "top" : "bottom",
 				tab == HTTP_TAB_INTERFACES ? "top" : "bottom",
-				tab == HTTP_TAB_TRANSPORTS ? "top" : "bottom"
+				tab == HTTP_TAB_TRANSPORTS ? "top" : "bottom",
+				tab == HTTP_TAB_EVENTS ? "top" : "bottom",
+				tab == HTTP_TAB_PROFILE ? "top" : "bottom"
 #ifdef USE_HISTOGRAMS
 			       ,tab == HTTP_TAB_HISTOGRAMS ? "top" : "bottom"
 #endif
@@ -877,8 +1238,7 @@ robots_callback (
 	PGM_GNUC_UNUSED const char*restrict path
         )
 {
-	http_set_content_type (connection, "text/plain");
-        http_set_static_response (connection, WWW_ROBOTS_TXT, strlen(WWW_ROBOTS_TXT));
+        http_set_static_response (connection, HTTP_STATIC_ROBOTS_TXT);
 }
 
 static
@@ -888,8 +1248,7 @@ css_callback (
 	PGM_GNUC_UNUSED const char*restrict path
         )
 {       
-	http_set_content_type (connection, "text/css");
-        http_set_static_response (connection, WWW_BASE_CSS, strlen(WWW_BASE_CSS));
+        http_set_static_response (connection, HTTP_STATIC_BASE_CSS);
 }
 
 static
@@ -1073,6 +1432,353 @@ histograms_callback (
 	http_finalize_response (connection, response);
 }
 
+/* most recent events of the binary trace, newest first, /events.N selects the
+ * count.  times are shown as age before the page timestamp.
+ */
+
+static
+void
+events_callback (
+	struct http_connection_t*restrict connection,
+	const char*		 restrict path
+        )
+{
+	unsigned len = HTTP_EVENTS_DEFAULT;
+	if ('.' == path[ strlen ("/events") ]) {
+		len = (unsigned)atoi (path + strlen ("/events."));
+		if (0 == len || len > HTTP_EVENTS_MAX) {
+			http_set_static_response (connection, HTTP_STATIC_404_HTML);
+			return;
+		}
+	}
+
+	pgm_string_t* response = http_create_response ("Events", HTTP_TAB_EVENTS);
+	pgm_evtrace_event_t* events = pgm_new (pgm_evtrace_event_t, len);
+	const unsigned count = pgm_evtrace_read (events, len);
+	if (0 == count) {
+		pgm_string_append (response,	"<p>No events recorded, the trace is enabled by pgm_evtrace_init().</p>\n");
+		pgm_free (events);
+		http_finalize_response (connection, response);
+		return;
+	}
+
+	const pgm_time_t now = pgm_time_update_now();
+	pgm_string_append_printf (response,	"<div class=\"bubbly\">"
+						"\n<table cellspacing=\"0\">"
+						"<tr>"
+							"<th>Age</th>"
+							"<th>Thread</th>"
+							"<th>Event</th>"
+							"<th>TSI</th>"
+							"<th>Sequence</th>"
+							"<th>Argument</th>"
+						"</tr>");
+	for (unsigned i = count; i-- > 0; )
+	{
+		const pgm_evtrace_event_t* event = &events[ i ];
+		const pgm_time_t age = now > event->tstamp ? now - event->tstamp : 0;
+		char tsi[PGM_TSISTRLEN];
+		pgm_tsi_print_r (&event->tsi, tsi, sizeof (tsi));
+		const char* name = pgm_evtrace_name (event->id);
+		pgm_string_append_printf (response,	"<tr>"
+								"<td>-%u.%06u</td>"
+								"<td>%u</td>"
+								"<td>%s</td>"
+								"<td><a href=\"/%s\">%s</a></td>"
+								"<td>%" PRIu32 "</td>"
+								"<td>%u</td>"
+							"</tr>",
+					(unsigned)(age / 1000000), (unsigned)(age % 1000000),
+					event->thread,
+					name ? name : "unknown",
+					tsi, tsi,
+					event->sqn,
+					event->arg);
+	}
+	pgm_string_append (response,		"</table>\n"
+						"</div>");
+	pgm_free (events);
+	http_finalize_response (connection, response);
+}
+
+/* totals of each profiled stage with the mean cost per call and per packet.
+ */
+
+static
+void
+profile_callback (
+	struct http_connection_t*restrict connection,
+	PGM_GNUC_UNUSED const char*restrict path
+        )
+{
+	pgm_profile_stage_t stages[PGM_PROFILE_MAX];
+	pgm_string_t* response = http_create_response ("Profile", HTTP_TAB_PROFILE);
+	if (!pgm_profile_read (stages, PGM_PROFILE_MAX)) {
+		pgm_string_append (response,	"<p>No stages profiled, accounting is enabled by pgm_profile_init().</p>\n");
+		http_finalize_response (connection, response);
+		return;
+	}
+
+	const char* unit = pgm_profile_unit();
+	pgm_string_append_printf (response,	"<div class=\"bubbly\">"
+						"\n<table cellspacing=\"0\">"
+						"<tr>"
+							"<th>Stage</th>"
+							"<th>Calls</th>"
+							"<th>Packets</th>"
+							"<th>Total %s</th>"
+							"<th>%s/call</th>"
+							"<th>%s/packet</th>"
+						"</tr>",
+				unit, unit, unit);
+	for (unsigned i = 0; i < PGM_PROFILE_MAX; i++)
+	{
+		const pgm_profile_stage_t* stage = &stages[ i ];
+		pgm_string_append_printf (response,	"<tr>"
+								"<td>%s</td>"
+								"<td>%" PRIu64 "</td>"
+								"<td>%" PRIu64 "</td>"
+								"<td>%" PRIu64 "</td>"
+								"<td>%" PRIu64 "</td>"
+								"<td>%" PRIu64 "</td>"
+							"</tr>",
+					pgm_profile_name (i),
+					stage->calls,
+					stage->packets,
+					stage->cycles,
+					stage->calls ? stage->cycles / stage->calls : 0,
+					stage->packets ? stage->cycles / stage->packets : 0);
+	}
+	pgm_string_append (response,		"</table>\n"
+						"</div>");
+	http_finalize_response (connection, response);
+}
+
+/* the response has no length so that the body can follow on demand, framed
+ * by closing the connection.
+ */
+
+static
+void
+metrics_callback (
+	struct http_connection_t*restrict connection,
+	PGM_GNUC_UNUSED const char*restrict path
+        )
+{
+	pgm_string_t* response = pgm_string_new (NULL);
+	pgm_string_printf (response, "HTTP/1.1 %d %s\r\n"
+				     "Server: OpenPGM HTTP Server %u.%u.%u\r\n"
+				     "Content-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"
+				     "Connection: close\r\n"
+				     "\r\n",
+			   connection->status_code,
+			   connection->status_text,
+			   pgm_major_version, pgm_minor_version, pgm_micro_version
+			);
+	http_free_response (connection);
+	connection->buflen = response->len;
+	connection->buf = pgm_string_free (response, FALSE);
+	connection->metrics = http_metrics_snapshot ();
+}
+
+/* copy counters of every socket and peer, formatting nothing until all
+ * read-side sections are left.  counters are read word by word, as the
+ * transport pages do.
+ */
+
+static
+struct http_metrics_t*
+http_metrics_snapshot (void)
+{
+	struct http_metrics_t* metrics = pgm_new0 (struct http_metrics_t, 1);
+	unsigned peer_alloc = 0;
+
+	pgm_rwlock_reader_lock (&pgm_sock_list_lock);
+	const unsigned source_alloc = pgm_slist_length (pgm_sock_list);
+	if (source_alloc)
+		metrics->sources = pgm_new (struct http_metrics_source_t, source_alloc);
+	for (pgm_slist_t* list = pgm_sock_list; list; list = list->next)
+	{
+		pgm_sock_t* sock = list->data;
+		if (sock->can_send_data) {
+			struct http_metrics_source_t* source = &metrics->sources[ metrics->source_len++ ];
+			const pgm_txw_t* window = sock->window;
+			source->tsi = sock->tsi;
+			pgm_stats_snapshot (sock->cumulative_stats, PGM_STATS_BLOCKS, source->cumulative_stats);
+			source->bytes_buffered   = window ? pgm_txw_size (window) : 0;
+			source->packets_buffered = window ? pgm_txw_length (window) : 0;
+			source->mem_used	 = pgm_budget_used (&sock->budget);
+		}
+		if (!sock->can_recv_data)
+			continue;
+		const uint32_t epoch = pgm_peers_read_lock (sock);
+		for (pgm_list_t* peers_list = sock->peers_list;
+		     peers_list;
+		     peers_list = peers_list->next)
+		{
+			const pgm_peer_t* receiver = peers_list->data;
+			const pgm_rxw_t* window = receiver->window;
+			if (metrics->peer_len == peer_alloc) {
+				peer_alloc = peer_alloc ? (2 * peer_alloc) : 64;
+				metrics->peers = pgm_realloc (metrics->peers, peer_alloc * sizeof(struct http_metrics_peer_t));
+			}
+			struct http_metrics_peer_t* peer = &metrics->peers[ metrics->peer_len++ ];
+			peer->tsi		= receiver->tsi;
+			peer->transport_tsi	= sock->tsi;
+			pgm_stats_snapshot (&receiver->cumulative_stats, 1, peer->cumulative_stats);
+			peer->cumulative_losses	= window->cumulative_losses;
+			peer->bytes_delivered	= window->bytes_delivered;
+			peer->msgs_delivered	= window->msgs_delivered;
+			peer->outstanding_naks	= window->nak_backoff_queue.length +
+						  window->wait_ncf_queue.length +
+						  window->wait_data_queue.length;
+			peer->min_fill_time	= window->min_fill_time;
+			peer->max_fill_time	= window->max_fill_time;
+			peer->min_fail_time	= receiver->min_fail_time;
+			peer->max_fail_time	= receiver->max_fail_time;
+		}
+		pgm_peers_read_unlock (sock, epoch);
+	}
+	pgm_rwlock_reader_unlock (&pgm_sock_list_lock);
+
+/* process-wide allocations */
+	struct pgm_mem_subsys_stats_t mem_stats[PGM_MEM_SUBSYS_MAX];
+	pgm_mem_get_subsys_stats (mem_stats, PGM_N_ELEMENTS(mem_stats));
+	for (unsigned i = 0; i < PGM_MEM_SUBSYS_MAX; i++) {
+		struct http_metrics_memory_t* memory = &metrics->memory[ i ];
+		memory->calls = mem_stats[ i ].calls;
+		memory->bytes = mem_stats[ i ].bytes;
+		sprintf (memory->labels, "subsystem=\"%s\"", pgm_mem_subsys_name (i));
+	}
+
+/* kernels selected at pgm_init() */
+	const char* name;
+	name = pgm_checksum_kernel (TRUE, &metrics->kernels[ HTTP_KERNEL_CHECKSUM_SMALL ].nsecs);
+	snprintf (metrics->kernels[ HTTP_KERNEL_CHECKSUM_SMALL ].labels,
+		  sizeof (metrics->kernels[ HTTP_KERNEL_CHECKSUM_SMALL ].labels),
+		  "function=\"checksum\",max_len=\"%u\",kernel=\"%s\"", PGM_CSUM_SMALL_LEN, name);
+	name = pgm_checksum_kernel (FALSE, &metrics->kernels[ HTTP_KERNEL_CHECKSUM_LARGE ].nsecs);
+	snprintf (metrics->kernels[ HTTP_KERNEL_CHECKSUM_LARGE ].labels,
+		  sizeof (metrics->kernels[ HTTP_KERNEL_CHECKSUM_LARGE ].labels),
+		  "function=\"checksum\",max_len=\"%u\",kernel=\"%s\"", UINT16_MAX, name);
+	name = pgm_rs_kernel (&metrics->kernels[ HTTP_KERNEL_REED_SOLOMON ].nsecs);
+	snprintf (metrics->kernels[ HTTP_KERNEL_REED_SOLOMON ].labels,
+		  sizeof (metrics->kernels[ HTTP_KERNEL_REED_SOLOMON ].labels),
+		  "function=\"reed_solomon\",max_len=\"%u\",kernel=\"%s\"", UINT16_MAX, name ? name : "UNKNOWN");
+
+/* labels */
+	for (unsigned i = 0; i < metrics->source_len; i++) {
+		struct http_metrics_source_t* source = &metrics->sources[ i ];
+		char tsi[ PGM_TSISTRLEN ];
+		pgm_tsi_print_r (&source->tsi, tsi, sizeof(tsi));
+		sprintf (source->labels, "tsi=\"%s\"", tsi);
+	}
+	for (unsigned i = 0; i < metrics->peer_len; i++) {
+		struct http_metrics_peer_t* peer = &metrics->peers[ i ];
+		char tsi[ PGM_TSISTRLEN ], transport_tsi[ PGM_TSISTRLEN ];
+		pgm_tsi_print_r (&peer->tsi, tsi, sizeof(tsi));
+		pgm_tsi_print_r (&peer->transport_tsi, transport_tsi, sizeof(transport_tsi));
+		sprintf (peer->labels, "tsi=\"%s\",transport=\"%s\"", tsi, transport_tsi);
+	}
+	return metrics;
+}
+
+static
+void
+http_metrics_free (
+	struct http_metrics_t*	metrics
+	)
+{
+	if (metrics->sources)
+		pgm_free (metrics->sources);
+	if (metrics->peers)
+		pgm_free (metrics->peers);
+	pgm_free (metrics);
+}
+
+/* replace the drained buffer with the next chunk of metric families,
+ * finishing with the EOF marker.
+ */
+
+static
+void
+http_metrics_render (
+	struct http_connection_t*	connection
+	)
+{
+	struct http_metrics_t* metrics = connection->metrics;
+	const unsigned source_families = PGM_N_ELEMENTS(http_source_metrics);
+	const unsigned peer_families = source_families + PGM_N_ELEMENTS(http_peer_metrics);
+	const unsigned memory_families = peer_families + PGM_N_ELEMENTS(http_memory_metrics);
+	const unsigned families = memory_families + PGM_N_ELEMENTS(http_kernel_metrics);
+	pgm_string_t* chunk = pgm_string_new (NULL);
+
+	while (chunk->len < HTTP_METRICS_CHUNK)
+	{
+		if (metrics->family == families) {
+			pgm_string_append (chunk, "# EOF\n");
+			http_metrics_free (metrics);
+			connection->metrics = NULL;
+			break;
+		}
+
+		const struct http_metric_t* metric;
+		unsigned rows;
+		if (metrics->family < source_families) {
+			metric = &http_source_metrics[ metrics->family ];
+			rows = metrics->source_len;
+		} else if (metrics->family < peer_families) {
+			metric = &http_peer_metrics[ metrics->family - source_families ];
+			rows = metrics->peer_len;
+		} else if (metrics->family < memory_families) {
+			metric = &http_memory_metrics[ metrics->family - peer_families ];
+			rows = PGM_MEM_SUBSYS_MAX;
+		} else {
+			metric = &http_kernel_metrics[ metrics->family - memory_families ];
+			rows = HTTP_KERNEL_MAX;
+		}
+		if (0 == metrics->row) {
+			pgm_string_append_printf (chunk, "# TYPE %s %s\n"
+							 "# HELP %s %s.\n",
+						  metric->name, metric->is_gauge ? "gauge" : "counter",
+						  metric->name, metric->help);
+		}
+		if (metrics->row == rows) {
+			metrics->family++;
+			metrics->row = 0;
+			continue;
+		}
+
+		const char* row;
+		const char* labels;
+		if (metrics->family < source_families) {
+			row = (const char*)&metrics->sources[ metrics->row ];
+			labels = metrics->sources[ metrics->row ].labels;
+		} else if (metrics->family < peer_families) {
+			row = (const char*)&metrics->peers[ metrics->row ];
+			labels = metrics->peers[ metrics->row ].labels;
+		} else if (metrics->family < memory_families) {
+			row = (const char*)&metrics->memory[ metrics->row ];
+			labels = metrics->memory[ metrics->row ].labels;
+		} else {
+			row = (const char*)&metrics->kernels[ metrics->row ];
+			labels = metrics->kernels[ metrics->row ].labels;
+		}
+		uint64_t value;
+		memcpy (&value, row + metric->offset, sizeof(value));
+		pgm_string_append_printf (chunk, "%s%s{%s} %" PRIu64 "\n",
+					  metric->name, metric->is_gauge ? "" : "_total",
+					  labels, value);
+		metrics->row++;
+	}
+
+	if (connection->buflen)
+		pgm_free (connection->buf);
+	connection->buflen = chunk->len;
+	connection->bufoff = 0;
+	connection->buf = pgm_string_free (chunk, FALSE);
+}
+
 static
 void
 default_callback (
@@ -1080,6 +1786,13 @@ default_callback (
 	const char*		 restrict path
         )
 {
+	if (0 == strncmp (path, "/events.", strlen ("/events.")) &&
+	    0 != atoi (path + strlen ("/events.")))
+	{
+		events_callback (connection, path);
+		return;
+	}
+
 	pgm_tsi_t tsi;
 	const int count = sscanf (path, "/%hhu.%hhu.%hhu.%hhu.%hhu.%hhu.%hu",
 				(unsigned char*)&tsi.gsi.identifier[0],
@@ -1096,8 +1809,7 @@ default_callback (
 		if (!retval) return;
 	}
 
-	http_set_status (connection, 404, "Not Found");
-	http_set_static_response (connection, WWW_404_HTML, strlen(WWW_404_HTML));
+	http_set_static_response (connection, HTTP_STATIC_404_HTML);
 }
 
 static
@@ -1124,16 +1836,21 @@ http_tsi_response (
 			break;
 		}
 
-/* check receivers */
-		pgm_rwlock_reader_lock (&list_sock->peers_lock);
-		pgm_peer_t* receiver = pgm_hashtable_lookup (list_sock->peers_hashtable, tsi);
-		if (receiver) {
-			const int retval = http_receiver_response (connection, list_sock, receiver);
-			pgm_rwlock_reader_unlock (&list_sock->peers_lock);
-			pgm_rwlock_reader_unlock (&pgm_sock_list_lock);
-			return retval;
+/* check receivers, the peer table belongs to the receive thread */
+		const uint32_t epoch = pgm_peers_read_lock (list_sock);
+		for (pgm_list_t* peers_list = list_sock->peers_list;
+		     peers_list;
+		     peers_list = peers_list->next)
+		{
+			pgm_peer_t* receiver = peers_list->data;
+			if (pgm_tsi_equal (tsi, &receiver->tsi)) {
+				const int retval = http_receiver_response (connection, list_sock, receiver);
+				pgm_peers_read_unlock (list_sock, epoch);
+				pgm_rwlock_reader_unlock (&pgm_sock_list_lock);
+				return retval;
+			}
 		}
-		pgm_rwlock_reader_unlock (&list_sock->peers_lock);
+		pgm_peers_read_unlock (list_sock, epoch);
 
 		list = next;
 	}
@@ -1170,11 +1887,12 @@ http_tsi_response (
 	const pgm_time_t ihb_min = sock->spm_heartbeat_len ? sock->spm_heartbeat_interval[ 1 ] : 0;
 	const pgm_time_t ihb_max = sock->spm_heartbeat_len ? sock->spm_heartbeat_interval[ sock->spm_heartbeat_len - 1 ] : 0;
 
-	char spm_path[INET6_ADDRSTRLEN];
-	getnameinfo ((struct sockaddr*)&sock->recv_gsr[0].gsr_source, pgm_sockaddr_len ((struct sockaddr*)&sock->recv_gsr[0].gsr_source),
-		     spm_path, sizeof(spm_path),
-		     NULL, 0,
-		     NI_NUMERICHOST);
+	char spm_path[INET6_ADDRSTRLEN] = "";
+	if (sock->recv_gsr_len > 0)
+		getnameinfo ((struct sockaddr*)&sock->recv_gsr[0].gsr_source, pgm_sockaddr_len ((struct sockaddr*)&sock->recv_gsr[0].gsr_source),
+			     spm_path, sizeof(spm_path),
+			     NULL, 0,
+			     NI_NUMERICHOST);
 
 	pgm_string_t* response = http_create_response (title, HTTP_TAB_TRANSPORTS);
 	pgm_string_append_printf (response,	"<div class=\"heading\">"
@@ -1199,14 +1917,14 @@ http_tsi_response (
 
 	if (sock->peers_list)
 	{
-		pgm_rwlock_reader_lock (&sock->peers_lock);
+		const uint32_t epoch = pgm_peers_read_lock (sock);
 		pgm_list_t* peers_list = sock->peers_list;
 		while (peers_list) {
 			pgm_list_t* next = peers_list->next;
 			http_each_receiver (sock, peers_list->data, response);
 			peers_list = next;
 		}
-		pgm_rwlock_reader_unlock (&sock->peers_lock);
+		pgm_peers_read_unlock (sock, epoch);
 	}
 	else
 	{
@@ -1287,61 +2005,63 @@ http_tsi_response (
 /* performance information */
 
 	const pgm_txw_t* window = sock->window;
+	uint64_t stats[PGM_STATS_COUNTERS];
+	pgm_stats_snapshot (sock->cumulative_stats, PGM_STATS_BLOCKS, stats);
 	pgm_string_append_printf (response,	"\n<h2>Performance information</h2>"
 						"\n<table>"
 						"<tr>"
-							"<th>Data bytes sent</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>Data bytes sent</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>Data packets sent</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>Data packets sent</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>Bytes buffered</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>Bytes buffered</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>Packets buffered</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>Packets buffered</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>Bytes sent</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>Bytes sent</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>Raw NAKs received</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>Raw NAKs received</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>Checksum errors</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>Checksum errors</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>Malformed NAKs</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>Malformed NAKs</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>Packets discarded</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>Packets discarded</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>Bytes retransmitted</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>Bytes retransmitted</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>Packets retransmitted</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>Packets retransmitted</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>NAKs received</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>NAKs received</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>NAKs ignored</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>NAKs ignored</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>Transmission rate</th><td>%" GROUP_FORMAT PRIu32 " bps</td>"
+							"<th>Transmission rate</th><td>%" GROUP_FORMAT PRIu64 " bps</td>"
 						"</tr><tr>"
-							"<th>NNAK packets received</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>NNAK packets received</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>NNAKs received</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>NNAKs received</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>Malformed NNAKs</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>Malformed NNAKs</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr>"
 						"</table>\n",
-						sock->cumulative_stats[PGM_PC_SOURCE_DATA_BYTES_SENT],
-						sock->cumulative_stats[PGM_PC_SOURCE_DATA_MSGS_SENT],
-						window ? (uint32_t)pgm_txw_size (window) : 0,	/* minus IP & any UDP header */
-						window ? (uint32_t)pgm_txw_length (window) : 0,
-						sock->cumulative_stats[PGM_PC_SOURCE_BYTES_SENT],
-						sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_NAKS_RECEIVED],
-						sock->cumulative_stats[PGM_PC_SOURCE_CKSUM_ERRORS],
-						sock->cumulative_stats[PGM_PC_SOURCE_MALFORMED_NAKS],
-						sock->cumulative_stats[PGM_PC_SOURCE_PACKETS_DISCARDED],
-						sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_BYTES_RETRANSMITTED],
-						sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_MSGS_RETRANSMITTED],
-						sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_NAKS_RECEIVED],
-						sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_NAKS_IGNORED],
-						sock->cumulative_stats[PGM_PC_SOURCE_TRANSMISSION_CURRENT_RATE],
-						sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_NNAK_PACKETS_RECEIVED],
-						sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_NNAKS_RECEIVED],
-						sock->cumulative_stats[PGM_PC_SOURCE_NNAK_ERRORS]);
+						stats[PGM_PC_SOURCE_DATA_BYTES_SENT],
+						stats[PGM_PC_SOURCE_DATA_MSGS_SENT],
+						window ? (uint64_t)pgm_txw_size (window) : 0,	/* minus IP & any UDP header */
+						window ? (uint64_t)pgm_txw_length (window) : 0,
+						stats[PGM_PC_SOURCE_BYTES_SENT],
+						stats[PGM_PC_SOURCE_SELECTIVE_NAKS_RECEIVED],
+						stats[PGM_PC_SOURCE_CKSUM_ERRORS],
+						stats[PGM_PC_SOURCE_MALFORMED_NAKS],
+						stats[PGM_PC_SOURCE_PACKETS_DISCARDED],
+						stats[PGM_PC_SOURCE_SELECTIVE_BYTES_RETRANSMITTED],
+						stats[PGM_PC_SOURCE_SELECTIVE_MSGS_RETRANSMITTED],
+						stats[PGM_PC_SOURCE_SELECTIVE_NAKS_RECEIVED],
+						stats[PGM_PC_SOURCE_SELECTIVE_NAKS_IGNORED],
+						stats[PGM_PC_SOURCE_TRANSMISSION_CURRENT_RATE],
+						stats[PGM_PC_SOURCE_SELECTIVE_NNAK_PACKETS_RECEIVED],
+						stats[PGM_PC_SOURCE_SELECTIVE_NNAKS_RECEIVED],
+						stats[PGM_PC_SOURCE_NNAK_ERRORS]);
 
 	pgm_rwlock_reader_unlock (&pgm_sock_list_lock);
 	http_finalize_response (connection, response);
@@ -1491,6 +2211,8 @@ http_receiver_response (
 	const uint32_t outstanding_naks = window->nak_backoff_queue.length +
 					  window->wait_ncf_queue.length +
 					  window->wait_data_queue.length;
+	uint64_t stats[PGM_STATS_COUNTERS];
+	pgm_stats_snapshot (&peer->cumulative_stats, 1, stats);
 
 	time_t last_activity_time;
 	pgm_time_since_epoch (&peer->last_packet, &last_activity_time);
@@ -1564,55 +2286,55 @@ http_receiver_response (
 	pgm_string_append_printf (response,	"\n<h2>Performance information</h2>"
 						"\n<table>"
 						"<tr>"
-							"<th>Data bytes received</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>Data bytes received</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>Data packets received</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>Data packets received</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>NAK failures</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>NAK failures</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>Bytes received</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>Bytes received</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>Checksum errors</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>Checksum errors</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>Malformed SPMs</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>Malformed SPMs</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>Malformed ODATA</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>Malformed ODATA</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>Malformed RDATA</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>Malformed RDATA</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>Malformed NCFs</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>Malformed NCFs</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>Packets discarded</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>Packets discarded</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>Losses</th><td>%" GROUP_FORMAT PRIu32 "</td>"	/* detected missed packets */
+							"<th>Losses</th><td>%" GROUP_FORMAT PRIu64 "</td>"	/* detected missed packets */
 						"</tr><tr>"
-							"<th>Bytes delivered to app</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>Bytes delivered to app</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>Packets delivered to app</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>Packets delivered to app</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>Duplicate SPMs</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>Duplicate SPMs</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>Duplicate ODATA/RDATA</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>Duplicate ODATA/RDATA</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>NAK packets sent</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>NAK packets sent</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>NAKs sent</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>NAKs sent</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>NAKs retransmitted</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>NAKs retransmitted</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>NAKs failed</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>NAKs failed</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>NAKs failed due to RXW advance</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>NAKs failed due to RXW advance</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>NAKs failed due to NCF retries</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>NAKs failed due to NCF retries</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>NAKs failed due to DATA retries</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>NAKs failed due to DATA retries</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>NAK failures delivered to app</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>NAK failures delivered to app</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>NAKs suppressed</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>NAKs suppressed</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
-							"<th>Malformed NAKs</th><td>%" GROUP_FORMAT PRIu32 "</td>"
+							"<th>Malformed NAKs</th><td>%" GROUP_FORMAT PRIu64 "</td>"
 						"</tr><tr>"
 							"<th>Outstanding NAKs</th><td>%" GROUP_FORMAT PRIu32 "</td>"
 						"</tr><tr>"
@@ -1637,41 +2359,41 @@ http_receiver_response (
 							"<th>NAK max retransmit count</th><td>%" GROUP_FORMAT PRIu32 "</td>"
 						"</tr>"
 						"</table>\n",
-						peer->cumulative_stats[PGM_PC_RECEIVER_DATA_BYTES_RECEIVED],
-						peer->cumulative_stats[PGM_PC_RECEIVER_DATA_MSGS_RECEIVED],
-						peer->cumulative_stats[PGM_PC_RECEIVER_NAK_FAILURES],
-						peer->cumulative_stats[PGM_PC_RECEIVER_BYTES_RECEIVED],
-						sock->cumulative_stats[PGM_PC_SOURCE_CKSUM_ERRORS],
-						peer->cumulative_stats[PGM_PC_RECEIVER_MALFORMED_SPMS],
-						peer->cumulative_stats[PGM_PC_RECEIVER_MALFORMED_ODATA],
-						peer->cumulative_stats[PGM_PC_RECEIVER_MALFORMED_RDATA],
-						peer->cumulative_stats[PGM_PC_RECEIVER_MALFORMED_NCFS],
-						peer->cumulative_stats[PGM_PC_RECEIVER_PACKETS_DISCARDED],
+						stats[PGM_PC_RECEIVER_DATA_BYTES_RECEIVED],
+						stats[PGM_PC_RECEIVER_DATA_MSGS_RECEIVED],
+						stats[PGM_PC_RECEIVER_NAK_FAILURES],
+						stats[PGM_PC_RECEIVER_BYTES_RECEIVED],
+						pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_CKSUM_ERRORS),
+						stats[PGM_PC_RECEIVER_MALFORMED_SPMS],
+						stats[PGM_PC_RECEIVER_MALFORMED_ODATA],
+						stats[PGM_PC_RECEIVER_MALFORMED_RDATA],
+						stats[PGM_PC_RECEIVER_MALFORMED_NCFS],
+						stats[PGM_PC_RECEIVER_PACKETS_DISCARDED],
 						window->cumulative_losses,
 						window->bytes_delivered,
 						window->msgs_delivered,
-						peer->cumulative_stats[PGM_PC_RECEIVER_DUP_SPMS],
-						peer->cumulative_stats[PGM_PC_RECEIVER_DUP_DATAS],
-						peer->cumulative_stats[PGM_PC_RECEIVER_SELECTIVE_NAK_PACKETS_SENT],
-						peer->cumulative_stats[PGM_PC_RECEIVER_SELECTIVE_NAKS_SENT],
-						peer->cumulative_stats[PGM_PC_RECEIVER_SELECTIVE_NAKS_RETRANSMITTED],
-						peer->cumulative_stats[PGM_PC_RECEIVER_SELECTIVE_NAKS_FAILED],
-						peer->cumulative_stats[PGM_PC_RECEIVER_NAKS_FAILED_RXW_ADVANCED],
-						peer->cumulative_stats[PGM_PC_RECEIVER_NAKS_FAILED_NCF_RETRIES_EXCEEDED],
-						peer->cumulative_stats[PGM_PC_RECEIVER_NAKS_FAILED_DATA_RETRIES_EXCEEDED],
-						peer->cumulative_stats[PGM_PC_RECEIVER_NAK_FAILURES_DELIVERED],
-						peer->cumulative_stats[PGM_PC_RECEIVER_SELECTIVE_NAKS_SUPPRESSED],
-						peer->cumulative_stats[PGM_PC_RECEIVER_NAK_ERRORS],
+						stats[PGM_PC_RECEIVER_DUP_SPMS],
+						stats[PGM_PC_RECEIVER_DUP_DATAS],
+						stats[PGM_PC_RECEIVER_SELECTIVE_NAK_PACKETS_SENT],
+						stats[PGM_PC_RECEIVER_SELECTIVE_NAKS_SENT],
+						stats[PGM_PC_RECEIVER_SELECTIVE_NAKS_RETRANSMITTED],
+						stats[PGM_PC_RECEIVER_SELECTIVE_NAKS_FAILED],
+						stats[PGM_PC_RECEIVER_NAKS_FAILED_RXW_ADVANCED],
+						stats[PGM_PC_RECEIVER_NAKS_FAILED_NCF_RETRIES_EXCEEDED],
+						stats[PGM_PC_RECEIVER_NAKS_FAILED_DATA_RETRIES_EXCEEDED],
+						stats[PGM_PC_RECEIVER_NAK_FAILURES_DELIVERED],
+						stats[PGM_PC_RECEIVER_SELECTIVE_NAKS_SUPPRESSED],
+						stats[PGM_PC_RECEIVER_NAK_ERRORS],
 						outstanding_naks,
 						last_activity,
 						window->min_fill_time,
-						peer->cumulative_stats[PGM_PC_RECEIVER_NAK_SVC_TIME_MEAN],
+						(uint32_t)stats[PGM_PC_RECEIVER_NAK_SVC_TIME_MEAN],
 						window->max_fill_time,
 						peer->min_fail_time,
-						peer->cumulative_stats[PGM_PC_RECEIVER_NAK_FAIL_TIME_MEAN],
+						(uint32_t)stats[PGM_PC_RECEIVER_NAK_FAIL_TIME_MEAN],
 						peer->max_fail_time,
 						window->min_nak_transmit_count,
-						peer->cumulative_stats[PGM_PC_RECEIVER_TRANSMIT_MEAN],
+						(uint32_t)stats[PGM_PC_RECEIVER_TRANSMIT_MEAN],
 						window->max_nak_transmit_count);
 	http_finalize_response (connection, response);
 	return 0;
@@ -124,6 +124,93 @@ START_TEST (test_shutdown_fail_001)
 }
 END_TEST
 
+/* target:
+ *	void
+ *	http_metrics_render (
+ *		struct http_connection_t*	connection
+ *	)
+ */
+
+static
+pgm_string_t*
+render_all (
+	struct http_connection_t*	connection,
+	unsigned*			chunks
+	)
+{
+	pgm_string_t* exposition = pgm_string_new (NULL);
+	*chunks = 0;
+	while (connection->metrics) {
+		http_metrics_render (connection);
+		fail_unless (connection->buflen <= HTTP_METRICS_CHUNK + 1024, "chunk overrun");
+		pgm_string_append (exposition, connection->buf);
+		(*chunks)++;
+	}
+	pgm_free (connection->buf);
+	return exposition;
+}
+
+/* no sockets */
+START_TEST (test_metrics_pass_001)
+{
+	struct http_connection_t connection;
+	unsigned chunks;
+	memset (&connection, 0, sizeof(connection));
+	connection.metrics = http_metrics_snapshot ();
+	fail_if (NULL == connection.metrics, "snapshot failed");
+	pgm_string_t* exposition = render_all (&connection, &chunks);
+	fail_unless (1 == chunks, "too many chunks");
+	fail_unless (NULL != strstr (exposition->str, "# TYPE pgm_source_data_bytes counter\n"), "family missing");
+	fail_unless (NULL != strstr (exposition->str, "# TYPE pgm_receiver_outstanding_naks gauge\n"), "family missing");
+	fail_unless (NULL != strstr (exposition->str, "# EOF\n"), "EOF missing");
+	fail_unless ('\n' == exposition->str[ exposition->len - 1 ], "unterminated");
+	pgm_string_free (exposition, TRUE);
+}
+END_TEST
+
+/* many peers render across chunks */
+START_TEST (test_metrics_pass_002)
+{
+	struct http_connection_t connection;
+	struct http_metrics_t* metrics = pgm_new0 (struct http_metrics_t, 1);
+	unsigned chunks;
+	memset (&connection, 0, sizeof(connection));
+	metrics->source_len = 1;
+	metrics->sources = pgm_new0 (struct http_metrics_source_t, 1);
+	metrics->sources[0].cumulative_stats[PGM_PC_SOURCE_DATA_BYTES_SENT] = 1234;
+	strcpy (metrics->sources[0].labels, "tsi=\"1.2.3.4.5.6.7000\"");
+	metrics->peer_len = 2000;
+	metrics->peers = pgm_new0 (struct http_metrics_peer_t, metrics->peer_len);
+	for (unsigned i = 0; i < metrics->peer_len; i++) {
+		metrics->peers[i].outstanding_naks = i;
+		sprintf (metrics->peers[i].labels, "tsi=\"1.2.3.4.5.6.%u\",transport=\"1.2.3.4.5.6.7000\"", i);
+	}
+	connection.metrics = metrics;
+	pgm_string_t* exposition = render_all (&connection, &chunks);
+	fail_unless (chunks > 1, "not incremental");
+	fail_unless (NULL != strstr (exposition->str, "pgm_source_data_bytes_total{tsi=\"1.2.3.4.5.6.7000\"} 1234\n"), "counter missing");
+	fail_unless (NULL != strstr (exposition->str, "pgm_receiver_outstanding_naks{tsi=\"1.2.3.4.5.6.1999\",transport=\"1.2.3.4.5.6.7000\"} 1999\n"), "gauge missing");
+	fail_unless (NULL != strstr (exposition->str, "# EOF\n"), "EOF missing");
+	pgm_string_free (exposition, TRUE);
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	http_is_keep_alive (
+ *		const char*	request
+ *	)
+ */
+
+START_TEST (test_keep_alive_pass_001)
+{
+	fail_unless (TRUE == http_is_keep_alive ("GET / HTTP/1.1\r\nHost: localhost\r\n"), "HTTP/1.1 closed");
+	fail_unless (FALSE == http_is_keep_alive ("GET / HTTP/1.1\r\nConnection: close\r\n"), "close ignored");
+	fail_unless (FALSE == http_is_keep_alive ("GET / HTTP/1.0\r\n"), "HTTP/1.0 kept alive");
+	fail_unless (TRUE == http_is_keep_alive ("GET / HTTP/1.0\r\nconnection:  Keep-Alive\r\n"), "keep-alive ignored");
+}
+END_TEST
+
 
 static
 Suite*
@@ -144,6 +231,15 @@ make_test_suite (void)
 	tcase_add_test (tc_shutdown, test_shutdown_pass_002);
 	tcase_add_test (tc_shutdown, test_shutdown_fail_001);
 
+	TCase* tc_metrics = tcase_create ("metrics");
+	suite_add_tcase (s, tc_metrics);
+	tcase_add_test (tc_metrics, test_metrics_pass_001);
+	tcase_add_test (tc_metrics, test_metrics_pass_002);
+
+	TCase* tc_keep_alive = tcase_create ("keep-alive");
+	suite_add_tcase (s, tc_keep_alive);
+	tcase_add_test (tc_keep_alive, test_keep_alive_pass_001);
+
 	return s;
 }
 
@@ -0,0 +1,414 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * Test impairment of datagrams: Gilbert-Elliott burst loss, duplication,
+ * reordering and delay, available in release builds.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <errno.h>
+#include <stdlib.h>
+#include <impl/i18n.h>
+#include <impl/framework.h>
+
+
+//#define IMPAIR_DEBUG
+
+#ifndef IMPAIR_DEBUG
+#	define PGM_DISABLE_ASSERT
+#endif
+
+#define IMPAIR_PPM		1000000
+#define IMPAIR_MAX_HELD		8192		/* datagrams, further held datagrams are lost */
+
+/* held datagram, on the list in order of release */
+
+struct impair_packet_t {
+	struct impair_packet_t*	next;
+	pgm_time_t		due;
+	struct sockaddr_storage	src;
+	struct sockaddr_storage	dst;
+	bool			flag;		/* of the caller */
+	size_t			len;
+	char			data[];
+};
+
+struct pgm_impair_t {
+	struct pgm_impair_req_t	req;
+	pgm_mutex_t		mutex;		/* transmit is called from any sending thread */
+	pgm_rand_t		rand_;
+	bool			is_bad;		/* Gilbert-Elliott state */
+	struct impair_packet_t*	held;
+	unsigned		held_len;
+	uint64_t		lost;
+	uint64_t		duplicated;
+	uint64_t		reordered;
+	uint64_t		delayed;
+};
+
+struct pgm_impair_req_t pgm_impair_env;
+
+/* TRUE with probability ppm parts per million, from the high bits of the
+ * generator which are better distributed than the low.
+ */
+
+static inline
+bool
+impair_chance (
+	struct pgm_impair_t* const	impair,
+	const uint32_t			ppm
+	)
+{
+	if (0 == ppm)
+		return FALSE;
+	return ((uint64_t)pgm_rand_int (&impair->rand_) * IMPAIR_PPM) >> 32 < ppm;
+}
+
+/* step the Gilbert-Elliott chain and draw the loss of one datagram.
+ */
+
+static
+bool
+impair_is_lost (
+	struct pgm_impair_t* const	impair
+	)
+{
+	if (impair->is_bad) {
+		if (impair_chance (impair, impair->req.ir_r))
+			impair->is_bad = FALSE;
+	} else {
+		if (impair_chance (impair, impair->req.ir_p))
+			impair->is_bad = TRUE;
+	}
+	return impair_chance (impair, impair->is_bad ? impair->req.ir_loss_bad : impair->req.ir_loss_good);
+}
+
+/* delay of one datagram, zero to pass now.
+ */
+
+static
+pgm_time_t
+impair_delay (
+	struct pgm_impair_t* const	impair,
+	const bool			is_reorder
+	)
+{
+	pgm_time_t delay = impair->req.ir_delay;
+
+	if (impair->req.ir_jitter > 0) {
+		const uint32_t jitter = pgm_rand_int (&impair->rand_) % (2 * impair->req.ir_jitter + 1);
+		delay = (delay + jitter > impair->req.ir_jitter) ? delay + jitter - impair->req.ir_jitter : 0;
+	}
+	if (is_reorder)
+		delay += impair->req.ir_reorder_delay;
+	return delay;
+}
+
+/* copy a datagram onto the held list.  caller holds impair::mutex.
+ */
+
+static
+void
+impair_hold (
+	struct pgm_impair_t* const restrict	impair,
+	const pgm_time_t			due,
+	const void*		    restrict	data,
+	const size_t				len,
+	const struct sockaddr*	    restrict	src,
+	const struct sockaddr*	    restrict	dst,
+	const bool				flag
+	)
+{
+	struct impair_packet_t *packet, **p;
+
+	if (PGM_UNLIKELY(impair->held_len >= IMPAIR_MAX_HELD)) {
+		impair->lost++;
+		return;
+	}
+	packet = pgm_malloc (sizeof (struct impair_packet_t) + len);
+	packet->due = due;
+	memset (&packet->src, 0, sizeof (packet->src));
+	if (NULL != src)
+		memcpy (&packet->src, src, pgm_sockaddr_len (src));
+	memcpy (&packet->dst, dst, pgm_sockaddr_len (dst));
+	packet->flag = flag;
+	packet->len = len;
+	memcpy (packet->data, data, len);
+/* after any held datagram due at the same time */
+	for (p = &impair->held; NULL != *p && !pgm_time_after ((*p)->due, due); p = &(*p)->next);
+	packet->next = *p;
+	*p = packet;
+	impair->held_len++;
+}
+
+/* parse PGM_IMPAIR, comma separated rx and tx directions, and key=value fields
+ * p, r, good, bad, dup, reorder in parts per million, and delay, jitter and
+ * reorder_delay in microseconds.  without a direction receive is impaired.
+ *
+ * returns TRUE on success, returns FALSE on unknown fields leaving req unchanged.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_impair_parse (
+	const char*		  restrict str,
+	struct pgm_impair_req_t* restrict req
+	)
+{
+	static const struct {
+		const char*	name;
+		size_t		offset;
+	} fields[] = {
+		{ "p",			offsetof (struct pgm_impair_req_t, ir_p) },
+		{ "r",			offsetof (struct pgm_impair_req_t, ir_r) },
+		{ "good",		offsetof (struct pgm_impair_req_t, ir_loss_good) },
+		{ "bad",		offsetof (struct pgm_impair_req_t, ir_loss_bad) },
+		{ "dup",		offsetof (struct pgm_impair_req_t, ir_duplicate) },
+		{ "reorder",		offsetof (struct pgm_impair_req_t, ir_reorder) },
+		{ "delay",		offsetof (struct pgm_impair_req_t, ir_delay) },
+		{ "jitter",		offsetof (struct pgm_impair_req_t, ir_jitter) },
+		{ "reorder_delay",	offsetof (struct pgm_impair_req_t, ir_reorder_delay) }
+	};
+	struct pgm_impair_req_t new_req;
+	const char* token = str;
+
+/* pre-conditions */
+	pgm_assert (NULL != str);
+	pgm_assert (NULL != req);
+
+	memset (&new_req, 0, sizeof (new_req));
+	while ('\0' != *token)
+	{
+		const size_t token_len = strcspn (token, ",");
+		const char* value = memchr (token, '=', token_len);
+		const size_t name_len = (NULL != value) ? (size_t)(value - token) : token_len;
+		unsigned i;
+
+		if (2 == name_len && NULL == value && 0 == strncmp (token, "rx", 2))
+			new_req.ir_direction |= PGM_IMPAIR_RX;
+		else if (2 == name_len && NULL == value && 0 == strncmp (token, "tx", 2))
+			new_req.ir_direction |= PGM_IMPAIR_TX;
+		else if (name_len > 0) {
+			if (NULL == value)
+				return FALSE;
+			for (i = 0; i < PGM_N_ELEMENTS(fields); i++)
+				if (strlen (fields[i].name) == name_len && 0 == strncmp (token, fields[i].name, name_len))
+					break;
+			if (PGM_N_ELEMENTS(fields) == i)
+				return FALSE;
+			if (value[1] < '0' || value[1] > '9')
+				return FALSE;
+			char* end;
+			const unsigned long ul = strtoul (value + 1, &end, 10);
+			if (end != token + token_len || ul > UINT32_MAX)
+				return FALSE;
+			*(uint32_t*)((char*)&new_req + fields[i].offset) = (uint32_t)ul;
+		}
+		token += token_len;
+		if (',' == *token)
+			token++;
+	}
+	if (0 == new_req.ir_direction)
+		new_req.ir_direction = PGM_IMPAIR_RX;
+	if (new_req.ir_p > IMPAIR_PPM || new_req.ir_r > IMPAIR_PPM ||
+	    new_req.ir_loss_good > IMPAIR_PPM || new_req.ir_loss_bad > IMPAIR_PPM ||
+	    new_req.ir_duplicate > IMPAIR_PPM || new_req.ir_reorder > IMPAIR_PPM)
+		return FALSE;
+	*req = new_req;
+	return TRUE;
+}
+
+/* TRUE when req has a direction and any impairment.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_impair_is_enabled (
+	const struct pgm_impair_req_t* const	req
+	)
+{
+	return (0 != req->ir_direction) &&
+	       (0 != req->ir_loss_good || (0 != req->ir_p && 0 != req->ir_loss_bad) ||
+		0 != req->ir_duplicate || 0 != req->ir_reorder ||
+		0 != req->ir_delay || 0 != req->ir_jitter);
+}
+
+PGM_GNUC_INTERNAL
+struct pgm_impair_t*
+pgm_impair_new (
+	const struct pgm_impair_req_t* const	req
+	)
+{
+	struct pgm_impair_t* impair;
+
+/* pre-conditions */
+	pgm_assert (NULL != req);
+
+	impair = pgm_new0 (struct pgm_impair_t, 1);
+	impair->req = *req;
+	pgm_mutex_init (&impair->mutex);
+	pgm_rand_create (&impair->rand_);
+	return impair;
+}
+
+/* held datagrams are discarded, counts traced under the direction name.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_impair_destroy (
+	struct pgm_impair_t* const	impair,
+	const char* const		name
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != impair);
+
+	pgm_trace (PGM_LOG_ROLE_NETWORK,_("Impaired %s: %" PRIu64 " lost, %" PRIu64 " duplicated, %" PRIu64 " reordered, %" PRIu64 " delayed."),
+		   name, impair->lost, impair->duplicated, impair->reordered, impair->delayed);
+	while (NULL != impair->held) {
+		struct impair_packet_t* packet = impair->held;
+		impair->held = packet->next;
+		pgm_free (packet);
+	}
+	pgm_mutex_free (&impair->mutex);
+	pgm_free (impair);
+}
+
+/* draw the impairment of one datagram from src to dst, a duplicate or the
+ * delayed datagram itself is copied with the caller's flag to be taken from
+ * pgm_impair_release() once due.
+ *
+ * returns TRUE when the datagram is to be passed now, FALSE when lost or held.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_impair_apply (
+	struct pgm_impair_t* const restrict	impair,
+	const void*		   restrict	data,
+	const size_t				len,
+	const struct sockaddr*	   restrict	src,		/* NULL on transmit */
+	const struct sockaddr*	   restrict	dst,
+	const bool				flag
+	)
+{
+	bool is_passed = TRUE;
+
+/* pre-conditions */
+	pgm_assert (NULL != impair);
+	pgm_assert (NULL != data);
+	pgm_assert (NULL != dst);
+
+	pgm_mutex_lock (&impair->mutex);
+	if (impair_is_lost (impair)) {
+		impair->lost++;
+		pgm_mutex_unlock (&impair->mutex);
+		return FALSE;
+	}
+	const pgm_time_t now = pgm_time_update_now();
+	const bool is_reorder = impair_chance (impair, impair->req.ir_reorder);
+	const pgm_time_t delay = impair_delay (impair, is_reorder);
+	if (delay > 0) {
+		impair_hold (impair, now + delay, data, len, src, dst, flag);
+		if (is_reorder)
+			impair->reordered++;
+		else
+			impair->delayed++;
+		is_passed = FALSE;
+	}
+	if (impair_chance (impair, impair->req.ir_duplicate)) {
+		impair_hold (impair, now + impair_delay (impair, FALSE), data, len, src, dst, flag);
+		impair->duplicated++;
+	}
+	pgm_mutex_unlock (&impair->mutex);
+	return is_passed;
+}
+
+/* take the next held datagram due by now into buf.
+ *
+ * returns datagram length, or zero when none is due.
+ */
+
+PGM_GNUC_INTERNAL
+size_t
+pgm_impair_release (
+	struct pgm_impair_t* const restrict	impair,
+	const pgm_time_t			now,
+	void*			   restrict	buf,
+	const size_t				buflen,
+	struct sockaddr_storage*   restrict	src,
+	struct sockaddr_storage*   restrict	dst,
+	bool*			   restrict	flag
+	)
+{
+	struct impair_packet_t* packet;
+	size_t len;
+
+/* pre-conditions */
+	pgm_assert (NULL != impair);
+	pgm_assert (NULL != buf);
+
+	if (NULL == impair->held)		/* unlocked peek */
+		return 0;
+	pgm_mutex_lock (&impair->mutex);
+	packet = impair->held;
+	if (NULL == packet || pgm_time_after (packet->due, now)) {
+		pgm_mutex_unlock (&impair->mutex);
+		return 0;
+	}
+	impair->held = packet->next;
+	impair->held_len--;
+	pgm_mutex_unlock (&impair->mutex);
+
+	len = MIN(packet->len, buflen);
+	memcpy (buf, packet->data, len);
+	if (NULL != src)
+		memcpy (src, &packet->src, sizeof (*src));
+	if (NULL != dst)
+		memcpy (dst, &packet->dst, sizeof (*dst));
+	if (NULL != flag)
+		*flag = packet->flag;
+	pgm_free (packet);
+	return len;
+}
+
+/* returns release time of the next held datagram, or zero when none are held.
+ */
+
+PGM_GNUC_INTERNAL
+pgm_time_t
+pgm_impair_expiry (
+	struct pgm_impair_t* const	impair
+	)
+{
+	pgm_time_t expiry = 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != impair);
+
+	pgm_mutex_lock (&impair->mutex);
+	if (NULL != impair->held)
+		expiry = impair->held->due;
+	pgm_mutex_unlock (&impair->mutex);
+	return expiry;
+}
+
+/* eof */
@@ -0,0 +1,331 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * unit tests for test impairment of datagrams.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <check.h>
+
+#include "impl/framework.h"
+
+#ifdef _WIN32
+#	define PGM_CHECK_NOFORK		1
+#endif
+
+
+/* mock state */
+#define TEST_PACKETS		100000
+
+static pgm_time_t mock_pgm_time_now = 0x1000;
+
+/* mock functions for external references */
+
+static
+pgm_time_t
+_mock_pgm_time_update_now (void)
+{
+	return mock_pgm_time_now;
+}
+
+static pgm_time_update_func mock_pgm_time_update_now = _mock_pgm_time_update_now;
+
+#define pgm_time_update_now	mock_pgm_time_update_now
+
+#define IMPAIR_DEBUG
+#include "impair.c"
+
+static
+void
+generate_addr (
+	struct sockaddr_storage*	addr,
+	const char*			ip
+	)
+{
+	struct sockaddr_in* sin = (struct sockaddr_in*)addr;
+	memset (addr, 0, sizeof(*addr));
+	sin->sin_family = AF_INET;
+	sin->sin_addr.s_addr = inet_addr (ip);
+}
+
+/* target:
+ *	bool
+ *	pgm_impair_parse (
+ *		const char*			str,
+ *		struct pgm_impair_req_t*	req
+ *		)
+ */
+
+START_TEST (test_parse_pass_001)
+{
+	struct pgm_impair_req_t req;
+	fail_unless (TRUE == pgm_impair_parse ("tx,p=10000,r=300000,bad=500000,dup=20,reorder=30,reorder_delay=4000,delay=2000,jitter=500", &req), "parse failed");
+	fail_unless (PGM_IMPAIR_TX == req.ir_direction, "direction");
+	fail_unless (10000 == req.ir_p, "p");
+	fail_unless (300000 == req.ir_r, "r");
+	fail_unless (0 == req.ir_loss_good, "good");
+	fail_unless (500000 == req.ir_loss_bad, "bad");
+	fail_unless (20 == req.ir_duplicate, "dup");
+	fail_unless (30 == req.ir_reorder, "reorder");
+	fail_unless (4000 == req.ir_reorder_delay, "reorder_delay");
+	fail_unless (2000 == req.ir_delay, "delay");
+	fail_unless (500 == req.ir_jitter, "jitter");
+	fail_unless (TRUE == pgm_impair_is_enabled (&req), "not enabled");
+}
+END_TEST
+
+/* receive without a direction, both with two */
+START_TEST (test_parse_pass_002)
+{
+	struct pgm_impair_req_t req;
+	fail_unless (TRUE == pgm_impair_parse ("good=1000", &req), "parse failed");
+	fail_unless (PGM_IMPAIR_RX == req.ir_direction, "direction");
+	fail_unless (1000 == req.ir_loss_good, "good");
+	fail_unless (TRUE == pgm_impair_is_enabled (&req), "not enabled");
+	fail_unless (TRUE == pgm_impair_parse ("rx,tx,delay=10", &req), "parse failed");
+	fail_unless ((PGM_IMPAIR_RX | PGM_IMPAIR_TX) == req.ir_direction, "direction");
+	fail_unless (TRUE == pgm_impair_parse ("rx", &req), "parse failed");
+	fail_unless (FALSE == pgm_impair_is_enabled (&req), "enabled");
+}
+END_TEST
+
+/* unknown fields, malformed values and probabilities above one leave req unchanged */
+START_TEST (test_parse_fail_001)
+{
+	static const char* invalid[] = {
+		"loss=10", "p", "p=", "p=10x", "good=1000001", "rx,delay=-1", "reorder=1,xx"
+	};
+	struct pgm_impair_req_t req;
+	fail_unless (TRUE == pgm_impair_parse ("delay=7", &req), "parse failed");
+	for (unsigned i = 0; i < G_N_ELEMENTS(invalid); i++) {
+		fail_unless (FALSE == pgm_impair_parse (invalid[i], &req), "parse succeeded");
+		fail_unless (PGM_IMPAIR_RX == req.ir_direction && 7 == req.ir_delay, "req changed");
+	}
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_impair_apply (
+ *		struct pgm_impair_t*		impair,
+ *		const void*			data,
+ *		const size_t			len,
+ *		const struct sockaddr*		src,
+ *		const struct sockaddr*		dst,
+ *		const bool			flag
+ *		)
+ */
+
+/* uniform loss in the good state */
+START_TEST (test_apply_pass_001)
+{
+	const struct pgm_impair_req_t req = {
+		.ir_direction	= PGM_IMPAIR_RX,
+		.ir_loss_good	= 100000		/* 10% */
+	};
+	struct sockaddr_storage src, dst;
+	generate_addr (&src, "172.16.0.1");
+	generate_addr (&dst, "239.192.0.1");
+	struct pgm_impair_t* impair = pgm_impair_new (&req);
+	fail_if (NULL == impair, "new failed");
+	const char data[] = "impair";
+	unsigned passed = 0;
+	for (unsigned i = 0; i < TEST_PACKETS; i++)
+		if (pgm_impair_apply (impair, data, sizeof(data), (struct sockaddr*)&src, (struct sockaddr*)&dst, FALSE))
+			passed++;
+	fail_unless (passed > TEST_PACKETS * 88 / 100 && passed < TEST_PACKETS * 92 / 100, "loss rate");
+	fail_unless (TEST_PACKETS - passed == impair->lost, "lost count");
+	fail_unless (0 == pgm_impair_expiry (impair), "held datagrams");
+	pgm_impair_destroy (impair, "test");
+}
+END_TEST
+
+/* Gilbert-Elliott bursts: stationary bad state p/(p+r) ≈ 9.1%, mean burst 1/r = 10 */
+START_TEST (test_apply_pass_002)
+{
+	const struct pgm_impair_req_t req = {
+		.ir_direction	= PGM_IMPAIR_RX,
+		.ir_p		= 10000,
+		.ir_r		= 100000,
+		.ir_loss_bad	= 1000000
+	};
+	struct sockaddr_storage src, dst;
+	generate_addr (&src, "172.16.0.1");
+	generate_addr (&dst, "239.192.0.1");
+	struct pgm_impair_t* impair = pgm_impair_new (&req);
+	const char data[] = "impair";
+	unsigned lost = 0, bursts = 0;
+	bool was_lost = FALSE;
+	for (unsigned i = 0; i < TEST_PACKETS; i++) {
+		const bool is_lost = !pgm_impair_apply (impair, data, sizeof(data), (struct sockaddr*)&src, (struct sockaddr*)&dst, FALSE);
+		if (is_lost) {
+			lost++;
+			if (!was_lost)
+				bursts++;
+		}
+		was_lost = is_lost;
+	}
+	fail_unless (lost > TEST_PACKETS * 6 / 100 && lost < TEST_PACKETS * 12 / 100, "loss rate");
+	fail_unless (bursts > 0 && lost / bursts >= 6 && lost / bursts <= 14, "burst length");
+	pgm_impair_destroy (impair, "test");
+}
+END_TEST
+
+/* target:
+ *	size_t
+ *	pgm_impair_release (
+ *		struct pgm_impair_t*		impair,
+ *		const pgm_time_t		now,
+ *		void*				buf,
+ *		const size_t			buflen,
+ *		struct sockaddr_storage*	src,
+ *		struct sockaddr_storage*	dst,
+ *		bool*				flag
+ *		)
+ */
+
+/* delayed datagrams are held until due in order, duplicates alongside */
+START_TEST (test_release_pass_001)
+{
+	const struct pgm_impair_req_t req = {
+		.ir_direction	= PGM_IMPAIR_TX,
+		.ir_duplicate	= 1000000,
+		.ir_delay	= 1000
+	};
+	struct sockaddr_storage dst, addr;
+	generate_addr (&dst, "239.192.0.1");
+	struct pgm_impair_t* impair = pgm_impair_new (&req);
+	char buf[ 64 ];
+	bool flag = FALSE;
+
+	mock_pgm_time_now = 0x1000;
+	fail_unless (FALSE == pgm_impair_apply (impair, "one", 4, NULL, (struct sockaddr*)&dst, TRUE), "passed");
+	mock_pgm_time_now += 10;
+	fail_unless (FALSE == pgm_impair_apply (impair, "two", 4, NULL, (struct sockaddr*)&dst, FALSE), "passed");
+	fail_unless (0x1000 + 1000 == pgm_impair_expiry (impair), "expiry");
+	fail_unless (0 == pgm_impair_release (impair, 0x1000 + 999, buf, sizeof(buf), NULL, &addr, &flag), "released early");
+	for (unsigned i = 0; i < 2; i++) {
+		fail_unless (4 == pgm_impair_release (impair, 0x1000 + 1000, buf, sizeof(buf), NULL, &addr, &flag), "release");
+		fail_unless (0 == strcmp ("one", buf) && TRUE == flag, "order");
+		fail_unless (0 == memcmp (&addr, &dst, sizeof(struct sockaddr_in)), "address");
+	}
+	fail_unless (0 == pgm_impair_release (impair, 0x1000 + 1000, buf, sizeof(buf), NULL, &addr, &flag), "released early");
+	for (unsigned i = 0; i < 2; i++) {
+		fail_unless (4 == pgm_impair_release (impair, 0x1000 + 1010, buf, sizeof(buf), NULL, &addr, &flag), "release");
+		fail_unless (0 == strcmp ("two", buf) && FALSE == flag, "order");
+	}
+	fail_unless (0 == pgm_impair_expiry (impair), "held datagrams");
+	fail_unless (2 == impair->duplicated && 2 == impair->delayed, "counts");
+	pgm_impair_destroy (impair, "test");
+}
+END_TEST
+
+/* reordered datagrams are overtaken by those passed after them */
+START_TEST (test_release_pass_002)
+{
+	const struct pgm_impair_req_t req = {
+		.ir_direction		= PGM_IMPAIR_RX,
+		.ir_reorder		= 500000,
+		.ir_reorder_delay	= 5000
+	};
+	struct sockaddr_storage src, dst, addr;
+	generate_addr (&src, "172.16.0.1");
+	generate_addr (&dst, "239.192.0.1");
+	struct pgm_impair_t* impair = pgm_impair_new (&req);
+	char buf[ 64 ];
+	unsigned passed = 0;
+
+	mock_pgm_time_now = 0x1000;
+	for (unsigned i = 0; i < 1000; i++) {
+		const uint32_t sqn = i;
+		if (pgm_impair_apply (impair, &sqn, sizeof(sqn), (struct sockaddr*)&src, (struct sockaddr*)&dst, FALSE))
+			passed++;
+		mock_pgm_time_now++;
+	}
+	fail_unless (passed > 400 && passed < 600, "reorder rate");
+	fail_unless (1000 - passed == impair->reordered, "reorder count");
+	uint32_t last = 0;
+	unsigned held = 0;
+	while (sizeof(uint32_t) == pgm_impair_release (impair, mock_pgm_time_now + 5000, buf, sizeof(buf), &addr, NULL, NULL)) {
+		uint32_t sqn;
+		memcpy (&sqn, buf, sizeof(sqn));
+		fail_unless (0 == held || sqn > last, "release order");
+		fail_unless (0 == memcmp (&addr, &src, sizeof(struct sockaddr_in)), "address");
+		last = sqn;
+		held++;
+	}
+	fail_unless (1000 - passed == held, "held count");
+	pgm_impair_destroy (impair, "test");
+}
+END_TEST
+
+
+static
+Suite*
+make_test_suite (void)
+{
+	Suite* s;
+
+	s = suite_create (__FILE__);
+
+	TCase* tc_parse = tcase_create ("parse");
+	suite_add_tcase (s, tc_parse);
+	tcase_add_test (tc_parse, test_parse_pass_001);
+	tcase_add_test (tc_parse, test_parse_pass_002);
+	tcase_add_test (tc_parse, test_parse_fail_001);
+
+	TCase* tc_apply = tcase_create ("apply");
+	suite_add_tcase (s, tc_apply);
+	tcase_add_test (tc_apply, test_apply_pass_001);
+	tcase_add_test (tc_apply, test_apply_pass_002);
+
+	TCase* tc_release = tcase_create ("release");
+	suite_add_tcase (s, tc_release);
+	tcase_add_test (tc_release, test_release_pass_001);
+	tcase_add_test (tc_release, test_release_pass_002);
+	return s;
+}
+
+static
+Suite*
+make_master_suite (void)
+{
+	Suite* s = suite_create ("Master");
+	return s;
+}
+
+int
+main (void)
+{
+	pgm_messages_init();
+	SRunner* sr = srunner_create (make_master_suite ());
+	srunner_add_suite (sr, make_test_suite ());
+	srunner_run_all (sr, CK_ENV);
+	int number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	pgm_messages_shutdown();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof */
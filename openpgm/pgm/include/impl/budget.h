@@ -0,0 +1,66 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * Memory budgets of window packet buffers.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if !defined (__PGM_IMPL_FRAMEWORK_H_INSIDE__) && !defined (PGM_COMPILATION)
+#	error "Only <framework.h> can be included directly."
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_BUDGET_H__
+#define __PGM_IMPL_BUDGET_H__
+
+typedef struct pgm_budget_t pgm_budget_t;
+
+#include <pgm/types.h>
+#include <pgm/atomic.h>
+
+PGM_BEGIN_DECLS
+
+/* usage is counted in blocks such that 32-bit atomics span 256GB */
+#define PGM_BUDGET_UNIT			64
+#define PGM_BUDGET_UNITS(bytes)		((uint32_t)(((bytes) + PGM_BUDGET_UNIT - 1) / PGM_BUDGET_UNIT))
+
+/* idle receive windows are compacted this many times sooner under pressure */
+#define PGM_BUDGET_IDLE_DIVISOR		8
+
+struct pgm_budget_t {
+	volatile uint32_t		used;		/* units */
+	uint32_t			limit;		/* units, 0 = unlimited */
+	pgm_budget_t*			parent;		/* charged alongside, NULL = root */
+};
+
+extern pgm_budget_t pgm_budget_process;
+
+PGM_GNUC_INTERNAL void pgm_budget_init (pgm_budget_t*const restrict, pgm_budget_t*const restrict);
+PGM_GNUC_INTERNAL void pgm_budget_set_limit (pgm_budget_t*const, const uint64_t);
+PGM_GNUC_INTERNAL uint64_t pgm_budget_limit (const pgm_budget_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL uint64_t pgm_budget_used (const pgm_budget_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_budget_charge (pgm_budget_t*, const uint32_t);
+PGM_GNUC_INTERNAL void pgm_budget_uncharge (pgm_budget_t*, const uint32_t);
+PGM_GNUC_INTERNAL bool pgm_budget_is_exceeded (const pgm_budget_t*) PGM_GNUC_WARN_UNUSED_RESULT;
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_BUDGET_H__ */
+
+/* eof */
@@ -0,0 +1,53 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * packet capture ring.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if !defined (__PGM_IMPL_FRAMEWORK_H_INSIDE__) && !defined (PGM_COMPILATION)
+#	error "Only <framework.h> can be included directly."
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_CAPTURE_H__
+#define __PGM_IMPL_CAPTURE_H__
+
+struct pgm_capture_t;
+
+#include <pgm/types.h>
+#include <pgm/error.h>
+#include <pgm/capture.h>
+
+PGM_BEGIN_DECLS
+
+struct pgm_sock_t;
+
+PGM_GNUC_INTERNAL struct pgm_capture_t* pgm_capture_new (const char*restrict, size_t, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_capture_destroy (struct pgm_capture_t*);
+PGM_GNUC_INTERNAL void pgm_capture_packet (struct pgm_capture_t*const restrict, const bool, const void*restrict, const size_t, const bool, const struct sockaddr*restrict, const struct sockaddr*restrict, const in_port_t, const in_port_t);
+
+/* recv.c: process one replayed datagram, caller holds sock::receiver_mutex */
+PGM_GNUC_INTERNAL bool pgm_recv_replay (struct pgm_sock_t*const restrict, const void*restrict, const size_t, const struct sockaddr*restrict, const struct sockaddr*restrict, const bool);
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_CAPTURE_H__ */
+
+/* eof */
@@ -33,11 +33,20 @@
 
 PGM_BEGIN_DECLS
 
+/* checksums of at most this many bytes dispatch to the small packet kernel */
+#define PGM_CSUM_SMALL_LEN	256
+
+struct pgm_cpu_t;
+
+PGM_GNUC_INTERNAL void pgm_checksum_init (const struct pgm_cpu_t*);
+PGM_GNUC_INTERNAL void pgm_checksum_calibrate (const struct pgm_cpu_t*);
+PGM_GNUC_INTERNAL const char* pgm_checksum_kernel (const bool, uint64_t*);
 uint16_t pgm_inet_checksum (const void*, uint16_t, uint16_t);
 uint16_t pgm_csum_fold (uint32_t) PGM_GNUC_CONST;
 uint32_t pgm_csum_block_add (uint32_t, uint32_t, const uint16_t) PGM_GNUC_CONST;
 uint32_t pgm_compat_csum_partial (const void*, uint16_t, uint32_t);
 uint32_t pgm_compat_csum_partial_copy (const void*restrict, void*restrict, uint16_t, uint32_t);
+uint32_t pgm_compat_csum_partial_copy_nt (const void*restrict, void*restrict, uint16_t, uint32_t);
 
 static inline uint32_t add32_with_carry (uint32_t, uint32_t) PGM_GNUC_CONST;
 
@@ -71,6 +80,7 @@ static inline uint32_t add32_with_carry (uint32_t a, uint32_t b)
 
 #	define pgm_csum_partial            pgm_compat_csum_partial
 #	define pgm_csum_partial_copy       pgm_compat_csum_partial_copy
+#	define pgm_csum_partial_copy_nt    pgm_compat_csum_partial_copy_nt
 
 PGM_END_DECLS
 
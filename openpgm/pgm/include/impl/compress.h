@@ -0,0 +1,51 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * APDU payload compression with a shared dictionary.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if !defined (__PGM_IMPL_FRAMEWORK_H_INSIDE__) && !defined (PGM_COMPILATION)
+#	error "Only <framework.h> can be included directly."
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_COMPRESS_H__
+#define __PGM_IMPL_COMPRESS_H__
+
+struct pgm_compress_t;
+
+#include <pgm/types.h>
+#include <pgm/error.h>
+#include <pgm/msgv.h>
+#include <pgm/socket.h>
+
+PGM_BEGIN_DECLS
+
+PGM_GNUC_INTERNAL bool pgm_compress_is_supported (const unsigned) PGM_GNUC_CONST;
+PGM_GNUC_INTERNAL struct pgm_compress_t* pgm_compress_new (const struct pgm_compress_req_t*const restrict, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_compress_destroy (struct pgm_compress_t*);
+PGM_GNUC_INTERNAL size_t pgm_compress (struct pgm_compress_t*const restrict, const void*restrict, const size_t, void*restrict, const size_t);
+PGM_GNUC_INTERNAL bool pgm_decompress (struct pgm_compress_t*const restrict, const unsigned, const uint16_t, const struct pgm_iovec*restrict, const unsigned, void*restrict, const size_t);
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_COMPRESS_H__ */
+
+/* eof */
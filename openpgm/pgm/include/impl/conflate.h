@@ -0,0 +1,49 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * Conflation key table of last-value feeds.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if !defined (__PGM_IMPL_FRAMEWORK_H_INSIDE__) && !defined (PGM_COMPILATION)
+#	error "Only <framework.h> can be included directly."
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_CONFLATE_H__
+#define __PGM_IMPL_CONFLATE_H__
+
+struct pgm_conflate_t;
+
+#include <pgm/types.h>
+#include <pgm/socket.h>
+
+PGM_BEGIN_DECLS
+
+PGM_GNUC_INTERNAL struct pgm_conflate_t* pgm_conflate_new (void) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_conflate_destroy (struct pgm_conflate_t*const);
+PGM_GNUC_INTERNAL bool pgm_conflate_key (const struct pgm_conflate_req_t*const restrict, const void*restrict, const size_t, uint64_t*restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL bool pgm_conflate_lookup (const struct pgm_conflate_t*const restrict, const uint64_t, uint32_t*restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_conflate_insert (struct pgm_conflate_t*const, const uint64_t, const uint32_t);
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_CONFLATE_H__ */
+
+/* eof */
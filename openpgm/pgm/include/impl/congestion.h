@@ -0,0 +1,92 @@
+/* vim:ts=8:sts=4:sw=4:noai:noexpandtab
+ *
+ * Congestion control algorithms driven by ACKer feedback.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_CONGESTION_H__
+#define __PGM_IMPL_CONGESTION_H__
+
+#include <impl/framework.h>
+
+PGM_BEGIN_DECLS
+
+/* delivery rate samples kept for the bottleneck bandwidth maximum filter, one per round trip */
+#define PGM_CC_BBR_BW_ROUNDS		10
+
+/* minimum round trip time is re-sampled when older than this */
+#define PGM_CC_BBR_MIN_RTT_WIN		pgm_secs(10)
+
+/* receivers with the worst throughput estimate tracked by the source as ACKer candidates */
+#define PGM_ACKER_TABLE_SIZE		8
+
+/* a replacement ACKer must exceed the current ACKer estimate by a quarter */
+#define PGM_ACKER_HYSTERESIS(x)		((x) + ((x) >> 2))
+
+/* ACKer candidate with smoothed feedback, worst estimate is rtt² × loss rate */
+struct pgm_acker_t {
+	struct sockaddr_storage		nla;
+	pgm_time_t			last_feedback;			/* 0 = free slot */
+	uint32_t			rtt;				/* milliseconds */
+	uint32_t			loss_rate;			/* 16-bit fixed point */
+	uint64_t			loss;
+};
+
+/* state of the bandwidth and delay model */
+struct pgm_cc_bbr_t {
+	uint32_t			min_rtt;			/* milliseconds, 0 = no sample */
+	pgm_time_t			min_rtt_stamp;
+	uint32_t			bw[PGM_CC_BBR_BW_ROUNDS];	/* fixed point packets per millisecond */
+	unsigned			bw_index;
+	uint32_t			max_bw;
+	pgm_time_t			round_start;
+	uint32_t			round_acks;			/* packets acknowledged this round */
+	uint32_t			full_bw;			/* startup plateau detection */
+	unsigned			full_bw_rounds;
+	bool				is_filled_pipe;
+	unsigned			cycle_index;			/* pacing gain phase */
+};
+
+/* an algorithm meters transmission through pgm_sock_t::tokens and ::cwnd_size in
+ * fixed point packets, the source sends whilst one token remains.  ACK processing,
+ * ACKer election and loss detection are common and call into the algorithm with
+ * the source lock not held.
+ */
+struct pgm_cc_ops_t {
+	void		(*init) (pgm_sock_t*const);
+/* newly acknowledged sequences with the ACKer round trip time in milliseconds,
+ * is_recovery whilst acknowledging packets sent before the last loss.
+ */
+	void		(*on_ack) (pgm_sock_t*const, const pgm_time_t, const unsigned, const uint32_t, const bool);
+/* loss detected with the count of sequences acknowledged after the hole */
+	void		(*on_loss) (pgm_sock_t*const, const unsigned);
+	void		(*on_send) (pgm_sock_t*const);
+	void		(*on_timeout) (pgm_sock_t*const);
+/* bytes per second to pace original data at, 0 = not paced */
+	ssize_t		(*pacing_rate) (const pgm_sock_t*const);
+};
+
+PGM_GNUC_INTERNAL const struct pgm_cc_ops_t* pgm_cc_get (const unsigned) PGM_GNUC_CONST;
+PGM_GNUC_INTERNAL bool pgm_cc_on_feedback (pgm_sock_t*const restrict, const struct sockaddr*const restrict, const pgm_time_t, const uint32_t, const uint16_t) PGM_GNUC_WARN_UNUSED_RESULT;
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_CONGESTION_H__ */
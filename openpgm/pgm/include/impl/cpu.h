@@ -45,6 +45,13 @@ struct pgm_cpu_t {
 	bool		has_sse42;
 	bool		has_avx;
 	bool		has_avx2;
+	bool		has_avx512f;
+	bool		has_avx512bw;
+	bool		has_gfni;
+	bool		has_rdtscp;
+	bool		has_invariant_tsc;
+	bool		has_neon;
+	uint32_t	tsc_khz;	/* nominal TSC rate enumerated by CPUID, or 0 */
 };
 
 PGM_GNUC_INTERNAL void pgm_cpuid (pgm_cpu_t*);
@@ -0,0 +1,59 @@
+/* vim:ts=8:sts=4:sw=4:noai:noexpandtab
+ *
+ * DPDK poll-mode transport.
+ *
+ * Copyright (c) 2006-2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if !defined (__PGM_IMPL_FRAMEWORK_H_INSIDE__) && !defined (PGM_COMPILATION)
+#	error "Only <framework.h> can be included directly."
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_DPDK_H__
+#define __PGM_IMPL_DPDK_H__
+
+struct pgm_dpdk_t;
+
+#include <pgm/types.h>
+#include <pgm/msgv.h>
+#include <pgm/skbuff.h>
+
+PGM_BEGIN_DECLS
+
+/* default and maximum descriptors of each queue, power of 2 */
+#define PGM_DPDK_DEFAULT_DEPTH		1024
+#define PGM_DPDK_MAX_DEPTH		32768
+
+struct pgm_sock_t;
+struct pgm_dpdk_req_t;
+
+#ifdef HAVE_RTE_ETHDEV_H
+PGM_GNUC_INTERNAL struct pgm_dpdk_t* pgm_dpdk_new (const struct pgm_sock_t*const, const struct pgm_dpdk_req_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_dpdk_destroy (struct pgm_dpdk_t*const);
+PGM_GNUC_INTERNAL bool pgm_dpdk_join (struct pgm_dpdk_t*const restrict, const struct sockaddr*const restrict);
+PGM_GNUC_INTERNAL bool pgm_dpdk_leave (struct pgm_dpdk_t*const restrict, const struct sockaddr*const restrict);
+PGM_GNUC_INTERNAL ssize_t pgm_dpdk_sendv (struct pgm_dpdk_t*const restrict, const struct sockaddr*const restrict, const int, const int, const bool, const struct pgm_iovec*const restrict, const unsigned);
+PGM_GNUC_INTERNAL ssize_t pgm_dpdk_recv (struct pgm_dpdk_t*const restrict, struct pgm_sk_buff_t*const restrict, struct sockaddr*const restrict, struct sockaddr*const restrict);
+PGM_GNUC_INTERNAL bool pgm_dpdk_is_pending (const struct pgm_dpdk_t*const);
+#endif
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_DPDK_H__ */
@@ -0,0 +1,55 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * binary protocol event trace, recording interface.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if !defined (__PGM_IMPL_FRAMEWORK_H_INSIDE__) && !defined (PGM_COMPILATION)
+#	error "Only <framework.h> can be included directly."
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_EVTRACE_H__
+#define __PGM_IMPL_EVTRACE_H__
+
+#include <pgm/types.h>
+#include <pgm/tsi.h>
+#include <pgm/evtrace.h>
+
+PGM_BEGIN_DECLS
+
+extern bool pgm_evtrace_enabled;
+
+PGM_GNUC_INTERNAL void pgm__evtrace (const unsigned, const pgm_tsi_t*const, const uint32_t, const unsigned);
+
+/* record one event when a trace is active, a single test of a read-mostly
+ * flag otherwise.
+ */
+#define pgm_evtrace(id, tsi, sqn, arg) \
+	do { \
+		if (PGM_UNLIKELY(pgm_evtrace_enabled)) \
+			pgm__evtrace ((id), (tsi), (sqn), (arg)); \
+	} while (0)
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_EVTRACE_H__ */
+
+/* eof */
@@ -0,0 +1,54 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * in-kernel receive socket filter.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if !defined (__PGM_IMPL_FRAMEWORK_H_INSIDE__) && !defined (PGM_COMPILATION)
+#	error "Only <framework.h> can be included directly."
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_FILTER_H__
+#define __PGM_IMPL_FILTER_H__
+
+#include <pgm/types.h>
+
+/* classic BPF socket filters */
+#ifdef __linux__
+#	define PGM_HAVE_RECV_FILTER	1
+#endif
+
+PGM_BEGIN_DECLS
+
+/* data-destination ports matched before the port check is left to user space */
+#define PGM_FILTER_MAX_DPORTS		16
+
+struct pgm_sock_t;
+
+#ifdef PGM_HAVE_RECV_FILTER
+PGM_GNUC_INTERNAL bool pgm_recv_filter_attach (struct pgm_sock_t*const);
+#endif
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_FILTER_H__ */
+
+/* eof */
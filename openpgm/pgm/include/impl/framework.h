@@ -42,11 +42,18 @@
 #include <pgm/tsi.h>
 #include <pgm/types.h>
 
+#include <impl/affinity.h>
+#include <impl/budget.h>
 #include <impl/byteorder.h>
+#include <impl/capture.h>
 #include <impl/checksum.h>
+#include <impl/compress.h>
+#include <impl/conflate.h>
 #include <impl/cpu.h>
 #include <impl/endian.h>
 #include <impl/errno.h>
+#include <impl/evtrace.h>
+#include <impl/filter.h>
 #include <impl/fixed.h>
 #include <impl/galois.h>
 #include <impl/getifaddrs.h>
@@ -54,32 +61,51 @@
 #include <impl/getnetbyname.h>
 #include <impl/getnodeaddr.h>
 #include <impl/getprotobyname.h>
+#include <impl/handoff.h>
 #include <impl/hashtable.h>
 #include <impl/histogram.h>
+#include <impl/impair.h>
 #include <impl/indextoaddr.h>
 #include <impl/indextoname.h>
 #include <impl/inet_network.h>
 #include <impl/ip.h>
 #include <impl/list.h>
+#include <impl/local.h>
 #include <impl/math.h>
 #include <impl/md5.h>
+#include <impl/mem.h>
 #include <impl/messages.h>
 #include <impl/nametoindex.h>
 #include <impl/notify.h>
+#include <impl/peertable.h>
 #include <impl/processor.h>
+#include <impl/profile.h>
 #include <impl/queue.h>
 #include <impl/rand.h>
 #include <impl/rate_control.h>
+#include <impl/record.h>
 #include <impl/reed_solomon.h>
+#include <impl/restart.h>
+#include <impl/rio.h>
+#include <impl/rlc.h>
 #include <impl/security.h>
+#include <impl/skbuff.h>
 #include <impl/slist.h>
 #include <impl/sn.h>
 #include <impl/sockaddr.h>
+#include <impl/spill.h>
+#include <impl/stats.h>
 #include <impl/string.h>
 #include <impl/thread.h>
 #include <impl/time.h>
+#include <impl/tpacket.h>
 #include <impl/tsi.h>
+#include <impl/txw_store.h>
+#include <impl/uring.h>
+#include <impl/verbs.h>
+#include <impl/dpdk.h>
 #include <impl/wsastrerror.h>
+#include <impl/xdp.h>
 
 #undef __PGM_IMPL_FRAMEWORK_H_INSIDE__
 
@@ -71,6 +71,8 @@ struct pgm_ifaddrs_t
 	struct sockaddr*	ifa_netmask;	/* Netmask of this interface.  */
 };
 
+PGM_GNUC_INTERNAL void pgm_ifaddrs_init (void);
+PGM_GNUC_INTERNAL void pgm_ifaddrs_shutdown (void);
 bool pgm_getifaddrs (struct pgm_ifaddrs_t**restrict, pgm_error_t**restrict);
 void pgm_freeifaddrs (struct pgm_ifaddrs_t*);
 
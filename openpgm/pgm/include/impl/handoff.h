@@ -0,0 +1,82 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * Lock-free handoff of complete APDUs from the timer thread to application
+ * threads and of their skbuffs back again.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if !defined (__PGM_IMPL_FRAMEWORK_H_INSIDE__) && !defined (PGM_COMPILATION)
+#	error "Only <framework.h> can be included directly."
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_HANDOFF_H__
+#define __PGM_IMPL_HANDOFF_H__
+
+struct pgm_handoff_t;
+
+#include <pgm/types.h>
+#include <pgm/msgv.h>
+#include <pgm/tsi.h>
+
+PGM_BEGIN_DECLS
+
+/* slots of the PGM_HANDOFF_RING delivery ring */
+#define PGM_HANDOFF_MIN_SLOTS	2
+#define PGM_HANDOFF_MAX_SLOTS	65536
+
+/* one APDU, or with no skbuffs the unrecoverable loss of tsi */
+struct pgm_handoff_slot_t {
+	volatile uint32_t		sequence;		/* lap marker of the cursor position */
+	pgm_tsi_t			tsi;
+	struct pgm_msgv_t		msgv;
+};
+
+/* bounded ring with a sequence per slot, any number of threads on either end */
+struct pgm_handoff_queue_t {
+	struct pgm_handoff_slot_t*	slots;
+	uint32_t			mask;			/* slots - 1 */
+	PGM_ALIGNED(PGM_CACHELINE_SIZE)
+	volatile uint32_t		enqueue_pos;
+	PGM_ALIGNED(PGM_CACHELINE_SIZE)
+	volatile uint32_t		dequeue_pos;
+};
+
+struct pgm_handoff_t {
+	struct pgm_handoff_queue_t	delivery;		/* timer thread to consumers */
+	struct pgm_handoff_queue_t	release;		/* consumers to timer thread */
+	PGM_ALIGNED(PGM_CACHELINE_SIZE)
+	volatile uint32_t		is_waiting;		/* a consumer found the ring empty */
+	volatile uint32_t		is_blocked;		/* the timer thread found the ring full */
+};
+
+PGM_GNUC_INTERNAL struct pgm_handoff_t* pgm_handoff_new (const unsigned) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_handoff_destroy (struct pgm_handoff_t*const);
+PGM_GNUC_INTERNAL unsigned pgm_handoff_space (const struct pgm_handoff_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_handoff_publish (struct pgm_handoff_t*const restrict, const struct pgm_msgv_t*const restrict, const pgm_tsi_t*const restrict);
+PGM_GNUC_INTERNAL bool pgm_handoff_take (struct pgm_handoff_t*const restrict, struct pgm_msgv_t*const restrict, pgm_tsi_t*const restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL bool pgm_handoff_give (struct pgm_handoff_t*const restrict, const struct pgm_msgv_t*const restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_handoff_reclaim (struct pgm_handoff_t*const);
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_HANDOFF_H__ */
+
+/* eof */
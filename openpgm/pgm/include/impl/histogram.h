@@ -31,88 +31,96 @@
 
 #include <pgm/types.h>
 #include <pgm/time.h>
+#include <pgm/histogram.h>
 #include <impl/slist.h>
 #include <impl/string.h>
+#include <impl/thread.h>
 
 PGM_BEGIN_DECLS
 
-typedef int pgm_sample_t;
-typedef int pgm_count_t;
+/* HDR-style log-linear buckets: values below PGM_HISTOGRAM_SUB_BUCKETS are
+ * exact, every power of two above that is split into half as many linear
+ * sub-buckets.  Values are clamped to PGM_HISTOGRAM_VALUE_BITS, 2^40 µs is
+ * twelve days.
+ */
+#define PGM_HISTOGRAM_SUB_BUCKET_BITS	6
+#define PGM_HISTOGRAM_SUB_BUCKETS	(1U << PGM_HISTOGRAM_SUB_BUCKET_BITS)
+#define PGM_HISTOGRAM_VALUE_BITS	40
+#define PGM_HISTOGRAM_BUCKETS		((PGM_HISTOGRAM_VALUE_BITS - PGM_HISTOGRAM_SUB_BUCKET_BITS + 2) * (PGM_HISTOGRAM_SUB_BUCKETS / 2))
+
+/* recording threads hash onto shards, merged when read */
+#define PGM_HISTOGRAM_SHARD_BITS	3
+#define PGM_HISTOGRAM_SHARDS		(1U << PGM_HISTOGRAM_SHARD_BITS)
+
+/* one in PGM_HISTOGRAM_SAMPLE_RATE sequences, a power of two */
+#define PGM_HISTOGRAM_SAMPLE_RATE	64
+
+enum {
+	PGM_HISTOGRAM_UNREGISTERED = 0,
+	PGM_HISTOGRAM_INITIALIZING,
+	PGM_HISTOGRAM_REGISTERED
+};
 
-struct pgm_sample_set_t {
-	pgm_count_t*	counts;
-	unsigned	counts_len;
-	int64_t		sum;
-	int64_t		square_sum;
+struct pgm_histogram_shard_t {
+	volatile uint64_t	counts[ PGM_HISTOGRAM_BUCKETS ];
+	volatile uint64_t	sum;
+	volatile uint64_t	max;
 };
 
-typedef struct pgm_sample_set_t pgm_sample_set_t;
+typedef struct pgm_histogram_shard_t pgm_histogram_shard_t;
 
 struct pgm_histogram_t {
-	const char* restrict	histogram_name;
-	unsigned		bucket_count;
-	pgm_sample_t		declared_min;
-	pgm_sample_t		declared_max;
-	pgm_sample_t* restrict	ranges;
-	pgm_sample_set_t	sample;
-	bool			is_registered;
-	pgm_slist_t		histograms_link;
+	const char* restrict		histogram_name;
+	volatile uint32_t		state;
+	pgm_histogram_shard_t* restrict	shards;
+	pgm_slist_t			histograms_link;
 };
 
 typedef struct pgm_histogram_t pgm_histogram_t;
 
-#define PGM_HISTOGRAM_DEFINE(name, minimum, maximum, count) \
-		static pgm_count_t counts[ (count) ]; \
-		static pgm_sample_t ranges[ (count) + 1 ]; \
+#define PGM_HISTOGRAM_DEFINE(name) \
 		static pgm_histogram_t counter = { \
 			.histogram_name		= (name), \
-			.bucket_count		= (count), \
-			.declared_min		= (minimum), \
-			.declared_max		= (maximum), \
-			.ranges			= ranges, \
-			.sample = { \
-				.counts 		= counts, \
-				.counts_len		= (count), \
-				.sum			= 0, \
-				.square_sum		= 0 \
-			}, \
-			.is_registered		= FALSE \
+			.state			= PGM_HISTOGRAM_UNREGISTERED, \
+			.shards			= NULL \
 		}
 
 #ifdef USE_HISTOGRAMS
 
 #	define PGM_HISTOGRAM_TIMES(name, sample) do { \
-		PGM_HISTOGRAM_DEFINE(name, pgm_msecs(1), pgm_secs(10), 50); \
-		if (!counter.is_registered) { \
-			memset (counts, 0, sizeof(counts)); \
-			memset (ranges, 0, sizeof(ranges)); \
-			pgm_histogram_init (&counter); \
-		} \
-		pgm_histogram_add_time (&counter, sample); \
+		PGM_HISTOGRAM_DEFINE(name); \
+		pgm_histogram_add_time (&counter, (sample)); \
 	} while (0)
 
 #	define PGM_HISTOGRAM_COUNTS(name, sample) do { \
-		PGM_HISTOGRAM_DEFINE(name, 1, 1000000, 50); \
-		if (!counter.is_registered) { \
-			memset (counts, 0, sizeof(counts)); \
-			memset (ranges, 0, sizeof(ranges)); \
-			pgm_histogram_init (&counter); \
-		} \
+		PGM_HISTOGRAM_DEFINE(name); \
 		pgm_histogram_add (&counter, (sample)); \
 	} while (0)
 
+/* latency tracepoints sample by sequence number so every stage of one APDU
+ * is taken together, the sample expression is only evaluated when taken.
+ */
+#	define PGM_HISTOGRAM_IS_SAMPLED(sqn)	(0 == ((sqn) & (PGM_HISTOGRAM_SAMPLE_RATE - 1)))
+
+#	define PGM_HISTOGRAM_SAMPLED_TIMES(name, sqn, sample) do { \
+		if (PGM_HISTOGRAM_IS_SAMPLED(sqn)) \
+			PGM_HISTOGRAM_TIMES(name, (sample)); \
+	} while (0)
+
 #else
 
 #	define PGM_HISTOGRAM_TIMES(name, sample)
 #	define PGM_HISTOGRAM_COUNTS(name, sample)
+#	define PGM_HISTOGRAM_SAMPLED_TIMES(name, sqn, sample)
 
 #endif /* USE_HISTOGRAMS */
 
 
 extern pgm_slist_t*	pgm_histograms;
+extern pgm_spinlock_t	pgm_histograms_lock;
 
 void pgm_histogram_init (pgm_histogram_t*);
-void pgm_histogram_add (pgm_histogram_t*, int);
+void pgm_histogram_add (pgm_histogram_t*, uint64_t);
 void pgm_histogram_write_html_graph_all (pgm_string_t*);
 
 static inline
@@ -122,7 +130,7 @@ pgm_histogram_add_time (
 	pgm_time_t		sample_time
 	)
 {
-	pgm_histogram_add (histogram, (int)pgm_to_msecs (sample_time));
+	pgm_histogram_add (histogram, pgm_to_usecs (sample_time));
 }
 
 PGM_END_DECLS
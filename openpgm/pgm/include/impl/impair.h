@@ -0,0 +1,55 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * Test impairment of datagrams: loss, duplication, reordering and delay.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if !defined (__PGM_IMPL_FRAMEWORK_H_INSIDE__) && !defined (PGM_COMPILATION)
+#	error "Only <framework.h> can be included directly."
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_IMPAIR_H__
+#define __PGM_IMPL_IMPAIR_H__
+
+struct pgm_impair_t;
+
+#include <pgm/types.h>
+#include <pgm/socket.h>
+#include <impl/time.h>
+
+PGM_BEGIN_DECLS
+
+/* PGM_IMPAIR environment, applied to sockets as created */
+extern struct pgm_impair_req_t	pgm_impair_env;
+
+PGM_GNUC_INTERNAL bool pgm_impair_parse (const char*restrict, struct pgm_impair_req_t*restrict);
+PGM_GNUC_INTERNAL bool pgm_impair_is_enabled (const struct pgm_impair_req_t*const) PGM_GNUC_PURE;
+PGM_GNUC_INTERNAL struct pgm_impair_t* pgm_impair_new (const struct pgm_impair_req_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_impair_destroy (struct pgm_impair_t*const, const char*const);
+PGM_GNUC_INTERNAL bool pgm_impair_apply (struct pgm_impair_t*const restrict, const void*restrict, const size_t, const struct sockaddr*restrict, const struct sockaddr*restrict, const bool);
+PGM_GNUC_INTERNAL size_t pgm_impair_release (struct pgm_impair_t*const restrict, const pgm_time_t, void*restrict, const size_t, struct sockaddr_storage*restrict, struct sockaddr_storage*restrict, bool*restrict);
+PGM_GNUC_INTERNAL pgm_time_t pgm_impair_expiry (struct pgm_impair_t*const);
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_IMPAIR_H__ */
+
+/* eof */
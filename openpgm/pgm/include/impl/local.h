@@ -0,0 +1,53 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * shared memory ring of APDUs read by a receiver for same-host consumers.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if !defined (__PGM_IMPL_FRAMEWORK_H_INSIDE__) && !defined (PGM_COMPILATION)
+#	error "Only <framework.h> can be included directly."
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_LOCAL_H__
+#define __PGM_IMPL_LOCAL_H__
+
+#include <pgm/types.h>
+#include <pgm/error.h>
+#include <pgm/local.h>
+#include <pgm/msgv.h>
+#include <pgm/tsi.h>
+
+PGM_BEGIN_DECLS
+
+/* ring records when not specified */
+#define PGM_LOCAL_DEFAULT_SLOTS		4096
+#define PGM_LOCAL_MAX_SLOTS		(1U << 20)
+
+PGM_GNUC_INTERNAL pgm_local_t* pgm_local_create (const char*restrict, unsigned, const uint16_t, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_local_destroy (pgm_local_t*);
+PGM_GNUC_INTERNAL void pgm_local_publish (pgm_local_t*const restrict, const struct pgm_msgv_t*restrict, const struct pgm_msgv_t*const restrict);
+PGM_GNUC_INTERNAL void pgm_local_publish_loss (pgm_local_t*const restrict, const pgm_tsi_t*const restrict);
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_LOCAL_H__ */
+
+/* eof */
@@ -0,0 +1,203 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ * 
+ * Queued spinlocks per Mellor-Crummey and Scott, in the K42 form that
+ * keeps the queue node of the holder inside the lock so that the
+ * lock and unlock calls need no caller provided node.
+ *
+ * Copyright (c) 2011 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if !defined (__PGM_IMPL_FRAMEWORK_H_INSIDE__) && !defined (PGM_COMPILATION)
+#	error "Only <framework.h> can be included directly."
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_MCS_H__
+#define __PGM_IMPL_MCS_H__
+
+typedef struct pgm_mcs_t pgm_mcs_t;
+
+#if defined( __sun )
+#	include <atomic.h>
+#elif defined( __APPLE__ )
+#	include <libkern/OSAtomic.h>
+#elif defined( _WIN32 )
+#	define VC_EXTRALEAN
+#	define WIN32_LEAN_AND_MEAN
+#	include <windows.h>
+#	if defined( _MSC_VER )
+/* not implemented in MinGW */
+#		include <intrin.h>
+#	endif
+#else
+#	include <sched.h>
+#endif
+#include <pgm/types.h>
+#include <impl/thread.h>
+
+PGM_BEGIN_DECLS
+
+/* The lock is itself a queue node: tail is the last waiter, or the lock when
+ * held without waiters, and next is the first waiter.  Every waiter spins on
+ * its own node on the stack of pgm_mcs_lock() so that a release touches only
+ * the cache line of the next holder.
+ */
+
+struct pgm_mcs_t {
+	struct pgm_mcs_t* volatile	tail;
+	struct pgm_mcs_t* volatile	next;
+};
+
+#define PGM_MCS_WAITING		((struct pgm_mcs_t*)1)
+
+/* pointer CAS, returns TRUE if swap occurred.
+ */
+
+static inline
+bool
+pgm_mcs_compare_and_exchange (
+	struct pgm_mcs_t* volatile*	atomic,
+	struct pgm_mcs_t*		newval,
+	struct pgm_mcs_t*		oldval
+	)
+{
+#if defined( __GNUC__ ) && ( __GNUC__ * 100 + __GNUC_MINOR__ >= 401 )
+	return __sync_bool_compare_and_swap (atomic, oldval, newval);
+#elif defined( __sun )
+	return (oldval == atomic_cas_ptr ((volatile void*)atomic, oldval, newval));
+#elif defined( __APPLE__ )
+	return OSAtomicCompareAndSwapPtrBarrier (oldval, newval, (void* volatile*)atomic);
+#elif defined( _WIN32 )
+	return (oldval == InterlockedCompareExchangePointer ((PVOID volatile*)atomic, newval, oldval));
+#endif
+}
+
+/* full fence, ownership passes through plain stores.
+ */
+
+static inline
+void
+pgm_mcs_barrier (void)
+{
+#if defined( __GNUC__ ) && ( __GNUC__ * 100 + __GNUC_MINOR__ >= 401 )
+	__sync_synchronize();
+#elif defined( __sun )
+	membar_producer();
+	membar_consumer();
+#elif defined( _WIN32 )
+	MemoryBarrier();
+#endif
+}
+
+static inline
+void
+pgm_mcs_spin (
+	unsigned*	spins
+	)
+{
+#if defined( _WIN32 ) || defined( __i386__ ) || defined( __i386 ) || defined( __x86_64__ ) || defined( __amd64 )
+	if (!pgm_smp_system || (++*spins > PGM_ADAPTIVE_MUTEX_SPINCOUNT))
+#	ifdef _WIN32
+		SwitchToThread();
+#	else
+		sched_yield();
+#	endif
+	else		/* hyper-threading pause */
+#	ifdef _MSC_VER
+		YieldProcessor();
+#	else
+		__asm volatile ("pause" ::: "memory");
+#	endif
+#else
+	(void)spins;
+	sched_yield();
+#endif
+}
+
+
+/* queued spinlocks */
+
+static inline void pgm_mcs_init (pgm_mcs_t* lock) {
+	lock->tail = lock->next = NULL;
+}
+
+static inline void pgm_mcs_free (pgm_mcs_t* lock) {
+/* nop */
+	(void)lock;
+}
+
+static inline bool pgm_mcs_trylock (pgm_mcs_t* lock) {
+	return pgm_mcs_compare_and_exchange (&lock->tail, lock, NULL);
+}
+
+static inline void pgm_mcs_lock (pgm_mcs_t* lock) {
+	unsigned spins = 0;
+	for (;;) {
+		pgm_mcs_t* prev = lock->tail;
+		if (NULL == prev) {
+/* free, held without waiters */
+			if (pgm_mcs_compare_and_exchange (&lock->tail, lock, NULL))
+				return;
+			continue;
+		}
+		pgm_mcs_t node;
+		node.tail = PGM_MCS_WAITING;
+		node.next = NULL;
+		if (!pgm_mcs_compare_and_exchange (&lock->tail, &node, prev))
+			continue;
+/* the lock is prev when the holder has no waiters */
+		prev->next = &node;
+		while (PGM_MCS_WAITING == node.tail)
+			pgm_mcs_spin (&spins);
+		pgm_mcs_barrier();
+/* held, move the first waiter into the lock before the node goes out of scope */
+		pgm_mcs_t* succ = node.next;
+		if (NULL == succ) {
+			lock->next = NULL;
+			if (pgm_mcs_compare_and_exchange (&lock->tail, lock, &node))
+				return;
+			while (NULL == (succ = node.next))
+				pgm_mcs_spin (&spins);
+		}
+		lock->next = succ;
+		return;
+	}
+}
+
+static inline void pgm_mcs_unlock (pgm_mcs_t* lock) {
+	pgm_mcs_t* succ = lock->next;
+	if (NULL == succ) {
+		if (pgm_mcs_compare_and_exchange (&lock->tail, NULL, lock))
+			return;
+/* a waiter is between the swap of tail and linking itself */
+		unsigned spins = 0;
+		while (NULL == (succ = lock->next))
+			pgm_mcs_spin (&spins);
+	}
+	pgm_mcs_barrier();
+	succ->tail = NULL;
+}
+
+static inline bool pgm_mcs_is_unlocked (pgm_mcs_t* lock) {
+	return (NULL == lock->tail);
+}
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_MCS_H__ */
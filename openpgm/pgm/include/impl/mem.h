@@ -29,8 +29,29 @@
 
 PGM_BEGIN_DECLS
 
+/* window and skbuff slab placement resolved from struct pgm_mem_req_t */
+typedef struct pgm_mem_policy_t pgm_mem_policy_t;
+
+struct pgm_mem_policy_t {
+	unsigned	pages;		/* PGM_MEM_PAGES_* */
+	int		node;		/* NUMA node, -1 = any */
+};
+
 PGM_GNUC_INTERNAL void pgm_mem_init (void);
 PGM_GNUC_INTERNAL void pgm_mem_shutdown (void);
+PGM_GNUC_INTERNAL void* pgm_malloc_subsys (const size_t, const unsigned, const unsigned) PGM_GNUC_MALLOC PGM_GNUC_ALLOC_SIZE(1);
+PGM_GNUC_INTERNAL void* pgm_malloc0_subsys (const size_t, const unsigned, const unsigned) PGM_GNUC_MALLOC PGM_GNUC_ALLOC_SIZE(1);
+PGM_GNUC_INTERNAL void* pgm_malloc0_aligned (const size_t, const size_t) PGM_GNUC_MALLOC PGM_GNUC_ALLOC_SIZE(1);
+PGM_GNUC_INTERNAL void pgm_free_aligned (void*);
+PGM_GNUC_INTERNAL void* pgm_malloc0_policy (const size_t, const pgm_mem_policy_t*const) PGM_GNUC_MALLOC PGM_GNUC_ALLOC_SIZE(1);
+PGM_GNUC_INTERNAL void pgm_free_policy (void*);
+PGM_GNUC_INTERNAL size_t pgm_mem_policy_page_len (const pgm_mem_policy_t*const) PGM_GNUC_PURE;
+
+/* as pgm_new() and pgm_new0() counted against a PGM_MEM_SUBSYS_* allocation site */
+#define pgm_new_subsys(struct_type, n_structs, subsys) \
+	((struct_type*)pgm_malloc_subsys ((size_t)sizeof(struct_type) * (size_t)(n_structs), PGM_MEM_CLASS_GENERAL, (subsys)))
+#define pgm_new0_subsys(struct_type, n_structs, subsys) \
+	((struct_type*)pgm_malloc0_subsys ((size_t)sizeof(struct_type) * (size_t)(n_structs), PGM_MEM_CLASS_GENERAL, (subsys)))
 
 PGM_END_DECLS
 
@@ -51,21 +51,30 @@ PGM_GNUC_INTERNAL void pgm__logv (const int, const char*, va_list) PGM_GNUC_PRIN
 #	ifdef PGM_DEBUG
 #		define pgm_debug(...) \
 			do { \
-				if (pgm_min_log_level == PGM_LOG_LEVEL_DEBUG) \
+				if (PGM_UNLIKELY(pgm_min_log_level == PGM_LOG_LEVEL_DEBUG)) \
 					pgm__log (PGM_LOG_LEVEL_DEBUG, __VA_ARGS__); \
 			} while (0)
 #	else
 #		define pgm_debug(...)	while (0)
 #	endif /* !PGM_DEBUG */
 
-#	define pgm_trace(r,...) \
+/* trace level compiled out, arguments remain referenced but are never evaluated */
+#	ifndef PGM_DISABLE_TRACE
+#		define pgm_trace(r,...) \
 			do { \
-				if (pgm_min_log_level <= PGM_LOG_LEVEL_TRACE && pgm_log_mask & (r)) \
+				if (PGM_UNLIKELY(pgm_min_log_level <= PGM_LOG_LEVEL_TRACE && pgm_log_mask & (r))) \
 					pgm__log (PGM_LOG_LEVEL_TRACE, __VA_ARGS__); \
 			} while (0)
+#	else
+#		define pgm_trace(r,...) \
+			do { \
+				if (0) \
+					pgm__log (PGM_LOG_LEVEL_TRACE, __VA_ARGS__); \
+			} while (0)
+#	endif /* !PGM_DISABLE_TRACE */
 #	define pgm_minor(...) \
 			do { \
-				if (pgm_min_log_level <= PGM_LOG_LEVEL_MINOR) \
+				if (PGM_UNLIKELY(pgm_min_log_level <= PGM_LOG_LEVEL_MINOR)) \
 					pgm__log (PGM_LOG_LEVEL_MINOR, __VA_ARGS__); \
 			} while (0)
 #	define pgm_info(...) \
@@ -93,16 +102,20 @@ PGM_GNUC_INTERNAL void pgm__logv (const int, const char*, va_list) PGM_GNUC_PRIN
 #	ifdef PGM_DEBUG
 #		define pgm_debug(f...) \
 			do { \
-				if (pgm_min_log_level == PGM_LOG_LEVEL_DEBUG) \
+				if (PGM_UNLIKELY(pgm_min_log_level == PGM_LOG_LEVEL_DEBUG)) \
 					pgm__log (PGM_LOG_LEVEL_DEBUG, f); \
 			} while (0)
 #	else
 #		define pgm_debug(f...)	while (0)
 #	endif /* !PGM_DEBUG */
 
-#	define pgm_trace(r,f...)	if (pgm_min_log_level <= PGM_LOG_LEVEL_TRACE && pgm_log_mask & (r)) \
+#	ifndef PGM_DISABLE_TRACE
+#		define pgm_trace(r,f...)	if (PGM_UNLIKELY(pgm_min_log_level <= PGM_LOG_LEVEL_TRACE && pgm_log_mask & (r))) \
 					pgm__log (PGM_LOG_LEVEL_TRACE, f)
-#	define pgm_minor(f...)		if (pgm_min_log_level <= PGM_LOG_LEVEL_MINOR) pgm__log (PGM_LOG_LEVEL_MINOR, f)
+#	else
+#		define pgm_trace(r,f...)	if (0) pgm__log (PGM_LOG_LEVEL_TRACE, f)
+#	endif /* !PGM_DISABLE_TRACE */
+#	define pgm_minor(f...)		if (PGM_UNLIKELY(pgm_min_log_level <= PGM_LOG_LEVEL_MINOR)) pgm__log (PGM_LOG_LEVEL_MINOR, f)
 #	define pgm_info(f...)		if (pgm_min_log_level <= PGM_LOG_LEVEL_NORMAL) pgm__log (PGM_LOG_LEVEL_NORMAL, f)
 #	define pgm_warn(f...)		if (pgm_min_log_level <= PGM_LOG_LEVEL_WARNING) pgm__log (PGM_LOG_LEVEL_WARNING, f)
 #	define pgm_error(f...)		if (pgm_min_log_level <= PGM_LOG_LEVEL_ERROR) pgm__log (PGM_LOG_LEVEL_ERROR, f)
@@ -120,7 +133,7 @@ static inline void pgm_error (const char*, ...) PGM_GNUC_PRINTF (1, 2);
 static inline void pgm_fatal (const char*, ...) PGM_GNUC_PRINTF (1, 2);
 
 static inline void pgm_debug (const char* format, ...) {
-	if (PGM_LOG_LEVEL_DEBUG == pgm_min_log_level) {
+	if (PGM_UNLIKELY(PGM_LOG_LEVEL_DEBUG == pgm_min_log_level)) {
 		va_list args;
 		va_start (args, format);
 		pgm__logv (PGM_LOG_LEVEL_DEBUG, format, args);
@@ -129,16 +142,18 @@ static inline void pgm_debug (const char* format, ...) {
 }
 
 static inline void pgm_trace (const int role, const char* format, ...) {
-	if (PGM_LOG_LEVEL_TRACE >= pgm_min_log_level && pgm_log_mask & role) {
+#ifndef PGM_DISABLE_TRACE
+	if (PGM_UNLIKELY(PGM_LOG_LEVEL_TRACE >= pgm_min_log_level && pgm_log_mask & role)) {
 		va_list args;
 		va_start (args, format);
 		pgm__logv (PGM_LOG_LEVEL_TRACE, format, args);
 		va_end (args);
 	}
+#endif
 }
 
 static inline void pgm_minor (const char* format, ...) {
-	if (PGM_LOG_LEVEL_MINOR >= pgm_min_log_level) {
+	if (PGM_UNLIKELY(PGM_LOG_LEVEL_MINOR >= pgm_min_log_level)) {
 		va_list args;
 		va_start (args, format);
 		pgm__logv (PGM_LOG_LEVEL_MINOR, format, args);
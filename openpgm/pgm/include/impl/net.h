@@ -32,7 +32,47 @@
 
 PGM_BEGIN_DECLS
 
+/* the data socket is connect()ed to a multicast send group so the kernel keeps
+ * the route, requires explicit destinations still be accepted on a connected
+ * datagram socket for unicast NAKs, NCFs and ACKs.
+ */
+#ifdef __linux__
+#	define PGM_HAVE_CONNECTED_SEND		1
+#endif
+
+/* in-memory datagram transport in place of the network sockets for every PGM
+ * socket of the process, installed before the first bind.  sendto() takes the
+ * complete UDP payload, recvfrom() fills the source and destination addresses
+ * and returns -1 with PGM_SOCK_EAGAIN when empty, reads must be non-blocking.
+ */
+
+struct pgm_net_shim_t {
+	void*		user_data;
+	ssize_t		(*sendto)	(void*, pgm_sock_t*restrict, const void*restrict, size_t, const struct sockaddr*restrict, socklen_t);
+	ssize_t		(*recvfrom)	(void*, pgm_sock_t*restrict, void*restrict, size_t, struct sockaddr*restrict, struct sockaddr*restrict);
+};
+
+extern const struct pgm_net_shim_t*	pgm_net_shim;
+
+/* struct msghdr and struct iovec declare their pointers without const even
+ * though sendmsg() and sendmmsg() only read through them, the qualifier of a
+ * caller's buffer, address or vector is dropped here and nowhere else.
+ */
+
+static inline
+void*
+pgm_send_ptr (
+	const void*			ptr
+	)
+{
+	return (void*)(uintptr_t)ptr;
+}
+
 PGM_GNUC_INTERNAL ssize_t pgm_sendto_hops (pgm_sock_t*restrict, bool, pgm_rate_t*restrict, bool, int, const void*restrict, size_t, const struct sockaddr*restrict, socklen_t);
+PGM_GNUC_INTERNAL ssize_t pgm_sendto_tos (pgm_sock_t*restrict, bool, pgm_rate_t*restrict, int, const void*restrict, size_t, const struct sockaddr*restrict, socklen_t);
+PGM_GNUC_INTERNAL ssize_t pgm_sendtov (pgm_sock_t*restrict, bool, pgm_rate_t*restrict, bool, const struct pgm_iovec*restrict, unsigned, const struct sockaddr*restrict, socklen_t, int);
+PGM_GNUC_INTERNAL ssize_t pgm_sendto_batch (pgm_sock_t*restrict, bool, const struct pgm_iovec*restrict, const struct sockaddr*const*restrict, unsigned);
+PGM_GNUC_INTERNAL void pgm_sendto_impaired (pgm_sock_t*const, const pgm_time_t);
 PGM_GNUC_INTERNAL int pgm_set_nonblocking (SOCKET fd[2]);
 
 static inline
@@ -32,37 +32,57 @@
 typedef struct pgm_notify_t pgm_notify_t;
 
 #ifndef _WIN32
+#	include <errno.h>
 #	include <fcntl.h>
 #	include <unistd.h>
 #	ifdef HAVE_EVENTFD
 #		include <sys/eventfd.h>
+#	elif defined( HAVE_KQUEUE )
+#		include <sys/types.h>
+#		include <sys/event.h>
+#		include <sys/time.h>
+#		ifdef EVFILT_USER
+#			define PGM_HAVE_KQUEUE_NOTIFY	1
+#		endif
 #	endif
 #else /* _WIN32 */
 #	include <memory.h>
 #	include <ws2tcpip.h>
 #endif
 #include <pgm/types.h>
+#include <pgm/atomic.h>
 #include <impl/messages.h>
 #include <impl/sockaddr.h>
 
 PGM_BEGIN_DECLS
 
+/* notifications coalesce: only the first send after a clear writes to the
+ * descriptor and a clear only reads when one is pending, such that the
+ * descriptor holds exactly one token whilst pending.  eventfd counts in
+ * semaphore mode so that a read consumes one token as with the pipe.  on BSD
+ * and OS X a kqueue holding one EVFILT_USER event replaces the pipe, readable
+ * whilst triggered and reset as the event is collected.
+ */
+
 struct pgm_notify_t {
 #if defined( HAVE_EVENTFD )
 	int eventfd;
+#elif defined( PGM_HAVE_KQUEUE_NOTIFY )
+	int kq;
 #elif !defined( _WIN32 )
 	int pipefd[2];
 #else
 	SOCKET s[2];
 #endif /* _WIN32 */
+	volatile uint32_t is_pending;
 };
 
-#if defined( HAVE_EVENTFD )
-#	define PGM_NOTIFY_INIT		{ -1 }
+#if defined( HAVE_EVENTFD ) || defined( PGM_HAVE_KQUEUE_NOTIFY )
+#	define PGM_NOTIFY_INIT		{ -1, 0 }
 #elif !defined( _WIN32 )
-#	define PGM_NOTIFY_INIT		{ { -1, -1 } }
+#	define PGM_NOTIFY_INIT		{ { -1, -1 }, 0 }
 #else
-#	define PGM_NOTIFY_INIT		{ { INVALID_SOCKET, INVALID_SOCKET } }
+#	define PGM_NOTIFY_INIT		{ { INVALID_SOCKET, INVALID_SOCKET }, 0 }
 #endif
 
 
@@ -77,6 +97,9 @@ pgm_notify_is_valid (
 #if defined( HAVE_EVENTFD )
 	if (PGM_UNLIKELY(-1 == notify->eventfd))
 		return FALSE;
+#elif defined( PGM_HAVE_KQUEUE_NOTIFY )
+	if (PGM_UNLIKELY(-1 == notify->kq))
+		return FALSE;
 #elif !defined( _WIN32 )
 	if (PGM_UNLIKELY(-1 == notify->pipefd[0] || -1 == notify->pipefd[1]))
 		return FALSE;
@@ -96,7 +119,8 @@ pgm_notify_init (
 #if defined( HAVE_EVENTFD )
 	pgm_assert (NULL != notify);
 	notify->eventfd = -1;
-	int retval = eventfd (0, 0);
+	notify->is_pending = 0;
+	int retval = eventfd (0, EFD_SEMAPHORE);
 	if (-1 == retval)
 		return retval;
 	notify->eventfd = retval;
@@ -104,9 +128,24 @@ pgm_notify_init (
 	if (-1 != fd_flags)
 		retval = fcntl (notify->eventfd, F_SETFL, fd_flags | O_NONBLOCK);
 	return 0;
+#elif defined( PGM_HAVE_KQUEUE_NOTIFY )
+	struct kevent kev;
+	pgm_assert (NULL != notify);
+	notify->is_pending = 0;
+	notify->kq = kqueue ();
+	if (-1 == notify->kq)
+		return -1;
+	EV_SET(&kev, 0, EVFILT_USER, EV_ADD | EV_CLEAR, 0, 0, NULL);
+	if (-1 == kevent (notify->kq, &kev, 1, NULL, 0, NULL)) {
+		close (notify->kq);
+		notify->kq = -1;
+		return -1;
+	}
+	return 0;
 #elif !defined( _WIN32 )
 	pgm_assert (NULL != notify);
 	notify->pipefd[0] = notify->pipefd[1] = -1;
+	notify->is_pending = 0;
 	int retval = pipe (notify->pipefd);
 	pgm_assert (0 == retval);
 /* set non-blocking */
@@ -131,6 +170,7 @@ pgm_notify_init (
 
 	pgm_assert (NULL != notify);
 	notify->s[0] = notify->s[1] = INVALID_SOCKET;
+	notify->is_pending = 0;
 
 	listener = socket (AF_INET, SOCK_STREAM, 0);
 	pgm_assert (listener != INVALID_SOCKET);
@@ -190,6 +230,11 @@ pgm_notify_destroy (
 		close (notify->eventfd);
 		notify->eventfd = -1;
 	}
+#elif defined( PGM_HAVE_KQUEUE_NOTIFY )
+	if (-1 != notify->kq) {
+		close (notify->kq);
+		notify->kq = -1;
+	}
 #elif !defined( _WIN32 )
 	if (-1 != notify->pipefd[0]) {
 		close (notify->pipefd[0]);
@@ -212,77 +257,87 @@ pgm_notify_destroy (
 	return 0;
 }
 
+/* no system call when already pending.
+ */
+
 static inline
 int
 pgm_notify_send (
 	pgm_notify_t*	notify
 	)
 {
+	pgm_assert (NULL != notify);
+	if (0 != pgm_atomic_exchange32 (&notify->is_pending, 1))
+		return TRUE;
 #if defined( HAVE_EVENTFD )
 	uint64_t u = 1;
-	pgm_assert (NULL != notify);
 	pgm_assert (-1 != notify->eventfd);
 	ssize_t s = write (notify->eventfd, &u, sizeof(u));
 	return (s == sizeof(u));
+#elif defined( PGM_HAVE_KQUEUE_NOTIFY )
+	struct kevent kev;
+	pgm_assert (-1 != notify->kq);
+	EV_SET(&kev, 0, EVFILT_USER, 0, NOTE_TRIGGER, 0, NULL);
+	return (0 == kevent (notify->kq, &kev, 1, NULL, 0, NULL));
 #elif !defined( _WIN32 )
 	const char one = '1';
-	pgm_assert (NULL != notify);
 	pgm_assert (-1 != notify->pipefd[1]);
 	return (1 == write (notify->pipefd[1], &one, sizeof(one)));
 #else
 	const char one = '1';
-	pgm_assert (NULL != notify);
 	pgm_assert (INVALID_SOCKET != notify->s[1]);
 	return (1 == send (notify->s[1], &one, sizeof(one), 0));
 #endif /* HAVE_EVENTFD */
 }
 
+/* consume the pending token, returns TRUE if one was pending.  a sender may
+ * have marked the notification pending without its write having landed yet,
+ * the token is awaited to keep the descriptor and flag in step.
+ */
+
 static inline
 int
 pgm_notify_read (
 	pgm_notify_t*	notify
 	)
 {
+	pgm_assert (NULL != notify);
+	if (0 == pgm_atomic_exchange32 (&notify->is_pending, 0))
+		return FALSE;
 #if defined( HAVE_EVENTFD )
 	uint64_t u;
-	pgm_assert (NULL != notify);
 	pgm_assert (-1 != notify->eventfd);
-	return (sizeof(u) == read (notify->eventfd, &u, sizeof(u)));
+	while (sizeof(u) != read (notify->eventfd, &u, sizeof(u)) && (EAGAIN == errno || EINTR == errno));
+#elif defined( PGM_HAVE_KQUEUE_NOTIFY )
+	struct kevent kev;
+	const struct timespec ts = { 0, 0 };
+	int n;
+	pgm_assert (-1 != notify->kq);
+	do {
+		n = kevent (notify->kq, NULL, 0, &kev, 1, &ts);
+	} while (0 == n || (-1 == n && EINTR == errno));
 #elif !defined( _WIN32 )
 	char buf;
-	pgm_assert (NULL != notify);
 	pgm_assert (-1 != notify->pipefd[0]);
-	return (sizeof(buf) == read (notify->pipefd[0], &buf, sizeof(buf)));
+	while (sizeof(buf) != read (notify->pipefd[0], &buf, sizeof(buf)) && (EAGAIN == errno || EINTR == errno));
 #else
 	char buf;
-	pgm_assert (NULL != notify);
 	pgm_assert (INVALID_SOCKET != notify->s[0]);
-	return (sizeof(buf) == recv (notify->s[0], &buf, sizeof(buf), 0));
+	while (sizeof(buf) != recv (notify->s[0], &buf, sizeof(buf), 0) && WSAEWOULDBLOCK == WSAGetLastError());
 #endif /* HAVE_EVENTFD */
+	return TRUE;
 }
 
+/* no system call when not pending.
+ */
+
 static inline
 void
 pgm_notify_clear (
 	pgm_notify_t*	notify
 	)
 {
-#if defined( HAVE_EVENTFD )
-	uint64_t u;
-	pgm_assert (NULL != notify);
-	pgm_assert (-1 != notify->eventfd);
-	while (sizeof(u) == read (notify->eventfd, &u, sizeof(u)));
-#elif !defined( _WIN32 )
-	char buf;
-	pgm_assert (NULL != notify);
-	pgm_assert (-1 != notify->pipefd[0]);
-	while (sizeof(buf) == read (notify->pipefd[0], &buf, sizeof(buf)));
-#else
-	char buf;
-	pgm_assert (NULL != notify);
-	pgm_assert (INVALID_SOCKET != notify->s[0]);
-	while (sizeof(buf) == recv (notify->s[0], &buf, sizeof(buf), 0));
-#endif /* HAVE_EVENTFD */
+	(void)pgm_notify_read (notify);
 }
 
 static inline
@@ -296,6 +351,9 @@ pgm_notify_get_socket (
 #if defined( HAVE_EVENTFD )
 	pgm_assert (-1 != notify->eventfd);
 	return notify->eventfd;
+#elif defined( PGM_HAVE_KQUEUE_NOTIFY )
+	pgm_assert (-1 != notify->kq);
+	return notify->kq;
 #elif !defined( _WIN32 )
 	pgm_assert (-1 != notify->pipefd[0]);
 	return notify->pipefd[0];
@@ -32,8 +32,90 @@
 
 PGM_BEGIN_DECLS
 
+/* options of a received packet decoded in one pass, each an offset of the
+ * option header from the PGM header or zero if absent.  held in the control
+ * buffer until the receive window claims it for its own state.
+ */
+
+struct pgm_opt_desc_t {
+	uint16_t	opt_total_length;	/* OPT_LENGTH inclusive, zero without options */
+	uint16_t	opt_fragment;
+	uint16_t	opt_nak_list;
+	uint16_t	opt_parity_prm;
+	uint16_t	opt_sw_prm;
+	uint16_t	opt_sw_repair;
+	uint16_t	opt_batch;
+	uint16_t	opt_catchup;
+	uint16_t	opt_compress;
+	uint16_t	opt_conflate;
+	uint16_t	opt_pgmcc_data;
+	uint16_t	opt_pgmcc_feedback;
+	uint16_t	opt_ack_trail;
+	uint16_t	opt_credit;
+	uint16_t	opt_compact;
+};
+
+/* decoded options in the control buffer, writable by the parser */
+static inline
+struct pgm_opt_desc_t*
+pgm_opt_desc (
+	struct pgm_sk_buff_t*const		skb
+	)
+{
+	return (struct pgm_opt_desc_t*)skb->cb;
+}
+
+static inline
+const struct pgm_opt_desc_t*
+pgm_opt_desc_const (
+	const struct pgm_sk_buff_t*const	skb
+	)
+{
+	return (const struct pgm_opt_desc_t*)skb->cb;
+}
+
+/* option body following the option header, NULL if absent */
+static inline
+const void*
+pgm_opt_body (
+	const struct pgm_sk_buff_t*const	skb,
+	const uint16_t				offset
+	)
+{
+	return (0 == offset) ? NULL : (const char*)skb->pgm_header + offset + sizeof(struct pgm_opt_header);
+}
+
+/* as pgm_opt_body() for the owner of skb that keeps the option in the skbuff */
+static inline
+void*
+pgm_opt_body_mutable (
+	struct pgm_sk_buff_t*const		skb,
+	const uint16_t				offset
+	)
+{
+	return (0 == offset) ? NULL : (char*)skb->pgm_header + offset + sizeof(struct pgm_opt_header);
+}
+
+/* count of sequence numbers in OPT_NAK_LIST */
+static inline
+unsigned
+pgm_opt_nak_list_len (
+	const struct pgm_sk_buff_t*const	skb
+	)
+{
+	const uint16_t offset = pgm_opt_desc_const (skb)->opt_nak_list;
+	if (0 == offset)
+		return 0;
+	const struct pgm_opt_header* opt_header = (const struct pgm_opt_header*)((const char*)skb->pgm_header + offset);
+	return ( opt_header->opt_length - sizeof(struct pgm_opt_header) - sizeof(uint8_t) ) / sizeof(uint32_t);
+}
+
 PGM_GNUC_INTERNAL bool pgm_parse_raw (struct pgm_sk_buff_t*const restrict, struct sockaddr*const restrict, pgm_error_t**restrict);
 PGM_GNUC_INTERNAL bool pgm_parse_udp_encap (struct pgm_sk_buff_t*const restrict, pgm_error_t**restrict);
+PGM_GNUC_INTERNAL void pgm_parse_screen (const struct pgm_iovec*const restrict, const unsigned, const bool, uint8_t*restrict);
+PGM_GNUC_INTERNAL bool pgm_parse_compact (struct pgm_sk_buff_t*const restrict, const pgm_gsi_t*const restrict, const uint32_t, pgm_error_t**restrict);
+PGM_GNUC_INTERNAL bool pgm_verify_checksum (struct pgm_sk_buff_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL bool pgm_verify_checksum_copy (const struct pgm_sk_buff_t*const restrict, void*restrict, const uint16_t) PGM_GNUC_WARN_UNUSED_RESULT;
 PGM_GNUC_INTERNAL bool pgm_verify_spm (const struct pgm_sk_buff_t* const);
 PGM_GNUC_INTERNAL bool pgm_verify_spmr (const struct pgm_sk_buff_t* const);
 PGM_GNUC_INTERNAL bool pgm_verify_nak (const struct pgm_sk_buff_t* const);
@@ -42,6 +124,7 @@ PGM_GNUC_INTERNAL bool pgm_verify_ncf (const struct pgm_sk_buff_t* const);
 PGM_GNUC_INTERNAL bool pgm_verify_poll (const struct pgm_sk_buff_t* const);
 PGM_GNUC_INTERNAL bool pgm_verify_polr (const struct pgm_sk_buff_t* const);
 PGM_GNUC_INTERNAL bool pgm_verify_ack (const struct pgm_sk_buff_t* const);
+PGM_GNUC_INTERNAL bool pgm_parse_options (struct pgm_sk_buff_t*const restrict, const void*const restrict) PGM_GNUC_WARN_UNUSED_RESULT;
 
 PGM_END_DECLS
 
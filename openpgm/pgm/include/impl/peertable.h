@@ -0,0 +1,179 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * open-addressing peer lookup table keyed by TSI.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if !defined (__PGM_IMPL_FRAMEWORK_H_INSIDE__) && !defined (PGM_COMPILATION)
+#	error "Only <framework.h> can be included directly."
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_PEERTABLE_H__
+#define __PGM_IMPL_PEERTABLE_H__
+
+typedef struct pgm_peertable_t pgm_peertable_t;
+
+#include <string.h>
+#if defined(__SSE2__) || defined(_M_AMD64) || defined(_M_X64)
+#	include <emmintrin.h>
+#endif
+#if defined(_MSC_VER)
+#	include <intrin.h>
+#endif
+#include <pgm/types.h>
+#include <pgm/tsi.h>
+
+PGM_BEGIN_DECLS
+
+struct pgm_peer_t;
+
+/* Slots are arranged in groups of 16 with one control byte per slot: the
+ * top bit set marks a free slot, otherwise the low 7 bits hold a fragment
+ * of the key hash.  A probe tests a whole group of control bytes at once
+ * and only compares keys on a fragment match.
+ */
+
+#define PGM_PEERTABLE_GROUP_WIDTH	16
+#define PGM_PEERTABLE_EMPTY		0x80
+#define PGM_PEERTABLE_DELETED		0xfe
+
+struct pgm_peertable_slot_t {
+	uint64_t			key;
+	struct pgm_peer_t*		value;
+};
+
+struct pgm_peertable_t {
+	uint8_t* restrict		ctrl;
+	struct pgm_peertable_slot_t* restrict slots;
+	unsigned			group_mask;	/* group count - 1, power of 2 */
+	unsigned			size;		/* live entries */
+	unsigned			growth_left;	/* free slots before rehash */
+};
+
+PGM_GNUC_INTERNAL pgm_peertable_t* pgm_peertable_new (void) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_peertable_destroy (pgm_peertable_t*);
+PGM_GNUC_INTERNAL void pgm_peertable_insert (pgm_peertable_t*restrict, const pgm_tsi_t*restrict, struct pgm_peer_t*restrict);
+PGM_GNUC_INTERNAL bool pgm_peertable_remove (pgm_peertable_t*restrict, const pgm_tsi_t*restrict);
+
+static inline
+uint64_t
+_pgm_peertable_key (
+	const pgm_tsi_t*	tsi
+	)
+{
+	uint64_t key;
+	memcpy (&key, tsi, sizeof (key));
+	return key;
+}
+
+/* 64-bit finaliser from MurmurHash3, all key bits affect the group index
+ * and the control byte fragment.
+ */
+
+static inline
+uint64_t
+_pgm_peertable_hash (
+	uint64_t		key
+	)
+{
+	key ^= key >> 33;
+	key *= UINT64_C(0xff51afd7ed558ccd);
+	key ^= key >> 33;
+	return key;
+}
+
+/* bit i set in the result for each control byte i in the group equal to c.
+ */
+
+static inline
+unsigned
+_pgm_peertable_match (
+	const uint8_t*		ctrl,
+	const uint8_t		c
+	)
+{
+#if defined(__SSE2__) || defined(_M_AMD64) || defined(_M_X64)
+	const __m128i group = _mm_loadu_si128 ((const __m128i*)ctrl);
+	return (unsigned)_mm_movemask_epi8 (_mm_cmpeq_epi8 (group, _mm_set1_epi8 ((char)c)));
+#else
+	unsigned mask = 0;
+	for (unsigned i = 0; i < PGM_PEERTABLE_GROUP_WIDTH; i++)
+		if (ctrl[i] == c)
+			mask |= 1U << i;
+	return mask;
+#endif
+}
+
+static inline
+unsigned
+_pgm_peertable_ctz (
+	const unsigned		mask
+	)
+{
+#if defined(__GNUC__)
+	return (unsigned)__builtin_ctz (mask);
+#elif defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward (&index, mask);
+	return (unsigned)index;
+#else
+	unsigned i = 0;
+	while (0 == (mask & (1U << i)))
+		i++;
+	return i;
+#endif
+}
+
+/* returns peer with matching TSI, or NULL if not present.
+ */
+
+static inline
+struct pgm_peer_t*
+pgm_peertable_lookup (
+	const pgm_peertable_t* const restrict table,
+	const pgm_tsi_t*       const restrict tsi
+	)
+{
+	const uint64_t key  = _pgm_peertable_key (tsi);
+	const uint64_t hash = _pgm_peertable_hash (key);
+	const uint8_t  h2   = (uint8_t)(hash & 0x7f);
+	unsigned group = (unsigned)(hash >> 7) & table->group_mask;
+
+/* triangular probing visits every group of a power-of-2 table */
+	for (unsigned step = 1;; step++) {
+		const unsigned base = group * PGM_PEERTABLE_GROUP_WIDTH;
+		const uint8_t* ctrl = &table->ctrl[ base ];
+		unsigned mask = _pgm_peertable_match (ctrl, h2);
+		while (mask) {
+			const unsigned i = base + _pgm_peertable_ctz (mask);
+			if (PGM_LIKELY(table->slots[ i ].key == key))
+				return table->slots[ i ].value;
+			mask &= mask - 1;
+		}
+		if (PGM_LIKELY(_pgm_peertable_match (ctrl, PGM_PEERTABLE_EMPTY)))
+			return NULL;
+		group = (group + step) & table->group_mask;
+	}
+}
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_PEERTABLE_H__ */
@@ -15,6 +15,7 @@ PGM_BEGIN_DECLS
 
 /* function declarations */
 PGM_GNUC_INTERNAL bool pgm_mib_init (pgm_error_t**);
+PGM_GNUC_INTERNAL void pgm_mib_shutdown (void);
 
 PGM_GNUC_INTERNAL int send_pgmStart_trap(void);
 PGM_GNUC_INTERNAL int send_pgmStop_trap(void);
@@ -0,0 +1,94 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * cycle accounting of protocol stages.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if !defined (__PGM_IMPL_FRAMEWORK_H_INSIDE__) && !defined (PGM_COMPILATION)
+#	error "Only <framework.h> can be included directly."
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_PROFILE_H__
+#define __PGM_IMPL_PROFILE_H__
+
+#if !defined(HAVE_RDTSC) && defined(HAVE_CLOCK_GETTIME)
+#	include <time.h>
+#elif !defined(HAVE_RDTSC) && !defined(_WIN32)
+#	include <sys/time.h>
+#endif
+#if defined(HAVE_RDTSC) && defined(_MSC_VER)
+#	include <intrin.h>
+#endif
+#include <pgm/types.h>
+#include <pgm/profile.h>
+
+PGM_BEGIN_DECLS
+
+extern bool pgm_profile_enabled;
+
+PGM_GNUC_INTERNAL void pgm__profile (const unsigned, const uint64_t, const unsigned);
+
+/* cycle counter, without serialisation as stages are long against the
+ * reordering window.
+ */
+
+static inline
+uint64_t
+pgm_profile_cycles (void)
+{
+#if defined(HAVE_RDTSC) && !defined(_MSC_VER)
+	uint32_t lo, hi;
+	__asm volatile ("rdtsc" : "=a" (lo), "=d" (hi));
+	return (uint64_t)hi << 32 | lo;
+#elif defined(HAVE_RDTSC)
+	return (uint64_t)__rdtsc ();
+#elif defined(HAVE_CLOCK_GETTIME)
+	struct timespec ts;
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * UINT64_C(1000000000) + (uint64_t)ts.tv_nsec;
+#elif defined(_WIN32)
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter (&counter);
+	return (uint64_t)counter.QuadPart;
+#else
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return (uint64_t)tv.tv_sec * UINT64_C(1000000000) + (uint64_t)tv.tv_usec * 1000;
+#endif
+}
+
+/* open a stage, the counter is only read when profiling is active and a
+ * zero start skips the close.
+ */
+#define PGM_PROFILE_BEGIN(start) \
+	const uint64_t start = PGM_UNLIKELY(pgm_profile_enabled) ? pgm_profile_cycles() : 0
+
+#define PGM_PROFILE_END(stage, start, packets) \
+	do { \
+		if (PGM_UNLIKELY(0 != (start))) \
+			pgm__profile ((stage), pgm_profile_cycles() - (start), (packets)); \
+	} while (0)
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_PROFILE_H__ */
+
+/* eof */
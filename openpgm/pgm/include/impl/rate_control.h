@@ -42,15 +42,18 @@ struct pgm_rate_t {
 	ssize_t		rate_per_msec;
 	size_t		iphdr_len;
 
-	ssize_t		rate_limit;		/* signed for math */
-	pgm_time_t	last_rate_check;
-	pgm_spinlock_t	spinlock;
+	uint64_t	burst_nsecs;		/* bucket depth as time at rate_per_sec */
+	volatile uint64_t tat;			/* theoretical arrival time of next send in nanoseconds */
+	pgm_rate_t*	parent;			/* shared limit charged alongside, NULL = none */
 };
 
 PGM_GNUC_INTERNAL void pgm_rate_create (pgm_rate_t*, const ssize_t, const size_t, const uint16_t);
 PGM_GNUC_INTERNAL void pgm_rate_destroy (pgm_rate_t*);
+PGM_GNUC_INTERNAL void pgm_rate_pace (pgm_rate_t*, const uint16_t);
+PGM_GNUC_INTERNAL void pgm_rate_set (pgm_rate_t*, const ssize_t, const bool, const uint16_t);
 PGM_GNUC_INTERNAL bool pgm_rate_check2 (pgm_rate_t*, pgm_rate_t*, const size_t, const bool);
 PGM_GNUC_INTERNAL bool pgm_rate_check (pgm_rate_t*, const size_t, const bool);
+PGM_GNUC_INTERNAL bool pgm_rate_check_priority (pgm_rate_t*, pgm_rate_t*, const size_t, const bool);
 PGM_GNUC_INTERNAL pgm_time_t pgm_rate_remaining2 (pgm_rate_t*, pgm_rate_t*, const size_t);
 PGM_GNUC_INTERNAL pgm_time_t pgm_rate_remaining (pgm_rate_t*, const size_t);
 
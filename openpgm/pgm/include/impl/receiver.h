@@ -35,6 +35,22 @@ typedef struct pgm_peer_t pgm_peer_t;
 
 PGM_BEGIN_DECLS
 
+/* floor of PGM_NAK_ADAPTIVE intervals, absorbs source scheduling jitter on a LAN */
+#define PGM_NAK_ADAPTIVE_MIN_IVL	pgm_msecs(1)
+
+/* PGM_CATCHUP hold-off of catch-up sequences before falling back to NAKs */
+#define PGM_CATCHUP_DEFAULT_IVL		pgm_secs(2)
+
+/* PGM_DLR advertisement interval, receivers follow an advertisement for three intervals */
+#define PGM_DLR_DEFAULT_IVL		pgm_secs(1)
+#define PGM_DLR_LIFETIME_IVLS		3
+
+/* PGM_SHM_RECV wake-up of a waiting receiver to copy new records */
+#define PGM_SHM_DEFAULT_IVL		pgm_msecs(1)
+
+/* PGM_PEER_IDLE release of receive window storage of a source without data */
+#define PGM_PEER_IDLE_DEFAULT_IVL	pgm_secs(10)
+
 /* Performance Counters */
 
 enum {
@@ -64,7 +80,7 @@ enum {
 	PGM_PC_RECEIVER_NAKS_FAILED_RXW_ADVANCED,
 	PGM_PC_RECEIVER_NAKS_FAILED_NCF_RETRIES_EXCEEDED,
 	PGM_PC_RECEIVER_NAKS_FAILED_DATA_RETRIES_EXCEEDED,
-/*	PGM_PC_RECEIVER_NAKS_FAILED_GEN_EXPIRED */
+	PGM_PC_RECEIVER_NAKS_FAILED_GEN_EXPIRED,		/* delivery deadline passed */
 	PGM_PC_RECEIVER_NAK_FAILURES_DELIVERED,
 	PGM_PC_RECEIVER_SELECTIVE_NAKS_SUPPRESSED,
 	PGM_PC_RECEIVER_NAK_ERRORS,
@@ -88,26 +104,47 @@ struct pgm_peer_t {
 	volatile uint32_t		ref_count;		    /* atomic integer */
 
 	pgm_tsi_t			tsi;
+	in_port_t			dport;			/* data-destination port of the session */
 	struct sockaddr_storage		group_nla;
 	struct sockaddr_storage		nla, local_nla;		/* nla = advertised, local_nla = from packet */
 	struct sockaddr_storage		poll_nla;		/* from parent to direct poll-response */
 	struct sockaddr_storage		redirect_nla;		/* from dlr */
+	pgm_time_t			redirect_expiry;	/* lifetime of redirect_nla, 0 = none */
 	pgm_time_t			polr_expiry;
 	pgm_time_t			spmr_expiry;
 	pgm_time_t			spmr_tstamp;
 
 	pgm_rxw_t*      restrict      	window;
+	struct pgm_sk_buff_t**		dlr_history;		/* as DLR, original data slotted by sequence */
+	uint32_t			dlr_history_len;
 	pgm_list_t			peers_link;
 	pgm_slist_t			pending_link;
+	pgm_slist_t			retired_link;		    /* awaiting grace period */
+	uint32_t			retired_epoch;
 
 	unsigned			is_fec_enabled:1;
 	unsigned			has_proactive_parity:1;	    /* indicating availability from this source */
 	unsigned			has_ondemand_parity:1;
+	unsigned			is_redundant:1;		    /* one of sock::redundant_req */
+	unsigned			is_redundant_drop:1;	    /* chunks of a duplicate APDU follow */
+	unsigned			is_compact:1;		    /* announced OPT_COMPACT, may send PGM_CDATA */
+	unsigned			is_restarted:1;		    /* window opens at restart_next */
 
 	uint32_t			spm_sqn;
+	struct pgm_restart_slot_t*	restart_slot;		    /* PGM_WARM_RESTART, NULL = not recorded */
+	uint32_t			restart_next;		    /* first sequence unread before restart */
 	pgm_time_t			expiry;
+	pgm_time_t			idle_expiry;		    /* window compacted without data, 0 = compact */
+	pgm_time_t			timer_expiry;		    /* key in peers_heap */
+	unsigned			heap_index;
+	pgm_time_t			merge_key;		    /* arrival of next message to read */
+	ssize_t				delivery_deficit;	    /* bytes of the current turn, see sock::delivery_quantum */
 
 	pgm_time_t			ack_rb_expiry;			/* 0 = no ACK pending */
+	pgm_time_t			ack_trail_expiry;		/* next PGM_ACK_TRAIL report, 0 = none */
+	pgm_time_t			credit_expiry;			/* next PGM_CREDIT report, 0 = none */
+	pgm_time_t			credit_tstamp;			/* of credit_bytes */
+	uint64_t			credit_bytes;			/* bytes read by the previous report */
 	pgm_time_t			ack_last_tstamp;		/* in source time reference */
 	pgm_list_t			ack_link;
 
@@ -117,9 +154,9 @@ struct pgm_peer_t {
 	pgm_time_t			last_data_tstamp;		/* local timestamp of ack_last_tstamp */
 	unsigned			last_commit;
 	uint32_t			lost_count;
-	uint32_t			last_cumulative_losses;
-	volatile uint32_t		cumulative_stats[PGM_PC_RECEIVER_MAX];
-	uint32_t			snap_stats[PGM_PC_RECEIVER_MAX];
+	uint64_t			last_cumulative_losses;
+	pgm_stats_t			cumulative_stats;		/* receiver_mutex */
+	uint64_t			snap_stats[PGM_PC_RECEIVER_MAX];
 
 	uint32_t			min_fail_time;
 	uint32_t			max_fail_time;
@@ -127,16 +164,21 @@ struct pgm_peer_t {
 
 PGM_GNUC_INTERNAL pgm_peer_t* pgm_new_peer (pgm_sock_t*const restrict, const pgm_tsi_t*const restrict, const struct sockaddr*const restrict, const socklen_t, const struct sockaddr*const restrict, const socklen_t, const pgm_time_t);
 PGM_GNUC_INTERNAL void pgm_peer_unref (pgm_peer_t*);
+PGM_GNUC_INTERNAL uint32_t pgm_peers_read_lock (pgm_sock_t*const);
+PGM_GNUC_INTERNAL void pgm_peers_read_unlock (pgm_sock_t*const, const uint32_t);
+PGM_GNUC_INTERNAL void pgm_peers_reclaim_all (pgm_sock_t*const);
 PGM_GNUC_INTERNAL int pgm_flush_peers_pending (pgm_sock_t*const restrict, struct pgm_msgv_t**restrict, const struct pgm_msgv_t*const, size_t*const restrict, unsigned*const restrict);
 PGM_GNUC_INTERNAL bool pgm_peer_has_pending (pgm_peer_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
 PGM_GNUC_INTERNAL void pgm_peer_set_pending (pgm_sock_t*const restrict, pgm_peer_t*const restrict);
 PGM_GNUC_INTERNAL bool pgm_check_peer_state (pgm_sock_t*const, const pgm_time_t);
 PGM_GNUC_INTERNAL void pgm_set_reset_error (pgm_sock_t*const restrict, pgm_peer_t*const restrict, struct pgm_msgv_t*const restrict);
 PGM_GNUC_INTERNAL pgm_time_t pgm_min_receiver_expiry (pgm_sock_t*, pgm_time_t) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_peer_update_expiry (pgm_sock_t*const restrict, pgm_peer_t*const restrict);
 PGM_GNUC_INTERNAL bool pgm_on_peer_nak (pgm_sock_t*const restrict, pgm_peer_t*const restrict, struct pgm_sk_buff_t*const restrict) PGM_GNUC_WARN_UNUSED_RESULT;
 PGM_GNUC_INTERNAL bool pgm_on_data (pgm_sock_t*const restrict, pgm_peer_t*const restrict, struct pgm_sk_buff_t*const restrict) PGM_GNUC_WARN_UNUSED_RESULT;
 PGM_GNUC_INTERNAL bool pgm_on_ncf (pgm_sock_t*const restrict, pgm_peer_t*const restrict, struct pgm_sk_buff_t*const restrict) PGM_GNUC_WARN_UNUSED_RESULT;
 PGM_GNUC_INTERNAL bool pgm_on_spm (pgm_sock_t*const restrict, pgm_peer_t*const restrict, struct pgm_sk_buff_t*const restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL bool pgm_send_dlr_poll (pgm_sock_t*const, const pgm_time_t);
 PGM_GNUC_INTERNAL bool pgm_on_poll (pgm_sock_t*const restrict, pgm_peer_t*const restrict, struct pgm_sk_buff_t*const restrict) PGM_GNUC_WARN_UNUSED_RESULT;
 
 PGM_END_DECLS
@@ -0,0 +1,49 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * Recorder of delivered APDUs to segmented log files.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if !defined (__PGM_IMPL_FRAMEWORK_H_INSIDE__) && !defined (PGM_COMPILATION)
+#	error "Only <framework.h> can be included directly."
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_RECORD_H__
+#define __PGM_IMPL_RECORD_H__
+
+struct pgm_recorder_t;
+
+#include <pgm/types.h>
+#include <pgm/error.h>
+#include <pgm/msgv.h>
+#include <pgm/record.h>
+
+PGM_BEGIN_DECLS
+
+PGM_GNUC_INTERNAL struct pgm_recorder_t* pgm_recorder_new (const char*restrict, uint64_t, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_recorder_destroy (struct pgm_recorder_t*const);
+PGM_GNUC_INTERNAL void pgm_recorder_append (struct pgm_recorder_t*const restrict, const struct pgm_msgv_t*const restrict, const unsigned);
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_RECORD_H__ */
+
+/* eof */
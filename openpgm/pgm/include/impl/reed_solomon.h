@@ -32,22 +32,41 @@ typedef struct pgm_rs_t pgm_rs_t;
 
 #include <pgm/types.h>
 #include <impl/galois.h>
+#include <impl/cpu.h>
 
 PGM_BEGIN_DECLS
 
+/* inverted recovery matrices are cached keyed on the offsets vector of the
+ * repair, loss patterns for a transmission group size tend to repeat.
+ */
+#define PGM_RS_CACHE_SIZE	8
+
 struct pgm_rs_t {
 	uint8_t		n, k;		/* RS(n, k) */
 	pgm_gf8_t*	GM;
-	pgm_gf8_t*	RM;
+	pgm_gf8_t*	RM;		/* PGM_RS_CACHE_SIZE recovery matrices, k × k each */
+	uint8_t*	RM_offsets;	/* cache keys, k offsets each */
+	uint32_t	RM_stamp[ PGM_RS_CACHE_SIZE ];	/* last use, 0 when unused */
+	uint32_t	RM_clock;
 };
 
 #define PGM_RS_DEFAULT_N	255
 
+/* parity bytes encoded per pass of pgm_rs_encode_csum(), an even size keeps
+ * each partial checksum word aligned.
+ */
+#define PGM_RS_CSUM_BLOCK	512
+
+PGM_GNUC_INTERNAL void pgm_rs_init (const pgm_cpu_t*);
+PGM_GNUC_INTERNAL void pgm_rs_calibrate (const pgm_cpu_t*);
+PGM_GNUC_INTERNAL const char* pgm_rs_kernel (uint64_t*);
 PGM_GNUC_INTERNAL void pgm_rs_create (pgm_rs_t*, const uint8_t, const uint8_t);
 PGM_GNUC_INTERNAL void pgm_rs_destroy (pgm_rs_t*);
 PGM_GNUC_INTERNAL void pgm_rs_encode (pgm_rs_t*restrict, const pgm_gf8_t**restrict, const uint8_t, pgm_gf8_t*restrict, const uint16_t);
+PGM_GNUC_INTERNAL uint32_t pgm_rs_encode_csum (pgm_rs_t*restrict, const pgm_gf8_t**restrict, const uint16_t*restrict, const uint8_t, pgm_gf8_t*restrict, const uint16_t);
 PGM_GNUC_INTERNAL void pgm_rs_decode_parity_inline (pgm_rs_t*restrict, pgm_gf8_t**restrict, const uint8_t*restrict, const uint16_t);
-PGM_GNUC_INTERNAL void pgm_rs_decode_parity_appended (pgm_rs_t*restrict, pgm_gf8_t**restrict, const uint8_t*restrict, const uint16_t);
+PGM_GNUC_INTERNAL void pgm_gf_vec_addmul (pgm_gf8_t*restrict, const pgm_gf8_t, const pgm_gf8_t*restrict, uint16_t);
+PGM_GNUC_INTERNAL void pgm_rs_decode_parity_appended (pgm_rs_t*restrict, pgm_gf8_t**restrict, const uint16_t*restrict, const uint8_t*restrict, const uint16_t);
 
 PGM_END_DECLS
 
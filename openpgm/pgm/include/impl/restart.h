@@ -0,0 +1,65 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * Receiver state in a named shared memory segment for warm restart.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if !defined (__PGM_IMPL_FRAMEWORK_H_INSIDE__) && !defined (PGM_COMPILATION)
+#	error "Only <framework.h> can be included directly."
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_RESTART_H__
+#define __PGM_IMPL_RESTART_H__
+
+struct pgm_restart_t;
+struct pgm_restart_slot_t;
+
+#include <pgm/types.h>
+#include <pgm/error.h>
+#include <pgm/tsi.h>
+
+PGM_BEGIN_DECLS
+
+/* sources recorded when not specified */
+#define PGM_RESTART_DEFAULT_SOURCES	64
+#define PGM_RESTART_MAX_SOURCES		4096
+
+/* the resume point of one source as last read by the application */
+struct pgm_restart_state_t {
+	pgm_tsi_t			tsi;
+	uint16_t			dport;
+	uint32_t			next;			/* first sequence not read */
+	uint32_t			spm_sqn;
+	struct sockaddr_storage		nla;			/* advertised by SPM, AF_UNSPEC = unknown */
+};
+
+PGM_GNUC_INTERNAL struct pgm_restart_t* pgm_restart_open (const char*restrict, unsigned, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_restart_close (struct pgm_restart_t*);
+PGM_GNUC_INTERNAL unsigned pgm_restart_len (const struct pgm_restart_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL struct pgm_restart_slot_t* pgm_restart_claim (struct pgm_restart_t*const restrict, const pgm_tsi_t*const restrict, const uint16_t, struct pgm_restart_state_t*restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_restart_save (struct pgm_restart_slot_t*const restrict, const struct pgm_restart_state_t*const restrict);
+PGM_GNUC_INTERNAL void pgm_restart_release (struct pgm_restart_t*const restrict, struct pgm_restart_slot_t*const restrict);
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_RESTART_H__ */
+
+/* eof */
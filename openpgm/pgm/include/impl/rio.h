@@ -0,0 +1,67 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * Windows Registered I/O send and receive engine.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if !defined (__PGM_IMPL_FRAMEWORK_H_INSIDE__) && !defined (PGM_COMPILATION)
+#	error "Only <framework.h> can be included directly."
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_RIO_H__
+#define __PGM_IMPL_RIO_H__
+
+struct pgm_rio_t;
+
+#ifdef _WIN32
+#	include <winsock2.h>
+#	include <mswsock.h>
+#endif
+#include <pgm/types.h>
+#include <pgm/skbuff.h>
+
+/* Registered I/O from the Windows 8 SDK */
+#if defined( _WIN32 ) && defined( WSA_FLAG_REGISTERED_IO )
+#	define PGM_HAVE_RIO		1
+#endif
+
+PGM_BEGIN_DECLS
+
+/* maximum operations kept in flight per direction */
+#define PGM_MAX_RIO_DEPTH		4096
+
+struct pgm_sock_t;
+
+#ifdef PGM_HAVE_RIO
+PGM_GNUC_INTERNAL SOCKET pgm_rio_socket (const int, const int, const int);
+PGM_GNUC_INTERNAL struct pgm_rio_t* pgm_rio_new (struct pgm_sock_t*const, const unsigned) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_rio_destroy (struct pgm_rio_t*const);
+PGM_GNUC_INTERNAL ssize_t pgm_rio_recvmsg (struct pgm_rio_t*const restrict, struct pgm_sk_buff_t*const restrict, struct sockaddr*const restrict, const socklen_t, WSAMSG*const restrict);
+PGM_GNUC_INTERNAL ssize_t pgm_rio_sendto (struct pgm_rio_t*const restrict, const void*restrict, const size_t, const struct sockaddr*restrict, const socklen_t);
+PGM_GNUC_INTERNAL bool pgm_rio_is_pending (const struct pgm_rio_t*const);
+PGM_GNUC_INTERNAL SOCKET pgm_rio_get_socket (const struct pgm_rio_t*const) PGM_GNUC_PURE;
+#endif
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_RIO_H__ */
+
+/* eof */
@@ -0,0 +1,58 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * random linear codes over GF(2⁸) for sliding window forward error correction.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if !defined (__PGM_IMPL_FRAMEWORK_H_INSIDE__) && !defined (PGM_COMPILATION)
+#	error "Only <framework.h> can be included directly."
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_RLC_H__
+#define __PGM_IMPL_RLC_H__
+
+#include <pgm/types.h>
+#include <pgm/packet.h>
+#include <pgm/skbuff.h>
+#include <impl/galois.h>
+
+PGM_BEGIN_DECLS
+
+/* a repair covers at most PGM_RLC_MAX_WINDOW source packets ending at its
+ * data_sqn, receivers solve for at most PGM_RLC_MAX_UNKNOWNS missing packets
+ * from as many held repairs.
+ */
+#define PGM_RLC_MAX_WINDOW	64
+#define PGM_RLC_MAX_UNKNOWNS	16
+#define PGM_RLC_UNSOLVED	0xff
+
+/* every source symbol is its TSDU length and fragment option followed by the
+ * payload, zero extended to the longest covered packet.
+ */
+#define PGM_RLC_SYMBOL_HEADER	( sizeof(uint16_t) + sizeof(struct pgm_opt_fragment) )
+
+PGM_GNUC_INTERNAL pgm_gf8_t pgm_rlc_coefficient (const uint16_t, const uint32_t) PGM_GNUC_CONST;
+PGM_GNUC_INTERNAL void pgm_rlc_encode (pgm_gf8_t*restrict, const pgm_gf8_t, const struct pgm_sk_buff_t*restrict);
+PGM_GNUC_INTERNAL void pgm_rlc_solve (pgm_gf8_t*restrict, pgm_gf8_t**restrict, const uint8_t, const uint8_t, const uint16_t, uint8_t*restrict);
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_RLC_H__ */
@@ -33,11 +33,33 @@ typedef struct pgm_rwspinlock_t pgm_rwspinlock_t;
 
 #include <pgm/types.h>
 #include <impl/ticket.h>
+#if defined( USE_MCS_SPINLOCK )
+#	include <impl/mcs.h>
+#endif
 
 PGM_BEGIN_DECLS
 
+/* writers serialise on a ticket or queued spinlock */
+#if defined( USE_MCS_SPINLOCK )
+typedef pgm_mcs_t			pgm_rwspinlock_writer_t;
+#	define _pgm_rwspinlock_init		pgm_mcs_init
+#	define _pgm_rwspinlock_free		pgm_mcs_free
+#	define _pgm_rwspinlock_trylock		pgm_mcs_trylock
+#	define _pgm_rwspinlock_lock		pgm_mcs_lock
+#	define _pgm_rwspinlock_unlock		pgm_mcs_unlock
+#	define _pgm_rwspinlock_is_unlocked	pgm_mcs_is_unlocked
+#else
+typedef pgm_ticket_t			pgm_rwspinlock_writer_t;
+#	define _pgm_rwspinlock_init		pgm_ticket_init
+#	define _pgm_rwspinlock_free		pgm_ticket_free
+#	define _pgm_rwspinlock_trylock		pgm_ticket_trylock
+#	define _pgm_rwspinlock_lock		pgm_ticket_lock
+#	define _pgm_rwspinlock_unlock		pgm_ticket_unlock
+#	define _pgm_rwspinlock_is_unlocked	pgm_ticket_is_unlocked
+#endif
+
 struct pgm_rwspinlock_t {
-	pgm_ticket_t		lock;
+	pgm_rwspinlock_writer_t	lock;
 	volatile uint32_t	readers;
 };
 
@@ -45,19 +67,19 @@ struct pgm_rwspinlock_t {
 /* read-write lock */
 
 static inline void pgm_rwspinlock_init (pgm_rwspinlock_t* rwspinlock) {
-	pgm_ticket_init (&rwspinlock->lock);
+	_pgm_rwspinlock_init (&rwspinlock->lock);
 	rwspinlock->readers = 0;
 }
 
 static inline void pgm_rwspinlock_free (pgm_rwspinlock_t* rwspinlock) {
-	pgm_ticket_free (&rwspinlock->lock);
+	_pgm_rwspinlock_free (&rwspinlock->lock);
 }
 
 static inline void pgm_rwspinlock_reader_lock (pgm_rwspinlock_t* rwspinlock) {
 	for (;;) {
 #if defined( _WIN32 ) || defined( __i386__ ) || defined( __i386 ) || defined( __x86_64__ ) || defined( __amd64 )
 		unsigned spins = 0;
-		while (!pgm_ticket_is_unlocked (&rwspinlock->lock))
+		while (!_pgm_rwspinlock_is_unlocked (&rwspinlock->lock))
 			if (!pgm_smp_system || (++spins > PGM_ADAPTIVE_MUTEX_SPINCOUNT))
 #	ifdef _WIN32
 				SwitchToThread();
@@ -72,12 +94,12 @@ static inline void pgm_rwspinlock_reader_lock (pgm_rwspinlock_t* rwspinlock) {
 				__asm volatile ("pause" ::: "memory");
 #	endif
 #else
-		while (!pgm_ticket_is_unlocked (&rwspinlock->lock))
+		while (!_pgm_rwspinlock_is_unlocked (&rwspinlock->lock))
 			sched_yield();
 #endif
 /* speculative lock */
 		pgm_atomic_inc32 (&rwspinlock->readers);
-		if (pgm_ticket_is_unlocked (&rwspinlock->lock))
+		if (_pgm_rwspinlock_is_unlocked (&rwspinlock->lock))
 			return;
 		pgm_atomic_dec32 (&rwspinlock->readers);
 	}
@@ -85,7 +107,7 @@ static inline void pgm_rwspinlock_reader_lock (pgm_rwspinlock_t* rwspinlock) {
 
 static inline bool pgm_rwspinlock_reader_trylock (pgm_rwspinlock_t* rwspinlock) {
 	pgm_atomic_inc32 (&rwspinlock->readers);
-	if (pgm_ticket_is_unlocked (&rwspinlock->lock))
+	if (_pgm_rwspinlock_is_unlocked (&rwspinlock->lock))
 		return TRUE;
 	pgm_atomic_dec32 (&rwspinlock->readers);
 	return FALSE;
@@ -98,7 +120,7 @@ static inline void pgm_rwspinlock_reader_unlock (pgm_rwspinlock_t* rwspinlock) {
 static inline void pgm_rwspinlock_writer_lock (pgm_rwspinlock_t* rwspinlock) {
 #if defined( _WIN32 ) || defined( __i386__ ) || defined( __i386 ) || defined( __x86_64__ ) || defined( __amd64 )
 	unsigned spins = 0;
-	pgm_ticket_lock (&rwspinlock->lock);
+	_pgm_rwspinlock_lock (&rwspinlock->lock);
 	while (rwspinlock->readers)
 		if (!pgm_smp_system || (++spins > PGM_ADAPTIVE_MUTEX_SPINCOUNT))
 #	ifdef _WIN32
@@ -113,7 +135,7 @@ static inline void pgm_rwspinlock_writer_lock (pgm_rwspinlock_t* rwspinlock) {
 			__asm volatile ("pause" ::: "memory");
 #	endif
 #else
-	pgm_ticket_lock (&rwspinlock->lock);
+	_pgm_rwspinlock_lock (&rwspinlock->lock);
 	while (rwspinlock->readers)
 		sched_yield();
 #endif
@@ -122,17 +144,17 @@ static inline void pgm_rwspinlock_writer_lock (pgm_rwspinlock_t* rwspinlock) {
 static inline bool pgm_rwspinlock_writer_trylock (pgm_rwspinlock_t* rwspinlock) {
 	if (rwspinlock->readers)
 		return FALSE;
-	if (!pgm_ticket_trylock (&rwspinlock->lock))
+	if (!_pgm_rwspinlock_trylock (&rwspinlock->lock))
 		return FALSE;
 	if (rwspinlock->readers) {
-		pgm_ticket_unlock (&rwspinlock->lock);
+		_pgm_rwspinlock_unlock (&rwspinlock->lock);
 		return FALSE;
 	}
 	return TRUE;
 }
 
 static inline void pgm_rwspinlock_writer_unlock (pgm_rwspinlock_t* rwspinlock) {
-	pgm_ticket_unlock (&rwspinlock->lock);
+	_pgm_rwspinlock_unlock (&rwspinlock->lock);
 }
 
 PGM_END_DECLS
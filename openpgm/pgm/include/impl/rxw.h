@@ -27,6 +27,7 @@
 
 typedef struct pgm_rxw_state_t pgm_rxw_state_t;
 typedef struct pgm_rxw_t pgm_rxw_t;
+typedef struct pgm_rxw_decoder_t pgm_rxw_decoder_t;
 
 #include <impl/framework.h>
 
@@ -63,12 +64,17 @@ struct pgm_rxw_state_t {
 	pgm_time_t	timer_expiry;
         int		pkt_state;
 
+	uint32_t	fill_time;		/* repair latency, 0 for original data */
+	pgm_time_t	nak_tstamp;		/* NAK sent or NCF received, 0 = none */
+
 	uint8_t		nak_transmit_count;	/* 8-bit for size constraints */
         uint8_t		ncf_retry_count;
         uint8_t		data_retry_count;
 
 /* only valid on tg_sqn::pkt_sqn = 0 */
 	unsigned	is_contiguous:1;	/* transmission group */
+
+	unsigned	is_conflated:1;		/* superseded by a later APDU of the key */
 };
 
 struct pgm_rxw_t {
@@ -85,6 +91,8 @@ struct pgm_rxw_t {
 	uint32_t		committed_count;	/* but still in window */
 
         uint16_t		max_tpdu;               /* maximum packet size */
+	pgm_skb_pool_t*		skb_pool;		/* shared with socket, may be NULL */
+	pgm_rxw_decoder_t*	decoder;		/* shared with socket, NULL = decode inline */
         uint32_t		lead, trail;
         uint32_t		rxw_trail, rxw_trail_init;
 	uint32_t		commit_lead;
@@ -95,44 +103,91 @@ struct pgm_rxw_t {
 	pgm_rs_t		rs;
 	uint32_t		tg_size;		/* transmission group size for parity recovery */
 	uint8_t			tg_sqn_shift;
+	unsigned		is_sw_available:1;
+	uint8_t			sw_window;		/* maximum packets per sliding window repair */
+	pgm_queue_t		sw_repairs;		/* held repairs, newest at head */
+	pgm_queue_t		batch_skbs;		/* messages unpacked from OPT_BATCH or spilled, freed on commit */
+	uint32_t		batch_sqn;		/* OPT_BATCH packet partially read at commit lead */
+	uint16_t		batch_offset;		/* bytes of batch_sqn read, 0 = none */
+	struct pgm_compress_t*	decompressor;		/* shared with socket, NULL = compressed APDUs discarded */
+	const struct pgm_spill_req_t* spill_req;	/* shared with socket, NULL = unread APDUs lost on a full window */
+	struct pgm_spill_t*	spill;			/* created on first spill, replayed ahead of the window */
+	pgm_time_t		delivery_deadline;	/* placeholder age before repair is abandoned, 0 = none */
+	uint32_t		jump_sqns;		/* unread sequences dropped at once on a full window, 0 = lost one by one */
+	uint64_t		cumulative_jumped;
+	const struct pgm_conflate_req_t* conflate_req;	/* shared with socket, NULL = every APDU delivered */
+	struct pgm_conflate_t*	conflate;		/* key to newest sequence, created on first key */
+	pgm_skb_pool_t*		placement_pool;		/* shared with socket, NULL = fragments delivered as received */
+	struct pgm_sk_buff_t**	placed;			/* APDU under reassembly by first sequence, created on first fragment */
+	uint32_t		apdu_first;		/* APDU at commit lead partially verified */
+	uint32_t		apdu_next;		/* first sequence not yet verified */
+	uint32_t		apdu_commit_lead;	/* commit lead when verified */
+	unsigned		apdu_tpdus;		/* fragments verified, 0 = none */
+	size_t			apdu_size;		/* bytes verified */
+	uint32_t		max_apdu;		/* streamed beyond PGM_MAX_APDU, 0 = off */
+	uint32_t		stream_first;		/* APDU partially delivered */
+	uint32_t		stream_next;		/* sequence of next chunk */
+	unsigned		is_streaming:1;
 
 	uint32_t		bitmap;			/* receive status of last 32 packets */
 	uint32_t		data_loss;		/* p */
 	uint32_t		ack_c_p;		/* constant Cᵨ */
 
-/* counters all guint32 */
+/* repair round trip estimates from first NAK transmissions, 0 = no sample */
+	pgm_time_t		ncf_srtt, ncf_rttvar;	/* NAK to NCF */
+	pgm_time_t		rdata_srtt, rdata_rttvar;	/* NCF to RDATA */
+
+/* counters */
 	uint32_t		min_fill_time;		/* restricted from pgm_time_t */
 	uint32_t		max_fill_time;
 	uint32_t		min_nak_transmit_count;
 	uint32_t		max_nak_transmit_count;
-	uint32_t		cumulative_losses;
-	uint32_t		bytes_delivered;
-	uint32_t		msgs_delivered;
+	uint64_t		cumulative_losses;
+	uint64_t		bytes_delivered;
+	uint64_t		msgs_delivered;
 
 	size_t			size;			/* in bytes */
-	unsigned		alloc;			/* in pkts */
-/* C90 and older */
-	struct pgm_sk_buff_t*   pdata[1];
+	unsigned		max_alloc;		/* configured window in pkts */
+	unsigned		alloc;			/* in pkts, grows on demand to max_alloc, 0 = none */
+	unsigned		mask;			/* alloc - 1 if a power of two, else 0 */
+	const pgm_mem_policy_t*	policy;			/* placement of pdata, NULL = heap */
+/* one bit per pdata slot, set while the slot holds received data or parity */
+	uint64_t* restrict	data_map;
+	uint64_t* restrict	parity_map;
+	struct pgm_sk_buff_t**	pdata;
 };
 
 
-PGM_GNUC_INTERNAL pgm_rxw_t* pgm_rxw_create (const pgm_tsi_t*const, const uint16_t, const unsigned, const unsigned, const ssize_t, const uint32_t) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL pgm_rxw_t* pgm_rxw_create (const pgm_tsi_t*const, const uint16_t, const unsigned, const unsigned, const ssize_t, const uint32_t, const pgm_mem_policy_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
 PGM_GNUC_INTERNAL void pgm_rxw_destroy (pgm_rxw_t*const);
 PGM_GNUC_INTERNAL int pgm_rxw_add (pgm_rxw_t*const restrict, struct pgm_sk_buff_t*const restrict, const pgm_time_t, const pgm_time_t) PGM_GNUC_WARN_UNUSED_RESULT;
 PGM_GNUC_INTERNAL void pgm_rxw_add_ack (pgm_rxw_t*const restrict, struct pgm_sk_buff_t*const restrict, const pgm_time_t);
 PGM_GNUC_INTERNAL void pgm_rxw_remove_ack (pgm_rxw_t*const restrict, struct pgm_sk_buff_t*const restrict);
 PGM_GNUC_INTERNAL void pgm_rxw_remove_commit (pgm_rxw_t*const);
 PGM_GNUC_INTERNAL ssize_t pgm_rxw_readv (pgm_rxw_t*const restrict, struct pgm_msgv_t** restrict, const unsigned) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL pgm_time_t pgm_rxw_next_tstamp (const pgm_rxw_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
 PGM_GNUC_INTERNAL unsigned pgm_rxw_remove_trail (pgm_rxw_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
 PGM_GNUC_INTERNAL unsigned pgm_rxw_update (pgm_rxw_t*const, const uint32_t, const uint32_t, const pgm_time_t, const pgm_time_t) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL unsigned pgm_rxw_catchup (pgm_rxw_t*const, const uint32_t, const uint32_t, const pgm_time_t, const pgm_time_t);
 PGM_GNUC_INTERNAL void pgm_rxw_update_fec (pgm_rxw_t*const, const uint8_t);
+PGM_GNUC_INTERNAL void pgm_rxw_update_sw (pgm_rxw_t*const, const uint8_t);
+PGM_GNUC_INTERNAL void pgm_rxw_compact (pgm_rxw_t*const);
+PGM_GNUC_INTERNAL int pgm_rxw_add_repair (pgm_rxw_t*const restrict, struct pgm_sk_buff_t*const restrict, const uint8_t, const uint16_t, const pgm_time_t, const pgm_time_t) PGM_GNUC_WARN_UNUSED_RESULT;
 PGM_GNUC_INTERNAL int pgm_rxw_confirm (pgm_rxw_t*const, const uint32_t, const pgm_time_t, const pgm_time_t, const pgm_time_t) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL uint32_t pgm_rxw_confirm_range (pgm_rxw_t*const, uint32_t, uint32_t, const pgm_time_t, const pgm_time_t, const pgm_time_t, bool*const);
 PGM_GNUC_INTERNAL void pgm_rxw_lost (pgm_rxw_t*const, const uint32_t);
 PGM_GNUC_INTERNAL void pgm_rxw_state (pgm_rxw_t*const restrict, struct pgm_sk_buff_t*const restrict, const int);
 PGM_GNUC_INTERNAL struct pgm_sk_buff_t* pgm_rxw_peek (pgm_rxw_t*const, const uint32_t) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL bool pgm_rxw_is_duplicate (const pgm_rxw_t*const, const uint32_t) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL bool pgm_rxw_ack_trail (const pgm_rxw_t*const restrict, uint32_t*const restrict) PGM_GNUC_WARN_UNUSED_RESULT;
 PGM_GNUC_INTERNAL const char* pgm_pkt_state_string (const int) PGM_GNUC_WARN_UNUSED_RESULT;
 PGM_GNUC_INTERNAL const char* pgm_rxw_returns_string (const int) PGM_GNUC_WARN_UNUSED_RESULT;
 PGM_GNUC_INTERNAL void pgm_rxw_dump (const pgm_rxw_t*const);
+PGM_GNUC_INTERNAL pgm_rxw_decoder_t* pgm_rxw_decoder_create (const unsigned, pgm_notify_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_rxw_decoder_destroy (pgm_rxw_decoder_t*const);
+PGM_GNUC_INTERNAL bool pgm_rxw_decoder_is_pending (const pgm_rxw_decoder_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL bool pgm_rxw_decoder_acknowledge (pgm_rxw_decoder_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL pgm_rxw_t* pgm_rxw_decoder_complete (pgm_rxw_decoder_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
 
 /* declare for GCC attributes */
 static inline unsigned pgm_rxw_max_length (const pgm_rxw_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
@@ -142,6 +197,8 @@ static inline bool pgm_rxw_is_empty (const pgm_rxw_t*const) PGM_GNUC_WARN_UNUSED
 static inline bool pgm_rxw_is_full (const pgm_rxw_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
 static inline uint32_t pgm_rxw_lead (const pgm_rxw_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
 static inline uint32_t pgm_rxw_next_lead (const pgm_rxw_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
+static inline pgm_time_t pgm_rxw_expiry (const pgm_rxw_t*const, const struct pgm_sk_buff_t*const, const pgm_time_t) PGM_GNUC_WARN_UNUSED_RESULT;
+static inline bool pgm_rxw_is_overdue (const pgm_rxw_t*const, const struct pgm_sk_buff_t*const, const pgm_time_t) PGM_GNUC_WARN_UNUSED_RESULT;
 
 static inline
 unsigned
@@ -150,7 +207,7 @@ pgm_rxw_max_length (
 	)
 {
 	pgm_assert (NULL != window);
-	return window->alloc;
+	return window->max_alloc;
 }
 
 static inline
@@ -213,6 +270,39 @@ pgm_rxw_next_lead (
 	return (uint32_t)(pgm_rxw_lead (window) + 1);
 }
 
+/* earlier of expiry and the delivery deadline of placeholder skb.
+ */
+
+static inline
+pgm_time_t
+pgm_rxw_expiry (
+	const pgm_rxw_t*	     const window,
+	const struct pgm_sk_buff_t* const skb,
+	const pgm_time_t		   expiry
+	)
+{
+	pgm_assert (NULL != window);
+	pgm_assert (NULL != skb);
+	if (window->delivery_deadline &&
+	    pgm_time_after (expiry, skb->tstamp + window->delivery_deadline))
+		return skb->tstamp + window->delivery_deadline;
+	return expiry;
+}
+
+static inline
+bool
+pgm_rxw_is_overdue (
+	const pgm_rxw_t*	     const window,
+	const struct pgm_sk_buff_t* const skb,
+	const pgm_time_t		   now
+	)
+{
+	pgm_assert (NULL != window);
+	pgm_assert (NULL != skb);
+	return window->delivery_deadline &&
+	       pgm_time_after_eq (now, skb->tstamp + window->delivery_deadline);
+}
+
 PGM_END_DECLS
 
 #endif /* __PGM_IMPL_RXW_H__ */
@@ -0,0 +1,100 @@
+/* vim:ts=8:sts=4:sw=4:noai:noexpandtab
+ * 
+ * Fixed size skbuff pool.
+ *
+ * Copyright (c) 2006-2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if !defined (__PGM_IMPL_FRAMEWORK_H_INSIDE__) && !defined (PGM_COMPILATION)
+#	error "Only <framework.h> can be included directly."
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_SKBUFF_H__
+#define __PGM_IMPL_SKBUFF_H__
+
+typedef struct pgm_skb_pool_t pgm_skb_pool_t;
+
+#include <pgm/types.h>
+#include <pgm/skbuff.h>
+#include <impl/budget.h>
+#include <impl/mem.h>
+#include <impl/thread.h>
+
+PGM_BEGIN_DECLS
+
+/* minimum skbuffs allocated per slab when the free list is exhausted */
+#define PGM_SKB_POOL_SLAB_LEN		64
+
+/* receive size classes of 256, 512 and 1024 bytes for small packets */
+#define PGM_SKB_CLASS_MIN		256
+#define PGM_SKB_CLASSES			3
+
+struct pgm_skb_pool_t {
+	uint16_t			size;			/* payload of each skbuff */
+	size_t				stride;			/* aligned skbuff + payload */
+	unsigned			slab_len;		/* skbuffs per slab */
+	pgm_mem_policy_t		policy;			/* slab placement */
+	pgm_spinlock_t			lock;
+	struct pgm_sk_buff_t*		free_list;		/* chained via link_.next */
+	void*				slabs;			/* chained via first word */
+	unsigned			outstanding;		/* allocated skbuffs */
+	char*				ring;			/* contiguous byte store, NULL = slabs */
+	size_t				ring_len;
+	size_t				ring_head;		/* next entry offset */
+	size_t				ring_tail;		/* oldest entry offset */
+	size_t				ring_used;		/* bytes from tail to head */
+	pgm_budget_t*			budget;			/* charged per outstanding skbuff or whole ring */
+	bool				is_destroyed;		/* release when outstanding = 0 */
+	bool				is_single_threaded;	/* unlocked, skbuffs with plain reference counts */
+	bool				is_fixed;		/* slab of application memory, not grown */
+};
+
+PGM_GNUC_INTERNAL pgm_skb_pool_t* pgm_skb_pool_new (const uint16_t, const pgm_mem_policy_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL pgm_skb_pool_t* pgm_skb_pool_new_fixed (const uint16_t, void*const, const size_t) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL pgm_skb_pool_t* pgm_skb_pool_new_ring (const uint16_t, const size_t, const pgm_mem_policy_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_skb_pool_destroy (pgm_skb_pool_t*const);
+PGM_GNUC_INTERNAL void pgm_skb_pool_set_budget (pgm_skb_pool_t*const restrict, pgm_budget_t*const restrict);
+PGM_GNUC_INTERNAL void pgm_skb_pool_trim (struct pgm_sk_buff_t*const);
+PGM_GNUC_INTERNAL struct pgm_sk_buff_t* pgm_skb_pool_copy (pgm_skb_pool_t*const, const struct pgm_sk_buff_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL struct pgm_sk_buff_t* pgm_skb_pool_alloc (pgm_skb_pool_t*const, const uint16_t) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL struct pgm_sk_buff_t* pgm_skb_pool_alloc_subsys (pgm_skb_pool_t*const, const uint16_t, const unsigned) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL struct pgm_sk_buff_t* pgm_alloc_skb_subsys (const uint16_t, const unsigned) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_skb_pool_release_list (struct pgm_sk_buff_t*);
+
+/* drop a reference as pgm_free_skb(), on the last reference the skbuff is
+ * chained on to list for one pgm_skb_pool_release_list() call.
+ */
+
+static inline
+void
+pgm_free_skb_deferred (
+	struct pgm_sk_buff_t*const  restrict skb,
+	struct pgm_sk_buff_t**const restrict list
+	)
+{
+	if (skb->is_private ? 0 == --skb->users : pgm_atomic_exchange_and_add32 (&skb->users, (uint32_t)-1) == 1) {
+		skb->link_.next = (void*)*list;
+		*list = skb;
+	}
+}
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_SKBUFF_H__ */
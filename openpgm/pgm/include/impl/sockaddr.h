@@ -61,6 +61,7 @@ PGM_BEGIN_DECLS
 #	define PGM_SOCK_EHOSTUNREACH		EHOSTUNREACH
 #	define PGM_SOCK_EINTR			EINTR
 #	define PGM_SOCK_EINVAL			EINVAL
+#	define PGM_SOCK_EMSGSIZE		EMSGSIZE
 #	define PGM_SOCK_ENETUNREACH		ENETUNREACH
 #	define PGM_SOCK_ENOBUFS			ENOBUFS
 #	define closesocket			close
@@ -102,6 +103,7 @@ pgm_gai_strerror_s (char* buffer, size_t size, int errnum)
 #	define PGM_SOCK_EHOSTUNREACH		WSAEHOSTUNREACH
 #	define PGM_SOCK_EINTR			WSAEINTR
 #	define PGM_SOCK_EINVAL			WSAEINVAL
+#	define PGM_SOCK_EMSGSIZE		WSAEMSGSIZE
 #	define PGM_SOCK_ENETUNREACH		WSAENETUNREACH
 #	define PGM_SOCK_ENOBUFS			WSAENOBUFS
 #	define pgm_get_last_sock_error()	WSAGetLastError()
@@ -141,6 +143,8 @@ PGM_GNUC_INTERNAL int pgm_sockaddr_hdrincl (const SOCKET s, const sa_family_t sa
 PGM_GNUC_INTERNAL int pgm_sockaddr_pktinfo (const SOCKET s, const sa_family_t sa_family, const bool v);
 PGM_GNUC_INTERNAL int pgm_sockaddr_router_alert (const SOCKET s, const sa_family_t sa_family, const bool v);
 PGM_GNUC_INTERNAL int pgm_sockaddr_tos (const SOCKET s, const sa_family_t sa_family, const int tos);
+PGM_GNUC_INTERNAL int pgm_sockaddr_pmtudisc (const SOCKET s, const sa_family_t sa_family, const int mode);
+PGM_GNUC_INTERNAL int pgm_sockaddr_path_mtu (const SOCKET s, const sa_family_t sa_family);
 PGM_GNUC_INTERNAL int pgm_sockaddr_join_group (const SOCKET s, const sa_family_t sa_family, const struct group_req* gr);
 PGM_GNUC_INTERNAL int pgm_sockaddr_leave_group (const SOCKET s, const sa_family_t sa_family, const struct group_req* gr);
 PGM_GNUC_INTERNAL int pgm_sockaddr_block_source (const SOCKET s, const sa_family_t sa_family, const struct group_source_req* gsr);
@@ -162,6 +166,7 @@ PGM_GNUC_INTERNAL int pgm_sockaddr_leave_source_group (const SOCKET s, const sa_
 PGM_GNUC_INTERNAL int pgm_sockaddr_msfilter (const SOCKET s, const sa_family_t sa_family, const struct group_filter* gf_list);
 PGM_GNUC_INTERNAL int pgm_sockaddr_multicast_if (const SOCKET s, const struct sockaddr* address, const unsigned ifindex);
 PGM_GNUC_INTERNAL int pgm_sockaddr_multicast_loop (const SOCKET s, const sa_family_t sa_family, const bool v);
+PGM_GNUC_INTERNAL int pgm_sockaddr_multicast_all (const SOCKET s, const sa_family_t sa_family, const bool v);
 PGM_GNUC_INTERNAL int pgm_sockaddr_multicast_hops (const SOCKET s, const sa_family_t sa_family, const unsigned hops);
 PGM_GNUC_INTERNAL void pgm_sockaddr_nonblocking (const SOCKET s, const bool v);
 
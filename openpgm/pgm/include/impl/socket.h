@@ -30,6 +30,7 @@ struct pgm_sock_t;
 #include <impl/framework.h>
 #include <impl/txw.h>
 #include <impl/source.h>
+#include <impl/congestion.h>
 
 PGM_BEGIN_DECLS
 
@@ -37,23 +38,83 @@ PGM_BEGIN_DECLS
 #	define IP_MAX_MEMBERSHIPS	20
 #endif
 
+/* maximum group memberships per PGM socket, across PGM_RECV_SOCKETS */
+#define PGM_MAX_MEMBERSHIPS		65536
+
+/* maximum datagrams read per recvmmsg() call */
+#define PGM_MAX_RECV_BATCH		64
+
+/* maximum FEC decoder threads per PGM socket */
+#define PGM_MAX_FEC_DECODE_THREADS	16
+
+/* maximum kernel receive sockets per PGM socket for SO_REUSEPORT fan-in */
+#define PGM_MAX_RECV_SOCKETS		8
+
+/* maximum pgm_send_skbv() and pgm_send_file() datagrams awaiting MSG_ZEROCOPY completion, power of 2 */
+#define PGM_ZEROCOPY_MAX_PENDING	1024
+
+/* receive buffer for one UDP_GRO coalesced super-datagram */
+#define PGM_UDP_GRO_BUFLEN		UINT16_MAX
+
+struct mmsghdr;
+
+/* ring of preallocated receive buffers for recvmmsg() */
+struct pgm_recv_batch_t {
+	unsigned			count;				/* datagrams read by last syscall */
+	unsigned			index;				/* next datagram to process */
+	pgm_time_t			tstamp;				/* arrival of the batch, 0 when stale */
+	pgm_time_t			realtime;			/* system clock at tstamp for SO_TIMESTAMPING */
+	struct pgm_sk_buff_t**		skb;
+	struct mmsghdr*			msgvec;
+	struct pgm_iovec*		iov;
+	struct sockaddr_storage*	addr;				/* source addresses */
+	char*				aux;				/* control messages */
+	uint8_t*			type;				/* from pgm_parse_screen(), PGM_MAX to discard */
+};
+
+/* UDP_GRO coalesced datagram pending segmentation */
+struct pgm_recv_gro_t {
+	size_t				len;				/* total read by last syscall */
+	size_t				offset;				/* next segment to process */
+	size_t				segment_len;			/* from UDP_GRO control message */
+	pgm_time_t			tstamp;				/* arrival of the datagram, 0 when stale */
+	pgm_time_t			realtime;			/* system clock at tstamp for SO_TIMESTAMPING */
+	pgm_time_t			kernel_time;			/* system clock from SO_TIMESTAMPING, 0 = none */
+	struct sockaddr_storage		src_addr;
+	struct sockaddr_storage		dst_addr;
+	char*				buf;				/* PGM_UDP_GRO_BUFLEN bytes */
+};
+
+/* sources of a multi-stream source, PGM_STREAM_GROUP.  membership changes under
+ * pgm_sock_list_lock, the send sockets are closed by the last member.
+ */
+struct pgm_stream_group_t {
+	pgm_rate_t			rate_control;			/* whole group, parent of each member bucket */
+	pgm_slist_t*			members;
+	uint32_t			weight_total;
+	SOCKET				send_sock;
+	SOCKET				send_with_router_alert_sock;
+};
+
+/* members are grouped by the thread that writes them: read mostly configuration,
+ * the sending thread, the receiving thread and timer, and the statistics.  each
+ * written group starts on a new cache line so a sending thread and a receiving
+ * thread on the same socket do not contend for lines.
+ */
+
 struct pgm_sock_t {
+/* configuration, read mostly after bind */
 	sa_family_t			family;				/* communications domain */
 	int				socket_type;
 	int				protocol;
 	pgm_tsi_t           		tsi;
 	in_port_t			dport;
+	in_port_t*			rx_dports;			/* additional data-destination ports, sorted */
+	unsigned			rx_dports_len;
 	in_port_t			udp_encap_ucast_port;
 	in_port_t			udp_encap_mcast_port;
 	uint32_t			rand_node_id;			/* node identifier */
 
-	pgm_rwlock_t			lock;				/* running / destroyed */
-	pgm_mutex_t			receiver_mutex;			/* receiver API */
-	pgm_mutex_t			source_mutex;			/* source API */
-	pgm_spinlock_t			txw_spinlock;			/* transmit window */
-	pgm_mutex_t			send_mutex;			/* non-router alert socket */
-	pgm_mutex_t			timer_mutex;			/* next timer expiration */
-
 	bool				is_bound;
 	bool				is_connected;
 	bool				is_destroyed;
@@ -70,28 +131,47 @@ struct pgm_sock_t {
 	struct sockaddr_storage		send_addr;			/* unicast nla */
 	SOCKET				send_sock;
 	SOCKET				send_with_router_alert_sock;
-	struct group_source_req 	recv_gsr[IP_MAX_MEMBERSHIPS];	/* sa_family = 0 terminated */
+	SOCKET				send_path_sock[PGM_MAX_SEND_PATHS - 1];	/* PGM_SEND_PATHS */
+	unsigned			send_path_len;
+	uint32_t			send_path_mode;			/* PGM_PATH_* */
+	SOCKET				send_port_sock[PGM_MAX_SEND_PORTS - 1];	/* PGM_PORTS_PER_TG */
+	unsigned			send_port_len;
+	struct group_source_req*	recv_gsr;			/* grown on join */
 	unsigned			recv_gsr_len;
+	unsigned			recv_gsr_size;
 	SOCKET				recv_sock;
+	SOCKET				recv_sock_extra[PGM_MAX_RECV_SOCKETS - 1];	/* SO_REUSEPORT fan-in */
+	unsigned			recv_sock_extra_len;
+	uint32_t			rxq_ovfl[PGM_MAX_RECV_SOCKETS];	/* last SO_RXQ_OVFL count per socket */
+	pgm_time_t			rxq_overrun_expiry;	    /* new NAKs held back until */
 
 	size_t				max_apdu;
+	size_t				large_apdu;		    /* streamed beyond PGM_MAX_APDU, 0 = off */
 	uint16_t			max_tpdu;
 	uint16_t			max_tsdu;		    /* excluding optional var_pktlen word */
 	uint16_t			max_tsdu_fragment;
 	size_t				iphdr_len;
+	int				pmtud_mode;		    /* PGM_PMTUD_* */
+	volatile uint32_t		path_mtu;		    /* learnt below max_tpdu, then fragmented, 0 = none */
 	bool				use_multicast_loop;    	    /* and reuseaddr for UDP encapsulation */
+	bool				use_udp_gso;		    /* UDP segmentation offload */
+	bool				use_hops_cmsg;		    /* hop limit as ancillary data, else setsockopt() */
+	bool				is_send_connected;	    /* send_sock connect()ed to send_gsr */
+	bool				use_zerocopy;		    /* MSG_ZEROCOPY for pgm_send_skbv(), pgm_send_file() */
+	bool				use_pacing;		    /* space TPDUs at the rate limit */
+	bool				use_timer_thread;	    /* timers and repairs off the application */
+	bool				use_timer_pool;		    /* timer thread shared across sockets */
+	bool				is_single_threaded;	    /* no socket locks, no internal threads */
 	unsigned			hops;
+	int				tos;			    /* PGM_TOS, restored after a per-datagram class */
 	unsigned			txw_sqns, txw_secs;
 	unsigned			rxw_sqns, rxw_secs;
 	ssize_t				txw_max_rte, rxw_max_rte;
 	ssize_t				odata_max_rte;
 	ssize_t				rdata_max_rte;
 	size_t				sndbuf, rcvbuf;		    /* setsockopt (SO_SNDBUF/SO_RCVBUF) */
+	unsigned			autobuf_msecs;		    /* size both from the rates, 0 = off */
 
-	pgm_txw_t* restrict    		window;
-	pgm_rate_t			rate_control;
-	pgm_rate_t			odata_rate_control;
-	pgm_rate_t			rdata_rate_control;
 	pgm_time_t			adv_ivl;		/* advancing with data */
 	unsigned			adv_mode;		/* 0 = time, 1 = data */
 	bool				is_controlled_spm;
@@ -100,9 +180,201 @@ struct pgm_sock_t {
 
 	bool				use_cr;			/* congestion reports */
 	bool				use_pgmcc;		/* congestion control */
-	bool				is_pending_crqst;
+	unsigned			cc_algorithm;		/* PGM_CC_* */
+	const struct pgm_cc_ops_t*	cc;
 	unsigned			ack_c;			/* constant C */
 	unsigned			ack_c_p;		/* constant Cᵨ */
+	pgm_time_t			ack_expiry_ivl;
+	pgm_time_t			crqst_ivl;
+	pgm_time_t			ack_bo_ivl;
+
+	pgm_notify_t			ack_notify;
+	pgm_notify_t			rdata_notify;
+	pgm_notify_t			pending_notify;		    /* timer to rx */
+	pgm_notify_t			timer_notify;		    /* source to timer thread */
+	struct pgm_timer_thread_t* restrict timer_thread;
+	struct pgm_timer_pool_sock_t* restrict timer_pool_sock;
+	bool				use_timer_fd;		    /* PGM_TIMER_FD */
+	SOCKET				timer_fd;		    /* timerfd armed at next_poll */
+	pgm_time_t			timer_fd_expiry;	    /* last armed */
+	SOCKET				timer_kq;		    /* kqueue of pgm_kqueue_ctl() for EVFILT_TIMER */
+
+	unsigned			spm_ambient_interval;	    /* microseconds */
+	unsigned* restrict		spm_heartbeat_interval;     /* zero terminated, zero lead-pad */
+	unsigned			spm_heartbeat_len;
+	unsigned			peer_expiry;		    /* from absence of SPMs */
+	unsigned			spmr_expiry;		    /* waiting for peer SPMRs */
+	unsigned			linger_ivl;		    /* repairs served after pgm_close_async() */
+	unsigned			peer_idle_ivl;		    /* compact idle peer windows, 0 = never */
+
+	unsigned			nak_data_retries, nak_ncf_retries;
+	pgm_time_t			nak_bo_ivl, nak_rpt_ivl, nak_rdata_ivl;
+	pgm_time_t			delivery_deadline;	    /* placeholder age abandoning repair, 0 = none */
+	unsigned			slow_consumer_jump;	    /* percent of a full window dropped at once, 0 = reset */
+	bool				use_nak_adaptive;	    /* intervals follow per peer repair RTT */
+
+	bool				use_proactive_parity;
+	bool				use_ondemand_parity;
+	bool				use_var_pktlen;
+	bool				use_fec_worker;		    /* proactive parity off the send path */
+	uint8_t				rs_n;
+	uint8_t				rs_k;
+	uint8_t				rs_proactive_h;		    /* 0 <= proactive-h <= ( n - k ) */
+	uint8_t				rs_proactive_max_h;	    /* configured, ceiling of adaptive FEC */
+	bool				use_adaptive_fec;	    /* proactive parity follows receiver loss */
+	unsigned			fec_decode_threads;	    /* receiver reconstruction threads, 0 = inline */
+	unsigned			fec_tg_count;		    /* transmission groups since last sample */
+	volatile uint32_t		fec_nak_count;		    /* packets reported lost by NAKs */
+	uint32_t			fec_nak_last;		    /* fec_nak_count at last sample */
+	volatile uint32_t		fec_feedback_loss;	    /* ACKer loss rate, 16-bit fixed point */
+	uint32_t			fec_loss;		    /* smoothed loss fraction, 16-bit fixed point */
+	uint8_t				tg_sqn_shift;
+	bool				use_sliding_fec;
+	uint8_t				sw_window;		    /* source packets per repair */
+	uint8_t				sw_interval;		    /* source packets between repairs */
+	uint16_t			sw_key;			    /* coefficient seed of next repair */
+	pgm_skb_pool_t* restrict	skb_pool;		    /* max_tpdu sized skbuffs */
+	pgm_skb_pool_t* restrict	txw_skb_pool;		    /* ring store or skb_pool */
+	size_t				txw_ring_len;		    /* ring store bytes, 0 = disabled */
+	struct pgm_txw_store_req_t	txw_store_req;		    /* history file, ts_path empty = disabled */
+	struct pgm_txw_store_t*		txw_store;		    /* opened at bind, attached to the window */
+	struct pgm_standby_req_t	standby_req;		    /* sb_ivl 0 = disabled */
+	struct pgm_txw_store_t*		standby;		    /* store of the primary, read-only until take over */
+	uint32_t			standby_lead;		    /* primary progress last seen */
+	uint32_t			standby_spm_sqn;
+	pgm_time_t			standby_progress;	    /* when last seen to advance */
+	volatile uint32_t		is_standby;		    /* silent, sends would block */
+	struct pgm_warm_restart_req_t	warm_restart_req;	    /* resume points, wr_name empty = disabled */
+	struct pgm_restart_t*		restart;		    /* opened at bind by a receiver */
+	struct pgm_local_req_t		local_req;		    /* fan-out ring, lr_name empty = disabled */
+	pgm_local_t*			local;			    /* created at bind by a receiver */
+	struct pgm_shm_req_t		shm_req;		    /* receiver: same-host store, sr_path empty = disabled */
+	struct pgm_txw_store_t*		rx_shm;			    /* attached at bind, read-only */
+	uint32_t			rx_shm_next;		    /* next sequence to copy */
+	pgm_time_t			rx_shm_ivl;		    /* poll interval whilst waiting */
+	bool				is_rx_shm;		    /* sock::rx_buffer copied from the store */
+	bool				is_rx_shm_yield;	    /* network read before next copy */
+	bool				use_rx_size_classes;	    /* copy small packets down before the receive window */
+	pgm_skb_pool_t*			rx_class_pool[PGM_SKB_CLASSES];	/* smallest first, NULL at or above max_tpdu */
+	unsigned			rx_batch_len;		    /* recvmmsg() batch size, 0 = disabled */
+	bool				use_udp_gro;		    /* UDP receive offload */
+	unsigned			timestamping;		    /* receive time stamps, 0 = off, 1 = kernel, 2 = NIC */
+	unsigned			tx_timestamping;	    /* ODATA transmit time stamps, 0 = off, 1 = kernel, 2 = NIC */
+	unsigned			busy_poll_usecs;	    /* spin before sleeping, 0 = disabled */
+	uint32_t			rx_shard_count;		    /* 0 = all sources */
+	uint32_t			rx_shard_index;
+	unsigned			rx_uring_depth;		    /* io_uring receive operations, 0 = disabled */
+	unsigned			rio_depth;		    /* Registered I/O operations, 0 = disabled */
+	struct pgm_xdp_req_t		rx_xdp_req;		    /* AF_XDP queue, xr_interface 0 = disabled */
+	struct pgm_verbs_req_t		verbs_req;		    /* RDMA UD multicast, vr_port 0 = disabled */
+	struct pgm_dpdk_req_t		dpdk_req;		    /* DPDK ethdev queue, dr_device "" = disabled */
+	struct pgm_tpacket_req_t	rx_tpacket_req;		    /* TPACKET_V3 ring, tr_interface 0 = disabled */
+	struct pgm_filter_req_t		rx_filter_req;		    /* classic BPF on the receive sockets */
+	bool				use_recv_filter;
+	struct pgm_source_filter_req_t	rx_source_filter;	    /* sorted, checked before peer creation */
+	struct pgm_capture_req_t	capture_req;		    /* pcapng ring file, cr_path empty = disabled */
+	struct pgm_capture_t*		capture;		    /* opened at bind, read by send and receive paths */
+	struct pgm_record_req_t		record_req;		    /* rr_path empty = disabled */
+	struct pgm_recorder_t*		recorder;		    /* opened at bind, written by the receive path */
+	struct pgm_impair_req_t		impair_req;		    /* default pgm_impair_env */
+	struct pgm_impair_t*		rx_impair;		    /* created at bind per ir_direction */
+	struct pgm_impair_t*		tx_impair;
+	struct pgm_delivery_req_t	delivery_req;		    /* dr_func NULL = pgm_recvmsgv() */
+	bool				is_delivery_stopped;	    /* reset under abort-on-reset */
+	struct pgm_handoff_t*		handoff;		    /* PGM_HANDOFF_RING, NULL = pgm_recvmsgv() */
+	unsigned			handoff_len;		    /* slots, power of two, 0 = disabled */
+	pgm_notify_t			handoff_notify;		    /* APDUs published to a waiting consumer */
+	unsigned			rx_checksum;		    /* PGM_CHECKSUM_* receive verification policy */
+	unsigned			tx_checksum;		    /* PGM_CHECKSUM_* for sent ODATA and RDATA */
+	bool				use_pow2_windows;	    /* round window sizes up for mask indexing */
+	struct pgm_mem_req_t		mem_req;		    /* window page size and NUMA node */
+	pgm_mem_policy_t		mem_policy;		    /* resolved at bind */
+	struct pgm_batch_req_t		batch_req;		    /* coalescing of pgm_send_batch() */
+	char* restrict			batch_buf;		    /* pending length-prefixed messages */
+	uint16_t			batch_max;		    /* batch_buf size, 0 = disabled */
+	uint16_t			batch_len;		    /* bytes pending */
+	uint16_t			batch_count;		    /* messages pending */
+	pgm_time_t			batch_expiry;		    /* flush time of pending messages, 0 = none */
+	struct pgm_compress_req_t	compress_req;		    /* cr_dict aliases compress_dict */
+	void*				compress_dict;		    /* owned copy of the dictionary, NULL = none */
+	struct pgm_compress_t*		compress;		    /* encoder and decoders, NULL = disabled */
+	char* restrict			compress_buf;		    /* compressed APDU of pgm_send(), NULL = not compressing */
+	size_t				compress_len;		    /* bytes of a blocked compressed APDU, 0 = none */
+	struct pgm_conflate_req_t	conflate_req;		    /* cf_len 0 = disabled */
+	struct pgm_conflate_t*		conflate;		    /* source key to last sequence, NULL = disabled */
+	struct pgm_placement_req_t	placement_req;		    /* pr_len 0 = disabled */
+	pgm_skb_pool_t*			placement_pool;		    /* carved from placement_req, shared with windows */
+	struct pgm_ack_trail_req_t	ack_trail_req;		    /* at_ivl 0 = disabled */
+	struct pgm_ack_trail_t* restrict ack_trail;		    /* source reporting receivers, NULL = disabled */
+	unsigned			ack_trail_len;
+	struct pgm_nak_limit_req_t	nak_limit_req;		    /* nl_rate 0 = disabled */
+	struct pgm_nak_limit_t* restrict nak_limit;		    /* NAKing receivers, NULL = disabled */
+	unsigned			nak_limit_len;
+	struct pgm_credit_req_t		credit_req;		    /* cr_ivl 0 = disabled */
+	struct pgm_fanout_req_t		fanout_req;		    /* fr_len 0 = send group, ports resolved on bind */
+	unsigned			compact_tsdu;		    /* PGM_CDATA up to this TSDU length, 0 = disabled */
+	struct pgm_credit_t* restrict	credit;			    /* source election set, NULL = disabled */
+	unsigned			credit_len;
+	ssize_t				credit_rate;		    /* slowest of the election set, 0 = none */
+	pgm_budget_t			budget;			    /* packet buffers of every window, parent is the process */
+	struct pgm_stream_req_t		stream_req;		    /* sr_sock NULL = not joining */
+	struct pgm_priority_req_t	priority_req[PGM_PRIORITY_CLASSES];  /* pr_max_rte 0 = class disabled */
+	struct pgm_send_path_req_t	send_path_req;		    /* sp_len 0 = bound interface only */
+	struct pgm_send_port_req_t	send_port_req;		    /* pt_mode 0 = one ephemeral port */
+	struct pgm_stream_group_t*	stream_group;		    /* shared send sockets and rate, NULL = none */
+	struct pgm_sendq_msg_t** restrict sendq;		    /* copied APDUs pending send, head resumable */
+	unsigned			sendq_max;		    /* sendq slots, 0 = disabled */
+	unsigned			sendq_head;		    /* slot of next to send */
+	unsigned			sendq_len;		    /* APDUs queued */
+	pgm_notify_t			sendq_notify;		    /* queue drained or space after full */
+	pgm_time_t			sendq_expiry;		    /* retry time of blocked head, 0 = none */
+	struct pgm_mp_slot_t* restrict	mp_ring;		    /* PGM_MULTI_PRODUCER publication slots, NULL = disabled */
+	unsigned			mp_len;			    /* slots, power of two, 0 = disabled */
+	struct pgm_nak_req_t* restrict	nak_pending;		    /* repair requests awaiting aggregation */
+	unsigned			nak_pending_len;
+	pgm_time_t			nak_aggregate_ivl;	    /* 0 = repair immediately */
+	pgm_time_t			nak_aggregate_expiry;	    /* flush time of pending requests, 0 = none */
+	pgm_mutex_t			nak_mutex;		    /* nak_pending */
+	struct pgm_catchup_t* restrict	catchup;		    /* unicast catch-up streams */
+	unsigned			catchup_len;
+	ssize_t				catchup_max_rte;	    /* bytes per second, 0 = disabled */
+	pgm_rate_t			catchup_rate_control;
+	pgm_mutex_t			catchup_mutex;		    /* catchup */
+	uint32_t			catchup_sqns;		    /* receiver: sequences requested on late join, 0 = disabled */
+	pgm_time_t			catchup_ivl;		    /* receiver: NAK hold-off of requested sequences */
+	uint32_t			dlr_sqns;		    /* receiver: designated local repairer history, 0 = disabled */
+	pgm_time_t			dlr_ivl;		    /* advertisement interval */
+	pgm_time_t			next_dlr_poll;
+	uint32_t			dlr_poll_sqn;
+	ssize_t				dlr_max_rte;		    /* bytes per second, 0 = unlimited */
+	pgm_rate_t			dlr_rate_control;
+
+/* taken shared by every API call */
+	PGM_ALIGNED(PGM_CACHELINE_SIZE)
+	pgm_rwlock_t			lock;				/* running / destroyed */
+
+/* multi-producer cursors, reserved by any thread, committed under source_mutex */
+	PGM_ALIGNED(PGM_CACHELINE_SIZE)
+	volatile uint32_t		mp_reserve;			/* next ticket */
+	PGM_ALIGNED(PGM_CACHELINE_SIZE)
+	volatile uint32_t		mp_commit;			/* next ticket to send */
+
+/* source, written per packet by the sending thread */
+	PGM_ALIGNED(PGM_CACHELINE_SIZE)
+	pgm_mutex_t			source_mutex;			/* source API */
+	pgm_mutex_t			send_mutex;			/* non-router alert socket state, see is_send_locked() */
+	pgm_txw_t* restrict    		window;
+	pgm_odata_copy_func		odata_copy;			/* send path bound at bind */
+	struct pgm_odata_tmpl_t		odata_tmpl;			/* ODATA header template */
+	pgm_rate_t			rate_control;
+	pgm_rate_t			odata_rate_control;
+	pgm_rate_t			rdata_rate_control;
+	pgm_rate_t			priority_rate_control[PGM_PRIORITY_CLASSES];	/* class 0 unused */
+	pgm_time_t			tx_writable;		    /* device queue estimated clear after ENOBUFS, 0 = clear */
+	pgm_time_t			tx_backoff_ivl;
+	volatile uint32_t		send_path_next;		    /* PGM_PATH_STRIPE rotation */
+
+	bool				is_pending_crqst;
 	uint32_t			ssthresh;		/* slow-start threshold */
 	uint32_t			tokens;
 	uint32_t			cwnd_size;		/* congestion window size */
@@ -112,19 +384,15 @@ struct pgm_sock_t {
 	uint32_t			suspended_sqn;
 	bool				is_congested;
 	pgm_time_t			ack_expiry;
-	pgm_time_t			ack_expiry_ivl;
 	pgm_time_t			next_crqst;
-	pgm_time_t			crqst_ivl;
-	pgm_time_t			ack_bo_ivl;
 	struct sockaddr_storage		acker_nla;
 	uint64_t			acker_loss;
+	struct pgm_acker_t		acker_table[PGM_ACKER_TABLE_SIZE];
+	struct pgm_cc_bbr_t		bbr;
 
-	pgm_notify_t			ack_notify;
-	pgm_notify_t			rdata_notify;
-
-	pgm_hash_t			last_hash_key;
-	void* restrict			last_hash_value;
-	unsigned			last_commit;
+	uint32_t			zc_head, zc_tail;	    /* completion ids issued, released */
+	struct pgm_sk_buff_t** restrict	zc_skb;			    /* referenced until completion */
+	char*				tx_tstamp_buf;		    /* datagram returned with a transmit time stamp */
 	size_t				blocklen;		    /* length of buffer blocked */
 	bool				is_apdu_eagain;		    /* writer-lock on window_lock exists as send would block */
 	bool				is_spm_eagain;		    /* writer-lock in receiver */
@@ -140,40 +408,65 @@ struct pgm_sock_t {
 		unsigned			vector_index;
 		size_t				vector_offset;
 		bool				is_rate_limited;
+		unsigned			priority;	/* class of pgm_send_priority(), 0 = pgm_send() */
+		struct pgm_sk_buff_t*		skbv[PGM_MAX_FRAGMENTS];	/* batch pending send, referenced */
+		unsigned			skbv_len;
+		unsigned			skbv_offset;
 	} pkt_dontwait_state;
 
 	uint32_t			spm_sqn;
-	unsigned			spm_ambient_interval;	    /* microseconds */
-	unsigned* restrict		spm_heartbeat_interval;     /* zero terminated, zero lead-pad */
 	unsigned			spm_heartbeat_state;	    /* indexof spm_heartbeat_interval */
-	unsigned			spm_heartbeat_len;
-	unsigned			peer_expiry;		    /* from absence of SPMs */
-	unsigned			spmr_expiry;		    /* waiting for peer SPMRs */
-
-	pgm_rand_t			rand_;			    /* for calculating nak_rb_ivl from nak_bo_ivl */
-	unsigned			nak_data_retries, nak_ncf_retries;
-	pgm_time_t			nak_bo_ivl, nak_rpt_ivl, nak_rdata_ivl;
 	pgm_time_t			next_heartbeat_spm, next_ambient_spm;
 
-	bool				use_proactive_parity;
-	bool				use_ondemand_parity;
-	bool				use_var_pktlen;
-	uint8_t				rs_n;
-	uint8_t				rs_k;
-	uint8_t				rs_proactive_h;		    /* 0 <= proactive-h <= ( n - k ) */
-	uint8_t				tg_sqn_shift;
+/* receiver, written per packet by the receiving thread */
+	PGM_ALIGNED(PGM_CACHELINE_SIZE)
+	pgm_mutex_t			receiver_mutex;			/* receiver API */
 	struct pgm_sk_buff_t* restrict	rx_buffer;
+	struct pgm_recv_batch_t* restrict rx_batch;
+	struct pgm_recv_gro_t* restrict	rx_gro;
+	struct pgm_recv_uring_t* restrict rx_uring;
+	struct pgm_rio_t* restrict	rio;			    /* Registered I/O, send side under send_mutex */
+	struct pgm_recv_xdp_t* restrict	rx_xdp;
+	struct pgm_verbs_t* restrict	verbs;			    /* RDMA UD multicast, send side locked within */
+	struct pgm_dpdk_t* restrict	dpdk;			    /* DPDK ethdev queue, send side locked within */
+	struct pgm_recv_tpacket_t* restrict rx_tpacket;
+	struct pgm_rxw_decoder_t* restrict rx_decoder;	    /* FEC decoder threads, NULL = inline */
+	unsigned			recv_sock_index;		/* socket next read, 0 = recv_sock */
+	pgm_rand_t			rand_;			    /* for calculating nak_rb_ivl from nak_bo_ivl */
 
-	pgm_rwlock_t			peers_lock;
-	pgm_hashtable_t* restrict	peers_hashtable;	    /* fast lookup */
+	void* restrict			last_hash_value;
+	unsigned			last_commit;
+
+	volatile uint32_t		peers_epoch;		    /* peer reclamation */
+	volatile uint32_t		peers_readers[2];	    /* monitoring readers by epoch parity */
+	pgm_slist_t*     restrict	peers_retired;		    /* expired, awaiting grace period */
+	pgm_peertable_t* restrict	peers_hashtable;	    /* fast lookup */
 	pgm_list_t*      restrict	peers_list;		    /* easy iteration */
-	pgm_slist_t*     restrict	peers_pending;		    /* rxw: have or lost data */
-	pgm_notify_t			pending_notify;		    /* timer to rx */
+	pgm_peer_t**     restrict	peers_heap;		    /* ordered by next timer */
+	unsigned			peers_heap_len;
+	unsigned			peers_heap_alloc;
+	pgm_slist_t*			peers_pending;		    /* rxw: have or lost data, FIFO */
+	pgm_slist_t*			peers_pending_tail;
+	uint32_t			delivery_quantum;	    /* bytes per source turn, 0 = read each source in full */
+	pgm_peer_t**     restrict	merge_heap;		    /* pending peers by next arrival */
+	unsigned			merge_heap_alloc;
+	struct pgm_nak_batch_t*		nak_batch;		    /* NAKs of a timer sweep, receiver.c */
+	bool				use_merge_delivery;	    /* interleave sources by arrival */
+	struct pgm_spill_req_t		spill_req;		    /* sr_dir aliases spill_dir, sr_size 0 = disabled */
+	char*				spill_dir;		    /* owned copy of the directory, NULL = default */
+	struct pgm_redundant_req_t	redundant_req;		    /* rr_tsi_len 0 = disabled */
+	uint64_t			redundant_key;		    /* last delivered */
+	bool				has_redundant_key;
 	bool				is_pending_read;
-	pgm_time_t			next_poll;
 
-	uint32_t			cumulative_stats[PGM_PC_SOURCE_MAX];
-	uint32_t			snap_stats[PGM_PC_SOURCE_MAX];
+/* next timer expiration, written by either thread under timer_mutex, read without */
+	PGM_ALIGNED(PGM_CACHELINE_SIZE)
+	pgm_mutex_t			timer_mutex;			/* next timer expiration */
+	volatile pgm_time_t		next_poll;
+
+	PGM_ALIGNED(PGM_CACHELINE_SIZE)
+	pgm_stats_t			cumulative_stats[PGM_STATS_BLOCKS];	/* by writing context */
+	uint64_t			snap_stats[PGM_PC_SOURCE_MAX];
 	pgm_time_t			snap_time;
 };
 
@@ -183,6 +476,53 @@ extern pgm_rwlock_t pgm_sock_list_lock;
 extern pgm_slist_t* pgm_sock_list;
 
 size_t pgm_pkt_offset (bool, sa_family_t);
+PGM_GNUC_INTERNAL void pgm_reaper_shutdown (void);
+PGM_GNUC_INTERNAL unsigned pgm_poll_info_len (const pgm_sock_t*const, const short) PGM_GNUC_PURE PGM_GNUC_WARN_UNUSED_RESULT;
+
+/* socket locks taken on the data path, elided where PGM_SINGLE_THREADED
+ * declares the application the only caller and no internal thread runs.
+ */
+
+static inline
+bool
+pgm_sock_reader_trylock (
+	pgm_sock_t* const sock
+	)
+{
+	return sock->is_single_threaded || pgm_rwlock_reader_trylock (&sock->lock);
+}
+
+static inline
+void
+pgm_sock_reader_unlock (
+	pgm_sock_t* const sock
+	)
+{
+	if (!sock->is_single_threaded)
+		pgm_rwlock_reader_unlock (&sock->lock);
+}
+
+static inline
+void
+pgm_sock_mutex_lock (
+	const pgm_sock_t* const	sock,
+	pgm_mutex_t* const	mutex
+	)
+{
+	if (!sock->is_single_threaded)
+		pgm_mutex_lock (mutex);
+}
+
+static inline
+void
+pgm_sock_mutex_unlock (
+	const pgm_sock_t* const	sock,
+	pgm_mutex_t* const	mutex
+	)
+{
+	if (!sock->is_single_threaded)
+		pgm_mutex_unlock (mutex);
+}
 
 PGM_END_DECLS
 
@@ -60,15 +60,110 @@ enum {
 	PGM_PC_SOURCE_PARITY_NNAKS_RECEIVED,
 	PGM_PC_SOURCE_SELECTIVE_NNAKS_RECEIVED,
 	PGM_PC_SOURCE_NNAK_ERRORS,
+	PGM_PC_SOURCE_RXQ_DROPS,			/* kernel receive queue overrun */
+	PGM_PC_SOURCE_PEERS_REFUSED,			/* memory budget reached */
+	PGM_PC_SOURCE_NAKS_RATE_LIMITED,		/* sequences over a receiver NAK limit */
+	PGM_PC_SOURCE_RECEIVERS_DEMOTED,
 
 /* marker */
 	PGM_PC_SOURCE_MAX
 };
 
+/* one original data TPDU from callee owned memory, specialised per configuration */
+typedef int (*pgm_odata_copy_func)(pgm_sock_t*const restrict, const void*restrict, const uint16_t, const uint16_t, size_t*restrict);
+
+/* invariant PGM header of ODATA packets with its partial checksums */
+struct pgm_odata_tmpl_t {
+	struct pgm_header		header;			/* pgm_options and pgm_tsdu_length zero */
+	uint32_t			unfolded_header;	/* without options */
+	uint32_t			unfolded_header_opt;	/* with PGM_OPT_PRESENT */
+};
+
+/* repair requests held by PGM_NAK_AGGREGATE_IVL */
+#define PGM_NAK_AGGREGATE_MAX	1024
+
+/* one NAKed sequence, or transmission group and packet count for a parity NAK */
+struct pgm_nak_req_t {
+	uint32_t			sqn;
+	uint8_t				tg_count;		/* packets of the group in the originating NAK */
+	bool				is_parity;
+};
+
+/* unicast catch-up streams of PGM_CATCHUP_RATE served concurrently */
+#define PGM_CATCHUP_MAX		8
+
+/* packets per stream per timer dispatch */
+#define PGM_CATCHUP_BATCH	64
+
+/* one receiver catching up, the sequences [next, end) remain */
+struct pgm_catchup_t {
+	struct sockaddr_storage		addr;
+	uint32_t			next;
+	uint32_t			end;
+};
+
+/* receivers reporting a PGM_ACK_TRAIL contiguous lead */
+#define PGM_ACK_TRAIL_MAX	64
+
+/* report intervals without a report before a receiver is forgotten */
+#define PGM_ACK_TRAIL_EXPIRY_IVLS	4
+
+/* one reporting receiver */
+struct pgm_ack_trail_t {
+	struct sockaddr_storage		addr;
+	uint32_t			lead;
+	pgm_time_t			expiry;
+};
+
+/* one receiver of PGM_NAK_LIMIT, credit in sequences scaled by PGM_NAK_LIMIT_UNIT */
+#define PGM_NAK_LIMIT_UNIT	UINT64_C(1000000)
+
+struct pgm_nak_limit_t {
+	struct pgm_nak_limit_stat_t	stat;
+	uint64_t			credit;
+	pgm_time_t			refill;			/* last NAK */
+	pgm_time_t			last_refused;
+	uint32_t			strikes;		/* sequences refused towards demotion */
+};
+
+/* receivers electing the PGM_CREDIT original data rate */
+#define PGM_CREDIT_MAX		64
+
+/* report intervals without a report before a receiver is forgotten */
+#define PGM_CREDIT_EXPIRY_IVLS	4
+
+/* one reporting receiver, rate it can take in bytes per second */
+struct pgm_credit_t {
+	struct sockaddr_storage		addr;
+	ssize_t				rate;
+	pgm_time_t			expiry;
+};
+
+/* APDU copied into the send queue of PGM_SEND_QUEUE */
+struct pgm_sendq_msg_t {
+	size_t				len;
+	char				data[];
+};
+
+/* maximum slots of the PGM_MULTI_PRODUCER publication ring */
+#define PGM_MP_MAX_SLOTS	65536
+
+/* publication slot, holds the TSDU of a ticket once published counts its lap */
+struct pgm_mp_slot_t {
+	struct pgm_sk_buff_t*		skb;
+	volatile uint32_t		published;
+};
+
+PGM_GNUC_INTERNAL void pgm_source_select_send (pgm_sock_t*const);
 PGM_GNUC_INTERNAL bool pgm_send_spm (pgm_sock_t*const, const int) PGM_GNUC_WARN_UNUSED_RESULT;
 PGM_GNUC_INTERNAL bool pgm_on_deferred_nak (pgm_sock_t*const);
+PGM_GNUC_INTERNAL bool pgm_on_batch_expiry (pgm_sock_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL pgm_time_t pgm_on_sendq_expiry (pgm_sock_t*const);
+PGM_GNUC_INTERNAL void pgm_on_nak_aggregate_expiry (pgm_sock_t*const);
+PGM_GNUC_INTERNAL pgm_time_t pgm_on_catchup (pgm_sock_t*const);
+PGM_GNUC_INTERNAL pgm_time_t pgm_on_standby (pgm_sock_t*const, const pgm_time_t);
 PGM_GNUC_INTERNAL bool pgm_on_spmr (pgm_sock_t*const restrict, pgm_peer_t*const restrict, struct pgm_sk_buff_t*const restrict) PGM_GNUC_WARN_UNUSED_RESULT;
-PGM_GNUC_INTERNAL bool pgm_on_nak (pgm_sock_t*const restrict, struct pgm_sk_buff_t*const restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL bool pgm_on_nak (pgm_sock_t*const restrict, struct pgm_sk_buff_t*const restrict, const struct sockaddr*const restrict) PGM_GNUC_WARN_UNUSED_RESULT;
 PGM_GNUC_INTERNAL bool pgm_on_nnak (pgm_sock_t*const restrict, struct pgm_sk_buff_t*const restrict) PGM_GNUC_WARN_UNUSED_RESULT;
 PGM_GNUC_INTERNAL bool pgm_on_ack (pgm_sock_t*const restrict, struct pgm_sk_buff_t*const restrict) PGM_GNUC_WARN_UNUSED_RESULT;
 
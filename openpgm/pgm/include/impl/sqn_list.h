@@ -36,6 +36,51 @@ struct pgm_sqn_list_t {
 	uint32_t		sqn[63];	/* list of sequence numbers */
 };
 
+/* run-length encoded losses, a run is [first, first + count).  On the wire
+ * each run is expanded into NAK_LIST chunks of up to 63 sequence numbers.
+ */
+
+#define PGM_MAX_SQN_RANGES	64
+
+struct pgm_sqn_range_t {
+	uint32_t		first;
+	uint32_t		count;
+};
+
+struct pgm_sqn_range_list_t {
+	unsigned		len;
+	uint32_t		total;		/* sequence numbers over all runs */
+	struct pgm_sqn_range_t	range[PGM_MAX_SQN_RANGES];
+};
+
+/* append a sequence number, extending the last run if consecutive.
+ *
+ * returns FALSE if a new run is needed and the list is full.
+ */
+
+static inline
+bool
+pgm_sqn_range_list_add (
+	struct pgm_sqn_range_list_t* const	list,
+	const uint32_t				sqn
+	)
+{
+	if (list->len > 0) {
+		struct pgm_sqn_range_t* last = &list->range[ list->len - 1 ];
+		if (sqn == last->first + last->count) {
+			last->count++;
+			list->total++;
+			return TRUE;
+		}
+	}
+	if (list->len == PGM_MAX_SQN_RANGES)
+		return FALSE;
+	list->range[ list->len   ].first = sqn;
+	list->range[ list->len++ ].count = 1;
+	list->total++;
+	return TRUE;
+}
+
 PGM_END_DECLS
 
 #endif /* __PGM_IMPL_SQN_LIST_H__ */
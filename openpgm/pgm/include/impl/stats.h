@@ -0,0 +1,117 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * statistics counter blocks.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if !defined (__PGM_IMPL_FRAMEWORK_H_INSIDE__) && !defined (PGM_COMPILATION)
+#	error "Only <framework.h> can be included directly."
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_STATS_H__
+#define __PGM_IMPL_STATS_H__
+
+typedef struct pgm_stats_t pgm_stats_t;
+
+#include <pgm/types.h>
+
+PGM_BEGIN_DECLS
+
+/* Each block has one writer at a time, serialised by the lock of its context,
+ * so counters are added without locked instructions.  Readers sum the blocks
+ * of an object.  64-bit stores are single-copy atomic on LP64 platforms,
+ * elsewhere the block sequence is odd whilst a counter is written.
+ *
+ * With the sequence word a block fills five cache lines.
+ */
+#define PGM_STATS_COUNTERS		39
+
+#if defined( __x86_64__ ) || defined( __amd64 ) || defined( __LP64__ ) || defined( _LP64 ) || defined( _WIN64 )
+#	define PGM_STATS_USE_SEQUENCE	0
+#else
+#	define PGM_STATS_USE_SEQUENCE	1
+#endif
+
+/* socket blocks by writing context */
+enum {
+	PGM_STATS_TX = 0,		/* source API, source_mutex */
+	PGM_STATS_RX,			/* receive path, timers and repairs, receiver_mutex */
+	PGM_STATS_BLOCKS
+};
+
+struct pgm_stats_t {
+	volatile uint32_t	sequence;
+	uint32_t		reserved;
+	volatile uint64_t	counters[PGM_STATS_COUNTERS];
+};
+
+#if PGM_STATS_USE_SEQUENCE
+static inline
+void
+pgm_stats_barrier (void)
+{
+#	if defined( __GNUC__ ) && ( __GNUC__ * 100 + __GNUC_MINOR__ >= 401 )
+	__sync_synchronize();
+#	elif defined( __sun )
+	membar_producer();
+#	elif defined( _WIN32 )
+	MemoryBarrier();
+#	endif
+}
+#endif
+
+static inline
+void
+pgm_stats_add (
+	pgm_stats_t*		stats,
+	const unsigned		counter,
+	const uint64_t		value
+	)
+{
+#if PGM_STATS_USE_SEQUENCE
+	stats->sequence++;
+	pgm_stats_barrier();
+	stats->counters[ counter ] += value;
+	pgm_stats_barrier();
+	stats->sequence++;
+#else
+	stats->counters[ counter ] += value;
+#endif
+}
+
+static inline
+void
+pgm_stats_inc (
+	pgm_stats_t*		stats,
+	const unsigned		counter
+	)
+{
+	pgm_stats_add (stats, counter, 1);
+}
+
+PGM_GNUC_INTERNAL uint64_t pgm_stats_read (const pgm_stats_t*, const unsigned, const unsigned) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_stats_snapshot (const pgm_stats_t*restrict, const unsigned, uint64_t*restrict);
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_STATS_H__ */
+
+/* eof */
@@ -44,6 +44,7 @@ typedef struct pgm_rwlock_t pgm_rwlock_t;
 extern bool pgm_smp_system;
 
 #ifndef _WIN32
+#	include <errno.h>
 #	include <pthread.h>
 #	include <unistd.h>
 #	if defined( __sun )
@@ -57,6 +58,9 @@ extern bool pgm_smp_system;
 #	include <libkern/OSAtomic.h>
 #endif
 #include <pgm/types.h>
+#if defined( USE_MCS_SPINLOCK )
+#	include <impl/mcs.h>
+#endif
 #if defined( USE_TICKET_SPINLOCK )
 #	include <impl/ticket.h>
 #endif
@@ -77,7 +81,10 @@ struct pgm_mutex_t {
 };
 
 struct pgm_spinlock_t {
-#if defined( USE_TICKET_SPINLOCK )
+#if defined( USE_MCS_SPINLOCK )
+/* queued spinlock, waiters spin on their own cache line */
+	pgm_mcs_t		mcs_lock;
+#elif defined( USE_TICKET_SPINLOCK )
 /* ticket based spinlock */
 	pgm_ticket_t		ticket_lock;
 #elif defined( HAVE_PTHREAD_SPINLOCK )
@@ -173,7 +180,9 @@ PGM_GNUC_INTERNAL void pgm_spinlock_init (pgm_spinlock_t*);
 PGM_GNUC_INTERNAL void pgm_spinlock_free (pgm_spinlock_t*);
 
 static inline bool pgm_spinlock_trylock (pgm_spinlock_t* spinlock) {
-#if defined( USE_TICKET_SPINLOCK )
+#if defined( USE_MCS_SPINLOCK )
+	return pgm_mcs_trylock (&spinlock->mcs_lock);
+#elif defined( USE_TICKET_SPINLOCK )
 	return pgm_ticket_trylock (&spinlock->ticket_lock);
 #elif defined( HAVE_PTHREAD_SPINLOCK )
 	const int result = pthread_spin_trylock (&spinlock->pthread_spinlock);
@@ -192,7 +201,9 @@ static inline bool pgm_spinlock_trylock (pgm_spinlock_t* spinlock) {
 }
 
 static inline void pgm_spinlock_lock (pgm_spinlock_t* spinlock) {
-#if defined( USE_TICKET_SPINLOCK )
+#if defined( USE_MCS_SPINLOCK )
+	pgm_mcs_lock (&spinlock->mcs_lock);
+#elif defined( USE_TICKET_SPINLOCK )
 	pgm_ticket_lock (&spinlock->ticket_lock);
 #elif defined( HAVE_PTHREAD_SPINLOCK )
 	pthread_spin_lock (&spinlock->pthread_spinlock);
@@ -228,7 +239,9 @@ static inline void pgm_spinlock_lock (pgm_spinlock_t* spinlock) {
 }
 
 static inline void pgm_spinlock_unlock (pgm_spinlock_t* spinlock) {
-#if defined( USE_TICKET_SPINLOCK )
+#if defined( USE_MCS_SPINLOCK )
+	pgm_mcs_unlock (&spinlock->mcs_lock);
+#elif defined( USE_TICKET_SPINLOCK )
 	pgm_ticket_unlock (&spinlock->ticket_lock);
 #elif defined( HAVE_PTHREAD_SPINLOCK )
 	pthread_spin_unlock (&spinlock->pthread_spinlock);
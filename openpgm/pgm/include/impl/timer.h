@@ -26,14 +26,43 @@
 #define __PGM_IMPL_TIMER_H__
 
 #include <impl/framework.h>
+#include <pgm/atomic.h>
 #include <impl/socket.h>
 
 PGM_BEGIN_DECLS
 
+/* ambient SPMs are spread by up to 1/PGM_SPM_AMBIENT_JITTER of the interval either way
+ * so that sockets connected together do not broadcast together, and are sent up to
+ * 1/PGM_SPM_AMBIENT_SLACK of the interval early by a timer pass made for another reason.
+ */
+#define PGM_SPM_AMBIENT_JITTER		8
+#define PGM_SPM_AMBIENT_SLACK		8
+
+/* descriptors reporting the next timer expiration: PGM_TIMER_FD and pgm_kqueue_ctl() */
+#if defined( HAVE_SYS_TIMERFD_H ) || defined( HAVE_KQUEUE )
+#	define PGM_HAVE_TIMER_FD		1
+#endif
+
+static inline
+bool
+pgm_timer_has_fd (
+	const pgm_sock_t* const sock
+	)
+{
+	return (INVALID_SOCKET != sock->timer_fd || INVALID_SOCKET != sock->timer_kq);
+}
+
 PGM_GNUC_INTERNAL bool pgm_timer_prepare (pgm_sock_t*const);
 PGM_GNUC_INTERNAL bool pgm_timer_check (pgm_sock_t*const);
 PGM_GNUC_INTERNAL pgm_time_t pgm_timer_expiration (pgm_sock_t*const);
 PGM_GNUC_INTERNAL bool pgm_timer_dispatch (pgm_sock_t*const);
+PGM_GNUC_INTERNAL pgm_time_t pgm_timer_next_ambient_spm (pgm_sock_t*const, const pgm_time_t);
+PGM_GNUC_INTERNAL bool pgm_timer_thread_start (pgm_sock_t*const);
+#ifdef PGM_HAVE_TIMER_FD
+PGM_GNUC_INTERNAL void pgm_timer_arm (pgm_sock_t*const);
+#endif
+PGM_GNUC_INTERNAL void pgm_timer_thread_stop (pgm_sock_t*const);
+PGM_GNUC_INTERNAL void pgm_linger (pgm_sock_t*const restrict, pgm_notify_t*const restrict, const pgm_time_t);
 
 static inline
 void
@@ -41,7 +70,7 @@ pgm_timer_lock (
 	pgm_sock_t* const sock
 	)
 {
-	if (sock->can_send_data)
+	if (sock->can_send_data && !sock->is_single_threaded)
 		pgm_mutex_lock (&sock->timer_mutex);
 }
 
@@ -51,10 +80,32 @@ pgm_timer_unlock (
 	pgm_sock_t* const sock
 	)
 {
-	if (sock->can_send_data)
+	if (sock->can_send_data && !sock->is_single_threaded)
 		pgm_mutex_unlock (&sock->timer_mutex);
 }
 
+/* next timer expiration for the event loop queries between dispatches, an aligned
+ * 64-bit load cannot tear on 64-bit platforms so the mutex is skipped.  32-bit
+ * platforms keep the mutex as writers may store next_poll in two halves.
+ */
+
+static inline
+pgm_time_t
+pgm_timer_next_poll (
+	pgm_sock_t* const sock
+	)
+{
+#if defined( __x86_64__ ) || defined( __amd64 ) || defined( __LP64__ ) || defined( _LP64 ) || defined( _WIN64 )
+	return pgm_atomic_read64 (&sock->next_poll);
+#else
+	pgm_time_t next_poll;
+	pgm_timer_lock (sock);
+	next_poll = sock->next_poll;
+	pgm_timer_unlock (sock);
+	return next_poll;
+#endif
+}
+
 PGM_END_DECLS
 
 #endif /* __PGM_IMPL_TIMER_H__ */
@@ -0,0 +1,68 @@
+/* vim:ts=8:sts=4:sw=4:noai:noexpandtab
+ *
+ * PACKET_MMAP TPACKET_V3 receive ring.
+ *
+ * Copyright (c) 2006-2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if !defined (__PGM_IMPL_FRAMEWORK_H_INSIDE__) && !defined (PGM_COMPILATION)
+#	error "Only <framework.h> can be included directly."
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_TPACKET_H__
+#define __PGM_IMPL_TPACKET_H__
+
+struct pgm_recv_tpacket_t;
+
+#include <pgm/types.h>
+#include <pgm/skbuff.h>
+
+PGM_BEGIN_DECLS
+
+/* default and maximum ring geometry */
+#define PGM_TPACKET_DEFAULT_BLOCK_SIZE	(256 * 1024)
+#define PGM_TPACKET_MAX_BLOCK_SIZE	(4 * 1024 * 1024)
+#define PGM_TPACKET_MIN_BLOCK_SIZE	4096
+#define PGM_TPACKET_DEFAULT_BLOCKS	16
+#define PGM_TPACKET_MAX_BLOCKS		1024
+#define PGM_TPACKET_DEFAULT_TIMEOUT	1		/* milliseconds */
+#define PGM_TPACKET_MAX_TIMEOUT		1000
+
+/* instructions of the classic BPF prefix admitting PGM/IP to the ring */
+#define PGM_TPACKET_FILTER_INSNS	8
+
+struct pgm_sock_t;
+struct pgm_tpacket_req_t;
+struct sock_filter;
+
+#ifdef HAVE_LINUX_IF_PACKET_H
+PGM_GNUC_INTERNAL struct pgm_recv_tpacket_t* pgm_recv_tpacket_new (const struct pgm_sock_t*const, const struct pgm_tpacket_req_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_recv_tpacket_destroy (struct pgm_recv_tpacket_t*const);
+PGM_GNUC_INTERNAL ssize_t pgm_recv_tpacket_recv (struct pgm_recv_tpacket_t*const restrict, struct pgm_sk_buff_t*const restrict, struct sockaddr*const restrict, struct sockaddr*const restrict);
+PGM_GNUC_INTERNAL bool pgm_recv_tpacket_is_pending (const struct pgm_recv_tpacket_t*const);
+PGM_GNUC_INTERNAL SOCKET pgm_recv_tpacket_get_socket (const struct pgm_recv_tpacket_t*const) PGM_GNUC_PURE;
+PGM_GNUC_INTERNAL unsigned pgm_recv_tpacket_filter_prefix (struct sock_filter*const);
+#endif
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_TPACKET_H__ */
+
+/* eof */
@@ -36,26 +36,52 @@ PGM_BEGIN_DECLS
 struct pgm_txw_state_t {
 	uint32_t	unfolded_checksum;	/* first 32-bit word must be checksum */
 
-	unsigned	waiting_retransmit:1;	/* in retransmit queue */
-	unsigned	retransmit_count:15;
-	unsigned	nak_elimination_count:16;
-
-	uint8_t		pkt_cnt_requested;	/* # parity packets to send */
+	volatile uint32_t retransmit;		/* in retransmit queue | # parity packets to send */
+	volatile uint32_t nak_elimination_count;
+	uint16_t	retransmit_count;
 	uint8_t		pkt_cnt_sent;		/* # parity packets already sent */
 };
 
+/* single producer, the source API, appends and evicts.  NAK processing on any thread
+ * queues retransmit requests through a bounded multiple-producer ring, a single consumer,
+ * the repair path, drains the ring and owns the retransmit queue.  a reference is held
+ * on every skbuff a request is queued for or read by a consumer, the producer waits out
+ * a reference being taken while it evicts the trailing edge.
+ */
+
+struct pgm_txw_request_t;
+struct pgm_txw_parity_t;
+
 struct pgm_txw_t {
 	const pgm_tsi_t* restrict	tsi;
 
-/* option: lockless atomics */
+/* lockless atomics, lead published after the entry is written */
         volatile uint32_t		lead;
         volatile uint32_t		trail;
+	volatile uint32_t		peek_active;		/* references being taken */
 
-        pgm_queue_t			retransmit_queue;
+/* retransmit requests */
+	struct pgm_txw_request_t* restrict request;		/* ring of referenced skbuffs */
+	uint32_t			request_mask;		/* ring length - 1 */
+	volatile uint32_t		request_head;		/* claimed by producers */
+	uint32_t			request_tail;		/* consumer only */
+        pgm_queue_t			retransmit_queue;	/* consumer only, referenced */
 
 	pgm_rs_t			rs;
 	uint8_t				tg_sqn_shift;
+	uint16_t			max_tpdu;
 	struct pgm_sk_buff_t* restrict	parity_buffer;
+	struct pgm_txw_parity_t* restrict parity;		/* FEC worker, proactive parity */
+
+/* repair history beyond the window */
+	struct pgm_txw_store_t* restrict store;
+	volatile uint32_t		store_trail;
+
+/* receiver-acknowledged trail, published by the receive path */
+	volatile uint32_t		ack_trail;		/* held by every reporting receiver */
+	volatile uint32_t		has_ack_trail;
+	pgm_time_t			ack_trail_retention;	/* minimum age of a released entry */
+	const pgm_budget_t*		budget;			/* hold length whilst exceeded, NULL = unlimited */
 
 /* Advance with data */
 	pgm_time_t			adv_ivl_expiry;	
@@ -68,21 +94,34 @@ struct pgm_txw_t {
 
 	size_t				size;			/* window content size in bytes */
 	unsigned			alloc;			/* length of pdata[] */
+	unsigned			mask;			/* alloc - 1 if a power of two, else 0 */
 /* C90 and older */
 	struct pgm_sk_buff_t*		pdata[1];
 };
 
-PGM_GNUC_INTERNAL pgm_txw_t* pgm_txw_create (const pgm_tsi_t*const, const uint16_t, const uint32_t, const unsigned, const ssize_t, const bool, const uint8_t, const uint8_t) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL pgm_txw_t* pgm_txw_create (const pgm_tsi_t*const, const uint16_t, const uint32_t, const unsigned, const ssize_t, const bool, const uint8_t, const uint8_t, const pgm_mem_policy_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
 PGM_GNUC_INTERNAL void pgm_txw_shutdown (pgm_txw_t*const);
 PGM_GNUC_INTERNAL void pgm_txw_add (pgm_txw_t*const restrict, struct pgm_sk_buff_t*const restrict);
 PGM_GNUC_INTERNAL struct pgm_sk_buff_t* pgm_txw_peek (const pgm_txw_t*const, const uint32_t) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL unsigned pgm_txw_release (pgm_txw_t*const, uint32_t, const pgm_time_t);
 PGM_GNUC_INTERNAL bool pgm_txw_retransmit_push (pgm_txw_t*const, const uint32_t, const bool, const uint8_t) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL unsigned pgm_txw_retransmit_push_range (pgm_txw_t*const, const uint32_t, const uint32_t);
+PGM_GNUC_INTERNAL struct pgm_sk_buff_t* pgm_txw_get_repair (pgm_txw_t*const, const uint32_t) PGM_GNUC_WARN_UNUSED_RESULT;
 PGM_GNUC_INTERNAL struct pgm_sk_buff_t* pgm_txw_retransmit_try_peek (pgm_txw_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL unsigned pgm_txw_retransmit_try_peekv (pgm_txw_t*const restrict, struct pgm_sk_buff_t**const restrict, const unsigned) PGM_GNUC_WARN_UNUSED_RESULT;
 PGM_GNUC_INTERNAL void pgm_txw_retransmit_remove_head (pgm_txw_t*const);
 PGM_GNUC_INTERNAL uint32_t pgm_txw_get_unfolded_checksum (const struct pgm_sk_buff_t*const) PGM_GNUC_PURE;
 PGM_GNUC_INTERNAL void pgm_txw_set_unfolded_checksum (struct pgm_sk_buff_t*const, const uint32_t);
 PGM_GNUC_INTERNAL void pgm_txw_inc_retransmit_count (struct pgm_sk_buff_t*const);
 PGM_GNUC_INTERNAL bool pgm_txw_retransmit_is_empty (const pgm_txw_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL bool pgm_txw_parity_start (pgm_txw_t*const restrict, const uint8_t, pgm_notify_t*const restrict);
+PGM_GNUC_INTERNAL bool pgm_txw_parity_submit (pgm_txw_t*const, const uint32_t);
+PGM_GNUC_INTERNAL struct pgm_sk_buff_t* pgm_txw_parity_try_peek (pgm_txw_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_txw_parity_remove_head (pgm_txw_t*const);
+PGM_GNUC_INTERNAL void pgm_txw_set_store (pgm_txw_t*const restrict, struct pgm_txw_store_t*const restrict);
+PGM_GNUC_INTERNAL void pgm_txw_set_retention (pgm_txw_t*const, const pgm_time_t);
+PGM_GNUC_INTERNAL void pgm_txw_update_ack_trail (pgm_txw_t*const, const bool, const uint32_t);
+PGM_GNUC_INTERNAL struct pgm_sk_buff_t* pgm_txw_sw_encode (pgm_txw_t*const, const uint32_t, const uint8_t, const uint16_t) PGM_GNUC_WARN_UNUSED_RESULT;
 
 /* declare for GCC attributes */
 static inline size_t pgm_txw_max_length (const pgm_txw_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
@@ -95,6 +134,7 @@ static inline uint32_t pgm_txw_lead_atomic (const pgm_txw_t* const) PGM_GNUC_WAR
 static inline uint32_t pgm_txw_next_lead (const pgm_txw_t* const) PGM_GNUC_WARN_UNUSED_RESULT;
 static inline uint32_t pgm_txw_trail (const pgm_txw_t* const) PGM_GNUC_WARN_UNUSED_RESULT;
 static inline uint32_t pgm_txw_trail_atomic (const pgm_txw_t* const) PGM_GNUC_WARN_UNUSED_RESULT;
+static inline uint32_t pgm_txw_repair_trail (const pgm_txw_t* const) PGM_GNUC_WARN_UNUSED_RESULT;
 
 static inline
 size_t
@@ -197,6 +237,17 @@ pgm_txw_trail_atomic (
 	return pgm_atomic_read32 (&window->trail);
 }
 
+/* oldest sequence that can be repaired, the store extends the trailing edge */
+static inline
+uint32_t
+pgm_txw_repair_trail (
+	const pgm_txw_t*const window
+	)
+{
+	pgm_assert (NULL != window);
+	return window->store ? pgm_atomic_read32 (&window->store_trail) : pgm_atomic_read32 (&window->trail);
+}
+
 PGM_END_DECLS
 
 #endif /* __PGM_IMPL_TXW_H__ */
@@ -0,0 +1,62 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * memory-mapped transmit window history.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if !defined (__PGM_IMPL_FRAMEWORK_H_INSIDE__) && !defined (PGM_COMPILATION)
+#	error "Only <framework.h> can be included directly."
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_TXW_STORE_H__
+#define __PGM_IMPL_TXW_STORE_H__
+
+struct pgm_txw_store_t;
+
+#include <pgm/types.h>
+#include <pgm/error.h>
+#include <pgm/skbuff.h>
+#include <pgm/tsi.h>
+
+PGM_BEGIN_DECLS
+
+/* retained sequences when not specified, rounded up to a power of 2 */
+#define PGM_TXW_STORE_DEFAULT_SQNS	65536
+
+PGM_GNUC_INTERNAL struct pgm_txw_store_t* pgm_txw_store_open (const char*restrict, const pgm_tsi_t*restrict, const uint16_t, uint32_t, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL struct pgm_txw_store_t* pgm_txw_store_attach (const char*restrict, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_txw_store_close (struct pgm_txw_store_t*);
+PGM_GNUC_INTERNAL bool pgm_txw_store_resume (const struct pgm_txw_store_t*const restrict, uint32_t*restrict, uint32_t*restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_txw_store_reset (struct pgm_txw_store_t*const);
+PGM_GNUC_INTERNAL uint32_t pgm_txw_store_append (struct pgm_txw_store_t*const restrict, const struct pgm_sk_buff_t*const restrict);
+PGM_GNUC_INTERNAL struct pgm_sk_buff_t* pgm_txw_store_load (struct pgm_txw_store_t*const, const uint32_t) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL uint32_t pgm_txw_store_trail (const struct pgm_txw_store_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL bool pgm_txw_store_extent (const struct pgm_txw_store_t*const restrict, uint32_t*restrict, uint32_t*restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL size_t pgm_txw_store_copy (const struct pgm_txw_store_t*const restrict, const uint32_t, void*restrict, const size_t) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_txw_store_spm (struct pgm_txw_store_t*const, const uint32_t);
+PGM_GNUC_INTERNAL void pgm_txw_store_geometry (const struct pgm_txw_store_t*const restrict, pgm_tsi_t*restrict, uint32_t*restrict, uint16_t*restrict);
+PGM_GNUC_INTERNAL bool pgm_txw_store_is_owned (const struct pgm_txw_store_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_TXW_STORE_H__ */
+
+/* eof */
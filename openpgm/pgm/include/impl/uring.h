@@ -0,0 +1,61 @@
+/* vim:ts=8:sts=4:sw=4:noai:noexpandtab
+ *
+ * io_uring receive engine.
+ *
+ * Copyright (c) 2006-2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if !defined (__PGM_IMPL_FRAMEWORK_H_INSIDE__) && !defined (PGM_COMPILATION)
+#	error "Only <framework.h> can be included directly."
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_URING_H__
+#define __PGM_IMPL_URING_H__
+
+struct pgm_recv_uring_t;
+struct pgm_write_uring_t;
+
+#include <pgm/types.h>
+#include <pgm/skbuff.h>
+
+PGM_BEGIN_DECLS
+
+/* maximum receive operations kept in flight per socket, power of 2 */
+#define PGM_MAX_URING_DEPTH		1024
+
+struct pgm_sock_t;
+struct msghdr;
+
+#ifdef HAVE_LINUX_IO_URING_H
+PGM_GNUC_INTERNAL struct pgm_recv_uring_t* pgm_recv_uring_new (struct pgm_sock_t*const, const unsigned) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_recv_uring_destroy (struct pgm_recv_uring_t*const);
+PGM_GNUC_INTERNAL ssize_t pgm_recv_uring_recvmsg (struct pgm_recv_uring_t*const restrict, struct pgm_sk_buff_t* restrict*const, struct msghdr**const restrict);
+PGM_GNUC_INTERNAL bool pgm_recv_uring_is_pending (const struct pgm_recv_uring_t*const);
+PGM_GNUC_INTERNAL SOCKET pgm_recv_uring_get_socket (const struct pgm_recv_uring_t*const) PGM_GNUC_PURE;
+PGM_GNUC_INTERNAL struct pgm_write_uring_t* pgm_write_uring_new (const unsigned) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_write_uring_destroy (struct pgm_write_uring_t*const);
+PGM_GNUC_INTERNAL bool pgm_write_uring_writev (struct pgm_write_uring_t*const restrict, const int, const struct pgm_iovec*const restrict, const unsigned, const uint64_t, const uint64_t) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL bool pgm_write_uring_reap (struct pgm_write_uring_t*const restrict, const bool, uint64_t*const restrict, int*const restrict);
+PGM_GNUC_INTERNAL unsigned pgm_write_uring_in_flight (const struct pgm_write_uring_t*const) PGM_GNUC_PURE;
+#endif
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_URING_H__ */
@@ -0,0 +1,56 @@
+/* vim:ts=8:sts=4:sw=4:noai:noexpandtab
+ *
+ * AF_XDP kernel-bypass receive.
+ *
+ * Copyright (c) 2006-2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if !defined (__PGM_IMPL_FRAMEWORK_H_INSIDE__) && !defined (PGM_COMPILATION)
+#	error "Only <framework.h> can be included directly."
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_XDP_H__
+#define __PGM_IMPL_XDP_H__
+
+struct pgm_recv_xdp_t;
+
+#include <pgm/types.h>
+#include <pgm/skbuff.h>
+
+PGM_BEGIN_DECLS
+
+/* default and maximum UMEM frames per socket, power of 2 */
+#define PGM_XDP_DEFAULT_FRAMES		4096
+#define PGM_XDP_MAX_FRAMES		65536
+
+struct pgm_sock_t;
+struct pgm_xdp_req_t;
+
+#ifdef HAVE_LINUX_IF_XDP_H
+PGM_GNUC_INTERNAL struct pgm_recv_xdp_t* pgm_recv_xdp_new (const struct pgm_sock_t*const, const struct pgm_xdp_req_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_recv_xdp_destroy (struct pgm_recv_xdp_t*const);
+PGM_GNUC_INTERNAL ssize_t pgm_recv_xdp_recv (struct pgm_recv_xdp_t*const restrict, struct pgm_sk_buff_t*const restrict, struct sockaddr*const restrict, struct sockaddr*const restrict);
+PGM_GNUC_INTERNAL bool pgm_recv_xdp_is_pending (const struct pgm_recv_xdp_t*const);
+PGM_GNUC_INTERNAL SOCKET pgm_recv_xdp_get_socket (const struct pgm_recv_xdp_t*const) PGM_GNUC_PURE;
+#endif
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_XDP_H__ */
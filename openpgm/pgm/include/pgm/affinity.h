@@ -0,0 +1,71 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * CPU, scheduling and NUMA placement of internal threads.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_AFFINITY_H__
+#define __PGM_AFFINITY_H__
+
+typedef struct pgm_affinity_t pgm_affinity_t;
+
+#include <pgm/types.h>
+#include <pgm/error.h>
+
+PGM_BEGIN_DECLS
+
+#define PGM_AFFINITY_MAX_CPUS		1024
+
+/* classes of threads created by the library */
+enum {
+	PGM_THREAD_TIMER = 0,		/* per socket timer threads and the shared timer pool */
+	PGM_THREAD_FEC,			/* parity encoders and decoders */
+	PGM_THREAD_HTTP,
+	PGM_THREAD_SNMP,
+	PGM_THREAD_SHMSTATS,
+	PGM_THREAD_IO,			/* completion notification for Registered I/O */
+	PGM_THREAD_MAX
+};
+
+enum {
+	PGM_SCHED_INHERIT = 0,
+	PGM_SCHED_OTHER,
+	PGM_SCHED_FIFO,
+	PGM_SCHED_RR
+};
+
+/* placement of one class of thread.  without a CPU list a NUMA node also
+ * restricts the threads to the processors of that node.
+ */
+struct pgm_affinity_t {
+	const char*		cpus;		/* e.g. "2-3,6", NULL to inherit */
+	int			sched;		/* PGM_SCHED_* */
+	int			priority;	/* static priority for FIFO and RR */
+	int			node;		/* preferred node for allocations, -1 to inherit */
+};
+
+bool pgm_affinity_set (int, const pgm_affinity_t*, pgm_error_t**) PGM_GNUC_WARN_UNUSED_RESULT;
+
+PGM_END_DECLS
+
+#endif /* __PGM_AFFINITY_H__ */
+
+/* eof */
@@ -1,6 +1,6 @@
 /* vim:ts=8:sts=8:sw=4:noai:noexpandtab
  * 
- * 32-bit atomic operations.  A complex mix of inline assembler and compiler
+ * 32 and 64-bit atomic operations.  A complex mix of inline assembler and compiler
  * intrinsics.  Native x86 code uses fetch-and-add instruction which is proven
  * faster than Solaris intrinsics that all use compare-and-swap (CAS):
  * https://blogs.oracle.com/dave/entry/atomic_fetch_and_add_vs
@@ -199,6 +199,114 @@ pgm_atomic_dec32 (
 #endif
 }
 
+/* 32-bit word exchange returning original atomic value, full barrier.
+ *
+ * 	uint32_t tmp = *atomic;
+ * 	*atomic = val;
+ * 	return tmp;
+ */
+
+static inline
+uint32_t
+pgm_atomic_exchange32 (
+	volatile uint32_t*	atomic,
+	const uint32_t		val
+	)
+{
+#if defined( __GNUC__ ) && ( defined( __i386__ ) || defined( __x86_64__ ) )
+/* GCC assembler, xchg with memory is implicitly locked */
+	uint32_t result = val;
+	__asm__ volatile ("xchgl %0, %1"
+		        : "+r" (result), "+m" (*atomic)
+		        :
+		        : "memory"  );
+	return result;
+#elif defined( __sun ) || defined(__NetBSD__)
+/* Solaris and NetBSD intrinsic */
+	const uint32_t result = atomic_swap_32 (atomic, val);
+	membar_enter ();
+	return result;
+#elif defined( __APPLE__ )
+/* Darwin intrinsic */
+	uint32_t result;
+	do {
+		result = *atomic;
+	} while (!OSAtomicCompareAndSwap32Barrier ((int32_t)result, (int32_t)val, (volatile int32_t*)atomic));
+	return result;
+#elif defined( __GNUC__ ) && ( __GNUC__ * 100 + __GNUC_MINOR__ >= 401 )
+/* GCC 4.0.1 intrinsic, an acquire barrier only */
+	__sync_synchronize ();
+	return __sync_lock_test_and_set (atomic, val);
+#elif defined( _AIX )
+	int result;
+	do {
+		result = (int)*atomic;
+	} while (!compare_and_swap ((atomic_p)atomic, &result, (int)val));
+	return (uint32_t)result;
+#elif defined( _WIN32 )
+/* Windows intrinsic */
+	return _InterlockedExchange ((volatile LONG*)atomic, val);
+#else
+#	error "No supported atomic operations for this platform."
+#endif
+}
+
+/* 32-bit word CAS, returns TRUE if swap occurred.
+ *
+ *	if (*atomic == oldval) {
+ *		*atomic = newval;
+ *		return TRUE;
+ *	}
+ *	return FALSE;
+ *
+ * Sun Studio on x86 GCC-compatible assembler not implemented.
+ */
+
+static inline
+bool
+pgm_atomic_compare_and_exchange32 (
+	volatile uint32_t*	atomic,
+	const uint32_t		newval,
+	const uint32_t		oldval
+	)
+{
+#if defined( __GNUC__ ) && ( defined( __i386__ ) || defined( __x86_64__ ) )
+/* GCC assembler */
+	uint8_t result;
+	__asm__ volatile ("lock; cmpxchgl %2, %0\n\t"
+			  "setz %1\n\t"
+			: "+m" (*atomic), "=q" (result)
+			: "r" (newval),  "a" (oldval)
+			: "memory", "cc"  );
+	return (bool)result;
+#elif defined( __SUNPRO_C ) && ( defined( __i386__ ) || defined( __x86_64__ ) )
+/* GCC-compatible assembler */
+	uint8_t result;
+	__asm__ volatile ("lock; cmpxchgl %2, %0\n\t"
+			  "setz %1\n\t"
+			: "+m" (*atomic), "=q" (result)
+			: "r" (newval),  "a" (oldval)
+			: "memory", "cc"  );
+	return (bool)result;
+#elif defined( __sun ) || defined( _NetBSD__ )
+/* Solaris and NetBSD intrinsic */
+	const uint32_t original = atomic_cas_32 (atomic, oldval, newval);
+	return (oldval == original);
+#elif defined( __APPLE__ )
+/* Darwin intrinsic */
+	return OSAtomicCompareAndSwap32Barrier ((int32_t)oldval, (int32_t)newval, (volatile int32_t*)atomic);
+#elif defined( __GNUC__ ) && ( __GNUC__ * 100 + __GNUC_MINOR__ >= 401 )
+/* GCC 4.0.1 intrinsic */
+	return __sync_bool_compare_and_swap (atomic, oldval, newval);
+#elif defined( _AIX )
+	return compare_and_swap ((int *)atomic, (int *)&oldval, newval);
+#elif defined( _WIN32 )
+/* Windows intrinsic */
+	const uint32_t original = _InterlockedCompareExchange ((volatile LONG*)atomic, newval, oldval);
+	return (oldval == original);
+#endif
+}
+
 /* 32-bit word load 
  */
 
@@ -224,4 +332,60 @@ pgm_atomic_write32 (
 	*atomic = val;
 }
 
+/* 64-bit word CAS, returns TRUE if swap occurred, full barrier.
+ *
+ *	if (*atomic == oldval) {
+ *		*atomic = newval;
+ *		return TRUE;
+ *	}
+ *	return FALSE;
+ */
+
+static inline
+bool
+pgm_atomic_compare_and_exchange64 (
+	volatile uint64_t*	atomic,
+	const uint64_t		newval,
+	const uint64_t		oldval
+	)
+{
+#if defined( __sun )
+/* Solaris intrinsic */
+	const uint64_t original = atomic_cas_64 (atomic, oldval, newval);
+	return (oldval == original);
+#elif defined( __APPLE__ )
+/* Darwin intrinsic */
+	return OSAtomicCompareAndSwap64Barrier ((int64_t)oldval, (int64_t)newval, (volatile int64_t*)atomic);
+#elif defined( __GNUC__ ) && ( __GNUC__ * 100 + __GNUC_MINOR__ >= 401 )
+/* GCC 4.0.1 intrinsic, cmpxchg8b on i586 */
+	return __sync_bool_compare_and_swap (atomic, oldval, newval);
+#elif defined( _WIN32 )
+/* Windows intrinsic */
+	const uint64_t original = _InterlockedCompareExchange64 ((volatile LONGLONG*)atomic, newval, oldval);
+	return (oldval == original);
+#else
+#	error "No supported 64-bit compare-and-swap for this platform."
+#endif
+}
+
+/* 64-bit word load, a plain load may tear on 32-bit platforms.
+ */
+
+static inline
+uint64_t
+pgm_atomic_read64 (
+	const volatile uint64_t* atomic
+	)
+{
+#if defined( __x86_64__ ) || defined( __amd64 ) || defined( _WIN64 ) || defined( __LP64__ ) || defined( _LP64 )
+	return *atomic;
+#else
+	uint64_t oldval;
+	do {
+		oldval = *atomic;
+	} while (!pgm_atomic_compare_and_exchange64 ((volatile uint64_t*)atomic, oldval, oldval));
+	return oldval;
+#endif
+}
+
 #endif /* __PGM_ATOMIC_H__ */
@@ -0,0 +1,46 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * packet capture ring and replay.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_CAPTURE_H__
+#define __PGM_CAPTURE_H__
+
+#include <pgm/types.h>
+#include <pgm/error.h>
+#include <pgm/socket.h>
+
+PGM_BEGIN_DECLS
+
+#define PGM_CAPTURE_DEFAULT_SIZE	(16*1024*1024)	/* bytes */
+#define PGM_CAPTURE_MIN_SIZE		(256*1024)
+
+/* replay flags */
+#define PGM_REPLAY_MAX_SPEED		0x1		/* ignore recorded packet spacing */
+
+bool pgm_capture_replay (pgm_sock_t*const restrict, const char*restrict, int, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+
+PGM_END_DECLS
+
+#endif /* __PGM_CAPTURE_H__ */
+
+/* eof */
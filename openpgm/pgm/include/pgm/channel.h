@@ -0,0 +1,78 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * topics sharded over a pool of multicast groups and ports.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_CHANNEL_H__
+#define __PGM_CHANNEL_H__
+
+typedef struct pgm_channel_t pgm_channel_t;
+typedef struct pgm_topic_t pgm_topic_t;
+struct pgm_channel_info_t;
+
+#include <pgm/types.h>
+#include <pgm/error.h>
+#include <pgm/gsi.h>
+#include <pgm/socket.h>
+
+PGM_BEGIN_DECLS
+
+#define PGM_CHANNEL_MAX_TOPIC		255		/* bytes excluding terminator */
+
+/* options of a shard socket after pgm_socket() and before bind, is_recv is set for the
+ * receive socket.  returns FALSE to fail the open.
+ */
+typedef bool (*pgm_channel_setup_func_t) (pgm_sock_t*, const uint32_t, const bool, void*);
+
+/* shard n of ci_shards is sent to group ci_group + n % ci_groups with data-destination
+ * port ci_port + n.  ci_group is an IPv4 or IPv6 multicast address, the low 32 bits are
+ * incremented.
+ */
+struct pgm_channel_info_t {
+	struct sockaddr_storage		ci_group;	/* first group of the pool */
+	uint32_t			ci_groups;	/* groups of the pool, 0 = 1 */
+	uint32_t			ci_shards;	/* data-destination ports, at least ci_groups */
+	uint16_t			ci_port;	/* first data-destination port */
+	uint16_t			ci_udp_encap_port;	/* IPPROTO_UDP only */
+	int				ci_protocol;	/* IPPROTO_PGM or IPPROTO_UDP */
+	pgm_gsi_t			ci_gsi;
+	struct pgm_interface_req_t	ci_interface;	/* send and receive interface */
+	pgm_channel_setup_func_t	ci_setup;	/* NULL = defaults */
+	void*				ci_setup_arg;
+};
+
+bool pgm_channel_create (pgm_channel_t**restrict, const struct pgm_channel_info_t*restrict, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+bool pgm_channel_destroy (pgm_channel_t*, bool);
+uint32_t pgm_channel_shard (const pgm_channel_t*restrict, const char*restrict);
+bool pgm_channel_publish (pgm_channel_t*restrict, const char*restrict, pgm_topic_t**restrict, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+int pgm_topic_send (pgm_topic_t*const restrict, const void*restrict, const size_t, size_t*restrict);
+pgm_sock_t* pgm_topic_sock (const pgm_topic_t*const);
+bool pgm_channel_subscribe (pgm_channel_t*restrict, const char*restrict, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+bool pgm_channel_unsubscribe (pgm_channel_t*restrict, const char*restrict);
+int pgm_channel_recv (pgm_channel_t*const restrict, void*restrict, const size_t, const int, size_t*const restrict, const char**restrict, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+pgm_sock_t* pgm_channel_recv_sock (pgm_channel_t*const);
+
+PGM_END_DECLS
+
+#endif /* __PGM_CHANNEL_H__ */
+
+/* eof */
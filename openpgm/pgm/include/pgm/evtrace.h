@@ -0,0 +1,93 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * Binary protocol event trace.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_EVTRACE_H__
+#define __PGM_EVTRACE_H__
+
+typedef struct pgm_evtrace_event_t pgm_evtrace_event_t;
+typedef struct pgm_evtrace_header_t pgm_evtrace_header_t;
+
+#include <pgm/types.h>
+#include <pgm/error.h>
+#include <pgm/tsi.h>
+
+PGM_BEGIN_DECLS
+
+#define PGM_EVTRACE_MAGIC		0x50475445U	/* "PGTE" */
+#define PGM_EVTRACE_VERSION		1
+#define PGM_EVTRACE_DEFAULT_EVENTS	4096		/* per thread */
+
+/* event identifiers, values are recorded in saved traces and never reused.
+ */
+enum {
+	PGM_EV_NONE = 0,
+	PGM_EV_PEER_NEW,		/* sqn: none */
+	PGM_EV_PEER_EXPIRED,
+	PGM_EV_NAK_SENT,		/* sqn: first sequence, arg: count */
+	PGM_EV_NCF_RECEIVED,		/* sqn: first sequence, arg: count */
+	PGM_EV_RDATA_RECEIVED,		/* sqn: repaired sequence */
+	PGM_EV_DATA_LOST,		/* sqn: lost sequence, arg: 0 NCF retries, 1 DATA retries, 2 delivery deadline */
+	PGM_EV_RESET,			/* sqn: cumulative losses, arg: losses since last reset */
+	PGM_EV_NAK_RECEIVED,		/* sqn: first sequence, arg: count */
+	PGM_EV_RDATA_SENT,		/* sqn: repaired sequence */
+	PGM_EV_ACK_TIMEOUT,		/* arg: congestion window in packets */
+	PGM_EV_WINDOW_JUMP,		/* sqn: first dropped sequence, arg: count */
+	PGM_EV_MAX
+};
+
+/* one event, 32 bytes, timestamps are pgm_time_t microseconds.
+ */
+struct pgm_evtrace_event_t {
+	uint64_t		tstamp;
+	pgm_tsi_t		tsi;		/* source of the session */
+	uint32_t		sqn;
+	uint16_t		id;
+	uint16_t		arg;
+	uint32_t		thread;		/* recording thread, in order of first event */
+	uint32_t		reserved;
+};
+
+/* a saved trace is the header followed by count events, oldest first.  both
+ * clocks are read at save to convert event times to wall clock.
+ */
+struct pgm_evtrace_header_t {
+	uint32_t		magic;
+	uint32_t		version;
+	uint32_t		event_size;
+	uint32_t		count;
+	uint64_t		tstamp;		/* pgm_time_t at save */
+	uint64_t		wall_usecs;	/* microseconds since the epoch at save */
+};
+
+bool pgm_evtrace_init (unsigned, pgm_error_t**) PGM_GNUC_WARN_UNUSED_RESULT;
+bool pgm_evtrace_shutdown (void);
+unsigned pgm_evtrace_read (pgm_evtrace_event_t*, unsigned);
+bool pgm_evtrace_save (const char*, unsigned, pgm_error_t**) PGM_GNUC_WARN_UNUSED_RESULT;
+const char* pgm_evtrace_name (unsigned) PGM_GNUC_CONST;
+
+PGM_END_DECLS
+
+#endif /* __PGM_EVTRACE_H__ */
+
+/* eof */
@@ -0,0 +1,52 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * histogram percentiles.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_HISTOGRAM_H__
+#define __PGM_HISTOGRAM_H__
+
+typedef struct pgm_histogram_summary_t pgm_histogram_summary_t;
+
+#include <pgm/types.h>
+
+PGM_BEGIN_DECLS
+
+/* Time histograms are recorded in microseconds, count histograms in the
+ * counted unit.  Percentiles report the highest value of the bucket holding
+ * that rank, which is within 1/32 of the true sample.
+ */
+struct pgm_histogram_summary_t {
+	uint64_t	count;
+	uint64_t	p50;
+	uint64_t	p99;
+	uint64_t	p999;
+	uint64_t	max;
+};
+
+bool pgm_histogram_summary (const char*restrict, pgm_histogram_summary_t*restrict);
+
+PGM_END_DECLS
+
+#endif /* __PGM_HISTOGRAM_H__ */
+
+/* eof */
@@ -0,0 +1,47 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * same-host consumers of the APDUs read by a PGM_LOCAL_PUBLISH receiver.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_LOCAL_H__
+#define __PGM_LOCAL_H__
+
+typedef struct pgm_local_t pgm_local_t;
+
+#include <pgm/types.h>
+#include <pgm/error.h>
+#include <pgm/msgv.h>
+
+PGM_BEGIN_DECLS
+
+/* microseconds between polls of a blocking pgm_local_recvmsgv() */
+#define PGM_LOCAL_POLL_IVL		100
+
+pgm_local_t* pgm_local_attach (const char*restrict, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+void pgm_local_detach (pgm_local_t*);
+int pgm_local_recvmsgv (pgm_local_t*const restrict, struct pgm_msgv_t*const restrict, const size_t, const int, size_t*restrict, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+
+PGM_END_DECLS
+
+#endif /* __PGM_LOCAL_H__ */
+
+/* eof */
@@ -47,11 +47,15 @@
 						__section__((".data.cacheline_aligned")))
 #	define PGM_GNUC_READ_MOSTLY		__attribute__((__section__(".data.read_mostly")))
 
+/* Inline at every call site, specialising one body by constant arguments */
+#	define PGM_GNUC_ALWAYS_INLINE		__attribute__((__always_inline__))
+
 #else
 #	define PGM_GNUC_PURE
 #	define PGM_GNUC_MALLOC
 #	define PGM_GNUC_CACHELINE_ALIGNED
 #	define PGM_GNUC_READ_MOSTLY
+#	define PGM_GNUC_ALWAYS_INLINE
 #endif
 
 #if (__GNUC__ >= 4)
@@ -119,6 +123,18 @@
 #	endif
 #endif /* __GNUC__ */
 
+/* Structure member alignment to separate state written by different threads */
+#ifndef PGM_CACHELINE_SIZE
+#	define PGM_CACHELINE_SIZE		64
+#endif
+#if defined(__GNUC__)
+#	define PGM_ALIGNED(n)			__attribute__((__aligned__(n)))
+#elif defined(_MSC_VER)
+#	define PGM_ALIGNED(n)			__declspec(align(n))
+#else
+#	define PGM_ALIGNED(n)
+#endif
+
 
 /* Compiler time assertions, must be on unique lines in the project */
 #define PGM_PASTE_ARGS(identifier1,identifier2) identifier1 ## identifier2
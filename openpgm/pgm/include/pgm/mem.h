@@ -38,7 +38,28 @@ PGM_BEGIN_DECLS
 
 extern bool pgm_mem_gc_friendly;
 
+/* size class hint to a custom allocator */
+enum {
+	PGM_MEM_CLASS_GENERAL = 0,	/* sockets, control structures and strings */
+	PGM_MEM_CLASS_PACKET,		/* skbuffs, a few TPDU sizes churned on the data path */
+	PGM_MEM_CLASS_WINDOW		/* window and slab storage, large and long lived */
+};
+
+/* allocator for all library memory, installed before pgm_init().  al_aligned_alloc
+ * may be NULL, memory from it is released with al_free.
+ */
+struct pgm_allocator_t {
+	void*		al_user_data;
+	void*		(*al_malloc) (void*, size_t, unsigned);
+	void*		(*al_aligned_alloc) (void*, size_t, size_t, unsigned);
+	void*		(*al_realloc) (void*, void*, size_t, unsigned);
+	void		(*al_free) (void*, void*);
+};
+
+bool pgm_mem_set_allocator (const struct pgm_allocator_t*);
+
 void* pgm_malloc (const size_t) PGM_GNUC_MALLOC PGM_GNUC_ALLOC_SIZE(1);
+void* pgm_malloc_class (const size_t, const unsigned) PGM_GNUC_MALLOC PGM_GNUC_ALLOC_SIZE(1);
 void* pgm_malloc_n (const size_t, const size_t) PGM_GNUC_MALLOC PGM_GNUC_ALLOC_SIZE2(1, 2);
 void* pgm_malloc0 (const size_t) PGM_GNUC_MALLOC PGM_GNUC_ALLOC_SIZE(1);
 void* pgm_malloc0_n (const size_t, const size_t) PGM_GNUC_MALLOC PGM_GNUC_ALLOC_SIZE2(1, 2);
@@ -46,6 +67,32 @@ void* pgm_memdup (const void*, const size_t) PGM_GNUC_MALLOC;
 void* pgm_realloc (void*, const size_t) PGM_GNUC_WARN_UNUSED_RESULT;
 void pgm_free (void*);
 
+/* process-wide budget of window packet buffers in bytes, 0 = unlimited */
+void pgm_mem_set_budget (const uint64_t);
+uint64_t pgm_mem_get_budget (void) PGM_GNUC_WARN_UNUSED_RESULT;
+uint64_t pgm_mem_get_used (void) PGM_GNUC_WARN_UNUSED_RESULT;
+
+/* allocation sites, calls and bytes are counted per thread and summed when read */
+enum {
+	PGM_MEM_SUBSYS_GENERAL = 0,
+	PGM_MEM_SUBSYS_SKB,		/* heap skbuffs */
+	PGM_MEM_SUBSYS_PLACEHOLDER,	/* lost packet skbuffs beyond the pool */
+	PGM_MEM_SUBSYS_HASHTABLE,
+	PGM_MEM_SUBSYS_LIST,		/* pgm_list_t and pgm_slist_t links */
+	PGM_MEM_SUBSYS_FEC,		/* parity buffers, decoders and matrices */
+	PGM_MEM_SUBSYS_PEER,
+	PGM_MEM_SUBSYS_WINDOW,		/* window and slab storage */
+	PGM_MEM_SUBSYS_MAX
+};
+
+struct pgm_mem_subsys_stats_t {
+	uint64_t	calls;
+	uint64_t	bytes;
+};
+
+void pgm_mem_get_subsys_stats (struct pgm_mem_subsys_stats_t*, const unsigned);
+const char* pgm_mem_subsys_name (const unsigned) PGM_GNUC_CONST;
+
 /* Convenience memory allocators that wont work well above 32-bit sizes
  */
 #define pgm_new(struct_type, n_structs) \
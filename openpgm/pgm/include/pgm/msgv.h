@@ -27,6 +27,7 @@
 
 struct pgm_iovec;
 struct pgm_msgv_t;
+struct pgm_bulk_msg_t;
 
 #include <pgm/types.h>
 #include <pgm/packet.h>
@@ -52,6 +53,42 @@ struct pgm_msgv_t {
 	struct pgm_sk_buff_t*	msgv_skb[PGM_MAX_FRAGMENTS];	/* PGM socket buffer array */
 };
 
+/* APDU copied into a caller provided arena by pgm_recvbulk() */
+struct pgm_bulk_msg_t {
+	pgm_tsi_t		bm_tsi;				/* source */
+	uint32_t		bm_sqn;				/* sequence number of first TPDU */
+	uint32_t		bm_offset;			/* from start of arena */
+	uint32_t		bm_len;				/* APDU length */
+};
+
+/* skbuffs returned by pgm_recvmsgv() belong to the receive window and are
+ * released on the next call.  borrow to keep an APDU beyond that call, on any
+ * thread, without holding back the window; return each with
+ * pgm_msgv_release() or pgm_skb_release() per skbuff.
+ */
+
+static inline
+void
+pgm_msgv_borrow (
+	const struct pgm_msgv_t*const	msgv
+	)
+{
+	uint32_t i;
+	for (i = 0; i < msgv->msgv_len; i++)
+		pgm_skb_borrow (msgv->msgv_skb[i]);
+}
+
+static inline
+void
+pgm_msgv_release (
+	const struct pgm_msgv_t*const	msgv
+	)
+{
+	uint32_t i;
+	for (i = 0; i < msgv->msgv_len; i++)
+		pgm_skb_release (msgv->msgv_skb[i]);
+}
+
 PGM_END_DECLS
 
 #endif /* __PGM_MSGV_H__ */
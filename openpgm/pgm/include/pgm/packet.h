@@ -85,6 +85,7 @@ enum pgm_type_e {
 	PGM_NCF		= 0x0a,	/* 8.3: NCF or NAK confirmation */
 	PGM_SPMR	= 0x0c,	/* 13.6: SPM request */
 	PGM_ACK		= 0x0d,	/* PGMCC: congestion control ACK */
+	PGM_CDATA	= 0x0e,	/* OpenPGM: compact original data */
 	PGM_MAX		= 0xff
 };
 
@@ -100,6 +101,15 @@ enum pgm_type_e {
 #define PGM_OPT_PARITY_PRM	    0x08	/* forward error correction parameters */
 #define PGM_OPT_PARITY_GRP	    0x09	/*   group number */
 #define PGM_OPT_CURR_TGSIZE	    0x0a	/*   group size */
+#define PGM_OPT_SW_PRM		    0x14	/* sliding window FEC parameters */
+#define PGM_OPT_SW_REPAIR	    0x15	/*   repair coding window */
+#define PGM_OPT_BATCH		    0x16	/* coalesced messages */
+#define PGM_OPT_CATCHUP		    0x17	/* late join unicast catch-up */
+#define PGM_OPT_COMPRESS	    0x18	/* compressed APDU */
+#define PGM_OPT_CONFLATE	    0x19	/* last-value key */
+#define PGM_OPT_ACK_TRAIL	    0x1a	/* receiver contiguous lead */
+#define PGM_OPT_CREDIT		    0x1b	/* receiver flow control credit */
+#define PGM_OPT_COMPACT		    0x1c	/* compact data headers accepted */
 
 #define PGM_OPT_CR		    0x10	/* congestion report */
 #define PGM_OPT_CRQST		    0x11	/* congestion report request */
@@ -167,6 +177,29 @@ struct pgm_data {
 	/* ... data */
 };
 
+/* OpenPGM compact original data, UDP encapsulation only, GSI implied by the
+ * session of the source transport address.
+ */
+struct pgm_compact_header {
+	uint16_t	pgm_sport;		/* source port: tsi::sport */
+	uint16_t	pgm_dport;		/* destination port */
+	uint8_t		pgm_type;		/* PGM_CDATA */
+	uint8_t		pgm_options;		/* PGM_OPT_PRESENT for a short fragment */
+	uint16_t	pgm_checksum;		/* checksum of the standard ODATA encoding */
+	uint16_t	cdata_sqn;		/* low 16 bits of data_sqn */
+	uint16_t	cdata_trail;		/* data_sqn - data_trail */
+	uint16_t	pgm_tsdu_length;	/* data length */
+	/* ... short fragment */
+	/* ... data */
+};
+
+/* short form of OPT_LENGTH + OPT_FRAGMENT */
+struct pgm_compact_fragment {
+	uint16_t	cfrag_sqn;		/* data_sqn - opt_sqn */
+	uint16_t	cfrag_off;		/* offset */
+	uint16_t	cfrag_len;		/* APDU length */
+};
+
 /* 8.3.  Negative Acknowledgments and Confirmations (NAK, N-NAK, & NCF) */
 struct pgm_nak {
 	uint32_t	nak_sqn;		/* requested sequence number */
@@ -293,6 +326,67 @@ struct pgm_opt_curr_tgsize {
 	uint32_t	prm_atgsize;		/* actual transmission group size */
 };
 
+/* Option Sliding Window Parameters - OPT_SW_PRM */
+struct pgm_opt_sw_prm {
+	uint8_t		opt_reserved;		/* reserved */
+	uint8_t		sw_prm_window;		/* maximum source packets per repair */
+};
+
+/* Option Sliding Window Repair - OPT_SW_REPAIR, RDATA data_sqn is the last covered packet */
+struct pgm_opt_sw_repair {
+	uint8_t		opt_reserved;		/* reserved */
+	uint8_t		sw_repair_count;	/* covered source packets */
+	uint16_t	sw_repair_key;		/* coding coefficient seed */
+};
+
+/* Option Batch - OPT_BATCH, TSDU holds batch_count messages each prefixed with
+ * a 16-bit length in network order.
+ */
+struct pgm_opt_batch {
+	uint8_t		opt_reserved;		/* reserved */
+	uint8_t		batch_reserved;
+	uint16_t	batch_count;		/* coalesced messages */
+};
+
+/* Option Compress - OPT_COMPRESS, in every TPDU of an APDU compressed whole
+ * into compress_apdu_len bytes with the dictionary compress_dict_id.
+ */
+struct pgm_opt_compress {
+	uint8_t		opt_reserved;		/* reserved */
+	uint8_t		compress_type;		/* PGM_COMPRESS_* */
+	uint16_t	compress_dict_id;	/* 0 = none */
+	uint32_t	compress_apdu_len;	/* uncompressed length */
+};
+
+/* Option Conflate - OPT_CONFLATE, APDU of key conflate_key supersedes the earlier
+ * APDU conflate_prev_sqn of the same key, or none when equal to the data sequence.
+ */
+struct pgm_opt_conflate {
+	uint8_t		opt_reserved;		/* reserved */
+	uint8_t		conflate_reserved[3];
+	uint32_t	conflate_prev_sqn;	/* previous sequence of key */
+	uint8_t		conflate_key[8];	/* key bytes, zero padded */
+};
+
+/* Option Catch-up - OPT_CATCHUP, NAK nak_sqn is the first of catchup_count sequences
+ * requested as unicast RDATA to the receiver NLA.
+ */
+struct pgm_opt_catchup {
+	uint8_t		opt_reserved;		/* reserved */
+	uint32_t	catchup_count;		/* requested sequences */
+	uint16_t	opt_nla_afi;		/* nla afi */
+	uint16_t	opt_reserved2;		/* reserved */
+	struct in_addr	opt_nla;		/* receiver nla */
+};
+
+struct pgm_opt6_catchup {
+	uint8_t		opt6_reserved;		/* reserved */
+	uint32_t	catchup6_count;		/* requested sequences */
+	uint16_t	opt6_nla_afi;		/* nla afi */
+	uint16_t	opt6_reserved2;		/* reserved */
+	struct in6_addr	opt6_nla;		/* receiver nla */
+};
+
 /*
  * Congestion Control
  */
@@ -361,6 +455,48 @@ struct pgm_opt6_pgmcc_feedback {
 	struct in6_addr	opt6_nla;		/* ACKER nla */
 };
 
+/* Option ACK Trail - OPT_ACK_TRAIL, ACK ack_rx_max is the contiguous lead of the
+ * receiver NLA, every earlier sequence received or abandoned.
+ */
+struct pgm_opt_ack_trail {
+	uint8_t		opt_reserved;		/* reserved */
+	uint8_t		ack_trail_reserved[3];
+	uint16_t	opt_nla_afi;		/* nla afi */
+	uint16_t	opt_reserved2;		/* reserved */
+	struct in_addr	opt_nla;		/* receiver nla */
+};
+
+struct pgm_opt6_ack_trail {
+	uint8_t		opt6_reserved;		/* reserved */
+	uint8_t		ack_trail6_reserved[3];
+	uint16_t	opt6_nla_afi;		/* nla afi */
+	uint16_t	opt6_reserved2;		/* reserved */
+	struct in6_addr	opt6_nla;		/* receiver nla */
+};
+
+/* Option Credit - OPT_CREDIT, unused receive window and application read rate
+ * of the receiver NLA for the source to limit its original data rate.
+ */
+struct pgm_opt_credit {
+	uint8_t		opt_reserved;		/* reserved */
+	uint8_t		credit_reserved[3];
+	uint32_t	opt_free_sqns;		/* unused receive window sequences */
+	uint32_t	opt_read_rate;		/* bytes per second read by the application */
+	uint16_t	opt_nla_afi;		/* nla afi */
+	uint16_t	opt_reserved2;		/* reserved */
+	struct in_addr	opt_nla;		/* receiver nla */
+};
+
+struct pgm_opt6_credit {
+	uint8_t		opt6_reserved;		/* reserved */
+	uint8_t		credit6_reserved[3];
+	uint32_t	opt6_free_sqns;
+	uint32_t	opt6_read_rate;
+	uint16_t	opt6_nla_afi;		/* nla afi */
+	uint16_t	opt6_reserved2;		/* reserved */
+	struct in6_addr	opt6_nla;		/* receiver nla */
+};
+
 
 /*
  * SPM Requests
@@ -450,6 +586,12 @@ struct pgm_opt6_path_nla {
 	struct in6_addr opt6_path_nla;		/* path nla */
 };
 
+/* Option Compact - OPT_COMPACT, SPM announcement that PGM_CDATA may follow */
+struct pgm_opt_compact {
+	uint8_t		opt_reserved;		/* reserved */
+	uint8_t		compact_reserved;
+};
+
 
 #if ((defined( __GNUC__ ) && ( __GNUC__ >= 4 )) && !defined( __sun ) && !defined( __CYGWIN__ )) || defined( __xlc__ ) || defined( __xlC__ )
 #	pragma pack(pop)
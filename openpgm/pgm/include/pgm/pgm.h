@@ -33,16 +33,25 @@
 #	pragma comment (lib, "advapi32")
 #endif
 
+#include <pgm/affinity.h>
 #include <pgm/atomic.h>
+#include <pgm/capture.h>
+#include <pgm/channel.h>
 #include <pgm/engine.h>
 #include <pgm/error.h>
+#include <pgm/evtrace.h>
 #include <pgm/gsi.h>
+#include <pgm/histogram.h>
 #include <pgm/if.h>
+#include <pgm/local.h>
 #include <pgm/macros.h>
 #include <pgm/mem.h>
 #include <pgm/messages.h>
 #include <pgm/msgv.h>
 #include <pgm/packet.h>
+#include <pgm/profile.h>
+#include <pgm/record.h>
+#include <pgm/shmstats.h>
 #include <pgm/skbuff.h>
 #include <pgm/socket.h>
 #include <pgm/time.h>
@@ -0,0 +1,598 @@
+/* vim:ts=8:sts=4:sw=4:noai:noexpandtab
+ *
+ * Asynchronous PGM socket, completion handlers and C++20 awaitables
+ * serviced by a poll reactor.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef __PGM_ASYNC_HH__
+#define __PGM_ASYNC_HH__
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <utility>
+#include <vector>
+#ifndef _WIN32
+#	include <poll.h>
+#else
+#	include <ws2tcpip.h>
+#endif
+#if defined(__has_include)
+#	if __has_include(<version>)
+#		include <version>
+#	endif
+#endif
+#if defined(__cpp_lib_span)
+#	include <span>
+#endif
+#if defined(__cpp_impl_coroutine) && defined(__cpp_lib_coroutine)
+#	include <coroutine>
+#	include <exception>
+#endif
+
+#include <pgm/pgm_socket.hh>
+#include <pgm/pgm_message.hh>
+
+/// Result of an awaited receive.
+struct pgm_receive_result
+{
+	int		status;		/// PGM_IO_STATUS_*
+	pgm_message	message;
+};
+
+/// Result of an awaited send.
+struct pgm_send_result
+{
+	int		status;		/// PGM_IO_STATUS_*
+	std::size_t	bytes_written;
+};
+
+class pgm_io_context;
+
+/// Operation queues of one socket, serviced by the owning pgm_io_context.
+/// Receives drive the protocol timers, so every registered socket is polled
+/// for timer expiration whether or not an operation is outstanding: an APDU
+/// completed without a waiting receive is held for the next one.
+class pgm_async_service
+{
+public:
+	/// Handler signature for receive completion.
+	typedef std::function<void (int, pgm_message)> receive_handler;
+
+	/// Handler signature for send completion.
+	typedef std::function<void (int, std::size_t)> send_handler;
+
+	/// Start an asynchronous receive of one APDU.
+	void async_receive (receive_handler handler)
+	{
+		this->rx_ops_.push_back (std::move (handler));
+	}
+
+	/// Start an asynchronous send of one APDU, the buffer must remain valid
+	/// until the handler is called.
+	void async_send (const void* buf, std::size_t len, send_handler handler)
+	{
+		tx_op op;
+		op.buf = buf;
+		op.len = len;
+		op.handler = std::move (handler);
+		this->tx_ops_.push_back (std::move (op));
+	}
+
+#if defined(__cpp_lib_span)
+	void async_send (std::span<const std::byte> buf, send_handler handler)
+	{
+		this->async_send (buf.data(), buf.size(), std::move (handler));
+	}
+#endif
+
+	/// Whether any operation is outstanding.
+	bool has_work() const
+	{
+		return !this->rx_ops_.empty() || !this->tx_ops_.empty();
+	}
+
+protected:
+	pgm_async_service() : tx_state_ (TX_READY), is_rx_due_ (false), is_tx_due_ (false) {}
+	virtual ~pgm_async_service() {}
+
+	virtual cpgm::pgm_sock_t* service_native() = 0;
+
+private:
+	friend class pgm_io_context;
+
+	struct tx_op
+	{
+		const void*	buf;
+		std::size_t	len;
+		send_handler	handler;
+	};
+
+	struct rx_result
+	{
+		int		status;
+		pgm_message	message;
+	};
+
+	enum { TX_READY, TX_RATE_LIMITED, TX_BLOCKED };
+
+/* readiness interest for the next poll, lowers the timeout to the next deadline in
+ * milliseconds.  returns true when work can proceed without waiting.
+ */
+	bool prepare (short* events, int* timeout)
+	{
+		cpgm::pgm_sock_t* sock = this->service_native();
+		struct cpgm::pgm_sock_events_t ev;
+		bool is_ready = false;
+
+		*events = 0;
+		this->is_rx_due_ = this->is_tx_due_ = false;
+		if (NULL == sock || !cpgm::pgm_sock_events (sock, &ev)) {
+/* unbound or closed, fail any outstanding operation */
+			this->is_rx_due_ = !this->rx_ops_.empty();
+			this->is_tx_due_ = !this->tx_ops_.empty();
+			return this->is_rx_due_ || this->is_tx_due_;
+		}
+
+		const bool want_rx = !this->rx_ops_.empty();
+		if (want_rx && !this->rx_backlog_.empty()) {
+			this->is_rx_due_ = is_ready = true;
+		} else if (ev.pe_events & (cpgm::PGM_EVENT_TIMER | cpgm::PGM_EVENT_REPAIR)) {
+			this->is_rx_due_ = is_ready = true;
+		} else if (ev.pe_events & (cpgm::PGM_EVENT_DATA | cpgm::PGM_EVENT_READ)) {
+/* without a waiting receive the data stays in the receive window until a timer is due */
+			if (want_rx)
+				this->is_rx_due_ = is_ready = true;
+		} else {
+			*events |= POLLIN;
+		}
+		if (ev.pe_timer_remain > 0)
+			lower_timeout (timeout, ev.pe_timer_remain);
+
+		if (!this->tx_ops_.empty()) {
+			switch (this->tx_state_) {
+			case TX_READY:
+				this->is_tx_due_ = is_ready = true;
+				break;
+			case TX_RATE_LIMITED: {
+				struct timeval tv;
+				::socklen_t optlen = sizeof (tv);
+				if (!cpgm::pgm_getsockopt (sock, IPPROTO_PGM, cpgm::PGM_RATE_REMAIN, &tv, &optlen) ||
+				    (0 == tv.tv_sec && 0 == tv.tv_usec))
+				{
+					this->is_tx_due_ = is_ready = true;
+				}
+				else
+					lower_timeout (timeout, (tv.tv_sec * 1000000UL) + tv.tv_usec);
+				break;
+			}
+			case TX_BLOCKED:
+				if (ev.pe_events & cpgm::PGM_EVENT_CONGESTION_CLEARED)
+					this->is_tx_due_ = is_ready = true;
+				else
+					*events |= POLLOUT;
+				break;
+			}
+		}
+		return is_ready;
+	}
+
+/* perform non-blocking i/o and run completion handlers, returns the count of
+ * handlers run.
+ */
+	std::size_t perform (bool is_readable, bool is_writable)
+	{
+		cpgm::pgm_sock_t* sock = this->service_native();
+		std::size_t count = 0;
+
+		if (NULL == sock) {
+			while (!this->rx_ops_.empty())
+				count += complete_receive (cpgm::PGM_IO_STATUS_ERROR, pgm_message());
+			while (!this->tx_ops_.empty()) {
+				send_handler handler (std::move (this->tx_ops_.front().handler));
+				this->tx_ops_.pop_front();
+				handler (cpgm::PGM_IO_STATUS_ERROR, 0);
+				count++;
+			}
+			return count;
+		}
+
+/* a congestion stall waits on the ACK socket rather than the send socket */
+		if ((is_readable || is_writable) && TX_BLOCKED == this->tx_state_)
+			this->is_tx_due_ = true;
+
+/* receive, at most one APDU when nobody is waiting */
+		if (this->is_rx_due_ || is_readable) {
+			bool is_once = this->rx_ops_.empty();
+			while (!this->rx_ops_.empty() && !this->rx_backlog_.empty()) {
+				rx_result result (std::move (this->rx_backlog_.front()));
+				this->rx_backlog_.pop_front();
+				count += complete_receive (result.status, std::move (result.message));
+			}
+			while (is_once || !this->rx_ops_.empty()) {
+				struct cpgm::pgm_msgv_t msgv;
+				cpgm::pgm_error_t* pgm_err = NULL;
+				std::size_t bytes_read = 0;
+#ifdef MSG_DONTWAIT
+				const int status = cpgm::pgm_recvmsgv (sock, &msgv, 1, MSG_DONTWAIT, &bytes_read, &pgm_err);
+#else
+				const int status = cpgm::pgm_recvmsgv (sock, &msgv, 1, 0, &bytes_read, &pgm_err);
+#endif
+				if (pgm_err)
+					cpgm::pgm_error_free (pgm_err);
+				if (cpgm::PGM_IO_STATUS_WOULD_BLOCK == status ||
+				    cpgm::PGM_IO_STATUS_TIMER_PENDING == status ||
+				    cpgm::PGM_IO_STATUS_RATE_LIMITED == status)
+					break;
+				pgm_message message;
+				if (cpgm::PGM_IO_STATUS_NORMAL == status)
+					message = pgm_message (msgv);
+				if (this->rx_ops_.empty()) {
+					rx_result result = { status, std::move (message) };
+					this->rx_backlog_.push_back (std::move (result));
+				} else {
+					count += complete_receive (status, std::move (message));
+				}
+				if (cpgm::PGM_IO_STATUS_ERROR == status || cpgm::PGM_IO_STATUS_EOF == status)
+					break;
+				is_once = false;
+			}
+		}
+
+/* send in order until the socket would block */
+		if (this->is_tx_due_) {
+			this->tx_state_ = TX_READY;
+			while (!this->tx_ops_.empty()) {
+				std::size_t bytes_written = 0;
+				const int status = cpgm::pgm_send (sock, this->tx_ops_.front().buf, this->tx_ops_.front().len, &bytes_written);
+				if (cpgm::PGM_IO_STATUS_RATE_LIMITED == status) {
+					this->tx_state_ = TX_RATE_LIMITED;
+					break;
+				}
+				if (cpgm::PGM_IO_STATUS_WOULD_BLOCK == status ||
+				    cpgm::PGM_IO_STATUS_CONGESTION == status)
+				{
+					this->tx_state_ = TX_BLOCKED;
+					break;
+				}
+				send_handler handler (std::move (this->tx_ops_.front().handler));
+				this->tx_ops_.pop_front();
+				handler (status, bytes_written);
+				count++;
+			}
+		}
+		return count;
+	}
+
+	std::size_t complete_receive (int status, pgm_message message)
+	{
+		receive_handler handler (std::move (this->rx_ops_.front()));
+		this->rx_ops_.pop_front();
+		handler (status, std::move (message));
+		return 1;
+	}
+
+	static void lower_timeout (int* timeout, unsigned long usecs)
+	{
+		const int msecs = static_cast<int>((usecs + 999) / 1000);
+		if (*timeout < 0 || msecs < *timeout)
+			*timeout = msecs;
+	}
+
+	std::deque<receive_handler>	rx_ops_;
+	std::deque<rx_result>		rx_backlog_;
+	std::deque<tx_op>		tx_ops_;
+	int				tx_state_;
+	bool				is_rx_due_;
+	bool				is_tx_due_;
+};
+
+/// Single threaded reactor running completion handlers for any number of
+/// PGM sockets.  All operations on the context and its sockets, and every
+/// handler, run on the thread calling run().  A socket must outlive its
+/// outstanding operations and must not be destroyed from its own handler.
+/// As with the C API a sender keeps a receive outstanding to answer NAKs,
+/// run() returns once no operation remains.
+class pgm_io_context
+{
+public:
+	pgm_io_context() : is_stopped_ (false)
+	{
+	}
+
+	/// Run handlers until stopped or no operations remain, returns the count
+	/// of handlers run.
+	std::size_t run()
+	{
+		std::size_t count = 0;
+		while (!this->is_stopped_ && this->has_work())
+			count += this->do_one (-1);
+		return count;
+	}
+
+	/// Run until at least one handler has run.
+	std::size_t run_one()
+	{
+		std::size_t count = 0;
+		while (!this->is_stopped_ && this->has_work() && 0 == count)
+			count += this->do_one (-1);
+		return count;
+	}
+
+	/// Run handlers that are ready without blocking.
+	std::size_t poll()
+	{
+		if (this->is_stopped_)
+			return 0;
+		return this->do_one (0);
+	}
+
+	/// Stop the event loop, outstanding operations remain queued.
+	void stop()
+	{
+		this->is_stopped_ = true;
+	}
+
+	bool stopped() const
+	{
+		return this->is_stopped_;
+	}
+
+	/// Allow run() to be called again after stop().
+	void restart()
+	{
+		this->is_stopped_ = false;
+	}
+
+private:
+	template <typename Protocol> friend class pgm_async_socket;
+
+#ifndef _WIN32
+	typedef struct ::pollfd pollfd_type;
+#else
+	typedef WSAPOLLFD pollfd_type;
+#endif
+
+/* upper bound on descriptors from pgm_poll_info() for one socket */
+	enum { MAX_FDS_PER_SOCKET = 16 };
+
+	void add (pgm_async_service* service)
+	{
+		this->services_.push_back (service);
+	}
+
+	void remove (pgm_async_service* service)
+	{
+		for (std::size_t i = 0; i < this->services_.size(); i++)
+			if (this->services_[i] == service) {
+				this->services_.erase (this->services_.begin() + i);
+				break;
+			}
+	}
+
+	bool has_work() const
+	{
+		for (std::size_t i = 0; i < this->services_.size(); i++)
+			if (this->services_[i]->has_work())
+				return true;
+		return false;
+	}
+
+/* one poll iteration, with a timeout of -1 waiting until the next protocol deadline */
+	std::size_t do_one (int max_timeout)
+	{
+		const std::vector<pgm_async_service*> services (this->services_);
+		std::vector<std::size_t> offsets (services.size() + 1, 0);
+		int timeout = max_timeout;
+		bool is_ready = false;
+
+		this->fds_.resize (services.size() * MAX_FDS_PER_SOCKET);
+		std::size_t nfds = 0;
+		for (std::size_t i = 0; i < services.size(); i++) {
+			short events;
+			offsets[i] = nfds;
+			if (services[i]->prepare (&events, &timeout))
+				is_ready = true;
+			if (events) {
+#ifndef _WIN32
+				int n = MAX_FDS_PER_SOCKET;
+				if (cpgm::pgm_poll_info (services[i]->service_native(), &this->fds_[nfds], &n, events) >= 0)
+					nfds += n;
+#else
+				ULONG n = MAX_FDS_PER_SOCKET;
+				if (cpgm::pgm_wsapoll_info (services[i]->service_native(), &this->fds_[nfds], &n, events) >= 0)
+					nfds += n;
+#endif
+			}
+		}
+		offsets[services.size()] = nfds;
+
+		if (is_ready)
+			timeout = 0;
+		else if (0 == nfds && timeout < 0)
+			return 0;
+		if (nfds > 0 || timeout != 0) {
+#ifndef _WIN32
+			::poll (this->fds_.data(), nfds, timeout);
+#else
+			::WSAPoll (this->fds_.data(), static_cast<ULONG>(nfds), timeout);
+#endif
+		}
+
+		std::size_t count = 0;
+		for (std::size_t i = 0; i < services.size(); i++) {
+			bool is_readable = false, is_writable = false;
+			for (std::size_t j = offsets[i]; j < offsets[i + 1]; j++) {
+				if (this->fds_[j].revents & (POLLIN | POLLERR | POLLHUP))
+					is_readable = true;
+				if (this->fds_[j].revents & POLLOUT)
+					is_writable = true;
+			}
+/* a lapsed timeout is serviced by prepare() on the next iteration */
+			count += services[i]->perform (is_readable, is_writable);
+		}
+		return count;
+	}
+
+	std::vector<pgm_async_service*>	services_;
+	std::vector<pollfd_type>	fds_;
+	bool				is_stopped_;
+};
+
+#if defined(__cpp_impl_coroutine) && defined(__cpp_lib_coroutine)
+/// Awaitable receive, resumes on the io_context thread.
+class pgm_receive_awaitable
+{
+public:
+	explicit pgm_receive_awaitable (pgm_async_service& service) : service_ (service) {}
+
+	bool await_ready() const
+	{
+		return false;
+	}
+
+	void await_suspend (std::coroutine_handle<> h)
+	{
+		this->service_.async_receive ([this, h] (int status, pgm_message message) {
+			this->result_.status = status;
+			this->result_.message = std::move (message);
+			h.resume();
+		});
+	}
+
+	pgm_receive_result await_resume()
+	{
+		return std::move (this->result_);
+	}
+
+private:
+	pgm_async_service&	service_;
+	pgm_receive_result	result_ {};
+};
+
+/// Awaitable send, resumes on the io_context thread.
+class pgm_send_awaitable
+{
+public:
+	pgm_send_awaitable (pgm_async_service& service, std::span<const std::byte> buf) : service_ (service), buf_ (buf) {}
+
+	bool await_ready() const
+	{
+		return false;
+	}
+
+	void await_suspend (std::coroutine_handle<> h)
+	{
+		this->service_.async_send (this->buf_, [this, h] (int status, std::size_t bytes_written) {
+			this->result_.status = status;
+			this->result_.bytes_written = bytes_written;
+			h.resume();
+		});
+	}
+
+	pgm_send_result await_resume() const
+	{
+		return this->result_;
+	}
+
+private:
+	pgm_async_service&		service_;
+	std::span<const std::byte>	buf_;
+	pgm_send_result			result_ {};
+};
+
+/// Fire-and-forget coroutine type for handlers written with co_await, the frame
+/// is destroyed on completion.
+struct pgm_task
+{
+	struct promise_type
+	{
+		pgm_task get_return_object() { return pgm_task(); }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		std::suspend_never final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { std::terminate(); }
+	};
+};
+#endif
+
+/// PGM socket with asynchronous operations serviced by a pgm_io_context.
+template <typename Protocol>
+class pgm_async_socket : public pgm_socket<Protocol>, public pgm_async_service
+{
+public:
+	explicit pgm_async_socket (pgm_io_context& io_context) : io_context_ (io_context)
+	{
+		this->io_context_.add (this);
+	}
+
+	~pgm_async_socket()
+	{
+		this->io_context_.remove (this);
+	}
+
+	/// Open a new PGM socket implementation in non-blocking mode.
+	bool open (::sa_family_t family, int sock_type, int protocol, cpgm::pgm_error_t** error)
+	{
+		const int nonblocking = 1;
+		if (!pgm_socket<Protocol>::open (family, sock_type, protocol, error))
+			return false;
+		return this->set_option (IPPROTO_PGM, cpgm::PGM_NOBLOCK, &nonblocking, sizeof(nonblocking));
+	}
+
+	/// Get the io_context servicing the socket.
+	pgm_io_context& get_io_context()
+	{
+		return this->io_context_;
+	}
+
+#if defined(__cpp_impl_coroutine) && defined(__cpp_lib_coroutine)
+	using pgm_async_service::async_receive;
+	using pgm_async_service::async_send;
+
+	/// co_await sock.async_receive() for a pgm_receive_result.
+	pgm_receive_awaitable async_receive()
+	{
+		return pgm_receive_awaitable (*this);
+	}
+
+	/// co_await sock.async_send (buf) for a pgm_send_result.
+	pgm_send_awaitable async_send (std::span<const std::byte> buf)
+	{
+		return pgm_send_awaitable (*this, buf);
+	}
+#endif
+
+protected:
+	cpgm::pgm_sock_t* service_native()
+	{
+		return this->native();
+	}
+
+private:
+	pgm_io_context&	io_context_;
+};
+
+#endif /* __PGM_ASYNC_HH__ */
@@ -0,0 +1,376 @@
+/* vim:ts=8:sts=4:sw=4:noai:noexpandtab
+ *
+ * Zero-copy PGM message handles and batched receive arena.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef __PGM_MESSAGE_HH__
+#define __PGM_MESSAGE_HH__
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <vector>
+#if defined(__has_include)
+#	if __has_include(<version>)
+#		include <version>
+#	endif
+#endif
+#if defined(__cpp_lib_span)
+#	include <span>
+#endif
+
+#include <pgm/pgm_socket.hh>
+
+/// One TPDU fragment of an APDU, a view into the skbuff.
+#if defined(__cpp_lib_span)
+typedef std::span<const std::byte> pgm_fragment;
+#else
+class pgm_fragment
+{
+public:
+	pgm_fragment (const void* data, std::size_t size) : data_ (data), size_ (size) {}
+
+	const void* data() const
+	{
+		return this->data_;
+	}
+
+	std::size_t size() const
+	{
+		return this->size_;
+	}
+
+private:
+	const void*	data_;
+	std::size_t	size_;
+};
+#endif
+
+/// Random access range of the fragments of one APDU.
+class pgm_fragment_range
+{
+public:
+	class iterator
+	{
+	public:
+		typedef std::random_access_iterator_tag	iterator_category;
+		typedef pgm_fragment			value_type;
+		typedef std::ptrdiff_t			difference_type;
+		typedef const pgm_fragment*		pointer;
+		typedef pgm_fragment			reference;
+
+		iterator() : skb_ (NULL) {}
+		explicit iterator (struct cpgm::pgm_sk_buff_t* const* skb) : skb_ (skb) {}
+
+		pgm_fragment operator*() const
+		{
+#if defined(__cpp_lib_span)
+			return pgm_fragment (static_cast<const std::byte*>((*this->skb_)->data), (*this->skb_)->len);
+#else
+			return pgm_fragment ((*this->skb_)->data, (*this->skb_)->len);
+#endif
+		}
+
+		pgm_fragment operator[] (difference_type n) const
+		{
+			return *(*this + n);
+		}
+
+		iterator& operator++()			{ ++this->skb_; return *this; }
+		iterator operator++ (int)		{ iterator t (*this); ++this->skb_; return t; }
+		iterator& operator--()			{ --this->skb_; return *this; }
+		iterator operator-- (int)		{ iterator t (*this); --this->skb_; return t; }
+		iterator& operator+= (difference_type n){ this->skb_ += n; return *this; }
+		iterator& operator-= (difference_type n){ this->skb_ -= n; return *this; }
+		friend iterator operator+ (iterator i, difference_type n)	{ return i += n; }
+		friend iterator operator+ (difference_type n, iterator i)	{ return i += n; }
+		friend iterator operator- (iterator i, difference_type n)	{ return i -= n; }
+		friend difference_type operator- (const iterator& a, const iterator& b)	{ return a.skb_ - b.skb_; }
+		friend bool operator== (const iterator& a, const iterator& b)	{ return a.skb_ == b.skb_; }
+		friend bool operator!= (const iterator& a, const iterator& b)	{ return a.skb_ != b.skb_; }
+		friend bool operator< (const iterator& a, const iterator& b)	{ return a.skb_ < b.skb_; }
+		friend bool operator> (const iterator& a, const iterator& b)	{ return a.skb_ > b.skb_; }
+		friend bool operator<= (const iterator& a, const iterator& b)	{ return a.skb_ <= b.skb_; }
+		friend bool operator>= (const iterator& a, const iterator& b)	{ return a.skb_ >= b.skb_; }
+
+	private:
+		struct cpgm::pgm_sk_buff_t* const* skb_;
+	};
+
+	explicit pgm_fragment_range (const cpgm::pgm_msgv_t& msgv) : msgv_ (&msgv) {}
+
+	iterator begin() const
+	{
+		return iterator (this->msgv_->msgv_skb);
+	}
+
+	iterator end() const
+	{
+		return iterator (this->msgv_->msgv_skb + this->msgv_->msgv_len);
+	}
+
+	std::size_t size() const
+	{
+		return this->msgv_->msgv_len;
+	}
+
+	bool empty() const
+	{
+		return 0 == this->msgv_->msgv_len;
+	}
+
+	pgm_fragment operator[] (std::size_t i) const
+	{
+		return this->begin()[i];
+	}
+
+private:
+	const cpgm::pgm_msgv_t* msgv_;
+};
+
+/// Accessors shared by owning and borrowed messages, Derived provides native().
+template <typename Derived>
+class pgm_msgv_accessors
+{
+public:
+	/// Whether the message holds no data.
+	bool empty() const
+	{
+		return 0 == this->msgv().msgv_len;
+	}
+
+	/// Fragments of the APDU as a range of views.
+	pgm_fragment_range fragments() const
+	{
+		return pgm_fragment_range (this->msgv());
+	}
+
+	/// Total APDU length.
+	std::size_t size() const
+	{
+		std::size_t len = 0;
+		for (unsigned i = 0; i < this->msgv().msgv_len; i++)
+			len += this->msgv().msgv_skb[i]->len;
+		return len;
+	}
+
+	/// Transport session of the source, the message must not be empty.
+	const cpgm::pgm_tsi_t& tsi() const
+	{
+		return this->msgv().msgv_skb[0]->tsi;
+	}
+
+	/// Copy the APDU into a flat buffer, returns bytes copied.
+	std::size_t copy (void* buf, std::size_t len) const
+	{
+		char* dst = static_cast<char*>(buf);
+		std::size_t copied = 0;
+		for (unsigned i = 0; i < this->msgv().msgv_len && copied < len; i++) {
+			std::size_t n = this->msgv().msgv_skb[i]->len;
+			if (n > len - copied)
+				n = len - copied;
+			std::memcpy (dst + copied, this->msgv().msgv_skb[i]->data, n);
+			copied += n;
+		}
+		return copied;
+	}
+
+protected:
+	const cpgm::pgm_msgv_t& msgv() const
+	{
+		return static_cast<const Derived*>(this)->native();
+	}
+};
+
+/// A received APDU borrowed from the receive window, valid until the next
+/// receive call on the socket.
+class pgm_message_view : public pgm_msgv_accessors<pgm_message_view>
+{
+public:
+	explicit pgm_message_view (const cpgm::pgm_msgv_t& msgv) : msgv_ (&msgv) {}
+
+	/// Get the native message vector.
+	const cpgm::pgm_msgv_t& native() const
+	{
+		return *this->msgv_;
+	}
+
+private:
+	const cpgm::pgm_msgv_t* msgv_;
+};
+
+/// A received APDU.  Holds a reference on every skbuff of the message so that
+/// the contents remain valid after the receive window advances, released on
+/// destruction.  Move-only and free of heap allocation.
+class pgm_message : public pgm_msgv_accessors<pgm_message>
+{
+public:
+	/// Construct an empty message.
+	pgm_message()
+	{
+		this->msgv_.msgv_len = 0;
+	}
+
+	/// Take references on the skbuffs returned by pgm_recvmsgv().
+	explicit pgm_message (const cpgm::pgm_msgv_t& msgv)
+	{
+		this->msgv_.msgv_len = msgv.msgv_len;
+		std::memcpy (this->msgv_.msgv_skb, msgv.msgv_skb, msgv.msgv_len * sizeof (msgv.msgv_skb[0]));
+		cpgm::pgm_msgv_borrow (&this->msgv_);
+	}
+
+	/// Take references on a borrowed message.
+	explicit pgm_message (const pgm_message_view& view) : pgm_message (view.native())
+	{
+	}
+
+	pgm_message (pgm_message&& other)
+	{
+		this->msgv_.msgv_len = 0;
+		this->swap (other);
+	}
+
+	pgm_message& operator= (pgm_message&& other)
+	{
+		if (this != &other) {
+			this->reset();
+			this->swap (other);
+		}
+		return *this;
+	}
+
+	pgm_message (const pgm_message&) = delete;
+	pgm_message& operator= (const pgm_message&) = delete;
+
+	~pgm_message()
+	{
+		this->reset();
+	}
+
+	/// Release the skbuff references.
+	void reset()
+	{
+		cpgm::pgm_msgv_release (&this->msgv_);
+		this->msgv_.msgv_len = 0;
+	}
+
+	void swap (pgm_message& other)
+	{
+		cpgm::pgm_msgv_t t;
+		std::memcpy (&t, &this->msgv_, sizeof (t));
+		std::memcpy (&this->msgv_, &other.msgv_, sizeof (t));
+		std::memcpy (&other.msgv_, &t, sizeof (t));
+	}
+
+	/// Get the native message vector.
+	const cpgm::pgm_msgv_t& native() const
+	{
+		return this->msgv_;
+	}
+
+private:
+	cpgm::pgm_msgv_t msgv_;
+};
+
+/// Reusable message vector for batched receive, sized once so that receiving
+/// performs no heap allocation.  Messages are borrowed from the receive window
+/// and valid until the next receive on the socket, take() keeps one longer.
+class pgm_msgv_arena
+{
+public:
+	/// Construct an arena receiving up to capacity APDUs per call.
+	explicit pgm_msgv_arena (std::size_t capacity = 32) : msgv_ (capacity), len_ (0), bytes_ (0)
+	{
+	}
+
+	/// Receive a batch of APDUs, returns PGM_IO_STATUS_*.
+	template <typename Protocol>
+	int receive (pgm_socket<Protocol>& sock, int flags, cpgm::pgm_error_t** error)
+	{
+		return this->receive (sock.native(), flags, error);
+	}
+
+	int receive (cpgm::pgm_sock_t* sock, int flags, cpgm::pgm_error_t** error)
+	{
+		std::size_t bytes_read = 0;
+		this->len_ = this->bytes_ = 0;
+		const int status = cpgm::pgm_recvmsgv (sock, this->msgv_.data(), this->msgv_.size(), flags, &bytes_read, error);
+		if (cpgm::PGM_IO_STATUS_NORMAL != status)
+			return status;
+/* pgm_recvmsgv() fills consecutive entries until the byte count is consumed */
+		this->bytes_ = bytes_read;
+		while (bytes_read > 0 && this->len_ < this->msgv_.size()) {
+			const pgm_message_view view (this->msgv_[this->len_++]);
+			bytes_read -= view.size();
+		}
+		return status;
+	}
+
+	/// Number of APDUs held from the last receive.
+	std::size_t size() const
+	{
+		return this->len_;
+	}
+
+	bool empty() const
+	{
+		return 0 == this->len_;
+	}
+
+	/// Total bytes of the last receive.
+	std::size_t bytes() const
+	{
+		return this->bytes_;
+	}
+
+	std::size_t capacity() const
+	{
+		return this->msgv_.size();
+	}
+
+	pgm_message_view operator[] (std::size_t i) const
+	{
+		return pgm_message_view (this->msgv_[i]);
+	}
+
+	/// Take references on one APDU to keep it past the next receive.
+	pgm_message take (std::size_t i) const
+	{
+		return pgm_message (this->msgv_[i]);
+	}
+
+	/// Forget the last receive, the receive window owns the contents.
+	void clear()
+	{
+		this->len_ = this->bytes_ = 0;
+	}
+
+private:
+	std::vector<cpgm::pgm_msgv_t>	msgv_;
+	std::size_t			len_;
+	std::size_t			bytes_;
+};
+
+#endif /* __PGM_MESSAGE_HH__ */
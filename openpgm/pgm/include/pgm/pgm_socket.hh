@@ -26,10 +26,19 @@
 #	pragma once
 #endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
+/* system headers the C API pulls in, included first to stay outside namespace cpgm */
 #include <cerrno>
+#include <climits>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
 #ifndef _WIN32
 #	include <cstddef>
+#	include <stdint.h>
+#	include <poll.h>
+#	include <sys/types.h>
 #	include <sys/socket.h>
+#	include <netinet/in.h>
 #else
 #	include <ws2tcpip.h>
 #endif
@@ -53,7 +62,7 @@ public:
 	typedef struct cpgm::pgm_sock_t* native_type;
 
 	/// Construct a pgm_socket without opening it.
-	pgm_socket()
+	pgm_socket() : native_type_ (NULL)
 	{
 	}
 
@@ -66,7 +75,9 @@ public:
 	/// Close a PGM socket implementation.
 	bool close (bool flush)
 	{
-		return pgm_close (this->native_type_, flush);
+		const bool status = pgm_close (this->native_type_, flush);
+		this->native_type_ = NULL;
+		return status;
 	}
 
 	/// Get the native socket implementation.
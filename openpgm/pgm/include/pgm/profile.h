@@ -0,0 +1,68 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * cycle accounting of protocol stages.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_PROFILE_H__
+#define __PGM_PROFILE_H__
+
+typedef struct pgm_profile_stage_t pgm_profile_stage_t;
+
+#include <pgm/types.h>
+
+PGM_BEGIN_DECLS
+
+/* protocol stages, a stage called from another is counted in both.
+ */
+enum {
+	PGM_PROFILE_RECVSKB = 0,	/* read of one datagram from any receive path */
+	PGM_PROFILE_PARSE,		/* pgm_parse_raw() or pgm_parse_udp_encap() */
+	PGM_PROFILE_DOWNSTREAM,		/* on_downstream() including pgm_on_data() */
+	PGM_PROFILE_RXW_ADD,
+	PGM_PROFILE_RXW_READ,		/* _pgm_rxw_incoming_read(), packets are messages */
+	PGM_PROFILE_SEND_ODATA,		/* completed ODATA sends, packets are TPDUs */
+	PGM_PROFILE_SENDTO,		/* pgm_sendto_hops() and pgm_sendto_tos() */
+	PGM_PROFILE_RS,			/* Reed-Solomon encode and decode, packets are parity or repairs */
+	PGM_PROFILE_TIMER,		/* pgm_timer_dispatch() */
+	PGM_PROFILE_MAX
+};
+
+/* totals of all threads, cycles are TSC ticks where available otherwise
+ * nanoseconds or performance counter ticks, see pgm_profile_unit().
+ */
+struct pgm_profile_stage_t {
+	uint64_t		calls;
+	uint64_t		packets;
+	uint64_t		cycles;
+};
+
+bool pgm_profile_init (void);
+bool pgm_profile_shutdown (void);
+bool pgm_profile_read (pgm_profile_stage_t*, unsigned);
+const char* pgm_profile_name (unsigned) PGM_GNUC_CONST;
+const char* pgm_profile_unit (void) PGM_GNUC_CONST;
+
+PGM_END_DECLS
+
+#endif /* __PGM_PROFILE_H__ */
+
+/* eof */
@@ -0,0 +1,63 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * recorder of delivered APDUs, on disk format.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_RECORD_H__
+#define __PGM_RECORD_H__
+
+#include <pgm/types.h>
+#include <pgm/tsi.h>
+
+PGM_BEGIN_DECLS
+
+#define PGM_RECORD_DEFAULT_SEGMENT	(UINT64_C(1) << 30)	/* log bytes */
+#define PGM_RECORD_MIN_SEGMENT		(4*1024*1024)
+
+/* log segment <rr_path>.<n>.log, n counting from 000000, is a sequence of records
+ * each a header, the APDU, and zero padding to 8 bytes.  index segment
+ * <rr_path>.<n>.idx has one entry per record of the log segment.  fields are
+ * host byte order.
+ */
+
+struct pgm_record_header_t {
+	uint32_t		rh_size;	/* bytes including header and padding */
+	uint32_t		rh_len;		/* APDU bytes */
+	uint32_t		rh_sqn;		/* first sequence number of the APDU */
+	uint32_t		rh_reserved;
+	pgm_tsi_t		rh_tsi;
+	uint64_t		rh_tstamp;	/* pgm_time_t receive time */
+};
+
+struct pgm_record_index_t {
+	pgm_tsi_t		ri_tsi;
+	uint32_t		ri_sqn;
+	uint32_t		ri_len;
+	uint64_t		ri_tstamp;
+	uint64_t		ri_offset;	/* of the record header in the log segment */
+};
+
+PGM_END_DECLS
+
+#endif /* __PGM_RECORD_H__ */
+
+/* eof */
@@ -0,0 +1,90 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * statistics published to shared memory.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_SHMSTATS_H__
+#define __PGM_SHMSTATS_H__
+
+typedef struct pgm_shmstats_header_t pgm_shmstats_header_t;
+typedef struct pgm_shmstats_slot_t pgm_shmstats_slot_t;
+
+#include <pgm/types.h>
+#include <pgm/error.h>
+#include <pgm/tsi.h>
+
+PGM_BEGIN_DECLS
+
+#define PGM_SHMSTATS_MAGIC		0x5047534dU	/* "PGSM" */
+#define PGM_SHMSTATS_VERSION		1
+#define PGM_SHMSTATS_DEFAULT_SLOTS	1024
+#define PGM_SHMSTATS_DEFAULT_INTERVAL	(100*1000)	/* microseconds */
+#define PGM_SHMSTATS_COUNTERS		48
+#define PGM_SHMSTATS_NAMELEN		40
+
+enum {
+	PGM_SHMSTATS_SLOT_FREE = 0,
+	PGM_SHMSTATS_SLOT_SOURCE,
+	PGM_SHMSTATS_SLOT_RECEIVER
+};
+
+/* The segment is a header followed by slot_count slots of slot_size bytes,
+ * both sizes are recorded so that later versions may extend either.  Counter
+ * names are listed by the header per slot type, an empty name ends a list.
+ */
+struct pgm_shmstats_header_t {
+	uint32_t		magic;
+	uint32_t		version;
+	uint32_t		header_size;
+	uint32_t		slot_size;
+	uint32_t		slot_count;
+	uint32_t		interval;		/* microseconds */
+	uint32_t		pid;
+	volatile uint32_t	slot_len;		/* slots in use */
+	volatile uint32_t	truncated;		/* rows without a slot in last pass */
+	volatile uint32_t	passes;
+	volatile uint64_t	publish_time;		/* pgm_time_t of last pass */
+	char			source_names[PGM_SHMSTATS_COUNTERS][PGM_SHMSTATS_NAMELEN];
+	char			receiver_names[PGM_SHMSTATS_COUNTERS][PGM_SHMSTATS_NAMELEN];
+};
+
+/* sequence is odd whilst the publisher rewrites the slot.
+ */
+struct pgm_shmstats_slot_t {
+	volatile uint32_t	sequence;
+	uint32_t		type;
+	pgm_tsi_t		tsi;
+	pgm_tsi_t		transport_tsi;		/* owning socket */
+	uint64_t		counters[PGM_SHMSTATS_COUNTERS];
+};
+
+bool pgm_shmstats_init (const char*, unsigned, unsigned, pgm_error_t**) PGM_GNUC_WARN_UNUSED_RESULT;
+bool pgm_shmstats_shutdown (void);
+pgm_shmstats_header_t* pgm_shmstats_attach (const char*, pgm_error_t**) PGM_GNUC_WARN_UNUSED_RESULT;
+void pgm_shmstats_detach (pgm_shmstats_header_t*);
+bool pgm_shmstats_read (const pgm_shmstats_header_t*restrict, unsigned, pgm_shmstats_slot_t*restrict);
+
+PGM_END_DECLS
+
+#endif /* __PGM_SHMSTATS_H__ */
+
+/* eof */
@@ -28,6 +28,7 @@
 #include <string.h>
 
 struct pgm_sk_buff_t;
+struct pgm_skb_pool_t;
 
 #include <pgm/types.h>
 #include <pgm/atomic.h>
@@ -40,41 +41,55 @@ struct pgm_sk_buff_t;
 
 PGM_BEGIN_DECLS
 
+/* fields touched by every window operation lead, the receive and transmit
+ * window state in the control buffer follows in the second cache line, fields
+ * of the receive path and allocator trail.
+ */
+
 struct pgm_sk_buff_t {
 	pgm_list_t			link_;
-
-	pgm_sock_t* restrict		sock;
 	pgm_time_t			tstamp;
-	pgm_tsi_t			tsi;
 
 	uint32_t			sequence;
-	uint32_t			__padding;	/* push alignment of pgm_sk_buff_t::cb to 8 bytes */
-
-	char				cb[48];		/* control buffer */
+	volatile uint32_t		users;		/* atomic */
 
 	uint16_t			len;		/* actual data */
 	unsigned			zero_padded:1;
-	unsigned			__padding2:31;	/* fix bit field */
+	unsigned			csum_unnecessary:1;	/* verified below PGM, UDP by host or NIC */
+	unsigned			csum_deferred:1;	/* ODATA checksum verified at the receive window */
+	unsigned			is_batch:1;	/* OPT_BATCH, length-prefixed messages */
+	unsigned			is_private:1;	/* single-threaded owner, plain reference count */
+	unsigned			is_zc_pending:1;	/* MSG_ZEROCOPY send not yet completed */
+	unsigned			__padding:10;	/* fix bit field */
 
+	void			       *data;		/* all may-alias */
 	struct pgm_header*		pgm_header;
+
+	char				cb[32];		/* control buffer, 8 byte aligned */
+
+	void			       *tail;
+	struct pgm_data*		pgm_data;
 	struct pgm_opt_fragment* 	pgm_opt_fragment;
 #define of_apdu_first_sqn		pgm_opt_fragment->opt_sqn
 #define of_frag_offset			pgm_opt_fragment->opt_frag_off
 #define of_apdu_len			pgm_opt_fragment->opt_frag_len
-	struct pgm_opt_pgmcc_data*	pgm_opt_pgmcc_data;
-	struct pgm_data*		pgm_data;
+	void			       *head;
 
-	void			       *head,		/* all may-alias */
-				       *data,
-				       *tail,
-				       *end;
+	void			       *end;
+	pgm_sock_t* restrict		sock;
+	pgm_tsi_t			tsi;
+	pgm_time_t			wire_tstamp;	/* kernel or NIC receive time, else tstamp */
+	struct pgm_opt_pgmcc_data*	pgm_opt_pgmcc_data;
+	struct pgm_opt_compress*	pgm_opt_compress;
+	struct pgm_opt_conflate*	pgm_opt_conflate;
+	struct pgm_skb_pool_t*		pool;		/* owner, NULL = heap */
 	uint32_t			truesize;
-	volatile uint32_t		users;		/* atomic */
 };
 
 void pgm_skb_over_panic (const struct pgm_sk_buff_t*const, const uint16_t) PGM_GNUC_NORETURN;
 void pgm_skb_under_panic (const struct pgm_sk_buff_t*const, const uint16_t) PGM_GNUC_NORETURN;
 bool pgm_skb_is_valid (const struct pgm_sk_buff_t*const) PGM_GNUC_PURE PGM_GNUC_WARN_UNUSED_RESULT;
+void pgm_skb_pool_release (struct pgm_sk_buff_t*const);
 
 /* attribute __pure__ only valid for platforms with atomic ops.
  * attribute __malloc__ not used as only part of the memory should be aliased.
@@ -90,7 +105,7 @@ pgm_alloc_skb (
 {
 	struct pgm_sk_buff_t* skb;
 
-	skb = (struct pgm_sk_buff_t*)pgm_malloc (size + sizeof(struct pgm_sk_buff_t));
+	skb = (struct pgm_sk_buff_t*)pgm_malloc_class (size + sizeof(struct pgm_sk_buff_t), PGM_MEM_CLASS_PACKET);
 /* Requires fast FSB to test
 	pgm_prefetchw (skb);
  */
@@ -115,7 +130,10 @@ pgm_skb_get (
 	struct pgm_sk_buff_t*const skb
 	)
 {
-	pgm_atomic_inc32 (&skb->users);
+	if (skb->is_private)
+		skb->users++;
+	else
+		pgm_atomic_inc32 (&skb->users);
 	return skb;
 }
 
@@ -125,8 +143,32 @@ pgm_free_skb (
 	struct pgm_sk_buff_t*const skb
 	)
 {
-	if (pgm_atomic_exchange_and_add32 (&skb->users, (uint32_t)-1) == 1)
-		pgm_free (skb);
+	if (skb->is_private ? 0 == --skb->users : pgm_atomic_exchange_and_add32 (&skb->users, (uint32_t)-1) == 1) {
+		if (skb->pool)
+			pgm_skb_pool_release (skb);
+		else
+			pgm_free (skb);
+	}
+}
+
+/* keep a receive window skbuff beyond the next receive call */
+static inline
+struct pgm_sk_buff_t*
+pgm_skb_borrow (
+	struct pgm_sk_buff_t*const skb
+	)
+{
+	return pgm_skb_get (skb);
+}
+
+/* return a borrowed skbuff, safe from any thread but for PGM_SINGLE_THREADED sockets */
+static inline
+void
+pgm_skb_release (
+	struct pgm_sk_buff_t*const skb
+	)
+{
+	pgm_free_skb (skb);
 }
 
 /* add data */
@@ -214,10 +256,12 @@ pgm_skb_copy (
 {
 	struct pgm_sk_buff_t* newskb;
 	newskb = (struct pgm_sk_buff_t*)pgm_malloc (skb->truesize);
-	memcpy (newskb, skb, PGM_OFFSETOF(struct pgm_sk_buff_t, pgm_header));
+	memcpy (newskb, skb, sizeof(struct pgm_sk_buff_t));
 	newskb->zero_padded = 0;
+	newskb->is_private = 0;
 	newskb->truesize = skb->truesize;
 	pgm_atomic_write32 (&newskb->users, 1);
+	newskb->pool = NULL;
 	newskb->head = newskb + 1;
 	newskb->end  = (char*)newskb->head + ((char*)skb->end  - (char*)skb->head);
 	newskb->data = (char*)newskb->head + ((char*)skb->data - (char*)skb->head);
@@ -225,6 +269,7 @@ pgm_skb_copy (
 	newskb->pgm_header = skb->pgm_header ? (struct pgm_header*)((char*)newskb->head + ((char*)skb->pgm_header - (char*)skb->head)) : skb->pgm_header;
 	newskb->pgm_opt_fragment = skb->pgm_opt_fragment ? (struct pgm_opt_fragment*)((char*)newskb->head + ((char*)skb->pgm_opt_fragment - (char*)skb->head)) : skb->pgm_opt_fragment;
 	newskb->pgm_data = skb->pgm_data ? (struct pgm_data*)((char*)newskb->head + ((char*)skb->pgm_data - (char*)skb->head)) : skb->pgm_data;
+	newskb->pgm_opt_pgmcc_data = skb->pgm_opt_pgmcc_data ? (struct pgm_opt_pgmcc_data*)((char*)newskb->head + ((char*)skb->pgm_opt_pgmcc_data - (char*)skb->head)) : skb->pgm_opt_pgmcc_data;
 	memcpy (newskb->head, skb->head, (char*)skb->end - (char*)skb->head);
 	return newskb;
 }
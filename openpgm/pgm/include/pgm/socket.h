@@ -36,6 +36,11 @@ struct pgm_fecinto_t;
 #ifdef HAVE_EPOLL
 #	include <sys/epoll.h>
 #endif
+#ifdef HAVE_KQUEUE
+#	include <sys/types.h>
+#	include <sys/event.h>
+#	include <sys/time.h>
+#endif
 #ifndef _WIN32
 #ifdef _AIX
 #   define IP_MULTICAST
@@ -80,6 +85,375 @@ struct pgm_interface_req_t {
 
 #define	PGM_HAS_IR_ADDRESS	1
 
+/* receive only sources of folded TSI hash modulo sr_count equal to sr_index */
+struct pgm_shard_req_t {
+	uint32_t				sr_count;
+	uint32_t				sr_index;
+};
+
+/* AF_XDP receive queue steered to the socket, xr_interface 0 = disabled */
+struct pgm_xdp_req_t {
+	uint32_t				xr_interface;	/* interface index */
+	uint32_t				xr_queue;	/* device receive queue */
+	uint32_t				xr_frames;	/* UMEM frames, power of 2, 0 = default */
+	uint32_t				xr_flags;
+};
+
+#define PGM_XDP_GENERIC		0x1			/* kernel copy mode for devices without native XDP */
+
+/* RDMA unreliable datagram multicast of a UDP encapsulated socket over RoCE or
+ * InfiniBand, vr_port 0 = disabled.
+ */
+struct pgm_verbs_req_t {
+	char					vr_device[64];	/* device name, "" = first device */
+	uint32_t				vr_port;	/* device port */
+	uint32_t				vr_gid_index;	/* source GID, RoCE v2 IPv4 for RoCE */
+	uint32_t				vr_depth;	/* work requests of each queue, power of 2, 0 = default */
+	uint32_t				vr_qkey;	/* 0 = default */
+	uint32_t				vr_mlid;	/* InfiniBand multicast LID, 0 for RoCE */
+};
+
+/* DPDK poll-mode ethdev queue of an IPv4 socket, dr_device "" = disabled */
+struct pgm_dpdk_req_t {
+	char					dr_device[64];	/* ethdev name, PCI address or virtual device */
+	uint32_t				dr_queue;	/* receive and transmit queue */
+	uint32_t				dr_depth;	/* descriptors of each queue, power of 2, 0 = default */
+	uint32_t				dr_flags;
+};
+
+#define PGM_DPDK_CONFIGURE	0x1			/* configure and start the port with the one queue */
+
+/* TPACKET_V3 receive ring of PGM/IP on one interface, tr_interface 0 = disabled */
+struct pgm_tpacket_req_t {
+	uint32_t				tr_interface;	/* interface index */
+	uint32_t				tr_block_size;	/* bytes, power of 2 of at least 4096, 0 = default */
+	uint32_t				tr_blocks;	/* 0 = default */
+	uint32_t				tr_timeout;	/* block retire timeout in milliseconds, 0 = default */
+};
+
+/* in-kernel receive filter, fr_types 0 = all packet types, fr_gsi_len 0 = all sources */
+#define PGM_FILTER_MAX_GSI	16
+#define PGM_FILTER_TYPE(t)	(1U << (t))		/* fr_types bit of a PGM_SPM ... PGM_ACK packet type */
+
+struct pgm_filter_req_t {
+	uint32_t				fr_types;	/* PGM_FILTER_TYPE() bits */
+	uint32_t				fr_gsi_len;
+	pgm_gsi_t				fr_gsi[PGM_FILTER_MAX_GSI];
+};
+
+/* receive only, or all but, the listed sources, tsi sport 0 = every session of the GSI */
+#define PGM_SOURCE_FILTER_MAX	64
+
+enum {
+	PGM_SOURCE_ALLOW = 0,
+	PGM_SOURCE_DENY
+};
+
+struct pgm_source_filter_req_t {
+	uint32_t				sf_mode;	/* PGM_SOURCE_ALLOW or PGM_SOURCE_DENY */
+	uint32_t				sf_len;		/* 0 = all sources */
+	pgm_tsi_t				sf_tsi[PGM_SOURCE_FILTER_MAX];
+};
+
+/* pcapng packet capture ring file, cr_path empty = disabled */
+#define PGM_CAPTURE_PATH_MAX	256
+
+struct pgm_capture_req_t {
+	char					cr_path[PGM_CAPTURE_PATH_MAX];
+	uint32_t				cr_size;	/* file bytes, 0 = default */
+};
+
+/* recorder of delivered APDUs to segmented log files, rr_path empty = disabled */
+#define PGM_RECORD_PATH_MAX	256
+
+struct pgm_record_req_t {
+	char					rr_path[PGM_RECORD_PATH_MAX];	/* segment file prefix */
+	uint64_t				rr_segment_size;	/* log bytes per segment, 0 = default */
+};
+
+/* test impairment of datagrams on receive and transmit, probabilities in parts
+ * per million.  loss follows a Gilbert-Elliott chain, a bernoulli loss model is
+ * ir_loss_good alone.
+ */
+#define PGM_IMPAIR_RX		0x1
+#define PGM_IMPAIR_TX		0x2
+
+struct pgm_impair_req_t {
+	uint32_t				ir_direction;		/* PGM_IMPAIR_RX | PGM_IMPAIR_TX, 0 = disabled */
+	uint32_t				ir_p;			/* good to bad state transition */
+	uint32_t				ir_r;			/* bad to good state transition */
+	uint32_t				ir_loss_good;		/* loss in good state, 1 - k */
+	uint32_t				ir_loss_bad;		/* loss in bad state, 1 - h */
+	uint32_t				ir_duplicate;
+	uint32_t				ir_reorder;		/* held a further ir_reorder_delay */
+	uint32_t				ir_delay;		/* microseconds */
+	uint32_t				ir_jitter;		/* microseconds either side of ir_delay */
+	uint32_t				ir_reorder_delay;	/* microseconds */
+};
+
+/* delivery of complete APDUs from the timer thread in place of pgm_recvmsgv(),
+ * dr_func NULL = disabled.  msgv is only valid until dr_func returns and the tsi
+ * is NULL, unrecoverable loss of a source is its tsi with no messages.
+ */
+typedef void (*pgm_delivery_func_t) (const struct pgm_msgv_t*, size_t, const pgm_tsi_t*, void*);
+
+struct pgm_delivery_req_t {
+	pgm_delivery_func_t			dr_func;
+	void*					dr_user_data;
+};
+
+/* memory-mapped transmit window history file, ts_path empty = disabled */
+#define PGM_TXW_STORE_PATH_MAX	256
+
+struct pgm_txw_store_req_t {
+	char					ts_path[PGM_TXW_STORE_PATH_MAX];
+	uint32_t				ts_sqns;	/* retained sequences, 0 = default */
+};
+
+/* same-host receive from the transmit window store of a source, sr_path empty = disabled */
+struct pgm_shm_req_t {
+	char					sr_path[PGM_TXW_STORE_PATH_MAX];
+	uint32_t				sr_ivl;		/* microseconds between polls, 0 = default */
+};
+
+/* hot standby of the source writing the transmit window store, sb_ivl 0 = disabled */
+struct pgm_standby_req_t {
+	uint32_t				sb_ivl;		/* microseconds between polls of the primary */
+	uint32_t				sb_timeout;	/* microseconds without progress, 0 = on exit only */
+};
+
+/* late join catch-up over unicast, cu_sqns 0 = disabled */
+struct pgm_catchup_req_t {
+	uint32_t				cu_sqns;	/* maximum sequences requested */
+	uint32_t				cu_ivl;		/* microseconds before NAKing, 0 = default */
+};
+
+/* designated local repairer, dr_sqns 0 = disabled */
+struct pgm_dlr_req_t {
+	uint32_t				dr_sqns;	/* retained sequences per source */
+	uint32_t				dr_ivl;		/* microseconds between advertisements, 0 = default */
+	uint32_t				dr_max_rte;	/* repair bytes per second, 0 = unlimited */
+};
+
+/* receive checksum verification policy, transmit takes ALWAYS or UDP_TRUSTED */
+enum {
+	PGM_CHECKSUM_ALWAYS = 0,	/* verify every packet */
+	PGM_CHECKSUM_NEVER,		/* trusted network segment */
+	PGM_CHECKSUM_UDP_TRUSTED,	/* skip datagrams verified by the host UDP stack or NIC, transmit data without */
+	PGM_CHECKSUM_LAZY,		/* verify ODATA only once accepted into the receive window */
+	PGM_CHECKSUM_DELIVERY		/* verify ODATA whilst copying to the application */
+};
+
+/* transmit and receive window memory placement */
+struct pgm_mem_req_t {
+	uint32_t				mr_pages;	/* PGM_MEM_PAGES_* */
+	int32_t					mr_node;	/* NUMA node or PGM_MEM_NODE_* */
+};
+
+enum {
+	PGM_MEM_PAGES_DEFAULT = 0,	/* process heap */
+	PGM_MEM_PAGES_TRANSPARENT,	/* anonymous mapping advised for transparent huge pages */
+	PGM_MEM_PAGES_2MB,		/* reserved 2 MB huge pages */
+	PGM_MEM_PAGES_1GB		/* reserved 1 GB huge pages */
+};
+
+#define PGM_MEM_NODE_ANY	(-1)
+#define PGM_MEM_NODE_INTERFACE	(-2)		/* node of the sending interface's device */
+#define PGM_MEM_NODE_LOCAL	(-3)		/* node of the thread calling pgm_bind() */
+
+/* maximum TPDU from the sending interface MTU, datagrams sent with DF */
+enum {
+	PGM_PMTUD_DISABLED = 0,		/* PGM_MTU, fragmented by IP */
+	PGM_PMTUD_INTERFACE,		/* refused above the learnt path MTU, then fragmented */
+	PGM_PMTUD_PROBE			/* learnt path MTU ignored */
+};
+
+/* congestion control algorithm driven by PGMCC ACKer feedback */
+enum {
+	PGM_CC_PGMCC = 0,		/* TCP-like window, halved on loss */
+	PGM_CC_BBR			/* bandwidth and delay model with paced original data */
+};
+
+/* hot-hot redundant sources of one stream, each APDU carries an increasing
+ * 64-bit big-endian key at rr_key_offset.  rr_tsi_len 0 = disabled.
+ */
+#define PGM_REDUNDANT_MAX_SOURCES	4
+
+struct pgm_redundant_req_t {
+	uint32_t				rr_key_offset;	/* bytes into each APDU */
+	uint32_t				rr_nak_ivl;	/* microseconds NAKs are held back, 0 = none */
+	uint32_t				rr_tsi_len;
+	pgm_tsi_t				rr_tsi[PGM_REDUNDANT_MAX_SOURCES];
+};
+
+/* priority classes of pgm_send_priority(), class 0 is that of pgm_send().  a class
+ * sends within its own rate ahead of lower classes waiting on TXW_MAX_RTE.
+ */
+#define PGM_PRIORITY_CLASSES		4
+
+struct pgm_priority_req_t {
+	uint32_t				pr_class;	/* 1 to PGM_PRIORITY_CLASSES - 1 */
+	uint32_t				pr_max_rte;	/* bytes per second, 0 = disabled */
+	int					pr_tos;		/* IP_TOS or IPV6_TCLASS, -1 = that of PGM_TOS */
+};
+
+/* interfaces of a source in addition to the bound send interface, each
+ * datagram to the send group is sent on every path or the stream rotates
+ * across them.
+ */
+#define PGM_MAX_SEND_PATHS		4
+
+enum {
+	PGM_PATH_DUPLICATE = 1,		/* every datagram on each path */
+	PGM_PATH_STRIPE			/* one path per datagram in turn */
+};
+
+struct pgm_send_path_req_t {
+	uint32_t				sp_mode;	/* PGM_PATH_*, 0 = disabled */
+	uint32_t				sp_len;		/* additional paths */
+	struct pgm_interface_req_t		sp_if[PGM_MAX_SEND_PATHS - 1];
+};
+
+/* UDP source ports of a source for receive side scaling: receivers hashing the
+ * ports onto queues spread the sources of one host, or the transmission groups
+ * of one source, across cores.  Receivers identify sources by TSI alone.
+ */
+#define PGM_MAX_SEND_PORTS		16
+
+/* sequences of a transmission group for PGM_PORTS_PER_TG without FEC */
+#define PGM_PORTS_TG_SQNS		64
+
+enum {
+	PGM_PORTS_PER_TSI = 1,		/* one port of the range chosen by TSI */
+	PGM_PORTS_PER_TG		/* each transmission group on the next port */
+};
+
+struct pgm_send_port_req_t {
+	uint32_t				pt_mode;	/* PGM_PORTS_*, 0 = disabled */
+	uint16_t				pt_base;	/* first port, 0 = ephemeral */
+	uint16_t				pt_count;	/* ports in the range */
+};
+
+/* coalescing of small APDUs sent with pgm_send_batch() */
+struct pgm_batch_req_t {
+	uint32_t				br_size;	/* TSDU bytes, 0 = disabled */
+	uint32_t				br_ivl;		/* flush delay in microseconds, 0 = size or explicit only */
+};
+
+/* compression of APDUs sent with pgm_send(), cr_type PGM_COMPRESS_NONE = disabled */
+enum {
+	PGM_COMPRESS_NONE = 0,
+	PGM_COMPRESS_ZLIB,			/* raw deflate */
+	PGM_COMPRESS_ZSTD
+};
+
+struct pgm_compress_req_t {
+	uint32_t				cr_type;	/* PGM_COMPRESS_* */
+	int32_t					cr_level;	/* 0 = default */
+	uint32_t				cr_dict_id;	/* 16-bit dictionary identifier, 0 = none */
+	uint32_t				cr_dict_len;	/* bytes, copied by setsockopt */
+	const void*				cr_dict;
+};
+
+/* spilling of unread APDUs to a file-backed log when the receive window is full */
+struct pgm_spill_req_t {
+	uint64_t				sr_size;	/* bytes per source, 0 = disabled */
+	const char*				sr_dir;		/* copied by setsockopt, NULL = P_tmpdir */
+};
+
+/* conflation of last-value feeds, the key of an APDU is cf_len bytes at cf_offset */
+struct pgm_conflate_req_t {
+	uint16_t				cf_offset;	/* bytes into the APDU */
+	uint16_t				cf_len;		/* 1 to 8 bytes, 0 = disabled */
+};
+
+/* reassembly of fragmented APDUs into application memory, the region is carved
+ * into buffers each of a skbuff header and pr_apdu bytes.
+ */
+struct pgm_placement_req_t {
+	void*					pr_base;	/* valid until the socket and its skbuffs are released */
+	size_t					pr_len;		/* bytes, 0 = disabled */
+	uint16_t				pr_apdu;	/* largest APDU placed */
+};
+
+/* multi-stream source, a source sending on the sockets and within the rate
+ * limit of another.
+ */
+struct pgm_stream_req_t {
+	pgm_sock_t*				sr_sock;	/* bound source of the group, NULL = weight only */
+	uint32_t				sr_weight;	/* share of the group rate, 0 = 1 */
+};
+
+/* receiver-acknowledged trail of the transmit window */
+struct pgm_ack_trail_req_t {
+	uint32_t				at_ivl;		/* report interval in microseconds, 0 = disabled */
+	uint32_t				at_receivers;	/* source: reporters required to release, 0 = any */
+	uint32_t				at_retention;	/* source: microseconds sent data is kept */
+};
+
+/* receiver-advertised credit limiting the original data rate of a source */
+struct pgm_credit_req_t {
+	uint32_t				cr_ivl;		/* report interval in microseconds, 0 = disabled */
+	uint32_t				cr_receivers;	/* source: slowest reporters electing the limit, 0 = default */
+};
+
+/* unicast receivers of a source on a network without multicast, each datagram to
+ * the send group is replicated to every address in place of the group.
+ */
+#define PGM_MAX_FANOUT			64
+
+struct pgm_fanout_req_t {
+	uint32_t				fr_len;		/* receivers, 0 = disabled */
+	struct sockaddr_storage			fr_addr[PGM_MAX_FANOUT];	/* port 0 = send group port */
+};
+
+/* per-receiver NAK limit at the source, keyed by the address NAKs arrive from.  a
+ * receiver refused nl_demote sequences, each within nl_restore of the last, is
+ * demoted to nl_action until it keeps to the limit for nl_restore.
+ */
+#define PGM_NAK_LIMIT_UNICAST		0	/* repair a demoted receiver by unicast */
+#define PGM_NAK_LIMIT_IGNORE		1	/* ignore NAKs of a demoted receiver */
+
+#define PGM_NAK_LIMIT_RECEIVERS		64
+
+struct pgm_nak_limit_req_t {
+	uint32_t				nl_rate;	/* sequences per second per receiver, 0 = disabled */
+	uint32_t				nl_burst;	/* sequences, 0 = nl_rate */
+	uint32_t				nl_demote;	/* refused sequences, 0 = never demote */
+	uint32_t				nl_restore;	/* microseconds, 0 = never restore */
+	uint32_t				nl_action;	/* PGM_NAK_LIMIT_* */
+};
+
+/* accounting of each NAKing receiver tracked, the least recently NAKing is evicted */
+struct pgm_nak_limit_stat_t {
+	struct sockaddr_storage			ns_addr;
+	uint64_t				ns_sqns;	/* sequences NAKed */
+	uint64_t				ns_refused;	/* sequences over the limit */
+	uint32_t				ns_demotions;
+	bool					ns_is_demoted;
+};
+
+struct pgm_nak_limit_stats_t {
+	uint32_t				ns_len;
+	struct pgm_nak_limit_stat_t		ns_receiver[PGM_NAK_LIMIT_RECEIVERS];
+};
+
+/* receiver resume points in a named shared memory segment, wr_name empty = disabled */
+#define PGM_WARM_RESTART_NAME_MAX	256
+
+struct pgm_warm_restart_req_t {
+	char					wr_name[PGM_WARM_RESTART_NAME_MAX];
+	uint32_t				wr_sources;	/* recorded sources, 0 = default */
+};
+
+/* completed APDUs published to a named shared memory ring for same-host consumers, lr_name empty = disabled */
+#define PGM_LOCAL_NAME_MAX		256
+
+struct pgm_local_req_t {
+	char					lr_name[PGM_LOCAL_NAME_MAX];
+	uint32_t				lr_slots;	/* ring records, 0 = default */
+};
+
 struct pgm_fecinfo_t {
 	uint8_t					block_size;
 	uint8_t					proactive_packets;
@@ -88,6 +462,12 @@ struct pgm_fecinfo_t {
 	bool					var_pktlen_enabled;
 };
 
+/* sliding window FEC, a repair every repair_interval packets covering the last window_size */
+struct pgm_sw_fecinfo_t {
+	uint8_t					window_size;
+	uint8_t					repair_interval;
+};
+
 struct pgm_pgmccinfo_t {
 	uint32_t				ack_bo_ivl;
 	uint32_t				ack_c;
@@ -149,7 +529,114 @@ enum {
 	PGM_UNCONTROLLED_ODATA,
 	PGM_UNCONTROLLED_RDATA,
 	PGM_ODATA_MAX_RTE,
-	PGM_RDATA_MAX_RTE
+	PGM_RDATA_MAX_RTE,
+	PGM_RECV_BATCH,
+	PGM_UDP_GSO,
+	PGM_UDP_GRO,
+	PGM_ZEROCOPY,
+	PGM_RECV_SHARD,
+	PGM_RECV_SOCKETS,
+	PGM_BUSY_POLL,
+	PGM_IO_URING,
+	PGM_XDP_RECV,
+	PGM_FEC_WORKER,
+	PGM_USE_SLIDING_FEC,
+	PGM_PACING,
+	PGM_TIMER_THREAD,
+	PGM_TIMER_POOL,
+	PGM_TIMESTAMPING,
+	PGM_CAPTURE,
+	PGM_RX_CHECKSUM,
+	PGM_POW2_WINDOWS,
+	PGM_MEM_POLICY,
+	PGM_TXW_RING,
+	PGM_RX_SIZE_CLASSES,
+	PGM_SEND_BATCH,
+	PGM_SEND_QUEUE,
+	PGM_SEND_QUEUE_SOCK,
+	PGM_SEND_QUEUE_LEN,
+	PGM_CONGESTION_CONTROL,
+	PGM_NAK_ADAPTIVE,
+	PGM_NAK_AGGREGATE_IVL,
+	PGM_FEC_ADAPTIVE,
+	PGM_FEC_DECODE_THREADS,
+	PGM_TXW_STORE,
+	PGM_CATCHUP,
+	PGM_CATCHUP_RATE,
+	PGM_DLR,
+	PGM_SHM_RECV,
+	PGM_JOIN_DPORT,
+	PGM_LEAVE_DPORT,
+	PGM_PEER_IDLE,
+	PGM_LARGE_APDU,
+	PGM_MERGE_DELIVERY,
+	PGM_REDUNDANT_SOURCES,
+	PGM_RIO,
+	PGM_MULTI_PRODUCER,
+	PGM_RXQ_DROPS,
+	PGM_AUTO_BUFFERS,
+	PGM_RECV_QUEUED,
+	PGM_SEND_QUEUED,
+	PGM_RECV_FILTER,
+	PGM_SOURCE_FILTER,
+	PGM_TX_CHECKSUM,
+	PGM_TPACKET_RECV,
+	PGM_SINGLE_THREADED,
+	PGM_TIMER_FD,
+	PGM_TIMER_SOCK,
+	PGM_COMPRESS,
+	PGM_SPILL,
+	PGM_DELIVERY_DEADLINE,
+	PGM_CONFLATE,
+	PGM_ACK_TRAIL,
+	PGM_MEM_BUDGET,
+	PGM_MEM_USED,
+	PGM_MTU_DISCOVERY,
+	PGM_PATH_MTU,
+	PGM_PLACEMENT,
+	PGM_DELIVERY_QUANTUM,
+	PGM_STREAM_GROUP,
+	PGM_PRIORITY_CLASS,
+	PGM_SEND_PATHS,
+	PGM_RECORD,
+	PGM_IMPAIR,
+	PGM_TX_TIMESTAMPING,
+	PGM_DELIVERY_CALLBACK,
+	PGM_SLOW_CONSUMER_JUMP,
+	PGM_CREDIT,
+	PGM_UNICAST_FANOUT,
+	PGM_VERBS,
+	PGM_DPDK,
+	PGM_COMPACT,
+	PGM_LINGER,
+	PGM_HANDOFF_RING,
+	PGM_HANDOFF_SOCK,
+	PGM_NAK_LIMIT,
+	PGM_NAK_LIMIT_STATS,
+	PGM_WARM_RESTART,
+	PGM_LOCAL_PUBLISH,
+	PGM_STANDBY,
+	PGM_SEND_PORTS,
+	PGM_JOIN_SOURCE_GROUPS
+};
+
+/* readiness reported by pgm_sock_events() */
+enum {
+	PGM_EVENT_DATA			= 0x01,	/* contiguous data or a reset, pgm_recvmsgv() returns without reading */
+	PGM_EVENT_READ			= 0x02,	/* datagrams buffered by the socket await pgm_recvmsgv() */
+	PGM_EVENT_TIMER			= 0x04,	/* timer due, pgm_recvmsgv() dispatches */
+	PGM_EVENT_REPAIR		= 0x08,	/* repairs queued, pgm_recvmsgv() transmits */
+	PGM_EVENT_CONGESTION		= 0x10,	/* send blocked on the congestion window */
+	PGM_EVENT_CONGESTION_CLEARED	= 0x20	/* blocked send may resume */
+};
+
+#define PGM_EVENT_MAX_PEERS		8
+
+struct pgm_sock_events_t {
+	uint32_t				pe_events;	/* PGM_EVENT_* */
+	uint32_t				pe_timer_remain;/* microseconds until the next timer */
+	uint32_t				pe_peers_len;	/* sources with pending data */
+	pgm_tsi_t				pe_peers[PGM_EVENT_MAX_PEERS];	/* first pending sources */
 };
 
 /* IO status */
@@ -178,17 +665,29 @@ bool pgm_bind (pgm_sock_t*restrict, const struct pgm_sockaddr_t*const restrict,
 bool pgm_bind3 (pgm_sock_t*restrict, const struct pgm_sockaddr_t*const restrict, const socklen_t, const struct pgm_interface_req_t*const, const socklen_t, const struct pgm_interface_req_t*const, const socklen_t, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
 bool pgm_connect (pgm_sock_t*restrict, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
 bool pgm_close (pgm_sock_t*, bool);
+bool pgm_close_async (pgm_sock_t*, bool);
 bool pgm_setsockopt (pgm_sock_t*const restrict, const int, const int, const void*restrict, const socklen_t);
 bool pgm_getsockopt (pgm_sock_t*const restrict, const int, const int, void*restrict, socklen_t*restrict);
 bool pgm_getaddrinfo (const char*restrict, const struct pgm_addrinfo_t*const restrict, struct pgm_addrinfo_t**restrict, pgm_error_t**restrict);
 void pgm_freeaddrinfo (struct pgm_addrinfo_t*);
 int pgm_send (pgm_sock_t*const restrict, const void*restrict, const size_t, size_t*restrict);
+int pgm_send_priority (pgm_sock_t*const restrict, const void*restrict, const size_t, const unsigned, size_t*restrict);
 int pgm_sendv (pgm_sock_t*const restrict, const struct pgm_iovec*const restrict, const unsigned, const bool, size_t*restrict);
 int pgm_send_skbv (pgm_sock_t*const restrict, struct pgm_sk_buff_t**const restrict, const unsigned, const bool, size_t*restrict);
+int pgm_sendv_csum (pgm_sock_t*const restrict, const struct pgm_iovec*const restrict, const uint32_t*const restrict, const unsigned, const bool, size_t*restrict);
+int pgm_send_skbv_csum (pgm_sock_t*const restrict, struct pgm_sk_buff_t**const restrict, const uint32_t*const restrict, const unsigned, const bool, size_t*restrict);
+uint32_t pgm_csum_payload (const void*, const size_t);
+int pgm_send_file (pgm_sock_t*const restrict, const int, const uint64_t, const size_t, size_t*restrict);
+int pgm_send_batch (pgm_sock_t*const restrict, const void*restrict, const size_t, size_t*restrict);
+int pgm_send_flush (pgm_sock_t*const restrict, size_t*restrict);
 int pgm_recvmsg (pgm_sock_t*const restrict, struct pgm_msgv_t*const restrict, const int, size_t*restrict, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
 int pgm_recvmsgv (pgm_sock_t*const restrict, struct pgm_msgv_t*const restrict, const size_t, const int, size_t*restrict, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
 int pgm_recv (pgm_sock_t*const restrict, void*restrict, const size_t, const int, size_t*const restrict, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+int pgm_recvbulk (pgm_sock_t*const restrict, void*restrict, const size_t, struct pgm_bulk_msg_t*restrict, const size_t, const int, size_t*restrict, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
 int pgm_recvfrom (pgm_sock_t*const restrict, void*restrict, const size_t, const int, size_t*restrict, struct pgm_sockaddr_t*restrict, socklen_t*restrict, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+bool pgm_sock_events (pgm_sock_t*const restrict, struct pgm_sock_events_t*const restrict);
+int pgm_handoff_recv (pgm_sock_t*const restrict, struct pgm_msgv_t*const restrict, const size_t, size_t*restrict, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+void pgm_handoff_release (pgm_sock_t*const restrict, const struct pgm_msgv_t*const restrict, const size_t);
 
 bool pgm_getsockname (pgm_sock_t*const restrict, struct pgm_sockaddr_t*restrict, socklen_t*restrict);
 int pgm_select_info (pgm_sock_t*const restrict, fd_set*const restrict, fd_set*const restrict, int*const restrict);
@@ -201,6 +700,9 @@ int pgm_wsapoll_info (pgm_sock_t*const restrict, WSAPOLLFD*const restrict, ULONG
 #if defined( EPOLLIN ) && defined( EPOLLOUT )
 int pgm_epoll_ctl (pgm_sock_t*const, const int, const int, const int);
 #endif
+#if defined( EVFILT_READ ) && defined( POLLIN )
+int pgm_kqueue_ctl (pgm_sock_t*const, const int, const int, const short);
+#endif
 
 static
 const char*
@@ -37,7 +37,7 @@ pgm_list_append (
 	pgm_list_t* new_list;
 	pgm_list_t* last;
 
-	new_list = pgm_new (pgm_list_t, 1);
+	new_list = pgm_new_subsys (pgm_list_t, 1, PGM_MEM_SUBSYS_LIST);
 	new_list->data = data;
 	new_list->next = NULL;
 
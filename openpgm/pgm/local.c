@@ -0,0 +1,669 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * shared memory ring of APDUs read by a receiver for same-host consumers.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <errno.h>
+#include <string.h>
+#ifndef _WIN32
+#	include <fcntl.h>
+#	include <time.h>
+#	include <unistd.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#else
+#	include <process.h>
+#	define getpid		_getpid
+#endif
+#include <impl/i18n.h>
+#include <impl/framework.h>
+#include <pgm/local.h>
+
+
+//#define LOCAL_DEBUG
+
+/* One receiving process publishes every APDU it reads into a named ring so that
+ * any number of processes on the host consume the session without joining the
+ * group, NAKing, or holding receive windows of their own.
+ *
+ * The ring is a header then a power of two count of fixed size records, one TSDU
+ * each, an APDU taking consecutive records and the first recording the count.  A
+ * record of no fragments is unrecoverable loss from its source.  The receiving
+ * thread is the only writer: a record is marked with the next position whilst
+ * written, then its own, and the tail advances once per APDU.  Consumers map the
+ * ring read-only, keep their own position and never block the writer; one that
+ * falls a ring behind is moved to the tail and told so with a reset.
+ */
+
+#define LOCAL_MAGIC			0x50474c46U	/* "PGLF" */
+#define LOCAL_VERSION			1
+
+struct local_header_t {
+	uint32_t		magic;
+	uint32_t		version;
+	uint32_t		slot_count;		/* power of two */
+	uint32_t		slot_size;		/* record and max_tsdu */
+	uint32_t		pid;			/* of the writer */
+	volatile uint32_t	tail;			/* next position written */
+	volatile uint32_t	is_closed;
+	uint32_t		__padding;
+};
+
+struct local_record_t {
+	volatile uint32_t	position;		/* position + 1 whilst written */
+	uint32_t		sequence;		/* of the TPDU */
+	pgm_tsi_t		tsi;
+	uint16_t		len;
+	uint16_t		fragments;		/* on first record of APDU, 0 = loss */
+};
+
+struct pgm_local_t {
+	void*				base;
+	size_t				size;
+	struct local_header_t*		header;
+	char*				records;
+	uint32_t			mask;
+	char*				name;
+/* consumer */
+	uint32_t			next;
+	struct pgm_sk_buff_t**		held;			/* returned by the last call */
+	size_t				held_len;
+	size_t				held_size;
+#ifdef _WIN32
+	HANDLE				mapping;
+#endif
+};
+
+
+static inline
+void
+local_barrier (void)
+{
+#if defined( __GNUC__ ) && ( __GNUC__ * 100 + __GNUC_MINOR__ >= 401 )
+	__sync_synchronize();
+#elif defined( __sun )
+	membar_producer();
+#elif defined( _WIN32 )
+	MemoryBarrier();
+#endif
+}
+
+static inline
+struct local_record_t*
+local_record (
+	const pgm_local_t*const	local,
+	const uint32_t		position
+	)
+{
+	return (struct local_record_t*)(local->records + ((size_t)(position & local->mask) * local->header->slot_size));
+}
+
+/* create the ring name of slots records of up to max_tsdu bytes, replacing any
+ * ring of that name left behind.
+ *
+ * returns local on success, returns NULL on error with error set.
+ */
+
+PGM_GNUC_INTERNAL
+pgm_local_t*
+pgm_local_create (
+	const char*	  restrict	name,
+	unsigned			slots,		/* 0 = default */
+	const uint16_t			max_tsdu,
+	pgm_error_t**	  restrict	error
+	)
+{
+	pgm_local_t* local;
+	void* base;
+
+/* pre-conditions */
+	pgm_assert (NULL != name);
+	pgm_assert (max_tsdu > 0);
+
+	if (0 == slots)
+		slots = PGM_LOCAL_DEFAULT_SLOTS;
+	if (slots > PGM_LOCAL_MAX_SLOTS)
+		slots = PGM_LOCAL_MAX_SLOTS;
+/* room for the largest APDU with a second in flight */
+	if (slots < 2 * PGM_MAX_FRAGMENTS)
+		slots = 2 * PGM_MAX_FRAGMENTS;
+	slots = (unsigned)pgm_nearest_power (1, slots);
+
+	const uint32_t slot_size = (uint32_t)((sizeof (struct local_record_t) + max_tsdu + 7) & ~7);
+	local = pgm_new0 (pgm_local_t, 1);
+	local->size = sizeof (struct local_header_t) + ((size_t)slots * slot_size);
+
+#ifndef _WIN32
+	shm_unlink (name);
+	const int fd = shm_open (name, O_RDWR | O_CREAT | O_EXCL, 0644);
+	if (-1 == fd) {
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_errno (save_errno),
+			     _("Creating shared memory segment %s: %s"),
+			     name,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		goto err_free;
+	}
+	if (-1 == ftruncate (fd, local->size)) {
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_errno (save_errno),
+			     _("Sizing shared memory segment %s: %s"),
+			     name,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		close (fd);
+		shm_unlink (name);
+		goto err_free;
+	}
+	base = mmap (NULL, local->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close (fd);
+	if (MAP_FAILED == base) {
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_errno (save_errno),
+			     _("Mapping shared memory segment %s: %s"),
+			     name,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		shm_unlink (name);
+		goto err_free;
+	}
+#else
+	local->mapping = CreateFileMappingA (INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+					     (DWORD)((uint64_t)local->size >> 32), (DWORD)local->size, name);
+	if (NULL == local->mapping) {
+		const DWORD save_errno = GetLastError();
+		char winstr[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_win_errno (save_errno),
+			     _("Creating file mapping %s: %s"),
+			     name,
+			     pgm_win_strerror (winstr, sizeof (winstr), save_errno));
+		goto err_free;
+	}
+	base = MapViewOfFile (local->mapping, FILE_MAP_WRITE, 0, 0, local->size);
+	if (NULL == base) {
+		const DWORD save_errno = GetLastError();
+		char winstr[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_win_errno (save_errno),
+			     _("Mapping view of file %s: %s"),
+			     name,
+			     pgm_win_strerror (winstr, sizeof (winstr), save_errno));
+		CloseHandle (local->mapping);
+		goto err_free;
+	}
+#endif /* _WIN32 */
+
+	local->base	= base;
+	local->header	= (struct local_header_t*)base;
+	local->records	= (char*)(local->header + 1);
+	local->mask	= slots - 1;
+	local->name	= pgm_strdup (name);
+
+	struct local_header_t* header = local->header;
+	memset (base, 0, local->size);
+	header->version		= LOCAL_VERSION;
+	header->slot_count	= slots;
+	header->slot_size	= slot_size;
+	header->pid		= (uint32_t)getpid();
+/* magic last, consumers refuse the ring until set */
+	local_barrier();
+	header->magic		= LOCAL_MAGIC;
+	pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Local publish ring %s of %u records of %u bytes."),
+		name, slots, (unsigned)max_tsdu);
+	return local;
+
+err_free:
+	pgm_free (local);
+	return NULL;
+}
+
+/* mark the ring closed so consumers read end of file, and remove the name.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_local_destroy (
+	pgm_local_t*		local
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != local);
+
+	local_barrier();
+	local->header->is_closed = 1;
+#ifndef _WIN32
+	munmap (local->base, local->size);
+	shm_unlink (local->name);
+#else
+	UnmapViewOfFile (local->base);
+	CloseHandle (local->mapping);
+#endif
+	pgm_free (local->name);
+	pgm_free (local);
+}
+
+/* copy the APDUs of msgv up to msgv_end into the ring, called by the receiving
+ * thread only.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_local_publish (
+	pgm_local_t*		  const restrict	local,
+	const struct pgm_msgv_t*	restrict	msgv,
+	const struct pgm_msgv_t*  const restrict	msgv_end
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != local);
+	pgm_assert (NULL != msgv);
+	pgm_assert (msgv <= msgv_end);
+
+	const size_t max_tsdu = local->header->slot_size - sizeof (struct local_record_t);
+	uint32_t position = local->header->tail;
+
+	for (; msgv < msgv_end; msgv++)
+	{
+		uint32_t i;
+		for (i = 0; i < msgv->msgv_len; i++)
+			if (PGM_UNLIKELY(msgv->msgv_skb[ i ]->len > max_tsdu))
+				break;
+		if (PGM_UNLIKELY(i < msgv->msgv_len)) {
+			pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Discarding APDU with TSDU beyond local ring record size."));
+			continue;
+		}
+		for (i = 0; i < msgv->msgv_len; i++)
+		{
+			const struct pgm_sk_buff_t* skb = msgv->msgv_skb[ i ];
+			struct local_record_t* record = local_record (local, position);
+			record->position = position + 1;
+			local_barrier();
+			record->sequence  = skb->sequence;
+			record->tsi       = skb->tsi;
+			record->len       = skb->len;
+			record->fragments = 0 == i ? (uint16_t)msgv->msgv_len : 0;
+			memcpy (record + 1, skb->data, skb->len);
+			local_barrier();
+			record->position = position++;
+		}
+		local_barrier();
+		local->header->tail = position;
+	}
+}
+
+/* record unrecoverable loss from tsi for consumers.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_local_publish_loss (
+	pgm_local_t*		  const restrict	local,
+	const pgm_tsi_t*	  const restrict	tsi
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != local);
+	pgm_assert (NULL != tsi);
+
+	const uint32_t position = local->header->tail;
+	struct local_record_t* record = local_record (local, position);
+	record->position = position + 1;
+	local_barrier();
+	record->sequence  = 0;
+	record->tsi       = *tsi;
+	record->len       = 0;
+	record->fragments = 0;
+	local_barrier();
+	record->position = position;
+	local_barrier();
+	local->header->tail = position + 1;
+}
+
+/* attach to the ring name published by another process on this host, reading
+ * from the next APDU published.
+ *
+ * returns local on success, returns NULL on error with error set.
+ */
+
+pgm_local_t*
+pgm_local_attach (
+	const char*	restrict	name,
+	pgm_error_t**	restrict	error
+	)
+{
+	pgm_return_val_if_fail (NULL != name, NULL);
+
+#ifndef _WIN32
+	const int fd = shm_open (name, O_RDONLY, 0);
+	if (-1 == fd) {
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_RECV,
+			     pgm_error_from_errno (save_errno),
+			     _("Opening shared memory segment %s: %s"),
+			     name,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		return NULL;
+	}
+	struct stat st;
+	if (-1 == fstat (fd, &st) || st.st_size < (off_t)sizeof(struct local_header_t)) {
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_RECV,
+			     PGM_ERROR_FAILED,
+			     _("Shared memory segment %s is not a local publish ring."),
+			     name);
+		close (fd);
+		return NULL;
+	}
+	const size_t size = (size_t)st.st_size;
+	void* base = mmap (NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+	close (fd);
+	if (MAP_FAILED == base) {
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_RECV,
+			     pgm_error_from_errno (save_errno),
+			     _("Mapping shared memory segment %s: %s"),
+			     name,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		return NULL;
+	}
+#else
+	HANDLE mapping = OpenFileMappingA (FILE_MAP_READ, FALSE, name);
+	if (NULL == mapping) {
+		const DWORD save_errno = GetLastError();
+		char winstr[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_RECV,
+			     pgm_error_from_win_errno (save_errno),
+			     _("Opening file mapping %s: %s"),
+			     name,
+			     pgm_win_strerror (winstr, sizeof (winstr), save_errno));
+		return NULL;
+	}
+	void* base = MapViewOfFile (mapping, FILE_MAP_READ, 0, 0, 0);
+	if (NULL == base) {
+		const DWORD save_errno = GetLastError();
+		char winstr[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_RECV,
+			     pgm_error_from_win_errno (save_errno),
+			     _("Mapping view of file %s: %s"),
+			     name,
+			     pgm_win_strerror (winstr, sizeof (winstr), save_errno));
+		CloseHandle (mapping);
+		return NULL;
+	}
+	MEMORY_BASIC_INFORMATION info;
+	VirtualQuery (base, &info, sizeof (info));
+	const size_t size = info.RegionSize;
+#endif /* _WIN32 */
+
+	struct local_header_t* header = base;
+	if (LOCAL_MAGIC != header->magic ||
+	    LOCAL_VERSION != header->version ||
+	    0 == header->slot_count ||
+	    0 != (header->slot_count & (header->slot_count - 1)) ||
+	    header->slot_size <= sizeof (struct local_record_t) ||
+	    size < sizeof (struct local_header_t) + ((size_t)header->slot_count * header->slot_size))
+	{
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_RECV,
+			     PGM_ERROR_FAILED,
+			     _("Shared memory segment %s is not a local publish ring."),
+			     name);
+#ifndef _WIN32
+		munmap (base, size);
+#else
+		UnmapViewOfFile (base);
+		CloseHandle (mapping);
+#endif
+		return NULL;
+	}
+
+	pgm_local_t* local = pgm_new0 (pgm_local_t, 1);
+	local->base	= base;
+	local->size	= size;
+	local->header	= header;
+	local->records	= (char*)(header + 1);
+	local->mask	= header->slot_count - 1;
+	local->name	= pgm_strdup (name);
+	local->next	= header->tail;
+#ifdef _WIN32
+	local->mapping	= mapping;
+#endif
+	return local;
+}
+
+static
+void
+local_release_held (
+	pgm_local_t*		local
+	)
+{
+	for (size_t i = 0; i < local->held_len; i++)
+		pgm_free_skb (local->held[ i ]);
+	local->held_len = 0;
+}
+
+/* detach from the ring, freeing skbuffs returned by the last read.
+ */
+
+void
+pgm_local_detach (
+	pgm_local_t*		local
+	)
+{
+	if (NULL == local)
+		return;
+	local_release_held (local);
+	pgm_free (local->held);
+#ifndef _WIN32
+	munmap (local->base, local->size);
+#else
+	UnmapViewOfFile (local->base);
+	CloseHandle (local->mapping);
+#endif
+	pgm_free (local->name);
+	pgm_free (local);
+}
+
+/* copy the APDU at the consumer position into msgv.
+ *
+ * returns count of records consumed, 0 if not yet complete, -1 if overrun.
+ */
+
+static
+int
+local_read_apdu (
+	pgm_local_t*		  const restrict	local,
+	struct pgm_msgv_t*	  const restrict	msgv,
+	pgm_tsi_t*		  const restrict	loss_tsi,
+	size_t*			  const restrict	bytes_read
+	)
+{
+	msgv->msgv_len = 0;
+	const uint32_t tail = local->header->tail;
+	if (tail == local->next)
+		return 0;
+	local_barrier();
+	if (tail - local->next > local->header->slot_count)
+		return -1;
+
+	const struct local_record_t* first = local_record (local, local->next);
+	const uint32_t fragments = first->fragments;
+	if (0 == fragments) {
+		*loss_tsi = first->tsi;
+		local_barrier();
+		if (first->position != local->next)
+			return -1;
+		msgv->msgv_len = 0;
+		return 1;
+	}
+	if (fragments > PGM_MAX_FRAGMENTS || tail - local->next < fragments)
+		return -1;
+
+	size_t len = 0;
+	for (uint32_t i = 0; i < fragments; i++)
+	{
+		const uint32_t position = local->next + i;
+		const struct local_record_t* record = local_record (local, position);
+		const uint16_t tsdu_length = record->len;
+		if (PGM_UNLIKELY(tsdu_length > local->header->slot_size - sizeof (struct local_record_t))) {
+			msgv->msgv_len = i;
+			return -1;
+		}
+		struct pgm_sk_buff_t* skb = pgm_alloc_skb (tsdu_length);
+		skb->tsi      = record->tsi;
+		skb->sequence = record->sequence;
+		memcpy (pgm_skb_put (skb, tsdu_length), record + 1, tsdu_length);
+		msgv->msgv_skb[ i ] = skb;
+		msgv->msgv_len = i + 1;
+		len += tsdu_length;
+/* the writer may have lapped us during the copy */
+		local_barrier();
+		if (record->position != position)
+			return -1;
+	}
+	*bytes_read += len;
+	return (int)fragments;
+}
+
+static
+void
+local_free_msgv (
+	struct pgm_msgv_t*		msgv
+	)
+{
+	for (uint32_t i = 0; i < msgv->msgv_len; i++)
+		pgm_free_skb (msgv->msgv_skb[ i ]);
+	msgv->msgv_len = 0;
+}
+
+/* read up to msg_len APDUs published to the ring as pgm_recvmsgv(), the skbuffs
+ * returned are owned by the consumer and released on the next call or detach.
+ *
+ * on success, returns PGM_IO_STATUS_NORMAL, on no published data and non-blocking
+ * returns PGM_IO_STATUS_WOULD_BLOCK, on unrecoverable loss at the publisher or the
+ * consumer falling a ring behind returns PGM_IO_STATUS_RESET with error set, and
+ * once the publisher closes returns PGM_IO_STATUS_EOF.
+ */
+
+int
+pgm_local_recvmsgv (
+	pgm_local_t*	    const restrict	local,
+	struct pgm_msgv_t*  const restrict	msg_start,
+	const size_t				msg_len,
+	const int				flags,
+	size_t*		          restrict	bytes_read,
+	pgm_error_t**	          restrict	error
+	)
+{
+	size_t bytes = 0;
+	struct pgm_msgv_t* pmsg = msg_start;
+	const struct pgm_msgv_t* msg_end = msg_start + msg_len;
+
+	pgm_return_val_if_fail (NULL != local, PGM_IO_STATUS_ERROR);
+	if (PGM_LIKELY(msg_len)) pgm_return_val_if_fail (NULL != msg_start, PGM_IO_STATUS_ERROR);
+
+	local_release_held (local);
+	if (PGM_UNLIKELY(0 == msg_len))
+		return PGM_IO_STATUS_NORMAL;
+	if (local->held_size < msg_len * PGM_MAX_FRAGMENTS) {
+		local->held_size = msg_len * PGM_MAX_FRAGMENTS;
+		local->held = pgm_realloc (local->held, local->held_size * sizeof (struct pgm_sk_buff_t*));
+	}
+
+	for (;;)
+	{
+		while (pmsg < msg_end)
+		{
+			pgm_tsi_t loss_tsi;
+			const int records = local_read_apdu (local, pmsg, &loss_tsi, &bytes);
+			if (0 == records)
+				break;
+			if (records < 0) {
+				local_free_msgv (pmsg);
+/* overrun is reported alone, after any APDUs before it */
+				if (pmsg > msg_start)
+					break;
+				const uint32_t skipped = local->header->tail - local->next;
+				local->next = local->header->tail;
+				pgm_set_error (error,
+					     PGM_ERROR_DOMAIN_RECV,
+					     PGM_ERROR_NOBUFS,
+					     _("Consumer overrun by %u records of local publish ring %s."),
+					     (unsigned)skipped, local->name);
+				return PGM_IO_STATUS_RESET;
+			}
+			if (0 == pmsg->msgv_len) {
+/* as is loss */
+				if (pmsg > msg_start)
+					break;
+				local->next++;
+				if (error) {
+					char tsi[PGM_TSISTRLEN];
+					pgm_tsi_print_r (&loss_tsi, tsi, sizeof(tsi));
+					pgm_set_error (error,
+						     PGM_ERROR_DOMAIN_RECV,
+						     PGM_ERROR_CONNRESET,
+						     _("Transport has been reset on unrecoverable loss from %s."),
+						     tsi);
+				}
+				return PGM_IO_STATUS_RESET;
+			}
+			local->next += (uint32_t)records;
+			memcpy (&local->held[ local->held_len ], pmsg->msgv_skb, pmsg->msgv_len * sizeof (struct pgm_sk_buff_t*));
+			local->held_len += pmsg->msgv_len;
+			pmsg++;
+		}
+		if (pmsg > msg_start) {
+			if (NULL != bytes_read)
+				*bytes_read = bytes;
+			return PGM_IO_STATUS_NORMAL;
+		}
+		if (local->header->is_closed)
+			return PGM_IO_STATUS_EOF;
+		if (flags & MSG_DONTWAIT)
+			return PGM_IO_STATUS_WOULD_BLOCK;
+#ifndef _WIN32
+		const struct timespec ts = { .tv_sec = 0, .tv_nsec = PGM_LOCAL_POLL_IVL * 1000 };
+		nanosleep (&ts, NULL);
+#else
+		Sleep (1);
+#endif
+	}
+}
+
+/* eof */
@@ -0,0 +1,282 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * unit tests for the local fan-out ring.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <check.h>
+
+#include "impl/framework.h"
+
+#ifdef _WIN32
+#	define PGM_CHECK_NOFORK		1
+#endif
+
+
+/* mock state */
+#define TEST_NAME		"/pgm-local-unittest"
+#define TEST_MAX_TSDU		1400
+
+static const pgm_tsi_t		test_tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+
+#define LOCAL_DEBUG
+#include "local.c"
+
+
+/* msgv of one APDU of count TSDUs of len bytes, each filled with its sequence */
+static
+void
+generate_apdu (
+	struct pgm_msgv_t*	msgv,
+	uint32_t		sequence,
+	unsigned		count,
+	uint16_t		len
+	)
+{
+	msgv->msgv_len = count;
+	for (unsigned i = 0; i < count; i++) {
+		struct pgm_sk_buff_t* skb = pgm_alloc_skb (len);
+		skb->tsi      = test_tsi;
+		skb->sequence = sequence + i;
+		memset (pgm_skb_put (skb, len), (int)(skb->sequence & 0xff), len);
+		msgv->msgv_skb[ i ] = skb;
+	}
+}
+
+static
+void
+free_apdu (
+	struct pgm_msgv_t*	msgv
+	)
+{
+	for (unsigned i = 0; i < msgv->msgv_len; i++)
+		pgm_free_skb (msgv->msgv_skb[ i ]);
+}
+
+/* target:
+ *	pgm_local_t*
+ *	pgm_local_create (
+ *		const char*		name,
+ *		unsigned		slots,
+ *		const uint16_t		max_tsdu,
+ *		pgm_error_t**		error
+ *	)
+ */
+
+START_TEST (test_create_pass_001)
+{
+	pgm_error_t* err = NULL;
+	pgm_local_t* local = pgm_local_create (TEST_NAME, 100, TEST_MAX_TSDU, &err);
+	fail_if (NULL == local, "create failed");
+	fail_unless (128 == local->header->slot_count, "slots not rounded to power of two");
+	fail_unless (local->header->slot_size >= sizeof (struct local_record_t) + TEST_MAX_TSDU, "record too small");
+	pgm_local_destroy (local);
+}
+END_TEST
+
+/* target:
+ *	int
+ *	pgm_local_recvmsgv (
+ *		pgm_local_t*		local,
+ *		struct pgm_msgv_t*	msg_start,
+ *		const size_t		msg_len,
+ *		const int		flags,
+ *		size_t*			bytes_read,
+ *		pgm_error_t**		error
+ *	)
+ */
+
+/* APDUs published after attach are read in order, then would block */
+START_TEST (test_recvmsgv_pass_001)
+{
+	pgm_error_t* err = NULL;
+	struct pgm_msgv_t apdu[2], msgv[4];
+	size_t bytes_read = 0;
+	pgm_local_t* local = pgm_local_create (TEST_NAME, 0, TEST_MAX_TSDU, &err);
+	fail_if (NULL == local, "create failed");
+	generate_apdu (&apdu[0], 10, 1, 100);
+	pgm_local_publish (local, apdu, apdu + 1);
+	pgm_local_t* consumer = pgm_local_attach (TEST_NAME, &err);
+	fail_if (NULL == consumer, "attach failed");
+	fail_unless (PGM_IO_STATUS_WOULD_BLOCK == pgm_local_recvmsgv (consumer, msgv, PGM_N_ELEMENTS(msgv), MSG_DONTWAIT, &bytes_read, &err), "data before attach");
+	free_apdu (&apdu[0]);
+	generate_apdu (&apdu[0], 11, 1, 100);
+	generate_apdu (&apdu[1], 12, 3, TEST_MAX_TSDU);
+	pgm_local_publish (local, apdu, apdu + 2);
+	fail_unless (PGM_IO_STATUS_NORMAL == pgm_local_recvmsgv (consumer, msgv, PGM_N_ELEMENTS(msgv), MSG_DONTWAIT, &bytes_read, &err), "recvmsgv failed");
+	fail_unless (100 + 3 * TEST_MAX_TSDU == bytes_read, "bytes_read");
+	fail_unless (1 == msgv[0].msgv_len, "first APDU");
+	fail_unless (3 == msgv[1].msgv_len, "second APDU");
+	fail_unless (11 == msgv[0].msgv_skb[0]->sequence, "sequence");
+	fail_unless (14 == msgv[1].msgv_skb[2]->sequence, "sequence");
+	fail_unless (pgm_tsi_equal (&test_tsi, &msgv[1].msgv_skb[2]->tsi), "tsi");
+	fail_unless (14 == ((uint8_t*)msgv[1].msgv_skb[2]->data)[TEST_MAX_TSDU - 1], "data");
+	fail_unless (PGM_IO_STATUS_WOULD_BLOCK == pgm_local_recvmsgv (consumer, msgv, PGM_N_ELEMENTS(msgv), MSG_DONTWAIT, &bytes_read, &err), "recvmsgv failed");
+	free_apdu (&apdu[0]);
+	free_apdu (&apdu[1]);
+	pgm_local_detach (consumer);
+	pgm_local_destroy (local);
+}
+END_TEST
+
+/* loss at the publisher is a reset after the APDUs before it */
+START_TEST (test_recvmsgv_pass_002)
+{
+	pgm_error_t* err = NULL;
+	struct pgm_msgv_t apdu[1], msgv[4];
+	size_t bytes_read = 0;
+	pgm_local_t* local = pgm_local_create (TEST_NAME, 0, TEST_MAX_TSDU, &err);
+	fail_if (NULL == local, "create failed");
+	pgm_local_t* consumer = pgm_local_attach (TEST_NAME, &err);
+	fail_if (NULL == consumer, "attach failed");
+	generate_apdu (&apdu[0], 1, 1, 10);
+	pgm_local_publish (local, apdu, apdu + 1);
+	pgm_local_publish_loss (local, &test_tsi);
+	fail_unless (PGM_IO_STATUS_NORMAL == pgm_local_recvmsgv (consumer, msgv, PGM_N_ELEMENTS(msgv), MSG_DONTWAIT, &bytes_read, &err), "recvmsgv failed");
+	fail_unless (PGM_IO_STATUS_RESET == pgm_local_recvmsgv (consumer, msgv, PGM_N_ELEMENTS(msgv), MSG_DONTWAIT, &bytes_read, &err), "loss not reported");
+	fail_if (NULL == err, "error not set");
+	fail_unless (PGM_ERROR_CONNRESET == err->code, "error code");
+	pgm_error_free (err);
+	err = NULL;
+	fail_unless (PGM_IO_STATUS_WOULD_BLOCK == pgm_local_recvmsgv (consumer, msgv, PGM_N_ELEMENTS(msgv), MSG_DONTWAIT, &bytes_read, &err), "recvmsgv failed");
+	free_apdu (&apdu[0]);
+	pgm_local_detach (consumer);
+	pgm_local_destroy (local);
+}
+END_TEST
+
+/* a consumer a ring behind resumes at the tail after a reset */
+START_TEST (test_recvmsgv_pass_003)
+{
+	pgm_error_t* err = NULL;
+	struct pgm_msgv_t apdu[1], msgv[4];
+	size_t bytes_read = 0;
+	pgm_local_t* local = pgm_local_create (TEST_NAME, 32, TEST_MAX_TSDU, &err);
+	fail_if (NULL == local, "create failed");
+	pgm_local_t* consumer = pgm_local_attach (TEST_NAME, &err);
+	fail_if (NULL == consumer, "attach failed");
+	for (uint32_t i = 0; i < 40; i++) {
+		generate_apdu (&apdu[0], i, 1, 10);
+		pgm_local_publish (local, apdu, apdu + 1);
+		free_apdu (&apdu[0]);
+	}
+	fail_unless (PGM_IO_STATUS_RESET == pgm_local_recvmsgv (consumer, msgv, PGM_N_ELEMENTS(msgv), MSG_DONTWAIT, &bytes_read, &err), "overrun not reported");
+	fail_unless (PGM_ERROR_NOBUFS == err->code, "error code");
+	pgm_error_free (err);
+	err = NULL;
+	generate_apdu (&apdu[0], 40, 1, 10);
+	pgm_local_publish (local, apdu, apdu + 1);
+	free_apdu (&apdu[0]);
+	fail_unless (PGM_IO_STATUS_NORMAL == pgm_local_recvmsgv (consumer, msgv, PGM_N_ELEMENTS(msgv), MSG_DONTWAIT, &bytes_read, &err), "recvmsgv failed");
+	fail_unless (40 == msgv[0].msgv_skb[0]->sequence, "sequence");
+	pgm_local_detach (consumer);
+	pgm_local_destroy (local);
+}
+END_TEST
+
+/* closed publisher reads end of file */
+START_TEST (test_recvmsgv_pass_004)
+{
+	pgm_error_t* err = NULL;
+	struct pgm_msgv_t msgv[4];
+	size_t bytes_read = 0;
+	pgm_local_t* local = pgm_local_create (TEST_NAME, 0, TEST_MAX_TSDU, &err);
+	fail_if (NULL == local, "create failed");
+	pgm_local_t* consumer = pgm_local_attach (TEST_NAME, &err);
+	fail_if (NULL == consumer, "attach failed");
+	pgm_local_destroy (local);
+	fail_unless (PGM_IO_STATUS_EOF == pgm_local_recvmsgv (consumer, msgv, PGM_N_ELEMENTS(msgv), 0, &bytes_read, &err), "eof not reported");
+	pgm_local_detach (consumer);
+}
+END_TEST
+
+/* target:
+ *	pgm_local_t*
+ *	pgm_local_attach (
+ *		const char*		name,
+ *		pgm_error_t**		error
+ *	)
+ */
+
+START_TEST (test_attach_fail_001)
+{
+	pgm_error_t* err = NULL;
+#ifndef _WIN32
+	shm_unlink (TEST_NAME);
+#endif
+	fail_unless (NULL == pgm_local_attach (TEST_NAME, &err), "attach succeeded");
+	fail_if (NULL == err, "error not set");
+	pgm_error_free (err);
+}
+END_TEST
+
+
+static
+Suite*
+make_test_suite (void)
+{
+	Suite* s;
+
+	s = suite_create (__FILE__);
+
+	TCase* tc_create = tcase_create ("create");
+	suite_add_tcase (s, tc_create);
+	tcase_add_test (tc_create, test_create_pass_001);
+
+	TCase* tc_recvmsgv = tcase_create ("recvmsgv");
+	suite_add_tcase (s, tc_recvmsgv);
+	tcase_add_test (tc_recvmsgv, test_recvmsgv_pass_001);
+	tcase_add_test (tc_recvmsgv, test_recvmsgv_pass_002);
+	tcase_add_test (tc_recvmsgv, test_recvmsgv_pass_003);
+	tcase_add_test (tc_recvmsgv, test_recvmsgv_pass_004);
+
+	TCase* tc_attach = tcase_create ("attach");
+	suite_add_tcase (s, tc_attach);
+	tcase_add_test (tc_attach, test_attach_fail_001);
+	return s;
+}
+
+static
+Suite*
+make_master_suite (void)
+{
+	Suite* s = suite_create ("Master");
+	return s;
+}
+
+int
+main (void)
+{
+	pgm_messages_init();
+	SRunner* sr = srunner_create (make_master_suite ());
+	srunner_add_suite (sr, make_test_suite ());
+	srunner_run_all (sr, CK_ENV);
+	int number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	pgm_messages_shutdown();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof */
@@ -0,0 +1,566 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * end-to-end performance test of one source and N receivers in one process
+ * over an in-memory transport, the complete protocol engine runs without
+ * the network stack: windows, NAK and repair state machines, SPM heartbeats
+ * and timers.  the transport applies independent loss, reordering and delay
+ * per receiver.
+ *
+ * the result is written to stdout as one JSON object:
+ *
+ *   {"receivers":4,"messages":100000,"size":1000,...,"msgs_per_sec":..,"gbit_per_sec":..,
+ *    "cpu_ns_per_msg":..,"latency_us":{"p50":..,"p90":..,"p99":..,"p999":..,"max":..}}
+ *
+ * usage: loopback_perftest [-n messages] [-s size] [-r receivers] [-l loss%]
+ *			    [-o reorder%] [-d delay-us] [-w window-sqns] [-R bytes/s]
+ *
+ * the window defaults to cover the whole run, a shorter window under loss
+ * may leave a receiver unable to recover and the run reports "stalled".
+ *
+ * Copyright (c) 2010-2016 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#	include <sys/resource.h>
+#endif
+#include <pgm/engine.h>
+#include <impl/framework.h>
+#include <impl/net.h>
+#include <impl/socket.h>
+
+
+#define BENCH_NETWORK		"127.0.0.1;239.192.0.1"
+#define BENCH_PORT		7500
+#define BENCH_UDP_ENCAP_PORT	3055
+#define BENCH_MAX_RECEIVERS	64
+#define BENCH_BURST		64
+#define BENCH_INBOX_DEPTH	8192
+#define BENCH_IDLE_TIMEOUT	pgm_secs(5)
+#define BENCH_MIN_SQNS		16384
+#define BENCH_MAX_SQNS		(1 << 20)
+
+/* one datagram in flight to an endpoint */
+
+struct bench_datagram_t {
+	pgm_time_t		due;
+	size_t			len;
+	struct sockaddr_storage	src;
+	struct sockaddr_storage	dst;
+	char*			data;
+};
+
+struct bench_endpoint_t {
+	pgm_sock_t*		sock;
+	bool			is_source;
+/* inbox ring, head is the next read */
+	struct bench_datagram_t* ring;
+	char*			store;
+	unsigned		head, tail;
+	unsigned		overflow;
+/* receiver results */
+	unsigned		delivered;
+	unsigned		resets;
+	bool			is_complete;
+};
+
+static struct bench_endpoint_t	bench_endpoints[ 1 + BENCH_MAX_RECEIVERS ];
+static unsigned			bench_endpoints_len;
+static size_t			bench_max_tpdu = 1500;
+static unsigned			bench_loss = 0;		/* parts per million */
+static unsigned			bench_reorder = 0;	/* parts per million */
+static pgm_time_t		bench_delay = 0;
+static uint32_t			bench_rand_state = 0x2545f491;
+static unsigned			bench_lost = 0, bench_reordered = 0;
+
+/* xorshift32, independent of the library generators */
+
+static inline
+unsigned
+bench_rand_ppm (void)
+{
+	uint32_t x = bench_rand_state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	bench_rand_state = x;
+	return x % 1000000;
+}
+
+static
+struct bench_endpoint_t*
+bench_lookup (
+	const pgm_sock_t* const	sock
+	)
+{
+	for (unsigned i = 0; i < bench_endpoints_len; i++)
+		if (sock == bench_endpoints[i].sock)
+			return &bench_endpoints[i];
+	return NULL;
+}
+
+static
+void
+bench_inbox_push (
+	struct bench_endpoint_t* const restrict	endpoint,
+	const pgm_sock_t*	 const restrict	sender,
+	const void*		       restrict	buf,
+	const size_t				len,
+	const struct sockaddr*	       restrict	to,
+	const pgm_time_t			due
+	)
+{
+	if (endpoint->tail - endpoint->head == BENCH_INBOX_DEPTH) {
+		endpoint->overflow++;
+		return;
+	}
+	struct bench_datagram_t* datagram = &endpoint->ring[ endpoint->tail++ % BENCH_INBOX_DEPTH ];
+	datagram->due = due;
+	datagram->len = len;
+	memcpy (&datagram->src, &sender->send_addr, sizeof(struct sockaddr_storage));
+	memcpy (&datagram->dst, to, pgm_sockaddr_len (to));
+	memcpy (datagram->data, buf, len);
+
+/* overtake the previous unread datagram, due times remain in order */
+	if (bench_reorder &&
+	    endpoint->tail - endpoint->head > 1 &&
+	    bench_rand_ppm() < bench_reorder)
+	{
+		struct bench_datagram_t* previous = &endpoint->ring[ (endpoint->tail - 2) % BENCH_INBOX_DEPTH ];
+		struct bench_datagram_t swap = *previous;
+		previous->len = datagram->len;
+		previous->src = datagram->src;
+		previous->dst = datagram->dst;
+		previous->data = datagram->data;
+		datagram->len = swap.len;
+		datagram->src = swap.src;
+		datagram->dst = swap.dst;
+		datagram->data = swap.data;
+		bench_reordered++;
+	}
+}
+
+/* multicast reaches every other endpoint, unicast is upstream to the source.
+ */
+
+static
+ssize_t
+bench_sendto (
+	void*				user_data,
+	pgm_sock_t*	       restrict	sock,
+	const void*	       restrict	buf,
+	size_t				len,
+	const struct sockaddr* restrict	to,
+	socklen_t			tolen
+	)
+{
+	const bool is_multicast = pgm_sockaddr_is_addr_multicast (to);
+	const pgm_time_t due = bench_delay ? pgm_time_update_now() + bench_delay : 0;
+
+	(void)user_data;
+	(void)tolen;
+	for (unsigned i = 0; i < bench_endpoints_len; i++) {
+		struct bench_endpoint_t* endpoint = &bench_endpoints[i];
+		if (endpoint->sock == sock || (!is_multicast && !endpoint->is_source))
+			continue;
+		if (bench_loss && bench_rand_ppm() < bench_loss) {
+			bench_lost++;
+			continue;
+		}
+		bench_inbox_push (endpoint, sock, buf, len, to, due);
+	}
+	return (ssize_t)len;
+}
+
+static
+ssize_t
+bench_recvfrom (
+	void*				user_data,
+	pgm_sock_t*	       restrict	sock,
+	void*		       restrict	buf,
+	size_t				len,
+	struct sockaddr*       restrict	src_addr,
+	struct sockaddr*       restrict	dst_addr
+	)
+{
+	struct bench_endpoint_t* endpoint = bench_lookup (sock);
+
+	(void)user_data;
+	if (NULL == endpoint ||
+	    endpoint->head == endpoint->tail ||
+	    (bench_delay && pgm_time_after (endpoint->ring[ endpoint->head % BENCH_INBOX_DEPTH ].due, pgm_time_update_now())))
+	{
+		pgm_set_last_sock_error (PGM_SOCK_EAGAIN);
+		return -1;
+	}
+	const struct bench_datagram_t* datagram = &endpoint->ring[ endpoint->head++ % BENCH_INBOX_DEPTH ];
+	const size_t copy_len = MIN(len, datagram->len);
+	memcpy (buf, datagram->data, copy_len);
+	memcpy (src_addr, &datagram->src, sizeof(struct sockaddr_storage));
+	memcpy (dst_addr, &datagram->dst, sizeof(struct sockaddr_storage));
+	return (ssize_t)copy_len;
+}
+
+static const struct pgm_net_shim_t bench_shim = {
+	.user_data	= NULL,
+	.sendto		= bench_sendto,
+	.recvfrom	= bench_recvfrom
+};
+
+/* process user and system time in microseconds */
+
+static
+pgm_time_t
+bench_cpu_time (void)
+{
+#ifndef _WIN32
+	struct rusage usage;
+	getrusage (RUSAGE_SELF, &usage);
+	return (pgm_time_t)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000
+		+ (pgm_time_t)(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+#else
+	FILETIME creation, exit, kernel, user;
+	ULARGE_INTEGER k, u;
+	GetProcessTimes (GetCurrentProcess(), &creation, &exit, &kernel, &user);
+	k.LowPart = kernel.dwLowDateTime; k.HighPart = kernel.dwHighDateTime;
+	u.LowPart = user.dwLowDateTime;   u.HighPart = user.dwHighDateTime;
+	return (pgm_time_t)((k.QuadPart + u.QuadPart) / 10);
+#endif
+}
+
+static
+int
+bench_compare_latency (
+	const void*	a,
+	const void*	b
+	)
+{
+	const uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+	return (x > y) - (x < y);
+}
+
+static
+pgm_sock_t*
+bench_create_sock (
+	const struct pgm_addrinfo_t* const	res,
+	const unsigned				index_,		/* 0 is the source */
+	const unsigned				sqns,
+	const unsigned				max_rte
+	)
+{
+	pgm_sock_t* sock = NULL;
+	pgm_error_t* pgm_err = NULL;
+	const bool is_source = (0 == index_);
+	const sa_family_t sa_family = res->ai_send_addrs[0].gsr_group.ss_family;
+	const int udp_encap_port = BENCH_UDP_ENCAP_PORT,
+		  max_tpdu = (int)bench_max_tpdu,
+		  no_router_assist = 0,
+		  nonblocking = 1;
+
+	if (!pgm_socket (&sock, sa_family, SOCK_SEQPACKET, IPPROTO_UDP, &pgm_err)) {
+		fprintf (stderr, "creating PGM/UDP socket: %s\n", pgm_err->message);
+		pgm_error_free (pgm_err);
+		return NULL;
+	}
+	pgm_setsockopt (sock, IPPROTO_PGM, PGM_UDP_ENCAP_UCAST_PORT, &udp_encap_port, sizeof(udp_encap_port));
+	pgm_setsockopt (sock, IPPROTO_PGM, PGM_UDP_ENCAP_MCAST_PORT, &udp_encap_port, sizeof(udp_encap_port));
+	pgm_setsockopt (sock, IPPROTO_PGM, PGM_IP_ROUTER_ALERT, &no_router_assist, sizeof(no_router_assist));
+	pgm_setsockopt (sock, IPPROTO_PGM, PGM_MTU, &max_tpdu, sizeof(max_tpdu));
+
+	if (is_source) {
+		const int send_only = 1,
+			  txw_sqns = (int)sqns,
+			  txw_max_rte = (int)max_rte,
+			  ambient_spm = pgm_msecs (100),
+			  heartbeat_spm[] = { pgm_msecs (1),
+					      pgm_msecs (1),
+					      pgm_msecs (2),
+					      pgm_msecs (4),
+					      pgm_msecs (8),
+					      pgm_msecs (16),
+					      pgm_msecs (32),
+					      pgm_msecs (64),
+					      pgm_msecs (100) };
+		pgm_setsockopt (sock, IPPROTO_PGM, PGM_SEND_ONLY, &send_only, sizeof(send_only));
+		pgm_setsockopt (sock, IPPROTO_PGM, PGM_TXW_SQNS, &txw_sqns, sizeof(txw_sqns));
+		pgm_setsockopt (sock, IPPROTO_PGM, PGM_TXW_MAX_RTE, &txw_max_rte, sizeof(txw_max_rte));
+		pgm_setsockopt (sock, IPPROTO_PGM, PGM_AMBIENT_SPM, &ambient_spm, sizeof(ambient_spm));
+		pgm_setsockopt (sock, IPPROTO_PGM, PGM_HEARTBEAT_SPM, &heartbeat_spm, sizeof(heartbeat_spm));
+	} else {
+/* repair timers follow the configured one-way delay */
+		const int recv_only = 1,
+			  passive = 0,
+			  rxw_sqns = (int)sqns,
+			  peer_expiry = pgm_secs (300),
+			  spmr_expiry = pgm_msecs (25),
+			  nak_bo_ivl = pgm_msecs (1),
+			  nak_rpt_ivl = (int)(pgm_msecs (5) + 2 * bench_delay),
+			  nak_rdata_ivl = (int)(pgm_msecs (10) + 2 * bench_delay),
+			  nak_data_retries = 50,
+			  nak_ncf_retries = 50;
+		pgm_setsockopt (sock, IPPROTO_PGM, PGM_RECV_ONLY, &recv_only, sizeof(recv_only));
+		pgm_setsockopt (sock, IPPROTO_PGM, PGM_PASSIVE, &passive, sizeof(passive));
+		pgm_setsockopt (sock, IPPROTO_PGM, PGM_RXW_SQNS, &rxw_sqns, sizeof(rxw_sqns));
+		pgm_setsockopt (sock, IPPROTO_PGM, PGM_PEER_EXPIRY, &peer_expiry, sizeof(peer_expiry));
+		pgm_setsockopt (sock, IPPROTO_PGM, PGM_SPMR_EXPIRY, &spmr_expiry, sizeof(spmr_expiry));
+		pgm_setsockopt (sock, IPPROTO_PGM, PGM_NAK_BO_IVL, &nak_bo_ivl, sizeof(nak_bo_ivl));
+		pgm_setsockopt (sock, IPPROTO_PGM, PGM_NAK_RPT_IVL, &nak_rpt_ivl, sizeof(nak_rpt_ivl));
+		pgm_setsockopt (sock, IPPROTO_PGM, PGM_NAK_RDATA_IVL, &nak_rdata_ivl, sizeof(nak_rdata_ivl));
+		pgm_setsockopt (sock, IPPROTO_PGM, PGM_NAK_DATA_RETRIES, &nak_data_retries, sizeof(nak_data_retries));
+		pgm_setsockopt (sock, IPPROTO_PGM, PGM_NAK_NCF_RETRIES, &nak_ncf_retries, sizeof(nak_ncf_retries));
+	}
+
+	struct pgm_sockaddr_t addr;
+	memset (&addr, 0, sizeof(addr));
+	addr.sa_port = BENCH_PORT;
+	addr.sa_addr.sport = (uint16_t)(BENCH_PORT + 1 + index_);
+	pgm_gsi_create_from_string (&addr.sa_addr.gsi, "loopback_perftest", -1);
+
+	struct pgm_interface_req_t if_req;
+	memset (&if_req, 0, sizeof(if_req));
+	if_req.ir_interface = res->ai_recv_addrs[0].gsr_interface;
+	memcpy (&if_req.ir_address, &res->ai_send_addrs[0].gsr_addr, sizeof(struct sockaddr_storage));
+	if (!pgm_bind3 (sock,
+			&addr, sizeof(addr),
+			&if_req, sizeof(if_req),	/* tx interface */
+			&if_req, sizeof(if_req),	/* rx interface */
+			&pgm_err))
+	{
+		fprintf (stderr, "binding PGM socket: %s\n", pgm_err->message);
+		pgm_error_free (pgm_err);
+		pgm_close (sock, FALSE);
+		return NULL;
+	}
+	for (unsigned i = 0; i < res->ai_recv_addrs_len; i++)
+		pgm_setsockopt (sock, IPPROTO_PGM, PGM_JOIN_GROUP, &res->ai_recv_addrs[i], sizeof(struct pgm_group_source_req));
+	pgm_setsockopt (sock, IPPROTO_PGM, PGM_SEND_GROUP, &res->ai_send_addrs[0], sizeof(struct pgm_group_source_req));
+	pgm_setsockopt (sock, IPPROTO_PGM, PGM_NOBLOCK, &nonblocking, sizeof(nonblocking));
+	if (!pgm_connect (sock, &pgm_err)) {
+		fprintf (stderr, "connecting PGM socket: %s\n", pgm_err->message);
+		pgm_error_free (pgm_err);
+		pgm_close (sock, FALSE);
+		return NULL;
+	}
+	return sock;
+}
+
+/* message header: send time and index, delivery is in order so the receiver
+ * is complete on the last index, unrecoverable loss notwithstanding.
+ */
+
+struct bench_header_t {
+	pgm_time_t		tstamp;
+	uint32_t		index_;
+};
+
+/* drain one receiver, recording the latency of every complete message.
+ *
+ * returns count of messages delivered.
+ */
+
+static
+unsigned
+bench_receive (
+	struct bench_endpoint_t* const restrict	endpoint,
+	const unsigned				messages,
+	uint32_t*		       restrict	latency,
+	unsigned*		 const restrict	latency_len
+	)
+{
+	struct pgm_msgv_t msgv[ BENCH_BURST ];
+	unsigned count = 0;
+
+	for (;;) {
+		size_t bytes_read = 0;
+		const int status = pgm_recvmsgv (endpoint->sock, msgv, PGM_N_ELEMENTS(msgv), 0, &bytes_read, NULL);
+		if (PGM_IO_STATUS_RESET == status) {
+			endpoint->resets++;
+			continue;
+		}
+		if (PGM_IO_STATUS_NORMAL != status)
+			break;
+		const pgm_time_t now = pgm_time_update_now();
+		for (size_t i = 0; bytes_read > 0; i++) {
+			const struct pgm_sk_buff_t* skb = msgv[i].msgv_skb[0];
+			struct bench_header_t header;
+			memcpy (&header, skb->data, sizeof(header));
+			latency[ (*latency_len)++ ] = (uint32_t)(now - header.tstamp);
+			if (messages - 1 == header.index_)
+				endpoint->is_complete = TRUE;
+			for (unsigned j = 0; j < msgv[i].msgv_len; j++)
+				bytes_read -= msgv[i].msgv_skb[j]->len;
+			count++;
+		}
+	}
+	endpoint->delivered += count;
+	return count;
+}
+
+int
+main (
+	int		argc,
+	char*		argv[]
+	)
+{
+	struct pgm_addrinfo_t* res = NULL;
+	pgm_error_t* pgm_err = NULL;
+	unsigned messages = 100000, size = 1000, receivers = 4, sqns = 0, max_rte = 0;
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		if (i + 1 == argc || '-' != argv[i][0]) {
+usage:
+			fprintf (stderr, "usage: %s [-n messages] [-s size] [-r receivers] [-l loss%%] [-o reorder%%] [-d delay-us] [-w window-sqns] [-R bytes/s]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+		const char* value = argv[++i];
+		switch (argv[i - 1][1]) {
+		case 'n':	messages = (unsigned)strtoul (value, NULL, 10); break;
+		case 's':	size = (unsigned)strtoul (value, NULL, 10); break;
+		case 'r':	receivers = (unsigned)strtoul (value, NULL, 10); break;
+		case 'l':	bench_loss = (unsigned)(strtod (value, NULL) * 10000.0); break;
+		case 'o':	bench_reorder = (unsigned)(strtod (value, NULL) * 10000.0); break;
+		case 'd':	bench_delay = pgm_usecs (strtoul (value, NULL, 10)); break;
+		case 'w':	sqns = (unsigned)strtoul (value, NULL, 10); break;
+		case 'R':	max_rte = (unsigned)strtoul (value, NULL, 10); break;
+		default:	goto usage;
+		}
+	}
+	if (0 == messages || size < sizeof(struct bench_header_t) || 0 == receivers || receivers > BENCH_MAX_RECEIVERS)
+		goto usage;
+
+/* the source does not wait for repairs, a window shorter than the run lets
+ * the leading edge overrun receivers still recovering the trailing edge.
+ */
+	if (0 == sqns) {
+		sqns = BENCH_MIN_SQNS;
+		while (sqns < messages && sqns < BENCH_MAX_SQNS)
+			sqns <<= 1;
+	}
+
+	if (!pgm_init (&pgm_err)) {
+		fprintf (stderr, "unable to start PGM engine: %s\n", pgm_err->message);
+		pgm_error_free (pgm_err);
+		return EXIT_FAILURE;
+	}
+	if (!pgm_getaddrinfo (BENCH_NETWORK, NULL, &res, &pgm_err)) {
+		fprintf (stderr, "parsing network parameter: %s\n", pgm_err->message);
+		pgm_error_free (pgm_err);
+		pgm_shutdown ();
+		return EXIT_FAILURE;
+	}
+
+/* no datagram reaches the network from here */
+	pgm_net_shim = &bench_shim;
+
+/* receivers listen before the source announces itself */
+	bench_endpoints_len = 1 + receivers;
+	for (unsigned r = 0; r < bench_endpoints_len; r++) {
+		struct bench_endpoint_t* endpoint = &bench_endpoints[r];
+		endpoint->is_source = (0 == r);
+		endpoint->ring = pgm_new0 (struct bench_datagram_t, BENCH_INBOX_DEPTH);
+		endpoint->store = pgm_malloc ((size_t)BENCH_INBOX_DEPTH * bench_max_tpdu);
+		for (unsigned j = 0; j < BENCH_INBOX_DEPTH; j++)
+			endpoint->ring[j].data = endpoint->store + (size_t)j * bench_max_tpdu;
+	}
+	for (unsigned r = bench_endpoints_len; r-- > 0;) {
+		bench_endpoints[r].sock = bench_create_sock (res, r, sqns, max_rte);
+		if (NULL == bench_endpoints[r].sock) {
+			pgm_freeaddrinfo (res);
+			pgm_shutdown ();
+			return EXIT_FAILURE;
+		}
+	}
+	pgm_freeaddrinfo (res);
+
+	struct bench_endpoint_t* source = &bench_endpoints[0];
+	uint32_t* latency = pgm_new (uint32_t, (size_t)messages * receivers);
+	char* buf = pgm_malloc0 (size);
+	char discard[ 4096 ];
+	unsigned sent = 0, delivered = 0, completed = 0, latency_len = 0;
+	const pgm_time_t start = pgm_time_update_now(), cpu_start = bench_cpu_time();
+	pgm_time_t last_progress = start;
+
+	while (completed < receivers)
+	{
+/* source: a burst of original data, then repairs and heartbeats */
+		for (unsigned burst = 0; sent < messages && burst < BENCH_BURST; burst++) {
+			const struct bench_header_t header = { .tstamp = pgm_time_update_now(), .index_ = sent };
+			memcpy (buf, &header, sizeof(header));
+			if (PGM_IO_STATUS_NORMAL != pgm_send (source->sock, buf, size, NULL))
+				break;
+			sent++;
+			last_progress = header.tstamp;
+		}
+		size_t bytes_read;
+		while (PGM_IO_STATUS_NORMAL == pgm_recv (source->sock, discard, sizeof(discard), 0, &bytes_read, NULL));
+
+		completed = 0;
+		for (unsigned r = 1; r <= receivers; r++) {
+			const unsigned count = bench_receive (&bench_endpoints[r], messages, latency, &latency_len);
+			if (count) {
+				delivered += count;
+				last_progress = pgm_time_update_now();
+			}
+			if (bench_endpoints[r].is_complete)
+				completed++;
+		}
+		if (pgm_time_after (pgm_time_update_now(), last_progress + BENCH_IDLE_TIMEOUT)) {
+			fprintf (stderr, "no progress for %u seconds, %u of %u messages delivered.\n",
+				 (unsigned)(BENCH_IDLE_TIMEOUT / pgm_secs (1)), delivered, messages * receivers);
+			break;
+		}
+	}
+
+	const bool is_stalled = (completed < receivers);
+	const pgm_time_t elapsed = pgm_time_update_now() - start, cpu = bench_cpu_time() - cpu_start;
+	unsigned overflow = 0, resets = 0;
+	for (unsigned r = 0; r < bench_endpoints_len; r++) {
+		overflow += bench_endpoints[r].overflow;
+		resets += bench_endpoints[r].resets;
+	}
+	qsort (latency, latency_len, sizeof(uint32_t), bench_compare_latency);
+#define PERCENTILE(p)	(latency_len ? latency[ (size_t)((latency_len - 1) * (p)) ] : 0)
+	printf ("{\"receivers\":%u,\"messages\":%u,\"size\":%u,\"window_sqns\":%u,\"loss_pct\":%.4f,\"reorder_pct\":%.4f,\"delay_us\":%" PGM_TIME_FORMAT ","
+		"\"stalled\":%s,\"sent\":%u,\"delivered\":%u,\"lost\":%u,\"reordered\":%u,\"overflow\":%u,\"resets\":%u,"
+		"\"elapsed_us\":%" PGM_TIME_FORMAT ",\"msgs_per_sec\":%.0f,\"gbit_per_sec\":%.3f,\"cpu_ns_per_msg\":%.1f,"
+		"\"latency_us\":{\"p50\":%u,\"p90\":%u,\"p99\":%u,\"p999\":%u,\"max\":%u}}\n",
+		receivers, messages, size, sqns, bench_loss / 10000.0, bench_reorder / 10000.0, bench_delay,
+		is_stalled ? "true" : "false", sent, delivered, bench_lost, bench_reordered, overflow, resets,
+		elapsed,
+		elapsed ? (double)sent * 1000000.0 / elapsed : 0.0,
+		elapsed ? (double)sent * size * 8.0 / (elapsed * 1000.0) : 0.0,
+		sent ? (double)cpu * 1000.0 / sent : 0.0,
+		PERCENTILE(0.5), PERCENTILE(0.9), PERCENTILE(0.99), PERCENTILE(0.999), PERCENTILE(1.0));
+#undef PERCENTILE
+
+	for (unsigned r = 0; r < bench_endpoints_len; r++) {
+		pgm_close (bench_endpoints[r].sock, FALSE);
+		pgm_free (bench_endpoints[r].ring);
+		pgm_free (bench_endpoints[r].store);
+	}
+	pgm_net_shim = NULL;
+	pgm_free (latency);
+	pgm_free (buf);
+	pgm_shutdown ();
+	return is_stalled ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/* eof */
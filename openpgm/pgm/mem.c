@@ -29,6 +29,12 @@
 #include <string.h>
 #ifdef _WIN32
 #	define strcasecmp	stricmp
+#else
+#	include <unistd.h>
+#	include <sys/mman.h>
+#endif
+#ifdef __linux__
+#	include <sys/syscall.h>
 #endif
 #include <impl/framework.h>
 #include <impl/mem.h>
@@ -52,6 +58,44 @@ typedef struct pgm_debug_key_t pgm_debug_key_t;
 
 static volatile uint32_t mem_ref_count = 0;
 
+/* custom allocator, NULL for the system heap */
+static const struct pgm_allocator_t* mem_allocator PGM_GNUC_READ_MOSTLY = NULL;
+
+/* Allocation counters are plain per-thread increments, a thread creates its
+ * block on first allocation and pushes it on to a list that readers sum.
+ * Blocks come from the system heap, are not counted, and outlive their thread
+ * so totals never go backwards.  Readers may see a torn count on 32-bit
+ * platforms.
+ */
+
+#if defined(_MSC_VER)
+#	define MEM_TLS	__declspec(thread)
+#else
+#	define MEM_TLS	__thread
+#endif
+
+struct mem_counters_t {
+	struct mem_counters_t*	next;
+	volatile uint64_t	calls[PGM_MEM_SUBSYS_MAX];
+	volatile uint64_t	bytes[PGM_MEM_SUBSYS_MAX];
+};
+
+static struct mem_counters_t* volatile	mem_counters_list = NULL;
+static MEM_TLS struct mem_counters_t*	mem_counters = NULL;
+
+static const char* const mem_subsys_names[PGM_MEM_SUBSYS_MAX] = {
+	"general",
+	"skb",
+	"placeholder",
+	"hashtable",
+	"list",
+	"fec",
+	"peer",
+	"window"
+};
+
+static void mem_count_slow (const unsigned, const size_t);
+
 
 static
 bool
@@ -149,15 +193,169 @@ pgm_mem_shutdown (void)
 	/* nop */
 }
 
+/* pointer CAS, returns TRUE if swap occurred.
+ */
+
+static inline
+bool
+mem_counters_compare_and_exchange (
+	struct mem_counters_t* volatile*	atomic,
+	struct mem_counters_t*			newval,
+	struct mem_counters_t*			oldval
+	)
+{
+#if defined( __GNUC__ ) && ( __GNUC__ * 100 + __GNUC_MINOR__ >= 401 )
+	return __sync_bool_compare_and_swap (atomic, oldval, newval);
+#elif defined( __sun )
+	return (oldval == atomic_cas_ptr ((volatile void*)atomic, oldval, newval));
+#elif defined( __APPLE__ )
+	return OSAtomicCompareAndSwapPtrBarrier (oldval, newval, (void* volatile*)atomic);
+#elif defined( _WIN32 )
+	return (oldval == InterlockedCompareExchangePointer ((PVOID volatile*)atomic, newval, oldval));
+#endif
+}
+
+static inline
+void
+mem_count (
+	const unsigned	subsys,
+	const size_t	n_bytes
+	)
+{
+	struct mem_counters_t* counters = mem_counters;
+	if (PGM_UNLIKELY (NULL == counters)) {
+		mem_count_slow (subsys, n_bytes);
+		return;
+	}
+	counters->calls[ subsys ]++;
+	counters->bytes[ subsys ] += n_bytes;
+}
+
+/* first allocation of a thread, without a block the call goes uncounted.
+ */
+
+static
+void
+mem_count_slow (
+	const unsigned	subsys,
+	const size_t	n_bytes
+	)
+{
+	struct mem_counters_t* counters = calloc (1, sizeof (struct mem_counters_t));
+	if (PGM_UNLIKELY (NULL == counters))
+		return;
+	do {
+		counters->next = mem_counters_list;
+	} while (!mem_counters_compare_and_exchange (&mem_counters_list, counters, counters->next));
+	mem_counters = counters;
+	counters->calls[ subsys ]++;
+	counters->bytes[ subsys ] += n_bytes;
+}
+
+/* sum the allocation counters of every thread into len entries indexed by
+ * PGM_MEM_SUBSYS_*.
+ */
+
+void
+pgm_mem_get_subsys_stats (
+	struct pgm_mem_subsys_stats_t*	stats,
+	const unsigned			len
+	)
+{
+	pgm_return_if_fail (NULL != stats || 0 == len);
+
+	const unsigned n = MIN(len, PGM_MEM_SUBSYS_MAX);
+	memset (stats, 0, len * sizeof (struct pgm_mem_subsys_stats_t));
+	for (const struct mem_counters_t* counters = mem_counters_list;
+	     NULL != counters;
+	     counters = counters->next)
+	{
+		for (unsigned i = 0; i < n; i++) {
+			stats[ i ].calls += counters->calls[ i ];
+			stats[ i ].bytes += counters->bytes[ i ];
+		}
+	}
+}
+
+/* returns name of a PGM_MEM_SUBSYS_* allocation site, NULL if unknown.
+ */
+
+const char*
+pgm_mem_subsys_name (
+	const unsigned	subsys
+	)
+{
+	if (PGM_UNLIKELY (subsys >= PGM_MEM_SUBSYS_MAX))
+		return NULL;
+	return mem_subsys_names[ subsys ];
+}
+
+/* install a custom allocator, or the system heap for NULL, only whilst no
+ * engine is running so every block is released by the allocator that
+ * provided it.
+ *
+ * returns TRUE on success, returns FALSE if the engine is running or a
+ * mandatory member is missing.
+ */
+
+bool
+pgm_mem_set_allocator (
+	const struct pgm_allocator_t*	allocator
+	)
+{
+	static struct pgm_allocator_t copy;
+
+	pgm_return_val_if_fail (0 == pgm_atomic_read32 (&mem_ref_count), FALSE);
+	if (NULL == allocator) {
+		mem_allocator = NULL;
+		return TRUE;
+	}
+	pgm_return_val_if_fail (NULL != allocator->al_malloc, FALSE);
+	pgm_return_val_if_fail (NULL != allocator->al_realloc, FALSE);
+	pgm_return_val_if_fail (NULL != allocator->al_free, FALSE);
+	copy = *allocator;
+	mem_allocator = &copy;
+	return TRUE;
+}
+
 /* malloc wrappers to hard fail */
 void*
 pgm_malloc (
 	const size_t	n_bytes
 	)
+{
+	return pgm_malloc_class (n_bytes, PGM_MEM_CLASS_GENERAL);
+}
+
+void*
+pgm_malloc_class (
+	const size_t	n_bytes,
+	const unsigned	size_class
+	)
+{
+	const unsigned subsys = (PGM_MEM_CLASS_PACKET == size_class) ? PGM_MEM_SUBSYS_SKB :
+				(PGM_MEM_CLASS_WINDOW == size_class) ? PGM_MEM_SUBSYS_WINDOW :
+								       PGM_MEM_SUBSYS_GENERAL;
+	return pgm_malloc_subsys (n_bytes, size_class, subsys);
+}
+
+/* as pgm_malloc_class() counted against a PGM_MEM_SUBSYS_* allocation site.
+ */
+
+PGM_GNUC_INTERNAL
+void*
+pgm_malloc_subsys (
+	const size_t	n_bytes,
+	const unsigned	size_class,
+	const unsigned	subsys
+	)
 {
 	if (PGM_LIKELY (n_bytes))
 	{
-		void* mem = malloc (n_bytes);
+		mem_count (subsys, n_bytes);
+		void* mem = PGM_UNLIKELY (NULL != mem_allocator) ?
+				mem_allocator->al_malloc (mem_allocator->al_user_data, n_bytes, size_class) :
+				malloc (n_bytes);
 		if (mem)
 			return mem;
 
@@ -197,13 +395,27 @@ pgm_malloc_n (
 	return pgm_malloc (n_blocks * block_bytes);
 }
 
+/* a custom allocator has no calloc, the block is cleared after allocation.
+ */
+
+PGM_GNUC_INTERNAL
 void*
-pgm_malloc0 (
-	const size_t	n_bytes
+pgm_malloc0_subsys (
+	const size_t	n_bytes,
+	const unsigned	size_class,
+	const unsigned	subsys
 	)
 {
+	if (PGM_UNLIKELY (NULL != mem_allocator)) {
+		void* mem = pgm_malloc_subsys (n_bytes, size_class, subsys);
+		if (mem)
+			memset (mem, 0, n_bytes);
+		return mem;
+	}
+
 	if (PGM_LIKELY (n_bytes))
 	{
+		mem_count (subsys, n_bytes);
 		void* mem = calloc (1, n_bytes);
 		if (mem)
 			return mem;
@@ -222,14 +434,31 @@ pgm_malloc0 (
 	return NULL;
 }
 
+void*
+pgm_malloc0 (
+	const size_t	n_bytes
+	)
+{
+	return pgm_malloc0_subsys (n_bytes, PGM_MEM_CLASS_GENERAL, PGM_MEM_SUBSYS_GENERAL);
+}
+
 void*
 pgm_malloc0_n (
 	const size_t	n_blocks,
 	const size_t	block_bytes
 	)
 {
+	if (PGM_UNLIKELY (NULL != mem_allocator)) {
+		if (PGM_UNLIKELY (0 == n_blocks || 0 == block_bytes))
+			return NULL;
+		void* mem = pgm_malloc_n (n_blocks, block_bytes);
+		memset (mem, 0, n_blocks * block_bytes);
+		return mem;
+	}
+
 	if (PGM_LIKELY (n_blocks && block_bytes))
 	{
+		mem_count (PGM_MEM_SUBSYS_GENERAL, n_blocks * block_bytes);
 		void* mem = calloc (n_blocks, block_bytes);
 		if (mem)
 			return mem;
@@ -273,6 +502,10 @@ pgm_realloc (
 	const size_t	n_bytes
 	)
 {
+	if (PGM_LIKELY (n_bytes))
+		mem_count (PGM_MEM_SUBSYS_GENERAL, n_bytes);
+	if (PGM_UNLIKELY (NULL != mem_allocator))
+		return mem_allocator->al_realloc (mem_allocator->al_user_data, mem, n_bytes, PGM_MEM_CLASS_GENERAL);
 	return realloc (mem, n_bytes);
 }
 
@@ -281,8 +514,268 @@ pgm_free (
 	void*		mem
 	)
 {
-	if (PGM_LIKELY (NULL != mem))
-		free (mem);
+	if (PGM_LIKELY (NULL != mem)) {
+		if (PGM_UNLIKELY (NULL != mem_allocator))
+			mem_allocator->al_free (mem_allocator->al_user_data, mem);
+		else
+			free (mem);
+	}
+}
+
+/* zeroed allocation on a power of 2 boundary for structures with cache line
+ * aligned members, release with pgm_free_aligned().  a custom allocator
+ * without aligned allocation is over-allocated with the original pointer
+ * stored preceding the aligned block.
+ */
+
+PGM_GNUC_INTERNAL
+void*
+pgm_malloc0_aligned (
+	const size_t	n_bytes,
+	const size_t	alignment
+	)
+{
+	if (PGM_LIKELY (n_bytes))
+	{
+		void* mem;
+		if (PGM_UNLIKELY (NULL != mem_allocator)) {
+			if (NULL != mem_allocator->al_aligned_alloc) {
+				mem_count (PGM_MEM_SUBSYS_GENERAL, n_bytes);
+				mem = mem_allocator->al_aligned_alloc (mem_allocator->al_user_data, n_bytes, MAX(alignment, sizeof(void*)), PGM_MEM_CLASS_GENERAL);
+			} else {
+				char* raw = pgm_malloc (n_bytes + alignment + sizeof(void*));
+				mem = (void*)(((uintptr_t)raw + sizeof(void*) + alignment - 1) & ~(uintptr_t)(alignment - 1));
+				((void**)mem)[-1] = raw;
+			}
+		} else {
+			mem_count (PGM_MEM_SUBSYS_GENERAL, n_bytes);
+#ifndef _WIN32
+			if (0 != posix_memalign (&mem, MAX(alignment, sizeof(void*)), n_bytes))
+				mem = NULL;
+#else
+			mem = _aligned_malloc (n_bytes, alignment);
+#endif
+		}
+		if (mem) {
+			memset (mem, 0, n_bytes);
+			return mem;
+		}
+
+#ifdef __GNUC__
+		pgm_fatal ("file %s: line %d (%s): failed to allocate %" PRIzu " bytes",
+			__FILE__, __LINE__, __PRETTY_FUNCTION__,
+			n_bytes);
+#else
+		pgm_fatal ("file %s: line %d: failed to allocate %" PRIzu " bytes",
+			__FILE__, __LINE__,
+			n_bytes);
+#endif
+		abort ();
+	}
+	return NULL;
+}
+
+PGM_GNUC_INTERNAL
+void
+pgm_free_aligned (
+	void*		mem
+	)
+{
+	if (PGM_UNLIKELY (NULL == mem))
+		return;
+	if (PGM_UNLIKELY (NULL != mem_allocator)) {
+		pgm_free (NULL != mem_allocator->al_aligned_alloc ? mem : ((void**)mem)[-1]);
+		return;
+	}
+#ifndef _WIN32
+	free (mem);
+#else
+	_aligned_free (mem);
+#endif
+}
+
+/* policy allocations for window and skbuff slab storage, each block is prefixed with
+ * a cache line header recording how it was obtained so release needs only the
+ * pointer.  Reserved huge pages fall back to an anonymous mapping advised for
+ * transparent huge pages when the pool is exhausted, a NUMA node is a preference,
+ * not a binding, so a full node spills over rather than faulting.
+ */
+
+#define PGM_MEM_BLOCK_HEADER	64
+
+#ifdef __linux__
+#	ifndef MAP_HUGE_SHIFT
+#		define MAP_HUGE_SHIFT	26
+#	endif
+#	ifndef MAP_HUGE_2MB
+#		define MAP_HUGE_2MB	(21 << MAP_HUGE_SHIFT)
+#	endif
+#	ifndef MAP_HUGE_1GB
+#		define MAP_HUGE_1GB	(30 << MAP_HUGE_SHIFT)
+#	endif
+#	ifndef MPOL_PREFERRED
+#		define MPOL_PREFERRED	1
+#	endif
+#	define PGM_MEM_MAX_NODES	1024
+#endif
+
+struct pgm_mem_block_t {
+	size_t		len;		/* mapping length, 0 = heap */
+};
+
+/* page length a policy allocation is rounded to, 0 for heap allocations.
+ */
+
+PGM_GNUC_INTERNAL
+size_t
+pgm_mem_policy_page_len (
+	const pgm_mem_policy_t*const policy
+	)
+{
+	if (NULL == policy)
+		return 0;
+	switch (policy->pages) {
+	case PGM_MEM_PAGES_1GB:		return (size_t)1 << 30;
+	case PGM_MEM_PAGES_2MB:
+	case PGM_MEM_PAGES_TRANSPARENT:	return (size_t)2 << 20;
+	default: break;
+	}
+#ifdef __linux__
+	if (policy->node >= 0)
+		return (size_t)sysconf (_SC_PAGESIZE);
+#endif
+	return 0;
+}
+
+#ifdef __linux__
+/* anonymous mapping aligned to page_len so transparent huge pages can back the
+ * whole range, the unaligned head and tail are returned to the kernel.
+ */
+
+static
+void*
+map_aligned (
+	const size_t	len,
+	const size_t	page_len
+	)
+{
+	char* raw = mmap (NULL, len + page_len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (MAP_FAILED == raw)
+		return MAP_FAILED;
+	char* addr = (char*)(((uintptr_t)raw + page_len - 1) & ~(uintptr_t)(page_len - 1));
+	if (addr > raw)
+		munmap (raw, addr - raw);
+	if (raw + page_len > addr)
+		munmap (addr + len, (raw + page_len) - addr);
+	return addr;
+}
+
+static
+void
+bind_node (
+	void*		addr,
+	const size_t	len,
+	const int	node
+	)
+{
+	unsigned long nodemask[ PGM_MEM_MAX_NODES / (8 * sizeof (unsigned long)) ];
+
+	if (node >= PGM_MEM_MAX_NODES)
+		return;
+	memset (nodemask, 0, sizeof (nodemask));
+	nodemask[ node / (8 * sizeof (unsigned long)) ] |= 1UL << (node % (8 * sizeof (unsigned long)));
+	if (0 != syscall (SYS_mbind, addr, len, MPOL_PREFERRED, nodemask, (unsigned long)PGM_MEM_MAX_NODES + 1, 0)) {
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_trace (PGM_LOG_ROLE_MEMORY,_("Failed to prefer NUMA node %d: %s"),
+			node, pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+	}
+}
+#endif /* __linux__ */
+
+PGM_GNUC_INTERNAL
+void*
+pgm_malloc0_policy (
+	const size_t			n_bytes,
+	const pgm_mem_policy_t*const	policy
+	)
+{
+	const size_t page_len = pgm_mem_policy_page_len (policy);
+	struct pgm_mem_block_t* block;
+
+	if (PGM_UNLIKELY (0 == n_bytes))
+		return NULL;
+
+#ifdef __linux__
+	if (page_len) {
+		const size_t len = (PGM_MEM_BLOCK_HEADER + n_bytes + page_len - 1) & ~(page_len - 1);
+		void* addr = MAP_FAILED;
+
+		if (PGM_MEM_PAGES_2MB == policy->pages || PGM_MEM_PAGES_1GB == policy->pages) {
+			const int huge_flags = MAP_HUGETLB | (PGM_MEM_PAGES_1GB == policy->pages ? MAP_HUGE_1GB : MAP_HUGE_2MB);
+			addr = mmap (NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | huge_flags, -1, 0);
+			if (MAP_FAILED == addr) {
+				const int save_errno = errno;
+				char errbuf[1024];
+				pgm_trace (PGM_LOG_ROLE_MEMORY,_("Huge page mapping of %" PRIzu " bytes failed, using transparent huge pages: %s"),
+					len, pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+			}
+		}
+		if (MAP_FAILED == addr) {
+			addr = map_aligned (len, page_len);
+			if (MAP_FAILED != addr && PGM_MEM_PAGES_DEFAULT != policy->pages) {
+#	ifdef MADV_HUGEPAGE
+				madvise (addr, len, MADV_HUGEPAGE);
+#	endif
+			}
+		}
+		if (MAP_FAILED != addr) {
+			mem_count (PGM_MEM_SUBSYS_WINDOW, len);
+/* preference must precede first touch */
+			if (policy->node >= 0)
+				bind_node (addr, len, policy->node);
+			block = addr;
+			block->len = len;
+			return (char*)block + PGM_MEM_BLOCK_HEADER;
+		}
+#	ifdef __GNUC__
+		pgm_fatal ("file %s: line %d (%s): failed to map %" PRIzu " bytes",
+			__FILE__, __LINE__, __PRETTY_FUNCTION__,
+			len);
+#	else
+		pgm_fatal ("file %s: line %d: failed to map %" PRIzu " bytes",
+			__FILE__, __LINE__,
+			len);
+#	endif
+		abort ();
+	}
+#else
+	(void)page_len;
+#endif /* __linux__ */
+
+	block = pgm_malloc0_subsys (PGM_MEM_BLOCK_HEADER + n_bytes, PGM_MEM_CLASS_WINDOW, PGM_MEM_SUBSYS_WINDOW);
+	block->len = 0;
+	return (char*)block + PGM_MEM_BLOCK_HEADER;
+}
+
+PGM_GNUC_INTERNAL
+void
+pgm_free_policy (
+	void*		mem
+	)
+{
+	struct pgm_mem_block_t* block;
+
+	if (PGM_UNLIKELY (NULL == mem))
+		return;
+	block = (struct pgm_mem_block_t*)((char*)mem - PGM_MEM_BLOCK_HEADER);
+#ifdef __linux__
+	if (block->len) {
+		munmap (block, block->len);
+		return;
+	}
+#endif
+	pgm_free (block);
 }
 
 /* eof */
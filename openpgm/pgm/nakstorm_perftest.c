@@ -0,0 +1,948 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * NAK storm performance test of one source and thousands of virtual receivers
+ * in one process.  the source is a complete PGM socket over an in-memory
+ * transport, each virtual receiver is a receive window with its own NAK
+ * back-off, NCF and RDATA timers, all driven by one virtual clock.  loss is
+ * independent per receiver, shared by every receiver, or both; shared loss
+ * has every receiver NAK the same sequence numbers and so loads NCF
+ * suppression, pgm_on_nak() and the repair path of the source.
+ *
+ * the result is written to stdout as one JSON object, run once per receiver
+ * count to find where the source saturates:
+ *
+ *   for r in 10 100 1000 10000; do ./nakstorm_perftest -r $r -L 1; done
+ *
+ *   {"receivers":1000,"messages":20000,...,"ncf_per_sec":..,"rdata_per_sec":..,
+ *    "source_cpu_pct":..,"repair_us":{"p50":..,"p90":..,"p99":..,"max":..}}
+ *
+ * usage: nakstorm_perftest [-n messages] [-s size] [-r receivers] [-m msgs/s]
+ *			    [-l loss%] [-L shared-loss%] [-d delay-us]
+ *			    [-b nak-bo-ivl-us] [-w rxw-sqns] [-q inbox-depth]
+ *
+ * source CPU is the thread CPU time spent inside pgm_send() and pgm_recv() of
+ * the source socket, as a percentage of the virtual run time it is the load
+ * the same storm would place on a real source.  rates are per second of
+ * virtual time.  repair time is from original transmission of a message to
+ * delivery of its repair at a receiver that lost it.
+ *
+ * Copyright (c) 2010-2016 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#	include <time.h>
+#endif
+#include <pgm/engine.h>
+#include <impl/framework.h>
+#include <impl/net.h>
+#include <impl/packet_parse.h>
+#include <impl/rxw.h>
+#include <impl/socket.h>
+
+
+#define STORM_NETWORK		"127.0.0.1;239.192.0.1"
+#define STORM_PORT		7500
+#define STORM_UDP_ENCAP_PORT	3055
+#define STORM_MAX_TPDU		1500
+#define STORM_TICK		pgm_usecs (100)
+#define STORM_IDLE_TIMEOUT	pgm_secs (5)		/* virtual time */
+#define STORM_BURST		64
+#define STORM_NAK_RETRIES	50
+#define STORM_MAX_NAK_LIST	63			/* sequence numbers per NAK */
+#define STORM_MIN_SQNS		16384
+#define STORM_MAX_SQNS		(1 << 20)
+
+/* one datagram in flight, multicast from the source or upstream from a
+ * virtual receiver.
+ */
+
+struct storm_datagram_t {
+	pgm_time_t		due;
+	unsigned		from;			/* receiver index, upstream only */
+	uint16_t		len;
+	char*			data;
+};
+
+/* FIFO of datagrams, a constant delay keeps due times in order */
+
+struct storm_queue_t {
+	struct storm_datagram_t* ring;
+	unsigned		head, tail;
+	unsigned		size;			/* power of two */
+};
+
+/* message header: send time and index */
+
+struct storm_header_t {
+	pgm_time_t		tstamp;
+	uint32_t		index_;
+};
+
+struct storm_receiver_t {
+	pgm_rxw_t*		window;
+/* indices of original data lost to this receiver, ascending */
+	uint32_t*		lost;
+	unsigned		lost_head, lost_tail, lost_size;
+	unsigned		delivered;
+	bool			is_pending;		/* window to be read */
+	bool			is_complete;
+};
+
+/* virtual clock replacing pgm_time_update_now() for the whole library */
+static pgm_time_t		storm_now;
+static pgm_time_update_func	storm_saved_clock;
+
+static pgm_sock_t*		storm_source;
+static struct storm_queue_t	storm_downstream;	/* source to every receiver */
+static struct storm_queue_t	storm_inbox;		/* receivers to the source */
+static unsigned			storm_inbox_depth = 4096;
+
+static struct storm_receiver_t*	storm_receivers;
+static unsigned			storm_receivers_len;
+
+static unsigned			storm_loss = 0;		/* parts per million */
+static unsigned			storm_shared_loss = 0;	/* parts per million */
+static pgm_time_t		storm_delay = pgm_msecs (1);
+static pgm_time_t		storm_nak_bo_ivl = pgm_msecs (10);
+static pgm_time_t		storm_nak_rpt_ivl, storm_nak_rdata_ivl;
+static uint32_t			storm_rand_state = 0x2545f491;
+
+/* source transmit and receiver NAK counters */
+static unsigned			storm_odata, storm_rdata, storm_ncfs, storm_spms;
+static unsigned			storm_naks, storm_nak_sqns, storm_naks_dropped, storm_naks_lost;
+static unsigned			storm_lost, storm_shared_lost;
+
+/* repair times in microseconds */
+static uint32_t*		storm_repairs;
+static size_t			storm_repairs_len, storm_repairs_size;
+
+static
+pgm_time_t
+storm_clock (void)
+{
+	return storm_now;
+}
+
+/* xorshift32, independent of the library generators */
+
+static inline
+unsigned
+storm_rand (void)
+{
+	uint32_t x = storm_rand_state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	storm_rand_state = x;
+	return x;
+}
+
+static inline
+unsigned
+storm_rand_ppm (void)
+{
+	return storm_rand() % 1000000;
+}
+
+/* random back-off of a new placeholder, as nak_rb_ivl() of receiver.c */
+
+static inline
+pgm_time_t
+storm_nak_rb_expiry (void)
+{
+	return storm_now + 1 + storm_rand() % storm_nak_bo_ivl;
+}
+
+static
+void
+storm_queue_push (
+	struct storm_queue_t* const restrict	queue,
+	const void*		    restrict	buf,
+	const size_t				len,
+	const unsigned				from
+	)
+{
+	if (queue->tail - queue->head == queue->size) {
+		const unsigned size = queue->size ? queue->size << 1 : 1024;
+		struct storm_datagram_t* ring = pgm_new (struct storm_datagram_t, size);
+		for (unsigned i = queue->head; i != queue->tail; i++)
+			ring[ (i - queue->head) ] = queue->ring[ i & (queue->size - 1) ];
+		pgm_free (queue->ring);
+		queue->ring = ring;
+		queue->tail -= queue->head;
+		queue->head = 0;
+		queue->size = size;
+	}
+	struct storm_datagram_t* datagram = &queue->ring[ queue->tail++ & (queue->size - 1) ];
+	datagram->due = storm_now + storm_delay;
+	datagram->from = from;
+	datagram->len = (uint16_t)len;
+	datagram->data = pgm_memdup (buf, len);
+}
+
+/* returns the head datagram if due, otherwise NULL.
+ */
+
+static
+struct storm_datagram_t*
+storm_queue_peek (
+	struct storm_queue_t* const	queue
+	)
+{
+	if (queue->head == queue->tail)
+		return NULL;
+	struct storm_datagram_t* datagram = &queue->ring[ queue->head & (queue->size - 1) ];
+	return pgm_time_after (datagram->due, storm_now) ? NULL : datagram;
+}
+
+static
+void
+storm_queue_pop (
+	struct storm_queue_t* const	queue
+	)
+{
+	pgm_free (queue->ring[ queue->head++ & (queue->size - 1) ].data);
+}
+
+static
+void
+storm_queue_free (
+	struct storm_queue_t* const	queue
+	)
+{
+	while (queue->head != queue->tail)
+		storm_queue_pop (queue);
+	pgm_free (queue->ring);
+}
+
+/* the source only ever sends multicast, counted by packet type.
+ */
+
+static
+ssize_t
+storm_sendto (
+	void*				user_data,
+	pgm_sock_t*	       restrict	sock,
+	const void*	       restrict	buf,
+	size_t				len,
+	const struct sockaddr* restrict	to,
+	socklen_t			tolen
+	)
+{
+	const struct pgm_header* header = buf;
+
+	(void)user_data;
+	(void)sock;
+	(void)tolen;
+	if (len < sizeof(struct pgm_header) || !pgm_sockaddr_is_addr_multicast (to))
+		return (ssize_t)len;
+	switch (header->pgm_type) {
+	case PGM_ODATA:	storm_odata++; break;
+	case PGM_RDATA:	storm_rdata++; break;
+	case PGM_NCF:	storm_ncfs++; break;
+	case PGM_SPM:	storm_spms++; break;
+	default: break;
+	}
+	storm_queue_push (&storm_downstream, buf, len, 0);
+	return (ssize_t)len;
+}
+
+/* NAKs arrive from a distinct unicast address per virtual receiver.
+ */
+
+static
+ssize_t
+storm_recvfrom (
+	void*				user_data,
+	pgm_sock_t*	       restrict	sock,
+	void*		       restrict	buf,
+	size_t				len,
+	struct sockaddr*       restrict	src_addr,
+	struct sockaddr*       restrict	dst_addr
+	)
+{
+	const struct storm_datagram_t* datagram = storm_queue_peek (&storm_inbox);
+
+	(void)user_data;
+	if (NULL == datagram) {
+		pgm_set_last_sock_error (PGM_SOCK_EAGAIN);
+		return -1;
+	}
+	const size_t copy_len = MIN(len, datagram->len);
+	memcpy (buf, datagram->data, copy_len);
+	struct sockaddr_in* sin = (struct sockaddr_in*)src_addr;
+	memset (src_addr, 0, sizeof(struct sockaddr_storage));
+	sin->sin_family = AF_INET;
+	sin->sin_addr.s_addr = htonl (0x0a000001 + datagram->from);	/* 10.0.0.1 onwards */
+	memcpy (dst_addr, &sock->send_addr, sizeof(struct sockaddr_storage));
+	storm_queue_pop (&storm_inbox);
+	return (ssize_t)copy_len;
+}
+
+static const struct pgm_net_shim_t storm_shim = {
+	.user_data	= NULL,
+	.sendto		= storm_sendto,
+	.recvfrom	= storm_recvfrom
+};
+
+/* thread CPU time in nanoseconds */
+
+static
+uint64_t
+storm_cpu_time (void)
+{
+#ifndef _WIN32
+	struct timespec ts;
+	clock_gettime (CLOCK_THREAD_CPUTIME_ID, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+#else
+	FILETIME creation, exit, kernel, user;
+	ULARGE_INTEGER k, u;
+	GetThreadTimes (GetCurrentThread(), &creation, &exit, &kernel, &user);
+	k.LowPart = kernel.dwLowDateTime; k.HighPart = kernel.dwHighDateTime;
+	u.LowPart = user.dwLowDateTime;   u.HighPart = user.dwHighDateTime;
+	return (uint64_t)(k.QuadPart + u.QuadPart) * 100;
+#endif
+}
+
+static
+int
+storm_compare_time (
+	const void*	a,
+	const void*	b
+	)
+{
+	const uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+	return (x > y) - (x < y);
+}
+
+/* NAK from a virtual receiver, laid out as send_nak_list() of receiver.c.
+ */
+
+static
+void
+storm_send_nak (
+	const unsigned		from,
+	const uint32_t*	const	sqn,
+	const unsigned		len
+	)
+{
+	char buf[ sizeof(struct pgm_header) + sizeof(struct pgm_nak) +
+		  sizeof(struct pgm_opt_length) + sizeof(struct pgm_opt_header) +
+		  sizeof(uint8_t) + (STORM_MAX_NAK_LIST - 1) * sizeof(uint32_t) ];
+	struct pgm_header* header = (struct pgm_header*)buf;
+	struct pgm_nak* nak = (struct pgm_nak*)(header + 1);
+	size_t tpdu_length = sizeof(struct pgm_header) + sizeof(struct pgm_nak);
+
+	pgm_assert (len > 0 && len <= STORM_MAX_NAK_LIST);
+
+	storm_naks++;
+	storm_nak_sqns += len;
+	if (storm_loss && storm_rand_ppm() < storm_loss) {
+		storm_naks_lost++;
+		return;
+	}
+	if (storm_inbox.tail - storm_inbox.head >= storm_inbox_depth) {
+		storm_naks_dropped++;
+		return;
+	}
+
+	memcpy (header->pgm_gsi, &storm_source->tsi.gsi, sizeof(pgm_gsi_t));
+	header->pgm_sport	= storm_source->dport;
+	header->pgm_dport	= storm_source->tsi.sport;
+	header->pgm_type	= PGM_NAK;
+	header->pgm_options	= 0;
+	header->pgm_tsdu_length	= 0;
+	nak->nak_sqn		= pgm_htonl (sqn[0]);
+	pgm_sockaddr_to_nla ((const struct sockaddr*)&storm_source->send_addr, (char*)&nak->nak_src_nla_afi);
+	pgm_sockaddr_to_nla ((const struct sockaddr*)&storm_source->send_gsr.gsr_group, (char*)&nak->nak_grp_nla_afi);
+
+	if (len > 1) {
+		struct pgm_opt_length* opt_len = (struct pgm_opt_length*)(nak + 1);
+		struct pgm_opt_header* opt_header = (struct pgm_opt_header*)(opt_len + 1);
+		struct pgm_opt_nak_list* opt_nak_list = (struct pgm_opt_nak_list*)(opt_header + 1);
+		const size_t opt_total_length = sizeof(struct pgm_opt_length) +
+						sizeof(struct pgm_opt_header) +
+						sizeof(uint8_t) +
+						( (len - 1) * sizeof(uint32_t) );
+		header->pgm_options	  = PGM_OPT_PRESENT | PGM_OPT_NETWORK;
+		opt_len->opt_type	  = PGM_OPT_LENGTH;
+		opt_len->opt_length	  = sizeof(struct pgm_opt_length);
+		opt_len->opt_total_length = pgm_htons ((uint16_t)opt_total_length);
+		opt_header->opt_type	  = PGM_OPT_NAK_LIST | PGM_OPT_END;
+		opt_header->opt_reserved  = 0;
+		opt_header->opt_length	  = (uint8_t)(opt_total_length - sizeof(struct pgm_opt_length));
+		opt_nak_list->opt_reserved = 0;
+		for (unsigned i = 1; i < len; i++)
+			opt_nak_list->opt_sqn[i - 1] = pgm_htonl (sqn[i]);
+		tpdu_length += opt_total_length;
+	}
+
+	header->pgm_checksum	= 0;
+	header->pgm_checksum	= pgm_csum_fold (pgm_csum_partial (buf, (uint16_t)tpdu_length, 0));
+	storm_queue_push (&storm_inbox, buf, tpdu_length, from);
+}
+
+/* repair state machine of one virtual receiver: the select NAK branch of
+ * nak_rb_state(), nak_rpt_state() and nak_rdata_state() of receiver.c.
+ */
+
+static
+void
+storm_nak_state (
+	struct storm_receiver_t* const	receiver,
+	const unsigned			from
+	)
+{
+	pgm_rxw_t* window = receiver->window;
+	uint32_t nak_list[ STORM_MAX_NAK_LIST ];
+	unsigned nak_list_len = 0;
+
+	for (pgm_list_t *it = window->nak_backoff_queue.tail, *prev; NULL != it; it = prev)
+	{
+		struct pgm_sk_buff_t* skb = (struct pgm_sk_buff_t*)it;
+		pgm_rxw_state_t* state = (pgm_rxw_state_t*)&skb->cb;
+
+		prev = it->prev;
+		if (pgm_time_after (state->timer_expiry, storm_now))
+			break;
+		pgm_rxw_state (window, skb, PGM_PKT_STATE_WAIT_NCF);
+		state->nak_transmit_count++;
+		state->nak_tstamp = storm_now;
+		state->timer_expiry = storm_now + storm_nak_rpt_ivl;
+		nak_list[ nak_list_len++ ] = skb->sequence;
+		if (STORM_MAX_NAK_LIST == nak_list_len) {
+			storm_send_nak (from, nak_list, nak_list_len);
+			nak_list_len = 0;
+		}
+	}
+	if (nak_list_len)
+		storm_send_nak (from, nak_list, nak_list_len);
+
+	for (pgm_list_t *it = window->wait_ncf_queue.tail, *prev; NULL != it; it = prev)
+	{
+		struct pgm_sk_buff_t* skb = (struct pgm_sk_buff_t*)it;
+		pgm_rxw_state_t* state = (pgm_rxw_state_t*)&skb->cb;
+
+		prev = it->prev;
+		if (pgm_time_after (state->timer_expiry, storm_now))
+			break;
+		if (++state->ncf_retry_count >= STORM_NAK_RETRIES) {
+			pgm_rxw_lost (window, skb->sequence);
+			receiver->is_pending = TRUE;
+			continue;
+		}
+		state->timer_expiry = storm_nak_rb_expiry();
+		pgm_rxw_state (window, skb, PGM_PKT_STATE_BACK_OFF);
+	}
+
+	for (pgm_list_t *it = window->wait_data_queue.tail, *prev; NULL != it; it = prev)
+	{
+		struct pgm_sk_buff_t* skb = (struct pgm_sk_buff_t*)it;
+		pgm_rxw_state_t* state = (pgm_rxw_state_t*)&skb->cb;
+
+		prev = it->prev;
+		if (pgm_time_after (state->timer_expiry, storm_now))
+			break;
+		if (++state->data_retry_count >= STORM_NAK_RETRIES) {
+			pgm_rxw_lost (window, skb->sequence);
+			receiver->is_pending = TRUE;
+			continue;
+		}
+		state->timer_expiry = storm_nak_rb_expiry();
+		pgm_rxw_state (window, skb, PGM_PKT_STATE_BACK_OFF);
+	}
+}
+
+/* original or repair data into the window of one virtual receiver, prepared
+ * as recv.c and pgm_on_data() of receiver.c.
+ */
+
+static
+void
+storm_on_data (
+	struct storm_receiver_t* const	     restrict receiver,
+	const struct storm_datagram_t* const restrict datagram
+	)
+{
+	struct pgm_sk_buff_t* skb = pgm_alloc_skb (datagram->len);
+	skb->sock		= storm_source;		/* owner for skbuff validation only */
+	skb->is_private		= 1;
+	skb->tstamp		= storm_now;
+	skb->wire_tstamp	= storm_now;
+	skb->csum_unnecessary	= 1;
+	memcpy (pgm_skb_put (skb, datagram->len), datagram->data, datagram->len);
+	if (PGM_UNLIKELY(!pgm_parse_udp_encap (skb, NULL)))
+		goto discarded;
+	skb->data = (void*)( skb->pgm_header + 1 );
+	skb->len -= sizeof(struct pgm_header);
+	skb->pgm_data = skb->data;
+	if (PGM_UNLIKELY(!pgm_parse_options (skb, skb->pgm_data + 1)))
+		goto discarded;
+	pgm_skb_pull (skb, (uint16_t)(sizeof(struct pgm_data) + pgm_opt_desc_const (skb)->opt_total_length));
+
+	switch (pgm_rxw_add (receiver->window, skb, storm_now, storm_nak_rb_expiry())) {
+	case PGM_RXW_INSERTED:
+	case PGM_RXW_APPENDED:
+	case PGM_RXW_MISSING:
+		receiver->is_pending = TRUE;
+		return;
+	default:
+		break;
+	}
+discarded:
+	pgm_free_skb (skb);
+}
+
+/* note an original data message lost to one receiver, growing the list as
+ * required.
+ */
+
+static
+void
+storm_lost_push (
+	struct storm_receiver_t* const	receiver,
+	const uint32_t			index_
+	)
+{
+	if (receiver->lost_tail - receiver->lost_head == receiver->lost_size) {
+		const unsigned size = receiver->lost_size ? receiver->lost_size << 1 : 16;
+		uint32_t* lost = pgm_new (uint32_t, size);
+		for (unsigned i = receiver->lost_head; i != receiver->lost_tail; i++)
+			lost[ i - receiver->lost_head ] = receiver->lost[ i & (receiver->lost_size - 1) ];
+		pgm_free (receiver->lost);
+		receiver->lost = lost;
+		receiver->lost_tail -= receiver->lost_head;
+		receiver->lost_head = 0;
+		receiver->lost_size = size;
+	}
+	receiver->lost[ receiver->lost_tail++ & (receiver->lost_size - 1) ] = index_;
+}
+
+/* deliver everything in order from one receive window, recording the repair
+ * time of messages this receiver lost.
+ */
+
+static
+void
+storm_receive (
+	struct storm_receiver_t* const	receiver,
+	const unsigned			messages
+	)
+{
+	pgm_rxw_t* window = receiver->window;
+
+	receiver->is_pending = FALSE;
+	for (;;) {
+		struct pgm_msgv_t msgv[ STORM_BURST ], *pmsg = msgv;
+		const uint32_t trail = window->trail;
+		const ssize_t bytes_read = pgm_rxw_readv (window, &pmsg, PGM_N_ELEMENTS(msgv));
+		for (const struct pgm_msgv_t* msg = msgv; msg < pmsg; msg++) {
+			struct storm_header_t header;
+			memcpy (&header, msg->msgv_skb[0]->data, sizeof(header));
+			while (receiver->lost_head != receiver->lost_tail) {
+				const uint32_t lost = receiver->lost[ receiver->lost_head & (receiver->lost_size - 1) ];
+				if (lost > header.index_)
+					break;
+				receiver->lost_head++;
+				if (lost < header.index_)
+					continue;
+				if (storm_repairs_len == storm_repairs_size) {
+					storm_repairs_size = storm_repairs_size ? storm_repairs_size << 1 : 4096;
+					storm_repairs = pgm_realloc (storm_repairs, storm_repairs_size * sizeof(uint32_t));
+				}
+				storm_repairs[ storm_repairs_len++ ] = (uint32_t)pgm_to_usecs (storm_now - header.tstamp);
+			}
+			if (messages - 1 == header.index_)
+				receiver->is_complete = TRUE;
+			receiver->delivered++;
+		}
+		pgm_rxw_remove_commit (window);
+/* a lost trail is removed without reading */
+		if (bytes_read < 0 && trail == window->trail)
+			break;
+	}
+}
+
+/* one multicast datagram from the source to every virtual receiver, parsed
+ * once for the fields shared by all.
+ */
+
+static
+void
+storm_fanout (
+	const struct storm_datagram_t* const	datagram
+	)
+{
+	struct pgm_sk_buff_t* skb = pgm_alloc_skb (datagram->len);
+	uint32_t sqn[ 1 + STORM_MAX_NAK_LIST ];
+	unsigned sqn_len = 0;
+	uint32_t spm_lead = 0, spm_trail = 0, index_ = 0;
+
+	skb->sock		= storm_source;
+	skb->is_private		= 1;
+	skb->tstamp		= storm_now;
+	skb->csum_unnecessary	= 1;
+	memcpy (pgm_skb_put (skb, datagram->len), datagram->data, datagram->len);
+	if (PGM_UNLIKELY(!pgm_parse_udp_encap (skb, NULL)))
+		goto out;
+	skb->data = (void*)( skb->pgm_header + 1 );
+	skb->len -= sizeof(struct pgm_header);
+
+	const uint8_t type = skb->pgm_header->pgm_type;
+	switch (type) {
+	case PGM_ODATA:
+	case PGM_RDATA:
+		skb->pgm_data = skb->data;
+		if (PGM_UNLIKELY(!pgm_parse_options (skb, skb->pgm_data + 1)))
+			goto out;
+		pgm_skb_pull (skb, (uint16_t)(sizeof(struct pgm_data) + pgm_opt_desc_const (skb)->opt_total_length));
+		if (skb->len >= sizeof(struct storm_header_t))
+			memcpy (&index_, (const char*)skb->data + offsetof(struct storm_header_t, index_), sizeof(index_));
+		break;
+
+	case PGM_NCF:
+	{
+		const struct pgm_nak* ncf = (const struct pgm_nak*)skb->data;
+		if (PGM_UNLIKELY(!pgm_verify_ncf (skb)))
+			goto out;
+		sqn[ sqn_len++ ] = pgm_ntohl (ncf->nak_sqn);
+		if (skb->pgm_header->pgm_options & PGM_OPT_PRESENT) {
+			if (PGM_UNLIKELY(!pgm_parse_options (skb, ncf + 1)))
+				goto out;
+			const struct pgm_opt_nak_list* opt_nak_list = pgm_opt_body (skb, pgm_opt_desc_const (skb)->opt_nak_list);
+			if (NULL != opt_nak_list) {
+				const unsigned list_len = MIN(STORM_MAX_NAK_LIST, pgm_opt_nak_list_len (skb));
+				for (unsigned i = 0; i < list_len; i++)
+					sqn[ sqn_len++ ] = pgm_ntohl (opt_nak_list->opt_sqn[i]);
+			}
+		}
+		break;
+	}
+
+	case PGM_SPM:
+	{
+		const struct pgm_spm* spm = (const struct pgm_spm*)skb->data;
+		if (PGM_UNLIKELY(!pgm_verify_spm (skb)))
+			goto out;
+		spm_lead  = pgm_ntohl (spm->spm_lead);
+		spm_trail = pgm_ntohl (spm->spm_trail);
+		break;
+	}
+
+	default:
+		goto out;
+	}
+
+/* loss upstream of every receiver */
+	const bool is_shared_loss = storm_shared_loss && storm_rand_ppm() < storm_shared_loss;
+	if (is_shared_loss)
+		storm_shared_lost++;
+
+	for (unsigned r = 0; r < storm_receivers_len; r++)
+	{
+		struct storm_receiver_t* receiver = &storm_receivers[r];
+		if (is_shared_loss || (storm_loss && storm_rand_ppm() < storm_loss)) {
+			if (!is_shared_loss)
+				storm_lost++;
+			if (PGM_ODATA == type)
+				storm_lost_push (receiver, index_);
+			continue;
+		}
+		switch (type) {
+		case PGM_ODATA:
+		case PGM_RDATA:
+			storm_on_data (receiver, datagram);
+			break;
+
+/* suppress our own NAK or await the repair */
+		case PGM_NCF:
+			for (unsigned i = 0; i < sqn_len; i++) {
+				const int status = pgm_rxw_confirm (receiver->window,
+								    sqn[i],
+								    storm_now,
+								    storm_now + storm_nak_rdata_ivl,
+								    storm_nak_rb_expiry());
+				(void)status;
+			}
+			break;
+
+		case PGM_SPM:
+			if (pgm_rxw_update (receiver->window, spm_lead, spm_trail, storm_now, storm_nak_rb_expiry()))
+				receiver->is_pending = TRUE;
+			break;
+		}
+	}
+out:
+	pgm_free_skb (skb);
+}
+
+static
+pgm_sock_t*
+storm_create_source (
+	const struct pgm_addrinfo_t* const	res,
+	const unsigned				sqns
+	)
+{
+	pgm_sock_t* sock = NULL;
+	pgm_error_t* pgm_err = NULL;
+	const sa_family_t sa_family = res->ai_send_addrs[0].gsr_group.ss_family;
+	const int udp_encap_port = STORM_UDP_ENCAP_PORT,
+		  max_tpdu = STORM_MAX_TPDU,
+		  no_router_assist = 0,
+		  nonblocking = 1,
+		  send_only = 1,
+		  txw_sqns = (int)sqns,
+		  ambient_spm = pgm_msecs (100),
+		  heartbeat_spm[] = { pgm_msecs (1),
+				      pgm_msecs (1),
+				      pgm_msecs (2),
+				      pgm_msecs (4),
+				      pgm_msecs (8),
+				      pgm_msecs (16),
+				      pgm_msecs (32),
+				      pgm_msecs (64),
+				      pgm_msecs (100) };
+
+	if (!pgm_socket (&sock, sa_family, SOCK_SEQPACKET, IPPROTO_UDP, &pgm_err)) {
+		fprintf (stderr, "creating PGM/UDP socket: %s\n", pgm_err->message);
+		pgm_error_free (pgm_err);
+		return NULL;
+	}
+	pgm_setsockopt (sock, IPPROTO_PGM, PGM_UDP_ENCAP_UCAST_PORT, &udp_encap_port, sizeof(udp_encap_port));
+	pgm_setsockopt (sock, IPPROTO_PGM, PGM_UDP_ENCAP_MCAST_PORT, &udp_encap_port, sizeof(udp_encap_port));
+	pgm_setsockopt (sock, IPPROTO_PGM, PGM_IP_ROUTER_ALERT, &no_router_assist, sizeof(no_router_assist));
+	pgm_setsockopt (sock, IPPROTO_PGM, PGM_MTU, &max_tpdu, sizeof(max_tpdu));
+	pgm_setsockopt (sock, IPPROTO_PGM, PGM_SEND_ONLY, &send_only, sizeof(send_only));
+	pgm_setsockopt (sock, IPPROTO_PGM, PGM_TXW_SQNS, &txw_sqns, sizeof(txw_sqns));
+	pgm_setsockopt (sock, IPPROTO_PGM, PGM_AMBIENT_SPM, &ambient_spm, sizeof(ambient_spm));
+	pgm_setsockopt (sock, IPPROTO_PGM, PGM_HEARTBEAT_SPM, &heartbeat_spm, sizeof(heartbeat_spm));
+
+	struct pgm_sockaddr_t addr;
+	memset (&addr, 0, sizeof(addr));
+	addr.sa_port = STORM_PORT;
+	addr.sa_addr.sport = STORM_PORT + 1;
+	pgm_gsi_create_from_string (&addr.sa_addr.gsi, "nakstorm_perftest", -1);
+
+	struct pgm_interface_req_t if_req;
+	memset (&if_req, 0, sizeof(if_req));
+	if_req.ir_interface = res->ai_recv_addrs[0].gsr_interface;
+	memcpy (&if_req.ir_address, &res->ai_send_addrs[0].gsr_addr, sizeof(struct sockaddr_storage));
+	if (!pgm_bind3 (sock,
+			&addr, sizeof(addr),
+			&if_req, sizeof(if_req),	/* tx interface */
+			&if_req, sizeof(if_req),	/* rx interface */
+			&pgm_err))
+	{
+		fprintf (stderr, "binding PGM socket: %s\n", pgm_err->message);
+		pgm_error_free (pgm_err);
+		pgm_close (sock, FALSE);
+		return NULL;
+	}
+	for (unsigned i = 0; i < res->ai_recv_addrs_len; i++)
+		pgm_setsockopt (sock, IPPROTO_PGM, PGM_JOIN_GROUP, &res->ai_recv_addrs[i], sizeof(struct pgm_group_source_req));
+	pgm_setsockopt (sock, IPPROTO_PGM, PGM_SEND_GROUP, &res->ai_send_addrs[0], sizeof(struct pgm_group_source_req));
+	pgm_setsockopt (sock, IPPROTO_PGM, PGM_NOBLOCK, &nonblocking, sizeof(nonblocking));
+	if (!pgm_connect (sock, &pgm_err)) {
+		fprintf (stderr, "connecting PGM socket: %s\n", pgm_err->message);
+		pgm_error_free (pgm_err);
+		pgm_close (sock, FALSE);
+		return NULL;
+	}
+	return sock;
+}
+
+int
+main (
+	int		argc,
+	char*		argv[]
+	)
+{
+	struct pgm_addrinfo_t* res = NULL;
+	pgm_error_t* pgm_err = NULL;
+	unsigned messages = 20000, size = 200, receivers = 1000, rate = 10000, rxw_sqns = 1024;
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		if (i + 1 == argc || '-' != argv[i][0]) {
+usage:
+			fprintf (stderr, "usage: %s [-n messages] [-s size] [-r receivers] [-m msgs/s] [-l loss%%] [-L shared-loss%%] [-d delay-us] [-b nak-bo-ivl-us] [-w rxw-sqns] [-q inbox-depth]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+		const char* value = argv[++i];
+		switch (argv[i - 1][1]) {
+		case 'n':	messages = (unsigned)strtoul (value, NULL, 10); break;
+		case 's':	size = (unsigned)strtoul (value, NULL, 10); break;
+		case 'r':	receivers = (unsigned)strtoul (value, NULL, 10); break;
+		case 'm':	rate = (unsigned)strtoul (value, NULL, 10); break;
+		case 'l':	storm_loss = (unsigned)(strtod (value, NULL) * 10000.0); break;
+		case 'L':	storm_shared_loss = (unsigned)(strtod (value, NULL) * 10000.0); break;
+		case 'd':	storm_delay = pgm_usecs (strtoul (value, NULL, 10)); break;
+		case 'b':	storm_nak_bo_ivl = pgm_usecs (strtoul (value, NULL, 10)); break;
+		case 'w':	rxw_sqns = (unsigned)strtoul (value, NULL, 10); break;
+		case 'q':	storm_inbox_depth = (unsigned)strtoul (value, NULL, 10); break;
+		default:	goto usage;
+		}
+	}
+	if (0 == messages || size < sizeof(struct storm_header_t) || size > 1024 ||
+	    0 == receivers || 0 == rate || 0 == rxw_sqns || 0 == storm_nak_bo_ivl || 0 == storm_inbox_depth)
+		goto usage;
+
+/* repeat and repair timers follow the one-way delay as loopback_perftest */
+	storm_nak_rpt_ivl   = pgm_msecs (5) + 2 * storm_delay;
+	storm_nak_rdata_ivl = pgm_msecs (10) + 2 * storm_delay;
+
+	unsigned txw_sqns = STORM_MIN_SQNS;
+	while (txw_sqns < messages && txw_sqns < STORM_MAX_SQNS)
+		txw_sqns <<= 1;
+
+	if (!pgm_init (&pgm_err)) {
+		fprintf (stderr, "unable to start PGM engine: %s\n", pgm_err->message);
+		pgm_error_free (pgm_err);
+		return EXIT_FAILURE;
+	}
+	if (!pgm_getaddrinfo (STORM_NETWORK, NULL, &res, &pgm_err)) {
+		fprintf (stderr, "parsing network parameter: %s\n", pgm_err->message);
+		pgm_error_free (pgm_err);
+		pgm_shutdown ();
+		return EXIT_FAILURE;
+	}
+
+/* no datagram reaches the network and no time passes but by the loop below */
+	pgm_net_shim = &storm_shim;
+	storm_now = pgm_time_update_now();
+	storm_saved_clock = pgm_time_update_now;
+	pgm_time_update_now = storm_clock;
+
+	storm_source = storm_create_source (res, txw_sqns);
+	pgm_freeaddrinfo (res);
+	if (NULL == storm_source) {
+		pgm_time_update_now = storm_saved_clock;
+		pgm_shutdown ();
+		return EXIT_FAILURE;
+	}
+
+	storm_receivers_len = receivers;
+	storm_receivers = pgm_new0 (struct storm_receiver_t, receivers);
+	for (unsigned r = 0; r < receivers; r++)
+		storm_receivers[r].window = pgm_rxw_create (&storm_source->tsi, STORM_MAX_TPDU, rxw_sqns, 0, 0, 0, NULL);
+
+	char* buf = pgm_malloc0 (size);
+	char discard[ 4096 ];
+	unsigned sent = 0, completed = 0;
+	uint64_t source_cpu = 0;
+	const pgm_time_t start = storm_now;
+	pgm_time_t last_progress = start;
+
+	while (completed < receivers)
+	{
+		storm_now += STORM_TICK;
+
+/* source: open loop original data at the configured rate, then NAKs */
+		const uint64_t cpu_start = storm_cpu_time();
+		const unsigned due = (unsigned)MIN((uint64_t)messages, (storm_now - start) * rate / pgm_secs (1));
+		while (sent < due) {
+			const struct storm_header_t header = { .tstamp = storm_now, .index_ = sent };
+			memcpy (buf, &header, sizeof(header));
+			if (PGM_IO_STATUS_NORMAL != pgm_send (storm_source, buf, size, NULL))
+				break;
+			sent++;
+		}
+		size_t bytes_read;
+		for (unsigned spins = 0; spins < STORM_BURST; spins++) {
+			const int status = pgm_recv (storm_source, discard, sizeof(discard), 0, &bytes_read, NULL);
+			if (PGM_IO_STATUS_NORMAL != status && NULL == storm_queue_peek (&storm_inbox))
+				break;
+		}
+		source_cpu += storm_cpu_time() - cpu_start;
+
+/* network */
+		struct storm_datagram_t* datagram;
+		while (NULL != (datagram = storm_queue_peek (&storm_downstream))) {
+			storm_fanout (datagram);
+			storm_queue_pop (&storm_downstream);
+		}
+
+/* virtual receivers */
+		completed = 0;
+		for (unsigned r = 0; r < receivers; r++) {
+			struct storm_receiver_t* receiver = &storm_receivers[r];
+			storm_nak_state (receiver, r);
+			if (receiver->is_pending) {
+				const unsigned delivered = receiver->delivered;
+				storm_receive (receiver, messages);
+				if (delivered != receiver->delivered)
+					last_progress = storm_now;
+			}
+			if (receiver->is_complete)
+				completed++;
+		}
+		if (sent < messages)
+			last_progress = storm_now;
+		else if (pgm_time_after (storm_now, last_progress + STORM_IDLE_TIMEOUT)) {
+			fprintf (stderr, "no progress for %u virtual seconds, %u of %u receivers complete.\n",
+				 (unsigned)(STORM_IDLE_TIMEOUT / pgm_secs (1)), completed, receivers);
+			break;
+		}
+	}
+
+	const bool is_stalled = (completed < receivers);
+	const pgm_time_t elapsed = storm_now - start;
+	const double secs = pgm_to_secsf (elapsed);
+	uint64_t delivered = 0, unrecovered = 0;
+	for (unsigned r = 0; r < receivers; r++) {
+		delivered += storm_receivers[r].delivered;
+		unrecovered += storm_receivers[r].window->cumulative_losses;
+	}
+	qsort (storm_repairs, storm_repairs_len, sizeof(uint32_t), storm_compare_time);
+#define PERCENTILE(p)	(storm_repairs_len ? storm_repairs[ (size_t)((storm_repairs_len - 1) * (p)) ] : 0)
+	printf ("{\"receivers\":%u,\"messages\":%u,\"size\":%u,\"msgs_per_sec\":%u,\"loss_pct\":%.4f,\"shared_loss_pct\":%.4f,"
+		"\"delay_us\":%" PGM_TIME_FORMAT ",\"nak_bo_ivl_us\":%" PGM_TIME_FORMAT ",\"stalled\":%s,\"virtual_us\":%" PGM_TIME_FORMAT ","
+		"\"odata\":%u,\"lost\":%u,\"shared_lost\":%u,\"naks\":%u,\"nak_sqns\":%u,\"naks_lost\":%u,\"naks_dropped\":%u,"
+		"\"ncfs\":%u,\"rdata\":%u,\"spms\":%u,\"naks_per_sec\":%.0f,\"ncf_per_sec\":%.0f,\"rdata_per_sec\":%.0f,"
+		"\"source_cpu_us\":%" PRIu64 ",\"source_cpu_pct\":%.2f,\"delivered\":%" PRIu64 ",\"repairs\":%" PRIu64 ",\"unrecovered\":%" PRIu64 ","
+		"\"repair_us\":{\"p50\":%u,\"p90\":%u,\"p99\":%u,\"max\":%u}}\n",
+		receivers, messages, size, rate, storm_loss / 10000.0, storm_shared_loss / 10000.0,
+		pgm_to_usecs (storm_delay), pgm_to_usecs (storm_nak_bo_ivl), is_stalled ? "true" : "false", pgm_to_usecs (elapsed),
+		storm_odata, storm_lost, storm_shared_lost, storm_naks, storm_nak_sqns, storm_naks_lost, storm_naks_dropped,
+		storm_ncfs, storm_rdata, storm_spms,
+		secs > 0 ? storm_naks / secs : 0.0, secs > 0 ? storm_ncfs / secs : 0.0, secs > 0 ? storm_rdata / secs : 0.0,
+		source_cpu / 1000, secs > 0 ? source_cpu / (secs * 1e7) : 0.0, delivered, (uint64_t)storm_repairs_len, unrecovered,
+		PERCENTILE(0.5), PERCENTILE(0.9), PERCENTILE(0.99), PERCENTILE(1.0));
+#undef PERCENTILE
+
+	for (unsigned r = 0; r < receivers; r++) {
+		pgm_rxw_destroy (storm_receivers[r].window);
+		pgm_free (storm_receivers[r].lost);
+	}
+	pgm_free (storm_receivers);
+	pgm_close (storm_source, FALSE);
+	storm_queue_free (&storm_downstream);
+	storm_queue_free (&storm_inbox);
+	pgm_net_shim = NULL;
+	pgm_time_update_now = storm_saved_clock;
+	pgm_free (storm_repairs);
+	pgm_free (buf);
+	pgm_shutdown ();
+	return is_stalled ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/* eof */
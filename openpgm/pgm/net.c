@@ -22,39 +22,552 @@
 #ifdef HAVE_CONFIG_H
 #	include <config.h>
 #endif
+
+#ifndef _GNU_SOURCE
+#	define _GNU_SOURCE
+#endif
+
 #include <errno.h>
 #ifdef HAVE_POLL
 #	include <poll.h>
 #endif
+#ifdef __linux__
+#	include <sys/ioctl.h>
+#	include <linux/sockios.h>
+#endif
 #ifndef _WIN32
 #	include <sys/socket.h>
 #	include <netinet/in.h>
+#	include <netinet/udp.h>
 #	include <arpa/inet.h>
 #endif
 #include <impl/i18n.h>
 #include <impl/framework.h>
 #include <impl/net.h>
 #include <impl/socket.h>
+#include <impl/timer.h>
 
 #include "impl/net_os.h"
 
 //#define NET_DEBUG
 
 
-/* locked and rate regulated sendto
+/* in-memory transport, NULL for the network */
+const struct pgm_net_shim_t*	pgm_net_shim PGM_GNUC_READ_MOSTLY = NULL;
+
+
+/* wait up to 500ms for a blocked send socket to clear.
+ *
+ * returns count of ready sockets, 0 on timeout, or -1 on error.
+ */
+
+static
+int
+wait_for_send (
+	const SOCKET		send_sock
+	)
+{
+#ifdef HAVE_POLL
+/* poll for cleared socket */
+	struct pollfd p = {
+		.fd		= send_sock,
+		.events		= POLLOUT,
+		.revents	= 0
+	};
+	return poll (&p, 1, 500 /* ms */);
+#else
+	fd_set writefds;
+	FD_ZERO(&writefds);
+	FD_SET(send_sock, &writefds);
+#	ifndef _WIN32
+	const int n_fds = send_sock + 1;	/* largest fd + 1 */
+#	else
+	const int n_fds = 1;			/* count of fds */
+#	endif
+	struct timeval tv = {
+		.tv_sec  = 0,
+		.tv_usec = 500 /* ms */ * 1000
+	};
+	return select (n_fds, NULL, &writefds, NULL, &tv);
+#endif /* HAVE_POLL */
+}
+
+/* bounds of the wait after the kernel refuses a datagram with ENOBUFS */
+#define PGM_TX_BACKOFF_MIN_IVL		100		/* us */
+#define PGM_TX_BACKOFF_MAX_IVL		pgm_msecs (10)
+
+/* estimate when the device queue refusing datagrams with ENOBUFS drains.  the
+ * unsent bytes of the socket at the regulated rate where both are known,
+ * otherwise back off exponentially over repeated refusals.
+ */
+
+static
+void
+tx_backoff (
+	pgm_sock_t* const	sock,
+	const SOCKET		send_sock
+	)
+{
+	pgm_time_t ivl = 0;
+#ifdef SIOCOUTQ
+	int queued = 0;
+	if (sock->txw_max_rte > 0 &&
+	    0 == ioctl (send_sock, SIOCOUTQ, &queued) && queued > 0)
+		ivl = ((pgm_time_t)queued * pgm_secs (1)) / (pgm_time_t)sock->txw_max_rte;
+#else
+	(void)send_sock;
+#endif
+	if (0 == ivl)
+		ivl = sock->tx_backoff_ivl * 2;
+	ivl = MIN(MAX(ivl, PGM_TX_BACKOFF_MIN_IVL), PGM_TX_BACKOFF_MAX_IVL);
+	sock->tx_backoff_ivl = ivl;
+	sock->tx_writable = pgm_time_update_now() + ivl;
+	pgm_debug ("ENOBUFS, send queue estimated clear in %" PGM_TIME_FORMAT " us", ivl);
+}
+
+/* returns TRUE once the device queue is estimated clear, yielding on blocking
+ * sockets, returns FALSE on a non-blocking socket with time remaining.
+ */
+
+static
+bool
+tx_wait (
+	pgm_sock_t* const	sock
+	)
+{
+	const pgm_time_t writable = sock->tx_writable;
+	if (0 == writable || pgm_time_update_now() >= writable)
+		return TRUE;
+	if (sock->is_nonblocking)
+		return FALSE;
+	while (pgm_time_update_now() < writable)
+		pgm_thread_yield();
+	return TRUE;
+}
+
+/* forget the backoff on the first accepted datagram */
+
+static inline
+void
+tx_clear (
+	pgm_sock_t* const	sock
+	)
+{
+	if (PGM_UNLIKELY(0 != sock->tx_writable)) {
+		sock->tx_writable = 0;
+		sock->tx_backoff_ivl = 0;
+	}
+}
+
+/* record one sent datagram in the capture ring.
+ */
+
+static inline
+void
+capture_sent (
+	pgm_sock_t*	       const restrict sock,
+	const void*		     restrict buf,
+	const size_t			      len,
+	const struct sockaddr*	     restrict to
+	)
+{
+	const bool is_udp_encap = (0 != sock->udp_encap_ucast_port);
+	pgm_capture_packet (sock->capture, TRUE, buf, len, FALSE,
+			    (const struct sockaddr*)&sock->send_addr, to,
+			    is_udp_encap ? pgm_htons (sock->udp_encap_ucast_port) : 0,
+			    is_udp_encap ? pgm_sockaddr_port (to) : 0);
+}
+
+/* datagram refused above the path MTU learnt from ICMP fragmentation needed.
+ * windows and pools are sized at bind so max_tpdu cannot shrink, record the
+ * path MTU and let the kernel fragment datagrams thereafter.
+ *
+ * returns TRUE to resend the datagram.
+ */
+
+static
+bool
+tx_msgsize (
+	pgm_sock_t*	       const restrict sock,
+	const struct sockaddr*	     restrict to,
+	const socklen_t			      tolen
+	)
+{
+	if (PGM_PMTUD_INTERFACE != sock->pmtud_mode)
+		return FALSE;
+	sock->pmtud_mode = PGM_PMTUD_DISABLED;
+
+/* the kernel reports the path MTU of a socket connected to the destination */
+	int mtu = SOCKET_ERROR;
+	const SOCKET s = socket (to->sa_family, SOCK_DGRAM, 0);
+	if (INVALID_SOCKET != s) {
+		if (pgm_sockaddr_is_addr_multicast (to))
+			(void)pgm_sockaddr_multicast_if (s, (const struct sockaddr*)&sock->send_addr, sock->send_gsr.gsr_interface);
+		if (0 == connect (s, to, tolen))
+			mtu = pgm_sockaddr_path_mtu (s, to->sa_family);
+		closesocket (s);
+	}
+	if (mtu > 0)
+		pgm_atomic_write32 (&sock->path_mtu, (uint32_t)mtu);
+	(void)pgm_sockaddr_pmtudisc (sock->send_sock, sock->family, PGM_PMTUD_DISABLED);
+	(void)pgm_sockaddr_pmtudisc (sock->send_with_router_alert_sock, sock->family, PGM_PMTUD_DISABLED);
+	pgm_warn (_("Path MTU %d below maximum TPDU of %u bytes, fragmenting datagrams."),
+		  mtu, (unsigned)sock->max_tpdu);
+	return TRUE;
+}
+
+#if !defined(_WIN32) && defined(IP_TTL) && defined(IPV6_HOPLIMIT) && defined(IP_TOS) && defined(IPV6_TCLASS)
+#	define PGM_HAVE_HOPS_CMSG	1
+
+/* unlocked send of one datagram carrying the hop limit and traffic class as
+ * ancillary data, replacing a setsockopt() either side of the send.
  *
  * on success, returns number of bytes sent.  on error, -1 is returned, and
  * errno set appropriately.
  */
 
+static
+ssize_t
+send_cmsg (
+	const SOCKET			send_sock,
+	const sa_family_t		family,
+	const int			hops,		/* -1 == socket default */
+	const int			tos,		/* -1 == socket default */
+	const void*	       restrict	buf,
+	const size_t			len,
+	const struct sockaddr* restrict	to,
+	const socklen_t			tolen
+	)
+{
+	struct iovec iov = {
+		.iov_base	= pgm_send_ptr (buf),
+		.iov_len	= len
+	};
+	char control[ 2 * CMSG_SPACE(sizeof(int)) ];
+	memset (control, 0, sizeof(control));
+	struct msghdr msg = {
+		.msg_name	= pgm_send_ptr (to),
+		.msg_namelen	= tolen,
+		.msg_iov	= &iov,
+		.msg_iovlen	= 1,
+		.msg_control	= control,
+		.msg_controllen	= ((-1 != hops) + (-1 != tos)) * CMSG_SPACE(sizeof(int)),
+		.msg_flags	= 0
+	};
+	struct cmsghdr* cmsg	= CMSG_FIRSTHDR(&msg);
+	if (-1 != hops) {
+		cmsg->cmsg_level	= (AF_INET6 == family) ? IPPROTO_IPV6 : IPPROTO_IP;
+		cmsg->cmsg_type		= (AF_INET6 == family) ? IPV6_HOPLIMIT : IP_TTL;
+		cmsg->cmsg_len		= CMSG_LEN(sizeof(int));
+		memcpy (CMSG_DATA(cmsg), &hops, sizeof(int));
+		cmsg = CMSG_NXTHDR(&msg, cmsg);
+	}
+	if (-1 != tos) {
+		cmsg->cmsg_level	= (AF_INET6 == family) ? IPPROTO_IPV6 : IPPROTO_IP;
+		cmsg->cmsg_type		= (AF_INET6 == family) ? IPV6_TCLASS : IP_TOS;
+		cmsg->cmsg_len		= CMSG_LEN(sizeof(int));
+		memcpy (CMSG_DATA(cmsg), &tos, sizeof(int));
+	}
+	return sendmsg (send_sock, &msg, 0);
+}
+#endif /* IP_TTL */
+
+/* destination for the system call, NULL for the send group on the connected
+ * data socket so the kernel reuses the cached route.  callers pass the group as
+ * &sock->send_gsr.gsr_group.
+ */
+
+static inline
+const struct sockaddr*
+send_dest (
+	const pgm_sock_t*      const restrict sock,
+	const SOCKET			      send_sock,
+	const struct sockaddr*	     restrict to,
+	socklen_t*		     restrict tolen
+	)
+{
+#ifdef PGM_HAVE_CONNECTED_SEND
+	if (sock->is_send_connected &&
+	    send_sock == sock->send_sock &&
+	    to == (const struct sockaddr*)&sock->send_gsr.gsr_group)
+	{
+		*tolen = 0;
+		return NULL;
+	}
+#endif
+	return to;
+}
+
+/* data socket of ODATA or RDATA under PGM_PORTS_PER_TG, each transmission
+ * group takes the next PGM_SEND_PORTS socket so receive side scaling hashes
+ * the groups of one source onto different queues.
+ */
+
+static inline
+SOCKET
+send_port (
+	const pgm_sock_t*      const restrict sock,
+	const void*		     restrict buf,
+	const size_t			      len
+	)
+{
+	const struct pgm_header* header = buf;
+	if (len < sizeof(struct pgm_header) + sizeof(struct pgm_data) ||
+	    (PGM_ODATA != header->pgm_type && PGM_RDATA != header->pgm_type))
+		return sock->send_sock;
+	const struct pgm_data* data = (const struct pgm_data*)(header + 1);
+	const unsigned tg_sqn_shift = sock->tg_sqn_shift ? sock->tg_sqn_shift : pgm_power2_log2 (PGM_PORTS_TG_SQNS);
+	const uint32_t i = (pgm_ntohl (data->data_sqn) >> tg_sqn_shift) % (1 + sock->send_port_len);
+	return (0 == i) ? sock->send_sock : sock->send_port_sock[ i - 1 ];
+}
+
+/* data socket of one datagram, PGM_PATH_STRIPE rotates datagrams to the send
+ * group across the bound interface and each PGM_SEND_PATHS interface.
+ */
+
+static inline
+SOCKET
+send_path (
+	pgm_sock_t*	       const restrict sock,
+	const void*		     restrict buf,
+	const size_t			      len,
+	const struct sockaddr*	     restrict to
+	)
+{
+	if (PGM_UNLIKELY(0 != sock->send_port_len) &&
+	    to == (const struct sockaddr*)&sock->send_gsr.gsr_group)
+		return send_port (sock, buf, len);
+	if (PGM_LIKELY(0 == sock->send_path_len) ||
+	    PGM_PATH_STRIPE != sock->send_path_mode ||
+	    to != (const struct sockaddr*)&sock->send_gsr.gsr_group)
+		return sock->send_sock;
+	const uint32_t i = pgm_atomic_exchange_and_add32 (&sock->send_path_next, 1) % (1 + sock->send_path_len);
+	return (0 == i) ? sock->send_sock : sock->send_path_sock[ i - 1 ];
+}
+
+/* returns TRUE if datagrams to the send group are repeated on each PGM_SEND_PATHS
+ * interface.
+ */
+
+static inline
+bool
+is_send_duplicate (
+	const pgm_sock_t*      const restrict sock,
+	const bool			      use_router_alert,
+	const struct sockaddr*	     restrict to
+	)
+{
+	return (PGM_UNLIKELY(0 != sock->send_path_len) &&
+		PGM_PATH_DUPLICATE == sock->send_path_mode &&
+		!use_router_alert &&
+		to == (const struct sockaddr*)&sock->send_gsr.gsr_group &&
+		NULL == pgm_net_shim);
+}
+
+/* returns TRUE if datagrams to the send group are replicated to each
+ * PGM_UNICAST_FANOUT receiver in place of the group.
+ */
+
+static inline
+bool
+is_send_fanout (
+	const pgm_sock_t*      const restrict sock,
+	const struct sockaddr*	     restrict to
+	)
+{
+	return (PGM_UNLIKELY(0 != sock->fanout_req.fr_len) &&
+		to == (const struct sockaddr*)&sock->send_gsr.gsr_group);
+}
+
+/* messages of one fan-out system call */
+#define PGM_FANOUT_BATCH		64
+
+/* send a vector of datagrams to every PGM_UNICAST_FANOUT receiver, each message
+ * of the system call referencing the caller's buffer so that a datagram is
+ * framed and checksummed once whatever the number of receivers.  a receiver
+ * refusing a datagram is passed over for the next.
+ *
+ * returns count if any receiver took a datagram, on error returns -1 and errno
+ * set from the last failure.
+ */
+
+static
+int
+send_fanout (
+	pgm_sock_t*	       restrict	sock,
+	const SOCKET			send_sock,
+	const struct pgm_iovec* restrict vector,
+	const unsigned			count
+	)
+{
+	const struct pgm_fanout_req_t* fr = &sock->fanout_req;
+	const unsigned total = count * fr->fr_len;
+	unsigned i = 0, accepted = 0;
+	int save_errno = 0;
+
+	if (PGM_UNLIKELY(NULL != pgm_net_shim)) {
+		for (i = 0; i < total; i++) {
+			const struct sockaddr* to = (const struct sockaddr*)&fr->fr_addr[ i % fr->fr_len ];
+			const struct pgm_iovec* iov = &vector[ i / fr->fr_len ];
+			if (pgm_net_shim->sendto (pgm_net_shim->user_data, sock, iov->iov_base, iov->iov_len, to, pgm_sockaddr_len (to)) >= 0)
+				accepted++;
+			else
+				save_errno = pgm_get_last_sock_error();
+		}
+	}
+	else
+	{
+#ifdef HAVE_SENDMMSG
+		struct mmsghdr msgvec[ PGM_FANOUT_BATCH ];
+		while (i < total) {
+			const unsigned len = MIN(total - i, PGM_FANOUT_BATCH);
+			memset (msgvec, 0, len * sizeof(struct mmsghdr));
+			for (unsigned j = 0; j < len; j++) {
+				const struct sockaddr* to = (const struct sockaddr*)&fr->fr_addr[ (i + j) % fr->fr_len ];
+				msgvec[j].msg_hdr.msg_name	= pgm_send_ptr (to);
+				msgvec[j].msg_hdr.msg_namelen	= pgm_sockaddr_len (to);
+				msgvec[j].msg_hdr.msg_iov	= pgm_send_ptr (&vector[ (i + j) / fr->fr_len ]);
+				msgvec[j].msg_hdr.msg_iovlen	= 1;
+			}
+			const int sent = sendmmsg (send_sock, msgvec, len, 0);
+			if (sent > 0) {
+				accepted += sent;
+				i += sent;
+			} else {
+/* the first message failed, skip its receiver */
+				save_errno = pgm_get_last_sock_error();
+				i++;
+			}
+		}
+#else
+		for (i = 0; i < total; i++) {
+			const struct sockaddr* to = (const struct sockaddr*)&fr->fr_addr[ i % fr->fr_len ];
+			const struct pgm_iovec* iov = &vector[ i / fr->fr_len ];
+			if ((*priv_sendto)(send_sock, iov->iov_base, iov->iov_len, 0, to, pgm_sockaddr_len (to)) >= 0)
+				accepted++;
+			else
+				save_errno = pgm_get_last_sock_error();
+		}
+#endif
+	}
+	if (PGM_UNLIKELY(0 == accepted)) {
+		pgm_set_last_sock_error (save_errno);
+		return -1;
+	}
+	return (int)count;
+}
+
+/* returns TRUE if sends on the data socket must hold sock::send_mutex.  a
+ * datagram send is atomic, the mutex is only needed whilst socket state is
+ * changed around it: a hop limit set with setsockopt(), the registered send
+ * buffers, or an in-memory transport.  otherwise ODATA, RDATA, SPMs and NCFs
+ * from the application and timer threads are sent concurrently.  never
+ * for PGM_SINGLE_THREADED sockets.
+ *
+ * evaluate once per send as sock::use_hops_cmsg may clear within it.
+ */
+
+static inline
+bool
+is_send_locked (
+	const pgm_sock_t* const	sock,
+	const bool		use_router_alert
+	)
+{
+	if (use_router_alert || !sock->can_send_data || sock->is_single_threaded)
+		return FALSE;
+#ifdef PGM_HAVE_HOPS_CMSG
+	return (!sock->use_hops_cmsg ||
+		&default_sendto != priv_sendto ||
+		NULL != pgm_net_shim);
+#else
+	return TRUE;
+#endif
+}
+
+/* send transmit datagrams held by test impairment and due by now, flagged for
+ * the router alert socket, with the socket hop limit and traffic class.
+ */
+
 PGM_GNUC_INTERNAL
+void
+pgm_sendto_impaired (
+	pgm_sock_t* const	sock,
+	const pgm_time_t	now
+	)
+{
+	struct sockaddr_storage to;
+	bool use_router_alert;
+	size_t len;
+	char buf[ sock->max_tpdu ];
+
+	while (0 != (len = pgm_impair_release (sock->tx_impair, now, buf, sizeof (buf), NULL, &to, &use_router_alert)))
+	{
+		const SOCKET send_sock = use_router_alert ? sock->send_with_router_alert_sock : sock->send_sock;
+		const socklen_t tolen = pgm_sockaddr_len ((struct sockaddr*)&to);
+		const bool is_locked = is_send_locked (sock, use_router_alert);
+		if (is_locked)
+			pgm_mutex_lock (&sock->send_mutex);
+		ssize_t sent;
+		if (PGM_UNLIKELY(0 != sock->fanout_req.fr_len) &&
+		    0 == pgm_sockaddr_cmp ((struct sockaddr*)&to, (struct sockaddr*)&sock->send_gsr.gsr_group))
+		{
+			const struct pgm_iovec iov = { .iov_base = buf, .iov_len = len };
+			sent = (send_fanout (sock, send_sock, &iov, 1) < 0) ? (ssize_t)-1 : (ssize_t)len;
+		}
+		else
+			sent = PGM_UNLIKELY(NULL != pgm_net_shim) ?
+				pgm_net_shim->sendto (pgm_net_shim->user_data, sock, buf, len, (struct sockaddr*)&to, tolen) :
+				(*priv_sendto)(send_sock, buf, len, 0, (struct sockaddr*)&to, tolen);
+		if (PGM_UNLIKELY(NULL != sock->capture) && sent > 0)
+			capture_sent (sock, buf, (size_t)sent, (struct sockaddr*)&to);
+		if (is_locked)
+			pgm_mutex_unlock (&sock->send_mutex);
+	}
+}
+
+/* pull the next timer poll forward to the first held transmit datagram, waking
+ * the rx or timer thread.
+ */
+
+static
+void
+tx_impair_wake (
+	pgm_sock_t* const	sock
+	)
+{
+	const pgm_time_t expiry = pgm_impair_expiry (sock->tx_impair);
+	if (0 == expiry)
+		return;
+	pgm_timer_lock (sock);
+	if (pgm_time_after (sock->next_poll, expiry))
+	{
+		sock->next_poll = expiry;
+		if (!sock->is_pending_read) {
+			pgm_notify_send (&sock->pending_notify);
+			sock->is_pending_read = TRUE;
+		}
+		if (sock->use_timer_thread)
+			pgm_notify_send (&sock->timer_notify);
+	}
+	pgm_timer_unlock (sock);
+}
+
+/* rate regulated sendto, locked only as is_send_locked()
+ *
+ * on success, returns number of bytes sent.  on error, -1 is returned, and
+ * errno set appropriately.
+ */
+
+static
 ssize_t
-pgm_sendto_hops (
+sendto_cmsg (
 	pgm_sock_t*	       restrict	sock,
 	bool				use_rate_limit,
 	pgm_rate_t*	       restrict	minor_rate_control,
 	bool				use_router_alert,
 	int				hops,			/* -1 == system default */
+	int				tos,			/* -1 == socket default */
 	const void*	       restrict	buf,
 	size_t				len,
 	const struct sockaddr* restrict	to,
@@ -82,7 +595,15 @@ pgm_sendto_hops (
 		(int)tolen);
 #endif
 
-	const SOCKET send_sock = use_router_alert ? sock->send_with_router_alert_sock : sock->send_sock;
+	const SOCKET send_sock = use_router_alert ? sock->send_with_router_alert_sock : send_path (sock, buf, len, to);
+	socklen_t dstlen = tolen;
+	const struct sockaddr* dst = send_dest (sock, send_sock, to, &dstlen);
+
+/* hold back whilst the device queue is estimated full */
+	if (PGM_UNLIKELY(0 != sock->tx_writable) && !tx_wait (sock)) {
+		pgm_set_last_sock_error (PGM_SOCK_ENOBUFS);
+		return (const ssize_t)-1;
+	}
 
 	if (use_rate_limit)
 	{
@@ -104,45 +625,153 @@ pgm_sendto_hops (
 		}
 	}
 
-	if (!use_router_alert && sock->can_send_data)
-		pgm_mutex_lock (&sock->send_mutex);
-	if (-1 != hops)
-		pgm_sockaddr_multicast_hops (send_sock, sock->send_gsr.gsr_group.ss_family, hops);
+/* test impairment draws loss, duplication and delay per datagram, a lost or held
+ * datagram is reported as sent.
+ */
+	if (PGM_UNLIKELY(NULL != sock->tx_impair))
+	{
+		pgm_sendto_impaired (sock, pgm_time_update_now());
+		const bool is_passed = pgm_impair_apply (sock->tx_impair, buf, len, NULL, to, use_router_alert);
+		tx_impair_wake (sock);
+		if (!is_passed)
+			return (ssize_t)len;
+	}
 
-	ssize_t sent = (*priv_sendto)(send_sock, buf, len, 0, to, (socklen_t)tolen);
+	bool is_locked = is_send_locked (sock, use_router_alert);
+	if (is_locked)
+		pgm_mutex_lock (&sock->send_mutex);
+/* unicast receivers take the datagram in place of the send group */
+	if (is_send_fanout (sock, to)) {
+		const struct pgm_iovec iov = { .iov_base = pgm_send_ptr (buf), .iov_len = len };
+		const ssize_t sent = (send_fanout (sock, send_sock, &iov, 1) < 0) ? (ssize_t)-1 : (ssize_t)len;
+		if (sent >= 0)
+			tx_clear (sock);
+		if (PGM_UNLIKELY(NULL != sock->capture) && sent > 0)
+			capture_sent (sock, buf, (size_t)sent, to);
+		if (is_locked)
+			pgm_mutex_unlock (&sock->send_mutex);
+		return sent;
+	}
+	if (PGM_UNLIKELY(NULL != pgm_net_shim)) {
+		const ssize_t sent = pgm_net_shim->sendto (pgm_net_shim->user_data, sock, buf, len, to, tolen);
+		if (is_locked)
+			pgm_mutex_unlock (&sock->send_mutex);
+		return sent;
+	}
+#ifdef HAVE_RTE_ETHDEV_H
+/* every IPv4 datagram is framed onto the ethdev queue, falling back to the socket
+ * whilst the link address of a unicast peer is unresolved or the queue is full.
+ */
+	if (NULL != sock->dpdk)
+	{
+		const struct pgm_iovec iov = { .iov_base = (void*)buf, .iov_len = len };
+		if (pgm_dpdk_sendv (sock->dpdk, to, hops, tos, use_router_alert, &iov, 1) > 0) {
+			if (PGM_UNLIKELY(NULL != sock->capture))
+				capture_sent (sock, buf, len, to);
+			if (is_locked)
+				pgm_mutex_unlock (&sock->send_mutex);
+			return (ssize_t)len;
+		}
+	}
+#endif
+#ifdef HAVE_INFINIBAND_VERBS_H
+/* datagrams to the send group at the socket hop limit and traffic class are posted to
+ * the RDMA queue pair, falling back to the socket whilst every work request is outstanding.
+ */
+	if (NULL != sock->verbs && -1 == hops && -1 == tos &&
+	    to == (const struct sockaddr*)&sock->send_gsr.gsr_group)
+	{
+		const struct pgm_iovec iov = { .iov_base = pgm_send_ptr (buf), .iov_len = len };
+		if (pgm_verbs_sendv (sock->verbs, &iov, 1) > 0) {
+			if (PGM_UNLIKELY(NULL != sock->capture))
+				capture_sent (sock, buf, len, to);
+			if (is_locked)
+				pgm_mutex_unlock (&sock->send_mutex);
+			return (ssize_t)len;
+		}
+	}
+#endif
+	ssize_t sent;
+	bool is_hops_cmsg = FALSE;
+#ifdef PGM_HAVE_HOPS_CMSG
+/* one system call where the kernel accepts a per-datagram hop limit and traffic class */
+	if ((-1 != hops || -1 != tos) && sock->use_hops_cmsg && &default_sendto == priv_sendto)
+	{
+		sent = send_cmsg (send_sock, sock->family, hops, tos, buf, len, dst, dstlen);
+		if (sent < 0 && EINVAL == pgm_get_last_sock_error()) {
+			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Per-datagram hop limit or traffic class not supported by kernel, disabling."));
+			sock->use_hops_cmsg = FALSE;
+/* the socket hop limit is now shared state */
+			if (!is_locked && !use_router_alert && sock->can_send_data && !sock->is_single_threaded) {
+				pgm_mutex_lock (&sock->send_mutex);
+				is_locked = TRUE;
+			}
+		} else
+			is_hops_cmsg = TRUE;
+	}
+#endif
+	if (!is_hops_cmsg)
+	{
+		if (-1 != hops)
+			pgm_sockaddr_multicast_hops (send_sock, sock->send_gsr.gsr_group.ss_family, hops);
+		if (-1 != tos)
+			pgm_sockaddr_tos (send_sock, sock->family, tos);
+#ifdef PGM_HAVE_RIO
+/* registered send buffers are serialised by send_mutex, fall back to the socket
+ * call when every buffer is in flight.
+ */
+		if (NULL != sock->rio && is_locked && -1 == hops && -1 == tos) {
+			sent = pgm_rio_sendto (sock->rio, buf, len, to, (socklen_t)tolen);
+			if (sent < 0 && PGM_SOCK_EAGAIN == pgm_get_last_sock_error())
+				sent = (*priv_sendto)(send_sock, buf, len, 0, to, (socklen_t)tolen);
+		} else
+#endif
+		sent = (*priv_sendto)(send_sock, buf, len, 0, dst, (socklen_t)dstlen);
+	}
 	pgm_debug ("sendto returned %" PRIzd, sent);
 	if (sent < 0) {
 		int save_errno = pgm_get_last_sock_error();
-		if (PGM_UNLIKELY(save_errno != PGM_SOCK_ENETUNREACH &&	/* Network is unreachable */
+/* device queue full, the socket polls writable so wait for the estimated drain */
+		if (PGM_SOCK_ENOBUFS == save_errno)
+		{
+			tx_backoff (sock, send_sock);
+			if (!tx_wait (sock))
+				pgm_set_last_sock_error (PGM_SOCK_ENOBUFS);
+			else {
+#ifdef PGM_HAVE_HOPS_CMSG
+				if (is_hops_cmsg)
+					sent = send_cmsg (send_sock, sock->family, hops, tos, buf, len, dst, dstlen);
+				else
+#endif
+				sent = (*priv_sendto)(send_sock, buf, len, 0, dst, (socklen_t)dstlen);
+				if (sent < 0 && PGM_SOCK_ENOBUFS == pgm_get_last_sock_error())
+					tx_backoff (sock, send_sock);
+			}
+		}
+		else if (PGM_SOCK_EMSGSIZE == save_errno)
+		{
+			if (tx_msgsize (sock, to, tolen)) {
+#ifdef PGM_HAVE_HOPS_CMSG
+				if (is_hops_cmsg)
+					sent = send_cmsg (send_sock, sock->family, hops, tos, buf, len, dst, dstlen);
+				else
+#endif
+				sent = (*priv_sendto)(send_sock, buf, len, 0, dst, (socklen_t)dstlen);
+			}
+		}
+		else if (PGM_UNLIKELY(save_errno != PGM_SOCK_ENETUNREACH &&	/* Network is unreachable */
 		 		 save_errno != PGM_SOCK_EHOSTUNREACH &&	/* No route to host */
 		    		 save_errno != PGM_SOCK_EAGAIN))	/* would block on non-blocking send */
 		{
-#ifdef HAVE_POLL
-/* poll for cleared socket */
-			struct pollfd p = {
-				.fd		= send_sock,
-				.events		= POLLOUT,
-				.revents	= 0
-			};
-			const int ready = poll (&p, 1, 500 /* ms */);
-#else
-			fd_set writefds;
-			FD_ZERO(&writefds);
-			FD_SET(send_sock, &writefds);
-#	ifndef _WIN32
-			const int n_fds = send_sock + 1;	/* largest fd + 1 */
-#	else
-			const int n_fds = 1;			/* count of fds */
-#	endif
-			struct timeval tv = {
-				.tv_sec  = 0,
-				.tv_usec = 500 /* ms */ * 1000
-			};
-			const int ready = select (n_fds, NULL, &writefds, NULL, &tv);
-#endif /* HAVE_POLL */
+			const int ready = wait_for_send (send_sock);
 			if (ready > 0)
 			{
-				sent = (*priv_sendto)(send_sock, buf, len, 0, to, (socklen_t)tolen);
+#ifdef PGM_HAVE_HOPS_CMSG
+				if (is_hops_cmsg)
+					sent = send_cmsg (send_sock, sock->family, hops, tos, buf, len, dst, dstlen);
+				else
+#endif
+				sent = (*priv_sendto)(send_sock, buf, len, 0, dst, (socklen_t)dstlen);
 				if ( sent < 0 )
 				{
 					char errbuf[1024];
@@ -169,15 +798,483 @@ pgm_sendto_hops (
 			}
 		}
 	}
+	if (sent >= 0)
+		tx_clear (sock);
+/* redundant paths carry the socket hop limit and traffic class unless sent as
+ * ancillary data, the datagram is sent once any path takes it.
+ */
+	if (is_send_duplicate (sock, use_router_alert, to))
+	{
+		for (unsigned i = 0; i < sock->send_path_len; i++)
+		{
+			ssize_t path_sent;
+#ifdef PGM_HAVE_HOPS_CMSG
+			if (is_hops_cmsg)
+				path_sent = send_cmsg (sock->send_path_sock[i], sock->family, hops, tos, buf, len, to, tolen);
+			else
+#endif
+			path_sent = (*priv_sendto)(sock->send_path_sock[i], buf, len, 0, to, (socklen_t)tolen);
+			if (sent < 0 && path_sent >= 0)
+				sent = path_sent;
+		}
+	}
+	if (PGM_UNLIKELY(NULL != sock->capture) && sent > 0)
+		capture_sent (sock, buf, (size_t)sent, to);
 
-/* revert to default value hop limit */
-	if (-1 != hops)
+/* revert to default value hop limit and traffic class */
+	if (-1 != hops && !is_hops_cmsg)
 		pgm_sockaddr_multicast_hops (send_sock, sock->send_gsr.gsr_group.ss_family, sock->hops);
-	if (!use_router_alert && sock->can_send_data)
+	if (-1 != tos && !is_hops_cmsg)
+		pgm_sockaddr_tos (send_sock, sock->family, sock->tos);
+	if (is_locked)
 		pgm_mutex_unlock (&sock->send_mutex);
 	return sent;
 }
 
+PGM_GNUC_INTERNAL
+ssize_t
+pgm_sendto_hops (
+	pgm_sock_t*	       restrict	sock,
+	bool				use_rate_limit,
+	pgm_rate_t*	       restrict	minor_rate_control,
+	bool				use_router_alert,
+	int				hops,			/* -1 == system default */
+	const void*	       restrict	buf,
+	size_t				len,
+	const struct sockaddr* restrict	to,
+	socklen_t			tolen
+	)
+{
+	PGM_PROFILE_BEGIN (sendto_start);
+	const ssize_t sent = sendto_cmsg (sock, use_rate_limit, minor_rate_control, use_router_alert, hops, -1, buf, len, to, tolen);
+	PGM_PROFILE_END (PGM_PROFILE_SENDTO, sendto_start, sent >= 0);
+	return sent;
+}
+
+/* as pgm_sendto() with the traffic class of one datagram, IP_TOS or IPV6_TCLASS.
+ */
+
+PGM_GNUC_INTERNAL
+ssize_t
+pgm_sendto_tos (
+	pgm_sock_t*	       restrict	sock,
+	bool				use_rate_limit,
+	pgm_rate_t*	       restrict	minor_rate_control,
+	int				tos,			/* -1 == socket default */
+	const void*	       restrict	buf,
+	size_t				len,
+	const struct sockaddr* restrict	to,
+	socklen_t			tolen
+	)
+{
+	PGM_PROFILE_BEGIN (sendto_start);
+	const ssize_t sent = sendto_cmsg (sock, use_rate_limit, minor_rate_control, FALSE, -1, tos, buf, len, to, tolen);
+	PGM_PROFILE_END (PGM_PROFILE_SENDTO, sendto_start, sent >= 0);
+	return sent;
+}
+
+#ifdef UDP_SEGMENT
+/* kernel limits on one segmentation offload super-datagram */
+#	define PGM_UDP_GSO_MAX_SEGMENTS		64
+#	define PGM_UDP_GSO_MAX_BYTES		(UINT16_MAX - 128)
+
+/* unlocked send of a run of equal length datagrams as one super-datagram
+ * segmented by the kernel, only the last segment may be shorter.
+ *
+ * on success, returns number of datagrams sent.  on error, -1 is returned, and
+ * errno set appropriately.
+ */
+
+static
+int
+send_segments (
+	const SOCKET			send_sock,
+	const struct pgm_iovec* restrict vector,
+	const unsigned			count,
+	const struct sockaddr* restrict	to,
+	const socklen_t			tolen
+	)
+{
+	const size_t gso_size = vector[0].iov_len;
+	size_t total = gso_size;
+	unsigned n = 1;
+
+	while (n < count &&
+	       n < PGM_UDP_GSO_MAX_SEGMENTS &&
+	       vector[n].iov_len <= gso_size &&
+	       total + vector[n].iov_len <= PGM_UDP_GSO_MAX_BYTES)
+	{
+		total += vector[n].iov_len;
+		if (vector[n++].iov_len < gso_size)
+			break;
+	}
+
+	char control[ CMSG_SPACE(sizeof(uint16_t)) ];
+	memset (control, 0, sizeof(control));
+	struct msghdr msg = {
+		.msg_name	= pgm_send_ptr (to),
+		.msg_namelen	= tolen,
+		.msg_iov	= pgm_send_ptr (vector),
+		.msg_iovlen	= n,
+		.msg_control	= control,
+		.msg_controllen	= sizeof(control),
+		.msg_flags	= 0
+	};
+	if (n > 1) {
+		struct cmsghdr* cmsg	= CMSG_FIRSTHDR(&msg);
+		cmsg->cmsg_level	= SOL_UDP;
+		cmsg->cmsg_type		= UDP_SEGMENT;
+		cmsg->cmsg_len		= CMSG_LEN(sizeof(uint16_t));
+		*(uint16_t*)CMSG_DATA(cmsg) = (uint16_t)gso_size;
+	} else {
+		msg.msg_control		= NULL;
+		msg.msg_controllen	= 0;
+	}
+	if (sendmsg (send_sock, &msg, 0) < 0)
+		return -1;
+	return (int)n;
+}
+#endif /* UDP_SEGMENT */
+
+/* unlocked send of a vector of datagrams, falls back to one sendto() per
+ * datagram without sendmmsg().
+ */
+
+static
+int
+send_datagrams (
+	pgm_sock_t*	       restrict	sock,
+	const SOCKET			send_sock,
+	const struct pgm_iovec* restrict vector,
+	const unsigned			count,
+	const struct sockaddr* restrict	to,
+	const socklen_t			tolen,
+	const int			flags
+	)
+{
+	if (PGM_UNLIKELY(NULL != pgm_net_shim)) {
+		unsigned i;
+		for (i = 0; i < count; i++) {
+			if (pgm_net_shim->sendto (pgm_net_shim->user_data, sock, vector[i].iov_base, vector[i].iov_len, to, tolen) < 0)
+				break;
+		}
+		return (0 == i) ? -1 : (int)i;
+	}
+#ifdef UDP_SEGMENT
+/* one completion per datagram for zero-copy sends */
+	if (sock->use_udp_gso && 0 == flags && count > 1 && send_sock == sock->send_sock)
+	{
+		const int sent = send_segments (send_sock, vector, count, to, tolen);
+		if (PGM_LIKELY(sent >= 0))
+			return sent;
+		const int save_errno = pgm_get_last_sock_error();
+		if (EIO != save_errno && EINVAL != save_errno && EOPNOTSUPP != save_errno)
+			return sent;
+/* device or kernel without segmentation offload */
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("UDP segmentation offload unavailable, disabling."));
+		sock->use_udp_gso = FALSE;
+	}
+#endif
+#ifdef HAVE_SENDMMSG
+	struct mmsghdr msgvec[ count ];
+	memset (msgvec, 0, sizeof(msgvec));
+	for (unsigned i = 0; i < count; i++) {
+		msgvec[i].msg_hdr.msg_name	= pgm_send_ptr (to);
+		msgvec[i].msg_hdr.msg_namelen	= tolen;
+		msgvec[i].msg_hdr.msg_iov	= pgm_send_ptr (&vector[i]);
+		msgvec[i].msg_hdr.msg_iovlen	= 1;
+	}
+	return sendmmsg (send_sock, msgvec, count, flags);
+#else
+	unsigned i;
+	for (i = 0; i < count; i++) {
+		if ((*priv_sendto)(send_sock, vector[i].iov_base, vector[i].iov_len, flags, to, (socklen_t)tolen) < 0)
+			break;
+	}
+	return (0 == i) ? -1 : (int)i;
+#endif
+}
+
+/* send a vector of datagrams to one address with one system call where
+ * sendmmsg() is available.  rate regulation is applied once for the
+ * complete vector, flags are passed through to the system call.
+ *
+ * on success, returns number of datagrams sent which may be less than count
+ * on a non-blocking socket, partial system call results are continued
+ * internally.  on error, -1 is returned, and errno set
+ * appropriately.
+ */
+
+PGM_GNUC_INTERNAL
+ssize_t
+pgm_sendtov (
+	pgm_sock_t*	        restrict sock,
+	bool				 use_rate_limit,
+	pgm_rate_t*	        restrict minor_rate_control,
+	bool				 use_router_alert,
+	const struct pgm_iovec* restrict vector,		/* one datagram per element */
+	unsigned			 count,
+	const struct sockaddr*  restrict to,
+	socklen_t			 tolen,
+	int				 flags
+	)
+{
+	pgm_assert( NULL != sock );
+	pgm_assert( NULL != vector );
+	pgm_assert( count > 0 );
+	pgm_assert( NULL != to );
+	pgm_assert( tolen > 0 );
+
+	pgm_debug ("pgm_sendtov (sock:%p use_rate_limit:%s minor_rate_control:%p use_router_alert:%s vector:%p count:%u to:%p tolen:%d flags:%d)",
+		(const void*)sock,
+		use_rate_limit ? "TRUE" : "FALSE",
+		(const void*)minor_rate_control,
+		use_router_alert ? "TRUE" : "FALSE",
+		(const void*)vector,
+		count,
+		(const void*)to,
+		(int)tolen,
+		flags);
+
+	const SOCKET send_sock = use_router_alert ? sock->send_with_router_alert_sock : send_path (sock, vector[0].iov_base, vector[0].iov_len, to);
+	socklen_t dstlen = tolen;
+	const struct sockaddr* dst = send_dest (sock, send_sock, to, &dstlen);
+
+	if (PGM_UNLIKELY(0 != sock->tx_writable) && !tx_wait (sock)) {
+		pgm_set_last_sock_error (PGM_SOCK_ENOBUFS);
+		return (const ssize_t)-1;
+	}
+
+	if (use_rate_limit)
+	{
+/* bucket charges one IP header, add the remainder */
+		size_t len = (count - 1) * sock->iphdr_len;
+		for (unsigned i = 0; i < count; i++)
+			len += vector[i].iov_len;
+		const bool is_permitted = (NULL == minor_rate_control) ?
+			pgm_rate_check (&sock->rate_control, len, sock->is_nonblocking) :
+			pgm_rate_check2 (&sock->rate_control, minor_rate_control, len, sock->is_nonblocking);
+		if (!is_permitted) {
+			pgm_set_last_sock_error (PGM_SOCK_ENOBUFS);
+			return (const ssize_t)-1;
+		}
+	}
+
+/* impaired datagrams are drawn one at a time, charged above */
+	if (PGM_UNLIKELY(NULL != sock->tx_impair))
+	{
+		unsigned i;
+		for (i = 0; i < count; i++)
+			if (sendto_cmsg (sock, FALSE, NULL, use_router_alert, -1, -1, vector[i].iov_base, vector[i].iov_len, to, tolen) < 0)
+				break;
+		return (0 == i) ? (ssize_t)-1 : (ssize_t)i;
+	}
+
+	const bool is_locked = is_send_locked (sock, use_router_alert);
+	if (is_locked)
+		pgm_mutex_lock (&sock->send_mutex);
+
+	if (is_send_fanout (sock, to)) {
+		const int sent = send_fanout (sock, send_sock, vector, count);
+		if (sent > 0) {
+			tx_clear (sock);
+			if (PGM_UNLIKELY(NULL != sock->capture))
+				for (int i = 0; i < sent; i++)
+					capture_sent (sock, vector[i].iov_base, vector[i].iov_len, to);
+		}
+		if (is_locked)
+			pgm_mutex_unlock (&sock->send_mutex);
+		return (ssize_t)sent;
+	}
+
+/* continue on partial sends so the rate regulation charge applies once */
+	unsigned total = 0;
+#ifdef HAVE_RTE_ETHDEV_H
+	if (NULL != sock->dpdk)
+	{
+		ssize_t sent;
+		while (total < count &&
+		       (sent = pgm_dpdk_sendv (sock->dpdk, to, -1, -1, use_router_alert, vector + total, count - total)) > 0)
+		{
+			if (PGM_UNLIKELY(NULL != sock->capture))
+				for (unsigned i = 0; i < (unsigned)sent; i++)
+					capture_sent (sock, vector[total + i].iov_base, vector[total + i].iov_len, to);
+			total += (unsigned)sent;
+		}
+	}
+#endif
+#ifdef HAVE_INFINIBAND_VERBS_H
+/* post to the RDMA queue pair until every work request is outstanding, the remainder
+ * continues through the socket.
+ */
+	if (NULL != sock->verbs && to == (const struct sockaddr*)&sock->send_gsr.gsr_group)
+	{
+		ssize_t posted;
+		while (total < count &&
+		       (posted = pgm_verbs_sendv (sock->verbs, vector + total, count - total)) > 0)
+		{
+			if (PGM_UNLIKELY(NULL != sock->capture))
+				for (unsigned i = 0; i < (unsigned)posted; i++)
+					capture_sent (sock, vector[total + i].iov_base, vector[total + i].iov_len, to);
+			total += (unsigned)posted;
+		}
+	}
+#endif
+#if defined(HAVE_RTE_ETHDEV_H) || defined(HAVE_INFINIBAND_VERBS_H)
+	if (total < count)
+#endif
+	do {
+		int sent = send_datagrams (sock, send_sock, vector + total, count - total, dst, dstlen, flags);
+		pgm_debug ("send_datagrams returned %d", sent);
+		if (sent < 0) {
+			int save_errno = pgm_get_last_sock_error();
+			if (PGM_SOCK_ENOBUFS == save_errno)
+			{
+				tx_backoff (sock, send_sock);
+				if (!tx_wait (sock))
+					pgm_set_last_sock_error (PGM_SOCK_ENOBUFS);
+				else {
+					sent = send_datagrams (sock, send_sock, vector + total, count - total, dst, dstlen, flags);
+					if (sent < 0 && PGM_SOCK_ENOBUFS == pgm_get_last_sock_error())
+						tx_backoff (sock, send_sock);
+				}
+			}
+			else if (PGM_SOCK_EMSGSIZE == save_errno)
+			{
+				if (tx_msgsize (sock, to, tolen))
+					sent = send_datagrams (sock, send_sock, vector + total, count - total, dst, dstlen, flags);
+			}
+			else if (PGM_UNLIKELY(save_errno != PGM_SOCK_ENETUNREACH &&	/* Network is unreachable */
+			 		 save_errno != PGM_SOCK_EHOSTUNREACH &&	/* No route to host */
+			    		 save_errno != PGM_SOCK_EAGAIN))	/* would block on non-blocking send */
+			{
+				const int ready = wait_for_send (send_sock);
+				if (ready > 0)
+				{
+					sent = send_datagrams (sock, send_sock, vector + total, count - total, dst, dstlen, flags);
+					if ( sent < 0 )
+					{
+						char errbuf[1024];
+						char toaddr[INET6_ADDRSTRLEN];
+						save_errno = pgm_get_last_sock_error();
+						pgm_sockaddr_ntop (to, toaddr, sizeof(toaddr));
+						pgm_warn (_("sendmmsg() %s failed: %s"),
+							toaddr,
+							pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+					}
+				}
+				else if (ready == 0)
+				{
+					char toaddr[INET6_ADDRSTRLEN];
+					pgm_sockaddr_ntop (to, toaddr, sizeof(toaddr));
+					pgm_warn (_("sendmmsg() %s failed: socket timeout."), toaddr);
+				}
+				else
+				{
+					char errbuf[1024];
+					save_errno = pgm_get_last_sock_error();
+					pgm_warn (_("blocked socket failed: %s"),
+						  pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+				}
+			}
+			if (sent < 0)
+				break;
+		}
+		tx_clear (sock);
+		if (PGM_UNLIKELY(NULL != sock->capture))
+			for (int i = 0; i < sent; i++)
+				capture_sent (sock, vector[total + i].iov_base, vector[total + i].iov_len, to);
+		total += sent;
+	} while (total < count);
+
+/* repeat what the bound interface took on each redundant path, copied */
+	if (total > 0 && is_send_duplicate (sock, use_router_alert, to))
+		for (unsigned i = 0; i < sock->send_path_len; i++)
+			send_datagrams (sock, sock->send_path_sock[i], vector, total, to, tolen, 0);
+
+	if (is_locked)
+		pgm_mutex_unlock (&sock->send_mutex);
+	return (0 == total) ? (ssize_t)-1 : (ssize_t)total;
+}
+
+/* send a vector of datagrams each to its own address without rate regulation,
+ * with one system call where sendmmsg() is available.  a datagram the batch
+ * call fails to send is retried alone through pgm_sendto() for its error
+ * handling, and the batch continues after it.
+ *
+ * returns number of datagrams sent, on error returns -1 and errno set
+ * appropriately.
+ */
+
+PGM_GNUC_INTERNAL
+ssize_t
+pgm_sendto_batch (
+	pgm_sock_t*		     restrict sock,
+	bool				      use_router_alert,
+	const struct pgm_iovec*	     restrict vector,		/* one datagram per element */
+	const struct sockaddr*const* restrict to,		/* one address per element */
+	unsigned			      count
+	)
+{
+	unsigned total = 0;
+
+	pgm_assert( NULL != sock );
+	pgm_assert( NULL != vector );
+	pgm_assert( NULL != to );
+
+	pgm_debug ("pgm_sendto_batch (sock:%p use_router_alert:%s vector:%p to:%p count:%u)",
+		(const void*)sock,
+		use_router_alert ? "TRUE" : "FALSE",
+		(const void*)vector,
+		(const void*)to,
+		count);
+
+	while (total < count)
+	{
+#ifdef HAVE_SENDMMSG
+		if (PGM_LIKELY(NULL == pgm_net_shim && NULL == sock->tx_impair) && count - total > 1)
+		{
+			const SOCKET send_sock = use_router_alert ? sock->send_with_router_alert_sock : sock->send_sock;
+			const unsigned len = count - total;
+			struct mmsghdr msgvec[ len ];
+			memset (msgvec, 0, sizeof(msgvec));
+			for (unsigned i = 0; i < len; i++) {
+				socklen_t dstlen = pgm_sockaddr_len (to[total + i]);
+				msgvec[i].msg_hdr.msg_name	= pgm_send_ptr (send_dest (sock, send_sock, to[total + i], &dstlen));
+				msgvec[i].msg_hdr.msg_namelen	= dstlen;
+				msgvec[i].msg_hdr.msg_iov	= pgm_send_ptr (&vector[total + i]);
+				msgvec[i].msg_hdr.msg_iovlen	= 1;
+			}
+			const bool is_locked = is_send_locked (sock, use_router_alert);
+			if (is_locked)
+				pgm_mutex_lock (&sock->send_mutex);
+			const int sent = sendmmsg (send_sock, msgvec, len, 0);
+			if (is_locked)
+				pgm_mutex_unlock (&sock->send_mutex);
+			pgm_debug ("sendmmsg returned %d", sent);
+			if (sent > 0) {
+				if (PGM_UNLIKELY(NULL != sock->capture))
+					for (int i = 0; i < sent; i++)
+						capture_sent (sock, vector[total + i].iov_base, vector[total + i].iov_len, to[total + i]);
+				total += sent;
+				continue;
+			}
+		}
+#endif
+		if (pgm_sendto (sock,
+				FALSE,			/* not rate limited */
+				NULL,
+				use_router_alert,
+				vector[total].iov_base,
+				vector[total].iov_len,
+				to[total],
+				pgm_sockaddr_len (to[total])) < 0)
+			break;
+		total++;
+	}
+	return (0 == total && count > 0) ? (ssize_t)-1 : (ssize_t)total;
+}
+
 /* socket helper, for setting pipe ends non-blocking
  *
  * on success, returns 0.  on error, returns -1, and sets errno appropriately.
@@ -22,6 +22,7 @@
 
 #include <signal.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #ifndef _WIN32
@@ -41,8 +42,17 @@
 
 /* mock state */
 
+static int mock_sendmsg_hops = -1;
+static int mock_sendmsg_tos = -1;
+static int mock_sendmsg_errno = 0;
+static unsigned mock_multicast_hops_calls = 0;
+static uint64_t mock_pgm_time_now = 0x1;
+static uint64_t _mock_pgm_time_update_now (void);
+uint64_t (*mock_pgm_time_update_now)(void) = _mock_pgm_time_update_now;
+
 #ifndef _WIN32
 ssize_t mock_sendto (int, const void*, size_t, int, const struct sockaddr*, socklen_t);
+ssize_t mock_sendmsg (int, const struct msghdr*, int);
 #else
 int mock_sendto (SOCKET, const char*, int, int, const struct sockaddr*, int);
 int mock_select (int, fd_set*, fd_set*, fd_set*, struct timeval*);
@@ -50,14 +60,23 @@ int mock_select (int, fd_set*, fd_set*, fd_set*, struct timeval*);
 
 
 #define pgm_rate_check		mock_pgm_rate_check
+#define pgm_capture_packet	mock_pgm_capture_packet
 #define sendto			mock_sendto
+#define sendmsg			mock_sendmsg
+#define pgm_sockaddr_multicast_hops	mock_pgm_sockaddr_multicast_hops
 #define poll			mock_poll
 #define select			mock_select
 #define fcntl			mock_fcntl
+#define pgm_time_update_now	mock_pgm_time_update_now
+
 
 #define NET_DEBUG
 #include "net.c"
 
+static pgm_sock_t* mock_send_sock = NULL;
+static int mock_send_locked = -1;
+static const struct sockaddr* mock_send_to = NULL;
+static int mock_send_errno = 0;
 
 static
 pgm_sock_t*
@@ -173,6 +192,28 @@ mock_pgm_rate_check (
 	return TRUE;
 }
 
+void
+mock_pgm_capture_packet (
+	struct pgm_capture_t*const restrict	capture,
+	const bool				is_outbound,
+	const void*		restrict	tpdu,
+	const size_t				len,
+	const bool				has_iphdr,
+	const struct sockaddr*	restrict	src,
+	const struct sockaddr*	restrict	dst,
+	const in_port_t				sport,
+	const in_port_t				dport
+	)
+{
+}
+
+static
+uint64_t
+_mock_pgm_time_update_now (void)
+{
+	return mock_pgm_time_now;
+}
+
 #ifndef _WIN32
 ssize_t
 mock_sendto (
@@ -195,13 +236,63 @@ mock_sendto (
 	)
 #endif
 {
-	char saddr[INET6_ADDRSTRLEN];
-	pgm_sockaddr_ntop (to, saddr, sizeof(saddr));
+	char saddr[INET6_ADDRSTRLEN] = "(null)";
+	if (NULL != to)
+		pgm_sockaddr_ntop (to, saddr, sizeof(saddr));
 	g_debug ("mock_sendto (s:%i buf:%p len:%u flags:%s to:%s tolen:%d)",
 		s, buf, (unsigned)len, flags_string (flags), saddr, tolen);
+	mock_send_to = to;
+	if (0 != mock_send_errno) {
+		errno = mock_send_errno;
+		return -1;
+	}
+	if (NULL != mock_send_sock) {
+		mock_send_locked = !pgm_mutex_trylock (&mock_send_sock->send_mutex);
+		if (!mock_send_locked)
+			pgm_mutex_unlock (&mock_send_sock->send_mutex);
+	}
 	return len;
 }
 
+#ifndef _WIN32
+ssize_t
+mock_sendmsg (
+	int			s,
+	const struct msghdr*	msg,
+	int			flags
+	)
+{
+	g_debug ("mock_sendmsg (s:%i msg:%p flags:%s)",
+		s, (gconstpointer)msg, flags_string (flags));
+	if (mock_sendmsg_errno) {
+		errno = mock_sendmsg_errno;
+		return -1;
+	}
+	for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(msg); NULL != cmsg; cmsg = CMSG_NXTHDR((struct msghdr*)msg, cmsg))
+		if ((IPPROTO_IP == cmsg->cmsg_level && IP_TTL == cmsg->cmsg_type) ||
+		    (IPPROTO_IPV6 == cmsg->cmsg_level && IPV6_HOPLIMIT == cmsg->cmsg_type))
+			memcpy (&mock_sendmsg_hops, CMSG_DATA(cmsg), sizeof(int));
+		else if ((IPPROTO_IP == cmsg->cmsg_level && IP_TOS == cmsg->cmsg_type) ||
+			 (IPPROTO_IPV6 == cmsg->cmsg_level && IPV6_TCLASS == cmsg->cmsg_type))
+			memcpy (&mock_sendmsg_tos, CMSG_DATA(cmsg), sizeof(int));
+	return msg->msg_iov[0].iov_len;
+}
+#endif
+
+PGM_GNUC_INTERNAL
+int
+mock_pgm_sockaddr_multicast_hops (
+	const SOCKET		s,
+	const sa_family_t	sa_family,
+	const unsigned		hops
+	)
+{
+	g_debug ("mock_pgm_sockaddr_multicast_hops (s:%i sa-family:%d hops:%u)",
+		(int)s, (int)sa_family, hops);
+	mock_multicast_hops_calls++;
+	return 0;
+}
+
 #ifdef HAVE_POLL
 int
 mock_poll (
@@ -286,6 +377,98 @@ START_TEST (test_sendto_pass_001)
 }
 END_TEST
 
+/* data socket sends without shared state are not serialised */
+#ifdef PGM_HAVE_HOPS_CMSG
+START_TEST (test_sendto_pass_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	pgm_mutex_init (&sock->send_mutex);
+	sock->can_send_data = TRUE;
+	sock->use_hops_cmsg = TRUE;
+	priv_sendto = &default_sendto;
+	const char* buf = "i am not a string";
+	struct sockaddr_in addr = {
+		.sin_family		= AF_INET,
+		.sin_addr.s_addr	= inet_addr ("239.192.0.1")
+	};
+	mock_send_sock = sock;
+	mock_send_locked = -1;
+	gssize len = pgm_sendto (sock, FALSE, NULL, FALSE, buf, strlen(buf), (struct sockaddr*)&addr, sizeof(addr));
+	fail_unless (strlen(buf) == len, "sendto underrun");
+	fail_unless (0 == mock_send_locked, "send serialised");
+/* hop limit through setsockopt() */
+	sock->use_hops_cmsg = FALSE;
+	len = pgm_sendto (sock, FALSE, NULL, FALSE, buf, strlen(buf), (struct sockaddr*)&addr, sizeof(addr));
+	fail_unless (strlen(buf) == len, "sendto underrun");
+	fail_unless (1 == mock_send_locked, "send not serialised");
+	mock_send_sock = NULL;
+	pgm_mutex_free (&sock->send_mutex);
+}
+END_TEST
+#endif
+
+/* group datagrams on a connected data socket carry no address */
+#ifdef PGM_HAVE_CONNECTED_SEND
+START_TEST (test_sendto_pass_003)
+{
+	pgm_sock_t* sock = generate_sock ();
+	sock->family = AF_INET;
+	sock->is_send_connected = TRUE;
+	priv_sendto = &default_sendto;
+	const char* buf = "i am not a string";
+	struct sockaddr_in* group = (struct sockaddr_in*)&sock->send_gsr.gsr_group;
+	group->sin_family	= AF_INET;
+	group->sin_addr.s_addr	= inet_addr ("239.192.0.1");
+	gssize len = pgm_sendto (sock, FALSE, NULL, FALSE, buf, strlen(buf), (struct sockaddr*)group, sizeof(*group));
+	fail_unless (strlen(buf) == len, "sendto underrun");
+	fail_unless (NULL == mock_send_to, "group address passed");
+/* unicast, e.g. NCF to a NAKer */
+	struct sockaddr_in addr = {
+		.sin_family		= AF_INET,
+		.sin_addr.s_addr	= inet_addr ("172.12.90.1")
+	};
+	len = pgm_sendto (sock, FALSE, NULL, FALSE, buf, strlen(buf), (struct sockaddr*)&addr, sizeof(addr));
+	fail_unless (strlen(buf) == len, "sendto underrun");
+	fail_unless ((const struct sockaddr*)&addr == mock_send_to, "unicast address dropped");
+}
+END_TEST
+#endif
+
+/* a device queue refusing with ENOBUFS holds a non-blocking socket until the
+ * estimated drain without touching the device.
+ */
+#ifdef PGM_SOCK_ENOBUFS
+START_TEST (test_sendto_pass_004)
+{
+	pgm_sock_t* sock = generate_sock ();
+	sock->is_nonblocking = TRUE;
+	priv_sendto = &default_sendto;
+	const char* buf = "i am not a string";
+	struct sockaddr_in addr = {
+		.sin_family		= AF_INET,
+		.sin_addr.s_addr	= inet_addr ("172.12.90.1")
+	};
+	mock_pgm_time_now = 1000;
+	mock_send_errno = PGM_SOCK_ENOBUFS;
+	gssize len = pgm_sendto (sock, FALSE, NULL, FALSE, buf, strlen(buf), (struct sockaddr*)&addr, sizeof(addr));
+	fail_unless (-1 == len, "sendto succeeded");
+	fail_unless (PGM_SOCK_ENOBUFS == pgm_get_last_sock_error(), "not ENOBUFS");
+	fail_unless (mock_pgm_time_now + PGM_TX_BACKOFF_MIN_IVL == sock->tx_writable, "backoff not set");
+/* held without a system call */
+	mock_send_errno = 0;
+	mock_send_to = NULL;
+	len = pgm_sendto (sock, FALSE, NULL, FALSE, buf, strlen(buf), (struct sockaddr*)&addr, sizeof(addr));
+	fail_unless (-1 == len, "sendto succeeded");
+	fail_unless (NULL == mock_send_to, "device touched");
+/* estimated drain */
+	mock_pgm_time_now += PGM_TX_BACKOFF_MIN_IVL;
+	len = pgm_sendto (sock, FALSE, NULL, FALSE, buf, strlen(buf), (struct sockaddr*)&addr, sizeof(addr));
+	fail_unless (strlen(buf) == len, "sendto underrun");
+	fail_unless (0 == sock->tx_writable, "backoff not cleared");
+}
+END_TEST
+#endif
+
 START_TEST (test_sendto_fail_001)
 {
 	const char* buf = "i am not a string";
@@ -350,6 +533,100 @@ START_TEST (test_sendto_fail_005)
 }
 END_TEST
 
+/* target:
+ *	ssize_t
+ *	pgm_sendto_hops (
+ *		pgm_sock_t*		sock,
+ *		bool			use_rate_limit,
+ *		pgm_rate_t*		minor_rate_control,
+ *		bool			use_router_alert,
+ *		int			hops,
+ *		const void*		buf,
+ *		size_t			len,
+ *		const struct sockaddr*	to,
+ *		socklen_t		tolen
+ *	)
+ */
+
+#ifdef PGM_HAVE_HOPS_CMSG
+/* hop limit carried with the datagram */
+START_TEST (test_sendto_hops_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	sock->use_hops_cmsg = TRUE;
+	priv_sendto = &default_sendto;
+	const char* buf = "i am not a string";
+	struct sockaddr_in addr = {
+		.sin_family		= AF_INET,
+		.sin_addr.s_addr	= inet_addr ("239.192.0.1")
+	};
+	mock_sendmsg_hops = -1;
+	mock_sendmsg_errno = 0;
+	mock_multicast_hops_calls = 0;
+	gssize len = pgm_sendto_hops (sock, FALSE, NULL, FALSE, 1, buf, strlen(buf), (struct sockaddr*)&addr, sizeof(addr));
+	fail_unless (strlen(buf) == len, "sendto underrun");
+	fail_unless (1 == mock_sendmsg_hops, "hop limit not sent");
+	fail_unless (0 == mock_multicast_hops_calls, "socket hop limit changed");
+}
+END_TEST
+
+/* kernel refusing the ancillary data */
+START_TEST (test_sendto_hops_pass_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	sock->use_hops_cmsg = TRUE;
+	priv_sendto = &default_sendto;
+	const char* buf = "i am not a string";
+	struct sockaddr_in addr = {
+		.sin_family		= AF_INET,
+		.sin_addr.s_addr	= inet_addr ("239.192.0.1")
+	};
+	mock_sendmsg_errno = EINVAL;
+	mock_multicast_hops_calls = 0;
+	gssize len = pgm_sendto_hops (sock, FALSE, NULL, FALSE, 1, buf, strlen(buf), (struct sockaddr*)&addr, sizeof(addr));
+	fail_unless (strlen(buf) == len, "sendto underrun");
+	fail_unless (FALSE == sock->use_hops_cmsg, "ancillary data not disabled");
+	fail_unless (2 == mock_multicast_hops_calls, "socket hop limit not set and reverted");
+	mock_sendmsg_errno = 0;
+}
+END_TEST
+
+/* target:
+ *	ssize_t
+ *	pgm_sendto_tos (
+ *		pgm_sock_t*		sock,
+ *		bool			use_rate_limit,
+ *		pgm_rate_t*		minor_rate_control,
+ *		int			tos,
+ *		const void*		buf,
+ *		size_t			len,
+ *		const struct sockaddr*	to,
+ *		socklen_t		tolen
+ *	)
+ */
+
+/* traffic class carried with the datagram, the hop limit left alone */
+START_TEST (test_sendto_tos_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	sock->use_hops_cmsg = TRUE;
+	priv_sendto = &default_sendto;
+	const char* buf = "i am not a string";
+	struct sockaddr_in addr = {
+		.sin_family		= AF_INET,
+		.sin_addr.s_addr	= inet_addr ("239.192.0.1")
+	};
+	mock_sendmsg_hops = -1;
+	mock_sendmsg_tos = -1;
+	mock_sendmsg_errno = 0;
+	gssize len = pgm_sendto_tos (sock, FALSE, NULL, 0xb8, buf, strlen(buf), (struct sockaddr*)&addr, sizeof(addr));
+	fail_unless (strlen(buf) == len, "sendto underrun");
+	fail_unless (0xb8 == mock_sendmsg_tos, "traffic class not sent");
+	fail_unless (-1 == mock_sendmsg_hops, "hop limit sent");
+}
+END_TEST
+#endif
+
 /* target:
  * 	int
  * 	pgm_set_nonblocking (
@@ -384,6 +661,15 @@ make_test_suite (void)
 	TCase* tc_sendto = tcase_create ("sendto");
 	suite_add_tcase (s, tc_sendto);
 	tcase_add_test (tc_sendto, test_sendto_pass_001);
+#ifdef PGM_HAVE_HOPS_CMSG
+	tcase_add_test (tc_sendto, test_sendto_pass_002);
+#endif
+#ifdef PGM_HAVE_CONNECTED_SEND
+	tcase_add_test (tc_sendto, test_sendto_pass_003);
+#endif
+#ifdef PGM_SOCK_ENOBUFS
+	tcase_add_test (tc_sendto, test_sendto_pass_004);
+#endif
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_sendto, test_sendto_fail_001, SIGABRT);
 	tcase_add_test_raise_signal (tc_sendto, test_sendto_fail_002, SIGABRT);
@@ -392,6 +678,17 @@ make_test_suite (void)
 	tcase_add_test_raise_signal (tc_sendto, test_sendto_fail_005, SIGABRT);
 #endif
 
+#ifdef PGM_HAVE_HOPS_CMSG
+	TCase* tc_sendto_hops = tcase_create ("sendto-hops");
+	suite_add_tcase (s, tc_sendto_hops);
+	tcase_add_test (tc_sendto_hops, test_sendto_hops_pass_001);
+	tcase_add_test (tc_sendto_hops, test_sendto_hops_pass_002);
+
+	TCase* tc_sendto_tos = tcase_create ("sendto-tos");
+	suite_add_tcase (s, tc_sendto_tos);
+	tcase_add_test (tc_sendto_tos, test_sendto_tos_pass_001);
+#endif
+
 	TCase* tc_set_nonblocking = tcase_create ("set-nonblocking");
 	suite_add_tcase (s, tc_set_nonblocking);
 	tcase_add_test (tc_set_nonblocking, test_set_nonblocking_pass_001);
@@ -258,6 +258,187 @@ pgm_parse_udp_encap (
 	return pgm_parse (skb, error);
 }
 
+/* packet types dispatched by on_pgm(), PGM_CDATA with UDP encapsulation only */
+#define PGM_SCREEN_TYPES	( (1U << PGM_SPM)	| \
+				  (1U << PGM_POLL)	| \
+				  (1U << PGM_POLR)	| \
+				  (1U << PGM_ODATA)	| \
+				  (1U << PGM_RDATA)	| \
+				  (1U << PGM_NAK)	| \
+				  (1U << PGM_NNAK)	| \
+				  (1U << PGM_NCF)	| \
+				  (1U << PGM_SPMR)	| \
+				  (1U << PGM_ACK) )
+
+/* screen a batch of count datagrams read with one system call before per-packet
+ * parsing: each iov holds a receive buffer of at least PGM_MIN_SIZE bytes with iov_len
+ * the length received.  type[i] is set to the PGM type of datagram i or PGM_MAX where
+ * the fixed header checks of pgm_parse_raw() or pgm_parse_udp_encap() would fail or
+ * on_pgm() would not dispatch the type.  the checks of each datagram are combined
+ * without branches so the loop runs at the rate of the header loads, no datagram
+ * accepted by the per-packet parse is rejected and checksums remain with pgm_parse().
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_parse_screen (
+	const struct pgm_iovec* const restrict	iov,
+	const unsigned				count,
+	const bool				is_udp_encap,
+	uint8_t*		      restrict	type
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != iov);
+	pgm_assert (NULL != type);
+
+	if (is_udp_encap)
+	{
+		const uint32_t accept = PGM_SCREEN_TYPES | (1U << PGM_CDATA);
+		for (unsigned i = 0; i < count; i++)
+		{
+			const uint8_t* packet = iov[i].iov_base;
+			const size_t len = iov[i].iov_len;
+			const uint8_t t = packet[ PGM_OFFSETOF(struct pgm_header, pgm_type) ];
+			const size_t min_len = (PGM_CDATA == t) ? sizeof(struct pgm_compact_header) : sizeof(struct pgm_header);
+			const bool is_valid = (len >= min_len) &
+					      (t < 32) &
+					      (bool)((accept >> (t & 31)) & 1);
+			type[i] = is_valid ? t : PGM_MAX;
+		}
+		return;
+	}
+
+	for (unsigned i = 0; i < count; i++)
+	{
+		const uint8_t* packet = iov[i].iov_base;
+		const size_t len = iov[i].iov_len;
+		const struct pgm_ip* ip = (const struct pgm_ip*)packet;
+		const size_t ip_header_length = ip->ip_hl * 4;
+#ifndef HAVE_HOST_ORDER_IP_OFF
+		const uint16_t offset = pgm_ntohs (ip->ip_off);
+#else
+		const uint16_t offset = ip->ip_off;
+#endif
+/* type read within the datagram, a short datagram is rejected on length */
+		const bool is_whole = (len >= ip_header_length + sizeof(struct pgm_header));
+		const size_t pgm_offset = is_whole ? ip_header_length : 0;
+		const uint8_t t = packet[ pgm_offset + PGM_OFFSETOF(struct pgm_header, pgm_type) ];
+		const bool is_valid = (len >= PGM_MIN_SIZE) &
+				      (4 == ip->ip_v) &
+				      (ip_header_length >= sizeof(struct pgm_ip)) &
+				      is_whole &
+				      (0 == (offset & 0x1fff)) &
+				      (t < 32) &
+				      (bool)((PGM_SCREEN_TYPES >> (t & 31)) & 1);
+		type[i] = is_valid ? t : PGM_MAX;
+	}
+}
+
+/* expand a PGM_CDATA packet in place into the ODATA packet it was encoded from,
+ * the GSI implied by the session and sequence numbers nearest the peer lead, so
+ * that the transmitted checksum and every later stage apply unchanged.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_parse_compact (
+	struct pgm_sk_buff_t*const restrict skb,		/* will be modified */
+	const pgm_gsi_t*	   const restrict gsi,
+	const uint32_t				  lead,
+	pgm_error_t**			restrict error
+	)
+{
+	struct pgm_compact_header   compact;
+	struct pgm_compact_fragment cfrag;
+	size_t compact_len, header_len;
+
+/* pre-conditions */
+	pgm_assert (NULL != skb);
+	pgm_assert (NULL != gsi);
+
+	if (PGM_UNLIKELY(skb->len < sizeof(struct pgm_compact_header))) {
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_PACKET,
+			     PGM_ERROR_BOUNDS,
+			     _("UDP payload too small for compact PGM packet at %" PRIu16 " bytes, expecting at least %" PRIzu " bytes."),
+			     skb->len, sizeof(struct pgm_compact_header));
+		return FALSE;
+	}
+	memcpy (&compact, skb->data, sizeof(compact));
+	compact_len = sizeof(struct pgm_compact_header);
+	header_len  = sizeof(struct pgm_header) + sizeof(struct pgm_data);
+	if (compact.pgm_options & PGM_OPT_PRESENT) {
+		if (PGM_UNLIKELY(compact.pgm_options != PGM_OPT_PRESENT ||
+				 skb->len < compact_len + sizeof(struct pgm_compact_fragment)))
+		{
+			pgm_set_error (error,
+				     PGM_ERROR_DOMAIN_PACKET,
+				     PGM_ERROR_PROTO,
+				     _("Compact PGM packet with malformed short fragment."));
+			return FALSE;
+		}
+		memcpy (&cfrag, (const char*)skb->data + compact_len, sizeof(cfrag));
+		compact_len += sizeof(struct pgm_compact_fragment);
+		header_len  += sizeof(struct pgm_opt_length) + sizeof(struct pgm_opt_header) + sizeof(struct pgm_opt_fragment);
+	} else if (PGM_UNLIKELY(0 != compact.pgm_options)) {
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_PACKET,
+			     PGM_ERROR_PROTO,
+			     _("Compact PGM packet with unsupported options 0x%x."),
+			     compact.pgm_options);
+		return FALSE;
+	}
+
+	const size_t tsdu_len = skb->len - compact_len;
+	if (PGM_UNLIKELY((size_t)((char*)skb->end - (char*)skb->data) < header_len + tsdu_len)) {
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_PACKET,
+			     PGM_ERROR_BOUNDS,
+			     _("Compact PGM packet expands beyond the receive buffer at %" PRIzu " bytes."),
+			     header_len + tsdu_len);
+		return FALSE;
+	}
+
+/* nearest sequence number to the lead with the transmitted low bits */
+	const uint16_t lead16 = (uint16_t)lead;
+	const uint32_t sqn = lead + (int16_t)(pgm_ntohs (compact.cdata_sqn) - lead16);
+
+	memmove ((char*)skb->data + header_len, (const char*)skb->data + compact_len, tsdu_len);
+	struct pgm_header* header = skb->data;
+	struct pgm_data* data = (struct pgm_data*)(header + 1);
+	header->pgm_sport	= compact.pgm_sport;
+	header->pgm_dport	= compact.pgm_dport;
+	header->pgm_type	= PGM_ODATA;
+	header->pgm_options	= compact.pgm_options;
+	header->pgm_checksum	= compact.pgm_checksum;
+	memcpy (header->pgm_gsi, gsi, sizeof(pgm_gsi_t));
+	header->pgm_tsdu_length	= compact.pgm_tsdu_length;
+	data->data_sqn		= pgm_htonl (sqn);
+	data->data_trail	= pgm_htonl (sqn - pgm_ntohs (compact.cdata_trail));
+	if (compact.pgm_options & PGM_OPT_PRESENT) {
+		struct pgm_opt_length* opt_len = (struct pgm_opt_length*)(data + 1);
+		struct pgm_opt_header* opt_header = (struct pgm_opt_header*)(opt_len + 1);
+		struct pgm_opt_fragment* opt_fragment = (struct pgm_opt_fragment*)(opt_header + 1);
+		opt_len->opt_type		= PGM_OPT_LENGTH;
+		opt_len->opt_length		= sizeof(struct pgm_opt_length);
+		opt_len->opt_total_length	= pgm_htons ((uint16_t)(sizeof(struct pgm_opt_length) +
+									sizeof(struct pgm_opt_header) +
+									sizeof(struct pgm_opt_fragment)));
+		opt_header->opt_type		= PGM_OPT_FRAGMENT | PGM_OPT_END;
+		opt_header->opt_length		= sizeof(struct pgm_opt_header) + sizeof(struct pgm_opt_fragment);
+		opt_header->opt_reserved	= 0;
+		opt_fragment->opt_reserved	= 0;
+		opt_fragment->opt_sqn		= pgm_htonl (sqn - pgm_ntohs (cfrag.cfrag_sqn));
+		opt_fragment->opt_frag_off	= pgm_htonl ((uint32_t)pgm_ntohs (cfrag.cfrag_off));
+		opt_fragment->opt_frag_len	= pgm_htonl ((uint32_t)pgm_ntohs (cfrag.cfrag_len));
+	}
+	skb->len  = (uint16_t)(header_len + tsdu_len);
+	skb->tail = (char*)skb->data + skb->len;
+	skb->pgm_header = skb->data;
+	return pgm_parse (skb, error);
+}
+
 /* will modify packet contents to calculate and check PGM checksum
  */
 static
@@ -273,6 +454,12 @@ pgm_parse (
 /* pgm_checksum == 0 means no transmitted checksum */
 	if (skb->pgm_header->pgm_checksum)
 	{
+/* lazy verification of original data once accepted by the receive window */
+		if (skb->csum_deferred && PGM_ODATA == skb->pgm_header->pgm_type)
+			goto copy_tsi;
+		skb->csum_deferred = 0;
+		if (skb->csum_unnecessary)
+			goto copy_tsi;
 		const uint16_t sum = skb->pgm_header->pgm_checksum;
 		skb->pgm_header->pgm_checksum = 0;
 		const uint16_t pgm_sum = pgm_csum_fold (pgm_csum_partial ((const char*)skb->pgm_header, skb->len, 0));
@@ -286,8 +473,12 @@ pgm_parse (
 			return FALSE;
 		}
 	} else {
-		if (PGM_ODATA == skb->pgm_header->pgm_type ||
-		    PGM_RDATA == skb->pgm_header->pgm_type)
+/* data of PGM_TX_CHECKSUM senders relies upon the UDP checksum, accepted only where
+ * the receive policy trusts it.
+ */
+		if ((PGM_ODATA == skb->pgm_header->pgm_type ||
+		     PGM_RDATA == skb->pgm_header->pgm_type) &&
+		    !skb->csum_unnecessary)
 		{
 			pgm_set_error (error,
 				     PGM_ERROR_DOMAIN_PACKET,
@@ -297,14 +488,91 @@ pgm_parse (
 			return FALSE;
 		}
 		pgm_debug ("No PGM checksum :O");
+		skb->csum_deferred = 0;
 	}
 
+copy_tsi:
 /* copy packets source transport identifier */
 	memcpy (&skb->tsi.gsi, skb->pgm_header->pgm_gsi, sizeof(pgm_gsi_t));
 	skb->tsi.sport = skb->pgm_header->pgm_sport;
 	return TRUE;
 }
 
+/* sum the header run ahead of skb::data skipping the checksum field so that
+ * window skbuffs may be verified without modification outside the receiver lock.
+ */
+
+static inline
+uint32_t
+checksum_header (
+	const struct pgm_sk_buff_t* const skb,
+	const uint16_t			  header_len
+	)
+{
+	const uint16_t field_off = (uint16_t)PGM_OFFSETOF(struct pgm_header, pgm_checksum);
+	const uint16_t tail_off  = field_off + sizeof(uint16_t);
+	const uint32_t unfolded_head = pgm_csum_partial ((const char*)skb->pgm_header, field_off, 0);
+	const uint32_t unfolded_tail = pgm_csum_partial ((const char*)skb->pgm_header + tail_off, header_len - tail_off, 0);
+	return pgm_csum_block_add (unfolded_head, unfolded_tail, tail_off);
+}
+
+/* verify the checksum of a data packet deferred by pgm_parse(), skb::data at the
+ * data header or beyond.  header and remainder are summed as unfolded parts as the
+ * source does when building the packet.
+ *
+ * returns TRUE if the checksum matches, FALSE otherwise.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_verify_checksum (
+	struct pgm_sk_buff_t* const	skb
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != skb);
+	pgm_assert (NULL != skb->pgm_header);
+	pgm_assert ((char*)skb->data >= (char*)skb->pgm_header + sizeof(struct pgm_header));
+
+	const uint16_t header_len = (uint16_t)((char*)skb->data - (char*)skb->pgm_header);
+	const uint32_t unfolded_header = checksum_header (skb, header_len);
+	const uint32_t unfolded_data = pgm_csum_partial ((const char*)skb->data, skb->len, 0);
+	skb->csum_deferred = 0;
+	return (skb->pgm_header->pgm_checksum == pgm_csum_fold (pgm_csum_block_add (unfolded_header, unfolded_data, header_len)));
+}
+
+/* fused verify and copy of a deferred window skbuff into an application buffer,
+ * each payload byte is read once.  bytes beyond copy_len, as when the caller's
+ * buffer truncates the APDU, are summed but not copied.  the skbuff is not modified.
+ *
+ * returns TRUE if the checksum matches, FALSE otherwise.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_verify_checksum_copy (
+	const struct pgm_sk_buff_t* const restrict skb,
+	void*			    restrict dst,
+	const uint16_t			     copy_len
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != skb);
+	pgm_assert (NULL != skb->pgm_header);
+	pgm_assert ((char*)skb->data >= (char*)skb->pgm_header + sizeof(struct pgm_header));
+	pgm_assert (copy_len <= skb->len);
+	if (copy_len) pgm_assert (NULL != dst);
+
+	const uint16_t header_len = (uint16_t)((char*)skb->data - (char*)skb->pgm_header);
+	const uint32_t unfolded_header = checksum_header (skb, header_len);
+	uint32_t unfolded_data = copy_len ? pgm_csum_partial_copy ((const char*)skb->data, dst, copy_len, 0) : 0;
+	if (PGM_UNLIKELY(copy_len < skb->len)) {
+		const uint32_t unfolded_rest = pgm_csum_partial ((const char*)skb->data + copy_len, skb->len - copy_len, 0);
+		unfolded_data = pgm_csum_block_add (unfolded_data, unfolded_rest, copy_len);
+	}
+	return (skb->pgm_header->pgm_checksum == pgm_csum_fold (pgm_csum_block_add (unfolded_header, unfolded_data, header_len)));
+}
+
 /* 8.1.  Source Path Messages (SPM)
  *
  *  0                   1                   2                   3
@@ -622,4 +890,84 @@ pgm_verify_ack (
 	return TRUE;
 }
 
+/* Option extensions, decoded once per packet into the control buffer so that
+ * protocol handlers and the receive window never walk the option list again.
+ *
+ * the list must open with OPT_LENGTH, close with OPT_END inside the total
+ * length reported there, which must fit the packet, and hold at most
+ * PGM_MAX_OPTIONS options each at least an option header long.
+ *
+ * returns TRUE on success, or FALSE if the options are malformed.
+ */
+
+#define PGM_MAX_OPTIONS		16
+
+PGM_STATIC_ASSERT(sizeof(struct pgm_opt_desc_t) <= sizeof(((struct pgm_sk_buff_t*)0)->cb));
+
+PGM_GNUC_INTERNAL
+bool
+pgm_parse_options (
+	struct pgm_sk_buff_t* const restrict skb,
+	const void*	      const restrict opt_start	/* OPT_LENGTH */
+	)
+{
+	struct pgm_opt_desc_t* const desc = pgm_opt_desc (skb);
+	const struct pgm_opt_length* opt_len;
+	const struct pgm_opt_header* opt_header;
+	const char* opt_end;
+
+/* pre-conditions */
+	pgm_assert (NULL != skb);
+	pgm_assert (NULL != skb->pgm_header);
+	pgm_assert (NULL != opt_start);
+
+	memset (desc, 0, sizeof(struct pgm_opt_desc_t));
+	if (!(skb->pgm_header->pgm_options & PGM_OPT_PRESENT))
+		return TRUE;
+
+	opt_len = (const struct pgm_opt_length*)opt_start;
+	if (PGM_UNLIKELY((const char*)(opt_len + 1) > (const char*)skb->tail ||
+			 PGM_OPT_LENGTH != opt_len->opt_type ||
+			 sizeof(struct pgm_opt_length) != opt_len->opt_length))
+		return FALSE;
+	desc->opt_total_length = pgm_ntohs (opt_len->opt_total_length);
+	opt_end = (const char*)opt_len + desc->opt_total_length;
+	if (PGM_UNLIKELY(desc->opt_total_length < sizeof(struct pgm_opt_length) + sizeof(struct pgm_opt_header) ||
+			 opt_end > (const char*)skb->tail))
+		return FALSE;
+
+	opt_header = (const struct pgm_opt_header*)(opt_len + 1);
+	for (unsigned i = 0; i < PGM_MAX_OPTIONS; i++)
+	{
+		if (PGM_UNLIKELY((const char*)(opt_header + 1) > opt_end ||
+				 opt_header->opt_length < sizeof(struct pgm_opt_header) ||
+				 (const char*)opt_header + opt_header->opt_length > opt_end))
+			return FALSE;
+
+		const uint16_t offset = (uint16_t)((const char*)opt_header - (const char*)skb->pgm_header);
+		switch (opt_header->opt_type & PGM_OPT_MASK) {
+		case PGM_OPT_FRAGMENT:		desc->opt_fragment = offset; break;
+		case PGM_OPT_NAK_LIST:		desc->opt_nak_list = offset; break;
+		case PGM_OPT_PARITY_PRM:	desc->opt_parity_prm = offset; break;
+		case PGM_OPT_SW_PRM:		desc->opt_sw_prm = offset; break;
+		case PGM_OPT_SW_REPAIR:		desc->opt_sw_repair = offset; break;
+		case PGM_OPT_BATCH:		desc->opt_batch = offset; break;
+		case PGM_OPT_CATCHUP:		desc->opt_catchup = offset; break;
+		case PGM_OPT_COMPRESS:		desc->opt_compress = offset; break;
+		case PGM_OPT_CONFLATE:		desc->opt_conflate = offset; break;
+		case PGM_OPT_PGMCC_DATA:	desc->opt_pgmcc_data = offset; break;
+		case PGM_OPT_PGMCC_FEEDBACK:	desc->opt_pgmcc_feedback = offset; break;
+		case PGM_OPT_ACK_TRAIL:		desc->opt_ack_trail = offset; break;
+		case PGM_OPT_CREDIT:		desc->opt_credit = offset; break;
+		case PGM_OPT_COMPACT:		desc->opt_compact = offset; break;
+		default: break;
+		}
+
+		if (opt_header->opt_type & PGM_OPT_END)
+			return TRUE;
+		opt_header = (const struct pgm_opt_header*)((const char*)opt_header + opt_header->opt_length);
+	}
+	return FALSE;
+}
+
 /* eof */
@@ -239,6 +239,276 @@ START_TEST (test_parse_udp_encap_fail_001)
 }
 END_TEST
 
+/* corrupt payload passes only when verification is skipped or deferred */
+START_TEST (test_parse_udp_encap_fail_002)
+{
+	pgm_error_t* err = NULL;
+	struct pgm_sk_buff_t* skb = generate_udp_encap_pgm ();
+	((char*)skb->tail)[-1] ^= 0x1;
+	fail_unless (FALSE == pgm_parse_udp_encap (skb, &err), "corrupt packet parsed");
+	pgm_error_free (err);
+	skb = generate_udp_encap_pgm ();
+	((char*)skb->tail)[-1] ^= 0x1;
+	skb->csum_unnecessary = 1;
+	fail_unless (TRUE == pgm_parse_udp_encap (skb, NULL), "verified packet checked");
+	skb = generate_udp_encap_pgm ();
+	((char*)skb->tail)[-1] ^= 0x1;
+	skb->csum_deferred = 1;
+	fail_unless (TRUE == pgm_parse_udp_encap (skb, NULL), "deferred ODATA checked");
+	fail_unless (1 == skb->csum_deferred, "deferral cleared");
+}
+END_TEST
+
+/* zero "no checksum" ODATA passes only where the UDP checksum is trusted */
+START_TEST (test_parse_udp_encap_fail_003)
+{
+	pgm_error_t* err = NULL;
+	struct pgm_sk_buff_t* skb = generate_udp_encap_pgm ();
+	((struct pgm_header*)skb->head)->pgm_checksum = 0;
+	fail_unless (FALSE == pgm_parse_udp_encap (skb, &err), "unchecksummed ODATA parsed");
+	pgm_error_free (err);
+	skb = generate_udp_encap_pgm ();
+	((struct pgm_header*)skb->head)->pgm_checksum = 0;
+	skb->csum_unnecessary = 1;
+	fail_unless (TRUE == pgm_parse_udp_encap (skb, NULL), "UDP verified ODATA discarded");
+}
+END_TEST
+
+/* batch screen keeps datagrams the per-packet parse accepts */
+START_TEST (test_parse_screen_pass_001)
+{
+	struct pgm_sk_buff_t* skb[3];
+	struct pgm_iovec iov[3];
+	uint8_t type[3];
+	for (unsigned i = 0; i < 3; i++) {
+		skb[i] = generate_udp_encap_pgm ();
+		iov[i].iov_base = skb[i]->head;
+		iov[i].iov_len  = skb[i]->len;
+	}
+	((struct pgm_header*)skb[1]->head)->pgm_type = PGM_NCF;
+	((struct pgm_header*)skb[2]->head)->pgm_type = PGM_CDATA;
+	pgm_parse_screen (iov, 3, TRUE, type);
+	fail_unless (PGM_ODATA == type[0], "ODATA screened");
+	fail_unless (PGM_NCF == type[1], "NCF screened");
+	fail_unless (PGM_CDATA == type[2], "CDATA screened");
+	skb[0] = generate_raw_pgm ();
+	iov[0].iov_base = skb[0]->head;
+	iov[0].iov_len  = skb[0]->len;
+	pgm_parse_screen (iov, 1, FALSE, type);
+	fail_unless (PGM_ODATA == type[0], "raw ODATA screened");
+}
+END_TEST
+
+/* short, unknown type, compact data over raw IP, fragment */
+START_TEST (test_parse_screen_fail_001)
+{
+	struct pgm_sk_buff_t* skb[2];
+	struct pgm_iovec iov[2];
+	uint8_t type[2];
+	for (unsigned i = 0; i < 2; i++) {
+		skb[i] = generate_udp_encap_pgm ();
+		iov[i].iov_base = skb[i]->head;
+		iov[i].iov_len  = skb[i]->len;
+	}
+	iov[0].iov_len = sizeof(struct pgm_header) - 1;
+	((struct pgm_header*)skb[1]->head)->pgm_type = 0x03;
+	pgm_parse_screen (iov, 2, TRUE, type);
+	fail_unless (PGM_MAX == type[0], "short datagram passed");
+	fail_unless (PGM_MAX == type[1], "unknown type passed");
+	for (unsigned i = 0; i < 2; i++) {
+		skb[i] = generate_raw_pgm ();
+		iov[i].iov_base = skb[i]->head;
+		iov[i].iov_len  = skb[i]->len;
+	}
+	((struct pgm_header*)((struct pgm_ip*)skb[0]->head + 1))->pgm_type = PGM_CDATA;
+	((struct pgm_ip*)skb[1]->head)->ip_off = g_htons (0x0001);
+	pgm_parse_screen (iov, 2, FALSE, type);
+	fail_unless (PGM_MAX == type[0], "raw CDATA passed");
+	fail_unless (PGM_MAX == type[1], "fragment passed");
+}
+END_TEST
+
+/* re-encode a standard UDP encapsulated packet as PGM_CDATA in a new skb */
+static
+struct pgm_sk_buff_t*
+generate_compact_pgm (
+	const struct pgm_sk_buff_t*	standard
+	)
+{
+	const struct pgm_header* pgmhdr = standard->data;
+	const struct pgm_data* datahdr = (gconstpointer)(pgmhdr + 1);
+	const guint16 tsdu_length = g_ntohs (pgmhdr->pgm_tsdu_length);
+	const guint32 sqn = g_ntohl (datahdr->data_sqn);
+	struct pgm_sk_buff_t* skb = pgm_alloc_skb (1500);
+	skb->sock		= (pgm_sock_t*)0x1;
+	skb->tstamp		= 0x1;
+	skb->data		= skb->head;
+	skb->len		= sizeof(struct pgm_compact_header) + tsdu_length;
+	skb->tail		= (guint8*)skb->data + skb->len;
+
+	struct pgm_compact_header* compact = skb->head;
+	compact->pgm_sport	= pgmhdr->pgm_sport;
+	compact->pgm_dport	= pgmhdr->pgm_dport;
+	compact->pgm_type	= PGM_CDATA;
+	compact->pgm_options	= 0;
+	compact->pgm_checksum	= pgmhdr->pgm_checksum;
+	compact->cdata_sqn	= g_htons ((guint16)sqn);
+	compact->cdata_trail	= g_htons ((guint16)(sqn - g_ntohl (datahdr->data_trail)));
+	compact->pgm_tsdu_length = pgmhdr->pgm_tsdu_length;
+	memcpy (compact + 1, datahdr + 1, tsdu_length);
+	return skb;
+}
+
+/* target:
+ *	bool
+ *	pgm_parse_compact (
+ *		struct pgm_sk_buff_t* const	skb,
+ *		const pgm_gsi_t* const		gsi,
+ *		const uint32_t			lead,
+ *		pgm_error_t**			error
+ *	)
+ */
+
+START_TEST (test_parse_compact_pass_001)
+{
+	pgm_error_t* err = NULL;
+	const pgm_gsi_t gsi = { { 1, 2, 3, 4, 5, 6 } };
+	struct pgm_sk_buff_t* standard = generate_udp_encap_pgm ();
+	struct pgm_sk_buff_t* skb = generate_compact_pgm (standard);
+/* lead behind the sequence number by less than 32K across the wrap */
+	gboolean success = pgm_parse_compact (skb, &gsi, (guint32)-100, &err);
+	if (!success && err) {
+		g_error ("Parsing compact packet: %s", err->message);
+	}
+	fail_unless (TRUE == success, "parse_compact failed");
+	fail_unless (standard->len == skb->len, "length mismatch");
+	fail_unless (0 == memcmp (standard->data, skb->data, skb->len), "expansion mismatch");
+	fail_unless (0 == memcmp (&gsi, &skb->tsi.gsi, sizeof(pgm_gsi_t)), "GSI mismatch");
+}
+END_TEST
+
+/* short fragment expands to OPT_LENGTH and OPT_FRAGMENT */
+START_TEST (test_parse_compact_pass_002)
+{
+	pgm_error_t* err = NULL;
+	const pgm_gsi_t gsi = { { 1, 2, 3, 4, 5, 6 } };
+	struct pgm_sk_buff_t* skb = generate_compact_pgm (generate_udp_encap_pgm ());
+	struct pgm_compact_header* compact = skb->data;
+	struct pgm_compact_fragment* cfrag = (gpointer)(compact + 1);
+	const guint16 tsdu_length = g_ntohs (compact->pgm_tsdu_length);
+	memmove (cfrag + 1, cfrag, tsdu_length);
+	compact->pgm_options	= PGM_OPT_PRESENT;
+	compact->pgm_checksum	= 0;
+	cfrag->cfrag_sqn	= g_htons (2);
+	cfrag->cfrag_off	= g_htons (2000);
+	cfrag->cfrag_len	= g_htons (2000 + tsdu_length);
+	skb->len += sizeof(struct pgm_compact_fragment);
+	skb->tail = (guint8*)skb->data + skb->len;
+	skb->csum_unnecessary = 1;
+	fail_unless (TRUE == pgm_parse_compact (skb, &gsi, 0, &err), "parse_compact failed");
+	const struct pgm_data* datahdr = (gconstpointer)(skb->pgm_header + 1);
+	const struct pgm_opt_length* opt_len = (gconstpointer)(datahdr + 1);
+	const struct pgm_opt_header* opt_header = (gconstpointer)(opt_len + 1);
+	const struct pgm_opt_fragment* opt_fragment = (gconstpointer)(opt_header + 1);
+	fail_unless (PGM_ODATA == skb->pgm_header->pgm_type, "type");
+	fail_unless (PGM_OPT_LENGTH == opt_len->opt_type, "OPT_LENGTH");
+	fail_unless ((PGM_OPT_FRAGMENT | PGM_OPT_END) == opt_header->opt_type, "OPT_FRAGMENT");
+	fail_unless ((guint32)-2 == g_ntohl (opt_fragment->opt_sqn), "first sqn");
+	fail_unless (2000 == g_ntohl (opt_fragment->opt_frag_off), "offset");
+	fail_unless (2000u + tsdu_length == g_ntohl (opt_fragment->opt_frag_len), "APDU length");
+	fail_unless (0 == memcmp ("i am not a string", opt_fragment + 1, tsdu_length), "payload");
+}
+END_TEST
+
+/* wrong session fails the checksum of the standard encoding */
+START_TEST (test_parse_compact_fail_001)
+{
+	pgm_error_t* err = NULL;
+	const pgm_gsi_t gsi = { { 6, 5, 4, 3, 2, 1 } };
+	struct pgm_sk_buff_t* skb = generate_compact_pgm (generate_udp_encap_pgm ());
+	fail_unless (FALSE == pgm_parse_compact (skb, &gsi, 0, &err), "foreign session parsed");
+	fail_unless (PGM_ERROR_CKSUM == err->code, "not a checksum error");
+	pgm_error_free (err);
+	err = NULL;
+	skb = generate_compact_pgm (generate_udp_encap_pgm ());
+	skb->len = sizeof(struct pgm_compact_header) - 1;
+	fail_unless (FALSE == pgm_parse_compact (skb, &gsi, 0, &err), "truncated packet parsed");
+	pgm_error_free (err);
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_verify_checksum (
+ *		struct pgm_sk_buff_t* const	skb
+ *	)
+ */
+
+START_TEST (test_verify_checksum_pass_001)
+{
+	struct pgm_sk_buff_t* skb = generate_udp_encap_pgm ();
+	skb->csum_deferred = 1;
+	fail_unless (TRUE == pgm_parse_udp_encap (skb, NULL), "parse_udp_encap failed");
+	pgm_skb_pull (skb, sizeof(struct pgm_header));
+	fail_unless (TRUE == pgm_verify_checksum (skb), "verify_checksum failed");
+	fail_unless (0 == skb->csum_deferred, "deferral not cleared");
+}
+END_TEST
+
+START_TEST (test_verify_checksum_fail_001)
+{
+	struct pgm_sk_buff_t* skb = generate_udp_encap_pgm ();
+	((char*)skb->tail)[-1] ^= 0x1;
+	skb->csum_deferred = 1;
+	fail_unless (TRUE == pgm_parse_udp_encap (skb, NULL), "parse_udp_encap failed");
+	pgm_skb_pull (skb, sizeof(struct pgm_header));
+	fail_unless (FALSE == pgm_verify_checksum (skb), "corrupt packet verified");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_verify_checksum_copy (
+ *		const struct pgm_sk_buff_t* const restrict skb,
+ *		void*			    restrict dst,
+ *		const uint16_t			     copy_len
+ *	)
+ */
+
+START_TEST (test_verify_checksum_copy_pass_001)
+{
+	char buf[1024];
+	struct pgm_sk_buff_t* skb = generate_udp_encap_pgm ();
+	skb->csum_deferred = 1;
+	fail_unless (TRUE == pgm_parse_udp_encap (skb, NULL), "parse_udp_encap failed");
+	pgm_skb_pull (skb, sizeof(struct pgm_header) + sizeof(struct pgm_data));
+	fail_unless (TRUE == pgm_verify_checksum_copy (skb, buf, skb->len), "verify_checksum_copy failed");
+	fail_unless (0 == memcmp (buf, skb->data, skb->len), "copy mismatch");
+	fail_unless (1 == skb->csum_deferred, "skbuff modified");
+/* truncated to an odd length */
+	memset (buf, 0, sizeof(buf));
+	const uint16_t copy_len = (skb->len / 2) | 1;
+	fail_unless (TRUE == pgm_verify_checksum_copy (skb, buf, copy_len), "truncated verify_checksum_copy failed");
+	fail_unless (0 == memcmp (buf, skb->data, copy_len), "truncated copy mismatch");
+	fail_unless (0 == buf[ copy_len ], "copied beyond length");
+	fail_unless (TRUE == pgm_verify_checksum_copy (skb, NULL, 0), "zero length verify_checksum_copy failed");
+}
+END_TEST
+
+START_TEST (test_verify_checksum_copy_fail_001)
+{
+	char buf[1024];
+	struct pgm_sk_buff_t* skb = generate_udp_encap_pgm ();
+	((char*)skb->tail)[-1] ^= 0x1;
+	skb->csum_deferred = 1;
+	fail_unless (TRUE == pgm_parse_udp_encap (skb, NULL), "parse_udp_encap failed");
+	pgm_skb_pull (skb, sizeof(struct pgm_header) + sizeof(struct pgm_data));
+	fail_unless (FALSE == pgm_verify_checksum_copy (skb, buf, skb->len), "corrupt packet verified");
+/* corruption beyond a truncated copy is still detected */
+	fail_unless (FALSE == pgm_verify_checksum_copy (skb, buf, 1), "truncated corrupt packet verified");
+}
+END_TEST
+
 /* target:
  *	bool
  *	pgm_verify_spm (
@@ -334,6 +604,96 @@ START_TEST (test_verify_ncf_fail_001)
 }
 END_TEST
 
+/* ODATA with OPT_LENGTH, OPT_FRAGMENT and OPT_PGMCC_DATA, the last option
+ * flagged with OPT_END.
+ */
+
+static
+struct pgm_sk_buff_t*
+generate_odata_options (void)
+{
+	const guint16 opt_total_length = sizeof(struct pgm_opt_length) +
+					 sizeof(struct pgm_opt_header) + sizeof(struct pgm_opt_fragment) +
+					 sizeof(struct pgm_opt_header) + sizeof(struct pgm_opt_pgmcc_data);
+	struct pgm_sk_buff_t* skb = pgm_alloc_skb (1500);
+	skb->pgm_header = skb->head;
+	pgm_skb_put (skb, sizeof(struct pgm_header) + sizeof(struct pgm_data) + opt_total_length);
+	memset (skb->head, 0, skb->len);
+	skb->pgm_header->pgm_type	= PGM_ODATA;
+	skb->pgm_header->pgm_options	= PGM_OPT_PRESENT;
+	skb->pgm_data = (gpointer)(skb->pgm_header + 1);
+	struct pgm_opt_length* opt_len = (gpointer)(skb->pgm_data + 1);
+	opt_len->opt_type	= PGM_OPT_LENGTH;
+	opt_len->opt_length	= sizeof(struct pgm_opt_length);
+	opt_len->opt_total_length = g_htons (opt_total_length);
+	struct pgm_opt_header* opt_header = (gpointer)(opt_len + 1);
+	opt_header->opt_type	= PGM_OPT_FRAGMENT;
+	opt_header->opt_length	= sizeof(struct pgm_opt_header) + sizeof(struct pgm_opt_fragment);
+	opt_header = (gpointer)((char*)opt_header + opt_header->opt_length);
+	opt_header->opt_type	= PGM_OPT_PGMCC_DATA | PGM_OPT_END;
+	opt_header->opt_length	= sizeof(struct pgm_opt_header) + sizeof(struct pgm_opt_pgmcc_data);
+	return skb;
+}
+
+/* target:
+ *	bool
+ *	pgm_parse_options (
+ *		struct pgm_sk_buff_t* const	skb,
+ *		const void* const		opt_start
+ *	)
+ */
+
+START_TEST (test_parse_options_pass_001)
+{
+	struct pgm_sk_buff_t* skb = generate_odata_options ();
+	const struct pgm_opt_desc_t* desc = pgm_opt_desc_const (skb);
+	const guint16 opt_offset = sizeof(struct pgm_header) + sizeof(struct pgm_data) + sizeof(struct pgm_opt_length);
+	fail_unless (TRUE == pgm_parse_options (skb, skb->pgm_data + 1), "parse_options failed");
+	fail_unless (opt_offset == desc->opt_fragment, "fragment offset");
+	fail_unless (opt_offset + sizeof(struct pgm_opt_header) + sizeof(struct pgm_opt_fragment) == desc->opt_pgmcc_data, "pgmcc_data offset");
+	fail_unless (0 == desc->opt_nak_list, "unexpected nak_list");
+	fail_unless (NULL == pgm_opt_body (skb, desc->opt_batch), "unexpected batch");
+	fail_unless ((char*)skb->head + opt_offset + sizeof(struct pgm_opt_header) == pgm_opt_body (skb, desc->opt_fragment), "fragment body");
+}
+END_TEST
+
+/* no options present */
+START_TEST (test_parse_options_pass_002)
+{
+	struct pgm_sk_buff_t* skb = generate_odata_options ();
+	skb->pgm_header->pgm_options = 0;
+	memset (skb->cb, 0xff, sizeof(skb->cb));
+	fail_unless (TRUE == pgm_parse_options (skb, skb->pgm_data + 1), "parse_options failed");
+	fail_unless (0 == pgm_opt_desc_const (skb)->opt_total_length, "stale total length");
+	fail_unless (0 == pgm_opt_desc_const (skb)->opt_fragment, "stale fragment");
+}
+END_TEST
+
+/* malformed options: missing OPT_END, past packet end, zero length option */
+START_TEST (test_parse_options_fail_001)
+{
+	struct pgm_sk_buff_t* skb = generate_odata_options ();
+	struct pgm_opt_length* opt_len = (gpointer)(skb->pgm_data + 1);
+	struct pgm_opt_header* opt_header = (gpointer)(opt_len + 1);
+	struct pgm_opt_header* last_header = (gpointer)((char*)opt_header + opt_header->opt_length);
+	last_header->opt_type &= ~PGM_OPT_END;
+	fail_unless (FALSE == pgm_parse_options (skb, opt_len), "unterminated options parsed");
+	last_header->opt_type |= PGM_OPT_END;
+	skb->tail = (char*)skb->tail - 1;
+	fail_unless (FALSE == pgm_parse_options (skb, opt_len), "truncated options parsed");
+	skb->tail = (char*)skb->tail + 1;
+	opt_header->opt_length = 0;
+	fail_unless (FALSE == pgm_parse_options (skb, opt_len), "zero length option parsed");
+}
+END_TEST
+
+START_TEST (test_parse_options_fail_002)
+{
+	pgm_parse_options (NULL, NULL);
+	fail ("reached");
+}
+END_TEST
+
 
 static
 Suite*
@@ -356,6 +716,26 @@ make_test_suite (void)
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_parse_udp_encap, test_parse_udp_encap_fail_001, SIGABRT);
 #endif
+	tcase_add_test (tc_parse_udp_encap, test_parse_udp_encap_fail_002);
+	tcase_add_test (tc_parse_udp_encap, test_parse_udp_encap_fail_003);
+
+	TCase* tc_parse_screen = tcase_create ("parse-screen");
+	suite_add_tcase (s, tc_parse_screen);
+	tcase_add_test (tc_parse_screen, test_parse_screen_pass_001);
+	tcase_add_test (tc_parse_screen, test_parse_screen_fail_001);
+
+	TCase* tc_parse_compact = tcase_create ("parse-compact");
+	suite_add_tcase (s, tc_parse_compact);
+	tcase_add_test (tc_parse_compact, test_parse_compact_pass_001);
+	tcase_add_test (tc_parse_compact, test_parse_compact_pass_002);
+	tcase_add_test (tc_parse_compact, test_parse_compact_fail_001);
+
+	TCase* tc_verify_checksum = tcase_create ("verify-checksum");
+	suite_add_tcase (s, tc_verify_checksum);
+	tcase_add_test (tc_verify_checksum, test_verify_checksum_pass_001);
+	tcase_add_test (tc_verify_checksum, test_verify_checksum_fail_001);
+	tcase_add_test (tc_verify_checksum, test_verify_checksum_copy_pass_001);
+	tcase_add_test (tc_verify_checksum, test_verify_checksum_copy_fail_001);
 
 	TCase* tc_verify_spm = tcase_create ("verify-spm");
 	suite_add_tcase (s, tc_verify_spm);
@@ -391,6 +771,15 @@ make_test_suite (void)
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_verify_ncf, test_verify_ncf_fail_001, SIGABRT);
 #endif
+
+	TCase* tc_parse_options = tcase_create ("parse-options");
+	suite_add_tcase (s, tc_parse_options);
+	tcase_add_test (tc_parse_options, test_parse_options_pass_001);
+	tcase_add_test (tc_parse_options, test_parse_options_pass_002);
+	tcase_add_test (tc_parse_options, test_parse_options_fail_001);
+#ifndef PGM_CHECK_NOFORK
+	tcase_add_test_raise_signal (tc_parse_options, test_parse_options_fail_002, SIGABRT);
+#endif
 	return s;
 }
 
@@ -405,6 +794,9 @@ make_master_suite (void)
 int
 main (void)
 {
+	pgm_cpu_t cpu;
+	pgm_cpuid (&cpu);
+	pgm_checksum_init (&cpu);
 	SRunner* sr = srunner_create (make_master_suite ());
 	srunner_add_suite (sr, make_test_suite ());
 	srunner_run_all (sr, CK_ENV);
@@ -987,6 +987,38 @@ pgm_print_options (
 			printf ("OPT_CURR_TGSIZE ");
 			break;
 
+		case PGM_OPT_SW_PRM:
+			printf ("OPT_SW_PRM ");
+			break;
+
+		case PGM_OPT_SW_REPAIR:
+			printf ("OPT_SW_REPAIR ");
+			break;
+
+		case PGM_OPT_BATCH:
+			printf ("OPT_BATCH ");
+			break;
+
+		case PGM_OPT_CATCHUP:
+			printf ("OPT_CATCHUP ");
+			break;
+
+		case PGM_OPT_COMPRESS:
+			printf ("OPT_COMPRESS ");
+			break;
+
+		case PGM_OPT_CONFLATE:
+			printf ("OPT_CONFLATE ");
+			break;
+
+		case PGM_OPT_ACK_TRAIL:
+			printf ("OPT_ACK_TRAIL ");
+			break;
+
+		case PGM_OPT_CREDIT:
+			printf ("OPT_CREDIT ");
+			break;
+
 		case PGM_OPT_CR:
 			printf ("OPT_CR ");
 			break;
@@ -0,0 +1,261 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * open-addressing peer lookup table keyed by TSI.
+ *
+ * Replaces the chained pgm_hashtable_t for the per-packet peer search: one
+ * flat allocation for all entries, 8-byte keys compared inline, and a
+ * group of 16 candidate slots filtered per probe by comparing control
+ * bytes in one SSE2 operation.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <impl/framework.h>
+
+
+//#define PEERTABLE_DEBUG
+
+#define PEERTABLE_MIN_GROUPS	1
+#define PEERTABLE_MAX_GROUPS	(1U << 20)
+
+static
+unsigned
+capacity_of (
+	const unsigned		groups
+	)
+{
+	return groups * PGM_PEERTABLE_GROUP_WIDTH;
+}
+
+/* maximum load 7/8 including deleted slots, guarantees every probe sequence
+ * terminates on an empty slot.
+ */
+
+static
+unsigned
+growth_of (
+	const unsigned		capacity
+	)
+{
+	return capacity - capacity / 8;
+}
+
+/* bit i set for each free, i.e. empty or deleted, control byte in the group.
+ */
+
+static inline
+unsigned
+match_free (
+	const uint8_t*		ctrl
+	)
+{
+#if defined(__SSE2__) || defined(_M_AMD64) || defined(_M_X64)
+	return (unsigned)_mm_movemask_epi8 (_mm_loadu_si128 ((const __m128i*)ctrl));
+#else
+	unsigned mask = 0;
+	for (unsigned i = 0; i < PGM_PEERTABLE_GROUP_WIDTH; i++)
+		if (ctrl[i] & 0x80)
+			mask |= 1U << i;
+	return mask;
+#endif
+}
+
+static
+void
+alloc_groups (
+	pgm_peertable_t*	table,
+	const unsigned		groups
+	)
+{
+	const unsigned capacity = capacity_of (groups);
+	table->ctrl        = pgm_malloc (capacity);
+	table->slots       = pgm_new (struct pgm_peertable_slot_t, capacity);
+	table->group_mask  = groups - 1;
+	table->growth_left = growth_of (capacity) - table->size;
+	memset (table->ctrl, PGM_PEERTABLE_EMPTY, capacity);
+}
+
+/* first free slot on the probe sequence of hash.
+ */
+
+static
+unsigned
+find_free (
+	const pgm_peertable_t*	table,
+	const uint64_t		hash
+	)
+{
+	unsigned group = (unsigned)(hash >> 7) & table->group_mask;
+	for (unsigned step = 1;; step++) {
+		const unsigned base = group * PGM_PEERTABLE_GROUP_WIDTH;
+		const unsigned mask = match_free (&table->ctrl[ base ]);
+		if (mask)
+			return base + _pgm_peertable_ctz (mask);
+		group = (group + step) & table->group_mask;
+	}
+}
+
+static
+void
+set_slot (
+	pgm_peertable_t*	table,
+	const unsigned		i,
+	const uint64_t		hash,
+	const uint64_t		key,
+	struct pgm_peer_t*	value
+	)
+{
+	table->ctrl[ i ]        = (uint8_t)(hash & 0x7f);
+	table->slots[ i ].key   = key;
+	table->slots[ i ].value = value;
+}
+
+/* rebuild into a table of the given group count, dropping deleted slots.
+ */
+
+static
+void
+rehash (
+	pgm_peertable_t*	table,
+	const unsigned		groups
+	)
+{
+	uint8_t* old_ctrl = table->ctrl;
+	struct pgm_peertable_slot_t* old_slots = table->slots;
+	const unsigned old_capacity = capacity_of (table->group_mask + 1);
+
+#ifdef PEERTABLE_DEBUG
+	pgm_debug ("rehash %u -> %u groups, %u entries", table->group_mask + 1, groups, table->size);
+#endif
+	alloc_groups (table, groups);
+	for (unsigned i = 0; i < old_capacity; i++) {
+		if (old_ctrl[ i ] & 0x80)
+			continue;
+		const uint64_t hash = _pgm_peertable_hash (old_slots[ i ].key);
+		set_slot (table, find_free (table, hash), hash, old_slots[ i ].key, old_slots[ i ].value);
+	}
+	pgm_free (old_slots);
+	pgm_free (old_ctrl);
+}
+
+PGM_GNUC_INTERNAL
+pgm_peertable_t*
+pgm_peertable_new (void)
+{
+	pgm_peertable_t* table = pgm_new0 (pgm_peertable_t, 1);
+	alloc_groups (table, PEERTABLE_MIN_GROUPS);
+	return table;
+}
+
+/* entries are not owned by the table, references are released by the caller.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_peertable_destroy (
+	pgm_peertable_t*	table
+	)
+{
+	pgm_return_if_fail (NULL != table);
+
+	pgm_free (table->slots);
+	pgm_free (table->ctrl);
+	pgm_free (table);
+}
+
+PGM_GNUC_INTERNAL
+void
+pgm_peertable_insert (
+	pgm_peertable_t*   restrict table,
+	const pgm_tsi_t*   restrict tsi,
+	struct pgm_peer_t* restrict peer
+	)
+{
+	pgm_return_if_fail (NULL != table);
+	pgm_return_if_fail (NULL != tsi);
+	pgm_return_if_fail (NULL == pgm_peertable_lookup (table, tsi));
+
+	const uint64_t key  = _pgm_peertable_key (tsi);
+	const uint64_t hash = _pgm_peertable_hash (key);
+	unsigned i = find_free (table, hash);
+
+/* re-using a deleted slot does not consume growth */
+	if (PGM_UNLIKELY(0 == table->growth_left &&
+			 PGM_PEERTABLE_EMPTY == table->ctrl[ i ]))
+	{
+		const unsigned groups = table->group_mask + 1;
+/* grow when over half live, otherwise purge deleted slots in place */
+		if (table->size >= growth_of (capacity_of (groups)) / 2 &&
+		    groups < PEERTABLE_MAX_GROUPS)
+			rehash (table, groups * 2);
+		else
+			rehash (table, groups);
+		i = find_free (table, hash);
+	}
+	if (PGM_PEERTABLE_EMPTY == table->ctrl[ i ])
+		table->growth_left--;
+	set_slot (table, i, hash, key, peer);
+	table->size++;
+}
+
+PGM_GNUC_INTERNAL
+bool
+pgm_peertable_remove (
+	pgm_peertable_t* restrict table,
+	const pgm_tsi_t* restrict tsi
+	)
+{
+	pgm_return_val_if_fail (NULL != table, FALSE);
+	pgm_return_val_if_fail (NULL != tsi, FALSE);
+
+	const uint64_t key  = _pgm_peertable_key (tsi);
+	const uint64_t hash = _pgm_peertable_hash (key);
+	const uint8_t  h2   = (uint8_t)(hash & 0x7f);
+	unsigned group = (unsigned)(hash >> 7) & table->group_mask;
+
+	for (unsigned step = 1;; step++) {
+		const unsigned base = group * PGM_PEERTABLE_GROUP_WIDTH;
+		uint8_t* ctrl = &table->ctrl[ base ];
+		unsigned mask = _pgm_peertable_match (ctrl, h2);
+		while (mask) {
+			const unsigned i = base + _pgm_peertable_ctz (mask);
+			if (table->slots[ i ].key == key) {
+/* a probe never continues past a group with an empty slot, so the slot
+ * can be freed outright rather than left as a tombstone.
+ */
+				if (_pgm_peertable_match (ctrl, PGM_PEERTABLE_EMPTY)) {
+					table->ctrl[ i ] = PGM_PEERTABLE_EMPTY;
+					table->growth_left++;
+				} else {
+					table->ctrl[ i ] = PGM_PEERTABLE_DELETED;
+				}
+				table->slots[ i ].value = NULL;
+				table->size--;
+				return TRUE;
+			}
+			mask &= mask - 1;
+		}
+		if (_pgm_peertable_match (ctrl, PGM_PEERTABLE_EMPTY))
+			return FALSE;
+		group = (group + step) & table->group_mask;
+	}
+}
+
+/* eof */
@@ -0,0 +1,233 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * unit tests for the TSI peer lookup table.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <check.h>
+
+#ifdef _WIN32
+#	define PGM_CHECK_NOFORK		1
+#endif
+
+
+/* mock state */
+
+#define TEST_PEERS		1000
+
+/* mock functions for external references */
+
+size_t
+pgm_transport_pkt_offset2 (
+        const bool                      can_fragment,
+        const bool                      use_pgmcc
+        )
+{
+        return 0;
+}
+
+#define PEERTABLE_DEBUG
+#include "peertable.c"
+
+PGM_GNUC_INTERNAL
+int
+pgm_get_nprocs (void)
+{
+	return 1;
+}
+
+static
+void
+generate_tsi (
+	pgm_tsi_t*	tsi,
+	const unsigned	n
+	)
+{
+	const pgm_tsi_t base = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	*tsi = base;
+	tsi->gsi.identifier[4] = (uint8_t)(n >> 8);
+	tsi->gsi.identifier[5] = (uint8_t)n;
+	tsi->sport = g_htons ((guint16)(n * 7));
+}
+
+/* peer pointers are opaque to the table */
+#define TEST_PEER(n)	((struct pgm_peer_t*)(uintptr_t)(0x1000 + (n) * 8))
+
+/* target:
+ *	pgm_peertable_t*
+ *	pgm_peertable_new (void)
+ */
+
+START_TEST (test_new_pass_001)
+{
+	pgm_peertable_t* table = pgm_peertable_new ();
+	fail_if (NULL == table, "new failed");
+	fail_unless (0 == table->size, "size not zero");
+	pgm_peertable_destroy (table);
+}
+END_TEST
+
+/* target:
+ *	void
+ *	pgm_peertable_insert (
+ *		pgm_peertable_t*	table,
+ *		const pgm_tsi_t*	tsi,
+ *		struct pgm_peer_t*	peer
+ *	)
+ */
+
+/* insert through several resizes then find every entry */
+START_TEST (test_insert_pass_001)
+{
+	pgm_peertable_t* table = pgm_peertable_new ();
+	pgm_tsi_t tsi;
+	for (unsigned i = 0; i < TEST_PEERS; i++) {
+		generate_tsi (&tsi, i);
+		pgm_peertable_insert (table, &tsi, TEST_PEER(i));
+	}
+	fail_unless (TEST_PEERS == table->size, "size mismatch");
+	for (unsigned i = 0; i < TEST_PEERS; i++) {
+		generate_tsi (&tsi, i);
+		fail_unless (TEST_PEER(i) == pgm_peertable_lookup (table, &tsi), "lookup failed");
+	}
+	generate_tsi (&tsi, TEST_PEERS);
+	fail_unless (NULL == pgm_peertable_lookup (table, &tsi), "lookup of absent key failed");
+	pgm_peertable_destroy (table);
+}
+END_TEST
+
+/* duplicate key is refused */
+START_TEST (test_insert_pass_002)
+{
+	pgm_peertable_t* table = pgm_peertable_new ();
+	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	pgm_peertable_insert (table, &tsi, TEST_PEER(1));
+	pgm_peertable_insert (table, &tsi, TEST_PEER(2));
+	fail_unless (1 == table->size, "size mismatch");
+	fail_unless (TEST_PEER(1) == pgm_peertable_lookup (table, &tsi), "lookup failed");
+	pgm_peertable_destroy (table);
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_peertable_remove (
+ *		pgm_peertable_t*	table,
+ *		const pgm_tsi_t*	tsi
+ *	)
+ */
+
+START_TEST (test_remove_pass_001)
+{
+	pgm_peertable_t* table = pgm_peertable_new ();
+	pgm_tsi_t tsi;
+	for (unsigned i = 0; i < TEST_PEERS; i++) {
+		generate_tsi (&tsi, i);
+		pgm_peertable_insert (table, &tsi, TEST_PEER(i));
+	}
+	for (unsigned i = 1; i < TEST_PEERS; i += 2) {
+		generate_tsi (&tsi, i);
+		fail_unless (pgm_peertable_remove (table, &tsi), "remove failed");
+		fail_if (pgm_peertable_remove (table, &tsi), "repeat remove succeeded");
+	}
+	fail_unless (TEST_PEERS / 2 == table->size, "size mismatch");
+	for (unsigned i = 0; i < TEST_PEERS; i++) {
+		generate_tsi (&tsi, i);
+		fail_unless ((i & 1 ? NULL : TEST_PEER(i)) == pgm_peertable_lookup (table, &tsi), "lookup failed");
+	}
+	pgm_peertable_destroy (table);
+}
+END_TEST
+
+/* peer churn on a small population must recycle deleted slots rather than grow */
+START_TEST (test_remove_pass_002)
+{
+	pgm_peertable_t* table = pgm_peertable_new ();
+	pgm_tsi_t tsi;
+	for (unsigned i = 0; i < 20000; i++) {
+		generate_tsi (&tsi, i);
+		pgm_peertable_insert (table, &tsi, TEST_PEER(i));
+		if (i >= 8) {
+			generate_tsi (&tsi, i - 8);
+			fail_unless (pgm_peertable_remove (table, &tsi), "remove failed");
+		}
+	}
+	fail_unless (8 == table->size, "size mismatch");
+	fail_unless (table->group_mask < 2, "table grew on churn");
+	for (unsigned i = 20000 - 8; i < 20000; i++) {
+		generate_tsi (&tsi, i);
+		fail_unless (TEST_PEER(i) == pgm_peertable_lookup (table, &tsi), "lookup failed");
+	}
+	pgm_peertable_destroy (table);
+}
+END_TEST
+
+
+static
+Suite*
+make_test_suite (void)
+{
+	Suite* s;
+
+	s = suite_create (__FILE__);
+
+	TCase* tc_new = tcase_create ("new");
+	suite_add_tcase (s, tc_new);
+	tcase_add_test (tc_new, test_new_pass_001);
+
+	TCase* tc_insert = tcase_create ("insert");
+	suite_add_tcase (s, tc_insert);
+	tcase_add_test (tc_insert, test_insert_pass_001);
+	tcase_add_test (tc_insert, test_insert_pass_002);
+
+	TCase* tc_remove = tcase_create ("remove");
+	suite_add_tcase (s, tc_remove);
+	tcase_add_test (tc_remove, test_remove_pass_001);
+	tcase_add_test (tc_remove, test_remove_pass_002);
+
+	return s;
+}
+
+static
+Suite*
+make_master_suite (void)
+{
+	Suite* s = suite_create ("Master");
+	return s;
+}
+
+int
+main (void)
+{
+	pgm_messages_init();
+	SRunner* sr = srunner_create (make_master_suite ());
+	srunner_add_suite (sr, make_test_suite ());
+	srunner_run_all (sr, CK_ENV);
+	int number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	pgm_messages_shutdown();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof */
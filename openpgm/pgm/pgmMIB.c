@@ -26,23 +26,48 @@
 
 /* locals */
 
-struct pgm_snmp_data_context_t {
-	pgm_sock_t*	sock;
-	pgm_peer_t*	peer;
+/* tables are walked from a snapshot rebuilt at most every PGM_MIB_SNAPSHOT_IVL:
+ * sockets and peers are copied under the socket list lock and each peers
+ * read-side section, so a walk holds no lock the data path takes and every
+ * GETNEXT or GETBULK row is a step along an array.  the agent thread alone
+ * builds, swaps and walks snapshots, a superseded snapshot is freed when the
+ * last loop context lets go of it.
+ */
+
+#define PGM_MIB_SNAPSHOT_IVL	pgm_secs(1)
+
+struct pgm_mib_sock_row_t {
+	pgm_sock_t	sock;		/* copy, pointers not followed */
+	unsigned	bytes_buffered;
+	unsigned	msgs_buffered;
 };
 
-typedef struct pgm_snmp_data_context_t pgm_snmp_data_context_t;
+struct pgm_mib_peer_row_t {
+	const struct pgm_mib_sock_row_t*	sock_row;
+	pgm_peer_t	peer;		/* copy, pointers not followed */
+	pgm_rxw_t	window;
+};
+
+struct pgm_mib_snapshot_t {
+	unsigned	ref_count;
+	pgm_time_t	expiry;
+	unsigned	sock_len;
+	unsigned	peer_len;
+	struct pgm_mib_sock_row_t*	socks;
+	struct pgm_mib_peer_row_t*	peers;	/* instance is the row number */
+};
+
+typedef struct pgm_mib_snapshot_t pgm_mib_snapshot_t;
 
 struct pgm_snmp_context_t {
-	pgm_slist_t*	list;
-	pgm_list_t*	node;
-	int		index;		/* table index */
-	unsigned 	instance;	/* unique number per node */
-	pgm_snmp_data_context_t	data_context;
+	pgm_mib_snapshot_t*	snapshot;
+	unsigned		index;		/* next row */
 };
 
 typedef struct pgm_snmp_context_t pgm_snmp_context_t;
 
+static pgm_mib_snapshot_t*	mib_snapshot = NULL;
+
 
 static const oid snmptrap_oid[] = {1, 3, 6, 1, 6, 3, 1, 1, 4, 1, 0};
 
@@ -85,6 +110,105 @@ static Netsnmp_First_Data_Point pgmReceiverPerformanceTable_get_first_data_point
 static Netsnmp_Next_Data_Point pgmReceiverPerformanceTable_get_next_data_point;
 static Netsnmp_Free_Loop_Context pgmReceiverPerformanceTable_free_loop_context;
 
+/* copy every socket and its peers.
+ *
+ * returns snapshot with one reference.
+ */
+
+static
+pgm_mib_snapshot_t*
+mib_snapshot_build (
+	const pgm_time_t	now
+	)
+{
+	pgm_mib_snapshot_t* snapshot = pgm_new0 (pgm_mib_snapshot_t, 1);
+	unsigned peer_alloc = 0;
+
+	snapshot->ref_count = 1;
+	snapshot->expiry = now + PGM_MIB_SNAPSHOT_IVL;
+
+	pgm_rwlock_reader_lock (&pgm_sock_list_lock);
+	const unsigned sock_len = pgm_slist_length (pgm_sock_list);
+	if (sock_len > 0)
+		snapshot->socks = pgm_new0 (struct pgm_mib_sock_row_t, sock_len);
+	for (pgm_slist_t* list = pgm_sock_list;
+	     list;
+	     list = list->next)
+	{
+		pgm_sock_t* sock = (pgm_sock_t*)list->data;
+		struct pgm_mib_sock_row_t* sock_row = &snapshot->socks[ snapshot->sock_len++ ];
+		memcpy (&sock_row->sock, sock, sizeof(pgm_sock_t));
+		if (sock->can_send_data && NULL != sock->window) {
+			sock_row->bytes_buffered = (unsigned)pgm_txw_size (sock->window);
+			sock_row->msgs_buffered  = (unsigned)pgm_txw_length (sock->window);
+		}
+
+		const uint32_t epoch = pgm_peers_read_lock (sock);
+		for (pgm_list_t* node = sock->peers_list;
+		     node;
+		     node = node->next)
+		{
+			const pgm_peer_t* peer = (const pgm_peer_t*)node->data;
+			if (snapshot->peer_len == peer_alloc) {
+				peer_alloc = peer_alloc ? peer_alloc * 2 : 16;
+				snapshot->peers = pgm_realloc (snapshot->peers, peer_alloc * sizeof(struct pgm_mib_peer_row_t));
+			}
+			struct pgm_mib_peer_row_t* peer_row = &snapshot->peers[ snapshot->peer_len++ ];
+			peer_row->sock_row = sock_row;
+			memcpy (&peer_row->peer, peer, sizeof(pgm_peer_t));
+			if (NULL != peer->window)
+				memcpy (&peer_row->window, peer->window, sizeof(pgm_rxw_t));
+			else
+				memset (&peer_row->window, 0, sizeof(pgm_rxw_t));
+		}
+		pgm_peers_read_unlock (sock, epoch);
+	}
+	pgm_rwlock_reader_unlock (&pgm_sock_list_lock);
+
+	pgm_debug ("mib_snapshot_build (now:%" PGM_TIME_FORMAT ") socks:%u peers:%u",
+		now, snapshot->sock_len, snapshot->peer_len);
+	return snapshot;
+}
+
+static
+void
+mib_snapshot_unref (
+	pgm_mib_snapshot_t*	snapshot
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != snapshot);
+	pgm_assert (snapshot->ref_count > 0);
+
+	if (0 != --snapshot->ref_count)
+		return;
+	pgm_free (snapshot->socks);
+	pgm_free (snapshot->peers);
+	pgm_free (snapshot);
+}
+
+/* current snapshot for one table walk, replaced when expired.
+ *
+ * returns snapshot with a reference for the caller.
+ */
+
+static
+pgm_mib_snapshot_t*
+mib_snapshot_ref (void)
+{
+	const pgm_time_t now = pgm_time_update_now();
+
+	if (NULL == mib_snapshot || now >= mib_snapshot->expiry)
+	{
+		pgm_mib_snapshot_t* snapshot = mib_snapshot_build (now);
+		if (NULL != mib_snapshot)
+			mib_snapshot_unref (mib_snapshot);
+		mib_snapshot = snapshot;
+	}
+	mib_snapshot->ref_count++;
+	return mib_snapshot;
+}
+
 PGM_GNUC_INTERNAL
 bool
 pgm_mib_init (
@@ -137,6 +261,19 @@ pgm_mib_init (
 	return TRUE;
 }
 
+/* release the current snapshot after the agent thread has stopped.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_mib_shutdown (void)
+{
+	if (NULL != mib_snapshot) {
+		mib_snapshot_unref (mib_snapshot);
+		mib_snapshot = NULL;
+	}
+}
+
 /*
  * pgmSourceTable
  *
@@ -225,16 +362,16 @@ pgmSourceTable_get_first_data_point(
 		(const void*)put_index_data,
 		(const void*)mydata);
 
-	pgm_rwlock_reader_lock (&pgm_sock_list_lock);
+	pgm_mib_snapshot_t* snapshot = mib_snapshot_ref ();
 
-	if (NULL == pgm_sock_list) {
-		pgm_rwlock_reader_unlock (&pgm_sock_list_lock);
+	if (0 == snapshot->sock_len) {
+		mib_snapshot_unref (snapshot);
 		return NULL;
 	}
 
 /* create our own context for this SNMP loop */
 	pgm_snmp_context_t* context = pgm_new0 (pgm_snmp_context_t, 1);
-	context->list = pgm_sock_list;
+	context->snapshot = snapshot;
 	*my_loop_context = context;
 
 /* pass on for generic row access */
@@ -265,10 +402,11 @@ pgmSourceTable_get_next_data_point(
 	pgm_snmp_context_t* context = (pgm_snmp_context_t*)*my_loop_context;
 	netsnmp_variable_list *idx = put_index_data;
 
-	if (NULL == context->list)
+	if (context->index == context->snapshot->sock_len)
 		return NULL;
 
-	pgm_sock_t* sock = context->list->data;
+	const struct pgm_mib_sock_row_t* sock_row = &context->snapshot->socks[ context->index++ ];
+	const pgm_sock_t* sock = &sock_row->sock;
 
 /* pgmSourceGlobalId */
 	char gsi[ PGM_GSISTRLEN ];
@@ -280,9 +418,7 @@ pgmSourceTable_get_next_data_point(
 	const unsigned sport = pgm_ntohs (sock->tsi.sport);
 	snmp_set_var_typed_value (idx, ASN_UNSIGNED, (const u_char*)&sport, sizeof(sport));
 
-	*my_data_context = sock;
-	context->list = context->list->next;
-
+	*my_data_context = (void*)sock_row;
 	return put_index_data;
 }
 
@@ -302,10 +438,9 @@ pgmSourceTable_free_loop_context (
 		(const void*)mydata);
 
 	pgm_snmp_context_t* context = (pgm_snmp_context_t*)my_loop_context;
+	mib_snapshot_unref (context->snapshot);
 	pgm_free (context);
 	my_loop_context = NULL;
-
-	pgm_rwlock_reader_unlock (&pgm_sock_list_lock);
 }
 
 static
@@ -338,12 +473,14 @@ pgmSourceTable_handler (
 		     request;
 		     request = request->next)
 		{
-			const pgm_sock_t* sock = (pgm_sock_t*)netsnmp_extract_iterator_context (request);
-			if (NULL == sock) {
+			const struct pgm_mib_sock_row_t* sock_row = (const struct pgm_mib_sock_row_t*)netsnmp_extract_iterator_context (request);
+			if (NULL == sock_row) {
 				netsnmp_set_request_error (reqinfo, request, SNMP_NOSUCHINSTANCE);
 				continue;
 			}
 
+			const pgm_sock_t* sock = &sock_row->sock;
+
 			netsnmp_variable_list *var = request->requestvb;
 			netsnmp_table_request_info* table_info = netsnmp_extract_table_info (request);
 			if (NULL == table_info) {
@@ -503,16 +640,16 @@ pgmSourceConfigTable_get_first_data_point(
 		(const void*)put_index_data,
 		(const void*)mydata);
 
-	pgm_rwlock_reader_lock (&pgm_sock_list_lock);
+	pgm_mib_snapshot_t* snapshot = mib_snapshot_ref ();
 
-	if (NULL == pgm_sock_list) {
-		pgm_rwlock_reader_unlock (&pgm_sock_list_lock);
+	if (0 == snapshot->sock_len) {
+		mib_snapshot_unref (snapshot);
 		return NULL;
 	}
 
 /* create our own context for this SNMP loop */
 	pgm_snmp_context_t* context = pgm_new0 (pgm_snmp_context_t, 1);
-	context->list = pgm_sock_list;
+	context->snapshot = snapshot;
 	*my_loop_context = context;
 
 /* pass on for generic row access */
@@ -543,10 +680,11 @@ pgmSourceConfigTable_get_next_data_point(
 	pgm_snmp_context_t* context = (pgm_snmp_context_t*)*my_loop_context;
 	netsnmp_variable_list *idx = put_index_data;
 
-	if (NULL == context->list)
+	if (context->index == context->snapshot->sock_len)
 		return NULL;
 
-	pgm_sock_t* sock = context->list->data;
+	const struct pgm_mib_sock_row_t* sock_row = &context->snapshot->socks[ context->index++ ];
+	const pgm_sock_t* sock = &sock_row->sock;
 
 /* pgmSourceGlobalId */
 	char gsi[ PGM_GSISTRLEN ];
@@ -558,9 +696,7 @@ pgmSourceConfigTable_get_next_data_point(
 	const unsigned sport = pgm_ntohs (sock->tsi.sport);
 	snmp_set_var_typed_value (idx, ASN_UNSIGNED, (const u_char*)&sport, sizeof(sport));
 
-	*my_data_context = sock;
-	context->list = context->list->next;
-
+	*my_data_context = (void*)sock_row;
 	return put_index_data;
 }
 
@@ -580,10 +716,9 @@ pgmSourceConfigTable_free_loop_context (
 		(const void*)mydata);
 
 	pgm_snmp_context_t* context = (pgm_snmp_context_t*)my_loop_context;
+	mib_snapshot_unref (context->snapshot);
 	pgm_free (context);
 	my_loop_context = NULL;
-
-	pgm_rwlock_reader_unlock (&pgm_sock_list_lock);
 }
 
 static
@@ -616,12 +751,14 @@ pgmSourceConfigTable_handler (
 		     request;
 		     request = request->next)
 		{
-			const pgm_sock_t* sock = (pgm_sock_t*)netsnmp_extract_iterator_context (request);
-			if (NULL == sock) {
+			const struct pgm_mib_sock_row_t* sock_row = (const struct pgm_mib_sock_row_t*)netsnmp_extract_iterator_context (request);
+			if (NULL == sock_row) {
 				netsnmp_set_request_error (reqinfo, request, SNMP_NOSUCHINSTANCE);
 				continue;
 			}
 
+			const pgm_sock_t* sock = &sock_row->sock;
+
 			netsnmp_variable_list *var = request->requestvb;
 			netsnmp_table_request_info* table_info = netsnmp_extract_table_info (request);
 			if (NULL == table_info) {
@@ -756,7 +893,7 @@ pgmSourceConfigTable_handler (
 			case COLUMN_PGMSOURCESPMPATHADDRESS:
 				{
 					struct sockaddr_in s4;
-					if (AF_INET == sock->recv_gsr[0].gsr_source.ss_family)
+					if (sock->recv_gsr_len > 0 && AF_INET == sock->recv_gsr[0].gsr_source.ss_family)
 						memcpy (&s4, &sock->recv_gsr[0].gsr_source, sizeof(s4));
 					else
 						memset (&s4, 0, sizeof(s4));
@@ -866,16 +1003,16 @@ pgmSourcePerformanceTable_get_first_data_point (
 		(const void*)put_index_data,
 		(const void*)mydata);
 
-	pgm_rwlock_reader_lock (&pgm_sock_list_lock);
+	pgm_mib_snapshot_t* snapshot = mib_snapshot_ref ();
 
-	if (NULL == pgm_sock_list) {
-		pgm_rwlock_reader_unlock (&pgm_sock_list_lock);
+	if (0 == snapshot->sock_len) {
+		mib_snapshot_unref (snapshot);
 		return NULL;
 	}
 
 /* create our own context for this SNMP loop */
 	pgm_snmp_context_t* context = pgm_new0 (pgm_snmp_context_t, 1);
-	context->list = pgm_sock_list;
+	context->snapshot = snapshot;
 	*my_loop_context = context;
 
 /* pass on for generic row access */
@@ -906,10 +1043,11 @@ pgmSourcePerformanceTable_get_next_data_point (
 	pgm_snmp_context_t* context = (pgm_snmp_context_t*)*my_loop_context;
 	netsnmp_variable_list *idx = put_index_data;
 
-	if (NULL == context->list)
+	if (context->index == context->snapshot->sock_len)
 		return NULL;
 
-	pgm_sock_t* sock = context->list->data;
+	const struct pgm_mib_sock_row_t* sock_row = &context->snapshot->socks[ context->index++ ];
+	const pgm_sock_t* sock = &sock_row->sock;
 
 /* pgmSourceGlobalId */
 	char gsi[ PGM_GSISTRLEN ];
@@ -921,9 +1059,7 @@ pgmSourcePerformanceTable_get_next_data_point (
 	const unsigned sport = pgm_ntohs (sock->tsi.sport);
 	snmp_set_var_typed_value (idx, ASN_UNSIGNED, (const u_char*)&sport, sizeof(sport));
 
-	*my_data_context = sock;
-	context->list = context->list->next;
-
+	*my_data_context = (void*)sock_row;
 	return put_index_data;
 }
 
@@ -941,12 +1077,11 @@ pgmSourcePerformanceTable_free_loop_context (
         pgm_debug ("pgmPerformanceSourceTable_free_loop_context (my_loop_context:%p mydata:%p)",
                 (const void*)my_loop_context,
 		(const void*)mydata);
- 
+
 	pgm_snmp_context_t* context = (pgm_snmp_context_t*)my_loop_context;
+	mib_snapshot_unref (context->snapshot);
 	pgm_free (context);
 	my_loop_context = NULL;
-
-	pgm_rwlock_reader_unlock (&pgm_sock_list_lock);
 }
 
 static
@@ -979,13 +1114,13 @@ pgmSourcePerformanceTable_handler (
 		     request;
 		     request = request->next)
 		{
-			const pgm_sock_t* sock = (pgm_sock_t*)netsnmp_extract_iterator_context (request);
-			if (NULL == sock) {
+			const struct pgm_mib_sock_row_t* sock_row = (const struct pgm_mib_sock_row_t*)netsnmp_extract_iterator_context (request);
+			if (NULL == sock_row) {
 				netsnmp_set_request_error (reqinfo, request, SNMP_NOSUCHINSTANCE);
 				continue;
 			}
 
-			const pgm_txw_t* window = (const pgm_txw_t*)sock->window;
+			const pgm_sock_t* sock = &sock_row->sock;
 
 			netsnmp_variable_list *var = request->requestvb;
 			netsnmp_table_request_info* table_info = netsnmp_extract_table_info (request);
@@ -998,7 +1133,7 @@ pgmSourcePerformanceTable_handler (
 
 			case COLUMN_PGMSOURCEDATABYTESSENT:
 				{
-					const unsigned data_bytes = sock->cumulative_stats[PGM_PC_SOURCE_DATA_BYTES_SENT];
+					const unsigned data_bytes = (unsigned)pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_DATA_BYTES_SENT);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&data_bytes, sizeof(data_bytes) );
 				}
@@ -1006,7 +1141,7 @@ pgmSourcePerformanceTable_handler (
 
 			case COLUMN_PGMSOURCEDATAMSGSSENT:
 				{
-					const unsigned data_msgs = sock->cumulative_stats[PGM_PC_SOURCE_DATA_MSGS_SENT];
+					const unsigned data_msgs = (unsigned)pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_DATA_MSGS_SENT);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&data_msgs, sizeof(data_msgs) );
 				}
@@ -1014,7 +1149,7 @@ pgmSourcePerformanceTable_handler (
 
 			case COLUMN_PGMSOURCEBYTESBUFFERED:
 				{
-					const unsigned bytes_buffered = sock->can_send_data ? pgm_txw_size (window) : 0;
+					const unsigned bytes_buffered = sock_row->bytes_buffered;
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&bytes_buffered, sizeof(bytes_buffered) );
 				}
@@ -1022,7 +1157,7 @@ pgmSourcePerformanceTable_handler (
 
 			case COLUMN_PGMSOURCEMSGSBUFFERED:
 				{
-					const unsigned msgs_buffered = sock->can_send_data ? pgm_txw_length (window) : 0;
+					const unsigned msgs_buffered = sock_row->msgs_buffered;
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&msgs_buffered, sizeof(msgs_buffered) );
 				}
@@ -1031,7 +1166,7 @@ pgmSourcePerformanceTable_handler (
 /* PGM_PC_SOURCE_SELECTIVE_BYTES_RETRANSMITTED + COLUMN_PGMSOURCEPARITYBYTESRETRANSMITTED */
 			case COLUMN_PGMSOURCEBYTESRETRANSMITTED:
 				{
-					const unsigned bytes_resent = sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_BYTES_RETRANSMITTED];
+					const unsigned bytes_resent = (unsigned)pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_SELECTIVE_BYTES_RETRANSMITTED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&bytes_resent, sizeof(bytes_resent) );
 				}
@@ -1040,7 +1175,7 @@ pgmSourcePerformanceTable_handler (
 /* PGM_PC_SOURCE_SELECTIVE_MSGS_RETRANSMITTED + COLUMN_PGMSOURCEPARITYMSGSRETRANSMITTED */
 			case COLUMN_PGMSOURCEMSGSRETRANSMITTED:
 				{
-					const unsigned msgs_resent = sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_MSGS_RETRANSMITTED];
+					const unsigned msgs_resent = (unsigned)pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_SELECTIVE_MSGS_RETRANSMITTED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&msgs_resent, sizeof(msgs_resent) );
 				}
@@ -1048,7 +1183,7 @@ pgmSourcePerformanceTable_handler (
 
 			case COLUMN_PGMSOURCEBYTESSENT:
 				{
-					const unsigned bytes_sent = sock->cumulative_stats[PGM_PC_SOURCE_BYTES_SENT];
+					const unsigned bytes_sent = (unsigned)pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_BYTES_SENT);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&bytes_sent, sizeof(bytes_sent) );
 				}
@@ -1057,7 +1192,7 @@ pgmSourcePerformanceTable_handler (
 /* COLUMN_PGMSOURCEPARITYNAKPACKETSRECEIVED + COLUMN_PGMSOURCESELECTIVENAKPACKETSRECEIVED */
 			case COLUMN_PGMSOURCERAWNAKSRECEIVED:
 				{
-					const unsigned nak_packets = sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_NAKS_RECEIVED];
+					const unsigned nak_packets = (unsigned)pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_SELECTIVE_NAKS_RECEIVED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&nak_packets, sizeof(nak_packets) );
 				}
@@ -1066,7 +1201,7 @@ pgmSourcePerformanceTable_handler (
 /* PGM_PC_SOURCE_SELECTIVE_NAKS_IGNORED + COLUMN_PGMSOURCEPARITYNAKSIGNORED */
 			case COLUMN_PGMSOURCENAKSIGNORED:
 				{
-					const unsigned naks_ignored = sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_NAKS_IGNORED];
+					const unsigned naks_ignored = (unsigned)pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_SELECTIVE_NAKS_IGNORED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&naks_ignored, sizeof(naks_ignored) );
 				}
@@ -1074,7 +1209,7 @@ pgmSourcePerformanceTable_handler (
 
 			case COLUMN_PGMSOURCECKSUMERRORS:
 				{
-					const unsigned cksum_errors = sock->cumulative_stats[PGM_PC_SOURCE_CKSUM_ERRORS];
+					const unsigned cksum_errors = (unsigned)pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_CKSUM_ERRORS);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&cksum_errors, sizeof(cksum_errors) );
 				}
@@ -1082,7 +1217,7 @@ pgmSourcePerformanceTable_handler (
 
 			case COLUMN_PGMSOURCEMALFORMEDNAKS:
 				{
-					const unsigned malformed_naks = sock->cumulative_stats[PGM_PC_SOURCE_MALFORMED_NAKS];
+					const unsigned malformed_naks = (unsigned)pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_MALFORMED_NAKS);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&malformed_naks, sizeof(malformed_naks) );
 				}
@@ -1090,7 +1225,7 @@ pgmSourcePerformanceTable_handler (
 
 			case COLUMN_PGMSOURCEPACKETSDISCARDED:
 				{
-					const unsigned packets_discarded = sock->cumulative_stats[PGM_PC_SOURCE_PACKETS_DISCARDED];
+					const unsigned packets_discarded = (unsigned)pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_PACKETS_DISCARDED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&packets_discarded, sizeof(packets_discarded) );
 				}
@@ -1099,7 +1234,7 @@ pgmSourcePerformanceTable_handler (
 /* PGM_PC_SOURCE_SELECTIVE_NAKS_RECEIVED + COLUMN_PGMSOURCEPARITYNAKSRECEIVED */
 			case COLUMN_PGMSOURCENAKSRCVD:
 				{
-					const unsigned naks_received = sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_NAKS_RECEIVED];
+					const unsigned naks_received = (unsigned)pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_SELECTIVE_NAKS_RECEIVED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&naks_received, sizeof(naks_received) );
 				}
@@ -1116,7 +1251,7 @@ pgmSourcePerformanceTable_handler (
 
 			case COLUMN_PGMSOURCESELECTIVEBYTESRETRANSMITED:
 				{
-					const unsigned selective_bytes_resent = sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_BYTES_RETRANSMITTED];
+					const unsigned selective_bytes_resent = (unsigned)pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_SELECTIVE_BYTES_RETRANSMITTED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&selective_bytes_resent, sizeof(selective_bytes_resent) );
 				}
@@ -1133,7 +1268,7 @@ pgmSourcePerformanceTable_handler (
 
 			case COLUMN_PGMSOURCESELECTIVEMSGSRETRANSMITTED:
 				{
-					const unsigned selective_msgs_resent = sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_MSGS_RETRANSMITTED];
+					const unsigned selective_msgs_resent = (unsigned)pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_SELECTIVE_MSGS_RETRANSMITTED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&selective_msgs_resent, sizeof(selective_msgs_resent) );
 				}
@@ -1168,7 +1303,7 @@ pgmSourcePerformanceTable_handler (
 
 			case COLUMN_PGMSOURCESELECTIVENAKPACKETSRECEIVED:
 				{
-					const unsigned selective_nak_packets = sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_NAKS_RECEIVED];
+					const unsigned selective_nak_packets = (unsigned)pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_SELECTIVE_NAKS_RECEIVED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&selective_nak_packets, sizeof(selective_nak_packets) );
 				}
@@ -1185,7 +1320,7 @@ pgmSourcePerformanceTable_handler (
 
 			case COLUMN_PGMSOURCESELECTIVENAKSRECEIVED:
 				{
-					const unsigned selective_naks = sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_NAKS_RECEIVED];
+					const unsigned selective_naks = (unsigned)pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_SELECTIVE_NAKS_RECEIVED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&selective_naks, sizeof(selective_naks) );
 				}
@@ -1202,7 +1337,7 @@ pgmSourcePerformanceTable_handler (
 
 			case COLUMN_PGMSOURCESELECTIVENAKSIGNORED:
 				{
-					const unsigned selective_naks_ignored = sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_NAKS_IGNORED];
+					const unsigned selective_naks_ignored = (unsigned)pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_SELECTIVE_NAKS_IGNORED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&selective_naks_ignored, sizeof(selective_naks_ignored) );
 				}
@@ -1210,7 +1345,7 @@ pgmSourcePerformanceTable_handler (
 
 			case COLUMN_PGMSOURCEACKERRORS:
 				{
-					const unsigned ack_errors = sock->cumulative_stats[PGM_PC_SOURCE_ACK_ERRORS];;
+					const unsigned ack_errors = (unsigned)pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_ACK_ERRORS);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&ack_errors, sizeof(ack_errors) );
 				}
@@ -1231,7 +1366,7 @@ pgmSourcePerformanceTable_handler (
 
 			case COLUMN_PGMSOURCETRANSMISSIONCURRENTRATE:
 				{
-					const unsigned tx_current_rate = sock->cumulative_stats[PGM_PC_SOURCE_TRANSMISSION_CURRENT_RATE];
+					const unsigned tx_current_rate = (unsigned)pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_TRANSMISSION_CURRENT_RATE);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&tx_current_rate, sizeof(tx_current_rate) );
 				}
@@ -1239,7 +1374,7 @@ pgmSourcePerformanceTable_handler (
 
 			case COLUMN_PGMSOURCEACKPACKETSRECEIVED:
 				{
-					const unsigned ack_packets = sock->cumulative_stats[PGM_PC_SOURCE_ACK_PACKETS_RECEIVED];
+					const unsigned ack_packets = (unsigned)pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_ACK_PACKETS_RECEIVED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&ack_packets, sizeof(ack_packets) );
 				}
@@ -1248,7 +1383,7 @@ pgmSourcePerformanceTable_handler (
 /* COLUMN_PGMSOURCEPARITYNNAKPACKETSRECEIVED + COLUMN_PGMSOURCESELECTIVENNAKPACKETSRECEIVED */
 			case COLUMN_PGMSOURCENNAKPACKETSRECEIVED:
 				{
-					const unsigned nnak_packets = sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_NNAK_PACKETS_RECEIVED];
+					const unsigned nnak_packets = (unsigned)pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_SELECTIVE_NNAK_PACKETS_RECEIVED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&nnak_packets, sizeof(nnak_packets) );
 				}
@@ -1265,7 +1400,7 @@ pgmSourcePerformanceTable_handler (
 
 			case COLUMN_PGMSOURCESELECTIVENNAKPACKETSRECEIVED:
 				{
-					const unsigned selective_nnak_packets = sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_NNAK_PACKETS_RECEIVED];
+					const unsigned selective_nnak_packets = (unsigned)pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_SELECTIVE_NNAK_PACKETS_RECEIVED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&selective_nnak_packets, sizeof(selective_nnak_packets) );
 				}
@@ -1274,7 +1409,7 @@ pgmSourcePerformanceTable_handler (
 /* COLUMN_PGMSOURCEPARITYNNAKSRECEIVED + COLUMN_PGMSOURCESELECTIVENNAKSRECEIVED */
 			case COLUMN_PGMSOURCENNAKSRECEIVED:
 				{
-					const unsigned nnaks_received = sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_NNAKS_RECEIVED];
+					const unsigned nnaks_received = (unsigned)pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_SELECTIVE_NNAKS_RECEIVED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&nnaks_received, sizeof(nnaks_received) );
 				}
@@ -1291,7 +1426,7 @@ pgmSourcePerformanceTable_handler (
 
 			case COLUMN_PGMSOURCESELECTIVENNAKSRECEIVED:
 				{
-					const unsigned selective_nnaks = sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_NNAKS_RECEIVED];
+					const unsigned selective_nnaks = (unsigned)pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_SELECTIVE_NNAKS_RECEIVED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&selective_nnaks, sizeof(selective_nnaks) );
 				}
@@ -1299,7 +1434,7 @@ pgmSourcePerformanceTable_handler (
 
 			case COLUMN_PGMSOURCENNAKERRORS:
 				{
-					const unsigned malformed_nnaks = sock->cumulative_stats[PGM_PC_SOURCE_NNAK_ERRORS];
+					const unsigned malformed_nnaks = (unsigned)pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_NNAK_ERRORS);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&malformed_nnaks, sizeof(malformed_nnaks) );
 				}
@@ -1406,42 +1541,17 @@ pgmReceiverTable_get_first_data_point (
 		(const void*)put_index_data,
 		(const void*)mydata);
 
-	pgm_rwlock_reader_lock (&pgm_sock_list_lock);
+	pgm_mib_snapshot_t* snapshot = mib_snapshot_ref ();
 
-	if (NULL == pgm_sock_list) {
-		pgm_rwlock_reader_unlock (&pgm_sock_list_lock);
+	if (0 == snapshot->peer_len) {
+		mib_snapshot_unref (snapshot);
 		return NULL;
 	}
 
 /* create our own context for this SNMP loop */
 	pgm_snmp_context_t* context = pgm_new0 (pgm_snmp_context_t, 1);
-
-/* hunt to find first node, through all socks */
-	for (context->list = pgm_sock_list;
-	     context->list;
-	     context->list = context->list->next)
-	{
-/* and through all peers for each sock */
-		pgm_sock_t* sock = (pgm_sock_t*)context->list->data;
-		pgm_rwlock_reader_lock (&sock->peers_lock);
-		context->node = sock->peers_list;
-		if (context->node) {
-/* maintain this sock's peers lock */
-			break;
-		}
-
-		pgm_rwlock_reader_unlock (&sock->peers_lock);
-	}
-
-/* no node found */
-	if (NULL == context->node) {
-		pgm_free (context);
-		pgm_rwlock_reader_unlock (&pgm_sock_list_lock);
-		return NULL;
-	}
-
-	*my_loop_context = context; 
-	*my_data_context = &context->data_context;
+	context->snapshot = snapshot;
+	*my_loop_context = context;
 
 /* pass on for generic row access */
 	return pgmReceiverTable_get_next_data_point (my_loop_context, my_data_context, put_index_data, mydata);
@@ -1469,20 +1579,14 @@ pgmReceiverTable_get_next_data_point (
 		(const void*)mydata);
 
 	pgm_snmp_context_t* context = (pgm_snmp_context_t*)*my_loop_context;
-	pgm_snmp_data_context_t* data_context = (pgm_snmp_data_context_t*)*my_data_context;
 	netsnmp_variable_list *idx = put_index_data;
 
-	if (NULL == context->list)
-		return NULL;
-
-	pgm_sock_t* sock = context->list->data;
-	data_context->sock = sock;
-
-	if (NULL == context->node)
+	if (context->index == context->snapshot->peer_len)
 		return NULL;
 
-	pgm_peer_t* peer = context->node->data;
-	data_context->peer = peer;
+	const unsigned instance = context->index;
+	const struct pgm_mib_peer_row_t* peer_row = &context->snapshot->peers[ context->index++ ];
+	const pgm_peer_t* peer = &peer_row->peer;
 
 /* pgmReceiverGlobalId */
 	char gsi[ PGM_GSISTRLEN ];
@@ -1496,29 +1600,9 @@ pgmReceiverTable_get_next_data_point (
 	idx = idx->next_variable;
 
 /* pgmReceiverInstance */
-	const unsigned instance = context->instance++;
 	snmp_set_var_typed_value (idx, ASN_UNSIGNED, (const u_char*)&instance, sizeof(instance));
 
-/* hunt for next valid node */
-	if (context->node->next) {
-		context->node = context->node->next;
-	}
-	else
-	{
-		context->node = NULL;
-		while (context->list->next) {
-			pgm_rwlock_reader_unlock (&sock->peers_lock);
-			context->list = context->list->next;
-			sock = context->list->data;
-			pgm_rwlock_reader_lock (&sock->peers_lock);
-			context->node = sock->peers_list;
-			if (context->node) {
-/* keep lock */
-				break;
-			}
-		}
-	}
-
+	*my_data_context = (void*)peer_row;
 	return put_index_data;
 }
 
@@ -1538,17 +1622,9 @@ pgmReceiverTable_free_loop_context (
 		(const void*)mydata);
 
 	pgm_snmp_context_t* context = (pgm_snmp_context_t*)my_loop_context;
-
-/* check for intra-peer state */
-	if (context->list) {
-		pgm_sock_t* sock = context->list->data;
-		pgm_rwlock_reader_unlock (&sock->peers_lock);
-	}
-
+	mib_snapshot_unref (context->snapshot);
 	pgm_free (context);
 	my_loop_context = NULL;
-
-	pgm_rwlock_reader_unlock (&pgm_sock_list_lock);
 }
 
 static
@@ -1581,14 +1657,14 @@ pgmReceiverTable_handler (
 		     request;
 		     request = request->next)
 		{
-			const pgm_snmp_data_context_t* data_context = (pgm_snmp_data_context_t*)netsnmp_extract_iterator_context (request);
-			if (!data_context) {
+			const struct pgm_mib_peer_row_t* peer_row = (const struct pgm_mib_peer_row_t*)netsnmp_extract_iterator_context (request);
+			if (NULL == peer_row) {
 				netsnmp_set_request_error (reqinfo, request, SNMP_NOSUCHINSTANCE);
 				continue;
 			}
 
-			const pgm_sock_t* sock = data_context->sock;
-			const pgm_peer_t* peer = data_context->peer;
+			const pgm_sock_t* sock = &peer_row->sock_row->sock;
+			const pgm_peer_t* peer = &peer_row->peer;
 
 			netsnmp_variable_list *var = request->requestvb;
 			netsnmp_table_request_info* table_info = netsnmp_extract_table_info(request);
@@ -1771,40 +1847,17 @@ pgmReceiverConfigTable_get_first_data_point(
 		(const void*)put_index_data,
 		(const void*)mydata);
 
-	pgm_rwlock_reader_lock (&pgm_sock_list_lock);
+	pgm_mib_snapshot_t* snapshot = mib_snapshot_ref ();
 
-	if (NULL == pgm_sock_list) {
-		pgm_rwlock_reader_unlock (&pgm_sock_list_lock);
+	if (0 == snapshot->peer_len) {
+		mib_snapshot_unref (snapshot);
 		return NULL;
 	}
 
 /* create our own context for this SNMP loop */
 	pgm_snmp_context_t* context = pgm_new0 (pgm_snmp_context_t, 1);
-
-/* hunt to find first node, through all socks */
-	for (context->list = pgm_sock_list;
-	     context->list;
-	     context->list = context->list->next)
-	{
-/* and through all peers for each sock */
-		pgm_sock_t* sock = (pgm_sock_t*)context->list->data;
-		pgm_rwlock_reader_lock (&sock->peers_lock);
-		context->node = sock->peers_list;
-		if (context->node)
-			break;
-
-		pgm_rwlock_reader_unlock (&sock->peers_lock);
-	}
-
-/* no node found */
-	if (NULL == context->node) {
-		pgm_free (context);
-		pgm_rwlock_reader_unlock (&pgm_sock_list_lock);
-		return NULL;
-	}
-
-	*my_loop_context = context; 
-	*my_data_context = NULL;
+	context->snapshot = snapshot;
+	*my_loop_context = context;
 
 /* pass on for generic row access */
 	return pgmReceiverConfigTable_get_next_data_point (my_loop_context, my_data_context, put_index_data, mydata);
@@ -1834,16 +1887,12 @@ pgmReceiverConfigTable_get_next_data_point(
 	pgm_snmp_context_t* context = (pgm_snmp_context_t*)*my_loop_context;
 	netsnmp_variable_list *idx = put_index_data;
 
-	if (NULL == context->list)
+	if (context->index == context->snapshot->peer_len)
 		return NULL;
 
-	pgm_sock_t* sock = context->list->data;
-	*my_data_context = sock;
-
-	if (NULL == context->node)
-		return NULL;
-
-	pgm_peer_t* peer = context->node->data;
+	const unsigned instance = context->index;
+	const struct pgm_mib_peer_row_t* peer_row = &context->snapshot->peers[ context->index++ ];
+	const pgm_peer_t* peer = &peer_row->peer;
 
 /* pgmReceiverGlobalId */
 	char gsi[ PGM_GSISTRLEN ];
@@ -1857,29 +1906,9 @@ pgmReceiverConfigTable_get_next_data_point(
 	idx = idx->next_variable;
 
 /* pgmReceiverInstance */
-	const unsigned instance = context->instance++;
 	snmp_set_var_typed_value (idx, ASN_UNSIGNED, (const u_char*)&instance, sizeof(instance));
 
-/* hunt for next valid node */
-	if (context->node->next) {
-		context->node = context->node->next;
-	}
-	else
-	{
-		context->node = NULL;
-		while (context->list->next) {
-			pgm_rwlock_reader_unlock (&sock->peers_lock);
-			context->list = context->list->next;
-			sock = context->list->data;
-			pgm_rwlock_reader_lock (&sock->peers_lock);
-			context->node = sock->peers_list;
-			if (context->node) {
-/* keep lock */
-				break;
-			}
-		}
-	}
-
+	*my_data_context = (void*)peer_row;
 	return put_index_data;
 }
 
@@ -1899,17 +1928,9 @@ pgmReceiverConfigTable_free_loop_context (
 		(const void*)mydata);
 
 	pgm_snmp_context_t* context = (pgm_snmp_context_t*)my_loop_context;
-
-/* check for intra-peer state */
-	if (context->list) {
-		pgm_sock_t* sock = context->list->data;
-		pgm_rwlock_reader_unlock (&sock->peers_lock);
-	}
-
+	mib_snapshot_unref (context->snapshot);
 	pgm_free (context);
 	my_loop_context = NULL;
-
-	pgm_rwlock_reader_unlock (&pgm_sock_list_lock);
 }
 
 static
@@ -1942,12 +1963,14 @@ pgmReceiverConfigTable_handler (
 		     request;
 		     request = request->next)
 		{
-			const pgm_sock_t* sock = (pgm_sock_t*)netsnmp_extract_iterator_context(request);
-			if (NULL == sock) {
+			const struct pgm_mib_peer_row_t* peer_row = (const struct pgm_mib_peer_row_t*)netsnmp_extract_iterator_context (request);
+			if (NULL == peer_row) {
 				netsnmp_set_request_error (reqinfo, request, SNMP_NOSUCHINSTANCE);
 				continue;
 			}
 
+			const pgm_sock_t* sock = &peer_row->sock_row->sock;
+
 			netsnmp_variable_list *var = request->requestvb;
 			netsnmp_table_request_info* table_info = netsnmp_extract_table_info(request);
 
@@ -2159,40 +2182,17 @@ pgmReceiverPerformanceTable_get_first_data_point (
 		(const void*)put_index_data,
 		(const void*)mydata);
 
-	pgm_rwlock_reader_lock (&pgm_sock_list_lock);
+	pgm_mib_snapshot_t* snapshot = mib_snapshot_ref ();
 
-	if (NULL == pgm_sock_list) {
-		pgm_rwlock_reader_unlock (&pgm_sock_list_lock);
+	if (0 == snapshot->peer_len) {
+		mib_snapshot_unref (snapshot);
 		return NULL;
 	}
 
 /* create our own context for this SNMP loop */
 	pgm_snmp_context_t* context = pgm_new0 (pgm_snmp_context_t, 1);
-
-/* hunt to find first node, through all socks */
-	for (context->list = pgm_sock_list;
-	     context->list;
-	     context->list = context->list->next)
-	{
-/* and through all peers for each sock */
-		pgm_sock_t* sock = (pgm_sock_t*)context->list->data;
-		pgm_rwlock_reader_lock (&sock->peers_lock);
-		context->node = sock->peers_list;
-		if (context->node)
-			break;
-
-		pgm_rwlock_reader_unlock (&sock->peers_lock);
-	}
-
-/* no node found */
-	if (NULL == context->node) {
-		pgm_free (context);
-		pgm_rwlock_reader_unlock (&pgm_sock_list_lock);
-		return NULL;
-	}
-
-	*my_loop_context = context; 
-	*my_data_context = &context->data_context;
+	context->snapshot = snapshot;
+	*my_loop_context = context;
 
 /* pass on for generic row access */
 	return pgmReceiverPerformanceTable_get_next_data_point (my_loop_context, my_data_context, put_index_data, mydata);
@@ -2220,20 +2220,14 @@ pgmReceiverPerformanceTable_get_next_data_point (
 		(const void*)mydata);
 
 	pgm_snmp_context_t* context = (pgm_snmp_context_t*)*my_loop_context;
-	pgm_snmp_data_context_t* data_context = (pgm_snmp_data_context_t*)*my_data_context;
 	netsnmp_variable_list *idx = put_index_data;
 
-	if (NULL == context->list)
-		return NULL;
-
-	pgm_sock_t* sock = context->list->data;
-	data_context->sock = sock;
-
-	if (NULL == context->node)
+	if (context->index == context->snapshot->peer_len)
 		return NULL;
 
-	pgm_peer_t* peer = context->node->data;
-	data_context->peer = peer;
+	const unsigned instance = context->index;
+	const struct pgm_mib_peer_row_t* peer_row = &context->snapshot->peers[ context->index++ ];
+	const pgm_peer_t* peer = &peer_row->peer;
 
 /* pgmReceiverGlobalId */
 	char gsi[ PGM_GSISTRLEN ];
@@ -2247,28 +2241,9 @@ pgmReceiverPerformanceTable_get_next_data_point (
 	idx = idx->next_variable;
 
 /* pgmReceiverInstance */
-	const unsigned instance = context->instance++;
 	snmp_set_var_typed_value (idx, ASN_UNSIGNED, (const u_char*)&instance, sizeof(instance));
 
-/* hunt for next valid node */
-	if (context->node->next) {
-		context->node = context->node->next;
-	}
-	else
-	{
-		context->node = NULL;
-		while (context->list->next) {
-			pgm_rwlock_reader_unlock (&sock->peers_lock);
-			context->list = context->list->next;
-			sock = context->list->data;
-			pgm_rwlock_reader_lock (&sock->peers_lock);
-			context->node = sock->peers_list;
-
-			if (context->node)
-				break;
-		}
-	}
-
+	*my_data_context = (void*)peer_row;
 	return put_index_data;
 }
 
@@ -2288,17 +2263,9 @@ pgmReceiverPerformanceTable_free_loop_context (
 		(const void*)mydata);
 
 	pgm_snmp_context_t* context = (pgm_snmp_context_t*)my_loop_context;
-
-/* check for intra-peer state */
-	if (context->list) {
-		pgm_sock_t* sock = context->list->data;
-		pgm_rwlock_reader_unlock (&sock->peers_lock);
-	}
-
+	mib_snapshot_unref (context->snapshot);
 	pgm_free (context);
 	my_loop_context = NULL;
-
-	pgm_rwlock_reader_unlock (&pgm_sock_list_lock);
 }
 
 static
@@ -2331,15 +2298,15 @@ pgmReceiverPerformanceTable_handler (
 		     request;
 		     request = request->next)
 		{
-			const pgm_snmp_data_context_t* data_context = (pgm_snmp_data_context_t*)netsnmp_extract_iterator_context (request);
-			if (NULL == data_context) {
+			const struct pgm_mib_peer_row_t* peer_row = (const struct pgm_mib_peer_row_t*)netsnmp_extract_iterator_context (request);
+			if (NULL == peer_row) {
 				netsnmp_set_request_error (reqinfo, request, SNMP_NOSUCHINSTANCE);
 				continue;
 			}
 
-			const pgm_sock_t* sock = data_context->sock;
-			const pgm_peer_t* peer = data_context->peer;
-			const pgm_rxw_t* window = peer->window;
+			const pgm_sock_t* sock = &peer_row->sock_row->sock;
+			const pgm_peer_t* peer = &peer_row->peer;
+			const pgm_rxw_t* window = &peer_row->window;
 
 			netsnmp_variable_list *var = request->requestvb;
 			netsnmp_table_request_info* table_info = netsnmp_extract_table_info (request);
@@ -2353,7 +2320,7 @@ pgmReceiverPerformanceTable_handler (
 
 			case COLUMN_PGMRECEIVERDATABYTESRECEIVED:
 				{
-					const unsigned data_bytes = peer->cumulative_stats[PGM_PC_RECEIVER_DATA_BYTES_RECEIVED];
+					const unsigned data_bytes = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_DATA_BYTES_RECEIVED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&data_bytes, sizeof(data_bytes) );
 				}
@@ -2361,7 +2328,7 @@ pgmReceiverPerformanceTable_handler (
 		
 			case COLUMN_PGMRECEIVERDATAMSGSRECEIVED:
 				{
-					const unsigned data_msgs = peer->cumulative_stats[PGM_PC_RECEIVER_DATA_MSGS_RECEIVED];
+					const unsigned data_msgs = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_DATA_MSGS_RECEIVED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&data_msgs, sizeof(data_msgs) );
 				}
@@ -2370,7 +2337,7 @@ pgmReceiverPerformanceTable_handler (
 /* total */
 			case COLUMN_PGMRECEIVERNAKSSENT:
 				{
-					const unsigned naks_sent = peer->cumulative_stats[PGM_PC_RECEIVER_SELECTIVE_NAKS_SENT];
+					const unsigned naks_sent = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_SELECTIVE_NAKS_SENT);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&naks_sent, sizeof(naks_sent) );
 				}
@@ -2379,7 +2346,7 @@ pgmReceiverPerformanceTable_handler (
 /* total */	
 			case COLUMN_PGMRECEIVERNAKSRETRANSMITTED:
 				{
-					const unsigned naks_resent = peer->cumulative_stats[PGM_PC_RECEIVER_SELECTIVE_NAKS_RETRANSMITTED];
+					const unsigned naks_resent = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_SELECTIVE_NAKS_RETRANSMITTED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&naks_resent, sizeof(naks_resent) );
 				}
@@ -2388,7 +2355,7 @@ pgmReceiverPerformanceTable_handler (
 /* total */	
 			case COLUMN_PGMRECEIVERNAKFAILURES:
 				{
-					const unsigned nak_failures = peer->cumulative_stats[PGM_PC_RECEIVER_SELECTIVE_NAKS_FAILED];
+					const unsigned nak_failures = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_SELECTIVE_NAKS_FAILED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&nak_failures, sizeof(nak_failures) );
 				}
@@ -2396,7 +2363,7 @@ pgmReceiverPerformanceTable_handler (
 		
 			case COLUMN_PGMRECEIVERBYTESRECEIVED:
 				{
-					const unsigned bytes_received = peer->cumulative_stats[PGM_PC_RECEIVER_BYTES_RECEIVED];
+					const unsigned bytes_received = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_BYTES_RECEIVED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&bytes_received, sizeof(bytes_received) );
 				}
@@ -2405,7 +2372,7 @@ pgmReceiverPerformanceTable_handler (
 /* total */	
 			case COLUMN_PGMRECEIVERNAKSSUPPRESSED:
 				{
-					const unsigned naks_suppressed = peer->cumulative_stats[PGM_PC_RECEIVER_SELECTIVE_NAKS_SUPPRESSED];
+					const unsigned naks_suppressed = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_SELECTIVE_NAKS_SUPPRESSED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&naks_suppressed, sizeof(naks_suppressed) );
 				}
@@ -2414,7 +2381,7 @@ pgmReceiverPerformanceTable_handler (
 /* bogus: same as source checksum errors */	
 			case COLUMN_PGMRECEIVERCKSUMERRORS:
 				{
-					const unsigned cksum_errors = sock->cumulative_stats[PGM_PC_SOURCE_CKSUM_ERRORS];
+					const unsigned cksum_errors = (unsigned)pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_CKSUM_ERRORS);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&cksum_errors, sizeof(cksum_errors) );
 				}
@@ -2422,7 +2389,7 @@ pgmReceiverPerformanceTable_handler (
 		
 			case COLUMN_PGMRECEIVERMALFORMEDSPMS:
 				{
-					const unsigned malformed_spms = peer->cumulative_stats[PGM_PC_RECEIVER_MALFORMED_SPMS];
+					const unsigned malformed_spms = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_MALFORMED_SPMS);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&malformed_spms, sizeof(malformed_spms) );
 				}
@@ -2430,7 +2397,7 @@ pgmReceiverPerformanceTable_handler (
 		
 			case COLUMN_PGMRECEIVERMALFORMEDODATA:
 				{
-					const unsigned malformed_odata = peer->cumulative_stats[PGM_PC_RECEIVER_MALFORMED_ODATA];
+					const unsigned malformed_odata = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_MALFORMED_ODATA);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&malformed_odata, sizeof(malformed_odata) );
 				}
@@ -2438,7 +2405,7 @@ pgmReceiverPerformanceTable_handler (
 		
 			case COLUMN_PGMRECEIVERMALFORMEDRDATA:
 				{
-					const unsigned malformed_rdata = peer->cumulative_stats[PGM_PC_RECEIVER_MALFORMED_RDATA];
+					const unsigned malformed_rdata = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_MALFORMED_RDATA);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&malformed_rdata, sizeof(malformed_rdata) );
 				}
@@ -2446,7 +2413,7 @@ pgmReceiverPerformanceTable_handler (
 		
 			case COLUMN_PGMRECEIVERMALFORMEDNCFS:
 				{
-					const unsigned malformed_ncfs = peer->cumulative_stats[PGM_PC_RECEIVER_MALFORMED_NCFS];
+					const unsigned malformed_ncfs = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_MALFORMED_NCFS);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&malformed_ncfs, sizeof(malformed_ncfs) );
 				}
@@ -2454,7 +2421,7 @@ pgmReceiverPerformanceTable_handler (
 		
 			case COLUMN_PGMRECEIVERPACKETSDISCARDED:
 				{
-					const unsigned packets_discarded = peer->cumulative_stats[PGM_PC_RECEIVER_PACKETS_DISCARDED];
+					const unsigned packets_discarded = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_PACKETS_DISCARDED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&packets_discarded, sizeof(packets_discarded) );
 				}
@@ -2462,7 +2429,7 @@ pgmReceiverPerformanceTable_handler (
 		
 			case COLUMN_PGMRECEIVERLOSSES:
 				{
-					const unsigned losses = window->cumulative_losses;
+					const unsigned losses = (unsigned)window->cumulative_losses;
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&losses, sizeof(losses) );
 				}
@@ -2470,7 +2437,7 @@ pgmReceiverPerformanceTable_handler (
 		
 			case COLUMN_PGMRECEIVERBYTESDELIVEREDTOAPP:
 				{
-					const unsigned bytes_delivered = window->bytes_delivered;
+					const unsigned bytes_delivered = (unsigned)window->bytes_delivered;
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&bytes_delivered, sizeof(bytes_delivered) );
 				}
@@ -2478,7 +2445,7 @@ pgmReceiverPerformanceTable_handler (
 		
 			case COLUMN_PGMRECEIVERMSGSDELIVEREDTOAPP:
 				{
-					const unsigned msgs_delivered = window->msgs_delivered;
+					const unsigned msgs_delivered = (unsigned)window->msgs_delivered;
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&msgs_delivered, sizeof(msgs_delivered) );
 				}
@@ -2486,7 +2453,7 @@ pgmReceiverPerformanceTable_handler (
 		
 			case COLUMN_PGMRECEIVERDUPSPMS:
 				{
-					const unsigned dup_spms = peer->cumulative_stats[PGM_PC_RECEIVER_DUP_SPMS];
+					const unsigned dup_spms = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_DUP_SPMS);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&dup_spms, sizeof(dup_spms) );
 				}
@@ -2494,7 +2461,7 @@ pgmReceiverPerformanceTable_handler (
 		
 			case COLUMN_PGMRECEIVERDUPDATAS:
 				{
-					const unsigned dup_data = peer->cumulative_stats[PGM_PC_RECEIVER_DUP_DATAS];
+					const unsigned dup_data = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_DUP_DATAS);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&dup_data, sizeof(dup_data) );
 				}
@@ -2512,7 +2479,7 @@ pgmReceiverPerformanceTable_handler (
 /* COLUMN_PGMRECEIVERPARITYNAKPACKETSSENT + COLUMN_PGMRECEIVERSELECTIVENAKPACKETSSENT */	
 			case COLUMN_PGMRECEIVERNAKPACKETSSENT:
 				{
-					const unsigned nak_packets = peer->cumulative_stats[PGM_PC_RECEIVER_SELECTIVE_NAK_PACKETS_SENT];
+					const unsigned nak_packets = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_SELECTIVE_NAK_PACKETS_SENT);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&nak_packets, sizeof(nak_packets) );
 				}
@@ -2529,7 +2496,7 @@ pgmReceiverPerformanceTable_handler (
 		
 			case COLUMN_PGMRECEIVERSELECTIVENAKPACKETSSENT:
 				{
-					const unsigned nak_packets = peer->cumulative_stats[PGM_PC_RECEIVER_SELECTIVE_NAK_PACKETS_SENT];
+					const unsigned nak_packets = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_SELECTIVE_NAK_PACKETS_SENT);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&nak_packets, sizeof(nak_packets) );
 				}
@@ -2546,7 +2513,7 @@ pgmReceiverPerformanceTable_handler (
 		
 			case COLUMN_PGMRECEIVERSELECTIVENAKSSENT:
 				{
-					const unsigned naks_sent = peer->cumulative_stats[PGM_PC_RECEIVER_SELECTIVE_NAKS_SENT];
+					const unsigned naks_sent = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_SELECTIVE_NAKS_SENT);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&naks_sent, sizeof(naks_sent) );
 				}
@@ -2563,7 +2530,7 @@ pgmReceiverPerformanceTable_handler (
 		
 			case COLUMN_PGMRECEIVERSELECTIVENAKSRETRANSMITTED:
 				{
-					const unsigned naks_resent = peer->cumulative_stats[PGM_PC_RECEIVER_SELECTIVE_NAKS_RETRANSMITTED];
+					const unsigned naks_resent = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_SELECTIVE_NAKS_RETRANSMITTED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&naks_resent, sizeof(naks_resent) );
 				}
@@ -2572,7 +2539,7 @@ pgmReceiverPerformanceTable_handler (
 /* COLUMN_PGMRECEIVERPARITYNAKSFAILED + COLUMN_PGMRECEIVERSELECTIVENAKSFAILED */	
 			case COLUMN_PGMRECEIVERNAKSFAILED:
 				{
-					const unsigned naks_failed = peer->cumulative_stats[PGM_PC_RECEIVER_SELECTIVE_NAKS_FAILED];
+					const unsigned naks_failed = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_SELECTIVE_NAKS_FAILED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&naks_failed, sizeof(naks_failed) );
 				}
@@ -2589,7 +2556,7 @@ pgmReceiverPerformanceTable_handler (
 		
 			case COLUMN_PGMRECEIVERSELECTIVENAKSFAILED:
 				{
-					const unsigned naks_failed = peer->cumulative_stats[PGM_PC_RECEIVER_SELECTIVE_NAKS_FAILED];
+					const unsigned naks_failed = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_SELECTIVE_NAKS_FAILED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&naks_failed, sizeof(naks_failed) );
 				}
@@ -2597,7 +2564,7 @@ pgmReceiverPerformanceTable_handler (
 		
 			case COLUMN_PGMRECEIVERNAKSFAILEDRXWADVANCED:
 				{
-					const unsigned rxw_failed = peer->cumulative_stats[PGM_PC_RECEIVER_NAKS_FAILED_RXW_ADVANCED];
+					const unsigned rxw_failed = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_NAKS_FAILED_RXW_ADVANCED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&rxw_failed, sizeof(rxw_failed) );
 				}
@@ -2605,7 +2572,7 @@ pgmReceiverPerformanceTable_handler (
 		
 			case COLUMN_PGMRECEIVERNAKSFALEDNCFRETRIESEXCEEDED:
 				{
-					const unsigned ncf_retries = peer->cumulative_stats[PGM_PC_RECEIVER_NAKS_FAILED_NCF_RETRIES_EXCEEDED];
+					const unsigned ncf_retries = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_NAKS_FAILED_NCF_RETRIES_EXCEEDED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&ncf_retries, sizeof(ncf_retries) );
 				}
@@ -2613,24 +2580,24 @@ pgmReceiverPerformanceTable_handler (
 		
 			case COLUMN_PGMRECEIVERNAKSFAILEDDATARETRIESEXCEEDED:
 				{
-					const unsigned data_retries = peer->cumulative_stats[PGM_PC_RECEIVER_NAKS_FAILED_DATA_RETRIES_EXCEEDED];
+					const unsigned data_retries = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_NAKS_FAILED_DATA_RETRIES_EXCEEDED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&data_retries, sizeof(data_retries) );
 				}
 				break;
 	
-/* FIXED: 0 - absolutely no idea what this means */	
+/* repairs abandoned at the delivery deadline */
 			case COLUMN_PGMRECEIVERNAKSFAILEDGENEXPIRED:
 				{
-					const unsigned happy_pandas = 0;
+					const unsigned gen_expired = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_NAKS_FAILED_GEN_EXPIRED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
-								  (const u_char*)&happy_pandas, sizeof(happy_pandas) );
+								  (const u_char*)&gen_expired, sizeof(gen_expired) );
 				}
 				break;
 		
 			case COLUMN_PGMRECEIVERNAKFAILURESDELIVERED:
 				{
-					const unsigned delivered = peer->cumulative_stats[PGM_PC_RECEIVER_NAK_FAILURES_DELIVERED];
+					const unsigned delivered = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_NAK_FAILURES_DELIVERED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&delivered, sizeof(delivered) );
 				}
@@ -2647,7 +2614,7 @@ pgmReceiverPerformanceTable_handler (
 		
 			case COLUMN_PGMRECEIVERSELECTIVENAKSSUPPRESSED:
 				{
-					const unsigned suppressed = peer->cumulative_stats[PGM_PC_RECEIVER_SELECTIVE_NAKS_SUPPRESSED];
+					const unsigned suppressed = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_SELECTIVE_NAKS_SUPPRESSED);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&suppressed, sizeof(suppressed) );
 				}
@@ -2655,7 +2622,7 @@ pgmReceiverPerformanceTable_handler (
 		
 			case COLUMN_PGMRECEIVERNAKERRORS:
 				{
-					const unsigned malformed_naks = peer->cumulative_stats[PGM_PC_RECEIVER_NAK_ERRORS];
+					const unsigned malformed_naks = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_NAK_ERRORS);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&malformed_naks, sizeof(malformed_naks) );
 				}
@@ -2702,7 +2669,7 @@ pgmReceiverPerformanceTable_handler (
 		
 			case COLUMN_PGMRECEIVERNAKSVCTIMEMEAN:
 				{
-					const unsigned mean_repair_time = peer->cumulative_stats[PGM_PC_RECEIVER_NAK_SVC_TIME_MEAN];
+					const unsigned mean_repair_time = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_NAK_SVC_TIME_MEAN);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&mean_repair_time, sizeof(mean_repair_time) );
 				}
@@ -2726,7 +2693,7 @@ pgmReceiverPerformanceTable_handler (
 		
 			case COLUMN_PGMRECEIVERNAKFAILTIMEMEAN:
 				{
-					const unsigned mean_fail_time = peer->cumulative_stats[PGM_PC_RECEIVER_NAK_FAIL_TIME_MEAN];
+					const unsigned mean_fail_time = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_NAK_FAIL_TIME_MEAN);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&mean_fail_time, sizeof(mean_fail_time) );
 				}
@@ -2750,7 +2717,7 @@ pgmReceiverPerformanceTable_handler (
 		
 			case COLUMN_PGMRECEIVERNAKTRANSMITMEAN:
 				{
-					const unsigned mean_transmit_count = peer->cumulative_stats[PGM_PC_RECEIVER_TRANSMIT_MEAN];
+					const unsigned mean_transmit_count = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_TRANSMIT_MEAN);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&mean_transmit_count, sizeof(mean_transmit_count) );
 				}
@@ -2766,7 +2733,7 @@ pgmReceiverPerformanceTable_handler (
 	
 			case COLUMN_PGMRECEIVERACKSSENT:
 				{
-					const unsigned acks_sent = peer->cumulative_stats[PGM_PC_RECEIVER_ACKS_SENT];
+					const unsigned acks_sent = (unsigned)pgm_stats_read (&peer->cumulative_stats, 1, PGM_PC_RECEIVER_ACKS_SENT);
 					snmp_set_var_typed_value (var, ASN_COUNTER, /* ASN_COUNTER32 */
 								  (const u_char*)&acks_sent, sizeof(acks_sent) );
 				}
@@ -0,0 +1,592 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * performance tests for PGM transmit and receive windows, Reed-Solomon coding,
+ * rate control, hash tables and packet parsing.
+ *
+ * every measurement is written to stdout as one JSON object per line:
+ *
+ *   {"suite":"txw","test":"add","param":"tsdu=1000","iterations":100000,"elapsed_us":5230,"ns_per_op":52.30}
+ *
+ * usage: pgm_perftest [-n iterations] [suite ...]
+ *
+ * Copyright (c) 2010-2016 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#	include <pthread.h>
+#	include <arpa/inet.h>
+#else
+#	include <process.h>
+#endif
+#include <impl/framework.h>
+#include <impl/txw.h>
+#include <impl/rxw.h>
+#include <impl/packet_parse.h>
+
+
+#define PERF_TSI		{ { { 1, 2, 3, 4, 5, 6 } }, 1000 }
+#define PERF_TPDU		1500
+#define PERF_TSDU		1000
+#define PERF_WINDOW_SQNS	4096
+#define PERF_MAX_THREADS	8
+
+PGM_GNUC_INTERNAL void pgm_checksum_init (const pgm_cpu_t*);
+
+static unsigned perf_iterations = 100000;
+
+/* one result line, elapsed time in microseconds */
+
+static
+void
+perf_report (
+	const char*		suite,
+	const char*		test,
+	const char*		param,
+	const unsigned		iterations,
+	const pgm_time_t	elapsed
+	)
+{
+	printf ("{\"suite\":\"%s\",\"test\":\"%s\",\"param\":\"%s\",\"iterations\":%u,\"elapsed_us\":%" PGM_TIME_FORMAT ",\"ns_per_op\":%.2f}\n",
+		suite, test, param, iterations, elapsed,
+		iterations ? ((double)elapsed * 1000.0) / iterations : 0.0);
+	fflush (stdout);
+}
+
+/* ODATA skb as the source constructs it, sequence numbers are assigned by the
+ * transmit window or set by the caller for the receive window.
+ */
+
+static
+struct pgm_sk_buff_t*
+perf_data_skb (
+	const uint16_t		tsdu_length
+	)
+{
+	const pgm_tsi_t tsi = PERF_TSI;
+	const uint16_t header_length = sizeof(struct pgm_header) + sizeof(struct pgm_data);
+	struct pgm_sk_buff_t* skb = pgm_alloc_skb (PERF_TPDU);
+	memcpy (&skb->tsi, &tsi, sizeof(tsi));
+	skb->sock = (pgm_sock_t*)0x1;
+	skb->tstamp = skb->wire_tstamp = 1;
+	pgm_skb_reserve (skb, header_length);
+	memset (skb->head, 0, header_length);
+	skb->pgm_header = (struct pgm_header*)skb->head;
+	skb->pgm_data   = (struct pgm_data*)(skb->pgm_header + 1);
+	skb->pgm_header->pgm_type = PGM_ODATA;
+	skb->pgm_header->pgm_tsdu_length = htons (tsdu_length);
+	pgm_skb_put (skb, tsdu_length);
+	return skb;
+}
+
+/* transmit window: append with eviction of the trail, and random access of
+ * recent history as performed for selective repairs.
+ */
+
+static
+void
+perf_txw (void)
+{
+	const pgm_tsi_t tsi = PERF_TSI;
+	const unsigned iterations = perf_iterations;
+	struct pgm_sk_buff_t** skbs = pgm_new (struct pgm_sk_buff_t*, iterations);
+	pgm_txw_t* window = pgm_txw_create (&tsi, PERF_TPDU, PERF_WINDOW_SQNS, 0, 0, FALSE, 0, 0, NULL);
+	pgm_time_t start, check;
+
+/* the transmit window stamps its own identity on added skbs */
+	for (unsigned i = 0; i < iterations; i++) {
+		skbs[i] = perf_data_skb (PERF_TSDU);
+		memset (&skbs[i]->tsi, 0, sizeof(pgm_tsi_t));
+	}
+
+	start = pgm_time_update_now();
+	for (unsigned i = 0; i < iterations; i++)
+		pgm_txw_add (window, skbs[i]);
+	check = pgm_time_update_now();
+	perf_report ("txw", "add", "tsdu=1000", iterations, check - start);
+
+	const uint32_t lead = pgm_txw_lead (window);
+	unsigned found = 0;
+	start = pgm_time_update_now();
+	for (unsigned i = 0; i < iterations; i++) {
+		const uint32_t sequence = lead - (uint32_t)((i * 2654435761U) % (PERF_WINDOW_SQNS - 1));
+		if (NULL != pgm_txw_peek (window, sequence))
+			found++;
+	}
+	check = pgm_time_update_now();
+	perf_report ("txw", "peek", "window=4096", iterations, check - start);
+	if (found != iterations)
+		fprintf (stderr, "txw peek: %u of %u sequences missing\n", iterations - found, iterations);
+
+	pgm_txw_shutdown (window);
+	pgm_free (skbs);
+}
+
+/* receive window: every loss_period'th sequence is withheld then repaired at the
+ * end of each window of data, 0 for in-order delivery.  the window is drained
+ * with readv between windows, outside of the measured add.
+ */
+
+static
+void
+perf_rxw_add (
+	const unsigned		loss_period
+	)
+{
+	const pgm_tsi_t tsi = PERF_TSI;
+	const unsigned windows = (perf_iterations + PERF_WINDOW_SQNS - 1) / PERF_WINDOW_SQNS;
+	const unsigned batch = PERF_WINDOW_SQNS / 2;
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, PERF_TPDU, PERF_WINDOW_SQNS, 0, 0, 0, NULL);
+	struct pgm_sk_buff_t** skbs = pgm_new (struct pgm_sk_buff_t*, batch);
+	struct pgm_msgv_t msgv[64], *pmsg;
+	pgm_time_t elapsed = 0, read_elapsed = 0, start;
+	unsigned added = 0, rejected = 0, read = 0;
+	uint32_t sequence = 0;
+	char param[32];
+
+	for (unsigned w = 0; w < windows; w++)
+	{
+		for (unsigned i = 0; i < batch; i++) {
+			skbs[i] = perf_data_skb (PERF_TSDU);
+			skbs[i]->pgm_data->data_sqn   = htonl (sequence + i);
+			skbs[i]->pgm_data->data_trail = htonl (sequence);
+		}
+		start = pgm_time_update_now();
+		for (unsigned i = 0; i < batch; i++) {
+			if (loss_period && 0 == ((sequence + i + 1) % loss_period))
+				continue;
+			if (pgm_rxw_add (window, skbs[i], 1, 2) >= PGM_RXW_DUPLICATE)
+				rejected++;
+			added++;
+		}
+		if (loss_period) {
+			for (unsigned i = 0; i < batch; i++) {
+				if (0 != ((sequence + i + 1) % loss_period))
+					continue;
+				skbs[i]->pgm_header->pgm_type = PGM_RDATA;
+				if (pgm_rxw_add (window, skbs[i], 1, 2) >= PGM_RXW_DUPLICATE)
+					rejected++;
+				added++;
+			}
+		}
+		elapsed += pgm_time_update_now() - start;
+
+		start = pgm_time_update_now();
+		do {
+			pmsg = msgv;
+			const ssize_t bytes_read = pgm_rxw_readv (window, &pmsg, PGM_N_ELEMENTS(msgv));
+			if (bytes_read <= 0)
+				break;
+			read += (unsigned)(pmsg - msgv);
+		} while (1);
+		pgm_rxw_remove_commit (window);
+		read_elapsed += pgm_time_update_now() - start;
+		sequence += batch;
+	}
+
+	if (loss_period) {
+		sprintf (param, "loss=1/%u", loss_period);
+		perf_report ("rxw", "add", param, added, elapsed);
+	} else {
+		perf_report ("rxw", "add", "in-order", added, elapsed);
+		perf_report ("rxw", "readv", "msgv=64", read, read_elapsed);
+	}
+	if (rejected)
+		fprintf (stderr, "rxw add: %u of %u sequences rejected\n", rejected, added);
+
+	pgm_rxw_destroy (window);
+	pgm_free (skbs);
+}
+
+static
+void
+perf_rxw (void)
+{
+	perf_rxw_add (0);
+	perf_rxw_add (100);
+	perf_rxw_add (10);
+	perf_rxw_add (2);
+}
+
+/* Reed-Solomon encode of one parity packet and repair of the first h packets of
+ * a transmission group with parity inline and appended.
+ */
+
+static
+void
+perf_rs_group (
+	const uint8_t		n,
+	const uint8_t		k,
+	const uint8_t		h
+	)
+{
+	const uint16_t len = PERF_TSDU;
+	const unsigned iterations = MAX(1, perf_iterations / (10U * k));
+	pgm_rs_t rs;
+	pgm_gf8_t* originals[UINT8_MAX];
+	pgm_gf8_t* block[UINT8_MAX];
+	uint8_t offsets[UINT8_MAX];
+	pgm_time_t start, check;
+	char param[32];
+
+	pgm_rs_create (&rs, n, k);
+	for (unsigned i = 0; i < n; i++) {
+		originals[i] = pgm_malloc (len);
+		block[i] = pgm_malloc (len);
+		for (unsigned j = 0; j < len; j++)
+			originals[i][j] = (pgm_gf8_t)((i * 31) + (j * 7));
+	}
+	sprintf (param, "n=%u,k=%u,h=%u", n, k, h);
+
+	start = pgm_time_update_now();
+	for (unsigned i = 0; i < iterations; i++)
+		pgm_rs_encode (&rs, (const pgm_gf8_t**)originals, k + (i % (n - k)), block[0], len);
+	check = pgm_time_update_now();
+	perf_report ("rs", "encode", param, iterations, check - start);
+
+/* erased packets replaced by parity in the same position */
+	pgm_time_t elapsed = 0;
+	for (unsigned i = 0; i < iterations; i++) {
+		for (unsigned j = 0; j < k; j++) {
+			offsets[j] = j;
+			memcpy (block[j], originals[j], len);
+		}
+		for (unsigned e = 0; e < h; e++) {
+			offsets[e] = k + e;
+			pgm_rs_encode (&rs, (const pgm_gf8_t**)originals, offsets[e], block[e], len);
+		}
+		start = pgm_time_update_now();
+		pgm_rs_decode_parity_inline (&rs, block, offsets, len);
+		elapsed += pgm_time_update_now() - start;
+	}
+	perf_report ("rs", "decode_parity_inline", param, iterations, elapsed);
+
+/* parity appended after the original group, erasures decoded in place */
+	elapsed = 0;
+	for (unsigned i = 0; i < iterations; i++) {
+		for (unsigned j = 0; j < k; j++) {
+			offsets[j] = j;
+			memcpy (block[j], originals[j], len);
+		}
+		for (unsigned e = 0; e < h; e++) {
+			offsets[e] = k + e;
+			pgm_rs_encode (&rs, (const pgm_gf8_t**)originals, offsets[e], block[k + e], len);
+			memset (block[e], 0, len);
+		}
+		start = pgm_time_update_now();
+		pgm_rs_decode_parity_appended (&rs, block, NULL, offsets, len);
+		elapsed += pgm_time_update_now() - start;
+	}
+	perf_report ("rs", "decode_parity_appended", param, iterations, elapsed);
+	if (0 != memcmp (block[0], originals[0], len))
+		fprintf (stderr, "rs %s: repair mismatch\n", param);
+
+	for (unsigned i = 0; i < n; i++) {
+		pgm_free (originals[i]);
+		pgm_free (block[i]);
+	}
+	pgm_rs_destroy (&rs);
+}
+
+static
+void
+perf_rs (void)
+{
+	perf_rs_group (255, 4, 1);
+	perf_rs_group (255, 16, 1);
+	perf_rs_group (255, 16, 4);
+	perf_rs_group (255, 64, 8);
+	perf_rs_group (255, 128, 16);
+	perf_rs_group (255, 223, 32);
+}
+
+/* rate control: major and minor buckets shared by every thread, the limit is
+ * beyond reach so that only the token accounting is measured.
+ */
+
+struct perf_rate_arg_t {
+	pgm_rate_t*	major;
+	pgm_rate_t*	minor;
+	unsigned	iterations;
+};
+
+#ifndef _WIN32
+static
+void*
+#else
+static
+unsigned
+__stdcall
+#endif
+perf_rate_routine (
+	void*			arg
+	)
+{
+	const struct perf_rate_arg_t* rate_arg = arg;
+	for (unsigned i = 0; i < rate_arg->iterations; i++)
+		(void)pgm_rate_check2 (rate_arg->major, rate_arg->minor, PERF_TPDU, TRUE);
+#ifndef _WIN32
+	return NULL;
+#else
+	_endthread();
+	return 0;
+#endif
+}
+
+static
+void
+perf_rate (void)
+{
+	pgm_rate_t major, minor;
+	struct perf_rate_arg_t rate_arg;
+	pgm_time_t start, check;
+	char param[32];
+
+	pgm_rate_create (&major, INT32_MAX, 0, PERF_TPDU);
+	pgm_rate_create (&minor, INT32_MAX, 0, PERF_TPDU);
+	rate_arg.major = &major;
+	rate_arg.minor = &minor;
+
+	for (unsigned thread_count = 1; thread_count <= PERF_MAX_THREADS; thread_count *= 2)
+	{
+#ifndef _WIN32
+		pthread_t threads[PERF_MAX_THREADS];
+#else
+		HANDLE threads[PERF_MAX_THREADS];
+#endif
+		rate_arg.iterations = perf_iterations;
+		start = pgm_time_update_now();
+		for (unsigned i = 0; i < thread_count; i++) {
+#ifndef _WIN32
+			pthread_create (&threads[i], NULL, &perf_rate_routine, &rate_arg);
+#else
+			threads[i] = (HANDLE)_beginthreadex (NULL, 0, &perf_rate_routine, &rate_arg, 0, NULL);
+#endif
+		}
+		for (unsigned i = 0; i < thread_count; i++) {
+#ifndef _WIN32
+			pthread_join (threads[i], NULL);
+#else
+			WaitForSingleObject (threads[i], INFINITE);
+			CloseHandle (threads[i]);
+#endif
+		}
+		check = pgm_time_update_now();
+		sprintf (param, "threads=%u", thread_count);
+		perf_report ("rate", "check2", param, thread_count * perf_iterations, check - start);
+	}
+
+	pgm_rate_destroy (&minor);
+	pgm_rate_destroy (&major);
+}
+
+/* hash table: TSI keyed lookup of the peer table, hits and misses */
+
+static
+void
+perf_hashtable_lookup (
+	const unsigned		peers
+	)
+{
+	pgm_hashtable_t* table = pgm_hashtable_new (pgm_tsi_hash, pgm_tsi_equal);
+	pgm_tsi_t* tsis = pgm_new0 (pgm_tsi_t, peers);
+	pgm_time_t start, check;
+	unsigned found = 0;
+	char param[32];
+
+	for (unsigned i = 0; i < peers; i++) {
+		memcpy (&tsis[i].gsi, &i, sizeof(i));
+		tsis[i].sport = htons ((uint16_t)(1000 + i));
+		pgm_hashtable_insert (table, &tsis[i], &tsis[i]);
+	}
+	sprintf (param, "peers=%u", peers);
+
+	start = pgm_time_update_now();
+	for (unsigned i = 0; i < perf_iterations; i++)
+		if (NULL != pgm_hashtable_lookup (table, &tsis[ (i * 2654435761U) % peers ]))
+			found++;
+	check = pgm_time_update_now();
+	perf_report ("hashtable", "lookup_hit", param, perf_iterations, check - start);
+	if (found != perf_iterations)
+		fprintf (stderr, "hashtable %s: %u lookups missed\n", param, perf_iterations - found);
+
+	pgm_tsi_t miss;
+	memset (&miss, 0xff, sizeof(miss));
+	start = pgm_time_update_now();
+	for (unsigned i = 0; i < perf_iterations; i++) {
+		miss.sport = (uint16_t)i;
+		if (NULL != pgm_hashtable_lookup (table, &miss))
+			found++;
+	}
+	check = pgm_time_update_now();
+	perf_report ("hashtable", "lookup_miss", param, perf_iterations, check - start);
+
+	pgm_hashtable_destroy (table);
+	pgm_free (tsis);
+}
+
+static
+void
+perf_hashtable (void)
+{
+	perf_hashtable_lookup (1);
+	perf_hashtable_lookup (64);
+	perf_hashtable_lookup (4096);
+}
+
+/* packet parsing: raw IPv4 ODATA as received on a raw socket */
+
+static
+void
+perf_parse_raw_tsdu (
+	const uint16_t		tsdu_length
+	)
+{
+	struct pgm_sk_buff_t* skb = pgm_alloc_skb (PERF_TPDU);
+	struct sockaddr_storage addr;
+	pgm_error_t* err = NULL;
+	const uint16_t tpdu_length = sizeof(struct pgm_ip) + sizeof(struct pgm_header) + sizeof(struct pgm_data) + tsdu_length;
+	pgm_time_t start, check;
+	unsigned parsed = 0;
+	char param[32];
+
+	memset (skb->head, 0, tpdu_length);
+	skb->sock = (pgm_sock_t*)0x1;
+	skb->tstamp = 1;
+
+	struct pgm_ip* iphdr = skb->head;
+	iphdr->ip_hl		= sizeof(struct pgm_ip) / 4;
+	iphdr->ip_v		= 4;
+#ifndef HAVE_HOST_ORDER_IP_LEN
+	iphdr->ip_len		= htons (tpdu_length);
+#else
+	iphdr->ip_len		= tpdu_length;
+#endif
+	iphdr->ip_ttl		= 16;
+	iphdr->ip_p		= IPPROTO_PGM;
+	iphdr->ip_src.s_addr	= htonl (0x7f000001);
+	iphdr->ip_dst.s_addr	= htonl (0xef000001);
+
+	struct pgm_header* header = (struct pgm_header*)(iphdr + 1);
+	const pgm_tsi_t tsi = PERF_TSI;
+	memcpy (header->pgm_gsi, &tsi.gsi, sizeof(pgm_gsi_t));
+	header->pgm_sport	= htons (tsi.sport);
+	header->pgm_dport	= htons (7500);
+	header->pgm_type	= PGM_ODATA;
+	header->pgm_tsdu_length = htons (tsdu_length);
+	struct pgm_data* data = (struct pgm_data*)(header + 1);
+	data->data_trail	= htonl ((uint32_t)-1);
+	header->pgm_checksum	= pgm_csum_fold (pgm_csum_partial (header, tpdu_length - sizeof(struct pgm_ip), 0));
+	iphdr->ip_sum		= pgm_inet_checksum (iphdr, sizeof(struct pgm_ip), 0);
+
+	start = pgm_time_update_now();
+	for (unsigned i = 0; i < perf_iterations; i++) {
+		skb->data = skb->head;
+		skb->len  = tpdu_length;
+		skb->tail = (char*)skb->data + skb->len;
+		if (pgm_parse_raw (skb, (struct sockaddr*)&addr, &err))
+			parsed++;
+		else
+			pgm_error_free (err), err = NULL;
+	}
+	check = pgm_time_update_now();
+	sprintf (param, "tsdu=%u", tsdu_length);
+	perf_report ("packet", "parse_raw", param, perf_iterations, check - start);
+	if (parsed != perf_iterations)
+		fprintf (stderr, "packet %s: %u parses failed\n", param, perf_iterations - parsed);
+	pgm_free_skb (skb);
+}
+
+static
+void
+perf_parse_raw (void)
+{
+	perf_parse_raw_tsdu (100);
+	perf_parse_raw_tsdu (1400);
+}
+
+static const struct {
+	const char*	name;
+	void	      (*run)(void);
+} perf_suites[] = {
+	{ "txw",	perf_txw },
+	{ "rxw",	perf_rxw },
+	{ "rs",		perf_rs },
+	{ "rate",	perf_rate },
+	{ "hashtable",	perf_hashtable },
+	{ "packet",	perf_parse_raw }
+};
+
+int
+main (
+	int		argc,
+	char*		argv[]
+	)
+{
+	pgm_cpu_t cpu;
+	bool has_filter = FALSE;
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		if (0 == strcmp (argv[i], "-n") && i + 1 < argc) {
+			perf_iterations = (unsigned)strtoul (argv[++i], NULL, 10);
+			if (0 == perf_iterations) {
+				fprintf (stderr, "usage: %s [-n iterations] [suite ...]\n", argv[0]);
+				return EXIT_FAILURE;
+			}
+		} else
+			has_filter = TRUE;
+	}
+
+/* framework as initialised by pgm_init() without any sockets */
+	pgm_cpuid (&cpu);
+	pgm_messages_init();
+	pgm_thread_init();
+	pgm_mem_init();
+	pgm_rand_init();
+	if (!pgm_time_init (NULL)) {
+		fprintf (stderr, "timing initialisation failed\n");
+		return EXIT_FAILURE;
+	}
+	pgm_checksum_init (&cpu);
+	pgm_rs_init (&cpu);
+
+	for (unsigned s = 0; s < PGM_N_ELEMENTS(perf_suites); s++) {
+		bool is_selected = !has_filter;
+		for (i = 1; i < argc && !is_selected; i++) {
+			if (0 == strcmp (argv[i], "-n"))
+				i++;
+			else if (0 == strcmp (argv[i], perf_suites[s].name))
+				is_selected = TRUE;
+		}
+		if (is_selected)
+			perf_suites[s].run();
+	}
+
+	pgm_time_shutdown();
+	pgm_rand_shutdown();
+	pgm_mem_shutdown();
+	pgm_thread_shutdown();
+	pgm_messages_shutdown();
+	return EXIT_SUCCESS;
+}
+
+/* eof */
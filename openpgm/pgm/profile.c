@@ -0,0 +1,221 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * cycle accounting of protocol stages.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <string.h>
+#include <impl/framework.h>
+#include <pgm/profile.h>
+
+
+//#define PROFILE_DEBUG
+
+/* Every profiled thread owns a block of stage totals, created on its first
+ * stage and updated without locks.  Readers sum the blocks of all threads,
+ * a total may trail the writer by the stage in progress.  Blocks are freed
+ * at shutdown, profiling must have stopped by then.
+ */
+
+#if defined(_MSC_VER)
+#	define PROFILE_TLS	__declspec(thread)
+#else
+#	define PROFILE_TLS	__thread
+#endif
+
+struct profile_block_t {
+	struct profile_block_t*	next;
+	pgm_profile_stage_t	stages[PGM_PROFILE_MAX];
+};
+
+bool pgm_profile_enabled PGM_GNUC_READ_MOSTLY = FALSE;
+
+static volatile uint32_t		profile_ref_count = 0;
+static volatile uint32_t		profile_generation = 0;
+static pgm_mutex_t			profile_mutex;
+static struct profile_block_t*		profile_blocks = NULL;
+
+static PROFILE_TLS struct profile_block_t*	profile_block = NULL;
+static PROFILE_TLS uint32_t			profile_block_generation = 0;
+
+static const char* const profile_names[PGM_PROFILE_MAX] = {
+	"recvskb",
+	"parse",
+	"downstream",
+	"rxw_add",
+	"rxw_read",
+	"send_odata",
+	"sendto",
+	"rs",
+	"timer"
+};
+
+static struct profile_block_t* profile_block_new (void);
+
+
+/* start accounting, nested calls are reference counted.
+ *
+ * returns TRUE.
+ */
+
+bool
+pgm_profile_init (void)
+{
+	if (pgm_atomic_exchange_and_add32 (&profile_ref_count, 1) > 0)
+		return TRUE;
+
+	pgm_mutex_init (&profile_mutex);
+	pgm_atomic_inc32 (&profile_generation);
+	pgm_profile_enabled = TRUE;
+	return TRUE;
+}
+
+/* stop accounting and free every block.
+ */
+
+bool
+pgm_profile_shutdown (void)
+{
+	pgm_return_val_if_fail (pgm_atomic_read32 (&profile_ref_count) > 0, FALSE);
+
+	if (pgm_atomic_exchange_and_add32 (&profile_ref_count, (uint32_t)-1) != 1)
+		return TRUE;
+
+	pgm_profile_enabled = FALSE;
+	pgm_atomic_inc32 (&profile_generation);
+	pgm_mutex_lock (&profile_mutex);
+	while (profile_blocks) {
+		struct profile_block_t* next = profile_blocks->next;
+		pgm_free (profile_blocks);
+		profile_blocks = next;
+	}
+	pgm_mutex_unlock (&profile_mutex);
+	pgm_mutex_free (&profile_mutex);
+	return TRUE;
+}
+
+/* block of the calling thread for the current profile, as evtrace rings the
+ * thread local pointer is only followed when its generation matches.
+ */
+
+static
+struct profile_block_t*
+profile_block_new (void)
+{
+	struct profile_block_t* block = pgm_new0 (struct profile_block_t, 1);
+	pgm_mutex_lock (&profile_mutex);
+	block->next = profile_blocks;
+	profile_blocks = block;
+	pgm_mutex_unlock (&profile_mutex);
+	profile_block = block;
+	profile_block_generation = pgm_atomic_read32 (&profile_generation);
+	return block;
+}
+
+/* account one closed stage, callers test pgm_profile_enabled through
+ * PGM_PROFILE_BEGIN().
+ */
+
+void
+pgm__profile (
+	const unsigned		stage,
+	const uint64_t		cycles,
+	const unsigned		packets
+	)
+{
+	struct profile_block_t* block;
+
+	pgm_assert (stage < PGM_PROFILE_MAX);
+
+/* closing a stage opened before shutdown */
+	if (PGM_UNLIKELY(!pgm_profile_enabled))
+		return;
+
+	if (PGM_LIKELY(profile_block_generation == profile_generation))
+		block = profile_block;
+	else
+		block = profile_block_new ();
+
+	pgm_profile_stage_t* totals = &block->stages[ stage ];
+	totals->calls++;
+	totals->packets += packets;
+	totals->cycles  += cycles;
+}
+
+/* sum the first len stages of every thread into stages.
+ *
+ * returns TRUE on success, returns FALSE when profiling is not active.
+ */
+
+bool
+pgm_profile_read (
+	pgm_profile_stage_t*	stages,
+	unsigned		len
+	)
+{
+	pgm_return_val_if_fail (NULL != stages || 0 == len, FALSE);
+
+	if (0 == pgm_atomic_read32 (&profile_ref_count))
+		return FALSE;
+
+	if (len > PGM_PROFILE_MAX)
+		len = PGM_PROFILE_MAX;
+	memset (stages, 0, len * sizeof (pgm_profile_stage_t));
+	pgm_mutex_lock (&profile_mutex);
+	for (const struct profile_block_t* block = profile_blocks; NULL != block; block = block->next)
+		for (unsigned i = 0; i < len; i++) {
+			stages[ i ].calls   += block->stages[ i ].calls;
+			stages[ i ].packets += block->stages[ i ].packets;
+			stages[ i ].cycles  += block->stages[ i ].cycles;
+		}
+	pgm_mutex_unlock (&profile_mutex);
+	return TRUE;
+}
+
+/* name of a stage, NULL when unknown.
+ */
+
+const char*
+pgm_profile_name (
+	unsigned	stage
+	)
+{
+	if (stage >= PGM_PROFILE_MAX)
+		return NULL;
+	return profile_names[ stage ];
+}
+
+/* unit of pgm_profile_stage_t::cycles.
+ */
+
+const char*
+pgm_profile_unit (void)
+{
+#if defined(HAVE_RDTSC)
+	return "cycles";
+#elif !defined(HAVE_CLOCK_GETTIME) && defined(_WIN32)
+	return "ticks";		/* performance counter */
+#else
+	return "ns";
+#endif
+}
+
+/* eof */
@@ -0,0 +1,179 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * unit tests for cycle accounting of protocol stages.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <check.h>
+
+#include "impl/framework.h"
+
+#ifdef _WIN32
+#	define PGM_CHECK_NOFORK		1
+#endif
+
+
+#define PROFILE_DEBUG
+#include "profile.c"
+
+
+/* target:
+ *	bool
+ *	pgm_profile_init (void)
+ */
+
+START_TEST (test_init_pass_001)
+{
+	fail_unless (TRUE == pgm_profile_init (), "init failed");
+	fail_unless (TRUE == pgm_profile_enabled, "not enabled");
+	fail_unless (TRUE == pgm_profile_init (), "init failed");
+	fail_unless (TRUE == pgm_profile_shutdown (), "shutdown failed");
+	fail_unless (TRUE == pgm_profile_enabled, "disabled by nested shutdown");
+	fail_unless (TRUE == pgm_profile_shutdown (), "shutdown failed");
+	fail_unless (FALSE == pgm_profile_enabled, "still enabled");
+	fail_unless (FALSE == pgm_profile_shutdown (), "shutdown succeeded");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_profile_read (
+ *		pgm_profile_stage_t*	stages,
+ *		unsigned		len
+ *	)
+ */
+
+START_TEST (test_read_pass_001)
+{
+	pgm_profile_stage_t stages[PGM_PROFILE_MAX];
+	fail_unless (TRUE == pgm_profile_init (), "init failed");
+	pgm__profile (PGM_PROFILE_RXW_ADD, 100, 1);
+	pgm__profile (PGM_PROFILE_RXW_ADD, 50, 1);
+	pgm__profile (PGM_PROFILE_RXW_READ, 30, 4);
+	fail_unless (TRUE == pgm_profile_read (stages, G_N_ELEMENTS(stages)), "read failed");
+	fail_unless (2 == stages[PGM_PROFILE_RXW_ADD].calls, "calls mismatch");
+	fail_unless (2 == stages[PGM_PROFILE_RXW_ADD].packets, "packets mismatch");
+	fail_unless (150 == stages[PGM_PROFILE_RXW_ADD].cycles, "cycles mismatch");
+	fail_unless (4 == stages[PGM_PROFILE_RXW_READ].packets, "packets mismatch");
+	fail_unless (0 == stages[PGM_PROFILE_TIMER].calls, "calls mismatch");
+	fail_unless (TRUE == pgm_profile_shutdown (), "shutdown failed");
+/* a new profile starts empty */
+	fail_unless (TRUE == pgm_profile_init (), "init failed");
+	fail_unless (TRUE == pgm_profile_read (stages, G_N_ELEMENTS(stages)), "read failed");
+	fail_unless (0 == stages[PGM_PROFILE_RXW_ADD].calls, "calls mismatch");
+	fail_unless (TRUE == pgm_profile_shutdown (), "shutdown failed");
+}
+END_TEST
+
+/* stages accounted through the begin and end macros */
+START_TEST (test_read_pass_002)
+{
+	pgm_profile_stage_t stages[PGM_PROFILE_MAX];
+	{
+		PGM_PROFILE_BEGIN (start);
+		PGM_PROFILE_END (PGM_PROFILE_PARSE, start, 1);
+	}
+	fail_unless (TRUE == pgm_profile_init (), "init failed");
+	for (unsigned i = 0; i < 3; i++) {
+		PGM_PROFILE_BEGIN (start);
+		PGM_PROFILE_END (PGM_PROFILE_PARSE, start, 1);
+	}
+	fail_unless (TRUE == pgm_profile_read (stages, G_N_ELEMENTS(stages)), "read failed");
+	fail_unless (3 == stages[PGM_PROFILE_PARSE].calls, "calls mismatch");
+	fail_unless (3 == stages[PGM_PROFILE_PARSE].packets, "packets mismatch");
+	fail_unless (TRUE == pgm_profile_shutdown (), "shutdown failed");
+}
+END_TEST
+
+START_TEST (test_read_fail_001)
+{
+	pgm_profile_stage_t stages[PGM_PROFILE_MAX];
+	fail_unless (FALSE == pgm_profile_read (stages, G_N_ELEMENTS(stages)), "read succeeded");
+}
+END_TEST
+
+/* target:
+ *	const char*
+ *	pgm_profile_name (
+ *		unsigned	stage
+ *	)
+ */
+
+START_TEST (test_name_pass_001)
+{
+	for (unsigned i = 0; i < PGM_PROFILE_MAX; i++)
+		fail_if (NULL == pgm_profile_name (i), "stage unnamed");
+	fail_unless (0 == strcmp ("rxw_add", pgm_profile_name (PGM_PROFILE_RXW_ADD)), "name mismatch");
+	fail_unless (NULL == pgm_profile_name (PGM_PROFILE_MAX), "name of unknown stage");
+	fail_if (NULL == pgm_profile_unit (), "unit unnamed");
+}
+END_TEST
+
+
+static
+Suite*
+make_test_suite (void)
+{
+	Suite* s;
+
+	s = suite_create (__FILE__);
+
+	TCase* tc_init = tcase_create ("init");
+	suite_add_tcase (s, tc_init);
+	tcase_add_test (tc_init, test_init_pass_001);
+
+	TCase* tc_read = tcase_create ("read");
+	suite_add_tcase (s, tc_read);
+	tcase_add_test (tc_read, test_read_pass_001);
+	tcase_add_test (tc_read, test_read_pass_002);
+	tcase_add_test (tc_read, test_read_fail_001);
+
+	TCase* tc_name = tcase_create ("name");
+	suite_add_tcase (s, tc_name);
+	tcase_add_test (tc_name, test_name_pass_001);
+	return s;
+}
+
+static
+Suite*
+make_master_suite (void)
+{
+	Suite* s = suite_create ("Master");
+	return s;
+}
+
+int
+main (void)
+{
+	pgm_messages_init();
+	SRunner* sr = srunner_create (make_master_suite ());
+	srunner_add_suite (sr, make_test_suite ());
+	srunner_run_all (sr, CK_ENV);
+	int number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	pgm_messages_shutdown();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof */
@@ -28,6 +28,11 @@
 /* create machinery for rate regulation.
  * the rate_per_sec is ammortized over millisecond time periods.
  *
+ * the bucket is kept as a single theoretical arrival time (GCRA) updated by
+ * compare-and-swap so concurrent senders never serialise on a lock: a send
+ * of n bytes advances the arrival time by n / rate_per_sec and is permitted
+ * while the arrival time stays within the bucket depth of now.
+ *
  * NB: bucket MUST be memset 0 before calling.
  */
 
@@ -46,15 +51,14 @@ pgm_rate_create (
 
 	bucket->rate_per_sec	= rate_per_sec;
 	bucket->iphdr_len	= iphdr_len;
-	bucket->last_rate_check	= pgm_time_update_now ();
 /* pre-fill bucket */
+	bucket->tat		= pgm_time_update_now() * UINT64_C(1000);
 	if ((rate_per_sec / 1000) >= max_tpdu) {
 		bucket->rate_per_msec	= bucket->rate_per_sec / 1000;
-		bucket->rate_limit	= bucket->rate_per_msec;
+		bucket->burst_nsecs	= UINT64_C(1000000);
 	} else {
-		bucket->rate_limit	= bucket->rate_per_sec;
+		bucket->burst_nsecs	= UINT64_C(1000000000);
 	}
-	pgm_spinlock_init (&bucket->spinlock);
 }
 
 PGM_GNUC_INTERNAL
@@ -65,8 +69,234 @@ pgm_rate_destroy (
 {
 /* pre-conditions */
 	pgm_assert (NULL != bucket);
+}
+
+/* time to transmit n bytes at the bucket rate.
+ */
+
+static inline
+uint64_t
+_pgm_rate_cost (
+	const pgm_rate_t*	bucket,
+	const size_t		n
+	)
+{
+	return ((uint64_t)n * UINT64_C(1000000000)) / bucket->rate_per_sec;
+}
+
+/* shrink the bucket depth to one maximum sized TPDU so sends are spaced at
+ * the rate instead of bursting a millisecond of data at line rate, spacing
+ * resolution is that of the pgm_time_update_now() timer.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_rate_pace (
+	pgm_rate_t*		bucket,
+	const uint16_t		max_tpdu
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != bucket);
+	pgm_assert (bucket->rate_per_sec >= max_tpdu);
+
+	bucket->burst_nsecs = _pgm_rate_cost (bucket, bucket->iphdr_len + max_tpdu);
+}
+
+/* change the rate of an active bucket as for congestion control pacing, the
+ * theoretical arrival time is kept so that outstanding reservations stand.
+ * concurrent senders may cost one TPDU at either rate.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_rate_set (
+	pgm_rate_t*		bucket,
+	const ssize_t		rate_per_sec,
+	const bool		is_paced,
+	const uint16_t		max_tpdu
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != bucket);
+	pgm_assert (rate_per_sec >= max_tpdu);
+
+	if (rate_per_sec == bucket->rate_per_sec)
+		return;
+	bucket->rate_per_sec	= rate_per_sec;
+	if ((rate_per_sec / 1000) >= max_tpdu) {
+		bucket->rate_per_msec	= bucket->rate_per_sec / 1000;
+		bucket->burst_nsecs	= UINT64_C(1000000);
+	} else {
+		bucket->rate_per_msec	= 0;
+		bucket->burst_nsecs	= UINT64_C(1000000000);
+	}
+	if (is_paced)
+		pgm_rate_pace (bucket, max_tpdu);
+}
+
+/* reserve n bytes from the bucket at time now, non-blocking reservations must
+ * fit within depth nanoseconds of the bucket.
+ *
+ * returns TRUE with the time the reservation is within the bucket depth in
+ * ready, returns FALSE if the bucket is short and the non-blocking flag is set.
+ */
+
+static
+bool
+_pgm_rate_reserve (
+	pgm_rate_t*	   restrict bucket,
+	const uint64_t		    now,
+	const size_t		    n,
+	const bool		    is_nonblocking,
+	const uint64_t		    depth,
+	uint64_t*	   restrict ready
+	)
+{
+	const uint64_t cost = _pgm_rate_cost (bucket, n);
+	uint64_t tat, new_tat;
+
+	do {
+		tat = pgm_atomic_read64 (&bucket->tat);
+		new_tat = MAX(tat, now) + cost;
+		if (is_nonblocking && new_tat - now > depth)
+			return FALSE;
+	} while (!pgm_atomic_compare_and_exchange64 (&bucket->tat, new_tat, tat));
+
+	*ready = new_tat - bucket->burst_nsecs;
+	return TRUE;
+}
+
+/* return a reservation of n bytes to the bucket.
+ */
+
+static
+void
+_pgm_rate_refund (
+	pgm_rate_t*		bucket,
+	const size_t		n
+	)
+{
+	const uint64_t cost = _pgm_rate_cost (bucket, n);
+	uint64_t tat;
+
+	do {
+		tat = pgm_atomic_read64 (&bucket->tat);
+	} while (!pgm_atomic_compare_and_exchange64 (&bucket->tat, tat - cost, tat));
+}
+
+/* reserve n bytes from a bucket and its parent.  within the bucket, its share
+ * of the parent, both are charged.  past the share idle parent capacity is
+ * borrowed whilst at least half the parent depth remains, such that members
+ * within their share are not held back by members borrowing.
+ *
+ * returns TRUE with borrowed set if only the parent was charged.
+ */
+
+static
+bool
+_pgm_rate_reserve_shared (
+	pgm_rate_t*	   restrict bucket,
+	const uint64_t		    now,
+	const size_t		    n,
+	const bool		    is_nonblocking,
+	uint64_t*	   restrict ready,
+	bool*		   restrict borrowed
+	)
+{
+	pgm_rate_t* parent = bucket->parent;
+	uint64_t parent_ready;
+
+	*borrowed = FALSE;
+	if (NULL == parent)
+		return _pgm_rate_reserve (bucket, now, n, is_nonblocking, bucket->burst_nsecs, ready);
+
+	if (_pgm_rate_reserve (bucket, now, n, TRUE, bucket->burst_nsecs, ready)) {
+		if (_pgm_rate_reserve (parent, now, n, is_nonblocking, parent->burst_nsecs, &parent_ready)) {
+			*ready = MAX(*ready, parent_ready);
+			return TRUE;
+		}
+		_pgm_rate_refund (bucket, n);
+		return FALSE;
+	}
+	if (_pgm_rate_reserve (parent, now, n, TRUE, parent->burst_nsecs / 2, ready)) {
+		*borrowed = TRUE;
+		return TRUE;
+	}
+	if (is_nonblocking)
+		return FALSE;
+/* wait in turn for the share */
+	_pgm_rate_reserve (bucket, now, n, FALSE, bucket->burst_nsecs, ready);
+	_pgm_rate_reserve (parent, now, n, FALSE, parent->burst_nsecs, &parent_ready);
+	*ready = MAX(*ready, parent_ready);
+	return TRUE;
+}
+
+static
+void
+_pgm_rate_refund_shared (
+	pgm_rate_t*		bucket,
+	const size_t		n,
+	const bool		borrowed
+	)
+{
+	if (!borrowed)
+		_pgm_rate_refund (bucket, n);
+	if (NULL != bucket->parent)
+		_pgm_rate_refund (bucket->parent, n);
+}
+
+/* yield until the reservation is due.
+ */
+
+static
+void
+_pgm_rate_wait (
+	const uint64_t		ready
+	)
+{
+	while (pgm_time_update_now() * UINT64_C(1000) < ready)
+		pgm_thread_yield();
+}
+
+/* remaining time in microseconds until n bytes fit within the bucket.
+ */
+
+static
+pgm_time_t
+_pgm_rate_remaining (
+	const pgm_rate_t*	bucket,
+	const uint64_t		now,
+	const size_t		n
+	)
+{
+	const uint64_t tat = MAX(pgm_atomic_read64 (&bucket->tat), now);
+	const uint64_t due = tat + _pgm_rate_cost (bucket, n) - bucket->burst_nsecs;
+	return (due > now) ? (pgm_time_t)((due - now) / 1000) : 0;
+}
+
+/* as _pgm_rate_remaining() for the earlier of the share with the parent, or
+ * borrowing from the parent.
+ */
+
+static
+pgm_time_t
+_pgm_rate_remaining_shared (
+	const pgm_rate_t*	bucket,
+	const uint64_t		now,
+	const size_t		n
+	)
+{
+	const pgm_rate_t* parent = bucket->parent;
+
+	if (NULL == parent)
+		return _pgm_rate_remaining (bucket, now, n);
 
-	pgm_spinlock_free (&bucket->spinlock);
+	const pgm_time_t share = MAX(_pgm_rate_remaining (bucket, now, n), _pgm_rate_remaining (parent, now, n));
+	const uint64_t tat = MAX(pgm_atomic_read64 (&parent->tat), now);
+	const uint64_t due = tat + _pgm_rate_cost (parent, n) - parent->burst_nsecs / 2;
+	const pgm_time_t borrow = (due > now) ? (pgm_time_t)((due - now) / 1000) : 0;
+	return MIN(share, borrow);
 }
 
 /* check bit bucket whether an operation can proceed or should wait.
@@ -84,8 +314,8 @@ pgm_rate_check2 (
 	const bool		is_nonblocking
 	)
 {
-	int64_t new_major_limit, new_minor_limit;
-	pgm_time_t now;
+	uint64_t now, major_ready = 0, minor_ready = 0;
+	bool borrowed = FALSE;
 
 /* pre-conditions */
 	pgm_assert (NULL != major_bucket);
@@ -95,112 +325,21 @@ pgm_rate_check2 (
 	if (0 == major_bucket->rate_per_sec && 0 == minor_bucket->rate_per_sec)
 		return TRUE;
 
-	if (0 != major_bucket->rate_per_sec)
-	{
-		pgm_spinlock_lock (&major_bucket->spinlock);
-		now = pgm_time_update_now();
-
-		if (major_bucket->rate_per_msec)
-		{
-			const pgm_time_t time_since_last_rate_check = now - major_bucket->last_rate_check;
-			if (time_since_last_rate_check > pgm_msecs(1)) 
-				new_major_limit = major_bucket->rate_per_msec;
-			else {
-				new_major_limit = major_bucket->rate_limit + ((major_bucket->rate_per_msec * time_since_last_rate_check) / 1000UL);
-				if (new_major_limit > major_bucket->rate_per_msec)
-					new_major_limit = major_bucket->rate_per_msec;
-			}
-		}
-		else
-		{
-			const pgm_time_t time_since_last_rate_check = now - major_bucket->last_rate_check;
-			if (time_since_last_rate_check > pgm_secs(1)) 
-				new_major_limit = major_bucket->rate_per_sec;
-			else {
-				new_major_limit = major_bucket->rate_limit + ((major_bucket->rate_per_sec * time_since_last_rate_check) / 1000000UL);
-				if (new_major_limit > major_bucket->rate_per_sec)
-					new_major_limit = major_bucket->rate_per_sec;
-			}
-		}
+	now = pgm_time_update_now() * UINT64_C(1000);
 
-		new_major_limit -= ( major_bucket->iphdr_len + data_size );
-		if (is_nonblocking && new_major_limit < 0) {
-			pgm_spinlock_unlock (&major_bucket->spinlock);
-			return FALSE;
-		}
-
-		if (new_major_limit < 0) {
-			const pgm_time_t wait_start = now;
-			ssize_t sleep_amount;
-			do {
-				pgm_thread_yield();
-				now = pgm_time_update_now();
-				sleep_amount = (ssize_t)pgm_to_secs (major_bucket->rate_per_sec * (now - wait_start));
-			} while (sleep_amount + new_major_limit < 0);
-			new_major_limit += sleep_amount;
-		} 
-	}
-	else
-	{
-/* ensure we have a timestamp */
-		now = pgm_time_update_now();
-	}
+	if (0 != major_bucket->rate_per_sec &&
+	    !_pgm_rate_reserve_shared (major_bucket, now, major_bucket->iphdr_len + data_size, is_nonblocking, &major_ready, &borrowed))
+		return FALSE;
 
-	if (0 != minor_bucket->rate_per_sec)
+	if (0 != minor_bucket->rate_per_sec &&
+	    !_pgm_rate_reserve (minor_bucket, now, minor_bucket->iphdr_len + data_size, is_nonblocking, minor_bucket->burst_nsecs, &minor_ready))
 	{
-		if (minor_bucket->rate_per_msec)
-		{
-			const pgm_time_t time_since_last_rate_check = now - minor_bucket->last_rate_check;
-			if (time_since_last_rate_check > pgm_msecs(1)) 
-				new_minor_limit = minor_bucket->rate_per_msec;
-			else {
-				new_minor_limit = minor_bucket->rate_limit + ((minor_bucket->rate_per_msec * time_since_last_rate_check) / 1000UL);
-				if (new_minor_limit > minor_bucket->rate_per_msec)
-					new_minor_limit = minor_bucket->rate_per_msec;
-			}
-		}
-		else
-		{
-			const pgm_time_t time_since_last_rate_check = now - minor_bucket->last_rate_check;
-			if (time_since_last_rate_check > pgm_secs(1)) 
-				new_minor_limit = minor_bucket->rate_per_sec;
-			else {
-				new_minor_limit = minor_bucket->rate_limit + ((minor_bucket->rate_per_sec * time_since_last_rate_check) / 1000000UL);
-				if (new_minor_limit > minor_bucket->rate_per_sec)
-					new_minor_limit = minor_bucket->rate_per_sec;
-			}
-		}
-
-		new_minor_limit -= ( minor_bucket->iphdr_len + data_size );
-		if (is_nonblocking && new_minor_limit < 0) {
-			if (0 != major_bucket->rate_per_sec)
-				pgm_spinlock_unlock (&major_bucket->spinlock);
-			return FALSE;
-		}
-
-/* commit new rate limit */
-		minor_bucket->rate_limit = new_minor_limit;
-		minor_bucket->last_rate_check = now;
-	}
-
-	if (0 != major_bucket->rate_per_sec) {
-		major_bucket->rate_limit = new_major_limit;
-		major_bucket->last_rate_check = now;
-		pgm_spinlock_unlock (&major_bucket->spinlock);
+		if (0 != major_bucket->rate_per_sec)
+			_pgm_rate_refund_shared (major_bucket, major_bucket->iphdr_len + data_size, borrowed);
+		return FALSE;
 	}
 
-/* sleep on minor bucket outside of lock */
-	if (minor_bucket->rate_limit < 0) {
-		ssize_t sleep_amount;
-		do {
-			pgm_thread_yield();
-			now = pgm_time_update_now();
-			sleep_amount = (ssize_t)pgm_to_secs (minor_bucket->rate_per_sec * (now - minor_bucket->last_rate_check));
-		} while (sleep_amount + minor_bucket->rate_limit < 0);
-		minor_bucket->rate_limit += sleep_amount;
-		minor_bucket->last_rate_check = now;
-	} 
-
+	_pgm_rate_wait (MAX(major_ready, minor_ready));
 	return TRUE;
 }
 
@@ -212,7 +351,8 @@ pgm_rate_check (
 	const bool		is_nonblocking
 	)
 {
-	int64_t new_rate_limit;
+	uint64_t ready;
+	bool borrowed;
 
 /* pre-conditions */
 	pgm_assert (NULL != bucket);
@@ -221,51 +361,50 @@ pgm_rate_check (
 	if (0 == bucket->rate_per_sec)
 		return TRUE;
 
-	pgm_spinlock_lock (&bucket->spinlock);
-	pgm_time_t now = pgm_time_update_now();
+	const uint64_t now = pgm_time_update_now() * UINT64_C(1000);
+	if (!_pgm_rate_reserve_shared (bucket, now, bucket->iphdr_len + data_size, is_nonblocking, &ready, &borrowed))
+		return FALSE;
 
-	if (bucket->rate_per_msec)
-	{
-		const pgm_time_t time_since_last_rate_check = now - bucket->last_rate_check;
-		if (time_since_last_rate_check > pgm_msecs(1)) 
-			new_rate_limit = bucket->rate_per_msec;
-		else {
-			new_rate_limit = bucket->rate_limit + ((bucket->rate_per_msec * time_since_last_rate_check) / 1000UL);
-			if (new_rate_limit > bucket->rate_per_msec)
-				new_rate_limit = bucket->rate_per_msec;
-		}
-	}
-	else
-	{
-		const pgm_time_t time_since_last_rate_check = now - bucket->last_rate_check;
-		if (time_since_last_rate_check > pgm_secs(1)) 
-			new_rate_limit = bucket->rate_per_sec;
-		else {
-			new_rate_limit = bucket->rate_limit + ((bucket->rate_per_sec * time_since_last_rate_check) / 1000000UL);
-			if (new_rate_limit > bucket->rate_per_sec)
-				new_rate_limit = bucket->rate_per_sec;
-		}
-	}
+	_pgm_rate_wait (ready);
+	return TRUE;
+}
+
+/* check the bucket of a priority class.  the total bucket is charged without
+ * waiting, such that the class goes ahead of sends waiting on the total, and
+ * those sends wait in turn for the overdraft.  the class bucket bounds the
+ * overdraft.
+ *
+ * returns TRUE when the class bucket permits unless non-blocking flag is set.
+ * returns FALSE if operation should block and non-blocking flag is set.
+ */
 
-	new_rate_limit -= ( bucket->iphdr_len + data_size );
-	if (is_nonblocking && new_rate_limit < 0) {
-		pgm_spinlock_unlock (&bucket->spinlock);
+PGM_GNUC_INTERNAL
+bool
+pgm_rate_check_priority (
+	pgm_rate_t*		total_bucket,
+	pgm_rate_t*		class_bucket,
+	const size_t		data_size,
+	const bool		is_nonblocking
+	)
+{
+	uint64_t now, ready, total_ready;
+	bool borrowed;
+
+/* pre-conditions */
+	pgm_assert (NULL != total_bucket);
+	pgm_assert (NULL != class_bucket);
+	pgm_assert (class_bucket->rate_per_sec > 0);
+	pgm_assert (data_size > 0);
+
+	now = pgm_time_update_now() * UINT64_C(1000);
+
+	if (!_pgm_rate_reserve (class_bucket, now, class_bucket->iphdr_len + data_size, is_nonblocking, class_bucket->burst_nsecs, &ready))
 		return FALSE;
-	}
 
-	bucket->rate_limit = new_rate_limit;
-	bucket->last_rate_check = now;
-	if (bucket->rate_limit < 0) {
-		ssize_t sleep_amount;
-		do {
-			pgm_thread_yield();
-			now = pgm_time_update_now();
-			sleep_amount = (ssize_t)pgm_to_secs (bucket->rate_per_sec * (now - bucket->last_rate_check));
-		} while (sleep_amount + bucket->rate_limit < 0);
-		bucket->rate_limit += sleep_amount;
-		bucket->last_rate_check = now;
-	} 
-	pgm_spinlock_unlock (&bucket->spinlock);
+	if (0 != total_bucket->rate_per_sec)
+		_pgm_rate_reserve_shared (total_bucket, now, total_bucket->iphdr_len + data_size, FALSE, &total_ready, &borrowed);
+
+	_pgm_rate_wait (ready);
 	return TRUE;
 }
 
@@ -278,7 +417,6 @@ pgm_rate_remaining2 (
 	)
 {
 	pgm_time_t remaining = 0;
-	pgm_time_t now;
 
 /* pre-conditions */
 	pgm_assert (NULL != major_bucket);
@@ -287,38 +425,16 @@ pgm_rate_remaining2 (
 	if (PGM_UNLIKELY(0 == major_bucket->rate_per_sec && 0 == minor_bucket->rate_per_sec))
 		return remaining;
 
+	const uint64_t now = pgm_time_update_now() * UINT64_C(1000);
+
 	if (0 != major_bucket->rate_per_sec)
-	{
-		pgm_spinlock_lock (&major_bucket->spinlock);
-		now = pgm_time_update_now();
-		const int64_t bucket_bytes = major_bucket->rate_limit + pgm_to_secs (major_bucket->rate_per_sec * (now - major_bucket->last_rate_check)) - n;
-
-		if (bucket_bytes < 0) {
-			const int64_t outstanding_bytes = -bucket_bytes;
-			const pgm_time_t major_remaining = (1000000UL * outstanding_bytes) / major_bucket->rate_per_sec;
-			remaining = major_remaining;
-		}
-	}
-	else
-	{
-/* ensure we have a timestamp */
-		now = pgm_time_update_now();
-	}
+		remaining = _pgm_rate_remaining_shared (major_bucket, now, n);
 
 	if (0 != minor_bucket->rate_per_sec)
 	{
-		const int64_t bucket_bytes = minor_bucket->rate_limit + pgm_to_secs (minor_bucket->rate_per_sec * (now - minor_bucket->last_rate_check)) - n;
-
-		if (bucket_bytes < 0) {
-			const int64_t outstanding_bytes = -bucket_bytes;
-			const pgm_time_t minor_remaining = (1000000UL * outstanding_bytes) / minor_bucket->rate_per_sec;
+		const pgm_time_t minor_remaining = _pgm_rate_remaining (minor_bucket, now, n);
+		if (minor_remaining > 0)
 			remaining = remaining > 0 ? MIN(remaining, minor_remaining) : minor_remaining;
-		}
-	}
-
-	if (0 != major_bucket->rate_per_sec)
-	{
-		pgm_spinlock_unlock (&major_bucket->spinlock);
 	}
 
 	return remaining;
@@ -337,19 +453,7 @@ pgm_rate_remaining (
 	if (PGM_UNLIKELY(0 == bucket->rate_per_sec))
 		return 0;
 
-	pgm_spinlock_lock (&bucket->spinlock);
-	const pgm_time_t now = pgm_time_update_now();
-	const pgm_time_t time_since_last_rate_check = now - bucket->last_rate_check;
-	const int64_t bucket_bytes = bucket->rate_limit + pgm_to_secs (bucket->rate_per_sec * time_since_last_rate_check) - n;
-	pgm_spinlock_unlock (&bucket->spinlock);
-
-	if (bucket_bytes >= 0)
-		return 0;
-
-	const int64_t outstanding_bytes = -bucket_bytes;
-	const pgm_time_t remaining = (1000000UL * outstanding_bytes) / bucket->rate_per_sec;
-
-	return remaining;
+	return _pgm_rate_remaining_shared (bucket, pgm_time_update_now() * UINT64_C(1000), n);
 }
 
 /* eof */
@@ -121,6 +121,44 @@ START_TEST (test_destroy_fail_001)
 }
 END_TEST
 
+/* target:
+ *	void
+ *	pgm_rate_pace (
+ *		pgm_rate_t*		bucket,
+ *		const uint16_t		max_tpdu
+ *	)
+ */
+
+/* a paced bucket spaces packets at the rate instead of a millisecond burst */
+START_TEST (test_pace_pass_001)
+{
+	pgm_rate_t rate;
+	memset (&rate, 0, sizeof(rate));
+	mock_pgm_time_now = 1;
+	pgm_rate_create (&rate, 2*1010*1000, 10, 1500);
+	pgm_rate_pace (&rate, 1500);
+	mock_pgm_time_now += pgm_secs(2);
+	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE), "rate_check failed");
+	fail_unless (FALSE == pgm_rate_check (&rate, 1000, TRUE), "rate_check failed");
+/* one packet time at 2,020,000 bytes per second */
+	mock_pgm_time_now += pgm_usecs(500);
+	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE), "rate_check failed");
+	fail_unless (FALSE == pgm_rate_check (&rate, 1000, TRUE), "rate_check failed");
+/* idle does not accumulate beyond one maximum sized packet */
+	mock_pgm_time_now += pgm_secs(10);
+	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE), "rate_check failed");
+	fail_unless (FALSE == pgm_rate_check (&rate, 1000, TRUE), "rate_check failed");
+	pgm_rate_destroy (&rate);
+}
+END_TEST
+
+START_TEST (test_pace_fail_001)
+{
+	pgm_rate_pace (NULL, 1500);
+	fail ("reached");
+}
+END_TEST
+
 /* target:
  *	bool
  *	pgm_rate_check (
@@ -202,6 +240,78 @@ START_TEST (test_check_pass_003)
 }
 END_TEST
 
+/* 004: a bucket with a parent sends within its share, then borrows only
+ * whilst half the parent depth is free, leaving the rest to other members.
+ */
+
+START_TEST (test_check_pass_004)
+{
+	pgm_rate_t group, a, b;
+	memset (&group, 0, sizeof(group));
+	memset (&a, 0, sizeof(a));
+	memset (&b, 0, sizeof(b));
+	mock_pgm_time_now = 1;
+	pgm_rate_create (&group, 4*1010, 10, 1500);
+	pgm_rate_create (&a, 2*1010, 10, 1500);
+	pgm_rate_create (&b, 2*1010, 10, 1500);
+	a.parent = b.parent = &group;
+	mock_pgm_time_now += pgm_secs(2);
+/* share of a, then half the group is held */
+	fail_unless (TRUE == pgm_rate_check (&a, 1000, TRUE), "rate_check failed");
+	fail_unless (TRUE == pgm_rate_check (&a, 1000, TRUE), "rate_check failed");
+	fail_unless (FALSE == pgm_rate_check (&a, 1000, TRUE), "rate_check failed");
+/* borrow the group capacity freed meanwhile */
+	mock_pgm_time_now += pgm_msecs(250);
+	fail_unless (TRUE == pgm_rate_check (&a, 1000, TRUE), "rate_check failed");
+	fail_unless (FALSE == pgm_rate_check (&a, 1000, TRUE), "rate_check failed");
+/* b keeps its share of the remainder */
+	fail_unless (TRUE == pgm_rate_check (&b, 1000, TRUE), "rate_check failed");
+	fail_unless (TRUE == pgm_rate_check (&b, 1000, TRUE), "rate_check failed");
+	fail_unless (FALSE == pgm_rate_check (&b, 1000, TRUE), "rate_check failed");
+	pgm_rate_destroy (&b);
+	pgm_rate_destroy (&a);
+	pgm_rate_destroy (&group);
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_rate_check_priority (
+ *		pgm_rate_t*		total_bucket,
+ *		pgm_rate_t*		class_bucket,
+ *		const size_t		data_size,
+ *		const bool		is_nonblocking
+ *	)
+ *
+ * 001: should pass on the class budget with the total spent, and overdraft
+ *	the total so regular data waits.
+ */
+
+START_TEST (test_check_priority_pass_001)
+{
+	pgm_rate_t total, urgent;
+	memset (&total, 0, sizeof(total));
+	memset (&urgent, 0, sizeof(urgent));
+	mock_pgm_time_now = 1;
+	pgm_rate_create (&total, 2*1010, 10, 1500);
+	pgm_rate_create (&urgent, 2*1010, 10, 1500);
+	mock_pgm_time_now += pgm_secs(2);
+	fail_unless (TRUE == pgm_rate_check (&total, 1000, TRUE), "rate_check failed");
+	fail_unless (TRUE == pgm_rate_check (&total, 1000, TRUE), "rate_check failed");
+	fail_unless (FALSE == pgm_rate_check (&total, 1000, TRUE), "rate_check failed");
+/* urgent within its own budget */
+	fail_unless (TRUE == pgm_rate_check_priority (&total, &urgent, 1000, TRUE), "rate_check_priority failed");
+	fail_unless (TRUE == pgm_rate_check_priority (&total, &urgent, 1000, TRUE), "rate_check_priority failed");
+	fail_unless (FALSE == pgm_rate_check_priority (&total, &urgent, 1000, TRUE), "rate_check_priority failed");
+/* the overdraft is repaid by regular data */
+	mock_pgm_time_now += pgm_msecs(500);
+	fail_unless (FALSE == pgm_rate_check (&total, 1000, TRUE), "rate_check failed");
+	fail_unless (TRUE == pgm_rate_check_priority (&total, &urgent, 1000, TRUE), "rate_check_priority failed");
+	pgm_rate_destroy (&urgent);
+	pgm_rate_destroy (&total);
+}
+END_TEST
+
 /* target:
  *	bool
  *	pgm_rate_check2 (
@@ -519,6 +629,31 @@ START_TEST (test_check2_pass_003)
 }
 END_TEST
 
+/* 004: a send refused by the minor bucket must not consume the major bucket.
+ */
+
+START_TEST (test_check2_pass_004)
+{
+	pgm_rate_t major, minor;
+
+	memset (&major, 0, sizeof(major));
+	memset (&minor, 0, sizeof(minor));
+	mock_pgm_time_now = 1;
+	pgm_rate_create (&major, 3*1010, 10, 1500);
+	pgm_rate_create (&minor, 2*1010, 10, 1500);
+	mock_pgm_time_now += pgm_secs(2);
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:minor failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:minor failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:minor failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:minor failed");
+/* third packet remains in the major bucket */
+	fail_unless (TRUE == pgm_rate_check (&major, 1000, TRUE), "rate_check:major failed");
+	fail_unless (FALSE == pgm_rate_check (&major, 1000, TRUE), "rate_check:major failed");
+	pgm_rate_destroy (&major);
+	pgm_rate_destroy (&minor);
+}
+END_TEST
+
 
 static
 Suite*
@@ -542,20 +677,33 @@ make_test_suite (void)
 	tcase_add_test_raise_signal (tc_destroy, test_destroy_fail_001, SIGABRT);
 #endif
 
+	TCase* tc_pace = tcase_create ("pace");
+	suite_add_tcase (s, tc_pace);
+	tcase_add_test (tc_pace, test_pace_pass_001);
+#ifndef PGM_CHECK_NOFORK
+	tcase_add_test_raise_signal (tc_pace, test_pace_fail_001, SIGABRT);
+#endif
+
 	TCase* tc_check = tcase_create ("check");
 	suite_add_tcase (s, tc_check);
 	tcase_add_test (tc_check, test_check_pass_001);
 	tcase_add_test (tc_check, test_check_pass_002);
 	tcase_add_test (tc_check, test_check_pass_003);
+	tcase_add_test (tc_check, test_check_pass_004);
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_check, test_check_fail_001, SIGABRT);
 #endif
 
+	TCase* tc_check_priority = tcase_create ("check-priority");
+	suite_add_tcase (s, tc_check_priority);
+	tcase_add_test (tc_check_priority, test_check_priority_pass_001);
+
 	TCase* tc_check2 = tcase_create ("check2");
 	suite_add_tcase (s, tc_check2);
 	tcase_add_test (tc_check2, test_check2_pass_001);
 	tcase_add_test (tc_check2, test_check2_pass_002);
 	tcase_add_test (tc_check2, test_check2_pass_003);
+	tcase_add_test (tc_check2, test_check2_pass_004);
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_check2, test_check2_fail_001, SIGABRT);
 #endif
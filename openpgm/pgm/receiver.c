@@ -44,12 +44,21 @@ static bool send_spmr (pgm_sock_t*const restrict, pgm_peer_t*const restrict);
 static bool send_nak (pgm_sock_t*const restrict, pgm_peer_t*const restrict, const uint32_t);
 static bool send_parity_nak (pgm_sock_t*const restrict, pgm_peer_t*const restrict, const unsigned, const unsigned);
 static bool send_nak_list (pgm_sock_t*const restrict, pgm_peer_t*const restrict, const struct pgm_sqn_list_t*const restrict);
+static bool send_nak_ranges (pgm_sock_t*const restrict, pgm_peer_t*const restrict, const struct pgm_sqn_range_list_t*const restrict);
+static bool send_catchup (pgm_sock_t*const restrict, pgm_peer_t*const restrict, const uint32_t, const uint32_t);
+static void catchup_define (pgm_sock_t*const restrict, pgm_peer_t*const restrict, const uint32_t, const uint32_t, const pgm_time_t, const pgm_time_t);
+static void restart_define (pgm_sock_t*const restrict, pgm_peer_t*const restrict, const uint32_t, const pgm_time_t, const pgm_time_t);
 static bool nak_rb_state (pgm_sock_t*restrict, pgm_peer_t*restrict, const pgm_time_t);
+static bool check_peer_state (pgm_sock_t*const, const pgm_time_t);
+static bool nak_batch_push (pgm_sock_t*const restrict, const bool, const void*restrict, const size_t, const struct sockaddr*restrict);
 static void nak_rpt_state (pgm_sock_t*restrict, pgm_peer_t*restrict, const pgm_time_t);
 static void nak_rdata_state (pgm_sock_t*restrict, pgm_peer_t*restrict, const pgm_time_t);
 static inline pgm_peer_t* _pgm_peer_ref (pgm_peer_t*);
+static void retire_peer (pgm_sock_t*const restrict, pgm_peer_t*const restrict);
+static void reclaim_peers (pgm_sock_t*const);
 static bool on_general_poll (pgm_sock_t*const restrict, pgm_peer_t*const restrict, struct pgm_sk_buff_t*const restrict);
 static bool on_dlr_poll (pgm_sock_t*const restrict, pgm_peer_t*const restrict, struct pgm_sk_buff_t*const restrict);
+static void ncf_confirm (pgm_sock_t*const restrict, pgm_peer_t*const restrict, const uint32_t, const uint32_t*restrict, unsigned, const pgm_time_t, const pgm_time_t, const pgm_time_t);
 
 
 /* helpers for pgm_peer_t */
@@ -119,6 +128,150 @@ next_nak_rdata_expiry (
 	return state->timer_expiry;
 }
 
+/* earliest timer of any state of the peer, including peer expiration.
+ */
+
+static inline
+pgm_time_t
+next_peer_expiry (
+	const pgm_peer_t*	peer
+	)
+{
+	pgm_time_t expiration;
+
+	pgm_assert (NULL != peer);
+
+	expiration = peer->expiry;
+	if (peer->spmr_expiry && pgm_time_after (expiration, peer->spmr_expiry))
+		expiration = peer->spmr_expiry;
+	if (peer->idle_expiry && pgm_time_after (expiration, peer->idle_expiry))
+		expiration = peer->idle_expiry;
+	if (peer->ack_trail_expiry && pgm_time_after (expiration, peer->ack_trail_expiry))
+		expiration = peer->ack_trail_expiry;
+	if (peer->credit_expiry && pgm_time_after (expiration, peer->credit_expiry))
+		expiration = peer->credit_expiry;
+	if (peer->window->ack_backoff_queue.tail && pgm_time_after (expiration, next_ack_rb_expiry (peer->window)))
+		expiration = next_ack_rb_expiry (peer->window);
+	if (peer->window->nak_backoff_queue.tail && pgm_time_after (expiration, next_nak_rb_expiry (peer->window)))
+		expiration = next_nak_rb_expiry (peer->window);
+	if (peer->window->wait_ncf_queue.tail && pgm_time_after (expiration, next_nak_rpt_expiry (peer->window)))
+		expiration = next_nak_rpt_expiry (peer->window);
+	if (peer->window->wait_data_queue.tail && pgm_time_after (expiration, next_nak_rdata_expiry (peer->window)))
+		expiration = next_nak_rdata_expiry (peer->window);
+	return expiration;
+}
+
+/* binary min-heap of peers ordered by timer_expiry, a key is never later than the
+ * earliest timer of the peer.  keys are lowered eagerly when a state timer is armed
+ * and raised lazily when the peer is visited by the timer thread.
+ */
+
+static inline
+void
+peer_heap_set (
+	pgm_sock_t*const restrict	sock,
+	const unsigned			index_,
+	pgm_peer_t*const restrict	peer
+	)
+{
+	sock->peers_heap[index_] = peer;
+	peer->heap_index = index_;
+}
+
+static
+void
+peer_heap_up (
+	pgm_sock_t*const	sock,
+	unsigned		index_
+	)
+{
+	pgm_peer_t*const peer = sock->peers_heap[index_];
+	while (index_ > 0) {
+		const unsigned parent = (index_ - 1) / 2;
+		if (!pgm_time_after (sock->peers_heap[parent]->timer_expiry, peer->timer_expiry))
+			break;
+		peer_heap_set (sock, index_, sock->peers_heap[parent]);
+		index_ = parent;
+	}
+	peer_heap_set (sock, index_, peer);
+}
+
+static
+void
+peer_heap_down (
+	pgm_sock_t*const	sock,
+	unsigned		index_
+	)
+{
+	pgm_peer_t*const peer = sock->peers_heap[index_];
+	for (;;) {
+		unsigned child = (2 * index_) + 1;
+		if (child >= sock->peers_heap_len)
+			break;
+		if (child + 1 < sock->peers_heap_len &&
+		    pgm_time_after (sock->peers_heap[child]->timer_expiry, sock->peers_heap[child + 1]->timer_expiry))
+			child++;
+		if (!pgm_time_after (peer->timer_expiry, sock->peers_heap[child]->timer_expiry))
+			break;
+		peer_heap_set (sock, index_, sock->peers_heap[child]);
+		index_ = child;
+	}
+	peer_heap_set (sock, index_, peer);
+}
+
+static
+void
+peer_heap_insert (
+	pgm_sock_t*const restrict	sock,
+	pgm_peer_t*const restrict	peer
+	)
+{
+	if (sock->peers_heap_len == sock->peers_heap_alloc) {
+		sock->peers_heap_alloc = sock->peers_heap_alloc ? (2 * sock->peers_heap_alloc) : 16;
+		sock->peers_heap = pgm_realloc (sock->peers_heap, sock->peers_heap_alloc * sizeof(pgm_peer_t*));
+	}
+	peer->timer_expiry = next_peer_expiry (peer);
+	peer_heap_set (sock, sock->peers_heap_len++, peer);
+	peer_heap_up (sock, peer->heap_index);
+}
+
+static
+void
+peer_heap_remove (
+	pgm_sock_t*const restrict	sock,
+	pgm_peer_t*const restrict	peer
+	)
+{
+	const unsigned index_ = peer->heap_index;
+	pgm_assert (sock->peers_heap[index_] == peer);
+	if (index_ == --sock->peers_heap_len)
+		return;
+	peer_heap_set (sock, index_, sock->peers_heap[sock->peers_heap_len]);
+	peer_heap_down (sock, index_);
+	peer_heap_up (sock, sock->peers_heap[index_]->heap_index);
+}
+
+/* re-key after a state change of the peer that may arm an earlier timer.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_peer_update_expiry (
+	pgm_sock_t*const restrict	sock,
+	pgm_peer_t*const restrict	peer
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != peer);
+
+	const pgm_time_t expiration = next_peer_expiry (peer);
+	if (pgm_time_after (peer->timer_expiry, expiration)) {
+		peer->timer_expiry = expiration;
+		peer_heap_up (sock, peer->heap_index);
+	}
+}
+
 /* calculate ACK_RB_IVL.
  */
 static inline
@@ -135,19 +288,85 @@ ack_rb_ivl (
 	return pgm_rand_int_range (&sock->rand_, 1 /* us */, (int32_t)sock->ack_bo_ivl);
 }
 
-/* calculate NAK_RB_IVL as random time interval 1 - NAK_BO_IVL.
+/* NAK interval from a peer repair round trip estimate, RTO = SRTT + 4 × RTTVAR
+ * bounded by PGM_NAK_ADAPTIVE_MIN_IVL below and the configured interval above.
+ */
+static inline
+pgm_time_t
+nak_adaptive_ivl (
+	const pgm_time_t	srtt,
+	const pgm_time_t	rttvar,
+	const pgm_time_t	ivl
+	)
+{
+	if (0 == srtt)
+		return ivl;
+	const pgm_time_t rto = srtt + 4 * rttvar;
+	return MIN(MAX(rto, PGM_NAK_ADAPTIVE_MIN_IVL), ivl);
+}
+
+/* calculate NAK_RB_IVL as random time interval 1 - NAK_BO_IVL, with PGM_NAK_ADAPTIVE
+ * the upper bound follows the NAK to NCF round trip of the peer.  a redundant source
+ * holds back for another source of the stream to cover the gap.
  */
 static inline
 uint32_t
 nak_rb_ivl (
-	pgm_sock_t*		sock
+	pgm_sock_t*		sock,
+	const pgm_peer_t*	peer
 	)	/* not const as rand() updates the seed */
 {
 /* pre-conditions */
 	pgm_assert (NULL != sock);
+	pgm_assert (NULL != peer);
 	pgm_assert_cmpuint (sock->nak_bo_ivl, >, 1);
 
-	return pgm_rand_int_range (&sock->rand_, 1 /* us */, (int32_t)sock->nak_bo_ivl);
+	const pgm_time_t nak_bo_ivl = sock->use_nak_adaptive ?
+		nak_adaptive_ivl (peer->window->ncf_srtt, peer->window->ncf_rttvar, sock->nak_bo_ivl) :
+		sock->nak_bo_ivl;
+	const uint32_t hold_ivl = peer->is_redundant ? sock->redundant_req.rr_nak_ivl : 0;
+	return hold_ivl + pgm_rand_int_range (&sock->rand_, 1 /* us */, (int32_t)nak_bo_ivl);
+}
+
+/* additional hold on NAKs for new gaps whilst the kernel is dropping datagrams
+ * on the receive queue, see recvskb_rxq_drops().
+ */
+static inline
+pgm_time_t
+nak_overrun_ivl (
+	const pgm_sock_t*	sock,
+	const pgm_time_t	now
+	)
+{
+	return pgm_time_after (sock->rxq_overrun_expiry, now) ? sock->nak_bo_ivl : 0;
+}
+
+/* NAK_RPT_IVL, time to wait for an NCF before repeating the NAK.
+ */
+static inline
+pgm_time_t
+nak_rpt_ivl (
+	const pgm_sock_t*	sock,
+	const pgm_peer_t*	peer
+	)
+{
+	if (!sock->use_nak_adaptive)
+		return sock->nak_rpt_ivl;
+	return nak_adaptive_ivl (peer->window->ncf_srtt, peer->window->ncf_rttvar, sock->nak_rpt_ivl);
+}
+
+/* NAK_RDATA_IVL, time to wait for RDATA after an NCF.
+ */
+static inline
+pgm_time_t
+nak_rdata_ivl (
+	const pgm_sock_t*	sock,
+	const pgm_peer_t*	peer
+	)
+{
+	if (!sock->use_nak_adaptive)
+		return sock->nak_rdata_ivl;
+	return nak_adaptive_ivl (peer->window->rdata_srtt, peer->window->rdata_rttvar, sock->nak_rdata_ivl);
 }
 
 /* mark sequence as recovery failed.
@@ -305,14 +524,24 @@ pgm_peer_unref (
 	pgm_rxw_destroy (peer->window);
 	peer->window = NULL;
 
+/* repair history */
+	if (peer->dlr_history) {
+		for (uint32_t i = 0; i < peer->dlr_history_len; i++)
+			if (peer->dlr_history[ i ])
+				pgm_free_skb (peer->dlr_history[ i ]);
+		pgm_free (peer->dlr_history);
+		peer->dlr_history = NULL;
+	}
+
 /* object */
 	pgm_free (peer);
 	peer = NULL;
 }
 
-/* find PGM options in received SKB.
+/* set option pointers of received SKB from its decoded options.
  *
- * returns TRUE if opt_fragment is found, otherwise FALSE is returned.
+ * returns TRUE if opt_fragment, opt_pgmcc_data, opt_batch, opt_compress or opt_conflate
+ * is found, otherwise FALSE is returned.
  */
 
 static
@@ -321,47 +550,162 @@ get_pgm_options (
 	struct pgm_sk_buff_t* const	skb
 	)
 {
-	struct pgm_opt_header* opt_header;
-	bool found_opt = FALSE;
+	const struct pgm_opt_desc_t* desc;
 
 /* pre-conditions */
 	pgm_assert (NULL != skb);
 	pgm_assert (NULL != skb->pgm_data);
 
-	opt_header = (struct pgm_opt_header*)(skb->pgm_data + 1);
-
-	pgm_assert (opt_header->opt_type   == PGM_OPT_LENGTH);
-	pgm_assert (opt_header->opt_length == sizeof(struct pgm_opt_length));
-
 	pgm_debug ("get_pgm_options (skb:%p)",
 		(const void*)skb);
 
-	skb->pgm_opt_fragment = NULL;
-	skb->pgm_opt_pgmcc_data = NULL;
+	desc = pgm_opt_desc_const (skb);
+	skb->pgm_opt_fragment	= pgm_opt_body_mutable (skb, desc->opt_fragment);
+	skb->pgm_opt_pgmcc_data	= pgm_opt_body_mutable (skb, desc->opt_pgmcc_data);
+	skb->pgm_opt_compress	= pgm_opt_body_mutable (skb, desc->opt_compress);
+	skb->pgm_opt_conflate	= pgm_opt_body_mutable (skb, desc->opt_conflate);
+	skb->is_batch		= (0 != desc->opt_batch);
+	return (NULL != skb->pgm_opt_fragment || NULL != skb->pgm_opt_pgmcc_data || skb->is_batch ||
+		NULL != skb->pgm_opt_compress || NULL != skb->pgm_opt_conflate);
+}
 
-/* always at least two options, first is always opt_length */
-	do {
-		opt_header = (struct pgm_opt_header*)((char*)opt_header + opt_header->opt_length);
-/* option overflow */
-		if (PGM_UNLIKELY((char*)opt_header > (char*)skb->data))
-			break;
+/* Peers are reclaimed by epoch so that monitoring threads walk peers_list
+ * without a lock.  The receive thread, under receiver_mutex, is the only
+ * writer of the peer table, list and epoch; it reads them without any
+ * synchronisation.  A reader counts itself in the parity slot of the
+ * current epoch.  The epoch only advances once the slot of the previous
+ * epoch drains, so a peer unlinked during epoch E is unreachable by all
+ * readers once the epoch reaches E + 2.
+ */
 
-		switch (opt_header->opt_type & PGM_OPT_MASK) {
-		case PGM_OPT_FRAGMENT:
-			skb->pgm_opt_fragment = (struct pgm_opt_fragment*)(opt_header + 1);
-			found_opt = TRUE;
-			break;
+/* locked read of the epoch, a full memory barrier.
+ */
+
+static inline
+uint32_t
+peers_epoch_sync (
+	pgm_sock_t*		sock
+	)
+{
+	return pgm_atomic_exchange_and_add32 (&sock->peers_epoch, 0);
+}
 
-		case PGM_OPT_PGMCC_DATA:
-			skb->pgm_opt_pgmcc_data = (struct pgm_opt_pgmcc_data*)(opt_header + 1);
-			found_opt = TRUE;
+/* enter a read-side critical section over sock->peers_list, returning the
+ * epoch to pass to pgm_peers_read_unlock().  Peers reached through the list
+ * stay allocated until the section is left.
+ */
+
+PGM_GNUC_INTERNAL
+uint32_t
+pgm_peers_read_lock (
+	pgm_sock_t*const	sock
+	)
+{
+	uint32_t epoch;
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+
+	for (;;) {
+		epoch = pgm_atomic_read32 (&sock->peers_epoch);
+		pgm_atomic_inc32 (&sock->peers_readers[ epoch & 1 ]);
+		if (PGM_LIKELY(epoch == pgm_atomic_read32 (&sock->peers_epoch)))
 			break;
+/* writer advanced before the count was visible, retry in the new epoch */
+		pgm_atomic_dec32 (&sock->peers_readers[ epoch & 1 ]);
+	}
+	return epoch;
+}
 
-		default: break;
-		}
+PGM_GNUC_INTERNAL
+void
+pgm_peers_read_unlock (
+	pgm_sock_t*const	sock,
+	const uint32_t		epoch
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+
+	pgm_atomic_dec32 (&sock->peers_readers[ epoch & 1 ]);
+}
+
+/* unlink an expired peer and defer the final reference until a grace period
+ * has passed.  The link keeps its next pointer so a reader on this peer can
+ * continue along the list.
+ */
+
+static
+void
+retire_peer (
+	pgm_sock_t*const restrict sock,
+	pgm_peer_t*const restrict peer
+	)
+{
+	if (peer->peers_link.prev)
+		peer->peers_link.prev->next = peer->peers_link.next;
+	else
+		sock->peers_list = peer->peers_link.next;
+	if (peer->peers_link.next)
+		peer->peers_link.next->prev = peer->peers_link.prev;
+
+/* barrier orders the unlink before the reader count checks in reclaim_peers() */
+	peer->retired_epoch = peers_epoch_sync (sock);
+	peer->retired_link.data = peer;
+	sock->peers_retired = pgm_slist_prepend_link (sock->peers_retired, &peer->retired_link);
+}
+
+/* advance the epoch if no reader remains in the previous epoch, then release
+ * peers retired at least two epochs ago.
+ */
+
+static
+void
+reclaim_peers (
+	pgm_sock_t*const	sock
+	)
+{
+	uint32_t epoch = pgm_atomic_read32 (&sock->peers_epoch);
+	if (0 == pgm_atomic_read32 (&sock->peers_readers[ (epoch + 1) & 1 ])) {
+		pgm_atomic_inc32 (&sock->peers_epoch);
+		epoch++;
+	}
+
+/* newest first, so everything past the first old enough peer is too */
+	pgm_slist_t* prev = NULL;
+	pgm_slist_t* link = sock->peers_retired;
+	while (link && (int32_t)(epoch - ((pgm_peer_t*)link->data)->retired_epoch) < 2) {
+		prev = link;
+		link = link->next;
+	}
+	if (prev)
+		prev->next = NULL;
+	else
+		sock->peers_retired = NULL;
+	while (link) {
+		pgm_peer_t* peer = link->data;
+		link = link->next;
+		pgm_peer_unref (peer);
+	}
+}
+
+/* release all retired peers, only when no reader can remain.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_peers_reclaim_all (
+	pgm_sock_t*const	sock
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != sock);
 
-	} while (!(opt_header->opt_type & PGM_OPT_END));
-	return found_opt;
+	while (sock->peers_retired) {
+		pgm_peer_t* peer = sock->peers_retired->data;
+		sock->peers_retired = sock->peers_retired->next;
+		pgm_peer_unref (peer);
+	}
 }
 
 /* a peer in the context of the sock is another party on the network sending PGM
@@ -400,9 +744,10 @@ pgm_new_peer (
 		(void*)sock, pgm_tsi_print (tsi), saddr, (unsigned)src_addrlen, daddr, (unsigned)dst_addrlen);
 #endif
 
-	peer = pgm_new0 (pgm_peer_t, 1);
+	peer = pgm_new0_subsys (pgm_peer_t, 1, PGM_MEM_SUBSYS_PEER);
 	peer->expiry = now + sock->peer_expiry;
 	memcpy (&peer->tsi, tsi, sizeof(pgm_tsi_t));
+	peer->dport = sock->dport;
 	memcpy (&peer->group_nla, dst_addr, dst_addrlen);
 	memcpy (&peer->local_nla, src_addr, src_addrlen);
 /* port at same location for sin/sin6 */
@@ -413,17 +758,56 @@ pgm_new_peer (
 	peer->window = pgm_rxw_create (&peer->tsi,
 					sock->max_tpdu,
 					sock->rxw_sqns,
-					sock->rxw_secs,
-					sock->rxw_max_rte,
-					sock->ack_c_p);
+					sock->rxw_sqns ? 0 : sock->rxw_secs,
+					sock->rxw_sqns ? 0 : sock->rxw_max_rte,
+					sock->ack_c_p,
+					&sock->mem_policy);
+	peer->window->skb_pool = sock->skb_pool;
+	peer->window->decoder = sock->rx_decoder;
+	peer->window->decompressor = sock->compress;
+	peer->window->spill_req = sock->spill_req.sr_size ? &sock->spill_req : NULL;
+	peer->window->delivery_deadline = sock->delivery_deadline;
+	if (sock->slow_consumer_jump)
+		peer->window->jump_sqns = MAX(1, (uint32_t)((uint64_t)pgm_rxw_max_length (peer->window) * sock->slow_consumer_jump / 100));
+	peer->window->conflate_req = sock->conflate_req.cf_len ? &sock->conflate_req : NULL;
+	peer->window->placement_pool = sock->placement_pool;
+	peer->window->max_apdu = (uint32_t)sock->large_apdu;
+	for (unsigned i = 0; i < sock->redundant_req.rr_tsi_len; i++)
+		if (pgm_tsi_equal (tsi, &sock->redundant_req.rr_tsi[i]))
+			peer->is_redundant = 1;
+	if (sock->dlr_sqns) {
+		peer->dlr_history = pgm_new0_subsys (struct pgm_sk_buff_t*, sock->dlr_sqns, PGM_MEM_SUBSYS_PEER);
+		peer->dlr_history_len = sock->dlr_sqns;
+	}
 	peer->spmr_expiry = now + sock->spmr_expiry;
+/* resume point recorded by a previous process */
+	if (sock->restart) {
+		struct pgm_restart_state_t state;
+		peer->restart_slot = pgm_restart_claim (sock->restart, tsi, sock->dport, &state);
+		if (NULL != peer->restart_slot && pgm_tsi_equal (tsi, &state.tsi)) {
+			pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Resuming tsi %s from #%" PRIu32 " after restart."),
+				pgm_tsi_print (tsi), state.next);
+			peer->is_restarted = 1;
+			peer->restart_next = state.next;
+			peer->spm_sqn = state.spm_sqn;
+			if (AF_UNSPEC != state.nla.ss_family)
+				memcpy (&peer->nla, &state.nla, sizeof (struct sockaddr_storage));
+		}
+	}
 
-/* add peer to hash table and linked list */
-	pgm_rwlock_writer_lock (&sock->peers_lock);
-	pgm_hashtable_insert (sock->peers_hashtable, &peer->tsi, _pgm_peer_ref (peer));
+/* add peer to hash table and linked list, the barrier completes the peer
+ * before monitoring readers can reach it through peers_list.
+ */
+	pgm_peertable_insert (sock->peers_hashtable, &peer->tsi, _pgm_peer_ref (peer));
 	peer->peers_link.data = peer;
-	sock->peers_list = pgm_list_prepend_link (sock->peers_list, &peer->peers_link);
-	pgm_rwlock_writer_unlock (&sock->peers_lock);
+	peer->peers_link.next = sock->peers_list;
+	peer->peers_link.prev = NULL;
+	peers_epoch_sync (sock);
+	if (sock->peers_list)
+		sock->peers_list->prev = &peer->peers_link;
+	sock->peers_list = &peer->peers_link;
+	peer_heap_insert (sock, peer);
+	pgm_evtrace (PGM_EV_PEER_NEW, &peer->tsi, 0, 0);
 
 	pgm_timer_lock (sock);
 	if (pgm_time_after( sock->next_poll, peer->spmr_expiry ))
@@ -432,6 +816,220 @@ pgm_new_peer (
 	return peer;
 }
 
+/* unrecoverable loss from a peer resets the socket, unless the peer is one of
+ * several redundant sources of the stream.
+ */
+
+static inline
+void
+peer_update_losses (
+	pgm_sock_t* const restrict	sock,
+	pgm_peer_t* const restrict	peer
+	)
+{
+	if (peer->last_cumulative_losses != ((pgm_rxw_t*)peer->window)->cumulative_losses)
+	{
+		if (!peer->is_redundant) {
+			sock->is_reset = TRUE;
+			if (NULL != sock->local)
+				pgm_local_publish_loss (sock->local, &peer->tsi);
+		}
+		peer->lost_count = ((pgm_rxw_t*)peer->window)->cumulative_losses - peer->last_cumulative_losses;
+		peer->last_cumulative_losses = ((pgm_rxw_t*)peer->window)->cumulative_losses;
+	}
+}
+
+/* record the first sequence not yet read for PGM_WARM_RESTART.
+ */
+
+static
+void
+peer_save_restart (
+	pgm_peer_t* const	peer
+	)
+{
+	struct pgm_restart_state_t state;
+
+	memset (&state, 0, sizeof (state));
+	state.tsi	= peer->tsi;
+	state.dport	= peer->dport;
+	state.next	= ((pgm_rxw_t*)peer->window)->commit_lead;
+	state.spm_sqn	= peer->spm_sqn;
+	memcpy (&state.nla, &peer->nla, sizeof (struct sockaddr_storage));
+	pgm_restart_save (peer->restart_slot, &state);
+}
+
+/* remove messages of a redundant source from the vector when the key has already been
+ * delivered from another source, chunks of a large APDU follow the first chunk.
+ *
+ * returns bytes of the remaining messages.
+ */
+
+static
+ssize_t
+redundant_filter (
+	pgm_sock_t*	   const restrict sock,
+	pgm_peer_t*	   const restrict peer,
+	struct pgm_msgv_t*	 restrict msg_start,	/* first message of the read */
+	struct pgm_msgv_t**	 restrict pmsg,
+	ssize_t				  bytes_read
+	)
+{
+	const uint32_t key_offset = sock->redundant_req.rr_key_offset;
+	struct pgm_msgv_t* kept = msg_start;
+
+	for (struct pgm_msgv_t* msgv = msg_start; msgv < *pmsg; msgv++)
+	{
+		const struct pgm_sk_buff_t* skb = msgv->msgv_skb[0];
+		if (NULL == skb->pgm_opt_fragment || 0 == skb->of_frag_offset) {
+			if (skb->len >= key_offset + sizeof(uint64_t)) {
+				const uint8_t* p = (const uint8_t*)skb->data + key_offset;
+				uint64_t key = 0;
+				for (unsigned i = 0; i < sizeof(uint64_t); i++)
+					key = (key << 8) | p[i];
+				peer->is_redundant_drop = sock->has_redundant_key && key <= sock->redundant_key;
+				if (!peer->is_redundant_drop) {
+					sock->redundant_key = key;
+					sock->has_redundant_key = TRUE;
+				}
+			} else
+				peer->is_redundant_drop = 0;
+		}
+		if (peer->is_redundant_drop) {
+			for (unsigned i = 0; i < msgv->msgv_len; i++)
+				bytes_read -= msgv->msgv_skb[i]->len;
+			continue;
+		}
+		if (kept != msgv)
+			*kept = *msgv;
+		kept++;
+	}
+	*pmsg = kept;
+	return bytes_read;
+}
+
+/* binary min-heap of pending peers ordered by merge_key, built for each merged flush.
+ */
+
+static
+void
+merge_heap_down (
+	pgm_peer_t**const	heap,
+	const unsigned		len,
+	unsigned		index_
+	)
+{
+	pgm_peer_t*const peer = heap[index_];
+	for (;;) {
+		unsigned child = (2 * index_) + 1;
+		if (child >= len)
+			break;
+		if (child + 1 < len &&
+		    pgm_time_after (heap[child]->merge_key, heap[child + 1]->merge_key))
+			child++;
+		if (!pgm_time_after (peer->merge_key, heap[child]->merge_key))
+			break;
+		heap[index_] = heap[child];
+		index_ = child;
+	}
+	heap[index_] = peer;
+}
+
+/* remove the first source of the pending queue
+ */
+
+static inline
+void
+peer_unset_pending_first (
+	pgm_sock_t* const	sock
+	)
+{
+	pgm_assert (NULL != sock->peers_pending);
+	sock->peers_pending = pgm_slist_remove_first (sock->peers_pending);
+	if (NULL == sock->peers_pending)
+		sock->peers_pending_tail = NULL;
+}
+
+/* read one message at a time from the pending peer with the earliest next arrival.
+ * peers remaining in the heap on return are pending again, a reset peer first.
+ */
+
+static
+int
+flush_peers_merged (
+	pgm_sock_t* 	 	 const restrict	sock,
+	struct pgm_msgv_t**    	       restrict	pmsg,
+	const struct pgm_msgv_t* const		msg_end,
+	size_t*		 	 const restrict	bytes_read,
+	unsigned*	 	 const restrict	data_read
+	)
+{
+	unsigned len = 0;
+	int retval = 0;
+
+	const unsigned pending = pgm_slist_length (sock->peers_pending);
+	if (pending > sock->merge_heap_alloc) {
+		sock->merge_heap_alloc = MAX( pending, 2 * sock->merge_heap_alloc );
+		sock->merge_heap = pgm_realloc (sock->merge_heap, sock->merge_heap_alloc * sizeof(pgm_peer_t*));
+	}
+	pgm_peer_t** const heap = sock->merge_heap;
+	while (sock->peers_pending)
+	{
+		pgm_peer_t* peer = sock->peers_pending->data;
+		if (peer->last_commit && peer->last_commit < sock->last_commit)
+			pgm_rxw_remove_commit (peer->window);
+		peer->merge_key = pgm_rxw_next_tstamp (peer->window);
+		heap[len++] = peer;
+		peer_unset_pending_first (sock);
+	}
+	for (unsigned i = len / 2; i-- > 0;)
+		merge_heap_down (heap, len, i);
+
+	while (len > 0)
+	{
+		pgm_peer_t* peer = heap[0];
+		struct pgm_msgv_t* const msg_start = *pmsg;
+		ssize_t peer_bytes = pgm_rxw_readv (peer->window, pmsg, 1);
+		peer_update_losses (sock, peer);
+
+		if (peer_bytes >= 0)
+		{
+			peer->last_commit = sock->last_commit;
+			if (NULL != peer->restart_slot)
+				peer_save_restart (peer);
+			if (peer->is_redundant)
+				peer_bytes = redundant_filter (sock, peer, msg_start, pmsg, peer_bytes);
+			if (NULL != sock->local)
+				pgm_local_publish (sock->local, msg_start, *pmsg);
+			if (*pmsg > msg_start) {
+				(*bytes_read) += peer_bytes;
+				(*data_read)  ++;
+			}
+			if (*pmsg > msg_end) {			/* commit full */
+				retval = -PGM_SOCK_ENOBUFS;
+				break;
+			}
+		} else if (peer->last_commit != sock->last_commit)
+			peer->last_commit = 0;
+		if (PGM_UNLIKELY(sock->is_reset)) {
+			retval = -PGM_SOCK_ECONNRESET;
+			break;
+		}
+/* re-key on the next message, or drop the peer without one */
+		if (peer_bytes >= 0)
+			peer->merge_key = pgm_rxw_next_tstamp (peer->window);
+		else
+			heap[0] = heap[--len];
+		if (len > 0)
+			merge_heap_down (heap, len, 0);
+	}
+
+/* the reset peer, or one that filled the vector, is reported first */
+	for (unsigned i = 0; i < len; i++)
+		pgm_peer_set_pending (sock, heap[i]);
+	return retval;
+}
+
 /* copy any contiguous buffers in the peer list to the provided 
  * message vector.
  * returns -PGM_SOCK_ENOBUFS if the vector is full, returns -PGM_SOCK_ECONNRESET if
@@ -461,37 +1059,70 @@ pgm_flush_peers_pending (
 	pgm_debug ("pgm_flush_peers_pending (sock:%p pmsg:%p msg-end:%p bytes-read:%p data-read:%p)",
 		(const void*)sock, (const void*)pmsg, (const void*)msg_end, (const void*)bytes_read, (const void*)data_read);
 
+	if (sock->use_merge_delivery)
+		return flush_peers_merged (sock, pmsg, msg_end, bytes_read, data_read);
+
 	while (sock->peers_pending)
 	{
 		pgm_peer_t* peer = sock->peers_pending->data;
 		if (peer->last_commit && peer->last_commit < sock->last_commit)
 			pgm_rxw_remove_commit (peer->window);
-		const ssize_t peer_bytes = pgm_rxw_readv (peer->window, pmsg, (unsigned)(msg_end - *pmsg + 1));
-
-		if (peer->last_cumulative_losses != ((pgm_rxw_t*)peer->window)->cumulative_losses)
-		{
-			sock->is_reset = TRUE;
-			peer->lost_count = ((pgm_rxw_t*)peer->window)->cumulative_losses - peer->last_cumulative_losses;
-			peer->last_cumulative_losses = ((pgm_rxw_t*)peer->window)->cumulative_losses;
+/* deficit round-robin, each turn of a source adds the quantum and reads one
+ * message at a time whilst bytes remain.
+ */
+		unsigned msglen = (unsigned)(msg_end - *pmsg + 1);
+		if (sock->delivery_quantum) {
+			if (peer->delivery_deficit <= 0)
+				peer->delivery_deficit += sock->delivery_quantum;
+			msglen = 1;
 		}
+		struct pgm_msgv_t* const msg_start = *pmsg;
+		ssize_t peer_bytes = pgm_rxw_readv (peer->window, pmsg, msglen);
+		peer_update_losses (sock, peer);
 
+		bool is_refill = FALSE;
 		if (peer_bytes >= 0)
 		{
-			(*bytes_read) += peer_bytes;
-			(*data_read)  ++;
 			peer->last_commit = sock->last_commit;
+			if (NULL != peer->restart_slot)
+				peer_save_restart (peer);
+			if (peer->is_redundant) {
+/* read again after duplicates are removed from a full vector */
+				is_refill = (*pmsg > msg_end);
+				peer_bytes = redundant_filter (sock, peer, msg_start, pmsg, peer_bytes);
+			}
+			if (NULL != sock->local)
+				pgm_local_publish (sock->local, msg_start, *pmsg);
+			if (*pmsg > msg_start) {
+				(*bytes_read) += peer_bytes;
+				(*data_read)  ++;
+			}
 			if (*pmsg > msg_end) {			/* commit full */
 				retval = -PGM_SOCK_ENOBUFS;
 				break;
 			}
-		} else
+		} else if (peer->last_commit != sock->last_commit)
 			peer->last_commit = 0;
 		if (PGM_UNLIKELY(sock->is_reset)) {
 			retval = -PGM_SOCK_ECONNRESET;
 			break;
 		}
+		if (is_refill)
+			continue;
+		if (sock->delivery_quantum) {
+			if (peer_bytes >= 0) {
+				peer->delivery_deficit -= MAX(peer_bytes, 1);
+				if (peer->delivery_deficit > 0)
+					continue;
+/* end of turn, the source waits behind all other pending sources */
+				peer_unset_pending_first (sock);
+				pgm_peer_set_pending (sock, peer);
+				continue;
+			}
+			peer->delivery_deficit = 0;
+		}
 /* clear this reference and move to next */
-		sock->peers_pending = pgm_slist_remove_first (sock->peers_pending);
+		peer_unset_pending_first (sock);
 	}
 
 	return retval;
@@ -516,7 +1147,8 @@ pgm_peer_has_pending (
 	return FALSE;
 }
 
-/* set receiver in pending event queue
+/* append receiver to the pending event queue, sources are read in order of
+ * their first pending event.
  */
 
 PGM_GNUC_INTERNAL
@@ -532,7 +1164,12 @@ pgm_peer_set_pending (
 
 	if (peer->pending_link.data) return;
 	peer->pending_link.data = peer;
-	sock->peers_pending = pgm_slist_prepend_link (sock->peers_pending, &peer->pending_link);
+	peer->pending_link.next = NULL;
+	if (sock->peers_pending_tail)
+		sock->peers_pending_tail->next = &peer->pending_link;
+	else
+		sock->peers_pending = &peer->pending_link;
+	sock->peers_pending_tail = &peer->pending_link;
 }
 
 /* Create a new error SKB detailing data loss.
@@ -560,6 +1197,7 @@ pgm_set_reset_error (
 	error_skb->sequence	= source->lost_count;
 	msgv->msgv_skb[0]	= error_skb;
 	msgv->msgv_len		= 1;
+	pgm_evtrace (PGM_EV_RESET, &source->tsi, source->window->cumulative_losses, source->lost_count);
 }
 
 /* SPM indicate start of a session, continued presence of a session, or flushing final packets
@@ -589,7 +1227,7 @@ pgm_on_spm (
 
 	if (PGM_UNLIKELY(!pgm_verify_spm (skb))) {
 		pgm_trace(PGM_LOG_ROLE_NETWORK,_("Discarded invalid SPM."));
-		source->cumulative_stats[PGM_PC_RECEIVER_MALFORMED_SPMS]++;
+		pgm_stats_inc (&source->cumulative_stats, PGM_PC_RECEIVER_MALFORMED_SPMS);
 		return FALSE;
 	}
 
@@ -606,12 +1244,19 @@ pgm_on_spm (
 /* save sequence number */
 		source->spm_sqn = spm_sqn;
 
+/* late join catch-up of the advertised transmit window */
+		if (PGM_UNLIKELY(!source->window->is_defined) && source->is_restarted)
+			restart_define (sock, source, pgm_ntohl (spm->spm_lead), skb->wire_tstamp, skb->tstamp);
+		else if (PGM_UNLIKELY(!source->window->is_defined) && sock->catchup_sqns)
+			catchup_define (sock, source, pgm_ntohl (spm->spm_trail), pgm_ntohl (spm->spm_lead),
+					skb->wire_tstamp, skb->tstamp);
+
 /* update receive window */
-		const pgm_time_t nak_rb_expiry = skb->tstamp + nak_rb_ivl (sock);
+		const pgm_time_t nak_rb_expiry = skb->tstamp + nak_rb_ivl (sock, source) + nak_overrun_ivl (sock, skb->tstamp);
 		const unsigned naks = pgm_rxw_update (source->window,
 						      pgm_ntohl (spm->spm_lead),
 						      pgm_ntohl (spm->spm_trail),
-						      skb->tstamp,
+						      skb->wire_tstamp,
 						      nak_rb_expiry);
 		if (naks) {
 			pgm_timer_lock (sock);
@@ -633,63 +1278,67 @@ pgm_on_spm (
 	else
 	{	/* does not advance SPM sequence number */
 		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded duplicate SPM."));
-		source->cumulative_stats[PGM_PC_RECEIVER_DUP_SPMS]++;
+		pgm_stats_inc (&source->cumulative_stats, PGM_PC_RECEIVER_DUP_SPMS);
 		return FALSE;
 	}
 
+/* compact original data only whilst announced */
+	source->is_compact = 0;
+
 /* check whether peer can generate parity packets */
 	if (skb->pgm_header->pgm_options & PGM_OPT_PRESENT)
 	{
-		const struct pgm_opt_header* opt_header;
-		const struct pgm_opt_length* opt_len;
-
-		opt_len = (AF_INET6 == source->nla.ss_family) ?
-				(const struct pgm_opt_length*)(spm6 + 1) :
-				(const struct pgm_opt_length*)(spm  + 1);
-		if (PGM_UNLIKELY(opt_len->opt_type != PGM_OPT_LENGTH))
+		const struct pgm_opt_parity_prm* opt_parity_prm;
+		const struct pgm_opt_sw_prm* opt_sw_prm;
+		const void* opt_start;
+
+		opt_start = (AF_INET6 == source->nla.ss_family) ?
+				(const void*)(spm6 + 1) :
+				(const void*)(spm  + 1);
+		if (PGM_UNLIKELY(!pgm_parse_options (skb, opt_start)))
 		{
 			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded malformed SPM."));
-			source->cumulative_stats[PGM_PC_RECEIVER_MALFORMED_SPMS]++;
+			pgm_stats_inc (&source->cumulative_stats, PGM_PC_RECEIVER_MALFORMED_SPMS);
 			return FALSE;
 		}
-		if (PGM_UNLIKELY(opt_len->opt_length != sizeof(struct pgm_opt_length)))
+		opt_parity_prm = pgm_opt_body (skb, pgm_opt_desc_const (skb)->opt_parity_prm);
+		if (NULL != opt_parity_prm)
 		{
-			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded malformed SPM."));
-			source->cumulative_stats[PGM_PC_RECEIVER_MALFORMED_SPMS]++;
-			return FALSE;
-		}
-/* TODO: check for > 16 options & past packet end */
-		opt_header = (const struct pgm_opt_header*)opt_len;
-		do {
-			opt_header = (const struct pgm_opt_header*)((const char*)opt_header + opt_header->opt_length);
-			if ((opt_header->opt_type & PGM_OPT_MASK) == PGM_OPT_PARITY_PRM)
+			if (PGM_UNLIKELY((opt_parity_prm->opt_reserved & PGM_PARITY_PRM_MASK) == 0))
 			{
-				const struct pgm_opt_parity_prm* opt_parity_prm;
-
-				opt_parity_prm = (const struct pgm_opt_parity_prm*)(opt_header + 1);
-				if (PGM_UNLIKELY((opt_parity_prm->opt_reserved & PGM_PARITY_PRM_MASK) == 0))
-				{
-					pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded malformed SPM."));
-					source->cumulative_stats[PGM_PC_RECEIVER_MALFORMED_SPMS]++;
-					return FALSE;
-				}
+				pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded malformed SPM."));
+				pgm_stats_inc (&source->cumulative_stats, PGM_PC_RECEIVER_MALFORMED_SPMS);
+				return FALSE;
+			}
 
-				const uint32_t parity_prm_tgs = pgm_ntohl (opt_parity_prm->parity_prm_tgs);
-				if (PGM_UNLIKELY(parity_prm_tgs < 2 || parity_prm_tgs > 128))
-				{
-					pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded malformed SPM."));
-					source->cumulative_stats[PGM_PC_RECEIVER_MALFORMED_SPMS]++;
-					return FALSE;
-				}
-			
-				source->has_proactive_parity = opt_parity_prm->opt_reserved & PGM_PARITY_PRM_PRO;
-				source->has_ondemand_parity  = opt_parity_prm->opt_reserved & PGM_PARITY_PRM_OND;
-				if (source->has_proactive_parity || source->has_ondemand_parity) {
-					source->is_fec_enabled = 1;
-					pgm_rxw_update_fec (source->window, parity_prm_tgs);
-				}
+			const uint32_t parity_prm_tgs = pgm_ntohl (opt_parity_prm->parity_prm_tgs);
+			if (PGM_UNLIKELY(parity_prm_tgs < 2 || parity_prm_tgs > 128))
+			{
+				pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded malformed SPM."));
+				pgm_stats_inc (&source->cumulative_stats, PGM_PC_RECEIVER_MALFORMED_SPMS);
+				return FALSE;
+			}
+		
+			source->has_proactive_parity = opt_parity_prm->opt_reserved & PGM_PARITY_PRM_PRO;
+			source->has_ondemand_parity  = opt_parity_prm->opt_reserved & PGM_PARITY_PRM_OND;
+			if (source->has_proactive_parity || source->has_ondemand_parity) {
+				source->is_fec_enabled = 1;
+				pgm_rxw_update_fec (source->window, parity_prm_tgs);
+			}
+		}
+		opt_sw_prm = pgm_opt_body (skb, pgm_opt_desc_const (skb)->opt_sw_prm);
+		if (NULL != opt_sw_prm)
+		{
+			if (PGM_UNLIKELY(opt_sw_prm->sw_prm_window < 2 || opt_sw_prm->sw_prm_window > PGM_RLC_MAX_WINDOW))
+			{
+				pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded malformed SPM."));
+				pgm_stats_inc (&source->cumulative_stats, PGM_PC_RECEIVER_MALFORMED_SPMS);
+				return FALSE;
 			}
-		} while (!(opt_header->opt_type & PGM_OPT_END));
+			pgm_rxw_update_sw (source->window, opt_sw_prm->sw_prm_window);
+		}
+		if (NULL != pgm_opt_body (skb, pgm_opt_desc_const (skb)->opt_compact))
+			source->is_compact = 1;
 	}
 
 /* either way bump expiration timer */
@@ -702,6 +1351,51 @@ pgm_on_spm (
 	return TRUE;
 }
 
+/* as designated local repairer multicast a retained TPDU as RDATA to the local
+ * subnet, the original trail is kept as it cannot be ahead of the source.
+ *
+ * returns TRUE on repair, FALSE if not retained or the repair rate is exceeded.
+ */
+
+static
+bool
+dlr_repair (
+	pgm_sock_t* const restrict sock,
+	pgm_peer_t* const restrict peer,
+	const uint32_t		   sequence
+	)
+{
+	const struct pgm_sk_buff_t* skb = peer->dlr_history[ sequence % peer->dlr_history_len ];
+	if (NULL == skb || 0 == skb->len || skb->sequence != sequence)
+		return FALSE;
+	if (sock->dlr_max_rte &&
+	    !pgm_rate_check (&sock->dlr_rate_control, skb->len, TRUE))
+	{
+		return FALSE;
+	}
+
+	char* buf = pgm_alloca (skb->len);
+	memcpy (buf, skb->data, skb->len);
+	struct pgm_header* header = (struct pgm_header*)buf;
+	header->pgm_type	= PGM_RDATA;
+	header->pgm_checksum	= 0;
+	header->pgm_checksum	= pgm_csum_fold (pgm_csum_partial (buf, (uint16_t)skb->len, 0));
+
+	const ssize_t sent = pgm_sendto_hops (sock,
+					      FALSE,			/* already rate limited */
+					      NULL,
+					      TRUE,			/* with router alert */
+					      1,			/* local subnet */
+					      buf,
+					      skb->len,
+					      (struct sockaddr*)&sock->send_gsr.gsr_group,
+					      pgm_sockaddr_len((struct sockaddr*)&sock->send_gsr.gsr_group));
+	if (sent < 0)
+		return FALSE;
+	pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Local repair of #%" PRIu32 " for tsi %s."), sequence, pgm_tsi_print (&peer->tsi));
+	return TRUE;
+}
+
 /* Multicast peer-to-peer NAK handling, pretty much the same as a NCF but different direction
  *
  * if NAK is valid, returns TRUE.  on error, FALSE is returned.
@@ -718,8 +1412,10 @@ pgm_on_peer_nak (
 	const struct pgm_nak   *nak;
 	const struct pgm_nak6  *nak6;
 	struct sockaddr_storage nak_src_nla, nak_grp_nla;
+	const uint32_t*		nak_list = NULL;
+	unsigned		nak_list_len = 0;
 	bool			found_nak_grp = FALSE;
-	int			ncf_status;
+	unsigned		dlr_misses = 0;
 
 /* pre-conditions */
 	pgm_assert (NULL != sock);
@@ -732,7 +1428,14 @@ pgm_on_peer_nak (
 	if (PGM_UNLIKELY(!pgm_verify_nak (skb)))
 	{
 		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded invalid multicast NAK."));
-		peer->cumulative_stats[PGM_PC_RECEIVER_NAK_ERRORS]++;
+		pgm_stats_inc (&peer->cumulative_stats, PGM_PC_RECEIVER_NAK_ERRORS);
+		return FALSE;
+	}
+
+/* nothing to suppress before the window is defined and nothing to repair without history */
+	if (!peer->window->is_defined && NULL == peer->dlr_history)
+	{
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded multicast NAK for undefined receive window."));
 		return FALSE;
 	}
 
@@ -763,63 +1466,64 @@ pgm_on_peer_nak (
 		return FALSE;
 	}
 
-/* handle as NCF */
-	ncf_status = pgm_rxw_confirm (peer->window,
-				      pgm_ntohl (nak->nak_sqn),
-				      skb->tstamp,
-				      skb->tstamp + sock->nak_rdata_ivl,
-				      skb->tstamp + nak_rb_ivl(sock));
-	if (PGM_RXW_UPDATED == ncf_status || PGM_RXW_APPENDED == ncf_status)
-		peer->cumulative_stats[PGM_PC_RECEIVER_SELECTIVE_NAKS_SUPPRESSED]++;
-
 /* check NAK list */
 	if (skb->pgm_header->pgm_options & PGM_OPT_PRESENT)
 	{
-		const struct pgm_opt_header* opt_header;
-		const struct pgm_opt_length* opt_len;
-		const uint32_t* nak_list = NULL;
-		unsigned nak_list_len = 0;
-
-		opt_len = (AF_INET6 == nak_src_nla.ss_family) ?
-				(const struct pgm_opt_length*)(nak6 + 1) :
-				(const struct pgm_opt_length*)(nak + 1);
-		if (PGM_UNLIKELY(opt_len->opt_type != PGM_OPT_LENGTH))
+		const struct pgm_opt_nak_list* opt_nak_list;
+		const void* opt_start;
+
+		opt_start = (AF_INET6 == nak_src_nla.ss_family) ?
+				(const void*)(nak6 + 1) :
+				(const void*)(nak  + 1);
+		if (PGM_UNLIKELY(!pgm_parse_options (skb, opt_start)))
 		{
 			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded malformed multicast NAK."));
-			peer->cumulative_stats[PGM_PC_RECEIVER_MALFORMED_NCFS]++;
+			pgm_stats_inc (&peer->cumulative_stats, PGM_PC_RECEIVER_MALFORMED_NCFS);
 			return FALSE;
 		}
-		if (PGM_UNLIKELY(opt_len->opt_length != sizeof(struct pgm_opt_length)))
-		{
-			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded malformed multicast NAK."));
-			peer->cumulative_stats[PGM_PC_RECEIVER_MALFORMED_NCFS]++;
-			return FALSE;
+		opt_nak_list = pgm_opt_body (skb, pgm_opt_desc_const (skb)->opt_nak_list);
+		if (NULL != opt_nak_list) {
+			nak_list = opt_nak_list->opt_sqn;
+			nak_list_len = pgm_opt_nak_list_len (skb);
 		}
-/* TODO: check for > 16 options & past packet end */
-		opt_header = (const struct pgm_opt_header*)opt_len;
-		do {
-			opt_header = (const struct pgm_opt_header*)((const char*)opt_header + opt_header->opt_length);
-			if ((opt_header->opt_type & PGM_OPT_MASK) == PGM_OPT_NAK_LIST)
-			{
-				nak_list = ((const struct pgm_opt_nak_list*)(opt_header + 1))->opt_sqn;
-				nak_list_len = ( opt_header->opt_length - sizeof(struct pgm_opt_header) - sizeof(uint8_t) ) / sizeof(uint32_t);
-				break;
-			}
-		} while (!(opt_header->opt_type & PGM_OPT_END));
+	}
 
+/* handle as NCF, sequences we hold or have committed are skipped by slot map */
+	ncf_confirm (sock, peer, pgm_ntohl (nak->nak_sqn), nak_list, nak_list_len,
+		     skb->wire_tstamp,
+		     skb->tstamp + nak_rdata_ivl (sock, peer),
+		     skb->tstamp + nak_rb_ivl (sock, peer));
+
+/* redirected NAK, parity cannot be generated locally */
+	if (NULL != peer->dlr_history) {
+		if ((skb->pgm_header->pgm_options & PGM_OPT_PARITY) ||
+		    !dlr_repair (sock, peer, pgm_ntohl (nak->nak_sqn)))
+			dlr_misses++;
 		while (nak_list_len) {
-			ncf_status = pgm_rxw_confirm (peer->window,
-						      pgm_ntohl (*nak_list),
-						      skb->tstamp,
-						      skb->tstamp + sock->nak_rdata_ivl,
-						      skb->tstamp + nak_rb_ivl(sock));
-			if (PGM_RXW_UPDATED == ncf_status || PGM_RXW_APPENDED == ncf_status)
-				peer->cumulative_stats[PGM_PC_RECEIVER_SELECTIVE_NAKS_SUPPRESSED]++;
+			if ((skb->pgm_header->pgm_options & PGM_OPT_PARITY) ||
+			    !dlr_repair (sock, peer, pgm_ntohl (*nak_list)))
+				dlr_misses++;
 			nak_list++;
 			nak_list_len--;
 		}
 	}
 
+/* forward the unchanged NAK to the source for anything not repaired locally,
+ * receivers already repaired discard the duplicate RDATA.
+ */
+	if (dlr_misses && 0 != peer->nla.ss_family) {
+		const size_t tpdu_length = (const char*)skb->tail - (const char*)skb->pgm_header;
+		pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Forwarding NAK with %u unrepaired sequences to source."), dlr_misses);
+		pgm_sendto (sock,
+			    FALSE,			/* not rate limited */
+			    NULL,
+			    TRUE,			/* with router alert */
+			    skb->pgm_header,
+			    tpdu_length,
+			    (struct sockaddr*)&peer->nla,
+			    pgm_sockaddr_len((struct sockaddr*)&peer->nla));
+	}
+
 /* mark receiver window for flushing on next recv() */
 	if (peer->window->cumulative_losses != peer->last_cumulative_losses &&
 	    !peer->pending_link.data)
@@ -832,6 +1536,64 @@ pgm_on_peer_nak (
 	return TRUE;
 }
 
+/* confirm the NCF or peer NAK sequence followed by the OPT_NAK_LIST in network order, NAK lists
+ * are generated in ascending order so consecutive sequences are confirmed as one
+ * range against the receive window with a single update of the next poll.
+ */
+
+static
+void
+ncf_confirm (
+	pgm_sock_t*     const restrict sock,
+	pgm_peer_t*     const restrict source,
+	const uint32_t		       ncf_sqn,
+	const uint32_t*	      restrict ncf_list,
+	unsigned		       ncf_list_len,
+	const pgm_time_t	       now,
+	const pgm_time_t	       ncf_rdata_ivl,
+	const pgm_time_t	       ncf_rb_ivl
+	)
+{
+	uint32_t sequence = ncf_sqn;
+	uint32_t confirmed = 0;
+	bool     is_appended = FALSE;
+
+	for (;;)
+	{
+		uint32_t count = 1;
+		while (ncf_list_len && pgm_ntohl (*ncf_list) == sequence + count) {
+			count++;
+			ncf_list++;
+			ncf_list_len--;
+		}
+
+		bool is_range_appended;
+		confirmed += pgm_rxw_confirm_range (source->window,
+						    sequence,
+						    count,
+						    now,
+						    ncf_rdata_ivl,
+						    ncf_rb_ivl,
+						    &is_range_appended);
+		is_appended |= is_range_appended;
+		if (0 == ncf_list_len)
+			break;
+		sequence = pgm_ntohl (*ncf_list);
+		ncf_list++;
+		ncf_list_len--;
+	}
+
+	if (0 == confirmed)
+		return;
+	const pgm_time_t ncf_ivl = is_appended ? ncf_rb_ivl : ncf_rdata_ivl;
+	pgm_timer_lock (sock);
+	if (pgm_time_after (sock->next_poll, ncf_ivl)) {
+		sock->next_poll = ncf_ivl;
+	}
+	pgm_timer_unlock (sock);
+	pgm_stats_add (&source->cumulative_stats, PGM_PC_RECEIVER_SELECTIVE_NAKS_SUPPRESSED, confirmed);
+}
+
 /* NCF confirming receipt of a NAK from this sock or another on the LAN segment.
  *
  * Packet contents will match exactly the sent NAK, although not really that helpful.
@@ -850,7 +1612,9 @@ pgm_on_ncf (
 	const struct pgm_nak   *ncf;
 	const struct pgm_nak6  *ncf6;
 	struct sockaddr_storage ncf_src_nla, ncf_grp_nla;
-	int			ncf_status;
+	const uint32_t*		ncf_list = NULL;
+	unsigned		ncf_list_len = 0;
+	unsigned		ncf_count = 1;
 
 /* pre-conditions */
 	pgm_assert (NULL != sock);
@@ -863,7 +1627,7 @@ pgm_on_ncf (
 	if (PGM_UNLIKELY(!pgm_verify_ncf (skb)))
 	{
 		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded invalid NCF."));
-		source->cumulative_stats[PGM_PC_RECEIVER_MALFORMED_NCFS]++;
+		pgm_stats_inc (&source->cumulative_stats, PGM_PC_RECEIVER_MALFORMED_NCFS);
 		return FALSE;
 	}
 
@@ -876,7 +1640,7 @@ pgm_on_ncf (
 #if 0
 	if (PGM(pgm_sockaddr_cmp ((struct sockaddr*)&ncf_src_nla, (struct sockaddr*)&sock->send_addr) != 0)) {
 		g_trace ("INFO", "Discarded NCF on NLA mismatch.");
-		peer->cumulative_stats[PGM_PC_RECEIVER_PACKETS_DISCARDED]++;
+		pgm_stats_inc (&peer->cumulative_stats, PGM_PC_RECEIVER_PACKETS_DISCARDED);
 		return FALSE;
 	}
 #endif
@@ -889,74 +1653,36 @@ pgm_on_ncf (
 		return FALSE;
 	}
 
-	const pgm_time_t ncf_rdata_ivl = skb->tstamp + sock->nak_rdata_ivl;
-	const pgm_time_t ncf_rb_ivl    = skb->tstamp + nak_rb_ivl(sock);
-	ncf_status = pgm_rxw_confirm (source->window,
-				      pgm_ntohl (ncf->nak_sqn),
-				      skb->tstamp,
-				      ncf_rdata_ivl,
-				      ncf_rb_ivl);
-	if (PGM_RXW_UPDATED == ncf_status || PGM_RXW_APPENDED == ncf_status)
-	{
-		const pgm_time_t ncf_ivl = (PGM_RXW_APPENDED == ncf_status) ? ncf_rb_ivl : ncf_rdata_ivl;
-		pgm_timer_lock (sock);
-		if (pgm_time_after (sock->next_poll, ncf_ivl)) {
-			sock->next_poll = ncf_ivl;
-		}
-		pgm_timer_unlock (sock);
-		source->cumulative_stats[PGM_PC_RECEIVER_SELECTIVE_NAKS_SUPPRESSED]++;
-	}
-
 /* check NCF list */
 	if (skb->pgm_header->pgm_options & PGM_OPT_PRESENT)
 	{
-		const struct pgm_opt_header* opt_header;
-		const struct pgm_opt_length* opt_len;
-		const uint32_t* ncf_list = NULL;
-		unsigned ncf_list_len = 0;
-
-		opt_len = (AF_INET6 == ncf_src_nla.ss_family) ?
-				(const struct pgm_opt_length*)(ncf6 + 1) :
-				(const struct pgm_opt_length*)(ncf  + 1);
-		if (PGM_UNLIKELY(opt_len->opt_type != PGM_OPT_LENGTH))
+		const struct pgm_opt_nak_list* opt_nak_list;
+		const void* opt_start;
+
+		opt_start = (AF_INET6 == ncf_src_nla.ss_family) ?
+				(const void*)(ncf6 + 1) :
+				(const void*)(ncf  + 1);
+		if (PGM_UNLIKELY(!pgm_parse_options (skb, opt_start)))
 		{
 			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded malformed NCF."));
-			source->cumulative_stats[PGM_PC_RECEIVER_MALFORMED_NCFS]++;
+			pgm_stats_inc (&source->cumulative_stats, PGM_PC_RECEIVER_MALFORMED_NCFS);
 			return FALSE;
 		}
-		if (PGM_UNLIKELY(opt_len->opt_length != sizeof(struct pgm_opt_length)))
-		{
-			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded malformed NCF."));
-			source->cumulative_stats[PGM_PC_RECEIVER_MALFORMED_NCFS]++;
-			return FALSE;
+		opt_nak_list = pgm_opt_body (skb, pgm_opt_desc_const (skb)->opt_nak_list);
+		if (NULL != opt_nak_list) {
+			ncf_list = opt_nak_list->opt_sqn;
+			ncf_list_len = pgm_opt_nak_list_len (skb);
 		}
-/* TODO: check for > 16 options & past packet end */
-		opt_header = (const struct pgm_opt_header*)opt_len;
-		do {
-			opt_header = (const struct pgm_opt_header*)((const char*)opt_header + opt_header->opt_length);
-			if ((opt_header->opt_type & PGM_OPT_MASK) == PGM_OPT_NAK_LIST)
-			{
-				ncf_list = ((const struct pgm_opt_nak_list*)(opt_header + 1))->opt_sqn;
-				ncf_list_len = ( opt_header->opt_length - sizeof(struct pgm_opt_header) - sizeof(uint8_t) ) / sizeof(uint32_t);
-				break;
-			}
-		} while (!(opt_header->opt_type & PGM_OPT_END));
-
 		pgm_debug ("NCF contains 1+%d sequence numbers.", ncf_list_len);
-		while (ncf_list_len)
-		{
-			ncf_status = pgm_rxw_confirm (source->window,
-						      pgm_ntohl (*ncf_list),
-						      skb->tstamp,
-						      ncf_rdata_ivl,
-						      ncf_rb_ivl);
-			if (PGM_RXW_UPDATED == ncf_status || PGM_RXW_APPENDED == ncf_status)
-				source->cumulative_stats[PGM_PC_RECEIVER_SELECTIVE_NAKS_SUPPRESSED]++;
-			ncf_list++;
-			ncf_list_len--;
-		}
+		ncf_count += ncf_list_len;
 	}
 
+	ncf_confirm (sock, source, pgm_ntohl (ncf->nak_sqn), ncf_list, ncf_list_len,
+		     skb->wire_tstamp,
+		     skb->tstamp + nak_rdata_ivl (sock, source),
+		     skb->tstamp + nak_rb_ivl (sock, source));
+	pgm_evtrace (PGM_EV_NCF_RECEIVED, &source->tsi, pgm_ntohl (ncf->nak_sqn), ncf_count);
+
 /* mark receiver window for flushing on next recv() */
 	if (source->window->cumulative_losses != source->last_cumulative_losses &&
 	    !source->pending_link.data)
@@ -998,7 +1724,7 @@ send_spmr (
 	header = (struct pgm_header*)buf;
 	memcpy (header->pgm_gsi, &source->tsi.gsi, sizeof(pgm_gsi_t));
 /* dport & sport reversed communicating upstream */
-	header->pgm_sport	= sock->dport;
+	header->pgm_sport	= source->dport;
 	header->pgm_dport	= source->tsi.sport;
 	header->pgm_type	= PGM_SPMR;
 	header->pgm_options	= 0;
@@ -1031,7 +1757,115 @@ send_spmr (
 	if (sent < 0 && PGM_LIKELY(PGM_SOCK_EAGAIN == pgm_get_last_sock_error()))
 		return FALSE;
 
-	sock->cumulative_stats[PGM_PC_SOURCE_BYTES_SENT] += tpdu_length * 2;
+	pgm_stats_add (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_BYTES_SENT, tpdu_length * 2);
+	return TRUE;
+}
+
+/* selective NAKs follow a live designated local repairer advertisement.
+ */
+
+static inline
+const struct sockaddr*
+nak_nla (
+	const pgm_peer_t* const	peer
+	)
+{
+	return (const struct sockaddr*)(peer->redirect_expiry ? &peer->redirect_nla : &peer->nla);
+}
+
+/* NAKs generated by one sweep of the peer timers are sent together, with one
+ * batch call for each of the router alert and regular send sockets.  a NAK
+ * list is at most 62 further sequence numbers.
+ */
+
+#define PGM_NAK_BATCH_LEN	64
+#define PGM_NAK_BATCH_TPDU	( sizeof(struct pgm_header) + sizeof(struct pgm_nak6) + \
+				  sizeof(struct pgm_opt_length) + sizeof(struct pgm_opt_header) + \
+				  sizeof(uint8_t) + ( 62 * sizeof(uint32_t) ) )
+
+struct pgm_nak_batch_t {
+	unsigned		len;
+	bool			use_router_alert[ PGM_NAK_BATCH_LEN ];
+	struct sockaddr_storage	to[ PGM_NAK_BATCH_LEN ];
+	size_t			tpdu_length[ PGM_NAK_BATCH_LEN ];
+	char			buf[ PGM_NAK_BATCH_LEN ][ PGM_NAK_BATCH_TPDU ];
+};
+
+/* send all queued NAKs, a NAK the socket does not accept is lost as with a
+ * single send and repeated on NCF timeout.
+ *
+ * returns FALSE if operation would block.
+ */
+
+static
+bool
+nak_batch_flush (
+	pgm_sock_t* const	sock
+	)
+{
+	struct pgm_nak_batch_t* const batch = sock->nak_batch;
+	struct pgm_iovec vector[ PGM_NAK_BATCH_LEN ];
+	const struct sockaddr* to[ PGM_NAK_BATCH_LEN ];
+	bool is_blocked = FALSE;
+
+/* pre-conditions */
+	pgm_assert (NULL != batch);
+
+	pgm_debug ("nak_batch_flush (sock:%p len:%u)", (const void*)sock, batch->len);
+
+	for (unsigned pass = 0; pass < 2; pass++)
+	{
+		const bool use_router_alert = (0 == pass);
+		unsigned count = 0;
+		for (unsigned i = 0; i < batch->len; i++) {
+			if (batch->use_router_alert[ i ] != use_router_alert)
+				continue;
+			vector[ count ].iov_base = batch->buf[ i ];
+			vector[ count ].iov_len  = batch->tpdu_length[ i ];
+			to[ count ] = (const struct sockaddr*)&batch->to[ i ];
+			count++;
+		}
+		if (count > 0 &&
+		    pgm_sendto_batch (sock, use_router_alert, vector, to, count) < (ssize_t)count &&
+		    PGM_SOCK_EAGAIN == pgm_get_last_sock_error())
+			is_blocked = TRUE;
+	}
+	batch->len = 0;
+	return !is_blocked;
+}
+
+/* queue a NAK for nak_batch_flush(), a full batch is sent first.
+ *
+ * returns FALSE if operation would block.
+ */
+
+static
+bool
+nak_batch_push (
+	pgm_sock_t*	       const restrict sock,
+	const bool			      use_router_alert,
+	const void*		     restrict buf,
+	const size_t			      tpdu_length,
+	const struct sockaddr*	     restrict to
+	)
+{
+	struct pgm_nak_batch_t* batch = sock->nak_batch;
+
+/* pre-conditions */
+	pgm_assert (NULL != buf);
+	pgm_assert_cmpuint (tpdu_length, <=, PGM_NAK_BATCH_TPDU);
+	pgm_assert (NULL != to);
+
+	if (PGM_UNLIKELY(NULL == batch))
+		batch = sock->nak_batch = pgm_new0 (struct pgm_nak_batch_t, 1);
+	else if (PGM_UNLIKELY(PGM_NAK_BATCH_LEN == batch->len) && !nak_batch_flush (sock))
+		return FALSE;
+
+	const unsigned i = batch->len++;
+	batch->use_router_alert[ i ] = use_router_alert;
+	memcpy (&batch->to[ i ], to, pgm_sockaddr_len (to));
+	batch->tpdu_length[ i ] = tpdu_length;
+	memcpy (batch->buf[ i ], buf, tpdu_length);
 	return TRUE;
 }
 
@@ -1053,7 +1887,6 @@ send_nak (
 	struct pgm_header *header;
 	struct pgm_nak	  *nak;
 	struct pgm_nak6   *nak6;
-	ssize_t		   sent;
 
 /* pre-conditions */
 	pgm_assert (NULL != sock);
@@ -1072,7 +1905,7 @@ send_nak (
 	memcpy (header->pgm_gsi, &source->tsi.gsi, sizeof(pgm_gsi_t));
 
 /* dport & sport swap over for a nak */
-	header->pgm_sport	= sock->dport;
+	header->pgm_sport	= source->dport;
 	header->pgm_dport	= source->tsi.sport;
 	header->pgm_type        = PGM_NAK;
         header->pgm_options     = 0;
@@ -1093,19 +1926,12 @@ send_nak (
         header->pgm_checksum    = 0;
         header->pgm_checksum	= pgm_csum_fold (pgm_csum_partial (buf, (uint16_t)tpdu_length, 0));
 
-	sent = pgm_sendto (sock,
-			   FALSE,			/* not rate limited */
-			   NULL,
-			   TRUE,			/* with router alert */
-			   header,
-			   tpdu_length,
-			   (struct sockaddr*)&source->nla,
-			   pgm_sockaddr_len((struct sockaddr*)&source->nla));
-	if (sent < 0 && PGM_LIKELY(PGM_SOCK_EAGAIN == pgm_get_last_sock_error()))
+	if (!nak_batch_push (sock, TRUE, header, tpdu_length, nak_nla (source)))	/* with router alert */
 		return FALSE;
 
-	source->cumulative_stats[PGM_PC_RECEIVER_SELECTIVE_NAK_PACKETS_SENT]++;
-	source->cumulative_stats[PGM_PC_RECEIVER_SELECTIVE_NAKS_SENT]++;
+	pgm_stats_inc (&source->cumulative_stats, PGM_PC_RECEIVER_SELECTIVE_NAK_PACKETS_SENT);
+	pgm_stats_inc (&source->cumulative_stats, PGM_PC_RECEIVER_SELECTIVE_NAKS_SENT);
+	pgm_evtrace (PGM_EV_NAK_SENT, &source->tsi, sequence, 1);
 	return TRUE;
 }
 
@@ -1128,7 +1954,6 @@ send_parity_nak (
 	struct pgm_header *header;
 	struct pgm_nak	  *nak;
 	struct pgm_nak6   *nak6;
-	ssize_t		   sent;
 
 /* pre-conditions */
 	pgm_assert (NULL != sock);
@@ -1148,7 +1973,7 @@ send_parity_nak (
 	memcpy (header->pgm_gsi, &source->tsi.gsi, sizeof(pgm_gsi_t));
 
 /* dport & sport swap over for a nak */
-	header->pgm_sport	= sock->dport;
+	header->pgm_sport	= source->dport;
 	header->pgm_dport	= source->tsi.sport;
 	header->pgm_type        = PGM_NAK;
         header->pgm_options     = PGM_OPT_PARITY;	/* this is a parity packet */
@@ -1168,19 +1993,11 @@ send_parity_nak (
         header->pgm_checksum    = 0;
         header->pgm_checksum	= pgm_csum_fold (pgm_csum_partial (buf, (uint16_t)tpdu_length, 0));
 
-	sent = pgm_sendto (sock,
-			   FALSE,		/* not rate limited */
-			   NULL,
-			   TRUE,		/* with router alert */
-			   header,
-			   tpdu_length,
-			   (struct sockaddr*)&source->nla,
-			   pgm_sockaddr_len((struct sockaddr*)&source->nla));
-	if (sent < 0 && PGM_LIKELY(PGM_SOCK_EAGAIN == pgm_get_last_sock_error()))
+	if (!nak_batch_push (sock, TRUE, header, tpdu_length, (struct sockaddr*)&source->nla))	/* with router alert */
 		return FALSE;
 
-	source->cumulative_stats[PGM_PC_RECEIVER_PARITY_NAK_PACKETS_SENT]++;
-	source->cumulative_stats[PGM_PC_RECEIVER_PARITY_NAKS_SENT]++;
+	pgm_stats_inc (&source->cumulative_stats, PGM_PC_RECEIVER_PARITY_NAK_PACKETS_SENT);
+	pgm_stats_inc (&source->cumulative_stats, PGM_PC_RECEIVER_PARITY_NAKS_SENT);
 	return TRUE;
 }
 
@@ -1205,7 +2022,6 @@ send_nak_list (
 	struct pgm_opt_header	*opt_header;
 	struct pgm_opt_length	*opt_len;
 	struct pgm_opt_nak_list *opt_nak_list;
-	ssize_t			 sent;
 
 /* pre-conditions */
 	pgm_assert (NULL != sock);
@@ -1243,7 +2059,7 @@ send_nak_list (
 	memcpy (header->pgm_gsi, &source->tsi.gsi, sizeof(pgm_gsi_t));
 
 /* dport & sport swap over for a nak */
-	header->pgm_sport	= sock->dport;
+	header->pgm_sport	= source->dport;
 	header->pgm_dport	= source->tsi.sport;
 	header->pgm_type        = PGM_NAK;
         header->pgm_options     = PGM_OPT_PRESENT | PGM_OPT_NETWORK;
@@ -1272,6 +2088,7 @@ send_nak_list (
 						( (sqn_list->len-1) * sizeof(uint32_t) ) );
 	opt_header = (struct pgm_opt_header*)(opt_len + 1);
 	opt_header->opt_type	= PGM_OPT_NAK_LIST | PGM_OPT_END;
+	opt_header->opt_reserved = 0;
 	opt_header->opt_length	= sizeof(struct pgm_opt_header) + sizeof(uint8_t)
 				+ ( (sqn_list->len-1) * sizeof(uint32_t) );
 	opt_nak_list = (struct pgm_opt_nak_list*)(opt_header + 1);
@@ -1283,6 +2100,148 @@ send_nak_list (
         header->pgm_checksum    = 0;
         header->pgm_checksum	= pgm_csum_fold (pgm_csum_partial (buf, (uint16_t)tpdu_length, 0));
 
+	if (!nak_batch_push (sock, FALSE, header, tpdu_length, nak_nla (source)))	/* regular socket */
+		return FALSE;
+
+	pgm_stats_inc (&source->cumulative_stats, PGM_PC_RECEIVER_SELECTIVE_NAK_PACKETS_SENT);
+	pgm_stats_add (&source->cumulative_stats, PGM_PC_RECEIVER_SELECTIVE_NAKS_SENT, 1 + sqn_list->len);
+	pgm_evtrace (PGM_EV_NAK_SENT, &source->tsi, sqn_list->sqn[0], 1 + sqn_list->len);
+	return TRUE;
+}
+
+/* expand runs of lost sequence numbers into NAK_LIST chunks, a final lone
+ * sequence number is sent as a plain NAK.
+ *
+ * on success, TRUE is returned.  on error, FALSE is returned.
+ */
+
+static
+bool
+send_nak_ranges (
+	pgm_sock_t*		           const restrict sock,
+	pgm_peer_t*			   const restrict source,
+	const struct pgm_sqn_range_list_t* const restrict nak_ranges
+	)
+{
+	struct pgm_sqn_list_t nak_list = { .len = 0 };
+
+/* pre-conditions */
+	pgm_assert (NULL != nak_ranges);
+	pgm_assert_cmpuint (nak_ranges->len, >, 0);
+
+	pgm_debug ("send_nak_ranges (sock:%p source:%p runs:%u sequences:%" PRIu32 ")",
+		(const void*)sock, (const void*)source, nak_ranges->len, nak_ranges->total);
+
+	for (unsigned i = 0; i < nak_ranges->len; i++) {
+		const struct pgm_sqn_range_t* range = &nak_ranges->range[ i ];
+		for (uint32_t j = 0; j < range->count; j++) {
+			nak_list.sqn[ nak_list.len++ ] = range->first + j;
+			if (nak_list.len == PGM_N_ELEMENTS(nak_list.sqn)) {
+				if (!send_nak_list (sock, source, &nak_list))
+					return FALSE;
+				nak_list.len = 0;
+			}
+		}
+	}
+	if (nak_list.len > 1)
+		return send_nak_list (sock, source, &nak_list);
+	if (nak_list.len)
+		return send_nak (sock, source, nak_list.sqn[0]);
+	return TRUE;
+}
+
+/* send NAK with OPT_CATCHUP requesting count sequences from first as unicast
+ * RDATA to our NLA.
+ *
+ * on success, TRUE is returned, returns FALSE if operation would block.
+ */
+
+static
+bool
+send_catchup (
+	pgm_sock_t* const restrict sock,
+	pgm_peer_t* const restrict source,
+	const uint32_t		   first,
+	const uint32_t		   count
+	)
+{
+	size_t			 tpdu_length;
+	char			*buf;
+	struct pgm_header	*header;
+	struct pgm_nak		*nak;
+	struct pgm_nak6		*nak6;
+	struct pgm_opt_header	*opt_header;
+	struct pgm_opt_length	*opt_len;
+	struct pgm_opt_catchup	*opt_catchup;
+	size_t			 opt_catchup_length;
+	ssize_t			 sent;
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != source);
+	pgm_assert_cmpuint (count, >, 0);
+
+	pgm_debug ("send_catchup (sock:%p source:%p first:%" PRIu32 " count:%" PRIu32 ")",
+		(void*)sock, (void*)source, first, count);
+
+	opt_catchup_length = (AF_INET6 == sock->send_addr.ss_family) ?
+				sizeof(struct pgm_opt6_catchup) :
+				sizeof(struct pgm_opt_catchup);
+	tpdu_length = sizeof(struct pgm_header) +
+			    sizeof(struct pgm_nak) +
+			    sizeof(struct pgm_opt_length) +		/* includes header */
+			    sizeof(struct pgm_opt_header) +
+			    opt_catchup_length;
+	if (AF_INET6 == source->nla.ss_family)
+		tpdu_length += sizeof(struct pgm_nak6) - sizeof(struct pgm_nak);
+	buf = pgm_alloca (tpdu_length);
+	if (PGM_UNLIKELY(pgm_mem_gc_friendly))
+		memset (buf, 0, tpdu_length);
+	header = (struct pgm_header*)buf;
+	nak  = (struct pgm_nak *)(header + 1);
+	nak6 = (struct pgm_nak6*)(header + 1);
+	memcpy (header->pgm_gsi, &source->tsi.gsi, sizeof(pgm_gsi_t));
+
+/* dport & sport swap over for a nak */
+	header->pgm_sport	= source->dport;
+	header->pgm_dport	= source->tsi.sport;
+	header->pgm_type        = PGM_NAK;
+        header->pgm_options     = PGM_OPT_PRESENT;
+        header->pgm_tsdu_length = 0;
+
+/* NAK */
+	nak->nak_sqn		= pgm_htonl (first);
+
+/* source nla */
+	pgm_sockaddr_to_nla ((struct sockaddr*)&source->nla, (char*)&nak->nak_src_nla_afi);
+
+/* group nla */
+	pgm_sockaddr_to_nla ((struct sockaddr*)&source->group_nla,
+				(AF_INET6 == source->nla.ss_family) ?
+					(char*)&nak6->nak6_grp_nla_afi :
+					(char*)&nak->nak_grp_nla_afi);
+/* OPT_CATCHUP */
+	opt_len = (AF_INET6 == source->nla.ss_family) ?
+			(struct pgm_opt_length*)(nak6 + 1) :
+			(struct pgm_opt_length*)(nak  + 1);
+	opt_len->opt_type	= PGM_OPT_LENGTH;
+	opt_len->opt_length	= sizeof(struct pgm_opt_length);
+	opt_len->opt_total_length = pgm_htons (	sizeof(struct pgm_opt_length) +
+						sizeof(struct pgm_opt_header) +
+						opt_catchup_length );
+	opt_header = (struct pgm_opt_header*)(opt_len + 1);
+	opt_header->opt_type	= PGM_OPT_CATCHUP | PGM_OPT_END;
+	opt_header->opt_reserved = 0;
+	opt_header->opt_length	= (uint8_t)(sizeof(struct pgm_opt_header) + opt_catchup_length);
+	opt_catchup = (struct pgm_opt_catchup*)(opt_header + 1);
+	opt_catchup->opt_reserved  = 0;
+	opt_catchup->catchup_count = pgm_htonl (count);
+/* our unicast NLA receives the repairs */
+	pgm_sockaddr_to_nla ((struct sockaddr*)&sock->send_addr, (char*)&opt_catchup->opt_nla_afi);
+
+        header->pgm_checksum    = 0;
+        header->pgm_checksum	= pgm_csum_fold (pgm_csum_partial (buf, (uint16_t)tpdu_length, 0));
+
 	sent = pgm_sendto (sock,
 			   FALSE,			/* not rate limited */
 			   NULL,
@@ -1294,11 +2253,108 @@ send_nak_list (
 	if (sent < 0 && PGM_LIKELY(PGM_SOCK_EAGAIN == pgm_get_last_sock_error()))
 		return FALSE;
 
-	source->cumulative_stats[PGM_PC_RECEIVER_SELECTIVE_NAK_PACKETS_SENT]++;
-	source->cumulative_stats[PGM_PC_RECEIVER_SELECTIVE_NAKS_SENT] += 1 + sqn_list->len;
+	pgm_stats_inc (&source->cumulative_stats, PGM_PC_RECEIVER_SELECTIVE_NAK_PACKETS_SENT);
+	pgm_stats_add (&source->cumulative_stats, PGM_PC_RECEIVER_SELECTIVE_NAKS_SENT, count);
+	pgm_evtrace (PGM_EV_NAK_SENT, &source->tsi, first, count);
 	return TRUE;
 }
 
+/* PGM_CATCHUP on joining a session: open the receive window at the advertised
+ * trail, up to the configured count of sequences before the lead, and request
+ * them from the source as one unicast stream.  the placeholders are NAKed as
+ * usual once the hold-off expires.
+ */
+
+static
+void
+catchup_define (
+	pgm_sock_t* const restrict sock,
+	pgm_peer_t* const restrict source,
+	const uint32_t		   txw_trail,
+	const uint32_t		   txw_lead,	/* last sequence to catch up */
+	const pgm_time_t	   now,
+	const pgm_time_t	   tstamp
+	)
+{
+	uint32_t first = txw_trail;
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != source);
+	pgm_assert (sock->catchup_sqns > 0);
+	pgm_assert (!source->window->is_defined);
+
+/* leave space in the window for the lead */
+	const uint32_t max_sqns = MIN(sock->catchup_sqns, pgm_rxw_max_length (source->window) - 1);
+	if ((uint32_t)(txw_lead + 1 - first) > max_sqns)
+		first = txw_lead + 1 - max_sqns;
+	if (0 == max_sqns || !pgm_uint32_lte (first, txw_lead))
+		return;
+
+	const uint32_t count = txw_lead - first + 1;
+	const pgm_time_t nak_rb_expiry = tstamp + sock->catchup_ivl;
+	pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Catching up on %" PRIu32 " sequences from #%" PRIu32 "."), count, first);
+	if (pgm_rxw_catchup (source->window, first, txw_lead, now, nak_rb_expiry)) {
+		pgm_timer_lock (sock);
+		if (pgm_time_after (sock->next_poll, nak_rb_expiry))
+			sock->next_poll = nak_rb_expiry;
+		pgm_timer_unlock (sock);
+	}
+	if (sock->can_send_nak && !send_catchup (sock, source, first, count))
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Catch-up request would block, falling back to NAKs."));
+}
+
+/* PGM_WARM_RESTART of a source recorded by a previous process: open the receive
+ * window at the first sequence the application had not read, placeholders up to
+ * the lead are NAKed as usual once the hold-off expires.  sequences beyond the
+ * reach of the window are skipped.
+ */
+
+static
+void
+restart_define (
+	pgm_sock_t* const restrict sock,
+	pgm_peer_t* const restrict source,
+	const uint32_t		   txw_lead,	/* last sequence to recover */
+	const pgm_time_t	   now,
+	const pgm_time_t	   tstamp
+	)
+{
+	uint32_t first = source->restart_next;
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != source);
+	pgm_assert (!source->window->is_defined);
+
+	source->is_restarted = 0;
+/* nothing missed, the window opens as for a new source */
+	if (first == txw_lead + 1)
+		return;
+	if (!pgm_uint32_lte (first, txw_lead)) {
+		pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Restart sequence #%" PRIu32 " beyond lead #%" PRIu32 ", source restarted."), first, txw_lead);
+		return;
+	}
+/* leave space in the window for the lead */
+	const uint32_t max_sqns = pgm_rxw_max_length (source->window) - 1;
+	if (0 == max_sqns)
+		return;
+	if ((uint32_t)(txw_lead + 1 - first) > max_sqns) {
+		pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Skipping %" PRIu32 " sequences from #%" PRIu32 " beyond the receive window."),
+			(uint32_t)(txw_lead + 1 - first) - max_sqns, first);
+		first = txw_lead + 1 - max_sqns;
+	}
+
+	const pgm_time_t nak_rb_expiry = tstamp + nak_rb_ivl (sock, source);
+	pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Recovering %" PRIu32 " sequences from #%" PRIu32 " after restart."), txw_lead - first + 1, first);
+	if (pgm_rxw_catchup (source->window, first, txw_lead, now, nak_rb_expiry)) {
+		pgm_timer_lock (sock);
+		if (pgm_time_after (sock->next_poll, nak_rb_expiry))
+			sock->next_poll = nak_rb_expiry;
+		pgm_timer_unlock (sock);
+	}
+}
+
 /* send ACK upstream to source
  *
  * on success, TRUE is returned.  on error, FALSE is returned.
@@ -1344,7 +2400,7 @@ send_ack (
 	memcpy (header->pgm_gsi, &source->tsi.gsi, sizeof(pgm_gsi_t));
 
 /* dport & sport swap over for an ack */
-	header->pgm_sport	= sock->dport;
+	header->pgm_sport	= source->dport;
 	header->pgm_dport	= source->tsi.sport;
 	header->pgm_type	= PGM_ACK;
 	header->pgm_options	= PGM_OPT_PRESENT;
@@ -1391,7 +2447,205 @@ send_ack (
 	if (sent < 0 && PGM_LIKELY(PGM_SOCK_EAGAIN == pgm_get_last_sock_error()))
 		return FALSE;
 
-	source->cumulative_stats[PGM_PC_RECEIVER_ACKS_SENT]++;
+	pgm_stats_inc (&source->cumulative_stats, PGM_PC_RECEIVER_ACKS_SENT);
+	return TRUE;
+}
+
+/* ACK with OPT_ACK_TRAIL reporting the contiguous lead of the receive window
+ * to the source, outside of PGMCC.
+ *
+ * on success, TRUE is returned.  if operation would block, FALSE is returned.
+ */
+
+static
+bool
+send_ack_trail (
+	pgm_sock_t*const restrict	sock,
+	pgm_peer_t*const restrict	source
+	)
+{
+	size_t			  tpdu_length, opt_ack_trail_length;
+	char			 *buf;
+	struct pgm_header	 *header;
+	struct pgm_ack		 *ack;
+	struct pgm_opt_header	 *opt_header;
+	struct pgm_opt_length	 *opt_len;
+	struct pgm_opt_ack_trail *opt_ack_trail;
+	uint32_t		  lead;
+	ssize_t			  sent;
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != source);
+
+	pgm_debug ("send_ack_trail (sock:%p source:%p)",
+		(void*)sock, (void*)source);
+
+/* nothing to report yet or nowhere to report to */
+	if (!pgm_rxw_ack_trail (source->window, &lead) ||
+	    pgm_sockaddr_is_addr_unspecified ((struct sockaddr*)&source->nla))
+		return TRUE;
+
+	opt_ack_trail_length = (AF_INET6 == sock->send_addr.ss_family) ?
+				sizeof(struct pgm_opt6_ack_trail) :
+				sizeof(struct pgm_opt_ack_trail);
+	tpdu_length = sizeof(struct pgm_header) +
+		      sizeof(struct pgm_ack) +
+		      sizeof(struct pgm_opt_length) +		/* includes header */
+		      sizeof(struct pgm_opt_header) +
+		      opt_ack_trail_length;
+	buf = pgm_alloca (tpdu_length);
+	if (PGM_UNLIKELY(pgm_mem_gc_friendly))
+		memset (buf, 0, tpdu_length);
+	header = (struct pgm_header*)buf;
+	ack = (struct pgm_ack*)(header + 1);
+	memcpy (header->pgm_gsi, &source->tsi.gsi, sizeof(pgm_gsi_t));
+
+/* dport & sport swap over for an ack */
+	header->pgm_sport	= source->dport;
+	header->pgm_dport	= source->tsi.sport;
+	header->pgm_type	= PGM_ACK;
+	header->pgm_options	= PGM_OPT_PRESENT;
+	header->pgm_tsdu_length = 0;
+
+/* ACK, every sequence of the bitmap precedes the contiguous lead */
+	ack->ack_rx_max		= pgm_htonl (lead);
+	ack->ack_bitmap		= pgm_htonl (0xffffffff);
+
+/* OPT_ACK_TRAIL */
+	opt_len = (struct pgm_opt_length*)(ack + 1);
+	opt_len->opt_type	= PGM_OPT_LENGTH;
+	opt_len->opt_length	= sizeof(struct pgm_opt_length);
+	opt_len->opt_total_length = pgm_htons ((uint16_t)(sizeof(struct pgm_opt_length) +
+							   sizeof(struct pgm_opt_header) +
+							   opt_ack_trail_length));
+	opt_header = (struct pgm_opt_header*)(opt_len + 1);
+	opt_header->opt_type	= PGM_OPT_ACK_TRAIL | PGM_OPT_END;
+	opt_header->opt_reserved = 0;
+	opt_header->opt_length	= (uint8_t)(sizeof(struct pgm_opt_header) + opt_ack_trail_length);
+	opt_ack_trail = (struct pgm_opt_ack_trail*)(opt_header + 1);
+	memset (opt_ack_trail, 0, opt_ack_trail_length);
+	pgm_sockaddr_to_nla ((struct sockaddr*)&sock->send_addr, (char*)&opt_ack_trail->opt_nla_afi);
+
+	header->pgm_checksum	= 0;
+	header->pgm_checksum	= pgm_csum_fold (pgm_csum_partial (buf, (uint16_t)tpdu_length, 0));
+
+	sent = pgm_sendto (sock,
+			   FALSE,			/* not rate limited */
+			   NULL,
+			   FALSE,			/* regular socket */
+			   header,
+			   tpdu_length,
+			   (struct sockaddr*)&source->nla,
+			   pgm_sockaddr_len((struct sockaddr*)&source->nla));
+	if (sent < 0 && PGM_LIKELY(PGM_SOCK_EAGAIN == pgm_get_last_sock_error()))
+		return FALSE;
+
+	pgm_stats_inc (&source->cumulative_stats, PGM_PC_RECEIVER_ACKS_SENT);
+	return TRUE;
+}
+
+/* ACK with OPT_CREDIT reporting the unused receive window and the rate the
+ * application has read from it since the previous report.
+ *
+ * on success, TRUE is returned.  if operation would block, FALSE is returned.
+ */
+
+static
+bool
+send_credit (
+	pgm_sock_t*const restrict	sock,
+	pgm_peer_t*const restrict	source,
+	const pgm_time_t		now
+	)
+{
+	size_t			  tpdu_length, opt_credit_length;
+	char			 *buf;
+	struct pgm_header	 *header;
+	struct pgm_ack		 *ack;
+	struct pgm_opt_header	 *opt_header;
+	struct pgm_opt_length	 *opt_len;
+	struct pgm_opt_credit	 *opt_credit;
+	const pgm_rxw_t		 *window;
+	uint64_t		  read_rate = 0;
+	ssize_t			  sent;
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != source);
+
+	pgm_debug ("send_credit (sock:%p source:%p now:%" PGM_TIME_FORMAT ")",
+		(void*)sock, (void*)source, now);
+
+	window = source->window;
+/* nothing to report yet or nowhere to report to */
+	if (!window->is_defined ||
+	    pgm_sockaddr_is_addr_unspecified ((struct sockaddr*)&source->nla))
+		return TRUE;
+
+	if (source->credit_tstamp && pgm_time_after (now, source->credit_tstamp))
+		read_rate = ((window->bytes_delivered - source->credit_bytes) * UINT64_C(1000000)) / pgm_to_usecs (now - source->credit_tstamp);
+
+	opt_credit_length = (AF_INET6 == sock->send_addr.ss_family) ?
+				sizeof(struct pgm_opt6_credit) :
+				sizeof(struct pgm_opt_credit);
+	tpdu_length = sizeof(struct pgm_header) +
+		      sizeof(struct pgm_ack) +
+		      sizeof(struct pgm_opt_length) +		/* includes header */
+		      sizeof(struct pgm_opt_header) +
+		      opt_credit_length;
+	buf = pgm_alloca (tpdu_length);
+	if (PGM_UNLIKELY(pgm_mem_gc_friendly))
+		memset (buf, 0, tpdu_length);
+	header = (struct pgm_header*)buf;
+	ack = (struct pgm_ack*)(header + 1);
+	memcpy (header->pgm_gsi, &source->tsi.gsi, sizeof(pgm_gsi_t));
+
+/* dport & sport swap over for an ack */
+	header->pgm_sport	= source->dport;
+	header->pgm_dport	= source->tsi.sport;
+	header->pgm_type	= PGM_ACK;
+	header->pgm_options	= PGM_OPT_PRESENT;
+	header->pgm_tsdu_length = 0;
+
+/* ACK of the window lead, the bitmap is not significant */
+	ack->ack_rx_max		= pgm_htonl (pgm_rxw_lead (window));
+	ack->ack_bitmap		= pgm_htonl (window->bitmap);
+
+/* OPT_CREDIT */
+	opt_len = (struct pgm_opt_length*)(ack + 1);
+	opt_len->opt_type	= PGM_OPT_LENGTH;
+	opt_len->opt_length	= sizeof(struct pgm_opt_length);
+	opt_len->opt_total_length = pgm_htons ((uint16_t)(sizeof(struct pgm_opt_length) +
+							   sizeof(struct pgm_opt_header) +
+							   opt_credit_length));
+	opt_header = (struct pgm_opt_header*)(opt_len + 1);
+	opt_header->opt_type	= PGM_OPT_CREDIT | PGM_OPT_END;
+	opt_header->opt_reserved = 0;
+	opt_header->opt_length	= (uint8_t)(sizeof(struct pgm_opt_header) + opt_credit_length);
+	opt_credit = (struct pgm_opt_credit*)(opt_header + 1);
+	memset (opt_credit, 0, opt_credit_length);
+	opt_credit->opt_free_sqns = pgm_htonl (pgm_rxw_max_length (window) - pgm_rxw_length (window));
+	opt_credit->opt_read_rate = pgm_htonl ((uint32_t)MIN(read_rate, UINT32_MAX));
+	pgm_sockaddr_to_nla ((struct sockaddr*)&sock->send_addr, (char*)&opt_credit->opt_nla_afi);
+
+	header->pgm_checksum	= 0;
+	header->pgm_checksum	= pgm_csum_fold (pgm_csum_partial (buf, (uint16_t)tpdu_length, 0));
+
+	sent = pgm_sendto (sock,
+			   FALSE,			/* not rate limited */
+			   NULL,
+			   FALSE,			/* regular socket */
+			   header,
+			   tpdu_length,
+			   (struct sockaddr*)&source->nla,
+			   pgm_sockaddr_len((struct sockaddr*)&source->nla));
+	if (sent < 0 && PGM_LIKELY(PGM_SOCK_EAGAIN == pgm_get_last_sock_error()))
+		return FALSE;
+
+	source->credit_bytes  = window->bytes_delivered;
+	source->credit_tstamp = now;
+	pgm_stats_inc (&source->cumulative_stats, PGM_PC_RECEIVER_ACKS_SENT);
 	return TRUE;
 }
 
@@ -1482,6 +2736,24 @@ ack_rb_state (
 	return TRUE;
 }
 
+/* pull the socket timer forward to expiry, zero for no change.
+ */
+
+static inline
+void
+update_next_poll (
+	pgm_sock_t* const	sock,
+	const pgm_time_t	expiry
+	)
+{
+	if (0 == expiry)
+		return;
+	pgm_timer_lock (sock);
+	if (pgm_time_after (sock->next_poll, expiry))
+		sock->next_poll = expiry;
+	pgm_timer_unlock (sock);
+}
+
 /* check all receiver windows for packets in BACK-OFF_STATE, on expiration send a NAK.
  * update sock::next_nak_rb_timestamp for next expiration time.
  *
@@ -1500,6 +2772,7 @@ nak_rb_state (
 {
 	pgm_queue_t*		nak_backoff_queue;
 	unsigned		dropped_invalid = 0;
+	unsigned		overdue = 0;
 
 /* pre-conditions */
 	pgm_assert (NULL != sock);
@@ -1509,6 +2782,12 @@ nak_rb_state (
 	pgm_debug ("nak_rb_state (sock:%p peer:%p now:%" PGM_TIME_FORMAT ")",
 		(void*)sock, (void*)peer, now);
 
+/* designated local repairer advertisement lapsed, NAK the source */
+	if (peer->redirect_expiry && pgm_time_after_eq (now, peer->redirect_expiry)) {
+		pgm_trace (PGM_LOG_ROLE_SESSION,_("Designated local repairer expired for tsi %s"), pgm_tsi_print (&peer->tsi));
+		peer->redirect_expiry = 0;
+	}
+
 /* send all NAKs first, lack of data is blocking contiguous processing and its 
  * better to get the notification out a.s.a.p. even though it might be waiting
  * in a kernel queue.
@@ -1563,6 +2842,14 @@ nak_rb_state (
 					continue;
 				}
 
+				if (pgm_rxw_is_overdue (peer->window, skb, now)) {
+					overdue++;
+					pgm_evtrace (PGM_EV_DATA_LOST, &peer->tsi, skb->sequence, 2);
+					cancel_skb (sock, peer, skb, now);
+					pgm_stats_inc (&peer->cumulative_stats, PGM_PC_RECEIVER_NAKS_FAILED_GEN_EXPIRED);
+					continue;
+				}
+
 /* TODO: parity nak lists */
 				const uint32_t tg_sqn = skb->sequence & tg_sqn_mask;
 				if (	(  nak_pkt_cnt && tg_sqn == nak_tg_sqn ) ||
@@ -1573,16 +2860,18 @@ nak_rb_state (
 					if (!nak_pkt_cnt++)
 						nak_tg_sqn = tg_sqn;
 					state->nak_transmit_count++;
+					state->nak_tstamp = now;
 
 #ifdef PGM_ABSOLUTE_EXPIRY
-					state->timer_expiry += sock->nak_rpt_ivl;
+					state->timer_expiry += nak_rpt_ivl (sock, peer);
 					while (pgm_time_after_eq (now, state->timer_expiry)) {
-						state->timer_expiry += sock->nak_rpt_ivl;
+						state->timer_expiry += nak_rpt_ivl (sock, peer);
 						state->ncf_retry_count++;
 					}
 #else
-					state->timer_expiry = now + sock->nak_rpt_ivl;
+					state->timer_expiry = now + nak_rpt_ivl (sock, peer);
 #endif
+					state->timer_expiry = pgm_rxw_expiry (peer->window, skb, state->timer_expiry);
 					pgm_timer_lock (sock);
 					if (pgm_time_after (sock->next_poll, state->timer_expiry))
 						sock->next_poll = state->timer_expiry;
@@ -1604,7 +2893,8 @@ nak_rb_state (
 	}
 	else
 	{
-		struct pgm_sqn_list_t nak_list = { .len = 0 };
+		struct pgm_sqn_range_list_t nak_ranges = { .len = 0, .total = 0 };
+		pgm_time_t nak_rpt_expiry = 0;
 
 /* select NAK generation */
 
@@ -1628,35 +2918,44 @@ nak_rb_state (
 					continue;
 				}
 
+				if (pgm_rxw_is_overdue (peer->window, skb, now)) {
+					overdue++;
+					pgm_evtrace (PGM_EV_DATA_LOST, &peer->tsi, skb->sequence, 2);
+					cancel_skb (sock, peer, skb, now);
+					pgm_stats_inc (&peer->cumulative_stats, PGM_PC_RECEIVER_NAKS_FAILED_GEN_EXPIRED);
+					continue;
+				}
+
+/* flush when a new run does not fit */
+				if (!pgm_sqn_range_list_add (&nak_ranges, skb->sequence)) {
+					update_next_poll (sock, nak_rpt_expiry);
+					if (sock->can_send_nak && !send_nak_ranges (sock, peer, &nak_ranges))
+						return FALSE;
+					nak_ranges.len = nak_ranges.total = 0;
+					pgm_sqn_range_list_add (&nak_ranges, skb->sequence);
+				}
 				pgm_rxw_state (peer->window, skb, PGM_PKT_STATE_WAIT_NCF);
-				nak_list.sqn[nak_list.len++] = skb->sequence;
 				state->nak_transmit_count++;
+				state->nak_tstamp = now;
 
 /* we have two options here, calculate the expiry time in the new state relative to the current
  * state execution time, skipping missed expirations due to delay in state processing, or base
  * from the actual current time.
  */
 #ifdef PGM_ABSOLUTE_EXPIRY
-				state->timer_expiry += sock->nak_rpt_ivl;
+				state->timer_expiry += nak_rpt_ivl (sock, peer);
 				while (pgm_time_after_eq(now, state->timer_expiry)){
-					state->timer_expiry += sock->nak_rpt_ivl;
+					state->timer_expiry += nak_rpt_ivl (sock, peer);
 					state->ncf_retry_count++;
 				}
 #else
-				state->timer_expiry = now + sock->nak_rpt_ivl;
+				state->timer_expiry = now + nak_rpt_ivl (sock, peer);
 pgm_trace(PGM_LOG_ROLE_NETWORK,_("nak_rpt_expiry in %f seconds."),
 		pgm_to_secsf( state->timer_expiry - now ) );
 #endif
-				pgm_timer_lock (sock);
-				if (pgm_time_after (sock->next_poll, state->timer_expiry))
-					sock->next_poll = state->timer_expiry;
-				pgm_timer_unlock (sock);
-
-				if (nak_list.len == PGM_N_ELEMENTS(nak_list.sqn)) {
-					if (sock->can_send_nak && !send_nak_list (sock, peer, &nak_list))
-						return FALSE;
-					nak_list.len = 0;
-				}
+				state->timer_expiry = pgm_rxw_expiry (peer->window, skb, state->timer_expiry);
+				if (0 == nak_rpt_expiry || pgm_time_after (nak_rpt_expiry, state->timer_expiry))
+					nak_rpt_expiry = state->timer_expiry;
 			}
 			else
 			{	/* packet expires some time later */
@@ -1664,29 +2963,30 @@ pgm_trace(PGM_LOG_ROLE_NETWORK,_("nak_rpt_expiry in %f seconds."),
 			}
 		}
 
-		if (sock->can_send_nak && nak_list.len)
-		{
-			if (nak_list.len > 1 && !send_nak_list (sock, peer, &nak_list))
-				return FALSE;
-			else if (!send_nak (sock, peer, nak_list.sqn[0]))
-				return FALSE;
-		}
+		update_next_poll (sock, nak_rpt_expiry);
+		if (sock->can_send_nak && nak_ranges.len &&
+		    !send_nak_ranges (sock, peer, &nak_ranges))
+			return FALSE;
 
 	}
 
-	if (PGM_UNLIKELY(dropped_invalid))
-	{
+	if (PGM_UNLIKELY(dropped_invalid)) {
 		pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Dropped %u messages due to invalid NLA."), dropped_invalid);
+	}
+
+	if (PGM_UNLIKELY(overdue)) {
+		pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Dropped %u messages past delivery deadline."), overdue);
+	}
 
 /* mark receiver window for flushing on next recv() */
-		if (peer->window->cumulative_losses != peer->last_cumulative_losses &&
-		    !peer->pending_link.data)
-		{
-			sock->is_reset = TRUE;
-			peer->lost_count = peer->window->cumulative_losses - peer->last_cumulative_losses;
-			peer->last_cumulative_losses = peer->window->cumulative_losses;
-			pgm_peer_set_pending (sock, peer);
-		}
+	if (PGM_UNLIKELY((dropped_invalid || overdue) &&
+	    peer->window->cumulative_losses != peer->last_cumulative_losses &&
+	    !peer->pending_link.data))
+	{
+		sock->is_reset = TRUE;
+		peer->lost_count = peer->window->cumulative_losses - peer->last_cumulative_losses;
+		peer->last_cumulative_losses = peer->window->cumulative_losses;
+		pgm_peer_set_pending (sock, peer);
 	}
 
 	if (nak_backoff_queue->length == 0)
@@ -1731,16 +3031,25 @@ pgm_check_peer_state (
 	pgm_debug ("pgm_check_peer_state (sock:%p now:%" PGM_TIME_FORMAT ")",
 		(const void*)sock, now);
 
-	if (!sock->peers_list)
-		return TRUE;
+	const bool is_complete = check_peer_state (sock, now);
+/* NAKs of the sweep */
+	if (NULL != sock->nak_batch && sock->nak_batch->len > 0 && !nak_batch_flush (sock))
+		return FALSE;
+	return is_complete;
+}
 
-	for (pgm_list_t *it = sock->peers_list, *next = it->next;
-	     NULL != it;
-	     it = next)
+static
+bool
+check_peer_state (
+	pgm_sock_t*const	sock,
+	const pgm_time_t	now
+	)
+{
+/* only peers with a due timer, a peer blocked on send stays at the top of the heap */
+	while (sock->peers_heap_len > 0 &&
+	       pgm_time_after_eq (now, sock->peers_heap[0]->timer_expiry))
 	{
-		pgm_peer_t* peer = it->data;
-
-		next = it->next;
+		pgm_peer_t* peer = sock->peers_heap[0];
 
 		if (peer->spmr_expiry)
 		{
@@ -1786,6 +3095,31 @@ pgm_check_peer_state (
 				nak_rdata_state (sock, peer, now);
 		}
 
+/* report contiguous lead for the source to release its copies */
+		if (peer->ack_trail_expiry && pgm_time_after_eq (now, peer->ack_trail_expiry))
+		{
+			if (!send_ack_trail (sock, peer)) {
+				return FALSE;
+			}
+			peer->ack_trail_expiry = now + sock->ack_trail_req.at_ivl;
+		}
+
+/* report credit for the source to pace original data */
+		if (peer->credit_expiry && pgm_time_after_eq (now, peer->credit_expiry))
+		{
+			if (!send_credit (sock, peer, now)) {
+				return FALSE;
+			}
+			peer->credit_expiry = now + sock->credit_req.cr_ivl;
+		}
+
+/* no data within the idle interval, release window storage */
+		if (peer->idle_expiry && pgm_time_after_eq (now, peer->idle_expiry))
+		{
+			pgm_rxw_compact (peer->window);
+			peer->idle_expiry = 0;
+		}
+
 /* expired, remove from hash table and linked list */
 		if (pgm_time_after_eq (now, peer->expiry))
 		{
@@ -1802,16 +3136,30 @@ pgm_check_peer_state (
 			else
 			{
 				pgm_trace (PGM_LOG_ROLE_SESSION,_("Peer expired, tsi %s"), pgm_tsi_print (&peer->tsi));
-				pgm_hashtable_remove (sock->peers_hashtable, &peer->tsi);
-				sock->peers_list = pgm_list_remove_link (sock->peers_list, &peer->peers_link);
+				pgm_evtrace (PGM_EV_PEER_EXPIRED, &peer->tsi, 0, 0);
+				if (NULL != peer->restart_slot) {
+					pgm_restart_release (sock->restart, peer->restart_slot);
+					peer->restart_slot = NULL;
+				}
+				peer_heap_remove (sock, peer);
+				pgm_peertable_remove (sock->peers_hashtable, &peer->tsi);
 				if (sock->last_hash_value == peer)
 					sock->last_hash_value = NULL;
-				pgm_peer_unref (peer);
+				retire_peer (sock, peer);
+				continue;
 			}
 		}
 
+/* re-key on remaining timers, still due timers are revisited on the next dispatch */
+		peer->timer_expiry = next_peer_expiry (peer);
+		if (!pgm_time_after (peer->timer_expiry, now))
+			peer->timer_expiry = now + 1;
+		peer_heap_down (sock, peer->heap_index);
 	}
 
+	if (sock->peers_retired)
+		reclaim_peers (sock);
+
 /* check for waiting contiguous packets */
 	if (sock->peers_pending && !sock->is_pending_read)
 	{
@@ -1841,49 +3189,9 @@ pgm_min_receiver_expiry (
 	pgm_debug ("pgm_min_receiver_expiry (sock:%p expiration:%" PGM_TIME_FORMAT ")",
 		(void*)sock, expiration);
 
-	if (!sock->peers_list)
-		return expiration;
-
-	for (pgm_list_t *it = sock->peers_list, *next = it->next;
-	     NULL != it;
-	     it = next)
-	{
-		pgm_peer_t* peer = it->data;
-
-		next = it->next;
-
-		if (peer->spmr_expiry)
-		{
-			if (pgm_time_after_eq (expiration, peer->spmr_expiry))
-				expiration = peer->spmr_expiry;
-		}
-
-		if (peer->window->ack_backoff_queue.tail)
-		{
-			pgm_assert (sock->use_pgmcc);
-			if (pgm_time_after_eq (expiration, next_ack_rb_expiry (peer->window)))
-				expiration = next_ack_rb_expiry (peer->window);
-		}
-
-		if (peer->window->nak_backoff_queue.tail)
-		{
-			if (pgm_time_after_eq (expiration, next_nak_rb_expiry (peer->window)))
-				expiration = next_nak_rb_expiry (peer->window);
-		}
-
-		if (peer->window->wait_ncf_queue.tail)
-		{
-			if (pgm_time_after_eq (expiration, next_nak_rpt_expiry (peer->window)))
-				expiration = next_nak_rpt_expiry (peer->window);
-		}
-
-		if (peer->window->wait_data_queue.tail)
-		{
-			if (pgm_time_after_eq (expiration, next_nak_rdata_expiry (peer->window)))
-				expiration = next_nak_rdata_expiry (peer->window);
-		}
-
-	}
+	if (sock->peers_heap_len > 0 &&
+	    pgm_time_after (expiration, sock->peers_heap[0]->timer_expiry))
+		expiration = sock->peers_heap[0]->timer_expiry;
 
 	return expiration;
 }
@@ -1903,6 +3211,7 @@ nak_rpt_state (
 	pgm_queue_t*	wait_ncf_queue;
 	unsigned	dropped_invalid = 0;
 	unsigned	dropped = 0;
+	unsigned	overdue = 0;
 
 /* pre-conditions */
 	pgm_assert (NULL != sock);
@@ -1938,17 +3247,25 @@ nak_rpt_state (
 				continue;
 			}
 
-			if (++state->ncf_retry_count >= sock->nak_ncf_retries)
+			if (pgm_rxw_is_overdue (peer->window, skb, now))
+			{
+				overdue++;
+				pgm_evtrace (PGM_EV_DATA_LOST, &peer->tsi, skb->sequence, 2);
+				cancel_skb (sock, peer, skb, now);
+				pgm_stats_inc (&peer->cumulative_stats, PGM_PC_RECEIVER_NAKS_FAILED_GEN_EXPIRED);
+			}
+			else if (++state->ncf_retry_count >= sock->nak_ncf_retries)
 			{
 				dropped++;
+				pgm_evtrace (PGM_EV_DATA_LOST, &peer->tsi, skb->sequence, 0);
 				cancel_skb (sock, peer, skb, now);
-				peer->cumulative_stats[PGM_PC_RECEIVER_NAKS_FAILED_NCF_RETRIES_EXCEEDED]++;
+				pgm_stats_inc (&peer->cumulative_stats, PGM_PC_RECEIVER_NAKS_FAILED_NCF_RETRIES_EXCEEDED);
 			}
 			else
 			{
 /* retry */
-//				state->timer_expiry += nak_rb_ivl(sock);
-				state->timer_expiry = now + nak_rb_ivl (sock);
+//				state->timer_expiry += nak_rb_ivl (sock, peer);
+				state->timer_expiry = pgm_rxw_expiry (peer->window, skb, now + nak_rb_ivl (sock, peer));
 				pgm_rxw_state (peer->window, skb, PGM_PKT_STATE_BACK_OFF);
 				pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("NCF retry #%u attempt %u/%u."), skb->sequence, state->ncf_retry_count, sock->nak_ncf_retries);
 			}
@@ -1977,6 +3294,10 @@ nak_rpt_state (
 		pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Dropped %u messages due to invalid NLA."), dropped_invalid);
 	}
 
+	if (PGM_UNLIKELY(overdue)) {
+		pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Dropped %u messages past delivery deadline."), overdue);
+	}
+
 	if (PGM_UNLIKELY(dropped)) {
 		pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Dropped %u messages due to ncf cancellation, "
 				"rxw_sqns %" PRIu32
@@ -2036,6 +3357,7 @@ nak_rdata_state (
 	pgm_queue_t*	wait_data_queue;
 	unsigned	dropped_invalid = 0;
 	unsigned	dropped = 0;
+	unsigned	overdue = 0;
 
 /* pre-conditions */
 	pgm_assert (NULL != sock);
@@ -2071,16 +3393,25 @@ nak_rdata_state (
 				continue;
 			}
 
+			if (pgm_rxw_is_overdue (peer->window, rdata_skb, now)) {
+				overdue++;
+				pgm_evtrace (PGM_EV_DATA_LOST, &peer->tsi, rdata_skb->sequence, 2);
+				cancel_skb (sock, peer, rdata_skb, now);
+				pgm_stats_inc (&peer->cumulative_stats, PGM_PC_RECEIVER_NAKS_FAILED_GEN_EXPIRED);
+				continue;
+			}
+
 			if (++rdata_state->data_retry_count >= sock->nak_data_retries)
 			{
 				dropped++;
+				pgm_evtrace (PGM_EV_DATA_LOST, &peer->tsi, rdata_skb->sequence, 1);
 				cancel_skb (sock, peer, rdata_skb, now);
-				peer->cumulative_stats[PGM_PC_RECEIVER_NAKS_FAILED_DATA_RETRIES_EXCEEDED]++;
+				pgm_stats_inc (&peer->cumulative_stats, PGM_PC_RECEIVER_NAKS_FAILED_DATA_RETRIES_EXCEEDED);
 				continue;
 			}
 
-//			rdata_state->timer_expiry += nak_rb_ivl(sock);
-			rdata_state->timer_expiry = now + nak_rb_ivl (sock);
+//			rdata_state->timer_expiry += nak_rb_ivl (sock, peer);
+			rdata_state->timer_expiry = pgm_rxw_expiry (peer->window, rdata_skb, now + nak_rb_ivl (sock, peer));
 			pgm_rxw_state (peer->window, rdata_skb, PGM_PKT_STATE_BACK_OFF);
 
 /* retry back to back-off state */
@@ -2108,6 +3439,10 @@ nak_rdata_state (
 		pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Dropped %u messages due to invalid NLA."), dropped_invalid);
 	}
 
+	if (PGM_UNLIKELY(overdue)) {
+		pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Dropped %u messages past delivery deadline."), overdue);
+	}
+
 	if (PGM_UNLIKELY(dropped)) {
 		pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Dropped %u messages due to data cancellation."), dropped);
 	}
@@ -2130,9 +3465,93 @@ nak_rdata_state (
 	}
 }
 
+/* RDATA packet with OPT_SW_REPAIR, held by the receive window until the packets it
+ * codes are recovered.
+ *
+ * returns TRUE is skb has been replaced, FALSE is remains unchanged and can be recycled.
+ */
+
+static
+bool
+on_sw_repair (
+	pgm_sock_t*			  const restrict sock,
+	pgm_peer_t*			  const restrict source,
+	struct pgm_sk_buff_t*		  const restrict skb,
+	const struct pgm_opt_sw_repair*	  const restrict opt_sw_repair,
+	const pgm_time_t				 nak_rb_expiry
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != source);
+	pgm_assert (NULL != skb);
+	pgm_assert (NULL != opt_sw_repair);
+
+	const int add_status = pgm_rxw_add_repair (source->window,
+						   skb,
+						   opt_sw_repair->sw_repair_count,
+						   pgm_ntohs (opt_sw_repair->sw_repair_key),
+						   skb->wire_tstamp,
+						   nak_rb_expiry);
+
+/* skb reference is now invalid */
+	switch (add_status) {
+	case PGM_RXW_MISSING:
+/* flush out 1st time nak packets */
+		pgm_timer_lock (sock);
+		if (pgm_time_after (sock->next_poll, nak_rb_expiry))
+			sock->next_poll = nak_rb_expiry;
+		pgm_timer_unlock (sock);
+/* fall through */
+	case PGM_RXW_INSERTED:
+	case PGM_RXW_UPDATED:
+		return TRUE;
+
+	case PGM_RXW_MALFORMED:
+		pgm_stats_inc (&source->cumulative_stats, PGM_PC_RECEIVER_MALFORMED_RDATA);
+/* fall through */
+	case PGM_RXW_DUPLICATE:
+	case PGM_RXW_BOUNDS:
+		return FALSE;
+
+	default: pgm_assert_not_reached(); break;
+	}
+	return FALSE;
+}
+
+/* as designated local repairer retain a copy of the original TPDU, slots are
+ * recycled as the sequence wraps the history.
+ */
+
+static
+void
+dlr_retain (
+	pgm_sock_t*		    const restrict sock,
+	pgm_peer_t*		    const restrict source,
+	const struct pgm_sk_buff_t* const restrict skb
+	)
+{
+	const uint32_t sequence = pgm_ntohl (skb->pgm_data->data_sqn);
+	const uint16_t tpdu_length = (uint16_t)((const char*)skb->tail - (const char*)skb->pgm_header);
+	struct pgm_sk_buff_t** slot = &source->dlr_history[ sequence % source->dlr_history_len ];
+	struct pgm_sk_buff_t* copy = *slot;
+
+	if (NULL == copy) {
+		copy = *slot = pgm_alloc_skb (sock->max_tpdu);
+	} else if (copy->len > 0 && copy->sequence == sequence) {
+		return;
+	} else {
+		copy->data = copy->tail = copy->head;
+		copy->len  = 0;
+	}
+	memcpy (pgm_skb_put (copy, tpdu_length), skb->pgm_header, tpdu_length);
+	copy->sequence = sequence;
+}
+
 /* ODATA or RDATA packet with any of the following options:
  *
  * OPT_FRAGMENT - this TPDU part of a larger APDU.
+ * OPT_BATCH - TSDU holds length-prefixed coalesced messages.
  *
  * Ownership of skb is taken and must be passed to the receive window or destroyed.
  *
@@ -2159,20 +3578,42 @@ pgm_on_data (
 	pgm_debug ("pgm_on_data (sock:%p source:%p skb:%p)",
 		(void*)sock, (void*)source, (void*)skb);
 
-	const pgm_time_t nak_rb_expiry = skb->tstamp + nak_rb_ivl (sock);
-	const uint_fast16_t tsdu_length = pgm_ntohs (skb->pgm_header->pgm_tsdu_length);
-
 	skb->pgm_data = skb->data;
 
-	const uint_fast16_t opt_total_length = (skb->pgm_header->pgm_options & PGM_OPT_PRESENT) ?
-		pgm_ntohs(*(uint16_t*)( (char*)( skb->pgm_data + 1 ) + sizeof(uint16_t))) :
-		0;
+/* deferred checksum, duplicates are discarded unverified */
+	if (skb->csum_deferred)
+	{
+		if (!(skb->pgm_header->pgm_options & PGM_OPT_PARITY) &&
+		    pgm_rxw_is_duplicate (source->window, pgm_ntohl (skb->pgm_data->data_sqn)))
+		{
+			pgm_stats_inc (&source->cumulative_stats, PGM_PC_RECEIVER_DUP_DATAS);
+			return FALSE;
+		}
+/* held unverified until delivery unless parity is to be reconstructed from it */
+		const bool is_held = (PGM_CHECKSUM_DELIVERY == sock->rx_checksum &&
+				      !sock->use_proactive_parity && !sock->use_ondemand_parity);
+		if (!is_held && PGM_UNLIKELY(!pgm_verify_checksum (skb))) {
+			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded ODATA with checksum mismatch."));
+			pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_CKSUM_ERRORS);
+			return FALSE;
+		}
+	}
+
+	const pgm_time_t nak_rb_expiry = skb->tstamp + nak_rb_ivl (sock, source) + nak_overrun_ivl (sock, skb->tstamp);
+	const uint_fast16_t tsdu_length = pgm_ntohs (skb->pgm_header->pgm_tsdu_length);
+
+	if (PGM_UNLIKELY(!pgm_parse_options (skb, skb->pgm_data + 1))) {
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded ODATA with malformed options."));
+		pgm_stats_inc (&source->cumulative_stats, PGM_PC_RECEIVER_MALFORMED_ODATA);
+		return FALSE;
+	}
+	const uint_fast16_t opt_total_length = pgm_opt_desc_const (skb)->opt_total_length;
 
 /* advance data pointer to payload */
 	pgm_skb_pull (skb, (uint16_t)(sizeof(struct pgm_data) + opt_total_length));
 
-	if (opt_total_length > 0 &&			/* there are options */
-	    get_pgm_options (skb) &&			/* valid options */
+/* also resets options of a recycled receive buffer */
+	if (get_pgm_options (skb) &&			/* there are options */
 	    sock->use_pgmcc &&				/* PGMCC is enabled */
 	    NULL != skb->pgm_opt_pgmcc_data &&		/* PGMCC options */
 	    0 == source->ack_rb_expiry)			/* not partaking in a current election */
@@ -2180,24 +3621,71 @@ pgm_on_data (
 		ack_rb_expiry = skb->tstamp + ack_rb_ivl (sock);
 	}
 
-	const int add_status = pgm_rxw_add (source->window, skb, skb->tstamp, nak_rb_expiry);
+/* coalesced messages and compressed APDUs are copied out of the window without the packet header */
+	if ((skb->is_batch || NULL != skb->pgm_opt_compress) && skb->csum_deferred &&
+	    PGM_UNLIKELY(!pgm_verify_checksum (skb)))
+	{
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded ODATA with checksum mismatch."));
+		pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_CKSUM_ERRORS);
+		return FALSE;
+	}
+
+/* sliding window repairs code preceding original data rather than occupy a sequence number */
+	if (PGM_RDATA == skb->pgm_header->pgm_type && opt_total_length > 0)
+	{
+		const struct pgm_opt_sw_repair* opt_sw_repair = pgm_opt_body (skb, pgm_opt_desc_const (skb)->opt_sw_repair);
+		if (NULL != opt_sw_repair)
+			return on_sw_repair (sock, source, skb, opt_sw_repair, nak_rb_expiry);
+	}
+
+/* resume after restart, or late join catch-up, of the sequences preceding the first original data */
+	if (PGM_UNLIKELY(!source->window->is_defined) && source->is_restarted &&
+	    !(skb->pgm_header->pgm_options & PGM_OPT_PARITY))
+	{
+		restart_define (sock, source, pgm_ntohl (skb->pgm_data->data_sqn) - 1,
+				skb->wire_tstamp, skb->tstamp);
+	}
+	else if (PGM_UNLIKELY(!source->window->is_defined) && sock->catchup_sqns &&
+	    !(skb->pgm_header->pgm_options & PGM_OPT_PARITY))
+	{
+		catchup_define (sock, source, pgm_ntohl (skb->pgm_data->data_trail), pgm_ntohl (skb->pgm_data->data_sqn) - 1,
+				skb->wire_tstamp, skb->tstamp);
+	}
+
+/* the receive window takes ownership of skb */
+	if (NULL != source->dlr_history &&
+	    !(skb->pgm_header->pgm_options & PGM_OPT_PARITY))
+	{
+		dlr_retain (sock, source, skb);
+	}
+
+	const bool is_rdata = (PGM_RDATA == skb->pgm_header->pgm_type);
+	const uint32_t data_sqn = pgm_ntohl (skb->pgm_data->data_sqn);
+	PGM_PROFILE_BEGIN (add_start);
+	const int add_status = pgm_rxw_add (source->window, skb, skb->wire_tstamp, nak_rb_expiry);
+	PGM_PROFILE_END (PGM_PROFILE_RXW_ADD, add_start, 1);
 
 /* skb reference is now invalid */
 	switch (add_status) {
+	case PGM_RXW_INSERTED:
+		if (is_rdata)
+			pgm_evtrace (PGM_EV_RDATA_RECEIVED, &source->tsi, data_sqn, 0);
+		msg_count++;
+		break;
+
 	case PGM_RXW_MISSING:
 		flush_naks = TRUE;
 /* fall through */
-	case PGM_RXW_INSERTED:
 	case PGM_RXW_APPENDED:
 		msg_count++;
 		break;
 
 	case PGM_RXW_DUPLICATE:
-		source->cumulative_stats[PGM_PC_RECEIVER_DUP_DATAS]++;
+		pgm_stats_inc (&source->cumulative_stats, PGM_PC_RECEIVER_DUP_DATAS);
 		goto discarded;
 
 	case PGM_RXW_MALFORMED:
-		source->cumulative_stats[PGM_PC_RECEIVER_MALFORMED_ODATA]++;
+		pgm_stats_inc (&source->cumulative_stats, PGM_PC_RECEIVER_MALFORMED_ODATA);
 /* fall through */
 	case PGM_RXW_BOUNDS:
 discarded:
@@ -2207,9 +3695,26 @@ discarded:
 	}
 
 /* valid data */
+	if (sock->peer_idle_ivl)
+		source->idle_expiry = skb->tstamp + (PGM_UNLIKELY(pgm_budget_is_exceeded (&sock->budget)) ?
+						     sock->peer_idle_ivl / PGM_BUDGET_IDLE_DIVISOR : sock->peer_idle_ivl);
+	if (sock->ack_trail_req.at_ivl && 0 == source->ack_trail_expiry) {
+		source->ack_trail_expiry = skb->tstamp + sock->ack_trail_req.at_ivl;
+		pgm_timer_lock (sock);
+		if (pgm_time_after (sock->next_poll, source->ack_trail_expiry))
+			sock->next_poll = source->ack_trail_expiry;
+		pgm_timer_unlock (sock);
+	}
+	if (sock->credit_req.cr_ivl && 0 == source->credit_expiry) {
+		source->credit_expiry = skb->tstamp + sock->credit_req.cr_ivl;
+		pgm_timer_lock (sock);
+		if (pgm_time_after (sock->next_poll, source->credit_expiry))
+			sock->next_poll = source->credit_expiry;
+		pgm_timer_unlock (sock);
+	}
 	PGM_HISTOGRAM_COUNTS("Rx.DataBytesReceived", tsdu_length);
-	source->cumulative_stats[PGM_PC_RECEIVER_DATA_BYTES_RECEIVED] += tsdu_length;
-	source->cumulative_stats[PGM_PC_RECEIVER_DATA_MSGS_RECEIVED]  += msg_count;
+	pgm_stats_add (&source->cumulative_stats, PGM_PC_RECEIVER_DATA_BYTES_RECEIVED, tsdu_length);
+	pgm_stats_add (&source->cumulative_stats, PGM_PC_RECEIVER_DATA_MSGS_RECEIVED, msg_count);
 
 /* congestion control */
 	if (0 != ack_rb_expiry)
@@ -2259,6 +3764,80 @@ discarded:
 	return TRUE;
 }
 
+/* as designated local repairer advertise our unicast NLA to the local subnet for every
+ * source with a defined window as a DLR sub-type POLL.
+ *
+ * on success, TRUE is returned, returns FALSE if operation would block.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_send_dlr_poll (
+	pgm_sock_t* const	sock,
+	const pgm_time_t	now
+	)
+{
+	size_t		   tpdu_length;
+	char		  *buf;
+	struct pgm_header *header;
+	struct pgm_poll	  *poll4;
+	struct pgm_poll6  *poll6;
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (sock->dlr_sqns > 0);
+
+	pgm_debug ("pgm_send_dlr_poll (sock:%p now:%" PGM_TIME_FORMAT ")",
+		(const void*)sock, now);
+
+	tpdu_length = sizeof(struct pgm_header) + sizeof(struct pgm_poll);
+	if (AF_INET6 == sock->send_addr.ss_family)
+		tpdu_length += sizeof(struct pgm_poll6) - sizeof(struct pgm_poll);
+	buf = pgm_alloca (tpdu_length);
+	memset (buf, 0, tpdu_length);
+	header = (struct pgm_header*)buf;
+	poll4  = (struct pgm_poll *)(header + 1);
+	poll6  = (struct pgm_poll6*)(header + 1);
+
+	for (pgm_list_t* it = sock->peers_list; NULL != it; it = it->next)
+	{
+		const pgm_peer_t* peer = it->data;
+		if (!peer->window->is_defined)
+			continue;
+
+		memcpy (header->pgm_gsi, &peer->tsi.gsi, sizeof(pgm_gsi_t));
+		header->pgm_sport	= peer->tsi.sport;
+		header->pgm_dport	= sock->dport;
+		header->pgm_type	= PGM_POLL;
+
+		poll4->poll_sqn		= pgm_htonl (sock->dlr_poll_sqn++);
+		poll4->poll_s_type	= pgm_htons (PGM_POLL_DLR);
+		pgm_sockaddr_to_nla ((struct sockaddr*)&sock->send_addr, (char*)&poll4->poll_nla_afi);
+		if (AF_INET6 == sock->send_addr.ss_family)
+			poll6->poll6_bo_ivl = pgm_htonl ((uint32_t)(PGM_DLR_LIFETIME_IVLS * sock->dlr_ivl));
+		else
+			poll4->poll_bo_ivl  = pgm_htonl ((uint32_t)(PGM_DLR_LIFETIME_IVLS * sock->dlr_ivl));
+
+		header->pgm_checksum	= 0;
+		header->pgm_checksum	= pgm_csum_fold (pgm_csum_partial (buf, (uint16_t)tpdu_length, 0));
+
+		const ssize_t sent = pgm_sendto_hops (sock,
+						      FALSE,			/* not rate limited */
+						      NULL,
+						      TRUE,			/* with router alert */
+						      1,			/* local subnet */
+						      header,
+						      tpdu_length,
+						      (struct sockaddr*)&sock->send_gsr.gsr_group,
+						      pgm_sockaddr_len((struct sockaddr*)&sock->send_gsr.gsr_group));
+		if (sent < 0 && PGM_LIKELY(PGM_SOCK_EAGAIN == pgm_get_last_sock_error()))
+			return FALSE;
+	}
+
+	sock->next_dlr_poll = now + sock->dlr_ivl;
+	return TRUE;
+}
+
 /* POLLs are generated by PGM Parents (Sources or Network Elements).
  *
  * returns TRUE on valid packet, FALSE on invalid packet.
@@ -2298,6 +3877,10 @@ pgm_on_poll (
 		pgm_ntohl (poll6->poll6_mask) :
 		pgm_ntohl (poll4->poll_mask);
 
+/* designated local repairer advertisements are outside of any poll round */
+	if (PGM_POLL_DLR == pgm_ntohs (poll4->poll_s_type))
+		return on_dlr_poll (sock, source, skb);
+
 /* Check for probability match */
 	if (poll_mask &&
 	    (sock->rand_node_id & poll_mask) != poll_rand)
@@ -2330,9 +3913,6 @@ pgm_on_poll (
 	case PGM_POLL_GENERAL:
 		return on_general_poll (sock, source, skb);
 
-	case PGM_POLL_DLR:
-		return on_dlr_poll (sock, source, skb);
-
 	default:
 /* unknown sub-type, discard */
 		break;
@@ -2367,18 +3947,48 @@ on_general_poll (
 	return TRUE;
 }
 
-/* Used to count off-tree DLRs */
+/* Designated local repairer advertisement, the poll NLA is the unicast address of the
+ * DLR and the back-off interval the lifetime of the advertisement.  selective NAKs
+ * for this source are redirected to the DLR until the advertisement lapses.
+ */
 
 static
 bool
 on_dlr_poll (
-	PGM_GNUC_UNUSED pgm_sock_t*	      const restrict sock,
-	PGM_GNUC_UNUSED pgm_peer_t*	      const restrict source,
-	PGM_GNUC_UNUSED struct pgm_sk_buff_t* const restrict skb
+	pgm_sock_t*	      const restrict sock,
+	pgm_peer_t*	      const restrict source,
+	struct pgm_sk_buff_t* const restrict skb
 	)
 {
-/* we are not a DLR */
-	return FALSE;
+	struct pgm_poll*  poll4 = (struct pgm_poll *)skb->data;
+	struct pgm_poll6* poll6 = (struct pgm_poll6*)skb->data;
+	struct sockaddr_storage dlr_nla;
+
+	pgm_nla_to_sockaddr (&poll4->poll_nla_afi, (struct sockaddr*)&dlr_nla);
+
+/* our own advertisement, or we repair ourselves */
+	if (PGM_UNLIKELY(NULL != source->dlr_history ||
+			 pgm_sockaddr_cmp ((struct sockaddr*)&dlr_nla, (struct sockaddr*)&sock->send_addr) == 0))
+	{
+		return FALSE;
+	}
+
+	const uint32_t poll_bo_ivl = (AFI_IP6 == pgm_ntohs (poll4->poll_nla_afi)) ?
+		pgm_ntohl (poll6->poll6_bo_ivl) :
+		pgm_ntohl (poll4->poll_bo_ivl);
+	if (PGM_UNLIKELY(0 == poll_bo_ivl))
+		return FALSE;
+
+	if (0 == source->redirect_expiry ||
+	    pgm_sockaddr_cmp ((struct sockaddr*)&dlr_nla, (struct sockaddr*)&source->redirect_nla) != 0)
+	{
+		pgm_trace (PGM_LOG_ROLE_SESSION,_("Designated local repairer advertised for tsi %s"), pgm_tsi_print (&source->tsi));
+	}
+	memcpy (&source->redirect_nla, &dlr_nla, sizeof(struct sockaddr_storage));
+/* port at same location for sin/sin6 */
+	((struct sockaddr_in*)&source->redirect_nla)->sin_port = pgm_htons (sock->udp_encap_ucast_port);
+	source->redirect_expiry = skb->tstamp + poll_bo_ivl;
+	return TRUE;
 }
 
 /* eof */
@@ -56,19 +56,31 @@
 #define pgm_verify_nak		mock_pgm_verify_nak
 #define pgm_verify_ncf		mock_pgm_verify_ncf
 #define pgm_verify_poll		mock_pgm_verify_poll
+#define pgm_verify_checksum	mock_pgm_verify_checksum
 #define pgm_sendto_hops		mock_pgm_sendto_hops
 #define pgm_time_now		mock_pgm_time_now
 #define pgm_time_update_now	mock_pgm_time_update_now
 #define pgm_rxw_destroy		mock_pgm_rxw_destroy
 #define pgm_rxw_create		mock_pgm_rxw_create
 #define pgm_rxw_update		mock_pgm_rxw_update
+#define pgm_rxw_catchup		mock_pgm_rxw_catchup
+#define pgm_restart_claim	mock_pgm_restart_claim
+#define pgm_restart_save	mock_pgm_restart_save
+#define pgm_restart_release	mock_pgm_restart_release
+#define pgm_local_publish	mock_pgm_local_publish
+#define pgm_local_publish_loss	mock_pgm_local_publish_loss
 #define pgm_rxw_update_fec	mock_pgm_rxw_update_fec
+#define pgm_rxw_update_sw	mock_pgm_rxw_update_sw
+#define pgm_rxw_compact		mock_pgm_rxw_compact
 #define pgm_rxw_confirm		mock_pgm_rxw_confirm
 #define pgm_rxw_lost		mock_pgm_rxw_lost
+#define pgm_rxw_is_duplicate	mock_pgm_rxw_is_duplicate
 #define pgm_rxw_state		mock_pgm_rxw_state
 #define pgm_rxw_add		mock_pgm_rxw_add
+#define pgm_rxw_add_repair	mock_pgm_rxw_add_repair
 #define pgm_rxw_remove_commit	mock_pgm_rxw_remove_commit
 #define pgm_rxw_readv		mock_pgm_rxw_readv
+#define pgm_rxw_next_tstamp	mock_pgm_rxw_next_tstamp
 #define pgm_csum_fold		mock_pgm_csum_fold
 #define pgm_compat_csum_partial	mock_pgm_compat_csum_partial
 #define pgm_histogram_init	mock_pgm_histogram_init
@@ -121,7 +133,8 @@ static
 gboolean
 mock_pgm_on_nak (
 	pgm_sock_t* const		sock,
-	struct pgm_sk_buff_t* const	skb
+	struct pgm_sk_buff_t* const	skb,
+	const struct sockaddr* const	src_addr
 	)
 {
 	return TRUE;
@@ -210,6 +223,15 @@ mock_pgm_verify_poll (
 	return TRUE;
 }
 
+bool
+mock_pgm_verify_checksum (
+	struct pgm_sk_buff_t* const		skb
+	)
+{
+	skb->csum_deferred = 0;
+	return TRUE;
+}
+
 /* receive window module */
 pgm_rxw_t*
 mock_pgm_rxw_create (
@@ -218,7 +240,8 @@ mock_pgm_rxw_create (
 	const unsigned		sqns,
 	const unsigned		secs,
 	const ssize_t		max_rte,
-	const uint32_t		ack_c_p
+	const uint32_t		ack_c_p,
+	const pgm_mem_policy_t*const policy
 	)
 {
 	return g_malloc0 (sizeof(pgm_rxw_t));
@@ -253,6 +276,15 @@ mock_pgm_rxw_lost (
 {
 }
 
+bool
+mock_pgm_rxw_is_duplicate (
+	const pgm_rxw_t* const	window,
+	const uint32_t		sequence
+	)
+{
+	return FALSE;
+}
+
 void
 mock_pgm_rxw_state (
 	pgm_rxw_t* const		window,
@@ -274,6 +306,65 @@ mock_pgm_rxw_update (
 	return 0;
 }
 
+unsigned
+mock_pgm_rxw_catchup (
+	pgm_rxw_t* const		window,
+	const uint32_t			first,
+	const uint32_t			lead,
+	const pgm_time_t		now,
+	const pgm_time_t		nak_rb_expiry
+	)
+{
+	return 0;
+}
+
+/** warm restart module */
+struct pgm_restart_slot_t*
+mock_pgm_restart_claim (
+	struct pgm_restart_t* const	restart,
+	const pgm_tsi_t* const		tsi,
+	const uint16_t			dport,
+	struct pgm_restart_state_t*	state
+	)
+{
+	memset (state, 0, sizeof (struct pgm_restart_state_t));
+	return NULL;
+}
+
+void
+mock_pgm_restart_save (
+	struct pgm_restart_slot_t* const	slot,
+	const struct pgm_restart_state_t* const	state
+	)
+{
+}
+
+void
+mock_pgm_restart_release (
+	struct pgm_restart_t* const	restart,
+	struct pgm_restart_slot_t* const slot
+	)
+{
+}
+
+/** local fan-out module */
+void
+mock_pgm_local_publish (
+	pgm_local_t* const		local,
+	const struct pgm_msgv_t*	msgv,
+	const struct pgm_msgv_t* const	msgv_end
+	)
+{
+}
+
+void
+mock_pgm_local_publish_loss (
+	pgm_local_t* const		local,
+	const pgm_tsi_t* const		tsi
+	)
+{
+}
+
 void
 mock_pgm_rxw_update_fec (
 	pgm_rxw_t* const		window,
@@ -282,6 +373,21 @@ mock_pgm_rxw_update_fec (
 {
 }
 
+void
+mock_pgm_rxw_update_sw (
+	pgm_rxw_t* const		window,
+	const uint8_t			sw_window
+	)
+{
+}
+
+void
+mock_pgm_rxw_compact (
+	pgm_rxw_t* const		window
+	)
+{
+}
+
 int
 mock_pgm_rxw_add (
 	pgm_rxw_t* const		window,
@@ -293,6 +399,19 @@ mock_pgm_rxw_add (
 	return PGM_RXW_APPENDED;
 }
 
+int
+mock_pgm_rxw_add_repair (
+	pgm_rxw_t* const		window,
+	struct pgm_sk_buff_t* const	skb,
+	const uint8_t			count,
+	const uint16_t			key,
+	const pgm_time_t		now,
+	const pgm_time_t		nak_rb_expiry
+	)
+{
+	return PGM_RXW_DUPLICATE;
+}
+
 void
 mock_pgm_rxw_remove_commit (
 	pgm_rxw_t* const		window
@@ -310,6 +429,14 @@ mock_pgm_rxw_readv (
 	return 0;
 }
 
+pgm_time_t
+mock_pgm_rxw_next_tstamp (
+	const pgm_rxw_t* const		window
+	)
+{
+	return 0;
+}
+
 /* checksum module */
 uint16_t
 mock_pgm_csum_fold (
@@ -339,7 +466,7 @@ mock_pgm_histogram_init (
 void
 mock_pgm_histogram_add (
 	pgm_histogram_t*	histogram,
-	int			value
+	uint64_t		value
 	)
 {
 }
@@ -423,6 +550,34 @@ START_TEST (test_check_peer_state_pass_001)
 }
 END_TEST
 
+/* expired peer is only released after monitoring readers leave */
+START_TEST (test_check_peer_state_pass_002)
+{
+	pgm_sock_t* sock = generate_sock();
+	sock->is_bound = TRUE;
+	sock->peers_hashtable = pgm_peertable_new ();
+	pgm_peer_t* peer = generate_peer();
+	peer->expiry = mock_pgm_time_now;
+	pgm_peertable_insert (sock->peers_hashtable, &peer->tsi, peer);
+	peer->peers_link.data = peer;
+	sock->peers_list = &peer->peers_link;
+	peer_heap_insert (sock, peer);
+	const uint32_t epoch = pgm_peers_read_lock (sock);
+	fail_unless (sock->peers_list->data == peer, "peers_list failed");
+	pgm_check_peer_state (sock, mock_pgm_time_now);
+	fail_unless (NULL == sock->peers_list, "peer not unlinked");
+	fail_unless (NULL == pgm_peertable_lookup (sock->peers_hashtable, &peer->tsi), "peer not removed");
+	fail_unless (NULL != sock->peers_retired, "peer released");
+	for (unsigned i = 0; i < 4; i++)
+		pgm_check_peer_state (sock, mock_pgm_time_now);
+	fail_unless (NULL != sock->peers_retired, "peer released with reader in section");
+	pgm_peers_read_unlock (sock, epoch);
+	for (unsigned i = 0; i < 2; i++)
+		pgm_check_peer_state (sock, mock_pgm_time_now);
+	fail_unless (NULL == sock->peers_retired, "peer not released");
+}
+END_TEST
+
 START_TEST (test_check_peer_state_fail_001)
 {
 	pgm_check_peer_state (NULL, mock_pgm_time_now);
@@ -447,6 +602,33 @@ START_TEST (test_min_receiver_expiry_pass_001)
 }
 END_TEST
 
+/* earliest peer timer from the heap */
+START_TEST (test_min_receiver_expiry_pass_002)
+{
+	pgm_sock_t* sock = generate_sock();
+	sock->is_bound = TRUE;
+	pgm_peer_t peer[3];
+	pgm_rxw_t window[3];
+	memset (peer, 0, sizeof(peer));
+	memset (window, 0, sizeof(window));
+	for (unsigned i = 0; i < 3; i++) {
+		peer[i].window = &window[i];
+		peer[i].expiry = pgm_secs(10);
+	}
+	peer[1].spmr_expiry = pgm_secs(2);
+	for (unsigned i = 0; i < 3; i++)
+		peer_heap_insert (sock, &peer[i]);
+	fail_unless (pgm_secs(2) == pgm_min_receiver_expiry (sock, pgm_secs(5)), "min_receiver_expiry failed");
+/* lowered key on a later state change */
+	peer[2].expiry = pgm_secs(1);
+	pgm_peer_update_expiry (sock, &peer[2]);
+	fail_unless (pgm_secs(1) == pgm_min_receiver_expiry (sock, pgm_secs(5)), "min_receiver_expiry failed");
+	peer_heap_remove (sock, &peer[2]);
+	fail_unless (pgm_secs(2) == pgm_min_receiver_expiry (sock, pgm_secs(5)), "min_receiver_expiry failed");
+	fail_unless (2 == sock->peers_heap_len, "peers_heap_len failed");
+}
+END_TEST
+
 START_TEST (test_min_receiver_expiry_fail_001)
 {
 	const pgm_time_t expiration = pgm_secs(1);
@@ -801,6 +983,70 @@ START_TEST (test_set_nak_ncf_retries_fail_001)
 }
 END_TEST
 
+/* target:
+ *	bool
+ *	pgm_on_poll (
+ *		pgm_sock_t*		sock,
+ *		pgm_peer_t*		source,
+ *		struct pgm_sk_buff_t*	skb
+ *		)
+ */
+
+static
+struct pgm_sk_buff_t*
+generate_dlr_poll (
+	const uint32_t		dlr_addr,
+	const uint32_t		lifetime
+	)
+{
+	struct pgm_sk_buff_t* skb = pgm_alloc_skb (TEST_MAX_TPDU);
+	struct pgm_poll* poll4 = pgm_skb_put (skb, sizeof(struct pgm_poll));
+	memset (poll4, 0, sizeof(struct pgm_poll));
+	poll4->poll_s_type	= htons (PGM_POLL_DLR);
+	poll4->poll_nla_afi	= htons (AFI_IP);
+	poll4->poll_nla.s_addr	= htonl (dlr_addr);
+	poll4->poll_bo_ivl	= htonl (lifetime);
+	skb->tstamp = 1000;
+	return skb;
+}
+
+/* advertisement redirects selective NAKs */
+START_TEST (test_on_poll_dlr_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	pgm_peer_t* peer = generate_peer ();
+	struct pgm_sk_buff_t* skb = generate_dlr_poll (0x0a000002, pgm_secs(3));
+	sock->udp_encap_ucast_port = TEST_PORT;
+	fail_unless (TRUE == pgm_on_poll (sock, peer, skb), "on_poll failed");
+	fail_unless (1000 + pgm_secs(3) == peer->redirect_expiry, "redirect expiry not set");
+	fail_unless (nak_nla (peer) == (const struct sockaddr*)&peer->redirect_nla, "NAKs not redirected");
+	fail_unless (TEST_PORT == ntohs (((struct sockaddr_in*)&peer->redirect_nla)->sin_port), "port not set");
+}
+END_TEST
+
+/* own advertisement is ignored */
+START_TEST (test_on_poll_dlr_pass_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	pgm_peer_t* peer = generate_peer ();
+	struct pgm_sk_buff_t* skb = generate_dlr_poll (0x0a000001, pgm_secs(3));
+	struct sockaddr_in* send_addr = (struct sockaddr_in*)&sock->send_addr;
+	send_addr->sin_family = AF_INET;
+	send_addr->sin_addr.s_addr = htonl (0x0a000001);
+	fail_unless (FALSE == pgm_on_poll (sock, peer, skb), "on_poll failed");
+	fail_unless (0 == peer->redirect_expiry, "redirect expiry set");
+	fail_unless (nak_nla (peer) == (const struct sockaddr*)&peer->nla, "NAKs redirected");
+}
+END_TEST
+
+START_TEST (test_on_poll_fail_001)
+{
+	struct pgm_sk_buff_t* skb = generate_dlr_poll (0x0a000002, pgm_secs(3));
+	pgm_on_poll (NULL, NULL, skb);
+	fail ("reached");
+}
+END_TEST
+
 
 static
 Suite*
@@ -823,6 +1069,7 @@ make_test_suite (void)
 	suite_add_tcase (s, tc_check_peer_state);
 	tcase_add_checked_fixture (tc_check_peer_state, mock_setup, NULL);
 	tcase_add_test (tc_check_peer_state, test_check_peer_state_pass_001);
+	tcase_add_test (tc_check_peer_state, test_check_peer_state_pass_002);
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_check_peer_state, test_check_peer_state_fail_001, SIGABRT);
 #endif
@@ -832,6 +1079,7 @@ make_test_suite (void)
 	suite_add_tcase (s, tc_min_receiver_expiry);
 	tcase_add_checked_fixture (tc_min_receiver_expiry, mock_setup, NULL);
 	tcase_add_test (tc_min_receiver_expiry, test_min_receiver_expiry_pass_001);
+	tcase_add_test (tc_min_receiver_expiry, test_min_receiver_expiry_pass_002);
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_min_receiver_expiry, test_min_receiver_expiry_fail_001, SIGABRT);
 #endif
@@ -895,6 +1143,15 @@ make_test_suite (void)
 	tcase_add_checked_fixture (tc_set_nak_ncf_retries, mock_setup, NULL);
 	tcase_add_test (tc_set_nak_ncf_retries, test_set_nak_ncf_retries_pass_001);
 	tcase_add_test (tc_set_nak_ncf_retries, test_set_nak_ncf_retries_fail_001);
+
+	TCase* tc_on_poll = tcase_create ("on-poll");
+	suite_add_tcase (s, tc_on_poll);
+	tcase_add_checked_fixture (tc_on_poll, mock_setup, NULL);
+	tcase_add_test (tc_on_poll, test_on_poll_dlr_pass_001);
+	tcase_add_test (tc_on_poll, test_on_poll_dlr_pass_002);
+#ifndef PGM_CHECK_NOFORK
+	tcase_add_test_raise_signal (tc_on_poll, test_on_poll_fail_001, SIGABRT);
+#endif
 	return s;
 }
 
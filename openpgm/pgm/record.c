@@ -0,0 +1,504 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * Recorder of delivered APDUs: each message is appended with a header to
+ * large aligned buffers written to segmented log files, O_DIRECT where the
+ * file system allows, submitted through io_uring without waiting where
+ * available.  An index file per segment locates records by TSI, sequence
+ * number and time.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <errno.h>
+#include <stdio.h>
+#ifndef _WIN32
+#	include <fcntl.h>
+#	include <unistd.h>
+#endif
+#include <impl/i18n.h>
+#include <impl/framework.h>
+#include <impl/packet_parse.h>
+
+
+//#define RECORD_DEBUG
+
+#ifndef RECORD_DEBUG
+#	define PGM_DISABLE_ASSERT
+#endif
+
+#define RECORD_BUFFER_LEN	(1024*1024)	/* bytes per log write */
+#define RECORD_BUFFERS		4		/* one filling, the others in flight */
+#define RECORD_ALIGN		4096		/* O_DIRECT memory, offset and length */
+#define RECORD_PAD(x)		(((x) + 7) & ~(size_t)7)
+
+#ifndef O_DIRECT
+#	define O_DIRECT		0
+#endif
+
+/* log bytes and the index entries of records starting within them, a record
+ * is at least as long as its index entry so the index always fits a buffer of
+ * the same size.
+ */
+
+struct record_buffer_t {
+	char*			data;
+	char*			index;
+	size_t			len;
+	size_t			index_len;
+	unsigned		in_flight;	/* writes submitted, not completed */
+	struct pgm_iovec	iov[2];		/* data and index of in flight writes */
+};
+
+struct pgm_recorder_t {
+	char			path[PGM_RECORD_PATH_MAX];
+	uint64_t		segment_size;
+	unsigned		segment;
+	int			fd;		/* log segment, -1 = closed */
+	int			index_fd;
+	bool			is_direct;
+	uint64_t		offset;		/* log segment offset of the active buffer */
+	uint64_t		index_offset;
+	struct record_buffer_t	buffer[RECORD_BUFFERS];
+	unsigned		active;
+	int			error;		/* of the write that stopped recording */
+#ifdef HAVE_LINUX_IO_URING_H
+	struct pgm_write_uring_t* uring;	/* NULL = synchronous writes */
+#endif
+};
+
+#ifndef _WIN32
+
+/* positioned write of the whole buffer.
+ *
+ * returns 0 on success, or errno on failure.
+ */
+
+static
+int
+record_write (
+	const int		fd,
+	const char*		buf,
+	size_t			len,
+	uint64_t		offset
+	)
+{
+	while (len > 0) {
+		const ssize_t bytes_written = pwrite (fd, buf, len, (off_t)offset);
+		if (bytes_written < 0) {
+			if (EINTR == errno)
+				continue;
+			return errno;
+		}
+		buf    += bytes_written;
+		len    -= (size_t)bytes_written;
+		offset += (uint64_t)bytes_written;
+	}
+	return 0;
+}
+
+/* stop recording on the first failed write, reported once.
+ */
+
+static
+void
+record_fail (
+	struct pgm_recorder_t* const	recorder,
+	const int			save_errno
+	)
+{
+	char errbuf[1024];
+
+	if (0 != recorder->error)
+		return;
+	recorder->error = save_errno;
+	pgm_warn (_("Recording to %s stopped: %s"),
+		  recorder->path,
+		  pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+}
+
+/* release buffers of completed writes, with is_wait blocking for at least one.
+ *
+ * returns TRUE if any write completed.
+ */
+
+static
+bool
+record_reap (
+	struct pgm_recorder_t* const	recorder,
+	const bool			is_wait
+	)
+{
+#ifdef HAVE_LINUX_IO_URING_H
+	bool is_reaped = FALSE;
+	uint64_t user_data;
+	int res;
+
+	if (NULL == recorder->uring)
+		return FALSE;
+	while (pgm_write_uring_reap (recorder->uring, is_wait && !is_reaped, &user_data, &res))
+	{
+		is_reaped = TRUE;
+		struct record_buffer_t* buffer = &recorder->buffer[ user_data >> 1 ];
+		const size_t len = buffer->iov[ user_data & 1 ].iov_len;
+		buffer->in_flight--;
+		if (res < 0)
+			record_fail (recorder, -res);
+		else if ((size_t)res != len)
+			record_fail (recorder, ENOSPC);
+	}
+	return is_reaped;
+#else
+	(void)recorder;
+	(void)is_wait;
+	return FALSE;
+#endif
+}
+
+/* write the full active buffer at the end of the segment and continue in
+ * the next, waiting for the writes of that buffer to complete first.
+ */
+
+static
+void
+record_flush (
+	struct pgm_recorder_t* const	recorder
+	)
+{
+	struct record_buffer_t* buffer = &recorder->buffer[ recorder->active ];
+
+	pgm_assert (RECORD_BUFFER_LEN == buffer->len);
+
+	buffer->iov[0].iov_base = buffer->data;
+	buffer->iov[0].iov_len  = buffer->len;
+	buffer->iov[1].iov_base = buffer->index;
+	buffer->iov[1].iov_len  = buffer->index_len;
+#ifdef HAVE_LINUX_IO_URING_H
+	if (NULL != recorder->uring)
+	{
+		const uint64_t user_data = (uint64_t)recorder->active << 1;
+		if (!pgm_write_uring_writev (recorder->uring, recorder->fd, &buffer->iov[0], 1, recorder->offset, user_data))
+			record_fail (recorder, errno);
+		else
+			buffer->in_flight++;
+		if (buffer->index_len) {
+			if (!pgm_write_uring_writev (recorder->uring, recorder->index_fd, &buffer->iov[1], 1, recorder->index_offset, user_data | 1))
+				record_fail (recorder, errno);
+			else
+				buffer->in_flight++;
+		}
+	}
+	else
+#endif
+	{
+		int save_errno = record_write (recorder->fd, buffer->data, buffer->len, recorder->offset);
+		if (0 == save_errno)
+			save_errno = record_write (recorder->index_fd, buffer->index, buffer->index_len, recorder->index_offset);
+		if (0 != save_errno)
+			record_fail (recorder, save_errno);
+	}
+	recorder->offset	+= buffer->len;
+	recorder->index_offset	+= buffer->index_len;
+
+	recorder->active = (recorder->active + 1) % RECORD_BUFFERS;
+	buffer = &recorder->buffer[ recorder->active ];
+	while (buffer->in_flight && record_reap (recorder, TRUE));
+	buffer->len = buffer->index_len = 0;
+}
+
+/* append len bytes of src to the log, or zeros for NULL.
+ */
+
+static
+void
+record_copy (
+	struct pgm_recorder_t* const restrict	recorder,
+	const char*			 restrict	src,
+	size_t					len
+	)
+{
+	while (len > 0 && 0 == recorder->error)
+	{
+		struct record_buffer_t* buffer = &recorder->buffer[ recorder->active ];
+		const size_t copy_len = MIN(len, RECORD_BUFFER_LEN - buffer->len);
+		if (src) {
+			memcpy (buffer->data + buffer->len, src, copy_len);
+			src += copy_len;
+		} else
+			memset (buffer->data + buffer->len, 0, copy_len);
+		buffer->len += copy_len;
+		len -= copy_len;
+		if (RECORD_BUFFER_LEN == buffer->len)
+			record_flush (recorder);
+	}
+}
+
+/* open segment files of the current number, the log with O_DIRECT unless the
+ * file system refuses it.
+ *
+ * returns 0 on success, or errno on failure.
+ */
+
+static
+int
+record_open_segment (
+	struct pgm_recorder_t* const	recorder
+	)
+{
+	char path[PGM_RECORD_PATH_MAX + 16];
+	int save_errno;
+
+	pgm_snprintf_s (path, sizeof (path), _TRUNCATE, "%s.%06u.log", recorder->path, recorder->segment);
+	recorder->is_direct = (0 != O_DIRECT);
+	recorder->fd = open (path, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+	if (-1 == recorder->fd && EINVAL == errno && recorder->is_direct) {
+		pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Direct I/O not supported for %s."), path);
+		recorder->is_direct = FALSE;
+		recorder->fd = open (path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	}
+	if (-1 == recorder->fd)
+		return errno;
+
+	pgm_snprintf_s (path, sizeof (path), _TRUNCATE, "%s.%06u.idx", recorder->path, recorder->segment);
+	recorder->index_fd = open (path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (-1 == recorder->index_fd) {
+		save_errno = errno;
+		close (recorder->fd);
+		recorder->fd = -1;
+		return save_errno;
+	}
+	recorder->offset = recorder->index_offset = 0;
+	return 0;
+}
+
+/* write the partial active buffer once all other writes complete and close
+ * the segment.  the tail is not a multiple of the alignment, so the log is
+ * finished without O_DIRECT.
+ */
+
+static
+void
+record_close_segment (
+	struct pgm_recorder_t* const	recorder
+	)
+{
+	struct record_buffer_t* buffer = &recorder->buffer[ recorder->active ];
+
+	if (-1 == recorder->fd)
+		return;
+	for (unsigned i = 0; i < RECORD_BUFFERS; i++)
+		while (recorder->buffer[i].in_flight && record_reap (recorder, TRUE));
+	if (0 == recorder->error && buffer->len > 0)
+	{
+		int save_errno = 0;
+		if (recorder->is_direct && 0 != (buffer->len % RECORD_ALIGN)) {
+			const int flags = fcntl (recorder->fd, F_GETFL);
+			if (-1 == flags || -1 == fcntl (recorder->fd, F_SETFL, flags & ~O_DIRECT))
+				save_errno = errno;
+		}
+		if (0 == save_errno)
+			save_errno = record_write (recorder->fd, buffer->data, buffer->len, recorder->offset);
+		if (0 == save_errno)
+			save_errno = record_write (recorder->index_fd, buffer->index, buffer->index_len, recorder->index_offset);
+		if (0 != save_errno)
+			record_fail (recorder, save_errno);
+	}
+	buffer->len = buffer->index_len = 0;
+	close (recorder->index_fd);
+	close (recorder->fd);
+	recorder->fd = recorder->index_fd = -1;
+}
+#endif /* _WIN32 */
+
+/* create a recorder writing segments <path>.<n>.log and .idx from n = 0, a
+ * new segment started once a record would take the log beyond segment_size
+ * bytes.
+ *
+ * on success returns the new recorder, on failure returns NULL setting error.
+ */
+
+PGM_GNUC_INTERNAL
+struct pgm_recorder_t*
+pgm_recorder_new (
+	const char*   restrict	path,
+	uint64_t		segment_size,
+	pgm_error_t** restrict	error
+	)
+{
+#ifndef _WIN32
+	struct pgm_recorder_t* recorder;
+	char errbuf[1024];
+	int save_errno;
+
+/* pre-conditions */
+	pgm_assert (NULL != path);
+
+	if (0 == segment_size)
+		segment_size = PGM_RECORD_DEFAULT_SEGMENT;
+	if (segment_size < PGM_RECORD_MIN_SEGMENT)
+		segment_size = PGM_RECORD_MIN_SEGMENT;
+
+	recorder = pgm_new0 (struct pgm_recorder_t, 1);
+	pgm_strncpy_s (recorder->path, sizeof (recorder->path), path, _TRUNCATE);
+	recorder->segment_size = segment_size;
+	save_errno = record_open_segment (recorder);
+	if (0 != save_errno) {
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_RECV,
+			     pgm_error_from_errno (save_errno),
+			     _("Opening record segment %s.%06u: %s"),
+			     path, recorder->segment,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		pgm_free (recorder);
+		return NULL;
+	}
+	for (unsigned i = 0; i < RECORD_BUFFERS; i++) {
+		recorder->buffer[i].data  = pgm_malloc0_aligned (RECORD_BUFFER_LEN, RECORD_ALIGN);
+		recorder->buffer[i].index = pgm_malloc (RECORD_BUFFER_LEN);
+	}
+#ifdef HAVE_LINUX_IO_URING_H
+/* a data and an index write per buffer in flight */
+	recorder->uring = pgm_write_uring_new (2 * RECORD_BUFFERS);
+	if (NULL == recorder->uring) {
+		save_errno = errno;
+		pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("io_uring not available for recording, writes are synchronous: %s"),
+			   pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+	}
+#endif
+	pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Recording to %s in segments of %" PRIu64 " bytes."), path, segment_size);
+	return recorder;
+#else
+	(void)path;
+	(void)segment_size;
+	pgm_set_error (error,
+		     PGM_ERROR_DOMAIN_RECV,
+		     PGM_ERROR_NOSYS,
+		     _("Recording not supported on this platform."));
+	return NULL;
+#endif /* _WIN32 */
+}
+
+/* the partial buffer is written before the files are closed.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_recorder_destroy (
+	struct pgm_recorder_t* const	recorder
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != recorder);
+
+#ifndef _WIN32
+	record_close_segment (recorder);
+#	ifdef HAVE_LINUX_IO_URING_H
+	if (NULL != recorder->uring)
+		pgm_write_uring_destroy (recorder->uring);
+#	endif
+	for (unsigned i = 0; i < RECORD_BUFFERS; i++) {
+		pgm_free_aligned (recorder->buffer[i].data);
+		pgm_free (recorder->buffer[i].index);
+	}
+#endif
+	pgm_free (recorder);
+}
+
+/* append count messages of msgv as delivered, skbuffs are only read.  with
+ * checksums deferred to delivery each APDU is verified first and a corrupt one
+ * is not recorded, the skbuff is left for delivery to discard.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_recorder_append (
+	struct pgm_recorder_t*	  const restrict recorder,
+	const struct pgm_msgv_t* const restrict msgv,
+	const unsigned				 count
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != recorder);
+	pgm_assert (NULL != msgv);
+
+#ifndef _WIN32
+	for (unsigned i = 0; i < count && 0 == recorder->error; i++)
+	{
+		const struct pgm_msgv_t* const msg = &msgv[i];
+		const struct pgm_sk_buff_t* first = msg->msgv_skb[0];
+		struct pgm_record_header_t header;
+		struct pgm_record_index_t entry;
+		size_t apdu_len = 0;
+		bool is_valid = TRUE;
+
+		for (unsigned j = 0; j < msg->msgv_len; j++) {
+			const struct pgm_sk_buff_t* skb = msg->msgv_skb[j];
+			if (skb->csum_deferred && !pgm_verify_checksum_copy (skb, NULL, 0))
+				is_valid = FALSE;
+			apdu_len += skb->len;
+		}
+		if (PGM_UNLIKELY(!is_valid))
+			continue;
+
+		const size_t size = RECORD_PAD(sizeof (header) + apdu_len);
+		struct record_buffer_t* buffer = &recorder->buffer[ recorder->active ];
+		if (recorder->offset + buffer->len > 0 &&
+		    recorder->offset + buffer->len + size > recorder->segment_size)
+		{
+			record_close_segment (recorder);
+			recorder->segment++;
+			const int save_errno = record_open_segment (recorder);
+			if (0 != save_errno) {
+				record_fail (recorder, save_errno);
+				break;
+			}
+			buffer = &recorder->buffer[ recorder->active ];
+		}
+
+		memset (&header, 0, sizeof (header));
+		header.rh_size		= (uint32_t)size;
+		header.rh_len		= (uint32_t)apdu_len;
+		header.rh_sqn		= first->sequence;
+		header.rh_tsi		= first->tsi;
+		header.rh_tstamp	= first->tstamp;
+
+		entry.ri_tsi		= first->tsi;
+		entry.ri_sqn		= first->sequence;
+		entry.ri_len		= (uint32_t)apdu_len;
+		entry.ri_tstamp		= first->tstamp;
+		entry.ri_offset		= recorder->offset + buffer->len;
+		pgm_assert (buffer->index_len + sizeof (entry) <= RECORD_BUFFER_LEN);
+		memcpy (buffer->index + buffer->index_len, &entry, sizeof (entry));
+		buffer->index_len += sizeof (entry);
+
+		record_copy (recorder, (const char*)&header, sizeof (header));
+		for (unsigned j = 0; j < msg->msgv_len; j++)
+			record_copy (recorder, msg->msgv_skb[j]->data, msg->msgv_skb[j]->len);
+		record_copy (recorder, NULL, size - sizeof (header) - apdu_len);
+	}
+/* recycle buffers of completed writes */
+	(void)record_reap (recorder, FALSE);
+#else
+	(void)recorder;
+	(void)msgv;
+	(void)count;
+#endif
+}
+
+/* eof */
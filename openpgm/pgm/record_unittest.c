@@ -0,0 +1,337 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * unit tests for the recorder of delivered APDUs.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <check.h>
+
+#include "impl/framework.h"
+
+#ifdef _WIN32
+#	define PGM_CHECK_NOFORK		1
+#endif
+
+
+/* mock state */
+#define TEST_PATH		"record-unittest"
+
+/* mock functions for external references */
+
+PGM_GNUC_INTERNAL
+bool
+mock_pgm_verify_checksum_copy (
+	const struct pgm_sk_buff_t*const restrict skb,
+	PGM_GNUC_UNUSED void*		restrict dst,
+	PGM_GNUC_UNUSED const uint16_t	len
+	)
+{
+/* mark corrupt APDUs with a leading 0xff */
+	return 0xff != *(const uint8_t*)skb->data;
+}
+
+#define pgm_verify_checksum_copy	mock_pgm_verify_checksum_copy
+
+#define RECORD_DEBUG
+#include "record.c"
+
+static
+const char*
+segment_path (
+	const unsigned	segment,
+	const char*	suffix
+	)
+{
+	static char path[ 1024 ];
+	pgm_snprintf_s (path, sizeof(path), _TRUNCATE, "%s.%06u.%s", TEST_PATH, segment, suffix);
+	return path;
+}
+
+static
+void
+remove_segments (void)
+{
+	for (unsigned i = 0; i < 100; i++) {
+		unlink (segment_path (i, "log"));
+		unlink (segment_path (i, "idx"));
+	}
+}
+
+/* APDU of tag in fragments of at most tpdu bytes */
+static
+unsigned
+generate_msgv (
+	struct pgm_msgv_t*	msgv,
+	const uint32_t		tag,
+	const size_t		len,
+	const size_t		tpdu
+	)
+{
+	size_t offset = 0;
+	unsigned fragments = 0;
+	do {
+		const size_t fragment_len = MIN(tpdu, len - offset);
+		struct pgm_sk_buff_t* skb = pgm_alloc_skb (tpdu);
+		skb->tsi.sport = pgm_htons (1000);
+		skb->sequence = tag + fragments;
+		skb->tstamp = 0x1000 + tag;
+		pgm_skb_put (skb, (uint16_t)fragment_len);
+		memset (skb->data, (int)(tag & 0x7f), fragment_len);
+		msgv->msgv_skb[ fragments++ ] = skb;
+		offset += fragment_len;
+	} while (offset < len);
+	msgv->msgv_len = fragments;
+	return fragments;
+}
+
+static
+void
+free_msgv (
+	struct pgm_msgv_t*	msgv
+	)
+{
+	for (unsigned i = 0; i < msgv->msgv_len; i++)
+		pgm_free_skb (msgv->msgv_skb[i]);
+}
+
+static
+size_t
+apdu_len (
+	const uint32_t	tag
+	)
+{
+	return 1 + (tag * 7919u) % 9000;
+}
+
+/* read back one segment checking records against index, returns record count */
+static
+unsigned
+verify_segment (
+	const unsigned	segment,
+	uint32_t*	next_tag
+	)
+{
+	FILE* log = fopen (segment_path (segment, "log"), "rb");
+	FILE* idx = fopen (segment_path (segment, "idx"), "rb");
+	fail_if (NULL == log, "log segment missing");
+	fail_if (NULL == idx, "index segment missing");
+	struct pgm_record_header_t header;
+	struct pgm_record_index_t entry;
+	char* data = pgm_malloc (16 * 1024);
+	uint64_t offset = 0;
+	unsigned records = 0;
+	while (1 == fread (&header, sizeof(header), 1, log)) {
+		fail_unless (1 == fread (&entry, sizeof(entry), 1, idx), "index short");
+		fail_unless (offset == entry.ri_offset, "index offset");
+		fail_unless (header.rh_sqn == entry.ri_sqn, "index sequence");
+		fail_unless (header.rh_len == entry.ri_len, "index length");
+		fail_unless (0 == (header.rh_size % 8), "record padding");
+		fail_unless (*next_tag == header.rh_sqn, "records not contiguous");
+		fail_unless (apdu_len (header.rh_sqn) == header.rh_len, "APDU length");
+		fail_unless (0x1000 + header.rh_sqn == header.rh_tstamp, "timestamp");
+		fail_unless (pgm_htons (1000) == header.rh_tsi.sport, "TSI");
+		fail_unless (1 == fread (data, header.rh_size - sizeof(header), 1, log), "log short");
+		for (unsigned i = 0; i < header.rh_len; i++)
+			fail_unless ((char)(header.rh_sqn & 0x7f) == data[i], "APDU data");
+		offset += header.rh_size;
+		(*next_tag)++;
+		records++;
+	}
+	fail_unless (0 == fread (&entry, sizeof(entry), 1, idx), "index long");
+	pgm_free (data);
+	fclose (log);
+	fclose (idx);
+	return records;
+}
+
+/* target:
+ *	struct pgm_recorder_t*
+ *	pgm_recorder_new (
+ *		const char*	path,
+ *		uint64_t	segment_size,
+ *		pgm_error_t**	error
+ *	)
+ */
+
+START_TEST (test_new_pass_001)
+{
+	pgm_error_t* err = NULL;
+	struct pgm_recorder_t* recorder = pgm_recorder_new (TEST_PATH, 0, &err);
+	fail_if (NULL == recorder, "new failed");
+	fail_unless (PGM_RECORD_DEFAULT_SEGMENT == recorder->segment_size, "default segment size");
+	pgm_recorder_destroy (recorder);
+	uint32_t next_tag = 0;
+	fail_unless (0 == verify_segment (0, &next_tag), "empty recorder has records");
+	remove_segments ();
+}
+END_TEST
+
+START_TEST (test_new_pass_002)
+{
+	struct pgm_recorder_t* recorder = pgm_recorder_new (TEST_PATH, 1, NULL);
+	fail_if (NULL == recorder, "new failed");
+	fail_unless (PGM_RECORD_MIN_SEGMENT == recorder->segment_size, "minimum segment size");
+	pgm_recorder_destroy (recorder);
+	remove_segments ();
+}
+END_TEST
+
+START_TEST (test_new_fail_001)
+{
+	pgm_error_t* err = NULL;
+	fail_unless (NULL == pgm_recorder_new ("/nonexistent/record", 0, &err), "new succeeded");
+	fail_if (NULL == err, "error not set");
+	pgm_error_free (err);
+}
+END_TEST
+
+/* target:
+ *	void
+ *	pgm_recorder_append (
+ *		struct pgm_recorder_t*		recorder,
+ *		const struct pgm_msgv_t*	msgv,
+ *		const unsigned			count
+ *	)
+ */
+
+/* fragmented APDUs reassemble in the log across buffer boundaries */
+START_TEST (test_append_pass_001)
+{
+	struct pgm_msgv_t msgv[ 4 ];
+	struct pgm_recorder_t* recorder = pgm_recorder_new (TEST_PATH, 0, NULL);
+	fail_if (NULL == recorder, "new failed");
+	for (uint32_t tag = 0; tag < 1000; tag += 4) {
+		for (unsigned i = 0; i < 4; i++)
+			generate_msgv (&msgv[i], tag + i, apdu_len (tag + i), 1400);
+		pgm_recorder_append (recorder, msgv, 4);
+		for (unsigned i = 0; i < 4; i++)
+			free_msgv (&msgv[i]);
+	}
+	pgm_recorder_destroy (recorder);
+	uint32_t next_tag = 0;
+	fail_unless (1000 == verify_segment (0, &next_tag), "record count");
+	remove_segments ();
+}
+END_TEST
+
+/* segments rotate before exceeding their size, each indexed from zero */
+START_TEST (test_append_pass_002)
+{
+	struct pgm_msgv_t msgv;
+	struct pgm_recorder_t* recorder = pgm_recorder_new (TEST_PATH, PGM_RECORD_MIN_SEGMENT, NULL);
+	fail_if (NULL == recorder, "new failed");
+	const uint32_t count = 3000;
+	for (uint32_t tag = 0; tag < count; tag++) {
+		generate_msgv (&msgv, tag, apdu_len (tag), 9000);
+		pgm_recorder_append (recorder, &msgv, 1);
+		free_msgv (&msgv);
+	}
+	pgm_recorder_destroy (recorder);
+	uint32_t next_tag = 0;
+	unsigned segment = 0;
+	while (next_tag < count) {
+		struct stat st;
+		fail_unless (0 == stat (segment_path (segment, "log"), &st), "segment missing");
+		fail_unless ((uint64_t)st.st_size <= PGM_RECORD_MIN_SEGMENT, "segment oversize");
+		verify_segment (segment++, &next_tag);
+	}
+	fail_unless (segment > 1, "segments not rotated");
+	fail_unless (count == next_tag, "record count");
+	remove_segments ();
+}
+END_TEST
+
+/* APDUs failing a deferred checksum are not recorded */
+START_TEST (test_append_pass_003)
+{
+	struct pgm_msgv_t msgv[ 3 ];
+	struct pgm_recorder_t* recorder = pgm_recorder_new (TEST_PATH, 0, NULL);
+	fail_if (NULL == recorder, "new failed");
+	for (unsigned i = 0; i < 3; i++) {
+		generate_msgv (&msgv[i], i, apdu_len (i), 1400);
+		msgv[i].msgv_skb[0]->csum_deferred = 1;
+	}
+	memset (msgv[1].msgv_skb[0]->data, 0xff, 1);
+	pgm_recorder_append (recorder, msgv, 3);
+	for (unsigned i = 0; i < 3; i++)
+		free_msgv (&msgv[i]);
+	pgm_recorder_destroy (recorder);
+	FILE* idx = fopen (segment_path (0, "idx"), "rb");
+	fail_if (NULL == idx, "index segment missing");
+	struct pgm_record_index_t entry;
+	fail_unless (1 == fread (&entry, sizeof(entry), 1, idx), "index short");
+	fail_unless (0 == entry.ri_sqn, "first record");
+	fail_unless (1 == fread (&entry, sizeof(entry), 1, idx), "index short");
+	fail_unless (2 == entry.ri_sqn, "corrupt APDU recorded");
+	fail_unless (0 == fread (&entry, sizeof(entry), 1, idx), "index long");
+	fclose (idx);
+	remove_segments ();
+}
+END_TEST
+
+
+static
+Suite*
+make_test_suite (void)
+{
+	Suite* s;
+
+	s = suite_create (__FILE__);
+
+	TCase* tc_new = tcase_create ("new");
+	suite_add_tcase (s, tc_new);
+	tcase_add_test (tc_new, test_new_pass_001);
+	tcase_add_test (tc_new, test_new_pass_002);
+	tcase_add_test (tc_new, test_new_fail_001);
+
+	TCase* tc_append = tcase_create ("append");
+	suite_add_tcase (s, tc_append);
+	tcase_add_test (tc_append, test_append_pass_001);
+	tcase_add_test (tc_append, test_append_pass_002);
+	tcase_add_test (tc_append, test_append_pass_003);
+	return s;
+}
+
+static
+Suite*
+make_master_suite (void)
+{
+	Suite* s = suite_create ("Master");
+	return s;
+}
+
+int
+main (void)
+{
+	pgm_messages_init();
+	SRunner* sr = srunner_create (make_master_suite ());
+	srunner_add_suite (sr, make_test_suite ());
+	srunner_run_all (sr, CK_ENV);
+	int number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	pgm_messages_shutdown();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof */
@@ -28,16 +28,25 @@
 #endif
 
 #include <errno.h>
+#ifdef HAVE_EPOLL_CTL
+#	include <sys/epoll.h>
+#endif
 #ifndef _WIN32
 #	include <sys/types.h>
 #	include <sys/socket.h>
 #	include <netinet/in.h>		/* _GNU_SOURCE for in6_pktinfo */
+#	include <netinet/udp.h>
 #else
 #	include <ws2tcpip.h>
 #	include <mswsock.h>
 #endif
+#ifdef HAVE_LINUX_NET_TSTAMP_H
+#	include <time.h>
+#	include <linux/errqueue.h>		/* struct scm_timestamping */
+#endif
 #include <impl/i18n.h>
 #include <impl/framework.h>
+#include <impl/net.h>
 #include <impl/source.h>
 #include <impl/packet_parse.h>
 #include <impl/timer.h>
@@ -75,97 +84,134 @@
 #	define pgm_cmsghdr			cmsghdr
 #endif
 
+#ifndef _WIN32
+typedef struct msghdr			pgm_msghdr_t;
+#else
+typedef WSAMSG				pgm_msghdr_t;
+#endif
 
-/* read a packet into a PGM skbuff
- * on success returns packet length, on closed socket returns 0,
- * on error returns -1.
+
+/* kernel receive socket currently read, fan-in sockets are read round-robin.
  */
 
-static
-ssize_t
-recvskb (
-	pgm_sock_t*           const restrict sock,
-	struct pgm_sk_buff_t* const restrict skb,
-	const int			     flags,
-	struct sockaddr*      const restrict src_addr,
-	const socklen_t			     src_addrlen,
-	struct sockaddr*      const restrict dst_addr,
-	const socklen_t			     dst_addrlen
+static inline
+SOCKET
+current_recv_sock (
+	const pgm_sock_t* const	sock
 	)
 {
-/* pre-conditions */
-	pgm_assert (NULL != sock);
-	pgm_assert (NULL != skb);
-	pgm_assert (NULL != src_addr);
-	pgm_assert (src_addrlen > 0);
-	pgm_assert (NULL != dst_addr);
-	pgm_assert (dst_addrlen > 0);
+	return (0 == sock->recv_sock_index) ? sock->recv_sock : sock->recv_sock_extra[sock->recv_sock_index - 1];
+}
 
-	pgm_debug ("recvskb (sock:%p skb:%p flags:%d src-addr:%p src-addrlen:%d dst-addr:%p dst-addrlen:%d)",
-		(void*)sock, (void*)skb, flags, (void*)src_addr, (int)src_addrlen, (void*)dst_addr, (int)dst_addrlen);
+static inline
+void
+next_recv_sock (
+	pgm_sock_t* const	sock
+	)
+{
+	if (++sock->recv_sock_index > sock->recv_sock_extra_len)
+		sock->recv_sock_index = 0;
+}
 
-	if (PGM_UNLIKELY(sock->is_destroyed))
-		return 0;
+/* returns TRUE if PGM_RECV_SHARD assigns the source to this socket.  the TSI hash
+ * is folded as its low bits are independent of the source port, and sessions of
+ * one host share a GSI.
+ */
 
-	struct pgm_iovec iov = {
-		.iov_base	= skb->head,
-		.iov_len	= sock->max_tpdu
-	};
-	char aux[ 1024 ];
-#ifndef _WIN32
-	struct msghdr msg = {
-		.msg_name	= src_addr,
-		.msg_namelen	= src_addrlen,
-		.msg_iov	= (void*)&iov,
-		.msg_iovlen	= 1,
-		.msg_control	= aux,
-		.msg_controllen = sizeof(aux),
-		.msg_flags	= 0
-	};
-	ssize_t len = recvmsg (sock->recv_sock, &msg, flags);
-	if (len <= 0)
-		return len;
-#else /* !_WIN32 */
-	WSAMSG msg = {
-		.name		= (LPSOCKADDR)src_addr,
-		.namelen	= src_addrlen,
-		.lpBuffers	= (LPWSABUF)&iov,
-		.dwBufferCount	= 1,
-		.dwFlags	= 0
-	};
-	msg.Control.buf		= aux;
-	msg.Control.len		= sizeof(aux);
-	DWORD len;
-	if (SOCKET_ERROR == pgm_WSARecvMsg (sock->recv_sock, &msg, &len, NULL, NULL)) {
-		return SOCKET_ERROR;
-	}
-#endif /* !_WIN32 */
+static inline
+bool
+is_source_sharded (
+	const pgm_sock_t* const restrict sock,
+	const pgm_tsi_t*  const restrict tsi
+	)
+{
+	if (PGM_LIKELY(0 == sock->rx_shard_count))
+		return TRUE;
+	const pgm_hash_t hash_value = pgm_tsi_hash (tsi);
+	return sock->rx_shard_index == ((hash_value ^ (hash_value >> 16)) % sock->rx_shard_count);
+}
 
-#ifdef PGM_DEBUG
-	if (PGM_UNLIKELY(pgm_loss_rate > 0)) {
-		const unsigned percent = pgm_rand_int_range (&sock->rand_, 0, 100);
-		if (percent <= pgm_loss_rate) {
-			pgm_debug ("Simulated packet loss");
-			pgm_set_last_sock_error (PGM_SOCK_EAGAIN);
-			return SOCKET_ERROR;
+/* returns TRUE if PGM_SOURCE_FILTER admits the source, the list is sorted such
+ * that a GSI wildcard, sport 0, precedes the sessions of its GSI.
+ */
+
+static
+bool
+is_source_wanted (
+	const pgm_sock_t* const	restrict sock,
+	const pgm_tsi_t*  const	restrict tsi
+	)
+{
+	const struct pgm_source_filter_req_t* sf = &sock->rx_source_filter;
+	pgm_tsi_t key;
+	unsigned lo = 0, hi = sf->sf_len;
+	bool is_listed = FALSE;
+
+	if (PGM_LIKELY(0 == sf->sf_len))
+		return TRUE;
+	memcpy (&key.gsi, &tsi->gsi, sizeof (pgm_gsi_t));
+	key.sport = 0;
+	while (lo < hi) {
+		const unsigned mid = (lo + hi) / 2;
+		if (memcmp (&sf->sf_tsi[mid], &key, sizeof (pgm_tsi_t)) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	for (; lo < sf->sf_len && pgm_gsi_equal (&sf->sf_tsi[lo].gsi, &tsi->gsi); lo++)
+		if (0 == sf->sf_tsi[lo].sport || tsi->sport == sf->sf_tsi[lo].sport) {
+			is_listed = TRUE;
+			break;
 		}
+	return (PGM_SOURCE_DENY == sf->sf_mode) ? !is_listed : is_listed;
+}
+
+/* data-destination port of the socket or added with PGM_JOIN_DPORT, caller holds
+ * sock::receiver_mutex.
+ */
+
+static inline
+bool
+is_rx_dport (
+	const pgm_sock_t* const	sock,
+	const in_port_t		dport
+	)
+{
+	unsigned lo = 0, hi = sock->rx_dports_len;
+
+	if (PGM_LIKELY(dport == sock->dport))
+		return TRUE;
+	while (lo < hi) {
+		const unsigned mid = (lo + hi) / 2;
+		if (sock->rx_dports[mid] < dport)
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
-#endif
+	return lo < sock->rx_dports_len && dport == sock->rx_dports[lo];
+}
 
-	skb->sock		= sock;
-	skb->tstamp		= pgm_time_update_now();
-	skb->data		= skb->head;
-	skb->len		= (uint16_t)len;
-	skb->zero_padded	= 0;
-	skb->tail		= (char*)skb->data + len;
+/* extract the destination address from the ancillary data of a received datagram.
+ *
+ * returns TRUE on success, returns FALSE on invalid control message.
+ */
 
+static
+bool
+recvskb_dst_addr (
+	const pgm_sock_t*       const restrict sock,
+	pgm_msghdr_t*	        const restrict msg,
+	const struct sockaddr*  const restrict src_addr,
+	struct sockaddr*        const restrict dst_addr
+	)
+{
 	if (sock->udp_encap_ucast_port ||
 	    AF_INET6 == pgm_sockaddr_family (src_addr))
 	{
 		struct pgm_cmsghdr* cmsg;
-		for (cmsg = PGM_CMSG_FIRSTHDR(&msg);
+		for (cmsg = PGM_CMSG_FIRSTHDR(msg);
 		     cmsg != NULL;
-		     cmsg = PGM_CMSG_NXTHDR(&msg, cmsg))
+		     cmsg = PGM_CMSG_NXTHDR(msg, cmsg))
 		{
 /* both IP_PKTINFO and IP_RECVDSTADDR exist on OpenSolaris, so capture
  * each type if defined.
@@ -178,7 +224,7 @@ recvskb (
 /* discard on invalid address */
 				if (PGM_UNLIKELY(NULL == pktinfo)) {
 					pgm_debug ("in_pktinfo is NULL");
-					return -1;
+					return FALSE;
 				}
 				const struct in_pktinfo* in	= pktinfo;
 				struct sockaddr_in s4;
@@ -197,7 +243,7 @@ recvskb (
 /* discard on invalid address */
 				if (PGM_UNLIKELY(NULL == recvdstaddr)) {
 					pgm_debug ("in_recvdstaddr is NULL");
-					return -1;
+					return FALSE;
 				}
 				const struct in_addr* in	= recvdstaddr;
 				struct sockaddr_in s4;
@@ -219,7 +265,7 @@ recvskb (
 /* discard on invalid address */
 				if (PGM_UNLIKELY(NULL == pktinfo)) {
 					pgm_debug ("in6_pktinfo is NULL");
-					return -1;
+					return FALSE;
 				}
 				const struct in6_pktinfo* in6	= pktinfo;
 				struct sockaddr_in6 s6;
@@ -233,180 +279,227 @@ recvskb (
 			}
 		}
 	}
-	return len;
+	return TRUE;
 }
 
-/* upstream = receiver to source, peer-to-peer = receive to receiver
- *
- * NB: SPMRs can be upstream or peer-to-peer, if the packet is multicast then its
- *     a peer-to-peer message, if its unicast its an upstream message.
- *
- * returns TRUE on valid processed packet, returns FALSE on discarded packet.
+/* receive time stamps beyond a second old imply an unsynchronised NIC clock */
+#define PGM_TIMESTAMPING_MAX_DELAY	pgm_secs (1)
+
+/* system clock in micro-seconds, the clock of SO_TIMESTAMPING, read alongside
+ * the user-space time stamp of a datagram.
  */
 
-static
-bool
-on_upstream (
-	pgm_sock_t*           const restrict sock,
-	struct pgm_sk_buff_t* const restrict skb
-	)
+static inline
+pgm_time_t
+recvskb_realtime (void)
 {
-/* pre-conditions */
-	pgm_assert (NULL != sock);
-	pgm_assert (NULL != skb);
-	pgm_assert_cmpuint (skb->pgm_header->pgm_dport, ==, sock->tsi.sport);
-
-	pgm_debug ("on_upstream (sock:%p skb:%p)",
-		(const void*)sock, (const void*)skb);
-
-	if (PGM_UNLIKELY(!sock->can_send_data)) {
-		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded packet for muted source."));
-		goto out_discarded;
-	}
+#if defined(HAVE_LINUX_NET_TSTAMP_H) && defined(SO_TIMESTAMPING)
+	struct timespec ts;
+	clock_gettime (CLOCK_REALTIME, &ts);
+	return (pgm_time_t)ts.tv_sec * 1000000 + (pgm_time_t)ts.tv_nsec / 1000;
+#else
+	return 0;
+#endif
+}
 
-/* unicast upstream message, note that dport & sport are reversed */
-	if (PGM_UNLIKELY(skb->pgm_header->pgm_sport != sock->dport)) {
-/* its upstream/peer-to-peer for another session */
-		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded packet on data-destination port mismatch."));
-		goto out_discarded;
-	}
+/* returns the system clock time in micro-seconds of the SCM_TIMESTAMPING control
+ * message preferring NIC hardware to kernel software, or 0 if not present.
+ */
 
-	if (PGM_UNLIKELY(!pgm_gsi_equal (&skb->tsi.gsi, &sock->tsi.gsi))) {
-/* its upstream/peer-to-peer for another session */
-		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded packet on data-destination port mismatch."));
-		goto out_discarded;
+static
+pgm_time_t
+recvskb_kernel_time (
+	pgm_msghdr_t* const	msg
+	)
+{
+#if defined(HAVE_LINUX_NET_TSTAMP_H) && defined(SO_TIMESTAMPING)
+	for (struct pgm_cmsghdr* cmsg = PGM_CMSG_FIRSTHDR(msg);
+	     cmsg != NULL;
+	     cmsg = PGM_CMSG_NXTHDR(msg, cmsg))
+	{
+		if (SOL_SOCKET == cmsg->cmsg_level &&
+		    SCM_TIMESTAMPING == cmsg->cmsg_type)
+		{
+			const struct scm_timestamping* tss = (const void*)PGM_CMSG_DATA(cmsg);
+			const struct timespec* ts = &tss->ts[2];	/* raw hardware */
+			if (0 == ts->tv_sec && 0 == ts->tv_nsec)
+				ts = &tss->ts[0];			/* software */
+			return (pgm_time_t)ts->tv_sec * 1000000 + (pgm_time_t)ts->tv_nsec / 1000;
+		}
 	}
+#else
+	(void)msg;
+#endif
+	return 0;
+}
 
-/* advance SKB pointer to PGM type header */
-	skb->data	= (char*)skb->data + sizeof(struct pgm_header);
-	skb->len       -= sizeof(struct pgm_header);
-
-	switch (skb->pgm_header->pgm_type) {
-	case PGM_NAK:
-		if (PGM_UNLIKELY(!pgm_on_nak (sock, skb)))
-			goto out_discarded;
-		break;
-
-	case PGM_NNAK:
-		if (PGM_UNLIKELY(!pgm_on_nnak (sock, skb)))
-			goto out_discarded;
-		break;
+/* convert a kernel or NIC receive time to the clock of tstamp by the delay to realtime,
+ * both read at the same instant.
+ *
+ * returns tstamp when not present or implausible.
+ */
 
-	case PGM_SPMR:
-		if (PGM_UNLIKELY(!pgm_on_spmr (sock, NULL, skb)))
-			goto out_discarded;
-		break;
+static inline
+pgm_time_t
+recvskb_wire_tstamp (
+	const pgm_time_t	tstamp,
+	const pgm_time_t	realtime,
+	const pgm_time_t	kernel_time
+	)
+{
+	if (0 == kernel_time ||
+	    pgm_time_after (kernel_time, realtime) ||
+	    realtime - kernel_time > PGM_TIMESTAMPING_MAX_DELAY)
+		return tstamp;
+	return tstamp - (realtime - kernel_time);
+}
 
-	case PGM_ACK:
-		if (PGM_UNLIKELY(!pgm_on_ack (sock, skb)))
-			goto out_discarded;
-		break;
+/* account datagrams dropped by the kernel on a full receive queue of the socket
+ * just read.  SO_RXQ_OVFL carries a running count per socket with every datagram
+ * once the first is dropped.  a local overrun holds back NAKs for new gaps for
+ * one NAK back-off interval so the application can drain the queue before the
+ * repairs arrive, and the loss is not mistaken for the network.
+ */
 
-	case PGM_POLR:
-	default:
-		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded unsupported PGM type packet."));
-		goto out_discarded;
+static
+void
+recvskb_rxq_drops (
+	pgm_sock_t*   const restrict sock,
+	pgm_msghdr_t* const restrict msg
+	)
+{
+#ifdef SO_RXQ_OVFL
+	for (struct pgm_cmsghdr* cmsg = PGM_CMSG_FIRSTHDR(msg);
+	     cmsg != NULL;
+	     cmsg = PGM_CMSG_NXTHDR(msg, cmsg))
+	{
+		if (SOL_SOCKET == cmsg->cmsg_level &&
+		    SO_RXQ_OVFL == cmsg->cmsg_type)
+		{
+			uint32_t count;
+			memcpy (&count, PGM_CMSG_DATA(cmsg), sizeof(count));
+			const uint32_t drops = count - sock->rxq_ovfl[ sock->recv_sock_index ];
+			if (PGM_UNLIKELY(drops > 0)) {
+				sock->rxq_ovfl[ sock->recv_sock_index ] = count;
+				sock->rxq_overrun_expiry = pgm_time_update_now() + sock->nak_bo_ivl;
+				pgm_stats_add (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_RXQ_DROPS, drops);
+				pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Receive queue overrun, %" PRIu32 " datagrams dropped by kernel."), drops);
+			}
+			return;
+		}
 	}
-
-	return TRUE;
-out_discarded:
-	sock->cumulative_stats[PGM_PC_SOURCE_PACKETS_DISCARDED]++;
-	return FALSE;
+#else
+	(void)sock;
+	(void)msg;
+#endif
 }
 
-/* peer to peer message, either multicast NAK or multicast SPMR.
- *
- * returns TRUE on valid processed packet, returns FALSE on discarded packet.
+/* read a packet into a PGM skbuff
+ * on success returns packet length, on closed socket returns 0,
+ * on error returns -1.
  */
 
 static
-bool
-on_peer (
+ssize_t
+recvskb (
 	pgm_sock_t*           const restrict sock,
 	struct pgm_sk_buff_t* const restrict skb,
-	pgm_peer_t**		    restrict source
+	const int			     flags,
+	struct sockaddr*      const restrict src_addr,
+	const socklen_t			     src_addrlen,
+	struct sockaddr*      const restrict dst_addr,
+	const socklen_t			     dst_addrlen
 	)
 {
 /* pre-conditions */
 	pgm_assert (NULL != sock);
 	pgm_assert (NULL != skb);
-	pgm_assert_cmpuint (skb->pgm_header->pgm_dport, !=, sock->tsi.sport);
-	pgm_assert (NULL != source);
-
-	pgm_debug ("on_peer (sock:%p skb:%p source:%p)",
-		(const void*)sock, (const void*)skb, (const void*)source);
-
-/* we are not the source */
-	if (PGM_UNLIKELY(!sock->can_recv_data)) {
-		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded packet for muted receiver."));
-		goto out_discarded;
-	}
-
-/* unicast upstream message, note that dport & sport are reversed */
-	if (PGM_UNLIKELY(skb->pgm_header->pgm_sport != sock->dport)) {
-/* its upstream/peer-to-peer for another session */
-		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded packet on data-destination port mismatch."));
-		goto out_discarded;
-	}
-
-/* check to see the source this peer-to-peer message is about is in our peer list */
-	pgm_tsi_t upstream_tsi;
-	memcpy (&upstream_tsi.gsi, &skb->tsi.gsi, sizeof(pgm_gsi_t));
-	upstream_tsi.sport = skb->pgm_header->pgm_dport;
+	pgm_assert (NULL != src_addr);
+	pgm_assert (src_addrlen > 0);
+	pgm_assert (NULL != dst_addr);
+	pgm_assert (dst_addrlen > 0);
 
-	pgm_rwlock_reader_lock (&sock->peers_lock);
-	*source = pgm_hashtable_lookup (sock->peers_hashtable, &upstream_tsi);
-	pgm_rwlock_reader_unlock (&sock->peers_lock);
-	if (PGM_UNLIKELY(NULL == *source)) {
-/* this source is unknown, we don't care about messages about it */
-		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded peer packet about new source."));
-		goto out_discarded;
-	}
+	pgm_debug ("recvskb (sock:%p skb:%p flags:%d src-addr:%p src-addrlen:%d dst-addr:%p dst-addrlen:%d)",
+		(void*)sock, (void*)skb, flags, (void*)src_addr, (int)src_addrlen, (void*)dst_addr, (int)dst_addrlen);
 
-/* advance SKB pointer to PGM type header */
-	skb->data	= (char*)skb->data + sizeof(struct pgm_header);
-	skb->len       -= sizeof(struct pgm_header);
+	if (PGM_UNLIKELY(sock->is_destroyed))
+		return 0;
 
-	switch (skb->pgm_header->pgm_type) {
-	case PGM_NAK:
-		if (PGM_UNLIKELY(!pgm_on_peer_nak (sock, *source, skb)))
-			goto out_discarded;
-		break;
-
-	case PGM_SPMR:
-		if (PGM_UNLIKELY(!pgm_on_spmr (sock, *source, skb)))
-			goto out_discarded;
-		break;
+	struct pgm_iovec iov = {
+		.iov_base	= skb->head,
+		.iov_len	= sock->max_tpdu
+	};
+	char aux[ 1024 ];
+#ifndef _WIN32
+	struct msghdr msg = {
+		.msg_name	= src_addr,
+		.msg_namelen	= src_addrlen,
+		.msg_iov	= (void*)&iov,
+		.msg_iovlen	= 1,
+		.msg_control	= aux,
+		.msg_controllen = sizeof(aux),
+		.msg_flags	= 0
+	};
+	ssize_t len = recvmsg (current_recv_sock (sock), &msg, flags);
+	if (len <= 0)
+		return len;
+	recvskb_rxq_drops (sock, &msg);
+#else /* !_WIN32 */
+	WSAMSG msg = {
+		.name		= (LPSOCKADDR)src_addr,
+		.namelen	= src_addrlen,
+		.lpBuffers	= (LPWSABUF)&iov,
+		.dwBufferCount	= 1,
+		.dwFlags	= 0
+	};
+	msg.Control.buf		= aux;
+	msg.Control.len		= sizeof(aux);
+	DWORD len;
+	if (SOCKET_ERROR == pgm_WSARecvMsg (current_recv_sock (sock), &msg, &len, NULL, NULL)) {
+		return SOCKET_ERROR;
+	}
+#endif /* !_WIN32 */
 
-	case PGM_NNAK:
-	case PGM_POLR:
-	default:
-		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded unsupported PGM type packet."));
-		goto out_discarded;
+#ifdef PGM_DEBUG
+	if (PGM_UNLIKELY(pgm_loss_rate > 0)) {
+		const unsigned percent = pgm_rand_int_range (&sock->rand_, 0, 100);
+		if (percent <= pgm_loss_rate) {
+			pgm_debug ("Simulated packet loss");
+			pgm_set_last_sock_error (PGM_SOCK_EAGAIN);
+			return SOCKET_ERROR;
+		}
 	}
+#endif
 
-	return TRUE;
-out_discarded:
-	if (*source)
-		(*source)->cumulative_stats[PGM_PC_RECEIVER_PACKETS_DISCARDED]++;
-	else if (sock->can_send_data)
-		sock->cumulative_stats[PGM_PC_SOURCE_PACKETS_DISCARDED]++;
-	return FALSE;
+	skb->sock		= sock;
+	skb->tstamp		= pgm_time_update_now();
+	skb->wire_tstamp	= skb->tstamp;
+	if (sock->timestamping)
+		skb->wire_tstamp = recvskb_wire_tstamp (skb->tstamp, recvskb_realtime(), recvskb_kernel_time (&msg));
+	skb->data		= skb->head;
+	skb->len		= (uint16_t)len;
+	skb->zero_padded	= 0;
+	skb->csum_unnecessary	= (0 != sock->udp_encap_ucast_port);	/* UDP stack verified */
+	skb->tail		= (char*)skb->data + len;
+
+	if (PGM_UNLIKELY(!recvskb_dst_addr (sock, &msg, src_addr, dst_addr)))
+		return -1;
+	return len;
 }
 
-/* source to receiver message
+/* read a packet into a PGM skbuff from the in-memory transport.
  *
- * returns TRUE on valid processed packet, returns FALSE on discarded packet.
+ * on success returns packet length, on closed socket returns 0,
+ * on error returns -1.
  */
 
 static
-bool
-on_downstream (
+ssize_t
+recvskb_shim (
 	pgm_sock_t*           const restrict sock,
 	struct pgm_sk_buff_t* const restrict skb,
 	struct sockaddr*      const restrict src_addr,
-	struct sockaddr*      const restrict dst_addr,
-	pgm_peer_t**	  	    restrict source
+	struct sockaddr*      const restrict dst_addr
 	)
 {
 /* pre-conditions */
@@ -414,261 +507,2451 @@ on_downstream (
 	pgm_assert (NULL != skb);
 	pgm_assert (NULL != src_addr);
 	pgm_assert (NULL != dst_addr);
-	pgm_assert (NULL != source);
-
-#ifdef RECV_DEBUG
-	char saddr[INET6_ADDRSTRLEN], daddr[INET6_ADDRSTRLEN];
-	pgm_sockaddr_ntop (src_addr, saddr, sizeof(saddr));
-	pgm_sockaddr_ntop (dst_addr, daddr, sizeof(daddr));
-	pgm_debug ("on_downstream (sock:%p skb:%p src-addr:%s dst-addr:%s source:%p)",
-		(const void*)sock, (const void*)skb, saddr, daddr, (const void*)source);
-#endif
-
-	if (PGM_UNLIKELY(!sock->can_recv_data)) {
-		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded packet for muted receiver."));
-		goto out_discarded;
-	}
 
-/* pgm packet DPORT contains our sock DPORT */
-	if (PGM_UNLIKELY(skb->pgm_header->pgm_dport != sock->dport)) {
-		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded packet on data-destination port mismatch."));
-		goto out_discarded;
-	}
+	if (PGM_UNLIKELY(sock->is_destroyed))
+		return 0;
 
-/* search for TSI peer context or create a new one */
-	if (PGM_LIKELY(pgm_tsi_hash (&skb->tsi) == sock->last_hash_key &&
-			NULL != sock->last_hash_value))
-	{
-		*source = sock->last_hash_value;
-	}
-	else
-	{
-		pgm_rwlock_reader_lock (&sock->peers_lock);
-		*source = pgm_hashtable_lookup_extended (sock->peers_hashtable, &skb->tsi, &sock->last_hash_key);
-		pgm_rwlock_reader_unlock (&sock->peers_lock);
-		if (PGM_UNLIKELY(NULL == *source)) {
-			*source = pgm_new_peer (sock,
-					       &skb->tsi,
-					       (struct sockaddr*)src_addr, pgm_sockaddr_len(src_addr),
-					       (struct sockaddr*)dst_addr, pgm_sockaddr_len(dst_addr),
-						skb->tstamp);
-		}
-		sock->last_hash_value = *source;
-	}
+	const ssize_t len = pgm_net_shim->recvfrom (pgm_net_shim->user_data, sock, skb->head, sock->max_tpdu, src_addr, dst_addr);
+	if (len <= 0)
+		return len;
 
-	(*source)->cumulative_stats[PGM_PC_RECEIVER_BYTES_RECEIVED] += skb->len;
-	(*source)->last_packet = skb->tstamp;
+	skb->sock		= sock;
+	skb->tstamp		= pgm_time_update_now();
+	skb->wire_tstamp	= skb->tstamp;
+	skb->data		= skb->head;
+	skb->len		= (uint16_t)len;
+	skb->zero_padded	= 0;
+	skb->csum_unnecessary	= (0 != sock->udp_encap_ucast_port);	/* as the UDP stack */
+	skb->tail		= (char*)skb->data + len;
+	return len;
+}
 
-	skb->data       = (void*)( skb->pgm_header + 1 );
-	skb->len       -= sizeof(struct pgm_header);
+/* copy the next record of the same-host transmit window store into a PGM skbuff as
+ * a UDP encapsulated datagram from the loopback address to the receive group.  the
+ * reader restarts at the store trailing edge when overrun or the source restarts,
+ * skipped sequences are recovered by the receive window as network loss.
+ *
+ * returns packet length, or 0 when no record is available.
+ */
 
-/* handle PGM packet type */
-	switch (skb->pgm_header->pgm_type) {
-	case PGM_ODATA:
-	case PGM_RDATA:
-		if (PGM_UNLIKELY(!pgm_on_data (sock, *source, skb)))
-			goto out_discarded;
-		sock->rx_buffer = pgm_alloc_skb (sock->max_tpdu);
-		break;
+static
+ssize_t
+recvskb_shm (
+	pgm_sock_t*           const restrict sock,
+	struct pgm_sk_buff_t* const restrict skb,
+	struct sockaddr*      const restrict src_addr,
+	struct sockaddr*      const restrict dst_addr
+	)
+{
+	uint32_t trail, lead;
+	size_t len;
 
-	case PGM_NCF:
-		if (PGM_UNLIKELY(!pgm_on_ncf (sock, *source, skb)))
-			goto out_discarded;
-		break;
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != sock->rx_shm);
+	pgm_assert (NULL != skb);
+	pgm_assert (NULL != src_addr);
+	pgm_assert (NULL != dst_addr);
 
-	case PGM_SPM:
-		if (PGM_UNLIKELY(!pgm_on_spm (sock, *source, skb)))
-			goto out_discarded;
+	if (PGM_UNLIKELY(sock->is_destroyed))
+		return 0;
+	if (!pgm_txw_store_extent (sock->rx_shm, &trail, &lead))
+		return 0;
+	if (PGM_UNLIKELY(pgm_uint32_lt (sock->rx_shm_next, trail) ||
+			 pgm_uint32_gt (sock->rx_shm_next, lead + 1)))
+	{
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Shared memory reader at #%" PRIu32 " outside store #%" PRIu32 " to #%" PRIu32 ", restarting at trailing edge."),
+			sock->rx_shm_next, trail, lead);
+		sock->rx_shm_next = trail;
+	}
+	if (sock->rx_shm_next == (uint32_t)(lead + 1))
+		return 0;
+	len = pgm_txw_store_copy (sock->rx_shm, sock->rx_shm_next, skb->head, sock->max_tpdu);
+	if (PGM_UNLIKELY(0 == len)) {
+/* overwritten whilst copying */
+		sock->rx_shm_next = pgm_txw_store_trail (sock->rx_shm);
+		return 0;
+	}
+	sock->rx_shm_next++;
+
+	memset (src_addr, 0, sizeof(struct sockaddr_storage));
+	src_addr->sa_family = sock->recv_gsr[0].gsr_group.ss_family;
+	if (AF_INET6 == src_addr->sa_family) {
+		((struct sockaddr_in6*)src_addr)->sin6_addr = in6addr_loopback;
+		((struct sockaddr_in6*)src_addr)->sin6_port = pgm_htons (sock->udp_encap_ucast_port);
+	} else {
+		((struct sockaddr_in*)src_addr)->sin_addr.s_addr = pgm_htonl (INADDR_LOOPBACK);
+		((struct sockaddr_in*)src_addr)->sin_port = pgm_htons (sock->udp_encap_ucast_port);
+	}
+	memcpy (dst_addr, &sock->recv_gsr[0].gsr_group, pgm_sockaddr_len ((const struct sockaddr*)&sock->recv_gsr[0].gsr_group));
 
-/* update group NLA if appropriate */
-		if (PGM_LIKELY(pgm_sockaddr_is_addr_multicast ((struct sockaddr*)dst_addr)))
-			memcpy (&(*source)->group_nla, dst_addr, pgm_sockaddr_len(dst_addr));
-		break;
+	skb->sock		= sock;
+	skb->tstamp		= pgm_time_update_now();
+	skb->wire_tstamp	= skb->tstamp;
+	skb->data		= skb->head;
+	skb->len		= (uint16_t)len;
+	skb->zero_padded	= 0;
+	skb->csum_unnecessary	= 1;
+	skb->tail		= (char*)skb->data + len;
+	return (ssize_t)len;
+}
 
-#ifdef USE_PGM_PROTOCOL_POLL
-	case PGM_POLL:
-		if (PGM_UNLIKELY(!pgm_on_poll (sock, *source, skb)))
-			goto out_discarded;
-		break;
-#endif
+#ifdef HAVE_RECVMMSG
+/* control message buffer per batched datagram, sized for IPV6_PKTINFO and SCM_TIMESTAMPING */
+#	define PGM_RECV_BATCH_AUX_LEN		256
 
-	default:
-		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded unsupported PGM type packet."));
-		goto out_discarded;
-	}
+/* allocate receive ring of sock::rx_batch_len packet buffers in one block.
+ */
 
-	return TRUE;
-out_discarded:
-	if (*source)
-		(*source)->cumulative_stats[PGM_PC_RECEIVER_PACKETS_DISCARDED]++;
-	else if (sock->can_send_data)
-		sock->cumulative_stats[PGM_PC_SOURCE_PACKETS_DISCARDED]++;
-	return FALSE;
+static
+struct pgm_recv_batch_t*
+recvskb_batch_new (
+	pgm_sock_t* const	sock
+	)
+{
+	const unsigned len = sock->rx_batch_len;
+	char* p = pgm_malloc0 (sizeof(struct pgm_recv_batch_t) +
+			       len * (sizeof(struct pgm_sk_buff_t*) +
+				      sizeof(struct mmsghdr) +
+				      sizeof(struct pgm_iovec) +
+				      sizeof(struct sockaddr_storage) +
+				      PGM_RECV_BATCH_AUX_LEN +
+				      sizeof(uint8_t)));
+	struct pgm_recv_batch_t* batch = (struct pgm_recv_batch_t*)p;
+	p += sizeof(struct pgm_recv_batch_t);
+	batch->addr	= (struct sockaddr_storage*)p;	p += len * sizeof(struct sockaddr_storage);
+	batch->msgvec	= (struct mmsghdr*)p;		p += len * sizeof(struct mmsghdr);
+	batch->skb	= (struct pgm_sk_buff_t**)p;	p += len * sizeof(struct pgm_sk_buff_t*);
+	batch->iov	= (struct pgm_iovec*)p;		p += len * sizeof(struct pgm_iovec);
+	batch->aux	= p;				p += len * PGM_RECV_BATCH_AUX_LEN;
+	batch->type	= (uint8_t*)p;
+	for (unsigned i = 0; i < len; i++)
+		batch->skb[i] = pgm_skb_pool_alloc (sock->skb_pool, sock->max_tpdu);
+	return batch;
 }
 
-/* process a pgm packet
+/* read a packet into a PGM skbuff from a batch of datagrams read with one
+ * recvmmsg() call, refilling the batch when exhausted.  the filled buffer is
+ * exchanged with *skb such that the ring is always replenished with the
+ * spare buffer of the caller.
  *
- * returns TRUE on valid processed packet, returns FALSE on discarded packet.
+ * on success returns packet length, on closed socket returns 0,
+ * on error returns -1.
  */
+
 static
-bool
-on_pgm (
+ssize_t
+recvskb_batch (
 	pgm_sock_t*           const restrict sock,
-	struct pgm_sk_buff_t* const restrict skb,
+	struct pgm_sk_buff_t* restrict*	const skb,
+	const int			     flags,
 	struct sockaddr*      const restrict src_addr,
+	const socklen_t			     src_addrlen,
 	struct sockaddr*      const restrict dst_addr,
-	pgm_peer_t**		    restrict source
+	const socklen_t			     dst_addrlen
 	)
 {
 /* pre-conditions */
 	pgm_assert (NULL != sock);
+	pgm_assert (sock->rx_batch_len > 1);
 	pgm_assert (NULL != skb);
+	pgm_assert (NULL != *skb);
 	pgm_assert (NULL != src_addr);
+	pgm_assert (src_addrlen > 0);
 	pgm_assert (NULL != dst_addr);
-	pgm_assert (NULL != source);
+	pgm_assert (dst_addrlen > 0);
 
-#ifdef RECV_DEBUG
-	char saddr[INET6_ADDRSTRLEN], daddr[INET6_ADDRSTRLEN];
-	pgm_sockaddr_ntop (src_addr, saddr, sizeof(saddr));
-	pgm_sockaddr_ntop (dst_addr, daddr, sizeof(daddr));
-	pgm_debug ("on_pgm (sock:%p skb:%p src-addr:%s dst-addr:%s source:%p)",
-		(const void*)sock, (const void*)skb, saddr, daddr, (const void*)source);
-#endif
+	pgm_debug ("recvskb_batch (sock:%p skb:%p flags:%d src-addr:%p src-addrlen:%d dst-addr:%p dst-addrlen:%d)",
+		(void*)sock, (void*)skb, flags, (void*)src_addr, (int)src_addrlen, (void*)dst_addr, (int)dst_addrlen);
 
-	if (PGM_IS_DOWNSTREAM (skb->pgm_header->pgm_type))
-		return on_downstream (sock, skb, src_addr, dst_addr, source);
-	if (skb->pgm_header->pgm_dport == sock->tsi.sport)
+	if (PGM_UNLIKELY(sock->is_destroyed))
+		return 0;
+
+	if (PGM_UNLIKELY(NULL == sock->rx_batch))
+		sock->rx_batch = recvskb_batch_new (sock);
+
+	struct pgm_recv_batch_t* batch = sock->rx_batch;
+again:
+	if (batch->index == batch->count)
 	{
-		if (PGM_IS_UPSTREAM (skb->pgm_header->pgm_type) ||
-		    PGM_IS_PEER (skb->pgm_header->pgm_type))
+		for (unsigned i = 0; i < sock->rx_batch_len; i++)
 		{
-			return on_upstream (sock, skb);
+			struct msghdr* msg	= &batch->msgvec[i].msg_hdr;
+			batch->iov[i].iov_base	= batch->skb[i]->head;
+			batch->iov[i].iov_len	= sock->max_tpdu;
+			msg->msg_name		= &batch->addr[i];
+			msg->msg_namelen	= sizeof(struct sockaddr_storage);
+			msg->msg_iov		= (void*)&batch->iov[i];
+			msg->msg_iovlen		= 1;
+			msg->msg_control	= batch->aux + (i * PGM_RECV_BATCH_AUX_LEN);
+			msg->msg_controllen	= PGM_RECV_BATCH_AUX_LEN;
+			msg->msg_flags		= 0;
 		}
+		const int count = recvmmsg (current_recv_sock (sock), batch->msgvec, sock->rx_batch_len, flags, NULL);
+		if (count <= 0)
+			return count;
+/* running count, the last datagram is current */
+		recvskb_rxq_drops (sock, &batch->msgvec[count - 1].msg_hdr);
+		batch->count = count;
+		batch->index = 0;
+		batch->tstamp = 0;
+/* headers of the whole batch screened in one pass */
+		for (int j = 0; j < count; j++)
+			batch->iov[j].iov_len = batch->msgvec[j].msg_len;
+		pgm_parse_screen (batch->iov, count, sock->udp_encap_ucast_port || AF_INET6 == batch->addr[0].ss_family, batch->type);
+	}
+/* capture records every datagram as read */
+	if (PGM_LIKELY(NULL == sock->capture))
+	{
+		while (batch->index < batch->count &&
+		       PGM_UNLIKELY(PGM_MAX == batch->type[ batch->index ]))
+		{
+			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded invalid packet in batch."));
+			if (sock->can_send_data)
+				pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_PACKETS_DISCARDED);
+			batch->index++;
+		}
+		if (batch->index == batch->count)
+			goto again;
+	}
+	if (0 == batch->tstamp) {
+		batch->tstamp = pgm_time_update_now();
+		if (sock->timestamping)
+			batch->realtime = recvskb_realtime();
 	}
-	else if (PGM_IS_PEER (skb->pgm_header->pgm_type))
-		return on_peer (sock, skb, source);
 
-	pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded unknown PGM packet."));
-	if (sock->can_send_data)
-		sock->cumulative_stats[PGM_PC_SOURCE_PACKETS_DISCARDED]++;
-	return FALSE;
+	const unsigned i = batch->index++;
+	struct pgm_sk_buff_t* filled = batch->skb[i];
+	struct msghdr* msg = &batch->msgvec[i].msg_hdr;
+	const ssize_t len = batch->msgvec[i].msg_len;
+	batch->skb[i] = *skb;
+	*skb = filled;
+	memcpy (src_addr, &batch->addr[i], MIN(src_addrlen, msg->msg_namelen));
+	if (0 == len)
+		return len;
+
+#ifdef PGM_DEBUG
+	if (PGM_UNLIKELY(pgm_loss_rate > 0)) {
+		const unsigned percent = pgm_rand_int_range (&sock->rand_, 0, 100);
+		if (percent <= pgm_loss_rate) {
+			pgm_debug ("Simulated packet loss");
+			pgm_set_last_sock_error (PGM_SOCK_EAGAIN);
+			return SOCKET_ERROR;
+		}
+	}
+#endif
+
+	filled->sock		= sock;
+	filled->tstamp		= batch->tstamp;
+	filled->wire_tstamp	= batch->tstamp;
+	if (sock->timestamping)
+		filled->wire_tstamp = recvskb_wire_tstamp (batch->tstamp, batch->realtime, recvskb_kernel_time (msg));
+	filled->data		= filled->head;
+	filled->len		= (uint16_t)len;
+	filled->zero_padded	= 0;
+	filled->csum_unnecessary	= (0 != sock->udp_encap_ucast_port);	/* UDP stack verified */
+	filled->tail		= (char*)filled->data + len;
+
+	if (PGM_UNLIKELY(!recvskb_dst_addr (sock, msg, src_addr, dst_addr)))
+		return -1;
+	return len;
 }
+#endif /* HAVE_RECVMMSG */
 
-/* block on receiving socket whilst holding sock::waiting-mutex
- * returns EAGAIN for waiting data, returns EINTR for waiting timer event,
- * returns ENOENT on closed sock, and returns EFAULT for libc error.
+#ifdef HAVE_LINUX_IO_URING_H
+/* read a packet into a PGM skbuff from the completion queue of the io_uring
+ * receive engine, the filled buffer is exchanged with *skb as recvskb_batch().
+ *
+ * on success returns packet length, on closed socket returns 0,
+ * on error returns -1.
  */
 
 static
-int
-wait_for_event (
-	pgm_sock_t* const	sock
+ssize_t
+recvskb_uring (
+	pgm_sock_t*           const restrict sock,
+	struct pgm_sk_buff_t* restrict*	const skb,
+	PGM_GNUC_UNUSED const int	     flags,	/* receives are already posted */
+	struct sockaddr*      const restrict src_addr,
+	const socklen_t			     src_addrlen,
+	struct sockaddr*      const restrict dst_addr,
+	const socklen_t			     dst_addrlen
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != sock->rx_uring);
+	pgm_assert (NULL != skb);
+	pgm_assert (NULL != *skb);
+	pgm_assert (NULL != src_addr);
+	pgm_assert (src_addrlen > 0);
+	pgm_assert (NULL != dst_addr);
+	pgm_assert (dst_addrlen > 0);
+
+	pgm_debug ("recvskb_uring (sock:%p skb:%p flags:%d src-addr:%p src-addrlen:%d dst-addr:%p dst-addrlen:%d)",
+		(void*)sock, (void*)skb, flags, (void*)src_addr, (int)src_addrlen, (void*)dst_addr, (int)dst_addrlen);
+
+	if (PGM_UNLIKELY(sock->is_destroyed))
+		return 0;
+
+	struct msghdr* msg;
+	const ssize_t len = pgm_recv_uring_recvmsg (sock->rx_uring, skb, &msg);
+	if (len <= 0)
+		return len;
+	memcpy (src_addr, msg->msg_name, MIN(src_addrlen, msg->msg_namelen));
+
+#ifdef PGM_DEBUG
+	if (PGM_UNLIKELY(pgm_loss_rate > 0)) {
+		const unsigned percent = pgm_rand_int_range (&sock->rand_, 0, 100);
+		if (percent <= pgm_loss_rate) {
+			pgm_debug ("Simulated packet loss");
+			pgm_set_last_sock_error (PGM_SOCK_EAGAIN);
+			return SOCKET_ERROR;
+		}
+	}
+#endif
+
+	struct pgm_sk_buff_t* filled = *skb;
+	filled->sock		= sock;
+	filled->tstamp		= pgm_time_update_now();
+	filled->wire_tstamp	= filled->tstamp;
+	if (sock->timestamping)
+		filled->wire_tstamp = recvskb_wire_tstamp (filled->tstamp, recvskb_realtime(), recvskb_kernel_time (msg));
+	filled->data		= filled->head;
+	filled->len		= (uint16_t)len;
+	filled->zero_padded	= 0;
+	filled->csum_unnecessary	= (0 != sock->udp_encap_ucast_port);	/* UDP stack verified */
+	filled->tail		= (char*)filled->data + len;
+
+	if (PGM_UNLIKELY(!recvskb_dst_addr (sock, msg, src_addr, dst_addr)))
+		return -1;
+	return len;
+}
+#endif /* HAVE_LINUX_IO_URING_H */
+
+#ifdef PGM_HAVE_RIO
+/* read a packet into a PGM skbuff from the completion queue of the Registered
+ * I/O engine, the datagram is copied from the registered region as the receive
+ * window holds skbuffs indefinitely.
+ *
+ * on success returns packet length, on closed socket returns 0,
+ * on error returns -1.
+ */
+
+static
+ssize_t
+recvskb_rio (
+	pgm_sock_t*           const restrict sock,
+	struct pgm_sk_buff_t* const restrict skb,
+	struct sockaddr*      const restrict src_addr,
+	const socklen_t			     src_addrlen,
+	struct sockaddr*      const restrict dst_addr
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != sock->rio);
+	pgm_assert (NULL != skb);
+	pgm_assert (NULL != src_addr);
+	pgm_assert (src_addrlen > 0);
+	pgm_assert (NULL != dst_addr);
+
+	pgm_debug ("recvskb_rio (sock:%p skb:%p src-addr:%p src-addrlen:%d dst-addr:%p)",
+		(void*)sock, (void*)skb, (void*)src_addr, (int)src_addrlen, (void*)dst_addr);
+
+	if (PGM_UNLIKELY(sock->is_destroyed))
+		return 0;
+
+	WSAMSG msg;
+	const ssize_t len = pgm_rio_recvmsg (sock->rio, skb, src_addr, src_addrlen, &msg);
+	if (len <= 0)
+		return len;
+
+#ifdef PGM_DEBUG
+	if (PGM_UNLIKELY(pgm_loss_rate > 0)) {
+		const unsigned percent = pgm_rand_int_range (&sock->rand_, 0, 100);
+		if (percent <= pgm_loss_rate) {
+			pgm_debug ("Simulated packet loss");
+			pgm_set_last_sock_error (PGM_SOCK_EAGAIN);
+			return SOCKET_ERROR;
+		}
+	}
+#endif
+
+	skb->sock		= sock;
+	skb->tstamp		= pgm_time_update_now();
+	skb->wire_tstamp	= skb->tstamp;
+	skb->data		= skb->head;
+	skb->len		= (uint16_t)len;
+	skb->zero_padded	= 0;
+	skb->csum_unnecessary	= (0 != sock->udp_encap_ucast_port);	/* UDP stack verified */
+	skb->tail		= (char*)skb->data + len;
+
+	if (PGM_UNLIKELY(!recvskb_dst_addr (sock, &msg, src_addr, dst_addr)))
+		return -1;
+	return len;
+}
+#endif /* PGM_HAVE_RIO */
+
+#ifdef HAVE_LINUX_IF_XDP_H
+/* read a packet into a PGM skbuff from the AF_XDP receive ring, the frame is
+ * copied as the receive window holds skbuffs indefinitely and the UMEM is finite.
+ *
+ * on success returns packet length, on closed socket returns 0,
+ * on error returns -1.
+ */
+
+static
+ssize_t
+recvskb_xdp (
+	pgm_sock_t*           const restrict sock,
+	struct pgm_sk_buff_t* const restrict skb,
+	struct sockaddr*      const restrict src_addr,
+	struct sockaddr*      const restrict dst_addr
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != sock->rx_xdp);
+	pgm_assert (NULL != skb);
+	pgm_assert (NULL != src_addr);
+	pgm_assert (NULL != dst_addr);
+
+	pgm_debug ("recvskb_xdp (sock:%p skb:%p src-addr:%p dst-addr:%p)",
+		(void*)sock, (void*)skb, (void*)src_addr, (void*)dst_addr);
+
+	if (PGM_UNLIKELY(sock->is_destroyed))
+		return 0;
+
+	const ssize_t len = pgm_recv_xdp_recv (sock->rx_xdp, skb, src_addr, dst_addr);
+	if (len <= 0)
+		return len;
+
+#ifdef PGM_DEBUG
+	if (PGM_UNLIKELY(pgm_loss_rate > 0)) {
+		const unsigned percent = pgm_rand_int_range (&sock->rand_, 0, 100);
+		if (percent <= pgm_loss_rate) {
+			pgm_debug ("Simulated packet loss");
+			pgm_set_last_sock_error (PGM_SOCK_EAGAIN);
+			return SOCKET_ERROR;
+		}
+	}
+#endif
+
+	skb->sock		= sock;
+	skb->tstamp		= pgm_time_update_now();
+	skb->wire_tstamp	= skb->tstamp;
+	skb->data		= skb->head;
+	skb->len		= (uint16_t)len;
+	skb->zero_padded	= 0;
+	skb->csum_unnecessary	= 0;		/* frames bypass host checksum verification */
+	skb->tail		= (char*)skb->data + len;
+	return len;
+}
+#endif /* HAVE_LINUX_IF_XDP_H */
+
+#ifdef HAVE_INFINIBAND_VERBS_H
+/* read a packet into a PGM skbuff from the RDMA receive queue, the slot is copied
+ * and reposted as the receive window holds skbuffs indefinitely.
+ *
+ * on success returns packet length, on closed socket returns 0,
+ * on error returns -1.
+ */
+
+static
+ssize_t
+recvskb_verbs (
+	pgm_sock_t*           const restrict sock,
+	struct pgm_sk_buff_t* const restrict skb,
+	struct sockaddr*      const restrict src_addr,
+	struct sockaddr*      const restrict dst_addr
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != sock->verbs);
+	pgm_assert (NULL != skb);
+	pgm_assert (NULL != src_addr);
+	pgm_assert (NULL != dst_addr);
+
+	pgm_debug ("recvskb_verbs (sock:%p skb:%p src-addr:%p dst-addr:%p)",
+		(void*)sock, (void*)skb, (void*)src_addr, (void*)dst_addr);
+
+	if (PGM_UNLIKELY(sock->is_destroyed))
+		return 0;
+
+	const ssize_t len = pgm_verbs_recv (sock->verbs, skb, src_addr, dst_addr);
+	if (len <= 0)
+		return len;
+
+	skb->sock		= sock;
+	skb->tstamp		= pgm_time_update_now();
+	skb->wire_tstamp	= skb->tstamp;
+	skb->data		= skb->head;
+	skb->len		= (uint16_t)len;
+	skb->zero_padded	= 0;
+	skb->csum_unnecessary	= 0;
+	skb->tail		= (char*)skb->data + len;
+	return len;
+}
+#endif /* HAVE_INFINIBAND_VERBS_H */
+
+#ifdef HAVE_RTE_ETHDEV_H
+/* read a packet into a PGM skbuff from the DPDK receive queue, the frame is copied
+ * and returned to its pool as the receive window holds skbuffs indefinitely.
+ *
+ * on success returns packet length, on closed socket returns 0,
+ * on error returns -1.
+ */
+
+static
+ssize_t
+recvskb_dpdk (
+	pgm_sock_t*           const restrict sock,
+	struct pgm_sk_buff_t* const restrict skb,
+	struct sockaddr*      const restrict src_addr,
+	struct sockaddr*      const restrict dst_addr
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != sock->dpdk);
+	pgm_assert (NULL != skb);
+	pgm_assert (NULL != src_addr);
+	pgm_assert (NULL != dst_addr);
+
+	pgm_debug ("recvskb_dpdk (sock:%p skb:%p src-addr:%p dst-addr:%p)",
+		(void*)sock, (void*)skb, (void*)src_addr, (void*)dst_addr);
+
+	if (PGM_UNLIKELY(sock->is_destroyed))
+		return 0;
+
+	const ssize_t len = pgm_dpdk_recv (sock->dpdk, skb, src_addr, dst_addr);
+	if (len <= 0)
+		return len;
+
+	skb->sock		= sock;
+	skb->tstamp		= pgm_time_update_now();
+	skb->wire_tstamp	= skb->tstamp;
+	skb->data		= skb->head;
+	skb->len		= (uint16_t)len;
+	skb->zero_padded	= 0;
+	skb->csum_unnecessary	= 0;
+	skb->tail		= (char*)skb->data + len;
+	return len;
+}
+#endif /* HAVE_RTE_ETHDEV_H */
+
+#ifdef HAVE_LINUX_IF_PACKET_H
+/* read a packet into a PGM skbuff from the TPACKET_V3 receive ring, the frame is
+ * copied as the receive window holds skbuffs beyond the block being returned.
+ *
+ * on success returns packet length, on closed socket returns 0,
+ * on error returns -1.
+ */
+
+static
+ssize_t
+recvskb_tpacket (
+	pgm_sock_t*           const restrict sock,
+	struct pgm_sk_buff_t* const restrict skb,
+	struct sockaddr*      const restrict src_addr,
+	struct sockaddr*      const restrict dst_addr
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != sock->rx_tpacket);
+	pgm_assert (NULL != skb);
+	pgm_assert (NULL != src_addr);
+	pgm_assert (NULL != dst_addr);
+
+	pgm_debug ("recvskb_tpacket (sock:%p skb:%p src-addr:%p dst-addr:%p)",
+		(void*)sock, (void*)skb, (void*)src_addr, (void*)dst_addr);
+
+	if (PGM_UNLIKELY(sock->is_destroyed))
+		return 0;
+
+	const ssize_t len = pgm_recv_tpacket_recv (sock->rx_tpacket, skb, src_addr, dst_addr);
+	if (len <= 0)
+		return len;
+
+#ifdef PGM_DEBUG
+	if (PGM_UNLIKELY(pgm_loss_rate > 0)) {
+		const unsigned percent = pgm_rand_int_range (&sock->rand_, 0, 100);
+		if (percent <= pgm_loss_rate) {
+			pgm_debug ("Simulated packet loss");
+			pgm_set_last_sock_error (PGM_SOCK_EAGAIN);
+			return SOCKET_ERROR;
+		}
+	}
+#endif
+
+	skb->sock		= sock;
+	skb->tstamp		= pgm_time_update_now();
+	skb->wire_tstamp	= skb->tstamp;
+	skb->data		= skb->head;
+	skb->len		= (uint16_t)len;
+	skb->zero_padded	= 0;
+	skb->csum_unnecessary	= 0;
+	skb->tail		= (char*)skb->data + len;
+	return len;
+}
+#endif /* HAVE_LINUX_IF_PACKET_H */
+
+#ifdef UDP_GRO
+/* read a packet into a PGM skbuff from a super-datagram coalesced by the
+ * kernel, reading a new super-datagram when the previous is exhausted.  each
+ * segment is copied into the caller skbuff as the transmit and receive windows
+ * require one allocation per packet.
+ *
+ * on success returns packet length, on closed socket returns 0,
+ * on error returns -1.
+ */
+
+static
+ssize_t
+recvskb_gro (
+	pgm_sock_t*           const restrict sock,
+	struct pgm_sk_buff_t* const restrict skb,
+	const int			     flags,
+	struct sockaddr*      const restrict src_addr,
+	const socklen_t			     src_addrlen,
+	struct sockaddr*      const restrict dst_addr,
+	const socklen_t			     dst_addrlen
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != skb);
+	pgm_assert (NULL != src_addr);
+	pgm_assert (src_addrlen > 0);
+	pgm_assert (NULL != dst_addr);
+	pgm_assert (dst_addrlen > 0);
+
+	pgm_debug ("recvskb_gro (sock:%p skb:%p flags:%d src-addr:%p src-addrlen:%d dst-addr:%p dst-addrlen:%d)",
+		(void*)sock, (void*)skb, flags, (void*)src_addr, (int)src_addrlen, (void*)dst_addr, (int)dst_addrlen);
+
+	if (PGM_UNLIKELY(sock->is_destroyed))
+		return 0;
+
+	if (PGM_UNLIKELY(NULL == sock->rx_gro)) {
+		sock->rx_gro = pgm_malloc0 (sizeof(struct pgm_recv_gro_t) + PGM_UDP_GRO_BUFLEN);
+		sock->rx_gro->buf = (char*)(sock->rx_gro + 1);
+	}
+
+	struct pgm_recv_gro_t* gro = sock->rx_gro;
+	if (gro->offset == gro->len)
+	{
+		struct pgm_iovec iov = {
+			.iov_base	= gro->buf,
+			.iov_len	= PGM_UDP_GRO_BUFLEN
+		};
+		char aux[ 1024 ];
+		struct msghdr msg = {
+			.msg_name	= &gro->src_addr,
+			.msg_namelen	= sizeof(gro->src_addr),
+			.msg_iov	= (void*)&iov,
+			.msg_iovlen	= 1,
+			.msg_control	= aux,
+			.msg_controllen = sizeof(aux),
+			.msg_flags	= 0
+		};
+		const ssize_t len = recvmsg (current_recv_sock (sock), &msg, flags);
+		if (len <= 0)
+			return len;
+		recvskb_rxq_drops (sock, &msg);
+		gro->len		= len;
+		gro->offset		= 0;
+		gro->segment_len	= len;
+		gro->tstamp		= 0;
+		gro->kernel_time	= sock->timestamping ? recvskb_kernel_time (&msg) : 0;
+		for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+		     cmsg != NULL;
+		     cmsg = CMSG_NXTHDR(&msg, cmsg))
+		{
+			if (SOL_UDP == cmsg->cmsg_level &&
+			    UDP_GRO == cmsg->cmsg_type)
+			{
+				const int segment_len = *(const int*)CMSG_DATA(cmsg);
+				if (PGM_LIKELY(segment_len > 0))
+					gro->segment_len = segment_len;
+				break;
+			}
+		}
+		memset (&gro->dst_addr, 0, sizeof(gro->dst_addr));
+		if (PGM_UNLIKELY(!recvskb_dst_addr (sock, &msg, (struct sockaddr*)&gro->src_addr, (struct sockaddr*)&gro->dst_addr))) {
+			gro->offset = gro->len;
+			return -1;
+		}
+	}
+	if (0 == gro->tstamp) {
+		gro->tstamp = pgm_time_update_now();
+		if (sock->timestamping)
+			gro->realtime = recvskb_realtime();
+	}
+
+/* truncate as per recvskb() on oversized segments */
+	const size_t segment_len = MIN(gro->segment_len, gro->len - gro->offset);
+	const size_t len = MIN(segment_len, sock->max_tpdu);
+	memcpy (skb->head, gro->buf + gro->offset, len);
+	gro->offset += segment_len;
+	memcpy (src_addr, &gro->src_addr, MIN(src_addrlen, sizeof(gro->src_addr)));
+	memcpy (dst_addr, &gro->dst_addr, MIN(dst_addrlen, sizeof(gro->dst_addr)));
+
+#ifdef PGM_DEBUG
+	if (PGM_UNLIKELY(pgm_loss_rate > 0)) {
+		const unsigned percent = pgm_rand_int_range (&sock->rand_, 0, 100);
+		if (percent <= pgm_loss_rate) {
+			pgm_debug ("Simulated packet loss");
+			pgm_set_last_sock_error (PGM_SOCK_EAGAIN);
+			return SOCKET_ERROR;
+		}
+	}
+#endif
+
+	skb->sock		= sock;
+	skb->tstamp		= gro->tstamp;
+	skb->wire_tstamp	= sock->timestamping ? recvskb_wire_tstamp (gro->tstamp, gro->realtime, gro->kernel_time) : gro->tstamp;
+	skb->data		= skb->head;
+	skb->len		= (uint16_t)len;
+	skb->zero_padded	= 0;
+	skb->csum_unnecessary	= (0 != sock->udp_encap_ucast_port);	/* UDP stack verified */
+	skb->tail		= (char*)skb->data + len;
+	return len;
+}
+#endif /* UDP_GRO */
+
+/* returns TRUE if datagrams read by recvmmsg(), segments of a UDP_GRO
+ * super-datagram, or io_uring or Registered I/O completions remain to be processed.
+ */
+
+static inline
+bool
+is_batch_pending (
+	const pgm_sock_t* const	sock
+	)
+{
+	return ((NULL != sock->rx_batch && sock->rx_batch->index < sock->rx_batch->count) ||
+		(NULL != sock->rx_gro && sock->rx_gro->offset < sock->rx_gro->len)
+#ifdef HAVE_LINUX_IO_URING_H
+		|| (NULL != sock->rx_uring && pgm_recv_uring_is_pending (sock->rx_uring))
+#endif
+#ifdef PGM_HAVE_RIO
+		|| (NULL != sock->rio && pgm_rio_is_pending (sock->rio))
+#endif
+#ifdef HAVE_LINUX_IF_XDP_H
+		|| (NULL != sock->rx_xdp && pgm_recv_xdp_is_pending (sock->rx_xdp))
+#endif
+#ifdef HAVE_INFINIBAND_VERBS_H
+		|| (NULL != sock->verbs && pgm_verbs_is_pending (sock->verbs))
+#endif
+#ifdef HAVE_RTE_ETHDEV_H
+		|| (NULL != sock->dpdk && pgm_dpdk_is_pending (sock->dpdk))
+#endif
+#ifdef HAVE_LINUX_IF_PACKET_H
+		|| (NULL != sock->rx_tpacket && pgm_recv_tpacket_is_pending (sock->rx_tpacket))
+#endif
+		);
+}
+
+/* insert transmission groups reconstructed by FEC decoder threads and queue their
+ * peers for delivery.  the decoder notification shares the pending-pipe, so the
+ * pipe is refilled if a read is still pending.
+ */
+
+static
+void
+recv_fec_complete (
+	pgm_sock_t* const	sock
+	)
+{
+	pgm_rxw_t* window;
+
+	if (NULL == sock->rx_decoder ||
+	    !pgm_rxw_decoder_acknowledge (sock->rx_decoder))
+		return;
+	if (sock->is_pending_read)
+		pgm_notify_send (&sock->pending_notify);
+	while (NULL != (window = pgm_rxw_decoder_complete (sock->rx_decoder)))
+	{
+		pgm_peer_t* peer = pgm_peertable_lookup (sock->peers_hashtable, window->tsi);
+		if (PGM_LIKELY(NULL != peer))
+			pgm_peer_set_pending (sock, peer);
+	}
+}
+
+/* datagrams left over from an earlier call were not read just now, restamp them
+ * on next use rather than reading the clock for every datagram.
+ */
+
+static inline
+void
+expire_batch_tstamp (
+	pgm_sock_t* const	sock
+	)
+{
+	if (NULL != sock->rx_batch)
+		sock->rx_batch->tstamp = 0;
+	if (NULL != sock->rx_gro)
+		sock->rx_gro->tstamp = 0;
+}
+
+/* read the next datagram from the in-memory transport, a DPDK queue, an RDMA queue pair, AF_XDP, a TPACKET_V3
+ * ring, io_uring, Registered I/O, UDP_GRO, a recvmmsg() batch or the current kernel receive socket into
+ * sock::rx_buffer.  the DPDK queue and queue pair are polled before each kernel read, steered datagrams are read
+ * first, then those passed to the kernel once is_xdp_eagain is set.
+ *
+ * returns the datagram length, or SOCKET_ERROR as the underlying read.
+ */
+
+static
+ssize_t
+recvskb_net (
+	pgm_sock_t*		 const restrict sock,
+	struct sockaddr_storage* const restrict src,
+	struct sockaddr_storage* const restrict dst,
+	bool*			 const restrict is_xdp_eagain
+	)
+{
+	if (PGM_UNLIKELY(NULL != pgm_net_shim))
+		return recvskb_shim (sock,
+				     sock->rx_buffer,		/* PGM skbuff */
+				     (struct sockaddr*)src,
+				     (struct sockaddr*)dst);
+#ifdef HAVE_RTE_ETHDEV_H
+	if (sock->dpdk) {
+		const ssize_t len = recvskb_dpdk (sock,
+						  sock->rx_buffer,	/* PGM skbuff, copied from frame */
+						  (struct sockaddr*)src,
+						  (struct sockaddr*)dst);
+		if (len >= 0 || PGM_SOCK_EAGAIN != pgm_get_last_sock_error())
+			return len;
+	}
+#endif
+#ifdef HAVE_INFINIBAND_VERBS_H
+	if (sock->verbs) {
+		const ssize_t len = recvskb_verbs (sock,
+						   sock->rx_buffer,	/* PGM skbuff, copied from receive slot */
+						   (struct sockaddr*)src,
+						   (struct sockaddr*)dst);
+		if (len >= 0 || PGM_SOCK_EAGAIN != pgm_get_last_sock_error())
+			return len;
+	}
+#endif
+#ifdef HAVE_LINUX_IF_XDP_H
+	if (sock->rx_xdp && !*is_xdp_eagain) {
+		const ssize_t len = recvskb_xdp (sock,
+						 sock->rx_buffer,	/* PGM skbuff, copied from UMEM */
+						 (struct sockaddr*)src,
+						 (struct sockaddr*)dst);
+		if (len >= 0 || PGM_SOCK_EAGAIN != pgm_get_last_sock_error())
+			return len;
+		*is_xdp_eagain = TRUE;
+	}
+#else
+	(void)is_xdp_eagain;
+#endif
+#ifdef HAVE_LINUX_IF_PACKET_H
+	if (sock->rx_tpacket)
+		return recvskb_tpacket (sock,
+					sock->rx_buffer,	/* PGM skbuff, copied from ring block */
+					(struct sockaddr*)src,
+					(struct sockaddr*)dst);
+#endif
+#ifdef HAVE_LINUX_IO_URING_H
+	if (sock->rx_uring)
+		return recvskb_uring (sock,
+				      &sock->rx_buffer,	/* PGM skbuff, exchanged with ring */
+				      0,
+				      (struct sockaddr*)src,
+				      sizeof(*src),
+				      (struct sockaddr*)dst,
+				      sizeof(*dst));
+#endif
+#ifdef PGM_HAVE_RIO
+	if (sock->rio)
+		return recvskb_rio (sock,
+				    sock->rx_buffer,	/* PGM skbuff, copied from registered region */
+				    (struct sockaddr*)src,
+				    sizeof(*src),
+				    (struct sockaddr*)dst);
+#endif
+#ifdef UDP_GRO
+	if (sock->use_udp_gro)
+		return recvskb_gro (sock,
+				    sock->rx_buffer,	/* PGM skbuff, copied from super-datagram */
+				    0,
+				    (struct sockaddr*)src,
+				    sizeof(*src),
+				    (struct sockaddr*)dst,
+				    sizeof(*dst));
+#endif
+#ifdef HAVE_RECVMMSG
+	if (sock->rx_batch_len > 1)
+		return recvskb_batch (sock,
+				      &sock->rx_buffer,	/* PGM skbuff, exchanged with batch */
+				      0,
+				      (struct sockaddr*)src,
+				      sizeof(*src),
+				      (struct sockaddr*)dst,
+				      sizeof(*dst));
+#endif
+	return recvskb (sock,
+			sock->rx_buffer,		/* PGM skbuff */
+			0,
+			(struct sockaddr*)src,
+			sizeof(*src),
+			(struct sockaddr*)dst,
+			sizeof(*dst));
+}
+
+/* read the next datagram, copies from the same-host store alternate with network reads
+ * such that SPMs and repairs are not starved, the store is read again when the network
+ * would block.  sets sock::is_rx_shm for a copied record.
+ *
+ * returns the datagram length, or SOCKET_ERROR as the underlying read.
+ */
+
+static
+ssize_t
+recvskb_next (
+	pgm_sock_t*		 const restrict sock,
+	struct sockaddr_storage* const restrict src,
+	struct sockaddr_storage* const restrict dst,
+	bool*			 const restrict is_xdp_eagain
+	)
+{
+	ssize_t len;
+
+	sock->is_rx_shm = FALSE;
+	if (PGM_LIKELY(NULL == sock->rx_shm))
+		return recvskb_net (sock, src, dst, is_xdp_eagain);
+
+	if (!sock->is_rx_shm_yield) {
+		len = recvskb_shm (sock, sock->rx_buffer, (struct sockaddr*)src, (struct sockaddr*)dst);
+		if (len > 0)
+			goto out_shm;
+	}
+	sock->is_rx_shm_yield = FALSE;
+	len = recvskb_net (sock, src, dst, is_xdp_eagain);
+	if (len >= 0 || PGM_SOCK_EAGAIN != pgm_get_last_sock_error())
+		return len;
+	len = recvskb_shm (sock, sock->rx_buffer, (struct sockaddr*)src, (struct sockaddr*)dst);
+	if (0 == len) {
+		pgm_set_last_sock_error (PGM_SOCK_EAGAIN);
+		return SOCKET_ERROR;
+	}
+out_shm:
+	sock->is_rx_shm = TRUE;
+	sock->is_rx_shm_yield = TRUE;
+	return len;
+}
+
+/* next datagram under test impairment: held datagrams once due, as received
+ * earlier, then reads of which a drawn share are lost or held.  the next timer
+ * poll is pulled forward to the first held datagram.
+ */
+
+static
+ssize_t
+recvskb_impaired (
+	pgm_sock_t*		 const restrict sock,
+	struct sockaddr_storage* const restrict src,
+	struct sockaddr_storage* const restrict dst,
+	bool*			 const restrict is_xdp_eagain
+	)
+{
+	struct pgm_sk_buff_t* skb = sock->rx_buffer;
+	const size_t held = pgm_impair_release (sock->rx_impair, pgm_time_update_now(), skb->head, sock->max_tpdu, src, dst, NULL);
+	if (held > 0) {
+		sock->is_rx_shm		= FALSE;
+		skb->sock		= sock;
+		skb->tstamp		= pgm_time_update_now();
+		skb->wire_tstamp	= skb->tstamp;
+		skb->data		= skb->head;
+		skb->len		= (uint16_t)held;
+		skb->zero_padded	= 0;
+		skb->csum_unnecessary	= 0;
+		skb->tail		= (char*)skb->data + held;
+		return (ssize_t)held;
+	}
+
+	for (;;)
+	{
+		const ssize_t len = recvskb_next (sock, src, dst, is_xdp_eagain);
+		if (len <= 0 || sock->is_rx_shm)
+			return len;
+		skb = sock->rx_buffer;
+		if (pgm_impair_apply (sock->rx_impair, skb->data, skb->len, (struct sockaddr*)src, (struct sockaddr*)dst, FALSE))
+			return len;
+		const pgm_time_t expiry = pgm_impair_expiry (sock->rx_impair);
+		if (0 != expiry) {
+			pgm_timer_lock (sock);
+			if (pgm_time_after (sock->next_poll, expiry))
+				sock->next_poll = expiry;
+			pgm_timer_unlock (sock);
+		}
+	}
+}
+
+/* upstream = receiver to source, peer-to-peer = receive to receiver
+ *
+ * NB: SPMRs can be upstream or peer-to-peer, if the packet is multicast then its
+ *     a peer-to-peer message, if its unicast its an upstream message.
+ *
+ * returns TRUE on valid processed packet, returns FALSE on discarded packet.
+ */
+
+static
+bool
+on_upstream (
+	pgm_sock_t*           const restrict sock,
+	struct pgm_sk_buff_t* const restrict skb,
+	const struct sockaddr* const restrict src_addr
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != skb);
+	pgm_assert (NULL != src_addr);
+	pgm_assert_cmpuint (skb->pgm_header->pgm_dport, ==, sock->tsi.sport);
+
+	pgm_debug ("on_upstream (sock:%p skb:%p src-addr:%p)",
+		(const void*)sock, (const void*)skb, (const void*)src_addr);
+
+	if (PGM_UNLIKELY(!sock->can_send_data)) {
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded packet for muted source."));
+		goto out_discarded;
+	}
+
+/* the primary repairs until a standby takes over */
+	if (PGM_UNLIKELY(sock->is_standby)) {
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded packet for standby source."));
+		goto out_discarded;
+	}
+
+/* unicast upstream message, note that dport & sport are reversed */
+	if (PGM_UNLIKELY(skb->pgm_header->pgm_sport != sock->dport)) {
+/* its upstream/peer-to-peer for another session */
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded packet on data-destination port mismatch."));
+		goto out_discarded;
+	}
+
+	if (PGM_UNLIKELY(!pgm_gsi_equal (&skb->tsi.gsi, &sock->tsi.gsi))) {
+/* its upstream/peer-to-peer for another session */
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded packet on data-destination port mismatch."));
+		goto out_discarded;
+	}
+
+/* advance SKB pointer to PGM type header */
+	skb->data	= (char*)skb->data + sizeof(struct pgm_header);
+	skb->len       -= sizeof(struct pgm_header);
+
+	switch (skb->pgm_header->pgm_type) {
+	case PGM_NAK:
+		if (PGM_UNLIKELY(!pgm_on_nak (sock, skb, src_addr)))
+			goto out_discarded;
+		break;
+
+	case PGM_NNAK:
+		if (PGM_UNLIKELY(!pgm_on_nnak (sock, skb)))
+			goto out_discarded;
+		break;
+
+	case PGM_SPMR:
+		if (PGM_UNLIKELY(!pgm_on_spmr (sock, NULL, skb)))
+			goto out_discarded;
+		break;
+
+	case PGM_ACK:
+		if (PGM_UNLIKELY(!pgm_on_ack (sock, skb)))
+			goto out_discarded;
+		break;
+
+	case PGM_POLR:
+	default:
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded unsupported PGM type packet."));
+		goto out_discarded;
+	}
+
+	return TRUE;
+out_discarded:
+	pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_PACKETS_DISCARDED);
+	return FALSE;
+}
+
+/* peer to peer message, either multicast NAK or multicast SPMR.
+ *
+ * returns TRUE on valid processed packet, returns FALSE on discarded packet.
+ */
+
+static
+bool
+on_peer (
+	pgm_sock_t*           const restrict sock,
+	struct pgm_sk_buff_t* const restrict skb,
+	pgm_peer_t**		    restrict source
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != skb);
+	pgm_assert_cmpuint (skb->pgm_header->pgm_dport, !=, sock->tsi.sport);
+	pgm_assert (NULL != source);
+
+	pgm_debug ("on_peer (sock:%p skb:%p source:%p)",
+		(const void*)sock, (const void*)skb, (const void*)source);
+
+/* we are not the source */
+	if (PGM_UNLIKELY(!sock->can_recv_data)) {
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded packet for muted receiver."));
+		goto out_discarded;
+	}
+
+/* unicast upstream message, note that dport & sport are reversed */
+	if (PGM_UNLIKELY(!is_rx_dport (sock, skb->pgm_header->pgm_sport))) {
+/* its upstream/peer-to-peer for another session */
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded packet on data-destination port mismatch."));
+		goto out_discarded;
+	}
+
+/* check to see the source this peer-to-peer message is about is in our peer list */
+	pgm_tsi_t upstream_tsi;
+	memcpy (&upstream_tsi.gsi, &skb->tsi.gsi, sizeof(pgm_gsi_t));
+	upstream_tsi.sport = skb->pgm_header->pgm_dport;
+
+	*source = pgm_peertable_lookup (sock->peers_hashtable, &upstream_tsi);
+	if (PGM_UNLIKELY(NULL == *source)) {
+/* this source is unknown, we don't care about messages about it */
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded peer packet about new source."));
+		goto out_discarded;
+	}
+
+/* advance SKB pointer to PGM type header */
+	skb->data	= (char*)skb->data + sizeof(struct pgm_header);
+	skb->len       -= sizeof(struct pgm_header);
+
+	switch (skb->pgm_header->pgm_type) {
+	case PGM_NAK:
+		if (PGM_UNLIKELY(!pgm_on_peer_nak (sock, *source, skb)))
+			goto out_discarded;
+/* placeholder may have armed an earlier NAK timer */
+		pgm_peer_update_expiry (sock, *source);
+		break;
+
+	case PGM_SPMR:
+		if (PGM_UNLIKELY(!pgm_on_spmr (sock, *source, skb)))
+			goto out_discarded;
+		break;
+
+	case PGM_NNAK:
+	case PGM_POLR:
+	default:
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded unsupported PGM type packet."));
+		goto out_discarded;
+	}
+
+	return TRUE;
+out_discarded:
+	if (*source)
+		pgm_stats_inc (&(*source)->cumulative_stats, PGM_PC_RECEIVER_PACKETS_DISCARDED);
+	else if (sock->can_send_data)
+		pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_PACKETS_DISCARDED);
+	return FALSE;
+}
+
+/* smallest receive size class holding a packet of len bytes.
+ *
+ * returns pool, or NULL if size classes are disabled or none is large enough.
+ */
+
+static inline
+pgm_skb_pool_t*
+size_class_pool (
+	const pgm_sock_t* const	sock,
+	const size_t		len
+	)
+{
+	for (unsigned i = 0; i < PGM_SKB_CLASSES && NULL != sock->rx_class_pool[i]; i++)
+		if (len <= sock->rx_class_pool[i]->size)
+			return sock->rx_class_pool[i];
+	return NULL;
+}
+
+/* source to receiver message
+ *
+ * returns TRUE on valid processed packet, returns FALSE on discarded packet.
+ */
+
+static
+bool
+on_downstream (
+	pgm_sock_t*           const restrict sock,
+	struct pgm_sk_buff_t* const restrict skb,
+	struct sockaddr*      const restrict src_addr,
+	struct sockaddr*      const restrict dst_addr,
+	pgm_peer_t**	  	    restrict source
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != skb);
+	pgm_assert (NULL != src_addr);
+	pgm_assert (NULL != dst_addr);
+	pgm_assert (NULL != source);
+
+#ifdef RECV_DEBUG
+	char saddr[INET6_ADDRSTRLEN], daddr[INET6_ADDRSTRLEN];
+	pgm_sockaddr_ntop (src_addr, saddr, sizeof(saddr));
+	pgm_sockaddr_ntop (dst_addr, daddr, sizeof(daddr));
+	pgm_debug ("on_downstream (sock:%p skb:%p src-addr:%s dst-addr:%s source:%p)",
+		(const void*)sock, (const void*)skb, saddr, daddr, (const void*)source);
+#endif
+
+	if (PGM_UNLIKELY(!sock->can_recv_data)) {
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded packet for muted receiver."));
+		goto out_discarded;
+	}
+
+/* pgm packet DPORT contains our sock DPORT */
+	if (PGM_UNLIKELY(!is_rx_dport (sock, skb->pgm_header->pgm_dport))) {
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded packet on data-destination port mismatch."));
+		goto out_discarded;
+	}
+
+/* search for TSI peer context or create a new one */
+	if (PGM_LIKELY(NULL != sock->last_hash_value &&
+		       0 == memcmp (&skb->tsi, &((pgm_peer_t*)sock->last_hash_value)->tsi, sizeof (pgm_tsi_t))))
+	{
+		*source = sock->last_hash_value;
+	}
+	else
+	{
+/* source owned by another shard socket, not a discard.  the cached peer above
+ * always belongs to this shard as no other peer is ever created.
+ */
+		if (!is_source_sharded (sock, &skb->tsi))
+			return FALSE;
+/* receive thread is the only writer of the peer table */
+		*source = pgm_peertable_lookup (sock->peers_hashtable, &skb->tsi);
+		if (PGM_UNLIKELY(NULL == *source)) {
+/* no peer state for filtered sources */
+			if (PGM_UNLIKELY(!is_source_wanted (sock, &skb->tsi))) {
+				pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded packet from filtered source."));
+				goto out_discarded;
+			}
+/* no new receive windows whilst the memory budget is reached */
+			if (PGM_UNLIKELY(pgm_budget_is_exceeded (&sock->budget))) {
+				pgm_trace (PGM_LOG_ROLE_SESSION,_("Refused new peer on memory budget, tsi %s"), pgm_tsi_print (&skb->tsi));
+				pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_PEERS_REFUSED);
+				goto out_discarded;
+			}
+			*source = pgm_new_peer (sock,
+					       &skb->tsi,
+					       (struct sockaddr*)src_addr, pgm_sockaddr_len(src_addr),
+					       (struct sockaddr*)dst_addr, pgm_sockaddr_len(dst_addr),
+						skb->tstamp);
+			(*source)->dport = skb->pgm_header->pgm_dport;
+		}
+		sock->last_hash_value = *source;
+	}
+
+/* a TSI is one session, the source cannot address two ports */
+	if (PGM_UNLIKELY(skb->pgm_header->pgm_dport != (*source)->dport)) {
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded packet on data-destination port mismatch."));
+		goto out_discarded;
+	}
+
+	pgm_stats_add (&(*source)->cumulative_stats, PGM_PC_RECEIVER_BYTES_RECEIVED, skb->len);
+	(*source)->last_packet = skb->tstamp;
+
+	skb->data       = (void*)( skb->pgm_header + 1 );
+	skb->len       -= sizeof(struct pgm_header);
+
+/* handle PGM packet type */
+	switch (skb->pgm_header->pgm_type) {
+	case PGM_ODATA:
+	case PGM_RDATA:
+	{
+/* small packets move to a size class skbuff, the receive buffer is recycled */
+		pgm_skb_pool_t* class_pool = (*source)->window->is_fec_available ? NULL :
+						size_class_pool (sock, (size_t)((char*)skb->tail - (char*)skb->head));
+		if (NULL != class_pool) {
+			struct pgm_sk_buff_t* copy = pgm_skb_pool_copy (class_pool, skb);
+			if (PGM_UNLIKELY(!pgm_on_data (sock, *source, copy))) {
+				pgm_free_skb (copy);
+				goto out_discarded;
+			}
+			break;
+		}
+		if (PGM_UNLIKELY(!pgm_on_data (sock, *source, skb)))
+			goto out_discarded;
+		sock->rx_buffer = pgm_skb_pool_alloc (sock->skb_pool, sock->max_tpdu);
+		break;
+	}
+
+	case PGM_NCF:
+		if (PGM_UNLIKELY(!pgm_on_ncf (sock, *source, skb)))
+			goto out_discarded;
+		break;
+
+	case PGM_SPM:
+		if (PGM_UNLIKELY(!pgm_on_spm (sock, *source, skb)))
+			goto out_discarded;
+
+/* update group NLA if appropriate */
+		if (PGM_LIKELY(pgm_sockaddr_is_addr_multicast ((struct sockaddr*)dst_addr)))
+			memcpy (&(*source)->group_nla, dst_addr, pgm_sockaddr_len(dst_addr));
+		break;
+
+	case PGM_POLL:
+		if (PGM_UNLIKELY(!pgm_on_poll (sock, *source, skb)))
+			goto out_discarded;
+		break;
+
+	default:
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded unsupported PGM type packet."));
+		goto out_discarded;
+	}
+
+/* packet may have armed an earlier NAK or ACK timer */
+	pgm_peer_update_expiry (sock, *source);
+	return TRUE;
+out_discarded:
+	if (*source)
+		pgm_stats_inc (&(*source)->cumulative_stats, PGM_PC_RECEIVER_PACKETS_DISCARDED);
+	else if (sock->can_send_data)
+		pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_PACKETS_DISCARDED);
+	return FALSE;
+}
+
+/* process a pgm packet
+ *
+ * returns TRUE on valid processed packet, returns FALSE on discarded packet.
+ */
+static
+bool
+on_pgm (
+	pgm_sock_t*           const restrict sock,
+	struct pgm_sk_buff_t* const restrict skb,
+	struct sockaddr*      const restrict src_addr,
+	struct sockaddr*      const restrict dst_addr,
+	pgm_peer_t**		    restrict source
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != skb);
+	pgm_assert (NULL != src_addr);
+	pgm_assert (NULL != dst_addr);
+	pgm_assert (NULL != source);
+
+#ifdef RECV_DEBUG
+	char saddr[INET6_ADDRSTRLEN], daddr[INET6_ADDRSTRLEN];
+	pgm_sockaddr_ntop (src_addr, saddr, sizeof(saddr));
+	pgm_sockaddr_ntop (dst_addr, daddr, sizeof(daddr));
+	pgm_debug ("on_pgm (sock:%p skb:%p src-addr:%s dst-addr:%s source:%p)",
+		(const void*)sock, (const void*)skb, saddr, daddr, (const void*)source);
+#endif
+
+	if (PGM_IS_DOWNSTREAM (skb->pgm_header->pgm_type)) {
+		PGM_PROFILE_BEGIN (downstream_start);
+		const bool is_valid = on_downstream (sock, skb, src_addr, dst_addr, source);
+		PGM_PROFILE_END (PGM_PROFILE_DOWNSTREAM, downstream_start, 1);
+		return is_valid;
+	}
+	if (skb->pgm_header->pgm_dport == sock->tsi.sport)
+	{
+		if (PGM_IS_UPSTREAM (skb->pgm_header->pgm_type) ||
+		    PGM_IS_PEER (skb->pgm_header->pgm_type))
+		{
+			return on_upstream (sock, skb, src_addr);
+		}
+	}
+	else if (PGM_IS_PEER (skb->pgm_header->pgm_type))
+		return on_peer (sock, skb, source);
+/* unicast NAK redirected to us as designated local repairer */
+	else if (PGM_NAK == skb->pgm_header->pgm_type &&
+		 sock->dlr_sqns &&
+		 !pgm_sockaddr_is_addr_multicast (dst_addr))
+		return on_peer (sock, skb, source);
+
+	pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded unknown PGM packet."));
+	if (sock->can_send_data)
+		pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_PACKETS_DISCARDED);
+	return FALSE;
+}
+
+/* peer of a PGM_CDATA packet by source address and port as the GSI is not sent,
+ * only peers announcing OPT_COMPACT are candidates.
+ */
+
+static
+pgm_peer_t*
+compact_peer (
+	pgm_sock_t*		const restrict sock,
+	const struct sockaddr*	const restrict src,
+	const uint16_t			       sport
+	)
+{
+	pgm_peer_t* peer = sock->last_hash_value;
+	if (PGM_LIKELY(NULL != peer &&
+		       peer->is_compact &&
+		       sport == peer->tsi.sport &&
+		       0 == pgm_sockaddr_cmp (src, (const struct sockaddr*)&peer->local_nla)))
+		return peer;
+	for (pgm_list_t* list = sock->peers_list; list; list = list->next) {
+		peer = list->data;
+		if (peer->is_compact &&
+		    sport == peer->tsi.sport &&
+		    0 == pgm_sockaddr_cmp (src, (const struct sockaddr*)&peer->local_nla))
+		{
+			sock->last_hash_value = peer;
+			return peer;
+		}
+	}
+	return NULL;
+}
+
+/* parse and process the datagram in sock::rx_buffer, a source with new contiguous or
+ * lost data is added to the pending list.  is_udp_encap for datagrams without an IP
+ * header.
+ *
+ * returns TRUE on valid processed packet, returns FALSE on discarded packet.
+ */
+
+static
+bool
+recv_process (
+	pgm_sock_t*		 const restrict sock,
+	struct sockaddr_storage* const restrict src,
+	struct sockaddr_storage* const restrict dst,
+	const bool			        is_udp_encap
+	)
+{
+	pgm_error_t* err = NULL;
+	struct pgm_sk_buff_t* skb = sock->rx_buffer;
+
+/* receive engines mark datagrams already verified by the UDP stack */
+	switch (sock->rx_checksum) {
+	case PGM_CHECKSUM_NEVER:
+		skb->csum_unnecessary = 1;
+		skb->csum_deferred = 0;
+		break;
+	case PGM_CHECKSUM_UDP_TRUSTED:
+		skb->csum_deferred = 0;
+		break;
+	case PGM_CHECKSUM_LAZY:
+	case PGM_CHECKSUM_DELIVERY:
+		skb->csum_unnecessary = 0;
+		skb->csum_deferred = 1;
+		break;
+	default:
+		skb->csum_unnecessary = 0;
+		skb->csum_deferred = 0;
+		break;
+	}
+
+/* same-host store records are copied from memory as sent */
+	if (sock->is_rx_shm) {
+		skb->csum_unnecessary = 1;
+		skb->csum_deferred = 0;
+	}
+
+	if (PGM_UNLIKELY(NULL != sock->capture)) {
+		const in_port_t dport = !is_udp_encap ? 0 :
+			pgm_htons (pgm_sockaddr_is_addr_multicast ((struct sockaddr*)dst) > 0 ? sock->udp_encap_mcast_port : sock->udp_encap_ucast_port);
+		pgm_capture_packet (sock->capture, FALSE, skb->data, skb->len, !is_udp_encap,
+				    (struct sockaddr*)src, (struct sockaddr*)dst,
+				    is_udp_encap ? pgm_sockaddr_port ((struct sockaddr*)src) : 0, dport);
+	}
+/* compact original data is expanded against the session of its source */
+	const pgm_peer_t* compact = NULL;
+	if (is_udp_encap &&
+	    skb->len >= sizeof(struct pgm_compact_header) &&
+	    PGM_CDATA == ((const struct pgm_compact_header*)skb->data)->pgm_type)
+	{
+		compact = compact_peer (sock, (struct sockaddr*)src, ((const struct pgm_compact_header*)skb->data)->pgm_sport);
+		if (PGM_UNLIKELY(NULL == compact)) {
+			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded compact packet of unknown session."));
+			return FALSE;
+		}
+	}
+	PGM_PROFILE_BEGIN (parse_start);
+	const bool is_valid = compact ?
+					pgm_parse_compact (skb, &compact->tsi.gsi, pgm_rxw_lead (compact->window), &err) :
+				is_udp_encap ?
+					pgm_parse_udp_encap (skb, &err) :
+					pgm_parse_raw (skb, (struct sockaddr*)dst, &err);
+	PGM_PROFILE_END (PGM_PROFILE_PARSE, parse_start, 1);
+	if (PGM_UNLIKELY(!is_valid))
+	{
+/* inherently cannot determine PGM_PC_RECEIVER_CKSUM_ERRORS unless only one receiver */
+		pgm_trace (PGM_LOG_ROLE_NETWORK,
+				_("Discarded invalid packet: %s"),
+				(err && err->message) ? err->message : "(null)");
+		if (sock->can_send_data) {
+			if (err && PGM_ERROR_CKSUM == err->code)
+				pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_CKSUM_ERRORS);
+			pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_PACKETS_DISCARDED);
+		}
+		pgm_error_free (err);
+		return FALSE;
+	}
+
+	pgm_peer_t* source = NULL;
+	if (PGM_UNLIKELY(!on_pgm (sock, skb, (struct sockaddr*)src, (struct sockaddr*)dst, &source)))
+		return FALSE;
+
+/* check whether this source has waiting data */
+	if (source && pgm_peer_has_pending (source)) {
+		pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("New pending data."));
+		pgm_peer_set_pending (sock, source);
+	}
+	return TRUE;
+}
+
+/* process one datagram read from a capture file as if received from src on dst,
+ * waking readers for new data.  caller holds sock::receiver_mutex.
+ *
+ * returns TRUE on valid processed packet, returns FALSE on discarded packet.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_recv_replay (
+	pgm_sock_t*	       const restrict sock,
+	const void*		     restrict packet,
+	const size_t			      len,
+	const struct sockaddr*	     restrict src,
+	const struct sockaddr*	     restrict dst,
+	const bool			      is_udp_encap
+	)
+{
+	struct sockaddr_storage src_addr, dst_addr;
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != packet);
+	pgm_assert (NULL != src);
+	pgm_assert (NULL != dst);
+
+	if (PGM_UNLIKELY(len > sock->max_tpdu || len < sizeof(struct pgm_header)))
+		return FALSE;
+	memcpy (&src_addr, src, pgm_sockaddr_len (src));
+	memcpy (&dst_addr, dst, pgm_sockaddr_len (dst));
+
+	struct pgm_sk_buff_t* skb = sock->rx_buffer;
+	memcpy (skb->head, packet, len);
+	skb->sock	 = sock;
+	skb->tstamp	 = pgm_time_update_now();
+	skb->wire_tstamp = skb->tstamp;
+	skb->data	 = skb->head;
+	skb->len	 = (uint16_t)len;
+	skb->zero_padded = 0;
+	skb->csum_unnecessary = 0;
+	skb->tail	 = (char*)skb->data + len;
+	const bool is_valid = recv_process (sock, &src_addr, &dst_addr, is_udp_encap);
+
+	if (sock->peers_pending && !sock->is_pending_read) {
+		pgm_notify_send (&sock->pending_notify);
+		sock->is_pending_read = TRUE;
+	}
+	return is_valid;
+}
+
+/* block on receiving socket whilst holding sock::waiting-mutex
+ * returns EAGAIN for waiting data, returns EINTR for waiting timer event,
+ * returns ENOENT on closed sock, and returns EFAULT for libc error.
+ */
+
+static
+int
+wait_for_event (
+	pgm_sock_t* const	sock
+	)
+{
+#ifdef HAVE_POLL
+	int n_fds = (int)pgm_poll_info_len (sock, POLLIN);
+#else
+	int n_fds = 0;
+#endif
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+
+	pgm_debug ("wait_for_event (sock:%p)", (const void*)sock);
+
+	do {
+		if (PGM_UNLIKELY(sock->is_destroyed))
+			return ENOENT;
+
+		if (sock->can_send_data && !pgm_txw_retransmit_is_empty (sock->window))
+/* tight loop on blocked send */
+			pgm_on_deferred_nak (sock);
+
+#ifdef HAVE_POLL
+		struct pollfd fds[ n_fds ];
+		memset (fds, 0, sizeof(fds));
+		const int status = pgm_poll_info (sock, fds, &n_fds, POLLIN);
+		pgm_assert (-1 != status);
+#else
+		fd_set readfds;
+		FD_ZERO(&readfds);
+		const int status = pgm_select_info (sock, &readfds, NULL, &n_fds);
+		pgm_assert (-1 != status);
+#endif /* HAVE_POLL */
+
+/* flush any waiting notifications */
+		if (sock->is_pending_read) {
+			pgm_notify_clear (&sock->pending_notify);
+			sock->is_pending_read = FALSE;
+		}
+/* decoder notification may have been flushed with them */
+		if (NULL != sock->rx_decoder && pgm_rxw_decoder_is_pending (sock->rx_decoder))
+			return EAGAIN;
+
+		int timeout;
+		if (sock->can_send_data && !pgm_txw_retransmit_is_empty (sock->window))
+			timeout = 0;
+		else
+			timeout = (int)pgm_timer_expiration (sock);
+
+#ifdef HAVE_POLL
+/* busy-poll: spin on readiness for the budget before sleeping, bounded by the next timer */
+		if (sock->busy_poll_usecs > 0 && timeout > 0)
+		{
+			const pgm_time_t spin_expiry = pgm_time_update_now() + MIN((unsigned)timeout, sock->busy_poll_usecs);
+			do {
+				const int ready = poll (fds, n_fds, 0);
+				if (PGM_UNLIKELY(SOCKET_ERROR == ready)) {
+					pgm_debug ("busy-poll returned errno=%i",errno);
+					return EFAULT;
+				} else if (ready > 0) {
+					pgm_debug ("recv again on busy-poll");
+					return EAGAIN;
+				}
+			} while (pgm_time_after (spin_expiry, pgm_time_update_now()));
+			timeout = (int)pgm_timer_expiration (sock);
+		}
+#endif /* HAVE_POLL */
+		
+#ifdef HAVE_PPOLL
+		const struct timespec ts_timeout = {
+			.tv_sec		= timeout / 1000000L,
+			.tv_nsec	= (timeout % 1000000L) * 1000L
+		};
+		const int ready = ppoll (fds, n_fds, &ts_timeout, NULL);
+#elif defined( HAVE_POLL )
+		const int ready = poll (fds, n_fds, timeout /* μs */ / 1000 /* to ms */);
+#else
+		struct timeval tv_timeout = {
+			.tv_sec		= timeout > 1000000L ? (timeout / 1000000L) : 0,
+			.tv_usec	= timeout > 1000000L ? (timeout % 1000000L) : timeout
+		};
+		const int ready = select (n_fds, &readfds, NULL, NULL, &tv_timeout);
+#endif /* HAVE_POLL */
+		if (PGM_UNLIKELY(SOCKET_ERROR == ready)) {
+			pgm_debug ("block returned errno=%i",errno);
+			return EFAULT;
+		} else if (ready > 0) {
+			pgm_debug ("recv again on empty");
+			return EAGAIN;
+		}
+	} while (!pgm_timer_check (sock));
+	pgm_debug ("state generated event");
+	return EINTR;
+}
+
+/* send repairs queued by NAKs, once the queue is drained clear the repair notification.
+ *
+ * returns FALSE on rate limited send.
+ */
+
+static
+bool
+recv_repair (
+	pgm_sock_t* const	sock
+	)
+{
+	if (!pgm_txw_retransmit_is_empty (sock->window))
+		return pgm_on_deferred_nak (sock);
+	pgm_notify_clear (&sock->rdata_notify);
+/* FEC worker may publish parity between the test and the clear */
+	if (sock->use_fec_worker &&
+	    !pgm_txw_retransmit_is_empty (sock->window))
+		pgm_notify_send (&sock->rdata_notify);
+	return TRUE;
+}
+
+#if defined( HAVE_POLL ) && !defined( _WIN32 )
+/* timer thread: runs timers and repairs and reads the receive sockets into the receive
+ * windows whilst the application is outside of a receive call.  the receiver lock is
+ * held for at most this many datagrams so an application receive waits only briefly.
+ */
+#define PGM_TIMER_THREAD_BUDGET		64
+
+/* APDUs per call of a delivery callback */
+#define PGM_DELIVERY_BATCH		64
+
+struct pgm_timer_thread_t {
+	volatile bool			is_shutdown;
+	pthread_t			thread;
+};
+
+static unsigned verify_deferred_msgv (pgm_sock_t*const restrict, struct pgm_msgv_t*const restrict, const unsigned, size_t*const restrict);
+
+/* hand complete APDUs to the delivery callback of the socket in batches whilst holding
+ * sock::receiver-mutex, skbuffs of a batch are committed on the following batch as the
+ * callback has returned.  loss of a source is one call with its tsi and no messages.
+ *
+ * with a handoff ring each APDU is published holding references on its skbuffs instead,
+ * skbuffs given back by consumers are first returned to the pools.  a full ring leaves
+ * the remaining data in the receive windows until a consumer wakes the timer thread.
+ */
+
+static
+void
+recv_deliver (
+	pgm_sock_t* const	sock
+	)
+{
+	struct pgm_msgv_t msgv[PGM_DELIVERY_BATCH];
+	const struct pgm_delivery_req_t* dr = &sock->delivery_req;
+	struct pgm_handoff_t* handoff = sock->handoff;
+	bool is_published = FALSE;
+
+	if (NULL != handoff)
+		pgm_handoff_reclaim (handoff);
+
+	while (!sock->is_delivery_stopped)
+	{
+		unsigned space = PGM_DELIVERY_BATCH;
+		if (NULL != handoff) {
+			space = MIN(space, pgm_handoff_space (handoff));
+/* mark blocked then look again, a consumer taking in between is either seen or wakes us */
+			if (0 == space) {
+				(void)pgm_atomic_exchange32 (&handoff->is_blocked, 1);
+				space = MIN(PGM_DELIVERY_BATCH, pgm_handoff_space (handoff));
+				if (0 == space)
+					break;
+			}
+		}
+
+		if (PGM_UNLIKELY(sock->is_reset)) {
+			pgm_assert (NULL != sock->peers_pending);
+			pgm_assert (NULL != sock->peers_pending->data);
+			const pgm_peer_t* peer = sock->peers_pending->data;
+			if (NULL != handoff) {
+				const struct pgm_msgv_t loss = { .msgv_len = 0 };
+				pgm_handoff_publish (handoff, &loss, &peer->tsi);
+				is_published = TRUE;
+			} else
+				dr->dr_func (NULL, 0, &peer->tsi, dr->dr_user_data);
+			if (sock->is_abort_on_reset)
+				sock->is_delivery_stopped = TRUE;
+			else
+				sock->is_reset = FALSE;
+			continue;
+		}
+
+		if (PGM_UNLIKELY(0 == ++(sock->last_commit)))
+			++(sock->last_commit);
+		recv_fec_complete (sock);
+		if (NULL == sock->peers_pending)
+			break;
+
+		struct pgm_msgv_t* pmsg = msgv;
+		size_t bytes_read = 0;
+		unsigned data_read = 0;
+		const int status = pgm_flush_peers_pending (sock, &pmsg, msgv + space - 1, &bytes_read, &data_read);
+		unsigned msg_count = (unsigned)(pmsg - msgv);
+		if (PGM_UNLIKELY(PGM_CHECKSUM_DELIVERY == sock->rx_checksum) && msg_count > 0)
+			msg_count = verify_deferred_msgv (sock, msgv, msg_count, &bytes_read);
+		if (PGM_UNLIKELY(NULL != sock->recorder))
+			pgm_recorder_append (sock->recorder, msgv, msg_count);
+		if (NULL != handoff) {
+			for (unsigned i = 0; i < msg_count; i++)
+				pgm_handoff_publish (handoff, &msgv[i], NULL);
+			is_published |= (msg_count > 0);
+		} else if (msg_count > 0)
+			dr->dr_func (msgv, msg_count, NULL, dr->dr_user_data);
+/* all contiguous data delivered */
+		if (0 == status)
+			break;
+	}
+
+/* wake consumers that found the ring empty */
+	if (is_published &&
+	    pgm_atomic_read32 (&handoff->is_waiting) &&
+	    pgm_atomic_exchange32 (&handoff->is_waiting, 0))
+	{
+		pgm_notify_send (&sock->handoff_notify);
+	}
+}
+
+/* one pass of the timer thread whilst holding sock::receiver-mutex: dispatch expired
+ * timers, send queued repairs, and process waiting datagrams.  the application is woken
+ * on the pending notification to collect contiguous data or report loss, unless a
+ * delivery callback or handoff ring takes the data in the same pass.
+ *
+ * returns TRUE if datagrams may remain unread.
+ */
+
+static
+bool
+recv_pump (
+	pgm_sock_t* const	sock
+	)
+{
+	struct sockaddr_storage src, dst;
+	unsigned budget = PGM_TIMER_THREAD_BUDGET;
+	unsigned recv_sock_eagain = 0;
+	bool is_xdp_eagain = FALSE;
+
+	expire_batch_tstamp (sock);
+	if (pgm_timer_check (sock))
+		(void)pgm_timer_dispatch (sock);
+	if (sock->can_send_data)
+		(void)recv_repair (sock);
+
+	while (budget > 0)
+	{
+		PGM_PROFILE_BEGIN (recv_start);
+		const ssize_t len = PGM_UNLIKELY(NULL != sock->rx_impair) ?
+					recvskb_impaired (sock, &src, &dst, &is_xdp_eagain) :
+					recvskb_next (sock, &src, &dst, &is_xdp_eagain);
+		PGM_PROFILE_END (PGM_PROFILE_RECVSKB, recv_start, len > 0);
+		if (len < 0) {
+			if (PGM_SOCK_EAGAIN == pgm_get_last_sock_error() &&
+			    recv_sock_eagain++ < sock->recv_sock_extra_len)
+			{
+				next_recv_sock (sock);
+				continue;
+			}
+			break;
+		}
+		if (0 == len)
+			break;
+		budget--;
+		recv_sock_eagain = 0;
+		is_xdp_eagain = FALSE;
+		if (sock->recv_sock_extra_len > 0)
+			next_recv_sock (sock);
+		(void)recv_process (sock, &src, &dst, sock->udp_encap_ucast_port || AF_INET6 == src.ss_family);
+	}
+
+/* complete APDUs go straight to the application without a wakeup */
+	if (NULL != sock->delivery_req.dr_func || NULL != sock->handoff) {
+		recv_deliver (sock);
+		return (0 == budget || is_batch_pending (sock));
+	}
+
+	if (sock->peers_pending && !sock->is_pending_read) {
+		pgm_notify_send (&sock->pending_notify);
+		sock->is_pending_read = TRUE;
+	}
+	return (0 == budget || is_batch_pending (sock));
+}
+
+/* wait on the receive sockets, repair notification and timer thread channel until the next
+ * timer expiration, the application pending notification is not watched as it remains set
+ * until the application reads.
+ */
+
+static
+void*
+pgm_timer_thread_routine (
+	void*			arg
+	)
+{
+	pgm_sock_t* const sock = (pgm_sock_t*)arg;
+	struct pgm_timer_thread_t* const timer_thread = sock->timer_thread;
+	const int max_fds = (int)pgm_poll_info_len (sock, POLLIN);
+	struct pollfd fds[ max_fds ];
+	bool is_pending = FALSE;
+
+	pgm_affinity_apply (PGM_THREAD_TIMER);
+
+	while (!timer_thread->is_shutdown)
+	{
+		if (!is_pending)
+		{
+			int n_fds = max_fds, timeout;
+			memset (fds, 0, sizeof(fds));
+			if (SOCKET_ERROR == pgm_poll_info (sock, fds, &n_fds, POLLIN)) {
+/* closing, wait for shutdown */
+				n_fds = 0;
+				timeout = -1;
+			} else {
+				n_fds--;
+				if (sock->can_send_data && !pgm_txw_retransmit_is_empty (sock->window))
+					timeout = 0;
+				else
+					timeout = (int)pgm_timer_expiration (sock);
+			}
+			fds[n_fds].fd = pgm_notify_get_socket (&sock->timer_notify);
+			fds[n_fds].events = POLLIN;
+			fds[n_fds].revents = 0;
+			n_fds++;
+#ifdef HAVE_PPOLL
+			const struct timespec ts_timeout = {
+				.tv_sec		= timeout / 1000000L,
+				.tv_nsec	= (timeout % 1000000L) * 1000L
+			};
+			(void)ppoll (fds, n_fds, timeout < 0 ? NULL : &ts_timeout, NULL);
+#else
+			(void)poll (fds, n_fds, timeout < 0 ? -1 : timeout /* μs */ / 1000 /* to ms */);
+#endif
+		}
+		pgm_notify_clear (&sock->timer_notify);
+		if (timer_thread->is_shutdown)
+			break;
+		is_pending = FALSE;
+		if (!pgm_sock_reader_trylock (sock))
+			continue;
+		if (!sock->is_destroyed) {
+			pgm_sock_mutex_lock (sock, &sock->receiver_mutex);
+			is_pending = recv_pump (sock);
+			pgm_sock_mutex_unlock (sock, &sock->receiver_mutex);
+		}
+		pgm_sock_reader_unlock (sock);
+	}
+	return NULL;
+}
+
+#ifdef HAVE_EPOLL_CTL
+/* timer pool: sockets with PGM_TIMER_POOL share threads each waiting on one epoll set for
+ * the receive sockets and notification channels of its sockets.  a thread is added per
+ * PGM_TIMER_POOL_SOCKS sockets up to the processor count, each pass scans the timers of
+ * its sockets.  membership is serialised by pgm_sock_list_lock.
+ */
+#define PGM_TIMER_POOL_SOCKS		64
+#define PGM_TIMER_POOL_MAX_THREADS	16
+#define PGM_TIMER_POOL_EVENTS		64
+
+struct pgm_timer_pool_sock_t {
+	pgm_list_t			link_;
+	pgm_sock_t*			sock;
+	struct pgm_timer_pool_thread_t*	thread;
+	bool				is_ready;		/* epoll event */
+	bool				is_pending;		/* datagrams remain */
+};
+
+struct pgm_timer_pool_thread_t {
+	int				epfd;
+	pgm_notify_t			notify;			/* membership and shutdown */
+	pgm_mutex_t			mutex;
+	pgm_queue_t			socks;
+	uint32_t			generation;		/* advanced as sockets leave */
+	bool				is_shutdown;
+	pthread_t			thread;
+};
+
+static struct pgm_timer_pool_thread_t* pgm_timer_pool[ PGM_TIMER_POOL_MAX_THREADS ];
+static unsigned pgm_timer_pool_len = 0;
+
+/* one pass for a pool socket, skipped whilst the application holds the receiver lock as
+ * that receive call runs the timers itself, and so one socket cannot stall the pool.
+ */
+
+static
+void
+pgm_timer_pool_pump (
+	struct pgm_timer_pool_sock_t* const	member
+	)
+{
+	pgm_sock_t* const sock = member->sock;
+
+	member->is_pending = FALSE;
+	if (!pgm_rwlock_reader_trylock (&sock->lock))
+		return;
+	if (!sock->is_destroyed &&
+	    pgm_mutex_trylock (&sock->receiver_mutex))
+	{
+		member->is_pending = recv_pump (sock);
+		pgm_mutex_unlock (&sock->receiver_mutex);
+	}
+	pgm_rwlock_reader_unlock (&sock->lock);
+}
+
+/* pool thread: pass over every socket with an event, expired timer, queued repair or
+ * unread datagrams then wait for the earliest timer of any.  events carry the socket
+ * membership and are void when a socket has left since the wait began.
+ */
+
+static
+void*
+pgm_timer_pool_routine (
+	void*			arg
+	)
+{
+	struct pgm_timer_pool_thread_t* const thread = (struct pgm_timer_pool_thread_t*)arg;
+	struct epoll_event events[ PGM_TIMER_POOL_EVENTS ];
+	int ready = 0;
+
+	pgm_affinity_apply (PGM_THREAD_TIMER);
+
+	pgm_mutex_lock (&thread->mutex);
+	uint32_t generation = thread->generation;
+	while (!thread->is_shutdown)
+	{
+		const bool is_valid = (generation == thread->generation);
+		pgm_notify_clear (&thread->notify);
+		for (int i = 0; is_valid && i < ready; i++) {
+			struct pgm_timer_pool_sock_t* member = (struct pgm_timer_pool_sock_t*)events[i].data.ptr;
+			if (NULL != member)
+				member->is_ready = TRUE;
+		}
+
+		int timeout = -1;
+		for (pgm_list_t* link = thread->socks.head; NULL != link; link = link->next)
+		{
+			struct pgm_timer_pool_sock_t* member = (struct pgm_timer_pool_sock_t*)link;
+			pgm_sock_t* sock = member->sock;
+			if (member->is_ready || !is_valid)
+				pgm_notify_clear (&sock->timer_notify);
+			if (member->is_ready || !is_valid || member->is_pending ||
+			    pgm_timer_check (sock) ||
+			    (sock->can_send_data && !pgm_txw_retransmit_is_empty (sock->window)))
+			{
+				pgm_timer_pool_pump (member);
+			}
+			member->is_ready = FALSE;
+
+			int msecs;
+			if (member->is_pending ||
+			    (sock->can_send_data && !pgm_txw_retransmit_is_empty (sock->window)))
+				msecs = 0;
+			else
+				msecs = (int)MIN((pgm_timer_expiration (sock) + 999) / 1000, INT32_MAX);
+			if (timeout < 0 || msecs < timeout)
+				timeout = msecs;
+		}
+		generation = thread->generation;
+		pgm_mutex_unlock (&thread->mutex);
+		ready = epoll_wait (thread->epfd, events, PGM_TIMER_POOL_EVENTS, timeout);
+		pgm_mutex_lock (&thread->mutex);
+	}
+	pgm_mutex_unlock (&thread->mutex);
+	return NULL;
+}
+
+static
+struct pgm_timer_pool_thread_t*
+pgm_timer_pool_thread_new (void)
+{
+	struct pgm_timer_pool_thread_t* thread = pgm_new0 (struct pgm_timer_pool_thread_t, 1);
+	struct epoll_event event;
+
+	thread->epfd = epoll_create (PGM_TIMER_POOL_SOCKS);
+	if (-1 == thread->epfd)
+		goto err_free;
+	if (0 != pgm_notify_init (&thread->notify))
+		goto err_close;
+	memset (&event, 0, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.ptr = NULL;
+	if (0 != epoll_ctl (thread->epfd, EPOLL_CTL_ADD, pgm_notify_get_socket (&thread->notify), &event))
+		goto err_notify;
+	pgm_mutex_init (&thread->mutex);
+	if (0 != pthread_create (&thread->thread, NULL, &pgm_timer_pool_routine, thread)) {
+		pgm_mutex_free (&thread->mutex);
+		goto err_notify;
+	}
+	return thread;
+
+err_notify:
+	pgm_notify_destroy (&thread->notify);
+err_close:
+	close (thread->epfd);
+err_free:
+	pgm_free (thread);
+	return NULL;
+}
+
+static
+void
+pgm_timer_pool_thread_destroy (
+	struct pgm_timer_pool_thread_t* const	thread
+	)
+{
+	pgm_assert (pgm_queue_is_empty (&thread->socks));
+
+	pgm_mutex_lock (&thread->mutex);
+	thread->is_shutdown = TRUE;
+	pgm_mutex_unlock (&thread->mutex);
+	pgm_notify_send (&thread->notify);
+	pthread_join (thread->thread, NULL);
+	pgm_mutex_free (&thread->mutex);
+	pgm_notify_destroy (&thread->notify);
+	close (thread->epfd);
+	pgm_free (thread);
+}
+
+/* remove the notification channels and offload sockets that remain open after the
+ * kernel receive sockets close, closed descriptors leave the epoll set by themselves.
+ */
+
+static
+void
+pgm_timer_pool_unregister (
+	struct pgm_timer_pool_sock_t* const	member
+	)
+{
+	pgm_sock_t* const sock = member->sock;
+	const int epfd = member->thread->epfd;
+	struct epoll_event event;
+
+	memset (&event, 0, sizeof(event));
+	if (sock->can_send_data)
+		epoll_ctl (epfd, EPOLL_CTL_DEL, pgm_notify_get_socket (&sock->rdata_notify), &event);
+	epoll_ctl (epfd, EPOLL_CTL_DEL, pgm_notify_get_socket (&sock->timer_notify), &event);
+#ifdef HAVE_LINUX_IO_URING_H
+	if (sock->rx_uring)
+		epoll_ctl (epfd, EPOLL_CTL_DEL, pgm_recv_uring_get_socket (sock->rx_uring), &event);
+#endif
+#ifdef HAVE_LINUX_IF_XDP_H
+	if (sock->rx_xdp)
+		epoll_ctl (epfd, EPOLL_CTL_DEL, pgm_recv_xdp_get_socket (sock->rx_xdp), &event);
+#endif
+#ifdef HAVE_INFINIBAND_VERBS_H
+	if (sock->verbs)
+		epoll_ctl (epfd, EPOLL_CTL_DEL, pgm_verbs_get_socket (sock->verbs), &event);
+#endif
+#ifdef HAVE_LINUX_IF_PACKET_H
+	if (sock->rx_tpacket)
+		epoll_ctl (epfd, EPOLL_CTL_DEL, pgm_recv_tpacket_get_socket (sock->rx_tpacket), &event);
+#endif
+}
+
+/* add a bound sock to the least loaded pool thread, or a new thread whilst all are at
+ * PGM_TIMER_POOL_SOCKS and the processor count allows.
+ *
+ * returns TRUE on success, returns FALSE if no thread or epoll set is available.
+ */
+
+static
+bool
+pgm_timer_pool_join (
+	pgm_sock_t* const	sock
+	)
+{
+	struct pgm_timer_pool_thread_t* thread = NULL;
+	const int max_fds = (int)pgm_poll_info_len (sock, POLLIN);
+	struct pollfd fds[ max_fds ];
+	int n_fds = max_fds;
+	struct epoll_event event;
+
+	if (SOCKET_ERROR == pgm_poll_info (sock, fds, &n_fds, POLLIN))
+		return FALSE;
+/* replace the application pending notification with the timer thread channel */
+	fds[n_fds - 1].fd = pgm_notify_get_socket (&sock->timer_notify);
+
+	pgm_rwlock_writer_lock (&pgm_sock_list_lock);
+	for (unsigned i = 0; i < pgm_timer_pool_len; i++)
+		if (NULL == thread || pgm_timer_pool[i]->socks.length < thread->socks.length)
+			thread = pgm_timer_pool[i];
+	if (NULL == thread ||
+	    (thread->socks.length >= PGM_TIMER_POOL_SOCKS &&
+	     pgm_timer_pool_len < (unsigned)MIN(MAX(1, pgm_get_nprocs()), PGM_TIMER_POOL_MAX_THREADS)))
+	{
+		struct pgm_timer_pool_thread_t* new_thread = pgm_timer_pool_thread_new ();
+		if (NULL != new_thread)
+			thread = pgm_timer_pool[ pgm_timer_pool_len++ ] = new_thread;
+		else if (NULL == thread) {
+			pgm_rwlock_writer_unlock (&pgm_sock_list_lock);
+			return FALSE;
+		}
+	}
+
+	struct pgm_timer_pool_sock_t* member = pgm_new0 (struct pgm_timer_pool_sock_t, 1);
+	member->sock	= sock;
+	member->thread	= thread;
+	memset (&event, 0, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.ptr = member;
+	for (int i = 0; i < n_fds; i++)
+	{
+		if (0 != epoll_ctl (thread->epfd, EPOLL_CTL_ADD, fds[i].fd, &event)) {
+			while (i--)
+				epoll_ctl (thread->epfd, EPOLL_CTL_DEL, fds[i].fd, &event);
+			pgm_free (member);
+			pgm_rwlock_writer_unlock (&pgm_sock_list_lock);
+			return FALSE;
+		}
+	}
+	pgm_mutex_lock (&thread->mutex);
+	pgm_queue_push_head_link (&thread->socks, &member->link_);
+	pgm_mutex_unlock (&thread->mutex);
+/* recalculate the next timer */
+	pgm_notify_send (&thread->notify);
+	sock->timer_pool_sock = member;
+	pgm_rwlock_writer_unlock (&pgm_sock_list_lock);
+	return TRUE;
+}
+
+/* remove a sock from its pool thread, the last sock out stops the thread.
+ */
+
+static
+void
+pgm_timer_pool_leave (
+	pgm_sock_t* const	sock
+	)
+{
+	struct pgm_timer_pool_sock_t* const member = sock->timer_pool_sock;
+	struct pgm_timer_pool_thread_t* const thread = member->thread;
+
+	pgm_rwlock_writer_lock (&pgm_sock_list_lock);
+/* no new events for the member once unregistered, those already returned are voided */
+	pgm_timer_pool_unregister (member);
+	pgm_mutex_lock (&thread->mutex);
+	pgm_queue_unlink (&thread->socks, &member->link_);
+	thread->generation++;
+	pgm_mutex_unlock (&thread->mutex);
+	pgm_free (member);
+	sock->timer_pool_sock = NULL;
+
+	if (pgm_queue_is_empty (&thread->socks)) {
+		for (unsigned i = 0; i < pgm_timer_pool_len; i++)
+			if (thread == pgm_timer_pool[i]) {
+				pgm_timer_pool[i] = pgm_timer_pool[ --pgm_timer_pool_len ];
+				break;
+			}
+		pgm_timer_pool_thread_destroy (thread);
+	}
+	pgm_rwlock_writer_unlock (&pgm_sock_list_lock);
+}
+#endif /* HAVE_EPOLL_CTL */
+#endif /* defined( HAVE_POLL ) && !defined( _WIN32 ) */
+
+/* start the timer thread of a bound sock, woken by sock::timer-notify.  with
+ * PGM_TIMER_POOL the sock joins the shared pool, falling back to a dedicated thread.
+ *
+ * returns TRUE on success, returns FALSE if the thread cannot be created or the platform
+ * has no poll().
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_timer_thread_start (
+	pgm_sock_t* const	sock
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (sock->is_bound);
+	pgm_assert (NULL == sock->timer_thread);
+	pgm_assert (NULL == sock->timer_pool_sock);
+	pgm_assert (pgm_notify_is_valid (&sock->timer_notify));
+
+#if defined( HAVE_POLL ) && !defined( _WIN32 )
+#	ifdef HAVE_EPOLL_CTL
+	if (sock->use_timer_pool) {
+		if (pgm_timer_pool_join (sock))
+			return TRUE;
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Timer pool not available, starting dedicated timer thread."));
+		sock->use_timer_pool = FALSE;
+	}
+#	else
+	sock->use_timer_pool = FALSE;
+#	endif
+	sock->timer_thread = pgm_new0 (struct pgm_timer_thread_t, 1);
+	if (0 != pthread_create (&sock->timer_thread->thread, NULL, &pgm_timer_thread_routine, sock)) {
+		pgm_free (sock->timer_thread);
+		sock->timer_thread = NULL;
+		return FALSE;
+	}
+	return TRUE;
+#else
+	return FALSE;
+#endif
+}
+
+/* stop the timer thread, called with sock::lock held for writing so the thread is outside
+ * of any pass.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_timer_thread_stop (
+	pgm_sock_t* const	sock
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != sock->timer_thread || NULL != sock->timer_pool_sock);
+
+#ifdef HAVE_EPOLL_CTL
+	if (sock->timer_pool_sock) {
+		pgm_timer_pool_leave (sock);
+		return;
+	}
+#endif
+#if defined( HAVE_POLL ) && !defined( _WIN32 )
+	sock->timer_thread->is_shutdown = TRUE;
+	pgm_notify_send (&sock->timer_notify);
+	pthread_join (sock->timer_thread->thread, NULL);
+#endif
+	pgm_free (sock->timer_thread);
+	sock->timer_thread = NULL;
+}
+
+/* serve a closing source until expiry or notify is signalled: NAKs are answered
+ * with repairs, SPMs and other timers dispatched as by the timer thread, which
+ * when running does so itself.  Received data is left unread in the windows.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_linger (
+	pgm_sock_t*   const restrict sock,
+	pgm_notify_t* const restrict notify,
+	const pgm_time_t	     expiry
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != notify);
+
+#if defined( HAVE_POLL ) && !defined( _WIN32 )
+	const bool has_timer_thread = (NULL != sock->timer_thread || NULL != sock->timer_pool_sock);
+	const int max_fds = (int)pgm_poll_info_len (sock, POLLIN);
+	struct pollfd fds[ max_fds ];
+	bool is_pending = FALSE;
+
+	for (;;)
+	{
+		const pgm_time_t now = pgm_time_update_now();
+		if (pgm_time_after_eq (now, expiry))
+			break;
+		if (!is_pending)
+		{
+			int n_fds = max_fds, timeout = (int)MIN(expiry - now, (pgm_time_t)INT_MAX);
+			memset (fds, 0, sizeof(fds));
+			if (has_timer_thread ||
+			    SOCKET_ERROR == pgm_poll_info (sock, fds, &n_fds, POLLIN))
+			{
+				n_fds = 0;
+			} else {
+/* not the application pending notification */
+				n_fds--;
+				if (sock->can_send_data && !pgm_txw_retransmit_is_empty (sock->window))
+					timeout = 0;
+				else
+					timeout = (int)MIN((pgm_time_t)timeout, (pgm_time_t)pgm_timer_expiration (sock));
+			}
+			fds[n_fds].fd = pgm_notify_get_socket (notify);
+			fds[n_fds].events = POLLIN;
+			fds[n_fds].revents = 0;
+			n_fds++;
+#ifdef HAVE_PPOLL
+			const struct timespec ts_timeout = {
+				.tv_sec		= timeout / 1000000L,
+				.tv_nsec	= (timeout % 1000000L) * 1000L
+			};
+			(void)ppoll (fds, n_fds, &ts_timeout, NULL);
+#else
+			(void)poll (fds, n_fds, timeout /* μs */ / 1000 /* to ms */);
+#endif
+			if (fds[n_fds - 1].revents & POLLIN)
+				break;
+		}
+		is_pending = FALSE;
+		if (has_timer_thread ||
+		    !pgm_sock_reader_trylock (sock))
+			continue;
+		pgm_sock_mutex_lock (sock, &sock->receiver_mutex);
+		is_pending = recv_pump (sock);
+		pgm_sock_mutex_unlock (sock, &sock->receiver_mutex);
+		pgm_sock_reader_unlock (sock);
+	}
+#else
+	(void)expiry;
+	pgm_trace (PGM_LOG_ROLE_NETWORK,_("Linger not available on this platform."));
+#endif
+}
+
+/* verify checksums deferred to delivery for callers handed window skbuffs directly,
+ * corrupt APDUs are removed from the vector.
+ *
+ * returns count of APDUs remaining.
+ */
+
+static
+unsigned
+verify_deferred_msgv (
+	pgm_sock_t*	   const restrict sock,
+	struct pgm_msgv_t* const restrict msg_start,
+	const unsigned			  msg_count,
+	size_t*		   const restrict bytes_read
 	)
 {
-	int n_fds = 3;
+	unsigned kept = 0;
 
 /* pre-conditions */
 	pgm_assert (NULL != sock);
+	pgm_assert (NULL != msg_start);
+	pgm_assert (NULL != bytes_read);
 
-	pgm_debug ("wait_for_event (sock:%p)", (const void*)sock);
-
-	do {
-		if (PGM_UNLIKELY(sock->is_destroyed))
-			return ENOENT;
-
-		if (sock->can_send_data && !pgm_txw_retransmit_is_empty (sock->window))
-/* tight loop on blocked send */
-			pgm_on_deferred_nak (sock);
-
-#ifdef HAVE_POLL
-		struct pollfd fds[ n_fds ];
-		memset (fds, 0, sizeof(fds));
-		const int status = pgm_poll_info (sock, fds, &n_fds, POLLIN);
-		pgm_assert (-1 != status);
-#else
-		fd_set readfds;
-		FD_ZERO(&readfds);
-		const int status = pgm_select_info (sock, &readfds, NULL, &n_fds);
-		pgm_assert (-1 != status);
-#endif /* HAVE_POLL */
-
-/* flush any waiting notifications */
-		if (sock->is_pending_read) {
-			pgm_notify_clear (&sock->pending_notify);
-			sock->is_pending_read = FALSE;
+	for (unsigned i = 0; i < msg_count; i++)
+	{
+		struct pgm_msgv_t* msgv = &msg_start[ i ];
+		size_t apdu_len = 0;
+		bool is_valid = TRUE;
+		for (unsigned j = 0; j < msgv->msgv_len; j++) {
+			struct pgm_sk_buff_t* skb = msgv->msgv_skb[ j ];
+			apdu_len += skb->len;
+			if (skb->csum_deferred && !pgm_verify_checksum (skb))
+				is_valid = FALSE;
 		}
-
-		int timeout;
-		if (sock->can_send_data && !pgm_txw_retransmit_is_empty (sock->window))
-			timeout = 0;
-		else
-			timeout = (int)pgm_timer_expiration (sock);
-		
-#ifdef HAVE_POLL
-		const int ready = poll (fds, n_fds, timeout /* μs */ / 1000 /* to ms */);
-#else
-		struct timeval tv_timeout = {
-			.tv_sec		= timeout > 1000000L ? (timeout / 1000000L) : 0,
-			.tv_usec	= timeout > 1000000L ? (timeout % 1000000L) : timeout
-		};
-		const int ready = select (n_fds, &readfds, NULL, NULL, &tv_timeout);
-#endif /* HAVE_POLL */
-		if (PGM_UNLIKELY(SOCKET_ERROR == ready)) {
-			pgm_debug ("block returned errno=%i",errno);
-			return EFAULT;
-		} else if (ready > 0) {
-			pgm_debug ("recv again on empty");
-			return EAGAIN;
+		if (PGM_UNLIKELY(!is_valid)) {
+			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded APDU with checksum mismatch."));
+			pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_CKSUM_ERRORS);
+			*bytes_read -= apdu_len;
+			continue;
 		}
-	} while (pgm_timer_check (sock));
-	pgm_debug ("state generated event");
-	return EINTR;
+		if (kept != i) {
+			msg_start[ kept ].msgv_len = msgv->msgv_len;
+			memcpy (msg_start[ kept ].msgv_skb, msgv->msgv_skb, msgv->msgv_len * sizeof(struct pgm_sk_buff_t*));
+		}
+		kept++;
+	}
+	return kept;
 }
 
-/* data incoming on receive sockets, can be from a sender or receiver, or simply bogus.
- * for IPv4 we receive the IP header to handle fragmentation, for IPv6 we cannot, but the
- * underlying stack handles this for us.
- *
- * recvmsgv reads a vector of apdus each contained in a IO scatter/gather array.
- *
- * can be called due to event from incoming socket(s) or timer induced data loss.
- *
- * On success, returns PGM_IO_STATUS_NORMAL and saves the count of bytes read
- * into _bytes_read.  With non-blocking sockets a block returns
- * PGM_IO_STATUS_WOULD_BLOCK.  When rate limited sending repair data, returns
- * PGM_IO_STATUS_RATE_LIMITED and caller should wait.  During recovery state,
- * returns PGM_IO_STATUS_TIMER_PENDING and caller should also wait.  On
- * unrecoverable dataloss, returns PGM_IO_STATUS_CONN_RESET.  If connection is
- * closed, returns PGM_IO_STATUS_EOF.  On error, returns PGM_IO_STATUS_ERROR.
+/* recvmsgv with is_deferred_copy, the caller verifies checksums deferred to delivery
+ * whilst copying out of the window, as pgm_recvfrom().
  */
 
+static
 int
-pgm_recvmsgv (
+recvmsgv (
 	pgm_sock_t*   	   const restrict sock,
 	struct pgm_msgv_t* const restrict msg_start,
 	const size_t			  msg_len,
-	const int			  flags,	/* MSG_DONTWAIT for non-blocking */
-	size_t*			 restrict _bytes_read,	/* may be NULL */
+	const int			  flags,
+	size_t*			 restrict _bytes_read,
+	const bool			  is_deferred_copy,
 	pgm_error_t**		 restrict error
 	)
 {
 	int status = PGM_IO_STATUS_WOULD_BLOCK;
 
-	pgm_debug ("pgm_recvmsgv (sock:%p msg-start:%p msg-len:%" PRIzu " flags:%d bytes-read:%p error:%p)",
-		(void*)sock, (void*)msg_start, msg_len, flags, (void*)_bytes_read, (void*)error);
-
 /* parameters */
 	pgm_return_val_if_fail (NULL != sock, PGM_IO_STATUS_ERROR);
 	if (PGM_LIKELY(msg_len)) pgm_return_val_if_fail (NULL != msg_start, PGM_IO_STATUS_ERROR);
 
 /* shutdown */
-	if (PGM_UNLIKELY(!pgm_rwlock_reader_trylock (&sock->lock)))
+	if (PGM_UNLIKELY(!pgm_sock_reader_trylock (sock)))
 		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
 
-/* state */
-	if (PGM_UNLIKELY(!sock->is_bound || sock->is_destroyed))
+/* state, data is delivered by the callback or handoff ring */
+	if (PGM_UNLIKELY(!sock->is_bound || sock->is_destroyed || NULL != sock->delivery_req.dr_func || NULL != sock->handoff))
 	{
-		pgm_rwlock_reader_unlock (&sock->lock);
+		pgm_sock_reader_unlock (sock);
 		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
 	}
 
@@ -682,7 +2965,7 @@ pgm_recvmsgv (
 	}
 
 /* receiver */
-	pgm_mutex_lock (&sock->receiver_mutex);
+	pgm_sock_mutex_lock (sock, &sock->receiver_mutex);
 
 	if (PGM_UNLIKELY(sock->is_reset)) {
 		pgm_assert (NULL != sock->peers_pending);
@@ -701,11 +2984,13 @@ pgm_recvmsgv (
 		}
 		if (!sock->is_abort_on_reset)
 			sock->is_reset = !sock->is_reset;
-		pgm_mutex_unlock (&sock->receiver_mutex);
-		pgm_rwlock_reader_unlock (&sock->lock);
+		pgm_sock_mutex_unlock (sock, &sock->receiver_mutex);
+		pgm_sock_reader_unlock (sock);
 		return PGM_IO_STATUS_RESET;
 	}
 
+	expire_batch_tstamp (sock);
+
 /* timer status */
 	if (pgm_timer_check (sock) &&
 	    !pgm_timer_dispatch (sock))
@@ -714,15 +2999,10 @@ pgm_recvmsgv (
 		status = PGM_IO_STATUS_RATE_LIMITED;
 	}
 /* NAK status */
-	else if (sock->can_send_data)
+	else if (sock->can_send_data &&
+		 !recv_repair (sock))
 	{
-		if (!pgm_txw_retransmit_is_empty (sock->window))
-		{
-			if (!pgm_on_deferred_nak (sock))
-				status = PGM_IO_STATUS_RATE_LIMITED;
-		}
-		else
-			pgm_notify_clear (&sock->rdata_notify);
+		status = PGM_IO_STATUS_RATE_LIMITED;
 	}
 
 	size_t bytes_read = 0;
@@ -734,6 +3014,7 @@ pgm_recvmsgv (
 		++(sock->last_commit);
 
 	/* second, flush any remaining contiguous messages from previous call(s) */
+	recv_fec_complete (sock);
 	if (sock->peers_pending) {
 		if (0 != pgm_flush_peers_pending (sock, &pmsg, msg_end, &bytes_read, &data_read))
 			goto out;
@@ -747,22 +3028,28 @@ pgm_recvmsgv (
 	struct sockaddr_storage src, dst;
 	ssize_t len;
 	size_t bytes_received = 0;
+	unsigned recv_sock_eagain = 0;		/* consecutive kernel sockets without data */
+	bool is_xdp_eagain = FALSE;
 
 recv_again:
-
-	len = recvskb (sock,
-		       sock->rx_buffer,		/* PGM skbuff */
-		       0,
-		       (struct sockaddr*)&src,
-		       sizeof(src),
-		       (struct sockaddr*)&dst,
-		       sizeof(dst));
+	{
+		PGM_PROFILE_BEGIN (recv_start);
+		len = PGM_UNLIKELY(NULL != sock->rx_impair) ?
+			recvskb_impaired (sock, &src, &dst, &is_xdp_eagain) :
+			recvskb_next (sock, &src, &dst, &is_xdp_eagain);
+		PGM_PROFILE_END (PGM_PROFILE_RECVSKB, recv_start, len > 0);
+	}
 	if (len < 0)
 	{
 		const int save_errno = pgm_get_last_sock_error();
 		char errbuf[1024];
 		if (PGM_LIKELY(PGM_SOCK_EAGAIN == save_errno)) {
-			goto check_for_repeat;
+			if (recv_sock_eagain++ < sock->recv_sock_extra_len) {
+				next_recv_sock (sock);
+				goto recv_again;
+			}
+/* timer thread may have made data contiguous */
+			goto flush_pending;
 		}
 		status = PGM_IO_STATUS_ERROR;
 		pgm_set_error (error,
@@ -781,38 +3068,18 @@ recv_again:
 	else
 	{
 		bytes_received += len;
+/* round-robin fan-in sockets per read for fairness */
+		recv_sock_eagain = 0;
+		is_xdp_eagain = FALSE;
+		if (sock->recv_sock_extra_len > 0)
+			next_recv_sock (sock);
 	}
 
-	pgm_error_t* err = NULL;
-	const bool is_valid = (sock->udp_encap_ucast_port || AF_INET6 == src.ss_family) ?
-					pgm_parse_udp_encap (sock->rx_buffer, &err) :
-					pgm_parse_raw (sock->rx_buffer, (struct sockaddr*)&dst, &err);
-	if (PGM_UNLIKELY(!is_valid))
-	{
-/* inherently cannot determine PGM_PC_RECEIVER_CKSUM_ERRORS unless only one receiver */
-		pgm_trace (PGM_LOG_ROLE_NETWORK,
-				_("Discarded invalid packet: %s"),
-				(err && err->message) ? err->message : "(null)");
-		pgm_error_free (err);
-		if (sock->can_send_data) {
-			if (err && PGM_ERROR_CKSUM == err->code)
-				sock->cumulative_stats[PGM_PC_SOURCE_CKSUM_ERRORS]++;
-			sock->cumulative_stats[PGM_PC_SOURCE_PACKETS_DISCARDED]++;
-		}
-		goto recv_again;
-	}
-
-	pgm_peer_t* source = NULL;
-	if (PGM_UNLIKELY(!on_pgm (sock, sock->rx_buffer, (struct sockaddr*)&src, (struct sockaddr*)&dst, &source)))
+	if (PGM_UNLIKELY(!recv_process (sock, &src, &dst, sock->udp_encap_ucast_port || AF_INET6 == src.ss_family)))
 		goto recv_again;
 
-/* check whether this source has waiting data */
-	if (source && pgm_peer_has_pending (source)) {
-		pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("New pending data."));
-		pgm_peer_set_pending (sock, source);
-	}
-
 flush_pending:
+	recv_fec_complete (sock);
 /* flush any congtiguous packets generated by the receipt of this packet */
 	if (sock->peers_pending)
 	{
@@ -838,17 +3105,22 @@ check_for_repeat:
 /* repeat if blocking and empty, i.e. received non data packet.
  */
 		if (0 == data_read) {
+/* drain datagrams already read by recvmmsg() or UDP_GRO before waiting on the socket */
+			if (is_batch_pending (sock))
+				goto recv_again;
 			const int wait_status = wait_for_event (sock);
 			switch (wait_status) {
 			case EAGAIN:
+				recv_sock_eagain = 0;
+				is_xdp_eagain = FALSE;
 				goto recv_again;
 			case EINTR:
 				if (!pgm_timer_dispatch (sock))
 					goto check_for_repeat;
 				goto flush_pending;
 			case ENOENT:
-				pgm_mutex_unlock (&sock->receiver_mutex);
-				pgm_rwlock_reader_unlock (&sock->lock);
+				pgm_sock_mutex_unlock (sock, &sock->receiver_mutex);
+				pgm_sock_reader_unlock (sock);
 				return PGM_IO_STATUS_EOF;
 			case EFAULT: {
 				const int save_errno = pgm_get_last_sock_error();
@@ -859,8 +3131,8 @@ check_for_repeat:
 						_("Waiting for event: %s"),
 						pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno)
 						);
-				pgm_mutex_unlock (&sock->receiver_mutex);
-				pgm_rwlock_reader_unlock (&sock->lock);
+				pgm_sock_mutex_unlock (sock, &sock->receiver_mutex);
+				pgm_sock_reader_unlock (sock);
 				return PGM_IO_STATUS_ERROR;
 			}
 			default:
@@ -877,6 +3149,11 @@ out:
 			pgm_notify_clear (&sock->pending_notify);
 			sock->is_pending_read = FALSE;
 		}
+#ifdef PGM_HAVE_TIMER_FD
+/* the application waits on the timer descriptor next */
+		if (pgm_timer_has_fd (sock))
+			pgm_timer_arm (sock);
+#endif
 /* report data loss */
 		if (PGM_UNLIKELY(sock->is_reset)) {
 			pgm_assert (NULL != sock->peers_pending);
@@ -895,12 +3172,12 @@ out:
 			}
 			if (!sock->is_abort_on_reset)
 				sock->is_reset = !sock->is_reset;
-			pgm_mutex_unlock (&sock->receiver_mutex);
-			pgm_rwlock_reader_unlock (&sock->lock);
+			pgm_sock_mutex_unlock (sock, &sock->receiver_mutex);
+			pgm_sock_reader_unlock (sock);
 			return PGM_IO_STATUS_RESET;
 		}
-		pgm_mutex_unlock (&sock->receiver_mutex);
-		pgm_rwlock_reader_unlock (&sock->lock);
+		pgm_sock_mutex_unlock (sock, &sock->receiver_mutex);
+		pgm_sock_reader_unlock (sock);
 		if (PGM_IO_STATUS_WOULD_BLOCK == status &&
 		    ( sock->can_send_data ||
 		      ( sock->can_recv_data && NULL != sock->peers_list )))
@@ -910,7 +3187,15 @@ out:
 		return status;
 	}
 
-	if (sock->peers_pending)
+/* checksums deferred to delivery */
+	unsigned msg_count = (unsigned)(pmsg - msg_start);
+	bool is_corrupt = FALSE;
+	if (PGM_UNLIKELY(PGM_CHECKSUM_DELIVERY == sock->rx_checksum) && !is_deferred_copy && msg_count > 0) {
+		msg_count = verify_deferred_msgv (sock, msg_start, msg_count, &bytes_read);
+		is_corrupt = (0 == msg_count);
+	}
+
+	if (sock->peers_pending || is_batch_pending (sock))
 	{
 /* set event notification for additional available data */
 		if (sock->is_pending_read && sock->is_edge_triggered_recv)
@@ -927,13 +3212,239 @@ out:
 		}
 	}
 
+	if (PGM_UNLIKELY(is_corrupt)) {
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_RECV,
+			     PGM_ERROR_CKSUM,
+			     _("Received APDU failed checksum verification."));
+		pgm_sock_mutex_unlock (sock, &sock->receiver_mutex);
+		pgm_sock_reader_unlock (sock);
+		return PGM_IO_STATUS_ERROR;
+	}
+
+/* archive as delivered */
+	if (PGM_UNLIKELY(NULL != sock->recorder))
+		pgm_recorder_append (sock->recorder, msg_start, msg_count);
+
 	if (NULL != _bytes_read)
 		*_bytes_read = bytes_read;
-	pgm_mutex_unlock (&sock->receiver_mutex);
-	pgm_rwlock_reader_unlock (&sock->lock);
+	pgm_sock_mutex_unlock (sock, &sock->receiver_mutex);
+	pgm_sock_reader_unlock (sock);
 	return PGM_IO_STATUS_NORMAL;
 }
 
+/* data incoming on receive sockets, can be from a sender or receiver, or simply bogus.
+ * for IPv4 we receive the IP header to handle fragmentation, for IPv6 we cannot, but the
+ * underlying stack handles this for us.
+ *
+ * recvmsgv reads a vector of apdus each contained in a IO scatter/gather array.
+ *
+ * can be called due to event from incoming socket(s) or timer induced data loss.
+ *
+ * On success, returns PGM_IO_STATUS_NORMAL and saves the count of bytes read
+ * into _bytes_read.  With non-blocking sockets a block returns
+ * PGM_IO_STATUS_WOULD_BLOCK.  When rate limited sending repair data, returns
+ * PGM_IO_STATUS_RATE_LIMITED and caller should wait.  During recovery state,
+ * returns PGM_IO_STATUS_TIMER_PENDING and caller should also wait.  On
+ * unrecoverable dataloss, returns PGM_IO_STATUS_CONN_RESET.  If connection is
+ * closed, returns PGM_IO_STATUS_EOF.  On error, returns PGM_IO_STATUS_ERROR.
+ *
+ * With PGM_CHECKSUM_DELIVERY APDUs failing verification are dropped from the vector,
+ * PGM_ERROR_CKSUM is set if none remain.
+ */
+
+int
+pgm_recvmsgv (
+	pgm_sock_t*   	   const restrict sock,
+	struct pgm_msgv_t* const restrict msg_start,
+	const size_t			  msg_len,
+	const int			  flags,	/* MSG_DONTWAIT for non-blocking */
+	size_t*			 restrict _bytes_read,	/* may be NULL */
+	pgm_error_t**		 restrict error
+	)
+{
+	pgm_debug ("pgm_recvmsgv (sock:%p msg-start:%p msg-len:%" PRIzu " flags:%d bytes-read:%p error:%p)",
+		(void*)sock, (void*)msg_start, msg_len, flags, (void*)_bytes_read, (void*)error);
+
+	return recvmsgv (sock, msg_start, msg_len, flags, _bytes_read, FALSE, error);
+}
+
+/* readiness of the socket without reading, for an event loop woken on the descriptors of
+ * pgm_epoll_ctl(), pgm_poll_info() or pgm_select_info().  data is reported for the first
+ * PGM_EVENT_MAX_PEERS pending sources, the timer as microseconds remaining and
+ * PGM_EVENT_TIMER when due.  with EPOLLET registration the pending-pipe is only filled
+ * on a transition, events remain readable until pgm_recvmsgv() consumes them.
+ *
+ * returns TRUE on success, returns FALSE on an unbound or closed socket.
+ */
+
+bool
+pgm_sock_events (
+	pgm_sock_t*		  const restrict sock,
+	struct pgm_sock_events_t* const restrict events
+	)
+{
+	pgm_return_val_if_fail (NULL != sock, FALSE);
+	pgm_return_val_if_fail (NULL != events, FALSE);
+
+	if (PGM_UNLIKELY(!pgm_sock_reader_trylock (sock)))
+		pgm_return_val_if_reached (FALSE);
+	if (PGM_UNLIKELY(!sock->is_bound || sock->is_destroyed)) {
+		pgm_sock_reader_unlock (sock);
+		return FALSE;
+	}
+
+	memset (events, 0, sizeof (struct pgm_sock_events_t));
+	if (sock->can_recv_data) {
+		pgm_sock_mutex_lock (sock, &sock->receiver_mutex);
+		if (sock->is_reset)
+			events->pe_events |= PGM_EVENT_DATA;
+		for (const pgm_slist_t* list = sock->peers_pending; NULL != list; list = list->next) {
+			const pgm_peer_t* peer = list->data;
+			if (events->pe_peers_len < PGM_EVENT_MAX_PEERS)
+				memcpy (&events->pe_peers[events->pe_peers_len], &peer->tsi, sizeof (pgm_tsi_t));
+			events->pe_peers_len++;
+			events->pe_events |= PGM_EVENT_DATA;
+		}
+		if (is_batch_pending (sock))
+			events->pe_events |= PGM_EVENT_READ;
+		if (NULL != sock->rx_shm) {
+			uint32_t trail, lead;
+			if (pgm_txw_store_extent (sock->rx_shm, &trail, &lead) &&
+			    sock->rx_shm_next != (uint32_t)(lead + 1))
+				events->pe_events |= PGM_EVENT_READ;
+		}
+		pgm_sock_mutex_unlock (sock, &sock->receiver_mutex);
+	}
+	if (sock->can_send_data) {
+		if (!pgm_txw_retransmit_is_empty (sock->window))
+			events->pe_events |= PGM_EVENT_REPAIR;
+		if (sock->use_pgmcc && sock->is_apdu_eagain)
+			events->pe_events |= (sock->tokens < pgm_fp8 (1)) ? PGM_EVENT_CONGESTION : PGM_EVENT_CONGESTION_CLEARED;
+	}
+	if (sock->is_connected) {
+		const pgm_time_t remain = pgm_timer_expiration (sock);
+		events->pe_timer_remain = (uint32_t)MIN(remain, (pgm_time_t)UINT32_MAX);
+		if (0 == remain)
+			events->pe_events |= PGM_EVENT_TIMER;
+	}
+	pgm_sock_reader_unlock (sock);
+	return TRUE;
+}
+
+/* take up to msg_len complete APDUs from the handoff ring of the socket, on any number of
+ * threads without a lock.  each msgv holds references on its skbuffs, valid until given
+ * back with pgm_handoff_release().  an empty ring arms PGM_HANDOFF_SOCK to become readable
+ * on the next publication.
+ *
+ * on success, returns PGM_IO_STATUS_NORMAL, on an empty ring returns
+ * PGM_IO_STATUS_WOULD_BLOCK.  on unrecoverable loss returns PGM_IO_STATUS_RESET with
+ * msgs_read APDUs that preceded it.
+ */
+
+int
+pgm_handoff_recv (
+	pgm_sock_t*	   const restrict sock,
+	struct pgm_msgv_t* const restrict msg_start,
+	const size_t			  msg_len,
+	size_t*			 restrict msgs_read,	/* may be NULL */
+	pgm_error_t**		 restrict error
+	)
+{
+	pgm_debug ("pgm_handoff_recv (sock:%p msg-start:%p msg-len:%" PRIzu " msgs-read:%p error:%p)",
+		(const void*)sock, (const void*)msg_start, msg_len, (const void*)msgs_read, (const void*)error);
+
+/* parameters */
+	pgm_return_val_if_fail (NULL != sock, PGM_IO_STATUS_ERROR);
+	pgm_return_val_if_fail (NULL != msg_start, PGM_IO_STATUS_ERROR);
+	pgm_return_val_if_fail (msg_len > 0, PGM_IO_STATUS_ERROR);
+
+/* shutdown */
+	if (PGM_UNLIKELY(!pgm_sock_reader_trylock (sock)))
+		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
+
+/* state */
+	if (PGM_UNLIKELY(!sock->is_bound || sock->is_destroyed || NULL == sock->handoff))
+	{
+		pgm_sock_reader_unlock (sock);
+		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
+	}
+
+	struct pgm_handoff_t* handoff = sock->handoff;
+	int status = PGM_IO_STATUS_NORMAL;
+	size_t count = 0;
+	bool is_armed = FALSE;
+	pgm_tsi_t tsi;
+
+	while (count < msg_len)
+	{
+		if (pgm_handoff_take (handoff, &msg_start[count], &tsi)) {
+			if (PGM_UNLIKELY(0 == msg_start[count].msgv_len)) {
+				if (error) {
+					char tsi_string[PGM_TSISTRLEN];
+					pgm_tsi_print_r (&tsi, tsi_string, sizeof(tsi_string));
+					pgm_set_error (error,
+						     PGM_ERROR_DOMAIN_RECV,
+						     PGM_ERROR_CONNRESET,
+						     _("Transport has been reset on unrecoverable loss from %s."),
+						     tsi_string);
+				}
+				status = PGM_IO_STATUS_RESET;
+				break;
+			}
+			count++;
+			continue;
+		}
+		if (count > 0 || is_armed)
+			break;
+/* arm the wakeup then look again, a publication in between is either seen or notified */
+		pgm_notify_clear (&sock->handoff_notify);
+		(void)pgm_atomic_exchange32 (&handoff->is_waiting, 1);
+		is_armed = TRUE;
+	}
+
+/* space for a timer thread stopped on a full ring */
+	if ((count > 0 || PGM_IO_STATUS_RESET == status) &&
+	    pgm_atomic_read32 (&handoff->is_blocked) &&
+	    pgm_atomic_exchange32 (&handoff->is_blocked, 0))
+	{
+		pgm_notify_send (&sock->timer_notify);
+	}
+
+	pgm_sock_reader_unlock (sock);
+	if (msgs_read)
+		*msgs_read = count;
+	if (0 == count && PGM_IO_STATUS_NORMAL == status)
+		return PGM_IO_STATUS_WOULD_BLOCK;
+	return status;
+}
+
+/* give back APDUs taken by pgm_handoff_recv() from any thread, skbuffs are returned to
+ * their pools by the timer thread on its next pass or at once when the release ring is
+ * full or the socket is closing.
+ */
+
+void
+pgm_handoff_release (
+	pgm_sock_t*		 const restrict	sock,
+	const struct pgm_msgv_t* const restrict	msgv,
+	const size_t				msgv_len
+	)
+{
+	pgm_return_if_fail (NULL != sock);
+	if (PGM_LIKELY(msgv_len)) pgm_return_if_fail (NULL != msgv);
+
+	if (PGM_UNLIKELY(!pgm_sock_reader_trylock (sock))) {
+		for (size_t i = 0; i < msgv_len; i++)
+			pgm_msgv_release (&msgv[i]);
+		return;
+	}
+	for (size_t i = 0; i < msgv_len; i++)
+		if (NULL == sock->handoff || !pgm_handoff_give (sock->handoff, &msgv[i]))
+			pgm_msgv_release (&msgv[i]);
+	pgm_sock_reader_unlock (sock);
+}
+
 /* read one contiguous apdu and return as a IO scatter/gather array.  msgv is owned by
  * the caller, tpdu contents are owned by the receive window.
  *
@@ -990,16 +3501,17 @@ pgm_recvfrom (
 	pgm_debug ("pgm_recvfrom (sock:%p buf:%p buflen:%" PRIzu " flags:%d bytes-read:%p from:%p from:%p error:%p)",
 		(const void*)sock, buf, buflen, flags, (const void*)_bytes_read, (const void*)from, (const void*)fromlen, (const void*)error);
 
-	const int status = pgm_recvmsg (sock, &msgv, flags & ~(MSG_ERRQUEUE), &bytes_read, error);
+	const int status = recvmsgv (sock, &msgv, 1, flags & ~(MSG_ERRQUEUE), &bytes_read, TRUE, error);
 	if (PGM_IO_STATUS_NORMAL != status)
 		return status;
 
 	size_t bytes_copied = 0;
+	bool is_valid = TRUE;
 	struct pgm_sk_buff_t** skb = msgv.msgv_skb;
 	struct pgm_sk_buff_t* pskb = *skb;
 
 	if (from) {
-		from->sa_port = pgm_ntohs (sock->dport);
+		from->sa_port = pgm_ntohs (pskb->pgm_header->pgm_dport);
 		from->sa_addr.sport = pgm_ntohs (pskb->tsi.sport);
 		memcpy (&from->sa_addr.gsi, &pskb->tsi.gsi, sizeof(pgm_gsi_t));
 	}
@@ -1012,10 +3524,26 @@ pgm_recvfrom (
 			copy_len = buflen - bytes_copied;
 			bytes_read = buflen;
 		}
-		memcpy ((char*)buf + bytes_copied, pskb->data, copy_len);
+/* fused checksum and copy, each byte read once */
+		if (pskb->csum_deferred) {
+			if (PGM_UNLIKELY(!pgm_verify_checksum_copy (pskb, (char*)buf + bytes_copied, (uint16_t)copy_len)))
+				is_valid = FALSE;
+		} else
+			memcpy ((char*)buf + bytes_copied, pskb->data, copy_len);
 		bytes_copied += copy_len;
 		pskb = *(++skb);
 	}
+	if (PGM_UNLIKELY(!is_valid)) {
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded APDU with checksum mismatch."));
+		pgm_sock_mutex_lock (sock, &sock->receiver_mutex);
+		pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_CKSUM_ERRORS);
+		pgm_sock_mutex_unlock (sock, &sock->receiver_mutex);
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_RECV,
+			     PGM_ERROR_CKSUM,
+			     _("Received APDU failed checksum verification."));
+		return PGM_IO_STATUS_ERROR;
+	}
 	if (_bytes_read)
 		*_bytes_read = bytes_copied;
 	return PGM_IO_STATUS_NORMAL;
@@ -1045,4 +3573,130 @@ pgm_recv (
 	return pgm_recvfrom (sock, buf, buflen, flags, bytes_read, NULL, NULL, error);
 }
 
+/* bulk read function.  copies complete APDUs from any number of sources into the
+ * provided arena, each described by tsi, first sequence number, arena offset and
+ * length.  windows are drained in rounds of at most PGM_BULK_MSGV APDUs, a round
+ * is only started whilst the remaining arena holds a maximum sized APDU, so the
+ * arena should be many times sock::max_apdu.  only the first round may block.
+ *
+ * on success, returns PGM_IO_STATUS_NORMAL and sets msgs_read to the number of
+ * descriptors filled.
+ */
+
+#define PGM_BULK_MSGV		64
+
+int
+pgm_recvbulk (
+	pgm_sock_t*		const restrict sock,
+	void*			      restrict arena,
+	const size_t			       arena_len,
+	struct pgm_bulk_msg_t*	      restrict msgs,
+	const size_t			       msgs_len,
+	const int			       flags,		/* MSG_DONTWAIT for non-blocking */
+	size_t*			      restrict _msgs_read,	/* may be NULL */
+	pgm_error_t**		      restrict error
+	)
+{
+	struct pgm_msgv_t msgv[ PGM_BULK_MSGV ];
+	size_t offset = 0, msgs_read = 0;
+	unsigned corrupt_count = 0;
+	int status = PGM_IO_STATUS_NORMAL;
+
+	pgm_return_val_if_fail (NULL != sock, PGM_IO_STATUS_ERROR);
+	pgm_return_val_if_fail (NULL != arena, PGM_IO_STATUS_ERROR);
+	pgm_return_val_if_fail (NULL != msgs, PGM_IO_STATUS_ERROR);
+	pgm_return_val_if_fail (msgs_len > 0, PGM_IO_STATUS_ERROR);
+	pgm_return_val_if_fail (arena_len <= UINT32_MAX, PGM_IO_STATUS_ERROR);
+
+	pgm_debug ("pgm_recvbulk (sock:%p arena:%p arena-len:%" PRIzu " msgs:%p msgs-len:%" PRIzu " flags:%d msgs-read:%p error:%p)",
+		(const void*)sock, arena, arena_len, (const void*)msgs, msgs_len, flags, (const void*)_msgs_read, (const void*)error);
+
+	if (PGM_UNLIKELY(!sock->is_bound || sock->is_destroyed))
+		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
+/* large APDUs are delivered in chunks of at most PGM_MAX_FRAGMENTS fragments */
+	const size_t max_msg = MIN( sock->max_apdu, (size_t)PGM_MAX_FRAGMENTS * sock->max_tsdu_fragment );
+	if (PGM_UNLIKELY(arena_len < max_msg)) {
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_RECV,
+			     PGM_ERROR_NOBUFS,
+			     _("Arena smaller than maximum APDU of %" PRIzu " bytes."),
+			     max_msg);
+		return PGM_IO_STATUS_ERROR;
+	}
+
+	for (int round_flags = flags & ~(MSG_ERRQUEUE);; round_flags |= MSG_DONTWAIT)
+	{
+		const size_t arena_msgs = (arena_len - offset) / max_msg;
+		const size_t msgv_len = MIN( (size_t)PGM_BULK_MSGV, MIN( msgs_len - msgs_read, arena_msgs ) );
+		if (0 == msgv_len)
+			break;
+
+		pgm_error_t* round_error = NULL;
+		size_t bytes_read = 0;
+		const int round_status = recvmsgv (sock, msgv, msgv_len, round_flags, &bytes_read, TRUE,
+						   (0 == msgs_read && 0 == corrupt_count) ? error : &round_error);
+		if (PGM_IO_STATUS_NORMAL != round_status) {
+			if (0 == msgs_read && 0 == corrupt_count) {
+				status = round_status;
+				break;
+			}
+/* defer loss notification to the next call */
+			if (PGM_IO_STATUS_RESET == round_status && !sock->is_abort_on_reset) {
+				pgm_sock_mutex_lock (sock, &sock->receiver_mutex);
+				sock->is_reset = TRUE;
+				pgm_sock_mutex_unlock (sock, &sock->receiver_mutex);
+			}
+			pgm_error_free (round_error);
+			break;
+		}
+
+/* copy each APDU, fused with checksum verification, discarding any corrupt */
+		for (const struct pgm_msgv_t* pmsgv = msgv; bytes_read > 0; pmsgv++)
+		{
+			struct pgm_bulk_msg_t* msg = &msgs[ msgs_read ];
+			const struct pgm_sk_buff_t* first = pmsgv->msgv_skb[0];
+			size_t apdu_len = 0;
+			bool is_valid = TRUE;
+			for (unsigned i = 0; i < pmsgv->msgv_len; i++) {
+				const struct pgm_sk_buff_t* skb = pmsgv->msgv_skb[i];
+				char* dst = (char*)arena + offset + apdu_len;
+				if (skb->csum_deferred) {
+					if (PGM_UNLIKELY(!pgm_verify_checksum_copy (skb, dst, skb->len)))
+						is_valid = FALSE;
+				} else
+					memcpy (dst, skb->data, skb->len);
+				apdu_len += skb->len;
+			}
+			bytes_read -= apdu_len;
+			if (PGM_UNLIKELY(!is_valid)) {
+				corrupt_count++;
+				continue;
+			}
+			memcpy (&msg->bm_tsi, &first->tsi, sizeof(pgm_tsi_t));
+			msg->bm_sqn	= first->sequence;
+			msg->bm_offset	= (uint32_t)offset;
+			msg->bm_len	= (uint32_t)apdu_len;
+			offset += apdu_len;
+			msgs_read++;
+		}
+	}
+
+	if (PGM_UNLIKELY(corrupt_count)) {
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded %u APDUs with checksum mismatch."), corrupt_count);
+		pgm_sock_mutex_lock (sock, &sock->receiver_mutex);
+		pgm_stats_add (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_CKSUM_ERRORS, corrupt_count);
+		pgm_sock_mutex_unlock (sock, &sock->receiver_mutex);
+		if (0 == msgs_read) {
+			pgm_set_error (error,
+				     PGM_ERROR_DOMAIN_RECV,
+				     PGM_ERROR_CKSUM,
+				     _("Received APDUs failed checksum verification."));
+			return PGM_IO_STATUS_ERROR;
+		}
+	}
+	if (_msgs_read)
+		*_msgs_read = msgs_read;
+	return status;
+}
+
 /* eof */
@@ -81,6 +81,7 @@ static int mock_pgm_type = -1;
 static gboolean mock_reset_on_spmr = FALSE;
 static gboolean mock_data_on_spmr = FALSE;
 static struct pgm_peer_t* mock_peer = NULL;
+static guint64 mock_nak_expiry = 0;
 GList* mock_data_list = NULL;
 unsigned mock_pgm_loss_rate = 0;
 
@@ -93,15 +94,19 @@ static int mock_recvfrom (SOCKET, char*, int, int, struct sockaddr*, int*);
 
 #define pgm_parse_raw			mock_pgm_parse_raw
 #define pgm_parse_udp_encap		mock_pgm_parse_udp_encap
+#define pgm_parse_screen		mock_pgm_parse_screen
 #define pgm_verify_spm			mock_pgm_verify_spm
 #define pgm_verify_nak			mock_pgm_verify_nak
 #define pgm_verify_ncf			mock_pgm_verify_ncf
+#define pgm_verify_checksum		mock_pgm_verify_checksum
+#define pgm_verify_checksum_copy	mock_pgm_verify_checksum_copy
 #define pgm_select_info			mock_pgm_select_info
 #define pgm_poll_info			mock_pgm_poll_info
 #define pgm_set_reset_error		mock_pgm_set_reset_error
 #define pgm_flush_peers_pending		mock_pgm_flush_peers_pending
 #define pgm_peer_has_pending		mock_pgm_peer_has_pending
 #define pgm_peer_set_pending		mock_pgm_peer_set_pending
+#define pgm_peer_update_expiry		mock_pgm_peer_update_expiry
 #define pgm_txw_retransmit_is_empty	mock_pgm_txw_retransmit_is_empty
 #define pgm_rxw_create			mock_pgm_rxw_create
 #define pgm_rxw_readv			mock_pgm_rxw_readv
@@ -115,7 +120,11 @@ static int mock_recvfrom (SOCKET, char*, int, int, struct sockaddr*, int*);
 #define pgm_on_nnak			mock_pgm_on_nnak
 #define pgm_on_ncf			mock_pgm_on_ncf
 #define pgm_on_spmr			mock_pgm_on_spmr
-#define pgm_sendto			mock_pgm_sendto
+#define pgm_on_poll			mock_pgm_on_poll
+#define pgm_net_shim			mock_pgm_net_shim
+#define pgm_txw_store_extent		mock_pgm_txw_store_extent
+#define pgm_txw_store_copy		mock_pgm_txw_store_copy
+#define pgm_txw_store_trail		mock_pgm_txw_store_trail
 #define pgm_timer_prepare		mock_pgm_timer_prepare
 #define pgm_timer_check			mock_pgm_timer_check
 #define pgm_timer_expiration		mock_pgm_timer_expiration
@@ -131,7 +140,7 @@ static int mock_recvfrom (SOCKET, char*, int, int, struct sockaddr*, int*);
 #include "recv.c"
 
 
-pgm_rxw_t* mock_pgm_rxw_create (const pgm_tsi_t*, const uint16_t, const unsigned, const unsigned, const ssize_t, const uint32_t);
+pgm_rxw_t* mock_pgm_rxw_create (const pgm_tsi_t*, const uint16_t, const unsigned, const unsigned, const ssize_t, const uint32_t, const pgm_mem_policy_t*const);
 static pgm_time_t _mock_pgm_time_update_now (void);
 pgm_time_update_func mock_pgm_time_update_now = _mock_pgm_time_update_now;
 
@@ -155,6 +164,7 @@ mock_teardown (void)
 	mock_peer = NULL;
 	mock_data_list = NULL;
 	mock_pgm_loss_rate = 0;
+	mock_nak_expiry = 0;
 }
 
 static
@@ -176,14 +186,13 @@ generate_sock (void)
 	sock->can_send_data = TRUE;
 	sock->can_send_nak = TRUE;
 	sock->can_recv_data = TRUE;
-	sock->peers_hashtable = pgm_hashtable_new (pgm_tsi_hash, pgm_tsi_equal);
+	sock->peers_hashtable = pgm_peertable_new ();
 	pgm_rand_create (&sock->rand_);
 	sock->nak_bo_ivl = 100*1000;
 	pgm_notify_init (&sock->pending_notify);
 	pgm_notify_init (&sock->rdata_notify);
 	pgm_mutex_init (&sock->receiver_mutex);
 	pgm_rwlock_init (&sock->lock);
-	pgm_rwlock_init (&sock->peers_lock);
 	return sock;
 }
 
@@ -588,6 +597,18 @@ mock_pgm_parse_udp_encap (
 	return TRUE;
 }
 
+/* every datagram passes */
+void
+mock_pgm_parse_screen (
+	const struct pgm_iovec* const	iov,
+	const unsigned			count,
+	const bool			is_udp_encap,
+	uint8_t*			type
+	)
+{
+	memset (type, PGM_SPM, count);
+}
+
 bool
 mock_pgm_verify_spm (
 	const struct pgm_sk_buff_t* const	skb
@@ -612,6 +633,26 @@ mock_pgm_verify_ncf (
 	return TRUE;
 }
 
+bool
+mock_pgm_verify_checksum (
+	struct pgm_sk_buff_t* const	skb
+	)
+{
+	skb->csum_deferred = 0;
+	return TRUE;
+}
+
+bool
+mock_pgm_verify_checksum_copy (
+	const struct pgm_sk_buff_t* const restrict skb,
+	void*			    restrict dst,
+	const uint16_t			     copy_len
+	)
+{
+	memcpy (dst, skb->data, copy_len);
+	return TRUE;
+}
+
 /** socket module */
 #ifdef HAVE_POLL
 int
@@ -668,10 +709,11 @@ mock_pgm_new_peer (
 					    sock->rxw_sqns,
 					    sock->rxw_secs,
 					    sock->rxw_max_rte,
-					    sock->ack_c_p);
+					    sock->ack_c_p,
+					    NULL);
 	peer->spmr_expiry = now + sock->spmr_expiry;
 	gpointer entry = mock__pgm_peer_ref(peer);
-	pgm_hashtable_insert (sock->peers_hashtable, &peer->tsi, entry);
+	pgm_peertable_insert (sock->peers_hashtable, &peer->tsi, entry);
 	peer->peers_link.next = sock->peers_list;
 	peer->peers_link.data = peer;
 	if (sock->peers_list)
@@ -731,6 +773,19 @@ mock_pgm_peer_has_pending (
 	return FALSE;
 }
 
+PGM_GNUC_INTERNAL
+void
+mock_pgm_peer_update_expiry (
+	pgm_sock_t* const          sock,
+	pgm_peer_t* const               peer
+	)
+{
+	g_assert (NULL != sock);
+	g_assert (NULL != peer);
+	if (mock_nak_expiry && mock_nak_expiry < peer->timer_expiry)
+		peer->timer_expiry = mock_nak_expiry;
+}
+
 PGM_GNUC_INTERNAL
 void
 mock_pgm_peer_set_pending (
@@ -742,8 +797,12 @@ mock_pgm_peer_set_pending (
 	g_assert (NULL != peer);
 	if (peer->pending_link.data) return;
 	peer->pending_link.data = peer;
-	peer->pending_link.next = sock->peers_pending;
-	sock->peers_pending = &peer->pending_link;
+	peer->pending_link.next = NULL;
+	if (sock->peers_pending_tail)
+		sock->peers_pending_tail->next = &peer->pending_link;
+	else
+		sock->peers_pending = &peer->pending_link;
+	sock->peers_pending_tail = &peer->pending_link;
 }
 
 PGM_GNUC_INTERNAL
@@ -787,7 +846,8 @@ PGM_GNUC_INTERNAL
 bool
 mock_pgm_on_nak (
 	pgm_sock_t* const		sock,
-	struct pgm_sk_buff_t* const	skb
+	struct pgm_sk_buff_t* const	skb,
+	const struct sockaddr* const	src_addr
 	)
 {
 	g_debug ("mock_pgm_on_nak (sock:%p skb:%p)",
@@ -807,6 +867,8 @@ mock_pgm_on_peer_nak (
 	g_debug ("mock_pgm_on_peer_nak (sock:%p sender:%p skb:%p)",
 		(gpointer)sock, (gpointer)sender, (gpointer)skb);
 	mock_pgm_type = PGM_NAK;
+/* placeholder backs off as if the NAK were our own */
+	mock_nak_expiry = mock_pgm_time_update_now() + sock->nak_bo_ivl;
 	return TRUE;
 }
 
@@ -872,6 +934,20 @@ mock_pgm_on_spmr (
 	return TRUE;
 }
 
+PGM_GNUC_INTERNAL
+bool
+mock_pgm_on_poll (
+	pgm_sock_t* const		sock,
+	pgm_peer_t* const		source,
+	struct pgm_sk_buff_t* const	skb
+	)
+{
+	g_debug ("mock_pgm_on_poll (sock:%p source:%p skb:%p)",
+		(gpointer)sock, (gpointer)source, (gpointer)skb);
+	mock_pgm_type = PGM_POLL;
+	return TRUE;
+}
+
 /** transmit window */
 PGM_GNUC_INTERNAL
 bool
@@ -890,7 +966,8 @@ mock_pgm_rxw_create (
 	const unsigned		sqns,
 	const unsigned		secs,
 	const ssize_t		max_rte,
-	const uint32_t		ack_c_p
+	const uint32_t		ack_c_p,
+	const pgm_mem_policy_t*const policy
 	)
 {
 	return g_new0 (pgm_rxw_t, 1);
@@ -907,19 +984,39 @@ mock_pgm_rxw_readv (
 }
 
 /** net module */
+const struct pgm_net_shim_t* mock_pgm_net_shim = NULL;
+
+/** transmit window store module */
 PGM_GNUC_INTERNAL
-ssize_t
-mock_pgm_sendto (
-	pgm_sock_t*		sock,
-	bool				use_rate_limit,
-	bool				use_router_alert,
-	const void*			buf,
-	size_t				len,
-	const struct sockaddr*		to,
-	socklen_t			tolen
+bool
+mock_pgm_txw_store_extent (
+	const struct pgm_txw_store_t*const store,
+	uint32_t*			trail,
+	uint32_t*			lead
 	)
 {
-	return len;
+	return FALSE;
+}
+
+PGM_GNUC_INTERNAL
+size_t
+mock_pgm_txw_store_copy (
+	const struct pgm_txw_store_t*const store,
+	const uint32_t			sequence,
+	void*				buf,
+	const size_t			len
+	)
+{
+	return 0;
+}
+
+PGM_GNUC_INTERNAL
+uint32_t
+mock_pgm_txw_store_trail (
+	const struct pgm_txw_store_t*const store
+	)
+{
+	return 0;
 }
 
 /** timer module */
@@ -1109,6 +1206,8 @@ mock_recvfrom (
 
 /* mock functions for external references */
 
+pgm_rwlock_t pgm_sock_list_lock;
+
 size_t
 pgm_pkt_offset (
         const bool                      can_fragment,
@@ -1222,6 +1321,41 @@ START_TEST (test_peer_nak_pass_001)
 }
 END_TEST
 
+/* recv -> on_peer -> on_peer_nak as designated local repairer, placeholder re-keys the source */
+START_TEST (test_peer_nak_pass_002)
+{
+	pgm_sock_t* sock = generate_sock();
+	fail_if (NULL == sock, "generate_sock failed");
+	const pgm_tsi_t source_tsi = { { 1, 2, 3, 4, 5, 6 }, g_htons((guint16)TEST_XPORT) };
+	struct sockaddr_in grp_addr = {
+		.sin_family		= AF_INET,
+		.sin_addr.s_addr	= inet_addr(TEST_GROUP_ADDR)
+	}, source_addr = {
+		.sin_family		= AF_INET,
+		.sin_addr.s_addr	= inet_addr(TEST_SRC_ADDR)
+	};
+	pgm_peer_t* source = mock_pgm_new_peer (sock, &source_tsi, (struct sockaddr*)&grp_addr, sizeof(grp_addr), (struct sockaddr*)&source_addr, sizeof(source_addr), mock_pgm_time_now);
+	fail_if (NULL == source, "new_peer failed");
+	source->timer_expiry = mock_pgm_time_now + TEST_PEER_EXPIRY;
+	sock->dlr_sqns = TEST_RXW_SQNS;
+	guint8 buffer[ TEST_TXW_SQNS * TEST_MAX_TPDU ];
+	gpointer packet; gsize packet_len;
+	generate_peer_nak (0 /* sqn */, &packet, &packet_len);
+/* unicast NAK about another source on the same session */
+	struct pgm_ip* iphdr = packet;
+	iphdr->ip_dst.s_addr	= inet_addr (TEST_END_ADDR);
+	struct pgm_header* pgmhdr = (gpointer)(iphdr + 1);
+	pgmhdr->pgm_dport	= g_htons ((guint16)TEST_XPORT);
+	generate_msghdr (packet, packet_len);
+	push_block_event ();
+	gsize bytes_read;
+	pgm_error_t* err = NULL;
+	fail_unless (PGM_IO_STATUS_TIMER_PENDING == pgm_recv (sock, buffer, sizeof(buffer), MSG_DONTWAIT, &bytes_read, &err), "recv failed");
+	fail_unless (PGM_NAK == mock_pgm_type, "unexpected PGM packet");
+	fail_unless (mock_pgm_time_now + sock->nak_bo_ivl == source->timer_expiry, "source not re-keyed");
+}
+END_TEST
+
 /* recv -> on_nnak */
 START_TEST (test_nnak_pass_001)
 {
@@ -1636,6 +1770,236 @@ START_TEST (test_recvmsgv_fail_001)
 }
 END_TEST
 
+/* target:
+ *	int
+ *	pgm_recvbulk (
+ *		pgm_sock_t*		sock,
+ *		void*			arena,
+ *		size_t			arena_len,
+ *		struct pgm_bulk_msg_t*	msgs,
+ *		size_t			msgs_len,
+ *		int			flags,
+ *		size_t*			msgs_read,
+ *		pgm_error_t**		error
+ *		)
+ */
+
+START_TEST (test_recvbulk_fail_001)
+{
+	guint8 arena[ TEST_TXW_SQNS * TEST_MAX_TPDU ];
+	struct pgm_bulk_msg_t msgs[ TEST_TXW_SQNS ];
+	fail_unless (PGM_IO_STATUS_ERROR == pgm_recvbulk (NULL, arena, sizeof(arena), msgs, G_N_ELEMENTS(msgs), 0, NULL, NULL), "recvbulk failed");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_sock_events (
+ *		pgm_sock_t*			sock,
+ *		struct pgm_sock_events_t*	events
+ *		)
+ */
+
+START_TEST (test_sock_events_pass_001)
+{
+	struct pgm_sock_events_t events;
+	pgm_sock_t* sock = generate_sock();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_connected = TRUE;
+	fail_unless (TRUE == pgm_sock_events (sock, &events), "sock_events failed");
+	fail_unless (0 == events.pe_events, "events not empty");
+	fail_unless (100 == events.pe_timer_remain, "timer remain");
+	fail_unless (0 == events.pe_peers_len, "peers not empty");
+}
+END_TEST
+
+/* pending source hinted */
+START_TEST (test_sock_events_pass_002)
+{
+	struct pgm_sock_events_t events;
+	pgm_sock_t* sock = generate_sock();
+	fail_if (NULL == sock, "generate_sock failed");
+	const pgm_tsi_t peer_tsi = { { 9, 8, 7, 6, 5, 4 }, g_htons(9000) };
+	struct sockaddr_in grp_addr = {
+		.sin_family		= AF_INET,
+		.sin_addr.s_addr	= inet_addr(TEST_GROUP_ADDR)
+	}, peer_addr = {
+		.sin_family		= AF_INET,
+		.sin_addr.s_addr	= inet_addr(TEST_END_ADDR)
+	};
+	pgm_peer_t* peer = mock_pgm_new_peer (sock, &peer_tsi, (struct sockaddr*)&grp_addr, sizeof(grp_addr), (struct sockaddr*)&peer_addr, sizeof(peer_addr), mock_pgm_time_now);
+	fail_if (NULL == peer, "new_peer failed");
+	mock_pgm_peer_set_pending (sock, peer);
+	fail_unless (TRUE == pgm_sock_events (sock, &events), "sock_events failed");
+	fail_unless (PGM_EVENT_DATA == events.pe_events, "data not ready");
+	fail_unless (1 == events.pe_peers_len, "peers length");
+	fail_unless (pgm_tsi_equal (&peer_tsi, &events.pe_peers[0]), "peer tsi");
+}
+END_TEST
+
+START_TEST (test_sock_events_fail_001)
+{
+	struct pgm_sock_events_t events;
+	pgm_sock_t* sock = generate_sock();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_destroyed = TRUE;
+	fail_unless (FALSE == pgm_sock_events (sock, &events), "sock_events succeeded");
+}
+END_TEST
+
+/* target:
+ *	void
+ *	recvskb_rxq_drops (
+ *		pgm_sock_t*		sock,
+ *		pgm_msghdr_t*		msg
+ *		)
+ */
+
+#ifdef SO_RXQ_OVFL
+START_TEST (test_rxq_drops_pass_001)
+{
+	pgm_sock_t* sock = generate_sock();
+	fail_if (NULL == sock, "generate_sock failed");
+	char control[ CMSG_SPACE(sizeof(uint32_t)) ];
+	memset (control, 0, sizeof(control));
+	struct msghdr msg = {
+		.msg_control	= control,
+		.msg_controllen	= sizeof(control)
+	};
+	struct cmsghdr* cmsg	= CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level	= SOL_SOCKET;
+	cmsg->cmsg_type		= SO_RXQ_OVFL;
+	cmsg->cmsg_len		= CMSG_LEN(sizeof(uint32_t));
+	uint32_t count = 7;
+	memcpy (CMSG_DATA(cmsg), &count, sizeof(count));
+	recvskb_rxq_drops (sock, &msg);
+	fail_unless (7 == pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_RXQ_DROPS), "drops not counted");
+	fail_unless (pgm_time_after (sock->rxq_overrun_expiry, mock_pgm_time_now), "NAKs not held");
+/* running count, only the difference is new */
+	count = 10;
+	memcpy (CMSG_DATA(cmsg), &count, sizeof(count));
+	recvskb_rxq_drops (sock, &msg);
+	recvskb_rxq_drops (sock, &msg);
+	fail_unless (10 == pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_RXQ_DROPS), "drops counted twice");
+}
+END_TEST
+#endif
+
+/* target:
+ *	bool
+ *	is_source_wanted (
+ *		const pgm_sock_t*	sock,
+ *		const pgm_tsi_t*	tsi
+ *		)
+ */
+
+START_TEST (test_source_wanted_pass_001)
+{
+	pgm_sock_t* sock = generate_sock();
+	fail_if (NULL == sock, "generate_sock failed");
+	pgm_tsi_t tsi = { { { 1, 2, 3, 4, 5, 6 } }, htons (1000) };
+	fail_unless (TRUE == is_source_wanted (sock, &tsi), "unfiltered source rejected");
+/* sorted: GSI wildcard, then a single session of another GSI */
+	struct pgm_source_filter_req_t* sf = &sock->rx_source_filter;
+	sf->sf_mode = PGM_SOURCE_ALLOW;
+	sf->sf_len = 2;
+	memcpy (&sf->sf_tsi[0], &tsi, sizeof (pgm_tsi_t));
+	sf->sf_tsi[0].sport = 0;
+	memcpy (&sf->sf_tsi[1], &tsi, sizeof (pgm_tsi_t));
+	sf->sf_tsi[1].gsi.identifier[5] = 7;
+	fail_unless (TRUE == is_source_wanted (sock, &tsi), "GSI wildcard rejected");
+	tsi.gsi.identifier[5] = 7;
+	fail_unless (TRUE == is_source_wanted (sock, &tsi), "listed session rejected");
+	tsi.sport = htons (1001);
+	fail_unless (FALSE == is_source_wanted (sock, &tsi), "other session admitted");
+	sf->sf_mode = PGM_SOURCE_DENY;
+	fail_unless (TRUE == is_source_wanted (sock, &tsi), "unlisted session denied");
+	tsi.gsi.identifier[5] = 6;
+	fail_unless (FALSE == is_source_wanted (sock, &tsi), "denied GSI admitted");
+}
+END_TEST
+
+/* downstream packets from two sources, each shard socket keeps only the peer
+ * whose TSI hashes to its own index.
+ */
+
+static
+guint16
+shard_sport (
+	const pgm_sock_t*	sock
+	)
+{
+	pgm_tsi_t tsi = { { { 1, 2, 3, 4, 5, 6 } }, 0 };
+	for (guint16 sport = TEST_XPORT;; sport++) {
+		tsi.sport = g_htons (sport);
+		if (is_source_sharded (sock, &tsi))
+			return sport;
+	}
+}
+
+static
+void
+generate_shard_spm (
+	const guint16		sport
+	)
+{
+	gpointer packet; gsize packet_len;
+	generate_spm (200 /* spm-sqn */, -1 /* trail */, 0 /* lead */, &packet, &packet_len);
+	struct pgm_header* pgmhdr = (gpointer)((struct pgm_ip*)packet + 1);
+	pgmhdr->pgm_sport = g_htons (sport);
+	generate_msghdr (packet, packet_len);
+}
+
+START_TEST (test_shard_pass_001)
+{
+	pgm_sock_t* socks[2];
+	guint16 sport[2];
+	for (guint32 index = 0; index < 2; index++) {
+		socks[index] = generate_sock();
+		fail_if (NULL == socks[index], "generate_sock failed");
+		socks[index]->rx_shard_count = 2;
+		socks[index]->rx_shard_index = index;
+		sport[index] = shard_sport (socks[index]);
+	}
+	for (guint32 index = 0; index < 2; index++) {
+		pgm_sock_t* sock = socks[index];
+		guint8 buffer[ TEST_TXW_SQNS * TEST_MAX_TPDU ];
+		generate_shard_spm (sport[0]);
+		generate_shard_spm (sport[1]);
+		push_block_event ();
+		gsize bytes_read;
+		pgm_error_t* err = NULL;
+		fail_unless (PGM_IO_STATUS_TIMER_PENDING == pgm_recv (sock, buffer, sizeof(buffer), MSG_DONTWAIT, &bytes_read, &err), "recv failed");
+		fail_unless (NULL != sock->peers_list, "no peer created");
+		fail_unless (NULL == sock->peers_list->next, "peer created for another shard");
+		const pgm_peer_t* peer = sock->peers_list->data;
+		fail_unless (g_htons (sport[index]) == peer->tsi.sport, "peer of another shard");
+	}
+}
+END_TEST
+
+/* upstream packets to the sockets own TSI are never sharded */
+
+START_TEST (test_shard_pass_002)
+{
+	pgm_sock_t* sock = generate_sock();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->rx_shard_count = 2;
+	sock->rx_shard_index = 0;
+	if (is_source_sharded (sock, &sock->tsi))
+		sock->rx_shard_index = 1;
+	guint8 buffer[ TEST_TXW_SQNS * TEST_MAX_TPDU ];
+	gpointer packet; gsize packet_len;
+	generate_nak (0 /* sqn */, &packet, &packet_len);
+	generate_msghdr (packet, packet_len);
+	push_block_event ();
+	gsize bytes_read;
+	pgm_error_t* err = NULL;
+	fail_unless (PGM_IO_STATUS_TIMER_PENDING == pgm_recv (sock, buffer, sizeof(buffer), MSG_DONTWAIT, &bytes_read, &err), "recv failed");
+	fail_unless (PGM_NAK == mock_pgm_type, "NAK discarded by shard filter");
+}
+END_TEST
+
 
 static
 Suite*
@@ -1669,6 +2033,7 @@ make_test_suite (void)
 	suite_add_tcase (s, tc_peer_nak);
 	tcase_add_checked_fixture (tc_peer_nak, mock_setup, mock_teardown);
 	tcase_add_test (tc_peer_nak, test_peer_nak_pass_001);
+	tcase_add_test (tc_peer_nak, test_peer_nak_pass_002);
 
 	TCase* tc_nnak = tcase_create ("nnak");
 	suite_add_tcase (s, tc_nnak);
@@ -1745,6 +2110,34 @@ make_test_suite (void)
 	tcase_add_checked_fixture (tc_recvmsgv, mock_setup, mock_teardown);
 	tcase_add_test (tc_recvmsgv, test_recvmsgv_fail_001);
 
+	TCase* tc_recvbulk = tcase_create ("recvbulk");
+	suite_add_tcase (s, tc_recvbulk);
+	tcase_add_checked_fixture (tc_recvbulk, mock_setup, mock_teardown);
+	tcase_add_test (tc_recvbulk, test_recvbulk_fail_001);
+
+#ifdef SO_RXQ_OVFL
+	TCase* tc_rxq_drops = tcase_create ("rxq-drops");
+	suite_add_tcase (s, tc_rxq_drops);
+	tcase_add_test (tc_rxq_drops, test_rxq_drops_pass_001);
+#endif
+
+	TCase* tc_source_wanted = tcase_create ("source-wanted");
+	suite_add_tcase (s, tc_source_wanted);
+	tcase_add_test (tc_source_wanted, test_source_wanted_pass_001);
+
+	TCase* tc_shard = tcase_create ("shard");
+	suite_add_tcase (s, tc_shard);
+	tcase_add_checked_fixture (tc_shard, mock_setup, mock_teardown);
+	tcase_add_test (tc_shard, test_shard_pass_001);
+	tcase_add_test (tc_shard, test_shard_pass_002);
+
+	TCase* tc_sock_events = tcase_create ("sock-events");
+	suite_add_tcase (s, tc_sock_events);
+	tcase_add_checked_fixture (tc_sock_events, mock_setup, mock_teardown);
+	tcase_add_test (tc_sock_events, test_sock_events_pass_001);
+	tcase_add_test (tc_sock_events, test_sock_events_pass_002);
+	tcase_add_test (tc_sock_events, test_sock_events_fail_001);
+
 	return s;
 }
 
@@ -29,16 +29,111 @@
 #endif
 #include <impl/framework.h>
 
-#ifdef USE_GALOIS_SSE3
+#if defined(_MSC_VER)
+#	include <intrin.h>
+#elif defined(__i386__) || defined(__x86_64__)
 #	include <x86intrin.h>
 #endif
+#if defined(__aarch64__) || defined(_M_ARM64)
+#	include <arm_neon.h>
+#endif
+
 
 /* Vector GF(2⁸) plus-equals multiplication.
  *
  * d[] += b • s[]
+ *
+ * Vector implementations are compiled where the toolchain supports them and
+ * selected at run-time by pgm_rs_init() per the CPU feature set.
  */
 
-static
+typedef void (*pgm_gf_vec_addmul_func) (pgm_gf8_t*restrict, const pgm_gf8_t, const pgm_gf8_t*restrict, uint16_t);
+
+static void _pgm_gf_vec_addmul_scalar (pgm_gf8_t*restrict, const pgm_gf8_t, const pgm_gf8_t*restrict, uint16_t);
+static void _pgm_gf_vec_addmul_logexp (pgm_gf8_t*restrict, const pgm_gf8_t, const pgm_gf8_t*restrict, uint16_t);
+#if defined(__SSSE3__) || defined(_M_AMD64) || defined(_M_X64)
+#	define PGM_GF_HAVE_SSSE3
+static void _pgm_gf_vec_addmul_ssse3 (pgm_gf8_t*restrict, const pgm_gf8_t, const pgm_gf8_t*restrict, uint16_t);
+#endif
+#if defined(__AVX2__) || defined(_M_AMD64) || defined(_M_X64)
+#	define PGM_GF_HAVE_AVX2
+static void _pgm_gf_vec_addmul_avx2 (pgm_gf8_t*restrict, const pgm_gf8_t, const pgm_gf8_t*restrict, uint16_t);
+#endif
+#if defined(__AVX512BW__) || (defined(_MSC_VER) && (_MSC_VER >= 1920) && defined(_M_X64))
+#	define PGM_GF_HAVE_AVX512BW
+static void _pgm_gf_vec_addmul_avx512bw (pgm_gf8_t*restrict, const pgm_gf8_t, const pgm_gf8_t*restrict, uint16_t);
+#endif
+#if (defined(__GFNI__) && defined(__AVX__)) || (defined(_MSC_VER) && (_MSC_VER >= 1920) && defined(_M_X64))
+#	define PGM_GF_HAVE_GFNI
+static void _pgm_gf_vec_addmul_gfni (pgm_gf8_t*restrict, const pgm_gf8_t, const pgm_gf8_t*restrict, uint16_t);
+#endif
+#if (defined(__GFNI__) && defined(__AVX512BW__)) || (defined(_MSC_VER) && (_MSC_VER >= 1920) && defined(_M_X64))
+#	define PGM_GF_HAVE_GFNI_AVX512
+static void _pgm_gf_vec_addmul_gfni_avx512 (pgm_gf8_t*restrict, const pgm_gf8_t, const pgm_gf8_t*restrict, uint16_t);
+#endif
+/* TBL with a 128-bit table register is AArch64 only */
+#if defined(__aarch64__) || defined(_M_ARM64)
+#	define PGM_GF_HAVE_NEON
+static void _pgm_gf_vec_addmul_neon (pgm_gf8_t*restrict, const pgm_gf8_t, const pgm_gf8_t*restrict, uint16_t);
+#endif
+
+/* the nibble table is built by pgm_rs_init(), log/exp needs no set up */
+static pgm_gf_vec_addmul_func gf_vec_addmul = _pgm_gf_vec_addmul_logexp;
+
+/* Vector GF(2⁸) dot product of k source vectors from offset.
+ *
+ *         k-1
+ * d[] =    ∑  c_j • s_j[]
+ *         j=0
+ *
+ * blocked over the vector length so that each block of d is summed in
+ * registers across all k sources and stored once, rather than loaded and
+ * stored per source as repeated plus-equals multiplication would.
+ */
+
+typedef void (*pgm_gf_vec_dotprod_func) (pgm_gf8_t*restrict, const pgm_gf8_t*restrict, const pgm_gf8_t*const*restrict, const uint8_t, const uint16_t, uint16_t);
+
+static void _pgm_gf_vec_dotprod_scalar (pgm_gf8_t*restrict, const pgm_gf8_t*restrict, const pgm_gf8_t*const*restrict, const uint8_t, const uint16_t, uint16_t);
+static void _pgm_gf_vec_dotprod_logexp (pgm_gf8_t*restrict, const pgm_gf8_t*restrict, const pgm_gf8_t*const*restrict, const uint8_t, const uint16_t, uint16_t);
+#ifdef PGM_GF_HAVE_SSSE3
+static void _pgm_gf_vec_dotprod_ssse3 (pgm_gf8_t*restrict, const pgm_gf8_t*restrict, const pgm_gf8_t*const*restrict, const uint8_t, const uint16_t, uint16_t);
+#endif
+#ifdef PGM_GF_HAVE_AVX2
+static void _pgm_gf_vec_dotprod_avx2 (pgm_gf8_t*restrict, const pgm_gf8_t*restrict, const pgm_gf8_t*const*restrict, const uint8_t, const uint16_t, uint16_t);
+#endif
+#ifdef PGM_GF_HAVE_AVX512BW
+static void _pgm_gf_vec_dotprod_avx512bw (pgm_gf8_t*restrict, const pgm_gf8_t*restrict, const pgm_gf8_t*const*restrict, const uint8_t, const uint16_t, uint16_t);
+#endif
+#ifdef PGM_GF_HAVE_GFNI
+static void _pgm_gf_vec_dotprod_gfni (pgm_gf8_t*restrict, const pgm_gf8_t*restrict, const pgm_gf8_t*const*restrict, const uint8_t, const uint16_t, uint16_t);
+#endif
+#ifdef PGM_GF_HAVE_GFNI_AVX512
+static void _pgm_gf_vec_dotprod_gfni_avx512 (pgm_gf8_t*restrict, const pgm_gf8_t*restrict, const pgm_gf8_t*const*restrict, const uint8_t, const uint16_t, uint16_t);
+#endif
+#ifdef PGM_GF_HAVE_NEON
+static void _pgm_gf_vec_dotprod_neon (pgm_gf8_t*restrict, const pgm_gf8_t*restrict, const pgm_gf8_t*const*restrict, const uint8_t, const uint16_t, uint16_t);
+#endif
+
+static pgm_gf_vec_dotprod_func gf_vec_dotprod = _pgm_gf_vec_dotprod_logexp;
+
+/* bytes of d summed per block of the scalar dot product */
+#define PGM_GF_DOTPROD_BLOCK	256
+
+/* products of each field element with every 4-bit value, both nibbles, for
+ * the byte shuffle and scalar implementations, 8 KB in total.
+ */
+static struct {
+	pgm_gf8_t	lo[PGM_GF_NO_ELEMENTS][16];
+	pgm_gf8_t	hi[PGM_GF_NO_ELEMENTS][16];
+} gf_nibble_table;
+
+/* multiplication by each field element as an 8×8 bit matrix over GF(2) for
+ * GF2P8AFFINEQB, row for result bit i in byte 7 - i.  GF2P8MULB itself
+ * cannot be used as it is fixed to the AES polynomial.
+ */
+static uint64_t gf_affine_table[PGM_GF_NO_ELEMENTS];
+
+static inline
 void
 _pgm_gf_vec_addmul (
 	pgm_gf8_t*	 restrict d,
@@ -47,99 +142,935 @@ _pgm_gf_vec_addmul (
 	uint16_t		  len	/* length of vectors */
 	)
 {
-	uint_fast16_t i;
-#ifdef USE_GALOIS_SSE3
-	uint_fast16_t count16;
-#else
-	uint_fast16_t count8;
-#endif
-
 	if (PGM_UNLIKELY(b == 0))
 		return;
+	gf_vec_addmul (d, b, s, len);
+}
 
-#ifdef USE_GALOIS_MUL_LUT
-        const pgm_gf8_t* gfmul_b = &pgm_gftable[ (uint16_t)b << 8 ];
-#endif
-
-/* Implementation per the Intel IPP whitepaper
- * The Use of Finite Field GF(256) in the Performance Primitives (2008)
+/* shared with the sliding window codec.
  */
-#ifdef USE_GALOIS_SSE3
-	i = 0;
-	count16 = len >> 4;		/* 16-way unrolls */
-	if (count16)
-	{
-/* generate nibble size lookup table for feeding into SSE3 instruction PSHUFB */
-		struct {
-			pgm_gf8_t hi[PGM_GF_NO_ELEMENTS][16];
-			pgm_gf8_t lo[PGM_GF_NO_ELEMENTS][16];
-		} nibble_gftable;
-		for (int i = 0; i < PGM_GF_NO_ELEMENTS; i++) {
-			for (int j = 0; j < 16; j++) {
-				nibble_gftable.hi[i][j] = pgm_gfmul (i, j << 4);
-				nibble_gftable.lo[i][j] = pgm_gfmul (i, j);
-			}
-		}
 
-/* operate on GF((2^4)^2) */
-		const __m128i hi = _mm_loadu_si128 ((const __m128i*)nibble_gftable.hi[ b ]);
-		const __m128i lo = _mm_loadu_si128 ((const __m128i*)nibble_gftable.lo[ b ]);
-		const __m128i nibble_mask = _mm_set1_epi8 (0x0f);
-		while (count16--) {
-			const __m128i dst = _mm_load_si128 ((__m128i *)(&d[i]));
-			const __m128i src = _mm_load_si128 ((__m128i *)(&s[i]));
-			__m128i tmp = _mm_shuffle_epi8 (lo, _mm_and_si128 (nibble_mask, src));
-			tmp = _mm_xor_si128 (tmp, _mm_shuffle_epi8 (hi, _mm_and_si128 (nibble_mask, _mm_srli_epi64 (src, 4))));
+PGM_GNUC_INTERNAL
+void
+pgm_gf_vec_addmul (
+	pgm_gf8_t*	 restrict d,
+	const pgm_gf8_t		  b,
+	const pgm_gf8_t* restrict s,
+	uint16_t		  len
+	)
+{
+	_pgm_gf_vec_addmul (d, b, s, len);
+}
 
-			tmp = _mm_xor_si128 (dst, tmp);
-			_mm_store_si128 ((__m128i *)(&d[i]), tmp);
-			i += 16;
-		}
+/* split nibble table lookup, 32 bytes per coefficient rather than a 256 byte
+ * row of the 64 KB pgm_gftable, keeping repair bursts out of the cache.
+ */
 
-/* remaining */
-		len %= 16;
-	}
-#else
+static
+void
+_pgm_gf_vec_addmul_scalar (
+	pgm_gf8_t*	 restrict d,
+	const pgm_gf8_t		  b,
+	const pgm_gf8_t* restrict s,
+	uint16_t		  len	/* length of vectors */
+	)
+{
+	const pgm_gf8_t* restrict lo = gf_nibble_table.lo[ b ];
+	const pgm_gf8_t* restrict hi = gf_nibble_table.hi[ b ];
+	uint_fast16_t i;
+	uint_fast16_t count8;
+
+#define GFMUL_B(x)	(lo[ (x) & 0x0f ] ^ hi[ (x) >> 4 ])
 	i = 0;
 	count8 = len >> 3;		/* 8-way unrolls */
 	if (count8)
 	{
 		while (count8--) {
-#	ifdef USE_GALOIS_MUL_LUT
-			d[i  ] ^= gfmul_b[ s[i  ] ];
-			d[i+1] ^= gfmul_b[ s[i+1] ];
-			d[i+2] ^= gfmul_b[ s[i+2] ];
-			d[i+3] ^= gfmul_b[ s[i+3] ];
-			d[i+4] ^= gfmul_b[ s[i+4] ];
-			d[i+5] ^= gfmul_b[ s[i+5] ];
-			d[i+6] ^= gfmul_b[ s[i+6] ];
-			d[i+7] ^= gfmul_b[ s[i+7] ];
-#	else
-			d[i  ] ^= gfmul( b, s[i  ] );
-			d[i+1] ^= gfmul( b, s[i+1] );
-			d[i+2] ^= gfmul( b, s[i+2] );
-			d[i+3] ^= gfmul( b, s[i+3] );
-			d[i+4] ^= gfmul( b, s[i+4] );
-			d[i+5] ^= gfmul( b, s[i+5] );
-			d[i+6] ^= gfmul( b, s[i+6] );
-			d[i+7] ^= gfmul( b, s[i+7] );
-#	endif
+			d[i  ] ^= GFMUL_B( s[i  ] );
+			d[i+1] ^= GFMUL_B( s[i+1] );
+			d[i+2] ^= GFMUL_B( s[i+2] );
+			d[i+3] ^= GFMUL_B( s[i+3] );
+			d[i+4] ^= GFMUL_B( s[i+4] );
+			d[i+5] ^= GFMUL_B( s[i+5] );
+			d[i+6] ^= GFMUL_B( s[i+6] );
+			d[i+7] ^= GFMUL_B( s[i+7] );
 			i += 8;
 		}
 
 /* remaining */
 		len %= 8;
 	}
-#endif
 
 	while (len--) {
-#ifdef USE_GALOIS_MUL_LUT
-		d[i] ^= gfmul_b[ s[i] ];
-#else
-		d[i] ^= gfmul( b, s[i] );
-#endif
+		d[i] ^= GFMUL_B( s[i] );
 		i++;
 	}
+#undef GFMUL_B
+}
+
+/* logarithm and antilogarithm tables only, 512 bytes shared by all
+ * coefficients at the cost of a branch and modulo per byte.
+ */
+
+static
+void
+_pgm_gf_vec_addmul_logexp (
+	pgm_gf8_t*	 restrict d,
+	const pgm_gf8_t		  b,
+	const pgm_gf8_t* restrict s,
+	uint16_t		  len	/* length of vectors */
+	)
+{
+	const unsigned log_b = pgm_gflog[ b ];
+
+	for (uint_fast16_t i = 0; i < len; i++) {
+		if (0 == s[i])
+			continue;
+		const unsigned sum = log_b + pgm_gflog[ s[i] ];
+		d[i] ^= sum >= PGM_GF_MAX ? pgm_gfantilog[ sum - PGM_GF_MAX ] : pgm_gfantilog[ sum ];
+	}
+}
+
+/* Implementation per the Intel IPP whitepaper
+ * The Use of Finite Field GF(256) in the Performance Primitives (2008)
+ *
+ * operate on GF((2^4)^2), PSHUFB is a 16 entry table lookup per nibble.
+ */
+
+#ifdef PGM_GF_HAVE_SSSE3
+static
+void
+_pgm_gf_vec_addmul_ssse3 (
+	pgm_gf8_t*	 restrict d,
+	const pgm_gf8_t		  b,
+	const pgm_gf8_t* restrict s,
+	uint16_t		  len
+	)
+{
+	const __m128i lo = _mm_loadu_si128 ((const __m128i*)gf_nibble_table.lo[ b ]);
+	const __m128i hi = _mm_loadu_si128 ((const __m128i*)gf_nibble_table.hi[ b ]);
+	const __m128i nibble_mask = _mm_set1_epi8 (0x0f);
+	uint_fast16_t i = 0;
+
+	for (; len - i >= 16; i += 16) {
+		const __m128i src = _mm_loadu_si128 ((const __m128i*)&s[i]);
+		__m128i tmp = _mm_shuffle_epi8 (lo, _mm_and_si128 (nibble_mask, src));
+		tmp = _mm_xor_si128 (tmp, _mm_shuffle_epi8 (hi, _mm_and_si128 (nibble_mask, _mm_srli_epi64 (src, 4))));
+		_mm_storeu_si128 ((__m128i*)&d[i], _mm_xor_si128 (_mm_loadu_si128 ((const __m128i*)&d[i]), tmp));
+	}
+	if (i < len)
+		_pgm_gf_vec_addmul_scalar (&d[i], b, &s[i], len - i);
+}
+#endif
+
+#ifdef PGM_GF_HAVE_AVX2
+static
+void
+_pgm_gf_vec_addmul_avx2 (
+	pgm_gf8_t*	 restrict d,
+	const pgm_gf8_t		  b,
+	const pgm_gf8_t* restrict s,
+	uint16_t		  len
+	)
+{
+/* VPSHUFB looks up within each 128-bit lane */
+	const __m256i lo = _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i*)gf_nibble_table.lo[ b ]));
+	const __m256i hi = _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i*)gf_nibble_table.hi[ b ]));
+	const __m256i nibble_mask = _mm256_set1_epi8 (0x0f);
+	uint_fast16_t i = 0;
+
+	for (; len - i >= 32; i += 32) {
+		const __m256i src = _mm256_loadu_si256 ((const __m256i*)&s[i]);
+		__m256i tmp = _mm256_shuffle_epi8 (lo, _mm256_and_si256 (nibble_mask, src));
+		tmp = _mm256_xor_si256 (tmp, _mm256_shuffle_epi8 (hi, _mm256_and_si256 (nibble_mask, _mm256_srli_epi64 (src, 4))));
+		_mm256_storeu_si256 ((__m256i*)&d[i], _mm256_xor_si256 (_mm256_loadu_si256 ((const __m256i*)&d[i]), tmp));
+	}
+	if (i < len)
+		_pgm_gf_vec_addmul_scalar (&d[i], b, &s[i], len - i);
+}
+#endif
+
+#ifdef PGM_GF_HAVE_AVX512BW
+static
+void
+_pgm_gf_vec_addmul_avx512bw (
+	pgm_gf8_t*	 restrict d,
+	const pgm_gf8_t		  b,
+	const pgm_gf8_t* restrict s,
+	uint16_t		  len
+	)
+{
+	const __m512i lo = _mm512_broadcast_i32x4 (_mm_loadu_si128 ((const __m128i*)gf_nibble_table.lo[ b ]));
+	const __m512i hi = _mm512_broadcast_i32x4 (_mm_loadu_si128 ((const __m128i*)gf_nibble_table.hi[ b ]));
+	const __m512i nibble_mask = _mm512_set1_epi8 (0x0f);
+	uint_fast16_t i = 0;
+
+	for (; len - i >= 64; i += 64) {
+		const __m512i src = _mm512_loadu_si512 ((const void*)&s[i]);
+		__m512i tmp = _mm512_shuffle_epi8 (lo, _mm512_and_si512 (nibble_mask, src));
+		tmp = _mm512_xor_si512 (tmp, _mm512_shuffle_epi8 (hi, _mm512_and_si512 (nibble_mask, _mm512_srli_epi64 (src, 4))));
+		_mm512_storeu_si512 ((void*)&d[i], _mm512_xor_si512 (_mm512_loadu_si512 ((const void*)&d[i]), tmp));
+	}
+	if (i < len)
+		_pgm_gf_vec_addmul_scalar (&d[i], b, &s[i], len - i);
+}
+#endif
+
+#ifdef PGM_GF_HAVE_GFNI
+static
+void
+_pgm_gf_vec_addmul_gfni (
+	pgm_gf8_t*	 restrict d,
+	const pgm_gf8_t		  b,
+	const pgm_gf8_t* restrict s,
+	uint16_t		  len
+	)
+{
+	const __m256i matrix = _mm256_set1_epi64x ((long long)gf_affine_table[ b ]);
+	uint_fast16_t i = 0;
+
+	for (; len - i >= 32; i += 32) {
+		const __m256i src = _mm256_loadu_si256 ((const __m256i*)&s[i]);
+		const __m256i tmp = _mm256_gf2p8affine_epi64_epi8 (src, matrix, 0);
+		_mm256_storeu_si256 ((__m256i*)&d[i], _mm256_xor_si256 (_mm256_loadu_si256 ((const __m256i*)&d[i]), tmp));
+	}
+	if (i < len)
+		_pgm_gf_vec_addmul_scalar (&d[i], b, &s[i], len - i);
+}
+#endif
+
+#ifdef PGM_GF_HAVE_GFNI_AVX512
+static
+void
+_pgm_gf_vec_addmul_gfni_avx512 (
+	pgm_gf8_t*	 restrict d,
+	const pgm_gf8_t		  b,
+	const pgm_gf8_t* restrict s,
+	uint16_t		  len
+	)
+{
+	const __m512i matrix = _mm512_set1_epi64 ((long long)gf_affine_table[ b ]);
+	uint_fast16_t i = 0;
+
+	for (; len - i >= 64; i += 64) {
+		const __m512i src = _mm512_loadu_si512 ((const void*)&s[i]);
+		const __m512i tmp = _mm512_gf2p8affine_epi64_epi8 (src, matrix, 0);
+		_mm512_storeu_si512 ((void*)&d[i], _mm512_xor_si512 (_mm512_loadu_si512 ((const void*)&d[i]), tmp));
+	}
+	if (i < len)
+		_pgm_gf_vec_addmul_scalar (&d[i], b, &s[i], len - i);
+}
+#endif
+
+#ifdef PGM_GF_HAVE_NEON
+static
+void
+_pgm_gf_vec_addmul_neon (
+	pgm_gf8_t*	 restrict d,
+	const pgm_gf8_t		  b,
+	const pgm_gf8_t* restrict s,
+	uint16_t		  len
+	)
+{
+	const uint8x16_t lo = vld1q_u8 (gf_nibble_table.lo[ b ]);
+	const uint8x16_t hi = vld1q_u8 (gf_nibble_table.hi[ b ]);
+	const uint8x16_t nibble_mask = vdupq_n_u8 (0x0f);
+	uint_fast16_t i = 0;
+
+	for (; len - i >= 16; i += 16) {
+		const uint8x16_t src = vld1q_u8 (&s[i]);
+		uint8x16_t tmp = vqtbl1q_u8 (lo, vandq_u8 (src, nibble_mask));
+		tmp = veorq_u8 (tmp, vqtbl1q_u8 (hi, vshrq_n_u8 (src, 4)));
+		vst1q_u8 (&d[i], veorq_u8 (vld1q_u8 (&d[i]), tmp));
+	}
+	if (i < len)
+		_pgm_gf_vec_addmul_scalar (&d[i], b, &s[i], len - i);
+}
+#endif
+
+/* Dot product kernels, each block is four vector registers wide and the
+ * remainder falls back to single vectors and finally the scalar
+ * implementation.
+ */
+
+static
+void
+_pgm_gf_vec_dotprod_scalar (
+	pgm_gf8_t*		restrict d,
+	const pgm_gf8_t*	restrict c,	/* length k */
+	const pgm_gf8_t*const*	restrict s,	/* length k */
+	const uint8_t			 k,
+	const uint16_t			 offset,
+	uint16_t			 len
+	)
+{
+	for (uint_fast16_t i = 0; i < len; i += PGM_GF_DOTPROD_BLOCK)
+	{
+		const uint16_t block = (uint16_t)MIN(PGM_GF_DOTPROD_BLOCK, len - i);
+		memset (&d[i], 0, block);
+		for (uint_fast8_t j = 0; j < k; j++)
+			if (0 != c[j])
+				_pgm_gf_vec_addmul_scalar (&d[i], c[j], &s[j][offset + i], block);
+	}
+}
+
+static
+void
+_pgm_gf_vec_dotprod_logexp (
+	pgm_gf8_t*		restrict d,
+	const pgm_gf8_t*	restrict c,	/* length k */
+	const pgm_gf8_t*const*	restrict s,	/* length k */
+	const uint8_t			 k,
+	const uint16_t			 offset,
+	uint16_t			 len
+	)
+{
+	for (uint_fast16_t i = 0; i < len; i += PGM_GF_DOTPROD_BLOCK)
+	{
+		const uint16_t block = (uint16_t)MIN(PGM_GF_DOTPROD_BLOCK, len - i);
+		memset (&d[i], 0, block);
+		for (uint_fast8_t j = 0; j < k; j++)
+			if (0 != c[j])
+				_pgm_gf_vec_addmul_logexp (&d[i], c[j], &s[j][offset + i], block);
+	}
+}
+
+#ifdef PGM_GF_HAVE_SSSE3
+static inline
+__m128i
+_pgm_gf_mul_ssse3 (
+	const __m128i	lo,
+	const __m128i	hi,
+	const __m128i	nibble_mask,
+	const __m128i	src
+	)
+{
+	return _mm_xor_si128 (_mm_shuffle_epi8 (lo, _mm_and_si128 (nibble_mask, src)),
+			      _mm_shuffle_epi8 (hi, _mm_and_si128 (nibble_mask, _mm_srli_epi64 (src, 4))));
+}
+
+static
+void
+_pgm_gf_vec_dotprod_ssse3 (
+	pgm_gf8_t*		restrict d,
+	const pgm_gf8_t*	restrict c,
+	const pgm_gf8_t*const*	restrict s,
+	const uint8_t			 k,
+	const uint16_t			 offset,
+	uint16_t			 len
+	)
+{
+	const __m128i nibble_mask = _mm_set1_epi8 (0x0f);
+	uint_fast16_t i = 0;
+
+	for (; len - i >= 64; i += 64) {
+		__m128i acc0 = _mm_setzero_si128 (), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+		for (uint_fast8_t j = 0; j < k; j++) {
+			if (0 == c[j])
+				continue;
+			const __m128i lo = _mm_loadu_si128 ((const __m128i*)gf_nibble_table.lo[ c[j] ]);
+			const __m128i hi = _mm_loadu_si128 ((const __m128i*)gf_nibble_table.hi[ c[j] ]);
+			const __m128i* src = (const __m128i*)&s[j][offset + i];
+			acc0 = _mm_xor_si128 (acc0, _pgm_gf_mul_ssse3 (lo, hi, nibble_mask, _mm_loadu_si128 (&src[0])));
+			acc1 = _mm_xor_si128 (acc1, _pgm_gf_mul_ssse3 (lo, hi, nibble_mask, _mm_loadu_si128 (&src[1])));
+			acc2 = _mm_xor_si128 (acc2, _pgm_gf_mul_ssse3 (lo, hi, nibble_mask, _mm_loadu_si128 (&src[2])));
+			acc3 = _mm_xor_si128 (acc3, _pgm_gf_mul_ssse3 (lo, hi, nibble_mask, _mm_loadu_si128 (&src[3])));
+		}
+		_mm_storeu_si128 ((__m128i*)&d[i     ], acc0);
+		_mm_storeu_si128 ((__m128i*)&d[i + 16], acc1);
+		_mm_storeu_si128 ((__m128i*)&d[i + 32], acc2);
+		_mm_storeu_si128 ((__m128i*)&d[i + 48], acc3);
+	}
+	for (; i < len && len >= 16; i += 16) {
+/* a final partial vector overlaps the previous, products are stored not accumulated */
+		if (len - i < 16)
+			i = len - 16;
+		__m128i acc = _mm_setzero_si128 ();
+		for (uint_fast8_t j = 0; j < k; j++) {
+			if (0 == c[j])
+				continue;
+			const __m128i lo = _mm_loadu_si128 ((const __m128i*)gf_nibble_table.lo[ c[j] ]);
+			const __m128i hi = _mm_loadu_si128 ((const __m128i*)gf_nibble_table.hi[ c[j] ]);
+			acc = _mm_xor_si128 (acc, _pgm_gf_mul_ssse3 (lo, hi, nibble_mask, _mm_loadu_si128 ((const __m128i*)&s[j][offset + i])));
+		}
+		_mm_storeu_si128 ((__m128i*)&d[i], acc);
+	}
+	if (i < len)
+		_pgm_gf_vec_dotprod_scalar (&d[i], c, s, k, (uint16_t)(offset + i), (uint16_t)(len - i));
+}
+#endif
+
+#ifdef PGM_GF_HAVE_AVX2
+static inline
+__m256i
+_pgm_gf_mul_avx2 (
+	const __m256i	lo,
+	const __m256i	hi,
+	const __m256i	nibble_mask,
+	const __m256i	src
+	)
+{
+	return _mm256_xor_si256 (_mm256_shuffle_epi8 (lo, _mm256_and_si256 (nibble_mask, src)),
+				 _mm256_shuffle_epi8 (hi, _mm256_and_si256 (nibble_mask, _mm256_srli_epi64 (src, 4))));
+}
+
+static
+void
+_pgm_gf_vec_dotprod_avx2 (
+	pgm_gf8_t*		restrict d,
+	const pgm_gf8_t*	restrict c,
+	const pgm_gf8_t*const*	restrict s,
+	const uint8_t			 k,
+	const uint16_t			 offset,
+	uint16_t			 len
+	)
+{
+	const __m256i nibble_mask = _mm256_set1_epi8 (0x0f);
+	uint_fast16_t i = 0;
+
+	for (; len - i >= 128; i += 128) {
+		__m256i acc0 = _mm256_setzero_si256 (), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+		for (uint_fast8_t j = 0; j < k; j++) {
+			if (0 == c[j])
+				continue;
+			const __m256i lo = _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i*)gf_nibble_table.lo[ c[j] ]));
+			const __m256i hi = _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i*)gf_nibble_table.hi[ c[j] ]));
+			const __m256i* src = (const __m256i*)&s[j][offset + i];
+			acc0 = _mm256_xor_si256 (acc0, _pgm_gf_mul_avx2 (lo, hi, nibble_mask, _mm256_loadu_si256 (&src[0])));
+			acc1 = _mm256_xor_si256 (acc1, _pgm_gf_mul_avx2 (lo, hi, nibble_mask, _mm256_loadu_si256 (&src[1])));
+			acc2 = _mm256_xor_si256 (acc2, _pgm_gf_mul_avx2 (lo, hi, nibble_mask, _mm256_loadu_si256 (&src[2])));
+			acc3 = _mm256_xor_si256 (acc3, _pgm_gf_mul_avx2 (lo, hi, nibble_mask, _mm256_loadu_si256 (&src[3])));
+		}
+		_mm256_storeu_si256 ((__m256i*)&d[i     ], acc0);
+		_mm256_storeu_si256 ((__m256i*)&d[i + 32], acc1);
+		_mm256_storeu_si256 ((__m256i*)&d[i + 64], acc2);
+		_mm256_storeu_si256 ((__m256i*)&d[i + 96], acc3);
+	}
+	for (; i < len && len >= 32; i += 32) {
+/* a final partial vector overlaps the previous, products are stored not accumulated */
+		if (len - i < 32)
+			i = len - 32;
+		__m256i acc = _mm256_setzero_si256 ();
+		for (uint_fast8_t j = 0; j < k; j++) {
+			if (0 == c[j])
+				continue;
+			const __m256i lo = _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i*)gf_nibble_table.lo[ c[j] ]));
+			const __m256i hi = _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i*)gf_nibble_table.hi[ c[j] ]));
+			acc = _mm256_xor_si256 (acc, _pgm_gf_mul_avx2 (lo, hi, nibble_mask, _mm256_loadu_si256 ((const __m256i*)&s[j][offset + i])));
+		}
+		_mm256_storeu_si256 ((__m256i*)&d[i], acc);
+	}
+	if (i < len)
+		_pgm_gf_vec_dotprod_scalar (&d[i], c, s, k, (uint16_t)(offset + i), (uint16_t)(len - i));
+}
+#endif
+
+#ifdef PGM_GF_HAVE_AVX512BW
+static inline
+__m512i
+_pgm_gf_mul_avx512bw (
+	const __m512i	lo,
+	const __m512i	hi,
+	const __m512i	nibble_mask,
+	const __m512i	src
+	)
+{
+	return _mm512_xor_si512 (_mm512_shuffle_epi8 (lo, _mm512_and_si512 (nibble_mask, src)),
+				 _mm512_shuffle_epi8 (hi, _mm512_and_si512 (nibble_mask, _mm512_srli_epi64 (src, 4))));
+}
+
+static
+void
+_pgm_gf_vec_dotprod_avx512bw (
+	pgm_gf8_t*		restrict d,
+	const pgm_gf8_t*	restrict c,
+	const pgm_gf8_t*const*	restrict s,
+	const uint8_t			 k,
+	const uint16_t			 offset,
+	uint16_t			 len
+	)
+{
+	const __m512i nibble_mask = _mm512_set1_epi8 (0x0f);
+	uint_fast16_t i = 0;
+
+	for (; len - i >= 256; i += 256) {
+		__m512i acc0 = _mm512_setzero_si512 (), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+		for (uint_fast8_t j = 0; j < k; j++) {
+			if (0 == c[j])
+				continue;
+			const __m512i lo = _mm512_broadcast_i32x4 (_mm_loadu_si128 ((const __m128i*)gf_nibble_table.lo[ c[j] ]));
+			const __m512i hi = _mm512_broadcast_i32x4 (_mm_loadu_si128 ((const __m128i*)gf_nibble_table.hi[ c[j] ]));
+			const pgm_gf8_t* src = &s[j][offset + i];
+			acc0 = _mm512_xor_si512 (acc0, _pgm_gf_mul_avx512bw (lo, hi, nibble_mask, _mm512_loadu_si512 ((const void*)&src[  0])));
+			acc1 = _mm512_xor_si512 (acc1, _pgm_gf_mul_avx512bw (lo, hi, nibble_mask, _mm512_loadu_si512 ((const void*)&src[ 64])));
+			acc2 = _mm512_xor_si512 (acc2, _pgm_gf_mul_avx512bw (lo, hi, nibble_mask, _mm512_loadu_si512 ((const void*)&src[128])));
+			acc3 = _mm512_xor_si512 (acc3, _pgm_gf_mul_avx512bw (lo, hi, nibble_mask, _mm512_loadu_si512 ((const void*)&src[192])));
+		}
+		_mm512_storeu_si512 ((void*)&d[i      ], acc0);
+		_mm512_storeu_si512 ((void*)&d[i +  64], acc1);
+		_mm512_storeu_si512 ((void*)&d[i + 128], acc2);
+		_mm512_storeu_si512 ((void*)&d[i + 192], acc3);
+	}
+	for (; i < len && len >= 64; i += 64) {
+/* a final partial vector overlaps the previous, products are stored not accumulated */
+		if (len - i < 64)
+			i = len - 64;
+		__m512i acc = _mm512_setzero_si512 ();
+		for (uint_fast8_t j = 0; j < k; j++) {
+			if (0 == c[j])
+				continue;
+			const __m512i lo = _mm512_broadcast_i32x4 (_mm_loadu_si128 ((const __m128i*)gf_nibble_table.lo[ c[j] ]));
+			const __m512i hi = _mm512_broadcast_i32x4 (_mm_loadu_si128 ((const __m128i*)gf_nibble_table.hi[ c[j] ]));
+			acc = _mm512_xor_si512 (acc, _pgm_gf_mul_avx512bw (lo, hi, nibble_mask, _mm512_loadu_si512 ((const void*)&s[j][offset + i])));
+		}
+		_mm512_storeu_si512 ((void*)&d[i], acc);
+	}
+	if (i < len)
+		_pgm_gf_vec_dotprod_scalar (&d[i], c, s, k, (uint16_t)(offset + i), (uint16_t)(len - i));
+}
+#endif
+
+#ifdef PGM_GF_HAVE_GFNI
+static
+void
+_pgm_gf_vec_dotprod_gfni (
+	pgm_gf8_t*		restrict d,
+	const pgm_gf8_t*	restrict c,
+	const pgm_gf8_t*const*	restrict s,
+	const uint8_t			 k,
+	const uint16_t			 offset,
+	uint16_t			 len
+	)
+{
+	uint_fast16_t i = 0;
+
+	for (; len - i >= 128; i += 128) {
+		__m256i acc0 = _mm256_setzero_si256 (), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+		for (uint_fast8_t j = 0; j < k; j++) {
+			if (0 == c[j])
+				continue;
+			const __m256i matrix = _mm256_set1_epi64x ((long long)gf_affine_table[ c[j] ]);
+			const __m256i* src = (const __m256i*)&s[j][offset + i];
+			acc0 = _mm256_xor_si256 (acc0, _mm256_gf2p8affine_epi64_epi8 (_mm256_loadu_si256 (&src[0]), matrix, 0));
+			acc1 = _mm256_xor_si256 (acc1, _mm256_gf2p8affine_epi64_epi8 (_mm256_loadu_si256 (&src[1]), matrix, 0));
+			acc2 = _mm256_xor_si256 (acc2, _mm256_gf2p8affine_epi64_epi8 (_mm256_loadu_si256 (&src[2]), matrix, 0));
+			acc3 = _mm256_xor_si256 (acc3, _mm256_gf2p8affine_epi64_epi8 (_mm256_loadu_si256 (&src[3]), matrix, 0));
+		}
+		_mm256_storeu_si256 ((__m256i*)&d[i     ], acc0);
+		_mm256_storeu_si256 ((__m256i*)&d[i + 32], acc1);
+		_mm256_storeu_si256 ((__m256i*)&d[i + 64], acc2);
+		_mm256_storeu_si256 ((__m256i*)&d[i + 96], acc3);
+	}
+	for (; i < len && len >= 32; i += 32) {
+/* a final partial vector overlaps the previous, products are stored not accumulated */
+		if (len - i < 32)
+			i = len - 32;
+		__m256i acc = _mm256_setzero_si256 ();
+		for (uint_fast8_t j = 0; j < k; j++) {
+			if (0 == c[j])
+				continue;
+			const __m256i matrix = _mm256_set1_epi64x ((long long)gf_affine_table[ c[j] ]);
+			acc = _mm256_xor_si256 (acc, _mm256_gf2p8affine_epi64_epi8 (_mm256_loadu_si256 ((const __m256i*)&s[j][offset + i]), matrix, 0));
+		}
+		_mm256_storeu_si256 ((__m256i*)&d[i], acc);
+	}
+	if (i < len)
+		_pgm_gf_vec_dotprod_scalar (&d[i], c, s, k, (uint16_t)(offset + i), (uint16_t)(len - i));
+}
+#endif
+
+#ifdef PGM_GF_HAVE_GFNI_AVX512
+static
+void
+_pgm_gf_vec_dotprod_gfni_avx512 (
+	pgm_gf8_t*		restrict d,
+	const pgm_gf8_t*	restrict c,
+	const pgm_gf8_t*const*	restrict s,
+	const uint8_t			 k,
+	const uint16_t			 offset,
+	uint16_t			 len
+	)
+{
+	uint_fast16_t i = 0;
+
+	for (; len - i >= 256; i += 256) {
+		__m512i acc0 = _mm512_setzero_si512 (), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+		for (uint_fast8_t j = 0; j < k; j++) {
+			if (0 == c[j])
+				continue;
+			const __m512i matrix = _mm512_set1_epi64 ((long long)gf_affine_table[ c[j] ]);
+			const pgm_gf8_t* src = &s[j][offset + i];
+			acc0 = _mm512_xor_si512 (acc0, _mm512_gf2p8affine_epi64_epi8 (_mm512_loadu_si512 ((const void*)&src[  0]), matrix, 0));
+			acc1 = _mm512_xor_si512 (acc1, _mm512_gf2p8affine_epi64_epi8 (_mm512_loadu_si512 ((const void*)&src[ 64]), matrix, 0));
+			acc2 = _mm512_xor_si512 (acc2, _mm512_gf2p8affine_epi64_epi8 (_mm512_loadu_si512 ((const void*)&src[128]), matrix, 0));
+			acc3 = _mm512_xor_si512 (acc3, _mm512_gf2p8affine_epi64_epi8 (_mm512_loadu_si512 ((const void*)&src[192]), matrix, 0));
+		}
+		_mm512_storeu_si512 ((void*)&d[i      ], acc0);
+		_mm512_storeu_si512 ((void*)&d[i +  64], acc1);
+		_mm512_storeu_si512 ((void*)&d[i + 128], acc2);
+		_mm512_storeu_si512 ((void*)&d[i + 192], acc3);
+	}
+	for (; i < len && len >= 64; i += 64) {
+/* a final partial vector overlaps the previous, products are stored not accumulated */
+		if (len - i < 64)
+			i = len - 64;
+		__m512i acc = _mm512_setzero_si512 ();
+		for (uint_fast8_t j = 0; j < k; j++) {
+			if (0 == c[j])
+				continue;
+			const __m512i matrix = _mm512_set1_epi64 ((long long)gf_affine_table[ c[j] ]);
+			acc = _mm512_xor_si512 (acc, _mm512_gf2p8affine_epi64_epi8 (_mm512_loadu_si512 ((const void*)&s[j][offset + i]), matrix, 0));
+		}
+		_mm512_storeu_si512 ((void*)&d[i], acc);
+	}
+	if (i < len)
+		_pgm_gf_vec_dotprod_scalar (&d[i], c, s, k, (uint16_t)(offset + i), (uint16_t)(len - i));
+}
+#endif
+
+#ifdef PGM_GF_HAVE_NEON
+static inline
+uint8x16_t
+_pgm_gf_mul_neon (
+	const uint8x16_t	lo,
+	const uint8x16_t	hi,
+	const uint8x16_t	nibble_mask,
+	const uint8x16_t	src
+	)
+{
+	return veorq_u8 (vqtbl1q_u8 (lo, vandq_u8 (src, nibble_mask)), vqtbl1q_u8 (hi, vshrq_n_u8 (src, 4)));
+}
+
+static
+void
+_pgm_gf_vec_dotprod_neon (
+	pgm_gf8_t*		restrict d,
+	const pgm_gf8_t*	restrict c,
+	const pgm_gf8_t*const*	restrict s,
+	const uint8_t			 k,
+	const uint16_t			 offset,
+	uint16_t			 len
+	)
+{
+	const uint8x16_t nibble_mask = vdupq_n_u8 (0x0f);
+	uint_fast16_t i = 0;
+
+	for (; len - i >= 64; i += 64) {
+		uint8x16_t acc0 = vdupq_n_u8 (0), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+		for (uint_fast8_t j = 0; j < k; j++) {
+			if (0 == c[j])
+				continue;
+			const uint8x16_t lo = vld1q_u8 (gf_nibble_table.lo[ c[j] ]);
+			const uint8x16_t hi = vld1q_u8 (gf_nibble_table.hi[ c[j] ]);
+			const pgm_gf8_t* src = &s[j][offset + i];
+			acc0 = veorq_u8 (acc0, _pgm_gf_mul_neon (lo, hi, nibble_mask, vld1q_u8 (&src[ 0])));
+			acc1 = veorq_u8 (acc1, _pgm_gf_mul_neon (lo, hi, nibble_mask, vld1q_u8 (&src[16])));
+			acc2 = veorq_u8 (acc2, _pgm_gf_mul_neon (lo, hi, nibble_mask, vld1q_u8 (&src[32])));
+			acc3 = veorq_u8 (acc3, _pgm_gf_mul_neon (lo, hi, nibble_mask, vld1q_u8 (&src[48])));
+		}
+		vst1q_u8 (&d[i     ], acc0);
+		vst1q_u8 (&d[i + 16], acc1);
+		vst1q_u8 (&d[i + 32], acc2);
+		vst1q_u8 (&d[i + 48], acc3);
+	}
+	for (; i < len && len >= 16; i += 16) {
+/* a final partial vector overlaps the previous, products are stored not accumulated */
+		if (len - i < 16)
+			i = len - 16;
+		uint8x16_t acc = vdupq_n_u8 (0);
+		for (uint_fast8_t j = 0; j < k; j++) {
+			if (0 == c[j])
+				continue;
+			const uint8x16_t lo = vld1q_u8 (gf_nibble_table.lo[ c[j] ]);
+			const uint8x16_t hi = vld1q_u8 (gf_nibble_table.hi[ c[j] ]);
+			acc = veorq_u8 (acc, _pgm_gf_mul_neon (lo, hi, nibble_mask, vld1q_u8 (&s[j][offset + i])));
+		}
+		vst1q_u8 (&d[i], acc);
+	}
+	if (i < len)
+		_pgm_gf_vec_dotprod_scalar (&d[i], c, s, k, (uint16_t)(offset + i), (uint16_t)(len - i));
+}
+#endif
+
+/* vector multiply kernels supported by the CPU, fastest by feature set first.
+ */
+
+struct gf_kernel_t {
+	const char*		name;
+	pgm_gf_vec_addmul_func	addmul;
+	pgm_gf_vec_dotprod_func	dotprod;
+};
+
+#define GF_MAX_KERNELS		8
+
+/* encoding timed by pgm_rs_calibrate(): a transmission group of Ethernet sized TPDUs */
+#define GF_CALIBRATE_K		8
+#define GF_CALIBRATE_LEN	1500
+#define GF_CALIBRATE_CALLS	256
+#define GF_CALIBRATE_ROUNDS	3
+
+static const char* gf_kernel_name = NULL;
+static uint64_t gf_kernel_nsecs = 0;		/* per encoded parity packet, 0 = not calibrated */
+static bool gf_is_pinned = FALSE;
+
+static
+unsigned
+gf_kernels (
+	PGM_GNUC_UNUSED const pgm_cpu_t* cpu,	/* unused without vector kernels */
+	struct gf_kernel_t*		kernels
+	)
+{
+	unsigned len = 0;
+
+#ifdef PGM_GF_HAVE_GFNI_AVX512
+	if (cpu->has_gfni && cpu->has_avx512bw) {
+		kernels[len].name = "GFNI_AVX512";
+		kernels[len].addmul = _pgm_gf_vec_addmul_gfni_avx512;
+		kernels[len++].dotprod = _pgm_gf_vec_dotprod_gfni_avx512;
+	}
+#endif
+#ifdef PGM_GF_HAVE_AVX512BW
+	if (cpu->has_avx512bw) {
+		kernels[len].name = "AVX512BW";
+		kernels[len].addmul = _pgm_gf_vec_addmul_avx512bw;
+		kernels[len++].dotprod = _pgm_gf_vec_dotprod_avx512bw;
+	}
+#endif
+#ifdef PGM_GF_HAVE_GFNI
+	if (cpu->has_gfni && cpu->has_avx) {
+		kernels[len].name = "GFNI";
+		kernels[len].addmul = _pgm_gf_vec_addmul_gfni;
+		kernels[len++].dotprod = _pgm_gf_vec_dotprod_gfni;
+	}
+#endif
+#ifdef PGM_GF_HAVE_AVX2
+	if (cpu->has_avx2) {
+		kernels[len].name = "AVX2";
+		kernels[len].addmul = _pgm_gf_vec_addmul_avx2;
+		kernels[len++].dotprod = _pgm_gf_vec_dotprod_avx2;
+	}
+#endif
+#ifdef PGM_GF_HAVE_SSSE3
+	if (cpu->has_ssse3) {
+		kernels[len].name = "SSSE3";
+		kernels[len].addmul = _pgm_gf_vec_addmul_ssse3;
+		kernels[len++].dotprod = _pgm_gf_vec_dotprod_ssse3;
+	}
+#endif
+#ifdef PGM_GF_HAVE_NEON
+	if (cpu->has_neon) {
+		kernels[len].name = "NEON";
+		kernels[len].addmul = _pgm_gf_vec_addmul_neon;
+		kernels[len++].dotprod = _pgm_gf_vec_dotprod_neon;
+	}
+#endif
+	kernels[len].name = "NIBBLE";
+	kernels[len].addmul = _pgm_gf_vec_addmul_scalar;
+	kernels[len++].dotprod = _pgm_gf_vec_dotprod_scalar;
+	kernels[len].name = "LOG";
+	kernels[len].addmul = _pgm_gf_vec_addmul_logexp;
+	kernels[len++].dotprod = _pgm_gf_vec_dotprod_logexp;
+	pgm_assert (len <= GF_MAX_KERNELS);
+	return len;
+}
+
+static
+void
+gf_select (PGM_GNUC_UNUSED const pgm_cpu_t* cpu)
+{
+#ifdef PGM_GF_HAVE_GFNI_AVX512
+	if (cpu->has_gfni && cpu->has_avx512bw) {
+		pgm_minor (_("Using GFNI AVX-512 instructions for Reed-Solomon."));
+		gf_vec_addmul = _pgm_gf_vec_addmul_gfni_avx512;
+		gf_vec_dotprod = _pgm_gf_vec_dotprod_gfni_avx512;
+		return;
+	}
+#endif
+#ifdef PGM_GF_HAVE_AVX512BW
+	if (cpu->has_avx512bw) {
+		pgm_minor (_("Using AVX-512BW instructions for Reed-Solomon."));
+		gf_vec_addmul = _pgm_gf_vec_addmul_avx512bw;
+		gf_vec_dotprod = _pgm_gf_vec_dotprod_avx512bw;
+		return;
+	}
+#endif
+#ifdef PGM_GF_HAVE_GFNI
+	if (cpu->has_gfni && cpu->has_avx) {
+		pgm_minor (_("Using GFNI instructions for Reed-Solomon."));
+		gf_vec_addmul = _pgm_gf_vec_addmul_gfni;
+		gf_vec_dotprod = _pgm_gf_vec_dotprod_gfni;
+		return;
+	}
+#endif
+#ifdef PGM_GF_HAVE_AVX2
+	if (cpu->has_avx2) {
+		pgm_minor (_("Using AVX2 instructions for Reed-Solomon."));
+		gf_vec_addmul = _pgm_gf_vec_addmul_avx2;
+		gf_vec_dotprod = _pgm_gf_vec_dotprod_avx2;
+		return;
+	}
+#endif
+#ifdef PGM_GF_HAVE_SSSE3
+	if (cpu->has_ssse3) {
+		pgm_minor (_("Using SSSE3 instructions for Reed-Solomon."));
+		gf_vec_addmul = _pgm_gf_vec_addmul_ssse3;
+		gf_vec_dotprod = _pgm_gf_vec_dotprod_ssse3;
+		return;
+	}
+#endif
+#ifdef PGM_GF_HAVE_NEON
+	if (cpu->has_neon) {
+		pgm_minor (_("Using NEON instructions for Reed-Solomon."));
+		gf_vec_addmul = _pgm_gf_vec_addmul_neon;
+		gf_vec_dotprod = _pgm_gf_vec_dotprod_neon;
+		return;
+	}
+#endif
+	gf_vec_addmul = _pgm_gf_vec_addmul_scalar;
+	gf_vec_dotprod = _pgm_gf_vec_dotprod_scalar;
+}
+
+/* build the lookup tables and select the fastest vector kernels supported
+ * by the CPU, unless PGM_GF_MUL names another kernel, e.g. AVX2 as reported by
+ * a previous pgm_rs_calibrate(), or by initial LOG for the log/exp tables or
+ * NIBBLE for the split nibble tables.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_rs_init (const pgm_cpu_t* cpu)
+{
+	pgm_assert (NULL != cpu);
+
+	for (unsigned i = 0; i < PGM_GF_NO_ELEMENTS; i++) {
+		uint64_t matrix = 0;
+		for (unsigned j = 0; j < 16; j++) {
+			gf_nibble_table.lo[i][j] = pgm_gfmul ((pgm_gf8_t)i, (pgm_gf8_t)j);
+			gf_nibble_table.hi[i][j] = pgm_gfmul ((pgm_gf8_t)i, (pgm_gf8_t)(j << 4));
+		}
+		for (unsigned j = 0; j < 8; j++) {
+			const pgm_gf8_t column = pgm_gfmul ((pgm_gf8_t)i, (pgm_gf8_t)(1 << j));
+			for (unsigned bit = 0; bit < 8; bit++)
+				if (column & (1 << bit))
+					matrix |= UINT64_C(1) << (((7 - bit) * 8) + j);
+		}
+		gf_affine_table[i] = matrix;
+	}
+
+/* user preferred multiply, overriding the CPU feature set */
+	struct gf_kernel_t kernels[ GF_MAX_KERNELS ];
+	const unsigned len = gf_kernels (cpu, kernels);
+	gf_is_pinned = FALSE;
+	gf_kernel_nsecs = 0;
+	char* pgm_gf_mul;
+	size_t envlen;
+	const errno_t err = pgm_dupenv_s (&pgm_gf_mul, &envlen, "PGM_GF_MUL");
+	if (0 == err && envlen > 0) {
+		for (unsigned i = 0; i < len; i++) {
+			if (0 == strcmp (kernels[i].name, pgm_gf_mul)) {
+				pgm_minor (_("Using %s kernel for Reed-Solomon per PGM_GF_MUL."), kernels[i].name);
+				gf_vec_addmul = kernels[i].addmul;
+				gf_vec_dotprod = kernels[i].dotprod;
+				gf_kernel_name = kernels[i].name;
+				gf_is_pinned = TRUE;
+				pgm_free (pgm_gf_mul);
+				return;
+			}
+		}
+		const char c = pgm_gf_mul[0];
+		pgm_free (pgm_gf_mul);
+		switch (c) {
+		case 'L':
+			pgm_minor (_("Using log/exp tables for Reed-Solomon."));
+			gf_vec_addmul = _pgm_gf_vec_addmul_logexp;
+			gf_vec_dotprod = _pgm_gf_vec_dotprod_logexp;
+			gf_kernel_name = "LOG";
+			gf_is_pinned = TRUE;
+			return;
+		case 'N':
+			pgm_minor (_("Using nibble tables for Reed-Solomon."));
+			gf_vec_addmul = _pgm_gf_vec_addmul_scalar;
+			gf_vec_dotprod = _pgm_gf_vec_dotprod_scalar;
+			gf_kernel_name = "NIBBLE";
+			gf_is_pinned = TRUE;
+			return;
+		default: break;
+		}
+	}
+
+	gf_select (cpu);
+	gf_kernel_name = "NIBBLE";
+	for (unsigned i = 0; i < len; i++)
+		if (kernels[i].dotprod == gf_vec_dotprod)
+			gf_kernel_name = kernels[i].name;
+}
+
+/* time encoding with every supported kernel and keep the fastest, unless named
+ * by PGM_GF_MUL.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_rs_calibrate (const pgm_cpu_t* cpu)
+{
+	struct gf_kernel_t kernels[ GF_MAX_KERNELS ];
+	const pgm_gf8_t* src[ GF_CALIBRATE_K ];
+	pgm_gf8_t coeff[ GF_CALIBRATE_K ];
+
+	pgm_assert (NULL != cpu);
+
+	if (gf_is_pinned)
+		return;
+
+	const unsigned len = gf_kernels (cpu, kernels);
+	pgm_gf8_t* buf = pgm_malloc ((GF_CALIBRATE_K + 1) * GF_CALIBRATE_LEN);
+	for (unsigned i = 0; i < (GF_CALIBRATE_K + 1) * GF_CALIBRATE_LEN; i++)
+		buf[i] = (pgm_gf8_t)(i * 31);
+	for (unsigned j = 0; j < GF_CALIBRATE_K; j++) {
+		src[j] = &buf[ (j + 1) * GF_CALIBRATE_LEN ];
+		coeff[j] = (pgm_gf8_t)(j + 2);
+	}
+
+	unsigned best_index = 0;
+	pgm_time_t best = UINT64_MAX;
+	for (unsigned i = 0; i < len; i++)
+	{
+		pgm_time_t elapsed = UINT64_MAX;
+		for (unsigned round = 0; round < GF_CALIBRATE_ROUNDS; round++) {
+			const pgm_time_t start = pgm_time_update_now();
+			for (unsigned n = 0; n < GF_CALIBRATE_CALLS; n++)
+				kernels[i].dotprod (buf, coeff, src, GF_CALIBRATE_K, 0, GF_CALIBRATE_LEN);
+			elapsed = MIN(elapsed, pgm_time_update_now() - start);
+		}
+		if (elapsed < best) {
+			best = elapsed;
+			best_index = i;
+		}
+	}
+	pgm_free (buf);
+
+	gf_vec_addmul = kernels[best_index].addmul;
+	gf_vec_dotprod = kernels[best_index].dotprod;
+	gf_kernel_name = kernels[best_index].name;
+	gf_kernel_nsecs = MAX(UINT64_C(1), (best * 1000) / GF_CALIBRATE_CALLS);
+	pgm_minor (_("Calibrated Reed-Solomon kernel %s at %" PRIu64 "ns/parity packet, "
+		     "export PGM_GF_MUL=%s to skip calibration."),
+		   gf_kernel_name, gf_kernel_nsecs, gf_kernel_name);
+}
+
+/* returns name of the Reed-Solomon kernel, with nsecs the calibrated time to
+ * encode a parity packet or 0 if not calibrated.
+ */
+
+PGM_GNUC_INTERNAL
+const char*
+pgm_rs_kernel (
+	uint64_t*		nsecs
+	)
+{
+	if (NULL != nsecs)
+		*nsecs = gf_kernel_nsecs;
+	return gf_kernel_name;
 }
 
 /* Basic matrix multiplication.
@@ -424,8 +1355,11 @@ pgm_rs_create (
 
 	rs->n	= n;
 	rs->k	= k;
-	rs->GM	= pgm_new0 (pgm_gf8_t, n * k);
-	rs->RM	= pgm_new0 (pgm_gf8_t, k * k);
+	rs->GM	= pgm_new0_subsys (pgm_gf8_t, n * k, PGM_MEM_SUBSYS_FEC);
+	rs->RM	= pgm_new0_subsys (pgm_gf8_t, PGM_RS_CACHE_SIZE * k * k, PGM_MEM_SUBSYS_FEC);
+	rs->RM_offsets = pgm_new0_subsys (uint8_t, PGM_RS_CACHE_SIZE * k, PGM_MEM_SUBSYS_FEC);
+	memset (rs->RM_stamp, 0, sizeof (rs->RM_stamp));
+	rs->RM_clock = 0;
 
 /* alpha = root of primitive polynomial of degree m
  *                 ( 1 + x² + x³ + x⁴ + x⁸ )
@@ -435,7 +1369,7 @@ pgm_rs_create (
  * Be careful, Harry!
  */
 #ifdef USE_MALLOC_MATRIX
-	pgm_gf8_t* V = pgm_new0 (pgm_gf8_t, n * k);
+	pgm_gf8_t* V = pgm_new0_subsys (pgm_gf8_t, n * k, PGM_MEM_SUBSYS_FEC);
 #else
 	pgm_gf8_t* V = pgm_newa (pgm_gf8_t, n * k);
 	memset (V, 0, n * k);
@@ -492,6 +1426,11 @@ pgm_rs_destroy (
 {
 	pgm_assert (NULL != rs);
 
+	if (rs->RM_offsets) {
+		pgm_free (rs->RM_offsets);
+		rs->RM_offsets = NULL;
+	}
+
 	if (rs->RM) {
 		pgm_free (rs->RM);
 		rs->RM = NULL;
@@ -523,14 +1462,154 @@ pgm_rs_encode (
 	pgm_assert (NULL != dst);
 	pgm_assert (len > 0);
 
-	memset (dst, 0, len);
-	for (uint_fast8_t i = 0; i < rs->k; i++)
+	PGM_PROFILE_BEGIN (rs_start);
+	gf_vec_dotprod (dst, &rs->GM[ offset * rs->k ], src, rs->k, 0, len);
+	PGM_PROFILE_END (PGM_PROFILE_RS, rs_start, 1);
+}
+
+/* dot product over sources of variable length, bytes of s_j from lens[j] onwards
+ * are virtual zeros.  the vector is cut at each source length and every segment
+ * summed over only the sources still running, so a group of short packets costs
+ * no more than its data.  NULL lens for sources of full length.
+ */
+
+static
+void
+_pgm_rs_dotprod (
+	pgm_gf8_t*		restrict d,
+	const pgm_gf8_t*	restrict c,	/* length k */
+	const pgm_gf8_t*const*	restrict s,	/* length k */
+	const uint16_t*		restrict lens,	/* length k */
+	const uint8_t			 k,
+	const uint16_t			 offset,
+	const uint16_t			 len
+	)
+{
+	if (NULL == lens) {
+		gf_vec_dotprod (d, c, s, k, offset, len);
+		return;
+	}
+
+#ifndef _MSC_VER
+	pgm_gf8_t cs[ k ];
+	const pgm_gf8_t* ss[ k ];
+#else
+	pgm_gf8_t* cs = pgm_newa (pgm_gf8_t, k);
+	const pgm_gf8_t** ss = pgm_newa (const pgm_gf8_t*, k);
+#endif
+	const unsigned end = offset + len;
+
+	for (unsigned pos = offset; pos < end;)
 	{
-		const pgm_gf8_t c = rs->GM[ (offset * rs->k) + i ];
-		_pgm_gf_vec_addmul (dst, c, src[i], len);
+		unsigned segment_end = end;
+		uint8_t active = 0;
+
+		for (uint_fast8_t j = 0; j < k; j++)
+		{
+			if (0 == c[ j ] || lens[ j ] <= pos)
+				continue;
+			cs[ active ] = c[ j ];
+			ss[ active ] = s[ j ];
+			active++;
+			if (lens[ j ] < segment_end)
+				segment_end = lens[ j ];
+		}
+		if (0 == active) {
+			memset (d + (pos - offset), 0, end - pos);
+			return;
+		}
+		gf_vec_dotprod (d + (pos - offset), cs, ss, active, (uint16_t)pos, (uint16_t)(segment_end - pos));
+		pos = segment_end;
 	}
 }
 
+/* as pgm_rs_encode() returning the unfolded checksum of the parity data, each
+ * block of dst is summed straight after its last product whilst still in cache.
+ * sources shorter than len are read as zero padded to it per lens.
+ */
+
+PGM_GNUC_INTERNAL
+uint32_t
+pgm_rs_encode_csum (
+	pgm_rs_t*	  restrict rs,
+	const pgm_gf8_t** restrict src,		/* length rs_t::k */
+	const uint16_t*	  restrict lens,	/* length rs_t::k, NULL for len */
+	const uint8_t		   offset,
+	pgm_gf8_t*	  restrict dst,
+	const uint16_t		   len
+	)
+{
+	uint32_t csum = 0;
+
+	pgm_assert (NULL != rs);
+	pgm_assert (NULL != src);
+	pgm_assert (offset >= rs->k && offset < rs->n);	/* parity packet */
+	pgm_assert (NULL != dst);
+	pgm_assert (len > 0);
+
+	PGM_PROFILE_BEGIN (rs_start);
+	for (uint16_t done = 0; done < len;)
+	{
+		const uint16_t block = MIN(PGM_RS_CSUM_BLOCK, len - done);
+		_pgm_rs_dotprod (dst + done, &rs->GM[ offset * rs->k ], src, lens, rs->k, done, block);
+		csum = pgm_csum_block_add (csum, pgm_csum_partial (dst + done, block, 0), done);
+		done += block;
+	}
+	PGM_PROFILE_END (PGM_PROFILE_RS, rs_start, 1);
+	return csum;
+}
+
+/* returns the inverted recovery matrix for the offsets vector, from cache or
+ * built from the generator matrix into the least recently used entry.
+ */
+
+static
+const pgm_gf8_t*
+_pgm_rs_recovery_matrix (
+	pgm_rs_t*      restrict rs,
+	const uint8_t* restrict	offsets		/* length rs_t::k */
+	)
+{
+	const unsigned k = rs->k;
+	unsigned victim = 0;
+
+	if (PGM_UNLIKELY(0 == ++rs->RM_clock)) {
+		memset (rs->RM_stamp, 0, sizeof (rs->RM_stamp));
+		rs->RM_clock = 1;
+	}
+	for (unsigned slot = 0; slot < PGM_RS_CACHE_SIZE; slot++)
+	{
+		if (rs->RM_stamp[ slot ] &&
+		    0 == memcmp (&rs->RM_offsets[ slot * k ], offsets, k))
+		{
+			rs->RM_stamp[ slot ] = rs->RM_clock;
+			return &rs->RM[ slot * k * k ];
+		}
+		if (rs->RM_stamp[ slot ] < rs->RM_stamp[ victim ])
+			victim = slot;
+	}
+
+/* create new recovery matrix from generator
+ */
+	pgm_gf8_t* RM = &rs->RM[ victim * k * k ];
+	for (uint_fast8_t i = 0; i < k; i++)
+	{
+		if (offsets[i] < k) {
+			memset (&RM[ i * k ], 0, k * sizeof(pgm_gf8_t));
+			RM[ (i * k) + i ] = 1;
+			continue;
+		}
+		memcpy (&RM[ i * k ], &rs->GM[ offsets[ i ] * k ], k * sizeof(pgm_gf8_t));
+	}
+
+/* invert */
+	_pgm_matinv (RM, k);
+
+	memcpy (&rs->RM_offsets[ victim * k ], offsets, k);
+	rs->RM_stamp[ victim ] = rs->RM_clock;
+	return RM;
+}
+
 /* original data block of packets with missing packet entries replaced
  * with on-demand parity packets.
  */
@@ -549,20 +1628,9 @@ pgm_rs_decode_parity_inline (
 	pgm_assert (NULL != offsets);
 	pgm_assert (len > 0);
 
-/* create new recovery matrix from generator
- */
-	for (uint_fast8_t i = 0; i < rs->k; i++)
-	{
-		if (offsets[i] < rs->k) {
-			memset (&rs->RM[ i * rs->k ], 0, rs->k * sizeof(pgm_gf8_t));
-			rs->RM[ (i * rs->k) + i ] = 1;
-			continue;
-		}
-		memcpy (&rs->RM[ i * rs->k ], &rs->GM[ offsets[ i ] * rs->k ], rs->k * sizeof(pgm_gf8_t));
-	}
-
-/* invert */
-	_pgm_matinv (rs->RM, rs->k);
+	PGM_PROFILE_BEGIN (rs_start);
+	unsigned erasures = 0;
+	const pgm_gf8_t* RM = _pgm_rs_recovery_matrix (rs, offsets);
 
 #ifndef _MSC_VER
 	pgm_gf8_t* repairs[ rs->k ];
@@ -577,17 +1645,11 @@ pgm_rs_decode_parity_inline (
 			continue;
 
 #ifdef USE_MALLOC_MATRIX
-		pgm_gf8_t* erasure = repairs[ j ] = pgm_malloc0 (len);
+		repairs[ j ] = pgm_malloc_subsys (len, PGM_MEM_CLASS_GENERAL, PGM_MEM_SUBSYS_FEC);
 #else
-		pgm_gf8_t* erasure = repairs[ j ] = pgm_alloca (len);
-		memset (erasure, 0, len);
+		repairs[ j ] = pgm_alloca (len);
 #endif
-		for (uint_fast8_t i = 0; i < rs->k; i++)
-		{
-			pgm_gf8_t* src = block[ i ];
-			pgm_gf8_t c = rs->RM[ (j * rs->k) + i ];
-			_pgm_gf_vec_addmul (erasure, c, src, len);
-		}
+		gf_vec_dotprod (repairs[ j ], &RM[ j * rs->k ], (const pgm_gf8_t*const*)block, rs->k, 0, len);
 	}
 
 /* move repaired over parity packets */
@@ -600,12 +1662,15 @@ pgm_rs_decode_parity_inline (
 #ifdef USE_MALLOC_MATRIX
 		pgm_free (repairs[ j ]);
 #endif
+		erasures++;
 	}
+	PGM_PROFILE_END (PGM_PROFILE_RS, rs_start, erasures);
 }
 
 /* entire FEC block of original data and parity packets.
  *
- * erased packet buffers must be zeroed.
+ * erased packet buffers are overwritten, received packets shorter than len are
+ * read as zero padded to it per lens.
  */
 
 PGM_GNUC_INTERNAL
@@ -613,6 +1678,7 @@ void
 pgm_rs_decode_parity_appended (
 	pgm_rs_t*      restrict rs,
 	pgm_gf8_t**    restrict block,	/* length rs_t::n, the FEC block */
+	const uint16_t* restrict lens,	/* length rs_t::n, NULL for len */
 	const uint8_t* restrict offsets,	/* ordered index of packets */
 	const uint16_t	        len		/* packet length */
 	)
@@ -622,20 +1688,24 @@ pgm_rs_decode_parity_appended (
 	pgm_assert (NULL != offsets);
 	pgm_assert (len > 0);
 
-/* create new recovery matrix from generator
- */
-	for (uint_fast8_t i = 0; i < rs->k; i++)
-	{
-		if (offsets[i] < rs->k) {
-			memset (&rs->RM[ i * rs->k ], 0, rs->k * sizeof(pgm_gf8_t));
-			rs->RM[ (i * rs->k) + i ] = 1;
-			continue;
-		}
-		memcpy (&rs->RM[ i * rs->k ], &rs->GM[ offsets[ i ] * rs->k ], rs->k * sizeof(pgm_gf8_t));
-	}
+	PGM_PROFILE_BEGIN (rs_start);
+	unsigned erasures = 0;
+	const pgm_gf8_t* RM = _pgm_rs_recovery_matrix (rs, offsets);
 
-/* invert */
-	_pgm_matinv (rs->RM, rs->k);
+#ifndef _MSC_VER
+	const pgm_gf8_t* src[ rs->k ];
+	uint16_t src_lens[ rs->k ];
+#else
+	const pgm_gf8_t** src = pgm_newa (const pgm_gf8_t*, rs->k);
+	uint16_t* src_lens = pgm_newa (uint16_t, rs->k);
+#endif
+
+/* received packets in offsets order, parity taken in turn from the end of the block */
+	for (uint_fast8_t i = 0, p = rs->k; i < rs->k; i++) {
+		const uint_fast8_t b = (offsets[ i ] < rs->k) ? i : p++;
+		src[ i ] = block[ b ];
+		src_lens[ i ] = lens ? lens[ b ] : len;
+	}
 
 /* multiply out, through the length of erasures[] */
 	for (uint_fast8_t j = 0; j < rs->k; j++)
@@ -643,19 +1713,10 @@ pgm_rs_decode_parity_appended (
 		if (offsets[ j ] < rs->k)
 			continue;
 
-		uint_fast8_t p = rs->k;
-		pgm_gf8_t* erasure = block[ j ];
-		for (uint_fast8_t i = 0; i < rs->k; i++)
-		{
-			pgm_gf8_t* src;
-			if (offsets[ i ] < rs->k)
-				src = block[ i ];
-			else
-				src = block[ p++ ];
-			const pgm_gf8_t c = rs->RM[ (j * rs->k) + i ];
-			_pgm_gf_vec_addmul (erasure, c, src, len);
-		}
+		_pgm_rs_dotprod (block[ j ], &RM[ j * rs->k ], src, lens ? src_lens : NULL, rs->k, 0, len);
+		erasures++;
 	}
+	PGM_PROFILE_END (PGM_PROFILE_RS, rs_start, erasures);
 }
 
 /* eof */
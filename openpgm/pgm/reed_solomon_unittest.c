@@ -56,6 +56,108 @@ pgm_get_nprocs (void)
 	return 1;
 }
 
+/* target:
+ *	void
+ *	pgm_rs_init (
+ *		const pgm_cpu_t*	cpu
+ *	)
+ */
+
+/* selected vector multiply matches the scalar implementation */
+START_TEST (test_init_pass_001)
+{
+	pgm_cpu_t cpu;
+	pgm_gf8_t src[1500 + 1], expected[1500 + 1], dst[1500 + 1];
+	pgm_cpuid (&cpu);
+	pgm_rs_init (&cpu);
+	for (unsigned b = 1; b < PGM_GF_NO_ELEMENTS; b++)
+	{
+		for (unsigned i = 0; i < G_N_ELEMENTS(src); i++) {
+			src[i] = (pgm_gf8_t)g_random_int();
+			expected[i] = dst[i] = (pgm_gf8_t)g_random_int();
+		}
+/* odd offset and length exercise unaligned access and the scalar tail */
+		_pgm_gf_vec_addmul_scalar (&expected[1], b, &src[1], 1500 - b);
+		_pgm_gf_vec_addmul (&dst[1], b, &src[1], 1500 - b);
+		fail_unless (0 == memcmp (expected, dst, sizeof(dst)), "vector multiply mismatch");
+	}
+}
+END_TEST
+
+/* scalar tables selected by PGM_GF_MUL match field multiplication */
+START_TEST (test_init_pass_002)
+{
+	static const char* tables[] = { "LOG", "NIBBLE" };
+	pgm_cpu_t cpu;
+	pgm_gf8_t src[PGM_GF_NO_ELEMENTS], expected[PGM_GF_NO_ELEMENTS], dst[PGM_GF_NO_ELEMENTS];
+	pgm_cpuid (&cpu);
+	for (unsigned t = 0; t < G_N_ELEMENTS(tables); t++)
+	{
+		g_setenv ("PGM_GF_MUL", tables[t], TRUE);
+		pgm_rs_init (&cpu);
+		for (unsigned b = 0; b < PGM_GF_NO_ELEMENTS; b++)
+		{
+			for (unsigned i = 0; i < G_N_ELEMENTS(src); i++) {
+				src[i] = (pgm_gf8_t)i;
+				dst[i] = (pgm_gf8_t)g_random_int();
+				expected[i] = dst[i] ^ pgm_gfmul ((pgm_gf8_t)b, (pgm_gf8_t)i);
+			}
+			_pgm_gf_vec_addmul (dst, b, src, G_N_ELEMENTS(src));
+			fail_unless (0 == memcmp (expected, dst, sizeof(dst)), "scalar multiply mismatch");
+		}
+	}
+	g_unsetenv ("PGM_GF_MUL");
+	pgm_rs_init (&cpu);
+}
+END_TEST
+
+/* target:
+ *	void
+ *	pgm_rs_calibrate (
+ *		const pgm_cpu_t*	cpu
+ *	)
+ */
+
+/* the fastest kernel matches the scalar implementation, a kernel named by
+ * PGM_GF_MUL is kept.
+ */
+START_TEST (test_calibrate_pass_001)
+{
+	pgm_cpu_t cpu;
+	pgm_gf8_t src[1500], expected[1500], dst[1500];
+	uint64_t nsecs;
+	fail_unless (TRUE == pgm_time_init (NULL), "time_init failed");
+	pgm_cpuid (&cpu);
+	pgm_rs_init (&cpu);
+	pgm_rs_calibrate (&cpu);
+	fail_unless (NULL != pgm_rs_kernel (&nsecs), "no kernel");
+	fail_unless (nsecs > 0, "kernel not calibrated");
+	for (unsigned i = 0; i < G_N_ELEMENTS(src); i++) {
+		src[i] = (pgm_gf8_t)g_random_int();
+		expected[i] = dst[i] = (pgm_gf8_t)g_random_int();
+	}
+	_pgm_gf_vec_addmul_scalar (expected, 0x1d, src, G_N_ELEMENTS(src));
+	_pgm_gf_vec_addmul (dst, 0x1d, src, G_N_ELEMENTS(dst));
+	fail_unless (0 == memcmp (expected, dst, sizeof(dst)), "vector multiply mismatch");
+
+	g_setenv ("PGM_GF_MUL", "NIBBLE", TRUE);
+	pgm_rs_init (&cpu);
+	pgm_rs_calibrate (&cpu);
+	fail_unless (0 == strcmp ("NIBBLE", pgm_rs_kernel (&nsecs)), "kernel not pinned");
+	fail_unless (0 == nsecs, "pinned kernel calibrated");
+	g_unsetenv ("PGM_GF_MUL");
+	pgm_rs_init (&cpu);
+	fail_unless (TRUE == pgm_time_shutdown (), "time_shutdown failed");
+}
+END_TEST
+
+START_TEST (test_init_fail_001)
+{
+	pgm_rs_init (NULL);
+	fail ("reached");
+}
+END_TEST
+
 /* target:
  *	void
  *	pgm_rs_create (
@@ -134,6 +236,39 @@ START_TEST (test_encode_pass_001)
 }
 END_TEST
 
+/* blocked dot product matches per-source plus-equals multiplication for every
+ * length through vector blocks, single vectors and the final partial vector.
+ */
+START_TEST (test_encode_pass_002)
+{
+	pgm_cpu_t cpu;
+	pgm_rs_t rs;
+	const guint8 k = 64;
+	const guint16 max_len = 1500;
+	pgm_gf8_t* source_packets[k];
+	pgm_gf8_t* parity_packet = g_malloc (max_len + 1);
+	pgm_gf8_t* expected_packet = g_malloc (max_len);
+	pgm_cpuid (&cpu);
+	pgm_rs_init (&cpu);
+	pgm_rs_create (&rs, 255, k);
+	for (unsigned i = 0; i < k; i++) {
+		source_packets[i] = g_malloc (max_len);
+		for (unsigned j = 0; j < max_len; j++)
+			source_packets[i][j] = (pgm_gf8_t)g_random_int();
+	}
+	for (guint16 packet_len = 1; packet_len <= max_len; packet_len += 13) {
+		memset (expected_packet, 0, packet_len);
+		for (unsigned i = 0; i < k; i++)
+			pgm_gf_vec_addmul (expected_packet, rs.GM[ (k + 1) * k + i ], source_packets[i], packet_len);
+		parity_packet[packet_len] = 0xaa;
+		pgm_rs_encode (&rs, (const pgm_gf8_t**)source_packets, k + 1, parity_packet, packet_len);
+		fail_unless (0 == memcmp (expected_packet, parity_packet, packet_len), "parity mismatch");
+		fail_unless (0xaa == parity_packet[packet_len], "parity overrun");
+	}
+	pgm_rs_destroy (&rs);
+}
+END_TEST
+
 START_TEST (test_encode_fail_001)
 {
 	pgm_rs_encode (NULL, NULL, 0, NULL, 0);
@@ -141,6 +276,85 @@ START_TEST (test_encode_fail_001)
 }
 END_TEST
 
+/* target:
+ *	uint32_t
+ *	pgm_rs_encode_csum (
+ *		pgm_rs_t*		rs,
+ *		const pgm_gf8_t**	src,
+ *		const uint16_t*		lens,
+ *		const uint8_t		offset,
+ *		pgm_gf8_t*		dst,
+ *		const uint16_t		len
+ *	)
+ */
+
+/* parity and checksum match pgm_rs_encode() across several blocks and an odd tail */
+START_TEST (test_encode_csum_pass_001)
+{
+	pgm_rs_t rs;
+	const guint8 k = 8;
+	const guint8 parity_index = k + 1;
+	const guint16 packet_len = (3 * PGM_RS_CSUM_BLOCK) + 7;
+	pgm_gf8_t* source_packets[k];
+	pgm_gf8_t* parity_packet = g_malloc0 (packet_len);
+	pgm_gf8_t* fused_packet = g_malloc0 (packet_len);
+	pgm_cpu_t cpu;
+	pgm_cpuid (&cpu);
+	pgm_checksum_init (&cpu);
+	pgm_rs_create (&rs, 255, k);
+	for (unsigned i = 0; i < k; i++) {
+		source_packets[i] = g_malloc (packet_len);
+		for (unsigned j = 0; j < packet_len; j++)
+			source_packets[i][j] = (pgm_gf8_t)g_random_int();
+	}
+	pgm_rs_encode (&rs, (const pgm_gf8_t**)source_packets, parity_index, parity_packet, packet_len);
+	const guint32 csum = pgm_rs_encode_csum (&rs, (const pgm_gf8_t**)source_packets, NULL, parity_index, fused_packet, packet_len);
+	fail_unless (0 == memcmp (parity_packet, fused_packet, packet_len), "parity mismatch");
+	fail_unless (pgm_csum_fold (pgm_csum_partial (parity_packet, packet_len, 0)) == pgm_csum_fold (csum), "checksum mismatch");
+	pgm_rs_destroy (&rs);
+}
+END_TEST
+
+/* sources of variable length encode as if zero padded */
+START_TEST (test_encode_csum_pass_002)
+{
+	pgm_rs_t rs;
+	const guint8 k = 8;
+	const guint8 parity_index = k + 2;
+	const guint16 packet_len = PGM_RS_CSUM_BLOCK + 100;
+	const guint16 lens[] = { 10, packet_len, 0, 300, 10, PGM_RS_CSUM_BLOCK + 1, 7, 299 };
+	pgm_gf8_t* source_packets[k];
+	pgm_gf8_t* padded_packets[k];
+	pgm_gf8_t* parity_packet = g_malloc0 (packet_len);
+	pgm_gf8_t* fused_packet = g_malloc0 (packet_len);
+	pgm_cpu_t cpu;
+	pgm_cpuid (&cpu);
+	pgm_checksum_init (&cpu);
+	pgm_rs_create (&rs, 255, k);
+	for (unsigned i = 0; i < k; i++) {
+		source_packets[i] = g_malloc (lens[i] + 1);
+		padded_packets[i] = g_malloc0 (packet_len);
+		for (unsigned j = 0; j < lens[i]; j++)
+			source_packets[i][j] = padded_packets[i][j] = (pgm_gf8_t)g_random_int();
+/* beyond the length is never read */
+		source_packets[i][ lens[i] ] = 0xff;
+	}
+	pgm_rs_encode (&rs, (const pgm_gf8_t**)padded_packets, parity_index, parity_packet, packet_len);
+	memset (fused_packet, 0xa5, packet_len);
+	const guint32 csum = pgm_rs_encode_csum (&rs, (const pgm_gf8_t**)source_packets, lens, parity_index, fused_packet, packet_len);
+	fail_unless (0 == memcmp (parity_packet, fused_packet, packet_len), "parity mismatch");
+	fail_unless (pgm_csum_fold (pgm_csum_partial (parity_packet, packet_len, 0)) == pgm_csum_fold (csum), "checksum mismatch");
+	pgm_rs_destroy (&rs);
+}
+END_TEST
+
+START_TEST (test_encode_csum_fail_001)
+{
+	pgm_rs_encode_csum (NULL, NULL, NULL, 0, NULL, 0);
+	fail ("reached");
+}
+END_TEST
+
 /* target:
  *	void
  *	pgm_rs_decode_parity_inline (
@@ -191,6 +405,47 @@ START_TEST (test_decode_parity_inline_pass_001)
 }
 END_TEST
 
+/* cycle more erasure patterns than the recovery matrix cache holds */
+START_TEST (test_decode_parity_inline_pass_002)
+{
+	const guint8 k = 8;
+	const guint16 packet_len = 64;
+	const guint patterns = PGM_RS_CACHE_SIZE + 4;
+	pgm_rs_t rs;
+	pgm_gf8_t* originals[k];
+	pgm_gf8_t* block[k];
+	guint8 offsets[k];
+	pgm_rs_create (&rs, 255, k);
+	for (unsigned i = 0; i < k; i++) {
+		originals[i] = g_malloc (packet_len);
+		block[i] = g_malloc (packet_len);
+		for (unsigned j = 0; j < packet_len; j++)
+			originals[i][j] = (pgm_gf8_t)g_random_int();
+	}
+	for (unsigned round = 0; round < 3 * patterns; round++) {
+		const guint pattern = round % patterns;
+/* erase two packets, replaced by parity packets unique to the pattern */
+		const guint erased[2] = { pattern % k, (pattern + 1 + pattern / k) % k };
+		for (unsigned i = 0; i < k; i++) {
+			memcpy (block[i], originals[i], packet_len);
+			offsets[i] = i;
+		}
+		for (unsigned e = 0; e < G_N_ELEMENTS(erased); e++) {
+			offsets[ erased[e] ] = k + pattern * 2 + e;
+			pgm_rs_encode (&rs, (const pgm_gf8_t**)originals, offsets[ erased[e] ], block[ erased[e] ], packet_len);
+		}
+		pgm_rs_decode_parity_inline (&rs, block, offsets, packet_len);
+		for (unsigned i = 0; i < k; i++)
+			fail_unless (0 == memcmp (block[i], originals[i], packet_len), "repair failed");
+	}
+	pgm_rs_destroy (&rs);
+	for (unsigned i = 0; i < k; i++) {
+		g_free (originals[i]);
+		g_free (block[i]);
+	}
+}
+END_TEST
+
 START_TEST (test_decode_parity_inline_fail_001)
 {
 	pgm_rs_decode_parity_inline (NULL, NULL, NULL, 0);
@@ -203,6 +458,7 @@ END_TEST
  *	pgm_rs_decode_parity_appended (
  *		pgm_rs_t*		rs,
  *		pgm_gf8_t*		block,
+ *		const uint16_t*		lens,
  *		const uint8_t*		offsets,
  *		const uint16_t		len
  *	)
@@ -240,7 +496,7 @@ START_TEST (test_decode_parity_appended_pass_001)
 	memset (source_packets[erased_index], 0, packet_len);
 /* append parity to source packet block */
 	source_packets[parity_index] = parity_packet;
-	pgm_rs_decode_parity_appended (&rs, source_packets, offsets, packet_len);
+	pgm_rs_decode_parity_appended (&rs, source_packets, NULL, offsets, packet_len);
 	pgm_rs_destroy (&rs);
 	for (unsigned i = 0; i < k; i++) {
 		g_message ("repaired-packet#%2.2d: 0x%2.2x '%c'",
@@ -249,9 +505,41 @@ START_TEST (test_decode_parity_appended_pass_001)
 }
 END_TEST
 
+/* received packets of variable length read as if zero padded */
+START_TEST (test_decode_parity_appended_pass_002)
+{
+	pgm_rs_t rs;
+	const guint8 k = 4;
+	const guint16 packet_len = 64;
+	guint16 lens[] = { 5, 64, 17, 1, 64, 64 };
+	pgm_gf8_t* padded_packets[k];
+	pgm_gf8_t* block[k + 2];
+	pgm_rs_create (&rs, 255, k);
+	for (unsigned i = 0; i < k; i++) {
+		padded_packets[i] = g_malloc0 (packet_len);
+		block[i] = g_malloc (packet_len);
+		memset (block[i], 0xa5, packet_len);
+		for (unsigned j = 0; j < lens[i]; j++)
+			padded_packets[i][j] = block[i][j] = (pgm_gf8_t)g_random_int();
+	}
+	block[k]     = g_malloc (packet_len);
+	block[k + 1] = g_malloc (packet_len);
+	pgm_rs_encode (&rs, (const pgm_gf8_t**)padded_packets, k, block[k], packet_len);
+	pgm_rs_encode (&rs, (const pgm_gf8_t**)padded_packets, k + 1, block[k + 1], packet_len);
+/* erase #0 and #2 */
+	guint8 offsets[] = { k, 1, k + 1, 3 };
+	memset (block[0], 0xff, packet_len);
+	memset (block[2], 0xff, packet_len);
+	pgm_rs_decode_parity_appended (&rs, block, lens, offsets, packet_len);
+	fail_unless (0 == memcmp (padded_packets[0], block[0], packet_len), "repair #0 mismatch");
+	fail_unless (0 == memcmp (padded_packets[2], block[2], packet_len), "repair #2 mismatch");
+	pgm_rs_destroy (&rs);
+}
+END_TEST
+
 START_TEST (test_decode_parity_appended_fail_001)
 {
-	pgm_rs_decode_parity_appended (NULL, NULL, NULL, 0);
+	pgm_rs_decode_parity_appended (NULL, NULL, NULL, NULL, 0);
 	fail ("reached");
 }
 END_TEST
@@ -265,6 +553,18 @@ make_test_suite (void)
 
 	s = suite_create (__FILE__);
 
+	TCase* tc_init = tcase_create ("init");
+	suite_add_tcase (s, tc_init);
+	tcase_add_test (tc_init, test_init_pass_001);
+	tcase_add_test (tc_init, test_init_pass_002);
+#ifndef PGM_CHECK_NOFORK
+	tcase_add_test_raise_signal (tc_init, test_init_fail_001, SIGABRT);
+#endif
+
+	TCase* tc_calibrate = tcase_create ("calibrate");
+	suite_add_tcase (s, tc_calibrate);
+	tcase_add_test (tc_calibrate, test_calibrate_pass_001);
+
 	TCase* tc_create = tcase_create ("create");
 	suite_add_tcase (s, tc_create);
 	tcase_add_test (tc_create, test_create_pass_001);
@@ -282,13 +582,23 @@ make_test_suite (void)
 	TCase* tc_encode = tcase_create ("encode");
 	suite_add_tcase (s, tc_encode);
 	tcase_add_test (tc_encode, test_encode_pass_001);
+	tcase_add_test (tc_encode, test_encode_pass_002);
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_encode, test_encode_fail_001, SIGABRT);
 #endif
 
+	TCase* tc_encode_csum = tcase_create ("encode-csum");
+	suite_add_tcase (s, tc_encode_csum);
+	tcase_add_test (tc_encode_csum, test_encode_csum_pass_001);
+	tcase_add_test (tc_encode_csum, test_encode_csum_pass_002);
+#ifndef PGM_CHECK_NOFORK
+	tcase_add_test_raise_signal (tc_encode_csum, test_encode_csum_fail_001, SIGABRT);
+#endif
+
 	TCase* tc_decode_parity_inline = tcase_create ("decode-parity-inline");
 	suite_add_tcase (s, tc_decode_parity_inline);
 	tcase_add_test (tc_decode_parity_inline, test_decode_parity_inline_pass_001);
+	tcase_add_test (tc_decode_parity_inline, test_decode_parity_inline_pass_002);
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_decode_parity_inline, test_decode_parity_inline_fail_001, SIGABRT);
 #endif
@@ -296,6 +606,7 @@ make_test_suite (void)
 	TCase* tc_decode_parity_appended = tcase_create ("decode-parity-appended");
 	suite_add_tcase (s, tc_decode_parity_appended);
 	tcase_add_test (tc_decode_parity_appended, test_decode_parity_appended_pass_001);
+	tcase_add_test (tc_decode_parity_appended, test_decode_parity_appended_pass_002);
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_decode_parity_appended, test_decode_parity_appended_fail_001, SIGABRT);
 #endif
@@ -0,0 +1,381 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * Receiver state in a named shared memory segment for warm restart.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <errno.h>
+#include <string.h>
+#ifndef _WIN32
+#	include <fcntl.h>
+#	include <unistd.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#endif
+#include <impl/i18n.h>
+#include <impl/framework.h>
+
+
+//#define RESTART_DEBUG
+
+/* The segment is a header then a fixed count of slots, one per source a receiver
+ * has read from, holding the first sequence the application has not read and what
+ * is needed to NAK the source without waiting for an SPM.  The segment outlives the
+ * process: a receiver reopening it takes back the slot of each returning source and
+ * opens its receive window at the saved sequence, so only sequences missed whilst
+ * away are repaired.
+ *
+ * Slots are written by the receiving thread only, the slot sequence is odd whilst a
+ * slot is written so the state of a process that failed mid-write is discarded on
+ * the next open.  Windows and skbuffs stay in process memory: data received but not read before the
+ * restart is requested again.
+ */
+
+#define RESTART_MAGIC			0x50475252U	/* "PGRR" */
+#define RESTART_VERSION			1
+
+struct restart_header_t {
+	uint32_t		magic;
+	uint32_t		version;
+	uint32_t		slot_count;
+	uint32_t		slot_size;
+};
+
+struct pgm_restart_slot_t {
+	volatile uint32_t		sequence;		/* odd whilst written */
+	uint32_t			is_used;
+	struct pgm_restart_state_t	state;
+};
+
+struct pgm_restart_t {
+	void*				base;
+	size_t				size;
+	struct restart_header_t*	header;
+	struct pgm_restart_slot_t*	slots;
+	bool*				is_claimed;		/* by this process */
+	unsigned			len;			/* slots restored at open */
+#ifdef _WIN32
+	HANDLE				mapping;
+#endif
+};
+
+
+static inline
+void
+restart_barrier (void)
+{
+#if defined( __GNUC__ ) && ( __GNUC__ * 100 + __GNUC_MINOR__ >= 401 )
+	__sync_synchronize();
+#elif defined( __sun )
+	membar_producer();
+#elif defined( _WIN32 )
+	MemoryBarrier();
+#endif
+}
+
+static
+void
+restart_slot_clear (
+	struct pgm_restart_slot_t*const		slot
+	)
+{
+	slot->sequence++;
+	restart_barrier();
+	slot->is_used = 0;
+	restart_barrier();
+	slot->sequence++;
+}
+
+/* open or create the segment name recording up to sources sources, the slots of a
+ * previous process are kept if the segment has the same geometry.
+ *
+ * returns restart on success, returns NULL on error with error set.
+ */
+
+PGM_GNUC_INTERNAL
+struct pgm_restart_t*
+pgm_restart_open (
+	const char*	  restrict	name,
+	unsigned			sources,	/* 0 = default */
+	pgm_error_t**	  restrict	error
+	)
+{
+	struct pgm_restart_t* restart;
+	void* base;
+
+/* pre-conditions */
+	pgm_assert (NULL != name);
+
+	if (0 == sources)
+		sources = PGM_RESTART_DEFAULT_SOURCES;
+	if (sources > PGM_RESTART_MAX_SOURCES)
+		sources = PGM_RESTART_MAX_SOURCES;
+
+	restart = pgm_new0 (struct pgm_restart_t, 1);
+	restart->size = sizeof (struct restart_header_t) + ((size_t)sources * sizeof (struct pgm_restart_slot_t));
+
+#ifndef _WIN32
+	const int fd = shm_open (name, O_RDWR | O_CREAT, 0600);
+	if (-1 == fd) {
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_errno (save_errno),
+			     _("Opening shared memory segment %s: %s"),
+			     name,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		goto err_free;
+	}
+	struct stat st;
+	if (-1 == fstat (fd, &st) ||
+	    ((size_t)st.st_size != restart->size && -1 == ftruncate (fd, restart->size)))
+	{
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_errno (save_errno),
+			     _("Sizing shared memory segment %s: %s"),
+			     name,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		close (fd);
+		goto err_free;
+	}
+	base = mmap (NULL, restart->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close (fd);
+	if (MAP_FAILED == base) {
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_errno (save_errno),
+			     _("Mapping shared memory segment %s: %s"),
+			     name,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		goto err_free;
+	}
+#else
+/* a named mapping lasts whilst any process holds it open */
+	restart->mapping = CreateFileMappingA (INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+					       (DWORD)((uint64_t)restart->size >> 32), (DWORD)restart->size, name);
+	if (NULL == restart->mapping) {
+		const DWORD save_errno = GetLastError();
+		char winstr[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_win_errno (save_errno),
+			     _("Creating file mapping %s: %s"),
+			     name,
+			     pgm_win_strerror (winstr, sizeof (winstr), save_errno));
+		goto err_free;
+	}
+	base = MapViewOfFile (restart->mapping, FILE_MAP_WRITE, 0, 0, restart->size);
+	if (NULL == base) {
+		const DWORD save_errno = GetLastError();
+		char winstr[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_win_errno (save_errno),
+			     _("Mapping view of file %s: %s"),
+			     name,
+			     pgm_win_strerror (winstr, sizeof (winstr), save_errno));
+		CloseHandle (restart->mapping);
+		goto err_free;
+	}
+#endif /* _WIN32 */
+
+	restart->base		= base;
+	restart->header		= (struct restart_header_t*)base;
+	restart->slots		= (struct pgm_restart_slot_t*)(restart->header + 1);
+	restart->is_claimed	= pgm_new0 (bool, sources);
+
+	struct restart_header_t* header = restart->header;
+	if (RESTART_MAGIC != header->magic ||
+	    RESTART_VERSION != header->version ||
+	    sources != header->slot_count ||
+	    sizeof (struct pgm_restart_slot_t) != header->slot_size)
+	{
+		memset (base, 0, restart->size);
+		header->version		= RESTART_VERSION;
+		header->slot_count	= sources;
+		header->slot_size	= sizeof (struct pgm_restart_slot_t);
+/* magic last, a process failing before here leaves an invalid segment */
+		restart_barrier();
+		header->magic		= RESTART_MAGIC;
+	} else {
+		for (unsigned i = 0; i < sources; i++) {
+			struct pgm_restart_slot_t* slot = &restart->slots[ i ];
+/* discard a slot left mid-write */
+			if (slot->sequence & 1) {
+				slot->is_used = 0;
+				slot->sequence++;
+			}
+			if (slot->is_used)
+				restart->len++;
+		}
+	}
+	pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Warm restart segment %s of %u sources, %u restored."),
+		name, sources, restart->len);
+	return restart;
+
+err_free:
+	pgm_free (restart);
+	return NULL;
+}
+
+/* unmap the segment, which remains for the next process.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_restart_close (
+	struct pgm_restart_t*		restart
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != restart);
+
+#ifndef _WIN32
+	munmap (restart->base, restart->size);
+#else
+	UnmapViewOfFile (restart->base);
+	CloseHandle (restart->mapping);
+#endif
+	pgm_free (restart->is_claimed);
+	pgm_free (restart);
+}
+
+/* returns count of sources found in the segment when opened.
+ */
+
+PGM_GNUC_INTERNAL
+unsigned
+pgm_restart_len (
+	const struct pgm_restart_t*const	restart
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != restart);
+
+	return restart->len;
+}
+
+/* take the slot of a new source tsi on dport, copying its saved state to state if
+ * a previous process recorded it.  otherwise a free slot is taken, or failing that
+ * the slot of a source that has not returned, and state is zeroed.
+ *
+ * returns slot on success, returns NULL if every slot is taken by this process.
+ */
+
+PGM_GNUC_INTERNAL
+struct pgm_restart_slot_t*
+pgm_restart_claim (
+	struct pgm_restart_t*	   const restrict	restart,
+	const pgm_tsi_t*	   const restrict	tsi,
+	const uint16_t					dport,
+	struct pgm_restart_state_t*	 restrict	state
+	)
+{
+	struct pgm_restart_slot_t *free_slot = NULL, *stale_slot = NULL;
+	unsigned free_index = 0, stale_index = 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != restart);
+	pgm_assert (NULL != tsi);
+	pgm_assert (NULL != state);
+
+	memset (state, 0, sizeof (struct pgm_restart_state_t));
+	for (unsigned i = 0; i < restart->header->slot_count; i++)
+	{
+		struct pgm_restart_slot_t* slot = &restart->slots[ i ];
+		if (restart->is_claimed[ i ])
+			continue;
+		if (!slot->is_used) {
+			if (NULL == free_slot) {
+				free_slot = slot;
+				free_index = i;
+			}
+			continue;
+		}
+		if (pgm_tsi_equal (tsi, &slot->state.tsi) && dport == slot->state.dport) {
+			memcpy (state, &slot->state, sizeof (struct pgm_restart_state_t));
+			restart->is_claimed[ i ] = TRUE;
+			return slot;
+		}
+		if (NULL == stale_slot) {
+			stale_slot = slot;
+			stale_index = i;
+		}
+	}
+	if (NULL == free_slot) {
+		free_slot = stale_slot;
+		free_index = stale_index;
+	}
+	if (NULL == free_slot)
+		return NULL;
+	restart->is_claimed[ free_index ] = TRUE;
+	restart_slot_clear (free_slot);
+	return free_slot;
+}
+
+/* record state in slot, called by the receiving thread only.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_restart_save (
+	struct pgm_restart_slot_t*	   const restrict	slot,
+	const struct pgm_restart_state_t*  const restrict	state
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != slot);
+	pgm_assert (NULL != state);
+
+	slot->sequence++;
+	restart_barrier();
+	memcpy (&slot->state, state, sizeof (struct pgm_restart_state_t));
+	slot->is_used = 1;
+	restart_barrier();
+	slot->sequence++;
+}
+
+/* forget the source of slot, freeing it for another.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_restart_release (
+	struct pgm_restart_t*	   const restrict	restart,
+	struct pgm_restart_slot_t* const restrict	slot
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != restart);
+	pgm_assert (NULL != slot);
+	pgm_assert (slot >= restart->slots && slot < restart->slots + restart->header->slot_count);
+
+	restart_slot_clear (slot);
+	restart->is_claimed[ slot - restart->slots ] = FALSE;
+}
+
+/* eof */
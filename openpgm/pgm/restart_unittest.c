@@ -0,0 +1,228 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * unit tests for warm restart receiver state.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <check.h>
+
+#include "impl/framework.h"
+
+#ifdef _WIN32
+#	define PGM_CHECK_NOFORK		1
+#endif
+
+
+/* mock state */
+#define TEST_NAME		"/pgm-restart-unittest"
+#define TEST_DPORT		7500
+
+static const pgm_tsi_t		test_tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+static const pgm_tsi_t		test_tsi2 = { { 1, 2, 3, 4, 5, 6 }, 1001 };
+
+#define RESTART_DEBUG
+#include "restart.c"
+
+
+static
+void
+unlink_segment (void)
+{
+#ifndef _WIN32
+	shm_unlink (TEST_NAME);
+#endif
+}
+
+/* target:
+ *	struct pgm_restart_t*
+ *	pgm_restart_open (
+ *		const char*		name,
+ *		unsigned		sources,
+ *		pgm_error_t**		error
+ *	)
+ */
+
+START_TEST (test_open_pass_001)
+{
+	pgm_error_t* err = NULL;
+	unlink_segment ();
+	struct pgm_restart_t* restart = pgm_restart_open (TEST_NAME, 0, &err);
+	fail_if (NULL == restart, "open failed");
+	fail_unless (PGM_RESTART_DEFAULT_SOURCES == restart->header->slot_count, "default sources");
+	fail_unless (0 == pgm_restart_len (restart), "new segment not empty");
+	pgm_restart_close (restart);
+	unlink_segment ();
+}
+END_TEST
+
+/* a different geometry discards the previous state */
+START_TEST (test_open_pass_002)
+{
+	pgm_error_t* err = NULL;
+	struct pgm_restart_state_t state;
+	unlink_segment ();
+	struct pgm_restart_t* restart = pgm_restart_open (TEST_NAME, 4, &err);
+	fail_if (NULL == restart, "open failed");
+	struct pgm_restart_slot_t* slot = pgm_restart_claim (restart, &test_tsi, TEST_DPORT, &state);
+	fail_if (NULL == slot, "claim failed");
+	pgm_restart_save (slot, &state);
+	pgm_restart_close (restart);
+	restart = pgm_restart_open (TEST_NAME, 8, &err);
+	fail_if (NULL == restart, "open failed");
+	fail_unless (0 == pgm_restart_len (restart), "state not discarded");
+	pgm_restart_close (restart);
+	unlink_segment ();
+}
+END_TEST
+
+/* target:
+ *	struct pgm_restart_slot_t*
+ *	pgm_restart_claim (
+ *		struct pgm_restart_t*		restart,
+ *		const pgm_tsi_t*		tsi,
+ *		const uint16_t			dport,
+ *		struct pgm_restart_state_t*	state
+ *	)
+ */
+
+/* saved state survives a reopen */
+START_TEST (test_claim_pass_001)
+{
+	pgm_error_t* err = NULL;
+	struct pgm_restart_state_t state;
+	unlink_segment ();
+	struct pgm_restart_t* restart = pgm_restart_open (TEST_NAME, 4, &err);
+	fail_if (NULL == restart, "open failed");
+	struct pgm_restart_slot_t* slot = pgm_restart_claim (restart, &test_tsi, TEST_DPORT, &state);
+	fail_if (NULL == slot, "claim failed");
+	fail_unless (0 == state.next, "new source has state");
+	state.tsi = test_tsi;
+	state.dport = TEST_DPORT;
+	state.next = 12345;
+	state.spm_sqn = 99;
+	pgm_restart_save (slot, &state);
+	pgm_restart_close (restart);
+
+	restart = pgm_restart_open (TEST_NAME, 4, &err);
+	fail_if (NULL == restart, "open failed");
+	fail_unless (1 == pgm_restart_len (restart), "state not restored");
+	fail_if (NULL == pgm_restart_claim (restart, &test_tsi2, TEST_DPORT, &state), "claim failed");
+	fail_unless (0 == state.next, "other source has state");
+	fail_if (NULL == pgm_restart_claim (restart, &test_tsi, TEST_DPORT, &state), "claim failed");
+	fail_unless (12345 == state.next, "next not restored");
+	fail_unless (99 == state.spm_sqn, "spm_sqn not restored");
+	pgm_restart_close (restart);
+	unlink_segment ();
+}
+END_TEST
+
+/* a slot left mid-write is discarded */
+START_TEST (test_claim_pass_002)
+{
+	pgm_error_t* err = NULL;
+	struct pgm_restart_state_t state;
+	unlink_segment ();
+	struct pgm_restart_t* restart = pgm_restart_open (TEST_NAME, 4, &err);
+	fail_if (NULL == restart, "open failed");
+	struct pgm_restart_slot_t* slot = pgm_restart_claim (restart, &test_tsi, TEST_DPORT, &state);
+	state.tsi = test_tsi;
+	state.dport = TEST_DPORT;
+	state.next = 12345;
+	pgm_restart_save (slot, &state);
+	slot->sequence++;
+	pgm_restart_close (restart);
+
+	restart = pgm_restart_open (TEST_NAME, 4, &err);
+	fail_if (NULL == restart, "open failed");
+	fail_unless (0 == pgm_restart_len (restart), "torn state restored");
+	fail_if (NULL == pgm_restart_claim (restart, &test_tsi, TEST_DPORT, &state), "claim failed");
+	fail_unless (0 == state.next, "torn state restored");
+	pgm_restart_close (restart);
+	unlink_segment ();
+}
+END_TEST
+
+/* every slot claimed, a released slot is claimed again */
+START_TEST (test_claim_fail_001)
+{
+	pgm_error_t* err = NULL;
+	struct pgm_restart_state_t state;
+	unlink_segment ();
+	struct pgm_restart_t* restart = pgm_restart_open (TEST_NAME, 1, &err);
+	fail_if (NULL == restart, "open failed");
+	struct pgm_restart_slot_t* slot = pgm_restart_claim (restart, &test_tsi, TEST_DPORT, &state);
+	fail_if (NULL == slot, "claim failed");
+	fail_unless (NULL == pgm_restart_claim (restart, &test_tsi2, TEST_DPORT, &state), "claim succeeded");
+	pgm_restart_release (restart, slot);
+	fail_unless (slot == pgm_restart_claim (restart, &test_tsi2, TEST_DPORT, &state), "claim failed");
+	pgm_restart_close (restart);
+	unlink_segment ();
+}
+END_TEST
+
+
+static
+Suite*
+make_test_suite (void)
+{
+	Suite* s;
+
+	s = suite_create (__FILE__);
+
+	TCase* tc_open = tcase_create ("open");
+	suite_add_tcase (s, tc_open);
+	tcase_add_test (tc_open, test_open_pass_001);
+	tcase_add_test (tc_open, test_open_pass_002);
+
+	TCase* tc_claim = tcase_create ("claim");
+	suite_add_tcase (s, tc_claim);
+	tcase_add_test (tc_claim, test_claim_pass_001);
+	tcase_add_test (tc_claim, test_claim_pass_002);
+	tcase_add_test (tc_claim, test_claim_fail_001);
+	return s;
+}
+
+static
+Suite*
+make_master_suite (void)
+{
+	Suite* s = suite_create ("Master");
+	return s;
+}
+
+int
+main (void)
+{
+	pgm_messages_init();
+	SRunner* sr = srunner_create (make_master_suite ());
+	srunner_add_suite (sr, make_test_suite ());
+	srunner_run_all (sr, CK_ENV);
+	int number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	pgm_messages_shutdown();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof */
@@ -0,0 +1,551 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * Windows Registered I/O send and receive engine.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <impl/framework.h>
+#include <impl/socket.h>
+
+#ifdef PGM_HAVE_RIO
+#	include <process.h>
+
+
+//#define RIO_DEBUG
+
+#ifndef RIO_DEBUG
+#	define PGM_DISABLE_ASSERT
+#endif
+
+/* control message space per receive operation following RIO_CMSG_BUFFER */
+#define PGM_RIO_AUX_LEN			256
+
+/* commit deferred receive operations once this fraction of the queue is idle */
+#define PGM_RIO_COMMIT_SHIFT		2
+
+/* completions dequeued per call */
+#define PGM_RIO_RESULTS			64
+
+/* no receive operation awaiting replacement */
+#define PGM_RIO_NO_SLOT			UINT_MAX
+
+/* One registered region holds the data, address and control buffers of every
+ * operation, registration pins the pages once such that no operation locks
+ * buffers.  Datagrams are copied into the skbuff of the caller as the receive
+ * window holds skbuffs indefinitely, as the AF_XDP path.
+ *
+ * Receive completions are dequeued by the receiving thread without a system
+ * call.  Only when the queue is found empty is a notification armed, its
+ * completion port is serviced by a thread that signals a notification socket
+ * such that select() based waiting is unchanged.
+ */
+
+struct pgm_rio_slot_t {
+	RIO_BUF			data;
+	RIO_BUF			addr;			/* SOCKADDR_INET */
+	RIO_BUF			aux;			/* RIO_CMSG_BUFFER */
+};
+
+struct pgm_rio_t {
+	RIO_EXTENSION_FUNCTION_TABLE	fn;
+	char*				region;
+	RIO_BUFFERID			buffer_id;
+	size_t				slot_len;
+
+/* receive */
+	RIO_CQ				rx_cq;
+	RIO_RQ*				rx_rq;			/* per receive socket */
+	unsigned			rx_rq_len;
+	unsigned			rx_depth;
+	struct pgm_rio_slot_t*		rx_slot;
+	unsigned			to_commit;		/* deferred, not yet committed */
+	unsigned			last_slot;		/* completed, returned to caller */
+	RIORESULT			results[ PGM_RIO_RESULTS ];
+	unsigned			result_index;
+	unsigned			result_count;
+
+/* send, under sock::send_mutex */
+	RIO_CQ				tx_cq;
+	RIO_RQ				tx_rq;
+	unsigned			tx_depth;
+	struct pgm_rio_slot_t*		tx_slot;
+	unsigned*			tx_free;		/* stack of idle slots */
+	unsigned			tx_free_len;
+
+/* idle notification */
+	HANDLE				iocp;
+	OVERLAPPED			overlapped;
+	HANDLE				thread;
+	volatile uint32_t		is_shutdown;
+	pgm_notify_t			notify;
+};
+
+
+static
+unsigned
+__stdcall
+rio_notify_routine (
+	void*			arg
+	)
+{
+	struct pgm_rio_t* const rio = (struct pgm_rio_t*)arg;
+
+	pgm_affinity_apply (PGM_THREAD_IO);
+
+	for (;;)
+	{
+		DWORD bytes;
+		ULONG_PTR key;
+		OVERLAPPED* overlapped;
+		if (!GetQueuedCompletionStatus (rio->iocp, &bytes, &key, &overlapped, INFINITE) &&
+		    NULL == overlapped)
+			break;
+		if (pgm_atomic_read32 (&rio->is_shutdown))
+			break;
+		pgm_notify_send (&rio->notify);
+	}
+	_endthreadex (0);
+	return 0;
+}
+
+/* create a socket capable of registered I/O, falling back to a regular socket
+ * before Windows 8.
+ */
+
+PGM_GNUC_INTERNAL
+SOCKET
+pgm_rio_socket (
+	const int		family,
+	const int		type,
+	const int		protocol
+	)
+{
+	const SOCKET s = WSASocket (family, type, protocol, NULL, 0, WSA_FLAG_OVERLAPPED | WSA_FLAG_REGISTERED_IO);
+	if (INVALID_SOCKET != s)
+		return s;
+	return socket (family, type, protocol);
+}
+
+static
+bool
+rio_get_functions (
+	const SOCKET				s,
+	RIO_EXTENSION_FUNCTION_TABLE*		fn
+	)
+{
+	GUID rio_guid = WSAID_MULTIPLE_RIO;
+	DWORD bytes;
+
+	memset (fn, 0, sizeof (RIO_EXTENSION_FUNCTION_TABLE));
+	fn->cbSize = sizeof (RIO_EXTENSION_FUNCTION_TABLE);
+	return (SOCKET_ERROR != WSAIoctl (s,
+					  SIO_GET_MULTIPLE_EXTENSION_FUNCTION_POINTER,
+					  &rio_guid, sizeof (rio_guid),
+					  fn, sizeof (RIO_EXTENSION_FUNCTION_TABLE),
+					  &bytes,
+					  NULL,
+					  NULL));
+}
+
+/* carve slot n of the registered region.
+ */
+
+static
+void
+rio_slot_init (
+	const struct pgm_rio_t* const	rio,
+	struct pgm_rio_slot_t* const	slot,
+	const unsigned			n,
+	const uint16_t			max_tpdu
+	)
+{
+	const ULONG offset = (ULONG)(n * rio->slot_len);
+	slot->data.BufferId	= rio->buffer_id;
+	slot->data.Offset	= offset;
+	slot->data.Length	= max_tpdu;
+	slot->addr.BufferId	= rio->buffer_id;
+	slot->addr.Offset	= offset + max_tpdu;
+	slot->addr.Length	= sizeof (SOCKADDR_INET);
+	slot->aux.BufferId	= rio->buffer_id;
+	slot->aux.Offset	= offset + max_tpdu + sizeof (SOCKADDR_INET);
+	slot->aux.Length	= PGM_RIO_AUX_LEN;
+}
+
+static
+bool
+rio_post_receive (
+	struct pgm_rio_t* const	rio,
+	const unsigned		slot,
+	const DWORD		flags
+	)
+{
+	struct pgm_rio_slot_t* s = &rio->rx_slot[slot];
+	const RIO_RQ rq = rio->rx_rq[ slot % rio->rx_rq_len ];
+	if (!rio->fn.RIOReceiveEx (rq, &s->data, 1, NULL, &s->addr, &s->aux, NULL, flags, (PVOID)(uintptr_t)slot))
+		return FALSE;
+	if (flags & RIO_MSG_DEFER)
+		rio->to_commit++;
+	return TRUE;
+}
+
+static
+void
+rio_commit (
+	struct pgm_rio_t* const	rio
+	)
+{
+	if (0 == rio->to_commit)
+		return;
+	for (unsigned i = 0; i < rio->rx_rq_len; i++)
+		rio->fn.RIOReceive (rio->rx_rq[i], NULL, 0, RIO_MSG_COMMIT_ONLY, NULL);
+	rio->to_commit = 0;
+}
+
+/* register depth receive operations distributed round-robin across the receive
+ * sockets of sock, and when sock sends data depth send buffers on the send socket.
+ * the sockets must have been created by pgm_rio_socket().
+ *
+ * returns new engine, or NULL on failure setting the last socket error.
+ */
+
+PGM_GNUC_INTERNAL
+struct pgm_rio_t*
+pgm_rio_new (
+	pgm_sock_t* const	sock,
+	const unsigned		depth
+	)
+{
+	pgm_assert (NULL != sock);
+	pgm_assert (depth > 0);
+	pgm_assert (depth <= PGM_MAX_RIO_DEPTH);
+
+	const unsigned rx_rq_len = 1 + sock->recv_sock_extra_len;
+	const unsigned tx_depth = sock->can_send_data ? depth : 0;
+	struct pgm_rio_t* rio = pgm_malloc0 (sizeof (struct pgm_rio_t) +
+					     rx_rq_len * sizeof (RIO_RQ) +
+					     (depth + tx_depth) * sizeof (struct pgm_rio_slot_t) +
+					     tx_depth * sizeof (unsigned));
+	char* p = (char*)(rio + 1);
+	rio->rx_rq	= (RIO_RQ*)p;			p += rx_rq_len * sizeof (RIO_RQ);
+	rio->rx_slot	= (struct pgm_rio_slot_t*)p;	p += depth * sizeof (struct pgm_rio_slot_t);
+	rio->tx_slot	= (struct pgm_rio_slot_t*)p;	p += tx_depth * sizeof (struct pgm_rio_slot_t);
+	rio->tx_free	= (unsigned*)p;
+	rio->rx_rq_len	= rx_rq_len;
+	rio->rx_depth	= depth;
+	rio->tx_depth	= tx_depth;
+	rio->last_slot	= PGM_RIO_NO_SLOT;
+	rio->rx_cq	= rio->tx_cq = RIO_INVALID_CQ;
+	rio->buffer_id	= RIO_INVALID_BUFFERID;
+
+	if (!rio_get_functions (sock->recv_sock, &rio->fn))
+		goto err_free;
+
+	rio->slot_len = (sock->max_tpdu + sizeof (SOCKADDR_INET) + PGM_RIO_AUX_LEN + PGM_CACHELINE_SIZE - 1) & ~(size_t)(PGM_CACHELINE_SIZE - 1);
+	const size_t region_len = (depth + tx_depth) * rio->slot_len;
+	rio->region = VirtualAlloc (NULL, region_len, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+	if (NULL == rio->region) {
+		pgm_set_last_sock_error (WSAENOBUFS);
+		goto err_free;
+	}
+	rio->buffer_id = rio->fn.RIORegisterBuffer (rio->region, (DWORD)region_len);
+	if (RIO_INVALID_BUFFERID == rio->buffer_id)
+		goto err_region;
+	for (unsigned i = 0; i < depth; i++)
+		rio_slot_init (rio, &rio->rx_slot[i], i, sock->max_tpdu);
+	for (unsigned i = 0; i < tx_depth; i++) {
+		rio_slot_init (rio, &rio->tx_slot[i], depth + i, sock->max_tpdu);
+		rio->tx_free[ rio->tx_free_len++ ] = i;
+	}
+
+/* completion port serviced by the notification thread */
+	if (0 != pgm_notify_init (&rio->notify))
+		goto err_deregister;
+	rio->iocp = CreateIoCompletionPort (INVALID_HANDLE_VALUE, NULL, 0, 1);
+	if (NULL == rio->iocp) {
+		pgm_set_last_sock_error (GetLastError());
+		goto err_notify;
+	}
+	RIO_NOTIFICATION_COMPLETION completion;
+	memset (&completion, 0, sizeof (completion));
+	completion.Type			= RIO_IOCP_COMPLETION;
+	completion.Iocp.IocpHandle	= rio->iocp;
+	completion.Iocp.CompletionKey	= (PVOID)rio;
+	completion.Iocp.Overlapped	= &rio->overlapped;
+	rio->rx_cq = rio->fn.RIOCreateCompletionQueue (depth, &completion);
+	if (RIO_INVALID_CQ == rio->rx_cq)
+		goto err_iocp;
+	if (tx_depth > 0) {
+		rio->tx_cq = rio->fn.RIOCreateCompletionQueue (tx_depth, NULL);
+		if (RIO_INVALID_CQ == rio->tx_cq)
+			goto err_cq;
+	}
+
+/* request queues live as long as their sockets */
+	const unsigned rq_depth = (depth + rx_rq_len - 1) / rx_rq_len;
+	for (unsigned i = 0; i < rx_rq_len; i++) {
+		const SOCKET s = (0 == i) ? sock->recv_sock : sock->recv_sock_extra[i - 1];
+		rio->rx_rq[i] = rio->fn.RIOCreateRequestQueue (s, rq_depth, 1, 1, 1, rio->rx_cq, rio->rx_cq, NULL);
+		if (RIO_INVALID_RQ == rio->rx_rq[i])
+			goto err_cq;
+	}
+	if (tx_depth > 0) {
+		rio->tx_rq = rio->fn.RIOCreateRequestQueue (sock->send_sock, 1, 1, tx_depth, 1, rio->tx_cq, rio->tx_cq, NULL);
+		if (RIO_INVALID_RQ == rio->tx_rq)
+			goto err_cq;
+	}
+
+	for (unsigned i = 0; i < depth; i++)
+		if (!rio_post_receive (rio, i, RIO_MSG_DEFER))
+			goto err_cq;
+	rio_commit (rio);
+
+	rio->thread = (HANDLE)_beginthreadex (NULL, 0, &rio_notify_routine, rio, 0, NULL);
+	if (0 == rio->thread) {
+		pgm_set_last_sock_error (WSAENOBUFS);
+		goto err_cq;
+	}
+	rio->fn.RIONotify (rio->rx_cq);
+	return rio;
+
+err_cq:
+	{
+		const int save_errno = pgm_get_last_sock_error();
+		if (RIO_INVALID_CQ != rio->tx_cq)
+			rio->fn.RIOCloseCompletionQueue (rio->tx_cq);
+		rio->fn.RIOCloseCompletionQueue (rio->rx_cq);
+		pgm_set_last_sock_error (save_errno);
+	}
+err_iocp:
+	CloseHandle (rio->iocp);
+err_notify:
+	pgm_notify_destroy (&rio->notify);
+err_deregister:
+	rio->fn.RIODeregisterBuffer (rio->buffer_id);
+err_region:
+	VirtualFree (rio->region, 0, MEM_RELEASE);
+err_free:
+	pgm_free (rio);
+	return NULL;
+}
+
+/* request queues cannot be closed, operations still in flight are cancelled
+ * when the sockets close, which must precede destruction.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_rio_destroy (
+	struct pgm_rio_t* const	rio
+	)
+{
+	pgm_assert (NULL != rio);
+
+	pgm_atomic_inc32 (&rio->is_shutdown);
+	PostQueuedCompletionStatus (rio->iocp, 0, 0, &rio->overlapped);
+	WaitForSingleObject (rio->thread, INFINITE);
+	CloseHandle (rio->thread);
+	if (RIO_INVALID_CQ != rio->tx_cq)
+		rio->fn.RIOCloseCompletionQueue (rio->tx_cq);
+	rio->fn.RIOCloseCompletionQueue (rio->rx_cq);
+	CloseHandle (rio->iocp);
+	pgm_notify_destroy (&rio->notify);
+	rio->fn.RIODeregisterBuffer (rio->buffer_id);
+	VirtualFree (rio->region, 0, MEM_RELEASE);
+	pgm_free (rio);
+}
+
+/* arm the completion notification when the queue is empty, completions
+ * arriving before the notification is armed signal immediately.
+ */
+
+static
+ULONG
+rio_dequeue (
+	struct pgm_rio_t* const	rio
+	)
+{
+	ULONG count = rio->fn.RIODequeueCompletion (rio->rx_cq, rio->results, PGM_RIO_RESULTS);
+	if (count > 0 && RIO_CORRUPT_CQ != count)
+		return count;
+	rio_commit (rio);
+	pgm_notify_clear (&rio->notify);
+	rio->fn.RIONotify (rio->rx_cq);
+	count = rio->fn.RIODequeueCompletion (rio->rx_cq, rio->results, PGM_RIO_RESULTS);
+	return (RIO_CORRUPT_CQ == count) ? 0 : count;
+}
+
+/* copy one completed datagram into skb, the source address into src_addr and
+ * describe the control messages with msg for destination address recovery.
+ *
+ * on success returns datagram length, on error or with no completion returns
+ * -1 setting the last socket error, PGM_SOCK_EAGAIN when empty.
+ */
+
+PGM_GNUC_INTERNAL
+ssize_t
+pgm_rio_recvmsg (
+	struct pgm_rio_t*     const restrict	rio,
+	struct pgm_sk_buff_t* const restrict	skb,
+	struct sockaddr*      const restrict	src_addr,
+	const socklen_t				src_addrlen,
+	WSAMSG*		      const restrict	msg
+	)
+{
+	pgm_assert (NULL != rio);
+	pgm_assert (NULL != skb);
+	pgm_assert (NULL != src_addr);
+	pgm_assert (NULL != msg);
+
+/* re-arm the slot returned by the previous call now its buffers have been consumed */
+	if (PGM_RIO_NO_SLOT != rio->last_slot) {
+		rio_post_receive (rio, rio->last_slot, RIO_MSG_DEFER);
+		rio->last_slot = PGM_RIO_NO_SLOT;
+		if (rio->to_commit >= (rio->rx_depth >> PGM_RIO_COMMIT_SHIFT))
+			rio_commit (rio);
+	}
+
+	for (;;)
+	{
+		if (rio->result_index == rio->result_count) {
+			rio->result_index = 0;
+			rio->result_count = rio_dequeue (rio);
+			if (0 == rio->result_count) {
+				pgm_set_last_sock_error (PGM_SOCK_EAGAIN);
+				return SOCKET_ERROR;
+			}
+		}
+		const RIORESULT* result = &rio->results[ rio->result_index++ ];
+		const unsigned slot = (unsigned)result->RequestContext;
+		pgm_assert (slot < rio->rx_depth);
+
+		if (PGM_UNLIKELY(NO_ERROR != result->Status)) {
+			rio_post_receive (rio, slot, RIO_MSG_DEFER);
+			if (WSAEMSGSIZE == result->Status || WSAECONNRESET == result->Status)
+				continue;
+			pgm_set_last_sock_error (result->Status);
+			return SOCKET_ERROR;
+		}
+
+		const struct pgm_rio_slot_t* s = &rio->rx_slot[slot];
+		const char* base = rio->region + s->data.Offset;
+		memcpy (skb->head, base, result->BytesTransferred);
+
+		const SOCKADDR_INET* from = (const SOCKADDR_INET*)(rio->region + s->addr.Offset);
+		const socklen_t fromlen = (AF_INET6 == from->si_family) ? sizeof (struct sockaddr_in6) : sizeof (struct sockaddr_in);
+		memcpy (src_addr, from, MIN(src_addrlen, fromlen));
+
+		RIO_CMSG_BUFFER* aux = (RIO_CMSG_BUFFER*)(rio->region + s->aux.Offset);
+		memset (msg, 0, sizeof (WSAMSG));
+		msg->name	 = (LPSOCKADDR)src_addr;
+		msg->namelen	 = fromlen;
+		if (aux->TotalLength > RIO_CMSG_BASE_SIZE) {
+			msg->Control.buf = (char*)aux + RIO_CMSG_BASE_SIZE;
+			msg->Control.len = aux->TotalLength - RIO_CMSG_BASE_SIZE;
+		}
+		rio->last_slot = slot;
+		return (ssize_t)result->BytesTransferred;
+	}
+}
+
+/* reclaim send buffers of completed operations.
+ */
+
+static
+void
+rio_tx_reclaim (
+	struct pgm_rio_t* const	rio
+	)
+{
+	RIORESULT results[ PGM_RIO_RESULTS ];
+	const ULONG count = rio->fn.RIODequeueCompletion (rio->tx_cq, results, PGM_RIO_RESULTS);
+	if (RIO_CORRUPT_CQ == count)
+		return;
+	for (ULONG i = 0; i < count; i++)
+		rio->tx_free[ rio->tx_free_len++ ] = (unsigned)results[i].RequestContext;
+}
+
+/* copy one datagram into a registered buffer and queue it on the send socket,
+ * caller holds sock::send_mutex.
+ *
+ * on success returns datagram length, on error returns -1 setting the last
+ * socket error, PGM_SOCK_EAGAIN with every buffer in flight.
+ */
+
+PGM_GNUC_INTERNAL
+ssize_t
+pgm_rio_sendto (
+	struct pgm_rio_t*      const restrict	rio,
+	const void*		     restrict	buf,
+	const size_t				len,
+	const struct sockaddr*	     restrict	to,
+	const socklen_t				tolen
+	)
+{
+	pgm_assert (NULL != rio);
+	pgm_assert (rio->tx_depth > 0);
+	pgm_assert (NULL != buf);
+	pgm_assert (NULL != to);
+
+	if (0 == rio->tx_free_len)
+		rio_tx_reclaim (rio);
+	if (PGM_UNLIKELY(0 == rio->tx_free_len)) {
+		pgm_set_last_sock_error (PGM_SOCK_EAGAIN);
+		return SOCKET_ERROR;
+	}
+	const unsigned slot = rio->tx_free[ --rio->tx_free_len ];
+	struct pgm_rio_slot_t* s = &rio->tx_slot[slot];
+	pgm_assert (len <= s->data.Length);
+
+	memcpy (rio->region + s->data.Offset, buf, len);
+	memset (rio->region + s->addr.Offset, 0, sizeof (SOCKADDR_INET));
+	memcpy (rio->region + s->addr.Offset, to, MIN(tolen, sizeof (SOCKADDR_INET)));
+	RIO_BUF data = s->data;
+	data.Length = (ULONG)len;
+	if (!rio->fn.RIOSendEx (rio->tx_rq, &data, 1, NULL, &s->addr, NULL, NULL, 0, (PVOID)(uintptr_t)slot)) {
+		rio->tx_free[ rio->tx_free_len++ ] = slot;
+		return SOCKET_ERROR;
+	}
+	return (ssize_t)len;
+}
+
+PGM_GNUC_INTERNAL
+bool
+pgm_rio_is_pending (
+	const struct pgm_rio_t* const	rio
+	)
+{
+	pgm_assert (NULL != rio);
+	return rio->result_index < rio->result_count;
+}
+
+PGM_GNUC_INTERNAL
+SOCKET
+pgm_rio_get_socket (
+	const struct pgm_rio_t* const	rio
+	)
+{
+	pgm_assert (NULL != rio);
+	return pgm_notify_get_socket (&rio->notify);
+}
+
+#endif /* PGM_HAVE_RIO */
+
+/* eof */
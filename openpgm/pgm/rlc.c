@@ -0,0 +1,179 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * random linear codes over GF(2⁸) for sliding window forward error correction.
+ *
+ * A repair packet is the sum of the source symbols of a run of consecutive
+ * sequence numbers, each multiplied by a coefficient derived from the repair
+ * key and the packet sequence number, so receivers regenerate the coding
+ * vector from the repair header alone.  Unlike Reed-Solomon transmission
+ * groups the coding window slides with the data, a repair is useful as soon
+ * as it arrives.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <impl/framework.h>
+
+
+//#define RLC_DEBUG
+
+/* non-zero coefficient of source packet sqn in repair key, a 32-bit integer
+ * hash spreads neighbouring keys and sequence numbers across the field.
+ */
+
+PGM_GNUC_INTERNAL
+pgm_gf8_t
+pgm_rlc_coefficient (
+	const uint16_t		key,
+	const uint32_t		sqn
+	)
+{
+	uint32_t x = sqn ^ ((uint32_t)key << 16 | key);
+	x ^= x >> 16;
+	x *= UINT32_C(0x7feb352d);
+	x ^= x >> 15;
+	x *= UINT32_C(0x846ca68b);
+	x ^= x >> 16;
+	return (pgm_gf8_t)(1 + (x % PGM_GF_MAX));
+}
+
+/* add the source symbol of skb multiplied by c to the repair symbol.
+ *
+ * repair[] += c • { tsdu_length, opt_fragment, data[] }
+ *
+ * single fragment APDUs are read as unfragmented by receivers and code a
+ * zero fragment option, the repair must be long enough for the payload.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_rlc_encode (
+	pgm_gf8_t*		  restrict repair,
+	const pgm_gf8_t			   c,
+	const struct pgm_sk_buff_t* restrict skb
+	)
+{
+	pgm_gf8_t header[ PGM_RLC_SYMBOL_HEADER ];
+
+/* pre-conditions */
+	pgm_assert (NULL != repair);
+	pgm_assert (NULL != skb);
+	pgm_assert (c > 0);
+
+	const uint16_t tsdu_length = pgm_htons (skb->len);
+	memcpy (header, &tsdu_length, sizeof(tsdu_length));
+	if (skb->pgm_opt_fragment &&
+	    pgm_ntohl (skb->of_apdu_len) != skb->len)
+		memcpy (&header[ sizeof(uint16_t) ], skb->pgm_opt_fragment, sizeof(struct pgm_opt_fragment));
+	else
+		memset (&header[ sizeof(uint16_t) ], 0, sizeof(struct pgm_opt_fragment));
+
+	pgm_gf_vec_addmul (repair, c, header, sizeof(header));
+	pgm_gf_vec_addmul (repair + PGM_RLC_SYMBOL_HEADER, c, skb->data, skb->len);
+}
+
+/* solve the linear system of n_rows repairs in n_cols unknown source symbols
+ * by Gauss-Jordan elimination, matrix is n_rows × n_cols row-major coefficients
+ * and rows[] the repair symbols of len bytes, both are reduced in place.
+ *
+ * solved[col] is set to the row now holding the symbol of unknown col, or
+ * PGM_RLC_UNSOLVED if the repairs do not determine it.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_rlc_solve (
+	pgm_gf8_t*	 restrict matrix,
+	pgm_gf8_t**	 restrict rows,
+	const uint8_t		  n_rows,
+	const uint8_t		  n_cols,
+	const uint16_t		  len,
+	uint8_t*	 restrict solved
+	)
+{
+	uint_fast8_t pivot_row = 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != matrix);
+	pgm_assert (NULL != rows);
+	pgm_assert (NULL != solved);
+	pgm_assert_cmpuint (n_rows, <=, PGM_RLC_MAX_UNKNOWNS);
+	pgm_assert_cmpuint (n_cols, <=, PGM_RLC_MAX_UNKNOWNS);
+
+#ifdef RLC_DEBUG
+	pgm_debug ("rlc_solve (matrix:%p rows:%p n-rows:%u n-cols:%u len:%u solved:%p)",
+		(const void*)matrix, (const void*)rows, n_rows, n_cols, len, (const void*)solved);
+#endif
+
+	for (uint_fast8_t col = 0; col < n_cols; col++)
+	{
+		solved[ col ] = PGM_RLC_UNSOLVED;
+
+		uint_fast8_t row = pivot_row;
+		while (row < n_rows && 0 == matrix[ row * n_cols + col ])
+			row++;
+		if (row == n_rows)
+			continue;
+
+		if (row != pivot_row) {
+			for (uint_fast8_t j = 0; j < n_cols; j++) {
+				const pgm_gf8_t t = matrix[ row * n_cols + j ];
+				matrix[ row * n_cols + j ] = matrix[ pivot_row * n_cols + j ];
+				matrix[ pivot_row * n_cols + j ] = t;
+			}
+			pgm_gf8_t* t = rows[ row ];
+			rows[ row ] = rows[ pivot_row ];
+			rows[ pivot_row ] = t;
+		}
+
+/* normalise pivot to one */
+		const pgm_gf8_t inverse = pgm_gfdiv (1, matrix[ pivot_row * n_cols + col ]);
+		for (uint_fast8_t j = 0; j < n_cols; j++)
+			matrix[ pivot_row * n_cols + j ] = pgm_gfmul (matrix[ pivot_row * n_cols + j ], inverse);
+		for (uint_fast16_t i = 0; i < len; i++)
+			rows[ pivot_row ][ i ] = pgm_gfmul (rows[ pivot_row ][ i ], inverse);
+
+/* eliminate column from every other row */
+		for (uint_fast8_t i = 0; i < n_rows; i++)
+		{
+			const pgm_gf8_t f = matrix[ i * n_cols + col ];
+			if (i == pivot_row || 0 == f)
+				continue;
+			pgm_gf_vec_addmul (&matrix[ i * n_cols ], f, &matrix[ pivot_row * n_cols ], n_cols);
+			pgm_gf_vec_addmul (rows[ i ], f, rows[ pivot_row ], len);
+		}
+
+		solved[ col ] = (uint8_t)pivot_row++;
+	}
+
+/* a pivot row still referencing a free unknown does not determine its symbol */
+	for (uint_fast8_t col = 0; col < n_cols; col++)
+	{
+		if (PGM_RLC_UNSOLVED == solved[ col ])
+			continue;
+		for (uint_fast8_t j = 0; j < n_cols; j++)
+			if (j != col && 0 != matrix[ solved[ col ] * n_cols + j ]) {
+				solved[ col ] = PGM_RLC_UNSOLVED;
+				break;
+			}
+	}
+}
+
+/* eof */
@@ -0,0 +1,247 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * unit tests for random linear codes over GF(2⁸).
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <glib.h>
+#include <check.h>
+
+#ifdef _WIN32
+#	define PGM_CHECK_NOFORK		1
+#endif
+
+
+/* mock state */
+
+
+/* mock functions for external references */
+
+#define pgm_gf_vec_addmul	mock_pgm_gf_vec_addmul
+
+#define RLC_DEBUG
+#include "rlc.c"
+
+PGM_GNUC_INTERNAL
+void
+mock_pgm_gf_vec_addmul (
+	pgm_gf8_t*	    restrict d,
+	const pgm_gf8_t		     b,
+	const pgm_gf8_t*    restrict s,
+	uint16_t		     len
+	)
+{
+	for (unsigned i = 0; i < len; i++)
+		d[i] ^= pgm_gfmul (b, s[i]);
+}
+
+static
+struct pgm_sk_buff_t*
+generate_skb (
+	const char*	source
+	)
+{
+	const guint16 source_len = strlen (source);
+	struct pgm_sk_buff_t* skb = pgm_alloc_skb (source_len);
+	memcpy (pgm_skb_put (skb, source_len), source, source_len);
+	return skb;
+}
+
+/* target:
+ *	pgm_gf8_t
+ *	pgm_rlc_coefficient (
+ *		const uint16_t		key,
+ *		const uint32_t		sqn
+ *	)
+ */
+
+START_TEST (test_coefficient_pass_001)
+{
+	for (unsigned key = 0; key < 16; key++)
+		for (guint32 sqn = UINT32_MAX - 128; sqn != 128; sqn++) {
+			const pgm_gf8_t c = pgm_rlc_coefficient (key, sqn);
+			fail_unless (0 != c, "zero coefficient");
+			fail_unless (c == pgm_rlc_coefficient (key, sqn), "coefficient not deterministic");
+		}
+}
+END_TEST
+
+/* target:
+ *	void
+ *	pgm_rlc_encode (
+ *		pgm_gf8_t*			repair,
+ *		const pgm_gf8_t			c,
+ *		const struct pgm_sk_buff_t*	skb
+ *	)
+ */
+
+START_TEST (test_encode_pass_001)
+{
+	const char source[] = "i am not a string";
+	const guint16 source_len = strlen (source);
+	pgm_gf8_t repair[ PGM_RLC_SYMBOL_HEADER + 100 ];
+	struct pgm_sk_buff_t* skb = generate_skb (source);
+	memset (repair, 0, sizeof(repair));
+	pgm_rlc_encode (repair, 1, skb);
+	fail_unless (source_len == ((repair[0] << 8) | repair[1]), "tsdu length not coded");
+	for (unsigned i = sizeof(uint16_t); i < PGM_RLC_SYMBOL_HEADER; i++)
+		fail_unless (0 == repair[i], "fragment option not zero");
+	fail_unless (0 == memcmp (&repair[ PGM_RLC_SYMBOL_HEADER ], source, source_len), "payload not coded");
+	fail_unless (0 == repair[ PGM_RLC_SYMBOL_HEADER + source_len ], "payload not zero extended");
+/* adding the same symbol again cancels out */
+	pgm_rlc_encode (repair, 1, skb);
+	for (unsigned i = 0; i < sizeof(repair); i++)
+		fail_unless (0 == repair[i], "symbol not cancelled");
+	pgm_free_skb (skb);
+}
+END_TEST
+
+START_TEST (test_encode_fail_001)
+{
+	pgm_rlc_encode (NULL, 1, NULL);
+	fail ("reached");
+}
+END_TEST
+
+/* target:
+ *	void
+ *	pgm_rlc_solve (
+ *		pgm_gf8_t*		matrix,
+ *		pgm_gf8_t**		rows,
+ *		const uint8_t		n_rows,
+ *		const uint8_t		n_cols,
+ *		const uint16_t		len,
+ *		uint8_t*		solved
+ *	)
+ */
+
+/* recover three lost packets from three repairs of one coding window */
+START_TEST (test_solve_pass_001)
+{
+	const char* source[] = { "i am not a string", "i am", "the quick brown fox" };
+	const guint8 n = G_N_ELEMENTS(source);
+	const guint16 len = PGM_RLC_SYMBOL_HEADER + 100;
+	pgm_gf8_t matrix[ n * n ];
+	pgm_gf8_t* rows[ n ];
+	uint8_t solved[ n ];
+	struct pgm_sk_buff_t* skb[ n ];
+	for (unsigned j = 0; j < n; j++)
+		skb[j] = generate_skb (source[j]);
+	for (unsigned i = 0; i < n; i++) {
+		rows[i] = g_malloc0 (len);
+		for (unsigned j = 0; j < n; j++) {
+			matrix[ i * n + j ] = pgm_rlc_coefficient (i, j);
+			pgm_rlc_encode (rows[i], matrix[ i * n + j ], skb[j]);
+		}
+	}
+	pgm_rlc_solve (matrix, rows, n, n, len, solved);
+	for (unsigned j = 0; j < n; j++) {
+		fail_unless (PGM_RLC_UNSOLVED != solved[j], "unsolved symbol");
+		const pgm_gf8_t* symbol = rows[ solved[j] ];
+		fail_unless (skb[j]->len == ((symbol[0] << 8) | symbol[1]), "tsdu length not recovered");
+		fail_unless (0 == memcmp (&symbol[ PGM_RLC_SYMBOL_HEADER ], source[j], skb[j]->len), "payload not recovered");
+		pgm_free_skb (skb[j]);
+	}
+	for (unsigned i = 0; i < n; i++)
+		g_free (rows[i]);
+}
+END_TEST
+
+/* fewer repairs than unknowns determine nothing */
+START_TEST (test_solve_pass_002)
+{
+	const guint8 n_rows = 2, n_cols = 3;
+	const guint16 len = PGM_RLC_SYMBOL_HEADER;
+	pgm_gf8_t matrix[ n_rows * n_cols ];
+	pgm_gf8_t* rows[ n_rows ];
+	uint8_t solved[ n_cols ];
+	for (unsigned i = 0; i < n_rows; i++) {
+		rows[i] = g_malloc0 (len);
+		for (unsigned j = 0; j < n_cols; j++)
+			matrix[ i * n_cols + j ] = pgm_rlc_coefficient (i, j);
+	}
+	pgm_rlc_solve (matrix, rows, n_rows, n_cols, len, solved);
+	for (unsigned j = 0; j < n_cols; j++)
+		fail_unless (PGM_RLC_UNSOLVED == solved[j], "symbol solved from underdetermined system");
+	for (unsigned i = 0; i < n_rows; i++)
+		g_free (rows[i]);
+}
+END_TEST
+
+START_TEST (test_solve_fail_001)
+{
+	pgm_rlc_solve (NULL, NULL, 0, 0, 0, NULL);
+	fail ("reached");
+}
+END_TEST
+
+
+static
+Suite*
+make_test_suite (void)
+{
+	Suite* s;
+
+	s = suite_create (__FILE__);
+
+	TCase* tc_coefficient = tcase_create ("coefficient");
+	suite_add_tcase (s, tc_coefficient);
+	tcase_add_test (tc_coefficient, test_coefficient_pass_001);
+
+	TCase* tc_encode = tcase_create ("encode");
+	suite_add_tcase (s, tc_encode);
+	tcase_add_test (tc_encode, test_encode_pass_001);
+#ifndef PGM_CHECK_NOFORK
+	tcase_add_test_raise_signal (tc_encode, test_encode_fail_001, SIGABRT);
+#endif
+
+	TCase* tc_solve = tcase_create ("solve");
+	suite_add_tcase (s, tc_solve);
+	tcase_add_test (tc_solve, test_solve_pass_001);
+	tcase_add_test (tc_solve, test_solve_pass_002);
+#ifndef PGM_CHECK_NOFORK
+	tcase_add_test_raise_signal (tc_solve, test_solve_fail_001, SIGABRT);
+#endif
+	return s;
+}
+
+static
+Suite*
+make_master_suite (void)
+{
+	Suite* s = suite_create ("Master");
+	return s;
+}
+
+int
+main (void)
+{
+	SRunner* sr = srunner_create (make_master_suite ());
+	srunner_add_suite (sr, make_test_suite ());
+	srunner_run_all (sr, CK_ENV);
+	int number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof */
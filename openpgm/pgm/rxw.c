@@ -25,6 +25,7 @@
 #include <impl/i18n.h>
 #include <impl/framework.h>
 #include <impl/rxw.h>
+#include <impl/packet_parse.h>
 
 
 //#define RXW_DEBUG
@@ -59,6 +60,20 @@ _pgm_tsi_is_null (
 /* sequence state must be smaller than PGM skbuff control buffer */
 PGM_STATIC_ASSERT(sizeof(struct pgm_rxw_state_t) <= sizeof(((struct pgm_sk_buff_t*)0)->cb));
 
+/* coding window of a held sliding window repair, kept in the skbuff control buffer */
+struct pgm_rxw_repair_t {
+	uint32_t	first_sqn;
+	uint16_t	key;
+	uint8_t		count;
+};
+
+PGM_STATIC_ASSERT(sizeof(struct pgm_rxw_repair_t) <= sizeof(((struct pgm_sk_buff_t*)0)->cb));
+
+/* initial pdata allocation on first sequence, doubled on demand up to the
+ * configured window.
+ */
+#define PGM_RXW_MIN_ALLOC		64
+
 static void _pgm_rxw_define (pgm_rxw_t*const, const uint32_t);
 static void _pgm_rxw_update_trail (pgm_rxw_t*const, const uint32_t);
 static inline uint32_t _pgm_rxw_update_lead (pgm_rxw_t*const, const uint32_t, const pgm_time_t, const pgm_time_t);
@@ -68,16 +83,213 @@ static inline bool _pgm_rxw_is_first_of_tg_sqn (pgm_rxw_t*const, const uint32_t)
 static inline bool _pgm_rxw_is_last_of_tg_sqn (pgm_rxw_t*const, const uint32_t);
 static int _pgm_rxw_insert (pgm_rxw_t*const restrict, struct pgm_sk_buff_t*const restrict);
 static int _pgm_rxw_append (pgm_rxw_t*const restrict, struct pgm_sk_buff_t*const restrict, const pgm_time_t);
+static void _pgm_rxw_remove_trail_range (pgm_rxw_t*const restrict, const uint32_t, struct pgm_sk_buff_t**const restrict);
+static inline int _pgm_rxw_append_in_order (pgm_rxw_t*const restrict, struct pgm_sk_buff_t*const restrict);
+static inline bool _pgm_rxw_is_loss_free (const pgm_rxw_t*const);
 static int _pgm_rxw_add_placeholder_range (pgm_rxw_t*const, const uint32_t, const pgm_time_t, const pgm_time_t);
 static void _pgm_rxw_unlink (pgm_rxw_t*const restrict, struct pgm_sk_buff_t*const restrict);
 static uint32_t _pgm_rxw_remove_trail (pgm_rxw_t*const);
+static unsigned _pgm_rxw_remove_full_trail (pgm_rxw_t*const);
+static void _pgm_rxw_jump (pgm_rxw_t*const);
+static bool _pgm_rxw_release_commit (pgm_rxw_t*const);
 static void _pgm_rxw_state (pgm_rxw_t*const restrict, struct pgm_sk_buff_t*const restrict, const int);
-static inline void _pgm_rxw_shuffle_parity (pgm_rxw_t*const restrict, struct pgm_sk_buff_t*const restrict);
+static inline struct pgm_sk_buff_t* _pgm_rxw_find_missing (pgm_rxw_t*const, const uint32_t);
+static inline bool _pgm_rxw_has_parity_index (pgm_rxw_t*const restrict, const struct pgm_sk_buff_t*const restrict);
+static inline struct pgm_sk_buff_t* _pgm_rxw_shuffle_parity (pgm_rxw_t*const restrict, struct pgm_sk_buff_t*const restrict);
 static inline ssize_t _pgm_rxw_incoming_read (pgm_rxw_t*const restrict, struct pgm_msgv_t**restrict, uint32_t);
 static bool _pgm_rxw_is_apdu_complete (pgm_rxw_t*const, const uint32_t);
+static inline bool _pgm_rxw_is_streamed (const pgm_rxw_t*const restrict, const struct pgm_sk_buff_t*const restrict);
+static unsigned _pgm_rxw_stream_chunk (pgm_rxw_t*const restrict, struct pgm_sk_buff_t*const restrict);
+static inline ssize_t _pgm_rxw_incoming_read_chunk (pgm_rxw_t*const restrict, struct pgm_msgv_t**restrict, const unsigned);
 static inline ssize_t _pgm_rxw_incoming_read_apdu (pgm_rxw_t*const restrict, struct pgm_msgv_t**restrict);
-static inline int _pgm_rxw_recovery_update (pgm_rxw_t*const, const uint32_t, const pgm_time_t);
+static ssize_t _pgm_rxw_decompress_apdu (pgm_rxw_t*const restrict, struct pgm_msgv_t**restrict, const unsigned);
+static inline ssize_t _pgm_rxw_incoming_read_batch (pgm_rxw_t*const restrict, struct pgm_msgv_t**restrict, const struct pgm_msgv_t*const restrict, size_t*restrict);
+#ifdef USE_HISTOGRAMS
+static void _pgm_rxw_sample_apdu (pgm_rxw_t*const, const size_t);
+#endif
+static inline int _pgm_rxw_recovery_update (pgm_rxw_t*const, const uint32_t, const pgm_time_t, const pgm_time_t);
 static inline int _pgm_rxw_recovery_append (pgm_rxw_t*const, const pgm_time_t, const pgm_time_t);
+static unsigned _pgm_rxw_sw_recover (pgm_rxw_t*const);
+static void _pgm_rxw_reconstruct_cancel (pgm_rxw_t*const);
+static void _pgm_rxw_conflate (pgm_rxw_t*const restrict, struct pgm_sk_buff_t*const restrict);
+static bool _pgm_rxw_skip_conflated (pgm_rxw_t*const);
+static void _pgm_rxw_place (pgm_rxw_t*const restrict, struct pgm_sk_buff_t*const restrict);
+static bool _pgm_rxw_read_placed (pgm_rxw_t*const restrict, struct pgm_msgv_t**restrict, const unsigned, const size_t);
+
+
+/* pdata index of a sequence, a mask for power-of-two windows.
+ */
+
+static inline
+uint_fast32_t
+_pgm_rxw_index (
+	const pgm_rxw_t* const	window,
+	const uint32_t		sequence
+	)
+{
+	return PGM_LIKELY(window->mask) ? (sequence & window->mask) : (sequence % window->alloc);
+}
+
+/* longest acceptable APDU, beyond the protocol limit only when streamed.
+ */
+
+static inline
+uint32_t
+_pgm_rxw_max_apdu (
+	const pgm_rxw_t* const	window
+	)
+{
+	return MAX( PGM_MAX_APDU, window->max_apdu );
+}
+
+/* slot state bitmaps, the slot index of a sequence is its pdata index.
+ */
+
+static inline
+unsigned
+_pgm_rxw_ctz64 (
+	const uint64_t		word
+	)
+{
+#if (__GNUC__ > 3) || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4)
+	return (unsigned)__builtin_ctzll (word);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64 (&index, word);
+	return (unsigned)index;
+#else
+	unsigned i = 0;
+	while (0 == (word & (UINT64_C(1) << i)))
+		i++;
+	return i;
+#endif
+}
+
+static inline
+void
+_pgm_rxw_map_set (
+	uint64_t* const		map,
+	const uint_fast32_t	index_
+	)
+{
+	map[ index_ >> 6 ] |= UINT64_C(1) << (index_ & 63);
+}
+
+static inline
+void
+_pgm_rxw_map_clear (
+	uint64_t* const		map,
+	const uint_fast32_t	index_
+	)
+{
+	map[ index_ >> 6 ] &= ~(UINT64_C(1) << (index_ & 63));
+}
+
+/* count of consecutive sequences from sequence, up to count, with a bit set
+ * in either map.  scans a 64-bit word per step, wrapping at the end of the
+ * pdata ring.
+ */
+
+static
+uint32_t
+_pgm_rxw_map_run (
+	const pgm_rxw_t* const	window,
+	const uint64_t*	const	map1,
+	const uint64_t*	const	map2,		/* may be NULL */
+	const uint32_t		sequence,
+	const uint32_t		count
+	)
+{
+	const unsigned alloc = window->alloc;
+	uint_fast32_t index_ = _pgm_rxw_index (window, sequence);
+	uint32_t run = 0;
+
+	while (run < count) {
+		const unsigned bit = index_ & 63;
+		unsigned avail = 64 - bit;
+		if (avail > alloc - index_)
+			avail = alloc - index_;
+		uint64_t word = map1[ index_ >> 6 ];
+		if (NULL != map2)
+			word |= map2[ index_ >> 6 ];
+		const uint64_t holes = ~word >> bit;
+		if (holes) {
+			const unsigned first_hole = _pgm_rxw_ctz64 (holes);
+			if (first_hole < avail) {
+				run += first_hole;
+				break;
+			}
+		}
+		run += avail;
+		index_ += avail;
+		if (index_ == alloc)
+			index_ = 0;
+	}
+	return run < count ? run : count;
+}
+
+/* re-allocate pdata and the slot maps to alloc entries, entries between trail
+ * and lead move to the slot of their sequence in the new ring.  zero alloc
+ * releases the storage of an empty window.
+ */
+
+static
+void
+_pgm_rxw_resize (
+	pgm_rxw_t* const	window,
+	const unsigned		alloc
+	)
+{
+	struct pgm_sk_buff_t** pdata = NULL;
+	uint64_t* data_map = NULL;
+	const unsigned map_words = (alloc + 63) / 64;
+	const unsigned mask = (alloc > 1 && 0 == (alloc & (alloc - 1))) ? alloc - 1 : 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert_cmpuint (alloc, <=, window->max_alloc);
+	pgm_assert_cmpuint (pgm_rxw_length (window), <=, alloc);
+
+	pgm_debug ("resize (window:%p alloc:%u->%u)", (const void*)window, window->alloc, alloc);
+
+	if (alloc) {
+		pdata = pgm_malloc0_policy (alloc * sizeof(struct pgm_sk_buff_t*), window->policy);
+		data_map = pgm_new0 (uint64_t, 2 * map_words);
+		for (uint32_t sequence = window->trail; sequence != window->lead + 1; sequence++)
+		{
+			const uint_fast32_t from = _pgm_rxw_index (window, sequence);
+			const uint_fast32_t to = mask ? (sequence & mask) : (sequence % alloc);
+			pdata[to] = window->pdata[from];
+			if (window->data_map[ from >> 6 ] & (UINT64_C(1) << (from & 63)))
+				_pgm_rxw_map_set (data_map, to);
+			if (window->parity_map[ from >> 6 ] & (UINT64_C(1) << (from & 63)))
+				_pgm_rxw_map_set (data_map + map_words, to);
+		}
+	}
+	pgm_free_policy (window->pdata);
+	pgm_free (window->data_map);
+	window->pdata = pdata;
+	window->data_map = data_map;
+	window->parity_map = data_map ? data_map + map_words : NULL;
+	window->alloc = alloc;
+	window->mask = mask;
+}
+
+/* ensure a slot for the next lead, windows are allocated on first use and grow
+ * by doubling so that idle sessions do not pin a full window.
+ */
+
+static inline
+void
+_pgm_rxw_reserve (
+	pgm_rxw_t* const	window
+	)
+{
+	if (PGM_LIKELY(pgm_rxw_length (window) < window->alloc))
+		return;
+	_pgm_rxw_resize (window, window->alloc ? MIN(2 * window->alloc, window->max_alloc)
+					       : MIN(PGM_RXW_MIN_ALLOC, window->max_alloc));
+}
 
 
 /* returns the pointer at the given index of the window.
@@ -98,7 +310,7 @@ _pgm_rxw_peek (
 
 	if (pgm_uint32_gte (sequence, window->trail) && pgm_uint32_lte (sequence, window->lead))
 	{
-		const uint_fast32_t index_ = sequence % pgm_rxw_max_length (window);
+		const uint_fast32_t index_ = _pgm_rxw_index (window, sequence);
 		struct pgm_sk_buff_t* skb = window->pdata[index_];
 /* availability only guaranteed inside commit window */
 		if (pgm_uint32_lt (sequence, window->commit_lead)) {
@@ -178,7 +390,8 @@ pgm_rxw_create (
 	const unsigned		sqns,		/* receive window size in sequence numbers */
 	const unsigned		secs,		/* size in seconds */
 	const ssize_t		max_rte,	/* max bandwidth */
-	const uint32_t		ack_c_p
+	const uint32_t		ack_c_p,
+	const pgm_mem_policy_t*const policy	/* NULL = heap */
 	)
 {
 	pgm_rxw_t* window;
@@ -202,7 +415,7 @@ pgm_rxw_create (
 /* calculate receive window parameters */
 	pgm_assert (sqns || (secs && max_rte));
 	const unsigned alloc_sqns = sqns ? sqns : (unsigned)( (secs * max_rte) / tpdu_size );
-	window = pgm_malloc0 (sizeof(pgm_rxw_t) + ( alloc_sqns * sizeof(struct pgm_sk_buff_t*) ));
+	window = pgm_new0 (pgm_rxw_t, 1);
 
 	window->tsi		= tsi;
 	window->max_tpdu	= tpdu_size;
@@ -225,8 +438,9 @@ pgm_rxw_create (
 	window->ack_c_p = pgm_fp16 (ack_c_p);
 	window->bitmap = 0xffffffff;
 
-/* pointer array */
-	window->alloc = alloc_sqns;
+/* pointer array, allocated on first sequence */
+	window->max_alloc = alloc_sqns;
+	window->policy = policy;
 
 /* post-conditions */
 	pgm_assert_cmpuint (pgm_rxw_max_length (window), ==, alloc_sqns);
@@ -249,15 +463,53 @@ pgm_rxw_destroy (
 {
 /* pre-conditions */
 	pgm_assert (NULL != window);
-	pgm_assert_cmpuint (window->alloc, >, 0);
+	pgm_assert_cmpuint (window->max_alloc, >, 0);
 
 	pgm_debug ("destroy (window:%p)", (const void*)window);
 
-/* contents of window */
+/* pending reconstruction */
+	if (NULL != window->decoder)
+		_pgm_rxw_reconstruct_cancel (window);
+
+/* contents of window, returned to their pools in bulk */
+	struct pgm_sk_buff_t* released = NULL;
 	while (!pgm_rxw_is_empty (window)) {
-		_pgm_rxw_remove_trail (window);
+		struct pgm_sk_buff_t* skb = _pgm_rxw_peek (window, window->trail);
+		pgm_assert (NULL != skb);
+		_pgm_rxw_unlink (window, skb);
+		window->size -= skb->len;
+		if (PGM_UNLIKELY(NULL != window->placed)) {
+			struct pgm_sk_buff_t** placed = &window->placed[ window->trail % window->max_alloc ];
+			if (NULL != *placed) {
+				pgm_free_skb_deferred (*placed, &released);
+				*placed = NULL;
+			}
+		}
+		pgm_free_skb_deferred (skb, &released);
+		window->trail++;
 	}
 
+/* held sliding window repairs */
+	while (!pgm_queue_is_empty (&window->sw_repairs))
+		pgm_free_skb_deferred ((struct pgm_sk_buff_t*)pgm_queue_pop_tail_link (&window->sw_repairs), &released);
+
+/* delivered batch messages */
+	while (!pgm_queue_is_empty (&window->batch_skbs))
+		pgm_free_skb_deferred ((struct pgm_sk_buff_t*)pgm_queue_pop_tail_link (&window->batch_skbs), &released);
+	pgm_skb_pool_release_list (released);
+
+/* unread spilled messages */
+	if (NULL != window->spill)
+		pgm_spill_destroy (window->spill);
+
+/* conflation keys */
+	if (NULL != window->conflate)
+		pgm_conflate_destroy (window->conflate);
+
+/* APDU reassembly, buffers released with the trail */
+	if (NULL != window->placed)
+		pgm_free (window->placed);
+
 /* window must now be empty */
 	pgm_assert_cmpuint (pgm_rxw_length (window), ==, 0);
 	pgm_assert_cmpuint (pgm_rxw_size (window), ==, 0);
@@ -265,6 +517,8 @@ pgm_rxw_destroy (
 	pgm_assert (!pgm_rxw_is_full (window));
 
 /* window */
+	pgm_free (window->data_map);
+	pgm_free_policy (window->pdata);
 	pgm_free (window);
 }
 
@@ -342,49 +596,75 @@ pgm_rxw_add (
 			skb->pgm_opt_fragment = NULL;
 
 /* protocol sanity check: minimum APDU length */
-		if (PGM_UNLIKELY(pgm_ntohl (skb->of_apdu_len) < skb->len))
+		else if (PGM_UNLIKELY(pgm_ntohl (skb->of_apdu_len) < skb->len))
 			return PGM_RXW_MALFORMED;
 
 /* protocol sanity check: sequential ordering */
-		if (PGM_UNLIKELY(pgm_uint32_gt (pgm_ntohl (skb->of_apdu_first_sqn), skb->sequence)))
+		else if (PGM_UNLIKELY(pgm_uint32_gt (pgm_ntohl (skb->of_apdu_first_sqn), skb->sequence)))
 			return PGM_RXW_MALFORMED;
 
 /* protocol sanity check: maximum APDU length */
-		if (PGM_UNLIKELY(pgm_ntohl (skb->of_apdu_len) > PGM_MAX_APDU))
+		else if (PGM_UNLIKELY(pgm_ntohl (skb->of_apdu_len) > _pgm_rxw_max_apdu (window)))
+			return PGM_RXW_MALFORMED;
+	}
+
+/* parity is only of use with a matching FEC block, the packet sequence
+ * carries the parity index which must lie within the block.
+ */
+	if (skb->pgm_header->pgm_options & PGM_OPT_PARITY)
+	{
+		if (!window->is_fec_available)
+			return PGM_RXW_DUPLICATE;
+		if (PGM_UNLIKELY(_pgm_rxw_pkt_sqn (window, skb->sequence) >= (uint32_t)(window->rs.n - window->rs.k)))
 			return PGM_RXW_MALFORMED;
 	}
 
-/* first packet of a session defines the window */
+/* first packet of a session defines the window, parity at its transmission group */
 	if (PGM_UNLIKELY(!window->is_defined))
-		_pgm_rxw_define (window, skb->sequence - 1);	/* previous_lead needed for append to occur */
+		_pgm_rxw_define (window, ((skb->pgm_header->pgm_options & PGM_OPT_PARITY) ?
+					   _pgm_rxw_tg_sqn (window, skb->sequence) : skb->sequence) - 1);	/* previous_lead needed for append to occur */
 	else
 		_pgm_rxw_update_trail (window, pgm_ntohl (skb->pgm_data->data_trail));
 
+/* in-order fast path: the next sequence of a single TPDU APDU without outstanding
+ * loss skips the placeholder and repair checks.
+ */
+	if (PGM_LIKELY(skb->sequence == pgm_rxw_next_lead (window) &&
+		       !(skb->pgm_header->pgm_options & PGM_OPT_PARITY) &&
+		       NULL == skb->pgm_opt_fragment &&
+		       _pgm_rxw_is_loss_free (window) &&
+		       !pgm_rxw_is_full (window)))
+	{
+		status = _pgm_rxw_append_in_order (window, skb);
+		if (NULL != window->conflate_req)
+			_pgm_rxw_conflate (window, skb);
+		return status;
+	}
+
 /* bounds checking for parity data occurs at the transmission group sequence number */
 	if (skb->pgm_header->pgm_options & PGM_OPT_PARITY)
 	{
-		if (pgm_uint32_lt (_pgm_rxw_tg_sqn (window, skb->sequence), _pgm_rxw_tg_sqn (window, window->commit_lead)))
+		const uint32_t tg_sqn = _pgm_rxw_tg_sqn (window, skb->sequence);
+
+		if (pgm_uint32_lt (tg_sqn, _pgm_rxw_tg_sqn (window, window->commit_lead)) ||
+		    _pgm_rxw_has_parity_index (window, skb))
 			return PGM_RXW_DUPLICATE;
 
-		if (pgm_uint32_lt (_pgm_rxw_tg_sqn (window, skb->sequence), _pgm_rxw_tg_sqn (window, window->lead))) {
+		if (pgm_uint32_lt (tg_sqn, _pgm_rxw_tg_sqn (window, window->lead))) {
 			window->has_event = 1;
 			return _pgm_rxw_insert (window, skb);
 		}
 
-		const struct pgm_sk_buff_t* const first_skb = _pgm_rxw_peek (window, _pgm_rxw_tg_sqn (window, skb->sequence));
-		const pgm_rxw_state_t* const first_state = (pgm_rxw_state_t*)&first_skb->cb;
-
-		if (_pgm_rxw_tg_sqn (window, skb->sequence) == _pgm_rxw_tg_sqn (window, window->lead)) {
+/* fill gaps before extending the transmission group at the lead */
+		if (tg_sqn == _pgm_rxw_tg_sqn (window, window->lead)) {
 			window->has_event = 1;
-			if (NULL == first_state || first_state->is_contiguous) {
-				state->is_contiguous = 1;
-				return _pgm_rxw_append (window, skb, now);
-			} else
+			if (_pgm_rxw_is_last_of_tg_sqn (window, window->lead) ||
+			    NULL != _pgm_rxw_find_missing (window, tg_sqn))
 				return _pgm_rxw_insert (window, skb);
+			return _pgm_rxw_append (window, skb, now);
 		}
 
-		pgm_assert (NULL != first_state);
-		status = _pgm_rxw_add_placeholder_range (window, _pgm_rxw_tg_sqn (window, skb->sequence), now, nak_rb_expiry);
+		status = _pgm_rxw_add_placeholder_range (window, tg_sqn, now, nak_rb_expiry);
 	}
 	else
 	{
@@ -397,14 +677,27 @@ pgm_rxw_add (
 
 		if (pgm_uint32_lte (skb->sequence, window->lead)) {
 			window->has_event = 1;
-			return _pgm_rxw_insert (window, skb);
+			status = _pgm_rxw_insert (window, skb);
+			if (PGM_RXW_INSERTED == status && NULL != window->conflate_req)
+				_pgm_rxw_conflate (window, skb);
+			if (PGM_RXW_INSERTED == status && NULL != window->placement_pool && NULL != skb->pgm_opt_fragment)
+				_pgm_rxw_place (window, skb);
+/* a filled gap may complete the coding window of a held repair */
+			if (PGM_RXW_INSERTED == status && !pgm_queue_is_empty (&window->sw_repairs))
+				_pgm_rxw_sw_recover (window);
+			return status;
 		}
 
 		if (skb->sequence == pgm_rxw_next_lead (window)) {
 			window->has_event = 1;
 			if (_pgm_rxw_is_first_of_tg_sqn (window, skb->sequence))
 				state->is_contiguous = 1;
-			return _pgm_rxw_append (window, skb, now);
+			status = _pgm_rxw_append (window, skb, now);
+			if (PGM_RXW_APPENDED == status && NULL != window->conflate_req)
+				_pgm_rxw_conflate (window, skb);
+			if (PGM_RXW_APPENDED == status && NULL != window->placement_pool && NULL != skb->pgm_opt_fragment)
+				_pgm_rxw_place (window, skb);
+			return status;
 		}
 
 		status = _pgm_rxw_add_placeholder_range (window, skb->sequence, now, nak_rb_expiry);
@@ -412,12 +705,104 @@ pgm_rxw_add (
 
 	if (PGM_RXW_APPENDED == status) {
 		status = _pgm_rxw_append (window, skb, now);
-		if (PGM_RXW_APPENDED == status)
+		if (PGM_RXW_APPENDED == status) {
+			if (NULL != window->conflate_req &&
+			    !(skb->pgm_header->pgm_options & PGM_OPT_PARITY))
+				_pgm_rxw_conflate (window, skb);
+			if (NULL != window->placement_pool && NULL != skb->pgm_opt_fragment &&
+			    !(skb->pgm_header->pgm_options & PGM_OPT_PARITY))
+				_pgm_rxw_place (window, skb);
 			status = PGM_RXW_MISSING;
+		}
 	}
 	return status;
 }
 
+/* add a sliding window repair to the receive window, the repair codes the count packets
+ * ending at its data_sqn and is held until the coding window is recovered, committed, or
+ * falls behind the trail.
+ *
+ * returns:
+ * PGM_RXW_INSERTED - missing packets recovered, skb consumed.
+ * PGM_RXW_UPDATED - repair held to combine with further repairs, skb consumed.
+ * PGM_RXW_MISSING - as updated whilst window lead was advanced.
+ * PGM_RXW_DUPLICATE - repair of no further use, such as without sliding window FEC.
+ * PGM_RXW_MALFORMED - corrupted or invalid packet.
+ * PGM_RXW_BOUNDS - packet out of window.
+ */
+
+PGM_GNUC_INTERNAL
+int
+pgm_rxw_add_repair (
+	pgm_rxw_t*	      const restrict window,
+	struct pgm_sk_buff_t* const restrict skb,
+	const uint8_t			     count,
+	const uint16_t			     key,
+	const pgm_time_t		     now,
+	const pgm_time_t		     nak_rb_expiry
+	)
+{
+	struct pgm_rxw_repair_t* repair = (struct pgm_rxw_repair_t*)&skb->cb;
+	unsigned lost = 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (NULL != skb);
+	pgm_assert_cmpuint (nak_rb_expiry, >, 0);
+	pgm_assert (pgm_skb_is_valid (skb));
+	pgm_assert (((const pgm_list_t*)skb)->next == NULL);
+	pgm_assert (((const pgm_list_t*)skb)->prev == NULL);
+	pgm_assert (skb->len == ((char*)skb->tail - (char*)skb->data));
+
+	pgm_debug ("add_repair (window:%p skb:%p count:%u key:%u nak_rb_expiry:%" PGM_TIME_FORMAT ")",
+		(const void*)window, (const void*)skb, count, key, nak_rb_expiry);
+
+	skb->sequence = pgm_ntohl (skb->pgm_data->data_sqn);
+
+	if (!window->is_sw_available)
+		return PGM_RXW_DUPLICATE;
+
+/* protocol sanity check: tsdu size and coding window */
+	if (PGM_UNLIKELY(skb->len != pgm_ntohs (skb->pgm_header->pgm_tsdu_length) ||
+			 skb->len <= PGM_RLC_SYMBOL_HEADER ||
+			 0 == count || count > window->sw_window))
+		return PGM_RXW_MALFORMED;
+
+/* protocol sanity check: valid trail pointer wrt. sequence */
+	if (PGM_UNLIKELY(skb->sequence - pgm_ntohl (skb->pgm_data->data_trail) >= ((UINT32_MAX/2)-1)))
+		return PGM_RXW_BOUNDS;
+
+/* original data defines the window */
+	if (PGM_UNLIKELY(!window->is_defined))
+		return PGM_RXW_DUPLICATE;
+	_pgm_rxw_update_trail (window, pgm_ntohl (skb->pgm_data->data_trail));
+
+	repair->first_sqn = skb->sequence - count + 1;
+	repair->key	  = key;
+	repair->count	  = count;
+
+	if (pgm_uint32_lt (repair->first_sqn, window->trail) ||
+	    pgm_uint32_lt (skb->sequence, window->commit_lead))
+		return PGM_RXW_DUPLICATE;
+
+/* the repair proves the covered packets were sent */
+	if (pgm_uint32_gt (skb->sequence, window->lead)) {
+		lost = _pgm_rxw_update_lead (window, skb->sequence, now, nak_rb_expiry);
+		if (pgm_uint32_gt (skb->sequence, window->lead))
+			return PGM_RXW_BOUNDS;
+		if (pgm_uint32_lt (repair->first_sqn, window->trail))
+			return PGM_RXW_DUPLICATE;
+	}
+
+	if (PGM_RLC_MAX_UNKNOWNS == window->sw_repairs.length)
+		pgm_free_skb ((struct pgm_sk_buff_t*)pgm_queue_pop_tail_link (&window->sw_repairs));
+	pgm_queue_push_head_link (&window->sw_repairs, (pgm_list_t*)skb);
+
+	if (_pgm_rxw_sw_recover (window))
+		return PGM_RXW_INSERTED;
+	return lost ? PGM_RXW_MISSING : PGM_RXW_UPDATED;
+}
+
 /* trail is the next packet to commit upstream, lead is the leading edge
  * of the receive window with possible gaps inside, rxw_trail is the transmit
  * window trail for retransmit requests.
@@ -443,6 +828,8 @@ _pgm_rxw_define (
 	window->lead = lead;
 	window->commit_lead = window->rxw_trail = window->rxw_trail_init = window->trail = window->lead + 1;
 	window->is_constrained = window->is_defined = TRUE;
+	window->apdu_tpdus = 0;
+	window->is_streaming = 0;
 
 /* post-conditions */
 	pgm_assert (pgm_rxw_is_empty (window));
@@ -483,6 +870,36 @@ pgm_rxw_update (
 	return _pgm_rxw_update_lead (window, txw_lead, now, nak_rb_expiry);
 }
 
+/* define the window of a late joining receiver at the first sequence to catch up
+ * on, placeholders up to the lead wait for repairs until nak_rb_expiry.
+ *
+ * returns count of placeholders added into window.
+ */
+
+PGM_GNUC_INTERNAL
+unsigned
+pgm_rxw_catchup (
+	pgm_rxw_t* const	window,
+	const uint32_t		first,
+	const uint32_t		lead,
+	const pgm_time_t	now,
+	const pgm_time_t	nak_rb_expiry
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (!window->is_defined);
+	pgm_assert (pgm_uint32_lte (first, lead));
+	pgm_assert_cmpuint (lead - first, <, pgm_rxw_max_length (window));
+	pgm_assert_cmpuint (nak_rb_expiry, >, 0);
+
+	pgm_debug ("pgm_rxw_catchup (window:%p first:%" PRIu32 " lead:%" PRIu32 " nak-rb-expiry:%" PGM_TIME_FORMAT ")",
+		(void*)window, first, lead, nak_rb_expiry);
+
+	_pgm_rxw_define (window, first - 1);
+	return _pgm_rxw_update_lead (window, lead, now, nak_rb_expiry);
+}
+
 /* update trailing edge of receive window
  */
 
@@ -599,6 +1016,8 @@ pgm_rxw_update_fec (
 
 	if (window->is_fec_available) {
 		if (rs_k == window->rs.k) return;
+		if (NULL != window->decoder)
+			_pgm_rxw_reconstruct_cancel (window);
 		pgm_rs_destroy (&window->rs);
 	} else
 		window->is_fec_available = 1;
@@ -607,6 +1026,54 @@ pgm_rxw_update_fec (
 	window->tg_size = window->rs.k;
 }
 
+/* update sliding window FEC parameters
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_rxw_update_sw (
+	pgm_rxw_t* const	window,
+	const uint8_t		sw_window
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert_cmpuint (sw_window, >, 1);
+	pgm_assert_cmpuint (sw_window, <=, PGM_RLC_MAX_WINDOW);
+
+	pgm_debug ("pgm_rxw_update_sw (window:%p sw-window:%u)",
+		(void*)window, sw_window);
+
+	window->sw_window	= sw_window;
+	window->is_sw_available	= 1;
+}
+
+/* release storage of an idle window: an empty window frees pdata until the
+ * next sequence, otherwise pdata shrinks to the smallest doubling that holds
+ * the remaining sequences.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_rxw_compact (
+	pgm_rxw_t* const	window
+	)
+{
+	unsigned alloc = 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+
+	const uint32_t length = pgm_rxw_length (window);
+	if (length > 0) {
+		alloc = MIN(PGM_RXW_MIN_ALLOC, window->max_alloc);
+		while (alloc < length)
+			alloc = MIN(2 * alloc, window->max_alloc);
+	}
+	if (alloc < window->alloc)
+		_pgm_rxw_resize (window, alloc);
+}
+
 /* add one placeholder to leading edge due to detected lost packet.
  */
 
@@ -626,6 +1093,7 @@ _pgm_rxw_add_placeholder (
 	pgm_assert (!pgm_rxw_is_full (window));
 
 /* advance lead */
+	_pgm_rxw_reserve (window);
 	window->lead++;
 
 /* add loss to bitmap */
@@ -638,11 +1106,11 @@ _pgm_rxw_add_placeholder (
  */
 	window->data_loss = window->ack_c_p + pgm_fp16mul ((pgm_fp16 (1) - window->ack_c_p), window->data_loss);
 
-	skb			= pgm_alloc_skb (window->max_tpdu);
+	skb			= pgm_skb_pool_alloc_subsys (window->skb_pool, window->max_tpdu, PGM_MEM_SUBSYS_PLACEHOLDER);
 	state			= (pgm_rxw_state_t*)&skb->cb;
 	skb->tstamp		= now;
 	skb->sequence		= window->lead;
-	state->timer_expiry	= nak_rb_expiry;
+	state->timer_expiry	= pgm_rxw_expiry (window, skb, nak_rb_expiry);
 
 	if (!_pgm_rxw_is_first_of_tg_sqn (window, skb->sequence))
 	{
@@ -654,7 +1122,7 @@ _pgm_rxw_add_placeholder (
 	}
 
 /* add skb to window */
-	const uint_fast32_t index_	= skb->sequence % pgm_rxw_max_length (window);
+	const uint_fast32_t index_	= _pgm_rxw_index (window, skb->sequence);
 	window->pdata[index_]		= skb;
 
 	pgm_rxw_state (window, skb, PGM_PKT_STATE_BACK_OFF);
@@ -683,8 +1151,8 @@ _pgm_rxw_add_placeholder_range (
 
 /* check bounds of commit window */
 	const uint32_t new_commit_sqns = ( 1 + sequence ) - window->trail;
-        if ( !_pgm_rxw_commit_is_empty (window) &&
-	     (new_commit_sqns >= pgm_rxw_max_length (window)) )
+        if ( (new_commit_sqns >= pgm_rxw_max_length (window)) &&
+	     !_pgm_rxw_release_commit (window) )
         {
 		_pgm_rxw_update_lead (window, sequence, now, nak_rb_expiry);
 		return PGM_RXW_BOUNDS;		/* effectively a slow consumer */
@@ -693,7 +1161,7 @@ _pgm_rxw_add_placeholder_range (
 	if (pgm_rxw_is_full (window)) {
 		pgm_assert (_pgm_rxw_commit_is_empty (window));
 		pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Receive window full on placeholder sequence."));
-		_pgm_rxw_remove_trail (window);
+		_pgm_rxw_remove_full_trail (window);
 	}
 
 /* if packet is non-contiguous to current leading edge add place holders
@@ -705,7 +1173,7 @@ _pgm_rxw_add_placeholder_range (
 		if (pgm_rxw_is_full (window)) {
 			pgm_assert (_pgm_rxw_commit_is_empty (window));
 			pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Receive window full on placeholder sequence."));
-			_pgm_rxw_remove_trail (window);
+			_pgm_rxw_remove_full_trail (window);
 		}
 	}
 
@@ -740,8 +1208,8 @@ _pgm_rxw_update_lead (
 		return 0;
 
 /* committed packets limit constrain the lead until they are released */
-	if (!_pgm_rxw_commit_is_empty (window) &&
-	    (txw_lead - window->trail) >= pgm_rxw_max_length (window))
+	if ((txw_lead - window->trail) >= pgm_rxw_max_length (window) &&
+	    !_pgm_rxw_release_commit (window))
 	{
 		lead = window->trail + pgm_rxw_max_length (window) - 1;
 		if (lead == window->lead)
@@ -757,7 +1225,7 @@ _pgm_rxw_update_lead (
 		if (pgm_rxw_is_full (window)) {
 			pgm_assert (_pgm_rxw_commit_is_empty (window));
 			pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Receive window full on window lead advancement."));
-			_pgm_rxw_remove_trail (window);
+			_pgm_rxw_remove_full_trail (window);
 		}
 		_pgm_rxw_add_placeholder (window, now, nak_rb_expiry);
 		lost++;
@@ -796,6 +1264,12 @@ _pgm_rxw_is_apdu_lost (
 	if (apdu_first_sqn == skb->sequence)
 		return FALSE;
 
+/* remainder of an APDU streamed to the application, the first fragment has left the window */
+	if (window->is_streaming &&
+	    apdu_first_sqn == window->stream_first &&
+	    pgm_uint32_gte (skb->sequence, window->stream_next))
+		return FALSE;
+
 	const struct pgm_sk_buff_t* const first_skb = _pgm_rxw_peek (window, apdu_first_sqn);
 /* first fragment out-of-bounds */
 	if (NULL == first_skb)
@@ -808,97 +1282,141 @@ _pgm_rxw_is_apdu_lost (
 	return FALSE;
 }
 
-/* return the first missing packet sequence in the specified transmission
- * group or NULL if not required.
+/* return the first missing packet sequence in the transmission group of
+ * sequence or NULL if not required.  committed sequences and sequences
+ * beyond the lead are not candidates.
  */
 
 static inline
 struct pgm_sk_buff_t*
 _pgm_rxw_find_missing (
 	pgm_rxw_t* const		window,
-	const uint32_t			tg_sqn		/* tg_sqn | pkt_sqn */
+	const uint32_t			sequence	/* tg_sqn | pkt_sqn */
 	)
 {
 	struct pgm_sk_buff_t* skb;
-	pgm_rxw_state_t* state;
 
 /* pre-conditions */
 	pgm_assert (NULL != window);
 
-	for (uint32_t i = tg_sqn, j = 0; j < window->tg_size; i++, j++)
-	{
-		skb = _pgm_rxw_peek (window, i);
-		pgm_assert (NULL != skb);
-		state = (pgm_rxw_state_t*)&skb->cb;
-		switch (state->pkt_state) {
-		case PGM_PKT_STATE_BACK_OFF:
-		case PGM_PKT_STATE_WAIT_NCF:
-		case PGM_PKT_STATE_WAIT_DATA:
-		case PGM_PKT_STATE_LOST_DATA:
-			return skb;
-
-		case PGM_PKT_STATE_HAVE_DATA:
-		case PGM_PKT_STATE_HAVE_PARITY:
-			break;
+	const uint32_t tg_sqn = _pgm_rxw_tg_sqn (window, sequence);
+	const uint32_t tg_end = tg_sqn + window->tg_size;
+	uint32_t first = tg_sqn;
+	if (pgm_uint32_lt (first, window->commit_lead))
+		first = window->commit_lead;
+	if (pgm_uint32_gte (first, tg_end) || pgm_uint32_gt (first, window->lead))
+		return NULL;
+	const uint32_t count = pgm_uint32_lt (window->lead, tg_end) ? ( 1 + window->lead ) - first : tg_end - first;
 
-		default: pgm_assert_not_reached(); break;
-		}
-	}
+/* skip received data and parity a word at a time */
+	const uint32_t have = _pgm_rxw_map_run (window, window->data_map, window->parity_map, first, count);
+	if (have == count)
+		return NULL;
 
-	return NULL;
+	skb = _pgm_rxw_peek (window, first + have);
+	pgm_assert (NULL != skb);
+#ifdef RXW_DEBUG
+	const pgm_rxw_state_t* state = (const pgm_rxw_state_t*)&skb->cb;
+	pgm_assert (PGM_PKT_STATE_HAVE_DATA != state->pkt_state &&
+		    PGM_PKT_STATE_HAVE_PARITY != state->pkt_state);
+#endif
+	return skb;
 }
 
-/* returns TRUE if skb is a parity packet with packet length not
- * matching the transmission group length without the variable-packet-length
- * flag set.
+/* returns TRUE if the transmission group already holds a parity packet with
+ * the parity index of skb, a repeated index adds nothing to recovery.
  */
 
 static inline
 bool
-_pgm_rxw_is_invalid_var_pktlen (
+_pgm_rxw_has_parity_index (
 	pgm_rxw_t*		    const restrict window,
 	const struct pgm_sk_buff_t* const restrict skb
 	)
 {
-	const struct pgm_sk_buff_t* first_skb;
-
 /* pre-conditions */
 	pgm_assert (NULL != window);
+	pgm_assert (NULL != skb);
 
-	if (!window->is_fec_available)
-		return FALSE;
-
-	if (skb->pgm_header->pgm_options & PGM_OPT_VAR_PKTLEN)
+	if (0 == window->parity_count)
 		return FALSE;
 
 	const uint32_t tg_sqn = _pgm_rxw_tg_sqn (window, skb->sequence);
-	if (tg_sqn == skb->sequence)
-		return FALSE;
-
-	first_skb = _pgm_rxw_peek (window, tg_sqn);
-	if (NULL == first_skb)
-		return TRUE;	/* transmission group unrecoverable */
-
-	if (first_skb->len == skb->len)
-		return FALSE;
-
-	return TRUE;
+	for (uint32_t i = 0; i < window->tg_size; i++)
+	{
+		const struct pgm_sk_buff_t* parity_skb = _pgm_rxw_peek (window, tg_sqn + i);
+		if (NULL == parity_skb)
+			continue;
+		const pgm_rxw_state_t* state = (const pgm_rxw_state_t*)&parity_skb->cb;
+		if (PGM_PKT_STATE_HAVE_PARITY == state->pkt_state &&
+		    parity_skb->pgm_data->data_sqn == skb->pgm_data->data_sqn)
+			return TRUE;
+	}
+	return FALSE;
 }
 
+/* returns the first packet of the transmission group of skb when it holds
+ * original data, or NULL if lost, pending or outside the window.
+ */
+
 static inline
-bool
-_pgm_rxw_has_payload_op (
-	const struct pgm_sk_buff_t* const	skb
+const struct pgm_sk_buff_t*
+_pgm_rxw_peek_tg_data (
+	pgm_rxw_t*		    const restrict window,
+	const struct pgm_sk_buff_t* const restrict skb
 	)
 {
-/* pre-conditions */
-	pgm_assert (NULL != skb);
-	pgm_assert (NULL != skb->pgm_header);
+	const struct pgm_sk_buff_t* first_skb;
+	const pgm_rxw_state_t* first_state;
+
+	first_skb = _pgm_rxw_peek (window, _pgm_rxw_tg_sqn (window, skb->sequence));
+	if (NULL == first_skb)
+		return NULL;
+
+	first_state = (const pgm_rxw_state_t*)&first_skb->cb;
+	if (PGM_PKT_STATE_HAVE_DATA != first_state->pkt_state &&
+	    PGM_PKT_STATE_COMMIT_DATA != first_state->pkt_state)
+		return NULL;
+
+	return first_skb;
+}
+
+/* returns TRUE if skb is a parity packet with packet length not
+ * matching the transmission group length without the variable-packet-length
+ * flag set.  original data packets may always vary in length.
+ */
+
+static inline
+bool
+_pgm_rxw_is_invalid_var_pktlen (
+	pgm_rxw_t*		    const restrict window,
+	const struct pgm_sk_buff_t* const restrict skb
+	)
+{
+	const struct pgm_sk_buff_t* first_skb;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+
+	if (!window->is_fec_available)
+		return FALSE;
+
+	if (!(skb->pgm_header->pgm_options & PGM_OPT_PARITY) ||
+	    skb->pgm_header->pgm_options & PGM_OPT_VAR_PKTLEN)
+		return FALSE;
+
+	first_skb = _pgm_rxw_peek_tg_data (window, skb);
+	if (NULL == first_skb)
+		return FALSE;
+
+	if (first_skb->len == skb->len)
+		return FALSE;
 
-	return skb->pgm_opt_fragment || skb->pgm_header->pgm_options & PGM_OP_ENCODED;
+	return TRUE;
 }
 
-/* returns TRUE is skb options are invalid when compared to the transmission group
+/* returns TRUE if skb is a parity packet without encoded options for a
+ * transmission group carrying fragment options.
  */
 
 static inline
@@ -917,20 +1435,41 @@ _pgm_rxw_is_invalid_payload_op (
 	if (!window->is_fec_available)
 		return FALSE;
 
-	const uint32_t tg_sqn = _pgm_rxw_tg_sqn (window, skb->sequence);
-	if (tg_sqn == skb->sequence)
+	if (!(skb->pgm_header->pgm_options & PGM_OPT_PARITY) ||
+	    skb->pgm_header->pgm_options & PGM_OPT_PRESENT)
 		return FALSE;
 
-	first_skb = _pgm_rxw_peek (window, tg_sqn);
+	first_skb = _pgm_rxw_peek_tg_data (window, skb);
 	if (NULL == first_skb)
-		return TRUE;	/* transmission group unrecoverable */
+		return FALSE;
 
-	if (_pgm_rxw_has_payload_op (first_skb) == _pgm_rxw_has_payload_op (skb))
+	if (NULL == first_skb->pgm_opt_fragment)
 		return FALSE;
 
 	return TRUE;
 }
 
+/* Jacobson/Karels round trip estimator with the RFC 6298 gains α = ⅛, β = ¼.
+ */
+
+static inline
+void
+_pgm_rxw_rtt_sample (
+	pgm_time_t*const restrict	srtt,
+	pgm_time_t*const restrict	rttvar,
+	const pgm_time_t		sample
+	)
+{
+	if (0 == *srtt) {
+		*srtt	= MAX(sample, 1);
+		*rttvar	= sample / 2;
+		return;
+	}
+	const pgm_time_t err = pgm_time_after (sample, *srtt) ? sample - *srtt : *srtt - sample;
+	*rttvar	= *rttvar - (*rttvar >> 2) + (err >> 2);
+	*srtt	= *srtt - (*srtt >> 3) + (sample >> 3);
+}
+
 /* insert skb into window range, discard if duplicate.  window will have placeholder,
  * parity, or data packet already matching sequence.
  *
@@ -962,9 +1501,13 @@ _pgm_rxw_insert (
 
 	if (new_skb->pgm_header->pgm_options & PGM_OPT_PARITY)
 	{
+/* parity fills the first gap in the transmission group, the original
+ * sequence remains available in the packet header as the parity index.
+ */
 		skb = _pgm_rxw_find_missing (window, new_skb->sequence);
 		if (NULL == skb)
 			return PGM_RXW_DUPLICATE;
+		new_skb->sequence = skb->sequence;
 		state = (pgm_rxw_state_t*)&skb->cb;
 	}
 	else
@@ -975,14 +1518,14 @@ _pgm_rxw_insert (
 
 		if (state->pkt_state == PGM_PKT_STATE_HAVE_DATA)
 			return PGM_RXW_DUPLICATE;
-	}
 
 /* APDU fragments are already declared lost */
-	if (new_skb->pgm_opt_fragment &&
-	    _pgm_rxw_is_apdu_lost (window, new_skb))
-	{
-		pgm_rxw_lost (window, skb->sequence);
-		return PGM_RXW_BOUNDS;
+		if (new_skb->pgm_opt_fragment &&
+		    _pgm_rxw_is_apdu_lost (window, new_skb))
+		{
+			pgm_rxw_lost (window, skb->sequence);
+			return PGM_RXW_BOUNDS;
+		}
 	}
 
 /* verify placeholder state */
@@ -994,14 +1537,25 @@ _pgm_rxw_insert (
 		break;
 
 	case PGM_PKT_STATE_HAVE_PARITY:
-		_pgm_rxw_shuffle_parity (window, skb);
+		skb = _pgm_rxw_shuffle_parity (window, skb);
+		state = (pgm_rxw_state_t*)&skb->cb;
 		break;
 
 	default: pgm_assert_not_reached(); break;
 	}
 
-/* statistics */
-	const uint32_t fill_time = (uint32_t)(new_skb->tstamp - skb->tstamp);
+/* time the repair from its NCF whilst no retry makes the request ambiguous */
+	if (PGM_PKT_STATE_WAIT_DATA == state->pkt_state &&
+	    state->nak_transmit_count <= 1 &&
+	    0 == state->data_retry_count &&
+	    0 != state->nak_tstamp &&
+	    pgm_time_after (new_skb->wire_tstamp, state->nak_tstamp))
+	{
+		_pgm_rxw_rtt_sample (&window->rdata_srtt, &window->rdata_rttvar, new_skb->wire_tstamp - state->nak_tstamp);
+	}
+
+/* statistics, placeholders are stamped with the arrival time of the packet revealing loss */
+	const uint32_t fill_time = (uint32_t)(new_skb->wire_tstamp - skb->tstamp);
 	PGM_HISTOGRAM_TIMES("Rx.RepairTime", fill_time);
 	PGM_HISTOGRAM_COUNTS("Rx.NakTransmits", state->nak_transmit_count);
 	PGM_HISTOGRAM_COUNTS("Rx.NcfRetries", state->ncf_retry_count);
@@ -1045,9 +1599,11 @@ _pgm_rxw_insert (
 	memcpy (new_skb->cb, skb->cb, sizeof(skb->cb));
 	state = (void*)new_skb->cb;
 	state->pkt_state = PGM_PKT_STATE_ERROR;
+	state->fill_time = fill_time;
 	_pgm_rxw_unlink (window, skb);
+	window->size -= skb->len;
 	pgm_free_skb (skb);
-	const uint_fast32_t index_ = new_skb->sequence % pgm_rxw_max_length (window);
+	const uint_fast32_t index_ = _pgm_rxw_index (window, new_skb->sequence);
 	window->pdata[index_] = new_skb;
 	if (new_skb->pgm_header->pgm_options & PGM_OPT_PARITY)
 		_pgm_rxw_state (window, new_skb, PGM_PKT_STATE_HAVE_PARITY);
@@ -1058,18 +1614,21 @@ _pgm_rxw_insert (
 	return PGM_RXW_INSERTED;
 }
 
-/* shuffle parity packet at skb->sequence to any other needed spot.
+/* shuffle parity packet at skb->sequence to any other needed spot in the
+ * transmission group, swapping slots with the placeholder found there.
+ *
+ * returns the skb now occupying the original slot, a placeholder or the
+ * parity packet itself when no longer needed.
  */
 
 static inline
-void
+struct pgm_sk_buff_t*
 _pgm_rxw_shuffle_parity (
 	pgm_rxw_t*	      const restrict window,
 	struct pgm_sk_buff_t* const restrict skb
 	)
 {
 	struct pgm_sk_buff_t* restrict missing;
-	char cb[48];
 
 /* pre-conditions */
 	pgm_assert (NULL != window);
@@ -1077,17 +1636,72 @@ _pgm_rxw_shuffle_parity (
 
 	missing = _pgm_rxw_find_missing (window, skb->sequence);
 	if (NULL == missing)
-		return;
+		return skb;
+
+/* parity state follows the slot bitmaps so re-enter it at the new position */
+	const uint32_t parity_sequence = skb->sequence;
+	_pgm_rxw_unlink (window, skb);
+	skb->sequence = missing->sequence;
+	missing->sequence = parity_sequence;
+	window->pdata[ _pgm_rxw_index (window, skb->sequence) ] = skb;
+	window->pdata[ _pgm_rxw_index (window, missing->sequence) ] = missing;
+	_pgm_rxw_state (window, skb, PGM_PKT_STATE_HAVE_PARITY);
+	return missing;
+}
+
+/* returns TRUE if no sequence in the window is waiting on a NAK or repair.
+ */
+
+static inline
+bool
+_pgm_rxw_is_loss_free (
+	const pgm_rxw_t* const	window
+	)
+{
+	return pgm_queue_is_empty (&window->nak_backoff_queue) &&
+	       pgm_queue_is_empty (&window->wait_ncf_queue) &&
+	       pgm_queue_is_empty (&window->wait_data_queue);
+}
+
+/* original data at the next lead, not a fragment and the window not full, so
+ * none of the loss or FEC checks of _pgm_rxw_append() apply.  the slot of the
+ * following sequence is prefetched for the next call.
+ *
+ * returns PGM_RXW_APPENDED, skb consumed.
+ */
+
+static inline
+int
+_pgm_rxw_append_in_order (
+	pgm_rxw_t*	      const restrict window,
+	struct pgm_sk_buff_t* const restrict skb
+	)
+{
+	pgm_rxw_state_t* const state = (pgm_rxw_state_t*)&skb->cb;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (NULL != skb);
+	pgm_assert (skb->sequence == pgm_rxw_next_lead (window));
+	pgm_assert (!pgm_rxw_is_full (window));
+
+	window->has_event = 1;
+	if (_pgm_rxw_is_first_of_tg_sqn (window, skb->sequence))
+		state->is_contiguous = 1;
 
-/* replace place holder skb with parity skb */
-	_pgm_rxw_unlink (window, missing);
-	memcpy (cb, skb->cb, sizeof(skb->cb));
-	memcpy (skb->cb, missing->cb, sizeof(skb->cb));
-	memcpy (missing->cb, cb, sizeof(skb->cb));
-	const uint32_t parity_index = skb->sequence % pgm_rxw_max_length (window);
-	window->pdata[parity_index] = skb;
-	const uint32_t missing_index = missing->sequence % pgm_rxw_max_length (window);
-	window->pdata[missing_index] = missing;
+	_pgm_rxw_reserve (window);
+	window->lead++;
+	window->bitmap = (window->bitmap << 1) | 1;
+	window->data_loss = pgm_fp16mul (window->data_loss, pgm_fp16 (1) - window->ack_c_p);
+
+	window->pdata[ _pgm_rxw_index (window, skb->sequence) ] = skb;
+	pgm_prefetchw (&window->pdata[ _pgm_rxw_index (window, skb->sequence + 1) ]);
+	_pgm_rxw_state (window, skb, PGM_PKT_STATE_HAVE_DATA);
+
+/* statistics */
+	window->size += skb->len;
+
+	return PGM_RXW_APPENDED;
 }
 
 /* skb advances the window lead.
@@ -1110,7 +1724,7 @@ _pgm_rxw_append (
 	pgm_assert (NULL != window);
 	pgm_assert (NULL != skb);
 	if (skb->pgm_header->pgm_options & PGM_OPT_PARITY) {
-		pgm_assert (_pgm_rxw_tg_sqn (window, skb->sequence) == _pgm_rxw_tg_sqn (window, pgm_rxw_lead (window)));
+		pgm_assert (_pgm_rxw_tg_sqn (window, skb->sequence) == _pgm_rxw_tg_sqn (window, pgm_rxw_next_lead (window)));
 	} else {
 		pgm_assert (skb->sequence == pgm_rxw_next_lead (window));
 	}
@@ -1120,16 +1734,19 @@ _pgm_rxw_append (
 		return PGM_RXW_MALFORMED;
 
 	if (pgm_rxw_is_full (window)) {
-		if (_pgm_rxw_commit_is_empty (window)) {
+		if (_pgm_rxw_release_commit (window)) {
 			pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Receive window full on new data."));
-			_pgm_rxw_remove_trail (window);
+			_pgm_rxw_remove_full_trail (window);
 		} else {
 			return PGM_RXW_BOUNDS;		/* constrained by commit window */
 		}
 	}
 
-/* advance leading edge */
+/* advance leading edge, parity takes the next slot of the transmission group */
+	_pgm_rxw_reserve (window);
 	window->lead++;
+	if (skb->pgm_header->pgm_options & PGM_OPT_PARITY)
+		skb->sequence = window->lead;
 
 /* add packet to bitmap */
 	window->bitmap = (window->bitmap << 1) | 1;
@@ -1142,15 +1759,16 @@ _pgm_rxw_append (
 	window->data_loss = pgm_fp16mul (window->data_loss, pgm_fp16 (1) - window->ack_c_p);
 
 /* APDU fragments are already declared lost */
-	if (PGM_UNLIKELY(skb->pgm_opt_fragment &&
+	if (PGM_UNLIKELY(!(skb->pgm_header->pgm_options & PGM_OPT_PARITY) &&
+	    skb->pgm_opt_fragment &&
 	    _pgm_rxw_is_apdu_lost (window, skb)))
 	{
-		struct pgm_sk_buff_t* lost_skb	= pgm_alloc_skb (window->max_tpdu);
+		struct pgm_sk_buff_t* lost_skb	= pgm_skb_pool_alloc_subsys (window->skb_pool, window->max_tpdu, PGM_MEM_SUBSYS_PLACEHOLDER);
 		lost_skb->tstamp		= now;
 		lost_skb->sequence		= skb->sequence;
 
 /* add lost-placeholder skb to window */
-		const uint_fast32_t index_	= lost_skb->sequence % pgm_rxw_max_length (window);
+		const uint_fast32_t index_	= _pgm_rxw_index (window, lost_skb->sequence);
 		window->pdata[index_]		= lost_skb;
 
 		_pgm_rxw_state (window, lost_skb, PGM_PKT_STATE_LOST_DATA);
@@ -1160,13 +1778,13 @@ _pgm_rxw_append (
 /* add skb to window */
 	if (skb->pgm_header->pgm_options & PGM_OPT_PARITY)
 	{
-		const uint_fast32_t index_	= skb->sequence % pgm_rxw_max_length (window);
+		const uint_fast32_t index_	= _pgm_rxw_index (window, skb->sequence);
 		window->pdata[index_]		= skb;
 		_pgm_rxw_state (window, skb, PGM_PKT_STATE_HAVE_PARITY);
 	}
 	else
 	{
-		const uint_fast32_t index_	= skb->sequence % pgm_rxw_max_length (window);
+		const uint_fast32_t index_	= _pgm_rxw_index (window, skb->sequence);
 		window->pdata[index_]		= skb;
 		_pgm_rxw_state (window, skb, PGM_PKT_STATE_HAVE_DATA);
 	}
@@ -1178,7 +1796,10 @@ _pgm_rxw_append (
 }
 
 /* remove references to all commit packets not in the same transmission group
- * as the commit-lead
+ * as the commit-lead, with sliding window FEC the last sw_window packets are
+ * kept for repairs reaching behind the commit-lead.  messages unpacked from
+ * OPT_BATCH packets or replayed from the spill log, and packets released early
+ * for spilling, are all released.
  */
 
 PGM_GNUC_INTERNAL
@@ -1190,13 +1811,97 @@ pgm_rxw_remove_commit (
 /* pre-conditions */
 	pgm_assert (NULL != window);
 
+	struct pgm_sk_buff_t* released = NULL;
+	while (!pgm_queue_is_empty (&window->batch_skbs))
+		pgm_free_skb_deferred ((struct pgm_sk_buff_t*)pgm_queue_pop_tail_link (&window->batch_skbs), &released);
+
 	const uint32_t tg_sqn_of_commit_lead = _pgm_rxw_tg_sqn (window, window->commit_lead);
+	uint32_t sequence = window->trail;
 
-	while (!_pgm_rxw_commit_is_empty (window) &&
-	       tg_sqn_of_commit_lead != _pgm_rxw_tg_sqn (window, window->trail))
+	while (sequence != window->commit_lead &&
+	       tg_sqn_of_commit_lead != _pgm_rxw_tg_sqn (window, sequence) &&
+	       (!window->is_sw_available ||
+		window->commit_lead - sequence >= window->sw_window))
 	{
-		_pgm_rxw_remove_trail (window);
+		sequence++;
+	}
+	_pgm_rxw_remove_trail_range (window, sequence - window->trail, &released);
+	pgm_skb_pool_release_list (released);
+}
+
+/* remove count committed packets from the trail, the skbuffs without other
+ * references are chained on to released.
+ */
+
+static
+void
+_pgm_rxw_remove_trail_range (
+	pgm_rxw_t*	       const restrict window,
+	const uint32_t			      count,
+	struct pgm_sk_buff_t** const restrict released
+	)
+{
+	size_t size = 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (NULL != released);
+	pgm_assert_cmpuint (count, <=, _pgm_rxw_commit_length (window));
+
+	const uint32_t trail = window->trail + count;
+	for (uint32_t sequence = window->trail; sequence != trail; sequence++)
+	{
+		const uint_fast32_t index_ = _pgm_rxw_index (window, sequence);
+		struct pgm_sk_buff_t* skb = window->pdata[index_];
+		pgm_assert (NULL != skb);
+		if (sequence + 1 != trail)
+			pgm_prefetch (window->pdata[ _pgm_rxw_index (window, sequence + 1) ]);
+		_pgm_rxw_unlink (window, skb);
+		size += skb->len;
+/* APDU of the trail reassembled but not delivered */
+		if (PGM_UNLIKELY(NULL != window->placed)) {
+			struct pgm_sk_buff_t** placed = &window->placed[ sequence % window->max_alloc ];
+			if (NULL != *placed) {
+				pgm_free_skb_deferred (*placed, released);
+				*placed = NULL;
+			}
+		}
+		if (PGM_UNLIKELY(pgm_mem_gc_friendly))
+			window->pdata[index_] = NULL;
+		pgm_free_skb_deferred (skb, released);
+	}
+	window->size -= size;
+	window->trail = trail;
+}
+
+/* replay spilled messages, each segment a new skbuff held by the window until
+ * the next pgm_rxw_remove_commit().
+ *
+ * returns count of bytes read.
+ */
+
+static
+ssize_t
+_pgm_rxw_spill_read (
+	pgm_rxw_t*	   const restrict window,
+	struct pgm_msgv_t**	 restrict pmsg,		/* message array, updated as messages appended */
+	const struct pgm_msgv_t* const restrict msg_end	/* last item in message array */
+	)
+{
+	ssize_t bytes_read = 0, len;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (NULL != window->spill);
+
+	while (*pmsg <= msg_end && (len = pgm_spill_read (window->spill, *pmsg)) >= 0)
+	{
+		for (unsigned i = 0; i < (*pmsg)->msgv_len; i++)
+			pgm_queue_push_head_link (&window->batch_skbs, (pgm_list_t*)(*pmsg)->msgv_skb[i]);
+		(*pmsg)++;
+		bytes_read += len;
 	}
+	return bytes_read;
 }
 
 /* flush packets but instead of calling on_data append the contiguous data packets
@@ -1223,7 +1928,7 @@ pgm_rxw_readv (
 	const struct pgm_msgv_t* msg_end;
 	struct pgm_sk_buff_t* skb;
 	pgm_rxw_state_t* state;
-	ssize_t bytes_read;
+	ssize_t bytes_read, spill_read = -1;
 
 /* pre-conditions */
 	pgm_assert (NULL != window);
@@ -1235,8 +1940,19 @@ pgm_rxw_readv (
 
 	msg_end = *pmsg + pmsglen - 1;
 
+/* spilled messages precede the window */
+	if (NULL != window->spill && !pgm_spill_is_empty (window->spill)) {
+		spill_read = _pgm_rxw_spill_read (window, pmsg, msg_end);
+		if (*pmsg > msg_end)
+			return spill_read;
+	}
+
+/* superseded messages are committed unread */
+	if (NULL != window->conflate_req)
+		_pgm_rxw_skip_conflated (window);
+
 	if (_pgm_rxw_incoming_is_empty (window))
-		return -1;
+		return spill_read;
 
 	skb = _pgm_rxw_peek (window, window->commit_lead);
 	pgm_assert (NULL != skb);
@@ -1244,8 +1960,14 @@ pgm_rxw_readv (
 	state = (pgm_rxw_state_t*)&skb->cb;
 	switch (state->pkt_state) {
 	case PGM_PKT_STATE_HAVE_DATA:
+	case PGM_PKT_STATE_HAVE_PARITY:
+	{
+		const struct pgm_msgv_t* msg_start = *pmsg;
+		PGM_PROFILE_BEGIN (read_start);
 		bytes_read = _pgm_rxw_incoming_read (window, pmsg, (unsigned)(msg_end - *pmsg + 1));
+		PGM_PROFILE_END (PGM_PROFILE_RXW_READ, read_start, (unsigned)(*pmsg - msg_start));
 		break;
+	}
 
 	case PGM_PKT_STATE_LOST_DATA:
 /* do not purge in situ sequence */
@@ -1259,7 +1981,6 @@ pgm_rxw_readv (
 	case PGM_PKT_STATE_BACK_OFF:
 	case PGM_PKT_STATE_WAIT_NCF:
 	case PGM_PKT_STATE_WAIT_DATA:
-	case PGM_PKT_STATE_HAVE_PARITY:
 		bytes_read = -1;
 		break;
 
@@ -1270,9 +1991,35 @@ pgm_rxw_readv (
 		break;
 	}
 
+	if (spill_read >= 0)
+		return bytes_read >= 0 ? spill_read + bytes_read : spill_read;
 	return bytes_read;
 }
 
+/* arrival time of the next message to read, spilled or the sequence at the
+ * commit lead.
+ *
+ * returns 0 if the incoming window is empty.
+ */
+
+PGM_GNUC_INTERNAL
+pgm_time_t
+pgm_rxw_next_tstamp (
+	const pgm_rxw_t* const	window
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != window);
+
+	if (NULL != window->spill && !pgm_spill_is_empty (window->spill))
+		return pgm_spill_next_tstamp (window->spill);
+	if (_pgm_rxw_incoming_is_empty (window))
+		return 0;
+	const struct pgm_sk_buff_t* skb = _pgm_rxw_peek (window, window->commit_lead);
+	pgm_assert (NULL != skb);
+	return skb->tstamp;
+}
+
 /* remove lost sequences from the trailing edge of the window.  lost sequence
  * at lead of commit window invalidates all parity-data packets as any 
  * transmission group is now unrecoverable.
@@ -1296,9 +2043,17 @@ _pgm_rxw_remove_trail (
 	pgm_assert (NULL != skb);
 	_pgm_rxw_unlink (window, skb);
 	window->size -= skb->len;
+/* APDU of the trail reassembled but not delivered */
+	if (PGM_UNLIKELY(NULL != window->placed)) {
+		struct pgm_sk_buff_t** placed = &window->placed[ window->trail % window->max_alloc ];
+		if (NULL != *placed) {
+			pgm_free_skb (*placed);
+			*placed = NULL;
+		}
+	}
 /* remove reference to skb */
 	if (PGM_UNLIKELY(pgm_mem_gc_friendly)) {
-		const uint_fast32_t index_ = skb->sequence % pgm_rxw_max_length (window);
+		const uint_fast32_t index_ = _pgm_rxw_index (window, skb->sequence);
 		window->pdata[index_] = NULL;
 	}
 	pgm_free_skb (skb);
@@ -1322,226 +2077,1533 @@ pgm_rxw_remove_trail (
 	return _pgm_rxw_remove_trail (window);
 }
 
-/* read contiguous APDU-grouped sequences from the incoming window.
- *
- * side effects:
- *
- * 1) increments statics for window messages and bytes read.
+/* move messages from the commit lead of a full window to the spill log until
+ * the trailing packet is committed, as if read by the application.  skbuffs of
+ * the read are released immediately.  a message the full log cannot hold is
+ * counted lost.
  *
- * returns count of bytes read.
+ * returns TRUE if the trail is committed, FALSE if it is unread or incomplete.
  */
 
-static inline
-ssize_t
-_pgm_rxw_incoming_read (
-	pgm_rxw_t*    const restrict window,
-	struct pgm_msgv_t** restrict pmsg,		/* message array, updated as messages appended */
-	unsigned		     pmsglen		/* number of items in pmsg */
+static
+bool
+_pgm_rxw_spill (
+	pgm_rxw_t* const	window
 	)
 {
-	const struct pgm_msgv_t* msg_end;
-	struct pgm_sk_buff_t* skb;
-	ssize_t bytes_read = 0;
-	size_t  data_read  = 0;
-
 /* pre-conditions */
 	pgm_assert (NULL != window);
-	pgm_assert (NULL != pmsg);
-	pgm_assert_cmpuint (pmsglen, >, 0);
-	pgm_assert (!_pgm_rxw_incoming_is_empty (window));
+	pgm_assert (NULL != window->spill_req);
+	pgm_assert (_pgm_rxw_commit_is_empty (window));
 
-	pgm_debug ("_pgm_rxw_incoming_read (window:%p pmsg:%p pmsglen:%u)",
-		 (void*)window, (void*)pmsg, pmsglen);
+	if (PGM_UNLIKELY(NULL == window->spill)) {
+		pgm_error_t* spill_error = NULL;
+		window->spill = pgm_spill_create (window->spill_req->sr_dir, window->spill_req->sr_size, &spill_error);
+		if (NULL == window->spill) {
+			pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Spill log not available: %s"),
+				   spill_error ? spill_error->message : "(null)");
+			pgm_error_free (spill_error);
+			window->spill_req = NULL;
+			return FALSE;
+		}
+	}
 
-	msg_end = *pmsg + pmsglen - 1;
-	do {
-		skb = _pgm_rxw_peek (window, window->commit_lead);
+	while (_pgm_rxw_commit_is_empty (window))
+	{
+		if (NULL != window->conflate_req && _pgm_rxw_skip_conflated (window))
+			continue;
+		const struct pgm_sk_buff_t* skb = _pgm_rxw_peek (window, window->commit_lead);
 		pgm_assert (NULL != skb);
-		if (_pgm_rxw_is_apdu_complete (window,
-					      skb->pgm_opt_fragment ? pgm_ntohl (skb->of_apdu_first_sqn) : skb->sequence))
-		{
-			bytes_read += _pgm_rxw_incoming_read_apdu (window, pmsg);
-			data_read  ++;
+		const pgm_rxw_state_t* state = (const pgm_rxw_state_t*)&skb->cb;
+		if (PGM_PKT_STATE_HAVE_DATA != state->pkt_state &&
+		    PGM_PKT_STATE_HAVE_PARITY != state->pkt_state)
+			return FALSE;
+
+		struct pgm_msgv_t msgv, *pmsg = &msgv;
+		const unsigned batch_len = window->batch_skbs.length;
+		const uint32_t commit_lead = window->commit_lead;
+		if (_pgm_rxw_incoming_read (window, &pmsg, 1) < 0)
+			return FALSE;
+		const bool is_spilled = (pmsg == &msgv) || pgm_spill_append (window->spill, &msgv);
+		while (window->batch_skbs.length > batch_len) {
+			pgm_list_t* link = window->batch_skbs.head;
+			pgm_queue_unlink (&window->batch_skbs, link);
+			pgm_free_skb ((struct pgm_sk_buff_t*)link);
 		}
-		else
-		{
-			break;
+		if (PGM_UNLIKELY(!is_spilled)) {
+			pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Spill log full."));
+/* a partially read OPT_BATCH packet is left uncommitted to be lost with the trail */
+			if (commit_lead == window->commit_lead)
+				return FALSE;
+			window->cumulative_losses += window->commit_lead - commit_lead;
 		}
-	} while (*pmsg <= msg_end && !_pgm_rxw_incoming_is_empty (window));
-
-	window->bytes_delivered += bytes_read;
-	window->msgs_delivered  += data_read;
-	return data_read > 0 ? bytes_read : -1;
+	}
+	return TRUE;
 }
 
-/* returns TRUE if transmission group is lost.
+/* key of a whole message, from OPT_CONFLATE or else the payload of an
+ * uncompressed APDU.
  *
- * checking is lightly limited to bounds.
+ * returns TRUE on success, FALSE if the message has no key.
  */
 
 static inline
 bool
-_pgm_rxw_is_tg_sqn_lost (
-	pgm_rxw_t* const	window,
-	const uint32_t		tg_sqn		/* transmission group sequence */
+_pgm_rxw_conflate_key (
+	const pgm_rxw_t*	    const restrict window,
+	const struct pgm_sk_buff_t* const restrict skb,
+	uint64_t*		          restrict key
 	)
 {
-/* pre-conditions */
-	pgm_assert (NULL != window);
-	pgm_assert_cmpuint (_pgm_rxw_pkt_sqn (window, tg_sqn), ==, 0);
-
-	if (pgm_rxw_is_empty (window))
-		return TRUE;
-
-	if (pgm_uint32_lt (tg_sqn, window->trail))
+	if (skb->is_batch || NULL != skb->pgm_opt_fragment)
+		return FALSE;
+	if (NULL != skb->pgm_opt_conflate) {
+		memcpy (key, skb->pgm_opt_conflate->conflate_key, sizeof (uint64_t));
 		return TRUE;
-
-	return FALSE;
+	}
+	return (NULL == skb->pgm_opt_compress &&
+		pgm_conflate_key (window->conflate_req, skb->data, skb->len, key));
 }
 
-/* reconstruct missing sequences in a transmission group using embedded parity data.
+/* supersede the undelivered sequence of key: a placeholder is lost without
+ * counting as data loss, cancelling its NAK, and data is committed unread once
+ * at the commit lead.
  */
 
 static
 void
-_pgm_rxw_reconstruct (
+_pgm_rxw_supersede (
 	pgm_rxw_t* const	window,
-	const uint32_t		tg_sqn		/* transmission group sequence */
+	const uint32_t		sequence,
+	const uint64_t		key
 	)
 {
-	struct pgm_sk_buff_t	*skb;
-	pgm_rxw_state_t		*state;
-	struct pgm_sk_buff_t   **tg_skbs;
-	pgm_gf8_t	       **tg_data, **tg_opts;
-	uint8_t			*offsets;
-	uint8_t			 rs_h = 0;
-
-/* pre-conditions */
-	pgm_assert (NULL != window);
-	pgm_assert (1 == window->is_fec_available);
-	pgm_assert_cmpuint (_pgm_rxw_pkt_sqn (window, tg_sqn), ==, 0);
+	struct pgm_sk_buff_t* skb;
+	pgm_rxw_state_t* state;
+	uint64_t skb_key;
 
-/* use stack memory */
-	tg_skbs = pgm_newa (struct pgm_sk_buff_t*, window->rs.n);
-	tg_data = pgm_newa (pgm_gf8_t*, window->rs.n);
-	tg_opts = pgm_newa (pgm_gf8_t*, window->rs.n);
-	offsets = pgm_newa (uint8_t, window->rs.k);
+	if (pgm_uint32_lt (sequence, window->commit_lead) ||
+	    pgm_uint32_gt (sequence, window->lead))
+		return;
 
-	skb = _pgm_rxw_peek (window, tg_sqn);
+	skb = _pgm_rxw_peek (window, sequence);
 	pgm_assert (NULL != skb);
+	state = (pgm_rxw_state_t*)&skb->cb;
+	if (state->is_conflated)
+		return;
 
-	const bool is_var_pktlen = skb->pgm_header->pgm_options & PGM_OPT_VAR_PKTLEN;
-	const bool is_op_encoded = skb->pgm_header->pgm_options & PGM_OPT_PRESENT;
-	const uint16_t parity_length = pgm_ntohs (skb->pgm_header->pgm_tsdu_length);
-
-	for (uint32_t i = tg_sqn, j = 0; i != (tg_sqn + window->rs.k); i++, j++)
-	{
-		skb = _pgm_rxw_peek (window, i);
-		pgm_assert (NULL != skb);
-		state = (pgm_rxw_state_t*)&skb->cb;
+	switch (state->pkt_state) {
+	case PGM_PKT_STATE_BACK_OFF:
+	case PGM_PKT_STATE_WAIT_NCF:
+	case PGM_PKT_STATE_WAIT_DATA:
+		state->is_conflated = 1;
+		_pgm_rxw_state (window, skb, PGM_PKT_STATE_LOST_DATA);
+		break;
+
+	case PGM_PKT_STATE_HAVE_DATA:
+		if (_pgm_rxw_conflate_key (window, skb, &skb_key) && key == skb_key)
+			state->is_conflated = 1;
+		break;
+
+	default: break;
+	}
+}
+
+/* conflate a message newly added to the window with the previous message of
+ * its key, linked by OPT_CONFLATE or found in the key table.  a late repair
+ * preceding the newest message of its key is itself superseded.
+ */
+
+static
+void
+_pgm_rxw_conflate (
+	pgm_rxw_t*	      const restrict window,
+	struct pgm_sk_buff_t* const restrict skb
+	)
+{
+	pgm_rxw_state_t* state = (pgm_rxw_state_t*)&skb->cb;
+	uint64_t key;
+	uint32_t sequence;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (NULL != window->conflate_req);
+	pgm_assert (NULL != skb);
+
+	if (state->is_conflated ||
+	    !_pgm_rxw_conflate_key (window, skb, &key))
+		return;
+
+	if (NULL != skb->pgm_opt_conflate) {
+		sequence = pgm_ntohl (skb->pgm_opt_conflate->conflate_prev_sqn);
+		if (sequence != skb->sequence)
+			_pgm_rxw_supersede (window, sequence, key);
+	}
+
+	if (PGM_UNLIKELY(NULL == window->conflate))
+		window->conflate = pgm_conflate_new ();
+	if (pgm_conflate_lookup (window->conflate, key, &sequence)) {
+		if (pgm_uint32_gt (sequence, skb->sequence)) {
+			state->is_conflated = 1;
+			return;
+		}
+		if (sequence != skb->sequence)
+			_pgm_rxw_supersede (window, sequence, key);
+	}
+	pgm_conflate_insert (window->conflate, key, skb->sequence);
+}
+
+/* commit superseded messages at the commit lead unread.
+ *
+ * returns TRUE if any message was skipped.
+ */
+
+static
+bool
+_pgm_rxw_skip_conflated (
+	pgm_rxw_t* const	window
+	)
+{
+	bool is_skipped = FALSE;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+
+	while (!_pgm_rxw_incoming_is_empty (window))
+	{
+		struct pgm_sk_buff_t* skb = _pgm_rxw_peek (window, window->commit_lead);
+		pgm_assert (NULL != skb);
+		const pgm_rxw_state_t* state = (const pgm_rxw_state_t*)&skb->cb;
+		if (!state->is_conflated ||
+		    (PGM_PKT_STATE_HAVE_DATA != state->pkt_state &&
+		     PGM_PKT_STATE_LOST_DATA != state->pkt_state))
+			break;
+/* a placeholder is committed as empty data of the source */
+		if (PGM_PKT_STATE_LOST_DATA == state->pkt_state)
+			memcpy (&skb->tsi, window->tsi, sizeof (pgm_tsi_t));
+		_pgm_rxw_state (window, skb, PGM_PKT_STATE_COMMIT_DATA);
+		window->commit_lead++;
+		is_skipped = TRUE;
+	}
+	return is_skipped;
+}
+
+/* with spilling enabled the commit window does not constrain the lead, packets
+ * read by the application are released from the window and held until the next
+ * pgm_rxw_remove_commit().
+ *
+ * returns TRUE if the commit window is empty.
+ */
+
+static
+bool
+_pgm_rxw_release_commit (
+	pgm_rxw_t* const	window
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != window);
+
+	if (NULL == window->spill_req)
+		return _pgm_rxw_commit_is_empty (window);
+	while (!_pgm_rxw_commit_is_empty (window))
+	{
+		struct pgm_sk_buff_t* skb = _pgm_rxw_peek (window, window->trail);
+		pgm_assert (NULL != skb);
+		pgm_skb_get (skb);
+		_pgm_rxw_remove_trail (window);
+		pgm_queue_push_head_link (&window->batch_skbs, (pgm_list_t*)skb);
+	}
+	return TRUE;
+}
+
+/* slow consumer: drop jump_sqns unread sequences from the trail of a full window
+ * at once, extended to the start of the next whole APDU, so the application
+ * resumes on complete messages without the window recording a loss.
+ */
+
+static
+void
+_pgm_rxw_jump (
+	pgm_rxw_t* const	window
+	)
+{
+	const uint32_t first = window->trail;
+	const uint64_t cumulative_losses = window->cumulative_losses;
+	uint32_t next = first + window->jump_sqns;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (window->jump_sqns > 0);
+	pgm_assert (_pgm_rxw_commit_is_empty (window));
+
+	if (pgm_uint32_gt (next, pgm_rxw_next_lead (window)))
+		next = pgm_rxw_next_lead (window);
+	while (next != pgm_rxw_next_lead (window))
+	{
+		const struct pgm_sk_buff_t* skb = _pgm_rxw_peek (window, next);
+		const pgm_rxw_state_t* state = (const pgm_rxw_state_t*)&skb->cb;
+		if (PGM_PKT_STATE_HAVE_DATA == state->pkt_state &&
+		    (NULL == skb->pgm_opt_fragment || pgm_ntohl (skb->of_apdu_first_sqn) == skb->sequence))
+			break;
+		next++;
+	}
+
+	while (window->trail != next)
+		_pgm_rxw_remove_trail (window);
+	window->cumulative_losses = cumulative_losses;
+	window->cumulative_jumped += next - first;
+	window->apdu_tpdus = 0;
+	window->is_streaming = 0;
+	pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Receive window full, jumped unread sequences %" PRIu32 " to %" PRIu32 "."),
+		first, next - 1);
+	pgm_evtrace (PGM_EV_WINDOW_JUMP, window->tsi, first, MIN(next - first, UINT16_MAX));
+}
+
+/* remove the trailing packet of a full window, unread messages from the trail
+ * are first spilled when enabled, else jumped over when enabled.
+ *
+ * returns number of sequences lost.
+ */
+
+static
+unsigned
+_pgm_rxw_remove_full_trail (
+	pgm_rxw_t* const	window
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (!pgm_rxw_is_empty (window));
+
+	if (NULL != window->spill_req && _pgm_rxw_spill (window)) {
+		while (!_pgm_rxw_commit_is_empty (window))
+			_pgm_rxw_remove_trail (window);
+		return 0;
+	}
+	if (window->jump_sqns && _pgm_rxw_commit_is_empty (window)) {
+		_pgm_rxw_jump (window);
+		return 0;
+	}
+	return _pgm_rxw_remove_trail (window);
+}
+
+/* read contiguous APDU-grouped sequences from the incoming window, OPT_BATCH
+ * packets are read as one APDU per coalesced message.
+ *
+ * side effects:
+ *
+ * 1) increments statics for window messages and bytes read.
+ *
+ * returns count of bytes read.
+ */
+
+static inline
+ssize_t
+_pgm_rxw_incoming_read (
+	pgm_rxw_t*    const restrict window,
+	struct pgm_msgv_t** restrict pmsg,		/* message array, updated as messages appended */
+	unsigned		     pmsglen		/* number of items in pmsg */
+	)
+{
+	const struct pgm_msgv_t* msg_end;
+	struct pgm_sk_buff_t* skb;
+	ssize_t bytes_read = 0;
+	size_t  data_read  = 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (NULL != pmsg);
+	pgm_assert_cmpuint (pmsglen, >, 0);
+	pgm_assert (!_pgm_rxw_incoming_is_empty (window));
+
+	pgm_debug ("_pgm_rxw_incoming_read (window:%p pmsg:%p pmsglen:%u)",
+		 (void*)window, (void*)pmsg, pmsglen);
+
+	msg_end = *pmsg + pmsglen - 1;
+	do {
+		if (NULL != window->conflate_req &&
+		    _pgm_rxw_skip_conflated (window) &&
+		    _pgm_rxw_incoming_is_empty (window))
+			break;
+		skb = _pgm_rxw_peek (window, window->commit_lead);
+		pgm_assert (NULL != skb);
+		const pgm_rxw_state_t* state = (pgm_rxw_state_t*)&skb->cb;
+/* parity fragment options are encoded */
+		const bool is_fragment = PGM_PKT_STATE_HAVE_PARITY != state->pkt_state && skb->pgm_opt_fragment;
+/* the following skb header is needed by the next iteration */
+		if (window->commit_lead != window->lead)
+			pgm_prefetch (window->pdata[ _pgm_rxw_index (window, window->commit_lead + 1) ]);
+/* single TPDU APDU, always complete */
+		if (PGM_PKT_STATE_HAVE_DATA == state->pkt_state && !is_fragment && !skb->is_batch)
+		{
+			bytes_read += _pgm_rxw_incoming_read_apdu (window, pmsg);
+			data_read  ++;
+		}
+		else if (PGM_PKT_STATE_HAVE_DATA == state->pkt_state && skb->is_batch && !is_fragment)
+		{
+			bytes_read += _pgm_rxw_incoming_read_batch (window, pmsg, msg_end, &data_read);
+		}
+		else if (is_fragment && _pgm_rxw_is_streamed (window, skb))
+		{
+			const unsigned count = _pgm_rxw_stream_chunk (window, skb);
+			if (0 == count)
+				break;
+			bytes_read += _pgm_rxw_incoming_read_chunk (window, pmsg, count);
+			data_read  ++;
+		}
+		else if (_pgm_rxw_is_apdu_complete (window,
+					      is_fragment ? pgm_ntohl (skb->of_apdu_first_sqn) : skb->sequence))
+		{
+			bytes_read += _pgm_rxw_incoming_read_apdu (window, pmsg);
+			data_read  ++;
+		}
+		else
+		{
+			break;
+		}
+	} while (*pmsg <= msg_end && !_pgm_rxw_incoming_is_empty (window));
+
+	window->bytes_delivered += bytes_read;
+	window->msgs_delivered  += data_read;
+	return data_read > 0 ? bytes_read : -1;
+}
+
+/* returns TRUE if transmission group is lost.
+ *
+ * checking is lightly limited to bounds.
+ */
+
+static inline
+bool
+_pgm_rxw_is_tg_sqn_lost (
+	pgm_rxw_t* const	window,
+	const uint32_t		tg_sqn		/* transmission group sequence */
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert_cmpuint (_pgm_rxw_pkt_sqn (window, tg_sqn), ==, 0);
+
+	if (pgm_rxw_is_empty (window))
+		return TRUE;
+
+	if (pgm_uint32_lt (tg_sqn, window->trail))
+		return TRUE;
+
+	return FALSE;
+}
+
+/* a transmission group being reconstructed, the group packets are referenced so the
+ * window may advance before a decoder thread completes.
+ */
+
+enum {
+	PGM_RXW_FEC_QUEUED = 0,
+	PGM_RXW_FEC_DECODING,
+	PGM_RXW_FEC_DONE
+};
+
+struct pgm_rxw_fec_job_t {
+	pgm_list_t		link_;
+	pgm_rxw_t*		window;
+	uint32_t		tg_sqn;
+	int			state;
+	uint8_t			rs_h;			/* parity packets, 0 = none */
+	bool			is_var_pktlen;
+	bool			is_op_encoded;
+	uint16_t		parity_length;
+	uint16_t		max_length;
+	struct pgm_opt_fragment	null_opt_fragment;
+	struct pgm_sk_buff_t**	tg_skbs;		/* group packets, referenced */
+	struct pgm_sk_buff_t**	repair_skbs;		/* NULL for original data */
+	pgm_gf8_t**		tg_data;
+	pgm_gf8_t**		tg_opts;
+	pgm_gf8_t**		tg_pktlens;		/* appended TSDU lengths */
+	uint16_t*		lens;			/* TSDU lengths of original data */
+	uint8_t*		offsets;
+};
+
+/* FEC decoder: the receive thread queues complete transmission groups, worker threads
+ * run the Reed-Solomon decode and the receive thread inserts the reconstructed packets
+ * after the notification.  jobs of every state are held on one list, a window waits
+ * only for its jobs being decoded when destroyed or re-parameterised.
+ */
+
+#define PGM_RXW_MAX_FEC_JOBS		64
+
+struct pgm_rxw_decoder_t {
+	pgm_mutex_t		mutex;
+	pgm_cond_t		cond;			/* queued or shutdown */
+	pgm_cond_t		decoded_cond;		/* decode finished */
+	pgm_queue_t		jobs;			/* newest at head */
+	unsigned		queued;
+	unsigned		done;
+	pgm_notify_t*		notify;
+	volatile uint32_t	is_notified;
+	bool			is_shutdown;
+	unsigned		thread_count;
+#ifndef _WIN32
+	pthread_t		threads[1];
+#else
+	HANDLE			threads[1];
+#endif
+};
+
+static
+size_t
+_pgm_rxw_fec_job_size (
+	const pgm_rxw_t* const	window
+	)
+{
+	return sizeof(struct pgm_rxw_fec_job_t) +
+	       (2 * window->rs.k * sizeof(struct pgm_sk_buff_t*)) +
+	       (3 * window->rs.n * sizeof(pgm_gf8_t*)) +
+	       (window->rs.n * sizeof(uint16_t)) +
+	       window->rs.k;
+}
+
+static
+void
+_pgm_rxw_fec_job_init (
+	const pgm_rxw_t*	  const restrict window,
+	struct pgm_rxw_fec_job_t* const restrict job
+	)
+{
+	memset (job, 0, _pgm_rxw_fec_job_size (window));
+	job->tg_skbs	 = (struct pgm_sk_buff_t**)(job + 1);
+	job->repair_skbs = job->tg_skbs + window->rs.k;
+	job->tg_data	 = (pgm_gf8_t**)(job->repair_skbs + window->rs.k);
+	job->tg_opts	 = job->tg_data + window->rs.n;
+	job->tg_pktlens	 = job->tg_opts + window->rs.n;
+	job->lens	 = (uint16_t*)(job->tg_pktlens + window->rs.n);
+	job->offsets	 = (uint8_t*)(job->lens + window->rs.n);
+	job->null_opt_fragment.opt_reserved |= PGM_OP_ENCODED_NULL;
+}
+
+/* release the group references and any unused reconstructed packets.
+ */
+
+static
+void
+_pgm_rxw_fec_job_release (
+	const pgm_rxw_t*	  const restrict window,
+	struct pgm_rxw_fec_job_t* const restrict job
+	)
+{
+	for (uint_fast8_t j = 0; j < window->rs.k; j++) {
+		if (job->repair_skbs[ j ])
+			pgm_free_skb (job->repair_skbs[ j ]);
+		pgm_free_skb (job->tg_skbs[ j ]);
+	}
+}
+
+/* mark parity sequences of the group that still hold the job parity lost.
+ */
+
+static
+void
+_pgm_rxw_fec_job_lost (
+	pgm_rxw_t*		  const restrict window,
+	struct pgm_rxw_fec_job_t* const restrict job
+	)
+{
+	for (uint_fast8_t j = 0; j < window->rs.k; j++)
+	{
+		if (job->offsets[ j ] < window->rs.k ||
+		    job->tg_skbs[ j ] != _pgm_rxw_peek (window, job->tg_sqn + j))
+			continue;
+		pgm_rxw_lost (window, job->tg_sqn + j);
+	}
+}
+
+/* prepare missing sequences of a transmission group for reconstruction from embedded
+ * parity data.
+ *
+ * every sequence of the group must hold original, committed, or parity data.
+ * original data is decoded as zero padded to the parity length without touching
+ * the packet, the actual length appended for variable length groups is decoded
+ * separately from job::lens.
+ *
+ * returns FALSE if the group cannot be recovered, parity sequences are then
+ * marked lost.  job::rs_h is zero when the group holds no parity.
+ */
+
+static
+bool
+_pgm_rxw_reconstruct_prepare (
+	pgm_rxw_t*		  const restrict window,
+	const uint32_t			 tg_sqn,
+	struct pgm_rxw_fec_job_t* const restrict job
+	)
+{
+	struct pgm_sk_buff_t	*skb, *parity_skb = NULL;
+	pgm_rxw_state_t		*state;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (1 == window->is_fec_available);
+	pgm_assert_cmpuint (_pgm_rxw_pkt_sqn (window, tg_sqn), ==, 0);
+
+	job->window = window;
+	job->tg_sqn = tg_sqn;
+
+/* any parity packet defines the block length and encoding */
+	for (uint_fast8_t j = 0; j < window->rs.k && NULL == parity_skb; j++)
+	{
+		skb = _pgm_rxw_peek (window, tg_sqn + j);
+		pgm_assert (NULL != skb);
+		state = (pgm_rxw_state_t*)&skb->cb;
+		if (PGM_PKT_STATE_HAVE_PARITY == state->pkt_state)
+			parity_skb = skb;
+	}
+	if (PGM_UNLIKELY(NULL == parity_skb))
+		return TRUE;
+
+	job->is_var_pktlen = parity_skb->pgm_header->pgm_options & PGM_OPT_VAR_PKTLEN;
+	job->is_op_encoded = parity_skb->pgm_header->pgm_options & PGM_OPT_PRESENT;
+	job->parity_length = parity_skb->len;
+	job->max_length = job->is_var_pktlen ? job->parity_length - sizeof(uint16_t) : job->parity_length;
+	const uint16_t opt_total_length = sizeof(struct pgm_opt_length) +
+					  sizeof(struct pgm_opt_header) +
+					  sizeof(struct pgm_opt_fragment);
+
+/* verify the group before touching any packet */
+	for (uint_fast8_t j = 0; j < window->rs.k; j++)
+	{
+		skb = _pgm_rxw_peek (window, tg_sqn + j);
+		state = (pgm_rxw_state_t*)&skb->cb;
 		switch (state->pkt_state) {
 		case PGM_PKT_STATE_HAVE_DATA:
-			tg_skbs[ j ] = skb;
-			tg_data[ j ] = skb->data;
-			tg_opts[ j ] = (pgm_gf8_t*)skb->pgm_opt_fragment;
-			offsets[ j ] = j;
+		case PGM_PKT_STATE_COMMIT_DATA:
+			if (PGM_UNLIKELY(skb->len > job->max_length))
+				goto lost;
+			job->tg_data[ j ] = skb->data;
+			job->lens[ j ] = skb->len;
+			job->tg_pktlens[ j ] = (pgm_gf8_t*)&job->lens[ j ];
+			job->tg_opts[ j ] = skb->pgm_opt_fragment ? (pgm_gf8_t*)skb->pgm_opt_fragment : (pgm_gf8_t*)&job->null_opt_fragment;
+			job->offsets[ j ] = j;
+			break;
+
+		case PGM_PKT_STATE_HAVE_PARITY:
+			if (PGM_UNLIKELY(skb->len != job->parity_length ||
+			    (job->is_op_encoded && NULL == skb->pgm_opt_fragment)))
+				goto lost;
+			job->tg_data[ window->rs.k + job->rs_h ] = skb->data;
+			job->tg_opts[ window->rs.k + job->rs_h ] = (pgm_gf8_t*)skb->pgm_opt_fragment;
+			job->tg_pktlens[ window->rs.k + job->rs_h ] = (pgm_gf8_t*)skb->data + job->max_length;
+			job->lens[ window->rs.k + job->rs_h ] = job->max_length;
+			job->offsets[ j ] = window->rs.k + _pgm_rxw_pkt_sqn (window, pgm_ntohl (skb->pgm_data->data_sqn));
+			++job->rs_h;
+			break;
+
+		default:
+			pgm_assert_not_reached();
+			goto lost;
+		}
+	}
+
+/* allocate new skbs for reconstructed data */
+	for (uint_fast8_t j = 0; j < window->rs.k; j++)
+	{
+		skb = _pgm_rxw_peek (window, tg_sqn + j);
+		job->tg_skbs[ j ] = pgm_skb_get (skb);
+		if (job->offsets[ j ] < window->rs.k)
+			continue;
+
+		struct pgm_sk_buff_t* repair_skb = pgm_skb_pool_alloc_subsys (window->skb_pool, window->max_tpdu, PGM_MEM_SUBSYS_FEC);
+		repair_skb->tstamp	= skb->tstamp;
+		repair_skb->tsi		= skb->tsi;
+		repair_skb->sequence	= tg_sqn + j;
+		pgm_skb_reserve (repair_skb, sizeof(struct pgm_header) + sizeof(struct pgm_data));
+		repair_skb->pgm_header	= repair_skb->head;
+		repair_skb->pgm_data	= (void*)( repair_skb->pgm_header + 1 );
+		memcpy (repair_skb->pgm_header, skb->pgm_header, sizeof(struct pgm_header) + sizeof(struct pgm_data));
+		if (job->is_op_encoded) {
+			pgm_skb_reserve (repair_skb, opt_total_length);
+			repair_skb->pgm_opt_fragment = (void*)( (char*)( repair_skb->pgm_data + 1 ) +
+								sizeof(struct pgm_opt_length) +
+								sizeof(struct pgm_opt_header) );
+			memset (repair_skb->pgm_data + 1, 0, opt_total_length);
+		}
+		pgm_skb_put (repair_skb, job->parity_length);
+		job->repair_skbs[ j ] = repair_skb;
+		job->tg_data[ j ] = repair_skb->data;
+		job->tg_opts[ j ] = (pgm_gf8_t*)repair_skb->pgm_opt_fragment;
+		job->tg_pktlens[ j ] = (pgm_gf8_t*)repair_skb->data + job->max_length;
+	}
+	return TRUE;
+
+lost:
+	for (uint_fast8_t j = 0; j < window->rs.k; j++)
+	{
+		skb = _pgm_rxw_peek (window, tg_sqn + j);
+		state = (pgm_rxw_state_t*)&skb->cb;
+		if (PGM_PKT_STATE_HAVE_PARITY == state->pkt_state)
+			pgm_rxw_lost (window, tg_sqn + j);
+	}
+	return FALSE;
+}
+
+/* reconstruct payload and opt_fragment option, reads only the generator matrix and
+ * the job packets so may run without the receiver lock.
+ */
+
+static
+void
+_pgm_rxw_reconstruct_decode (
+	pgm_rs_t*		  const restrict rs,
+	struct pgm_rxw_fec_job_t* const restrict job
+	)
+{
+	pgm_rs_decode_parity_appended (rs,
+				       job->tg_data,
+				       job->is_var_pktlen ? job->lens : NULL,
+				       job->offsets,
+				       job->max_length);
+	if (job->is_var_pktlen)
+		pgm_rs_decode_parity_appended (rs,
+					       job->tg_pktlens,
+					       NULL,
+					       job->offsets,
+					       sizeof(uint16_t));
+	if (job->is_op_encoded)
+		pgm_rs_decode_parity_appended (rs,
+					       job->tg_opts,
+					       NULL,
+					       job->offsets,
+					       sizeof(struct pgm_opt_fragment));
+}
+
+/* complete decoded packets and swap them for the parity still held in the window,
+ * sequences since filled by original data or evicted are skipped.
+ *
+ * returns FALSE if the group cannot be recovered, parity sequences are then
+ * marked lost.  job references are released.
+ */
+
+static
+bool
+_pgm_rxw_reconstruct_complete (
+	pgm_rxw_t*		  const restrict window,
+	struct pgm_rxw_fec_job_t* const restrict job
+	)
+{
+	const uint16_t opt_total_length = sizeof(struct pgm_opt_length) +
+					  sizeof(struct pgm_opt_header) +
+					  sizeof(struct pgm_opt_fragment);
+
+/* validate all before replacing any parity */
+	for (uint_fast8_t j = 0; j < window->rs.k; j++)
+	{
+		struct pgm_sk_buff_t* repair_skb;
+
+		if (job->offsets[ j ] < window->rs.k)
+			continue;
+
+		repair_skb = job->repair_skbs[ j ];
+
+		if (job->is_var_pktlen)
+		{
+			const uint16_t pktlen = *(uint16_t*)( (char*)repair_skb->data + job->max_length );
+			if (pktlen > job->max_length) {
+				pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Invalid encoded variable packet length in reconstructed packet, dropping entire transmission group."));
+				_pgm_rxw_fec_job_lost (window, job);
+				_pgm_rxw_fec_job_release (window, job);
+				return FALSE;
+			}
+			repair_skb->len  = pktlen;
+			repair_skb->tail = (char*)repair_skb->data + pktlen;
+		}
+
+		repair_skb->pgm_header->pgm_options	= PGM_OPT_PRESENT;
+		repair_skb->pgm_header->pgm_checksum	= 0;
+		repair_skb->pgm_header->pgm_tsdu_length	= pgm_htons (repair_skb->len);
+		repair_skb->pgm_data->data_sqn		= pgm_htonl (repair_skb->sequence);
+		if (!job->is_op_encoded ||
+		    repair_skb->pgm_opt_fragment->opt_reserved & PGM_OP_ENCODED_NULL)
+		{
+			repair_skb->pgm_header->pgm_options = 0;
+			repair_skb->pgm_opt_fragment = NULL;
+		}
+		else
+		{
+			struct pgm_opt_length* opt_len = (void*)( repair_skb->pgm_data + 1 );
+			struct pgm_opt_header* opt_header = (void*)( opt_len + 1 );
+			opt_len->opt_type		= PGM_OPT_LENGTH;
+			opt_len->opt_length		= sizeof(struct pgm_opt_length);
+			opt_len->opt_total_length	= pgm_htons (opt_total_length);
+			opt_header->opt_type		= PGM_OPT_FRAGMENT | PGM_OPT_END;
+			opt_header->opt_length		= sizeof(struct pgm_opt_header) + sizeof(struct pgm_opt_fragment);
+/* protocol sanity check: single fragment APDU */
+			if (pgm_ntohl (repair_skb->of_apdu_len) == repair_skb->len)
+				repair_skb->pgm_opt_fragment = NULL;
+		}
+	}
+
+/* swap parity skbs with reconstructed skbs */
+	for (uint_fast8_t j = 0; j < window->rs.k; j++)
+	{
+		if (job->offsets[ j ] < window->rs.k ||
+		    job->tg_skbs[ j ] != _pgm_rxw_peek (window, job->tg_sqn + j))
+			continue;
+#ifdef PGM_DISABLE_ASSERT
+		_pgm_rxw_insert (window, job->repair_skbs[ j ]);
+#else
+		pgm_assert_cmpint (_pgm_rxw_insert (window, job->repair_skbs[ j ]), ==, PGM_RXW_INSERTED);
+#endif
+		job->repair_skbs[ j ] = NULL;
+	}
+	_pgm_rxw_fec_job_release (window, job);
+	return TRUE;
+}
+
+/* reconstruct missing sequences in a transmission group using embedded parity data.
+ *
+ * returns FALSE if the group cannot be recovered, parity sequences are then
+ * marked lost.
+ */
+
+static
+bool
+_pgm_rxw_reconstruct (
+	pgm_rxw_t* const	window,
+	const uint32_t		tg_sqn		/* transmission group sequence */
+	)
+{
+	struct pgm_rxw_fec_job_t* job;
+
+/* use stack memory */
+	job = pgm_alloca (_pgm_rxw_fec_job_size (window));
+	_pgm_rxw_fec_job_init (window, job);
+	if (!_pgm_rxw_reconstruct_prepare (window, tg_sqn, job))
+		return FALSE;
+	if (0 == job->rs_h)
+		return TRUE;
+	_pgm_rxw_reconstruct_decode (&window->rs, job);
+	return _pgm_rxw_reconstruct_complete (window, job);
+}
+
+/* queue a transmission group for a decoder thread, a group already queued is
+ * not queued again.
+ *
+ * returns TRUE if the group is queued or cannot be recovered, returns FALSE when
+ * the decoder is backlogged or the group holds no parity.
+ */
+
+static
+bool
+_pgm_rxw_reconstruct_submit (
+	pgm_rxw_t* const	window,
+	const uint32_t		tg_sqn
+	)
+{
+	pgm_rxw_decoder_t* decoder = window->decoder;
+	struct pgm_rxw_fec_job_t* job;
+
+/* pre-conditions */
+	pgm_assert (NULL != decoder);
+
+	pgm_mutex_lock (&decoder->mutex);
+	if (PGM_UNLIKELY(decoder->jobs.length >= PGM_RXW_MAX_FEC_JOBS)) {
+		pgm_mutex_unlock (&decoder->mutex);
+		return FALSE;
+	}
+	for (pgm_list_t* link = decoder->jobs.head; NULL != link; link = link->next) {
+		job = (struct pgm_rxw_fec_job_t*)link;
+		if (job->window == window && job->tg_sqn == tg_sqn) {
+			pgm_mutex_unlock (&decoder->mutex);
+			return TRUE;
+		}
+	}
+	pgm_mutex_unlock (&decoder->mutex);
+
+	job = pgm_malloc_subsys (_pgm_rxw_fec_job_size (window), PGM_MEM_CLASS_GENERAL, PGM_MEM_SUBSYS_FEC);
+	_pgm_rxw_fec_job_init (window, job);
+	if (!_pgm_rxw_reconstruct_prepare (window, tg_sqn, job)) {
+		pgm_free (job);
+		return TRUE;
+	}
+	if (0 == job->rs_h) {
+		pgm_free (job);
+		return FALSE;
+	}
+
+	pgm_mutex_lock (&decoder->mutex);
+	pgm_queue_push_head_link (&decoder->jobs, &job->link_);
+	decoder->queued++;
+	pgm_cond_signal (&decoder->cond);
+	pgm_mutex_unlock (&decoder->mutex);
+	return TRUE;
+}
+
+/* discard the decoder jobs of a window, waiting for any being decoded.
+ */
+
+static
+void
+_pgm_rxw_reconstruct_cancel (
+	pgm_rxw_t* const	window
+	)
+{
+	pgm_rxw_decoder_t* decoder = window->decoder;
+	pgm_list_t* link;
+
+/* pre-conditions */
+	pgm_assert (NULL != decoder);
+
+	pgm_mutex_lock (&decoder->mutex);
+	for (;;)
+	{
+		bool is_decoding = FALSE;
+		link = decoder->jobs.head;
+		while (NULL != link)
+		{
+			struct pgm_rxw_fec_job_t* job = (struct pgm_rxw_fec_job_t*)link;
+			link = link->next;
+			if (job->window != window)
+				continue;
+			if (PGM_RXW_FEC_DECODING == job->state) {
+				is_decoding = TRUE;
+				continue;
+			}
+			if (PGM_RXW_FEC_QUEUED == job->state)
+				decoder->queued--;
+			else
+				decoder->done--;
+			pgm_queue_unlink (&decoder->jobs, &job->link_);
+			_pgm_rxw_fec_job_release (window, job);
+			pgm_free (job);
+		}
+		if (!is_decoding)
 			break;
+#ifndef _WIN32
+		pgm_cond_wait (&decoder->decoded_cond, &decoder->mutex.pthread_mutex);
+#else
+		pgm_cond_wait (&decoder->decoded_cond, &decoder->mutex.win32_crit);
+#endif
+	}
+	pgm_mutex_unlock (&decoder->mutex);
+}
+
+/* FEC decoder thread: decode the oldest queued transmission group without the lock,
+ * the receive thread is woken once per batch of completed groups.
+ */
+
+static
+#ifndef _WIN32
+void*
+#else
+unsigned
+__stdcall
+#endif
+_pgm_rxw_decoder_routine (
+	void*			arg
+	)
+{
+	pgm_rxw_decoder_t* decoder = (pgm_rxw_decoder_t*)arg;
 
-		case PGM_PKT_STATE_HAVE_PARITY:
-			tg_skbs[ window->rs.k + rs_h ] = skb;
-			tg_data[ window->rs.k + rs_h ] = skb->data;
-			tg_opts[ window->rs.k + rs_h ] = (pgm_gf8_t*)skb->pgm_opt_fragment;
-			offsets[ j ] = window->rs.k + rs_h;
-			++rs_h;
-/* fall through and alloc new skb for reconstructed data */
-		case PGM_PKT_STATE_BACK_OFF:
-		case PGM_PKT_STATE_WAIT_NCF:
-		case PGM_PKT_STATE_WAIT_DATA:
-		case PGM_PKT_STATE_LOST_DATA:
-			skb = pgm_alloc_skb (window->max_tpdu);
-			pgm_skb_reserve (skb, sizeof(struct pgm_header) + sizeof(struct pgm_data));
-			skb->pgm_header = skb->head;
-			skb->pgm_data = (void*)( skb->pgm_header + 1 );
-			if (is_op_encoded) {
-				const uint16_t opt_total_length = sizeof(struct pgm_opt_length) +
-								 sizeof(struct pgm_opt_header) +
-								 sizeof(struct pgm_opt_fragment);
-				pgm_skb_reserve (skb, opt_total_length);
-				skb->pgm_opt_fragment = (void*)( skb->pgm_data + 1 );
-				pgm_skb_put (skb, parity_length);
-				memset (skb->pgm_opt_fragment, 0, opt_total_length + parity_length);
-			} else {
-				pgm_skb_put (skb, parity_length);
-				memset (skb->data, 0, parity_length);
-			}
-			tg_skbs[ j ] = skb;
-			tg_data[ j ] = skb->data;
-			tg_opts[ j ] = (void*)skb->pgm_opt_fragment;
+	pgm_affinity_apply (PGM_THREAD_FEC);
+
+	pgm_mutex_lock (&decoder->mutex);
+	for (;;)
+	{
+		while (!decoder->is_shutdown && 0 == decoder->queued)
+#ifndef _WIN32
+			pgm_cond_wait (&decoder->cond, &decoder->mutex.pthread_mutex);
+#else
+			pgm_cond_wait (&decoder->cond, &decoder->mutex.win32_crit);
+#endif
+		if (decoder->is_shutdown)
 			break;
+		struct pgm_rxw_fec_job_t* job = NULL;
+		for (pgm_list_t* link = decoder->jobs.tail; NULL != link; link = link->prev) {
+			job = (struct pgm_rxw_fec_job_t*)link;
+			if (PGM_RXW_FEC_QUEUED == job->state)
+				break;
+		}
+		pgm_assert (NULL != job);
+		job->state = PGM_RXW_FEC_DECODING;
+		decoder->queued--;
+		pgm_mutex_unlock (&decoder->mutex);
+
+		_pgm_rxw_reconstruct_decode (&job->window->rs, job);
+
+		pgm_mutex_lock (&decoder->mutex);
+		job->state = PGM_RXW_FEC_DONE;
+		decoder->done++;
+		pgm_cond_broadcast (&decoder->decoded_cond);
+		if (!decoder->is_notified) {
+			decoder->is_notified = 1;
+			pgm_notify_send (decoder->notify);
+		}
+	}
+	pgm_mutex_unlock (&decoder->mutex);
+	return 0;
+}
+
+/* create a pool of thread_count FEC decoder threads shared by the receive windows of
+ * a socket, notify is sent as transmission groups complete decoding.
+ *
+ * returns NULL if the threads cannot be created.
+ */
+
+PGM_GNUC_INTERNAL
+pgm_rxw_decoder_t*
+pgm_rxw_decoder_create (
+	const unsigned		     thread_count,
+	pgm_notify_t* const restrict notify
+	)
+{
+	pgm_rxw_decoder_t* decoder;
+
+/* pre-conditions */
+	pgm_assert_cmpuint (thread_count, >, 0);
+	pgm_assert (NULL != notify);
 
-		default: pgm_assert_not_reached(); break;
+	decoder = pgm_malloc0_subsys (sizeof(pgm_rxw_decoder_t) + ((thread_count - 1) * sizeof(decoder->threads[0])), PGM_MEM_CLASS_GENERAL, PGM_MEM_SUBSYS_FEC);
+	decoder->notify = notify;
+	pgm_mutex_init (&decoder->mutex);
+	pgm_cond_init (&decoder->cond);
+	pgm_cond_init (&decoder->decoded_cond);
+
+	while (decoder->thread_count < thread_count)
+	{
+#ifndef _WIN32
+		const int status = pthread_create (&decoder->threads[ decoder->thread_count ], NULL, &_pgm_rxw_decoder_routine, decoder);
+		if (0 != status)
+#else
+		decoder->threads[ decoder->thread_count ] = (HANDLE)_beginthreadex (NULL, 0, &_pgm_rxw_decoder_routine, decoder, 0, NULL);
+		if (0 == decoder->threads[ decoder->thread_count ])
+#endif
+		{
+			pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Creating FEC decoder thread failed."));
+			pgm_rxw_decoder_destroy (decoder);
+			return NULL;
 		}
+		decoder->thread_count++;
+	}
+	return decoder;
+}
+
+/* stop the decoder threads and release all jobs, windows must no longer
+ * reference the decoder.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_rxw_decoder_destroy (
+	pgm_rxw_decoder_t* const	decoder
+	)
+{
+	pgm_list_t* link;
+
+/* pre-conditions */
+	pgm_assert (NULL != decoder);
+
+	pgm_mutex_lock (&decoder->mutex);
+	decoder->is_shutdown = TRUE;
+	pgm_cond_broadcast (&decoder->cond);
+	pgm_mutex_unlock (&decoder->mutex);
+	for (unsigned i = 0; i < decoder->thread_count; i++) {
+#ifndef _WIN32
+		pthread_join (decoder->threads[ i ], NULL);
+#else
+		WaitForSingleObject (decoder->threads[ i ], INFINITE);
+		CloseHandle (decoder->threads[ i ]);
+#endif
+	}
+
+	while (NULL != (link = pgm_queue_pop_tail_link (&decoder->jobs))) {
+		struct pgm_rxw_fec_job_t* job = (struct pgm_rxw_fec_job_t*)link;
+		_pgm_rxw_fec_job_release (job->window, job);
+		pgm_free (job);
+	}
+
+	pgm_cond_free (&decoder->decoded_cond);
+	pgm_cond_free (&decoder->cond);
+	pgm_mutex_free (&decoder->mutex);
+	pgm_free (decoder);
+}
+
+/* returns TRUE if transmission groups completed decoding are awaiting
+ * pgm_rxw_decoder_acknowledge().
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_rxw_decoder_is_pending (
+	const pgm_rxw_decoder_t* const	decoder
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != decoder);
+
+	return 0 != decoder->is_notified;
+}
+
+/* clear the decoder notification.
+ *
+ * returns TRUE if transmission groups completed decoding since the last call.
+ */
 
-		if (!skb->zero_padded) {
-			memset (skb->tail, 0, parity_length - skb->len);
-			skb->zero_padded = 1;
+PGM_GNUC_INTERNAL
+bool
+pgm_rxw_decoder_acknowledge (
+	pgm_rxw_decoder_t* const	decoder
+	)
+{
+	bool is_notified = FALSE;
+
+/* pre-conditions */
+	pgm_assert (NULL != decoder);
+
+	if (!decoder->is_notified)
+		return FALSE;
+	pgm_mutex_lock (&decoder->mutex);
+	if (decoder->is_notified) {
+		decoder->is_notified = 0;
+		pgm_notify_clear (decoder->notify);
+		is_notified = TRUE;
+	}
+	pgm_mutex_unlock (&decoder->mutex);
+	return is_notified;
+}
+
+/* insert the reconstructed packets of one decoded transmission group into its window.
+ *
+ * returns the updated window, or NULL if no further groups are decoded.
+ */
+
+PGM_GNUC_INTERNAL
+pgm_rxw_t*
+pgm_rxw_decoder_complete (
+	pgm_rxw_decoder_t* const	decoder
+	)
+{
+	struct pgm_rxw_fec_job_t* job = NULL;
+	pgm_rxw_t* window;
+
+/* pre-conditions */
+	pgm_assert (NULL != decoder);
+
+	pgm_mutex_lock (&decoder->mutex);
+	if (decoder->done > 0) {
+		for (pgm_list_t* link = decoder->jobs.tail; NULL != link; link = link->prev) {
+			job = (struct pgm_rxw_fec_job_t*)link;
+			if (PGM_RXW_FEC_DONE == job->state)
+				break;
 		}
+		pgm_assert (NULL != job);
+		pgm_queue_unlink (&decoder->jobs, &job->link_);
+		decoder->done--;
+	}
+	pgm_mutex_unlock (&decoder->mutex);
+	if (NULL == job)
+		return NULL;
+
+	window = job->window;
+	_pgm_rxw_reconstruct_complete (window, job);
+	pgm_free (job);
+	return window;
+}
+
+/* reconstruct the transmission group of sequence when every sequence of the
+ * group holds data or parity.
+ *
+ * returns TRUE if the group was reconstructed.
+ */
+
+static
+bool
+_pgm_rxw_try_reconstruct (
+	pgm_rxw_t* const	window,
+	const uint32_t		sequence
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != window);
+
+	if (!window->is_fec_available)
+		return FALSE;
+
+	const uint32_t tg_sqn = _pgm_rxw_tg_sqn (window, sequence);
+	const uint32_t tg_end = tg_sqn + window->tg_size;
+	if (_pgm_rxw_is_tg_sqn_lost (window, tg_sqn) ||
+	    pgm_uint32_lt (window->lead, tg_end - 1) ||
+	    0 == window->parity_count)
+		return FALSE;
+
+/* committed sequences are original data */
+	const uint32_t first = pgm_uint32_lt (tg_sqn, window->commit_lead) ? window->commit_lead : tg_sqn;
+	if (pgm_uint32_gte (first, tg_end) ||
+	    _pgm_rxw_map_run (window, window->data_map, window->parity_map, first, tg_end - first) != tg_end - first)
+		return FALSE;
+
+/* completes asynchronously with a decoder */
+	if (NULL != window->decoder &&
+	    _pgm_rxw_reconstruct_submit (window, tg_sqn))
+		return FALSE;
+	return _pgm_rxw_reconstruct (window, tg_sqn);
+}
+
+/* returns TRUE if the slot of a sliding window coding window holds the original
+ * data, FALSE if the packet is still missing.
+ */
+
+static inline
+bool
+_pgm_rxw_sw_is_known (
+	const struct pgm_sk_buff_t* const skb
+	)
+{
+	const pgm_rxw_state_t* state = (const pgm_rxw_state_t*)&skb->cb;
+	return (PGM_PKT_STATE_HAVE_DATA == state->pkt_state ||
+		PGM_PKT_STATE_COMMIT_DATA == state->pkt_state);
+}
+
+/* complete a packet decoded from a sliding window symbol, the PGM header is taken
+ * from the repair.
+ *
+ * returns new skbuff, or NULL if the decoded length or fragment option is invalid.
+ */
+
+static
+struct pgm_sk_buff_t*
+_pgm_rxw_sw_rebuild (
+	pgm_rxw_t*		    const restrict window,
+	const struct pgm_sk_buff_t* const restrict repair_skb,
+	const uint32_t				   sequence,
+	const pgm_gf8_t*		  restrict symbol,
+	const uint16_t				   len
+	)
+{
+	struct pgm_sk_buff_t*   skb;
+	struct pgm_opt_fragment opt_fragment;
+	uint16_t		tsdu_length;
+	bool			is_fragment;
+
+	memcpy (&tsdu_length, symbol, sizeof(tsdu_length));
+	tsdu_length = pgm_ntohs (tsdu_length);
+	memcpy (&opt_fragment, symbol + sizeof(uint16_t), sizeof(opt_fragment));
 
+/* protocol sanity check: symbol length and fragment header */
+	if (PGM_UNLIKELY(tsdu_length > len - PGM_RLC_SYMBOL_HEADER))
+		return NULL;
+	is_fragment = (0 != opt_fragment.opt_frag_len);
+	if (is_fragment &&
+	    PGM_UNLIKELY(pgm_ntohl (opt_fragment.opt_frag_len) < tsdu_length ||
+			 pgm_ntohl (opt_fragment.opt_frag_len) > _pgm_rxw_max_apdu (window) ||
+			 pgm_uint32_gt (pgm_ntohl (opt_fragment.opt_sqn), sequence)))
+		return NULL;
+/* single fragment APDU */
+	if (is_fragment && pgm_ntohl (opt_fragment.opt_frag_len) == tsdu_length)
+		is_fragment = FALSE;
+
+	const uint16_t opt_total_length = sizeof(struct pgm_opt_length) +
+					  sizeof(struct pgm_opt_header) +
+					  sizeof(struct pgm_opt_fragment);
+
+	skb = pgm_skb_pool_alloc_subsys (window->skb_pool, window->max_tpdu, PGM_MEM_SUBSYS_FEC);
+	skb->tstamp	= repair_skb->tstamp;
+	skb->tsi	= repair_skb->tsi;
+	skb->sequence	= sequence;
+	pgm_skb_reserve (skb, sizeof(struct pgm_header) + sizeof(struct pgm_data));
+	skb->pgm_header	= skb->head;
+	skb->pgm_data	= (void*)( skb->pgm_header + 1 );
+	memcpy (skb->pgm_header, repair_skb->pgm_header, sizeof(struct pgm_header));
+	memcpy (skb->pgm_data, repair_skb->pgm_data, sizeof(struct pgm_data));
+	skb->pgm_header->pgm_options	 = 0;
+	skb->pgm_header->pgm_checksum	 = 0;
+	skb->pgm_header->pgm_tsdu_length = pgm_htons (tsdu_length);
+	skb->pgm_data->data_sqn		 = pgm_htonl (sequence);
+	if (is_fragment)
+	{
+		struct pgm_opt_length* opt_len = (void*)( skb->pgm_data + 1 );
+		struct pgm_opt_header* opt_header = (void*)( opt_len + 1 );
+		pgm_skb_reserve (skb, opt_total_length);
+		skb->pgm_header->pgm_options	= PGM_OPT_PRESENT;
+		opt_len->opt_type		= PGM_OPT_LENGTH;
+		opt_len->opt_length		= sizeof(struct pgm_opt_length);
+		opt_len->opt_total_length	= pgm_htons (opt_total_length);
+		opt_header->opt_type		= PGM_OPT_FRAGMENT | PGM_OPT_END;
+		opt_header->opt_length		= sizeof(struct pgm_opt_header) + sizeof(struct pgm_opt_fragment);
+		opt_header->opt_reserved	= 0;
+		skb->pgm_opt_fragment		= (void*)( opt_header + 1 );
+		memcpy (skb->pgm_opt_fragment, &opt_fragment, sizeof(opt_fragment));
 	}
+	pgm_skb_put (skb, tsdu_length);
+	memcpy (skb->data, symbol + PGM_RLC_SYMBOL_HEADER, tsdu_length);
+	return skb;
+}
 
-/* reconstruct payload */
-	pgm_rs_decode_parity_appended (&window->rs,
-				       tg_data,
-				       offsets,
-				       parity_length);
+/* release held repairs beyond use: coding windows reaching behind the trail, already
+ * committed, or without a missing packet.
+ */
 
-/* reconstruct opt_fragment option */
-	if (is_op_encoded)
-		pgm_rs_decode_parity_appended (&window->rs,
-					       tg_opts,
-					       offsets,
-					       sizeof(struct pgm_opt_fragment));
+static
+void
+_pgm_rxw_sw_prune (
+	pgm_rxw_t* const	window
+	)
+{
+	pgm_list_t* link = window->sw_repairs.head;
 
-/* swap parity skbs with reconstructed skbs */
-	for (uint_fast8_t i = 0; i < window->rs.k; i++)
+	while (link)
 	{
-		struct pgm_sk_buff_t* repair_skb;
+		struct pgm_sk_buff_t* repair_skb = (struct pgm_sk_buff_t*)link;
+		const struct pgm_rxw_repair_t* repair = (const struct pgm_rxw_repair_t*)&repair_skb->cb;
+		bool is_useful = FALSE;
+
+		link = link->next;
+		if (pgm_uint32_gte (repair->first_sqn, window->trail) &&
+		    pgm_uint32_gte (repair_skb->sequence, window->commit_lead) &&
+		    pgm_uint32_lte (repair_skb->sequence, window->lead))
+		{
+			for (uint_fast8_t i = 0; i < repair->count && !is_useful; i++)
+				is_useful = !_pgm_rxw_sw_is_known (_pgm_rxw_peek (window, repair->first_sqn + i));
+		}
+		if (!is_useful) {
+			pgm_queue_unlink (&window->sw_repairs, (pgm_list_t*)repair_skb);
+			repair_skb->link_.next = repair_skb->link_.prev = NULL;
+			pgm_free_skb (repair_skb);
+		}
+	}
+}
+
+/* solve the missing packets covered by held sliding window repairs: known packets are
+ * subtracted from each repair leaving a linear system in the missing packets, every
+ * determined packet is inserted into the window.
+ *
+ * returns count of recovered packets.
+ */
+
+static
+unsigned
+_pgm_rxw_sw_recover (
+	pgm_rxw_t* const	window
+	)
+{
+	struct pgm_sk_buff_t*	repairs[ PGM_RLC_MAX_UNKNOWNS ];
+	uint32_t		unknowns[ PGM_RLC_MAX_UNKNOWNS ];
+	uint8_t			solved[ PGM_RLC_MAX_UNKNOWNS ];
+	pgm_gf8_t	       *rows[ PGM_RLC_MAX_UNKNOWNS ];
+	pgm_gf8_t	       *matrix, *buffer;
+	uint_fast8_t		n_rows = 0, n_cols = 0;
+	uint16_t		len = 0;
+	unsigned		recovered = 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (window->is_sw_available);
+
+	_pgm_rxw_sw_prune (window);
+
+/* select repairs while the union of missing packets remains solvable */
+	for (pgm_list_t* link = window->sw_repairs.head; link && n_rows < PGM_RLC_MAX_UNKNOWNS; link = link->next)
+	{
+		struct pgm_sk_buff_t* repair_skb = (struct pgm_sk_buff_t*)link;
+		const struct pgm_rxw_repair_t* repair = (const struct pgm_rxw_repair_t*)&repair_skb->cb;
+		const uint_fast8_t saved_n_cols = n_cols;
+		bool is_usable = TRUE;
 
-		if (offsets[i] < window->rs.k)
+		for (uint_fast8_t i = 0; i < repair->count && is_usable; i++)
+		{
+			const uint32_t sequence = repair->first_sqn + i;
+			const struct pgm_sk_buff_t* skb = _pgm_rxw_peek (window, sequence);
+			if (_pgm_rxw_sw_is_known (skb)) {
+/* protocol sanity check: repair shorter than a covered packet */
+				is_usable = (PGM_RLC_SYMBOL_HEADER + skb->len <= repair_skb->len);
+				continue;
+			}
+			uint_fast8_t j = 0;
+			while (j < n_cols && unknowns[ j ] != sequence)
+				j++;
+			if (j < n_cols)
+				continue;
+			if (PGM_RLC_MAX_UNKNOWNS == n_cols)
+				is_usable = FALSE;
+			else
+				unknowns[ n_cols++ ] = sequence;
+		}
+		if (!is_usable) {
+			n_cols = saved_n_cols;
 			continue;
+		}
+		repairs[ n_rows++ ] = repair_skb;
+		if (repair_skb->len > len)
+			len = repair_skb->len;
+	}
+	if (0 == n_rows || 0 == n_cols)
+		return 0;
 
-		repair_skb = tg_skbs[i];
+	matrix = pgm_new0_subsys (pgm_gf8_t, (n_rows * n_cols) + (n_rows * len), PGM_MEM_SUBSYS_FEC);
+	buffer = matrix + (n_rows * n_cols);
 
-		if (is_var_pktlen)
+/* coefficients of missing packets, repair symbols less the known packets */
+	for (uint_fast8_t i = 0; i < n_rows; i++)
+	{
+		const struct pgm_sk_buff_t* repair_skb = repairs[ i ];
+		const struct pgm_rxw_repair_t* repair = (const struct pgm_rxw_repair_t*)&repair_skb->cb;
+
+		rows[ i ] = buffer + (i * len);
+		memcpy (rows[ i ], repair_skb->data, repair_skb->len);
+		for (uint_fast8_t k = 0; k < repair->count; k++)
 		{
-			const uint16_t pktlen = *(uint16_t*)( (char*)repair_skb->tail - sizeof(uint16_t));
-			if (pktlen > parity_length) {
-				pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Invalid encoded variable packet length in reconstructed packet, dropping entire transmission group."));
-				pgm_free_skb (repair_skb);
-				for (uint_fast8_t j = i; j < window->rs.k; j++)
-				{
-					if (offsets[j] < window->rs.k)
-						continue;
-					pgm_rxw_lost (window, tg_skbs[offsets[j]]->sequence);
-				}
-				break;
+			const uint32_t sequence = repair->first_sqn + k;
+			const struct pgm_sk_buff_t* skb = _pgm_rxw_peek (window, sequence);
+			const pgm_gf8_t c = pgm_rlc_coefficient (repair->key, sequence);
+			if (_pgm_rxw_sw_is_known (skb)) {
+				pgm_rlc_encode (rows[ i ], c, skb);
+				continue;
 			}
-			const uint16_t padding = parity_length - pktlen;
-			repair_skb->len -= padding;
-			repair_skb->tail = (char*)repair_skb->tail - padding;
+			for (uint_fast8_t j = 0; j < n_cols; j++)
+				if (unknowns[ j ] == sequence) {
+					matrix[ (i * n_cols) + j ] = c;
+					break;
+				}
 		}
+	}
 
-#ifdef PGM_DISABLE_ASSERT
-		_pgm_rxw_insert (window, repair_skb);
-#else
-		pgm_assert_cmpint (_pgm_rxw_insert (window, repair_skb), ==, PGM_RXW_INSERTED);
-#endif
+	pgm_rlc_solve (matrix, rows, (uint8_t)n_rows, (uint8_t)n_cols, len, solved);
+
+/* any repair header suffices for the reconstructed packets */
+	for (uint_fast8_t j = 0; j < n_cols; j++)
+	{
+		struct pgm_sk_buff_t* skb;
+
+		if (PGM_RLC_UNSOLVED == solved[ j ])
+			continue;
+		skb = _pgm_rxw_sw_rebuild (window, repairs[ 0 ], unknowns[ j ], rows[ solved[ j ] ], len);
+		if (PGM_UNLIKELY(NULL == skb)) {
+			pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Invalid sliding window repair of #%" PRIu32 ", discarded."), unknowns[ j ]);
+			continue;
+		}
+		if (PGM_RXW_INSERTED != _pgm_rxw_insert (window, skb)) {
+			pgm_free_skb (skb);
+			continue;
+		}
+		recovered++;
+	}
+	pgm_free (matrix);
+
+	if (recovered) {
+		window->has_event = 1;
+		_pgm_rxw_sw_prune (window);
+	}
+	return recovered;
+}
+
+/* returns TRUE if the fragment at the commit lead belongs to an APDU delivered in
+ * chunks, one that cannot be held by a single message vector.  the remainder of
+ * such an APDU is delivered after a lost fragment, including the first.
+ */
+
+static inline
+bool
+_pgm_rxw_is_streamed (
+	const pgm_rxw_t*	    const restrict window,
+	const struct pgm_sk_buff_t* const restrict skb
+	)
+{
+	const uint32_t first_sequence = pgm_ntohl (skb->of_apdu_first_sqn);
+	if (window->is_streaming && first_sequence == window->stream_first)
+		return TRUE;
+	const size_t apdu_size = pgm_ntohl (skb->of_apdu_len);
+	if (0 == window->max_apdu || apdu_size > window->max_apdu || NULL != skb->pgm_opt_compress)
+		return FALSE;
+/* fragment length of the APDU, the last fragment may be shorter */
+	const size_t fragment_len = (first_sequence == skb->sequence) ? skb->len :
+					pgm_ntohl (skb->of_frag_offset) / (skb->sequence - first_sequence);
+	return apdu_size > PGM_MAX_APDU || apdu_size > (size_t)PGM_MAX_FRAGMENTS * fragment_len;
+}
+
+/* verify the next chunk of a streamed APDU starting at the commit lead, complete
+ * with PGM_MAX_FRAGMENTS fragments or the end of the APDU.
+ *
+ * returns count of fragments in the chunk, or 0 if the chunk is incomplete.
+ */
+
+static
+unsigned
+_pgm_rxw_stream_chunk (
+	pgm_rxw_t*	      const restrict window,
+	struct pgm_sk_buff_t* const restrict skb
+	)
+{
+	const uint32_t	first_sequence = pgm_ntohl (skb->of_apdu_first_sqn);
+	const uint32_t	apdu_size = pgm_ntohl (skb->of_apdu_len);
+	uint32_t	sequence = skb->sequence;
+	unsigned	count = 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (sequence == window->commit_lead);
+
+	if (!window->is_streaming || first_sequence != window->stream_first) {
+		window->stream_first = first_sequence;
+		window->stream_next  = sequence;
+		window->is_streaming = 1;
+	}
+
+	while (count < PGM_MAX_FRAGMENTS)
+	{
+		struct pgm_sk_buff_t* fragment = _pgm_rxw_peek (window, sequence);
+		if (NULL == fragment)
+			return 0;
+
+/* recover the transmission group of the first gap and test again */
+		if (PGM_PKT_STATE_HAVE_DATA != ((pgm_rxw_state_t*)&fragment->cb)->pkt_state) {
+			if (_pgm_rxw_try_reconstruct (window, sequence))
+				continue;
+			return 0;
+		}
+
+/* protocol sanity check: matching APDU and fragment within it */
+		if (PGM_UNLIKELY(NULL == fragment->pgm_opt_fragment ||
+				 pgm_ntohl (fragment->of_apdu_first_sqn) != first_sequence ||
+				 pgm_ntohl (fragment->of_apdu_len) != apdu_size ||
+				 pgm_ntohl (fragment->of_frag_offset) > apdu_size - fragment->len))
+		{
+			pgm_rxw_lost (window, sequence);
+			return 0;
+		}
+
+		count++;
+		sequence++;
+		if (pgm_ntohl (fragment->of_frag_offset) + fragment->len == apdu_size)
+			break;
 	}
+	return count;
+}
+
+/* record the verified prefix of the APDU at the commit lead.
+ */
+
+static inline
+void
+_pgm_rxw_apdu_save (
+	pgm_rxw_t* const	window,
+	const uint32_t		first_sequence,
+	const uint32_t		next_sequence,
+	const unsigned		tpdus,
+	const size_t		size
+	)
+{
+	window->apdu_first	 = first_sequence;
+	window->apdu_next	 = next_sequence;
+	window->apdu_commit_lead = window->commit_lead;
+	window->apdu_tpdus	 = tpdus;
+	window->apdu_size	 = size;
 }
 
 /* check every TPDU in an APDU and verify that the data has arrived
  * and is available to commit to the application.
  *
+ * verification stops at the first missing fragment and resumes there on the
+ * next call, each fragment is inspected once however the APDU arrives.  The
+ * fragments before the stop stay in the window until the commit lead moves.
+ *
  * if APDU sits in a transmission group that can be reconstructed use parity
  * data then the entire group will be decoded and any missing data packets
  * replaced by the recovery calculation.
@@ -1562,9 +3624,9 @@ _pgm_rxw_is_apdu_complete (
 	)
 {
 	struct pgm_sk_buff_t	*skb;
+	uint32_t		 sequence = first_sequence;
 	unsigned		 contiguous_tpdus = 0;
 	size_t			 contiguous_size = 0;
-	bool			 check_parity = FALSE;
 
 /* pre-conditions */
 	pgm_assert (NULL != window);
@@ -1577,8 +3639,16 @@ _pgm_rxw_is_apdu_complete (
 		return FALSE;
 	}
 
+/* parity in place of the first fragment, the header is only available after
+ * recovery.
+ */
+	if (PGM_PKT_STATE_HAVE_DATA != ((pgm_rxw_state_t*)&skb->cb)->pkt_state) {
+		if (_pgm_rxw_try_reconstruct (window, first_sequence))
+			return _pgm_rxw_is_apdu_complete (window, first_sequence);
+		return FALSE;
+	}
+
 	const size_t apdu_size = skb->pgm_opt_fragment ? pgm_ntohl (skb->of_apdu_len) : skb->len;
-	const uint32_t  tg_sqn = _pgm_rxw_tg_sqn (window, first_sequence);
 
 	pgm_assert_cmpuint (apdu_size, >=, skb->len);
 
@@ -1588,80 +3658,120 @@ _pgm_rxw_is_apdu_complete (
 		return FALSE;
 	}
 
-	for (uint32_t sequence = first_sequence;
+/* resume after the fragments verified by the last call */
+	if (window->apdu_tpdus > 0 &&
+	    window->apdu_first == first_sequence &&
+	    window->apdu_commit_lead == window->commit_lead)
+	{
+		sequence	 = window->apdu_next;
+		contiguous_tpdus = window->apdu_tpdus;
+		contiguous_size	 = window->apdu_size;
+		skb = _pgm_rxw_peek (window, sequence);
+	}
+/* without parity the APDU needs at least apdu_size / max_tpdu contiguous
+ * data packets, skip the fragment walk while the run of received data is
+ * too short.
+ */
+	else if (!window->is_fec_available && apdu_size > window->max_tpdu)
+	{
+		const uint32_t have = _pgm_rxw_map_run (window, window->data_map, NULL, first_sequence,
+							( 1 + window->lead ) - first_sequence);
+		if ((size_t)have * window->max_tpdu < apdu_size)
+			return FALSE;
+	}
+
+	for (;
 	     skb;
 	     skb = _pgm_rxw_peek (window, ++sequence))
 	{
-		pgm_rxw_state_t* state = (pgm_rxw_state_t*)&skb->cb;
+		const pgm_rxw_state_t* state = (pgm_rxw_state_t*)&skb->cb;
 
-		if (!check_parity &&
-		    PGM_PKT_STATE_HAVE_DATA != state->pkt_state)
+/* recover the transmission group of the first gap and test again */
+		if (PGM_PKT_STATE_HAVE_DATA != state->pkt_state)
 		{
-			if (window->is_fec_available &&
-			    !_pgm_rxw_is_tg_sqn_lost (window, tg_sqn) )
-			{
-				check_parity = TRUE;
-/* pre-seed committed sequence count */
-				if (pgm_uint32_lte (tg_sqn, window->commit_lead))
-					contiguous_tpdus += window->commit_lead - tg_sqn;
-			}
-			else
-			{
-				return FALSE;
-			}
-		}
-
-		if (check_parity)
-		{
-			if (PGM_PKT_STATE_HAVE_DATA == state->pkt_state ||
-			    PGM_PKT_STATE_HAVE_PARITY == state->pkt_state)
-				++contiguous_tpdus;
-
-/* have sufficient been received for reconstruction */
-			if (contiguous_tpdus >= window->tg_size) {
-				_pgm_rxw_reconstruct (window, tg_sqn);
+			_pgm_rxw_apdu_save (window, first_sequence, sequence, contiguous_tpdus, contiguous_size);
+			if (_pgm_rxw_try_reconstruct (window, sequence))
 				return _pgm_rxw_is_apdu_complete (window, first_sequence);
-			}
+			return FALSE;
 		}
-		else
-		{
+
 /* single packet APDU, already complete */
-			if (PGM_PKT_STATE_HAVE_DATA == state->pkt_state &&
-			    !skb->pgm_opt_fragment)
-				return TRUE;
+		if (!skb->pgm_opt_fragment)
+			return TRUE;
 
 /* protocol sanity check: matching first sequence reference */
-			if (PGM_UNLIKELY(pgm_ntohl (skb->of_apdu_first_sqn) != first_sequence)) {
-				pgm_rxw_lost (window, first_sequence);
-				return FALSE;
-			}
+		if (PGM_UNLIKELY(pgm_ntohl (skb->of_apdu_first_sqn) != first_sequence)) {
+			pgm_rxw_lost (window, first_sequence);
+			return FALSE;
+		}
 
 /* protocol sanity check: matching apdu length */
-			if (PGM_UNLIKELY(pgm_ntohl (skb->of_apdu_len) != apdu_size)) {
-				pgm_rxw_lost (window, first_sequence);
-				return FALSE;
-			}
+		if (PGM_UNLIKELY(pgm_ntohl (skb->of_apdu_len) != apdu_size)) {
+			pgm_rxw_lost (window, first_sequence);
+			return FALSE;
+		}
 
 /* protocol sanity check: maximum number of fragments per apdu */
-			if (PGM_UNLIKELY(++contiguous_tpdus > PGM_MAX_FRAGMENTS)) {
-				pgm_rxw_lost (window, first_sequence);
-				return FALSE;
-			}
+		if (PGM_UNLIKELY(++contiguous_tpdus > PGM_MAX_FRAGMENTS)) {
+			pgm_rxw_lost (window, first_sequence);
+			return FALSE;
+		}
 
-			contiguous_size += skb->len;
-			if (apdu_size == contiguous_size)
-				return TRUE;
-			else if (PGM_UNLIKELY(apdu_size < contiguous_size)) {
-				pgm_rxw_lost (window, first_sequence);
-				return FALSE;
-			}
+		contiguous_size += skb->len;
+		if (apdu_size == contiguous_size)
+			return TRUE;
+		else if (PGM_UNLIKELY(apdu_size < contiguous_size)) {
+			pgm_rxw_lost (window, first_sequence);
+			return FALSE;
 		}
 	}
 
 /* pending */
+	_pgm_rxw_apdu_save (window, first_sequence, sequence, contiguous_tpdus, contiguous_size);
 	return FALSE;
 }
 
+#ifdef USE_HISTOGRAMS
+/* latency breakdown of a complete APDU at the commit lead, measured against
+ * the TPDU that completed it:
+ *
+ * read lag	 waiting in the socket for the application, kernel or NIC time
+ *		 stamp to library receive, zero without PGM_TIMESTAMPING.
+ * recovery wait longest repair of any TPDU, only when one was repaired.
+ * window wait	 library receive to delivery, i.e. blocked behind earlier
+ *		 sequences or a full message vector.
+ */
+
+static
+void
+_pgm_rxw_sample_apdu (
+	pgm_rxw_t* const	window,
+	const size_t		apdu_len
+	)
+{
+	const struct pgm_sk_buff_t* last_skb = NULL;
+	uint32_t recovery_time = 0;
+	size_t contiguous_len = 0;
+
+	for (uint32_t sequence = window->commit_lead; apdu_len > contiguous_len; sequence++)
+	{
+		const struct pgm_sk_buff_t* skb = _pgm_rxw_peek (window, sequence);
+		const pgm_rxw_state_t* state = (const pgm_rxw_state_t*)&skb->cb;
+		if (NULL == last_skb || skb->tstamp > last_skb->tstamp)
+			last_skb = skb;
+		if (state->fill_time > recovery_time)
+			recovery_time = state->fill_time;
+		contiguous_len += skb->len;
+	}
+
+	const pgm_time_t now = pgm_time_update_now();
+	PGM_HISTOGRAM_TIMES("Rx.ApduReadLag", last_skb->tstamp - last_skb->wire_tstamp);
+	if (recovery_time)
+		PGM_HISTOGRAM_TIMES("Rx.ApduRecoveryWait", recovery_time);
+	PGM_HISTOGRAM_TIMES("Rx.ApduWindowWait", now > last_skb->tstamp ? now - last_skb->tstamp : 0);
+}
+#endif /* USE_HISTOGRAMS */
+
 /* read one APDU consisting of one or more TPDUs.  target array is guaranteed
  * to be big enough to store complete APDU.
  */
@@ -1690,6 +3800,11 @@ _pgm_rxw_incoming_read_apdu (
 	const size_t apdu_len = skb->pgm_opt_fragment ? pgm_ntohl (skb->of_apdu_len) : skb->len;
 	pgm_assert_cmpuint (apdu_len, >=, skb->len);
 
+#ifdef USE_HISTOGRAMS
+	if (PGM_HISTOGRAM_IS_SAMPLED(skb->sequence))
+		_pgm_rxw_sample_apdu (window, apdu_len);
+#endif
+
 	do {
 		_pgm_rxw_state (window, skb, PGM_PKT_STATE_COMMIT_DATA);
 		(*pmsg)->msgv_skb[ count++ ] = skb;
@@ -1700,15 +3815,337 @@ _pgm_rxw_incoming_read_apdu (
 		skb = _pgm_rxw_peek (window, window->commit_lead);
 	} while (apdu_len > contiguous_len);
 
+	if (NULL != window->placed && count > 1 &&
+	    _pgm_rxw_read_placed (window, pmsg, count, contiguous_len))
+		return contiguous_len;
+
+	if (NULL != (*pmsg)->msgv_skb[0]->pgm_opt_compress)
+		return _pgm_rxw_decompress_apdu (window, pmsg, count);
+
+	(*pmsg)->msgv_len = count;
+	(*pmsg)++;
+
+/* post-conditions */
+	pgm_assert (!_pgm_rxw_commit_is_empty (window));
+
+	return contiguous_len;
+}
+
+/* replace the count compressed TPDUs of an APDU at pmsg with one skbuff of the
+ * decompressed APDU, held by the window until the next pgm_rxw_remove_commit().
+ * an APDU that cannot be decompressed is committed and discarded.
+ *
+ * returns count of bytes of the decompressed APDU, or 0 if discarded.
+ */
+
+static
+ssize_t
+_pgm_rxw_decompress_apdu (
+	pgm_rxw_t*    const restrict window,
+	struct pgm_msgv_t** restrict pmsg,		/* message array, updated as messages appended */
+	const unsigned		     count
+	)
+{
+	const struct pgm_sk_buff_t* first = (*pmsg)->msgv_skb[0];
+	const struct pgm_opt_compress* opt_compress = first->pgm_opt_compress;
+	const size_t apdu_len = pgm_ntohl (opt_compress->compress_apdu_len);
+	struct pgm_iovec src[ PGM_MAX_FRAGMENTS ];
+	struct pgm_sk_buff_t* skb;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert_cmpuint (count, >, 0);
+	pgm_assert_cmpuint (count, <=, PGM_MAX_FRAGMENTS);
+
+	if (PGM_UNLIKELY(NULL == window->decompressor || apdu_len > PGM_MAX_APDU)) {
+		pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Discarding compressed APDU, decompression not enabled or APDU too large."));
+		return 0;
+	}
+	for (unsigned i = 0; i < count; i++) {
+		src[i].iov_base = (*pmsg)->msgv_skb[i]->data;
+		src[i].iov_len  = (*pmsg)->msgv_skb[i]->len;
+	}
+	skb = pgm_alloc_skb ((uint16_t)apdu_len);
+	pgm_skb_put (skb, (uint16_t)apdu_len);
+	if (PGM_UNLIKELY(!pgm_decompress (window->decompressor,
+					  opt_compress->compress_type,
+					  pgm_ntohs (opt_compress->compress_dict_id),
+					  src, count,
+					  skb->data, apdu_len)))
+	{
+		pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Discarding compressed APDU of unavailable type %u, dictionary %u or corrupt."),
+			   (unsigned)opt_compress->compress_type, (unsigned)pgm_ntohs (opt_compress->compress_dict_id));
+		pgm_free_skb (skb);
+		return 0;
+	}
+	skb->sock		= first->sock;
+	skb->tstamp		= first->tstamp;
+	skb->wire_tstamp	= first->wire_tstamp;
+	skb->tsi		= first->tsi;
+	skb->sequence		= first->sequence;
+	pgm_queue_push_head_link (&window->batch_skbs, (pgm_list_t*)skb);
+
+	(*pmsg)->msgv_skb[0] = skb;
+	(*pmsg)->msgv_len = 1;
+	(*pmsg)++;
+	return apdu_len;
+}
+
+/* fragments of an APDU copied into its placement buffer, by index from the
+ * first sequence.
+ */
+
+struct pgm_rxw_placed_t {
+	uint32_t	fragments;
+};
+
+/* copy a fragment to its offset in the placement buffer of its APDU whilst the
+ * payload is cache hot, verifying any deferred checksum with the copy.  a
+ * fragment not placed here is copied on delivery.
+ */
+
+static
+void
+_pgm_rxw_place (
+	pgm_rxw_t*	      const restrict window,
+	struct pgm_sk_buff_t* const restrict skb
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (NULL != window->placement_pool);
+	pgm_assert (NULL != skb->pgm_opt_fragment);
+
+	const uint32_t apdu_len	   = pgm_ntohl (skb->of_apdu_len);
+	const uint32_t first_sqn   = pgm_ntohl (skb->of_apdu_first_sqn);
+	const uint32_t frag_offset = pgm_ntohl (skb->of_frag_offset);
+	const uint32_t frag_index  = skb->sequence - first_sqn;
+
+/* beyond the placement buffer, coalesced or compressed, or the first fragment
+ * already lost with the trail.
+ */
+	if (apdu_len > window->placement_pool->size ||
+	    frag_index >= PGM_MAX_FRAGMENTS ||
+	    frag_offset > apdu_len - skb->len ||
+	    skb->is_batch || NULL != skb->pgm_opt_compress ||
+	    pgm_uint32_lt (first_sqn, window->trail))
+	{
+		return;
+	}
+
+	if (PGM_UNLIKELY(NULL == window->placed))
+		window->placed = pgm_new0 (struct pgm_sk_buff_t*, window->max_alloc);
+	struct pgm_sk_buff_t** placed = &window->placed[ first_sqn % window->max_alloc ];
+	if (NULL == *placed) {
+		*placed = pgm_skb_pool_alloc (window->placement_pool, (uint16_t)apdu_len);
+		pgm_skb_put (*placed, (uint16_t)apdu_len);
+		(*placed)->sock		= skb->sock;
+		(*placed)->tsi		= skb->tsi;
+		(*placed)->sequence	= first_sqn;
+	}
+	struct pgm_sk_buff_t* apdu = *placed;
+	struct pgm_rxw_placed_t* fragments = (struct pgm_rxw_placed_t*)&apdu->cb;
+	if (PGM_UNLIKELY(apdu->len != apdu_len))
+		return;
+	char* dst = (char*)apdu->data + frag_offset;
+	if (skb->csum_deferred) {
+		if (PGM_UNLIKELY(!pgm_verify_checksum_copy (skb, dst, skb->len)))
+			return;
+		skb->csum_deferred = 0;
+	} else
+		memcpy (dst, skb->data, skb->len);
+	fragments->fragments |= 1u << frag_index;
+}
+
+/* replace the count fragments of an APDU at pmsg with its placement buffer,
+ * held by the window until the next pgm_rxw_remove_commit(), copying fragments
+ * not placed on arrival such as FEC recoveries.
+ *
+ * returns TRUE on success, FALSE to deliver the fragments as is, as when a
+ * deferred checksum fails verification.
+ */
+
+static
+bool
+_pgm_rxw_read_placed (
+	pgm_rxw_t*    const restrict window,
+	struct pgm_msgv_t** restrict pmsg,		/* message array, updated as messages appended */
+	const unsigned		     count,
+	const size_t		     apdu_len
+	)
+{
+	const struct pgm_sk_buff_t* first = (*pmsg)->msgv_skb[0];
+	struct pgm_sk_buff_t** placed = &window->placed[ first->sequence % window->max_alloc ];
+	struct pgm_sk_buff_t* apdu = *placed;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert_cmpuint (count, >, 1);
+	pgm_assert_cmpuint (count, <=, PGM_MAX_FRAGMENTS);
+
+	if (NULL == apdu)
+		return FALSE;
+	*placed = NULL;
+	if (PGM_UNLIKELY(apdu->sequence != first->sequence || apdu->len != apdu_len)) {
+		pgm_free_skb (apdu);
+		return FALSE;
+	}
+
+	const struct pgm_rxw_placed_t* fragments = (const struct pgm_rxw_placed_t*)&apdu->cb;
+	size_t offset = 0;
+	for (unsigned i = 0; i < count; i++) {
+		const struct pgm_sk_buff_t* skb = (*pmsg)->msgv_skb[i];
+		if (!(fragments->fragments & (1u << i))) {
+			char* dst = (char*)apdu->data + offset;
+			if (skb->csum_deferred) {
+				if (PGM_UNLIKELY(!pgm_verify_checksum_copy (skb, dst, skb->len))) {
+					pgm_free_skb (apdu);
+					return FALSE;
+				}
+			} else
+				memcpy (dst, skb->data, skb->len);
+		}
+		offset += skb->len;
+	}
+	apdu->tstamp		= first->tstamp;
+	apdu->wire_tstamp	= first->wire_tstamp;
+	pgm_queue_push_head_link (&window->batch_skbs, (pgm_list_t*)apdu);
+
+	(*pmsg)->msgv_skb[0] = apdu;
+	(*pmsg)->msgv_len = 1;
+	(*pmsg)++;
+	return TRUE;
+}
+
+/* read the next chunk of a streamed APDU, count fragments from the commit lead.
+ */
+
+static inline
+ssize_t
+_pgm_rxw_incoming_read_chunk (
+	pgm_rxw_t*    const restrict window,
+	struct pgm_msgv_t** restrict pmsg,		/* message array, updated as messages appended */
+	const unsigned		     count
+	)
+{
+	struct pgm_sk_buff_t *skb = NULL;
+	size_t		      contiguous_len = 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (NULL != pmsg);
+	pgm_assert (window->is_streaming);
+	pgm_assert_cmpuint (count, >, 0);
+	pgm_assert_cmpuint (count, <=, PGM_MAX_FRAGMENTS);
+
+	pgm_debug ("_pgm_rxw_incoming_read_chunk (window:%p pmsg:%p count:%u)",
+		(const void*)window, (const void*)pmsg, count);
+
+	for (unsigned i = 0; i < count; i++) {
+		skb = _pgm_rxw_peek (window, window->commit_lead);
+		pgm_assert (NULL != skb);
+		_pgm_rxw_state (window, skb, PGM_PKT_STATE_COMMIT_DATA);
+		(*pmsg)->msgv_skb[ i ] = skb;
+		contiguous_len += skb->len;
+		window->commit_lead++;
+	}
+
 	(*pmsg)->msgv_len = count;
 	(*pmsg)++;
 
+	window->stream_next = window->commit_lead;
+	if (pgm_ntohl (skb->of_frag_offset) + skb->len == pgm_ntohl (skb->of_apdu_len))
+		window->is_streaming = 0;
+
 /* post-conditions */
 	pgm_assert (!_pgm_rxw_commit_is_empty (window));
 
 	return contiguous_len;
 }
 
+/* read the messages of an OPT_BATCH packet at the commit lead, each copied into
+ * its own skbuff and appended as a single skbuff APDU.  skbuffs are held by the
+ * window until the next pgm_rxw_remove_commit().  when pmsg fills first the read
+ * offset is saved and the packet is committed once the last message is read.  a
+ * length prefix overrunning the packet discards the remainder.
+ *
+ * returns count of bytes read, count of messages is added to msgs_read.
+ */
+
+static inline
+ssize_t
+_pgm_rxw_incoming_read_batch (
+	pgm_rxw_t*	   const restrict window,
+	struct pgm_msgv_t**	 restrict pmsg,		/* message array, updated as messages appended */
+	const struct pgm_msgv_t* const restrict msg_end,	/* last item in message array */
+	size_t*			 restrict msgs_read
+	)
+{
+	struct pgm_sk_buff_t *skb;
+	ssize_t		      bytes_read = 0;
+	uint16_t	      offset;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (NULL != pmsg);
+	pgm_assert (NULL != msg_end);
+	pgm_assert (NULL != msgs_read);
+
+	pgm_debug ("_pgm_rxw_incoming_read_batch (window:%p pmsg:%p msg-end:%p msgs-read:%p)",
+		(const void*)window, (const void*)pmsg, (const void*)msg_end, (const void*)msgs_read);
+
+	skb = _pgm_rxw_peek (window, window->commit_lead);
+	pgm_assert (NULL != skb);
+	pgm_assert (skb->is_batch);
+
+	offset = (window->batch_offset && skb->sequence == window->batch_sqn) ? window->batch_offset : 0;
+	while (offset < skb->len && *pmsg <= msg_end)
+	{
+		struct pgm_sk_buff_t* msg_skb;
+		uint16_t msg_len;
+
+		if (PGM_UNLIKELY(offset + sizeof(uint16_t) > skb->len)) {
+			offset = skb->len;
+			break;
+		}
+		memcpy (&msg_len, (const char*)skb->data + offset, sizeof(msg_len));
+		msg_len = pgm_ntohs (msg_len);
+		offset += sizeof(uint16_t);
+		if (PGM_UNLIKELY(msg_len > skb->len - offset)) {
+			pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Discarding OPT_BATCH remainder with invalid message length."));
+			offset = skb->len;
+			break;
+		}
+
+		msg_skb = pgm_alloc_skb (msg_len);
+		msg_skb->sock		= skb->sock;
+		msg_skb->tstamp		= skb->tstamp;
+		msg_skb->wire_tstamp	= skb->wire_tstamp;
+		msg_skb->tsi		= skb->tsi;
+		msg_skb->sequence	= skb->sequence;
+		pgm_skb_put (msg_skb, msg_len);
+		memcpy (msg_skb->data, (const char*)skb->data + offset, msg_len);
+		offset += msg_len;
+		pgm_queue_push_head_link (&window->batch_skbs, (pgm_list_t*)msg_skb);
+
+		(*pmsg)->msgv_skb[0] = msg_skb;
+		(*pmsg)->msgv_len = 1;
+		(*pmsg)++;
+		bytes_read += msg_len;
+		(*msgs_read)++;
+	}
+
+	if (offset < skb->len) {
+		window->batch_sqn    = skb->sequence;
+		window->batch_offset = offset;
+	} else {
+		_pgm_rxw_state (window, skb, PGM_PKT_STATE_COMMIT_DATA);
+		window->commit_lead++;
+		window->batch_offset = 0;
+	}
+	return bytes_read;
+}
+
 /* returns transmission group sequence (TG_SQN) from sequence (SQN).
  */
 
@@ -1814,11 +4251,13 @@ _pgm_rxw_state (
 	case PGM_PKT_STATE_HAVE_DATA:
 		window->fragment_count++;
 		pgm_assert_cmpuint (window->fragment_count, <=, pgm_rxw_length (window));
+		_pgm_rxw_map_set (window->data_map, _pgm_rxw_index (window, skb->sequence));
 		break;
 
 	case PGM_PKT_STATE_HAVE_PARITY:
 		window->parity_count++;
 		pgm_assert_cmpuint (window->parity_count, <=, pgm_rxw_length (window));
+		_pgm_rxw_map_set (window->parity_map, _pgm_rxw_index (window, skb->sequence));
 		break;
 
 	case PGM_PKT_STATE_COMMIT_DATA:
@@ -1828,7 +4267,8 @@ _pgm_rxw_state (
 
 	case PGM_PKT_STATE_LOST_DATA:
 		window->lost_count++;
-		window->cumulative_losses++;
+		if (!state->is_conflated)
+			window->cumulative_losses++;
 		window->has_event = 1;
 		pgm_assert_cmpuint (window->lost_count, <=, pgm_rxw_length (window));
 		break;
@@ -1895,11 +4335,13 @@ unlink_queue:
 	case PGM_PKT_STATE_HAVE_DATA:
 		pgm_assert_cmpuint (window->fragment_count, >, 0);
 		window->fragment_count--;
+		_pgm_rxw_map_clear (window->data_map, _pgm_rxw_index (window, skb->sequence));
 		break;
 
 	case PGM_PKT_STATE_HAVE_PARITY:
 		pgm_assert_cmpuint (window->parity_count, >, 0);
 		window->parity_count--;
+		_pgm_rxw_map_clear (window->parity_map, _pgm_rxw_index (window, skb->sequence));
 		break;
 
 	case PGM_PKT_STATE_COMMIT_DATA:
@@ -1937,6 +4379,73 @@ pgm_rxw_peek (
 	return _pgm_rxw_peek (window, sequence);
 }
 
+/* returns TRUE if original data of sequence would be discarded as a duplicate
+ * without changing window state, already committed or held.  parity is not
+ * considered.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_rxw_is_duplicate (
+	const pgm_rxw_t* const	window,
+	const uint32_t		sequence
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != window);
+
+	if (!window->is_defined)
+		return FALSE;
+	if (pgm_uint32_lt (sequence, window->commit_lead))
+		return pgm_uint32_gte (sequence, window->trail);
+	if (pgm_uint32_lte (sequence, window->lead)) {
+		const struct pgm_sk_buff_t* skb = _pgm_rxw_peek (window, sequence);
+		return (NULL != skb &&
+			PGM_PKT_STATE_HAVE_DATA == ((const pgm_rxw_state_t*)&skb->cb)->pkt_state);
+	}
+	return FALSE;
+}
+
+/* contiguous lead of the window for a receiver-acknowledged trail, the last
+ * sequence such that it and every earlier sequence has been received or
+ * abandoned, for the source to release its copies.  sequences before the
+ * trail are of no further interest to a late joiner.
+ *
+ * returns TRUE on success, returns FALSE if the window is undefined.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_rxw_ack_trail (
+	const pgm_rxw_t* const restrict window,
+	uint32_t*	   const restrict sequence
+	)
+{
+	uint32_t contiguous;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (NULL != sequence);
+
+	if (!window->is_defined)
+		return FALSE;
+
+	contiguous = window->commit_lead - 1;
+	while (pgm_uint32_lt (contiguous, window->lead)) {
+		const struct pgm_sk_buff_t* skb = _pgm_rxw_peek (window, contiguous + 1);
+		const pgm_rxw_state_t* state;
+		if (NULL == skb)
+			break;
+		state = (const pgm_rxw_state_t*)&skb->cb;
+		if (PGM_PKT_STATE_HAVE_DATA != state->pkt_state &&
+		    PGM_PKT_STATE_LOST_DATA != state->pkt_state)
+			break;
+		contiguous++;
+	}
+	*sequence = contiguous;
+	return TRUE;
+}
+
 /* mark an existing sequence lost due to failed recovery.
  */
 
@@ -2014,7 +4523,7 @@ pgm_rxw_confirm (
 	}
 
 	if (pgm_uint32_lte (sequence, window->lead))
-		return _pgm_rxw_recovery_update (window, sequence, nak_rdata_expiry);
+		return _pgm_rxw_recovery_update (window, sequence, now, nak_rdata_expiry);
 
 	if (sequence == window->lead) 
 		return _pgm_rxw_recovery_append (window, now, nak_rdata_expiry);
@@ -2024,6 +4533,80 @@ pgm_rxw_confirm (
 	}
 }
 
+/* confirm count consecutive sequences from sequence as pgm_rxw_confirm(), for the
+ * ranges of an NCF list.  runs of data and parity are skipped a slot map word at
+ * a time and sequences beyond the lead are appended together.
+ *
+ * returns count of sequences updated or appended, is_appended is set when the
+ * lead is extended.
+ */
+
+PGM_GNUC_INTERNAL
+uint32_t
+pgm_rxw_confirm_range (
+	pgm_rxw_t* const	window,
+	uint32_t		sequence,
+	uint32_t		count,
+	const pgm_time_t	now,
+	const pgm_time_t	nak_rdata_expiry,		/* pre-calculated expiry times */
+	const pgm_time_t	nak_rb_expiry,
+	bool* const		is_appended
+	)
+{
+	uint32_t confirmed = 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (NULL != is_appended);
+
+	pgm_debug ("confirm_range (window:%p sequence:%" PRIu32 " count:%" PRIu32 " nak_rdata_expiry:%" PGM_TIME_FORMAT " nak_rb_expiry:%" PGM_TIME_FORMAT " is-appended:%p)",
+		(void*)window, sequence, count, nak_rdata_expiry, nak_rb_expiry, (void*)is_appended);
+
+	*is_appended = FALSE;
+
+/* NCFs do not define the transmit window */
+	if (PGM_UNLIKELY(!window->is_defined))
+		return 0;
+
+/* sequences already committed */
+	if (pgm_uint32_lt (sequence, window->commit_lead)) {
+		const uint32_t committed = window->commit_lead - sequence;
+		if (committed >= count)
+			return 0;
+		sequence += committed;
+		count    -= committed;
+	}
+
+/* placeholders within the window */
+	while (count > 0 && pgm_uint32_lte (sequence, window->lead))
+	{
+		const uint32_t span = MIN(count, ( 1 + window->lead ) - sequence);
+		const uint32_t run  = _pgm_rxw_map_run (window, window->data_map, window->parity_map, sequence, span);
+		sequence += run;
+		count    -= run;
+		if (run == span)
+			continue;
+		if (PGM_RXW_UPDATED == _pgm_rxw_recovery_update (window, sequence, now, nak_rdata_expiry))
+			confirmed++;
+		sequence++;
+		count--;
+	}
+	if (0 == count)
+		return confirmed;
+
+/* extend the lead */
+	if (sequence != pgm_rxw_next_lead (window) &&
+	    PGM_RXW_APPENDED != _pgm_rxw_add_placeholder_range (window, sequence, now, nak_rb_expiry))
+		return confirmed;
+	while (count--) {
+		if (PGM_RXW_APPENDED != _pgm_rxw_recovery_append (window, now, nak_rdata_expiry))
+			break;
+		*is_appended = TRUE;
+		confirmed++;
+	}
+	return confirmed;
+}
+
 /* update an incoming sequence with state transition to WAIT-DATA.
  *
  * returns:
@@ -2036,6 +4619,7 @@ int
 _pgm_rxw_recovery_update (
 	pgm_rxw_t* const	window,
 	const uint32_t		sequence,
+	const pgm_time_t	now,
 	const pgm_time_t	nak_rdata_expiry		/* pre-calculated expiry times */
 	)
 {
@@ -2050,13 +4634,22 @@ _pgm_rxw_recovery_update (
 	pgm_assert (NULL != skb);
 	state = (pgm_rxw_state_t*)&skb->cb;
 	switch (state->pkt_state) {
-	case PGM_PKT_STATE_BACK_OFF:
 	case PGM_PKT_STATE_WAIT_NCF:
+/* Karn's algorithm, only an unambiguous single NAK times the NCF */
+		if (1 == state->nak_transmit_count &&
+		    0 != state->nak_tstamp &&
+		    pgm_time_after (now, state->nak_tstamp))
+		{
+			_pgm_rxw_rtt_sample (&window->ncf_srtt, &window->ncf_rttvar, now - state->nak_tstamp);
+		}
+/* fall through */
+	case PGM_PKT_STATE_BACK_OFF:
 		pgm_rxw_state (window, skb, PGM_PKT_STATE_WAIT_DATA);
+		state->nak_tstamp = now;
 
 /* fall through */
 	case PGM_PKT_STATE_WAIT_DATA:
-		state->timer_expiry = nak_rdata_expiry;
+		state->timer_expiry = pgm_rxw_expiry (window, skb, nak_rdata_expiry);
 		return PGM_RXW_UPDATED;
 
 	case PGM_PKT_STATE_HAVE_DATA:
@@ -2102,6 +4695,7 @@ _pgm_rxw_recovery_append (
 	}
 
 /* advance leading edge */
+	_pgm_rxw_reserve (window);
 	window->lead++;
 
 /* add loss to bitmap */
@@ -2114,13 +4708,14 @@ _pgm_rxw_recovery_append (
  */
 	window->data_loss = window->ack_c_p + pgm_fp16mul (pgm_fp16 (1) - window->ack_c_p, window->data_loss);
 
-	skb			= pgm_alloc_skb (window->max_tpdu);
+	skb			= pgm_skb_pool_alloc_subsys (window->skb_pool, window->max_tpdu, PGM_MEM_SUBSYS_PLACEHOLDER);
 	state			= (pgm_rxw_state_t*)&skb->cb;
 	skb->tstamp		= now;
 	skb->sequence		= window->lead;
-	state->timer_expiry	= nak_rdata_expiry;
+	state->timer_expiry	= pgm_rxw_expiry (window, skb, nak_rdata_expiry);
+	state->nak_tstamp	= now;
 
-	const uint_fast32_t index_	= pgm_rxw_lead (window) % pgm_rxw_max_length (window);
+	const uint_fast32_t index_	= _pgm_rxw_index (window, pgm_rxw_lead (window));
 	window->pdata[index_]		= skb;
 	_pgm_rxw_state (window, skb, PGM_PKT_STATE_WAIT_DATA);
 
@@ -2161,9 +4756,10 @@ pgm_rxw_dump (
 		"max_fill_time = %" PRIu32 ", "
 		"min_nak_transmit_count = %" PRIu32 ", "
 		"max_nak_transmit_count = %" PRIu32 ", "
-		"cumulative_losses = %" PRIu32 ", "
-		"bytes_delivered = %" PRIu32 ", "
-		"msgs_delivered = %" PRIu32 ", "
+		"cumulative_losses = %" PRIu64 ", "
+		"cumulative_jumped = %" PRIu64 ", "
+		"bytes_delivered = %" PRIu64 ", "
+		"msgs_delivered = %" PRIu64 ", "
 		"size = %" PRIzu ", "
 		"alloc = %" PRIu32 ", "
 		"pdata = []"
@@ -2205,6 +4801,7 @@ pgm_rxw_dump (
 		window->min_nak_transmit_count,
 		window->max_nak_transmit_count,
 		window->cumulative_losses,
+		window->cumulative_jumped,
 		window->bytes_delivered,
 		window->msgs_delivered,
 		window->size,
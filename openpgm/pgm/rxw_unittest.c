@@ -69,6 +69,19 @@ pgm_get_nprocs (void)
 	return 1;
 }
 
+/** packet module */
+PGM_GNUC_INTERNAL
+bool
+pgm_verify_checksum_copy (
+	const struct pgm_sk_buff_t* const restrict skb,
+	void*			    restrict dst,
+	const uint16_t			     copy_len
+	)
+{
+	memcpy (dst, skb->data, copy_len);
+	return TRUE;
+}
+
 /** reed-solomon module */
 void
 mock_pgm_rs_create (
@@ -90,11 +103,17 @@ void
 mock_pgm_rs_decode_parity_appended (
 	pgm_rs_t*		rs,
 	pgm_gf8_t**		block,
+	const uint16_t*		lens,
 	const uint8_t*		offsets,
 	uint16_t		len
 	)
 {
-// null
+/* mark reconstructed payload */
+	if (len <= sizeof(struct pgm_opt_fragment))
+		return;
+	for (uint_fast8_t i = 0; i < rs->k; i++)
+		if (offsets[i] >= rs->k)
+			memset (block[i], 0xa5, len);
 }
 
 void
@@ -107,7 +126,7 @@ mock_pgm_histogram_init (
 void
 mock_pgm_histogram_add (
 	pgm_histogram_t*	histogram,
-	int			value
+	uint64_t		value
 	)
 {
 }
@@ -126,7 +145,7 @@ generate_valid_skb (void)
 	memcpy (&skb->tsi, &tsi, sizeof(tsi));
 /* fake but valid socket and timestamp */
 	skb->sock = (pgm_sock_t*)0x1;
-	skb->tstamp = pgm_time_now;
+	skb->tstamp = skb->wire_tstamp = pgm_time_now;
 /* header */
 	pgm_skb_reserve (skb, header_length);
 	memset (skb->head, 0, header_length);
@@ -147,7 +166,8 @@ generate_valid_skb (void)
  *		const unsigned		sqns,
  *		const unsigned		secs,
  *		const ssize_t		max_rte,
- *		const uint32_t		ack_c_p
+ *		const uint32_t		ack_c_p,
+ *		const pgm_mem_policy_t*const policy
  *		)
  */
 
@@ -156,7 +176,7 @@ START_TEST (test_create_pass_001)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	fail_if (NULL == pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p), "create failed");
+	fail_if (NULL == pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL), "create failed");
 }
 END_TEST
 
@@ -165,7 +185,7 @@ START_TEST (test_create_pass_002)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	fail_if (NULL == pgm_rxw_create (&tsi, 1500, 0, 60, 800000, ack_c_p), "create failed");
+	fail_if (NULL == pgm_rxw_create (&tsi, 1500, 0, 60, 800000, ack_c_p, NULL), "create failed");
 }
 END_TEST
 
@@ -174,7 +194,7 @@ START_TEST (test_create_pass_003)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	fail_if (NULL == pgm_rxw_create (&tsi, 9000, 0, 60, 800000, ack_c_p), "create failed");
+	fail_if (NULL == pgm_rxw_create (&tsi, 9000, 0, 60, 800000, ack_c_p, NULL), "create failed");
 }
 END_TEST
 
@@ -183,7 +203,25 @@ START_TEST (test_create_pass_004)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	fail_if (NULL == pgm_rxw_create (&tsi, UINT16_MAX, 0, 60, 800000, ack_c_p), "create failed");
+	fail_if (NULL == pgm_rxw_create (&tsi, UINT16_MAX, 0, 60, 800000, ack_c_p, NULL), "create failed");
+}
+END_TEST
+
+/* power-of-two windows index by mask once storage is allocated */
+START_TEST (test_create_pass_005)
+{
+	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const uint32_t ack_c_p = 500;
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 1024, 0, 0, ack_c_p, NULL);
+	fail_if (NULL == window, "create failed");
+	_pgm_rxw_resize (window, window->max_alloc);
+	fail_unless (1023 == window->mask, "mask not set");
+	pgm_rxw_destroy (window);
+	window = pgm_rxw_create (&tsi, 1500, 1000, 0, 0, ack_c_p, NULL);
+	fail_if (NULL == window, "create failed");
+	_pgm_rxw_resize (window, window->max_alloc);
+	fail_unless (0 == window->mask, "mask set");
+	pgm_rxw_destroy (window);
 }
 END_TEST
 
@@ -191,7 +229,7 @@ END_TEST
 START_TEST (test_create_fail_001)
 {
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (NULL, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (NULL, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail ("reached");
 }
 END_TEST
@@ -201,7 +239,7 @@ START_TEST (test_create_fail_002)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	fail_if (NULL == pgm_rxw_create (&tsi, 0, 100, 0, 0, ack_c_p), "create failed");
+	fail_if (NULL == pgm_rxw_create (&tsi, 0, 100, 0, 0, ack_c_p, NULL), "create failed");
 }
 END_TEST
 
@@ -209,7 +247,7 @@ START_TEST (test_create_fail_003)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 0, 0, 60, 800000, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 0, 0, 60, 800000, ack_c_p, NULL);
 	fail ("reached");
 }
 END_TEST
@@ -219,7 +257,7 @@ START_TEST (test_create_fail_004)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 0, 0, 0, 800000, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 0, 0, 0, 800000, ack_c_p, NULL);
 	fail ("reached");
 }
 END_TEST
@@ -229,7 +267,7 @@ START_TEST (test_create_fail_005)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 0, 0, 60, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 0, 0, 60, 0, ack_c_p, NULL);
 	fail ("reached");
 }
 END_TEST
@@ -237,7 +275,7 @@ END_TEST
 /* all invalid */
 START_TEST (test_create_fail_006)
 {
-	pgm_rxw_t* window = pgm_rxw_create (NULL, 0, 0, 0, 0, 0);
+	pgm_rxw_t* window = pgm_rxw_create (NULL, 0, 0, 0, 0, 0, NULL);
 	fail ("reached");
 }
 END_TEST
@@ -253,7 +291,7 @@ START_TEST (test_destroy_pass_001)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	pgm_rxw_destroy (window);
 }
@@ -281,7 +319,7 @@ START_TEST (test_add_pass_001)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	struct pgm_sk_buff_t* skb = generate_valid_skb ();
 	fail_if (NULL == skb, "generate_valid_skb failed");
@@ -298,7 +336,7 @@ START_TEST (test_add_pass_002)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-        pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+        pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
         fail_if (NULL == window, "create failed");
 /* #1 */
         struct pgm_sk_buff_t* skb = generate_valid_skb ();
@@ -326,7 +364,7 @@ START_TEST (test_add_pass_003)
 {
         pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-        pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+        pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
         fail_if (NULL == window, "create failed");
 /* #1 */
         struct pgm_sk_buff_t* skb = generate_valid_skb ();
@@ -354,7 +392,7 @@ START_TEST (test_add_pass_004)
 {
         pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-        pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+        pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
         fail_if (NULL == window, "create failed");
         struct pgm_sk_buff_t* skb = generate_valid_skb ();
         fail_if (NULL == skb, "generate_valid_skb failed"); 
@@ -371,7 +409,7 @@ START_TEST (test_add_pass_005)
 {
         pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-        pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+        pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
         fail_if (NULL == window, "create failed");
 /* #1 */
         struct pgm_sk_buff_t* skb = generate_valid_skb ();
@@ -409,12 +447,199 @@ START_TEST (test_add_pass_005)
 }
 END_TEST
 
+/* parity without FEC is discarded, parity for a missing packet is reconstructed */
+START_TEST (test_add_pass_006)
+{
+	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const uint32_t ack_c_p = 500;
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
+	fail_if (NULL == window, "create failed");
+	struct pgm_msgv_t msgv[4], *pmsg;
+	const pgm_time_t now = 1;
+	const pgm_time_t nak_rb_expiry = 2;
+/* #1 parity before FEC is enabled */
+	struct pgm_sk_buff_t* skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->pgm_header->pgm_type = PGM_RDATA;
+	skb->pgm_header->pgm_options = PGM_OPT_PARITY;
+	skb->pgm_data->data_sqn = g_htonl (0);
+	fail_unless (PGM_RXW_DUPLICATE == pgm_rxw_add (window, skb, now, nak_rb_expiry), "add not duplicate");
+/* reed-solomon module is mocked */
+	window->rs.n = 255;
+	window->rs.k = 4;
+	pgm_rxw_update_fec (window, 4);
+/* #2,3,4 transmission group missing one packet */
+	const guint32 sequences[] = { 0, 1, 3 };
+	const int answers[] = { PGM_RXW_APPENDED, PGM_RXW_APPENDED, PGM_RXW_MISSING };
+	for (unsigned i = 0; i < G_N_ELEMENTS(sequences); i++) {
+		skb = generate_valid_skb ();
+		fail_if (NULL == skb, "generate_valid_skb failed");
+		skb->pgm_data->data_sqn = g_htonl (sequences[i]);
+		fail_unless (answers[i] == pgm_rxw_add (window, skb, now, nak_rb_expiry), "add failed");
+	}
+/* #5 parity fills the group */
+	skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->pgm_header->pgm_type = PGM_RDATA;
+	skb->pgm_header->pgm_options = PGM_OPT_PARITY;
+	skb->pgm_data->data_sqn = g_htonl (0);
+	fail_unless (PGM_RXW_INSERTED == pgm_rxw_add (window, skb, now, nak_rb_expiry), "add not inserted");
+	pmsg = msgv;
+	fail_unless (4000 == pgm_rxw_readv (window, &pmsg, G_N_ELEMENTS(msgv)), "readv failed");
+	pgm_rxw_destroy (window);
+}
+END_TEST
+
+/* parity reconstruction completed by a decoder thread */
+START_TEST (test_add_pass_009)
+{
+	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const uint32_t ack_c_p = 500;
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
+	fail_if (NULL == window, "create failed");
+	pgm_notify_t notify;
+	fail_unless (0 == pgm_notify_init (&notify), "notify_init failed");
+	window->decoder = pgm_rxw_decoder_create (1, &notify);
+	fail_if (NULL == window->decoder, "decoder_create failed");
+	struct pgm_msgv_t msgv[4], *pmsg;
+	const pgm_time_t now = 1;
+	const pgm_time_t nak_rb_expiry = 2;
+	window->rs.n = 255;
+	window->rs.k = 4;
+	pgm_rxw_update_fec (window, 4);
+/* #1,2,3 transmission group missing one packet */
+	const guint32 sequences[] = { 0, 1, 3 };
+	for (unsigned i = 0; i < G_N_ELEMENTS(sequences); i++) {
+		struct pgm_sk_buff_t* skb = generate_valid_skb ();
+		fail_if (NULL == skb, "generate_valid_skb failed");
+		skb->pgm_data->data_sqn = g_htonl (sequences[i]);
+		(void)pgm_rxw_add (window, skb, now, nak_rb_expiry);
+	}
+/* #4 parity fills the group, reconstruction deferred to the decoder */
+	struct pgm_sk_buff_t* skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->pgm_header->pgm_type = PGM_RDATA;
+	skb->pgm_header->pgm_options = PGM_OPT_PARITY;
+	skb->pgm_data->data_sqn = g_htonl (0);
+	fail_unless (PGM_RXW_INSERTED == pgm_rxw_add (window, skb, now, nak_rb_expiry), "add not inserted");
+	pmsg = msgv;
+	fail_unless (2000 == pgm_rxw_readv (window, &pmsg, G_N_ELEMENTS(msgv)), "readv not stopped at parity");
+	while (!pgm_rxw_decoder_is_pending (window->decoder))
+		g_usleep (1000);
+	fail_unless (TRUE == pgm_rxw_decoder_acknowledge (window->decoder), "acknowledge failed");
+	fail_unless (window == pgm_rxw_decoder_complete (window->decoder), "complete failed");
+	fail_unless (NULL == pgm_rxw_decoder_complete (window->decoder), "complete not empty");
+	pmsg = msgv;
+	fail_unless (2000 == pgm_rxw_readv (window, &pmsg, G_N_ELEMENTS(msgv)), "readv failed");
+	fail_unless (2 == msgv[0].msgv_skb[0]->sequence, "reconstructed sequence");
+	fail_unless ((guint8)0xa5 == ((const guint8*)msgv[0].msgv_skb[0]->data)[999], "reconstructed payload");
+	pgm_rxw_decoder_t* decoder = window->decoder;
+	pgm_rxw_destroy (window);
+	pgm_rxw_decoder_destroy (decoder);
+	pgm_notify_destroy (&notify);
+}
+END_TEST
+
+/* repair time is measured from the placeholder to the wire arrival of the repair */
+START_TEST (test_add_pass_007)
+{
+	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const uint32_t ack_c_p = 500;
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
+	fail_if (NULL == window, "create failed");
+	const pgm_time_t nak_rb_expiry = 2;
+	struct pgm_sk_buff_t* skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->pgm_data->data_sqn = g_htonl (0);
+	fail_unless (PGM_RXW_APPENDED == pgm_rxw_add (window, skb, 1, nak_rb_expiry), "add not appended");
+/* #2 with jump creates placeholder at time 10 */
+	skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->pgm_data->data_sqn = g_htonl (2);
+	fail_unless (PGM_RXW_MISSING == pgm_rxw_add (window, skb, 10, nak_rb_expiry), "add not missing");
+/* #3 repair on the wire at time 40, read by the application at 100 */
+	skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->pgm_header->pgm_type = PGM_RDATA;
+	skb->pgm_data->data_sqn = g_htonl (1);
+	skb->tstamp = 100;
+	skb->wire_tstamp = 40;
+	fail_unless (PGM_RXW_INSERTED == pgm_rxw_add (window, skb, 40, nak_rb_expiry), "add not inserted");
+	fail_unless (30 == window->min_fill_time, "min_fill_time not from wire time");
+	fail_unless (30 == window->max_fill_time, "max_fill_time not from wire time");
+	fail_unless (30 == ((pgm_rxw_state_t*)&skb->cb)->fill_time, "fill_time not saved on repair");
+	pgm_rxw_destroy (window);
+}
+END_TEST
+
+/* small packet copied to a size class skbuff, receive buffer released */
+START_TEST (test_add_pass_008)
+{
+	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const uint32_t ack_c_p = 500;
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
+	fail_if (NULL == window, "create failed");
+	pgm_skb_pool_t* pool = pgm_skb_pool_new (PGM_SKB_CLASS_MIN, NULL);
+	fail_if (NULL == pool, "pgm_skb_pool_new failed");
+	struct pgm_sk_buff_t* skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->pgm_header->pgm_tsdu_length = g_htons (100);
+	skb->tail = (char*)skb->data + 100;
+	skb->len = 100;
+	memset (skb->data, 0x5a, 100);
+	skb->pgm_data->data_sqn = g_htonl (0);
+	struct pgm_sk_buff_t* copy = pgm_skb_pool_copy (pool, skb);
+	pgm_free_skb (skb);
+	fail_unless (pool == copy->pool, "copy not from pool");
+	fail_unless ((char*)copy->pgm_data == (char*)(copy->pgm_header + 1), "header pointers not rebased");
+	fail_unless (PGM_ODATA == copy->pgm_header->pgm_type, "header not copied");
+	fail_unless (PGM_RXW_APPENDED == pgm_rxw_add (window, copy, 1, 2), "add not appended");
+	struct pgm_msgv_t msgv[1], *pmsg = msgv;
+	fail_unless (100 == pgm_rxw_readv (window, &pmsg, G_N_ELEMENTS(msgv)), "readv failed");
+	fail_unless (copy == msgv[0].msgv_skb[0], "readv skb mismatch");
+	fail_unless (0x5a == ((const char*)copy->data)[99], "payload not copied");
+	pgm_rxw_destroy (window);
+	pgm_skb_pool_destroy (pool);
+}
+END_TEST
+
+/* slow consumer jump over the unread trail of a full window */
+START_TEST (test_add_pass_010)
+{
+	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const uint32_t ack_c_p = 500;
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
+	fail_if (NULL == window, "create failed");
+	window->jump_sqns = 10;
+	const pgm_time_t now = 1;
+	const pgm_time_t nak_rb_expiry = 2;
+	for (unsigned i = 0; i < pgm_rxw_max_length (window); i++) {
+		struct pgm_sk_buff_t* skb = generate_valid_skb ();
+		fail_if (NULL == skb, "generate_valid_skb failed");
+		skb->pgm_data->data_sqn = g_htonl (i);
+		fail_unless (PGM_RXW_APPENDED == pgm_rxw_add (window, skb, now, nak_rb_expiry), "add not appended");
+	}
+	fail_unless (pgm_rxw_is_full (window), "not full");
+	struct pgm_sk_buff_t* skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->pgm_data->data_sqn = g_htonl (pgm_rxw_max_length (window));
+	fail_unless (PGM_RXW_APPENDED == pgm_rxw_add (window, skb, now, nak_rb_expiry), "add not appended");
+	fail_unless (10 == window->trail, "trail not jumped");
+	fail_unless (10 == window->cumulative_jumped, "cumulative_jumped mismatch");
+	fail_unless (0 == window->cumulative_losses, "jump counted as loss");
+	struct pgm_msgv_t msgv[1], *pmsg = msgv;
+	fail_unless (1000 == pgm_rxw_readv (window, &pmsg, G_N_ELEMENTS(msgv)), "readv failed");
+	fail_unless (10 == msgv[0].msgv_skb[0]->sequence, "not resumed after jump");
+	pgm_rxw_destroy (window);
+}
+END_TEST
+
 /* null skb */
 START_TEST (test_add_fail_001)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	const pgm_time_t now = 1;
 	const pgm_time_t nak_rb_expiry = 2;
@@ -441,7 +666,7 @@ START_TEST (test_add_fail_003)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	char buffer[1500];
 	memset (buffer, 0, sizeof(buffer));
@@ -457,7 +682,7 @@ START_TEST (test_add_fail_004)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	struct pgm_sk_buff_t* skb = generate_valid_skb ();
 	fail_if (NULL == skb, "generate_valid_skb failed");
@@ -468,6 +693,110 @@ START_TEST (test_add_fail_004)
 }
 END_TEST
 
+/* target:
+ *	int
+ *	pgm_rxw_add_repair (
+ *		pgm_rxw_t* const		window,
+ *		struct pgm_sk_buff_t* const	skb,
+ *		const uint8_t			count,
+ *		const uint16_t			key,
+ *		const pgm_time_t		now,
+ *		const pgm_time_t		nak_rb_expiry
+ *		)
+ */
+
+static
+struct pgm_sk_buff_t*
+generate_repair_skb (
+	struct pgm_sk_buff_t**	sources,
+	const guint32		first,
+	const guint8		count,
+	const guint16		key
+	)
+{
+	const guint16 source_length = sources[0]->len;
+	struct pgm_sk_buff_t* skb = generate_valid_skb ();
+	skb->pgm_header->pgm_type = PGM_RDATA;
+	skb->pgm_header->pgm_tsdu_length = g_htons (PGM_RLC_SYMBOL_HEADER + source_length);
+	skb->pgm_data->data_sqn = g_htonl (first + count - 1);
+	skb->pgm_data->data_trail = g_htonl (first);
+	pgm_skb_put (skb, PGM_RLC_SYMBOL_HEADER + source_length - skb->len);
+	memset (skb->data, 0, skb->len);
+	for (unsigned i = 0; i < count; i++)
+		pgm_rlc_encode (skb->data, pgm_rlc_coefficient (key, first + i), sources[i]);
+	return skb;
+}
+
+/* repair covering a lost packet is inserted */
+START_TEST (test_add_repair_pass_001)
+{
+	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const uint32_t ack_c_p = 500;
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
+	fail_if (NULL == window, "create failed");
+	struct pgm_msgv_t msgv[4], *pmsg;
+	struct pgm_sk_buff_t* sources[4];
+	const pgm_time_t now = 1;
+	const pgm_time_t nak_rb_expiry = 2;
+	pgm_rxw_update_sw (window, 16);
+	for (unsigned i = 0; i < G_N_ELEMENTS(sources); i++) {
+		sources[i] = generate_valid_skb ();
+		fail_if (NULL == sources[i], "generate_valid_skb failed");
+		sources[i]->pgm_data->data_sqn = g_htonl (i);
+		memset (sources[i]->data, 'a' + i, sources[i]->len);
+	}
+	struct pgm_sk_buff_t* repair = generate_repair_skb (sources, 0, G_N_ELEMENTS(sources), 7);
+/* #1,2,3 packet #2 lost */
+	const int answers[] = { PGM_RXW_APPENDED, PGM_RXW_APPENDED, 0, PGM_RXW_MISSING };
+	for (unsigned i = 0; i < G_N_ELEMENTS(sources); i++) {
+		if (2 == i) continue;
+		fail_unless (answers[i] == pgm_rxw_add (window, sources[i], now, nak_rb_expiry), "add failed");
+	}
+/* #4 repair */
+	fail_unless (PGM_RXW_INSERTED == pgm_rxw_add_repair (window, repair, G_N_ELEMENTS(sources), 7, now, nak_rb_expiry), "add_repair not inserted");
+	pmsg = msgv;
+	fail_unless (4000 == pgm_rxw_readv (window, &pmsg, G_N_ELEMENTS(msgv)), "readv failed");
+	const struct pgm_sk_buff_t* skb = msgv[2].msgv_skb[0];
+	fail_unless (2 == skb->sequence, "recovered sequence mismatch");
+	fail_unless (1000 == skb->len, "recovered length mismatch");
+	fail_unless ('c' == ((const char*)skb->data)[0] && 'c' == ((const char*)skb->data)[999], "recovered data mismatch");
+	pgm_free_skb (sources[2]);
+	pgm_rxw_destroy (window);
+}
+END_TEST
+
+/* repair without sliding window FEC is discarded */
+START_TEST (test_add_repair_pass_002)
+{
+	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const uint32_t ack_c_p = 500;
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
+	fail_if (NULL == window, "create failed");
+	const pgm_time_t now = 1;
+	const pgm_time_t nak_rb_expiry = 2;
+	struct pgm_sk_buff_t* sources[1];
+	sources[0] = generate_valid_skb ();
+	fail_if (NULL == sources[0], "generate_valid_skb failed");
+	struct pgm_sk_buff_t* repair = generate_repair_skb (sources, 0, 1, 7);
+	fail_unless (PGM_RXW_DUPLICATE == pgm_rxw_add_repair (window, repair, 1, 7, now, nak_rb_expiry), "add_repair not duplicate");
+	pgm_free_skb (repair);
+	pgm_free_skb (sources[0]);
+	pgm_rxw_destroy (window);
+}
+END_TEST
+
+/* null window */
+START_TEST (test_add_repair_fail_001)
+{
+	struct pgm_sk_buff_t* skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	const pgm_time_t now = 1;
+	const pgm_time_t nak_rb_expiry = 2;
+	int retval = pgm_rxw_add_repair (NULL, skb, 1, 7, now, nak_rb_expiry);
+	fail ("reached");
+}
+END_TEST
+
 /* target:
  *	struct pgm_sk_buff_t*
  *	pgm_rxw_peek (
@@ -480,7 +809,7 @@ START_TEST (test_peek_pass_001)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	fail_unless (NULL == pgm_rxw_peek (window, 0), "peek failed");
 	struct pgm_sk_buff_t* skb = generate_valid_skb ();
@@ -504,6 +833,77 @@ START_TEST (test_peek_fail_001)
 }
 END_TEST
 
+/* target:
+ *	bool
+ *	pgm_rxw_is_duplicate (
+ *		const pgm_rxw_t* const	window,
+ *		const uint32_t		sequence
+ *		)
+ */
+
+START_TEST (test_is_duplicate_pass_001)
+{
+	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const uint32_t ack_c_p = 500;
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
+	fail_if (NULL == window, "create failed");
+	fail_unless (FALSE == pgm_rxw_is_duplicate (window, 0), "undefined window duplicate");
+	const pgm_time_t now = 1;
+	const pgm_time_t nak_rb_expiry = 2;
+	struct pgm_sk_buff_t* skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->pgm_data->data_sqn = g_htonl (0);
+	fail_unless (PGM_RXW_APPENDED == pgm_rxw_add (window, skb, now, nak_rb_expiry), "add not appended");
+/* #1 leaves a placeholder */
+	skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->pgm_data->data_sqn = g_htonl (2);
+	fail_unless (PGM_RXW_MISSING == pgm_rxw_add (window, skb, now, nak_rb_expiry), "add not missing");
+	fail_unless (TRUE == pgm_rxw_is_duplicate (window, 0), "held data not duplicate");
+	fail_unless (FALSE == pgm_rxw_is_duplicate (window, 1), "placeholder duplicate");
+	fail_unless (TRUE == pgm_rxw_is_duplicate (window, 2), "held data not duplicate");
+	fail_unless (FALSE == pgm_rxw_is_duplicate (window, 3), "next lead duplicate");
+	pgm_rxw_destroy (window);
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_rxw_ack_trail (
+ *		const pgm_rxw_t* const	window,
+ *		uint32_t* const		sequence
+ *		)
+ */
+
+START_TEST (test_ack_trail_pass_001)
+{
+	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const uint32_t ack_c_p = 500;
+	uint32_t sequence;
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
+	fail_if (NULL == window, "create failed");
+	fail_unless (FALSE == pgm_rxw_ack_trail (window, &sequence), "undefined window has trail");
+	const pgm_time_t now = 1;
+	const pgm_time_t nak_rb_expiry = 2;
+	struct pgm_sk_buff_t* skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->pgm_data->data_sqn = g_htonl (0);
+	fail_unless (PGM_RXW_APPENDED == pgm_rxw_add (window, skb, now, nak_rb_expiry), "add not appended");
+/* #1 leaves a placeholder */
+	skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->pgm_data->data_sqn = g_htonl (2);
+	fail_unless (PGM_RXW_MISSING == pgm_rxw_add (window, skb, now, nak_rb_expiry), "add not missing");
+	fail_unless (TRUE == pgm_rxw_ack_trail (window, &sequence), "no trail");
+	fail_unless (0 == sequence, "trail not #0");
+/* abandoned #1 no longer holds the trail */
+	pgm_rxw_lost (window, 1);
+	fail_unless (TRUE == pgm_rxw_ack_trail (window, &sequence), "no trail");
+	fail_unless (2 == sequence, "trail not #2");
+	pgm_rxw_destroy (window);
+}
+END_TEST
+
 /** inline function tests **/
 /* pgm_rxw_max_length () 
  */
@@ -512,13 +912,52 @@ START_TEST (test_max_length_pass_001)
 	const guint window_length = 100;
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, window_length, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, window_length, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	fail_unless (window_length == pgm_rxw_max_length (window), "max_length failed");
 	pgm_rxw_destroy (window);
 }
 END_TEST
 
+/* storage is allocated on the first sequence, grows on demand and is released
+ * by compaction once empty.
+ */
+START_TEST (test_max_length_pass_002)
+{
+	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const uint32_t ack_c_p = 500;
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 1024, 0, 0, ack_c_p, NULL);
+	fail_if (NULL == window, "create failed");
+	fail_unless (0 == window->alloc, "storage allocated on create");
+	const pgm_time_t now = 1;
+	const pgm_time_t nak_rb_expiry = 2;
+	for (unsigned i = 0; i < 100; i++)
+	{
+		struct pgm_sk_buff_t* skb = generate_valid_skb ();
+		fail_if (NULL == skb, "generate_valid_skb failed");
+		skb->pgm_data->data_sqn = g_htonl (i);
+		fail_unless (PGM_RXW_APPENDED == pgm_rxw_add (window, skb, now, nak_rb_expiry), "add not appended");
+	}
+	fail_unless (128 == window->alloc, "storage not grown");
+	fail_unless (1024 == pgm_rxw_max_length (window), "max_length failed");
+	fail_unless (100 == pgm_rxw_length (window), "length failed");
+	pgm_rxw_compact (window);
+	fail_unless (128 == window->alloc, "storage released whilst in use");
+	struct pgm_msgv_t msgv[100], *pmsg = msgv;
+	fail_unless (100000 == pgm_rxw_readv (window, &pmsg, G_N_ELEMENTS(msgv)), "readv failed");
+	pgm_rxw_remove_commit (window);
+	fail_unless (pgm_rxw_is_empty (window), "window not empty");
+	pgm_rxw_compact (window);
+	fail_unless (0 == window->alloc, "storage not released");
+	struct pgm_sk_buff_t* skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->pgm_data->data_sqn = g_htonl (100);
+	fail_unless (PGM_RXW_APPENDED == pgm_rxw_add (window, skb, now, nak_rb_expiry), "add not appended");
+	fail_unless (64 == window->alloc, "storage not re-allocated");
+	pgm_rxw_destroy (window);
+}
+END_TEST
+
 START_TEST (test_max_length_fail_001)
 {
 	const unsigned len = pgm_rxw_max_length (NULL);
@@ -532,7 +971,7 @@ START_TEST (test_length_pass_001)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	fail_unless (0 == pgm_rxw_length (window), "length failed");
 	struct pgm_sk_buff_t* skb = generate_valid_skb ();
@@ -565,7 +1004,7 @@ START_TEST (test_size_pass_001)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	fail_unless (0 == pgm_rxw_size (window), "size failed");
 	struct pgm_sk_buff_t* skb = generate_valid_skb ();
@@ -598,7 +1037,7 @@ START_TEST (test_is_empty_pass_001)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	fail_unless (pgm_rxw_is_empty (window), "is_empty failed");
 	struct pgm_sk_buff_t* skb = generate_valid_skb ();
@@ -625,7 +1064,7 @@ START_TEST (test_is_full_pass_001)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 1, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 1, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	fail_if (pgm_rxw_is_full (window), "is_full failed");
 	struct pgm_sk_buff_t* skb = generate_valid_skb ();
@@ -652,7 +1091,7 @@ START_TEST (test_lead_pass_001)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	guint32 lead = pgm_rxw_lead (window);
 	struct pgm_sk_buff_t* skb = generate_valid_skb ();
@@ -679,7 +1118,7 @@ START_TEST (test_next_lead_pass_001)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	guint32 next_lead = pgm_rxw_next_lead (window);
 	struct pgm_sk_buff_t* skb = generate_valid_skb ();
@@ -713,7 +1152,7 @@ START_TEST (test_readv_pass_001)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	struct pgm_msgv_t msgv[2], *pmsg;
 /* #1 empty */
@@ -767,7 +1206,7 @@ START_TEST (test_readv_pass_002)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	struct pgm_msgv_t msgv[2], *pmsg;
 	struct pgm_sk_buff_t* skb = generate_valid_skb ();
@@ -792,7 +1231,7 @@ START_TEST (test_readv_pass_003)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	struct pgm_msgv_t msgv[1], *pmsg;
 	struct pgm_sk_buff_t* skb;
@@ -829,7 +1268,7 @@ START_TEST (test_readv_pass_004)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	struct pgm_msgv_t msgv[1], *pmsg;
 	struct pgm_sk_buff_t* skb;
@@ -866,7 +1305,7 @@ START_TEST (test_readv_pass_005)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	struct pgm_msgv_t msgv[1], *pmsg;
 	struct pgm_sk_buff_t* skb;
@@ -921,7 +1360,7 @@ START_TEST (test_readv_pass_006)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	struct pgm_msgv_t msgv[1], *pmsg;
 	struct pgm_sk_buff_t* skb;
@@ -977,6 +1416,240 @@ START_TEST (test_readv_pass_006)
 END_TEST
 
 /* NULL window */
+/* OPT_BATCH messages, one APDU each, resumed across calls when pmsg fills */
+START_TEST (test_readv_pass_010)
+{
+	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const uint32_t ack_c_p = 500;
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
+	fail_if (NULL == window, "create failed");
+	struct pgm_msgv_t msgv[2], *pmsg;
+	const guint16 lengths[] = { 10, 0, 20 };
+	struct pgm_sk_buff_t* skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->is_batch = 1;
+	guint16 offset = 0;
+	for (unsigned i = 0; i < G_N_ELEMENTS(lengths); i++) {
+		const guint16 length = g_htons (lengths[i]);
+		memcpy ((char*)skb->data + offset, &length, sizeof(length));
+		memset ((char*)skb->data + offset + sizeof(length), 'a' + i, lengths[i]);
+		offset += sizeof(length) + lengths[i];
+	}
+/* trailing length prefix overruns the packet */
+	const guint16 overrun = g_htons (1000);
+	memcpy ((char*)skb->data + offset, &overrun, sizeof(overrun));
+	offset += sizeof(overrun);
+	skb->tail = (char*)skb->data + offset;
+	skb->len = offset;
+	skb->pgm_header->pgm_tsdu_length = g_htons (offset);
+	skb->pgm_data->data_sqn = g_htonl (0);
+	const pgm_time_t now = 1;
+	const pgm_time_t nak_rb_expiry = 2;
+	fail_unless (PGM_RXW_APPENDED == pgm_rxw_add (window, skb, now, nak_rb_expiry), "add not appended");
+/* first two messages fill pmsg */
+	pmsg = msgv;
+	fail_unless (10 == pgm_rxw_readv (window, &pmsg, G_N_ELEMENTS(msgv)), "readv failed");
+	fail_unless (&msgv[2] == pmsg, "unexpected message count");
+	fail_unless (1 == msgv[0].msgv_len && 10 == msgv[0].msgv_skb[0]->len, "unexpected first message");
+	fail_unless ('a' == *(char*)msgv[0].msgv_skb[0]->data, "unexpected first message data");
+	fail_unless (1 == msgv[1].msgv_len && 0 == msgv[1].msgv_skb[0]->len, "unexpected second message");
+	fail_unless (_pgm_rxw_commit_is_empty (window), "packet committed whilst partially read");
+	pgm_rxw_remove_commit (window);
+/* remainder */
+	pmsg = msgv;
+	fail_unless (20 == pgm_rxw_readv (window, &pmsg, G_N_ELEMENTS(msgv)), "readv failed");
+	fail_unless (&msgv[1] == pmsg, "unexpected message count");
+	fail_unless ('c' == *(char*)msgv[0].msgv_skb[0]->data, "unexpected third message data");
+	fail_unless (!_pgm_rxw_commit_is_empty (window), "packet not committed");
+	pmsg = msgv;
+	fail_unless (-1 == pgm_rxw_readv (window, &pmsg, G_N_ELEMENTS(msgv)), "readv failed");
+	pgm_rxw_remove_commit (window);
+	pgm_rxw_destroy (window);
+}
+END_TEST
+
+/* fragmented APDU, delivered once the gap before the last fragment fills */
+START_TEST (test_readv_pass_011)
+{
+	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const uint32_t ack_c_p = 500;
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
+	fail_if (NULL == window, "create failed");
+	struct pgm_opt_fragment fragments[4];
+	struct pgm_msgv_t msgv[1], *pmsg;
+	const unsigned order[] = { 0, 2, 3, 1 };
+	for (unsigned i = 0; i < G_N_ELEMENTS(order); i++)
+	{
+		const unsigned sequence = order[i];
+		struct pgm_sk_buff_t* skb = generate_valid_skb ();
+		fail_if (NULL == skb, "generate_valid_skb failed");
+		skb->pgm_data->data_sqn = g_htonl (sequence);
+		skb->pgm_opt_fragment = &fragments[sequence];
+		fragments[sequence].opt_sqn = g_htonl (0);
+		fragments[sequence].opt_frag_off = g_htonl (sequence * skb->len);
+		fragments[sequence].opt_frag_len = g_htonl (G_N_ELEMENTS(fragments) * skb->len);
+		const pgm_time_t now = 1;
+		const pgm_time_t nak_rb_expiry = 2;
+		fail_unless (PGM_RXW_MISSING >= pgm_rxw_add (window, skb, now, nak_rb_expiry), "add failed");
+		pmsg = msgv;
+		if (i < G_N_ELEMENTS(order) - 1) {
+			fail_unless (-1 == pgm_rxw_readv (window, &pmsg, G_N_ELEMENTS(msgv)), "readv failed");
+			fail_unless (msgv == pmsg, "unexpected message");
+		} else {
+			fail_unless (4000 == pgm_rxw_readv (window, &pmsg, G_N_ELEMENTS(msgv)), "readv failed");
+			fail_unless (&msgv[1] == pmsg, "unexpected message count");
+			fail_unless (4 == msgv[0].msgv_len, "unexpected fragment count");
+		}
+	}
+	pgm_rxw_remove_commit (window);
+	pgm_rxw_destroy (window);
+}
+END_TEST
+
+/* slow consumer, unread messages of a full window are spilled and read first */
+START_TEST (test_readv_pass_012)
+{
+	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const uint32_t ack_c_p = 500;
+	const struct pgm_spill_req_t spill_req = { .sr_size = 1024 * 1024, .sr_dir = NULL };
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 10, 0, 0, ack_c_p, NULL);
+	fail_if (NULL == window, "create failed");
+	window->spill_req = &spill_req;
+	struct pgm_opt_fragment fragments[4];
+	struct pgm_msgv_t msgv[32], *pmsg;
+	for (unsigned sequence = 0; sequence < 30; sequence++)
+	{
+		struct pgm_sk_buff_t* skb = generate_valid_skb ();
+		fail_if (NULL == skb, "generate_valid_skb failed");
+		skb->pgm_data->data_sqn = g_htonl (sequence);
+/* one APDU of four fragments */
+		if (sequence >= 5 && sequence < 9) {
+			struct pgm_opt_fragment* fragment = &fragments[sequence - 5];
+			skb->pgm_opt_fragment = fragment;
+			fragment->opt_sqn = g_htonl (5);
+			fragment->opt_frag_off = g_htonl ((sequence - 5) * skb->len);
+			fragment->opt_frag_len = g_htonl (G_N_ELEMENTS(fragments) * skb->len);
+		}
+		const pgm_time_t now = 1;
+		const pgm_time_t nak_rb_expiry = 2;
+		fail_unless (PGM_RXW_APPENDED == pgm_rxw_add (window, skb, now, nak_rb_expiry), "add not appended");
+	}
+	fail_unless (10 == pgm_rxw_length (window), "unexpected window length");
+	pmsg = msgv;
+	fail_unless (4000 == pgm_rxw_readv (window, &pmsg, 4), "readv failed");
+	fail_unless (&msgv[4] == pmsg, "unexpected message count");
+	pgm_rxw_remove_commit (window);
+	pmsg = msgv;
+	fail_unless (26000 == pgm_rxw_readv (window, &pmsg, G_N_ELEMENTS(msgv)), "readv failed");
+	fail_unless (&msgv[23] == pmsg, "unexpected message count");
+	fail_unless (4 == msgv[1].msgv_len, "unexpected fragment count");
+	for (unsigned i = 1; i < 23; i++)
+		fail_unless (msgv[i - 1].msgv_skb[0]->sequence < msgv[i].msgv_skb[0]->sequence, "out of order");
+	fail_unless (0 == window->cumulative_losses, "unexpected loss");
+	pgm_rxw_remove_commit (window);
+	pgm_rxw_destroy (window);
+}
+END_TEST
+
+/* last-value feed, superseded messages are skipped and their repair abandoned */
+START_TEST (test_readv_pass_013)
+{
+	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const uint32_t ack_c_p = 500;
+	const struct pgm_conflate_req_t conflate_req = { .cf_offset = 0, .cf_len = 1 };
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
+	fail_if (NULL == window, "create failed");
+	window->conflate_req = &conflate_req;
+	const pgm_time_t now = 1;
+	const pgm_time_t nak_rb_expiry = 2;
+	struct pgm_msgv_t msgv[4], *pmsg;
+/* keys A, B, A from the payload */
+	const char keys[] = "ABA";
+	for (unsigned sequence = 0; sequence < 3; sequence++)
+	{
+		struct pgm_sk_buff_t* skb = generate_valid_skb ();
+		fail_if (NULL == skb, "generate_valid_skb failed");
+		skb->pgm_data->data_sqn = g_htonl (sequence);
+		((char*)skb->data)[0] = keys[sequence];
+		fail_unless (PGM_RXW_APPENDED == pgm_rxw_add (window, skb, now, nak_rb_expiry), "add not appended");
+	}
+	pmsg = msgv;
+	fail_unless (2000 == pgm_rxw_readv (window, &pmsg, G_N_ELEMENTS(msgv)), "readv failed");
+	fail_unless (&msgv[2] == pmsg, "unexpected message count");
+	fail_unless (1 == msgv[0].msgv_skb[0]->sequence, "superseded message read");
+	pgm_rxw_remove_commit (window);
+/* #4 links #3 with OPT_CONFLATE, NAK of #3 cancelled */
+	struct pgm_opt_conflate opt_conflate;
+	memset (&opt_conflate, 0, sizeof(opt_conflate));
+	opt_conflate.conflate_key[0] = 'C';
+	opt_conflate.conflate_prev_sqn = g_htonl (3);
+	struct pgm_sk_buff_t* skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->pgm_data->data_sqn = g_htonl (4);
+	skb->pgm_opt_conflate = &opt_conflate;
+	fail_unless (PGM_RXW_MISSING == pgm_rxw_add (window, skb, now, nak_rb_expiry), "add not missing");
+	fail_unless (pgm_queue_is_empty (&window->nak_backoff_queue), "NAK not cancelled");
+/* late repair of #3 */
+	skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->pgm_data->data_sqn = g_htonl (3);
+	((char*)skb->data)[0] = 'C';
+	fail_unless (PGM_RXW_INSERTED == pgm_rxw_add (window, skb, now, nak_rb_expiry), "add not inserted");
+	pmsg = msgv;
+	fail_unless (1000 == pgm_rxw_readv (window, &pmsg, G_N_ELEMENTS(msgv)), "readv failed");
+	fail_unless (4 == msgv[0].msgv_skb[0]->sequence, "superseded message read");
+	fail_unless (0 == window->cumulative_losses, "unexpected loss");
+	pgm_rxw_remove_commit (window);
+	pgm_rxw_destroy (window);
+}
+END_TEST
+
+/* fragments placed into one application buffer on arrival, in any order */
+START_TEST (test_readv_pass_014)
+{
+	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const uint32_t ack_c_p = 500;
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
+	fail_if (NULL == window, "create failed");
+	static char region[ 2 * (sizeof(struct pgm_sk_buff_t) + 4000) + 16 ];
+	window->placement_pool = pgm_skb_pool_new_fixed (4000, region, sizeof(region));
+	fail_unless (2 == window->placement_pool->slab_len, "unexpected buffer count");
+	struct pgm_opt_fragment fragments[4];
+	struct pgm_msgv_t msgv[1], *pmsg;
+	const unsigned order[] = { 0, 3, 2, 1 };
+	for (unsigned i = 0; i < G_N_ELEMENTS(order); i++)
+	{
+		const unsigned sequence = order[i];
+		struct pgm_sk_buff_t* skb = generate_valid_skb ();
+		fail_if (NULL == skb, "generate_valid_skb failed");
+		skb->pgm_data->data_sqn = g_htonl (sequence);
+		skb->pgm_opt_fragment = &fragments[sequence];
+		fragments[sequence].opt_sqn = g_htonl (0);
+		fragments[sequence].opt_frag_off = g_htonl (sequence * skb->len);
+		fragments[sequence].opt_frag_len = g_htonl (G_N_ELEMENTS(fragments) * skb->len);
+		memset (skb->data, 'a' + sequence, skb->len);
+		const pgm_time_t now = 1;
+		const pgm_time_t nak_rb_expiry = 2;
+		fail_unless (PGM_RXW_MISSING >= pgm_rxw_add (window, skb, now, nak_rb_expiry), "add failed");
+	}
+	pmsg = msgv;
+	fail_unless (4000 == pgm_rxw_readv (window, &pmsg, G_N_ELEMENTS(msgv)), "readv failed");
+	fail_unless (&msgv[1] == pmsg, "unexpected message count");
+	fail_unless (1 == msgv[0].msgv_len, "unexpected fragment count");
+	const struct pgm_sk_buff_t* apdu = msgv[0].msgv_skb[0];
+	fail_unless (4000 == apdu->len, "unexpected APDU length");
+	fail_unless ((const char*)apdu >= region && (const char*)apdu->tail <= region + sizeof(region), "APDU outside region");
+	for (unsigned i = 0; i < 4; i++)
+		fail_unless ('a' + i == ((const char*)apdu->data)[ i * 1000 ] &&
+			     'a' + i == ((const char*)apdu->data)[ i * 1000 + 999 ], "misplaced fragment");
+	pgm_rxw_remove_commit (window);
+	pgm_skb_pool_t* pool = window->placement_pool;
+	fail_unless (0 == pool->outstanding, "placement buffer not released");
+	pgm_rxw_destroy (window);
+	pgm_skb_pool_destroy (pool);
+}
+END_TEST
+
 START_TEST (test_readv_fail_001)
 {
 	struct pgm_msgv_t msgv[1], *pmsg = msgv;
@@ -990,7 +1663,7 @@ START_TEST (test_readv_fail_002)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	struct pgm_sk_buff_t* skb = generate_valid_skb ();
 	fail_if (NULL == skb, "generate_valid_skb failed");
@@ -1009,7 +1682,7 @@ START_TEST (test_readv_fail_003)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	struct pgm_sk_buff_t* skb = generate_valid_skb ();
 	fail_if (NULL == skb, "generate_valid_skb failed");
@@ -1036,7 +1709,7 @@ START_TEST (test_remove_commit_pass_001)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	struct pgm_msgv_t msgv[1], *pmsg;
 	struct pgm_sk_buff_t* skb;
@@ -1109,6 +1782,34 @@ START_TEST (test_remove_commit_pass_001)
 }
 END_TEST
 
+/* borrowed skbuff survives window commit */
+START_TEST (test_remove_commit_pass_002)
+{
+	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const uint32_t ack_c_p = 500;
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
+	fail_if (NULL == window, "create failed");
+	struct pgm_msgv_t msgv[1], *pmsg;
+	struct pgm_sk_buff_t* skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->pgm_data->data_sqn = g_htonl (0);
+	const pgm_time_t now = 1;
+	const pgm_time_t nak_rb_expiry = 2;
+	fail_unless (PGM_RXW_APPENDED == pgm_rxw_add (window, skb, now, nak_rb_expiry), "add not appended");
+	pmsg = msgv;
+	fail_unless (1000 == pgm_rxw_readv (window, &pmsg, G_N_ELEMENTS(msgv)), "readv failed");
+	fail_unless (1 == msgv[0].msgv_len, "msgv_len failed");
+	fail_unless (skb == msgv[0].msgv_skb[0], "msgv_skb failed");
+	pgm_msgv_borrow (&msgv[0]);
+	pgm_rxw_remove_commit (window);
+	fail_unless (pgm_rxw_is_empty (window), "is_empty failed");
+	fail_unless (1 == pgm_atomic_read32 (&skb->users), "users failed");
+	fail_unless (1000 == skb->len, "len failed");
+	pgm_msgv_release (&msgv[0]);
+	pgm_rxw_destroy (window);
+}
+END_TEST
+
 START_TEST (test_remove_commit_fail_001)
 {
 	pgm_rxw_remove_commit (NULL);
@@ -1127,7 +1828,7 @@ START_TEST (test_remove_trail_pass_001)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	struct pgm_msgv_t msgv[2], *pmsg;
 	fail_unless (0 == pgm_rxw_remove_trail (window), "remove_trail failed");
@@ -1174,7 +1875,7 @@ START_TEST (test_update_pass_001)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	const pgm_time_t now = 1;
 	const pgm_time_t nak_rb_expiry = 2;
@@ -1208,6 +1909,49 @@ START_TEST (test_update_fail_001)
 }
 END_TEST
 
+/* target:
+ *	unsigned
+ *	pgm_rxw_catchup (
+ *		pgm_rxw_t* const	window,
+ *		const uint32_t		first,
+ *		const uint32_t		lead,
+ *		const pgm_time_t	now,
+ *		const pgm_time_t	nak_rb_expiry
+ *		)
+ */
+
+START_TEST (test_catchup_pass_001)
+{
+	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const uint32_t ack_c_p = 500;
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
+	fail_if (NULL == window, "create failed");
+	const pgm_time_t now = 1;
+	const pgm_time_t nak_rb_expiry = 2;
+/* placeholders #90 to #99 */
+	fail_unless (10 == pgm_rxw_catchup (window, 90, 99, now, nak_rb_expiry), "catchup failed");
+	fail_unless (10 == pgm_rxw_length (window), "length failed");
+/* first original data at 100 */
+	struct pgm_sk_buff_t* skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->pgm_data->data_sqn = g_htonl (100);
+	fail_unless (PGM_RXW_APPENDED == pgm_rxw_add (window, skb, now, nak_rb_expiry), "add not appended");
+/* catch-up repair at 90 */
+	skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->pgm_data->data_sqn = g_htonl (90);
+	fail_unless (PGM_RXW_INSERTED == pgm_rxw_add (window, skb, now, nak_rb_expiry), "add not inserted");
+	pgm_rxw_destroy (window);
+}
+END_TEST
+
+START_TEST (test_catchup_fail_001)
+{
+	pgm_rxw_catchup (NULL, 0, 0, 0, 0);
+	fail ("reached");
+}
+END_TEST
+
 /* target:
  *	int
  *	pgm_rxw_confirm (
@@ -1223,7 +1967,7 @@ START_TEST (test_confirm_pass_001)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	const pgm_time_t now = 1;
 	const pgm_time_t nak_rdata_expiry = 2;
@@ -1256,7 +2000,7 @@ START_TEST (test_confirm_pass_002)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	struct pgm_msgv_t msgv[1], *pmsg;
 	struct pgm_sk_buff_t* skb;
@@ -1302,6 +2046,152 @@ START_TEST (test_confirm_pass_002)
 }
 END_TEST
 
+/* single NAK repair times NAK to NCF and NCF to RDATA */
+START_TEST (test_confirm_pass_003)
+{
+	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const uint32_t ack_c_p = 500;
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
+	fail_if (NULL == window, "create failed");
+	const pgm_time_t nak_rdata_expiry = 5000;
+	const pgm_time_t nak_rb_expiry = 5000;
+	struct pgm_sk_buff_t* skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->pgm_data->data_sqn = g_htonl (100);
+	fail_unless (PGM_RXW_APPENDED == pgm_rxw_add (window, skb, 1000, nak_rb_expiry), "add not appended");
+	skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->pgm_data->data_sqn = g_htonl (102);
+	fail_unless (PGM_RXW_MISSING == pgm_rxw_add (window, skb, 1000, nak_rb_expiry), "add not missing");
+/* NAK #101 */
+	struct pgm_sk_buff_t* placeholder = _pgm_rxw_peek (window, 101);
+	fail_if (NULL == placeholder, "peek failed");
+	pgm_rxw_state_t* state = (pgm_rxw_state_t*)&placeholder->cb;
+	pgm_rxw_state (window, placeholder, PGM_PKT_STATE_WAIT_NCF);
+	state->nak_transmit_count++;
+	state->nak_tstamp = 1000;
+	fail_unless (PGM_RXW_UPDATED == pgm_rxw_confirm (window, 101, 1400, nak_rdata_expiry, nak_rb_expiry), "confirm not updated");
+	fail_unless (400 == window->ncf_srtt, "ncf srtt");
+	fail_unless (200 == window->ncf_rttvar, "ncf rttvar");
+/* RDATA #101 */
+	skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->pgm_data->data_sqn = g_htonl (101);
+	skb->wire_tstamp = 2000;
+	fail_unless (PGM_RXW_INSERTED == pgm_rxw_add (window, skb, 2000, nak_rb_expiry), "add not inserted");
+	fail_unless (600 == window->rdata_srtt, "rdata srtt");
+	fail_unless (300 == window->rdata_rttvar, "rdata rttvar");
+	pgm_rxw_destroy (window);
+}
+END_TEST
+
+/* repair timers capped at the delivery deadline */
+START_TEST (test_confirm_pass_004)
+{
+	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const uint32_t ack_c_p = 500;
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
+	fail_if (NULL == window, "create failed");
+	window->delivery_deadline = 300;
+	const pgm_time_t nak_rdata_expiry = 5000;
+	const pgm_time_t nak_rb_expiry = 5000;
+	struct pgm_sk_buff_t* skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->pgm_data->data_sqn = g_htonl (100);
+	fail_unless (PGM_RXW_APPENDED == pgm_rxw_add (window, skb, 1000, nak_rb_expiry), "add not appended");
+	skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->pgm_data->data_sqn = g_htonl (102);
+	fail_unless (PGM_RXW_MISSING == pgm_rxw_add (window, skb, 1000, nak_rb_expiry), "add not missing");
+	struct pgm_sk_buff_t* placeholder = _pgm_rxw_peek (window, 101);
+	fail_if (NULL == placeholder, "peek failed");
+	pgm_rxw_state_t* state = (pgm_rxw_state_t*)&placeholder->cb;
+	fail_unless (1300 == state->timer_expiry, "back-off not capped");
+	fail_unless (FALSE == pgm_rxw_is_overdue (window, placeholder, 1299), "overdue early");
+/* NCF #101 and #103 */
+	fail_unless (PGM_RXW_UPDATED == pgm_rxw_confirm (window, 101, 1200, nak_rdata_expiry, nak_rb_expiry), "confirm not updated");
+	fail_unless (1300 == state->timer_expiry, "wait-data not capped");
+	fail_unless (PGM_RXW_APPENDED == pgm_rxw_confirm (window, 103, 1200, nak_rdata_expiry, nak_rb_expiry), "confirm not appended");
+	struct pgm_sk_buff_t* appended = _pgm_rxw_peek (window, 103);
+	fail_if (NULL == appended, "peek failed");
+	fail_unless (1500 == ((pgm_rxw_state_t*)&appended->cb)->timer_expiry, "appended not capped");
+/* abandoned, later data delivered */
+	fail_unless (TRUE == pgm_rxw_is_overdue (window, placeholder, 1300), "not overdue");
+	pgm_rxw_lost (window, 101);
+	struct pgm_msgv_t msgv[2], *pmsg = msgv;
+	fail_unless (1000 == pgm_rxw_readv (window, &pmsg, G_N_ELEMENTS(msgv)), "readv failed");
+	pgm_rxw_remove_commit (window);
+	pmsg = msgv;
+	fail_unless (-1 == pgm_rxw_readv (window, &pmsg, G_N_ELEMENTS(msgv)), "loss not reported");
+	pmsg = msgv;
+	fail_unless (1000 == pgm_rxw_readv (window, &pmsg, G_N_ELEMENTS(msgv)), "readv failed");
+/* disabled */
+	window->delivery_deadline = 0;
+	fail_unless (FALSE == pgm_rxw_is_overdue (window, appended, 1000000), "overdue disabled");
+	fail_unless (5000 == pgm_rxw_expiry (window, appended, 5000), "expiry disabled");
+	pgm_rxw_destroy (window);
+}
+END_TEST
+
+/* target:
+ *	uint32_t
+ *	pgm_rxw_confirm_range (
+ *		pgm_rxw_t* const	window,
+ *		uint32_t		sequence,
+ *		uint32_t		count,
+ *		const pgm_time_t	now,
+ *		const pgm_time_t	nak_rdata_expiry,
+ *		const pgm_time_t	nak_rb_expiry,
+ *		bool* const		is_appended
+ *	)
+ */
+
+/* received data is skipped, placeholders updated and the lead extended */
+START_TEST (test_confirm_range_pass_001)
+{
+	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const uint32_t ack_c_p = 500;
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
+	fail_if (NULL == window, "create failed");
+	const pgm_time_t nak_rdata_expiry = 5000;
+	const pgm_time_t nak_rb_expiry = 4000;
+	bool is_appended = TRUE;
+/* undefined window */
+	fail_unless (0 == pgm_rxw_confirm_range (window, 100, 4, 1000, nak_rdata_expiry, nak_rb_expiry, &is_appended), "confirm on undefined window");
+	fail_unless (FALSE == is_appended, "appended to undefined window");
+	struct pgm_sk_buff_t* skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->pgm_data->data_sqn = g_htonl (100);
+	fail_unless (PGM_RXW_APPENDED == pgm_rxw_add (window, skb, 1000, nak_rb_expiry), "add not appended");
+	skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->pgm_data->data_sqn = g_htonl (102);
+	fail_unless (PGM_RXW_MISSING == pgm_rxw_add (window, skb, 1000, nak_rb_expiry), "add not missing");
+/* NCF #100-#105: #101 updated, #103-#105 appended */
+	fail_unless (4 == pgm_rxw_confirm_range (window, 100, 6, 1000, nak_rdata_expiry, nak_rb_expiry, &is_appended), "confirm count mismatch");
+	fail_unless (TRUE == is_appended, "not appended");
+	fail_unless (105 == window->lead, "lead mismatch");
+	for (uint32_t sqn = 103; sqn <= 105; sqn++) {
+		struct pgm_sk_buff_t* placeholder = _pgm_rxw_peek (window, sqn);
+		fail_if (NULL == placeholder, "peek failed");
+		fail_unless (PGM_PKT_STATE_WAIT_DATA == ((pgm_rxw_state_t*)&placeholder->cb)->pkt_state, "not wait-data");
+	}
+	struct pgm_sk_buff_t* placeholder = _pgm_rxw_peek (window, 101);
+	fail_unless (PGM_PKT_STATE_WAIT_DATA == ((pgm_rxw_state_t*)&placeholder->cb)->pkt_state, "not wait-data");
+/* repeated NCF refreshes wait-data, #102 is skipped */
+	fail_unless (4 == pgm_rxw_confirm_range (window, 101, 5, 1000, nak_rdata_expiry, nak_rb_expiry, &is_appended), "confirm count mismatch");
+	fail_unless (FALSE == is_appended, "refresh appended");
+/* committed and received sequences are not confirmed */
+	fail_unless (0 == pgm_rxw_confirm_range (window, 90, 11, 1000, nak_rdata_expiry, nak_rb_expiry, &is_appended), "received confirmed");
+/* NCF #108-#109 leaves #106-#107 in back-off */
+	fail_unless (2 == pgm_rxw_confirm_range (window, 108, 2, 1000, nak_rdata_expiry, nak_rb_expiry, &is_appended), "confirm count mismatch");
+	fail_unless (109 == window->lead, "lead mismatch");
+	placeholder = _pgm_rxw_peek (window, 106);
+	fail_unless (PGM_PKT_STATE_BACK_OFF == ((pgm_rxw_state_t*)&placeholder->cb)->pkt_state, "not back-off");
+	pgm_rxw_destroy (window);
+}
+END_TEST
+
 START_TEST (test_confirm_fail_001)
 {
 	int retval = pgm_rxw_confirm (NULL, 0, 0, 0, 0);
@@ -1321,7 +2211,7 @@ START_TEST (test_lost_pass_001)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	const pgm_time_t now = 1;
 	const pgm_time_t nak_rdata_expiry = 2;
@@ -1370,7 +2260,7 @@ START_TEST (test_state_pass_001)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	const pgm_time_t now = 1;
 	const pgm_time_t nak_rdata_expiry = 2;
@@ -1398,7 +2288,7 @@ START_TEST (test_state_fail_002)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	pgm_rxw_state (window, NULL, PGM_PKT_STATE_BACK_OFF);
 	fail ("reached");
@@ -1409,7 +2299,7 @@ START_TEST (test_state_fail_003)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	struct pgm_sk_buff_t* skb = generate_valid_skb ();
 	fail_if (NULL == skb, "generate_valid_skb failed");
@@ -1419,6 +2309,41 @@ START_TEST (test_state_fail_003)
 }
 END_TEST
 
+/* received-data bitmap tracks state across a 64-bit word boundary */
+START_TEST (test_state_pass_002)
+{
+	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const uint32_t ack_c_p = 500;
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
+	fail_if (NULL == window, "create failed");
+	struct pgm_sk_buff_t* skb;
+	const pgm_time_t now = 1;
+	const pgm_time_t nak_rb_expiry = 2;
+	for (unsigned i = 0; i < 70; i++)
+	{
+		if (65 == i) continue;
+		skb = generate_valid_skb ();
+		fail_if (NULL == skb, "generate_valid_skb failed");
+		skb->pgm_data->data_sqn = g_htonl (i);
+		fail_if (PGM_RXW_BOUNDS <= pgm_rxw_add (window, skb, now, nak_rb_expiry), "add failed");
+	}
+	fail_unless (65 == _pgm_rxw_map_run (window, window->data_map, NULL, 0, 70), "map_run failed");
+	fail_unless (4 == _pgm_rxw_map_run (window, window->data_map, NULL, 66, 70), "map_run failed");
+/* fill the gap */
+	skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	skb->pgm_data->data_sqn = g_htonl (65);
+	fail_unless (PGM_RXW_INSERTED == pgm_rxw_add (window, skb, now, nak_rb_expiry), "add not inserted");
+	fail_unless (70 == _pgm_rxw_map_run (window, window->data_map, NULL, 0, 70), "map_run failed");
+/* committed packets clear the bit */
+	struct pgm_msgv_t msgv[10], *pmsg = msgv;
+	fail_unless (10000 == pgm_rxw_readv (window, &pmsg, G_N_ELEMENTS(msgv)), "readv failed");
+	fail_unless (0 == _pgm_rxw_map_run (window, window->data_map, NULL, 0, 70), "map_run failed");
+	fail_unless (60 == _pgm_rxw_map_run (window, window->data_map, NULL, 10, 70), "map_run failed");
+	pgm_rxw_destroy (window);
+}
+END_TEST
+
 /* pgm_peer_has_pending
  */
 
@@ -1426,7 +2351,7 @@ START_TEST (test_has_pending_pass_001)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 /* empty */
 	fail_unless (0 == window->has_event, "unexpected event");
@@ -1486,6 +2411,7 @@ make_basic_test_suite (void)
 	tcase_add_test (tc_create, test_create_pass_002);
 	tcase_add_test (tc_create, test_create_pass_003);
 	tcase_add_test (tc_create, test_create_pass_004);
+	tcase_add_test (tc_create, test_create_pass_005);
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_create, test_create_fail_001, SIGABRT);
 	tcase_add_test_raise_signal (tc_create, test_create_fail_002, SIGABRT);
@@ -1507,12 +2433,25 @@ make_basic_test_suite (void)
 	tcase_add_test (tc_add, test_add_pass_003);
 	tcase_add_test (tc_add, test_add_pass_004);
 	tcase_add_test (tc_add, test_add_pass_005);
+	tcase_add_test (tc_add, test_add_pass_006);
+	tcase_add_test (tc_add, test_add_pass_007);
+	tcase_add_test (tc_add, test_add_pass_008);
+	tcase_add_test (tc_add, test_add_pass_010);
+	tcase_add_test (tc_add, test_add_pass_009);
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_add, test_add_fail_001, SIGABRT);
 	tcase_add_test_raise_signal (tc_add, test_add_fail_002, SIGABRT);
 	tcase_add_test_raise_signal (tc_add, test_add_fail_003, SIGABRT);
 #endif
 
+	TCase* tc_add_repair = tcase_create ("add-repair");
+	suite_add_tcase (s, tc_add_repair);
+	tcase_add_test (tc_add_repair, test_add_repair_pass_001);
+	tcase_add_test (tc_add_repair, test_add_repair_pass_002);
+#ifndef PGM_CHECK_NOFORK
+	tcase_add_test_raise_signal (tc_add_repair, test_add_repair_fail_001, SIGABRT);
+#endif
+
 	TCase* tc_peek = tcase_create ("peek");
 	suite_add_tcase (s, tc_peek);
 	tcase_add_test (tc_peek, test_peek_pass_001);
@@ -1520,9 +2459,18 @@ make_basic_test_suite (void)
 	tcase_add_test_raise_signal (tc_peek, test_peek_fail_001, SIGABRT);
 #endif
 
+	TCase* tc_is_duplicate = tcase_create ("is-duplicate");
+	suite_add_tcase (s, tc_is_duplicate);
+	tcase_add_test (tc_is_duplicate, test_is_duplicate_pass_001);
+
+	TCase* tc_ack_trail = tcase_create ("ack-trail");
+	suite_add_tcase (s, tc_ack_trail);
+	tcase_add_test (tc_ack_trail, test_ack_trail_pass_001);
+
 	TCase* tc_max_length = tcase_create ("max-length");
 	suite_add_tcase (s, tc_max_length);
 	tcase_add_test (tc_max_length, test_max_length_pass_001);
+	tcase_add_test (tc_max_length, test_max_length_pass_002);
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_max_length, test_max_length_fail_001, SIGABRT);
 #endif
@@ -1577,6 +2525,11 @@ make_basic_test_suite (void)
 	tcase_add_test (tc_readv, test_readv_pass_004);
 	tcase_add_test (tc_readv, test_readv_pass_005);
 	tcase_add_test (tc_readv, test_readv_pass_006);
+	tcase_add_test (tc_readv, test_readv_pass_010);
+	tcase_add_test (tc_readv, test_readv_pass_011);
+	tcase_add_test (tc_readv, test_readv_pass_012);
+	tcase_add_test (tc_readv, test_readv_pass_013);
+	tcase_add_test (tc_readv, test_readv_pass_014);
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_readv, test_readv_fail_001, SIGABRT);
 	tcase_add_test_raise_signal (tc_readv, test_readv_fail_002, SIGABRT);
@@ -1586,6 +2539,7 @@ make_basic_test_suite (void)
 	TCase* tc_remove_commit = tcase_create ("remove-commit");
 	suite_add_tcase (s, tc_remove_commit);
 	tcase_add_test (tc_remove_commit, test_remove_commit_pass_001);
+	tcase_add_test (tc_remove_commit, test_remove_commit_pass_002);
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_remove_commit, test_remove_commit_fail_001, SIGABRT);
 #endif
@@ -1598,12 +2552,22 @@ make_basic_test_suite (void)
 	tcase_add_test_raise_signal (tc_update, test_update_fail_001, SIGABRT);
 #endif
 
+	TCase* tc_catchup = tcase_create ("catchup");
+	suite_add_tcase (s, tc_catchup);
+	tcase_add_test (tc_catchup, test_catchup_pass_001);
+#ifndef PGM_CHECK_NOFORK
+	tcase_add_test_raise_signal (tc_catchup, test_catchup_fail_001, SIGABRT);
+#endif
+
         TCase* tc_confirm = tcase_create ("confirm");
 	suite_add_tcase (s, tc_confirm);
 	tcase_add_test (tc_confirm, test_confirm_pass_001);
 	tcase_add_test (tc_confirm, test_confirm_pass_002);
+	tcase_add_test (tc_confirm, test_confirm_pass_003);
+	tcase_add_test (tc_confirm, test_confirm_pass_004);
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_confirm, test_confirm_fail_001, SIGABRT);
+	tcase_add_test (tc_confirm, test_confirm_range_pass_001);
 #endif
 
         TCase* tc_lost = tcase_create ("lost");
@@ -1616,6 +2580,7 @@ make_basic_test_suite (void)
         TCase* tc_state = tcase_create ("state");
 	suite_add_tcase (s, tc_state);
 	tcase_add_test (tc_state, test_state_pass_001);
+	tcase_add_test (tc_state, test_state_pass_002);
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_state, test_state_fail_001, SIGABRT);
 #endif
@@ -1628,7 +2593,7 @@ START_TEST (test_readv_pass_007)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	struct pgm_msgv_t msgv[1], *pmsg;
 	struct pgm_sk_buff_t* skb;
@@ -1701,7 +2666,7 @@ START_TEST (test_readv_pass_008)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	struct pgm_msgv_t msgv[1], *pmsg;
 	struct pgm_sk_buff_t* skb;
@@ -1776,7 +2741,7 @@ START_TEST (test_readv_pass_009)
 {
 	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
 	const uint32_t ack_c_p = 500;
-	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p, NULL);
 	fail_if (NULL == window, "create failed");
 	struct pgm_msgv_t msgv[1], *pmsg;
 	struct pgm_sk_buff_t* skb;
@@ -1866,6 +2831,105 @@ make_best_effort_test_suite (void)
 	return s;
 }
 
+/* performance: modulo against mask indexing */
+
+static unsigned perf_sqns = 0;
+
+static
+void
+mock_setup_modulo (void)
+{
+	perf_sqns = 1000;
+}
+
+static
+void
+mock_setup_pow2 (void)
+{
+	perf_sqns = 1024;
+}
+
+START_TEST (test_perf_add)
+{
+	const unsigned iterations = 100;
+	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const uint32_t ack_c_p = 500;
+	const pgm_time_t now = 1;
+	const pgm_time_t nak_rb_expiry = 2;
+	struct pgm_sk_buff_t** skbs = g_new (struct pgm_sk_buff_t*, perf_sqns);
+	gdouble elapsed = 0.0;
+	for (unsigned i = iterations; i; i--) {
+		pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, perf_sqns, 0, 0, ack_c_p, NULL);
+		fail_if (NULL == window, "create failed");
+		for (uint32_t j = 0; j < perf_sqns; j++) {
+			skbs[j] = generate_valid_skb ();
+			skbs[j]->pgm_data->data_sqn = g_htonl (j);
+		}
+		GTimer* timer = g_timer_new ();
+		for (unsigned j = 0; j < perf_sqns; j++)
+			fail_unless (PGM_RXW_APPENDED == pgm_rxw_add (window, skbs[j], now, nak_rb_expiry), "add not appended");
+		elapsed += g_timer_elapsed (timer, NULL);
+		g_timer_destroy (timer);
+		pgm_rxw_destroy (window);
+	}
+	g_message ("add/%u: elapsed time %.0f us, unit time %.1f ns",
+		perf_sqns,
+		elapsed * 1e6,
+		(elapsed * 1e9) / (iterations * perf_sqns));
+	g_free (skbs);
+}
+END_TEST
+
+START_TEST (test_perf_peek)
+{
+	const unsigned iterations = 1000;
+	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const uint32_t ack_c_p = 500;
+	const pgm_time_t now = 1;
+	const pgm_time_t nak_rb_expiry = 2;
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, perf_sqns, 0, 0, ack_c_p, NULL);
+	fail_if (NULL == window, "create failed");
+	for (uint32_t j = 0; j < perf_sqns; j++) {
+		struct pgm_sk_buff_t* skb = generate_valid_skb ();
+		skb->pgm_data->data_sqn = g_htonl (j);
+		fail_unless (PGM_RXW_APPENDED == pgm_rxw_add (window, skb, now, nak_rb_expiry), "add not appended");
+	}
+	GTimer* timer = g_timer_new ();
+	for (unsigned i = iterations; i; i--)
+		for (uint32_t j = 0; j < perf_sqns; j++)
+			fail_if (NULL == pgm_rxw_peek (window, j), "peek failed");
+	const gdouble elapsed = g_timer_elapsed (timer, NULL);
+	g_message ("peek/%u: elapsed time %.0f us, unit time %.1f ns",
+		perf_sqns,
+		elapsed * 1e6,
+		(elapsed * 1e9) / (iterations * perf_sqns));
+	g_timer_destroy (timer);
+	pgm_rxw_destroy (window);
+}
+END_TEST
+
+static
+Suite*
+make_perf_suite (void)
+{
+	Suite* s;
+
+	s = suite_create ("Window indexing performance");
+
+	TCase* tc_modulo = tcase_create ("modulo");
+	suite_add_tcase (s, tc_modulo);
+	tcase_add_checked_fixture (tc_modulo, mock_setup_modulo, NULL);
+	tcase_add_test (tc_modulo, test_perf_add);
+	tcase_add_test (tc_modulo, test_perf_peek);
+
+	TCase* tc_pow2 = tcase_create ("pow2");
+	suite_add_tcase (s, tc_pow2);
+	tcase_add_checked_fixture (tc_pow2, mock_setup_pow2, NULL);
+	tcase_add_test (tc_pow2, test_perf_add);
+	tcase_add_test (tc_pow2, test_perf_peek);
+	return s;
+}
+
 static
 Suite*
 make_master_suite (void)
@@ -1880,6 +2944,7 @@ main (void)
 	SRunner* sr = srunner_create (make_master_suite ());
 	srunner_add_suite (sr, make_basic_test_suite ());
 	srunner_add_suite (sr, make_best_effort_test_suite ());
+	srunner_add_suite (sr, make_perf_suite ());
 	srunner_run_all (sr, CK_ENV);
 	int number_failed = srunner_ntests_failed (sr);
 	srunner_free (sr);
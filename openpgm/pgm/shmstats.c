@@ -0,0 +1,724 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * publish socket and peer counters to a shared memory segment.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#ifndef _WIN32
+#	include <fcntl.h>
+#	include <pthread.h>
+#	include <unistd.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#else
+#	include <process.h>
+#	define getpid		_getpid
+#endif
+#include <impl/i18n.h>
+#include <impl/framework.h>
+#include <impl/receiver.h>
+#include <impl/socket.h>
+#include <impl/source.h>
+#include <pgm/shmstats.h>
+
+
+//#define SHMSTATS_DEBUG
+
+#define SHMSTATS_NAME_MAX	256
+
+/* A single publisher thread copies the counters of every socket and peer
+ * into the segment once per interval, monitors map the segment read-only and
+ * never touch library state.  Each slot is a sequence lock, a pass rewrites
+ * slots in socket list order so a row may change slot between passes.
+ */
+
+/* counters beyond the cumulative statistics arrays */
+enum {
+	SHMSTATS_SOURCE_BYTES_BUFFERED = PGM_PC_SOURCE_MAX,
+	SHMSTATS_SOURCE_MSGS_BUFFERED,
+	SHMSTATS_SOURCE_MEM_USED,
+	SHMSTATS_SOURCE_MEM_PROCESS_USED,
+	SHMSTATS_SOURCE_MAX
+};
+
+enum {
+	SHMSTATS_RECEIVER_BYTES_DELIVERED = PGM_PC_RECEIVER_MAX,
+	SHMSTATS_RECEIVER_MSGS_DELIVERED,
+	SHMSTATS_RECEIVER_OUTSTANDING_NAKS,
+	SHMSTATS_RECEIVER_NAK_SVC_TIME_MIN,
+	SHMSTATS_RECEIVER_NAK_SVC_TIME_MAX,
+	SHMSTATS_RECEIVER_NAK_FAIL_TIME_MIN,
+	SHMSTATS_RECEIVER_NAK_FAIL_TIME_MAX,
+	SHMSTATS_RECEIVER_MAX
+};
+
+struct shmstats_name_t {
+	unsigned	index;
+	const char*	name;
+};
+
+static const struct shmstats_name_t shmstats_source_names[] = {
+	{ PGM_PC_SOURCE_DATA_BYTES_SENT,			"data_bytes_sent" },
+	{ PGM_PC_SOURCE_DATA_MSGS_SENT,				"data_msgs_sent" },
+	{ PGM_PC_SOURCE_BYTES_SENT,				"bytes_sent" },
+	{ PGM_PC_SOURCE_CKSUM_ERRORS,				"cksum_errors" },
+	{ PGM_PC_SOURCE_MALFORMED_NAKS,				"malformed_naks" },
+	{ PGM_PC_SOURCE_PACKETS_DISCARDED,			"packets_discarded" },
+	{ PGM_PC_SOURCE_PARITY_BYTES_RETRANSMITTED,		"parity_bytes_retransmitted" },
+	{ PGM_PC_SOURCE_SELECTIVE_BYTES_RETRANSMITTED,		"selective_bytes_retransmitted" },
+	{ PGM_PC_SOURCE_PARITY_MSGS_RETRANSMITTED,		"parity_msgs_retransmitted" },
+	{ PGM_PC_SOURCE_SELECTIVE_MSGS_RETRANSMITTED,		"selective_msgs_retransmitted" },
+	{ PGM_PC_SOURCE_PARITY_NAK_PACKETS_RECEIVED,		"parity_nak_packets_received" },
+	{ PGM_PC_SOURCE_SELECTIVE_NAK_PACKETS_RECEIVED,		"selective_nak_packets_received" },
+	{ PGM_PC_SOURCE_PARITY_NAKS_RECEIVED,			"parity_naks_received" },
+	{ PGM_PC_SOURCE_SELECTIVE_NAKS_RECEIVED,		"selective_naks_received" },
+	{ PGM_PC_SOURCE_PARITY_NAKS_IGNORED,			"parity_naks_ignored" },
+	{ PGM_PC_SOURCE_SELECTIVE_NAKS_IGNORED,			"selective_naks_ignored" },
+	{ PGM_PC_SOURCE_ACK_ERRORS,				"ack_errors" },
+	{ PGM_PC_SOURCE_TRANSMISSION_CURRENT_RATE,		"transmission_current_rate" },
+	{ PGM_PC_SOURCE_ACK_PACKETS_RECEIVED,			"ack_packets_received" },
+	{ PGM_PC_SOURCE_PARITY_NNAK_PACKETS_RECEIVED,		"parity_nnak_packets_received" },
+	{ PGM_PC_SOURCE_SELECTIVE_NNAK_PACKETS_RECEIVED,	"selective_nnak_packets_received" },
+	{ PGM_PC_SOURCE_PARITY_NNAKS_RECEIVED,			"parity_nnaks_received" },
+	{ PGM_PC_SOURCE_SELECTIVE_NNAKS_RECEIVED,		"selective_nnaks_received" },
+	{ PGM_PC_SOURCE_NNAK_ERRORS,				"nnak_errors" },
+	{ PGM_PC_SOURCE_RXQ_DROPS,				"rxq_drops" },
+	{ PGM_PC_SOURCE_PEERS_REFUSED,				"peers_refused" },
+	{ PGM_PC_SOURCE_NAKS_RATE_LIMITED,			"naks_rate_limited" },
+	{ PGM_PC_SOURCE_RECEIVERS_DEMOTED,			"receivers_demoted" },
+	{ SHMSTATS_SOURCE_BYTES_BUFFERED,			"bytes_buffered" },
+	{ SHMSTATS_SOURCE_MSGS_BUFFERED,			"msgs_buffered" },
+	{ SHMSTATS_SOURCE_MEM_USED,				"mem_used" },
+	{ SHMSTATS_SOURCE_MEM_PROCESS_USED,			"mem_process_used" }
+};
+
+static const struct shmstats_name_t shmstats_receiver_names[] = {
+	{ PGM_PC_RECEIVER_DATA_BYTES_RECEIVED,			"data_bytes_received" },
+	{ PGM_PC_RECEIVER_DATA_MSGS_RECEIVED,			"data_msgs_received" },
+	{ PGM_PC_RECEIVER_NAK_FAILURES,				"nak_failures" },
+	{ PGM_PC_RECEIVER_BYTES_RECEIVED,			"bytes_received" },
+	{ PGM_PC_RECEIVER_MALFORMED_SPMS,			"malformed_spms" },
+	{ PGM_PC_RECEIVER_MALFORMED_ODATA,			"malformed_odata" },
+	{ PGM_PC_RECEIVER_MALFORMED_RDATA,			"malformed_rdata" },
+	{ PGM_PC_RECEIVER_MALFORMED_NCFS,			"malformed_ncfs" },
+	{ PGM_PC_RECEIVER_PACKETS_DISCARDED,			"packets_discarded" },
+	{ PGM_PC_RECEIVER_LOSSES,				"losses" },
+	{ PGM_PC_RECEIVER_DUP_SPMS,				"dup_spms" },
+	{ PGM_PC_RECEIVER_DUP_DATAS,				"dup_datas" },
+	{ PGM_PC_RECEIVER_PARITY_NAK_PACKETS_SENT,		"parity_nak_packets_sent" },
+	{ PGM_PC_RECEIVER_SELECTIVE_NAK_PACKETS_SENT,		"selective_nak_packets_sent" },
+	{ PGM_PC_RECEIVER_PARITY_NAKS_SENT,			"parity_naks_sent" },
+	{ PGM_PC_RECEIVER_SELECTIVE_NAKS_SENT,			"selective_naks_sent" },
+	{ PGM_PC_RECEIVER_PARITY_NAKS_RETRANSMITTED,		"parity_naks_retransmitted" },
+	{ PGM_PC_RECEIVER_SELECTIVE_NAKS_RETRANSMITTED,		"selective_naks_retransmitted" },
+	{ PGM_PC_RECEIVER_PARITY_NAKS_FAILED,			"parity_naks_failed" },
+	{ PGM_PC_RECEIVER_SELECTIVE_NAKS_FAILED,		"selective_naks_failed" },
+	{ PGM_PC_RECEIVER_NAKS_FAILED_RXW_ADVANCED,		"naks_failed_rxw_advanced" },
+	{ PGM_PC_RECEIVER_NAKS_FAILED_NCF_RETRIES_EXCEEDED,	"naks_failed_ncf_retries_exceeded" },
+	{ PGM_PC_RECEIVER_NAKS_FAILED_DATA_RETRIES_EXCEEDED,	"naks_failed_data_retries_exceeded" },
+	{ PGM_PC_RECEIVER_NAKS_FAILED_GEN_EXPIRED,		"naks_failed_gen_expired" },
+	{ PGM_PC_RECEIVER_NAK_FAILURES_DELIVERED,		"nak_failures_delivered" },
+	{ PGM_PC_RECEIVER_SELECTIVE_NAKS_SUPPRESSED,		"selective_naks_suppressed" },
+	{ PGM_PC_RECEIVER_NAK_ERRORS,				"nak_errors" },
+	{ PGM_PC_RECEIVER_NAK_SVC_TIME_MEAN,			"nak_svc_time_mean" },
+	{ PGM_PC_RECEIVER_NAK_FAIL_TIME_MEAN,			"nak_fail_time_mean" },
+	{ PGM_PC_RECEIVER_TRANSMIT_MEAN,			"transmit_mean" },
+	{ PGM_PC_RECEIVER_ACKS_SENT,				"acks_sent" },
+	{ SHMSTATS_RECEIVER_BYTES_DELIVERED,			"bytes_delivered" },
+	{ SHMSTATS_RECEIVER_MSGS_DELIVERED,			"msgs_delivered" },
+	{ SHMSTATS_RECEIVER_OUTSTANDING_NAKS,			"outstanding_naks" },
+	{ SHMSTATS_RECEIVER_NAK_SVC_TIME_MIN,			"nak_svc_time_min" },
+	{ SHMSTATS_RECEIVER_NAK_SVC_TIME_MAX,			"nak_svc_time_max" },
+	{ SHMSTATS_RECEIVER_NAK_FAIL_TIME_MIN,			"nak_fail_time_min" },
+	{ SHMSTATS_RECEIVER_NAK_FAIL_TIME_MAX,			"nak_fail_time_max" }
+};
+
+static volatile uint32_t		shmstats_ref_count = 0;
+static pgm_shmstats_header_t*		shmstats_header = NULL;
+static size_t				shmstats_size;
+static char				shmstats_name[SHMSTATS_NAME_MAX];
+static pgm_notify_t			shmstats_notify = PGM_NOTIFY_INIT;
+#ifndef _WIN32
+static pthread_t			shmstats_thread;
+static void*				shmstats_routine (void*);
+#else
+static HANDLE				shmstats_mapping = NULL;
+static HANDLE				shmstats_thread;
+static unsigned __stdcall		shmstats_routine (void*);
+#endif
+
+static void shmstats_barrier (void);
+static pgm_shmstats_slot_t* shmstats_slot (pgm_shmstats_header_t*, const unsigned) PGM_GNUC_PURE;
+static const pgm_shmstats_slot_t* shmstats_slot_const (const pgm_shmstats_header_t*, const unsigned) PGM_GNUC_PURE;
+static void shmstats_publish (void);
+static void shmstats_publish_source (pgm_shmstats_slot_t*restrict, const pgm_sock_t*restrict);
+static void shmstats_publish_peer (pgm_shmstats_slot_t*restrict, const pgm_sock_t*restrict, const pgm_peer_t*restrict);
+
+
+/* full fence about slot sequence updates, counters are copied as plain data.
+ */
+
+static inline
+void
+shmstats_barrier (void)
+{
+#if defined( __GNUC__ ) && ( __GNUC__ * 100 + __GNUC_MINOR__ >= 401 )
+	__sync_synchronize();
+#elif defined( __sun )
+	membar_producer();
+	membar_consumer();
+#elif defined( _WIN32 )
+	MemoryBarrier();
+#endif
+}
+
+static inline
+pgm_shmstats_slot_t*
+shmstats_slot (
+	pgm_shmstats_header_t*		header,
+	const unsigned			index
+	)
+{
+	return (pgm_shmstats_slot_t*)((char*)header + header->header_size + ((size_t)index * header->slot_size));
+}
+
+static inline
+const pgm_shmstats_slot_t*
+shmstats_slot_const (
+	const pgm_shmstats_header_t*	header,
+	const unsigned			index
+	)
+{
+	return (const pgm_shmstats_slot_t*)((const char*)header + header->header_size + ((size_t)index * header->slot_size));
+}
+
+/* create the segment and start publishing at every interval microseconds, zero
+ * selects the defaults for slots and interval.  the segment is unlinked by
+ * pgm_shmstats_shutdown().
+ *
+ * on success, returns TRUE, on failure returns FALSE and sets error appropriately.
+ */
+
+bool
+pgm_shmstats_init (
+	const char*		name,
+	unsigned		slots,
+	unsigned		interval,
+	pgm_error_t**		error
+	)
+{
+	pgm_return_val_if_fail (NULL != name, FALSE);
+
+	if (pgm_atomic_exchange_and_add32 (&shmstats_ref_count, 1) > 0)
+		return TRUE;
+
+	if (0 == slots)
+		slots = PGM_SHMSTATS_DEFAULT_SLOTS;
+	if (0 == interval)
+		interval = PGM_SHMSTATS_DEFAULT_INTERVAL;
+	shmstats_size = sizeof(pgm_shmstats_header_t) + ((size_t)slots * sizeof(pgm_shmstats_slot_t));
+	pgm_strncpy_s (shmstats_name, sizeof (shmstats_name), name, _TRUNCATE);
+
+#ifndef _WIN32
+	const int fd = shm_open (name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (-1 == fd) {
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_ENGINE,
+			     pgm_error_from_errno (save_errno),
+			     _("Opening shared memory segment %s: %s"),
+			     name,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		goto err_destroy;
+	}
+	if (-1 == ftruncate (fd, shmstats_size)) {
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_ENGINE,
+			     pgm_error_from_errno (save_errno),
+			     _("Sizing shared memory segment %s: %s"),
+			     name,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		close (fd);
+		goto err_unlink;
+	}
+	void* segment = mmap (NULL, shmstats_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close (fd);
+	if (MAP_FAILED == segment) {
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_ENGINE,
+			     pgm_error_from_errno (save_errno),
+			     _("Mapping shared memory segment %s: %s"),
+			     name,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		goto err_unlink;
+	}
+#else
+	shmstats_mapping = CreateFileMappingA (INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+					       (DWORD)((uint64_t)shmstats_size >> 32), (DWORD)shmstats_size, name);
+	if (NULL == shmstats_mapping) {
+		const DWORD save_errno = GetLastError();
+		char winstr[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_ENGINE,
+			     pgm_error_from_win_errno (save_errno),
+			     _("Creating file mapping %s: %s"),
+			     name,
+			     pgm_win_strerror (winstr, sizeof (winstr), save_errno));
+		goto err_destroy;
+	}
+	void* segment = MapViewOfFile (shmstats_mapping, FILE_MAP_WRITE, 0, 0, shmstats_size);
+	if (NULL == segment) {
+		const DWORD save_errno = GetLastError();
+		char winstr[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_ENGINE,
+			     pgm_error_from_win_errno (save_errno),
+			     _("Mapping view of file %s: %s"),
+			     name,
+			     pgm_win_strerror (winstr, sizeof (winstr), save_errno));
+		goto err_unlink;
+	}
+#endif /* _WIN32 */
+
+	shmstats_header = segment;
+	memset (shmstats_header, 0, shmstats_size);
+	shmstats_header->header_size	= sizeof(pgm_shmstats_header_t);
+	shmstats_header->slot_size	= sizeof(pgm_shmstats_slot_t);
+	shmstats_header->slot_count	= slots;
+	shmstats_header->interval	= interval;
+	shmstats_header->pid		= (uint32_t)getpid();
+	for (unsigned i = 0; i < PGM_N_ELEMENTS(shmstats_source_names); i++)
+		pgm_strncpy_s (shmstats_header->source_names[ shmstats_source_names[ i ].index ], PGM_SHMSTATS_NAMELEN,
+			       shmstats_source_names[ i ].name, _TRUNCATE);
+	for (unsigned i = 0; i < PGM_N_ELEMENTS(shmstats_receiver_names); i++)
+		pgm_strncpy_s (shmstats_header->receiver_names[ shmstats_receiver_names[ i ].index ], PGM_SHMSTATS_NAMELEN,
+			       shmstats_receiver_names[ i ].name, _TRUNCATE);
+	shmstats_header->version	= PGM_SHMSTATS_VERSION;
+/* magic last, a monitor attaching early sees an incomplete segment */
+	shmstats_barrier();
+	shmstats_header->magic		= PGM_SHMSTATS_MAGIC;
+
+/* create notification channel */
+	if (0 != pgm_notify_init (&shmstats_notify)) {
+		const int save_errno = pgm_get_last_sock_error();
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_ENGINE,
+			     pgm_error_from_sock_errno (save_errno),
+			     _("Creating statistics notification channel: %s"),
+			     pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		goto err_unmap;
+	}
+
+/* spawn publisher thread */
+#ifndef _WIN32
+	const int status = pthread_create (&shmstats_thread, NULL, &shmstats_routine, NULL);
+	if (0 != status) {
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_ENGINE,
+			     pgm_error_from_errno (save_errno),
+			     _("Creating statistics thread: %s"),
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		goto err_unmap;
+	}
+#else
+	shmstats_thread = (HANDLE)_beginthreadex (NULL, 0, &shmstats_routine, NULL, 0, NULL);
+	if (0 == shmstats_thread) {
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_ENGINE,
+			     pgm_error_from_errno (save_errno),
+			     _("Creating statistics thread: %s"),
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		goto err_unmap;
+	}
+#endif /* _WIN32 */
+	pgm_minor (_("Statistics segment %s with %u slots every %uus."),
+			name, slots, interval);
+	return TRUE;
+
+err_unmap:
+	if (pgm_notify_is_valid (&shmstats_notify))
+		pgm_notify_destroy (&shmstats_notify);
+#ifndef _WIN32
+	munmap (shmstats_header, shmstats_size);
+#else
+	UnmapViewOfFile (shmstats_header);
+#endif
+	shmstats_header = NULL;
+err_unlink:
+#ifndef _WIN32
+	shm_unlink (name);
+#else
+	CloseHandle (shmstats_mapping);
+	shmstats_mapping = NULL;
+#endif
+err_destroy:
+	pgm_atomic_dec32 (&shmstats_ref_count);
+	return FALSE;
+}
+
+/* stop the publisher and remove the segment, attached monitors keep their
+ * mapping of the final pass.
+ */
+
+bool
+pgm_shmstats_shutdown (void)
+{
+	pgm_return_val_if_fail (pgm_atomic_read32 (&shmstats_ref_count) > 0, FALSE);
+
+	if (pgm_atomic_exchange_and_add32 (&shmstats_ref_count, (uint32_t)-1) != 1)
+		return TRUE;
+
+	pgm_notify_send (&shmstats_notify);
+#ifndef _WIN32
+	pthread_join (shmstats_thread, NULL);
+	munmap (shmstats_header, shmstats_size);
+	shm_unlink (shmstats_name);
+#else
+	WaitForSingleObject (shmstats_thread, INFINITE);
+	CloseHandle (shmstats_thread);
+	UnmapViewOfFile (shmstats_header);
+	CloseHandle (shmstats_mapping);
+	shmstats_mapping = NULL;
+#endif
+	shmstats_header = NULL;
+	pgm_notify_destroy (&shmstats_notify);
+	return TRUE;
+}
+
+static
+#ifndef _WIN32
+void*
+#else
+unsigned
+__stdcall
+#endif
+shmstats_routine (
+	PGM_GNUC_UNUSED	void*	arg
+	)
+{
+	const SOCKET notify_fd = pgm_notify_get_socket (&shmstats_notify);
+	const unsigned interval = shmstats_header->interval;
+
+	pgm_affinity_apply (PGM_THREAD_SHMSTATS);
+
+	for (;;)
+	{
+		shmstats_publish ();
+
+		fd_set readfds;
+		struct timeval tv;
+		FD_ZERO( &readfds );
+		FD_SET( notify_fd, &readfds );
+		tv.tv_sec  = interval / 1000000UL;
+		tv.tv_usec = interval % 1000000UL;
+		const int fds = select (notify_fd + 1, &readfds, NULL, NULL, &tv);
+		if (fds > 0 && FD_ISSET( notify_fd, &readfds ))
+			break;
+	}
+
+#ifndef _WIN32
+	return NULL;
+#else
+	_endthread();
+	return 0;
+#endif /* _WIN32 */
+}
+
+/* one pass over every socket, holding the same read-side sections as the
+ * HTTP and SNMP walks but only once per interval however many monitors read.
+ */
+
+static
+void
+shmstats_publish (void)
+{
+	pgm_shmstats_header_t* header = shmstats_header;
+	const unsigned slot_count = header->slot_count;
+	const unsigned last_len = header->slot_len;
+	unsigned len = 0, truncated = 0;
+
+	pgm_rwlock_reader_lock (&pgm_sock_list_lock);
+	for (pgm_slist_t* list = pgm_sock_list; list; list = list->next)
+	{
+		pgm_sock_t* sock = list->data;
+		if (sock->can_send_data) {
+			if (len < slot_count)
+				shmstats_publish_source (shmstats_slot (header, len++), sock);
+			else
+				truncated++;
+		}
+		if (!sock->can_recv_data)
+			continue;
+		const uint32_t epoch = pgm_peers_read_lock (sock);
+		for (pgm_list_t* peers_list = sock->peers_list;
+		     peers_list;
+		     peers_list = peers_list->next)
+		{
+			if (len < slot_count)
+				shmstats_publish_peer (shmstats_slot (header, len++), sock, peers_list->data);
+			else
+				truncated++;
+		}
+		pgm_peers_read_unlock (sock, epoch);
+	}
+	pgm_rwlock_reader_unlock (&pgm_sock_list_lock);
+
+/* vacate slots of departed rows */
+	for (unsigned i = len; i < last_len; i++) {
+		pgm_shmstats_slot_t* slot = shmstats_slot (header, i);
+		pgm_atomic_inc32 (&slot->sequence);
+		shmstats_barrier();
+		slot->type = PGM_SHMSTATS_SLOT_FREE;
+		shmstats_barrier();
+		pgm_atomic_inc32 (&slot->sequence);
+	}
+	header->slot_len	= len;
+	header->truncated	= truncated;
+	header->publish_time	= pgm_time_update_now();
+	shmstats_barrier();
+	pgm_atomic_inc32 (&header->passes);
+}
+
+static
+void
+shmstats_publish_source (
+	pgm_shmstats_slot_t* restrict	slot,
+	const pgm_sock_t*    restrict	sock
+	)
+{
+	const pgm_txw_t* window = sock->window;
+	uint64_t stats[ PGM_STATS_COUNTERS ];
+
+	pgm_stats_snapshot (sock->cumulative_stats, PGM_STATS_BLOCKS, stats);
+	pgm_atomic_inc32 (&slot->sequence);
+	shmstats_barrier();
+	slot->type		= PGM_SHMSTATS_SLOT_SOURCE;
+	slot->tsi		= sock->tsi;
+	slot->transport_tsi	= sock->tsi;
+	for (unsigned i = 0; i < PGM_PC_SOURCE_MAX; i++)
+		slot->counters[ i ] = stats[ i ];
+	slot->counters[ SHMSTATS_SOURCE_BYTES_BUFFERED ] = window ? pgm_txw_size (window) : 0;
+	slot->counters[ SHMSTATS_SOURCE_MSGS_BUFFERED ]  = window ? pgm_txw_length (window) : 0;
+	slot->counters[ SHMSTATS_SOURCE_MEM_USED ]	 = pgm_budget_used (&sock->budget);
+	slot->counters[ SHMSTATS_SOURCE_MEM_PROCESS_USED ] = pgm_budget_used (&pgm_budget_process);
+	shmstats_barrier();
+	pgm_atomic_inc32 (&slot->sequence);
+}
+
+static
+void
+shmstats_publish_peer (
+	pgm_shmstats_slot_t* restrict	slot,
+	const pgm_sock_t*    restrict	sock,
+	const pgm_peer_t*    restrict	peer
+	)
+{
+	const pgm_rxw_t* window = peer->window;
+	uint64_t stats[ PGM_STATS_COUNTERS ];
+
+	pgm_stats_snapshot (&peer->cumulative_stats, 1, stats);
+	pgm_atomic_inc32 (&slot->sequence);
+	shmstats_barrier();
+	slot->type		= PGM_SHMSTATS_SLOT_RECEIVER;
+	slot->tsi		= peer->tsi;
+	slot->transport_tsi	= sock->tsi;
+	for (unsigned i = 0; i < PGM_PC_RECEIVER_MAX; i++)
+		slot->counters[ i ] = stats[ i ];
+	slot->counters[ PGM_PC_RECEIVER_LOSSES ]		= window->cumulative_losses;
+	slot->counters[ SHMSTATS_RECEIVER_BYTES_DELIVERED ]	= window->bytes_delivered;
+	slot->counters[ SHMSTATS_RECEIVER_MSGS_DELIVERED ]	= window->msgs_delivered;
+	slot->counters[ SHMSTATS_RECEIVER_OUTSTANDING_NAKS ]	= window->nak_backoff_queue.length +
+								  window->wait_ncf_queue.length +
+								  window->wait_data_queue.length;
+	slot->counters[ SHMSTATS_RECEIVER_NAK_SVC_TIME_MIN ]	= window->min_fill_time;
+	slot->counters[ SHMSTATS_RECEIVER_NAK_SVC_TIME_MAX ]	= window->max_fill_time;
+	slot->counters[ SHMSTATS_RECEIVER_NAK_FAIL_TIME_MIN ]	= peer->min_fail_time;
+	slot->counters[ SHMSTATS_RECEIVER_NAK_FAIL_TIME_MAX ]	= peer->max_fail_time;
+	shmstats_barrier();
+	pgm_atomic_inc32 (&slot->sequence);
+}
+
+/* map an existing segment read-only for monitoring, pgm_init() is not required.
+ *
+ * returns the segment header, owned by the caller until pgm_shmstats_detach(),
+ * on failure returns NULL and sets error appropriately.  The mapping is
+ * read-only.
+ */
+
+pgm_shmstats_header_t*
+pgm_shmstats_attach (
+	const char*		name,
+	pgm_error_t**		error
+	)
+{
+	pgm_return_val_if_fail (NULL != name, NULL);
+
+#ifndef _WIN32
+	const int fd = shm_open (name, O_RDONLY, 0);
+	if (-1 == fd) {
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_ENGINE,
+			     pgm_error_from_errno (save_errno),
+			     _("Opening shared memory segment %s: %s"),
+			     name,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		return NULL;
+	}
+	struct stat st;
+	if (-1 == fstat (fd, &st) || st.st_size < (off_t)sizeof(pgm_shmstats_header_t)) {
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_ENGINE,
+			     PGM_ERROR_FAILED,
+			     _("Shared memory segment %s is not a statistics segment."),
+			     name);
+		close (fd);
+		return NULL;
+	}
+	const size_t size = (size_t)st.st_size;
+	void* segment = mmap (NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+	close (fd);
+	if (MAP_FAILED == segment) {
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_ENGINE,
+			     pgm_error_from_errno (save_errno),
+			     _("Mapping shared memory segment %s: %s"),
+			     name,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		return NULL;
+	}
+#else
+	HANDLE mapping = OpenFileMappingA (FILE_MAP_READ, FALSE, name);
+	if (NULL == mapping) {
+		const DWORD save_errno = GetLastError();
+		char winstr[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_ENGINE,
+			     pgm_error_from_win_errno (save_errno),
+			     _("Opening file mapping %s: %s"),
+			     name,
+			     pgm_win_strerror (winstr, sizeof (winstr), save_errno));
+		return NULL;
+	}
+	void* segment = MapViewOfFile (mapping, FILE_MAP_READ, 0, 0, 0);
+/* the view holds a reference to the mapping */
+	CloseHandle (mapping);
+	if (NULL == segment) {
+		const DWORD save_errno = GetLastError();
+		char winstr[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_ENGINE,
+			     pgm_error_from_win_errno (save_errno),
+			     _("Mapping view of file %s: %s"),
+			     name,
+			     pgm_win_strerror (winstr, sizeof (winstr), save_errno));
+		return NULL;
+	}
+	MEMORY_BASIC_INFORMATION info;
+	VirtualQuery (segment, &info, sizeof (info));
+	const size_t size = info.RegionSize;
+#endif /* _WIN32 */
+
+	pgm_shmstats_header_t* header = segment;
+	if (PGM_SHMSTATS_MAGIC != header->magic ||
+	    PGM_SHMSTATS_VERSION != header->version ||
+	    header->header_size < sizeof(pgm_shmstats_header_t) ||
+	    header->slot_size < sizeof(pgm_shmstats_slot_t) ||
+	    size < header->header_size + ((size_t)header->slot_count * header->slot_size))
+	{
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_ENGINE,
+			     PGM_ERROR_FAILED,
+			     _("Shared memory segment %s is not a version %u statistics segment."),
+			     name, PGM_SHMSTATS_VERSION);
+#ifndef _WIN32
+		munmap (segment, size);
+#else
+		UnmapViewOfFile (segment);
+#endif
+		return NULL;
+	}
+	return header;
+}
+
+void
+pgm_shmstats_detach (
+	pgm_shmstats_header_t*		header
+	)
+{
+	pgm_return_if_fail (NULL != header);
+
+#ifndef _WIN32
+	munmap (header, header->header_size + ((size_t)header->slot_count * header->slot_size));
+#else
+	UnmapViewOfFile (header);
+#endif
+}
+
+/* copy a consistent slot, retrying whilst the publisher rewrites it.
+ *
+ * returns TRUE if the slot holds a source or receiver, returns FALSE if the
+ * index is beyond the segment or the slot is vacant.
+ */
+
+bool
+pgm_shmstats_read (
+	const pgm_shmstats_header_t* restrict	header,
+	unsigned				index,
+	pgm_shmstats_slot_t*	     restrict	copy
+	)
+{
+	pgm_return_val_if_fail (NULL != header, FALSE);
+	pgm_return_val_if_fail (NULL != copy, FALSE);
+
+	if (index >= header->slot_count)
+		return FALSE;
+
+	const pgm_shmstats_slot_t* slot = shmstats_slot_const (header, index);
+	uint32_t sequence;
+	do {
+		while ((sequence = pgm_atomic_read32 (&slot->sequence)) & 1)
+			;
+		shmstats_barrier();
+		memcpy (copy, (const void*)slot, sizeof(pgm_shmstats_slot_t));
+		shmstats_barrier();
+	} while (sequence != pgm_atomic_read32 (&slot->sequence));
+
+	return (PGM_SHMSTATS_SLOT_FREE != copy->type);
+}
+
+/* eof */
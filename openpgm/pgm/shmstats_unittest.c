@@ -0,0 +1,288 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * unit tests for shared memory statistics.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <check.h>
+
+#include "impl/framework.h"
+
+#ifdef _WIN32
+#	define PGM_CHECK_NOFORK		1
+#endif
+
+
+/* mock state */
+#define TEST_SEGMENT		"/pgm-shmstats-unittest"
+#define TEST_INTERVAL		(1000)	/* microseconds */
+
+static pgm_rwlock_t	mock_pgm_sock_list_lock;
+static pgm_slist_t*	mock_pgm_sock_list = NULL;
+static pgm_time_t _mock_pgm_time_update_now (void);
+pgm_time_update_func mock_pgm_time_update_now = _mock_pgm_time_update_now;
+
+/* mock functions for external references */
+
+#define pgm_sock_list_lock	mock_pgm_sock_list_lock
+#define pgm_sock_list		mock_pgm_sock_list
+#define pgm_time_update_now	mock_pgm_time_update_now
+#define pgm_peers_read_lock	mock_pgm_peers_read_lock
+#define pgm_peers_read_unlock	mock_pgm_peers_read_unlock
+
+#define SHMSTATS_DEBUG
+#include "shmstats.c"
+
+static
+pgm_time_t
+_mock_pgm_time_update_now (void)
+{
+	return 0x1000;
+}
+
+PGM_GNUC_INTERNAL
+uint32_t
+mock_pgm_peers_read_lock (
+	PGM_GNUC_UNUSED pgm_sock_t*const	sock
+	)
+{
+	return 0;
+}
+
+PGM_GNUC_INTERNAL
+void
+mock_pgm_peers_read_unlock (
+	PGM_GNUC_UNUSED pgm_sock_t*const	sock,
+	PGM_GNUC_UNUSED const uint32_t		epoch
+	)
+{
+}
+
+static
+pgm_sock_t*
+generate_sock (void)
+{
+	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, g_htons(1000) };
+	pgm_sock_t* sock = g_new0 (pgm_sock_t, 1);
+	memcpy (&sock->tsi, &tsi, sizeof(pgm_tsi_t));
+	sock->can_send_data = TRUE;
+/* blocks are summed on publish */
+	pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_BYTES_SENT, 1000);
+	pgm_stats_add (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_BYTES_SENT, 234);
+	return sock;
+}
+
+/* wait for the publisher to complete two passes after the call */
+static
+void
+wait_for_passes (
+	const pgm_shmstats_header_t*	header
+	)
+{
+	const uint32_t passes = pgm_atomic_read32 (&header->passes);
+	while ((uint32_t)(pgm_atomic_read32 (&header->passes) - passes) < 2)
+		g_usleep (TEST_INTERVAL);
+}
+
+/* target:
+ *	bool
+ *	pgm_shmstats_init (
+ *		const char*	name,
+ *		unsigned	slots,
+ *		unsigned	interval,
+ *		pgm_error_t**	error
+ *	)
+ */
+
+START_TEST (test_init_pass_001)
+{
+	pgm_error_t* err = NULL;
+	fail_unless (TRUE == pgm_shmstats_init (TEST_SEGMENT, 0, TEST_INTERVAL, &err), "init failed");
+	fail_unless (NULL == err, "init failed");
+	pgm_shmstats_header_t* header = pgm_shmstats_attach (TEST_SEGMENT, &err);
+	fail_if (NULL == header, "attach failed");
+	fail_unless (PGM_SHMSTATS_MAGIC == header->magic, "magic mismatch");
+	fail_unless (PGM_SHMSTATS_DEFAULT_SLOTS == header->slot_count, "slot count mismatch");
+	fail_unless (TEST_INTERVAL == header->interval, "interval mismatch");
+	fail_unless (0 == strcmp ("bytes_sent", header->source_names[PGM_PC_SOURCE_BYTES_SENT]), "name mismatch");
+	fail_unless (0 == strcmp ("outstanding_naks", header->receiver_names[SHMSTATS_RECEIVER_OUTSTANDING_NAKS]), "name mismatch");
+	for (unsigned i = 0; i < SHMSTATS_SOURCE_MAX; i++)
+		fail_if ('\0' == header->source_names[i][0], "source counter unnamed");
+	for (unsigned i = 0; i < SHMSTATS_RECEIVER_MAX; i++)
+		fail_if ('\0' == header->receiver_names[i][0], "receiver counter unnamed");
+	fail_unless ('\0' == header->source_names[SHMSTATS_SOURCE_MAX][0], "names not terminated");
+	fail_unless ('\0' == header->receiver_names[SHMSTATS_RECEIVER_MAX][0], "names not terminated");
+	pgm_shmstats_detach (header);
+	fail_unless (TRUE == pgm_shmstats_shutdown (), "shutdown failed");
+	fail_unless (FALSE == pgm_shmstats_shutdown (), "shutdown failed");
+}
+END_TEST
+
+START_TEST (test_init_fail_001)
+{
+	fail_unless (FALSE == pgm_shmstats_init (NULL, 0, 0, NULL), "init failed");
+}
+END_TEST
+
+/* target:
+ *	pgm_shmstats_header_t*
+ *	pgm_shmstats_attach (
+ *		const char*	name,
+ *		pgm_error_t**	error
+ *	)
+ */
+
+/* no segment */
+START_TEST (test_attach_fail_001)
+{
+	pgm_error_t* err = NULL;
+	fail_unless (NULL == pgm_shmstats_attach (TEST_SEGMENT, &err), "attach succeeded");
+	fail_if (NULL == err, "error not set");
+	pgm_error_free (err);
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_shmstats_read (
+ *		const pgm_shmstats_header_t*	header,
+ *		unsigned			index,
+ *		pgm_shmstats_slot_t*		copy
+ *	)
+ */
+
+START_TEST (test_read_pass_001)
+{
+	pgm_error_t* err = NULL;
+	pgm_shmstats_slot_t slot;
+	pgm_sock_t* sock = generate_sock ();
+	mock_pgm_sock_list = pgm_slist_append (NULL, sock);
+	fail_unless (TRUE == pgm_shmstats_init (TEST_SEGMENT, 0, TEST_INTERVAL, &err), "init failed");
+	pgm_shmstats_header_t* header = pgm_shmstats_attach (TEST_SEGMENT, &err);
+	fail_if (NULL == header, "attach failed");
+	wait_for_passes (header);
+	fail_unless (1 == header->slot_len, "slot_len mismatch");
+	fail_unless (TRUE == pgm_shmstats_read (header, 0, &slot), "read failed");
+	fail_unless (PGM_SHMSTATS_SLOT_SOURCE == slot.type, "type mismatch");
+	fail_unless (pgm_tsi_equal (&sock->tsi, &slot.tsi), "tsi mismatch");
+	fail_unless (1234 == slot.counters[PGM_PC_SOURCE_BYTES_SENT], "counter mismatch");
+	fail_unless (0 == (slot.sequence & 1), "sequence odd");
+/* departed socket vacates its slot */
+	pgm_slist_free (mock_pgm_sock_list);
+	mock_pgm_sock_list = NULL;
+	wait_for_passes (header);
+	fail_unless (0 == header->slot_len, "slot_len mismatch");
+	fail_unless (FALSE == pgm_shmstats_read (header, 0, &slot), "read succeeded");
+	pgm_shmstats_detach (header);
+	fail_unless (TRUE == pgm_shmstats_shutdown (), "shutdown failed");
+	g_free (sock);
+}
+END_TEST
+
+/* rows beyond the segment are counted */
+START_TEST (test_read_pass_002)
+{
+	pgm_error_t* err = NULL;
+	pgm_shmstats_slot_t slot;
+	pgm_sock_t* sock[3];
+	for (unsigned i = 0; i < G_N_ELEMENTS(sock); i++) {
+		sock[i] = generate_sock ();
+		mock_pgm_sock_list = pgm_slist_append (mock_pgm_sock_list, sock[i]);
+	}
+	fail_unless (TRUE == pgm_shmstats_init (TEST_SEGMENT, 2, TEST_INTERVAL, &err), "init failed");
+	pgm_shmstats_header_t* header = pgm_shmstats_attach (TEST_SEGMENT, &err);
+	fail_if (NULL == header, "attach failed");
+	wait_for_passes (header);
+	fail_unless (2 == header->slot_len, "slot_len mismatch");
+	fail_unless (1 == header->truncated, "truncated mismatch");
+	fail_unless (TRUE == pgm_shmstats_read (header, 1, &slot), "read failed");
+	pgm_shmstats_detach (header);
+	fail_unless (TRUE == pgm_shmstats_shutdown (), "shutdown failed");
+	pgm_slist_free (mock_pgm_sock_list);
+	mock_pgm_sock_list = NULL;
+	for (unsigned i = 0; i < G_N_ELEMENTS(sock); i++)
+		g_free (sock[i]);
+}
+END_TEST
+
+START_TEST (test_read_fail_001)
+{
+	pgm_error_t* err = NULL;
+	pgm_shmstats_slot_t slot;
+	fail_unless (TRUE == pgm_shmstats_init (TEST_SEGMENT, 4, TEST_INTERVAL, &err), "init failed");
+	pgm_shmstats_header_t* header = pgm_shmstats_attach (TEST_SEGMENT, &err);
+	fail_if (NULL == header, "attach failed");
+	fail_unless (FALSE == pgm_shmstats_read (header, 4, &slot), "read succeeded");
+	pgm_shmstats_detach (header);
+	fail_unless (TRUE == pgm_shmstats_shutdown (), "shutdown failed");
+}
+END_TEST
+
+
+static
+Suite*
+make_test_suite (void)
+{
+	Suite* s;
+
+	s = suite_create (__FILE__);
+
+	TCase* tc_init = tcase_create ("init");
+	suite_add_tcase (s, tc_init);
+	tcase_add_test (tc_init, test_init_pass_001);
+	tcase_add_test (tc_init, test_init_fail_001);
+
+	TCase* tc_attach = tcase_create ("attach");
+	suite_add_tcase (s, tc_attach);
+	tcase_add_test (tc_attach, test_attach_fail_001);
+
+	TCase* tc_read = tcase_create ("read");
+	suite_add_tcase (s, tc_read);
+	tcase_add_test (tc_read, test_read_pass_001);
+	tcase_add_test (tc_read, test_read_pass_002);
+	tcase_add_test (tc_read, test_read_fail_001);
+	return s;
+}
+
+static
+Suite*
+make_master_suite (void)
+{
+	Suite* s = suite_create ("Master");
+	return s;
+}
+
+int
+main (void)
+{
+	pgm_messages_init();
+	SRunner* sr = srunner_create (make_master_suite ());
+	srunner_add_suite (sr, make_test_suite ());
+	srunner_run_all (sr, CK_ENV);
+	int number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	pgm_messages_shutdown();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof */
@@ -115,4 +115,501 @@ pgm_skb_is_valid (
 }
 #endif /* SKB_DEBUG */
 
+/* skbuff pool:  fixed size skbuffs carved from bulk allocated slabs and
+ * recycled through a free list such that steady state traffic of a socket
+ * makes no heap calls.  skbuffs may outlive the socket, the pool is released
+ * with the last outstanding skbuff.  Under a page policy each slab fills at least
+ * one page of the policy size.
+ */
+
+#define PGM_SKB_POOL_ALIGN		16
+#define PGM_SKB_POOL_ROUND(x)		(((x) + PGM_SKB_POOL_ALIGN - 1) & ~(size_t)(PGM_SKB_POOL_ALIGN - 1))
+
+/* a single-threaded socket's pools are only touched by its own thread */
+
+static inline
+void
+pgm_skb_pool_lock (
+	pgm_skb_pool_t*const	pool
+	)
+{
+	if (!pool->is_single_threaded)
+		pgm_spinlock_lock (&pool->lock);
+}
+
+static inline
+void
+pgm_skb_pool_unlock (
+	pgm_skb_pool_t*const	pool
+	)
+{
+	if (!pool->is_single_threaded)
+		pgm_spinlock_unlock (&pool->lock);
+}
+
+pgm_skb_pool_t*
+pgm_skb_pool_new (
+	const uint16_t			size,
+	const pgm_mem_policy_t*const	policy		/* NULL = heap */
+	)
+{
+	pgm_skb_pool_t* pool = pgm_new0 (pgm_skb_pool_t, 1);
+	pool->size   = size;
+	pool->stride = PGM_SKB_POOL_ROUND(sizeof(struct pgm_sk_buff_t) + size);
+	pool->slab_len = PGM_SKB_POOL_SLAB_LEN;
+	pool->policy.node = -1;
+	if (NULL != policy) {
+		const size_t page_len = pgm_mem_policy_page_len (policy);
+		pool->policy = *policy;
+		if (page_len > PGM_SKB_POOL_ALIGN + (PGM_SKB_POOL_SLAB_LEN * pool->stride))
+			pool->slab_len = (unsigned)((page_len - PGM_SKB_POOL_ALIGN) / pool->stride);
+	}
+	pgm_spinlock_init (&pool->lock);
+	return pool;
+}
+
+/* fixed pool:  skbuffs carved once from an application region, the region must
+ * remain valid until the pool is released with the last outstanding skbuff.
+ * The region is not charged to a budget, an exhausted pool falls back to the
+ * heap.
+ */
+
+pgm_skb_pool_t*
+pgm_skb_pool_new_fixed (
+	const uint16_t			size,
+	void*const			base,
+	const size_t			len		/* bytes */
+	)
+{
+	pgm_skb_pool_t* pool = pgm_skb_pool_new (size, NULL);
+	pool->is_fixed = TRUE;
+	char* slab = (char*)PGM_SKB_POOL_ROUND((uintptr_t)base);
+	const size_t slab_len = (size_t)((char*)base + len - slab);
+	pool->slab_len = (slab <= (char*)base + len) ? (unsigned)(slab_len / pool->stride) : 0;
+	for (unsigned i = pool->slab_len; i > 0; i--) {
+		struct pgm_sk_buff_t* skb = (struct pgm_sk_buff_t*)(slab + ((i - 1) * pool->stride));
+		skb->link_.next = (void*)pool->free_list;
+		pool->free_list = skb;
+	}
+	return pool;
+}
+
+static
+void
+pgm_skb_pool_free (
+	pgm_skb_pool_t*const	pool
+	)
+{
+	void* slab = pool->slabs;
+	pgm_free_policy (pool->ring);
+	while (slab) {
+		void* next = *(void**)slab;
+		pgm_free_policy (slab);
+		slab = next;
+	}
+	pgm_spinlock_free (&pool->lock);
+	pgm_free (pool);
+}
+
+/* budget charge of the pool: a slab pool charges each outstanding skbuff, a
+ * ring store is resident as a whole.  Heap fallbacks are not charged.  Called
+ * with pool lock held.
+ */
+
+static inline
+uint32_t
+pgm_skb_pool_charge (
+	const pgm_skb_pool_t*const	pool
+	)
+{
+	return NULL != pool->ring ? PGM_BUDGET_UNITS(pool->ring_len) : pool->outstanding * PGM_BUDGET_UNITS(pool->stride);
+}
+
+void
+pgm_skb_pool_set_budget (
+	pgm_skb_pool_t* const restrict	pool,
+	pgm_budget_t* const restrict	budget
+	)
+{
+	pgm_skb_pool_lock (pool);
+	pgm_budget_uncharge (pool->budget, pgm_skb_pool_charge (pool));
+	pool->budget = budget;
+	pgm_budget_charge (pool->budget, pgm_skb_pool_charge (pool));
+	pgm_skb_pool_unlock (pool);
+}
+
+/* skbuffs outstanding after destruction are released from the budget here,
+ * the budget may be freed with its socket.
+ */
+
+void
+pgm_skb_pool_destroy (
+	pgm_skb_pool_t*const	pool
+	)
+{
+	if (NULL == pool)
+		return;
+	pgm_skb_pool_lock (pool);
+	pool->is_destroyed = TRUE;
+	pgm_budget_uncharge (pool->budget, pgm_skb_pool_charge (pool));
+	pool->budget = NULL;
+	const bool is_idle = (0 == pool->outstanding);
+	pgm_skb_pool_unlock (pool);
+	if (is_idle)
+		pgm_skb_pool_free (pool);
+}
+
+/* ring store:  skbuffs carved in sequence from one contiguous region, each
+ * entry a header, the skbuff and its payload.  An entry is trimmed to the bytes
+ * used when added to the transmit window and reclaimed in order, so memory
+ * follows bytes sent rather than packets times max_tpdu.  Out of order release
+ * holds back reclamation, an exhausted ring falls back to the heap.
+ */
+
+struct pgm_skb_ring_entry_t {
+	uint32_t			len;		/* header, skbuff and payload */
+	uint32_t			is_free;
+};
+
+#define PGM_SKB_RING_HEADER		PGM_SKB_POOL_ROUND(sizeof(struct pgm_skb_ring_entry_t))
+#define PGM_SKB_RING_ENTRY(skb)		((struct pgm_skb_ring_entry_t*)((char*)(skb) - PGM_SKB_RING_HEADER))
+
+pgm_skb_pool_t*
+pgm_skb_pool_new_ring (
+	const uint16_t			size,
+	const size_t			ring_len,	/* bytes */
+	const pgm_mem_policy_t*const	policy		/* NULL = heap */
+	)
+{
+	pgm_assert_cmpuint (ring_len, <=, UINT32_MAX);
+
+	pgm_skb_pool_t* pool = pgm_skb_pool_new (size, policy);
+	pool->ring_len = ring_len & ~(size_t)(PGM_SKB_POOL_ALIGN - 1);
+	pool->ring = pgm_malloc0_policy (pool->ring_len, &pool->policy);
+	return pool;
+}
+
+/* called with pool lock held, returns NULL when the ring is exhausted. */
+
+static
+struct pgm_sk_buff_t*
+pgm_skb_ring_alloc (
+	pgm_skb_pool_t*const	pool,
+	const size_t		len
+	)
+{
+	struct pgm_skb_ring_entry_t* entry;
+
+	if (0 == pool->ring_used)
+		pool->ring_head = pool->ring_tail = 0;
+	if (pool->ring_head >= pool->ring_tail && pool->ring_used < pool->ring_len) {
+		if (pool->ring_head == pool->ring_len)
+			pool->ring_head = 0;
+		else if (pool->ring_len - pool->ring_head < len) {
+			if (len > pool->ring_tail)
+				return NULL;
+/* pad to the end of the region, reclaimed with the tail */
+			entry = (struct pgm_skb_ring_entry_t*)(pool->ring + pool->ring_head);
+			entry->len = (uint32_t)(pool->ring_len - pool->ring_head);
+			entry->is_free = 1;
+			pool->ring_used += entry->len;
+			pool->ring_head = 0;
+		}
+	}
+	if (pool->ring_head < pool->ring_tail && pool->ring_tail - pool->ring_head < len)
+		return NULL;
+	if (pool->ring_used + len > pool->ring_len)
+		return NULL;
+	entry = (struct pgm_skb_ring_entry_t*)(pool->ring + pool->ring_head);
+	entry->len = (uint32_t)len;
+	entry->is_free = 0;
+	pool->ring_head += len;
+	pool->ring_used += len;
+	return (struct pgm_sk_buff_t*)((char*)entry + PGM_SKB_RING_HEADER);
+}
+
+/* called with pool lock held */
+
+static
+void
+pgm_skb_ring_release (
+	pgm_skb_pool_t*const		pool,
+	struct pgm_sk_buff_t*const	skb
+	)
+{
+	PGM_SKB_RING_ENTRY(skb)->is_free = 1;
+	while (pool->ring_used) {
+		struct pgm_skb_ring_entry_t* entry = (struct pgm_skb_ring_entry_t*)(pool->ring + pool->ring_tail);
+		if (!entry->is_free)
+			break;
+		pool->ring_used -= entry->len;
+		pool->ring_tail += entry->len;
+		if (pool->ring_tail == pool->ring_len)
+			pool->ring_tail = 0;
+	}
+}
+
+/* shrink the newest ring entry to the bytes up to skb::tail, other skbuffs are
+ * left as allocated.
+ */
+
+void
+pgm_skb_pool_trim (
+	struct pgm_sk_buff_t*const skb
+	)
+{
+	pgm_skb_pool_t* pool = skb->pool;
+	struct pgm_skb_ring_entry_t* entry = PGM_SKB_RING_ENTRY(skb);
+
+	if (NULL == pool || NULL == pool->ring)
+		return;
+	const size_t len = PGM_SKB_RING_HEADER + PGM_SKB_POOL_ROUND((size_t)((char*)skb->tail - (char*)skb));
+	pgm_skb_pool_lock (pool);
+	if ((char*)entry + entry->len == pool->ring + pool->ring_head && len < entry->len) {
+		pool->ring_head -= entry->len - len;
+		pool->ring_used -= entry->len - len;
+		entry->len = (uint32_t)len;
+		skb->end = (char*)entry + len;
+		skb->truesize = (uint32_t)(len - PGM_SKB_RING_HEADER);
+	}
+	pgm_skb_pool_unlock (pool);
+}
+
+/* called with pool lock held */
+
+static
+void
+pgm_skb_pool_grow (
+	pgm_skb_pool_t*const	pool
+	)
+{
+	char* slab = pgm_malloc0_policy (PGM_SKB_POOL_ALIGN + (pool->slab_len * pool->stride), &pool->policy);
+	*(void**)slab = pool->slabs;
+	pool->slabs = slab;
+	for (char* p = slab + PGM_SKB_POOL_ALIGN + ((pool->slab_len - 1) * pool->stride);
+	     p > slab;
+	     p -= pool->stride)
+	{
+		struct pgm_sk_buff_t* skb = (struct pgm_sk_buff_t*)p;
+		skb->link_.next = (void*)pool->free_list;
+		pool->free_list = skb;
+	}
+}
+
+/* as pgm_alloc_skb() counted against a PGM_MEM_SUBSYS_* allocation site.
+ */
+
+struct pgm_sk_buff_t*
+pgm_alloc_skb_subsys (
+	const uint16_t		size,
+	const unsigned		subsys
+	)
+{
+	struct pgm_sk_buff_t* skb;
+
+	skb = pgm_malloc_subsys (size + sizeof(struct pgm_sk_buff_t), PGM_MEM_CLASS_PACKET, subsys);
+	if (PGM_UNLIKELY(pgm_mem_gc_friendly)) {
+		memset (skb, 0, size + sizeof(struct pgm_sk_buff_t));
+		skb->zero_padded = 1;
+	} else {
+		memset (skb, 0, sizeof(struct pgm_sk_buff_t));
+	}
+	skb->truesize = size + sizeof(struct pgm_sk_buff_t);
+	pgm_atomic_write32 (&skb->users, 1);
+	skb->head = skb + 1;
+	skb->data = skb->tail = skb->head;
+	skb->end  = (char*)skb->data + size;
+	return skb;
+}
+
+/* allocate a skbuff of at least size bytes from the pool, falling back to the
+ * heap without a pool or for oversized requests.
+ */
+
+struct pgm_sk_buff_t*
+pgm_skb_pool_alloc (
+	pgm_skb_pool_t*const	pool,
+	const uint16_t		size
+	)
+{
+	return pgm_skb_pool_alloc_subsys (pool, size, PGM_MEM_SUBSYS_SKB);
+}
+
+/* heap fallbacks are counted against subsys.
+ */
+
+struct pgm_sk_buff_t*
+pgm_skb_pool_alloc_subsys (
+	pgm_skb_pool_t*const	pool,
+	const uint16_t		size,
+	const unsigned		subsys
+	)
+{
+	if (PGM_UNLIKELY(NULL == pool || size > pool->size))
+		return pgm_alloc_skb_subsys (size, subsys);
+
+	struct pgm_sk_buff_t* skb;
+	pgm_skb_pool_lock (pool);
+	if (NULL != pool->ring) {
+		skb = pgm_skb_ring_alloc (pool, PGM_SKB_RING_HEADER + pool->stride);
+		if (PGM_UNLIKELY(NULL == skb)) {
+			pgm_skb_pool_unlock (pool);
+			return pgm_alloc_skb_subsys (size, subsys);
+		}
+	} else {
+		if (PGM_UNLIKELY(NULL == pool->free_list)) {
+			if (pool->is_fixed) {
+				pgm_skb_pool_unlock (pool);
+				return pgm_alloc_skb_subsys (size, subsys);
+			}
+			pgm_skb_pool_grow (pool);
+		}
+		skb = pool->free_list;
+		pool->free_list = (struct pgm_sk_buff_t*)skb->link_.next;
+		pgm_budget_charge (pool->budget, PGM_BUDGET_UNITS(pool->stride));
+	}
+	pool->outstanding++;
+	pgm_skb_pool_unlock (pool);
+
+/* as pgm_alloc_skb() */
+	if (PGM_UNLIKELY(pgm_mem_gc_friendly)) {
+		memset (skb, 0, sizeof(struct pgm_sk_buff_t) + pool->size);
+		skb->zero_padded = 1;
+	} else {
+		memset (skb, 0, sizeof(struct pgm_sk_buff_t));
+	}
+	skb->truesize = pool->size + sizeof(struct pgm_sk_buff_t);
+	pgm_atomic_write32 (&skb->users, 1);
+	skb->is_private = pool->is_single_threaded;
+	skb->pool = pool;
+	skb->head = skb + 1;
+	skb->data = skb->tail = skb->head;
+	skb->end  = (char*)skb->data + pool->size;
+	return skb;
+}
+
+/* rebase a pointer into the packet of skb onto copy, stale pointers beyond the
+ * packet are cleared.
+ */
+
+static inline
+void*
+pgm_skb_rebase (
+	struct pgm_sk_buff_t*const	 copy,
+	const struct pgm_sk_buff_t*const skb,
+	const void*			 ptr
+	)
+{
+	if ((const char*)ptr < (const char*)skb->head || (const char*)ptr > (const char*)skb->tail)
+		return NULL;
+	return (char*)copy->head + ((const char*)ptr - (const char*)skb->head);
+}
+
+/* copy a parsed packet into a smaller skbuff from pool, preserving metadata and
+ * header pointers, such that the original buffer can be recycled.
+ */
+
+struct pgm_sk_buff_t*
+pgm_skb_pool_copy (
+	pgm_skb_pool_t*const		 pool,
+	const struct pgm_sk_buff_t*const skb
+	)
+{
+	const size_t len = (const char*)skb->tail - (const char*)skb->head;
+
+/* pre-conditions */
+	pgm_assert (NULL != pool);
+	pgm_assert (NULL != skb);
+	pgm_assert_cmpuint (len, <=, pool->size);
+
+	struct pgm_sk_buff_t* copy = pgm_skb_pool_alloc (pool, pool->size);
+	const ptrdiff_t offset = (char*)copy->head - (char*)skb->head;
+	memcpy (copy->head, skb->head, len);
+	copy->sock		= skb->sock;
+	copy->tstamp		= skb->tstamp;
+	copy->wire_tstamp	= skb->wire_tstamp;
+	copy->tsi		= skb->tsi;
+	copy->sequence		= skb->sequence;
+	memcpy (copy->cb, skb->cb, sizeof(skb->cb));
+	copy->len		= skb->len;
+	copy->csum_unnecessary	= skb->csum_unnecessary;
+	copy->csum_deferred	= skb->csum_deferred;
+	copy->is_batch		= skb->is_batch;
+	copy->pgm_header	= pgm_skb_rebase (copy, skb, skb->pgm_header);
+	copy->pgm_opt_fragment	= pgm_skb_rebase (copy, skb, skb->pgm_opt_fragment);
+	copy->pgm_opt_pgmcc_data = pgm_skb_rebase (copy, skb, skb->pgm_opt_pgmcc_data);
+	copy->pgm_opt_compress	= pgm_skb_rebase (copy, skb, skb->pgm_opt_compress);
+	copy->pgm_opt_conflate	= pgm_skb_rebase (copy, skb, skb->pgm_opt_conflate);
+	copy->pgm_data		= pgm_skb_rebase (copy, skb, skb->pgm_data);
+	copy->data		= (char*)skb->data + offset;
+	copy->tail		= (char*)skb->tail + offset;
+	return copy;
+}
+
+/* return skbuff to owning pool on last reference, see pgm_free_skb().
+ */
+
+void
+pgm_skb_pool_release (
+	struct pgm_sk_buff_t*const skb
+	)
+{
+	pgm_skb_pool_t* pool = skb->pool;
+	pgm_skb_pool_lock (pool);
+	if (NULL != pool->ring)
+		pgm_skb_ring_release (pool, skb);
+	else {
+		skb->link_.next = (void*)pool->free_list;
+		pool->free_list = skb;
+		pgm_budget_uncharge (pool->budget, PGM_BUDGET_UNITS(pool->stride));
+	}
+	const bool is_last = (0 == --pool->outstanding && pool->is_destroyed);
+	pgm_skb_pool_unlock (pool);
+	if (PGM_UNLIKELY(is_last))
+		pgm_skb_pool_free (pool);
+}
+
+/* release a chain of skbuffs without references from pgm_free_skb_deferred(),
+ * each run of skbuffs of one pool is returned under one lock with a single
+ * budget update.
+ */
+
+void
+pgm_skb_pool_release_list (
+	struct pgm_sk_buff_t*	skb
+	)
+{
+	while (NULL != skb) {
+		pgm_skb_pool_t* pool = skb->pool;
+		struct pgm_sk_buff_t* next = (struct pgm_sk_buff_t*)skb->link_.next;
+		if (NULL == pool) {
+			pgm_free (skb);
+			skb = next;
+			continue;
+		}
+		struct pgm_sk_buff_t* last = skb;
+		unsigned count = 1;
+		while (NULL != next && next->pool == pool) {
+			last = next;
+			next = (struct pgm_sk_buff_t*)next->link_.next;
+			count++;
+		}
+		pgm_skb_pool_lock (pool);
+		if (NULL != pool->ring) {
+			for (struct pgm_sk_buff_t* p = skb; p != next; p = (struct pgm_sk_buff_t*)p->link_.next)
+				pgm_skb_ring_release (pool, p);
+		} else {
+			last->link_.next = (void*)pool->free_list;
+			pool->free_list = skb;
+			pgm_budget_uncharge (pool->budget, count * PGM_BUDGET_UNITS(pool->stride));
+		}
+		pool->outstanding -= count;
+		const bool is_last = (0 == pool->outstanding && pool->is_destroyed);
+		pgm_skb_pool_unlock (pool);
+		if (PGM_UNLIKELY(is_last))
+			pgm_skb_pool_free (pool);
+		skb = next;
+	}
+}
+
 /* eof */
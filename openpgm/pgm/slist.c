@@ -37,7 +37,7 @@ pgm_slist_append (
 	pgm_slist_t* new_list;
 	pgm_slist_t* last;
 
-	new_list = pgm_new (pgm_slist_t, 1);
+	new_list = pgm_new_subsys (pgm_slist_t, 1, PGM_MEM_SUBSYS_LIST);
 	new_list->data = data;
 	new_list->next = NULL;
 
@@ -60,7 +60,7 @@ pgm_slist_prepend (
 {
 	pgm_slist_t *new_list;
 
-	new_list = pgm_new (pgm_slist_t, 1);
+	new_list = pgm_new_subsys (pgm_slist_t, 1, PGM_MEM_SUBSYS_LIST);
 	new_list->data = data;
 	new_list->next = list;
 
@@ -174,6 +174,7 @@ pgm_snmp_shutdown (void)
 	CloseHandle (snmp_thread);
 #endif
 	pgm_notify_destroy (&snmp_notify);
+	pgm_mib_shutdown ();
 	snmp_shutdown (pgm_snmp_appname);
 	return TRUE;
 }
@@ -194,6 +195,8 @@ snmp_routine (
 {
 	const SOCKET notify_fd = pgm_notify_get_socket (&snmp_notify);
 
+	pgm_affinity_apply (PGM_THREAD_SNMP);
+
 	for (;;)
 	{
 		int fds = 0, block = 1;
@@ -599,6 +599,111 @@ pgm_sockaddr_tos (
 	return retval;
 }
 
+/* Don't fragment: PGM_PMTUD_DISABLED permits fragmentation, PGM_PMTUD_INTERFACE
+ * sets DF and refuses datagrams above the path MTU learnt by the kernel,
+ * PGM_PMTUD_PROBE sets DF ignoring the learnt path MTU.  Platforms without
+ * path MTU discovery only set DF.
+ *
+ * If no error occurs, pgm_sockaddr_pmtudisc returns zero.  Otherwise, a value
+ * of SOCKET_ERROR is returned, and a specific error code can be retrieved by
+ * calling pgm_get_last_sock_error().
+ */
+
+PGM_GNUC_INTERNAL
+int
+pgm_sockaddr_pmtudisc (
+	const SOCKET		s,
+	const sa_family_t	sa_family,
+	const int		mode
+	)
+{
+	int retval = SOCKET_ERROR;
+
+	switch (sa_family) {
+	case AF_INET: {
+#if defined(IP_MTU_DISCOVER)
+/* Linux:ip(7) "IP_MTU_DISCOVER ... Argument is an integer."
+ */
+		const int optval = (PGM_PMTUD_PROBE == mode) ? IP_PMTUDISC_PROBE :
+				   (PGM_PMTUD_INTERFACE == mode) ? IP_PMTUDISC_DO : IP_PMTUDISC_DONT;
+		retval = setsockopt (s, IPPROTO_IP, IP_MTU_DISCOVER, (const char*)&optval, sizeof(optval));
+#elif defined(IP_DONTFRAG)
+/* FreeBSD,OS X:IP(4) "IP_DONTFRAG ... int"
+ */
+		const int optval = (PGM_PMTUD_DISABLED != mode);
+		retval = setsockopt (s, IPPROTO_IP, IP_DONTFRAG, (const char*)&optval, sizeof(optval));
+#elif defined(IP_DONTFRAGMENT)
+/* WinSock2:MSDN(IPPROTO_IP Socket Options) "DWORD (boolean)"
+ */
+		const DWORD optval = (PGM_PMTUD_DISABLED != mode);
+		retval = setsockopt (s, IPPROTO_IP, IP_DONTFRAGMENT, (const char*)&optval, sizeof(optval));
+#endif
+		break;
+	}
+
+	case AF_INET6: {
+#if defined(IPV6_MTU_DISCOVER)
+/* Linux:ipv6(7) "IPV6_MTU_DISCOVER ... same as IP_MTU_DISCOVER"
+ */
+		const int optval = (PGM_PMTUD_PROBE == mode) ? IPV6_PMTUDISC_PROBE :
+				   (PGM_PMTUD_INTERFACE == mode) ? IPV6_PMTUDISC_DO : IPV6_PMTUDISC_DONT;
+		retval = setsockopt (s, IPPROTO_IPV6, IPV6_MTU_DISCOVER, (const char*)&optval, sizeof(optval));
+#elif defined(IPV6_DONTFRAG)
+/* RFC 3542 "IPV6_DONTFRAG ... int"
+ */
+		const int optval = (PGM_PMTUD_DISABLED != mode);
+		retval = setsockopt (s, IPPROTO_IPV6, IPV6_DONTFRAG, (const char*)&optval, sizeof(optval));
+#endif
+		break;
+	}
+
+	default: break;
+	}
+	return retval;
+}
+
+/* Path MTU towards the destination of a connected socket as learnt by the
+ * kernel, otherwise the MTU of the route.
+ *
+ * On success, returns the MTU.  Otherwise, a value of SOCKET_ERROR is returned,
+ * and a specific error code can be retrieved by calling pgm_get_last_sock_error().
+ */
+
+PGM_GNUC_INTERNAL
+int
+pgm_sockaddr_path_mtu (
+	const SOCKET		s,
+	const sa_family_t	sa_family
+	)
+{
+	int retval = SOCKET_ERROR;
+	int optval = 0;
+	socklen_t optlen = sizeof (optval);
+
+	switch (sa_family) {
+	case AF_INET:
+#ifdef IP_MTU
+/* Linux:ip(7) "IP_MTU ... Retrieve the current known path MTU of the current
+ * socket.  Valid only when the socket has been connected."
+ */
+		if (0 == getsockopt (s, IPPROTO_IP, IP_MTU, (char*)&optval, &optlen))
+			retval = optval;
+#endif
+		break;
+
+	case AF_INET6:
+#ifdef IPV6_MTU
+		if (0 == getsockopt (s, IPPROTO_IPV6, IPV6_MTU, (char*)&optval, &optlen))
+			retval = optval;
+#endif
+		break;
+
+	default: break;
+	}
+	(void)optlen;
+	return retval;
+}
+
 /* Join multicast group.
  * NB: IPV6_JOIN_GROUP == IPV6_ADD_MEMBERSHIP
  *
@@ -1164,6 +1269,49 @@ pgm_sockaddr_multicast_loop (
 	return retval;
 }
 
+/* Specify whether the socket receives every multicast group joined on the host
+ * for its bound address and port, or only groups joined on this socket.
+ *
+ * Linux:ip(7) "IP_MULTICAST_ALL ... Argument is an integer boolean."
+ *
+ * If no error occurs, pgm_sockaddr_multicast_all returns zero.  Otherwise, a
+ * value of SOCKET_ERROR is returned, and a specific error code can be
+ * retrieved by calling pgm_get_last_sock_error().
+ */
+
+PGM_GNUC_INTERNAL
+int
+pgm_sockaddr_multicast_all (
+	const SOCKET		s,
+	const sa_family_t	sa_family,
+	const bool		v
+	)
+{
+	int retval = SOCKET_ERROR;
+	const int optval = v ? 1 : 0;
+
+	switch (sa_family) {
+	case AF_INET:
+#ifdef IP_MULTICAST_ALL
+		retval = setsockopt (s, IPPROTO_IP, IP_MULTICAST_ALL, (const char*)&optval, sizeof(optval));
+#else
+		pgm_set_last_sock_error (PGM_SOCK_EINVAL);
+#endif
+		break;
+
+	case AF_INET6:
+#ifdef IPV6_MULTICAST_ALL
+		retval = setsockopt (s, IPPROTO_IPV6, IPV6_MULTICAST_ALL, (const char*)&optval, sizeof(optval));
+#else
+		pgm_set_last_sock_error (PGM_SOCK_EINVAL);
+#endif
+		break;
+
+	default: break;
+	}
+	return retval;
+}
+
 /* Specify TTL or outgoing hop limit.
  * NB: Only affects multicast hops, unicast hop-limit is not changed.
  *
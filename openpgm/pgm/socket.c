@@ -30,9 +30,33 @@
 #ifdef HAVE_EPOLL_CTL
 #	include <sys/epoll.h>
 #endif
+#ifdef HAVE_KQUEUE
+#	include <sys/types.h>
+#	include <sys/event.h>
+#	include <sys/time.h>
+#endif
+#ifndef _WIN32
+#	include <netinet/udp.h>
+#	include <sys/ioctl.h>
+#endif
+#ifdef HAVE_SYS_TIMERFD_H
+#	include <sys/timerfd.h>
+#endif
+#ifdef HAVE_LINUX_NET_TSTAMP_H
+#	include <linux/net_tstamp.h>
+#endif
+#ifdef __linux__
+#	include <unistd.h>
+#	include <sys/ioctl.h>
+#	include <sys/syscall.h>
+#	include <linux/sockios.h>
+#	include <linux/sock_diag.h>
+#endif
 #include <stdio.h>
 #include <impl/i18n.h>
 #include <impl/framework.h>
+#include <impl/mem.h>
+#include <impl/net.h>
 #include <impl/socket.h>
 #include <impl/receiver.h>
 #include <impl/source.h>
@@ -42,14 +66,47 @@
 #define SOCK_DEBUG
 //#define SOCK_SPM_DEBUG
 
+/* sockets capable of Registered I/O where the SDK provides it */
+#ifdef PGM_HAVE_RIO
+#	define transport_socket	pgm_rio_socket
+#else
+#	define transport_socket	socket
+#endif
+
 
 /* global locals */
 pgm_rwlock_t pgm_sock_list_lock;		/* list of all sockets for admin interfaces */
 pgm_slist_t* pgm_sock_list = NULL;
 
+/* sending and receiving thread state on separate cache lines */
+#if defined(__GNUC__) || defined(_MSC_VER)
+PGM_STATIC_ASSERT(0 == offsetof(struct pgm_sock_t, lock) % PGM_CACHELINE_SIZE);
+PGM_STATIC_ASSERT(0 == offsetof(struct pgm_sock_t, source_mutex) % PGM_CACHELINE_SIZE);
+PGM_STATIC_ASSERT(0 == offsetof(struct pgm_sock_t, receiver_mutex) % PGM_CACHELINE_SIZE);
+PGM_STATIC_ASSERT(0 == offsetof(struct pgm_sock_t, timer_mutex) % PGM_CACHELINE_SIZE);
+PGM_STATIC_ASSERT(0 == offsetof(struct pgm_sock_t, cumulative_stats) % PGM_CACHELINE_SIZE);
+PGM_STATIC_ASSERT(offsetof(struct pgm_sock_t, lock) + sizeof(pgm_rwlock_t) <= offsetof(struct pgm_sock_t, source_mutex));
+#endif
+
 
 static const char* pgm_sock_type_string (const int) PGM_GNUC_CONST;
 static const char* pgm_protocol_string (const int) PGM_GNUC_CONST;
+static bool open_recv_sockets (pgm_sock_t*const, const unsigned);
+static SOCKET recv_sock_for_group (const pgm_sock_t*const, const struct sockaddr*const);
+static bool recv_gsr_reserve (pgm_sock_t*const, const unsigned);
+static bool join_source_groups (pgm_sock_t*const, const struct group_source_req*const, const unsigned);
+static inline uint32_t stream_weight (const pgm_sock_t*const);
+static bool stream_join (pgm_sock_t*const, pgm_error_t**);
+static bool stream_leave (pgm_sock_t*const);
+static void stream_share (struct pgm_stream_group_t*const);
+static bool open_send_paths (pgm_sock_t*const, pgm_error_t**);
+static bool open_send_ports (pgm_sock_t*const, const struct sockaddr*const, pgm_error_t**);
+#if defined(HAVE_LINUX_NET_TSTAMP_H) && defined(SO_TIMESTAMPING)
+static int set_timestamping (const SOCKET, const unsigned);
+#endif
+#if defined(HAVE_LINUX_ERRQUEUE_H) && defined(HAVE_LINUX_NET_TSTAMP_H) && defined(SO_TIMESTAMPING)
+static int set_tx_timestamping (const SOCKET, const unsigned);
+#endif
 
 
 size_t
@@ -211,8 +268,7 @@ CLEANUP:
  * 1) pgm_sock_t::lock
  * 2) pgm_sock_t::receiver_mutex
  * 3) pgm_sock_t::source_mutex
- * 4) pgm_sock_t::txw_spinlock
- * 5) pgm_sock_t::timer_mutex
+ * 4) pgm_sock_t::timer_mutex
  *
  * If application calls a function on the sock after destroy() it is a
  * programmer error: segv likely to occur on unlock.
@@ -241,23 +297,39 @@ pgm_close (
 		closesocket (sock->recv_sock);
 		sock->recv_sock = INVALID_SOCKET;
 	}
-	if (INVALID_SOCKET != sock->send_sock) {
+	for (unsigned i = 0; i < sock->recv_sock_extra_len; i++)
+		closesocket (sock->recv_sock_extra[i]);
+	sock->recv_sock_extra_len = 0;
+/* shared send sockets of a multi-stream source are closed by the last member */
+	if (INVALID_SOCKET != sock->send_sock && NULL == sock->stream_group) {
 		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Closing send socket."));
 		closesocket (sock->send_sock);
 		sock->send_sock = INVALID_SOCKET;
 	}
+	for (unsigned i = 0; i < sock->send_path_len; i++)
+		closesocket (sock->send_path_sock[i]);
+	sock->send_path_len = 0;
+	for (unsigned i = 0; i < sock->send_port_len; i++)
+		closesocket (sock->send_port_sock[i]);
+	sock->send_port_len = 0;
 	pgm_rwlock_reader_unlock (&sock->lock);
 	pgm_debug ("blocking on destroy lock ...");
 	pgm_rwlock_writer_lock (&sock->lock);
 
+	if (sock->timer_thread || sock->timer_pool_sock) {
+		pgm_debug ("stopping timer thread.");
+		pgm_timer_thread_stop (sock);
+	}
+
 	pgm_debug ("removing sock from inventory.");
 	pgm_rwlock_writer_lock (&pgm_sock_list_lock);
 	pgm_sock_list = pgm_slist_remove (pgm_sock_list, sock);
 	pgm_rwlock_writer_unlock (&pgm_sock_list_lock);
 
-/* flush source side by sending heartbeat SPMs */
+/* flush source side by sending heartbeat SPMs, a standby never sent */
 	if (sock->can_send_data &&
-	    sock->is_connected && 
+	    sock->is_connected &&
+	    !sock->is_standby &&
 	    flush)
 	{
 		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Flushing PGM source with session finish option broadcast SPMs."));
@@ -269,9 +341,17 @@ pgm_close (
 		}
 	}
 
+/* windows reference decoder jobs until the decoder is gone */
+	if (sock->rx_decoder) {
+		pgm_debug ("stopping FEC decoder threads.");
+		for (pgm_list_t* list = sock->peers_list; NULL != list; list = list->next)
+			((pgm_peer_t*)list->data)->window->decoder = NULL;
+		pgm_rxw_decoder_destroy (sock->rx_decoder);
+		sock->rx_decoder = NULL;
+	}
 	if (sock->peers_hashtable) {
 		pgm_debug ("destroying peer lookup table.");
-		pgm_hashtable_destroy (sock->peers_hashtable);
+		pgm_peertable_destroy (sock->peers_hashtable);
 		sock->peers_hashtable = NULL;
 	}
 	if (sock->peers_list) {
@@ -283,14 +363,87 @@ pgm_close (
 			sock->peers_list = next;
 		} while (sock->peers_list);
 	}
+/* no monitoring reader remains once the sock is off pgm_sock_list */
+	pgm_peers_reclaim_all (sock);
+	if (sock->peers_heap) {
+		pgm_free (sock->peers_heap);
+		sock->peers_heap = NULL;
+		sock->peers_heap_len = sock->peers_heap_alloc = 0;
+	}
+	if (sock->merge_heap) {
+		pgm_free (sock->merge_heap);
+		sock->merge_heap = NULL;
+		sock->merge_heap_alloc = 0;
+	}
+	if (sock->nak_batch) {
+		pgm_free (sock->nak_batch);
+		sock->nak_batch = NULL;
+	}
 
+/* release references held by a blocked batch send */
+	while (sock->pkt_dontwait_state.skbv_offset < sock->pkt_dontwait_state.skbv_len)
+		pgm_free_skb (sock->pkt_dontwait_state.skbv[ sock->pkt_dontwait_state.skbv_offset++ ]);
+/* release references awaiting zero-copy completion */
+	if (sock->zc_skb) {
+		for (unsigned i = 0; i < PGM_ZEROCOPY_MAX_PENDING; i++)
+			if (sock->zc_skb[i])
+				pgm_free_skb (sock->zc_skb[i]);
+		pgm_free (sock->zc_skb);
+		sock->zc_skb = NULL;
+	}
+	if (sock->tx_tstamp_buf) {
+		pgm_free (sock->tx_tstamp_buf);
+		sock->tx_tstamp_buf = NULL;
+	}
 	if (sock->window) {
 		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Destroying transmit window."));
 		pgm_txw_shutdown (sock->window);
 		sock->window = NULL;
 	}
+	if (sock->txw_store) {
+		pgm_txw_store_close (sock->txw_store);
+		sock->txw_store = NULL;
+	}
+	if (sock->rx_shm) {
+		pgm_txw_store_close (sock->rx_shm);
+		sock->rx_shm = NULL;
+	}
+/* after the peers, which point into the segment */
+	if (sock->restart) {
+		pgm_restart_close (sock->restart);
+		sock->restart = NULL;
+	}
+	if (sock->local) {
+		pgm_local_destroy (sock->local);
+		sock->local = NULL;
+	}
+	if (sock->standby) {
+		pgm_txw_store_close (sock->standby);
+		sock->standby = NULL;
+	}
+	if (INVALID_SOCKET != sock->timer_fd) {
+		closesocket (sock->timer_fd);
+		sock->timer_fd = INVALID_SOCKET;
+	}
+#ifdef HAVE_KQUEUE
+/* the timer is identified by the socket, remove before the identity is reused */
+	if (INVALID_SOCKET != sock->timer_kq) {
+		struct kevent kev;
+		EV_SET(&kev, (uintptr_t)sock, EVFILT_TIMER, EV_DELETE, 0, 0, NULL);
+		kevent (sock->timer_kq, &kev, 1, NULL, 0, NULL);
+		sock->timer_kq = INVALID_SOCKET;
+	}
+#endif
 	pgm_trace (PGM_LOG_ROLE_RATE_CONTROL,_("Destroying rate control."));
 	pgm_rate_destroy (&sock->rate_control);
+	if (NULL != sock->stream_group) {
+		if (stream_leave (sock)) {
+			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Closing send socket of stream group."));
+			closesocket (sock->send_sock);
+		} else
+			sock->send_with_router_alert_sock = INVALID_SOCKET;
+		sock->send_sock = INVALID_SOCKET;
+	}
 	if (INVALID_SOCKET != sock->send_with_router_alert_sock) {
 		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Closing send with router alert socket."));
 		closesocket (sock->send_with_router_alert_sock);
@@ -306,29 +459,336 @@ pgm_close (
 		pgm_free_skb (sock->rx_buffer);
 		sock->rx_buffer = NULL;
 	}
+	if (sock->rx_batch) {
+		pgm_debug ("freeing batched receive buffers.");
+		for (unsigned i = 0; i < sock->rx_batch_len; i++)
+			pgm_free_skb (sock->rx_batch->skb[i]);
+		pgm_free (sock->rx_batch);
+		sock->rx_batch = NULL;
+	}
+	if (sock->rx_gro) {
+		pgm_free (sock->rx_gro);
+		sock->rx_gro = NULL;
+	}
+#ifdef HAVE_LINUX_IO_URING_H
+	if (sock->rx_uring) {
+		pgm_recv_uring_destroy (sock->rx_uring);
+		sock->rx_uring = NULL;
+	}
+#endif
+#ifdef PGM_HAVE_RIO
+	if (sock->rio) {
+		pgm_rio_destroy (sock->rio);
+		sock->rio = NULL;
+	}
+#endif
+#ifdef HAVE_LINUX_IF_XDP_H
+	if (sock->rx_xdp) {
+		pgm_recv_xdp_destroy (sock->rx_xdp);
+		sock->rx_xdp = NULL;
+	}
+#endif
+#ifdef HAVE_INFINIBAND_VERBS_H
+	if (sock->verbs) {
+		pgm_verbs_destroy (sock->verbs);
+		sock->verbs = NULL;
+	}
+#endif
+#ifdef HAVE_RTE_ETHDEV_H
+	if (sock->dpdk) {
+		pgm_dpdk_destroy (sock->dpdk);
+		sock->dpdk = NULL;
+	}
+#endif
+#ifdef HAVE_LINUX_IF_PACKET_H
+	if (sock->rx_tpacket) {
+		pgm_recv_tpacket_destroy (sock->rx_tpacket);
+		sock->rx_tpacket = NULL;
+	}
+#endif
+	if (sock->capture) {
+		pgm_capture_destroy (sock->capture);
+		sock->capture = NULL;
+	}
+	if (sock->recorder) {
+		pgm_recorder_destroy (sock->recorder);
+		sock->recorder = NULL;
+	}
+	if (sock->rx_impair) {
+		pgm_impair_destroy (sock->rx_impair, "receive");
+		sock->rx_impair = NULL;
+	}
+	if (sock->tx_impair) {
+		pgm_impair_destroy (sock->tx_impair, "transmit");
+		sock->tx_impair = NULL;
+	}
+	if (sock->txw_skb_pool && sock->txw_skb_pool != sock->skb_pool) {
+		pgm_debug ("releasing transmit window ring store.");
+		pgm_skb_pool_destroy (sock->txw_skb_pool);
+	}
+	sock->txw_skb_pool = NULL;
+	if (sock->batch_buf) {
+		pgm_free (sock->batch_buf);
+		sock->batch_buf = NULL;
+	}
+	if (sock->compress) {
+		pgm_compress_destroy (sock->compress);
+		sock->compress = NULL;
+	}
+	if (sock->conflate) {
+		pgm_conflate_destroy (sock->conflate);
+		sock->conflate = NULL;
+	}
+	if (sock->ack_trail) {
+		pgm_free (sock->ack_trail);
+		sock->ack_trail = NULL;
+	}
+	if (sock->credit) {
+		pgm_free (sock->credit);
+		sock->credit = NULL;
+	}
+	if (sock->nak_limit) {
+		pgm_free (sock->nak_limit);
+		sock->nak_limit = NULL;
+	}
+	if (sock->compress_buf) {
+		pgm_free (sock->compress_buf);
+		sock->compress_buf = NULL;
+	}
+	if (sock->compress_dict) {
+		pgm_free (sock->compress_dict);
+		sock->compress_dict = NULL;
+		sock->compress_req.cr_dict = NULL;
+	}
+	if (sock->spill_dir) {
+		pgm_free (sock->spill_dir);
+		sock->spill_dir = NULL;
+		sock->spill_req.sr_dir = NULL;
+	}
+	if (sock->sendq) {
+		pgm_debug ("discarding %u queued APDUs.", sock->sendq_len);
+		for (unsigned i = 0; i < sock->sendq_len; i++)
+			pgm_free (sock->sendq[ (sock->sendq_head + i) % sock->sendq_max ]);
+		pgm_free (sock->sendq);
+		sock->sendq = NULL;
+	}
+	if (sock->mp_ring) {
+		pgm_free (sock->mp_ring);
+		sock->mp_ring = NULL;
+	}
+	if (sock->handoff) {
+		pgm_debug ("releasing handoff ring.");
+		pgm_handoff_destroy (sock->handoff);
+		sock->handoff = NULL;
+	}
+	if (sock->nak_pending) {
+		pgm_free (sock->nak_pending);
+		sock->nak_pending = NULL;
+	}
+	if (sock->catchup) {
+		pgm_free (sock->catchup);
+		sock->catchup = NULL;
+	}
+	if (sock->recv_gsr) {
+		pgm_free (sock->recv_gsr);
+		sock->recv_gsr = NULL;
+		sock->recv_gsr_len = sock->recv_gsr_size = 0;
+	}
+	if (sock->rx_dports) {
+		pgm_free (sock->rx_dports);
+		sock->rx_dports = NULL;
+		sock->rx_dports_len = 0;
+	}
+	for (unsigned i = 0; i < PGM_SKB_CLASSES; i++) {
+		if (sock->rx_class_pool[i]) {
+			pgm_skb_pool_destroy (sock->rx_class_pool[i]);
+			sock->rx_class_pool[i] = NULL;
+		}
+	}
+	if (sock->placement_pool) {
+		pgm_skb_pool_destroy (sock->placement_pool);
+		sock->placement_pool = NULL;
+	}
+	if (sock->skb_pool) {
+		pgm_debug ("releasing packet buffer pool.");
+		pgm_skb_pool_destroy (sock->skb_pool);
+		sock->skb_pool = NULL;
+	}
 	pgm_debug ("destroying notification channels.");
 	if (sock->can_send_data) {
 		if (sock->use_pgmcc) {
 			pgm_notify_destroy (&sock->ack_notify);
 		}
+		if (sock->sendq_max)
+			pgm_notify_destroy (&sock->sendq_notify);
 		pgm_notify_destroy (&sock->rdata_notify);
 	}
 	pgm_notify_destroy (&sock->pending_notify);
+	if (sock->use_timer_thread)
+		pgm_notify_destroy (&sock->timer_notify);
+	if (sock->handoff_len)
+		pgm_notify_destroy (&sock->handoff_notify);
 	pgm_debug ("freeing sock locks.");
-	pgm_rwlock_free (&sock->peers_lock);
-	pgm_spinlock_free (&sock->txw_spinlock);
 	pgm_mutex_free (&sock->send_mutex);
 	pgm_mutex_free (&sock->timer_mutex);
+	pgm_mutex_free (&sock->nak_mutex);
+	pgm_mutex_free (&sock->catchup_mutex);
 	pgm_mutex_free (&sock->source_mutex);
 	pgm_mutex_free (&sock->receiver_mutex);
 	pgm_rwlock_writer_unlock (&sock->lock);
 	pgm_rwlock_free (&sock->lock);
 	pgm_debug ("freeing sock data.");
-	pgm_free (sock);
+	pgm_free_aligned (sock);
 	pgm_debug ("finished.");
 	return TRUE;
 }
 
+/* asynchronous close: a reaper thread per socket serves repairs for the linger
+ * interval then destroys the socket with pgm_close().  finished reapers are
+ * joined by the next pgm_close_async(), pgm_shutdown() cuts every linger short
+ * and joins the remainder before closing open sockets.
+ */
+
+struct pgm_reaper_t {
+	pgm_sock_t*		sock;
+	bool			flush;
+	pgm_time_t		linger_expiry;		/* 0 = none */
+	pgm_notify_t		notify;			/* cut linger short */
+	volatile uint32_t	is_done;
+#ifndef _WIN32
+	pthread_t		thread;
+#else
+	HANDLE			thread;
+#endif
+};
+
+static pgm_slist_t* pgm_reaper_list = NULL;		/* by pgm_sock_list_lock */
+
+static
+#ifndef _WIN32
+void*
+#else
+unsigned
+__stdcall
+#endif
+reaper_routine (
+	void*			arg
+	)
+{
+	struct pgm_reaper_t* reaper = (struct pgm_reaper_t*)arg;
+	if (reaper->linger_expiry)
+		pgm_linger (reaper->sock, &reaper->notify, reaper->linger_expiry);
+	pgm_close (reaper->sock, reaper->flush);
+	pgm_atomic_write32 (&reaper->is_done, 1);
+	return 0;
+}
+
+/* join finished reapers, or all with is_shutdown after cutting their lingers short.
+ */
+
+static
+void
+reaper_collect (
+	const bool		is_shutdown
+	)
+{
+	pgm_slist_t *joinable = NULL, *list;
+
+	pgm_rwlock_writer_lock (&pgm_sock_list_lock);
+	list = pgm_reaper_list;
+	while (list) {
+		pgm_slist_t* next = list->next;
+		struct pgm_reaper_t* reaper = list->data;
+		if (is_shutdown || pgm_atomic_read32 (&reaper->is_done)) {
+			pgm_reaper_list = pgm_slist_remove (pgm_reaper_list, reaper);
+			joinable = pgm_slist_prepend (joinable, reaper);
+		}
+		list = next;
+	}
+	pgm_rwlock_writer_unlock (&pgm_sock_list_lock);
+
+	while (joinable) {
+		struct pgm_reaper_t* reaper = joinable->data;
+		if (is_shutdown)
+			pgm_notify_send (&reaper->notify);
+#ifndef _WIN32
+		pthread_join (reaper->thread, NULL);
+#else
+		WaitForSingleObject (reaper->thread, INFINITE);
+		CloseHandle (reaper->thread);
+#endif
+		pgm_notify_destroy (&reaper->notify);
+		pgm_free (reaper);
+		joinable = pgm_slist_remove_first (joinable);
+	}
+}
+
+PGM_GNUC_INTERNAL
+void
+pgm_reaper_shutdown (void)
+{
+	reaper_collect (TRUE);
+}
+
+/* close a pgm_sock object without waiting for its destruction: the caller is
+ * returned immediately and must not use the socket again, as after pgm_close().
+ * A connected source with PGM_LINGER first keeps answering NAKs and sending SPMs
+ * for the interval, then flushes and destroys the socket and windows on a
+ * background thread.  PGM_SINGLE_THREADED sockets close synchronously as their
+ * unlocked pools cannot be shared with another thread.
+ *
+ * on success, returns TRUE, on failure returns FALSE.
+ */
+
+bool
+pgm_close_async (
+	pgm_sock_t*	sock,
+	bool		flush
+	)
+{
+	pgm_return_val_if_fail (sock != NULL, FALSE);
+	pgm_return_val_if_fail (!sock->is_destroyed, FALSE);
+	pgm_debug ("pgm_close_async (sock:%p flush:%s)",
+		(const void*)sock,
+		flush ? "TRUE":"FALSE");
+
+	reaper_collect (FALSE);
+	if (sock->is_single_threaded)
+		return pgm_close (sock, flush);
+
+	struct pgm_reaper_t* reaper = pgm_new0 (struct pgm_reaper_t, 1);
+	reaper->sock	= sock;
+	reaper->flush	= flush;
+	if (sock->linger_ivl &&
+	    sock->can_send_data &&
+	    sock->is_connected)
+	{
+		reaper->linger_expiry = pgm_time_update_now() + sock->linger_ivl;
+	}
+	if (0 != pgm_notify_init (&reaper->notify)) {
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Creating reaper notification channel failed, closing synchronously."));
+		pgm_free (reaper);
+		return pgm_close (sock, flush);
+	}
+#ifndef _WIN32
+	const int status = pthread_create (&reaper->thread, NULL, &reaper_routine, reaper);
+	if (0 != status)
+#else
+	reaper->thread = (HANDLE)_beginthreadex (NULL, 0, &reaper_routine, reaper, 0, NULL);
+	if (0 == reaper->thread)
+#endif
+	{
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Creating reaper thread failed, closing synchronously."));
+		pgm_notify_destroy (&reaper->notify);
+		pgm_free (reaper);
+		return pgm_close (sock, flush);
+	}
+	pgm_rwlock_writer_lock (&pgm_sock_list_lock);
+	pgm_reaper_list = pgm_slist_prepend (pgm_reaper_list, reaper);
+	pgm_rwlock_writer_unlock (&pgm_sock_list_lock);
+	return TRUE;
+}
+
 /* Create a pgm_sock object.  Create sockets that require superuser
  * priviledges.  If interface ports are specified then UDP encapsulation will
  * be used instead of raw protocol.
@@ -367,7 +827,7 @@ pgm_socket (
 	pgm_debug ("socket (sock:%p family:%s sock-type:%s protocol:%s error:%p)",
 		 (const void*)sock, pgm_family_string(family), pgm_sock_type_string(pgm_sock_type), pgm_protocol_string(protocol), (const void*)error);
 
-	new_sock = pgm_new0 (pgm_sock_t, 1);
+	new_sock = pgm_malloc0_aligned (sizeof (pgm_sock_t), PGM_CACHELINE_SIZE);
 	new_sock->family	= family;
 	new_sock->socket_type	= pgm_sock_type;
 	new_sock->protocol	= protocol;
@@ -377,6 +837,13 @@ pgm_socket (
 	new_sock->dport		= DEFAULT_DATA_DESTINATION_PORT;
 	new_sock->tsi.sport	= DEFAULT_DATA_SOURCE_PORT;
 	new_sock->adv_mode	= 0;	/* advance with time */
+	new_sock->mem_req.mr_node = PGM_MEM_NODE_ANY;
+	new_sock->peer_idle_ivl	= PGM_PEER_IDLE_DEFAULT_IVL;
+	new_sock->use_hops_cmsg	= TRUE;		/* cleared on the first refusal */
+	new_sock->impair_req	= pgm_impair_env;
+	for (unsigned i = 0; i < PGM_PRIORITY_CLASSES; i++)
+		new_sock->priority_req[i].pr_tos = -1;	/* socket PGM_TOS */
+	pgm_budget_init (&new_sock->budget, &pgm_budget_process);
 
 /* PGMCC */
 	new_sock->acker_nla.ss_family = family;
@@ -384,17 +851,20 @@ pgm_socket (
 /* source-side */
 	pgm_mutex_init (&new_sock->source_mutex);
 /* transmit window */
-	pgm_spinlock_init (&new_sock->txw_spinlock);
 /* send socket */
 	pgm_mutex_init (&new_sock->send_mutex);
 /* next timer & spm expiration */
 	pgm_mutex_init (&new_sock->timer_mutex);
+/* aggregated NAKs */
+	pgm_mutex_init (&new_sock->nak_mutex);
+/* catch-up streams */
+	pgm_mutex_init (&new_sock->catchup_mutex);
 /* receiver-side */
 	pgm_mutex_init (&new_sock->receiver_mutex);
-/* peer hash map & list lock */
-	pgm_rwlock_init (&new_sock->peers_lock);
 /* destroy lock */
 	pgm_rwlock_init (&new_sock->lock);
+/* PGM_TIMER_FD, pgm_kqueue_ctl() */
+	new_sock->timer_fd = new_sock->timer_kq = INVALID_SOCKET;
 
 /* open sockets to implement PGM */
 	if (IPPROTO_UDP == new_sock->protocol) {
@@ -407,7 +877,7 @@ pgm_socket (
 		socket_type = SOCK_RAW;
 	}
 
-	if ((new_sock->recv_sock = socket (new_sock->family,
+	if ((new_sock->recv_sock = transport_socket (new_sock->family,
 					   socket_type,
 					   new_sock->protocol)) == INVALID_SOCKET)
 	{
@@ -444,7 +914,7 @@ pgm_socket (
 /* receive socket must always be non-blocking */
 	pgm_sockaddr_nonblocking (new_sock->recv_sock, TRUE);
 
-	if ((new_sock->send_sock = socket (new_sock->family,
+	if ((new_sock->send_sock = transport_socket (new_sock->family,
 					   socket_type,
 					   new_sock->protocol)) == INVALID_SOCKET)
 	{
@@ -563,6 +1033,15 @@ pgm_socket (
 		}
 	}
 
+#ifdef SO_RXQ_OVFL
+/* count of datagrams dropped on a full receive queue with each datagram */
+	{
+		const int v = 1;
+		if (SOCKET_ERROR == setsockopt (new_sock->recv_sock, SOL_SOCKET, SO_RXQ_OVFL, (const char*)&v, sizeof(v)))
+			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Receive queue drop counter not supported by kernel."));
+	}
+#endif
+
 	*sock = new_sock;
 
 	pgm_rwlock_writer_lock (&pgm_sock_list_lock);
@@ -599,7 +1078,7 @@ err_destroy:
 		}
 		new_sock->send_with_router_alert_sock = INVALID_SOCKET;
 	}
-	pgm_free (new_sock);
+	pgm_free_aligned (new_sock);
 	return FALSE;
 }
 
@@ -715,6 +1194,18 @@ pgm_getsockopt (
 		status = TRUE;
 		break;
 
+/* timer socket */
+	case PGM_TIMER_SOCK:
+		if (PGM_UNLIKELY(!sock->is_connected))
+			break;
+		if (PGM_UNLIKELY(*optlen != sizeof (SOCKET)))
+			break;
+		if (PGM_UNLIKELY(INVALID_SOCKET == sock->timer_fd))
+			break;
+		*(SOCKET*restrict)optval = sock->timer_fd;
+		status = TRUE;
+		break;
+
 /* ACK or congestion socket */
 	case PGM_ACK_SOCK:
 		if (PGM_UNLIKELY(!sock->is_connected))
@@ -728,7 +1219,33 @@ pgm_getsockopt (
 		break;
 
 
-/* timeout for pending timer */
+/* send queue space or drained socket */
+	case PGM_SEND_QUEUE_SOCK:
+		if (PGM_UNLIKELY(!sock->is_connected))
+			break;
+		if (PGM_UNLIKELY(*optlen != sizeof (SOCKET)))
+			break;
+		if (PGM_UNLIKELY(!sock->sendq_max))
+			break;
+		*(SOCKET*restrict)optval = pgm_notify_get_socket (&sock->sendq_notify);
+		status = TRUE;
+		break;
+
+/* APDUs pending in the send queue */
+	case PGM_SEND_QUEUE_LEN:
+		if (PGM_UNLIKELY(!sock->is_connected))
+			break;
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		pgm_mutex_lock (&sock->source_mutex);
+		*(int*restrict)optval = (int)sock->sendq_len;
+		pgm_mutex_unlock (&sock->source_mutex);
+		status = TRUE;
+		break;
+
+/* timeout for pending timer, read without taking the timer mutex so cheap enough
+ * to query after every PGM_IO_STATUS_TIMER_PENDING.
+ */
 	case PGM_TIME_REMAIN:
 		if (PGM_UNLIKELY(!sock->is_connected))
 			break;
@@ -743,7 +1260,10 @@ pgm_getsockopt (
 		status = TRUE;
 		break;
 
-/* timeout for blocking sends */
+/* timeout for blocking sends, including any hold after the device queue
+ * refused a datagram with ENOBUFS.  read from the bucket arrival times
+ * without locking.
+ */
 	case PGM_RATE_REMAIN:
 		if (PGM_UNLIKELY(!sock->is_connected))
 			break;
@@ -751,13 +1271,70 @@ pgm_getsockopt (
 			break;
 		{
 			struct timeval* tv = optval;
-			const long usecs = (long)pgm_rate_remaining2 (&sock->rate_control, &sock->odata_rate_control, sock->blocklen);
+			long usecs = (long)pgm_rate_remaining2 (&sock->rate_control, &sock->odata_rate_control, sock->blocklen);
+/* device queue refusing datagrams with ENOBUFS */
+			const pgm_time_t writable = sock->tx_writable, now = pgm_time_update_now();
+			if (0 != writable && pgm_time_after (writable, now))
+				usecs = MAX(usecs, (long)(writable - now));
 			tv->tv_sec  = usecs / 1000000L;
 			tv->tv_usec = usecs % 1000000L;
 		}
 		status = TRUE;
 		break;
 
+/* datagrams dropped by the kernel on a full receive queue, as opposed to loss
+ * in the network.  zero where not reported by the platform.
+ */
+	case PGM_RXQ_DROPS:
+		if (PGM_UNLIKELY(*optlen != sizeof (uint64_t)))
+			break;
+		*(uint64_t*restrict)optval = pgm_stats_read (sock->cumulative_stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_RXQ_DROPS);
+		status = TRUE;
+		break;
+
+/* bytes held by the kernel receive queue of the primary receive socket, with
+ * SO_MEMINFO the occupancy charged against SO_RCVBUF, otherwise as FIONREAD
+ * which for datagram sockets may report only the next datagram.
+ */
+	case PGM_RECV_QUEUED:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		{
+#if defined(SO_MEMINFO)
+			uint32_t meminfo[SK_MEMINFO_VARS];
+			socklen_t meminfo_len = sizeof (meminfo);
+			if (SOCKET_ERROR == getsockopt (sock->recv_sock, SOL_SOCKET, SO_MEMINFO, (char*)meminfo, &meminfo_len))
+				break;
+			const int queued = (int)meminfo[SK_MEMINFO_RMEM_ALLOC];
+#elif !defined(_WIN32)
+			int queued = 0;
+			if (SOCKET_ERROR == ioctl (sock->recv_sock, FIONREAD, &queued))
+				break;
+#else
+			u_long queued = 0;
+			if (SOCKET_ERROR == ioctlsocket (sock->recv_sock, FIONREAD, &queued))
+				break;
+#endif
+			*(int*restrict)optval = (int)queued;
+		}
+		status = TRUE;
+		break;
+
+/* bytes not yet sent from the kernel send queue, where supported */
+	case PGM_SEND_QUEUED:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+#ifdef SIOCOUTQ
+		{
+			int queued = 0;
+			if (SOCKET_ERROR == ioctl (sock->send_sock, SIOCOUTQ, &queued))
+				break;
+			*(int*restrict)optval = queued;
+		}
+		status = TRUE;
+#endif
+		break;
+
 /** read-write options **/
 /* maximum transmission packet size */
 	case PGM_MTU:
@@ -767,6 +1344,23 @@ pgm_getsockopt (
 		status = TRUE;
 		break;
 
+	case PGM_MTU_DISCOVERY:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		*(int*restrict)optval = sock->pmtud_mode;
+		status = TRUE;
+		break;
+
+/* path MTU learnt below the maximum TPDU, since when datagrams are fragmented.
+ * 0 when none.
+ */
+	case PGM_PATH_MTU:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		*(int*restrict)optval = (int)pgm_atomic_read32 (&sock->path_mtu);
+		status = TRUE;
+		break;
+
 	case PGM_AMBIENT_SPM:
 		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
@@ -860,6 +1454,48 @@ pgm_getsockopt (
 		status = TRUE;
 		break;
 
+	case PGM_PEER_IDLE:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		*(int*restrict)optval = sock->peer_idle_ivl;
+		status = TRUE;
+		break;
+
+	case PGM_LINGER:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		*(int*restrict)optval = (int)sock->linger_ivl;
+		status = TRUE;
+		break;
+
+	case PGM_LARGE_APDU:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		*(int*restrict)optval = (int)sock->large_apdu;
+		status = TRUE;
+		break;
+
+	case PGM_MERGE_DELIVERY:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		*(int*restrict)optval = sock->use_merge_delivery ? 1 : 0;
+		status = TRUE;
+		break;
+
+	case PGM_DELIVERY_QUANTUM:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		*(int*restrict)optval = (int)sock->delivery_quantum;
+		status = TRUE;
+		break;
+
+	case PGM_REDUNDANT_SOURCES:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_redundant_req_t)))
+			break;
+		memcpy (optval, &sock->redundant_req, sizeof (struct pgm_redundant_req_t));
+		status = TRUE;
+		break;
+
 	case PGM_SPMR_EXPIRY:
 		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
@@ -948,6 +1584,20 @@ pgm_getsockopt (
 		status = TRUE;
 		break;
 
+	case PGM_DELIVERY_DEADLINE:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		*(int*restrict)optval = (int)sock->delivery_deadline;
+		status = TRUE;
+		break;
+
+	case PGM_SLOW_CONSUMER_JUMP:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		*(int*restrict)optval = (int)sock->slow_consumer_jump;
+		status = TRUE;
+		break;
+
 	case PGM_USE_FEC:
 		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_fecinfo_t)))
 			break;
@@ -957,7 +1607,7 @@ pgm_getsockopt (
 			fecinfo->var_pktlen_enabled	 = sock->use_var_pktlen;
 			fecinfo->block_size		 = sock->rs_n;
 			fecinfo->group_size		 = sock->rs_k;
-			fecinfo->proactive_packets	 = sock->rs_proactive_h;
+			fecinfo->proactive_packets	 = sock->rs_proactive_max_h;
 		}
 		status = TRUE;
 		break;
@@ -1037,837 +1687,2988 @@ pgm_getsockopt (
 		status = TRUE;
 		break;
 
-/** write-only options **/
-	case PGM_IP_ROUTER_ALERT:
-	case PGM_MULTICAST_LOOP:
-	case PGM_MULTICAST_HOPS:
-	case PGM_TOS:
-	case PGM_JOIN_GROUP:
-	case PGM_LEAVE_GROUP:
-	case PGM_BLOCK_SOURCE:
-	case PGM_UNBLOCK_SOURCE:
-	case PGM_JOIN_SOURCE_GROUP:
-	case PGM_LEAVE_SOURCE_GROUP:
-	case PGM_MSFILTER:
-	default:
-		break;
-	}
-	break;
-
-	default:
-	break;
-	}
-
-	pgm_rwlock_reader_unlock (&sock->lock);
-	return status;
-}
-
-bool
-pgm_setsockopt (
-	pgm_sock_t* const restrict sock,
-	const int		   level,		/* IPPROTO_PGM or SOL_SOCKET */
-	const int		   optname,
-	const void*	  restrict optval,
-	const socklen_t		   optlen
-	)
-{
-	bool status = FALSE;
-	pgm_return_val_if_fail (sock != NULL, status);
-	pgm_return_val_if_fail (IPPROTO_PGM == level || SOL_SOCKET == level, status);
-	if (PGM_UNLIKELY(!pgm_rwlock_reader_trylock (&sock->lock)))
-		pgm_return_val_if_reached (status);
-	if (PGM_UNLIKELY(sock->is_connected || sock->is_destroyed)) {
-		pgm_rwlock_reader_unlock (&sock->lock);
-		return status;
-	}
-
-	switch (level) {
-	case SOL_SOCKET:
-	switch (optname) {
-
-/* 0 < wmem < wmem_max (user)
- *
- * operating system and sysctl dependent maximum, minimum on Linux 256 (doubled).
- */
-	case SO_SNDBUF:
-		if (SOCKET_ERROR == setsockopt (sock->send_sock, SOL_SOCKET, SO_SNDBUF, (const char*)optval, optlen) ||
-		    SOCKET_ERROR == setsockopt (sock->send_with_router_alert_sock, SOL_SOCKET, SO_SNDBUF, (const char*)optval, optlen))
+	case PGM_RECV_BATCH:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
+		*(int*restrict)optval = sock->rx_batch_len;
 		status = TRUE;
 		break;
 
-/* 0 < rmem < rmem_max (user)
- *
- * minimum on Linux is 2048 (doubled).
- */
-	case SO_RCVBUF:
-		if (SOCKET_ERROR == setsockopt (sock->recv_sock, SOL_SOCKET, SO_RCVBUF, (const char*)optval, optlen))
+	case PGM_UDP_GSO:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
+		*(int*restrict)optval = sock->use_udp_gso ? 1 : 0;
 		status = TRUE;
 		break;
 
-	default:
+	case PGM_UDP_GRO:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		*(int*restrict)optval = sock->use_udp_gro ? 1 : 0;
+		status = TRUE;
 		break;
-	}
-	break;
 
-	case IPPROTO_PGM:
-	switch (optname) {
+	case PGM_ZEROCOPY:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		*(int*restrict)optval = sock->use_zerocopy ? 1 : 0;
+		status = TRUE;
+		break;
 
-/* RFC2113 IP Router Alert 
- */
-	case PGM_IP_ROUTER_ALERT:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+	case PGM_RECV_SHARD:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_shard_req_t)))
 			break;
 		{
-			const bool v = (0 != *(const int*)optval);
-			if (SOCKET_ERROR == pgm_sockaddr_router_alert (sock->send_with_router_alert_sock, sock->family, v))
-				break;
+			struct pgm_shard_req_t* sr = optval;
+			sr->sr_count = sock->rx_shard_count;
+			sr->sr_index = sock->rx_shard_index;
 		}
 		status = TRUE;
 		break;
 
-/* IPv4:   68 <= tpdu < 65536		(RFC 2765)
- * IPv6: 1280 <= tpdu < 65536		(RFC 2460)
- */
-	case PGM_MTU:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
-			break;
-		if (PGM_UNLIKELY(*(const int*)optval < (int)(sizeof(struct pgm_ip) + sizeof(struct pgm_header))))
+	case PGM_RECV_SOCKETS:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
-		if (PGM_UNLIKELY(*(const int*)optval > UINT16_MAX))
+		*(int*restrict)optval = 1 + sock->recv_sock_extra_len;
+		status = TRUE;
+		break;
+
+	case PGM_BUSY_POLL:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
-		sock->max_tpdu = *(const int*)optval;
+		*(int*restrict)optval = sock->busy_poll_usecs;
 		status = TRUE;
 		break;
 
-/* 1 = enable multicast loopback.
- * 0 = default, to disable.
- */
-	case PGM_MULTICAST_LOOP:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+	case PGM_IO_URING:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
-		{
-			const bool v = (0 != *(const int*)optval);
-#if !defined(_WIN32) && !defined(__CYGWIN__)	/* loop on send */
-			if (SOCKET_ERROR == pgm_sockaddr_multicast_loop (sock->send_sock, sock->family, v) ||
-			    SOCKET_ERROR == pgm_sockaddr_multicast_loop (sock->send_with_router_alert_sock, sock->family, v))
-				break;
-#else		/* loop on receive */
-			if (SOCKET_ERROR == pgm_sockaddr_multicast_loop (sock->recv_sock, sock->family, v))
-				break;
-#endif
-		}
+		*(int*restrict)optval = sock->rx_uring ? sock->rx_uring_depth : 0;
 		status = TRUE;
 		break;
 
-/* 0 < hops < 256, hops == -1 use kernel default (ignored).
- */
-	case PGM_MULTICAST_HOPS:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+	case PGM_RIO:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
-		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+		*(int*restrict)optval = sock->rio ? sock->rio_depth : 0;
+		status = TRUE;
+		break;
+
+	case PGM_XDP_RECV:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_xdp_req_t)))
 			break;
-		if (PGM_UNLIKELY(*(const int*)optval > UINT8_MAX))
+		memcpy (optval, &sock->rx_xdp_req, sizeof (struct pgm_xdp_req_t));
+		if (NULL == sock->rx_xdp)
+			((struct pgm_xdp_req_t*restrict)optval)->xr_interface = 0;
+		status = TRUE;
+		break;
+
+	case PGM_TPACKET_RECV:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_tpacket_req_t)))
 			break;
-		{
-			sock->hops = *(const int*)optval;
-			if (SOCKET_ERROR == pgm_sockaddr_multicast_hops (sock->send_sock, sock->family, sock->hops) ||
-			    SOCKET_ERROR == pgm_sockaddr_multicast_hops (sock->send_with_router_alert_sock, sock->family, sock->hops))
-				break;
-		}
+		memcpy (optval, &sock->rx_tpacket_req, sizeof (struct pgm_tpacket_req_t));
+		if (NULL == sock->rx_tpacket)
+			((struct pgm_tpacket_req_t*restrict)optval)->tr_interface = 0;
 		status = TRUE;
 		break;
 
-/* IP Type of Service (ToS) or RFC 3246, differentiated services (DSCP)
- */
-	case PGM_TOS:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+	case PGM_RECV_FILTER:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_filter_req_t)))
 			break;
-		if (SOCKET_ERROR == pgm_sockaddr_tos (sock->send_sock, sock->family, *(const int*)optval) ||
-		    SOCKET_ERROR == pgm_sockaddr_tos (sock->send_with_router_alert_sock, sock->family, *(const int*)optval))
-		{
-			pgm_warn (_("ToS/DSCP setting requires CAP_NET_ADMIN or ADMIN capability."));
+		if (PGM_UNLIKELY(!sock->use_recv_filter))
 			break;
-		}
+		memcpy (optval, &sock->rx_filter_req, sizeof (struct pgm_filter_req_t));
 		status = TRUE;
 		break;
 
-/* periodic ambient broadcast SPM interval in milliseconds.
- */
-	case PGM_AMBIENT_SPM:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+	case PGM_SOURCE_FILTER:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_source_filter_req_t)))
 			break;
-		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+		memcpy (optval, &sock->rx_source_filter, sizeof (struct pgm_source_filter_req_t));
+		status = TRUE;
+		break;
+
+	case PGM_CAPTURE:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_capture_req_t)))
 			break;
-		sock->spm_ambient_interval = *(const int*)optval;
+		memcpy (optval, &sock->capture_req, sizeof (struct pgm_capture_req_t));
+		if (NULL == sock->capture)
+			((struct pgm_capture_req_t*restrict)optval)->cr_path[0] = '\0';
 		status = TRUE;
 		break;
 
-/* sequence of heartbeat broadcast SPMS to flush out original 
- */
-	case PGM_HEARTBEAT_SPM:
-		if (PGM_UNLIKELY(0 != optlen % sizeof (int)))
+	case PGM_FEC_WORKER:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		*(int*restrict)optval = sock->use_fec_worker ? 1 : 0;
+		status = TRUE;
+		break;
+
+	case PGM_USE_SLIDING_FEC:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_sw_fecinfo_t)))
 			break;
 		{
-			sock->spm_heartbeat_len = optlen / sizeof (int);
-			sock->spm_heartbeat_interval = pgm_new (unsigned, sock->spm_heartbeat_len + 1);
-			sock->spm_heartbeat_interval[0] = 0;
-			for (unsigned i = 0; i < sock->spm_heartbeat_len; i++)
-				sock->spm_heartbeat_interval[i + 1] = ((const int*)optval)[i];
+			struct pgm_sw_fecinfo_t*restrict sw_fecinfo = optval;
+			sw_fecinfo->window_size		= sock->use_sliding_fec ? sock->sw_window : 0;
+			sw_fecinfo->repair_interval	= sock->use_sliding_fec ? sock->sw_interval : 0;
 		}
 		status = TRUE;
 		break;
 
-/* size of transmit window in sequence numbers.
- * 0 < txw_sqns < one less than half sequence space
- */
-	case PGM_TXW_SQNS:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
-			break;
-		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+	case PGM_PACING:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
-		if (PGM_UNLIKELY(*(const int*)optval >= (int)((UINT32_MAX/2)-1)))
+		*(int*restrict)optval = sock->use_pacing ? 1 : 0;
+		status = TRUE;
+		break;
+
+	case PGM_TIMER_THREAD:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
-		sock->txw_sqns = *(const int*)optval;
+		*(int*restrict)optval = sock->use_timer_thread ? 1 : 0;
 		status = TRUE;
 		break;
 
-/* size of transmit window in seconds.
- * 0 < secs < ( txw_sqns / txw_max_rte )
- */
-	case PGM_TXW_SECS:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+	case PGM_TIMER_POOL:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
-		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+		*(int*restrict)optval = sock->use_timer_pool ? 1 : 0;
+		status = TRUE;
+		break;
+
+	case PGM_SINGLE_THREADED:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
-		sock->txw_secs = *(const int*)optval;
+		*(int*restrict)optval = sock->is_single_threaded ? 1 : 0;
 		status = TRUE;
 		break;
 
-/* maximum transmit rate.
- * 0 < txw_max_rte < interface capacity
- *  10mb :   1250000
- * 100mb :  12500000
- *   1gb : 125000000
- */
-	case PGM_TXW_MAX_RTE:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+	case PGM_TIMER_FD:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
-		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+		*(int*restrict)optval = sock->use_timer_fd ? 1 : 0;
+		status = TRUE;
+		break;
+
+	case PGM_TIMESTAMPING:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
-		sock->txw_max_rte = *(const int*)optval;
-/* default to controlling SPM, ODATA, and RDATA packets. */
-		sock->is_controlled_odata = TRUE;
-		sock->is_controlled_rdata = TRUE;
+		*(int*restrict)optval = (int)sock->timestamping;
 		status = TRUE;
 		break;
 
-/* maximum original data rate.
- * 0 < odata_max_rte < txw_max_rte
- */
-	case PGM_ODATA_MAX_RTE:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+	case PGM_TX_TIMESTAMPING:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
-		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+		*(int*restrict)optval = (int)sock->tx_timestamping;
+		status = TRUE;
+		break;
+
+	case PGM_RX_CHECKSUM:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
-		sock->odata_max_rte = *(const int*)optval;
+		*(int*restrict)optval = (int)sock->rx_checksum;
 		status = TRUE;
 		break;
 
-/* maximum repair data rate.
- * 0 < rdata_max_rte < txw_max_rte
- */
-	case PGM_RDATA_MAX_RTE:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+	case PGM_TX_CHECKSUM:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
-		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+		*(int*restrict)optval = (int)sock->tx_checksum;
+		status = TRUE;
+		break;
+
+	case PGM_POW2_WINDOWS:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
-		sock->rdata_max_rte = *(const int*)optval;
+		*(int*restrict)optval = sock->use_pow2_windows ? 1 : 0;
 		status = TRUE;
 		break;
 
-/* ignore rate limit for original data packets, i.e. only apply to repairs.
- */
-	case PGM_UNCONTROLLED_ODATA:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+	case PGM_MEM_POLICY:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_mem_req_t)))
 			break;
-		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+		memcpy (optval, &sock->mem_req, sizeof (struct pgm_mem_req_t));
+		status = TRUE;
+		break;
+
+	case PGM_TXW_RING:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
-		sock->is_controlled_odata = (0 == *(const int*)optval);
+		*(int*restrict)optval = (int)sock->txw_ring_len;
 		status = TRUE;
 		break;
 
-/* ignore rate limit for repair data packets, i.e. only apply to original data.
- */
-	case PGM_UNCONTROLLED_RDATA:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+	case PGM_RX_SIZE_CLASSES:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
-		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+		*(int*restrict)optval = sock->use_rx_size_classes ? 1 : 0;
+		status = TRUE;
+		break;
+
+	case PGM_SEND_BATCH:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_batch_req_t)))
 			break;
-		sock->is_controlled_rdata = (0 == *(const int*)optval);
+		memcpy (optval, &sock->batch_req, sizeof (struct pgm_batch_req_t));
 		status = TRUE;
 		break;
 
-/* timeout for peers.
- * 0 < 2 * spm_ambient_interval <= peer_expiry
- */
-	case PGM_PEER_EXPIRY:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+	case PGM_COMPRESS:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_compress_req_t)))
 			break;
-		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+		memcpy (optval, &sock->compress_req, sizeof (struct pgm_compress_req_t));
+		status = TRUE;
+		break;
+
+	case PGM_SPILL:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_spill_req_t)))
 			break;
-		sock->peer_expiry = *(const int*)optval;
+		memcpy (optval, &sock->spill_req, sizeof (struct pgm_spill_req_t));
 		status = TRUE;
 		break;
 
-/* maximum back off range for listening for multicast SPMR.
- * 0 < spmr_expiry < spm_ambient_interval
- */
-	case PGM_SPMR_EXPIRY:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+	case PGM_CONFLATE:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_conflate_req_t)))
 			break;
-		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+		memcpy (optval, &sock->conflate_req, sizeof (struct pgm_conflate_req_t));
+		status = TRUE;
+		break;
+
+	case PGM_PLACEMENT:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_placement_req_t)))
 			break;
-		sock->spmr_expiry = *(const int*)optval;
+		memcpy (optval, &sock->placement_req, sizeof (struct pgm_placement_req_t));
 		status = TRUE;
 		break;
 
-/* size of receive window in sequence numbers.
- * 0 < rxw_sqns < one less than half sequence space
- */
-	case PGM_RXW_SQNS:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+	case PGM_ACK_TRAIL:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_ack_trail_req_t)))
 			break;
-		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+		memcpy (optval, &sock->ack_trail_req, sizeof (struct pgm_ack_trail_req_t));
+		status = TRUE;
+		break;
+
+	case PGM_CREDIT:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_credit_req_t)))
 			break;
-		if (PGM_UNLIKELY(*(const int*)optval >= (int)((UINT32_MAX/2)-1)))
+		memcpy (optval, &sock->credit_req, sizeof (struct pgm_credit_req_t));
+		status = TRUE;
+		break;
+
+	case PGM_NAK_LIMIT:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_nak_limit_req_t)))
 			break;
-		sock->rxw_sqns = *(const int*)optval;
+		memcpy (optval, &sock->nak_limit_req, sizeof (struct pgm_nak_limit_req_t));
 		status = TRUE;
 		break;
 
-/* size of receive window in seconds.
- * 0 < secs < ( rxw_sqns / rxw_max_rte )
- */
-	case PGM_RXW_SECS:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+/* NAKing receivers of a source with PGM_NAK_LIMIT */
+	case PGM_NAK_LIMIT_STATS:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_nak_limit_stats_t)))
 			break;
-		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+		if (PGM_UNLIKELY(NULL == sock->nak_limit))
 			break;
-		sock->rxw_secs = *(const int*)optval;
+		{
+			struct pgm_nak_limit_stats_t* ns = optval;
+			memset (ns, 0, sizeof (struct pgm_nak_limit_stats_t));
+			pgm_mutex_lock (&sock->receiver_mutex);
+			ns->ns_len = sock->nak_limit_len;
+			for (unsigned i = 0; i < sock->nak_limit_len; i++)
+				memcpy (&ns->ns_receiver[i], &sock->nak_limit[i].stat, sizeof (struct pgm_nak_limit_stat_t));
+			pgm_mutex_unlock (&sock->receiver_mutex);
+		}
 		status = TRUE;
 		break;
 
-/* maximum receive rate, for determining window size with txw_secs.
- * 0 < rxw_max_rte < interface capacity
- */
-	case PGM_RXW_MAX_RTE:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+	case PGM_UNICAST_FANOUT:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_fanout_req_t)))
 			break;
-		if (PGM_UNLIKELY(*(const int*)optval <= 0))
-			break;
-		sock->rxw_max_rte = *(const int*)optval;
+		memcpy (optval, &sock->fanout_req, sizeof (struct pgm_fanout_req_t));
 		status = TRUE;
 		break;
 
-/* maximum NAK back-off value nak_rb_ivl in milliseconds.
- * 0 < nak_rb_ivl <= nak_bo_ivl
- */
-	case PGM_NAK_BO_IVL:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+	case PGM_VERBS:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_verbs_req_t)))
 			break;
-		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+		memcpy (optval, &sock->verbs_req, sizeof (struct pgm_verbs_req_t));
+		if (NULL == sock->verbs)
+			((struct pgm_verbs_req_t*restrict)optval)->vr_port = 0;
+		status = TRUE;
+		break;
+
+	case PGM_DPDK:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_dpdk_req_t)))
 			break;
-		sock->nak_bo_ivl = *(const int*)optval;
+		memcpy (optval, &sock->dpdk_req, sizeof (struct pgm_dpdk_req_t));
+		if (NULL == sock->dpdk)
+			((struct pgm_dpdk_req_t*restrict)optval)->dr_device[0] = '\0';
 		status = TRUE;
 		break;
 
-/* repeat interval prior to re-sending a NAK, in milliseconds.
- */
-	case PGM_NAK_RPT_IVL:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+	case PGM_COMPACT:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
-		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+		*(int*restrict)optval = (int)sock->compact_tsdu;
+		status = TRUE;
+		break;
+
+	case PGM_STREAM_GROUP:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_stream_req_t)))
 			break;
-		sock->nak_rpt_ivl = *(const int*)optval;
+		memcpy (optval, &sock->stream_req, sizeof (struct pgm_stream_req_t));
+		((struct pgm_stream_req_t*)optval)->sr_weight = stream_weight (sock);
 		status = TRUE;
 		break;
 
-/* interval waiting for repair data, in milliseconds.
- */
-	case PGM_NAK_RDATA_IVL:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+	case PGM_SEND_PATHS:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_send_path_req_t)))
 			break;
-		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+		memcpy (optval, &sock->send_path_req, sizeof (struct pgm_send_path_req_t));
+		status = TRUE;
+		break;
+
+	case PGM_RECORD:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_record_req_t)))
 			break;
-		sock->nak_rdata_ivl = *(const int*)optval;
+		memcpy (optval, &sock->record_req, sizeof (struct pgm_record_req_t));
+		if (NULL == sock->recorder)
+			((struct pgm_record_req_t*restrict)optval)->rr_path[0] = '\0';
 		status = TRUE;
 		break;
 
-/* limit for data.
- * 0 < nak_data_retries < 256
- */
-	case PGM_NAK_DATA_RETRIES:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+	case PGM_IMPAIR:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_impair_req_t)))
 			break;
-		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+		memcpy (optval, &sock->impair_req, sizeof (struct pgm_impair_req_t));
+		status = TRUE;
+		break;
+
+	case PGM_DELIVERY_CALLBACK:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_delivery_req_t)))
 			break;
-		if (PGM_UNLIKELY(*(const int*)optval > UINT8_MAX))
+		memcpy (optval, &sock->delivery_req, sizeof (struct pgm_delivery_req_t));
+		status = TRUE;
+		break;
+
+	case PGM_HANDOFF_RING:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
-		sock->nak_data_retries = *(const int*)optval;
+		*(int*restrict)optval = sock->handoff ? (int)sock->handoff_len : 0;
 		status = TRUE;
 		break;
 
-/* limit for NAK confirms.
- * 0 < nak_ncf_retries < 256
- */
-	case PGM_NAK_NCF_RETRIES:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+/* APDUs in the handoff ring for a consumer that found it empty */
+	case PGM_HANDOFF_SOCK:
+		if (PGM_UNLIKELY(!sock->is_connected))
 			break;
-		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+		if (PGM_UNLIKELY(*optlen != sizeof (SOCKET)))
 			break;
-		if (PGM_UNLIKELY(*(const int*)optval > UINT8_MAX))
+		if (PGM_UNLIKELY(NULL == sock->handoff))
 			break;
-		sock->nak_ncf_retries = *(const int*)optval;
+		*(SOCKET*restrict)optval = pgm_notify_get_socket (&sock->handoff_notify);
 		status = TRUE;
 		break;
 
-/* Enable FEC for this sock, specifically Reed Solmon encoding RS(n,k), common
- * setting is RS(255, 223).
- *
- * inputs:
- *
- * n = FEC Block size = [k+1, 255]
- * k = original data packets == transmission group size = [2, 4, 8, 16, 32, 64, 128]
- * m = symbol size = 8 bits
- *
- * outputs:
- *
- * h = 2t = n - k = parity packets
- *
- * when h > k parity packets can be lost.
- */
-	case PGM_USE_FEC:
-		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_fecinfo_t)))
+	case PGM_PRIORITY_CLASS:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_priority_req_t)))
 			break;
 		{
-			const struct pgm_fecinfo_t* fecinfo = optval;
-			if (PGM_UNLIKELY(0 != (fecinfo->group_size & (fecinfo->group_size - 1))))
-				break;
-			if (PGM_UNLIKELY(fecinfo->group_size < 2 || fecinfo->group_size > 128))
-				break;
-			if (PGM_UNLIKELY(fecinfo->group_size > fecinfo->block_size))
-				break;
-			const uint8_t parity_packets = fecinfo->block_size - fecinfo->group_size;
-/* technically could re-send previous packets */
-			if (PGM_UNLIKELY(fecinfo->proactive_packets > parity_packets))
+			struct pgm_priority_req_t* pr = optval;
+			if (PGM_UNLIKELY(pr->pr_class < 1 || pr->pr_class >= PGM_PRIORITY_CLASSES))
 				break;
-/* check validity of parameters */
-			if (PGM_UNLIKELY(fecinfo->group_size > 223 && ((parity_packets * 223.0) / fecinfo->group_size) < 1.0))
-			{
-				pgm_error (_("k/h ratio too low to generate parity data."));
-				break;
-			}
-			sock->use_proactive_parity	= (fecinfo->proactive_packets > 0);
-			sock->use_ondemand_parity	= fecinfo->ondemand_parity_enabled;
-			sock->use_var_pktlen		= fecinfo->var_pktlen_enabled;
-			sock->rs_n			= fecinfo->block_size;
-			sock->rs_k			= fecinfo->group_size;
-			sock->rs_proactive_h		= fecinfo->proactive_packets;
+			memcpy (pr, &sock->priority_req[pr->pr_class], sizeof (struct pgm_priority_req_t));
 		}
 		status = TRUE;
 		break;
 
-/* congestion reporting */
-	case PGM_USE_CR:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+	case PGM_MEM_BUDGET:
+		if (PGM_UNLIKELY(*optlen != sizeof (uint64_t)))
 			break;
-		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+		*(uint64_t*restrict)optval = pgm_budget_limit (&sock->budget);
+		status = TRUE;
+		break;
+
+/* bytes of packet buffers charged to the socket, see pgm_mem_get_used() for
+ * the process.
+ */
+	case PGM_MEM_USED:
+		if (PGM_UNLIKELY(*optlen != sizeof (uint64_t)))
 			break;
-		sock->crqst_ivl = *(const int*)optval;
-		sock->use_cr    = (sock->crqst_ivl > 0);
+		*(uint64_t*restrict)optval = pgm_budget_used (&sock->budget);
 		status = TRUE;
 		break;
 
-/* congestion control */
-	case PGM_USE_PGMCC:
-		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_pgmccinfo_t)))
+	case PGM_SEND_QUEUE:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
-		{
-			const struct pgm_pgmccinfo_t* pgmccinfo = optval;
-			sock->ack_bo_ivl = pgmccinfo->ack_bo_ivl;
-			sock->ack_c      = pgmccinfo->ack_c;
-			sock->ack_c_p    = pgmccinfo->ack_c_p;
-			sock->use_pgmcc  = (sock->ack_c > 0);
-		}
+		*(int*restrict)optval = (int)sock->sendq_max;
 		status = TRUE;
 		break;
 
-/* declare socket only for sending, discard any incoming SPM, ODATA,
- * RDATA, etc, packets.
- */
-	case PGM_SEND_ONLY:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+	case PGM_MULTI_PRODUCER:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
-		sock->can_recv_data = (0 == *(const int*)optval);
+		*(int*restrict)optval = sock->mp_ring ? (int)sock->mp_len : 0;
 		status = TRUE;
 		break;
 
-/* declare socket only for receiving, no transmit window will be created
- * and no SPM broadcasts sent.
- */
-	case PGM_RECV_ONLY:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+	case PGM_AUTO_BUFFERS:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
-		sock->can_send_data = (0 == *(const int*)optval);
+		*(int*restrict)optval = (int)sock->autobuf_msecs;
 		status = TRUE;
 		break;
 
-/* passive receiving socket, i.e. no back channel to source
- */
-	case PGM_PASSIVE:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+	case PGM_CONGESTION_CONTROL:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
-		sock->can_send_nak = (0 == *(const int*)optval);
+		*(int*restrict)optval = (int)sock->cc_algorithm;
 		status = TRUE;
 		break;
 
-/* on unrecoverable data loss stop socket from further transmission and
- * receiving.
- */
-	case PGM_ABORT_ON_RESET:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+	case PGM_NAK_ADAPTIVE:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
-		sock->is_abort_on_reset = (0 != *(const int*)optval);
+		*(int*restrict)optval = sock->use_nak_adaptive ? 1 : 0;
 		status = TRUE;
 		break;
 
-/* default non-blocking operation on send and receive sockets.
- */
-	case PGM_NOBLOCK:
-		if (PGM_UNLIKELY(optlen != sizeof (int)))
+	case PGM_NAK_AGGREGATE_IVL:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
-		sock->is_nonblocking = (0 != *(const int*)optval);
-		pgm_sockaddr_nonblocking (sock->send_sock, sock->is_nonblocking);
-		pgm_sockaddr_nonblocking (sock->send_with_router_alert_sock, sock->is_nonblocking);
+		*(int*restrict)optval = (int)sock->nak_aggregate_ivl;
 		status = TRUE;
 		break;
 
-/* sending group, singular.  note that the address is only stored and used
- * later in sendto() calls, this routine only considers the interface.
- */
-	case PGM_SEND_GROUP:
-	{
-		void*     restrict tmp_optval = optval; 
-		socklen_t          tmp_optlen = optlen; 
+	case PGM_FEC_ADAPTIVE:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		*(int*restrict)optval = sock->use_adaptive_fec ? 1 : 0;
+		status = TRUE;
+		break;
 
-/* Use OpenPGM enhanced struct with support for multiple IP addresses per interface. */
-		if (tmp_optlen == sizeof(struct pgm_group_source_req))
-		{
-			const struct pgm_group_source_req* gsr = tmp_optval;
-			struct group_req* gr = pgm_alloca (sizeof (struct group_req));
-/* copy contents to bypass byte packing differences */
-			gr->gr_interface = gsr->gsr_interface;
-			memcpy (&gr->gr_group, &gsr->gsr_group, sizeof (struct sockaddr_storage));
-			tmp_optval = gr;
-			tmp_optlen = sizeof(struct group_req);
-		}
-		if (tmp_optlen == sizeof(struct group_req))
+	case PGM_FEC_DECODE_THREADS:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		*(int*restrict)optval = (int)sock->fec_decode_threads;
+		status = TRUE;
+		break;
+
+	case PGM_TXW_STORE:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_txw_store_req_t)))
+			break;
+		memcpy (optval, &sock->txw_store_req, sizeof (struct pgm_txw_store_req_t));
+		if (NULL == sock->txw_store)
+			((struct pgm_txw_store_req_t*restrict)optval)->ts_path[0] = '\0';
+		status = TRUE;
+		break;
+
+	case PGM_CATCHUP:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_catchup_req_t)))
+			break;
 		{
-			memcpy (&sock->send_gsr, tmp_optval, sizeof(struct group_req));
-			if (PGM_UNLIKELY(sock->family != sock->send_gsr.gsr_group.ss_family))
-				break;
-/* multicast group for later usage with sendto() */
-			if (sock->udp_encap_mcast_port)
-				((struct sockaddr_in*)&sock->send_gsr.gsr_group)->sin_port = htons (sock->udp_encap_mcast_port);
-/* interface */
-			if ((SOCKET_ERROR == pgm_sockaddr_multicast_if (sock->send_sock,
-									   (const struct sockaddr*)&sock->send_addr,
-									   sock->send_gsr.gsr_interface)) ||
-			    (SOCKET_ERROR == pgm_sockaddr_multicast_if (sock->send_with_router_alert_sock,
-									   (const struct sockaddr*)&sock->send_addr,
-									   sock->send_gsr.gsr_interface)))
-			{
-				break;
-			}
-			else if (PGM_UNLIKELY(pgm_log_mask & PGM_LOG_ROLE_NETWORK))
-			{
-				char addr[INET6_ADDRSTRLEN];
-				pgm_sockaddr_ntop ((const struct sockaddr*)&sock->send_addr, addr, sizeof(addr));
-				pgm_trace (PGM_LOG_ROLE_NETWORK,_("Multicast send interface set to %s index %u"),
-					addr,
-					(unsigned)sock->send_gsr.gsr_interface);
-			}
+			struct pgm_catchup_req_t* cu = optval;
+			cu->cu_sqns = sock->catchup_sqns;
+			cu->cu_ivl  = (uint32_t)sock->catchup_ivl;
 		}
-	}
 		status = TRUE;
 		break;
 
-/* for any-source applications (ASM), join a new group
- */
-	case PGM_JOIN_GROUP:
-		if (PGM_UNLIKELY(sock->recv_gsr_len >= IP_MAX_MEMBERSHIPS))
+	case PGM_CATCHUP_RATE:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
-	{
-		void*	  restrict tmp_optval = optval;
-		socklen_t	   tmp_optlen = optlen;
+		*(int*restrict)optval = (int)sock->catchup_max_rte;
+		status = TRUE;
+		break;
 
-/* Use OpenPGM enhanced struct with support for multiple IP addresses per interface. */
-		if (tmp_optlen == sizeof(struct pgm_group_source_req))
+	case PGM_DLR:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_dlr_req_t)))
+			break;
 		{
-			const struct pgm_group_source_req* gsr = tmp_optval;
-			struct group_req* gr = pgm_alloca (sizeof (struct group_req));
-/* copy contents to bypass byte packing differences */
-			gr->gr_interface = gsr->gsr_interface;
-			memcpy (&gr->gr_group, &gsr->gsr_group, sizeof (struct sockaddr_storage));
-			tmp_optval = gr;
-			tmp_optlen = sizeof(struct group_req);
+			struct pgm_dlr_req_t* dr = optval;
+			dr->dr_sqns    = sock->dlr_sqns;
+			dr->dr_ivl     = (uint32_t)sock->dlr_ivl;
+			dr->dr_max_rte = (uint32_t)sock->dlr_max_rte;
+		}
+		status = TRUE;
+		break;
+
+	case PGM_SHM_RECV:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_shm_req_t)))
+			break;
+		{
+			struct pgm_shm_req_t* sr = optval;
+			memcpy (sr, &sock->shm_req, sizeof (struct pgm_shm_req_t));
+			if (NULL == sock->rx_shm)
+				sr->sr_path[0] = '\0';
+			sr->sr_ivl = (uint32_t)sock->rx_shm_ivl;
+		}
+		status = TRUE;
+		break;
+
+	case PGM_WARM_RESTART:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_warm_restart_req_t)))
+			break;
+		memcpy (optval, &sock->warm_restart_req, sizeof (struct pgm_warm_restart_req_t));
+		if (NULL == sock->restart)
+			((struct pgm_warm_restart_req_t*restrict)optval)->wr_name[0] = '\0';
+		status = TRUE;
+		break;
+
+	case PGM_LOCAL_PUBLISH:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_local_req_t)))
+			break;
+		memcpy (optval, &sock->local_req, sizeof (struct pgm_local_req_t));
+		if (NULL == sock->local)
+			((struct pgm_local_req_t*restrict)optval)->lr_name[0] = '\0';
+		status = TRUE;
+		break;
+
+	case PGM_STANDBY:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_standby_req_t)))
+			break;
+		memcpy (optval, &sock->standby_req, sizeof (struct pgm_standby_req_t));
+		status = TRUE;
+		break;
+
+	case PGM_SEND_PORTS:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_send_port_req_t)))
+			break;
+		memcpy (optval, &sock->send_port_req, sizeof (struct pgm_send_port_req_t));
+		status = TRUE;
+		break;
+
+/** write-only options **/
+	case PGM_IP_ROUTER_ALERT:
+	case PGM_MULTICAST_LOOP:
+	case PGM_MULTICAST_HOPS:
+	case PGM_TOS:
+	case PGM_JOIN_GROUP:
+	case PGM_LEAVE_GROUP:
+	case PGM_BLOCK_SOURCE:
+	case PGM_UNBLOCK_SOURCE:
+	case PGM_JOIN_SOURCE_GROUP:
+	case PGM_LEAVE_SOURCE_GROUP:
+	case PGM_MSFILTER:
+	default:
+		break;
+	}
+	break;
+
+	default:
+	break;
+	}
+
+	pgm_rwlock_reader_unlock (&sock->lock);
+	return status;
+}
+
+/* order PGM_SOURCE_FILTER entries by GSI then source port, network order.
+ */
+
+static
+int
+source_filter_cmp (
+	const void*	a,
+	const void*	b
+	)
+{
+	return memcmp (a, b, sizeof (pgm_tsi_t));
+}
+
+/* group and data-destination port membership may change on a connected socket,
+ * readers of sock::recv_gsr and sock::rx_dports hold sock::receiver_mutex.
+ */
+
+static inline
+bool
+is_membership_option (
+	const int		level,
+	const int		optname
+	)
+{
+	return IPPROTO_PGM == level &&
+	       (PGM_JOIN_GROUP == optname || PGM_LEAVE_GROUP == optname ||
+		PGM_JOIN_DPORT == optname || PGM_LEAVE_DPORT == optname);
+}
+
+bool
+pgm_setsockopt (
+	pgm_sock_t* const restrict sock,
+	const int		   level,		/* IPPROTO_PGM or SOL_SOCKET */
+	const int		   optname,
+	const void*	  restrict optval,
+	const socklen_t		   optlen
+	)
+{
+	bool status = FALSE;
+	pgm_return_val_if_fail (sock != NULL, status);
+	pgm_return_val_if_fail (IPPROTO_PGM == level || SOL_SOCKET == level, status);
+	if (PGM_UNLIKELY(!pgm_rwlock_reader_trylock (&sock->lock)))
+		pgm_return_val_if_reached (status);
+	if (PGM_UNLIKELY(sock->is_destroyed ||
+			 (sock->is_connected && !is_membership_option (level, optname))))
+	{
+		pgm_rwlock_reader_unlock (&sock->lock);
+		return status;
+	}
+
+	switch (level) {
+	case SOL_SOCKET:
+	switch (optname) {
+
+/* 0 < wmem < wmem_max (user)
+ *
+ * operating system and sysctl dependent maximum, minimum on Linux 256 (doubled).
+ */
+	case SO_SNDBUF:
+		if (SOCKET_ERROR == setsockopt (sock->send_sock, SOL_SOCKET, SO_SNDBUF, (const char*)optval, optlen) ||
+		    SOCKET_ERROR == setsockopt (sock->send_with_router_alert_sock, SOL_SOCKET, SO_SNDBUF, (const char*)optval, optlen))
+			break;
+		status = TRUE;
+		break;
+
+/* 0 < rmem < rmem_max (user)
+ *
+ * minimum on Linux is 2048 (doubled).
+ */
+	case SO_RCVBUF:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (SOCKET_ERROR == setsockopt (sock->recv_sock, SOL_SOCKET, SO_RCVBUF, (const char*)optval, optlen))
+			break;
+		{
+			unsigned i;
+			for (i = 0; i < sock->recv_sock_extra_len; i++)
+				if (SOCKET_ERROR == setsockopt (sock->recv_sock_extra[i], SOL_SOCKET, SO_RCVBUF, (const char*)optval, optlen))
+					break;
+			if (PGM_UNLIKELY(i < sock->recv_sock_extra_len))
+				break;
+		}
+		sock->rcvbuf = *(const int*)optval;
+		status = TRUE;
+		break;
+
+	default:
+		break;
+	}
+	break;
+
+	case IPPROTO_PGM:
+	switch (optname) {
+
+/* RFC2113 IP Router Alert 
+ */
+	case PGM_IP_ROUTER_ALERT:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		{
+			const bool v = (0 != *(const int*)optval);
+			if (SOCKET_ERROR == pgm_sockaddr_router_alert (sock->send_with_router_alert_sock, sock->family, v))
+				break;
+		}
+		status = TRUE;
+		break;
+
+/* IPv4:   68 <= tpdu < 65536		(RFC 2765)
+ * IPv6: 1280 <= tpdu < 65536		(RFC 2460)
+ */
+	case PGM_MTU:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval < (int)(sizeof(struct pgm_ip) + sizeof(struct pgm_header))))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval > UINT16_MAX))
+			break;
+		sock->max_tpdu = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* PGM_PMTUD_INTERFACE or PGM_PMTUD_PROBE select the maximum TPDU from the MTU of
+ * the sending interface, bounded by any PGM_MTU, and send datagrams with DF.
+ * With PGM_PMTUD_INTERFACE a smaller path MTU learnt from ICMP fragmentation
+ * needed is reported by PGM_PATH_MTU and datagrams are fragmented thereafter,
+ * window data is sized at bind.  PGM_PMTUD_PROBE ignores the learnt path MTU.
+ * PGM_PMTUD_DISABLED = default, PGM_MTU with fragmentation.  Set before bind.
+ */
+	case PGM_MTU_DISCOVERY:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval < PGM_PMTUD_DISABLED ||
+				 *(const int*)optval > PGM_PMTUD_PROBE))
+			break;
+		sock->pmtud_mode = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* 1 = enable multicast loopback.
+ * 0 = default, to disable.
+ */
+	case PGM_MULTICAST_LOOP:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		{
+			const bool v = (0 != *(const int*)optval);
+#if !defined(_WIN32) && !defined(__CYGWIN__)	/* loop on send */
+			if (SOCKET_ERROR == pgm_sockaddr_multicast_loop (sock->send_sock, sock->family, v) ||
+			    SOCKET_ERROR == pgm_sockaddr_multicast_loop (sock->send_with_router_alert_sock, sock->family, v))
+				break;
+#else		/* loop on receive */
+			if (SOCKET_ERROR == pgm_sockaddr_multicast_loop (sock->recv_sock, sock->family, v))
+				break;
+#endif
+			sock->use_multicast_loop = v;
+		}
+		status = TRUE;
+		break;
+
+/* 0 < hops < 256, hops == -1 use kernel default (ignored).
+ */
+	case PGM_MULTICAST_HOPS:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval > UINT8_MAX))
+			break;
+		{
+			sock->hops = *(const int*)optval;
+			if (SOCKET_ERROR == pgm_sockaddr_multicast_hops (sock->send_sock, sock->family, sock->hops) ||
+			    SOCKET_ERROR == pgm_sockaddr_multicast_hops (sock->send_with_router_alert_sock, sock->family, sock->hops))
+				break;
+		}
+		status = TRUE;
+		break;
+
+/* IP Type of Service (ToS) or RFC 3246, differentiated services (DSCP)
+ */
+	case PGM_TOS:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (SOCKET_ERROR == pgm_sockaddr_tos (sock->send_sock, sock->family, *(const int*)optval) ||
+		    SOCKET_ERROR == pgm_sockaddr_tos (sock->send_with_router_alert_sock, sock->family, *(const int*)optval))
+		{
+			pgm_warn (_("ToS/DSCP setting requires CAP_NET_ADMIN or ADMIN capability."));
+			break;
+		}
+		sock->tos = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* periodic ambient broadcast SPM interval in milliseconds.
+ */
+	case PGM_AMBIENT_SPM:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+			break;
+		sock->spm_ambient_interval = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* sequence of heartbeat broadcast SPMS to flush out original 
+ */
+	case PGM_HEARTBEAT_SPM:
+		if (PGM_UNLIKELY(0 != optlen % sizeof (int)))
+			break;
+		{
+			sock->spm_heartbeat_len = optlen / sizeof (int);
+			sock->spm_heartbeat_interval = pgm_new (unsigned, sock->spm_heartbeat_len + 1);
+			sock->spm_heartbeat_interval[0] = 0;
+			for (unsigned i = 0; i < sock->spm_heartbeat_len; i++)
+				sock->spm_heartbeat_interval[i + 1] = ((const int*)optval)[i];
+		}
+		status = TRUE;
+		break;
+
+/* size of transmit window in sequence numbers.
+ * 0 < txw_sqns < one less than half sequence space
+ */
+	case PGM_TXW_SQNS:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval >= (int)((UINT32_MAX/2)-1)))
+			break;
+		sock->txw_sqns = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* size of transmit window in seconds.
+ * 0 < secs < ( txw_sqns / txw_max_rte )
+ */
+	case PGM_TXW_SECS:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+			break;
+		sock->txw_secs = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* maximum transmit rate.
+ * 0 < txw_max_rte < interface capacity
+ *  10mb :   1250000
+ * 100mb :  12500000
+ *   1gb : 125000000
+ */
+	case PGM_TXW_MAX_RTE:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+			break;
+		sock->txw_max_rte = *(const int*)optval;
+/* default to controlling SPM, ODATA, and RDATA packets. */
+		sock->is_controlled_odata = TRUE;
+		sock->is_controlled_rdata = TRUE;
+		status = TRUE;
+		break;
+
+/* maximum original data rate.
+ * 0 < odata_max_rte < txw_max_rte
+ */
+	case PGM_ODATA_MAX_RTE:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+			break;
+		sock->odata_max_rte = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* maximum repair data rate.
+ * 0 < rdata_max_rte < txw_max_rte
+ */
+	case PGM_RDATA_MAX_RTE:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+			break;
+		sock->rdata_max_rte = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* ignore rate limit for original data packets, i.e. only apply to repairs.
+ */
+	case PGM_UNCONTROLLED_ODATA:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+			break;
+		sock->is_controlled_odata = (0 == *(const int*)optval);
+		status = TRUE;
+		break;
+
+/* ignore rate limit for repair data packets, i.e. only apply to original data.
+ */
+	case PGM_UNCONTROLLED_RDATA:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+			break;
+		sock->is_controlled_rdata = (0 == *(const int*)optval);
+		status = TRUE;
+		break;
+
+/* timeout for peers.
+ * 0 < 2 * spm_ambient_interval <= peer_expiry
+ */
+	case PGM_PEER_EXPIRY:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+			break;
+		sock->peer_expiry = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* 0 < after pgm_close_async() a connected source keeps answering NAKs with
+ * repairs and sending SPMs for this interval in microseconds before it is
+ * destroyed, so that receivers recover the tail of the stream.  0 = default,
+ * destroyed at once.  Set before connect.
+ */
+	case PGM_LINGER:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval < 0))
+			break;
+		sock->linger_ivl = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* release receive window storage of peers without data for this interval,
+ * windows are re-allocated on the next sequence.  0 = never.
+ */
+	case PGM_PEER_IDLE:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval < 0))
+			break;
+		sock->peer_idle_ivl = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* maximum APDU length beyond PGM_MAX_APDU and PGM_MAX_FRAGMENTS, a source is
+ * further limited by the transmit window.  receivers deliver such APDUs as
+ * consecutive chunks of at most PGM_MAX_FRAGMENTS fragments.  0 = disabled.
+ */
+	case PGM_LARGE_APDU:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval < 0))
+			break;
+		sock->large_apdu = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* interleave messages of all sources with data by arrival time of each message
+ * instead of reading each source in turn.  messages of one source remain in
+ * sequence order.
+ */
+	case PGM_MERGE_DELIVERY:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		sock->use_merge_delivery = (0 != *(const int*)optval);
+		status = TRUE;
+		break;
+
+/* deficit round-robin across sources with data, each turn of a source reads
+ * messages until this many bytes are delivered and the source then waits
+ * behind the others.  bounds the delay a bulk source adds to light sources.
+ * 0 = each source is read until empty.
+ */
+	case PGM_DELIVERY_QUANTUM:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval < 0))
+			break;
+		sock->delivery_quantum = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* sources of one stream published hot-hot, the first copy of each APDU key is delivered
+ * and later copies dropped.  loss from one of the sources does not reset the socket, a
+ * gap in the keys shows loss from all.  NAKs from these sources wait a further rr_nak_ivl
+ * for another source to fill the gap.  Set before bind.
+ */
+	case PGM_REDUNDANT_SOURCES:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_redundant_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		{
+			const struct pgm_redundant_req_t* rr = optval;
+			if (PGM_UNLIKELY(rr->rr_tsi_len > PGM_REDUNDANT_MAX_SOURCES))
+				break;
+			memcpy (&sock->redundant_req, rr, sizeof (struct pgm_redundant_req_t));
+		}
+		status = TRUE;
+		break;
+
+/* maximum back off range for listening for multicast SPMR.
+ * 0 < spmr_expiry < spm_ambient_interval
+ */
+	case PGM_SPMR_EXPIRY:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+			break;
+		sock->spmr_expiry = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* size of receive window in sequence numbers.
+ * 0 < rxw_sqns < one less than half sequence space
+ */
+	case PGM_RXW_SQNS:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval >= (int)((UINT32_MAX/2)-1)))
+			break;
+		sock->rxw_sqns = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* size of receive window in seconds.
+ * 0 < secs < ( rxw_sqns / rxw_max_rte )
+ */
+	case PGM_RXW_SECS:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+			break;
+		sock->rxw_secs = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* maximum receive rate, for determining window size with txw_secs.
+ * 0 < rxw_max_rte < interface capacity
+ */
+	case PGM_RXW_MAX_RTE:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+			break;
+		sock->rxw_max_rte = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* maximum NAK back-off value nak_rb_ivl in milliseconds.
+ * 0 < nak_rb_ivl <= nak_bo_ivl
+ */
+	case PGM_NAK_BO_IVL:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+			break;
+		sock->nak_bo_ivl = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* repeat interval prior to re-sending a NAK, in milliseconds.
+ */
+	case PGM_NAK_RPT_IVL:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+			break;
+		sock->nak_rpt_ivl = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* interval waiting for repair data, in milliseconds.
+ */
+	case PGM_NAK_RDATA_IVL:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+			break;
+		sock->nak_rdata_ivl = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* limit for data.
+ * 0 < nak_data_retries < 256
+ */
+	case PGM_NAK_DATA_RETRIES:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval > UINT8_MAX))
+			break;
+		sock->nak_data_retries = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* limit for NAK confirms.
+ * 0 < nak_ncf_retries < 256
+ */
+	case PGM_NAK_NCF_RETRIES:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval > UINT8_MAX))
+			break;
+		sock->nak_ncf_retries = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* 0 < abandon repair of a sequence missing for longer than n microseconds, it
+ * is then lost and skipped as if out of retries, bounding the delay later data
+ * waits behind it.  0 = default, repairs end only on retries.  Set before bind.
+ */
+	case PGM_DELIVERY_DEADLINE:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval < 0))
+			break;
+		sock->delivery_deadline = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* 0 < n <= 100, a receive window full of data the application has not read drops
+ * the oldest n percent of the window at once, extended to the next whole APDU, and
+ * continues without a reset.  the dropped range of each source is traced and
+ * recorded as PGM_EV_WINDOW_JUMP.  0 = default, the unread trail is lost a sequence
+ * at a time and the socket reset.  Set before bind.
+ */
+	case PGM_SLOW_CONSUMER_JUMP:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval < 0 || *(const int*)optval > 100))
+			break;
+		sock->slow_consumer_jump = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* Enable FEC for this sock, specifically Reed Solmon encoding RS(n,k), common
+ * setting is RS(255, 223).
+ *
+ * inputs:
+ *
+ * n = FEC Block size = [k+1, 255]
+ * k = original data packets == transmission group size = [2, 4, 8, 16, 32, 64, 128]
+ * m = symbol size = 8 bits
+ *
+ * outputs:
+ *
+ * h = 2t = n - k = parity packets
+ *
+ * when h > k parity packets can be lost.
+ */
+	case PGM_USE_FEC:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_fecinfo_t)))
+			break;
+		{
+			const struct pgm_fecinfo_t* fecinfo = optval;
+			if (PGM_UNLIKELY(0 != (fecinfo->group_size & (fecinfo->group_size - 1))))
+				break;
+			if (PGM_UNLIKELY(fecinfo->group_size < 2 || fecinfo->group_size > 128))
+				break;
+			if (PGM_UNLIKELY(fecinfo->group_size > fecinfo->block_size))
+				break;
+			const uint8_t parity_packets = fecinfo->block_size - fecinfo->group_size;
+/* technically could re-send previous packets */
+			if (PGM_UNLIKELY(fecinfo->proactive_packets > parity_packets))
+				break;
+/* check validity of parameters */
+			if (PGM_UNLIKELY(fecinfo->group_size > 223 && ((parity_packets * 223.0) / fecinfo->group_size) < 1.0))
+			{
+				pgm_error (_("k/h ratio too low to generate parity data."));
+				break;
+			}
+			sock->use_proactive_parity	= (fecinfo->proactive_packets > 0);
+			sock->use_ondemand_parity	= fecinfo->ondemand_parity_enabled;
+			sock->use_var_pktlen		= fecinfo->var_pktlen_enabled;
+			sock->rs_n			= fecinfo->block_size;
+			sock->rs_k			= fecinfo->group_size;
+			sock->rs_proactive_h		= fecinfo->proactive_packets;
+			sock->rs_proactive_max_h	= fecinfo->proactive_packets;
+			sock->tg_sqn_shift		= pgm_power2_log2 (fecinfo->group_size);
+		}
+		status = TRUE;
+		break;
+
+/* congestion reporting */
+	case PGM_USE_CR:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval <= 0))
+			break;
+		sock->crqst_ivl = *(const int*)optval;
+		sock->use_cr    = (sock->crqst_ivl > 0);
+		status = TRUE;
+		break;
+
+/* congestion control */
+	case PGM_USE_PGMCC:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_pgmccinfo_t)))
+			break;
+		{
+			const struct pgm_pgmccinfo_t* pgmccinfo = optval;
+			sock->ack_bo_ivl = pgmccinfo->ack_bo_ivl;
+			sock->ack_c      = pgmccinfo->ack_c;
+			sock->ack_c_p    = pgmccinfo->ack_c_p;
+			sock->use_pgmcc  = (sock->ack_c > 0);
+		}
+		status = TRUE;
+		break;
+
+/* declare socket only for sending, discard any incoming SPM, ODATA,
+ * RDATA, etc, packets.
+ */
+	case PGM_SEND_ONLY:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		sock->can_recv_data = (0 == *(const int*)optval);
+		status = TRUE;
+		break;
+
+/* declare socket only for receiving, no transmit window will be created
+ * and no SPM broadcasts sent.
+ */
+	case PGM_RECV_ONLY:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		sock->can_send_data = (0 == *(const int*)optval);
+		status = TRUE;
+		break;
+
+/* passive receiving socket, i.e. no back channel to source
+ */
+	case PGM_PASSIVE:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		sock->can_send_nak = (0 == *(const int*)optval);
+		status = TRUE;
+		break;
+
+/* on unrecoverable data loss stop socket from further transmission and
+ * receiving.
+ */
+	case PGM_ABORT_ON_RESET:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		sock->is_abort_on_reset = (0 != *(const int*)optval);
+		status = TRUE;
+		break;
+
+/* default non-blocking operation on send and receive sockets.
+ */
+	case PGM_NOBLOCK:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		sock->is_nonblocking = (0 != *(const int*)optval);
+		pgm_sockaddr_nonblocking (sock->send_sock, sock->is_nonblocking);
+		pgm_sockaddr_nonblocking (sock->send_with_router_alert_sock, sock->is_nonblocking);
+		status = TRUE;
+		break;
+
+/* sending group, singular.  note that the address is only stored and used
+ * later in sendto() calls, this routine only considers the interface.
+ */
+	case PGM_SEND_GROUP:
+	{
+		void*     restrict tmp_optval = optval; 
+		socklen_t          tmp_optlen = optlen; 
+
+/* Use OpenPGM enhanced struct with support for multiple IP addresses per interface. */
+		if (tmp_optlen == sizeof(struct pgm_group_source_req))
+		{
+			const struct pgm_group_source_req* gsr = tmp_optval;
+			struct group_req* gr = pgm_alloca (sizeof (struct group_req));
+/* copy contents to bypass byte packing differences */
+			gr->gr_interface = gsr->gsr_interface;
+			memcpy (&gr->gr_group, &gsr->gsr_group, sizeof (struct sockaddr_storage));
+			tmp_optval = gr;
+			tmp_optlen = sizeof(struct group_req);
+		}
+		if (tmp_optlen == sizeof(struct group_req))
+		{
+			memcpy (&sock->send_gsr, tmp_optval, sizeof(struct group_req));
+			if (PGM_UNLIKELY(sock->family != sock->send_gsr.gsr_group.ss_family))
+				break;
+/* multicast group for later usage with sendto() */
+			if (sock->udp_encap_mcast_port)
+				((struct sockaddr_in*)&sock->send_gsr.gsr_group)->sin_port = htons (sock->udp_encap_mcast_port);
+/* interface */
+			if ((SOCKET_ERROR == pgm_sockaddr_multicast_if (sock->send_sock,
+									   (const struct sockaddr*)&sock->send_addr,
+									   sock->send_gsr.gsr_interface)) ||
+			    (SOCKET_ERROR == pgm_sockaddr_multicast_if (sock->send_with_router_alert_sock,
+									   (const struct sockaddr*)&sock->send_addr,
+									   sock->send_gsr.gsr_interface)))
+			{
+				break;
+			}
+			else if (PGM_UNLIKELY(pgm_log_mask & PGM_LOG_ROLE_NETWORK))
+			{
+				char addr[INET6_ADDRSTRLEN];
+				pgm_sockaddr_ntop ((const struct sockaddr*)&sock->send_addr, addr, sizeof(addr));
+				pgm_trace (PGM_LOG_ROLE_NETWORK,_("Multicast send interface set to %s index %u"),
+					addr,
+					(unsigned)sock->send_gsr.gsr_interface);
+			}
+		}
+	}
+		status = TRUE;
+		break;
+
+/* for any-source applications (ASM), join a new group, also once connected.
+ */
+	case PGM_JOIN_GROUP:
+		if (PGM_UNLIKELY(!recv_gsr_reserve (sock, 1)))
+			break;
+	{
+		void*	  restrict tmp_optval = optval;
+		socklen_t	   tmp_optlen = optlen;
+
+/* Use OpenPGM enhanced struct with support for multiple IP addresses per interface. */
+		if (tmp_optlen == sizeof(struct pgm_group_source_req))
+		{
+			const struct pgm_group_source_req* gsr = tmp_optval;
+			struct group_req* gr = pgm_alloca (sizeof (struct group_req));
+/* copy contents to bypass byte packing differences */
+			gr->gr_interface = gsr->gsr_interface;
+			memcpy (&gr->gr_group, &gsr->gsr_group, sizeof (struct sockaddr_storage));
+			tmp_optval = gr;
+			tmp_optlen = sizeof(struct group_req);
 		}
 /* Use OS native RFC 3678 group request struct */
 		if (tmp_optlen == sizeof(struct group_req))
 		{
-			const struct group_req* gr = tmp_optval;
-/* verify not duplicate group/interface pairing */
-			for (unsigned i = 0; i < sock->recv_gsr_len; i++)
-			{
-				if (pgm_sockaddr_cmp ((const struct sockaddr*)&gr->gr_group, (struct sockaddr*)&sock->recv_gsr[i].gsr_group)  == 0 &&
-				    pgm_sockaddr_cmp ((const struct sockaddr*)&gr->gr_group, (struct sockaddr*)&sock->recv_gsr[i].gsr_source) == 0 &&
-					(gr->gr_interface == sock->recv_gsr[i].gsr_interface ||
-					                0 == sock->recv_gsr[i].gsr_interface   ))
-				{
-#ifdef SOCK_DEBUG
-					char s[INET6_ADDRSTRLEN];
-					pgm_sockaddr_ntop ((const struct sockaddr*)&gr->gr_group, s, sizeof(s));
-					if (sock->recv_gsr[i].gsr_interface) {
-						pgm_warn(_("Socket has already joined group %s on interface %u"), s, gr->gr_interface);
-					} else {
-						pgm_warn(_("Socket has already joined group %s on all interfaces."), s);
-					}
-#endif
+			const struct group_req* gr = tmp_optval;
+/* verify not duplicate group/interface pairing */
+			for (unsigned i = 0; i < sock->recv_gsr_len; i++)
+			{
+				if (pgm_sockaddr_cmp ((const struct sockaddr*)&gr->gr_group, (struct sockaddr*)&sock->recv_gsr[i].gsr_group)  == 0 &&
+				    pgm_sockaddr_cmp ((const struct sockaddr*)&gr->gr_group, (struct sockaddr*)&sock->recv_gsr[i].gsr_source) == 0 &&
+					(gr->gr_interface == sock->recv_gsr[i].gsr_interface ||
+					                0 == sock->recv_gsr[i].gsr_interface   ))
+				{
+#ifdef SOCK_DEBUG
+					char s[INET6_ADDRSTRLEN];
+					pgm_sockaddr_ntop ((const struct sockaddr*)&gr->gr_group, s, sizeof(s));
+					if (sock->recv_gsr[i].gsr_interface) {
+						pgm_warn(_("Socket has already joined group %s on interface %u"), s, gr->gr_interface);
+					} else {
+						pgm_warn(_("Socket has already joined group %s on all interfaces."), s);
+					}
+#endif
+					break;
+				}
+			}
+			sock->recv_gsr[sock->recv_gsr_len].gsr_interface = gr->gr_interface;
+			memcpy (&sock->recv_gsr[sock->recv_gsr_len].gsr_group, &gr->gr_group, pgm_sockaddr_len ((const struct sockaddr*)&gr->gr_group));
+			if (sock->udp_encap_mcast_port)
+				((struct sockaddr_in*)&sock->recv_gsr[sock->recv_gsr_len].gsr_group)->sin_port = htons (sock->udp_encap_mcast_port);
+			memcpy (&sock->recv_gsr[sock->recv_gsr_len].gsr_source, &gr->gr_group, pgm_sockaddr_len ((const struct sockaddr*)&gr->gr_group));
+/* Resolved address family gr->gr_group.ss_family can be different from sock->family = AF_UNSPEC */
+			if (SOCKET_ERROR == pgm_sockaddr_join_group (recv_sock_for_group (sock, (const struct sockaddr*)&gr->gr_group), gr->gr_group.ss_family, gr)) {
+#ifdef SOCK_DEBUG
+				const int save_errno = pgm_get_last_sock_error();
+				char errbuf[1024];
+				char s[INET6_ADDRSTRLEN];
+				pgm_sockaddr_ntop ((const struct sockaddr*)&gr->gr_group, s, sizeof(s));
+				pgm_error(_("Join multicast group { .gr_interface = %u, .gr_group = \"%s\" } failed: %s(%d)"),
+					gr->gr_interface, s,
+					pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno), save_errno);
+#endif
+				break;
+			}
+			else if (PGM_UNLIKELY(pgm_log_mask & PGM_LOG_ROLE_NETWORK))
+			{
+				char addr[INET6_ADDRSTRLEN];
+				pgm_sockaddr_ntop ((const struct sockaddr*)&gr->gr_group, addr, sizeof(addr));
+				pgm_trace (PGM_LOG_ROLE_NETWORK,_("Join multicast group %s on interface index %u"),
+					addr,
+					(unsigned)gr->gr_interface);
+			}
+#ifdef HAVE_INFINIBAND_VERBS_H
+			if (NULL != sock->verbs && sock->can_recv_data &&
+			    !pgm_verbs_join (sock->verbs, (const struct sockaddr*)&gr->gr_group))
+			{
+				char errbuf[1024];
+				pgm_trace (PGM_LOG_ROLE_NETWORK,_("RDMA multicast attach failed: %s"),
+					   pgm_sock_strerror_s (errbuf, sizeof (errbuf), errno));
+			}
+#endif
+#ifdef HAVE_RTE_ETHDEV_H
+			if (NULL != sock->dpdk &&
+			    !pgm_dpdk_join (sock->dpdk, (const struct sockaddr*)&gr->gr_group))
+			{
+				char errbuf[1024];
+				pgm_trace (PGM_LOG_ROLE_NETWORK,_("DPDK group filter failed: %s"),
+					   pgm_sock_strerror_s (errbuf, sizeof (errbuf), errno));
+			}
+#endif
+/* entry visible to the receive path */
+			pgm_mutex_lock (&sock->receiver_mutex);
+			sock->recv_gsr_len++;
+			pgm_mutex_unlock (&sock->receiver_mutex);
+		}
+	}
+		status = TRUE;
+		break;
+
+/* for any-source applications (ASM), leave a joined group, also once connected.
+ */
+	case PGM_LEAVE_GROUP:
+		if (PGM_UNLIKELY(optlen != sizeof(struct group_req)))
+			break;
+		if (PGM_UNLIKELY(0 == sock->recv_gsr_len))
+			break;
+		{
+			const struct group_req* gr = optval;
+			pgm_mutex_lock (&sock->receiver_mutex);
+			for (unsigned i = 0; i < sock->recv_gsr_len;)
+			{
+				if ((pgm_sockaddr_cmp ((const struct sockaddr*)&gr->gr_group, (struct sockaddr*)&sock->recv_gsr[i].gsr_group) == 0) &&
+/* drop all matching receiver entries */
+				            (gr->gr_interface == 0 ||
+/* drop all sources with matching interface */
+					     gr->gr_interface == sock->recv_gsr[i].gsr_interface) )
+				{
+					sock->recv_gsr_len--;
+					memmove (&sock->recv_gsr[i], &sock->recv_gsr[i+1], (sock->recv_gsr_len - i) * sizeof(struct group_source_req));
+					continue;
+				}
+				i++;
+			}
+			pgm_mutex_unlock (&sock->receiver_mutex);
+			if (PGM_UNLIKELY(sock->family != gr->gr_group.ss_family))
+				break;
+#ifdef HAVE_INFINIBAND_VERBS_H
+			if (NULL != sock->verbs && sock->can_recv_data)
+				pgm_verbs_leave (sock->verbs, (const struct sockaddr*)&gr->gr_group);
+#endif
+#ifdef HAVE_RTE_ETHDEV_H
+			if (NULL != sock->dpdk)
+				pgm_dpdk_leave (sock->dpdk, (const struct sockaddr*)&gr->gr_group);
+#endif
+			if (SOCKET_ERROR == pgm_sockaddr_leave_group (recv_sock_for_group (sock, (const struct sockaddr*)&gr->gr_group), sock->family, gr))
+				break;
+			else if (PGM_UNLIKELY(pgm_log_mask & PGM_LOG_ROLE_NETWORK))
+			{
+				char addr[INET6_ADDRSTRLEN];
+				pgm_sockaddr_ntop ((const struct sockaddr*)&gr->gr_group, addr, sizeof(addr));
+				pgm_trace (PGM_LOG_ROLE_NETWORK,_("Leave multicast group %s on interface index %u"),
+					addr,
+					(unsigned)gr->gr_interface);
+			}
+		}
+		status = TRUE;
+		break;
+
+/* for any-source applications (ASM), turn off a given source
+ */
+	case PGM_BLOCK_SOURCE:
+		if (PGM_UNLIKELY(optlen != sizeof(struct group_source_req)))
+			break;
+		{
+			const struct group_source_req* gsr = optval;
+			if (PGM_UNLIKELY(sock->family != gsr->gsr_group.ss_family))
+				break;
+			if (SOCKET_ERROR == pgm_sockaddr_block_source (recv_sock_for_group (sock, (const struct sockaddr*)&gsr->gsr_group), sock->family, gsr))
+				break;
+		}
+		status = TRUE;
+		break;
+
+/* for any-source applications (ASM), re-allow a blocked source
+ */
+	case PGM_UNBLOCK_SOURCE:
+		if (PGM_UNLIKELY(optlen != sizeof(struct group_source_req)))
+			break;
+		{
+			const struct group_source_req* gsr = optval;
+			if (PGM_UNLIKELY(sock->family != gsr->gsr_group.ss_family))
+				break;
+			if (SOCKET_ERROR == pgm_sockaddr_unblock_source (recv_sock_for_group (sock, (const struct sockaddr*)&gsr->gsr_group), sock->family, gsr))
+				break;
+		}
+		status = TRUE;
+		break;
+
+/* for controlled-source applications (SSM), join each group/source pair.
+ *
+ * SSM joins are allowed on top of ASM in order to merge a remote source onto the local segment.
+ */
+	case PGM_JOIN_SOURCE_GROUP:
+		if (PGM_UNLIKELY(optlen != sizeof(struct group_source_req)))
+			break;
+		if (PGM_UNLIKELY(!recv_gsr_reserve (sock, 1)))
+			break;
+		{
+			const struct group_source_req* gsr = optval;
+/* verify if existing group/interface pairing */
+			for (unsigned i = 0; i < sock->recv_gsr_len; i++)
+			{
+				if (pgm_sockaddr_cmp ((const struct sockaddr*)&gsr->gsr_group, (struct sockaddr*)&sock->recv_gsr[i].gsr_group) == 0 &&
+					(gsr->gsr_interface == sock->recv_gsr[i].gsr_interface ||
+					                  0 == sock->recv_gsr[i].gsr_interface   ))
+				{
+					if (pgm_sockaddr_cmp ((const struct sockaddr*)&gsr->gsr_source, (struct sockaddr*)&sock->recv_gsr[i].gsr_source) == 0)
+					{
+#ifdef SOCK_DEBUG
+						char s1[INET6_ADDRSTRLEN], s2[INET6_ADDRSTRLEN];
+						pgm_sockaddr_ntop ((const struct sockaddr*)&gsr->gsr_group, s1, sizeof(s1));
+						pgm_sockaddr_ntop ((const struct sockaddr*)&gsr->gsr_source, s2, sizeof(s2));
+						if (sock->recv_gsr[i].gsr_interface) {
+							pgm_warn(_("Socket has already joined group %s from source %s on interface %d"),
+								s1, s2, (unsigned)gsr->gsr_interface);
+						} else {
+							pgm_warn(_("Socket has already joined group %s from source %s on all interfaces"),
+								s1, s2);
+						}
+#endif
+						break;
+					}
+					break;
+				}
+			}
+			if (PGM_UNLIKELY(sock->family != gsr->gsr_group.ss_family))
+				break;
+			if (PGM_UNLIKELY(sock->family != gsr->gsr_source.ss_family))
+				break;
+			if (SOCKET_ERROR == pgm_sockaddr_join_source_group (recv_sock_for_group (sock, (const struct sockaddr*)&gsr->gsr_group), sock->family, gsr))
+				break;
+			memcpy (&sock->recv_gsr[sock->recv_gsr_len], gsr, sizeof(struct group_source_req));
+			sock->recv_gsr_len++;
+		}
+		status = TRUE;
+		break;
+
+/* for controlled-source applications (SSM), join an array of group/source pairs at
+ * once, optlen a multiple of struct group_source_req.  Each group is joined with its
+ * first source and the remaining sources set with one MCAST_MSFILTER include list,
+ * otherwise joined one at a time.  The kernel limits sources per group, on Linux
+ * net.ipv4.igmp_max_msf, and groups per socket, spread groups with PGM_RECV_SOCKETS.
+ * Stops at the first pair refused, earlier groups remain joined.
+ */
+	case PGM_JOIN_SOURCE_GROUPS:
+		if (PGM_UNLIKELY(0 == optlen || 0 != optlen % sizeof(struct group_source_req)))
+			break;
+		{
+			const unsigned count = optlen / sizeof(struct group_source_req);
+			if (PGM_UNLIKELY(!recv_gsr_reserve (sock, count)))
+				break;
+			if (!join_source_groups (sock, optval, count))
+				break;
+		}
+		status = TRUE;
+		break;
+
+/* for controlled-source applications (SSM), leave each group/source pair
+ */
+	case PGM_LEAVE_SOURCE_GROUP:
+		if (PGM_UNLIKELY(optlen != sizeof(struct group_source_req)))
+			break;
+		if (PGM_UNLIKELY(0 == sock->recv_gsr_len))
+			break;
+		{
+			const struct group_source_req* gsr = optval;
+/* verify if existing group/interface pairing */
+			for (unsigned i = 0; i < sock->recv_gsr_len; i++)
+			{
+				if (pgm_sockaddr_cmp ((const struct sockaddr*)&gsr->gsr_group, (struct sockaddr*)&sock->recv_gsr[i].gsr_group)   == 0 &&
+				    pgm_sockaddr_cmp ((const struct sockaddr*)&gsr->gsr_source, (struct sockaddr*)&sock->recv_gsr[i].gsr_source) == 0 &&
+				    gsr->gsr_interface == sock->recv_gsr[i].gsr_interface)
+				{
+					sock->recv_gsr_len--;
+					memmove (&sock->recv_gsr[i], &sock->recv_gsr[i+1], (sock->recv_gsr_len - i) * sizeof(struct group_source_req));
+					break;
+				}
+			}
+			if (PGM_UNLIKELY(sock->family != gsr->gsr_group.ss_family))
+				break;
+			if (PGM_UNLIKELY(sock->family != gsr->gsr_source.ss_family))
+				break;
+			if (SOCKET_ERROR == pgm_sockaddr_leave_source_group (recv_sock_for_group (sock, (const struct sockaddr*)&gsr->gsr_group), sock->family, gsr))
+				break;
+		}
+		status = TRUE;
+		break;
+
+/* batch block and unblock sources */
+	case PGM_MSFILTER:
+#if defined(MCAST_MSFILTER) || defined(SIOCSMSFILTER)
+		if (PGM_UNLIKELY(optlen < (socklen_t)sizeof(struct group_filter)))
+			break;
+		{
+			const struct group_filter* gf_list = optval;
+			if ((socklen_t)GROUP_FILTER_SIZE( gf_list->gf_numsrc ) != optlen)
+				break;
+			if (PGM_UNLIKELY(sock->family != gf_list->gf_group.ss_family))
+				break;
+/* check only first */
+			if (PGM_UNLIKELY(sock->family != gf_list->gf_slist[0].ss_family))
+				break;
+			if (SOCKET_ERROR == pgm_sockaddr_msfilter (recv_sock_for_group (sock, (const struct sockaddr*)&gf_list->gf_group), sock->family, gf_list))
+				break;
+		}
+		status = TRUE;
+#endif
+		break;
+
+/* UDP encapsulation ports */
+	case PGM_UDP_ENCAP_UCAST_PORT:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		sock->udp_encap_ucast_port = *(const int*)optval;
+		status = TRUE;
+		break;
+
+	case PGM_UDP_ENCAP_MCAST_PORT:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		sock->udp_encap_mcast_port = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* 0 < datagrams ≤ PGM_MAX_RECV_BATCH read per recvmmsg() call, 0 = default, one recvmsg() per datagram.
+ * silently falls back to recvmsg() where recvmmsg() is not available.
+ */
+	case PGM_RECV_BATCH:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval < 0 || *(const int*)optval > PGM_MAX_RECV_BATCH))
+			break;
+		sock->rx_batch_len = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* 0 < send ODATA batches as one UDP_SEGMENT super-datagram, 0 = default, sendmmsg().
+ * UDP encapsulation only, silently remains disabled where the kernel lacks support.
+ */
+	case PGM_UDP_GSO:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(IPPROTO_UDP != sock->protocol))
+			break;
+		sock->use_udp_gso = FALSE;
+#ifdef UDP_SEGMENT
+		if (0 != *(const int*)optval) {
+			int gso_size = 0;
+			socklen_t gso_len = sizeof (gso_size);
+			if (SOCKET_ERROR == getsockopt (sock->send_sock, SOL_UDP, UDP_SEGMENT, (char*)&gso_size, &gso_len))
+				pgm_trace (PGM_LOG_ROLE_NETWORK,_("UDP segmentation offload not supported by kernel."));
+			else
+				sock->use_udp_gso = TRUE;
+		}
+#endif
+		status = TRUE;
+		break;
+
+/* 0 < read coalesced UDP_GRO super-datagrams and segment in user space, 0 = default, one datagram per read.
+ * UDP encapsulation only, supersedes PGM_RECV_BATCH, silently remains disabled where the kernel lacks support.
+ */
+	case PGM_UDP_GRO:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(IPPROTO_UDP != sock->protocol))
+			break;
+		if (PGM_UNLIKELY(NULL != sock->rx_uring))
+			break;
+		sock->use_udp_gro = FALSE;
+#ifdef UDP_GRO
+		{
+			const int v = (0 != *(const int*)optval) ? 1 : 0;
+			if (SOCKET_ERROR == setsockopt (sock->recv_sock, SOL_UDP, UDP_GRO, (const char*)&v, sizeof(v)))
+				pgm_trace (PGM_LOG_ROLE_NETWORK,_("UDP receive offload not supported by kernel."));
+			else
+				sock->use_udp_gro = (0 != v);
+/* sockets without offload return plain datagrams, read as single segments */
+			for (unsigned i = 0; i < sock->recv_sock_extra_len; i++)
+				setsockopt (sock->recv_sock_extra[i], SOL_UDP, UDP_GRO, (const char*)&v, sizeof(v));
+		}
+#endif
+		status = TRUE;
+		break;
+
+/* 0 < send pgm_send_skbv() datagrams with MSG_ZEROCOPY, 0 = default, copy into the kernel.
+ * skbuffs are referenced until the kernel notifies completion on the error queue, silently
+ * remains disabled where the kernel lacks support.
+ */
+	case PGM_ZEROCOPY:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		sock->use_zerocopy = FALSE;
+#if defined(HAVE_LINUX_ERRQUEUE_H) && defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+		if (0 != *(const int*)optval && NULL == sock->tx_impair) {
+			const int v = 1;
+			if (SOCKET_ERROR == setsockopt (sock->send_sock, SOL_SOCKET, SO_ZEROCOPY, (const char*)&v, sizeof(v)))
+				pgm_trace (PGM_LOG_ROLE_NETWORK,_("Zero-copy transmit not supported by kernel."));
+			else {
+				if (NULL == sock->zc_skb)
+					sock->zc_skb = pgm_new0 (struct pgm_sk_buff_t*, PGM_ZEROCOPY_MAX_PENDING);
+				sock->use_zerocopy = TRUE;
+			}
+		}
+#endif
+		status = TRUE;
+		break;
+
+/* receive one shard of sources partitioned by TSI hash, such that sockets of one
+ * group on separate threads each own a disjoint set of peers, windows and timers.
+ * sr_count ≤ 1 = all sources, sr_index < sr_count.
+ */
+	case PGM_RECV_SHARD:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_shard_req_t)))
+			break;
+		{
+			const struct pgm_shard_req_t* sr = optval;
+			if (PGM_UNLIKELY(sr->sr_count > 1 && sr->sr_index >= sr->sr_count))
+				break;
+			sock->rx_shard_count = sr->sr_count > 1 ? sr->sr_count : 0;
+			sock->rx_shard_index = sr->sr_count > 1 ? sr->sr_index : 0;
+		}
+		status = TRUE;
+		break;
+
+/* 1 < receive on count kernel sockets sharing the port with SO_REUSEPORT, 1 = default.
+ * Multicast groups are partitioned across the sockets by address so each datagram
+ * is delivered once, unicast is balanced by the kernel.  UDP encapsulation only,
+ * set once before bind and before joining any group, count ≤ PGM_MAX_RECV_SOCKETS.
+ */
+	case PGM_RECV_SOCKETS:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(IPPROTO_UDP != sock->protocol))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound || sock->recv_gsr_len > 0 || sock->recv_sock_extra_len > 0))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval < 1 || *(const int*)optval > PGM_MAX_RECV_SOCKETS))
+			break;
+		if (!open_recv_sockets (sock, *(const int*)optval))
+			break;
+		status = TRUE;
+		break;
+
+/* 0 < spin for up to usecs on receive readiness before sleeping in poll, 0 = default, sleep.
+ * Also requests SO_BUSY_POLL and SO_PREFER_BUSY_POLL on the receive sockets, silently
+ * ignored where not supported or permitted, e.g. raising SO_BUSY_POLL needs CAP_NET_ADMIN.
+ */
+/* 0 < keep depth receive operations in flight on an io_uring instance, completions are
+ * reaped without a system call and replacements submitted in batches, 0 = default, disabled.
+ * Set before bind, silently remains disabled where the kernel lacks support or with PGM_UDP_GRO.
+ */
+	case PGM_IO_URING:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval < 0 || *(const int*)optval > PGM_MAX_URING_DEPTH))
+			break;
+		sock->rx_uring_depth = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* 0 < keep depth receive operations in flight through Windows Registered I/O, with depth
+ * registered send buffers for sources, completions are dequeued without a system call,
+ * 0 = default, disabled.  Set before bind, silently remains disabled before Windows 8.
+ */
+	case PGM_RIO:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval < 0 || *(const int*)optval > PGM_MAX_RIO_DEPTH))
+			break;
+		sock->rio_depth = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* steer IPv4 datagrams of the socket from one device receive queue through an XDP program
+ * into an AF_XDP socket, bypassing the kernel network stack, xr_interface 0 = default, disabled.
+ * Datagrams with IP options or fragments, and IPv6, continue through the receive sockets.
+ * Set before bind, requires CAP_NET_ADMIN and CAP_BPF, disabled with a trace on failure.
+ */
+	case PGM_XDP_RECV:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_xdp_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		{
+			const struct pgm_xdp_req_t* xr = optval;
+			if (PGM_UNLIKELY(xr->xr_frames > PGM_XDP_MAX_FRAMES ||
+					 0 != (xr->xr_frames & (xr->xr_frames - 1))))
+				break;
+			if (PGM_UNLIKELY(0 != (xr->xr_flags & ~PGM_XDP_GENERIC)))
+				break;
+			memcpy (&sock->rx_xdp_req, xr, sizeof (struct pgm_xdp_req_t));
+		}
+		status = TRUE;
+		break;
+
+/* read PGM/IP datagrams of one interface from a PACKET_MMAP TPACKET_V3 ring in blocks
+ * rather than one recvmsg() each, tr_interface 0 = default, disabled.  Blocks are handed
+ * over when full or after tr_timeout milliseconds.  The raw receive sockets discard
+ * datagrams whilst the ring is open, fragmented datagrams are lost.  Set before bind,
+ * requires CAP_NET_RAW, IPv4 without UDP encapsulation, disabled with a trace on failure.
+ */
+	case PGM_TPACKET_RECV:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_tpacket_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		{
+			const struct pgm_tpacket_req_t* tr = optval;
+			if (PGM_UNLIKELY(0 != tr->tr_block_size &&
+					 (tr->tr_block_size < PGM_TPACKET_MIN_BLOCK_SIZE ||
+					  tr->tr_block_size > PGM_TPACKET_MAX_BLOCK_SIZE ||
+					  0 != (tr->tr_block_size & (tr->tr_block_size - 1)))))
+				break;
+			if (PGM_UNLIKELY(tr->tr_blocks > PGM_TPACKET_MAX_BLOCKS ||
+					 tr->tr_timeout > PGM_TPACKET_MAX_TIMEOUT))
+				break;
+			memcpy (&sock->rx_tpacket_req, tr, sizeof (struct pgm_tpacket_req_t));
+		}
+		status = TRUE;
+		break;
+
+/* discard datagrams in the kernel before they reach the receive socket buffers: other
+ * data-destination ports than the socket's and PGM_JOIN_DPORT sessions, packet types outside
+ * fr_types and sources outside fr_gsi.  The socket's own GSI is added for NAKs and SPMRs
+ * when sending.  Attached at connect, disabled with a trace on failure.
+ */
+	case PGM_RECV_FILTER:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_filter_req_t)))
+			break;
+		{
+			const struct pgm_filter_req_t* fr = optval;
+			const uint32_t types = PGM_FILTER_TYPE(PGM_SPM)  | PGM_FILTER_TYPE(PGM_POLL) |
+					       PGM_FILTER_TYPE(PGM_POLR) | PGM_FILTER_TYPE(PGM_ODATA) |
+					       PGM_FILTER_TYPE(PGM_RDATA) | PGM_FILTER_TYPE(PGM_NAK) |
+					       PGM_FILTER_TYPE(PGM_NNAK) | PGM_FILTER_TYPE(PGM_NCF) |
+					       PGM_FILTER_TYPE(PGM_SPMR) | PGM_FILTER_TYPE(PGM_ACK);
+			if (PGM_UNLIKELY(0 != (fr->fr_types & ~types)))
+				break;
+			if (PGM_UNLIKELY(fr->fr_gsi_len > PGM_FILTER_MAX_GSI))
+				break;
+			memcpy (&sock->rx_filter_req, fr, sizeof (struct pgm_filter_req_t));
+			sock->use_recv_filter = TRUE;
+		}
+		status = TRUE;
+		break;
+
+/* receive only the listed sources, or all but the listed sources, a TSI of sport 0 matching
+ * every session of its GSI.  Checked before a peer is created so that unwanted sources cost
+ * neither receive window nor NAKs, and compiled into the receive socket filter where
+ * available.  sf_len 0 = all sources.
+ */
+	case PGM_SOURCE_FILTER:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_source_filter_req_t)))
+			break;
+		{
+			const struct pgm_source_filter_req_t* sf = optval;
+			if (PGM_UNLIKELY(PGM_SOURCE_ALLOW != sf->sf_mode && PGM_SOURCE_DENY != sf->sf_mode))
+				break;
+			if (PGM_UNLIKELY(sf->sf_len > PGM_SOURCE_FILTER_MAX))
+				break;
+			memcpy (&sock->rx_source_filter, sf, sizeof (struct pgm_source_filter_req_t));
+/* GSI wildcard first, then its sessions */
+			qsort (sock->rx_source_filter.sf_tsi, sf->sf_len, sizeof (pgm_tsi_t), source_filter_cmp);
+		}
+		status = TRUE;
+		break;
+
+/* record every sent and received datagram of the socket to a pcapng file of cr_size bytes,
+ * cr_size 0 = PGM_CAPTURE_DEFAULT_SIZE, oldest packets are overwritten once full.  cr_path
+ * empty = default, disabled.  Set before bind, disabled with a trace on failure.
+ */
+	case PGM_CAPTURE:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_capture_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		{
+			const struct pgm_capture_req_t* cr = optval;
+			if (PGM_UNLIKELY(NULL == memchr (cr->cr_path, '\0', sizeof (cr->cr_path))))
+				break;
+			memcpy (&sock->capture_req, cr, sizeof (struct pgm_capture_req_t));
+		}
+		status = TRUE;
+		break;
+
+/* 0 < encode proactive parity on a worker thread per socket, sent by the repair path as
+ * ready, 0 = default, encoded on the repair path.  Set before bind, silently remains
+ * disabled without proactive parity or if the thread cannot be created.
+ */
+	case PGM_FEC_WORKER:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		sock->use_fec_worker = (0 != *(const int*)optval);
+		status = TRUE;
+		break;
+
+/* sliding window FEC: every repair_interval original data packets a repair packet is sent
+ * coding the last window_size packets, receivers recover any losses no more numerous than
+ * the repairs covering them without waiting on a transmission group boundary.  Set before
+ * bind, 2 <= window_size <= PGM_RLC_MAX_WINDOW, 1 <= repair_interval <= window_size.
+ */
+	case PGM_USE_SLIDING_FEC:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_sw_fecinfo_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		{
+			const struct pgm_sw_fecinfo_t* sw_fecinfo = optval;
+			if (PGM_UNLIKELY(sw_fecinfo->window_size < 2 || sw_fecinfo->window_size > PGM_RLC_MAX_WINDOW))
+				break;
+			if (PGM_UNLIKELY(sw_fecinfo->repair_interval < 1 || sw_fecinfo->repair_interval > sw_fecinfo->window_size))
+				break;
+			sock->use_sliding_fec	= TRUE;
+			sock->sw_window		= sw_fecinfo->window_size;
+			sock->sw_interval	= sw_fecinfo->repair_interval;
+		}
+		status = TRUE;
+		break;
+
+/* 0 < space TPDUs at the configured rate limits rather than permitting a millisecond
+ * burst at line rate, 0 = default, bursting token bucket.  Set before bind.  Also
+ * requests SO_MAX_PACING_RATE at the total rate limit on the send sockets so a fq
+ * qdisc paces in-kernel, silently ignored where not supported.
+ */
+	case PGM_PACING:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		sock->use_pacing = (0 != *(const int*)optval);
+		status = TRUE;
+		break;
+
+/* 0 < run SPM, NAK and NCF timers, repairs and the receive windows on an internal thread
+ * so they progress whilst the application is not inside a receive call, 0 = default,
+ * driven from the application receive calls.  Set before bind.  Contiguous data is
+ * signalled on the pending notification for the application to read.
+ */
+	case PGM_TIMER_THREAD:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		sock->use_timer_thread = (0 != *(const int*)optval);
+		status = TRUE;
+		break;
+
+/* 0 < run the timer thread of PGM_TIMER_THREAD on a pool shared by all such sockets of
+ * the process, each pool thread waiting on one epoll set for many sockets, 0 = default.
+ * Enabling implies PGM_TIMER_THREAD, falling back to a dedicated thread without epoll.
+ * Set before bind.
+ */
+	case PGM_TIMER_POOL:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		sock->use_timer_pool = (0 != *(const int*)optval);
+		if (sock->use_timer_pool)
+			sock->use_timer_thread = TRUE;
+		status = TRUE;
+		break;
+
+/* dr_func called on the timer thread with each batch of complete APDUs as soon as
+ * the receive windows have them, in place of pgm_recvmsgv() which then fails.  a
+ * reset is a call with the tsi of the lost source and no messages, further
+ * delivery stops if PGM_ABORT_ON_RESET is set.  dr_func NULL = default, disabled.
+ * Enabling implies PGM_TIMER_THREAD, without a timer thread at bind the callback
+ * is cleared.  Set before bind.
+ */
+	case PGM_DELIVERY_CALLBACK:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_delivery_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		memcpy (&sock->delivery_req, optval, sizeof (struct pgm_delivery_req_t));
+		if (NULL != sock->delivery_req.dr_func)
+			sock->use_timer_thread = TRUE;
+		status = TRUE;
+		break;
+
+/* 0 < the timer thread publishes complete APDUs into a lock-free ring of n slots, a
+ * power of two of at least 2, taken on any number of threads with pgm_handoff_recv()
+ * in place of pgm_recvmsgv() which then fails.  each APDU holds a reference on its
+ * skbuffs until given back with pgm_handoff_release(), a full ring leaves data in the
+ * receive windows.  0 = default, disabled.  Enabling implies PGM_TIMER_THREAD, not available
+ * with PGM_DELIVERY_CALLBACK.  Set before bind.
+ */
+	case PGM_HANDOFF_RING:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		{
+			const int n = *(const int*)optval;
+			if (PGM_UNLIKELY(n < 0 || (n > 0 && n < PGM_HANDOFF_MIN_SLOTS) || n > PGM_HANDOFF_MAX_SLOTS || 0 != (n & (n - 1))))
+				break;
+			sock->handoff_len = (unsigned)n;
+			if (n > 0)
+				sock->use_timer_thread = TRUE;
+		}
+		status = TRUE;
+		break;
+
+/* 0 < declare the application the only thread calling into the socket, 0 = default.  the
+ * socket locks on the send and receive paths are skipped and skbuffs from the socket's pools
+ * carry plain reference counts, such skbuffs must be freed or released on the same thread.
+ * Set before bind, the timer thread, FEC threads and multi-producer ring are disabled.
+ */
+	case PGM_SINGLE_THREADED:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		sock->is_single_threaded = (0 != *(const int*)optval);
+		status = TRUE;
+		break;
+
+/* 0 < provide a timerfd as PGM_TIMER_SOCK armed at the next timer expiration with
+ * microsecond resolution, to poll beside the receive sockets in place of a millisecond
+ * timeout from PGM_TIME_REMAIN, 0 = default.  re-armed as receive calls would block.
+ * Set before bind, Linux only, disabled with a trace on failure.
+ */
+	case PGM_TIMER_FD:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+#ifdef HAVE_SYS_TIMERFD_H
+		sock->use_timer_fd = (0 != *(const int*)optval);
+		status = TRUE;
+#endif
+		break;
+
+/* 1 = stamp received packets with SO_TIMESTAMPING kernel software time, 2 = NIC hardware time
+ * where available, 0 = default, user-space time only.  the interface must be configured for
+ * hardware receive time stamps separately, e.g. hwstamp_ctl, and the PHC synchronised to the
+ * system clock.  set before bind, silently remains disabled where the kernel lacks support.
+ */
+	case PGM_TIMESTAMPING:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		{
+			const int v = *(const int*)optval;
+			if (PGM_UNLIKELY(v < 0 || v > 2))
+				break;
+			sock->timestamping = 0;
+#if defined(HAVE_LINUX_NET_TSTAMP_H) && defined(SO_TIMESTAMPING)
+			if (SOCKET_ERROR == set_timestamping (sock->recv_sock, (unsigned)v))
+				pgm_trace (PGM_LOG_ROLE_NETWORK,_("Receive time stamps not supported by kernel."));
+			else
+				sock->timestamping = (unsigned)v;
+#endif
+		}
+		status = TRUE;
+		break;
+
+/* 1 = stamp sent ODATA with SO_TIMESTAMPING kernel software time at the qdisc and the
+ * driver, 2 = also NIC hardware time, 0 = default, disabled.  stamps are read from the
+ * error queue of the data socket by the send calls and matched to the transmit window
+ * by sequence, each stage is recorded as time since the pgm_send() call in sampled
+ * histograms.  additional PGM_SEND_PATHS sockets are not stamped.  set before bind,
+ * silently remains disabled where the kernel lacks support.
+ */
+	case PGM_TX_TIMESTAMPING:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		{
+			const int v = *(const int*)optval;
+			if (PGM_UNLIKELY(v < 0 || v > 2))
+				break;
+			sock->tx_timestamping = 0;
+#if defined(HAVE_LINUX_ERRQUEUE_H) && defined(HAVE_LINUX_NET_TSTAMP_H) && defined(SO_TIMESTAMPING)
+			if (SOCKET_ERROR == set_tx_timestamping (sock->send_sock, (unsigned)v))
+				pgm_trace (PGM_LOG_ROLE_NETWORK,_("Transmit time stamps not supported by kernel."));
+			else
+				sock->tx_timestamping = (unsigned)v;
+#endif
+		}
+		status = TRUE;
+		break;
+
+/* PGM_CHECKSUM_ALWAYS = default, verify every received packet.  PGM_CHECKSUM_NEVER for
+ * trusted segments, PGM_CHECKSUM_UDP_TRUSTED skips datagrams the host UDP stack or NIC has
+ * verified, not those read through AF_XDP, and relies upon senders not disabling UDP
+ * checksums.  PGM_CHECKSUM_LAZY verifies ODATA only once it is not a duplicate.
+ * PGM_CHECKSUM_DELIVERY holds ODATA in the receive window unverified and verifies
+ * while pgm_recvfrom() copies out, a mismatch is then unrecoverable loss of that APDU.
+ * FEC sockets fall back to lazy verification as parity must be built from good data.
+ */
+	case PGM_RX_CHECKSUM:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		{
+			const int v = *(const int*)optval;
+			if (PGM_UNLIKELY(v < PGM_CHECKSUM_ALWAYS || v > PGM_CHECKSUM_DELIVERY))
+				break;
+			sock->rx_checksum = (unsigned)v;
+		}
+		status = TRUE;
+		break;
+
+/* PGM_CHECKSUM_ALWAYS = default, checksum sent data.  PGM_CHECKSUM_UDP_TRUSTED sends ODATA
+ * and RDATA with a zero, "no checksum", PGM checksum relying on the UDP checksum the host
+ * or NIC computes, UDP encapsulation only.  Receivers discard such data unless their
+ * PGM_RX_CHECKSUM is PGM_CHECKSUM_UDP_TRUSTED or PGM_CHECKSUM_NEVER, so both ends must
+ * opt in.  Set before bind.
+ */
+	case PGM_TX_CHECKSUM:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		{
+			const int v = *(const int*)optval;
+			if (PGM_UNLIKELY(PGM_CHECKSUM_ALWAYS != v && PGM_CHECKSUM_UDP_TRUSTED != v))
+				break;
+			if (PGM_UNLIKELY(PGM_CHECKSUM_UDP_TRUSTED == v && 0 == sock->udp_encap_ucast_port))
+				break;
+			sock->tx_checksum = (unsigned)v;
+		}
+		status = TRUE;
+		break;
+
+/* round transmit and receive windows up to a power of two sequence numbers so that
+ * slots index with a mask rather than a division.  costs up to double the pointer
+ * array, 8 bytes per sequence on 64-bit, plus any skbuffs held in the extra slots.
+ */
+	case PGM_POW2_WINDOWS:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		sock->use_pow2_windows = (0 != *(const int*)optval);
+		status = TRUE;
+		break;
+
+/* back transmit and receive windows and their skbuff slabs with huge pages and
+ * prefer a NUMA node, that of the sending interface device or of the thread calling
+ * pgm_bind().  Reserved huge pages fall back to transparent huge pages when the
+ * pool is short.  Set before bind.
+ */
+	case PGM_MEM_POLICY:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_mem_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		{
+			const struct pgm_mem_req_t* mr = optval;
+			if (PGM_UNLIKELY(mr->mr_pages > PGM_MEM_PAGES_1GB))
+				break;
+			if (PGM_UNLIKELY(mr->mr_node < PGM_MEM_NODE_LOCAL))
+				break;
+			memcpy (&sock->mem_req, mr, sizeof (struct pgm_mem_req_t));
+		}
+		status = TRUE;
+		break;
+
+/* 0 < store transmit window packets in a contiguous ring of this many bytes, each
+ * entry trimmed to its packet length, 0 = default, max_tpdu sized pool skbuffs.
+ * Size to the window's span in bytes, packets beyond the ring use the heap.
+ * Set before bind.
+ */
+	case PGM_TXW_RING:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval < 0))
+			break;
+		sock->txw_ring_len = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* 0 < copy received data packets that fit a 256, 512 or 1024 byte size class into
+ * a skbuff of that class before the receive window, recycling the max_tpdu receive
+ * buffer, 0 = default, max_tpdu skbuffs are held.  Set before bind.
+ */
+	case PGM_RX_SIZE_CLASSES:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		sock->use_rx_size_classes = (0 != *(const int*)optval);
+		status = TRUE;
+		break;
+
+/* coalesce APDUs sent by pgm_send_batch() into TPDUs of up to br_size bytes, each
+ * message prefixed by its length, sent once full or br_ivl microseconds after the
+ * first, 0 = on size or pgm_send_flush() only.  br_size 0 = default, disabled.
+ * Receivers unpack OPT_BATCH packets into one APDU per message.  Not available
+ * with FEC, parity recovery does not restore the option.  Set before bind.
+ */
+	case PGM_SEND_BATCH:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_batch_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		memcpy (&sock->batch_req, optval, sizeof (struct pgm_batch_req_t));
+		status = TRUE;
+		break;
+
+/* compress APDUs of pgm_send() whole with cr_type at cr_level, sent with OPT_COMPRESS
+ * when smaller, primed with the cr_dict_len byte dictionary cr_dict identified by
+ * cr_dict_id, which receivers must also hold.  Receivers decompress every available
+ * type given the matching dictionary, or none for cr_dict_id 0, and discard others.
+ * cr_type PGM_COMPRESS_NONE = default, disabled, compressed APDUs are discarded.  Not available
+ * for sending with FEC, parity recovery does not restore the option.  Set before bind.
+ */
+	case PGM_COMPRESS:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_compress_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		{
+			const struct pgm_compress_req_t* cr = optval;
+			if (PGM_UNLIKELY(PGM_COMPRESS_NONE != cr->cr_type && !pgm_compress_is_supported (cr->cr_type)))
+				break;
+			if (PGM_UNLIKELY(cr->cr_dict_id > UINT16_MAX ||
+					 (0 == cr->cr_dict_id) != (0 == cr->cr_dict_len) ||
+					 (cr->cr_dict_len && NULL == cr->cr_dict)))
+				break;
+			if (sock->compress_dict)
+				pgm_free (sock->compress_dict);
+			memcpy (&sock->compress_req, cr, sizeof (struct pgm_compress_req_t));
+			sock->compress_dict = cr->cr_dict_len ? pgm_memdup (cr->cr_dict, cr->cr_dict_len) : NULL;
+			sock->compress_req.cr_dict = sock->compress_dict;
+		}
+		status = TRUE;
+		break;
+
+/* 0 < keep up to sr_size bytes of complete but unread messages per source in
+ * an unlinked file of directory sr_dir, memory mapped, when the receive window
+ * fills, and deliver them ahead of the window.  Messages are otherwise lost as
+ * the window advances.  The file is created on first use, a message a full log
+ * cannot hold is lost.  sr_size 0 = default, disabled.  Set before bind.
+ */
+	case PGM_SPILL:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_spill_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		{
+			const struct pgm_spill_req_t* sr = optval;
+			if (sock->spill_dir)
+				pgm_free (sock->spill_dir);
+			memcpy (&sock->spill_req, sr, sizeof (struct pgm_spill_req_t));
+			sock->spill_dir = sr->sr_dir ? pgm_strdup (sr->sr_dir) : NULL;
+			sock->spill_req.sr_dir = sock->spill_dir;
+		}
+		status = TRUE;
+		break;
+
+/* 0 < conflate a last-value feed keyed by the cf_len bytes at cf_offset of each
+ * APDU: receivers keep only the newest undelivered APDU of a key and abandon
+ * repair of superseded sequences.  APDUs of pgm_send() that fit one TPDU carry
+ * the key with OPT_CONFLATE linking the previous APDU of the key, not with FEC,
+ * the send queue or multi-producer ring.  Receivers otherwise read the key from
+ * the payload of whole uncompressed APDUs.  cf_len 0 = default, disabled, to at
+ * most 8.  Set before bind.
+ */
+	case PGM_CONFLATE:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_conflate_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		{
+			const struct pgm_conflate_req_t* cf = optval;
+			if (PGM_UNLIKELY(cf->cf_len > sizeof (uint64_t)))
+				break;
+			memcpy (&sock->conflate_req, cf, sizeof (struct pgm_conflate_req_t));
+		}
+		status = TRUE;
+		break;
+
+/* 0 < fragments of APDUs up to pr_apdu bytes are copied at arrival to their
+ * offset in a buffer of the pr_len byte application region at pr_base, such
+ * that pgm_recvmsg() returns each APDU as one skbuff in the region.  Checksums
+ * deferred to delivery are verified with the copy.  When the region is
+ * exhausted buffers come from the heap.  pr_len 0 = default, disabled.  Set
+ * before bind.
+ */
+	case PGM_PLACEMENT:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_placement_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		{
+			const struct pgm_placement_req_t* pr = optval;
+			if (PGM_UNLIKELY(pr->pr_len && (NULL == pr->pr_base || 0 == pr->pr_apdu)))
+				break;
+			memcpy (&sock->placement_req, pr, sizeof (struct pgm_placement_req_t));
+		}
+		status = TRUE;
+		break;
+
+/* multi-stream source, the socket sends on the send sockets of the bound source
+ * sr_sock, as of PGM_SEND_GROUP interface and options, and within its
+ * TXW_MAX_RTE, divided between the sources of the group by sr_weight.  a source
+ * past its share borrows rate left idle by the others.  each source keeps its
+ * own TSI, transmit window and SPMs, with PGM_TIMER_POOL of sr_sock the timers
+ * of the group share one thread.  sr_sock NULL sets the weight of a source
+ * joined by others.  Set before bind.
+ */
+	case PGM_STREAM_GROUP:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_stream_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		memcpy (&sock->stream_req, optval, sizeof (struct pgm_stream_req_t));
+		status = TRUE;
+		break;
+
+/* append every APDU delivered by the receive calls to log segments <rr_path>.<n>.log of
+ * up to rr_segment_size bytes with an index of TSI, sequence and time in <rr_path>.<n>.idx,
+ * rr_segment_size 0 = PGM_RECORD_DEFAULT_SEGMENT.  rr_path empty = default, disabled.  Set
+ * before bind, disabled with a trace on failure.
+ */
+	case PGM_RECORD:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_record_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		{
+			const struct pgm_record_req_t* rr = optval;
+			if (PGM_UNLIKELY(NULL == memchr (rr->rr_path, '\0', sizeof (rr->rr_path))))
+				break;
+			memcpy (&sock->record_req, rr, sizeof (struct pgm_record_req_t));
+		}
+		status = TRUE;
+		break;
+
+/* test impairment in ir_direction PGM_IMPAIR_RX and or PGM_IMPAIR_TX: Gilbert-Elliott
+ * loss moving to the bad state with probability ir_p and back with ir_r, losing
+ * ir_loss_good or ir_loss_bad of datagrams in each state, duplicating ir_duplicate and
+ * holding ir_reorder a further ir_reorder_delay µs, all parts per million, and a delay
+ * of ir_delay ± ir_jitter µs.  the default is the PGM_IMPAIR environment variable read
+ * by pgm_init(), otherwise disabled.  Set before bind.
+ */
+	case PGM_IMPAIR:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_impair_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		{
+			const struct pgm_impair_req_t* ir = optval;
+			if (PGM_UNLIKELY(ir->ir_p > 1000000 || ir->ir_r > 1000000 ||
+					 ir->ir_loss_good > 1000000 || ir->ir_loss_bad > 1000000 ||
+					 ir->ir_duplicate > 1000000 || ir->ir_reorder > 1000000))
+				break;
+			memcpy (&sock->impair_req, ir, sizeof (struct pgm_impair_req_t));
+		}
+		status = TRUE;
+		break;
+
+/* 0 < sp_len further interfaces of a source, sp_mode PGM_PATH_DUPLICATE sends each
+ * datagram to the send group on the bound interface and every path, receivers
+ * joining the group on more than one interface discard the duplicates by
+ * sequence number.  PGM_PATH_STRIPE spreads the datagrams across the interfaces
+ * in turn.  SPMs, NCFs and unicast datagrams take the bound interface alone.
+ * sp_len 0 = default, disabled.  Set before bind.
+ */
+	case PGM_SEND_PATHS:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_send_path_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		{
+			const struct pgm_send_path_req_t* sp = optval;
+			if (PGM_UNLIKELY(sp->sp_len >= PGM_MAX_SEND_PATHS))
+				break;
+			if (PGM_UNLIKELY(sp->sp_len > 0 &&
+					 PGM_PATH_DUPLICATE != sp->sp_mode &&
+					 PGM_PATH_STRIPE != sp->sp_mode))
+				break;
+			unsigned i;
+			for (i = 0; i < sp->sp_len; i++)
+				if (PGM_UNLIKELY(AF_UNSPEC != sp->sp_if[i].ir_address.ss_family &&
+						 sock->family != sp->sp_if[i].ir_address.ss_family))
+					break;
+			if (PGM_UNLIKELY(i < sp->sp_len))
+				break;
+			memcpy (&sock->send_path_req, sp, sizeof (struct pgm_send_path_req_t));
+		}
+		status = TRUE;
+		break;
+
+/* priority class pr_class 1 to 3 for pgm_send_priority(), paced by its own
+ * pr_max_rte bytes per second overdrafting TXW_MAX_RTE rather than queueing
+ * behind original data, each datagram marked with traffic class pr_tos, -1 for
+ * the socket PGM_TOS.  pr_max_rte 0 = default, disabled.  Set before bind.
+ */
+	case PGM_PRIORITY_CLASS:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_priority_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		{
+			const struct pgm_priority_req_t* pr = optval;
+			if (PGM_UNLIKELY(pr->pr_class < 1 || pr->pr_class >= PGM_PRIORITY_CLASSES))
+				break;
+			if (PGM_UNLIKELY(pr->pr_tos < -1 || pr->pr_tos > UINT8_MAX))
+				break;
+			memcpy (&sock->priority_req[pr->pr_class], pr, sizeof (struct pgm_priority_req_t));
+		}
+		status = TRUE;
+		break;
+
+/* 0 < receivers report their contiguous lead to each source every at_ivl
+ * microseconds, a source releases transmit window data every reporter holds
+ * once sent at_retention microseconds ago, with at least at_receivers
+ * reporting.  A receiver silent for four intervals is forgotten.  Release is
+ * otherwise by TXW_SQNS or TXW_SECS.  at_ivl 0 = default, disabled.  Set before
+ * bind.
+ */
+	case PGM_ACK_TRAIL:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_ack_trail_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		memcpy (&sock->ack_trail_req, optval, sizeof (struct pgm_ack_trail_req_t));
+		status = TRUE;
+		break;
+
+/* 0 < receivers report their unused receive window and application read rate to
+ * each source every cr_ivl microseconds.  a source lowers its PGM_ODATA_MAX_RTE
+ * to the slowest of an election set of the cr_receivers slowest reporters, each
+ * taking its read rate plus its unused window over one interval.  A receiver
+ * silent for four intervals is forgotten.  cr_ivl 0 = default, disabled.  Set
+ * before bind, a source requires PGM_ODATA_MAX_RTE.
+ */
+	case PGM_CREDIT:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_credit_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		if (PGM_UNLIKELY(((const struct pgm_credit_req_t*)optval)->cr_receivers > PGM_CREDIT_MAX))
+			break;
+		memcpy (&sock->credit_req, optval, sizeof (struct pgm_credit_req_t));
+		status = TRUE;
+		break;
+
+/* 0 < a source repairs each receiver, by the IP source of its NAKs, for at most
+ * nl_rate sequences per second with bursts of nl_burst, 0 = nl_rate.  sequences over
+ * the limit are ignored for the receiver to repeat, a receiver with nl_demote of them
+ * since last forgiven is demoted to nl_action: PGM_NAK_LIMIT_UNICAST repairs it by
+ * unicast without an NCF to the group, PGM_NAK_LIMIT_IGNORE ignores its NAKs.  A
+ * receiver within its limit for nl_restore microseconds is forgiven, 0 = never.  Up to
+ * PGM_NAK_LIMIT_RECEIVERS are tracked, the least recently NAKing is forgotten first.
+ * nl_rate 0 = default, disabled.  Set before bind.
+ */
+	case PGM_NAK_LIMIT:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_nak_limit_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		{
+			const struct pgm_nak_limit_req_t* nl = optval;
+			if (PGM_UNLIKELY(PGM_NAK_LIMIT_UNICAST != nl->nl_action && PGM_NAK_LIMIT_IGNORE != nl->nl_action))
+				break;
+			memcpy (&sock->nak_limit_req, nl, sizeof (struct pgm_nak_limit_req_t));
+			if (0 == sock->nak_limit_req.nl_burst)
+				sock->nak_limit_req.nl_burst = sock->nak_limit_req.nl_rate;
+		}
+		status = TRUE;
+		break;
+
+/* 0 < fr_len unicast receivers of a source on a network without multicast, every
+ * datagram to the send group: ODATA, RDATA, SPMs and NCFs, is sent to each
+ * fr_addr instead from the one transmit window, framed and checksummed once.
+ * NAKs naming a receiver address as group NLA are accepted as for the group.
+ * An fr_addr port of 0 takes the port of the send group.  fr_len 0 = default,
+ * disabled.  Set before bind.
+ */
+	case PGM_UNICAST_FANOUT:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_fanout_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		{
+			const struct pgm_fanout_req_t* fr = optval;
+			if (PGM_UNLIKELY(fr->fr_len > PGM_MAX_FANOUT))
+				break;
+			unsigned i;
+			for (i = 0; i < fr->fr_len; i++)
+				if (PGM_UNLIKELY(sock->family != fr->fr_addr[i].ss_family ||
+						 pgm_sockaddr_is_addr_multicast ((const struct sockaddr*)&fr->fr_addr[i])))
 					break;
-				}
-			}
-			sock->recv_gsr[sock->recv_gsr_len].gsr_interface = gr->gr_interface;
-			memcpy (&sock->recv_gsr[sock->recv_gsr_len].gsr_group, &gr->gr_group, pgm_sockaddr_len ((const struct sockaddr*)&gr->gr_group));
-			if (sock->udp_encap_mcast_port)
-				((struct sockaddr_in*)&sock->recv_gsr[sock->recv_gsr_len].gsr_group)->sin_port = htons (sock->udp_encap_mcast_port);
-			memcpy (&sock->recv_gsr[sock->recv_gsr_len].gsr_source, &gr->gr_group, pgm_sockaddr_len ((const struct sockaddr*)&gr->gr_group));
-/* Resolved address family gr->gr_group.ss_family can be different from sock->family = AF_UNSPEC */
-			if (SOCKET_ERROR == pgm_sockaddr_join_group (sock->recv_sock, gr->gr_group.ss_family, gr)) {
-#ifdef SOCK_DEBUG
-				const int save_errno = pgm_get_last_sock_error();
-				char errbuf[1024];
-				char s[INET6_ADDRSTRLEN];
-				pgm_sockaddr_ntop ((const struct sockaddr*)&gr->gr_group, s, sizeof(s));
-				pgm_error(_("Join multicast group { .gr_interface = %u, .gr_group = \"%s\" } failed: %s(%d)"),
-					gr->gr_interface, s,
-					pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno), save_errno);
-#endif
+			if (PGM_UNLIKELY(i < fr->fr_len))
 				break;
-			}
-			else if (PGM_UNLIKELY(pgm_log_mask & PGM_LOG_ROLE_NETWORK))
-			{
-				char addr[INET6_ADDRSTRLEN];
-				pgm_sockaddr_ntop ((const struct sockaddr*)&gr->gr_group, addr, sizeof(addr));
-				pgm_trace (PGM_LOG_ROLE_NETWORK,_("Join multicast group %s on interface index %u"),
-					addr,
-					(unsigned)gr->gr_interface);
-			}
-			sock->recv_gsr_len++;
+			memcpy (&sock->fanout_req, fr, sizeof (struct pgm_fanout_req_t));
 		}
-	}
 		status = TRUE;
 		break;
 
-/* for any-source applications (ASM), leave a joined group.
+/* post datagrams to and receive from the socket groups on an RDMA unreliable datagram
+ * queue pair of device vr_device port vr_port, bypassing the kernel network stack.
+ * RoCE addresses an IPv4 group by its IPv4-mapped GID with vr_gid_index a RoCE v2 IPv4
+ * GID, InfiniBand requires the subnet manager to hold the groups under vr_mlid.  Unicast
+ * datagrams continue through the sockets, as do sends whilst every work request is
+ * outstanding.  UDP encapsulation only, vr_port 0 = default, disabled.  Set before bind,
+ * disabled with a trace on failure to open at connect.
  */
-	case PGM_LEAVE_GROUP:
-		if (PGM_UNLIKELY(optlen != sizeof(struct group_req)))
+	case PGM_VERBS:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_verbs_req_t)))
 			break;
-		if (PGM_UNLIKELY(0 == sock->recv_gsr_len))
+		if (PGM_UNLIKELY(sock->is_bound))
 			break;
 		{
-			const struct group_req* gr = optval;
-			for (unsigned i = 0; i < sock->recv_gsr_len;)
-			{
-				if ((pgm_sockaddr_cmp ((const struct sockaddr*)&gr->gr_group, (struct sockaddr*)&sock->recv_gsr[i].gsr_group) == 0) &&
-/* drop all matching receiver entries */
-				            (gr->gr_interface == 0 ||
-/* drop all sources with matching interface */
-					     gr->gr_interface == sock->recv_gsr[i].gsr_interface) )
-				{
-					sock->recv_gsr_len--;
-					if (i < (IP_MAX_MEMBERSHIPS - 1))
-					{
-						memmove (&sock->recv_gsr[i], &sock->recv_gsr[i+1], (sock->recv_gsr_len - i) * sizeof(struct group_source_req));
-						continue;
-					}
-				}
-				i++;
-			}
-			if (PGM_UNLIKELY(sock->family != gr->gr_group.ss_family))
+			const struct pgm_verbs_req_t* vr = optval;
+			if (PGM_UNLIKELY(0 != vr->vr_port && 0 == sock->udp_encap_ucast_port))
 				break;
-			if (SOCKET_ERROR == pgm_sockaddr_leave_group (sock->recv_sock, sock->family, gr))
+			if (PGM_UNLIKELY(vr->vr_depth > PGM_VERBS_MAX_DEPTH ||
+					 0 != (vr->vr_depth & (vr->vr_depth - 1))))
 				break;
-			else if (PGM_UNLIKELY(pgm_log_mask & PGM_LOG_ROLE_NETWORK))
-			{
-				char addr[INET6_ADDRSTRLEN];
-				pgm_sockaddr_ntop ((const struct sockaddr*)&gr->gr_group, addr, sizeof(addr));
-				pgm_trace (PGM_LOG_ROLE_NETWORK,_("Leave multicast group %s on interface index %u"),
-					addr,
-					(unsigned)gr->gr_interface);
-			}
+			if (PGM_UNLIKELY(vr->vr_mlid > UINT16_MAX))
+				break;
+			if (PGM_UNLIKELY(NULL == memchr (vr->vr_device, '\0', sizeof (vr->vr_device))))
+				break;
+			memcpy (&sock->verbs_req, vr, sizeof (struct pgm_verbs_req_t));
 		}
 		status = TRUE;
 		break;
 
-/* for any-source applications (ASM), turn off a given source
+/* frame every datagram onto queue dr_queue of DPDK ethdev dr_device, polled by
+ * pgm_recv() on the calling lcore without the kernel.  PGM_DPDK_CONFIGURE starts
+ * the port with the one queue, otherwise the application configures the port
+ * and may poll one socket per queue.  The interface address answers ARP and the
+ * link address of unicast peers is learnt, datagrams continue through the
+ * sockets whilst unresolved.  IPv4 only, the EAL initialised by the application
+ * and non-blocking operation, dr_device "" = default, disabled.  Set before bind,
+ * disabled with a trace on failure to open at connect.
  */
-	case PGM_BLOCK_SOURCE:
-		if (PGM_UNLIKELY(optlen != sizeof(struct group_source_req)))
+	case PGM_DPDK:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_dpdk_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
 			break;
 		{
-			const struct group_source_req* gsr = optval;
-			if (PGM_UNLIKELY(sock->family != gsr->gsr_group.ss_family))
+			const struct pgm_dpdk_req_t* dr = optval;
+			if (PGM_UNLIKELY(NULL == memchr (dr->dr_device, '\0', sizeof (dr->dr_device))))
+				break;
+			if (PGM_UNLIKELY('\0' != dr->dr_device[0] && AF_INET != sock->family))
 				break;
-			if (SOCKET_ERROR == pgm_sockaddr_block_source (sock->recv_sock, sock->family, gsr))
+			if (PGM_UNLIKELY(dr->dr_depth > PGM_DPDK_MAX_DEPTH ||
+					 0 != (dr->dr_depth & (dr->dr_depth - 1))))
 				break;
+			if (PGM_UNLIKELY(dr->dr_queue > UINT16_MAX ||
+					 ((dr->dr_flags & PGM_DPDK_CONFIGURE) && 0 != dr->dr_queue)))
+				break;
+			memcpy (&sock->dpdk_req, dr, sizeof (struct pgm_dpdk_req_t));
 		}
 		status = TRUE;
 		break;
 
-/* for any-source applications (ASM), re-allow a blocked source
+/* 0 < original data of up to n bytes without options, or as one fragment of an
+ * APDU up to 64KB, is sent as PGM_CDATA to OpenPGM receivers: the GSI elided as
+ * implied by the source address and port, sequence numbers as 16-bit deltas and
+ * the fragment option in short form, announced by OPT_COMPACT on every SPM.  The
+ * checksum is that of the standard encoding which receivers restore.  Repairs
+ * and other packets keep the standard headers.  UDP encapsulation only, 0 =
+ * default, disabled.  Set before bind.
  */
-	case PGM_UNBLOCK_SOURCE:
-		if (PGM_UNLIKELY(optlen != sizeof(struct group_source_req)))
+	case PGM_COMPACT:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
 			break;
 		{
-			const struct group_source_req* gsr = optval;
-			if (PGM_UNLIKELY(sock->family != gsr->gsr_group.ss_family))
+			const int v = *(const int*)optval;
+			if (PGM_UNLIKELY(v < 0 || v > UINT16_MAX))
 				break;
-			if (SOCKET_ERROR == pgm_sockaddr_unblock_source (sock->recv_sock, sock->family, gsr))
+			if (PGM_UNLIKELY(0 != v && 0 == sock->udp_encap_ucast_port))
 				break;
+			sock->compact_tsdu = (unsigned)v;
 		}
 		status = TRUE;
 		break;
 
-/* for controlled-source applications (SSM), join each group/source pair.
- *
- * SSM joins are allowed on top of ASM in order to merge a remote source onto the local segment.
+/* 0 < budget of bytes in packet buffers of the transmit window and every peer
+ * receive window, counted with the process budget of pgm_mem_set_budget().
+ * Whilst either budget is reached new peers are refused, idle receive windows
+ * are compacted sooner and the transmit window stops growing.  0 = default,
+ * unlimited.
  */
-	case PGM_JOIN_SOURCE_GROUP:
-		if (PGM_UNLIKELY(optlen != sizeof(struct group_source_req)))
+	case PGM_MEM_BUDGET:
+		if (PGM_UNLIKELY(optlen != sizeof (uint64_t)))
+			break;
+		pgm_budget_set_limit (&sock->budget, *(const uint64_t*)optval);
+		status = TRUE;
+		break;
+
+/* 0 < queue up to n APDUs of pgm_send() blocked by the rate limit, kernel or
+ * congestion window, copied and sent in order by the timer, 0 = default,
+ * disabled, the blocked call is repeated with the same APDU.  Completion is
+ * signalled on PGM_SEND_QUEUE_SOCK as the queue drains, or regains space after
+ * pgm_send() returns blocked on a full queue.  Set before bind.
+ */
+	case PGM_SEND_QUEUE:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval < 0))
+			break;
+		sock->sendq_max = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* 0 < publish pgm_send() calls of one TPDU from concurrent threads through a
+ * ring of n slots, a power of two: each call takes a ticket with an atomic add,
+ * copies and checksums its payload unlocked, and returns once sent in ticket
+ * order, 0 = default, disabled.  Blocking sockets only, non-blocking calls and
+ * larger APDUs take the serialised path.  Not available with congestion
+ * control, PGM_SEND_QUEUE or PGM_SEND_BATCH.  Set before bind.
+ */
+	case PGM_MULTI_PRODUCER:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
 			break;
-		if (PGM_UNLIKELY(sock->recv_gsr_len >= IP_MAX_MEMBERSHIPS))
+		if (PGM_UNLIKELY(sock->is_bound))
 			break;
 		{
-			const struct group_source_req* gsr = optval;
-/* verify if existing group/interface pairing */
-			for (unsigned i = 0; i < sock->recv_gsr_len; i++)
-			{
-				if (pgm_sockaddr_cmp ((const struct sockaddr*)&gsr->gsr_group, (struct sockaddr*)&sock->recv_gsr[i].gsr_group) == 0 &&
-					(gsr->gsr_interface == sock->recv_gsr[i].gsr_interface ||
-					                  0 == sock->recv_gsr[i].gsr_interface   ))
-				{
-					if (pgm_sockaddr_cmp ((const struct sockaddr*)&gsr->gsr_source, (struct sockaddr*)&sock->recv_gsr[i].gsr_source) == 0)
-					{
-#ifdef SOCK_DEBUG
-						char s1[INET6_ADDRSTRLEN], s2[INET6_ADDRSTRLEN];
-						pgm_sockaddr_ntop ((const struct sockaddr*)&gsr->gsr_group, s1, sizeof(s1));
-						pgm_sockaddr_ntop ((const struct sockaddr*)&gsr->gsr_source, s2, sizeof(s2));
-						if (sock->recv_gsr[i].gsr_interface) {
-							pgm_warn(_("Socket has already joined group %s from source %s on interface %d"),
-								s1, s2, (unsigned)gsr->gsr_interface);
-						} else {
-							pgm_warn(_("Socket has already joined group %s from source %s on all interfaces"),
-								s1, s2);
-						}
-#endif
-						break;
-					}
-					break;
-				}
-			}
-			if (PGM_UNLIKELY(sock->family != gsr->gsr_group.ss_family))
+			const int n = *(const int*)optval;
+			if (PGM_UNLIKELY(n < 0 || n > PGM_MP_MAX_SLOTS || 0 != (n & (n - 1))))
 				break;
-			if (PGM_UNLIKELY(sock->family != gsr->gsr_source.ss_family))
+			sock->mp_len = (unsigned)n;
+		}
+		status = TRUE;
+		break;
+
+/* 0 < msecs <= 60s, size SO_SNDBUF from PGM_TXW_MAX_RTE and SO_RCVBUF from
+ * PGM_RXW_MAX_RTE to hold msecs of traffic plus one rate regulation burst,
+ * replacing explicit sizes.  Uses SO_SNDBUFFORCE and SO_RCVBUFFORCE where
+ * permitted, effective sizes are read back with SO_SNDBUF and SO_RCVBUF.
+ * 0 = default, off.  Set before bind.
+ */
+	case PGM_AUTO_BUFFERS:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval < 0 || *(const int*)optval > 60 * 1000))
+			break;
+		sock->autobuf_msecs = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* algorithm driven by PGMCC ACKs, requires PGM_USE_PGMCC to take effect.
+ */
+	case PGM_CONGESTION_CONTROL:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		{
+			const int v = *(const int*)optval;
+			if (PGM_UNLIKELY(v < PGM_CC_PGMCC || v > PGM_CC_BBR))
+				break;
+			sock->cc_algorithm = (unsigned)v;
+		}
+		status = TRUE;
+		break;
+
+/* scale NAK back-off, repeat and RDATA intervals per peer from the measured
+ * NAK to NCF and NCF to RDATA round trip times, the configured intervals
+ * become ceilings.
+ */
+	case PGM_NAK_ADAPTIVE:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		sock->use_nak_adaptive = (0 != *(const int*)optval);
+		status = TRUE;
+		break;
+
+/* hold NAKs for an interval in microseconds so that requests from many receivers
+ * share NCF lists and repairs, 0 confirms and queues each NAK on arrival.
+ */
+	case PGM_NAK_AGGREGATE_IVL:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval < 0))
+			break;
+		sock->nak_aggregate_ivl = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* proactive parity from 0 up to the PGM_USE_FEC proactive packet count, or the
+ * full parity count when zero, following the loss reported by receivers.
+ */
+	case PGM_FEC_ADAPTIVE:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		sock->use_adaptive_fec = (0 != *(const int*)optval);
+		status = TRUE;
+		break;
+
+/* 0 < threads ≤ PGM_MAX_FEC_DECODE_THREADS reconstructing transmission groups from parity,
+ * 0 = default, decode inline on the receive thread.
+ */
+	case PGM_FEC_DECODE_THREADS:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval < 0 || *(const int*)optval > PGM_MAX_FEC_DECODE_THREADS))
+			break;
+		sock->fec_decode_threads = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* retain every sent data packet in a memory-mapped file of ts_sqns records, 0 =
+ * PGM_TXW_STORE_DEFAULT_SQNS, repairing selective NAKs from beyond the transmit window.
+ * A file of the same TSI resumes the sequence space of the previous session.  ts_path
+ * empty = default, disabled.  Set before bind, disabled with a trace on failure.
+ */
+	case PGM_TXW_STORE:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_txw_store_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		{
+			const struct pgm_txw_store_req_t* ts = optval;
+			if (PGM_UNLIKELY(NULL == memchr (ts->ts_path, '\0', sizeof (ts->ts_path))))
+				break;
+			memcpy (&sock->txw_store_req, ts, sizeof (struct pgm_txw_store_req_t));
+		}
+		status = TRUE;
+		break;
+
+/* on joining a session request up to cu_sqns sequences of the advertised transmit
+ * window from the source as unicast RDATA, NAKs for them are held for cu_ivl
+ * microseconds, 0 = PGM_CATCHUP_DEFAULT_IVL.  cu_sqns 0 = default, disabled.
+ */
+	case PGM_CATCHUP:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_catchup_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		{
+			const struct pgm_catchup_req_t* cu = optval;
+			sock->catchup_sqns = cu->cu_sqns;
+			sock->catchup_ivl  = cu->cu_ivl ? cu->cu_ivl : PGM_CATCHUP_DEFAULT_IVL;
+		}
+		status = TRUE;
+		break;
+
+/* serve catch-up requests of receivers as unicast RDATA limited to bytes per second,
+ * independent of the multicast rate limit.  0 = default, catch-up requests ignored.
+ */
+	case PGM_CATCHUP_RATE:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval < 0))
+			break;
+		sock->catchup_max_rte = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* act as designated local repairer for every source, retaining dr_sqns sequences of
+ * original data to answer NAKs redirected by advertisements multicast each dr_ivl
+ * microseconds, 0 = PGM_DLR_DEFAULT_IVL.  repairs are limited to dr_max_rte bytes
+ * per second, requests beyond the history or rate are forwarded to the source.
+ */
+	case PGM_DLR:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_dlr_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		{
+			const struct pgm_dlr_req_t* dr = optval;
+			if (PGM_UNLIKELY(dr->dr_max_rte > INT32_MAX))
 				break;
-			if (SOCKET_ERROR == pgm_sockaddr_join_source_group (sock->recv_sock, sock->family, gsr))
+			sock->dlr_sqns    = dr->dr_sqns;
+			sock->dlr_ivl     = dr->dr_ivl ? dr->dr_ivl : PGM_DLR_DEFAULT_IVL;
+			sock->dlr_max_rte = dr->dr_max_rte;
+		}
+		status = TRUE;
+		break;
+
+/* receive original data of a source on the same host from its PGM_TXW_STORE file at
+ * sr_path, new records are copied without the network stack whilst the network socket
+ * serves SPMs, repairs and other sources.  the source should disable PGM_MULTICAST_LOOP.
+ * a waiting receiver polls every sr_ivl microseconds, 0 = PGM_SHM_DEFAULT_IVL.
+ * requires UDP encapsulation or IPv6.  sr_path empty = default, disabled.  Set before
+ * bind, disabled with a trace on failure.
+ */
+	case PGM_SHM_RECV:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_shm_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		{
+			const struct pgm_shm_req_t* sr = optval;
+			if (PGM_UNLIKELY(NULL == memchr (sr->sr_path, '\0', sizeof (sr->sr_path))))
 				break;
-			memcpy (&sock->recv_gsr[sock->recv_gsr_len], gsr, sizeof(struct group_source_req));
-			sock->recv_gsr_len++;
+			memcpy (&sock->shm_req, sr, sizeof (struct pgm_shm_req_t));
+			sock->rx_shm_ivl = sr->sr_ivl ? sr->sr_ivl : PGM_SHM_DEFAULT_IVL;
 		}
 		status = TRUE;
 		break;
 
-/* for controlled-source applications (SSM), leave each group/source pair
+/* record for each source the first sequence the application has not read, with the
+ * source NLA and SPM sequence, in the shared memory segment wr_name of up to wr_sources
+ * sources, 0 = PGM_RESTART_DEFAULT_SOURCES.  The segment outlives the process: a
+ * receiver reopening it resumes each returning source at its recorded sequence and NAKs
+ * only what was missed, without waiting for an SPM.  Data received but not read is
+ * requested again.  One socket per segment, the segment is removed by the application.
+ * wr_name empty = default, disabled.  Set before bind, disabled with a trace on failure.
  */
-	case PGM_LEAVE_SOURCE_GROUP:
-		if (PGM_UNLIKELY(optlen != sizeof(struct group_source_req)))
+	case PGM_WARM_RESTART:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_warm_restart_req_t)))
 			break;
-		if (PGM_UNLIKELY(0 == sock->recv_gsr_len))
+		if (PGM_UNLIKELY(sock->is_bound))
 			break;
 		{
-			const struct group_source_req* gsr = optval;
-/* verify if existing group/interface pairing */
-			for (unsigned i = 0; i < sock->recv_gsr_len; i++)
-			{
-				if (pgm_sockaddr_cmp ((const struct sockaddr*)&gsr->gsr_group, (struct sockaddr*)&sock->recv_gsr[i].gsr_group)   == 0 &&
-				    pgm_sockaddr_cmp ((const struct sockaddr*)&gsr->gsr_source, (struct sockaddr*)&sock->recv_gsr[i].gsr_source) == 0 &&
-				    gsr->gsr_interface == sock->recv_gsr[i].gsr_interface)
-				{
-					sock->recv_gsr_len--;
-					if (i < (IP_MAX_MEMBERSHIPS - 1))
-					{
-						memmove (&sock->recv_gsr[i], &sock->recv_gsr[i+1], (sock->recv_gsr_len - i) * sizeof(struct group_source_req));
-						break;
-					}
-				}
-			}
-			if (PGM_UNLIKELY(sock->family != gsr->gsr_group.ss_family))
+			const struct pgm_warm_restart_req_t* wr = optval;
+			if (PGM_UNLIKELY(NULL == memchr (wr->wr_name, '\0', sizeof (wr->wr_name))))
 				break;
-			if (PGM_UNLIKELY(sock->family != gsr->gsr_source.ss_family))
+			if (PGM_UNLIKELY(wr->wr_sources > PGM_RESTART_MAX_SOURCES))
 				break;
-			if (SOCKET_ERROR == pgm_sockaddr_leave_source_group (sock->recv_sock, sock->family, gsr))
+			memcpy (&sock->warm_restart_req, wr, sizeof (struct pgm_warm_restart_req_t));
+		}
+		status = TRUE;
+		break;
+
+/* publish each APDU as it is read to the shared memory ring lr_name of lr_slots TSDU
+ * records, 0 = PGM_LOCAL_DEFAULT_SLOTS, so processes on this host consume the session
+ * with pgm_local_attach() and pgm_local_recvmsgv() without receive windows or NAKs of
+ * their own.  The socket must still be read.  Consumers never hold back the socket, one
+ * falling a ring behind reads a reset.  lr_name empty = default, disabled.  Set before
+ * bind, receive sockets only, disabled with a trace on failure.
+ */
+	case PGM_LOCAL_PUBLISH:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_local_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		{
+			const struct pgm_local_req_t* lr = optval;
+			if (PGM_UNLIKELY(NULL == memchr (lr->lr_name, '\0', sizeof (lr->lr_name))))
 				break;
+			if (PGM_UNLIKELY(lr->lr_slots > PGM_LOCAL_MAX_SLOTS))
+				break;
+			memcpy (&sock->local_req, lr, sizeof (struct pgm_local_req_t));
 		}
 		status = TRUE;
 		break;
 
-/* batch block and unblock sources */
-	case PGM_MSFILTER:
-#if defined(MCAST_MSFILTER) || defined(SIOCSMSFILTER)
-		if (PGM_UNLIKELY(optlen < (socklen_t)sizeof(struct group_filter)))
+/* bind as hot standby of the source writing the PGM_TXW_STORE file on this host,
+ * adopting its TSI.  The store is polled every sb_ivl microseconds whilst the socket
+ * stays silent and sends return PGM_IO_STATUS_WOULD_BLOCK.  Once the writing process
+ * exits, or with sb_timeout the store has not advanced for sb_timeout microseconds,
+ * the socket takes over the store and continues the session at the next sequence,
+ * repairing from the stored history.  sb_timeout should exceed PGM_AMBIENT_SPM.
+ * sb_ivl 0 = default, disabled.  Set before bind, send sockets only.
+ */
+	case PGM_STANDBY:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_standby_req_t)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		memcpy (&sock->standby_req, optval, sizeof (struct pgm_standby_req_t));
+		status = TRUE;
+		break;
+
+/* send from pt_count UDP ports starting at pt_base so receive side scaling on the
+ * receivers hashes the traffic onto more than one queue.  pt_mode PGM_PORTS_PER_TSI
+ * binds the one data socket to the port of the range chosen by the TSI, spreading
+ * the sources of a host.  PGM_PORTS_PER_TG sends ODATA and RDATA of each transmission
+ * group from the next port in turn, groups of the FEC block size or otherwise of
+ * PGM_PORTS_TG_SQNS sequences, spreading one source whilst each group stays in order
+ * on one queue.  pt_base 0 takes ephemeral ports, PGM_PORTS_PER_TG only.  SPMs, NCFs
+ * and unicast datagrams take the first port, a vector sent with one system call
+ * takes the port of its first datagram.  pt_mode 0 = default, disabled.  UDP
+ * encapsulation only, set before bind, not with PGM_SEND_PATHS or PGM_STREAM_GROUP.
+ */
+	case PGM_SEND_PORTS:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_send_port_req_t)))
+			break;
+		if (PGM_UNLIKELY(IPPROTO_UDP != sock->protocol))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
 			break;
 		{
-			const struct group_filter* gf_list = optval;
-			if ((socklen_t)GROUP_FILTER_SIZE( gf_list->gf_numsrc ) != optlen)
+			const struct pgm_send_port_req_t* pt = optval;
+			if (PGM_UNLIKELY(0 != pt->pt_mode &&
+					 PGM_PORTS_PER_TSI != pt->pt_mode &&
+					 PGM_PORTS_PER_TG != pt->pt_mode))
 				break;
-			if (PGM_UNLIKELY(sock->family != gf_list->gf_group.ss_family))
+			if (PGM_UNLIKELY(0 != pt->pt_mode &&
+					 (pt->pt_count < 1 || pt->pt_count > PGM_MAX_SEND_PORTS)))
 				break;
-/* check only first */
-			if (PGM_UNLIKELY(sock->family != gf_list->gf_slist[0].ss_family))
+			if (PGM_UNLIKELY(PGM_PORTS_PER_TSI == pt->pt_mode && 0 == pt->pt_base))
 				break;
-			if (SOCKET_ERROR == pgm_sockaddr_msfilter (sock->recv_sock, sock->family, gf_list))
+			if (PGM_UNLIKELY(0 != pt->pt_base &&
+					 (uint32_t)pt->pt_base + pt->pt_count - 1 > UINT16_MAX))
 				break;
+			memcpy (&sock->send_port_req, pt, sizeof (struct pgm_send_port_req_t));
 		}
 		status = TRUE;
-#endif
 		break;
 
-/* UDP encapsulation ports */
-	case PGM_UDP_ENCAP_UCAST_PORT:
+/* receive sessions addressed to another data-destination port on this socket, sources are
+ * demultiplexed on TSI into their own receive windows whilst the descriptors, buffers and
+ * timers are shared.  NAKs and SPMRs carry the port of the session.  may be set at any
+ * time, once connected a PGM_RECV_FILTER program is rebuilt for the new ports.
+ */
+	case PGM_JOIN_DPORT:
 		if (PGM_UNLIKELY(optlen != sizeof (int)))
 			break;
-		sock->udp_encap_ucast_port = *(const int*)optval;
+		if (PGM_UNLIKELY(*(const int*)optval <= 0 || *(const int*)optval > UINT16_MAX))
+			break;
+		{
+			const in_port_t dport = htons ((uint16_t)*(const int*)optval);
+			unsigned i = 0;
+			pgm_mutex_lock (&sock->receiver_mutex);
+			while (i < sock->rx_dports_len && sock->rx_dports[i] < dport)
+				i++;
+			if (i == sock->rx_dports_len || sock->rx_dports[i] != dport) {
+				sock->rx_dports = pgm_realloc (sock->rx_dports, (sock->rx_dports_len + 1) * sizeof (in_port_t));
+				memmove (&sock->rx_dports[i + 1], &sock->rx_dports[i], (sock->rx_dports_len - i) * sizeof (in_port_t));
+				sock->rx_dports[i] = dport;
+				sock->rx_dports_len++;
+			}
+			pgm_mutex_unlock (&sock->receiver_mutex);
+		}
+#ifdef PGM_HAVE_RECV_FILTER
+		if (sock->is_connected &&
+		    (sock->use_recv_filter || sock->rx_source_filter.sf_len > 0))
+			pgm_recv_filter_attach (sock);
+#endif
 		status = TRUE;
 		break;
 
-	case PGM_UDP_ENCAP_MCAST_PORT:
+/* stop receiving a port added by PGM_JOIN_DPORT, its sessions expire as silent peers.
+ */
+	case PGM_LEAVE_DPORT:
 		if (PGM_UNLIKELY(optlen != sizeof (int)))
 			break;
-		sock->udp_encap_mcast_port = *(const int*)optval;
+		if (PGM_UNLIKELY(*(const int*)optval <= 0 || *(const int*)optval > UINT16_MAX))
+			break;
+		{
+			const in_port_t dport = htons ((uint16_t)*(const int*)optval);
+			unsigned i = 0;
+			pgm_mutex_lock (&sock->receiver_mutex);
+			while (i < sock->rx_dports_len && sock->rx_dports[i] != dport)
+				i++;
+			if (i < sock->rx_dports_len) {
+				sock->rx_dports_len--;
+				memmove (&sock->rx_dports[i], &sock->rx_dports[i + 1], (sock->rx_dports_len - i) * sizeof (in_port_t));
+				status = TRUE;
+			}
+			pgm_mutex_unlock (&sock->receiver_mutex);
+		}
+#ifdef PGM_HAVE_RECV_FILTER
+		if (status && sock->is_connected &&
+		    (sock->use_recv_filter || sock->rx_source_filter.sf_len > 0))
+			pgm_recv_filter_attach (sock);
+#endif
+		break;
+
+	case PGM_BUSY_POLL:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval < 0))
+			break;
+		sock->busy_poll_usecs = *(const int*)optval;
+#ifdef SO_BUSY_POLL
+		{
+			const int v = *(const int*)optval, prefer = (v > 0) ? 1 : 0;
+			for (unsigned i = 0; i <= sock->recv_sock_extra_len; i++) {
+				const SOCKET recv_sock = (0 == i) ? sock->recv_sock : sock->recv_sock_extra[i - 1];
+				if (SOCKET_ERROR == setsockopt (recv_sock, SOL_SOCKET, SO_BUSY_POLL, (const char*)&v, sizeof(v)))
+					pgm_trace (PGM_LOG_ROLE_NETWORK,_("Kernel busy-poll not permitted on receive socket."));
+#	ifdef SO_PREFER_BUSY_POLL
+				setsockopt (recv_sock, SOL_SOCKET, SO_PREFER_BUSY_POLL, (const char*)&prefer, sizeof(prefer));
+#	endif
+			}
+		}
+#endif
 		status = TRUE;
 		break;
 
@@ -1879,20 +4680,531 @@ pgm_setsockopt (
 	case PGM_RECV_SOCK:
 	case PGM_REPAIR_SOCK:
 	case PGM_PENDING_SOCK:
+	case PGM_HANDOFF_SOCK:
+	case PGM_NAK_LIMIT_STATS:
 	case PGM_ACK_SOCK:
+	case PGM_SEND_QUEUE_SOCK:
+	case PGM_SEND_QUEUE_LEN:
 	case PGM_TIME_REMAIN:
 	case PGM_RATE_REMAIN:
+	case PGM_RXQ_DROPS:
+	case PGM_RECV_QUEUED:
+	case PGM_SEND_QUEUED:
+	case PGM_MEM_USED:
+	case PGM_PATH_MTU:
 	default:
 		break;
 	}
 	break;
 
-	default:
-	break;
+	default:
+	break;
+	}
+
+	pgm_rwlock_reader_unlock (&sock->lock);
+	return status;
+}
+
+/* window size in sequence numbers rounded up to a power of two, sizes that would
+ * reach half the sequence space are left for modulo indexing.
+ */
+
+static
+unsigned
+pow2_window_sqns (
+	const unsigned		sqns,
+	const unsigned		secs,
+	const ssize_t		max_rte,
+	const uint16_t		tpdu_size
+	)
+{
+	const unsigned alloc_sqns = sqns ? sqns : (unsigned)( (secs * max_rte) / tpdu_size );
+	if (PGM_UNLIKELY(0 == alloc_sqns || alloc_sqns > (PGM_UINT32_SIGN_BIT >> 1)))
+		return alloc_sqns;
+	return (unsigned)pgm_nearest_power (1, alloc_sqns);
+}
+
+/* NUMA node of an interface device from sysfs, or -1 if unknown or not a device.
+ */
+
+static
+int
+mem_node_of_interface (
+	const unsigned		ifindex
+	)
+{
+	int node = -1;
+#ifdef __linux__
+	char ifname[IF_NAMESIZE], path[64 + IF_NAMESIZE];
+	FILE* fp;
+
+	if (0 == ifindex || NULL == pgm_if_indextoname (ifindex, ifname))
+		return -1;
+	pgm_snprintf_s (path, sizeof (path), _TRUNCATE, "/sys/class/net/%s/device/numa_node", ifname);
+	fp = fopen (path, "r");
+	if (NULL == fp)
+		return -1;
+	if (1 != fscanf (fp, "%d", &node))
+		node = -1;
+	fclose (fp);
+#else
+	(void)ifindex;
+#endif
+	return node;
+}
+
+/* MTU of the interface by index, or of the interface holding address when
+ * the index is 0, 0 when unknown.
+ */
+
+static
+unsigned
+mtu_of_interface (
+	const unsigned			ifindex,
+	const struct sockaddr*const	addr
+	)
+{
+	unsigned mtu = 0;
+#ifdef SIOCGIFMTU
+	struct ifreq ifr;
+	memset (&ifr, 0, sizeof (ifr));
+	if (0 != ifindex) {
+		if (NULL == pgm_if_indextoname (ifindex, ifr.ifr_name))
+			return 0;
+	} else if (AF_UNSPEC != addr->sa_family) {
+		struct pgm_ifaddrs_t *ifap, *ifa;
+		if (!pgm_getifaddrs (&ifap, NULL))
+			return 0;
+		for (ifa = ifap; ifa; ifa = ifa->ifa_next)
+			if (NULL != ifa->ifa_addr &&
+			    addr->sa_family == ifa->ifa_addr->sa_family &&
+			    0 == pgm_sockaddr_cmp (addr, ifa->ifa_addr))
+			{
+				pgm_strncpy_s (ifr.ifr_name, sizeof (ifr.ifr_name), ifa->ifa_name, _TRUNCATE);
+				break;
+			}
+		pgm_freeifaddrs (ifap);
+		if (NULL == ifa)
+			return 0;
+	} else
+		return 0;
+	const SOCKET s = socket (AF_INET, SOCK_DGRAM, 0);
+	if (INVALID_SOCKET == s)
+		return 0;
+	if (0 == ioctl (s, SIOCGIFMTU, &ifr) && ifr.ifr_mtu > 0)
+		mtu = (unsigned)ifr.ifr_mtu;
+	closesocket (s);
+#else
+	(void)ifindex;
+	(void)addr;
+#endif
+	return mtu;
+}
+
+/* NUMA node of the calling thread's current processor, or -1.
+ */
+
+static
+int
+mem_node_of_thread (void)
+{
+#if defined(__linux__) && defined(SYS_getcpu)
+	unsigned cpu, node;
+	if (0 == syscall (SYS_getcpu, &cpu, &node, NULL))
+		return (int)node;
+#endif
+	return -1;
+}
+
+/* kernel buffer to hold autobuf_msecs of traffic at max_rte plus one burst of
+ * the rate bucket, a millisecond of data or a single TPDU when paced.
+ */
+
+static
+int
+autobuf_bytes (
+	const pgm_sock_t*const	sock,
+	const ssize_t		max_rte,
+	const bool		is_paced
+	)
+{
+	const uint64_t tpdu = sock->iphdr_len + sock->max_tpdu;
+	const uint64_t burst = is_paced ? tpdu : MAX((uint64_t)max_rte / 1000, tpdu);
+	const uint64_t bytes = ((uint64_t)max_rte * sock->autobuf_msecs) / 1000 + burst;
+	return (int)MIN(bytes, (uint64_t)(INT_MAX / 2));
+}
+
+/* set a socket buffer, beyond net.core.rmem_max or wmem_max where the process
+ * has CAP_NET_ADMIN.
+ *
+ * returns the effective size as reported by the kernel, doubled on Linux for
+ * book-keeping overhead.
+ */
+
+static
+int
+autobuf_set (
+	const SOCKET		s,
+	const bool		is_recv,
+	const int		bytes
+	)
+{
+	const int optname = is_recv ? SO_RCVBUF : SO_SNDBUF;
+	int effective = 0;
+	socklen_t len = sizeof (effective);
+#if defined(SO_RCVBUFFORCE) && defined(SO_SNDBUFFORCE)
+	if (SOCKET_ERROR == setsockopt (s, SOL_SOCKET, is_recv ? SO_RCVBUFFORCE : SO_SNDBUFFORCE, (const char*)&bytes, sizeof(bytes)))
+#endif
+		setsockopt (s, SOL_SOCKET, optname, (const char*)&bytes, sizeof(bytes));
+	if (SOCKET_ERROR == getsockopt (s, SOL_SOCKET, optname, (char*)&effective, &len))
+		return 0;
+	return effective;
+}
+
+/* size send and receive buffers from the transmit and receive rates.
+ */
+
+static
+void
+autobuf_apply (
+	pgm_sock_t*const	sock
+	)
+{
+/* send sockets of a multi-stream source are sized by the first member */
+	if (sock->can_send_data && sock->txw_max_rte > 0 && NULL == sock->stream_group)
+	{
+		const int bytes = autobuf_bytes (sock, sock->txw_max_rte, sock->use_pacing);
+		const int effective = autobuf_set (sock->send_sock, FALSE, bytes);
+		autobuf_set (sock->send_with_router_alert_sock, FALSE, bytes);
+		sock->sndbuf = effective;
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Send buffer sized %d bytes for %u ms at %" PRIzd " bytes per second, effective %d bytes."),
+			   bytes, sock->autobuf_msecs, sock->txw_max_rte, effective);
+		if (PGM_UNLIKELY(effective < bytes))
+			pgm_warn (_("Send buffer limited to %d of %d bytes, raise net.core.wmem_max."), effective, bytes);
+	}
+	if (sock->can_recv_data && sock->rxw_max_rte > 0)
+	{
+		const int bytes = autobuf_bytes (sock, sock->rxw_max_rte, FALSE);
+		const int effective = autobuf_set (sock->recv_sock, TRUE, bytes);
+		for (unsigned i = 0; i < sock->recv_sock_extra_len; i++)
+			autobuf_set (sock->recv_sock_extra[i], TRUE, bytes);
+/* additional fan-in sockets opened later take the same size */
+		sock->rcvbuf = bytes;
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Receive buffer sized %d bytes for %u ms at %" PRIzd " bytes per second, effective %d bytes."),
+			   bytes, sock->autobuf_msecs, sock->rxw_max_rte, effective);
+		if (PGM_UNLIKELY(effective < bytes))
+			pgm_warn (_("Receive buffer limited to %d of %d bytes, raise net.core.rmem_max."), effective, bytes);
+	}
+}
+
+/* weight of a member of a multi-stream source.
+ */
+
+static inline
+uint32_t
+stream_weight (
+	const pgm_sock_t*const	sock
+	)
+{
+	return MAX(1, sock->stream_req.sr_weight);
+}
+
+/* divide the group rate between members by weight, each member bucket is charged
+ * alongside the group bucket.  call with pgm_sock_list_lock held.  concurrent
+ * senders may cost one TPDU at either share.
+ */
+
+static
+void
+stream_share (
+	struct pgm_stream_group_t*const	group
+	)
+{
+	if (0 == group->rate_control.rate_per_sec)
+		return;
+	for (pgm_slist_t* list = group->members; NULL != list; list = list->next)
+	{
+		pgm_sock_t* member = list->data;
+		if (0 == member->rate_control.rate_per_sec)
+			continue;
+		const ssize_t share = (ssize_t)(((uint64_t)group->rate_control.rate_per_sec * stream_weight (member)) / group->weight_total);
+		pgm_rate_set (&member->rate_control, MAX(share, (ssize_t)member->max_tpdu), member->use_pacing, member->max_tpdu);
+		member->rate_control.parent = &group->rate_control;
+	}
+}
+
+/* join the multi-stream source of sock::stream_req, the group is formed on the
+ * first join with the send sockets and TXW_MAX_RTE of the requested source.  the
+ * sockets opened for this source are closed.
+ *
+ * returns TRUE on success, returns FALSE if the requested source cannot be shared.
+ */
+
+static
+bool
+stream_join (
+	pgm_sock_t*const	sock,
+	pgm_error_t**		error
+	)
+{
+	pgm_sock_t* const source = sock->stream_req.sr_sock;
+	struct pgm_stream_group_t* group;
+	pgm_slist_t* list;
+	unsigned members;
+
+	pgm_rwlock_writer_lock (&pgm_sock_list_lock);
+	for (list = pgm_sock_list; NULL != list && source != list->data; list = list->next);
+	if (PGM_UNLIKELY(NULL == list ||
+			 source == sock ||
+			 !source->is_bound ||
+			 source->is_destroyed ||
+			 !source->can_send_data ||
+			 source->family != sock->family ||
+			 source->protocol != sock->protocol ||
+			 source->udp_encap_ucast_port != sock->udp_encap_ucast_port ||
+			 source->udp_encap_mcast_port != sock->udp_encap_mcast_port))
+	{
+		pgm_rwlock_writer_unlock (&pgm_sock_list_lock);
+		pgm_set_error (error,
+			       PGM_ERROR_DOMAIN_SOCKET,
+			       PGM_ERROR_INVAL,
+			       _("Stream group socket is not a bound source of the same transport."));
+		return FALSE;
+	}
+
+	group = source->stream_group;
+	if (NULL == group) {
+		group = pgm_new0 (struct pgm_stream_group_t, 1);
+		group->send_sock = source->send_sock;
+		group->send_with_router_alert_sock = source->send_with_router_alert_sock;
+		if (source->txw_max_rte > 0) {
+			pgm_rate_create (&group->rate_control, source->txw_max_rte, source->iphdr_len, source->max_tpdu);
+			if (source->use_pacing)
+				pgm_rate_pace (&group->rate_control, source->max_tpdu);
+		}
+		group->members = pgm_slist_append (NULL, source);
+		group->weight_total = stream_weight (source);
+		source->stream_group = group;
+	}
+	group->members = pgm_slist_append (group->members, sock);
+	group->weight_total += stream_weight (sock);
+	sock->stream_group = group;
+/* SPMs and repairs of every member on one timer thread */
+	if (source->use_timer_pool && !sock->is_single_threaded)
+		sock->use_timer_thread = sock->use_timer_pool = TRUE;
+	members = pgm_slist_length (group->members);
+	pgm_rwlock_writer_unlock (&pgm_sock_list_lock);
+
+	pgm_trace (PGM_LOG_ROLE_NETWORK,_("Sharing send sockets with stream group of %u members."), members);
+	closesocket (sock->send_sock);
+	closesocket (sock->send_with_router_alert_sock);
+	sock->send_sock = group->send_sock;
+	sock->send_with_router_alert_sock = group->send_with_router_alert_sock;
+	return TRUE;
+}
+
+/* leave the multi-stream source, the remaining members divide the group rate.
+ *
+ * returns TRUE if this was the last member and the send sockets are to be closed.
+ */
+
+static
+bool
+stream_leave (
+	pgm_sock_t*const	sock
+	)
+{
+	struct pgm_stream_group_t* group = sock->stream_group;
+	bool is_last;
+
+	pgm_rwlock_writer_lock (&pgm_sock_list_lock);
+	group->members = pgm_slist_remove (group->members, sock);
+	group->weight_total -= stream_weight (sock);
+	sock->stream_group = NULL;
+	sock->rate_control.parent = NULL;
+	is_last = (NULL == group->members);
+	if (!is_last)
+		stream_share (group);
+	pgm_rwlock_writer_unlock (&pgm_sock_list_lock);
+
+	if (is_last) {
+		pgm_rate_destroy (&group->rate_control);
+		pgm_free (group);
+	}
+	return is_last;
+}
+
+/* open and bind a data socket on each interface of sock::send_path_req, sending
+ * to the send group with the options of send_sock.  the paths of a multi-stream
+ * source would be shared, so a group member has none.
+ *
+ * returns TRUE on success, returns FALSE on failure leaving no path open.
+ */
+
+static
+bool
+open_send_paths (
+	pgm_sock_t*const	sock,
+	pgm_error_t**		error
+	)
+{
+	const struct pgm_send_path_req_t* req = &sock->send_path_req;
+	struct sockaddr_storage path_addr;
+	int sndbuf = 0, loop = 0;
+	socklen_t optlen = sizeof(sndbuf);
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (0 == sock->send_path_len);
+
+	if (PGM_UNLIKELY(NULL != sock->stream_group)) {
+		pgm_set_error (error,
+			       PGM_ERROR_DOMAIN_SOCKET,
+			       PGM_ERROR_INVAL,
+			       _("Send paths are not supported by a stream group member."));
+		return FALSE;
+	}
+
+	getsockopt (sock->send_sock, SOL_SOCKET, SO_SNDBUF, (char*)&sndbuf, &optlen);
+	loop = sock->use_multicast_loop;
+	while (sock->send_path_len < req->sp_len)
+	{
+		const struct pgm_interface_req_t* ir = &req->sp_if[ sock->send_path_len ];
+		memset (&path_addr, 0, sizeof(path_addr));
+		if (AF_UNSPEC != ir->ir_address.ss_family)
+			memcpy (&path_addr, &ir->ir_address, pgm_sockaddr_len ((const struct sockaddr*)&ir->ir_address));
+		else if (!pgm_if_indextoaddr (ir->ir_interface, sock->family, ir->ir_scope_id, (struct sockaddr*)&path_addr, error))
+			goto err_close;
+
+		const SOCKET new_sock = socket (sock->family,
+						IPPROTO_UDP == sock->protocol ? SOCK_DGRAM : SOCK_RAW,
+						sock->protocol);
+		if (INVALID_SOCKET == new_sock)
+			goto err_sock;
+		if (SOCKET_ERROR == bind (new_sock, (struct sockaddr*)&path_addr, pgm_sockaddr_len ((struct sockaddr*)&path_addr)) ||
+		    SOCKET_ERROR == pgm_sockaddr_multicast_if (new_sock, (struct sockaddr*)&path_addr, ir->ir_interface) ||
+		    SOCKET_ERROR == pgm_sockaddr_multicast_loop (new_sock, sock->family, loop) ||
+		    (sock->hops > 0 &&
+		     SOCKET_ERROR == pgm_sockaddr_multicast_hops (new_sock, sock->family, sock->hops)) ||
+		    (sndbuf > 0 &&
+		     SOCKET_ERROR == setsockopt (new_sock, SOL_SOCKET, SO_SNDBUF, (const char*)&sndbuf, sizeof(sndbuf))))
+		{
+			closesocket (new_sock);
+			goto err_sock;
+		}
+		if (sock->tos)
+			pgm_sockaddr_tos (new_sock, sock->family, sock->tos);
+		if (sock->pmtud_mode)
+			pgm_sockaddr_pmtudisc (new_sock, sock->family, sock->pmtud_mode);
+		pgm_sockaddr_nonblocking (new_sock, sock->is_nonblocking);
+		if (PGM_UNLIKELY(pgm_log_mask & PGM_LOG_ROLE_NETWORK))
+		{
+			char addr[INET6_ADDRSTRLEN];
+			pgm_sockaddr_ntop ((struct sockaddr*)&path_addr, addr, sizeof(addr));
+			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Send path %u on %s index %u"),
+				   1 + sock->send_path_len,
+				   addr,
+				   (unsigned)ir->ir_interface);
+		}
+		sock->send_path_sock[ sock->send_path_len++ ] = new_sock;
+	}
+	sock->send_path_mode = req->sp_mode;
+	return TRUE;
+
+err_sock:
+	{
+		const int save_errno = pgm_get_last_sock_error();
+		char errbuf[1024];
+		char addr[INET6_ADDRSTRLEN];
+		pgm_sockaddr_ntop ((struct sockaddr*)&path_addr, addr, sizeof(addr));
+		pgm_set_error (error,
+			       PGM_ERROR_DOMAIN_SOCKET,
+			       pgm_error_from_sock_errno (save_errno),
+			       _("Opening send path on address %s: %s"),
+			       addr,
+			       pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+	}
+err_close:
+	while (sock->send_path_len > 0)
+		closesocket (sock->send_path_sock[ --sock->send_path_len ]);
+	return FALSE;
+}
+
+/* open and bind a data socket on each further port of sock::send_port_req at
+ * send_addr, the bound data socket taking the first port.
+ */
+
+static
+bool
+open_send_ports (
+	pgm_sock_t*const		sock,
+	const struct sockaddr*const	send_addr,
+	pgm_error_t**			error
+	)
+{
+	const struct pgm_send_port_req_t* req = &sock->send_port_req;
+	struct sockaddr_storage port_addr;
+	int sndbuf = 0, loop = 0;
+	socklen_t optlen = sizeof(sndbuf);
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != send_addr);
+	pgm_assert (0 == sock->send_port_len);
+
+	getsockopt (sock->send_sock, SOL_SOCKET, SO_SNDBUF, (char*)&sndbuf, &optlen);
+	loop = sock->use_multicast_loop;
+	memcpy (&port_addr, send_addr, pgm_sockaddr_len (send_addr));
+	while (1 + sock->send_port_len < req->pt_count)
+	{
+		const in_port_t port = req->pt_base ? htons ((uint16_t)(req->pt_base + 1 + sock->send_port_len)) : 0;
+		if (AF_INET6 == port_addr.ss_family)
+			((struct sockaddr_in6*)&port_addr)->sin6_port = port;
+		else
+			((struct sockaddr_in*)&port_addr)->sin_port = port;
+
+		const SOCKET new_sock = socket (sock->family, SOCK_DGRAM, IPPROTO_UDP);
+		if (INVALID_SOCKET == new_sock)
+			goto err_sock;
+		if (SOCKET_ERROR == bind (new_sock, (struct sockaddr*)&port_addr, pgm_sockaddr_len ((struct sockaddr*)&port_addr)) ||
+		    SOCKET_ERROR == pgm_sockaddr_multicast_if (new_sock, send_addr, sock->send_gsr.gsr_interface) ||
+		    SOCKET_ERROR == pgm_sockaddr_multicast_loop (new_sock, sock->family, loop) ||
+		    (sock->hops > 0 &&
+		     SOCKET_ERROR == pgm_sockaddr_multicast_hops (new_sock, sock->family, sock->hops)) ||
+		    (sndbuf > 0 &&
+		     SOCKET_ERROR == setsockopt (new_sock, SOL_SOCKET, SO_SNDBUF, (const char*)&sndbuf, sizeof(sndbuf))))
+		{
+			closesocket (new_sock);
+			goto err_sock;
+		}
+		if (sock->tos)
+			pgm_sockaddr_tos (new_sock, sock->family, sock->tos);
+		if (sock->pmtud_mode)
+			pgm_sockaddr_pmtudisc (new_sock, sock->family, sock->pmtud_mode);
+		pgm_sockaddr_nonblocking (new_sock, sock->is_nonblocking);
+		sock->send_port_sock[ sock->send_port_len++ ] = new_sock;
 	}
+	pgm_trace (PGM_LOG_ROLE_NETWORK,_("Spreading transmission groups across %u send ports."),
+		   1 + sock->send_port_len);
+	return TRUE;
 
-	pgm_rwlock_reader_unlock (&sock->lock);
-	return status;
+err_sock:
+	{
+		const int save_errno = pgm_get_last_sock_error();
+		char errbuf[1024];
+		char addr[INET6_ADDRSTRLEN];
+		pgm_sockaddr_ntop ((struct sockaddr*)&port_addr, addr, sizeof(addr));
+		pgm_set_error (error,
+			       PGM_ERROR_DOMAIN_SOCKET,
+			       pgm_error_from_sock_errno (save_errno),
+			       _("Opening send port %u on address %s: %s"),
+			       (unsigned)pgm_sockaddr_port ((struct sockaddr*)&port_addr),
+			       addr,
+			       pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+	}
+	while (sock->send_port_len > 0)
+		closesocket (sock->send_port_sock[ --sock->send_port_len ]);
+	return FALSE;
 }
 
 bool
@@ -1943,6 +5255,17 @@ pgm_bind3 (
 		pgm_return_val_if_reached (FALSE);
 	}
 
+/* maximum TPDU from the sending interface, at most PGM_MTU */
+	if (sock->pmtud_mode) {
+		const unsigned mtu = MIN(mtu_of_interface (send_req->ir_interface, (const struct sockaddr*)&send_req->ir_address), UINT16_MAX);
+		if (mtu >= (sizeof(struct pgm_ip) + sizeof(struct pgm_header)) &&
+		    (0 == sock->max_tpdu || mtu < sock->max_tpdu))
+		{
+			sock->max_tpdu = (uint16_t)mtu;
+			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Maximum TPDU of %u bytes from interface MTU."), mtu);
+		}
+	}
+
 /* sanity checks on state */
 	if (sock->max_tpdu < (sizeof(struct pgm_ip) + sizeof(struct pgm_header))) {
 		pgm_set_error (error,
@@ -1985,6 +5308,13 @@ pgm_bind3 (
 			pgm_rwlock_writer_unlock (&sock->lock);
 			return FALSE;
 		}
+	} else if (PGM_UNLIKELY(NULL != sock->stream_req.sr_sock)) {
+		pgm_set_error (error,
+			       PGM_ERROR_DOMAIN_SOCKET,
+			       PGM_ERROR_FAILED,
+			       _("Stream group requires a source."));
+		pgm_rwlock_writer_unlock (&sock->lock);
+		return FALSE;
 	}
 	if (sock->can_recv_data) {
 		if (PGM_UNLIKELY(0 == sock->rxw_sqns && 0 == sock->rxw_secs)) {
@@ -2074,6 +5404,45 @@ pgm_bind3 (
 		} while (sock->tsi.sport == sock->dport);
 	}
 
+/* a hot standby adopts the session of the primary writing the store */
+	if (sock->can_send_data && sock->standby_req.sb_ivl)
+	{
+		uint32_t sqns;
+		uint16_t max_tpdu;
+		if (PGM_UNLIKELY('\0' == sock->txw_store_req.ts_path[0])) {
+			pgm_set_error (error,
+				       PGM_ERROR_DOMAIN_SOCKET,
+				       PGM_ERROR_FAILED,
+				       _("PGM_STANDBY requires PGM_TXW_STORE."));
+			pgm_rwlock_writer_unlock (&sock->lock);
+			return FALSE;
+		}
+		sock->standby = pgm_txw_store_attach (sock->txw_store_req.ts_path, error);
+		if (PGM_UNLIKELY(NULL == sock->standby)) {
+			pgm_rwlock_writer_unlock (&sock->lock);
+			return FALSE;
+		}
+		pgm_txw_store_geometry (sock->standby, &sock->tsi, &sqns, &max_tpdu);
+		if (PGM_UNLIKELY(max_tpdu != sock->max_tpdu)) {
+			pgm_set_error (error,
+				       PGM_ERROR_DOMAIN_SOCKET,
+				       PGM_ERROR_INVAL,
+				       _("Standby MTU %u differs from primary %u."),
+				       (unsigned)sock->max_tpdu, (unsigned)max_tpdu);
+			pgm_txw_store_close (sock->standby);
+			sock->standby = NULL;
+			pgm_rwlock_writer_unlock (&sock->lock);
+			return FALSE;
+		}
+		if (!pgm_txw_store_resume (sock->standby, &sock->standby_lead, &sock->standby_spm_sqn))
+			sock->standby_lead = sock->standby_spm_sqn = 0;
+		sock->standby_progress = pgm_time_update_now();
+		sock->is_standby = 1;
+		char tsi[PGM_TSISTRLEN];
+		pgm_tsi_print_r (&sock->tsi, tsi, sizeof (tsi));
+		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Standby of source %s."), tsi);
+	}
+
 /* pseudo-random number generator for back-off intervals */
 	pgm_rand_create (&sock->rand_);
 
@@ -2082,6 +5451,30 @@ pgm_bind3 (
 		sock->rand_node_id = pgm_rand_int (&sock->rand_);
 	}
 
+/* send queue only on source sockets */
+	if (!sock->can_send_data)
+		sock->sendq_max = 0;
+
+/* handoff ring only on receiving sockets without a delivery callback */
+	if (sock->handoff_len && NULL != sock->delivery_req.dr_func) {
+		pgm_warn (_("Handoff ring disabled with a delivery callback."));
+		sock->handoff_len = 0;
+	}
+	if (!sock->can_recv_data)
+		sock->handoff_len = 0;
+
+/* no internal threads to lock against */
+	if (sock->is_single_threaded) {
+		if (sock->use_timer_thread || sock->use_fec_worker || sock->fec_decode_threads > 0 || sock->mp_len > 0)
+			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Single-threaded socket, disabling timer thread, FEC threads and multi-producer ring."));
+		sock->use_timer_thread = sock->use_timer_pool = FALSE;
+		sock->delivery_req.dr_func = NULL;
+		sock->handoff_len = 0;
+		sock->use_fec_worker = FALSE;
+		sock->fec_decode_threads = 0;
+		sock->mp_len = 0;
+	}
+
 	if (sock->can_send_data)
 	{
 /* Windows notify call will raise an assertion on error, only Unix versions will return
@@ -2112,6 +5505,19 @@ pgm_bind3 (
 			pgm_rwlock_writer_unlock (&sock->lock);
 			return FALSE;
 		}
+		if (sock->sendq_max &&
+		    0 != pgm_notify_init (&sock->sendq_notify))
+		{
+			const int save_errno = pgm_get_last_sock_error();
+			char errbuf[1024];
+			pgm_set_error (error,
+				       PGM_ERROR_DOMAIN_SOCKET,
+				       pgm_error_from_sock_errno (save_errno),
+				       _("Creating send queue notification channel: %s"),
+				       pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+			pgm_rwlock_writer_unlock (&sock->lock);
+			return FALSE;
+		}
 	}
 	if (0 != pgm_notify_init (&sock->pending_notify))
 	{
@@ -2125,6 +5531,32 @@ pgm_bind3 (
 		pgm_rwlock_writer_unlock (&sock->lock);
 		return FALSE;
 	}
+	if (sock->use_timer_thread &&
+	    0 != pgm_notify_init (&sock->timer_notify))
+	{
+		const int save_errno = pgm_get_last_sock_error();
+		char errbuf[1024];
+		pgm_set_error (error,
+			       PGM_ERROR_DOMAIN_SOCKET,
+			       pgm_error_from_sock_errno (save_errno),
+			       _("Creating timer thread notification channel: %s"),
+			       pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		pgm_rwlock_writer_unlock (&sock->lock);
+		return FALSE;
+	}
+	if (sock->handoff_len &&
+	    0 != pgm_notify_init (&sock->handoff_notify))
+	{
+		const int save_errno = pgm_get_last_sock_error();
+		char errbuf[1024];
+		pgm_set_error (error,
+			       PGM_ERROR_DOMAIN_SOCKET,
+			       pgm_error_from_sock_errno (save_errno),
+			       _("Creating handoff ring notification channel: %s"),
+			       pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		pgm_rwlock_writer_unlock (&sock->lock);
+		return FALSE;
+	}
 
 /* determine IP header size for rate regulation engine & stats */
 	sock->iphdr_len = (AF_INET == sock->family) ? sizeof(struct pgm_ip) : sizeof(struct pgm_ip6_hdr);
@@ -2139,21 +5571,222 @@ pgm_bind3 (
 	const sa_family_t pgmcc_family = sock->use_pgmcc ? sock->family : 0;
 	sock->max_tsdu = (uint16_t)(sock->max_tpdu - sock->iphdr_len - pgm_pkt_offset (FALSE, pgmcc_family));
 	sock->max_tsdu_fragment = (uint16_t)(sock->max_tpdu - sock->iphdr_len - pgm_pkt_offset (TRUE, pgmcc_family));
+/* fix window sizes in sequence numbers, windows then index by mask */
+	if (sock->use_pow2_windows) {
+		if (sock->can_send_data) {
+			sock->txw_sqns = pow2_window_sqns (sock->txw_sqns, sock->txw_secs, sock->txw_max_rte, sock->max_tpdu);
+			pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Transmit window rounded to %u sequence numbers."), sock->txw_sqns);
+		}
+		if (sock->can_recv_data) {
+			sock->rxw_sqns = pow2_window_sqns (sock->rxw_sqns, sock->rxw_secs, sock->rxw_max_rte, sock->max_tpdu);
+			sock->rxw_secs = 0;
+			pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Receive window rounded to %u sequence numbers."), sock->rxw_sqns);
+		}
+	}
+
 	const unsigned max_fragments = sock->txw_sqns ? MIN( PGM_MAX_FRAGMENTS, sock->txw_sqns ) : PGM_MAX_FRAGMENTS;
 	sock->max_apdu = MIN( PGM_MAX_APDU, max_fragments * sock->max_tsdu_fragment );
+	if (sock->large_apdu > sock->max_apdu) {
+/* fragments of a large APDU must all remain in the transmit window for repair */
+		if (sock->txw_sqns)
+			sock->max_apdu = MIN( sock->large_apdu, (size_t)sock->txw_sqns * sock->max_tsdu_fragment );
+		else
+			sock->max_apdu = sock->large_apdu;
+	}
+
+/* window memory placement */
+	sock->mem_policy.pages = sock->mem_req.mr_pages;
+	switch (sock->mem_req.mr_node) {
+	case PGM_MEM_NODE_INTERFACE:
+		sock->mem_policy.node = mem_node_of_interface (sock->send_gsr.gsr_interface);
+		break;
+	case PGM_MEM_NODE_LOCAL:
+		sock->mem_policy.node = mem_node_of_thread ();
+		break;
+	default:
+		sock->mem_policy.node = sock->mem_req.mr_node;
+		break;
+	}
+	if (PGM_MEM_PAGES_DEFAULT != sock->mem_policy.pages || sock->mem_policy.node >= 0)
+		pgm_trace (PGM_LOG_ROLE_MEMORY,_("Window memory pages policy %u on NUMA node %d."),
+			sock->mem_policy.pages, sock->mem_policy.node);
+
+/* packet buffers for transmit and receive windows */
+	sock->skb_pool = pgm_skb_pool_new (sock->max_tpdu, &sock->mem_policy);
+	sock->txw_skb_pool = sock->skb_pool;
+	if (sock->can_send_data && sock->txw_ring_len) {
+		sock->txw_skb_pool = pgm_skb_pool_new_ring (sock->max_tpdu, sock->txw_ring_len, &sock->mem_policy);
+		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Transmit window ring store of %" PRIzu " bytes."), sock->txw_ring_len);
+	}
+	sock->skb_pool->is_single_threaded = sock->is_single_threaded;
+	sock->txw_skb_pool->is_single_threaded = sock->is_single_threaded;
+	pgm_skb_pool_set_budget (sock->skb_pool, &sock->budget);
+	if (sock->txw_skb_pool != sock->skb_pool)
+		pgm_skb_pool_set_budget (sock->txw_skb_pool, &sock->budget);
+/* adaptive FEC starts without proactive parity, requires Reed-Solomon coding */
+	if (sock->use_adaptive_fec) {
+		if (sock->can_send_data && (sock->use_proactive_parity || sock->use_ondemand_parity)) {
+			if (0 == sock->rs_proactive_max_h)
+				sock->rs_proactive_max_h = sock->rs_n - sock->rs_k;
+			sock->use_proactive_parity	= TRUE;
+			sock->rs_proactive_h		= 0;
+		} else
+			sock->use_adaptive_fec = FALSE;
+	}
+/* per-packet send path specialised by the now fixed configuration */
+	if (sock->can_send_data)
+		pgm_source_select_send (sock);
+/* coalescing buffer, limited to one TPDU with OPT_BATCH */
+	if (sock->can_send_data && sock->batch_req.br_size) {
+		if (sock->use_proactive_parity || sock->use_ondemand_parity || sock->use_sliding_fec) {
+			pgm_warn (_("Coalescing of APDUs disabled with FEC."));
+		} else {
+			const size_t batch_opt_length = (sock->use_pgmcc ? 0 : sizeof (struct pgm_opt_length)) +
+							sizeof (struct pgm_opt_header) + sizeof (struct pgm_opt_batch);
+			sock->batch_max = (uint16_t)MIN( sock->batch_req.br_size, sock->max_tsdu - batch_opt_length );
+			sock->batch_buf = pgm_malloc (sock->batch_max);
+			pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Coalescing APDUs into %u byte TSDUs."), sock->batch_max);
+		}
+	}
+/* APDU compression, the source buffer holds a blocked APDU */
+	if (PGM_COMPRESS_NONE != sock->compress_req.cr_type) {
+		pgm_error_t* compress_error = NULL;
+		sock->compress = pgm_compress_new (&sock->compress_req, &compress_error);
+		if (NULL == sock->compress) {
+			pgm_trace (PGM_LOG_ROLE_NETWORK,_("APDU compression not available: %s"),
+				   compress_error ? compress_error->message : "(null)");
+			pgm_error_free (compress_error);
+		} else if (sock->can_send_data) {
+			if (sock->use_proactive_parity || sock->use_ondemand_parity || sock->use_sliding_fec)
+				pgm_warn (_("Compression of sent APDUs disabled with FEC."));
+			else
+				sock->compress_buf = pgm_malloc (PGM_MAX_APDU);
+		}
+	}
+/* last-value keys of sent APDUs */
+	if (sock->conflate_req.cf_len && sock->can_send_data) {
+		if (sock->use_proactive_parity || sock->use_ondemand_parity || sock->use_sliding_fec)
+			pgm_warn (_("Conflation keys of sent APDUs disabled with FEC."));
+		else {
+			sock->conflate = pgm_conflate_new ();
+			pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Conflating APDUs on %u byte key at offset %u."),
+				   sock->conflate_req.cf_len, sock->conflate_req.cf_offset);
+		}
+	}
+/* send queue, APDUs are copied as queued */
+	if (sock->sendq_max) {
+		sock->sendq = pgm_new0 (struct pgm_sendq_msg_t*, sock->sendq_max);
+		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Send queue of %u APDUs."), sock->sendq_max);
+	}
+/* multi-producer publication ring */
+	if (sock->can_send_data && sock->mp_len) {
+		if (sock->use_pgmcc || sock->sendq_max || sock->batch_max) {
+			pgm_warn (_("Multi-producer publishing disabled with congestion control, send queue or coalescing."));
+		} else {
+			sock->mp_ring = pgm_new0 (struct pgm_mp_slot_t, sock->mp_len);
+			pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Multi-producer publication ring of %u slots."), sock->mp_len);
+		}
+	}
+/* application handoff ring */
+	if (sock->handoff_len) {
+		sock->handoff = pgm_handoff_new (sock->handoff_len);
+		pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Handoff ring of %u slots."), sock->handoff_len);
+	}
+/* NAK aggregation window */
+	if (sock->can_send_data && sock->nak_aggregate_ivl) {
+		sock->nak_pending = pgm_new (struct pgm_nak_req_t, PGM_NAK_AGGREGATE_MAX);
+		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Aggregating NAKs over %" PGM_TIME_FORMAT "us."), sock->nak_aggregate_ivl);
+	}
+/* unicast catch-up streams, the bucket holds at least one TPDU */
+	if (sock->can_send_data && sock->catchup_max_rte) {
+		sock->catchup = pgm_new (struct pgm_catchup_t, PGM_CATCHUP_MAX);
+		pgm_rate_create (&sock->catchup_rate_control, MAX(sock->catchup_max_rte, (ssize_t)sock->max_tpdu), sock->iphdr_len, sock->max_tpdu);
+		pgm_trace (PGM_LOG_ROLE_RATE_CONTROL,_("Serving catch-up requests at %" PRIzd " bytes per second."), sock->catchup_max_rte);
+	}
+/* designated local repairer, first advertisement on the first timer dispatch */
+	if (sock->can_recv_data && sock->dlr_sqns) {
+		if (sock->dlr_max_rte)
+			pgm_rate_create (&sock->dlr_rate_control, MAX(sock->dlr_max_rte, (ssize_t)sock->max_tpdu), sock->iphdr_len, sock->max_tpdu);
+		sock->next_dlr_poll = pgm_time_update_now();
+		pgm_trace (PGM_LOG_ROLE_SESSION,_("Designated local repairer retaining %" PRIu32 " sequences per source."), sock->dlr_sqns);
+	}
+/* same-host store, delivery starts after the current lead as a late join */
+	if (sock->can_recv_data && '\0' != sock->shm_req.sr_path[0]) {
+		if (0 == sock->udp_encap_ucast_port && AF_INET6 != sock->family) {
+			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Shared memory receive requires UDP encapsulation or IPv6."));
+		} else {
+			pgm_error_t* shm_error = NULL;
+			uint32_t trail, lead;
+			sock->rx_shm = pgm_txw_store_attach (sock->shm_req.sr_path, &shm_error);
+			if (NULL == sock->rx_shm) {
+				pgm_trace (PGM_LOG_ROLE_NETWORK,_("Shared memory receive not available: %s"),
+					   shm_error ? shm_error->message : "(null)");
+				pgm_error_free (shm_error);
+			} else if (pgm_txw_store_extent (sock->rx_shm, &trail, &lead)) {
+				sock->rx_shm_next = lead + 1;
+			} else {
+/* nothing stored yet, the source's first sequence is zero */
+				sock->rx_shm_next = 0;
+			}
+		}
+	}
+/* resume points of a previous process */
+	if (sock->can_recv_data && '\0' != sock->warm_restart_req.wr_name[0]) {
+		pgm_error_t* restart_error = NULL;
+		sock->restart = pgm_restart_open (sock->warm_restart_req.wr_name,
+						  sock->warm_restart_req.wr_sources,
+						  &restart_error);
+		if (NULL == sock->restart) {
+			pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Warm restart not available: %s"),
+				   restart_error ? restart_error->message : "(null)");
+			pgm_error_free (restart_error);
+		}
+	}
+/* fan-out to local consumers, records sized for any TSDU within a TPDU */
+	if (sock->can_recv_data && '\0' != sock->local_req.lr_name[0]) {
+		pgm_error_t* local_error = NULL;
+		sock->local = pgm_local_create (sock->local_req.lr_name,
+						sock->local_req.lr_slots,
+						sock->max_tpdu,
+						&local_error);
+		if (NULL == sock->local) {
+			pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Local publish not available: %s"),
+				   local_error ? local_error->message : "(null)");
+			pgm_error_free (local_error);
+		}
+	}
+	if (sock->can_recv_data && sock->use_rx_size_classes) {
+		for (unsigned i = 0; i < PGM_SKB_CLASSES; i++) {
+			const unsigned class_size = PGM_SKB_CLASS_MIN << i;
+			if (class_size >= sock->max_tpdu)
+				break;
+			sock->rx_class_pool[i] = pgm_skb_pool_new ((uint16_t)class_size, &sock->mem_policy);
+			sock->rx_class_pool[i]->is_single_threaded = sock->is_single_threaded;
+			pgm_skb_pool_set_budget (sock->rx_class_pool[i], &sock->budget);
+		}
+	}
+	if (sock->can_recv_data && sock->placement_req.pr_len) {
+		sock->placement_pool = pgm_skb_pool_new_fixed (sock->placement_req.pr_apdu,
+							       sock->placement_req.pr_base,
+							       sock->placement_req.pr_len);
+		sock->placement_pool->is_single_threaded = sock->is_single_threaded;
+		pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Placement of APDUs up to %u bytes into %u application buffers."),
+			   (unsigned)sock->placement_req.pr_apdu, sock->placement_pool->slab_len);
+	}
 
 	if (sock->can_send_data)
 	{
 		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Create transmit window."));
 		sock->window = sock->txw_sqns ?
 					pgm_txw_create (&sock->tsi,
-							0,			/* MAX_TPDU */
+							sock->max_tpdu,		/* MAX_TPDU, parity packets */
 							sock->txw_sqns,		/* TXW_SQNS */
 							0,			/* TXW_SECS */
 							0,			/* TXW_MAX_RTE */
 							sock->use_ondemand_parity || sock->use_proactive_parity,
 							sock->rs_n,
-							sock->rs_k) :
+							sock->rs_k,
+							&sock->mem_policy) :
 					pgm_txw_create (&sock->tsi,
 							sock->max_tpdu,		/* MAX_TPDU */
 							0,			/* TXW_SQNS */
@@ -2161,13 +5794,75 @@ pgm_bind3 (
 							sock->txw_max_rte,	/* TXW_MAX_RTE */
 							sock->use_ondemand_parity || sock->use_proactive_parity,
 							sock->rs_n,
-							sock->rs_k);
+							sock->rs_k,
+							&sock->mem_policy);
 		pgm_assert (NULL != sock->window);
+		sock->window->budget = &sock->budget;
+/* a standby opens the store on take over */
+		if ('\0' != sock->txw_store_req.ts_path[0] && !sock->is_standby)
+		{
+			pgm_error_t* store_error = NULL;
+/* history at least the length of the window */
+			const uint32_t store_sqns = sock->txw_store_req.ts_sqns ? sock->txw_store_req.ts_sqns : PGM_TXW_STORE_DEFAULT_SQNS;
+			sock->txw_store = pgm_txw_store_open (sock->txw_store_req.ts_path,
+							      &sock->tsi,
+							      sock->max_tpdu,
+							      MAX(store_sqns, (uint32_t)pgm_txw_max_length (sock->window)),
+							      &store_error);
+			if (NULL == sock->txw_store) {
+				pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Transmit window store not available: %s"),
+					   store_error ? store_error->message : "(null)");
+				pgm_error_free (store_error);
+			} else {
+				uint32_t lead, spm_sqn;
+				if (pgm_txw_store_resume (sock->txw_store, &lead, &spm_sqn)) {
+/* transmission groups must remain aligned to the sequence space */
+					if ((sock->use_ondemand_parity || sock->use_proactive_parity) &&
+					    0 != ((lead + 1) & (sock->rs_k - 1)))
+					{
+						pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Transmit window store lead #%" PRIu32 " not aligned to transmission group, discarding history."), lead);
+						pgm_txw_store_reset (sock->txw_store);
+					} else {
+						pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Resuming transmit window after #%" PRIu32 "."), lead);
+						sock->spm_sqn = spm_sqn + 1;
+					}
+				}
+				pgm_txw_set_store (sock->window, sock->txw_store);
+			}
+		}
+		if (sock->use_fec_worker &&
+		    (!sock->use_proactive_parity ||
+		     !pgm_txw_parity_start (sock->window, sock->rs_proactive_max_h, &sock->rdata_notify)))
+		{
+			sock->use_fec_worker = FALSE;
+		}
+/* receiver-acknowledged trail */
+		if (sock->ack_trail_req.at_ivl) {
+			sock->ack_trail = pgm_new (struct pgm_ack_trail_t, PGM_ACK_TRAIL_MAX);
+			pgm_txw_set_retention (sock->window, pgm_usecs (sock->ack_trail_req.at_retention));
+			pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Releasing data acknowledged by %u receivers after %" PRIu32 "us."),
+				   MAX(1, sock->ack_trail_req.at_receivers), sock->ack_trail_req.at_retention);
+		}
+/* receiver-advertised credit */
+		if (sock->credit_req.cr_ivl && 0 == sock->odata_max_rte) {
+			pgm_trace (PGM_LOG_ROLE_RATE_CONTROL,_("Receiver credit ignored without PGM_ODATA_MAX_RTE."));
+		} else if (sock->credit_req.cr_ivl) {
+			sock->credit = pgm_new (struct pgm_credit_t, PGM_CREDIT_MAX);
+			pgm_trace (PGM_LOG_ROLE_RATE_CONTROL,_("Limiting ODATA rate to the slowest of %u receivers."),
+				   sock->credit_req.cr_receivers ? sock->credit_req.cr_receivers : PGM_CREDIT_MAX);
+		}
+/* per-receiver NAK limit */
+		if (sock->nak_limit_req.nl_rate) {
+			sock->nak_limit = pgm_new0 (struct pgm_nak_limit_t, PGM_NAK_LIMIT_RECEIVERS);
+			sock->nak_limit_len = 0;
+			pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Limiting NAKs to %" PRIu32 " sequences per second per receiver, burst %" PRIu32 "."),
+				   sock->nak_limit_req.nl_rate, sock->nak_limit_req.nl_burst);
+		}
 	}
 
 /* create peer list */
 	if (sock->can_recv_data) {
-		sock->peers_hashtable = pgm_hashtable_new (pgm_tsi_hash, pgm_tsi_equal);
+		sock->peers_hashtable = pgm_peertable_new ();
 		pgm_assert (NULL != sock->peers_hashtable);
 	}
 
@@ -2254,6 +5949,28 @@ pgm_bind3 (
 		return FALSE;
 	}
 
+/* SO_REUSEPORT fan-in sockets share the identical address */
+	for (unsigned i = 0; i < sock->recv_sock_extra_len; i++)
+	{
+		if (SOCKET_ERROR == bind (sock->recv_sock_extra[i],
+					  &recv_addr.sa,
+					  pgm_sockaddr_len (&recv_addr.sa)))
+		{
+			const int save_errno = pgm_get_last_sock_error();
+			char errbuf[1024];
+			char addr[INET6_ADDRSTRLEN];
+			pgm_sockaddr_ntop ((struct sockaddr*)&recv_addr, addr, sizeof(addr));
+			pgm_set_error (error,
+				       PGM_ERROR_DOMAIN_SOCKET,
+				       pgm_error_from_sock_errno (save_errno),
+				       _("Binding additional receive socket to address %s: %s"),
+				       addr,
+				       pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+			pgm_rwlock_writer_unlock (&sock->lock);
+			return FALSE;
+		}
+	}
+
 	if (PGM_UNLIKELY(pgm_log_mask & PGM_LOG_ROLE_NETWORK))
 	{
 		char s[INET6_ADDRSTRLEN];
@@ -2287,7 +6004,33 @@ pgm_bind3 (
 	}
 
 	memcpy (&send_with_router_alert_addr, &send_addr, pgm_sockaddr_len ((struct sockaddr*)&send_addr));
-	if (SOCKET_ERROR == bind (sock->send_sock,
+/* the data socket takes the first port of a PGM_SEND_PORTS range, or the port of the TSI */
+	if (sock->send_port_req.pt_mode)
+	{
+		if (PGM_UNLIKELY(NULL != sock->stream_req.sr_sock || sock->send_path_req.sp_len > 0)) {
+			pgm_set_error (error,
+				       PGM_ERROR_DOMAIN_SOCKET,
+				       PGM_ERROR_INVAL,
+				       _("Send ports are not supported with send paths or by a stream group member."));
+			pgm_rwlock_writer_unlock (&sock->lock);
+			return FALSE;
+		}
+		const unsigned index = (PGM_PORTS_PER_TSI == sock->send_port_req.pt_mode) ?
+					pgm_tsi_hash (&sock->tsi) % sock->send_port_req.pt_count : 0;
+		const in_port_t port = sock->send_port_req.pt_base ? htons ((uint16_t)(sock->send_port_req.pt_base + index)) : 0;
+		if (AF_INET6 == send_addr.ss.ss_family)
+			((struct sockaddr_in6*)&send_addr)->sin6_port = port;
+		else
+			((struct sockaddr_in*)&send_addr)->sin_port = port;
+	}
+/* a member of a multi-stream source sends on the bound sockets of the group */
+	if (NULL != sock->stream_req.sr_sock) {
+		if (!stream_join (sock, error)) {
+			pgm_rwlock_writer_unlock (&sock->lock);
+			return FALSE;
+		}
+	}
+	else if (SOCKET_ERROR == bind (sock->send_sock,
 				      (struct sockaddr*)&send_addr,
 				      pgm_sockaddr_len ((struct sockaddr*)&send_addr)))
 	{
@@ -2304,6 +6047,10 @@ pgm_bind3 (
 		pgm_rwlock_writer_unlock (&sock->lock);
 		return FALSE;
 	}
+	if (AF_INET6 == send_addr.ss.ss_family)
+		((struct sockaddr_in6*)&send_addr)->sin6_port = 0;
+	else
+		((struct sockaddr_in*)&send_addr)->sin_port = 0;
 
 /* resolve bound address if 0.0.0.0 */
 	if (AF_INET == send_addr.ss.ss_family)
@@ -2329,7 +6076,8 @@ pgm_bind3 (
 		pgm_debug ("bind succeeded on send_gsr interface %s", s);
 	}
 
-	if (SOCKET_ERROR == bind (sock->send_with_router_alert_sock,
+	if (NULL == sock->stream_group &&
+	    SOCKET_ERROR == bind (sock->send_with_router_alert_sock,
 				      (struct sockaddr*)&send_with_router_alert_addr,
 				      pgm_sockaddr_len((struct sockaddr*)&send_with_router_alert_addr)))
 	{
@@ -2354,17 +6102,74 @@ pgm_bind3 (
 		pgm_debug ("bind (router alert) succeeded on send_gsr interface %s", s);
 	}
 
+/* redundant or striped data sockets on further interfaces */
+	if (sock->can_send_data &&
+	    sock->send_path_req.sp_len > 0 &&
+	    !open_send_paths (sock, error))
+	{
+		pgm_rwlock_writer_unlock (&sock->lock);
+		return FALSE;
+	}
+
+/* transmission groups across further ports */
+	if (sock->can_send_data &&
+	    PGM_PORTS_PER_TG == sock->send_port_req.pt_mode &&
+	    !open_send_ports (sock, (struct sockaddr*)&send_addr, error))
+	{
+		pgm_rwlock_writer_unlock (&sock->lock);
+		return FALSE;
+	}
+
+/* unicast fan-out receivers without a port take the port of the send group */
+	for (unsigned i = 0; i < sock->fanout_req.fr_len; i++)
+	{
+		struct sockaddr_storage* fr_addr = &sock->fanout_req.fr_addr[i];
+		if (0 != pgm_sockaddr_port ((struct sockaddr*)fr_addr))
+			continue;
+		if (AF_INET6 == fr_addr->ss_family)
+			((struct sockaddr_in6*)fr_addr)->sin6_port = pgm_sockaddr_port ((struct sockaddr*)&sock->send_gsr.gsr_group);
+		else
+			((struct sockaddr_in*)fr_addr)->sin_port = pgm_sockaddr_port ((struct sockaddr*)&sock->send_gsr.gsr_group);
+	}
+
+/* don't fragment, datagrams of maximum TPDU fit the interface */
+	if (sock->pmtud_mode &&
+	    (SOCKET_ERROR == pgm_sockaddr_pmtudisc (sock->send_sock, sock->family, sock->pmtud_mode) ||
+	     SOCKET_ERROR == pgm_sockaddr_pmtudisc (sock->send_with_router_alert_sock, sock->family, sock->pmtud_mode)))
+	{
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Don't fragment not supported, datagrams may be fragmented."));
+	}
+
 /* save send side address for broadcasting as source nla */
 	memcpy (&sock->send_addr, &send_addr, pgm_sockaddr_len ((struct sockaddr*)&send_addr));
 
 /* rx to nak processor notify channel */
 	if (sock->can_send_data)
 	{
-/* setup rate control */
-		if (sock->txw_max_rte > 0) {
+/* setup rate control, a member of a multi-stream source takes its share of the group */
+		if (NULL != sock->stream_group && sock->stream_group->rate_control.rate_per_sec > 0) {
+			pgm_rate_create (&sock->rate_control, sock->stream_group->rate_control.rate_per_sec, sock->iphdr_len, sock->max_tpdu);
+			if (sock->use_pacing)
+				pgm_rate_pace (&sock->rate_control, sock->max_tpdu);
+			pgm_rwlock_writer_lock (&pgm_sock_list_lock);
+			stream_share (sock->stream_group);
+			pgm_rwlock_writer_unlock (&pgm_sock_list_lock);
+			pgm_trace (PGM_LOG_ROLE_RATE_CONTROL,_("Setting rate regulation to %" PRIzd " bytes per second of stream group."),
+					sock->rate_control.rate_per_sec);
+			sock->is_controlled_spm   = TRUE;	/* must always be set */
+		} else if (sock->txw_max_rte > 0) {
 			pgm_trace (PGM_LOG_ROLE_RATE_CONTROL,_("Setting rate regulation to %" PRIzd " bytes per second."),
 					sock->txw_max_rte);
 			pgm_rate_create (&sock->rate_control, sock->txw_max_rte, sock->iphdr_len, sock->max_tpdu);
+			if (sock->use_pacing) {
+				pgm_rate_pace (&sock->rate_control, sock->max_tpdu);
+#ifdef SO_MAX_PACING_RATE
+				const uint32_t pacing_rate = (uint64_t)sock->txw_max_rte > UINT32_MAX ? UINT32_MAX : (uint32_t)sock->txw_max_rte;
+				if (SOCKET_ERROR == setsockopt (sock->send_sock, SOL_SOCKET, SO_MAX_PACING_RATE, (const char*)&pacing_rate, sizeof(pacing_rate)) ||
+				    SOCKET_ERROR == setsockopt (sock->send_with_router_alert_sock, SOL_SOCKET, SO_MAX_PACING_RATE, (const char*)&pacing_rate, sizeof(pacing_rate)))
+					pgm_trace (PGM_LOG_ROLE_RATE_CONTROL,_("Kernel pacing not available on send socket."));
+#endif
+			}
 			sock->is_controlled_spm   = TRUE;	/* must always be set */
 		} else
 			sock->is_controlled_spm   = FALSE;
@@ -2373,22 +6178,166 @@ pgm_bind3 (
 			pgm_trace (PGM_LOG_ROLE_RATE_CONTROL,_("Setting ODATA rate regulation to %" PRIzd " bytes per second."),
 					sock->odata_max_rte);
 			pgm_rate_create (&sock->odata_rate_control, sock->odata_max_rte, sock->iphdr_len, sock->max_tpdu);
+			if (sock->use_pacing)
+				pgm_rate_pace (&sock->odata_rate_control, sock->max_tpdu);
 			sock->is_controlled_odata = TRUE;
 		}
 		if (sock->rdata_max_rte > 0) {
 			pgm_trace (PGM_LOG_ROLE_RATE_CONTROL,_("Setting RDATA rate regulation to %" PRIzd " bytes per second."),
 					sock->rdata_max_rte);
 			pgm_rate_create (&sock->rdata_rate_control, sock->rdata_max_rte, sock->iphdr_len, sock->max_tpdu);
+			if (sock->use_pacing)
+				pgm_rate_pace (&sock->rdata_rate_control, sock->max_tpdu);
 			sock->is_controlled_rdata = TRUE;
 		}
+		for (unsigned i = 1; i < PGM_PRIORITY_CLASSES; i++) {
+			if (0 == sock->priority_req[i].pr_max_rte)
+				continue;
+			pgm_trace (PGM_LOG_ROLE_RATE_CONTROL,_("Setting priority class %u rate regulation to %" PRIu32 " bytes per second."),
+					i, sock->priority_req[i].pr_max_rte);
+			pgm_rate_create (&sock->priority_rate_control[i], sock->priority_req[i].pr_max_rte, sock->iphdr_len, sock->max_tpdu);
+			if (sock->use_pacing)
+				pgm_rate_pace (&sock->priority_rate_control[i], sock->max_tpdu);
+		}
 	}
 
+/* kernel buffers from the rates */
+	if (sock->autobuf_msecs)
+		autobuf_apply (sock);
+
 /* allocate first incoming packet buffer */
-	sock->rx_buffer = pgm_alloc_skb (sock->max_tpdu);
+	sock->rx_buffer = pgm_skb_pool_alloc (sock->skb_pool, sock->max_tpdu);
+
+/* FEC decoder threads, completion is signalled on the pending-pipe */
+	if (sock->can_recv_data && sock->fec_decode_threads > 0)
+	{
+		sock->rx_decoder = pgm_rxw_decoder_create (sock->fec_decode_threads, &sock->pending_notify);
+		if (NULL == sock->rx_decoder)
+			pgm_warn (_("FEC decoder threads not available, reconstructing inline."));
+	}
+
+#ifdef HAVE_LINUX_IO_URING_H
+/* io_uring receive engine, UDP_GRO super-datagrams require the socket calls */
+	if (sock->rx_uring_depth > 0 && !sock->use_udp_gro)
+	{
+		sock->rx_uring = pgm_recv_uring_new (sock, sock->rx_uring_depth);
+		if (NULL == sock->rx_uring) {
+			const int save_errno = errno;
+			char errbuf[1024];
+			pgm_trace (PGM_LOG_ROLE_NETWORK,_("io_uring receive engine not available: %s"),
+				   pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		}
+	}
+#endif
+#ifdef PGM_HAVE_RIO
+	if (sock->rio_depth > 0)
+	{
+		sock->rio = pgm_rio_new (sock, sock->rio_depth);
+		if (NULL == sock->rio) {
+			const int save_errno = pgm_get_last_sock_error();
+			char errbuf[1024];
+			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Registered I/O engine not available: %s"),
+				   pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		}
+	}
+#endif
+#ifdef HAVE_LINUX_IF_XDP_H
+/* AF_XDP receive queue, only IPv4 can be steered */
+	if (0 != sock->rx_xdp_req.xr_interface && AF_INET == sock->family)
+	{
+		sock->rx_xdp = pgm_recv_xdp_new (sock, &sock->rx_xdp_req);
+		if (NULL == sock->rx_xdp) {
+			const int save_errno = errno;
+			char errbuf[1024];
+			pgm_trace (PGM_LOG_ROLE_NETWORK,_("AF_XDP receive path not available: %s"),
+				   pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		}
+	}
+#endif
+#ifdef HAVE_LINUX_IF_PACKET_H
+/* TPACKET_V3 receive ring, raw IPv4 sockets only and never beside AF_XDP which steers first */
+	if (0 != sock->rx_tpacket_req.tr_interface &&
+	    AF_INET == sock->family &&
+	    0 == sock->udp_encap_ucast_port &&
+	    NULL == sock->rx_xdp)
+	{
+		sock->rx_tpacket = pgm_recv_tpacket_new (sock, &sock->rx_tpacket_req);
+		if (NULL == sock->rx_tpacket) {
+			const int save_errno = errno;
+			char errbuf[1024];
+			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Packet ring receive path not available: %s"),
+				   pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		}
+	}
+#endif
+#ifdef HAVE_SYS_TIMERFD_H
+	if (sock->use_timer_fd)
+	{
+		sock->timer_fd = timerfd_create (CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+		if (INVALID_SOCKET == sock->timer_fd) {
+			const int save_errno = errno;
+			char errbuf[1024];
+			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Timer descriptor not available: %s"),
+				   pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+			sock->use_timer_fd = FALSE;
+		}
+	}
+#endif
+	if ('\0' != sock->capture_req.cr_path[0])
+	{
+		pgm_error_t* capture_error = NULL;
+		sock->capture = pgm_capture_new (sock->capture_req.cr_path, sock->capture_req.cr_size, &capture_error);
+		if (NULL == sock->capture) {
+			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Packet capture not available: %s"),
+				   capture_error ? capture_error->message : "(null)");
+			pgm_error_free (capture_error);
+		}
+	}
+	if ('\0' != sock->record_req.rr_path[0] && sock->can_recv_data)
+	{
+		pgm_error_t* record_error = NULL;
+		sock->recorder = pgm_recorder_new (sock->record_req.rr_path, sock->record_req.rr_segment_size, &record_error);
+		if (NULL == sock->recorder) {
+			pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Recording not available: %s"),
+				   record_error ? record_error->message : "(null)");
+			pgm_error_free (record_error);
+		}
+	}
+	if (pgm_impair_is_enabled (&sock->impair_req))
+	{
+		if (sock->impair_req.ir_direction & PGM_IMPAIR_RX)
+			sock->rx_impair = pgm_impair_new (&sock->impair_req);
+		if (sock->impair_req.ir_direction & PGM_IMPAIR_TX) {
+			sock->tx_impair = pgm_impair_new (&sock->impair_req);
+/* impaired datagrams are sent one at a time, copied when held */
+			if (sock->use_zerocopy) {
+				pgm_trace (PGM_LOG_ROLE_NETWORK,_("Zero-copy transmit disabled by transmit impairment."));
+				sock->use_zerocopy = FALSE;
+			}
+		}
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Impairing %s%s%s datagrams."),
+			   sock->rx_impair ? "received" : "",
+			   sock->rx_impair && sock->tx_impair ? " and " : "",
+			   sock->tx_impair ? "sent" : "");
+	}
 
 /* bind complete */
 	sock->is_bound = TRUE;
 
+/* timers and repairs are now safe to run concurrently with the application */
+	if (sock->use_timer_thread &&
+	    !pgm_timer_thread_start (sock))
+	{
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Timer thread not available, timers run from receive calls."));
+		pgm_notify_destroy (&sock->timer_notify);
+		sock->use_timer_thread = sock->use_timer_pool = FALSE;
+		sock->delivery_req.dr_func = NULL;
+		if (sock->handoff) {
+			pgm_handoff_destroy (sock->handoff);
+			sock->handoff = NULL;
+		}
+	}
+
 /* cleanup */
 	pgm_rwlock_writer_unlock (&sock->lock);
 	pgm_debug ("PGM socket successfully bound.");
@@ -2421,13 +6370,65 @@ pgm_connect (
 	pgm_debug ("connect (sock:%p error:%p)",
 		 (const void*)sock, (const void*)error);
 
+#ifdef HAVE_INFINIBAND_VERBS_H
+/* RDMA queue pair once the groups are known, ahead of the first SPM */
+	if (0 != sock->verbs_req.vr_port && NULL == pgm_net_shim)
+	{
+		sock->verbs = pgm_verbs_new (sock, &sock->verbs_req);
+		if (NULL == sock->verbs) {
+			const int save_errno = errno;
+			char errbuf[1024];
+			pgm_trace (PGM_LOG_ROLE_NETWORK,_("RDMA multicast transport not available: %s"),
+				   pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		}
+	}
+#endif
+#ifdef HAVE_RTE_ETHDEV_H
+/* DPDK queue, polled only by a non-blocking receiver */
+	if ('\0' != sock->dpdk_req.dr_device[0] && NULL == pgm_net_shim)
+	{
+		if (!sock->is_nonblocking)
+			pgm_trace (PGM_LOG_ROLE_NETWORK,_("DPDK transport requires a non-blocking socket."));
+		else {
+			sock->dpdk = pgm_dpdk_new (sock, &sock->dpdk_req);
+			if (NULL == sock->dpdk) {
+				const int save_errno = errno;
+				char errbuf[1024];
+				pgm_trace (PGM_LOG_ROLE_NETWORK,_("DPDK transport not available: %s"),
+					   pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+			}
+		}
+	}
+#endif
+
 /* rx to nak processor notify channel */
 	if (sock->can_send_data)
 	{
-/* announce new sock by sending out SPMs */
-		if (!pgm_send_spm (sock, PGM_OPT_SYN) ||
-		    !pgm_send_spm (sock, PGM_OPT_SYN) ||
-		    !pgm_send_spm (sock, PGM_OPT_SYN))
+#ifdef PGM_HAVE_CONNECTED_SEND
+/* fix the route to the group once rather than per datagram, the sockets of a
+ * multi-stream source carry every member's group.
+ */
+		if (NULL == pgm_net_shim &&
+		    NULL == sock->stream_group &&
+		    pgm_sockaddr_is_addr_multicast ((const struct sockaddr*)&sock->send_gsr.gsr_group))
+		{
+			if (SOCKET_ERROR == connect (sock->send_sock,
+						     (const struct sockaddr*)&sock->send_gsr.gsr_group,
+						     pgm_sockaddr_len ((const struct sockaddr*)&sock->send_gsr.gsr_group)))
+			{
+				char errbuf[1024];
+				pgm_trace (PGM_LOG_ROLE_NETWORK,_("Connecting send socket to group failed: %s"),
+					   pgm_sock_strerror_s (errbuf, sizeof (errbuf), pgm_get_last_sock_error()));
+			}
+			else
+				sock->is_send_connected = TRUE;
+		}
+#endif
+/* announce new sock by sending out SPMs, a standby continues the session of the primary */
+		if (!sock->is_standby &&
+		    (!pgm_send_spm (sock, PGM_OPT_SYN) ||
+		     !pgm_send_spm (sock, PGM_OPT_SYN) ||
+		     !pgm_send_spm (sock, PGM_OPT_SYN)))
 		{
 			const int save_errno = pgm_get_last_sock_error();
 			char errbuf[1024];
@@ -2440,13 +6441,13 @@ pgm_connect (
 			return FALSE;
 		}
 
-		sock->next_poll = sock->next_ambient_spm = pgm_time_update_now() + sock->spm_ambient_interval;
-
-/* start PGMCC with one token */
-		sock->tokens = sock->cwnd_size = pgm_fp8 (1);
+		sock->next_poll = sock->next_ambient_spm = pgm_timer_next_ambient_spm (sock, pgm_time_update_now());
+		if (sock->is_standby)
+			sock->next_poll = pgm_time_update_now() + pgm_usecs (sock->standby_req.sb_ivl);
 
-/* slow start threshold */
-		sock->ssthresh = pgm_fp8 (4);
+/* congestion control starts with one token */
+		sock->cc = pgm_cc_get (sock->cc_algorithm);
+		sock->cc->init (sock);
 
 /* ACK timeout, should be greater than first SPM heartbeat interval in order to be scheduled correctly */
 		sock->ack_expiry_ivl = pgm_secs (3);
@@ -2459,7 +6460,20 @@ pgm_connect (
 		pgm_assert (sock->can_recv_data);
 		sock->next_poll = pgm_time_update_now() + pgm_secs( 30 );
 	}
+#ifdef PGM_HAVE_TIMER_FD
+	if (pgm_timer_has_fd (sock))
+		pgm_timer_arm (sock);
+#endif
 
+#ifdef PGM_HAVE_RECV_FILTER
+	if ((sock->use_recv_filter || sock->rx_source_filter.sf_len > 0) &&
+	    !pgm_recv_filter_attach (sock))
+	{
+		char errbuf[1024];
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Receive socket filter not attached: %s"),
+			   pgm_sock_strerror_s (errbuf, sizeof (errbuf), pgm_get_last_sock_error()));
+	}
+#endif
 	sock->is_connected = TRUE;
 
 /* cleanup */
@@ -2525,6 +6539,46 @@ pgm_select_info (
 		fds = sock->recv_sock + 1;
 #else
 		fds = 1;
+#endif
+		for (unsigned i = 0; i < sock->recv_sock_extra_len; i++) {
+			FD_SET(sock->recv_sock_extra[i], readfds);
+#ifndef _WIN32
+			fds = MAX(fds, sock->recv_sock_extra[i] + 1);
+#endif
+		}
+#ifdef HAVE_LINUX_IO_URING_H
+		if (sock->rx_uring) {
+			const SOCKET uring_fd = pgm_recv_uring_get_socket (sock->rx_uring);
+			FD_SET(uring_fd, readfds);
+			fds = MAX(fds, uring_fd + 1);
+		}
+#endif
+#ifdef PGM_HAVE_RIO
+		if (sock->rio) {
+			FD_SET(pgm_rio_get_socket (sock->rio), readfds);
+			fds++;
+		}
+#endif
+#ifdef HAVE_LINUX_IF_XDP_H
+		if (sock->rx_xdp) {
+			const SOCKET xdp_fd = pgm_recv_xdp_get_socket (sock->rx_xdp);
+			FD_SET(xdp_fd, readfds);
+			fds = MAX(fds, xdp_fd + 1);
+		}
+#endif
+#ifdef HAVE_INFINIBAND_VERBS_H
+		if (sock->verbs) {
+			const SOCKET verbs_fd = pgm_verbs_get_socket (sock->verbs);
+			FD_SET(verbs_fd, readfds);
+			fds = MAX(fds, verbs_fd + 1);
+		}
+#endif
+#ifdef HAVE_LINUX_IF_PACKET_H
+		if (sock->rx_tpacket) {
+			const SOCKET tpacket_fd = pgm_recv_tpacket_get_socket (sock->rx_tpacket);
+			FD_SET(tpacket_fd, readfds);
+			fds = MAX(fds, tpacket_fd + 1);
+		}
 #endif
 		if (sock->can_send_data) {
 			const SOCKET rdata_fd = pgm_notify_get_socket (&sock->rdata_notify);
@@ -2586,6 +6640,52 @@ pgm_select_info (
 #	define PGM_POLLOUT		POLLWRNORM
 #endif
 
+/* returns the number of pollfd structures pgm_poll_info() fills for events: the
+ * receive sockets, each receive engine, and the notification channels.  the RDMA
+ * engine is counted once configured as pgm_connect() creates it after bind.
+ */
+
+PGM_GNUC_INTERNAL
+unsigned
+pgm_poll_info_len (
+	const pgm_sock_t* const	sock,
+	const short		events		/* POLLIN, POLLOUT */
+	)
+{
+	unsigned len = 0;
+
+	if (events & PGM_POLLIN)
+	{
+		len += 1 + sock->recv_sock_extra_len;
+#ifdef HAVE_LINUX_IO_URING_H
+		if (sock->rx_uring)
+			len++;
+#endif
+#ifdef PGM_HAVE_RIO
+		if (sock->rio)
+			len++;
+#endif
+#ifdef HAVE_LINUX_IF_XDP_H
+		if (sock->rx_xdp)
+			len++;
+#endif
+#ifdef HAVE_INFINIBAND_VERBS_H
+		if (sock->verbs || 0 != sock->verbs_req.vr_port)
+			len++;
+#endif
+#ifdef HAVE_LINUX_IF_PACKET_H
+		if (sock->rx_tpacket)
+			len++;
+#endif
+		if (sock->can_send_data)
+			len++;
+		len++;
+	}
+	if (sock->can_send_data && events & PGM_POLLOUT)
+		len++;
+	return len;
+}
+
 #ifndef _WIN32
 int
 pgm_poll_info (
@@ -2620,13 +6720,65 @@ pgm_wsapoll_info (
 		return SOCKET_ERROR;
 	}
 
-/* we currently only support one incoming socket */
+/* checked without assertions, a receive engine each adds a descriptor */
+	if (PGM_UNLIKELY((long)*n_fds < (long)pgm_poll_info_len (sock, events)))
+	{
+		pgm_set_last_sock_error (PGM_SOCK_EINVAL);
+		return SOCKET_ERROR;
+	}
+
 	if (events & PGM_POLLIN)
 	{
 		pgm_assert ( (1 + nfds) <= *n_fds );
 		fds[nfds].fd = sock->recv_sock;
 		fds[nfds].events = PGM_POLLIN;
 		nfds++;
+		for (unsigned i = 0; i < sock->recv_sock_extra_len; i++) {
+			pgm_assert ( (1 + nfds) <= *n_fds );
+			fds[nfds].fd = sock->recv_sock_extra[i];
+			fds[nfds].events = PGM_POLLIN;
+			nfds++;
+		}
+#ifdef HAVE_LINUX_IO_URING_H
+		if (sock->rx_uring) {
+			pgm_assert ( (1 + nfds) <= *n_fds );
+			fds[nfds].fd = pgm_recv_uring_get_socket (sock->rx_uring);
+			fds[nfds].events = PGM_POLLIN;
+			nfds++;
+		}
+#endif
+#ifdef PGM_HAVE_RIO
+		if (sock->rio) {
+			pgm_assert ( (1 + nfds) <= *n_fds );
+			fds[nfds].fd = pgm_rio_get_socket (sock->rio);
+			fds[nfds].events = PGM_POLLIN;
+			nfds++;
+		}
+#endif
+#ifdef HAVE_LINUX_IF_XDP_H
+		if (sock->rx_xdp) {
+			pgm_assert ( (1 + nfds) <= *n_fds );
+			fds[nfds].fd = pgm_recv_xdp_get_socket (sock->rx_xdp);
+			fds[nfds].events = PGM_POLLIN;
+			nfds++;
+		}
+#endif
+#ifdef HAVE_INFINIBAND_VERBS_H
+		if (sock->verbs) {
+			pgm_assert ( (1 + nfds) <= *n_fds );
+			fds[nfds].fd = pgm_verbs_get_socket (sock->verbs);
+			fds[nfds].events = PGM_POLLIN;
+			nfds++;
+		}
+#endif
+#ifdef HAVE_LINUX_IF_PACKET_H
+		if (sock->rx_tpacket) {
+			pgm_assert ( (1 + nfds) <= *n_fds );
+			fds[nfds].fd = pgm_recv_tpacket_get_socket (sock->rx_tpacket);
+			fds[nfds].events = PGM_POLLIN;
+			nfds++;
+		}
+#endif
 		if (sock->can_send_data) {
 			pgm_assert ( (1 + nfds) <= *n_fds );
 			fds[nfds].fd = pgm_notify_get_socket (&sock->rdata_notify);
@@ -2695,6 +6847,39 @@ pgm_epoll_ctl (
 		retval = epoll_ctl (epfd, op, sock->recv_sock, &event);
 		if (retval)
 			goto out;
+		for (unsigned i = 0; i < sock->recv_sock_extra_len; i++) {
+			retval = epoll_ctl (epfd, op, sock->recv_sock_extra[i], &event);
+			if (retval)
+				goto out;
+		}
+#ifdef HAVE_LINUX_IO_URING_H
+		if (sock->rx_uring) {
+			retval = epoll_ctl (epfd, op, pgm_recv_uring_get_socket (sock->rx_uring), &event);
+			if (retval)
+				goto out;
+		}
+#endif
+#ifdef HAVE_LINUX_IF_XDP_H
+		if (sock->rx_xdp) {
+			retval = epoll_ctl (epfd, op, pgm_recv_xdp_get_socket (sock->rx_xdp), &event);
+			if (retval)
+				goto out;
+		}
+#endif
+#ifdef HAVE_INFINIBAND_VERBS_H
+		if (sock->verbs) {
+			retval = epoll_ctl (epfd, op, pgm_verbs_get_socket (sock->verbs), &event);
+			if (retval)
+				goto out;
+		}
+#endif
+#ifdef HAVE_LINUX_IF_PACKET_H
+		if (sock->rx_tpacket) {
+			retval = epoll_ctl (epfd, op, pgm_recv_tpacket_get_socket (sock->rx_tpacket), &event);
+			if (retval)
+				goto out;
+		}
+#endif
 		if (sock->can_send_data) {
 			retval = epoll_ctl (epfd, op, pgm_notify_get_socket (&sock->rdata_notify), &event);
 			if (retval)
@@ -2745,6 +6930,102 @@ out:
 }
 #endif /* HAVE_EPOLL_CTL */
 
+/* add kqueue filters for the socket in one kevent() call, EVFILT_READ on the receive
+ * sockets and notifications for POLLIN, EVFILT_WRITE on the send socket for POLLOUT.
+ * flags are one of EV_ADD, EV_DELETE, EV_ENABLE or EV_DISABLE, optionally with
+ * EV_CLEAR or EV_ONESHOT.  each event carries the socket as udata.
+ *
+ * with POLLIN the protocol timers are added as a one-shot EVFILT_TIMER identified by the
+ * socket, re-armed at the next expiration by each receive call that would block, such
+ * that no timeout from PGM_TIME_REMAIN is required.  one kqueue per socket holds the timer.
+ *
+ * returns 0 on success, -1 on failure and sets errno appropriately.
+ */
+#ifdef HAVE_KQUEUE
+int
+pgm_kqueue_ctl (
+	pgm_sock_t* const	sock,
+	const int		kq,
+	const int		flags,		/* EV_ADD, EV_DELETE, ... */
+	const short		events		/* POLLIN, POLLOUT */
+	)
+{
+	struct kevent changes[ PGM_MAX_RECV_SOCKETS + 4 ];
+	int n = 0;
+	const int op = flags & (EV_ADD | EV_DELETE | EV_ENABLE | EV_DISABLE);
+
+	if (!(op == EV_ADD || op == EV_DELETE || op == EV_ENABLE || op == EV_DISABLE))
+	{
+		pgm_set_last_sock_error (PGM_SOCK_EINVAL);
+		return SOCKET_ERROR;
+	}
+	else if (!sock->is_bound || sock->is_destroyed)
+	{
+		pgm_set_last_sock_error (PGM_SOCK_EINVAL);
+		return SOCKET_ERROR;
+	}
+
+	if (events & POLLIN)
+	{
+		EV_SET(&changes[n++], sock->recv_sock, EVFILT_READ, flags, 0, 0, sock);
+		for (unsigned i = 0; i < sock->recv_sock_extra_len; i++)
+			EV_SET(&changes[n++], sock->recv_sock_extra[i], EVFILT_READ, flags, 0, 0, sock);
+		if (sock->can_send_data)
+			EV_SET(&changes[n++], pgm_notify_get_socket (&sock->rdata_notify), EVFILT_READ, flags, 0, 0, sock);
+		EV_SET(&changes[n++], pgm_notify_get_socket (&sock->pending_notify), EVFILT_READ, flags, 0, 0, sock);
+
+		if (flags & EV_CLEAR)
+			sock->is_edge_triggered_recv = TRUE;
+	}
+
+	if (sock->can_send_data && events & POLLOUT)
+	{
+		bool enable_ack_socket = FALSE;
+		bool enable_send_socket = FALSE;
+
+/* both filters need to be added when PGMCC is enabled */
+		if (sock->use_pgmcc && EV_ADD == op) {
+			enable_ack_socket = enable_send_socket = TRUE;
+		} else {
+/* automagically switch filter when congestion stall occurs */
+			if (sock->use_pgmcc && sock->tokens < pgm_fp8 (1))
+				enable_ack_socket = TRUE;
+			else
+				enable_send_socket = TRUE;
+		}
+
+/* rx thread poll for ACK */
+		if (enable_ack_socket)
+			EV_SET(&changes[n++], pgm_notify_get_socket (&sock->ack_notify), EVFILT_READ, flags & ~EV_CLEAR, 0, 0, sock);
+/* kernel resource poll */
+		if (enable_send_socket)
+			EV_SET(&changes[n++], sock->send_sock, EVFILT_WRITE, flags, 0, 0, sock);
+	}
+
+	if (n > 0 && SOCKET_ERROR == kevent (kq, changes, n, NULL, 0, NULL))
+		return SOCKET_ERROR;
+
+/* protocol timers */
+	if (events & POLLIN)
+	{
+		if (EV_DELETE == op) {
+			if (kq == sock->timer_kq) {
+				struct kevent kev;
+/* one-shot timer may have fired and been removed already */
+				EV_SET(&kev, (uintptr_t)sock, EVFILT_TIMER, EV_DELETE, 0, 0, NULL);
+				kevent (kq, &kev, 1, NULL, 0, NULL);
+				sock->timer_kq = INVALID_SOCKET;
+			}
+		} else if (EV_ADD == op) {
+			sock->timer_kq = kq;
+			if (sock->is_connected)
+				pgm_timer_arm (sock);
+		}
+	}
+	return 0;
+}
+#endif /* HAVE_KQUEUE */
+
 static
 const char*
 pgm_sock_type_string (
@@ -2778,4 +7059,328 @@ pgm_protocol_string (
 	return c;
 }
 
+#if defined(HAVE_LINUX_NET_TSTAMP_H) && defined(SO_TIMESTAMPING)
+/* request receive time stamps of kernel software, and with mode 2 of NIC hardware,
+ * reported per datagram in a SCM_TIMESTAMPING control message.
+ */
+
+static
+int
+set_timestamping (
+	const SOCKET	s,
+	const unsigned	mode
+	)
+{
+	int v = 0;
+	if (mode > 0)
+		v |= SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+	if (mode > 1)
+		v |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+	return setsockopt (s, SOL_SOCKET, SO_TIMESTAMPING, (const char*)&v, sizeof(v));
+}
+#endif
+
+#if defined(HAVE_LINUX_ERRQUEUE_H) && defined(HAVE_LINUX_NET_TSTAMP_H) && defined(SO_TIMESTAMPING)
+/* request transmit time stamps on entering the qdisc and leaving the driver, and with
+ * mode 2 from the NIC, each reported on the error queue with a copy of the datagram.
+ */
+
+static
+int
+set_tx_timestamping (
+	const SOCKET	s,
+	const unsigned	mode
+	)
+{
+	int v = 0;
+	if (mode > 0)
+		v |= SOF_TIMESTAMPING_TX_SCHED | SOF_TIMESTAMPING_TX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+	if (mode > 1)
+		v |= SOF_TIMESTAMPING_TX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+	return setsockopt (s, SOL_SOCKET, SO_TIMESTAMPING, (const char*)&v, sizeof(v));
+}
+#endif
+
+/* open count - 1 additional receive sockets sharing the UDP port of recv_sock,
+ * any socket only receives multicast groups joined on itself.
+ *
+ * returns TRUE on success, returns FALSE on failure leaving only recv_sock open.
+ */
+
+static
+bool
+open_recv_sockets (
+	pgm_sock_t* const	sock,
+	const unsigned		count
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (IPPROTO_UDP == sock->protocol);
+	pgm_assert (count > 0);
+	pgm_assert (count <= PGM_MAX_RECV_SOCKETS);
+	pgm_assert (0 == sock->recv_sock_extra_len);
+
+	if (1 == count)
+		return TRUE;
+
+#ifdef SO_REUSEPORT
+	if (SOCKET_ERROR == pgm_sockaddr_multicast_all (sock->recv_sock, sock->family, FALSE)) {
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Per-socket multicast membership not supported by kernel."));
+		return FALSE;
+	}
+
+	const int v = 1, rcvbuf = (int)sock->rcvbuf;
+	while (1 + sock->recv_sock_extra_len < count)
+	{
+		const SOCKET new_sock = socket (sock->family, SOCK_DGRAM, sock->protocol);
+		if (INVALID_SOCKET == new_sock)
+			goto err_close;
+		pgm_sockaddr_nonblocking (new_sock, TRUE);
+		if (SOCKET_ERROR == setsockopt (new_sock, SOL_SOCKET, SO_REUSEPORT, (const char*)&v, sizeof(v)) ||
+		    SOCKET_ERROR == pgm_sockaddr_pktinfo (new_sock, sock->family, TRUE) ||
+		    SOCKET_ERROR == pgm_sockaddr_multicast_all (new_sock, sock->family, FALSE) ||
+		    (rcvbuf > 0 &&
+		     SOCKET_ERROR == setsockopt (new_sock, SOL_SOCKET, SO_RCVBUF, (const char*)&rcvbuf, sizeof(rcvbuf))))
+		{
+			closesocket (new_sock);
+			goto err_close;
+		}
+#	ifdef UDP_GRO
+		if (sock->use_udp_gro)
+			setsockopt (new_sock, SOL_UDP, UDP_GRO, (const char*)&v, sizeof(v));
+#	endif
+#	ifdef SO_RXQ_OVFL
+		setsockopt (new_sock, SOL_SOCKET, SO_RXQ_OVFL, (const char*)&v, sizeof(v));
+#	endif
+#	if defined(HAVE_LINUX_NET_TSTAMP_H) && defined(SO_TIMESTAMPING)
+		if (sock->timestamping)
+			set_timestamping (new_sock, sock->timestamping);
+#	endif
+		sock->recv_sock_extra[sock->recv_sock_extra_len++] = new_sock;
+	}
+	pgm_trace (PGM_LOG_ROLE_NETWORK,_("Opened %u receive sockets."), count);
+	return TRUE;
+
+err_close:
+	{
+		const int save_errno = pgm_get_last_sock_error();
+		char errbuf[1024];
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Opening additional receive socket: %s"),
+			   pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+	}
+	while (sock->recv_sock_extra_len > 0)
+		closesocket (sock->recv_sock_extra[--sock->recv_sock_extra_len]);
+	pgm_sockaddr_multicast_all (sock->recv_sock, sock->family, TRUE);
+	return FALSE;
+#else
+	pgm_trace (PGM_LOG_ROLE_NETWORK,_("SO_REUSEPORT not supported by platform."));
+	return FALSE;
+#endif /* SO_REUSEPORT */
+}
+
+/* receive socket owning membership of a multicast group, partitioned by the low order
+ * bits of the group address.
+ */
+
+static
+SOCKET
+recv_sock_for_group (
+	const pgm_sock_t* const		sock,
+	const struct sockaddr* const	group
+	)
+{
+	uint32_t hash = 0;
+
+	if (0 == sock->recv_sock_extra_len)
+		return sock->recv_sock;
+
+	switch (group->sa_family) {
+	case AF_INET:
+		hash = ntohl (((const struct sockaddr_in*)group)->sin_addr.s_addr);
+		break;
+	case AF_INET6: {
+		const uint8_t* addr = ((const struct sockaddr_in6*)group)->sin6_addr.s6_addr;
+		hash = (uint32_t)addr[12] << 24 | (uint32_t)addr[13] << 16 | (uint32_t)addr[14] << 8 | addr[15];
+		break;
+	}
+	default: break;
+	}
+
+	const unsigned i = hash % (1 + sock->recv_sock_extra_len);
+	return (0 == i) ? sock->recv_sock : sock->recv_sock_extra[i - 1];
+}
+
+/* room for count more group memberships, the array grows by doubling under the receiver
+ * mutex as the receive path reads it.  the kernel applies its own limit per socket,
+ * on Linux net.ipv4.igmp_max_memberships, spread groups with PGM_RECV_SOCKETS.
+ *
+ * returns TRUE on success, returns FALSE when PGM_MAX_MEMBERSHIPS would be exceeded.
+ */
+
+static
+bool
+recv_gsr_reserve (
+	pgm_sock_t* const	sock,
+	const unsigned		count
+	)
+{
+	if (PGM_LIKELY(count <= sock->recv_gsr_size - sock->recv_gsr_len))
+		return TRUE;
+	if (PGM_UNLIKELY(count > PGM_MAX_MEMBERSHIPS - sock->recv_gsr_len))
+		return FALSE;
+
+	unsigned size = sock->recv_gsr_size ? sock->recv_gsr_size : IP_MAX_MEMBERSHIPS;
+	while (size - sock->recv_gsr_len < count)
+		size = MIN(2 * size, PGM_MAX_MEMBERSHIPS);
+	pgm_mutex_lock (&sock->receiver_mutex);
+	sock->recv_gsr = pgm_realloc (sock->recv_gsr, size * sizeof (struct group_source_req));
+	memset (&sock->recv_gsr[ sock->recv_gsr_size ], 0, (size - sock->recv_gsr_size) * sizeof (struct group_source_req));
+	sock->recv_gsr_size = size;
+	pgm_mutex_unlock (&sock->receiver_mutex);
+	return TRUE;
+}
+
+/* order group/source pairs by interface, group, then source.
+ */
+
+static
+int
+gsr_cmp (
+	const void*	a,
+	const void*	b
+	)
+{
+	const struct group_source_req* gsr_a = a;
+	const struct group_source_req* gsr_b = b;
+	if (gsr_a->gsr_interface != gsr_b->gsr_interface)
+		return gsr_a->gsr_interface < gsr_b->gsr_interface ? -1 : 1;
+	const int retval = pgm_sockaddr_cmp ((const struct sockaddr*)&gsr_a->gsr_group, (const struct sockaddr*)&gsr_b->gsr_group);
+	if (0 != retval)
+		return retval;
+	return pgm_sockaddr_cmp ((const struct sockaddr*)&gsr_a->gsr_source, (const struct sockaddr*)&gsr_b->gsr_source);
+}
+
+/* returns TRUE if entry of sock::recv_gsr is a source of the group of the sorted
+ * pairs but not among them.
+ */
+
+static inline
+bool
+is_earlier_source (
+	const struct group_source_req*	 const restrict entry,
+	const struct group_source_req*	 const restrict pairs,
+	const unsigned				len
+	)
+{
+	return entry->gsr_interface == pairs[0].gsr_interface &&
+	       0 == pgm_sockaddr_cmp ((const struct sockaddr*)&entry->gsr_group, (const struct sockaddr*)&pairs[0].gsr_group) &&
+/* ASM entries hold the group as source */
+	       0 != pgm_sockaddr_cmp ((const struct sockaddr*)&entry->gsr_source, (const struct sockaddr*)&entry->gsr_group) &&
+	       NULL == bsearch (entry, pairs, len, sizeof (struct group_source_req), gsr_cmp);
+}
+
+/* join count group/source pairs, one kernel join per group and one include list of
+ * the group's sources, plus any joined earlier as the list replaces the filter.
+ * room for count entries of sock::recv_gsr is reserved.
+ *
+ * returns TRUE on success, returns FALSE on the first pair refused.
+ */
+
+static
+bool
+join_source_groups (
+	pgm_sock_t*			 const restrict sock,
+	const struct group_source_req*	 const restrict gsr,
+	const unsigned				count
+	)
+{
+	struct group_source_req* pairs;
+	unsigned i, len = 0;
+	bool status = FALSE;
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != gsr);
+	pgm_assert (count <= sock->recv_gsr_size - sock->recv_gsr_len);
+
+	for (i = 0; i < count; i++)
+		if (PGM_UNLIKELY(sock->family != gsr[i].gsr_group.ss_family ||
+				 sock->family != gsr[i].gsr_source.ss_family))
+			return FALSE;
+
+/* sort then drop duplicates */
+	pairs = pgm_new (struct group_source_req, count);
+	memcpy (pairs, gsr, count * sizeof (struct group_source_req));
+	qsort (pairs, count, sizeof (struct group_source_req), gsr_cmp);
+	for (i = 0; i < count; i++)
+		if (0 == len || 0 != gsr_cmp (&pairs[len - 1], &pairs[i]))
+			memmove (&pairs[len++], &pairs[i], sizeof (struct group_source_req));
+
+	for (i = 0; i < len;)
+	{
+		const struct sockaddr* group = (const struct sockaddr*)&pairs[i].gsr_group;
+		const SOCKET recv_sock = recv_sock_for_group (sock, group);
+		unsigned j = i + 1;
+		while (j < len &&
+		       pairs[j].gsr_interface == pairs[i].gsr_interface &&
+		       0 == pgm_sockaddr_cmp ((const struct sockaddr*)&pairs[j].gsr_group, group))
+			j++;
+
+		if (SOCKET_ERROR == pgm_sockaddr_join_source_group (recv_sock, sock->family, &pairs[i]))
+			goto out;
+		unsigned joined = i + 1;
+#if defined(MCAST_MSFILTER) || defined(SIOCSMSFILTER)
+		if (j - i > 1)
+		{
+/* include sources of the group joined earlier on this socket */
+			unsigned numsrc = j - i;
+			for (unsigned k = 0; k < sock->recv_gsr_len; k++)
+				if (is_earlier_source (&sock->recv_gsr[k], &pairs[i], j - i))
+					numsrc++;
+			struct group_filter* gf_list = pgm_malloc0 (GROUP_FILTER_SIZE(numsrc));
+			gf_list->gf_interface	= pairs[i].gsr_interface;
+			gf_list->gf_fmode	= MCAST_INCLUDE;
+			gf_list->gf_numsrc	= numsrc;
+			memcpy (&gf_list->gf_group, group, pgm_sockaddr_len (group));
+			numsrc = 0;
+			for (unsigned k = i; k < j; k++)
+				memcpy (&gf_list->gf_slist[ numsrc++ ], &pairs[k].gsr_source, sizeof (struct sockaddr_storage));
+			for (unsigned k = 0; k < sock->recv_gsr_len; k++)
+				if (is_earlier_source (&sock->recv_gsr[k], &pairs[i], j - i))
+					memcpy (&gf_list->gf_slist[ numsrc++ ], &sock->recv_gsr[k].gsr_source, sizeof (struct sockaddr_storage));
+			if (SOCKET_ERROR != pgm_sockaddr_msfilter (recv_sock, sock->family, gf_list))
+				joined = j;
+			pgm_free (gf_list);
+		}
+#endif
+/* one at a time where a filter list is not available or refused */
+		for (; joined < j; joined++)
+			if (SOCKET_ERROR == pgm_sockaddr_join_source_group (recv_sock, sock->family, &pairs[joined]))
+				break;
+
+/* entries visible to the receive path */
+		memcpy (&sock->recv_gsr[ sock->recv_gsr_len ], &pairs[i], (joined - i) * sizeof (struct group_source_req));
+		pgm_mutex_lock (&sock->receiver_mutex);
+		sock->recv_gsr_len += joined - i;
+		pgm_mutex_unlock (&sock->receiver_mutex);
+		if (PGM_UNLIKELY(pgm_log_mask & PGM_LOG_ROLE_NETWORK))
+		{
+			char addr[INET6_ADDRSTRLEN];
+			pgm_sockaddr_ntop (group, addr, sizeof(addr));
+			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Join multicast group %s from %u sources on interface index %u"),
+				addr,
+				joined - i,
+				(unsigned)pairs[i].gsr_interface);
+		}
+		if (joined < j)
+			goto out;
+		i = j;
+	}
+	status = TRUE;
+out:
+	pgm_free (pairs);
+	return status;
+}
+
 /* eof */
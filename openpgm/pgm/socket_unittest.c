@@ -56,20 +56,43 @@
 
 #define pgm_ipproto_pgm		mock_pgm_ipproto_pgm
 #define pgm_peer_unref		mock_pgm_peer_unref
+#define pgm_peers_reclaim_all	mock_pgm_peers_reclaim_all
 #define pgm_on_nak_notify	mock_pgm_on_nak_notify
 #define pgm_send_spm		mock_pgm_send_spm
+#define pgm_source_select_send	mock_pgm_source_select_send
 #define pgm_timer_prepare	mock_pgm_timer_prepare
 #define pgm_timer_check		mock_pgm_timer_check
 #define pgm_timer_expiration	mock_pgm_timer_expiration
 #define pgm_timer_dispatch	mock_pgm_timer_dispatch
+#define pgm_timer_thread_start	mock_pgm_timer_thread_start
+#define pgm_timer_thread_stop	mock_pgm_timer_thread_stop
+#define pgm_timer_next_ambient_spm	mock_pgm_timer_next_ambient_spm
 #define pgm_txw_create		mock_pgm_txw_create
 #define pgm_txw_shutdown	mock_pgm_txw_shutdown
+#define pgm_txw_parity_start	mock_pgm_txw_parity_start
 #define pgm_rate_create		mock_pgm_rate_create
 #define pgm_rate_destroy	mock_pgm_rate_destroy
+#define pgm_rate_pace		mock_pgm_rate_pace
 #define pgm_rate_remaining	mock_pgm_rate_remaining
 #define pgm_rs_create		mock_pgm_rs_create
 #define pgm_rs_destroy		mock_pgm_rs_destroy
 #define pgm_time_update_now	mock_pgm_time_update_now
+#define pgm_capture_new		mock_pgm_capture_new
+#define pgm_capture_destroy	mock_pgm_capture_destroy
+#define pgm_recorder_new	mock_pgm_recorder_new
+#define pgm_recorder_destroy	mock_pgm_recorder_destroy
+#define pgm_txw_store_open	mock_pgm_txw_store_open
+#define pgm_txw_store_close	mock_pgm_txw_store_close
+#define pgm_txw_store_resume	mock_pgm_txw_store_resume
+#define pgm_txw_store_reset	mock_pgm_txw_store_reset
+#define pgm_txw_store_attach	mock_pgm_txw_store_attach
+#define pgm_txw_store_extent	mock_pgm_txw_store_extent
+#define pgm_txw_store_geometry	mock_pgm_txw_store_geometry
+#define pgm_txw_set_store	mock_pgm_txw_set_store
+#define pgm_restart_open	mock_pgm_restart_open
+#define pgm_restart_close	mock_pgm_restart_close
+#define pgm_local_create	mock_pgm_local_create
+#define pgm_local_destroy	mock_pgm_local_destroy
 
 #define SOCK_DEBUG
 #include "socket.c"
@@ -154,6 +177,10 @@ preconnect_socket (
 	((struct sockaddr_in*)&sock->send_gsr.gsr_group)->sin_addr.s_addr = inet_addr ("239.192.0.1");
 
 /* rx */
+	if (NULL == sock->recv_gsr) {
+		sock->recv_gsr = g_new0 (struct group_source_req, IP_MAX_MEMBERSHIPS);
+		sock->recv_gsr_size = IP_MAX_MEMBERSHIPS;
+	}
 	sock->recv_gsr_len = 1;
 	((struct sockaddr*)&sock->recv_gsr[0].gsr_group)->sa_family = ((struct sockaddr*)&sock->send_gsr.gsr_group)->sa_family;
 	((struct sockaddr*)&sock->recv_gsr[0].gsr_source)->sa_family = ((struct sockaddr*)&sock->send_gsr.gsr_group)->sa_family;
@@ -185,11 +212,43 @@ generate_sock (void)
 	sock->dport = g_htons(TEST_PORT);
 	sock->window = g_new0 (pgm_txw_t, 1);
 	sock->iphdr_len = sizeof(struct pgm_ip);
-	pgm_spinlock_init (&sock->txw_spinlock);
 	pgm_rwlock_init (&sock->lock);
 	return sock;
 }
 
+/* as generate_sock() with UDP encapsulation over datagram sockets, such that
+ * UDP socket options reach the kernel.
+ */
+
+static
+struct pgm_sock_t*
+generate_udp_sock (void)
+{
+	struct pgm_sock_t* sock = generate_sock ();
+	close (sock->recv_sock);
+	close (sock->send_sock);
+	sock->protocol = IPPROTO_UDP;
+	sock->recv_sock = socket (AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	sock->send_sock = socket (AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	return sock;
+}
+
+/* read an int option back through pgm_getsockopt(), as an application would.
+ */
+
+static
+int
+get_int_opt (
+	pgm_sock_t*		sock,
+	const int		optname
+	)
+{
+	int optval = -1;
+	socklen_t optlen = sizeof(optval);
+	fail_unless (TRUE == pgm_getsockopt (sock, IPPROTO_PGM, optname, &optval, &optlen), "getsockopt failed");
+	return optval;
+}
+
 /** receiver module */
 PGM_GNUC_INTERNAL
 void
@@ -199,6 +258,14 @@ mock_pgm_peer_unref (
 {
 }
 
+PGM_GNUC_INTERNAL
+void
+mock_pgm_peers_reclaim_all (
+	pgm_sock_t*const	sock
+	)
+{
+}
+
 /** source module */
 static
 bool
@@ -221,6 +288,14 @@ mock_pgm_send_spm (
 	return TRUE;
 }
 
+PGM_GNUC_INTERNAL
+void
+mock_pgm_source_select_send (
+	pgm_sock_t*		sock
+	)
+{
+}
+
 /** timer module */
 PGM_GNUC_INTERNAL
 bool
@@ -258,6 +333,33 @@ mock_pgm_timer_dispatch (
 	return TRUE;
 }
 
+PGM_GNUC_INTERNAL
+bool
+mock_pgm_timer_thread_start (
+	pgm_sock_t* const		sock
+	)
+{
+	return TRUE;
+}
+
+PGM_GNUC_INTERNAL
+void
+mock_pgm_timer_thread_stop (
+	pgm_sock_t* const		sock
+	)
+{
+}
+
+PGM_GNUC_INTERNAL
+pgm_time_t
+mock_pgm_timer_next_ambient_spm (
+	pgm_sock_t* const		sock,
+	const pgm_time_t		now
+	)
+{
+	return now + sock->spm_ambient_interval;
+}
+
 /** transmit window module */
 pgm_txw_t*
 mock_pgm_txw_create (
@@ -268,7 +370,8 @@ mock_pgm_txw_create (
 	const ssize_t		max_rte,
 	const bool		use_fec,
 	const uint8_t		rs_n,
-	const uint8_t		rs_k
+	const uint8_t		rs_k,
+	const pgm_mem_policy_t*const policy
 	)
 {
 	pgm_txw_t* window = g_new0 (pgm_txw_t, 1);
@@ -283,6 +386,16 @@ mock_pgm_txw_shutdown (
 	g_free (window);
 }
 
+bool
+mock_pgm_txw_parity_start (
+	pgm_txw_t* const	window,
+	const uint8_t		h,
+	pgm_notify_t* const	notify
+	)
+{
+	return TRUE;
+}
+
 /** rate control module */
 PGM_GNUC_INTERNAL
 void
@@ -303,6 +416,15 @@ mock_pgm_rate_destroy (
 {
 }
 
+PGM_GNUC_INTERNAL
+void
+mock_pgm_rate_pace (
+	pgm_rate_t*		bucket,
+	uint16_t		max_tpdu
+	)
+{
+}
+
 PGM_GNUC_INTERNAL
 pgm_time_t
 mock_pgm_rate_remaining (
@@ -330,6 +452,153 @@ mock_pgm_rs_destroy (
 {
 }
 
+/** capture module */
+struct pgm_capture_t*
+mock_pgm_capture_new (
+	const char*		path,
+	size_t			size,
+	pgm_error_t**		error
+	)
+{
+	return NULL;
+}
+
+void
+mock_pgm_capture_destroy (
+	struct pgm_capture_t*	capture
+	)
+{
+}
+
+/** recorder module */
+struct pgm_recorder_t*
+mock_pgm_recorder_new (
+	const char*		path,
+	uint64_t		segment_size,
+	pgm_error_t**		error
+	)
+{
+	return NULL;
+}
+
+void
+mock_pgm_recorder_destroy (
+	struct pgm_recorder_t*	recorder
+	)
+{
+}
+
+/** transmit window store module */
+struct pgm_txw_store_t*
+mock_pgm_txw_store_open (
+	const char*		path,
+	const pgm_tsi_t*	tsi,
+	const uint16_t		max_tpdu,
+	uint32_t		sqns,
+	pgm_error_t**		error
+	)
+{
+	return NULL;
+}
+
+void
+mock_pgm_txw_store_close (
+	struct pgm_txw_store_t*	store
+	)
+{
+}
+
+bool
+mock_pgm_txw_store_resume (
+	const struct pgm_txw_store_t*const store,
+	uint32_t*		lead,
+	uint32_t*		spm_sqn
+	)
+{
+	return FALSE;
+}
+
+void
+mock_pgm_txw_store_reset (
+	struct pgm_txw_store_t*const store
+	)
+{
+}
+
+struct pgm_txw_store_t*
+mock_pgm_txw_store_attach (
+	const char*		path,
+	pgm_error_t**		error
+	)
+{
+	return NULL;
+}
+
+bool
+mock_pgm_txw_store_extent (
+	const struct pgm_txw_store_t*const store,
+	uint32_t*		trail,
+	uint32_t*		lead
+	)
+{
+	return FALSE;
+}
+
+void
+mock_pgm_txw_store_geometry (
+	const struct pgm_txw_store_t*const store,
+	pgm_tsi_t*		tsi,
+	uint32_t*		sqns,
+	uint16_t*		max_tpdu
+	)
+{
+}
+
+void
+mock_pgm_txw_set_store (
+	pgm_txw_t*const		window,
+	struct pgm_txw_store_t*const store
+	)
+{
+}
+
+/** warm restart module */
+struct pgm_restart_t*
+mock_pgm_restart_open (
+	const char*		name,
+	unsigned		sources,
+	pgm_error_t**		error
+	)
+{
+	return NULL;
+}
+
+void
+mock_pgm_restart_close (
+	struct pgm_restart_t*	restart
+	)
+{
+}
+
+/** local fan-out module */
+pgm_local_t*
+mock_pgm_local_create (
+	const char*		name,
+	unsigned		slots,
+	const uint16_t		max_tsdu,
+	pgm_error_t**		error
+	)
+{
+	return NULL;
+}
+
+void
+mock_pgm_local_destroy (
+	pgm_local_t*		local
+	)
+{
+}
+
 /** time module */
 static pgm_time_t _mock_pgm_time_update_now (void);
 pgm_time_update_func mock_pgm_time_update_now = _mock_pgm_time_update_now;
@@ -384,6 +653,24 @@ START_TEST (test_create_pass_001)
 }
 END_TEST
 
+/* sending and receiving thread state on separate cache lines */
+START_TEST (test_create_pass_002)
+{
+	pgm_error_t* err = NULL;
+	pgm_sock_t* sock = NULL;
+#define CACHELINE_OF(member)	(offsetof(struct pgm_sock_t, member) / PGM_CACHELINE_SIZE)
+	fail_unless (TRUE == pgm_socket (&sock, AF_INET, SOCK_SEQPACKET, IPPROTO_PGM, &err), "create failed");
+	fail_unless (0 == (uintptr_t)sock % PGM_CACHELINE_SIZE, "unaligned socket");
+	fail_unless (CACHELINE_OF(tokens) != CACHELINE_OF(peers_pending), "tokens shares line with peers_pending");
+	fail_unless (CACHELINE_OF(spm_sqn) != CACHELINE_OF(rx_buffer), "spm_sqn shares line with rx_buffer");
+	fail_unless (CACHELINE_OF(send_mutex) != CACHELINE_OF(receiver_mutex), "send_mutex shares line with receiver_mutex");
+	fail_unless (CACHELINE_OF(source_mutex) != CACHELINE_OF(lock), "source_mutex shares line with lock");
+	fail_unless (CACHELINE_OF(timer_mutex) != CACHELINE_OF(is_pending_read), "timer_mutex shares line with receiver state");
+	fail_unless (CACHELINE_OF(cumulative_stats) != CACHELINE_OF(next_poll), "statistics share line with timer");
+#undef CACHELINE_OF
+}
+END_TEST
+
 /* NULL socket */
 START_TEST (test_create_fail_002)
 {
@@ -1154,58 +1441,2777 @@ START_TEST (test_set_udp_multicast_fail_001)
 }
 END_TEST
 
-static
-Suite*
-make_test_suite (void)
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_RECV_BATCH,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_recv_batch_pass_001)
 {
-	Suite* s;
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RECV_BATCH;
+	const int recv_batch	= 32;
+	const void* optval	= &recv_batch;
+	const socklen_t optlen	= sizeof(recv_batch);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_recv_batch failed");
+	fail_unless (recv_batch == get_int_opt (sock, optname), "recv_batch not read back");
+}
+END_TEST
 
-	s = suite_create (__FILE__);
+START_TEST (test_set_recv_batch_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RECV_BATCH;
+	const int recv_batch	= 32;
+	const void* optval	= &recv_batch;
+	const socklen_t optlen	= sizeof(recv_batch);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_recv_batch failed");
+}
+END_TEST
 
-	TCase* tc_create = tcase_create ("create");
-	suite_add_tcase (s, tc_create);
-	tcase_add_checked_fixture (tc_create, mock_setup, mock_teardown);
-	tcase_add_test (tc_create, test_create_pass_001);
-	tcase_add_test (tc_create, test_create_fail_002);
-	tcase_add_test (tc_create, test_create_fail_003);
-	tcase_add_test (tc_create, test_create_fail_004);
-	tcase_add_test (tc_create, test_create_fail_005);
+START_TEST (test_set_recv_batch_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RECV_BATCH;
+	const int recv_batch	= PGM_MAX_RECV_BATCH + 1;
+	const void* optval	= &recv_batch;
+	const socklen_t optlen	= sizeof(recv_batch);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_recv_batch failed");
+	fail_unless (0 == get_int_opt (sock, optname), "rejected recv_batch applied");
+}
+END_TEST
 
-	TCase* tc_bind = tcase_create ("bind");
-	suite_add_tcase (s, tc_bind);
-	tcase_add_checked_fixture (tc_bind, mock_setup, mock_teardown);
-	tcase_add_test (tc_bind, test_bind_fail_001);
-	tcase_add_test (tc_bind, test_bind_fail_002);
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_UDP_GSO,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
 
-	TCase* tc_connect = tcase_create ("connect");
-	suite_add_tcase (s, tc_connect);
-	tcase_add_checked_fixture (tc_connect, mock_setup, mock_teardown);
-	tcase_add_test (tc_connect, test_connect_pass_001);
-	tcase_add_test (tc_connect, test_connect_fail_001);
+START_TEST (test_set_udp_gso_pass_001)
+{
+	pgm_sock_t* sock = generate_udp_sock ();
+	fail_if (NULL == sock, "generate_udp_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_UDP_GSO;
+	int udp_gso		= 1;
+	const void* optval	= &udp_gso;
+	const socklen_t optlen	= sizeof(udp_gso);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_udp_gso failed");
+#ifdef UDP_SEGMENT
+	fail_unless (1 == get_int_opt (sock, optname), "udp_gso not enabled");
+#else
+	fail_unless (0 == get_int_opt (sock, optname), "udp_gso enabled without kernel support");
+#endif
+	udp_gso = 0;
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_udp_gso failed");
+	fail_unless (0 == get_int_opt (sock, optname), "udp_gso not disabled");
+}
+END_TEST
 
-	TCase* tc_destroy = tcase_create ("destroy");
-	suite_add_tcase (s, tc_destroy);
-	tcase_add_checked_fixture (tc_destroy, mock_setup, mock_teardown);
-	tcase_add_test (tc_destroy, test_destroy_pass_001);
-	tcase_add_test (tc_destroy, test_destroy_fail_001);
+START_TEST (test_set_udp_gso_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_UDP_GSO;
+	const int udp_gso	= 1;
+	const void* optval	= &udp_gso;
+	const socklen_t optlen	= sizeof(udp_gso);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_udp_gso failed");
+}
+END_TEST
 
-	TCase* tc_set_max_tpdu = tcase_create ("set-max-tpdu");
-	suite_add_tcase (s, tc_set_max_tpdu);
-	tcase_add_checked_fixture (tc_set_max_tpdu, mock_setup, mock_teardown);
-	tcase_add_test (tc_set_max_tpdu, test_set_max_tpdu_pass_001);
-	tcase_add_test (tc_set_max_tpdu, test_set_max_tpdu_fail_001);
+START_TEST (test_set_udp_gso_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_UDP_GSO;
+	const int udp_gso	= 1;
+	const void* optval	= &udp_gso;
+	const socklen_t optlen	= sizeof(udp_gso);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_udp_gso failed");
+	fail_unless (0 == get_int_opt (sock, optname), "udp_gso enabled on raw PGM");
+}
+END_TEST
 
-	TCase* tc_set_multicast_loop = tcase_create ("set-multicast-loop");
-	suite_add_tcase (s, tc_set_multicast_loop);
-	tcase_add_checked_fixture (tc_set_multicast_loop, mock_setup, mock_teardown);
-	tcase_add_test (tc_set_multicast_loop, test_set_multicast_loop_pass_001);
-	tcase_add_test (tc_set_multicast_loop, test_set_multicast_loop_fail_001);
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_UDP_GRO,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
 
-	TCase* tc_set_hops = tcase_create ("set-hops");
-	suite_add_tcase (s, tc_set_hops);
-	tcase_add_checked_fixture (tc_set_hops, mock_setup, mock_teardown);
-	tcase_add_test (tc_set_hops, test_set_hops_pass_001);
-	tcase_add_test (tc_set_hops, test_set_hops_fail_001);
+START_TEST (test_set_udp_gro_pass_001)
+{
+	pgm_sock_t* sock = generate_udp_sock ();
+	fail_if (NULL == sock, "generate_udp_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_UDP_GRO;
+	int udp_gro		= 1;
+	const void* optval	= &udp_gro;
+	const socklen_t optlen	= sizeof(udp_gro);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_udp_gro failed");
+#ifdef UDP_GRO
+	fail_unless (1 == get_int_opt (sock, optname), "udp_gro not enabled");
+#else
+	fail_unless (0 == get_int_opt (sock, optname), "udp_gro enabled without kernel support");
+#endif
+	udp_gro = 0;
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_udp_gro failed");
+	fail_unless (0 == get_int_opt (sock, optname), "udp_gro not disabled");
+}
+END_TEST
+
+START_TEST (test_set_udp_gro_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_UDP_GRO;
+	const int udp_gro	= 1;
+	const void* optval	= &udp_gro;
+	const socklen_t optlen	= sizeof(udp_gro);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_udp_gro failed");
+}
+END_TEST
+
+START_TEST (test_set_udp_gro_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_UDP_GRO;
+	const int udp_gro	= 1;
+	const void* optval	= &udp_gro;
+	const socklen_t optlen	= sizeof(udp_gro);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_udp_gro failed");
+	fail_unless (0 == get_int_opt (sock, optname), "udp_gro enabled on raw PGM");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_ZEROCOPY,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_zerocopy_pass_001)
+{
+	pgm_sock_t* sock = generate_udp_sock ();
+	fail_if (NULL == sock, "generate_udp_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_ZEROCOPY;
+	int zerocopy		= 1;
+	const void* optval	= &zerocopy;
+	const socklen_t optlen	= sizeof(zerocopy);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_zerocopy failed");
+#if defined(HAVE_LINUX_ERRQUEUE_H) && defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+	fail_unless (1 == get_int_opt (sock, optname), "zerocopy not enabled");
+	fail_if (NULL == sock->zc_skb, "completion ring not allocated");
+#else
+	fail_unless (0 == get_int_opt (sock, optname), "zerocopy enabled without kernel support");
+#endif
+	zerocopy = 0;
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_zerocopy failed");
+	fail_unless (0 == get_int_opt (sock, optname), "zerocopy not disabled");
+}
+END_TEST
+
+START_TEST (test_set_zerocopy_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_ZEROCOPY;
+	const int zerocopy	= 1;
+	const void* optval	= &zerocopy;
+	const socklen_t optlen	= sizeof(zerocopy);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_zerocopy failed");
+}
+END_TEST
+
+START_TEST (test_set_zerocopy_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_ZEROCOPY;
+	const int zerocopy	= 1;
+	const void* optval	= &zerocopy;
+	const socklen_t optlen	= sizeof(zerocopy) - 1;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_zerocopy failed");
+	fail_unless (0 == get_int_opt (sock, optname), "rejected zerocopy applied");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_RECV_SHARD,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(struct pgm_shard_req_t)
+ *	)
+ */
+
+START_TEST (test_set_recv_shard_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RECV_SHARD;
+	const struct pgm_shard_req_t sr = { 4, 3 };
+	const void* optval	= &sr;
+	const socklen_t optlen	= sizeof(sr);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_recv_shard failed");
+	struct pgm_shard_req_t sr_get = { 0, 0 };
+	socklen_t sr_len = sizeof(sr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &sr_get, &sr_len), "get_recv_shard failed");
+	fail_unless (4 == sr_get.sr_count && 3 == sr_get.sr_index, "recv_shard not read back");
+}
+END_TEST
+
+START_TEST (test_set_recv_shard_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RECV_SHARD;
+	const struct pgm_shard_req_t sr = { 4, 3 };
+	const void* optval	= &sr;
+	const socklen_t optlen	= sizeof(sr);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_recv_shard failed");
+}
+END_TEST
+
+START_TEST (test_set_recv_shard_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RECV_SHARD;
+	const struct pgm_shard_req_t sr = { 4, 4 };
+	const void* optval	= &sr;
+	const socklen_t optlen	= sizeof(sr);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_recv_shard failed");
+	struct pgm_shard_req_t sr_get = { 1, 1 };
+	socklen_t sr_len = sizeof(sr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &sr_get, &sr_len), "get_recv_shard failed");
+	fail_unless (0 == sr_get.sr_count && 0 == sr_get.sr_index, "rejected recv_shard applied");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_RECV_SOCKETS,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_recv_sockets_pass_001)
+{
+	pgm_sock_t* sock = generate_udp_sock ();
+	fail_if (NULL == sock, "generate_udp_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RECV_SOCKETS;
+	const int recv_sockets	= 4;
+	const void* optval	= &recv_sockets;
+	const socklen_t optlen	= sizeof(recv_sockets);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_recv_sockets failed");
+#ifdef SO_REUSEPORT
+	fail_unless (recv_sockets == get_int_opt (sock, optname), "recv_sockets not read back");
+	for (unsigned i = 0; i < sock->recv_sock_extra_len; i++)
+		fail_if (INVALID_SOCKET == sock->recv_sock_extra[i], "extra receive socket not opened");
+#endif
+}
+END_TEST
+
+START_TEST (test_set_recv_sockets_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RECV_SOCKETS;
+	const int recv_sockets	= 1;
+	const void* optval	= &recv_sockets;
+	const socklen_t optlen	= sizeof(recv_sockets);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_recv_sockets failed");
+}
+END_TEST
+
+START_TEST (test_set_recv_sockets_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RECV_SOCKETS;
+	const int recv_sockets	= 0;
+	const void* optval	= &recv_sockets;
+	const socklen_t optlen	= sizeof(recv_sockets);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_recv_sockets failed");
+	fail_unless (1 == get_int_opt (sock, optname), "rejected recv_sockets applied");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_BUSY_POLL,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_busy_poll_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_BUSY_POLL;
+	const int busy_poll	= 50;
+	const void* optval	= &busy_poll;
+	const socklen_t optlen	= sizeof(busy_poll);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_busy_poll failed");
+	fail_unless (busy_poll == get_int_opt (sock, optname), "busy_poll not read back");
+}
+END_TEST
+
+START_TEST (test_set_busy_poll_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_BUSY_POLL;
+	const int busy_poll	= 50;
+	const void* optval	= &busy_poll;
+	const socklen_t optlen	= sizeof(busy_poll);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_busy_poll failed");
+}
+END_TEST
+
+START_TEST (test_set_busy_poll_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_BUSY_POLL;
+	const int busy_poll	= -1;
+	const void* optval	= &busy_poll;
+	const socklen_t optlen	= sizeof(busy_poll);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_busy_poll failed");
+	fail_unless (0 == get_int_opt (sock, optname), "rejected busy_poll applied");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_IO_URING,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_io_uring_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_IO_URING;
+	const int io_uring	= 64;
+	const void* optval	= &io_uring;
+	const socklen_t optlen	= sizeof(io_uring);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_io_uring failed");
+	fail_unless ((unsigned)io_uring == sock->rx_uring_depth, "ring depth not set");
+/* the ring is created by pgm_bind() */
+	fail_unless (0 == get_int_opt (sock, optname), "ring reported before bind");
+}
+END_TEST
+
+START_TEST (test_set_io_uring_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_IO_URING;
+	const int io_uring	= 64;
+	const void* optval	= &io_uring;
+	const socklen_t optlen	= sizeof(io_uring);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_io_uring failed");
+}
+END_TEST
+
+START_TEST (test_set_io_uring_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_IO_URING;
+	const int io_uring	= -1;
+	const void* optval	= &io_uring;
+	const socklen_t optlen	= sizeof(io_uring);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_io_uring failed");
+	fail_unless (0 == sock->rx_uring_depth, "rejected ring depth applied");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_XDP_RECV,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(struct pgm_xdp_req_t)
+ *	)
+ */
+
+START_TEST (test_set_xdp_recv_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_XDP_RECV;
+	const struct pgm_xdp_req_t xdp_req = {
+		.xr_interface	= 1,
+		.xr_queue	= 0,
+		.xr_frames	= 2048,
+		.xr_flags	= PGM_XDP_GENERIC
+	};
+	const void* optval	= &xdp_req;
+	const socklen_t optlen	= sizeof(xdp_req);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_xdp_recv failed");
+	struct pgm_xdp_req_t xdp_get;
+	socklen_t xdp_len = sizeof(xdp_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &xdp_get, &xdp_len), "get_xdp_recv failed");
+	fail_unless (xdp_req.xr_frames == xdp_get.xr_frames, "frames not read back");
+	fail_unless (xdp_req.xr_flags == xdp_get.xr_flags, "flags not read back");
+/* the queue is opened by pgm_bind() */
+	fail_unless (0 == xdp_get.xr_interface, "queue reported before bind");
+}
+END_TEST
+
+START_TEST (test_set_xdp_recv_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_XDP_RECV;
+	const struct pgm_xdp_req_t xdp_req = {
+		.xr_interface	= 1,
+		.xr_queue	= 0,
+		.xr_frames	= 2048,
+		.xr_flags	= 0
+	};
+	const void* optval	= &xdp_req;
+	const socklen_t optlen	= sizeof(xdp_req);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_xdp_recv failed");
+}
+END_TEST
+
+/* frames not a power of 2 */
+START_TEST (test_set_xdp_recv_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_XDP_RECV;
+	const struct pgm_xdp_req_t xdp_req = {
+		.xr_interface	= 1,
+		.xr_queue	= 0,
+		.xr_frames	= 3000,
+		.xr_flags	= 0
+	};
+	const void* optval	= &xdp_req;
+	const socklen_t optlen	= sizeof(xdp_req);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_xdp_recv failed");
+	struct pgm_xdp_req_t xdp_get;
+	socklen_t xdp_len = sizeof(xdp_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &xdp_get, &xdp_len), "get_xdp_recv failed");
+	fail_unless (0 == xdp_get.xr_frames, "rejected frames applied");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_TPACKET_RECV,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(struct pgm_tpacket_req_t)
+ *	)
+ */
+
+START_TEST (test_set_tpacket_recv_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_TPACKET_RECV;
+	const struct pgm_tpacket_req_t tpacket_req = {
+		.tr_interface	= 1,
+		.tr_block_size	= 65536,
+		.tr_blocks	= 32,
+		.tr_timeout	= 2
+	};
+	const void* optval	= &tpacket_req;
+	const socklen_t optlen	= sizeof(tpacket_req);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_tpacket_recv failed");
+	struct pgm_tpacket_req_t tpacket_get;
+	socklen_t tpacket_len = sizeof(tpacket_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &tpacket_get, &tpacket_len), "get_tpacket_recv failed");
+	fail_unless (tpacket_req.tr_block_size == tpacket_get.tr_block_size, "block size not read back");
+	fail_unless (tpacket_req.tr_blocks == tpacket_get.tr_blocks, "blocks not read back");
+	fail_unless (tpacket_req.tr_timeout == tpacket_get.tr_timeout, "timeout not read back");
+/* the ring is mapped by pgm_bind() */
+	fail_unless (0 == tpacket_get.tr_interface, "ring reported before bind");
+}
+END_TEST
+
+START_TEST (test_set_tpacket_recv_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_TPACKET_RECV;
+	const struct pgm_tpacket_req_t tpacket_req = {
+		.tr_interface	= 1,
+		.tr_block_size	= 0,
+		.tr_blocks	= 0,
+		.tr_timeout	= 0
+	};
+	const void* optval	= &tpacket_req;
+	const socklen_t optlen	= sizeof(tpacket_req);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_tpacket_recv failed");
+}
+END_TEST
+
+/* block size not a power of 2 */
+START_TEST (test_set_tpacket_recv_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_TPACKET_RECV;
+	const struct pgm_tpacket_req_t tpacket_req = {
+		.tr_interface	= 1,
+		.tr_block_size	= 12288,
+		.tr_blocks	= 0,
+		.tr_timeout	= 0
+	};
+	const void* optval	= &tpacket_req;
+	const socklen_t optlen	= sizeof(tpacket_req);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_tpacket_recv failed");
+	struct pgm_tpacket_req_t tpacket_get;
+	socklen_t tpacket_len = sizeof(tpacket_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &tpacket_get, &tpacket_len), "get_tpacket_recv failed");
+	fail_unless (0 == tpacket_get.tr_block_size, "rejected block size applied");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_SINGLE_THREADED,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_single_threaded_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_SINGLE_THREADED;
+	const int single_threaded = 1;
+	const void* optval	= &single_threaded;
+	const socklen_t optlen	= sizeof(single_threaded);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_single_threaded failed");
+	fail_unless (1 == get_int_opt (sock, optname), "single_threaded not read back");
+}
+END_TEST
+
+START_TEST (test_set_single_threaded_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_SINGLE_THREADED;
+	const int single_threaded = 1;
+	const void* optval	= &single_threaded;
+	const socklen_t optlen	= sizeof(single_threaded);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_single_threaded failed");
+}
+END_TEST
+
+/* bound socket */
+START_TEST (test_set_single_threaded_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_SINGLE_THREADED;
+	const int single_threaded = 1;
+	const void* optval	= &single_threaded;
+	const socklen_t optlen	= sizeof(single_threaded);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_single_threaded failed");
+	fail_unless (0 == get_int_opt (sock, optname), "single_threaded changed after bind");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_TIMER_FD,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+#ifdef HAVE_SYS_TIMERFD_H
+START_TEST (test_set_timer_fd_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_TIMER_FD;
+	const int timer_fd	= 1;
+	const void* optval	= &timer_fd;
+	const socklen_t optlen	= sizeof(timer_fd);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_timer_fd failed");
+	fail_unless (1 == get_int_opt (sock, optname), "timer_fd not read back");
+}
+END_TEST
+#endif
+
+START_TEST (test_set_timer_fd_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_TIMER_FD;
+	const int timer_fd	= 1;
+	const void* optval	= &timer_fd;
+	const socklen_t optlen	= sizeof(timer_fd);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_timer_fd failed");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_FEC_WORKER,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_fec_worker_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_FEC_WORKER;
+	const int fec_worker	= 1;
+	const void* optval	= &fec_worker;
+	const socklen_t optlen	= sizeof(fec_worker);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_fec_worker failed");
+	fail_unless (1 == get_int_opt (sock, optname), "fec_worker not read back");
+}
+END_TEST
+
+START_TEST (test_set_fec_worker_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_FEC_WORKER;
+	const int fec_worker	= 1;
+	const void* optval	= &fec_worker;
+	const socklen_t optlen	= sizeof(fec_worker);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_fec_worker failed");
+}
+END_TEST
+
+/* after bind */
+START_TEST (test_set_fec_worker_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_FEC_WORKER;
+	const int fec_worker	= 1;
+	const void* optval	= &fec_worker;
+	const socklen_t optlen	= sizeof(fec_worker);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_fec_worker failed");
+	fail_unless (0 == get_int_opt (sock, optname), "fec_worker changed after bind");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_USE_SLIDING_FEC,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(struct pgm_sw_fecinfo_t)
+ *	)
+ */
+
+START_TEST (test_set_sliding_fec_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_USE_SLIDING_FEC;
+	const struct pgm_sw_fecinfo_t sw_fecinfo = {
+		.window_size		= 16,
+		.repair_interval	= 4
+	};
+	const void* optval	= &sw_fecinfo;
+	const socklen_t optlen	= sizeof(sw_fecinfo);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_sliding_fec failed");
+	struct pgm_sw_fecinfo_t sw_get;
+	socklen_t sw_len = sizeof(sw_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &sw_get, &sw_len), "get_sliding_fec failed");
+	fail_unless (16 == sw_get.window_size && 4 == sw_get.repair_interval, "sliding_fec not read back");
+}
+END_TEST
+
+START_TEST (test_set_sliding_fec_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_USE_SLIDING_FEC;
+	const struct pgm_sw_fecinfo_t sw_fecinfo = {
+		.window_size		= 16,
+		.repair_interval	= 4
+	};
+	const void* optval	= &sw_fecinfo;
+	const socklen_t optlen	= sizeof(sw_fecinfo);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_sliding_fec failed");
+}
+END_TEST
+
+/* repair interval wider than coding window */
+START_TEST (test_set_sliding_fec_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_USE_SLIDING_FEC;
+	const struct pgm_sw_fecinfo_t sw_fecinfo = {
+		.window_size		= 4,
+		.repair_interval	= 16
+	};
+	const void* optval	= &sw_fecinfo;
+	const socklen_t optlen	= sizeof(sw_fecinfo);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_sliding_fec failed");
+	struct pgm_sw_fecinfo_t sw_get;
+	socklen_t sw_len = sizeof(sw_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &sw_get, &sw_len), "get_sliding_fec failed");
+	fail_unless (0 == sw_get.window_size, "rejected sliding_fec applied");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_PACING,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_pacing_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_PACING;
+	const int pacing	= 1;
+	const void* optval	= &pacing;
+	const socklen_t optlen	= sizeof(pacing);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_pacing failed");
+	fail_unless (1 == get_int_opt (sock, optname), "pacing not read back");
+}
+END_TEST
+
+START_TEST (test_set_pacing_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_PACING;
+	const int pacing	= 1;
+	const void* optval	= &pacing;
+	const socklen_t optlen	= sizeof(pacing);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_pacing failed");
+}
+END_TEST
+
+/* after bind */
+START_TEST (test_set_pacing_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_PACING;
+	const int pacing	= 1;
+	const void* optval	= &pacing;
+	const socklen_t optlen	= sizeof(pacing);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_pacing failed");
+	fail_unless (0 == get_int_opt (sock, optname), "pacing changed after bind");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_TIMER_THREAD,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_timer_thread_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_TIMER_THREAD;
+	const int timer_thread	= 1;
+	const void* optval	= &timer_thread;
+	const socklen_t optlen	= sizeof(timer_thread);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_timer_thread failed");
+	fail_unless (1 == get_int_opt (sock, optname), "timer_thread not read back");
+}
+END_TEST
+
+START_TEST (test_set_timer_thread_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_TIMER_THREAD;
+	const int timer_thread	= 1;
+	const void* optval	= &timer_thread;
+	const socklen_t optlen	= sizeof(timer_thread);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_timer_thread failed");
+}
+END_TEST
+
+/* after bind */
+START_TEST (test_set_timer_thread_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_TIMER_THREAD;
+	const int timer_thread	= 1;
+	const void* optval	= &timer_thread;
+	const socklen_t optlen	= sizeof(timer_thread);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_timer_thread failed");
+	fail_unless (0 == get_int_opt (sock, optname), "timer_thread changed after bind");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_TIMESTAMPING,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_timestamping_pass_001)
+{
+	pgm_sock_t* sock = generate_udp_sock ();
+	fail_if (NULL == sock, "generate_udp_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_TIMESTAMPING;
+	const int timestamping	= 2;
+	const void* optval	= &timestamping;
+	const socklen_t optlen	= sizeof(timestamping);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_timestamping failed");
+#if defined(HAVE_LINUX_NET_TSTAMP_H) && defined(SO_TIMESTAMPING)
+	fail_unless (timestamping == get_int_opt (sock, optname), "timestamping not read back");
+#else
+	fail_unless (0 == get_int_opt (sock, optname), "timestamping enabled without kernel support");
+#endif
+}
+END_TEST
+
+START_TEST (test_set_timestamping_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_TIMESTAMPING;
+	const int timestamping	= 1;
+	const void* optval	= &timestamping;
+	const socklen_t optlen	= sizeof(timestamping);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_timestamping failed");
+}
+END_TEST
+
+/* after bind */
+START_TEST (test_set_timestamping_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_TIMESTAMPING;
+	const int timestamping	= 1;
+	const void* optval	= &timestamping;
+	const socklen_t optlen	= sizeof(timestamping);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_timestamping failed");
+	fail_unless (0 == get_int_opt (sock, optname), "timestamping changed after bind");
+}
+END_TEST
+
+/* unknown mode */
+START_TEST (test_set_timestamping_fail_003)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_TIMESTAMPING;
+	const int timestamping	= 3;
+	const void* optval	= &timestamping;
+	const socklen_t optlen	= sizeof(timestamping);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_timestamping failed");
+	fail_unless (0 == get_int_opt (sock, optname), "rejected timestamping applied");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_POW2_WINDOWS,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_pow2_windows_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_POW2_WINDOWS;
+	const int use_pow2	= 1;
+	const void* optval	= &use_pow2;
+	const socklen_t optlen	= sizeof(use_pow2);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_pow2_windows failed");
+	fail_unless (1 == get_int_opt (sock, optname), "pow2 windows not read back");
+}
+END_TEST
+
+/* after bind */
+START_TEST (test_set_pow2_windows_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	const int before	= get_int_opt (sock, PGM_POW2_WINDOWS);
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_POW2_WINDOWS;
+	const int use_pow2	= 1;
+	const void* optval	= &use_pow2;
+	const socklen_t optlen	= sizeof(use_pow2);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_pow2_windows failed");
+	fail_unless (before == get_int_opt (sock, optname), "pow2 windows changed after bind");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_MEM_POLICY,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(struct pgm_mem_req_t)
+ *	)
+ */
+
+START_TEST (test_set_mem_policy_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_MEM_POLICY;
+	const struct pgm_mem_req_t mr = { .mr_pages = PGM_MEM_PAGES_2MB, .mr_node = PGM_MEM_NODE_INTERFACE };
+	const void* optval	= &mr;
+	const socklen_t optlen	= sizeof(mr);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_mem_policy failed");
+	struct pgm_mem_req_t mr_get;
+	socklen_t mr_len = sizeof(mr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &mr_get, &mr_len), "get_mem_policy failed");
+	fail_unless (PGM_MEM_PAGES_2MB == mr_get.mr_pages, "pages not read back");
+	fail_unless (PGM_MEM_NODE_INTERFACE == mr_get.mr_node, "node not read back");
+}
+END_TEST
+
+/* after bind */
+START_TEST (test_set_mem_policy_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_MEM_POLICY;
+	const struct pgm_mem_req_t mr = { .mr_pages = PGM_MEM_PAGES_2MB, .mr_node = PGM_MEM_NODE_ANY };
+	const void* optval	= &mr;
+	const socklen_t optlen	= sizeof(mr);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_mem_policy failed");
+	struct pgm_mem_req_t mr_get;
+	socklen_t mr_len = sizeof(mr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &mr_get, &mr_len), "get_mem_policy failed");
+	fail_unless (PGM_MEM_PAGES_DEFAULT == mr_get.mr_pages, "rejected pages applied");
+}
+END_TEST
+
+/* invalid page size or node */
+START_TEST (test_set_mem_policy_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_MEM_POLICY;
+	struct pgm_mem_req_t mr = { .mr_pages = PGM_MEM_PAGES_1GB + 1, .mr_node = PGM_MEM_NODE_ANY };
+	const void* optval	= &mr;
+	const socklen_t optlen	= sizeof(mr);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_mem_policy failed");
+	mr.mr_pages = PGM_MEM_PAGES_DEFAULT;
+	mr.mr_node = PGM_MEM_NODE_LOCAL - 1;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_mem_policy failed");
+	struct pgm_mem_req_t mr_get;
+	socklen_t mr_len = sizeof(mr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &mr_get, &mr_len), "get_mem_policy failed");
+	fail_unless (PGM_MEM_PAGES_DEFAULT == mr_get.mr_pages, "rejected pages applied");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_TXW_RING,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_txw_ring_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_TXW_RING;
+	const int ring_len	= 64 * 1024 * 1024;
+	const void* optval	= &ring_len;
+	const socklen_t optlen	= sizeof(ring_len);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_txw_ring failed");
+	fail_unless (ring_len == get_int_opt (sock, optname), "ring length not read back");
+}
+END_TEST
+
+/* after bind */
+START_TEST (test_set_txw_ring_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_TXW_RING;
+	const int ring_len	= 64 * 1024 * 1024;
+	const void* optval	= &ring_len;
+	const socklen_t optlen	= sizeof(ring_len);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_txw_ring failed");
+	fail_unless (0 == get_int_opt (sock, optname), "ring length changed after bind");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_RX_SIZE_CLASSES,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_rx_size_classes_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RX_SIZE_CLASSES;
+	const int use_classes	= 1;
+	const void* optval	= &use_classes;
+	const socklen_t optlen	= sizeof(use_classes);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_rx_size_classes failed");
+	fail_unless (1 == get_int_opt (sock, optname), "size classes not read back");
+}
+END_TEST
+
+/* after bind */
+START_TEST (test_set_rx_size_classes_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RX_SIZE_CLASSES;
+	const int use_classes	= 1;
+	const void* optval	= &use_classes;
+	const socklen_t optlen	= sizeof(use_classes);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_rx_size_classes failed");
+	fail_unless (0 == get_int_opt (sock, optname), "size classes changed after bind");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_SEND_BATCH,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(struct pgm_batch_req_t)
+ *	)
+ */
+
+START_TEST (test_set_send_batch_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_SEND_BATCH;
+	const struct pgm_batch_req_t br = { 1400, 100 };
+	const void* optval	= &br;
+	const socklen_t optlen	= sizeof(br);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_send_batch failed");
+	struct pgm_batch_req_t br_get;
+	socklen_t br_len = sizeof(br_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &br_get, &br_len), "get_send_batch failed");
+	fail_unless (1400 == br_get.br_size && 100 == br_get.br_ivl, "batch not read back");
+}
+END_TEST
+
+START_TEST (test_set_send_batch_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_SEND_BATCH;
+	const struct pgm_batch_req_t br = { 1400, 100 };
+	const void* optval	= &br;
+	const socklen_t optlen	= sizeof(br);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_send_batch failed");
+	struct pgm_batch_req_t br_get;
+	socklen_t br_len = sizeof(br_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &br_get, &br_len), "get_send_batch failed");
+	fail_unless (0 == br_get.br_size, "batch changed after bind");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_SEND_QUEUE,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_send_queue_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_SEND_QUEUE;
+	const int depth		= 64;
+	const void* optval	= &depth;
+	const socklen_t optlen	= sizeof(depth);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_send_queue failed");
+	fail_unless (depth == get_int_opt (sock, optname), "send queue not read back");
+}
+END_TEST
+
+START_TEST (test_set_send_queue_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_SEND_QUEUE;
+	const int depth		= -1;
+	const void* optval	= &depth;
+	const socklen_t optlen	= sizeof(depth);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_send_queue failed");
+	fail_unless (0 == get_int_opt (sock, optname), "rejected send queue applied");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_MULTI_PRODUCER,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_multi_producer_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_MULTI_PRODUCER;
+	const int slots		= 256;
+	const void* optval	= &slots;
+	const socklen_t optlen	= sizeof(slots);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_multi_producer failed");
+	fail_unless (256 == sock->mp_len, "ring length not set");
+	/* the ring is allocated by pgm_bind() */
+	fail_unless (0 == get_int_opt (sock, optname), "ring reported before bind");
+}
+END_TEST
+
+/* not a power of two */
+START_TEST (test_set_multi_producer_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_MULTI_PRODUCER;
+	const int slots		= 100;
+	const void* optval	= &slots;
+	const socklen_t optlen	= sizeof(slots);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_multi_producer failed");
+	fail_unless (0 == sock->mp_len, "rejected ring length applied");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_AUTO_BUFFERS,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_auto_buffers_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_AUTO_BUFFERS;
+	const int msecs		= 50;
+	const void* optval	= &msecs;
+	const socklen_t optlen	= sizeof(msecs);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_auto_buffers failed");
+	fail_unless (msecs == get_int_opt (sock, optname), "period not read back");
+}
+END_TEST
+
+START_TEST (test_set_auto_buffers_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_AUTO_BUFFERS;
+	const int msecs		= -1;
+	const void* optval	= &msecs;
+	const socklen_t optlen	= sizeof(msecs);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_auto_buffers failed");
+	fail_unless (0 == get_int_opt (sock, optname), "rejected period applied");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_RECV_FILTER,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(struct pgm_filter_req_t)
+ *	)
+ */
+
+START_TEST (test_set_recv_filter_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RECV_FILTER;
+	struct pgm_filter_req_t fr;
+	memset (&fr, 0, sizeof(fr));
+	fr.fr_types		= PGM_FILTER_TYPE(PGM_ODATA) | PGM_FILTER_TYPE(PGM_RDATA);
+	fr.fr_gsi_len		= 1;
+	const void* optval	= &fr;
+	const socklen_t optlen	= sizeof(fr);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_recv_filter failed");
+	struct pgm_filter_req_t fr_get;
+	socklen_t fr_len = sizeof(fr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &fr_get, &fr_len), "get_recv_filter failed");
+	fail_unless (fr.fr_types == fr_get.fr_types, "types not read back");
+	fail_unless (1 == fr_get.fr_gsi_len, "gsi list not read back");
+}
+END_TEST
+
+START_TEST (test_set_recv_filter_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RECV_FILTER;
+	struct pgm_filter_req_t fr;
+	memset (&fr, 0, sizeof(fr));
+	fr.fr_types		= PGM_FILTER_TYPE(0x03);
+	const void* optval	= &fr;
+	const socklen_t optlen	= sizeof(fr);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_recv_filter failed");
+	fr.fr_types		= 0;
+	fr.fr_gsi_len		= PGM_FILTER_MAX_GSI + 1;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_recv_filter failed");
+	/* no filter installed */
+	struct pgm_filter_req_t fr_get;
+	socklen_t fr_len = sizeof(fr_get);
+	fail_unless (FALSE == pgm_getsockopt (sock, level, optname, &fr_get, &fr_len), "rejected filter installed");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_SOURCE_FILTER,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(struct pgm_source_filter_req_t)
+ *	)
+ */
+
+START_TEST (test_set_source_filter_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_SOURCE_FILTER;
+	struct pgm_source_filter_req_t sf;
+	memset (&sf, 0, sizeof(sf));
+	sf.sf_mode		= PGM_SOURCE_ALLOW;
+	sf.sf_len		= 2;
+	sf.sf_tsi[0].gsi.identifier[0] = 2;
+	sf.sf_tsi[1].gsi.identifier[0] = 1;
+	const void* optval	= &sf;
+	const socklen_t optlen	= sizeof(sf);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_source_filter failed");
+	struct pgm_source_filter_req_t sf_get;
+	socklen_t sf_get_len = sizeof(sf_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &sf_get, &sf_get_len), "get_source_filter failed");
+	fail_unless (2 == sf_get.sf_len, "list not read back");
+	fail_unless (1 == sf_get.sf_tsi[0].gsi.identifier[0], "list not sorted");
+}
+END_TEST
+
+START_TEST (test_set_source_filter_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_SOURCE_FILTER;
+	struct pgm_source_filter_req_t sf;
+	memset (&sf, 0, sizeof(sf));
+	sf.sf_mode		= PGM_SOURCE_DENY + 1;
+	const void* optval	= &sf;
+	const socklen_t optlen	= sizeof(sf);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_source_filter failed");
+	sf.sf_mode		= PGM_SOURCE_DENY;
+	sf.sf_len		= PGM_SOURCE_FILTER_MAX + 1;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_source_filter failed");
+	struct pgm_source_filter_req_t sf_get;
+	socklen_t sf_get_len = sizeof(sf_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &sf_get, &sf_get_len), "get_source_filter failed");
+	fail_unless (0 == sf_get.sf_len, "rejected list applied");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_TX_CHECKSUM,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_tx_checksum_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_TX_CHECKSUM;
+	const int tx_checksum	= PGM_CHECKSUM_UDP_TRUSTED;
+	const void* optval	= &tx_checksum;
+	const socklen_t optlen	= sizeof(tx_checksum);
+	sock->udp_encap_ucast_port = TEST_PORT;
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_tx_checksum failed");
+	fail_unless (PGM_CHECKSUM_UDP_TRUSTED == get_int_opt (sock, optname), "policy not read back");
+}
+END_TEST
+
+/* zero checksums rely on UDP encapsulation */
+START_TEST (test_set_tx_checksum_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_TX_CHECKSUM;
+	int tx_checksum		= PGM_CHECKSUM_UDP_TRUSTED;
+	const void* optval	= &tx_checksum;
+	const socklen_t optlen	= sizeof(tx_checksum);
+	const int before	= get_int_opt (sock, optname);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_tx_checksum failed");
+	sock->udp_encap_ucast_port = TEST_PORT;
+	tx_checksum		= PGM_CHECKSUM_LAZY;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_tx_checksum failed");
+	fail_unless (before == get_int_opt (sock, optname), "rejected policy applied");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_CONGESTION_CONTROL,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_congestion_control_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_CONGESTION_CONTROL;
+	const int algorithm	= PGM_CC_BBR;
+	const void* optval	= &algorithm;
+	const socklen_t optlen	= sizeof(algorithm);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_congestion_control failed");
+	fail_unless (PGM_CC_BBR == get_int_opt (sock, optname), "algorithm not read back");
+}
+END_TEST
+
+START_TEST (test_set_congestion_control_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_CONGESTION_CONTROL;
+	const int algorithm	= PGM_CC_BBR + 1;
+	const void* optval	= &algorithm;
+	const socklen_t optlen	= sizeof(algorithm);
+	const int before	= get_int_opt (sock, optname);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_congestion_control failed");
+	fail_unless (before == get_int_opt (sock, optname), "rejected algorithm applied");
+}
+END_TEST
+
+START_TEST (test_set_nak_adaptive_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_NAK_ADAPTIVE;
+	const int adaptive	= 1;
+	const void* optval	= &adaptive;
+	const socklen_t optlen	= sizeof(adaptive);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_nak_adaptive failed");
+	fail_unless (1 == get_int_opt (sock, optname), "adaptive not read back");
+}
+END_TEST
+
+START_TEST (test_set_nak_adaptive_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_NAK_ADAPTIVE;
+	const int adaptive	= 1;
+	const void* optval	= &adaptive;
+	const socklen_t optlen	= sizeof(adaptive);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_nak_adaptive failed");
+}
+END_TEST
+
+START_TEST (test_set_nak_aggregate_ivl_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_NAK_AGGREGATE_IVL;
+	const int ivl		= 2000;
+	const void* optval	= &ivl;
+	const socklen_t optlen	= sizeof(ivl);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_nak_aggregate_ivl failed");
+	fail_unless (ivl == get_int_opt (sock, optname), "interval not read back");
+}
+END_TEST
+
+START_TEST (test_set_nak_aggregate_ivl_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_NAK_AGGREGATE_IVL;
+	const int ivl		= -1;
+	const void* optval	= &ivl;
+	const socklen_t optlen	= sizeof(ivl);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_nak_aggregate_ivl failed");
+	fail_unless (0 == get_int_opt (sock, optname), "rejected interval applied");
+}
+END_TEST
+
+START_TEST (test_set_fec_adaptive_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_FEC_ADAPTIVE;
+	const int adaptive	= 1;
+	const void* optval	= &adaptive;
+	const socklen_t optlen	= sizeof(adaptive);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_fec_adaptive failed");
+	fail_unless (1 == get_int_opt (sock, optname), "adaptive not read back");
+}
+END_TEST
+
+/* fixed once bound */
+START_TEST (test_set_fec_adaptive_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_FEC_ADAPTIVE;
+	const int adaptive	= 1;
+	const void* optval	= &adaptive;
+	const socklen_t optlen	= sizeof(adaptive);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_fec_adaptive failed");
+	fail_unless (0 == get_int_opt (sock, optname), "adaptive changed after bind");
+}
+END_TEST
+
+START_TEST (test_set_fec_decode_threads_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_FEC_DECODE_THREADS;
+	const int threads	= 2;
+	const void* optval	= &threads;
+	const socklen_t optlen	= sizeof(threads);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_fec_decode_threads failed");
+	fail_unless (threads == get_int_opt (sock, optname), "threads not read back");
+}
+END_TEST
+
+/* above maximum */
+START_TEST (test_set_fec_decode_threads_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_FEC_DECODE_THREADS;
+	const int threads	= PGM_MAX_FEC_DECODE_THREADS + 1;
+	const void* optval	= &threads;
+	const socklen_t optlen	= sizeof(threads);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_fec_decode_threads failed");
+	fail_unless (0 == get_int_opt (sock, optname), "rejected threads applied");
+}
+END_TEST
+
+/* fixed once bound */
+START_TEST (test_set_fec_decode_threads_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_FEC_DECODE_THREADS;
+	const int threads	= 1;
+	const void* optval	= &threads;
+	const socklen_t optlen	= sizeof(threads);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_fec_decode_threads failed");
+	fail_unless (0 == get_int_opt (sock, optname), "threads changed after bind");
+}
+END_TEST
+
+START_TEST (test_set_txw_store_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_TXW_STORE;
+	struct pgm_txw_store_req_t ts;
+	memset (&ts, 0, sizeof(ts));
+	strcpy (ts.ts_path, "/tmp/pgm.txw");
+	ts.ts_sqns		= 1024;
+	const void* optval	= &ts;
+	const socklen_t optlen	= sizeof(ts);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_txw_store failed");
+	struct pgm_txw_store_req_t ts_get;
+	socklen_t ts_len		= sizeof(ts_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &ts_get, &ts_len), "get_txw_store failed");
+	fail_unless (1024 == ts_get.ts_sqns, "sqns not read back");
+	fail_unless ('\0' == ts_get.ts_path[0], "path reported before store opened");
+}
+END_TEST
+
+/* fixed once bound */
+START_TEST (test_set_txw_store_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_TXW_STORE;
+	struct pgm_txw_store_req_t ts;
+	memset (&ts, 0, sizeof(ts));
+	strcpy (ts.ts_path, "/tmp/pgm.txw");
+	const void* optval	= &ts;
+	const socklen_t optlen	= sizeof(ts);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_txw_store failed");
+	struct pgm_txw_store_req_t ts_get;
+	socklen_t ts_len		= sizeof(ts_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &ts_get, &ts_len), "get_txw_store failed");
+	fail_unless (0 == ts_get.ts_sqns, "store changed after bind");
+}
+END_TEST
+
+/* unterminated path */
+START_TEST (test_set_txw_store_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_TXW_STORE;
+	struct pgm_txw_store_req_t ts;
+	memset (&ts, 'a', sizeof(ts.ts_path));
+	ts.ts_sqns		= 0;
+	const void* optval	= &ts;
+	const socklen_t optlen	= sizeof(ts);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_txw_store failed");
+	struct pgm_txw_store_req_t ts_get;
+	socklen_t ts_len		= sizeof(ts_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &ts_get, &ts_len), "get_txw_store failed");
+	fail_unless (0 == ts_get.ts_sqns, "rejected store applied");
+}
+END_TEST
+
+START_TEST (test_set_shm_recv_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_SHM_RECV;
+	struct pgm_shm_req_t sr;
+	memset (&sr, 0, sizeof(sr));
+	strcpy (sr.sr_path, "/dev/shm/pgm.txw");
+	const void* optval	= &sr;
+	const socklen_t optlen	= sizeof(sr);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_shm_recv failed");
+	struct pgm_shm_req_t sr_get;
+	socklen_t sr_len		= sizeof(sr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &sr_get, &sr_len), "get_shm_recv failed");
+	fail_unless (PGM_SHM_DEFAULT_IVL == sr_get.sr_ivl, "default interval not read back");
+	fail_unless (0 == sr_get.sr_path[0], "path reported before segment opened");
+}
+END_TEST
+
+/* fixed once bound */
+START_TEST (test_set_shm_recv_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_SHM_RECV;
+	struct pgm_shm_req_t sr;
+	memset (&sr, 0, sizeof(sr));
+	strcpy (sr.sr_path, "/dev/shm/pgm.txw");
+	const void* optval	= &sr;
+	const socklen_t optlen	= sizeof(sr);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_shm_recv failed");
+	struct pgm_shm_req_t sr_get;
+	socklen_t sr_len		= sizeof(sr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &sr_get, &sr_len), "get_shm_recv failed");
+	fail_unless (0 == sr_get.sr_ivl, "segment changed after bind");
+}
+END_TEST
+
+/* unterminated path */
+START_TEST (test_set_shm_recv_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_SHM_RECV;
+	struct pgm_shm_req_t sr;
+	memset (&sr, 'a', sizeof(sr.sr_path));
+	sr.sr_ivl		= 0;
+	const void* optval	= &sr;
+	const socklen_t optlen	= sizeof(sr);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_shm_recv failed");
+	struct pgm_shm_req_t sr_get;
+	socklen_t sr_len		= sizeof(sr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &sr_get, &sr_len), "get_shm_recv failed");
+	fail_unless (0 == sr_get.sr_ivl, "rejected segment applied");
+}
+END_TEST
+
+START_TEST (test_set_catchup_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_CATCHUP;
+	const struct pgm_catchup_req_t cu = { .cu_sqns = 10000, .cu_ivl = 0 };
+	const void* optval	= &cu;
+	const socklen_t optlen	= sizeof(cu);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_catchup failed");
+	struct pgm_catchup_req_t cu_get;
+	socklen_t cu_len		= sizeof(cu_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &cu_get, &cu_len), "get_catchup failed");
+	fail_unless (10000 == cu_get.cu_sqns, "sequences not read back");
+	fail_unless (PGM_CATCHUP_DEFAULT_IVL == cu_get.cu_ivl, "default interval not read back");
+}
+END_TEST
+
+/* fixed once bound */
+START_TEST (test_set_catchup_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_CATCHUP;
+	const struct pgm_catchup_req_t cu = { .cu_sqns = 10000, .cu_ivl = 0 };
+	const void* optval	= &cu;
+	const socklen_t optlen	= sizeof(cu);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_catchup failed");
+	struct pgm_catchup_req_t cu_get;
+	socklen_t cu_len		= sizeof(cu_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &cu_get, &cu_len), "get_catchup failed");
+	fail_unless (0 == cu_get.cu_sqns, "catch-up changed after bind");
+}
+END_TEST
+
+START_TEST (test_set_catchup_rate_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_CATCHUP_RATE;
+	const int rate		= 100*1000*1000;
+	const void* optval	= &rate;
+	const socklen_t optlen	= sizeof(rate);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_catchup_rate failed");
+	fail_unless (rate == get_int_opt (sock, optname), "rate not read back");
+}
+END_TEST
+
+START_TEST (test_set_catchup_rate_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_CATCHUP_RATE;
+	const int rate		= -1;
+	const void* optval	= &rate;
+	const socklen_t optlen	= sizeof(rate);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_catchup_rate failed");
+	fail_unless (0 == get_int_opt (sock, optname), "rejected rate applied");
+}
+END_TEST
+
+START_TEST (test_set_dlr_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_DLR;
+	const struct pgm_dlr_req_t dr = { .dr_sqns = 4096, .dr_ivl = 0, .dr_max_rte = 1000*1000 };
+	const void* optval	= &dr;
+	const socklen_t optlen	= sizeof(dr);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_dlr failed");
+	struct pgm_dlr_req_t dr_get;
+	socklen_t dr_len		= sizeof(dr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &dr_get, &dr_len), "get_dlr failed");
+	fail_unless (4096 == dr_get.dr_sqns, "sequences not read back");
+	fail_unless (PGM_DLR_DEFAULT_IVL == dr_get.dr_ivl, "default interval not read back");
+	fail_unless (1000*1000 == dr_get.dr_max_rte, "rate not read back");
+}
+END_TEST
+
+/* fixed once bound */
+START_TEST (test_set_dlr_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_DLR;
+	const struct pgm_dlr_req_t dr = { .dr_sqns = 4096, .dr_ivl = 0, .dr_max_rte = 0 };
+	const void* optval	= &dr;
+	const socklen_t optlen	= sizeof(dr);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_dlr failed");
+	struct pgm_dlr_req_t dr_get;
+	socklen_t dr_len		= sizeof(dr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &dr_get, &dr_len), "get_dlr failed");
+	fail_unless (0 == dr_get.dr_sqns, "repairer changed after bind");
+}
+END_TEST
+
+START_TEST (test_set_join_dport_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_JOIN_DPORT;
+	const int ports[]	= { 7502, 7501, 7502 };
+	for (unsigned i = 0; i < G_N_ELEMENTS(ports); i++)
+		fail_unless (TRUE == pgm_setsockopt (sock, level, optname, &ports[i], sizeof(ports[i])), "set_join_dport failed");
+	fail_unless (2 == sock->rx_dports_len, "duplicate port added");
+	fail_unless (sock->rx_dports[0] < sock->rx_dports[1], "ports not sorted");
+}
+END_TEST
+
+START_TEST (test_set_join_dport_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_JOIN_DPORT;
+	const int port		= 0;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &port, sizeof(port)), "set_join_dport failed");
+	fail_unless (0 == sock->rx_dports_len, "rejected port added");
+}
+END_TEST
+
+/* membership remains open on a connected socket, other options do not */
+START_TEST (test_set_join_dport_pass_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int port		= 7501;
+	const int max_tpdu	= 1500;
+	sock->is_connected = TRUE;
+	fail_unless (TRUE == pgm_setsockopt (sock, level, PGM_JOIN_DPORT, &port, sizeof(port)), "set_join_dport failed");
+	fail_unless (1 == sock->rx_dports_len, "port not added");
+	fail_unless (TRUE == pgm_setsockopt (sock, level, PGM_LEAVE_DPORT, &port, sizeof(port)), "set_leave_dport failed");
+	fail_unless (FALSE == pgm_setsockopt (sock, level, PGM_MTU, &max_tpdu, sizeof(max_tpdu)), "set_mtu succeeded");
+}
+END_TEST
+
+START_TEST (test_set_leave_dport_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int port		= 7501;
+	fail_unless (TRUE == pgm_setsockopt (sock, level, PGM_JOIN_DPORT, &port, sizeof(port)), "set_join_dport failed");
+	fail_unless (TRUE == pgm_setsockopt (sock, level, PGM_LEAVE_DPORT, &port, sizeof(port)), "set_leave_dport failed");
+	fail_unless (0 == sock->rx_dports_len, "port not removed");
+}
+END_TEST
+
+/* not joined */
+START_TEST (test_set_leave_dport_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_LEAVE_DPORT;
+	const int port		= 7501;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &port, sizeof(port)), "set_leave_dport failed");
+	fail_unless (0 == sock->rx_dports_len, "port list changed");
+}
+END_TEST
+
+START_TEST (test_set_peer_idle_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_PEER_IDLE;
+	const int ivl		= 0;
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, &ivl, sizeof(ivl)), "set_peer_idle failed");
+	fail_unless (ivl == get_int_opt (sock, optname), "interval not read back");
+}
+END_TEST
+
+START_TEST (test_set_peer_idle_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_PEER_IDLE;
+	const int ivl		= -1;
+	const int before	= get_int_opt (sock, optname);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &ivl, sizeof(ivl)), "set_peer_idle failed");
+	fail_unless (before == get_int_opt (sock, optname), "rejected interval applied");
+}
+END_TEST
+
+START_TEST (test_set_large_apdu_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_LARGE_APDU;
+	const int size		= 1024 * 1024;
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, &size, sizeof(size)), "set_large_apdu failed");
+	fail_unless (size == get_int_opt (sock, optname), "size not read back");
+}
+END_TEST
+
+START_TEST (test_set_large_apdu_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_LARGE_APDU;
+	const int size		= -1;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &size, sizeof(size)), "set_large_apdu failed");
+	fail_unless (0 == get_int_opt (sock, optname), "rejected size applied");
+}
+END_TEST
+
+START_TEST (test_set_merge_delivery_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_MERGE_DELIVERY;
+	const int use_merge	= 1;
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, &use_merge, sizeof(use_merge)), "set_merge_delivery failed");
+	fail_unless (1 == get_int_opt (sock, optname), "merge delivery not read back");
+}
+END_TEST
+
+START_TEST (test_set_merge_delivery_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_MERGE_DELIVERY;
+	const char use_merge	= 1;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &use_merge, sizeof(use_merge)), "set_merge_delivery failed");
+	fail_unless (0 == get_int_opt (sock, optname), "merge delivery enabled by short option");
+}
+END_TEST
+
+START_TEST (test_set_delivery_quantum_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_DELIVERY_QUANTUM;
+	const int quantum	= 64 * 1024;
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, &quantum, sizeof(quantum)), "set_delivery_quantum failed");
+	fail_unless (quantum == get_int_opt (sock, optname), "quantum not read back");
+}
+END_TEST
+
+START_TEST (test_set_delivery_quantum_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_DELIVERY_QUANTUM;
+	const int quantum	= -1;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &quantum, sizeof(quantum)), "set_delivery_quantum failed");
+	fail_unless (0 == get_int_opt (sock, optname), "rejected quantum applied");
+}
+END_TEST
+
+START_TEST (test_set_stream_group_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_STREAM_GROUP;
+	const struct pgm_stream_req_t sr = { .sr_sock = NULL, .sr_weight = 3 };
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, &sr, sizeof(sr)), "set_stream_group failed");
+	struct pgm_stream_req_t sr_get;
+	socklen_t sr_len		= sizeof(sr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &sr_get, &sr_len), "get_stream_group failed");
+	fail_unless (3 == sr_get.sr_weight, "weight not read back");
+}
+END_TEST
+
+/* set before bind */
+START_TEST (test_set_stream_group_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_STREAM_GROUP;
+	const struct pgm_stream_req_t sr = { .sr_sock = NULL, .sr_weight = 3 };
+	sock->is_bound = TRUE;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &sr, sizeof(sr)), "set_stream_group failed");
+	struct pgm_stream_req_t sr_get;
+	socklen_t sr_len		= sizeof(sr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &sr_get, &sr_len), "get_stream_group failed");
+	fail_unless (1 == sr_get.sr_weight, "weight changed after bind");
+}
+END_TEST
+
+START_TEST (test_set_priority_class_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_PRIORITY_CLASS;
+	const struct pgm_priority_req_t pr = { .pr_class = 1, .pr_max_rte = 100*1000, .pr_tos = 0xb8 };
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, &pr, sizeof(pr)), "set_priority_class failed");
+	struct pgm_priority_req_t pr_get = { .pr_class = 1 };
+	socklen_t pr_len		= sizeof(pr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &pr_get, &pr_len), "get_priority_class failed");
+	fail_unless (100*1000 == pr_get.pr_max_rte, "rate not read back");
+	fail_unless (0xb8 == pr_get.pr_tos, "traffic class not read back");
+}
+END_TEST
+
+/* class 0 is pgm_send(), set before bind */
+START_TEST (test_set_priority_class_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_PRIORITY_CLASS;
+	struct pgm_priority_req_t pr = { .pr_class = 0, .pr_max_rte = 100*1000, .pr_tos = -1 };
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &pr, sizeof(pr)), "set_priority_class failed");
+	pr.pr_class = PGM_PRIORITY_CLASSES;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &pr, sizeof(pr)), "set_priority_class failed");
+	pr.pr_class = 1;
+	sock->is_bound = TRUE;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &pr, sizeof(pr)), "set_priority_class failed");
+	struct pgm_priority_req_t pr_get = { .pr_class = 1 };
+	socklen_t pr_len		= sizeof(pr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &pr_get, &pr_len), "get_priority_class failed");
+	fail_unless (0 == pr_get.pr_max_rte, "rejected class applied");
+}
+END_TEST
+
+START_TEST (test_set_send_paths_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_SEND_PATHS;
+	struct pgm_send_path_req_t sp;
+	memset (&sp, 0, sizeof(sp));
+	sp.sp_mode		= PGM_PATH_DUPLICATE;
+	sp.sp_len		= 1;
+	sp.sp_if[0].ir_interface = 2;
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, &sp, sizeof(sp)), "set_send_paths failed");
+	struct pgm_send_path_req_t sp_get;
+	socklen_t sp_len		= sizeof(sp_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &sp_get, &sp_len), "get_send_paths failed");
+	fail_unless (1 == sp_get.sp_len, "paths not read back");
+	fail_unless (PGM_PATH_DUPLICATE == sp_get.sp_mode, "mode not read back");
+	fail_unless (2 == sp_get.sp_if[0].ir_interface, "interface not read back");
+}
+END_TEST
+
+/* mode required, family of the socket, set before bind */
+START_TEST (test_set_send_paths_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_SEND_PATHS;
+	struct pgm_send_path_req_t sp;
+	memset (&sp, 0, sizeof(sp));
+	sp.sp_len		= 1;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &sp, sizeof(sp)), "set_send_paths failed");
+	sp.sp_mode		= PGM_PATH_STRIPE;
+	sp.sp_len		= PGM_MAX_SEND_PATHS;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &sp, sizeof(sp)), "set_send_paths failed");
+	sp.sp_len		= 1;
+	sp.sp_if[0].ir_address.ss_family = AF_INET6;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &sp, sizeof(sp)), "set_send_paths failed");
+	sp.sp_if[0].ir_address.ss_family = AF_UNSPEC;
+	sock->is_bound = TRUE;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &sp, sizeof(sp)), "set_send_paths failed");
+	struct pgm_send_path_req_t sp_get;
+	socklen_t sp_len		= sizeof(sp_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &sp_get, &sp_len), "get_send_paths failed");
+	fail_unless (0 == sp_get.sp_len, "rejected paths applied");
+}
+END_TEST
+
+START_TEST (test_set_unicast_fanout_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_UNICAST_FANOUT;
+	struct pgm_fanout_req_t fr;
+	memset (&fr, 0, sizeof(fr));
+	fr.fr_len		= 2;
+	((struct sockaddr_in*)&fr.fr_addr[0])->sin_family = AF_INET;
+	((struct sockaddr_in*)&fr.fr_addr[0])->sin_addr.s_addr = inet_addr ("192.0.2.10");
+	((struct sockaddr_in*)&fr.fr_addr[1])->sin_family = AF_INET;
+	((struct sockaddr_in*)&fr.fr_addr[1])->sin_addr.s_addr = inet_addr ("192.0.2.11");
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, &fr, sizeof(fr)), "set_unicast_fanout failed");
+	struct pgm_fanout_req_t fr_get;
+	socklen_t fr_len		= sizeof(fr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &fr_get, &fr_len), "get_unicast_fanout failed");
+	fail_unless (2 == fr_get.fr_len, "receivers not read back");
+	fail_unless (inet_addr ("192.0.2.11") == ((struct sockaddr_in*)&fr_get.fr_addr[1])->sin_addr.s_addr, "receiver not read back");
+}
+END_TEST
+
+/* unicast addresses of the socket family, set before bind */
+START_TEST (test_set_unicast_fanout_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_UNICAST_FANOUT;
+	struct pgm_fanout_req_t fr;
+	memset (&fr, 0, sizeof(fr));
+	fr.fr_len		= PGM_MAX_FANOUT + 1;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &fr, sizeof(fr)), "set_unicast_fanout failed");
+	fr.fr_len		= 1;
+	fr.fr_addr[0].ss_family	= AF_INET6;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &fr, sizeof(fr)), "set_unicast_fanout failed");
+	((struct sockaddr_in*)&fr.fr_addr[0])->sin_family = AF_INET;
+	((struct sockaddr_in*)&fr.fr_addr[0])->sin_addr.s_addr = inet_addr ("239.192.0.1");
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &fr, sizeof(fr)), "set_unicast_fanout failed");
+	((struct sockaddr_in*)&fr.fr_addr[0])->sin_addr.s_addr = inet_addr ("192.0.2.10");
+	sock->is_bound = TRUE;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &fr, sizeof(fr)), "set_unicast_fanout failed");
+	struct pgm_fanout_req_t fr_get;
+	socklen_t fr_len		= sizeof(fr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &fr_get, &fr_len), "get_unicast_fanout failed");
+	fail_unless (0 == fr_get.fr_len, "rejected receivers applied");
+}
+END_TEST
+
+START_TEST (test_set_verbs_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_VERBS;
+	struct pgm_verbs_req_t vr;
+	memset (&vr, 0, sizeof(vr));
+	strcpy (vr.vr_device, "mlx5_0");
+	vr.vr_port		= 1;
+	vr.vr_gid_index		= 3;
+	vr.vr_depth		= 512;
+	sock->udp_encap_ucast_port = TEST_PORT;
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, &vr, sizeof(vr)), "set_verbs failed");
+	struct pgm_verbs_req_t vr_get;
+	socklen_t vr_len		= sizeof(vr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &vr_get, &vr_len), "get_verbs failed");
+	fail_unless (512 == vr_get.vr_depth, "depth not read back");
+	fail_unless (3 == vr_get.vr_gid_index, "gid index not read back");
+	fail_unless (0 == vr_get.vr_port, "port reported before bind");
+}
+END_TEST
+
+/* UDP encapsulation, depth a power of 2, terminated device name, set before bind */
+START_TEST (test_set_verbs_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_VERBS;
+	struct pgm_verbs_req_t vr;
+	memset (&vr, 0, sizeof(vr));
+	vr.vr_port		= 1;
+	sock->udp_encap_ucast_port = 0;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &vr, sizeof(vr)), "set_verbs failed");
+	sock->udp_encap_ucast_port = TEST_PORT;
+	vr.vr_depth		= 500;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &vr, sizeof(vr)), "set_verbs failed");
+	vr.vr_depth		= 0;
+	memset (vr.vr_device, 'x', sizeof(vr.vr_device));
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &vr, sizeof(vr)), "set_verbs failed");
+	vr.vr_device[0]		= '\0';
+	sock->is_bound = TRUE;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &vr, sizeof(vr)), "set_verbs failed");
+	struct pgm_verbs_req_t vr_get;
+	socklen_t vr_len		= sizeof(vr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &vr_get, &vr_len), "get_verbs failed");
+	fail_unless (0 == vr_get.vr_depth, "rejected depth applied");
+}
+END_TEST
+
+START_TEST (test_set_dpdk_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_DPDK;
+	struct pgm_dpdk_req_t dr;
+	memset (&dr, 0, sizeof(dr));
+	strcpy (dr.dr_device, "0000:3b:00.0");
+	dr.dr_queue		= 3;
+	dr.dr_depth		= 2048;
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, &dr, sizeof(dr)), "set_dpdk failed");
+	struct pgm_dpdk_req_t dr_get;
+	socklen_t dr_len		= sizeof(dr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &dr_get, &dr_len), "get_dpdk failed");
+	fail_unless (3 == dr_get.dr_queue, "queue not read back");
+	fail_unless (2048 == dr_get.dr_depth, "depth not read back");
+	fail_unless (0 == dr_get.dr_device[0], "device reported before bind");
+}
+END_TEST
+
+/* depth a power of 2, one queue for a configured port, terminated device name, set before bind */
+START_TEST (test_set_dpdk_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_DPDK;
+	struct pgm_dpdk_req_t dr;
+	memset (&dr, 0, sizeof(dr));
+	strcpy (dr.dr_device, "net_ice0");
+	dr.dr_depth		= 1000;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &dr, sizeof(dr)), "set_dpdk failed");
+	dr.dr_depth		= 0;
+	dr.dr_queue		= 1;
+	dr.dr_flags		= PGM_DPDK_CONFIGURE;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &dr, sizeof(dr)), "set_dpdk failed");
+	dr.dr_queue		= 0;
+	memset (dr.dr_device, 'x', sizeof(dr.dr_device));
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &dr, sizeof(dr)), "set_dpdk failed");
+	strcpy (dr.dr_device, "net_ice0");
+	sock->is_bound = TRUE;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &dr, sizeof(dr)), "set_dpdk failed");
+	struct pgm_dpdk_req_t dr_get;
+	socklen_t dr_len		= sizeof(dr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &dr_get, &dr_len), "get_dpdk failed");
+	fail_unless (0 == dr_get.dr_depth && 0 == dr_get.dr_queue && 0 == dr_get.dr_flags, "rejected request applied");
+}
+END_TEST
+
+START_TEST (test_set_compact_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_COMPACT;
+	const int tsdu		= 256;
+	sock->udp_encap_ucast_port = TEST_PORT;
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, &tsdu, sizeof(tsdu)), "set_compact failed");
+	fail_unless (tsdu == get_int_opt (sock, optname), "tsdu not read back");
+}
+END_TEST
+
+/* UDP encapsulation only, within the 16-bit TSDU length, set before bind */
+START_TEST (test_set_compact_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_COMPACT;
+	int tsdu		= 256;
+	sock->udp_encap_ucast_port = 0;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &tsdu, sizeof(tsdu)), "set_compact failed");
+	sock->udp_encap_ucast_port = TEST_PORT;
+	tsdu			= UINT16_MAX + 1;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &tsdu, sizeof(tsdu)), "set_compact failed");
+	tsdu			= -1;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &tsdu, sizeof(tsdu)), "set_compact failed");
+	tsdu			= 256;
+	sock->is_bound = TRUE;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &tsdu, sizeof(tsdu)), "set_compact failed");
+	fail_unless (0 == get_int_opt (sock, optname), "rejected tsdu applied");
+}
+END_TEST
+
+START_TEST (test_set_linger_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_LINGER;
+	const int linger	= pgm_secs (2);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, &linger, sizeof(linger)), "set_linger failed");
+	fail_unless (linger == get_int_opt (sock, optname), "linger not read back");
+}
+END_TEST
+
+START_TEST (test_set_linger_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_LINGER;
+	const int linger	= -1;
+	const int before	= get_int_opt (sock, optname);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &linger, sizeof(linger)), "set_linger failed");
+	fail_unless (before == get_int_opt (sock, optname), "rejected linger applied");
+}
+END_TEST
+
+START_TEST (test_set_handoff_ring_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_HANDOFF_RING;
+	const int slots		= 1024;
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, &slots, sizeof(slots)), "set_handoff_ring failed");
+	fail_unless (1024 == sock->handoff_len, "slots not set");
+	fail_unless (TRUE == sock->use_timer_thread, "timer thread not enabled");
+	fail_unless (0 == get_int_opt (sock, optname), "ring reported before bind");
+}
+END_TEST
+
+/* a power of two of at least 2, set before bind */
+START_TEST (test_set_handoff_ring_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_HANDOFF_RING;
+	int slots		= 1;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &slots, sizeof(slots)), "set_handoff_ring failed");
+	slots			= 1000;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &slots, sizeof(slots)), "set_handoff_ring failed");
+	slots			= 1024;
+	sock->is_bound = TRUE;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &slots, sizeof(slots)), "set_handoff_ring failed");
+	fail_unless (0 == sock->handoff_len, "rejected slots applied");
+	fail_unless (0 == get_int_opt (sock, optname), "ring reported");
+}
+END_TEST
+
+/* burst defaults to the rate */
+START_TEST (test_set_nak_limit_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_NAK_LIMIT;
+	const struct pgm_nak_limit_req_t nl = {
+		.nl_rate	= 1000,
+		.nl_demote	= 5000,
+		.nl_restore	= 10 * 1000 * 1000,
+		.nl_action	= PGM_NAK_LIMIT_UNICAST
+	};
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, &nl, sizeof(nl)), "set_nak_limit failed");
+	struct pgm_nak_limit_req_t nl_get;
+	socklen_t nl_len		= sizeof(nl_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &nl_get, &nl_len), "get_nak_limit failed");
+	fail_unless (1000 == nl_get.nl_burst, "burst not defaulted");
+	fail_unless (PGM_NAK_LIMIT_UNICAST == nl_get.nl_action, "action not read back");
+}
+END_TEST
+
+START_TEST (test_set_nak_limit_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_NAK_LIMIT;
+	struct pgm_nak_limit_req_t nl = {
+		.nl_rate	= 1000,
+		.nl_action	= 2
+	};
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &nl, sizeof(nl)), "set_nak_limit failed");
+	nl.nl_action		= PGM_NAK_LIMIT_IGNORE;
+	sock->is_bound = TRUE;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &nl, sizeof(nl)), "set_nak_limit failed");
+	struct pgm_nak_limit_req_t nl_get;
+	socklen_t nl_len		= sizeof(nl_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &nl_get, &nl_len), "get_nak_limit failed");
+	fail_unless (0 == nl_get.nl_rate, "rejected limit applied");
+}
+END_TEST
+
+START_TEST (test_set_warm_restart_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_WARM_RESTART;
+	struct pgm_warm_restart_req_t wr;
+	memset (&wr, 0, sizeof (wr));
+	strcpy (wr.wr_name, "/pgm-restart");
+	wr.wr_sources		= 8;
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, &wr, sizeof(wr)), "set_warm_restart failed");
+	struct pgm_warm_restart_req_t wr_get;
+	socklen_t wr_len		= sizeof(wr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &wr_get, &wr_len), "get_warm_restart failed");
+	fail_unless (8 == wr_get.wr_sources, "sources not read back");
+	fail_unless (0 == wr_get.wr_name[0], "name reported before segment opened");
+}
+END_TEST
+
+/* unterminated name, too many sources, set before bind */
+START_TEST (test_set_warm_restart_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_WARM_RESTART;
+	struct pgm_warm_restart_req_t wr;
+	memset (&wr, 'a', sizeof (wr.wr_name));
+	wr.wr_sources		= 0;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &wr, sizeof(wr)), "set_warm_restart failed");
+	strcpy (wr.wr_name, "/pgm-restart");
+	wr.wr_sources		= PGM_RESTART_MAX_SOURCES + 1;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &wr, sizeof(wr)), "set_warm_restart failed");
+	wr.wr_sources		= 0;
+	sock->is_bound = TRUE;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &wr, sizeof(wr)), "set_warm_restart failed");
+	struct pgm_warm_restart_req_t wr_get;
+	socklen_t wr_len		= sizeof(wr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &wr_get, &wr_len), "get_warm_restart failed");
+	fail_unless (0 == wr_get.wr_sources, "rejected sources applied");
+}
+END_TEST
+
+START_TEST (test_set_local_publish_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_LOCAL_PUBLISH;
+	struct pgm_local_req_t lr;
+	memset (&lr, 0, sizeof (lr));
+	strcpy (lr.lr_name, "/pgm-local");
+	lr.lr_slots		= 1024;
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, &lr, sizeof(lr)), "set_local_publish failed");
+	struct pgm_local_req_t lr_get;
+	socklen_t lr_len		= sizeof(lr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &lr_get, &lr_len), "get_local_publish failed");
+	fail_unless (1024 == lr_get.lr_slots, "slots not read back");
+	fail_unless (0 == lr_get.lr_name[0], "name reported before ring opened");
+}
+END_TEST
+
+/* unterminated name, too many slots, set before bind */
+START_TEST (test_set_local_publish_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_LOCAL_PUBLISH;
+	struct pgm_local_req_t lr;
+	memset (&lr, 'a', sizeof (lr.lr_name));
+	lr.lr_slots		= 0;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &lr, sizeof(lr)), "set_local_publish failed");
+	strcpy (lr.lr_name, "/pgm-local");
+	lr.lr_slots		= PGM_LOCAL_MAX_SLOTS + 1;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &lr, sizeof(lr)), "set_local_publish failed");
+	lr.lr_slots		= 0;
+	sock->is_bound = TRUE;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &lr, sizeof(lr)), "set_local_publish failed");
+	struct pgm_local_req_t lr_get;
+	socklen_t lr_len		= sizeof(lr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &lr_get, &lr_len), "get_local_publish failed");
+	fail_unless (0 == lr_get.lr_slots, "rejected slots applied");
+}
+END_TEST
+
+START_TEST (test_set_standby_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_STANDBY;
+	const struct pgm_standby_req_t sb = { .sb_ivl = 10000, .sb_timeout = 60 * 1000 * 1000 };
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, &sb, sizeof(sb)), "set_standby failed");
+	struct pgm_standby_req_t sb_get;
+	socklen_t sb_len		= sizeof(sb_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &sb_get, &sb_len), "get_standby failed");
+	fail_unless (10000 == sb_get.sb_ivl, "ivl not read back");
+	fail_unless (60 * 1000 * 1000 == sb_get.sb_timeout, "timeout not read back");
+}
+END_TEST
+
+/* invalid length, set before bind */
+START_TEST (test_set_standby_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_STANDBY;
+	const struct pgm_standby_req_t sb = { .sb_ivl = 10000, .sb_timeout = 0 };
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &sb, sizeof(sb) - 1), "set_standby failed");
+	sock->is_bound = TRUE;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &sb, sizeof(sb)), "set_standby failed");
+	struct pgm_standby_req_t sb_get;
+	socklen_t sb_len		= sizeof(sb_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &sb_get, &sb_len), "get_standby failed");
+	fail_unless (0 == sb_get.sb_ivl, "rejected standby applied");
+}
+END_TEST
+
+START_TEST (test_set_send_ports_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_SEND_PORTS;
+	const struct pgm_send_port_req_t pt = { .pt_mode = PGM_PORTS_PER_TG, .pt_base = 0, .pt_count = PGM_MAX_SEND_PORTS };
+	sock->protocol = IPPROTO_UDP;
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, &pt, sizeof(pt)), "set_send_ports failed");
+	struct pgm_send_port_req_t pt_get;
+	socklen_t pt_len		= sizeof(pt_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &pt_get, &pt_len), "get_send_ports failed");
+	fail_unless (PGM_PORTS_PER_TG == pt_get.pt_mode, "mode not read back");
+	fail_unless (PGM_MAX_SEND_PORTS == pt_get.pt_count, "count not read back");
+}
+END_TEST
+
+/* invalid length, raw PGM, mode, count, range, ephemeral per TSI, set before bind */
+START_TEST (test_set_send_ports_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_SEND_PORTS;
+	struct pgm_send_port_req_t pt = { .pt_mode = PGM_PORTS_PER_TSI, .pt_base = 7500, .pt_count = 4 };
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &pt, sizeof(pt)), "set_send_ports failed");
+	sock->protocol = IPPROTO_UDP;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &pt, sizeof(pt) - 1), "set_send_ports failed");
+	pt.pt_mode = PGM_PORTS_PER_TG + 1;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &pt, sizeof(pt)), "set_send_ports failed");
+	pt.pt_mode = PGM_PORTS_PER_TG;
+	pt.pt_count = PGM_MAX_SEND_PORTS + 1;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &pt, sizeof(pt)), "set_send_ports failed");
+	pt.pt_count = 4;
+	pt.pt_base = UINT16_MAX - 2;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &pt, sizeof(pt)), "set_send_ports failed");
+	pt.pt_mode = PGM_PORTS_PER_TSI;
+	pt.pt_base = 0;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &pt, sizeof(pt)), "set_send_ports failed");
+	pt.pt_base = 7500;
+	sock->is_bound = TRUE;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &pt, sizeof(pt)), "set_send_ports failed");
+	struct pgm_send_port_req_t pt_get;
+	socklen_t pt_len		= sizeof(pt_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &pt_get, &pt_len), "get_send_ports failed");
+	fail_unless (0 == pt_get.pt_count, "rejected ports applied");
+}
+END_TEST
+
+/* invalid length, family mismatch */
+START_TEST (test_set_join_source_groups_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_JOIN_SOURCE_GROUPS;
+	struct group_source_req gsr[2];
+	memset (gsr, 0, sizeof(gsr));
+	((struct sockaddr*)&gsr[0].gsr_group)->sa_family  = AF_INET;
+	((struct sockaddr*)&gsr[0].gsr_source)->sa_family = AF_INET;
+	((struct sockaddr*)&gsr[1].gsr_group)->sa_family  = AF_INET6;
+	((struct sockaddr*)&gsr[1].gsr_source)->sa_family = AF_INET6;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, gsr, 0), "set_join_source_groups failed");
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, gsr, sizeof(gsr) - 1), "set_join_source_groups failed");
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, gsr, sizeof(gsr)), "set_join_source_groups failed");
+	fail_unless (0 == sock->recv_gsr_len, "membership recorded");
+}
+END_TEST
+
+START_TEST (test_set_redundant_sources_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_REDUNDANT_SOURCES;
+	struct pgm_redundant_req_t rr;
+	memset (&rr, 0, sizeof(rr));
+	rr.rr_key_offset	= 8;
+	rr.rr_tsi_len		= 2;
+	rr.rr_tsi[1].sport	= 1;
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, &rr, sizeof(rr)), "set_redundant_sources failed");
+	struct pgm_redundant_req_t rr_get;
+	socklen_t rr_len		= sizeof(rr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &rr_get, &rr_len), "get_redundant_sources failed");
+	fail_unless (2 == rr_get.rr_tsi_len, "sources not read back");
+	fail_unless (8 == rr_get.rr_key_offset, "key offset not read back");
+	fail_unless (1 == rr_get.rr_tsi[1].sport, "source not read back");
+}
+END_TEST
+
+START_TEST (test_set_redundant_sources_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_REDUNDANT_SOURCES;
+	struct pgm_redundant_req_t rr;
+	memset (&rr, 0, sizeof(rr));
+	rr.rr_tsi_len		= PGM_REDUNDANT_MAX_SOURCES + 1;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, &rr, sizeof(rr)), "set_redundant_sources failed");
+	struct pgm_redundant_req_t rr_get;
+	socklen_t rr_len		= sizeof(rr_get);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &rr_get, &rr_len), "get_redundant_sources failed");
+	fail_unless (0 == rr_get.rr_tsi_len, "rejected sources applied");
+}
+END_TEST
+
+/* target:
+ *	int
+ *	pgm_poll_info (
+ *		pgm_sock_t*	sock,
+ *		struct pollfd*	fds,
+ *		int*		n_fds,
+ *		const short	events
+ *		)
+ */
+
+/* receive sockets, repair and pending notifications, each receive engine adds one */
+START_TEST (test_poll_info_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	sock->can_send_data = TRUE;
+	struct pollfd fds[8];
+	int n_fds = G_N_ELEMENTS(fds);
+	fail_unless (3 == pgm_poll_info_len (sock, POLLIN), "unexpected length");
+	fail_unless (4 == pgm_poll_info_len (sock, POLLIN | POLLOUT), "unexpected length");
+	fail_unless (3 == pgm_poll_info (sock, fds, &n_fds, POLLIN), "poll_info failed");
+	fail_unless (3 == n_fds, "unexpected count");
+	fail_unless (sock->recv_sock == fds[0].fd, "receive socket not first");
+#ifdef HAVE_INFINIBAND_VERBS_H
+/* RDMA engine counted from configuration, created later by pgm_connect() */
+	sock->verbs_req.vr_port = 1;
+	fail_unless (4 == pgm_poll_info_len (sock, POLLIN), "engine not counted");
+#endif
+}
+END_TEST
+
+/* an array short of the descriptors is refused without writing past it */
+START_TEST (test_poll_info_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	sock->can_send_data = TRUE;
+	struct pollfd fds[4];
+	memset (fds, 0xff, sizeof(fds));
+	int n_fds = 2;
+	fail_unless (-1 == pgm_poll_info (sock, fds, &n_fds, POLLIN), "short array accepted");
+	fail_unless (EINVAL == errno, "unexpected error");
+	fail_unless (-1 == fds[0].fd, "array written");
+}
+END_TEST
+
+static
+Suite*
+make_test_suite (void)
+{
+	Suite* s;
+
+	s = suite_create (__FILE__);
+
+	TCase* tc_create = tcase_create ("create");
+	suite_add_tcase (s, tc_create);
+	tcase_add_checked_fixture (tc_create, mock_setup, mock_teardown);
+	tcase_add_test (tc_create, test_create_pass_001);
+	tcase_add_test (tc_create, test_create_pass_002);
+	tcase_add_test (tc_create, test_create_fail_002);
+	tcase_add_test (tc_create, test_create_fail_003);
+	tcase_add_test (tc_create, test_create_fail_004);
+	tcase_add_test (tc_create, test_create_fail_005);
+
+	TCase* tc_bind = tcase_create ("bind");
+	suite_add_tcase (s, tc_bind);
+	tcase_add_checked_fixture (tc_bind, mock_setup, mock_teardown);
+	tcase_add_test (tc_bind, test_bind_fail_001);
+	tcase_add_test (tc_bind, test_bind_fail_002);
+
+	TCase* tc_connect = tcase_create ("connect");
+	suite_add_tcase (s, tc_connect);
+	tcase_add_checked_fixture (tc_connect, mock_setup, mock_teardown);
+	tcase_add_test (tc_connect, test_connect_pass_001);
+	tcase_add_test (tc_connect, test_connect_fail_001);
+
+	TCase* tc_destroy = tcase_create ("destroy");
+	suite_add_tcase (s, tc_destroy);
+	tcase_add_checked_fixture (tc_destroy, mock_setup, mock_teardown);
+	tcase_add_test (tc_destroy, test_destroy_pass_001);
+	tcase_add_test (tc_destroy, test_destroy_fail_001);
+
+	TCase* tc_set_max_tpdu = tcase_create ("set-max-tpdu");
+	suite_add_tcase (s, tc_set_max_tpdu);
+	tcase_add_checked_fixture (tc_set_max_tpdu, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_max_tpdu, test_set_max_tpdu_pass_001);
+	tcase_add_test (tc_set_max_tpdu, test_set_max_tpdu_fail_001);
+
+	TCase* tc_set_multicast_loop = tcase_create ("set-multicast-loop");
+	suite_add_tcase (s, tc_set_multicast_loop);
+	tcase_add_checked_fixture (tc_set_multicast_loop, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_multicast_loop, test_set_multicast_loop_pass_001);
+	tcase_add_test (tc_set_multicast_loop, test_set_multicast_loop_fail_001);
+
+	TCase* tc_set_hops = tcase_create ("set-hops");
+	suite_add_tcase (s, tc_set_hops);
+	tcase_add_checked_fixture (tc_set_hops, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_hops, test_set_hops_pass_001);
+	tcase_add_test (tc_set_hops, test_set_hops_fail_001);
 
 	TCase* tc_set_sndbuf = tcase_create ("set-sndbuf");
 	suite_add_tcase (s, tc_set_sndbuf);
@@ -1275,6 +4281,387 @@ make_test_suite (void)
 	tcase_add_test (tc_set_udp_multicast, test_set_udp_multicast_pass_001);
 	tcase_add_test (tc_set_udp_multicast, test_set_udp_multicast_fail_001);
 
+	TCase* tc_set_recv_batch = tcase_create ("set-recv-batch");
+	suite_add_tcase (s, tc_set_recv_batch);
+	tcase_add_checked_fixture (tc_set_recv_batch, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_recv_batch, test_set_recv_batch_pass_001);
+	tcase_add_test (tc_set_recv_batch, test_set_recv_batch_fail_001);
+	tcase_add_test (tc_set_recv_batch, test_set_recv_batch_fail_002);
+
+	TCase* tc_set_udp_gso = tcase_create ("set-udp-gso");
+	suite_add_tcase (s, tc_set_udp_gso);
+	tcase_add_checked_fixture (tc_set_udp_gso, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_udp_gso, test_set_udp_gso_pass_001);
+	tcase_add_test (tc_set_udp_gso, test_set_udp_gso_fail_001);
+	tcase_add_test (tc_set_udp_gso, test_set_udp_gso_fail_002);
+
+	TCase* tc_set_udp_gro = tcase_create ("set-udp-gro");
+	suite_add_tcase (s, tc_set_udp_gro);
+	tcase_add_checked_fixture (tc_set_udp_gro, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_udp_gro, test_set_udp_gro_pass_001);
+	tcase_add_test (tc_set_udp_gro, test_set_udp_gro_fail_001);
+	tcase_add_test (tc_set_udp_gro, test_set_udp_gro_fail_002);
+
+	TCase* tc_set_zerocopy = tcase_create ("set-zerocopy");
+	suite_add_tcase (s, tc_set_zerocopy);
+	tcase_add_checked_fixture (tc_set_zerocopy, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_zerocopy, test_set_zerocopy_pass_001);
+	tcase_add_test (tc_set_zerocopy, test_set_zerocopy_fail_001);
+	tcase_add_test (tc_set_zerocopy, test_set_zerocopy_fail_002);
+
+	TCase* tc_set_recv_shard = tcase_create ("set-recv-shard");
+	suite_add_tcase (s, tc_set_recv_shard);
+	tcase_add_checked_fixture (tc_set_recv_shard, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_recv_shard, test_set_recv_shard_pass_001);
+	tcase_add_test (tc_set_recv_shard, test_set_recv_shard_fail_001);
+	tcase_add_test (tc_set_recv_shard, test_set_recv_shard_fail_002);
+
+	TCase* tc_set_recv_sockets = tcase_create ("set-recv-sockets");
+	suite_add_tcase (s, tc_set_recv_sockets);
+	tcase_add_checked_fixture (tc_set_recv_sockets, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_recv_sockets, test_set_recv_sockets_pass_001);
+	tcase_add_test (tc_set_recv_sockets, test_set_recv_sockets_fail_001);
+	tcase_add_test (tc_set_recv_sockets, test_set_recv_sockets_fail_002);
+
+	TCase* tc_set_busy_poll = tcase_create ("set-busy-poll");
+	suite_add_tcase (s, tc_set_busy_poll);
+	tcase_add_checked_fixture (tc_set_busy_poll, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_busy_poll, test_set_busy_poll_pass_001);
+	tcase_add_test (tc_set_busy_poll, test_set_busy_poll_fail_001);
+	tcase_add_test (tc_set_busy_poll, test_set_busy_poll_fail_002);
+
+	TCase* tc_set_io_uring = tcase_create ("set-io-uring");
+	suite_add_tcase (s, tc_set_io_uring);
+	tcase_add_checked_fixture (tc_set_io_uring, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_io_uring, test_set_io_uring_pass_001);
+	tcase_add_test (tc_set_io_uring, test_set_io_uring_fail_001);
+	tcase_add_test (tc_set_io_uring, test_set_io_uring_fail_002);
+
+	TCase* tc_set_xdp_recv = tcase_create ("set-xdp-recv");
+	suite_add_tcase (s, tc_set_xdp_recv);
+	tcase_add_checked_fixture (tc_set_xdp_recv, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_xdp_recv, test_set_xdp_recv_pass_001);
+	tcase_add_test (tc_set_xdp_recv, test_set_xdp_recv_fail_001);
+	tcase_add_test (tc_set_xdp_recv, test_set_xdp_recv_fail_002);
+
+	TCase* tc_set_tpacket_recv = tcase_create ("set-tpacket-recv");
+	suite_add_tcase (s, tc_set_tpacket_recv);
+	tcase_add_checked_fixture (tc_set_tpacket_recv, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_tpacket_recv, test_set_tpacket_recv_pass_001);
+	tcase_add_test (tc_set_tpacket_recv, test_set_tpacket_recv_fail_001);
+	tcase_add_test (tc_set_tpacket_recv, test_set_tpacket_recv_fail_002);
+
+	TCase* tc_set_single_threaded = tcase_create ("set-single-threaded");
+	suite_add_tcase (s, tc_set_single_threaded);
+	tcase_add_checked_fixture (tc_set_single_threaded, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_single_threaded, test_set_single_threaded_pass_001);
+	tcase_add_test (tc_set_single_threaded, test_set_single_threaded_fail_001);
+	tcase_add_test (tc_set_single_threaded, test_set_single_threaded_fail_002);
+
+	TCase* tc_set_timer_fd = tcase_create ("set-timer-fd");
+	suite_add_tcase (s, tc_set_timer_fd);
+	tcase_add_checked_fixture (tc_set_timer_fd, mock_setup, mock_teardown);
+#ifdef HAVE_SYS_TIMERFD_H
+	tcase_add_test (tc_set_timer_fd, test_set_timer_fd_pass_001);
+#endif
+	tcase_add_test (tc_set_timer_fd, test_set_timer_fd_fail_001);
+
+	TCase* tc_set_fec_worker = tcase_create ("set-fec-worker");
+	suite_add_tcase (s, tc_set_fec_worker);
+	tcase_add_checked_fixture (tc_set_fec_worker, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_fec_worker, test_set_fec_worker_pass_001);
+	tcase_add_test (tc_set_fec_worker, test_set_fec_worker_fail_001);
+	tcase_add_test (tc_set_fec_worker, test_set_fec_worker_fail_002);
+
+	TCase* tc_set_sliding_fec = tcase_create ("set-sliding-fec");
+	suite_add_tcase (s, tc_set_sliding_fec);
+	tcase_add_checked_fixture (tc_set_sliding_fec, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_sliding_fec, test_set_sliding_fec_pass_001);
+	tcase_add_test (tc_set_sliding_fec, test_set_sliding_fec_fail_001);
+	tcase_add_test (tc_set_sliding_fec, test_set_sliding_fec_fail_002);
+
+	TCase* tc_set_pacing = tcase_create ("set-pacing");
+	suite_add_tcase (s, tc_set_pacing);
+	tcase_add_checked_fixture (tc_set_pacing, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_pacing, test_set_pacing_pass_001);
+	tcase_add_test (tc_set_pacing, test_set_pacing_fail_001);
+	tcase_add_test (tc_set_pacing, test_set_pacing_fail_002);
+
+	TCase* tc_set_timer_thread = tcase_create ("set-timer-thread");
+	suite_add_tcase (s, tc_set_timer_thread);
+	tcase_add_checked_fixture (tc_set_timer_thread, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_timer_thread, test_set_timer_thread_pass_001);
+	tcase_add_test (tc_set_timer_thread, test_set_timer_thread_fail_001);
+	tcase_add_test (tc_set_timer_thread, test_set_timer_thread_fail_002);
+
+	TCase* tc_set_timestamping = tcase_create ("set-timestamping");
+	suite_add_tcase (s, tc_set_timestamping);
+	tcase_add_checked_fixture (tc_set_timestamping, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_timestamping, test_set_timestamping_pass_001);
+	tcase_add_test (tc_set_timestamping, test_set_timestamping_fail_001);
+	tcase_add_test (tc_set_timestamping, test_set_timestamping_fail_002);
+	tcase_add_test (tc_set_timestamping, test_set_timestamping_fail_003);
+
+	TCase* tc_set_pow2_windows = tcase_create ("set-pow2-windows");
+	suite_add_tcase (s, tc_set_pow2_windows);
+	tcase_add_checked_fixture (tc_set_pow2_windows, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_pow2_windows, test_set_pow2_windows_pass_001);
+	tcase_add_test (tc_set_pow2_windows, test_set_pow2_windows_fail_001);
+
+	TCase* tc_set_mem_policy = tcase_create ("set-mem-policy");
+	suite_add_tcase (s, tc_set_mem_policy);
+	tcase_add_checked_fixture (tc_set_mem_policy, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_mem_policy, test_set_mem_policy_pass_001);
+	tcase_add_test (tc_set_mem_policy, test_set_mem_policy_fail_001);
+	tcase_add_test (tc_set_mem_policy, test_set_mem_policy_fail_002);
+
+	TCase* tc_set_txw_ring = tcase_create ("set-txw-ring");
+	suite_add_tcase (s, tc_set_txw_ring);
+	tcase_add_checked_fixture (tc_set_txw_ring, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_txw_ring, test_set_txw_ring_pass_001);
+	tcase_add_test (tc_set_txw_ring, test_set_txw_ring_fail_001);
+
+	TCase* tc_set_rx_size_classes = tcase_create ("set-rx-size-classes");
+	suite_add_tcase (s, tc_set_rx_size_classes);
+	tcase_add_checked_fixture (tc_set_rx_size_classes, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_rx_size_classes, test_set_rx_size_classes_pass_001);
+	tcase_add_test (tc_set_rx_size_classes, test_set_rx_size_classes_fail_001);
+
+	TCase* tc_set_send_batch = tcase_create ("set-send-batch");
+	suite_add_tcase (s, tc_set_send_batch);
+	tcase_add_checked_fixture (tc_set_send_batch, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_send_batch, test_set_send_batch_pass_001);
+	tcase_add_test (tc_set_send_batch, test_set_send_batch_fail_001);
+
+	TCase* tc_set_send_queue = tcase_create ("set-send-queue");
+	suite_add_tcase (s, tc_set_send_queue);
+	tcase_add_checked_fixture (tc_set_send_queue, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_send_queue, test_set_send_queue_pass_001);
+	tcase_add_test (tc_set_send_queue, test_set_send_queue_fail_001);
+
+	TCase* tc_set_multi_producer = tcase_create ("set-multi-producer");
+	suite_add_tcase (s, tc_set_multi_producer);
+	tcase_add_checked_fixture (tc_set_multi_producer, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_multi_producer, test_set_multi_producer_pass_001);
+	tcase_add_test (tc_set_multi_producer, test_set_multi_producer_fail_001);
+
+	TCase* tc_set_auto_buffers = tcase_create ("set-auto-buffers");
+	suite_add_tcase (s, tc_set_auto_buffers);
+	tcase_add_checked_fixture (tc_set_auto_buffers, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_auto_buffers, test_set_auto_buffers_pass_001);
+	tcase_add_test (tc_set_auto_buffers, test_set_auto_buffers_fail_001);
+
+	TCase* tc_set_recv_filter = tcase_create ("set-recv-filter");
+	suite_add_tcase (s, tc_set_recv_filter);
+	tcase_add_checked_fixture (tc_set_recv_filter, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_recv_filter, test_set_recv_filter_pass_001);
+	tcase_add_test (tc_set_recv_filter, test_set_recv_filter_fail_001);
+
+	TCase* tc_set_source_filter = tcase_create ("set-source-filter");
+	suite_add_tcase (s, tc_set_source_filter);
+	tcase_add_checked_fixture (tc_set_source_filter, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_source_filter, test_set_source_filter_pass_001);
+	tcase_add_test (tc_set_source_filter, test_set_source_filter_fail_001);
+
+	TCase* tc_set_tx_checksum = tcase_create ("set-tx-checksum");
+	suite_add_tcase (s, tc_set_tx_checksum);
+	tcase_add_checked_fixture (tc_set_tx_checksum, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_tx_checksum, test_set_tx_checksum_pass_001);
+	tcase_add_test (tc_set_tx_checksum, test_set_tx_checksum_fail_001);
+
+	TCase* tc_set_congestion_control = tcase_create ("set-congestion-control");
+	suite_add_tcase (s, tc_set_congestion_control);
+	tcase_add_checked_fixture (tc_set_congestion_control, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_congestion_control, test_set_congestion_control_pass_001);
+	tcase_add_test (tc_set_congestion_control, test_set_congestion_control_fail_001);
+
+	TCase* tc_set_nak_adaptive = tcase_create ("set-nak-adaptive");
+	suite_add_tcase (s, tc_set_nak_adaptive);
+	tcase_add_checked_fixture (tc_set_nak_adaptive, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_nak_adaptive, test_set_nak_adaptive_pass_001);
+	tcase_add_test (tc_set_nak_adaptive, test_set_nak_adaptive_fail_001);
+
+	TCase* tc_set_nak_aggregate_ivl = tcase_create ("set-nak-aggregate-ivl");
+	suite_add_tcase (s, tc_set_nak_aggregate_ivl);
+	tcase_add_checked_fixture (tc_set_nak_aggregate_ivl, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_nak_aggregate_ivl, test_set_nak_aggregate_ivl_pass_001);
+	tcase_add_test (tc_set_nak_aggregate_ivl, test_set_nak_aggregate_ivl_fail_001);
+
+	TCase* tc_set_fec_adaptive = tcase_create ("set-fec-adaptive");
+	suite_add_tcase (s, tc_set_fec_adaptive);
+	tcase_add_checked_fixture (tc_set_fec_adaptive, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_fec_adaptive, test_set_fec_adaptive_pass_001);
+	tcase_add_test (tc_set_fec_adaptive, test_set_fec_adaptive_fail_001);
+
+	TCase* tc_set_fec_decode_threads = tcase_create ("set-fec-decode-threads");
+	suite_add_tcase (s, tc_set_fec_decode_threads);
+	tcase_add_checked_fixture (tc_set_fec_decode_threads, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_fec_decode_threads, test_set_fec_decode_threads_pass_001);
+	tcase_add_test (tc_set_fec_decode_threads, test_set_fec_decode_threads_fail_001);
+	tcase_add_test (tc_set_fec_decode_threads, test_set_fec_decode_threads_fail_002);
+
+	TCase* tc_set_txw_store = tcase_create ("set-txw-store");
+	suite_add_tcase (s, tc_set_txw_store);
+	tcase_add_checked_fixture (tc_set_txw_store, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_txw_store, test_set_txw_store_pass_001);
+	tcase_add_test (tc_set_txw_store, test_set_txw_store_fail_001);
+	tcase_add_test (tc_set_txw_store, test_set_txw_store_fail_002);
+
+	TCase* tc_set_shm_recv = tcase_create ("set-shm-recv");
+	suite_add_tcase (s, tc_set_shm_recv);
+	tcase_add_checked_fixture (tc_set_shm_recv, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_shm_recv, test_set_shm_recv_pass_001);
+	tcase_add_test (tc_set_shm_recv, test_set_shm_recv_fail_001);
+	tcase_add_test (tc_set_shm_recv, test_set_shm_recv_fail_002);
+
+	TCase* tc_set_catchup = tcase_create ("set-catchup");
+	suite_add_tcase (s, tc_set_catchup);
+	tcase_add_checked_fixture (tc_set_catchup, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_catchup, test_set_catchup_pass_001);
+	tcase_add_test (tc_set_catchup, test_set_catchup_fail_001);
+	tcase_add_test (tc_set_catchup, test_set_catchup_rate_pass_001);
+	tcase_add_test (tc_set_catchup, test_set_catchup_rate_fail_001);
+
+	TCase* tc_set_dlr = tcase_create ("set-dlr");
+	suite_add_tcase (s, tc_set_dlr);
+	tcase_add_checked_fixture (tc_set_dlr, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_dlr, test_set_dlr_pass_001);
+	tcase_add_test (tc_set_dlr, test_set_dlr_fail_001);
+
+	TCase* tc_set_dport = tcase_create ("set-dport");
+	suite_add_tcase (s, tc_set_dport);
+	tcase_add_checked_fixture (tc_set_dport, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_dport, test_set_join_dport_pass_001);
+	tcase_add_test (tc_set_dport, test_set_join_dport_fail_001);
+	tcase_add_test (tc_set_dport, test_set_join_dport_pass_002);
+	tcase_add_test (tc_set_dport, test_set_leave_dport_pass_001);
+	tcase_add_test (tc_set_dport, test_set_leave_dport_fail_001);
+
+	TCase* tc_set_peer_idle = tcase_create ("set-peer-idle");
+	suite_add_tcase (s, tc_set_peer_idle);
+	tcase_add_checked_fixture (tc_set_peer_idle, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_peer_idle, test_set_peer_idle_pass_001);
+	tcase_add_test (tc_set_peer_idle, test_set_peer_idle_fail_001);
+
+	TCase* tc_set_large_apdu = tcase_create ("set-large-apdu");
+	suite_add_tcase (s, tc_set_large_apdu);
+	tcase_add_checked_fixture (tc_set_large_apdu, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_large_apdu, test_set_large_apdu_pass_001);
+	tcase_add_test (tc_set_large_apdu, test_set_large_apdu_fail_001);
+
+	TCase* tc_set_merge_delivery = tcase_create ("set-merge-delivery");
+	suite_add_tcase (s, tc_set_merge_delivery);
+	tcase_add_checked_fixture (tc_set_merge_delivery, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_merge_delivery, test_set_merge_delivery_pass_001);
+	tcase_add_test (tc_set_merge_delivery, test_set_merge_delivery_fail_001);
+
+	TCase* tc_set_delivery_quantum = tcase_create ("set-delivery-quantum");
+	suite_add_tcase (s, tc_set_delivery_quantum);
+	tcase_add_checked_fixture (tc_set_delivery_quantum, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_delivery_quantum, test_set_delivery_quantum_pass_001);
+	tcase_add_test (tc_set_delivery_quantum, test_set_delivery_quantum_fail_001);
+
+	TCase* tc_set_stream_group = tcase_create ("set-stream-group");
+	suite_add_tcase (s, tc_set_stream_group);
+	tcase_add_checked_fixture (tc_set_stream_group, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_stream_group, test_set_stream_group_pass_001);
+	tcase_add_test (tc_set_stream_group, test_set_stream_group_fail_001);
+
+	TCase* tc_set_priority_class = tcase_create ("set-priority-class");
+	suite_add_tcase (s, tc_set_priority_class);
+	tcase_add_checked_fixture (tc_set_priority_class, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_priority_class, test_set_priority_class_pass_001);
+	tcase_add_test (tc_set_priority_class, test_set_priority_class_fail_001);
+
+	TCase* tc_set_send_paths = tcase_create ("set-send-paths");
+	suite_add_tcase (s, tc_set_send_paths);
+	tcase_add_checked_fixture (tc_set_send_paths, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_send_paths, test_set_send_paths_pass_001);
+	tcase_add_test (tc_set_send_paths, test_set_send_paths_fail_001);
+
+	TCase* tc_set_unicast_fanout = tcase_create ("set-unicast-fanout");
+	suite_add_tcase (s, tc_set_unicast_fanout);
+	tcase_add_checked_fixture (tc_set_unicast_fanout, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_unicast_fanout, test_set_unicast_fanout_pass_001);
+	tcase_add_test (tc_set_unicast_fanout, test_set_unicast_fanout_fail_001);
+
+	TCase* tc_set_verbs = tcase_create ("set-verbs");
+	suite_add_tcase (s, tc_set_verbs);
+	tcase_add_checked_fixture (tc_set_verbs, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_verbs, test_set_verbs_pass_001);
+	tcase_add_test (tc_set_verbs, test_set_verbs_fail_001);
+
+	TCase* tc_set_dpdk = tcase_create ("set-dpdk");
+	suite_add_tcase (s, tc_set_dpdk);
+	tcase_add_checked_fixture (tc_set_dpdk, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_dpdk, test_set_dpdk_pass_001);
+	tcase_add_test (tc_set_dpdk, test_set_dpdk_fail_001);
+
+	TCase* tc_set_compact = tcase_create ("set-compact");
+	suite_add_tcase (s, tc_set_compact);
+	tcase_add_checked_fixture (tc_set_compact, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_compact, test_set_compact_pass_001);
+	tcase_add_test (tc_set_compact, test_set_compact_fail_001);
+
+	TCase* tc_set_linger = tcase_create ("set-linger");
+	suite_add_tcase (s, tc_set_linger);
+	tcase_add_checked_fixture (tc_set_linger, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_linger, test_set_linger_pass_001);
+	tcase_add_test (tc_set_linger, test_set_linger_fail_001);
+
+	TCase* tc_set_handoff_ring = tcase_create ("set-handoff-ring");
+	suite_add_tcase (s, tc_set_handoff_ring);
+	tcase_add_checked_fixture (tc_set_handoff_ring, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_handoff_ring, test_set_handoff_ring_pass_001);
+	tcase_add_test (tc_set_handoff_ring, test_set_handoff_ring_fail_001);
+
+	TCase* tc_set_nak_limit = tcase_create ("set-nak-limit");
+	suite_add_tcase (s, tc_set_nak_limit);
+	tcase_add_checked_fixture (tc_set_nak_limit, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_nak_limit, test_set_nak_limit_pass_001);
+	tcase_add_test (tc_set_nak_limit, test_set_nak_limit_fail_001);
+
+	TCase* tc_set_warm_restart = tcase_create ("set-warm-restart");
+	suite_add_tcase (s, tc_set_warm_restart);
+	tcase_add_checked_fixture (tc_set_warm_restart, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_warm_restart, test_set_warm_restart_pass_001);
+	tcase_add_test (tc_set_warm_restart, test_set_warm_restart_fail_001);
+
+	TCase* tc_set_local_publish = tcase_create ("set-local-publish");
+	suite_add_tcase (s, tc_set_local_publish);
+	tcase_add_checked_fixture (tc_set_local_publish, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_local_publish, test_set_local_publish_pass_001);
+	tcase_add_test (tc_set_local_publish, test_set_local_publish_fail_001);
+
+	TCase* tc_set_standby = tcase_create ("set-standby");
+	suite_add_tcase (s, tc_set_standby);
+	tcase_add_checked_fixture (tc_set_standby, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_standby, test_set_standby_pass_001);
+	tcase_add_test (tc_set_standby, test_set_standby_fail_001);
+
+	TCase* tc_set_send_ports = tcase_create ("set-send-ports");
+	suite_add_tcase (s, tc_set_send_ports);
+	tcase_add_checked_fixture (tc_set_send_ports, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_send_ports, test_set_send_ports_pass_001);
+	tcase_add_test (tc_set_send_ports, test_set_send_ports_fail_001);
+
+	TCase* tc_set_join_source_groups = tcase_create ("set-join-source-groups");
+	suite_add_tcase (s, tc_set_join_source_groups);
+	tcase_add_checked_fixture (tc_set_join_source_groups, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_join_source_groups, test_set_join_source_groups_fail_001);
+
+	TCase* tc_set_redundant_sources = tcase_create ("set-redundant-sources");
+	suite_add_tcase (s, tc_set_redundant_sources);
+	tcase_add_checked_fixture (tc_set_redundant_sources, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_redundant_sources, test_set_redundant_sources_pass_001);
+	tcase_add_test (tc_set_redundant_sources, test_set_redundant_sources_fail_001);
+
+	TCase* tc_poll_info = tcase_create ("poll-info");
+	suite_add_tcase (s, tc_poll_info);
+	tcase_add_checked_fixture (tc_poll_info, mock_setup, mock_teardown);
+	tcase_add_test (tc_poll_info, test_poll_info_pass_001);
+	tcase_add_test (tc_poll_info, test_poll_info_fail_001);
+
 	return s;
 }
 
@@ -23,6 +23,16 @@
 #	include <config.h>
 #endif
 #include <errno.h>
+#ifndef _WIN32
+#	include <unistd.h>
+#else
+#	include <io.h>
+#endif
+#ifdef HAVE_LINUX_ERRQUEUE_H
+#	include <sys/socket.h>
+#	include <netinet/in.h>
+#	include <linux/errqueue.h>
+#endif
 #include <impl/i18n.h>
 #include <impl/framework.h>
 #include <impl/socket.h>
@@ -38,6 +48,15 @@
 #	define PGM_DISABLE_ASSERT
 #endif
 
+/* retry interval of a queued APDU blocked other than by the rate limit */
+#define PGM_SENDQ_RETRY_IVL	pgm_msecs(1)
+
+/* selective repairs sent per datagram batch under one rate limit charge */
+#define PGM_RDATA_BATCH		16
+
+/* transmission groups per adaptive FEC loss sample */
+#define PGM_FEC_ADAPT_TGS	16
+
 
 /* locals */
 static inline bool peer_is_source (const pgm_peer_t*) PGM_GNUC_CONST;
@@ -45,10 +64,20 @@ static inline bool peer_is_peer (const pgm_peer_t*) PGM_GNUC_CONST;
 static void reset_heartbeat_spm (pgm_sock_t*const, const pgm_time_t);
 static bool send_ncf (pgm_sock_t*const restrict, const struct sockaddr*const restrict, const struct sockaddr*const restrict, const uint32_t, const bool);
 static bool send_ncf_list (pgm_sock_t*const restrict, const struct sockaddr*const restrict, const struct sockaddr*const restrict, struct pgm_sqn_list_t*const restrict, const bool);
-static int send_odata (pgm_sock_t*const restrict, struct pgm_sk_buff_t*const restrict, size_t*restrict);
-static int send_odata_copy (pgm_sock_t*const restrict, const void*restrict, const uint16_t, size_t*restrict);
-static int send_odatav (pgm_sock_t*const restrict, const struct pgm_iovec*const restrict, const unsigned, size_t*restrict);
-static bool send_rdata (pgm_sock_t*restrict, struct pgm_sk_buff_t*restrict);
+static int send_odata (pgm_sock_t*const restrict, struct pgm_sk_buff_t*const restrict, const uint32_t*restrict, size_t*restrict);
+static inline int send_odata_copy (pgm_sock_t*const restrict, const void*restrict, const uint16_t, const uint16_t, size_t*restrict);
+static int send_odatav (pgm_sock_t*const restrict, const struct pgm_iovec*const restrict, const uint32_t*restrict, const unsigned, size_t*restrict);
+static int send_batch_pending (pgm_sock_t*const);
+static int _pgm_sendv (pgm_sock_t*const restrict, const struct pgm_iovec*const restrict, const uint32_t*restrict, const unsigned, const bool, size_t*restrict);
+static int _pgm_send_skbv (pgm_sock_t*const restrict, struct pgm_sk_buff_t**const restrict, const uint32_t*restrict, const unsigned, const bool, size_t*restrict);
+static int send_sendq_pending (pgm_sock_t*const);
+static bool send_rdata (pgm_sock_t*restrict, pgm_stats_t*restrict, struct pgm_sk_buff_t*restrict);
+static unsigned send_rdatav (pgm_sock_t*restrict, pgm_stats_t*restrict, struct pgm_sk_buff_t**const restrict, const unsigned);
+static void source_wake_timer (pgm_sock_t*const, const pgm_time_t);
+static void nak_aggregate (pgm_sock_t*const restrict, const struct pgm_sqn_list_t*const restrict, const bool);
+static bool on_catchup (pgm_sock_t*const restrict, const uint32_t, const struct pgm_opt_catchup*const restrict);
+static bool on_ack_trail (pgm_sock_t*const restrict, const uint32_t, const struct pgm_opt_ack_trail*const restrict, const pgm_time_t);
+static bool on_credit (pgm_sock_t*const restrict, const struct pgm_opt_credit*const restrict, const pgm_time_t);
 
 
 static inline
@@ -107,9 +136,160 @@ source_max_tsdu (
 	size_t max_tsdu = can_fragment ? sock->max_tsdu_fragment : sock->max_tsdu;
 	if (sock->use_var_pktlen /* OPT_VAR_PKT_LEN */)
 		max_tsdu -= sizeof (uint16_t);
+/* sliding window repairs code the length and fragment option with the payload */
+	if (sock->use_sliding_fec /* OPT_SW_REPAIR */) {
+		const size_t sw_max_tsdu = sock->max_tpdu - sock->iphdr_len -
+					   (sizeof(struct pgm_header) + sizeof(struct pgm_data) +
+					    sizeof(struct pgm_opt_length) + sizeof(struct pgm_opt_header) +
+					    sizeof(struct pgm_opt_sw_repair) + PGM_RLC_SYMBOL_HEADER);
+		max_tsdu = MIN(max_tsdu, sw_max_tsdu);
+	}
 	return max_tsdu;
 }
 
+/* OPT_BATCH, and OPT_LENGTH when not already present for PGMCC.
+ */
+
+static inline
+size_t
+source_batch_opt_length (
+	const pgm_sock_t*	sock
+	)
+{
+	return (sock->use_pgmcc ? 0 : sizeof (struct pgm_opt_length)) +
+		sizeof (struct pgm_opt_header) + sizeof (struct pgm_opt_batch);
+}
+
+/* ODATA and RDATA of PGM_TX_CHECKSUM as PGM_CHECKSUM_UDP_TRUSTED carry a zero, "no
+ * checksum", PGM checksum and rely upon the UDP checksum, computed by the host or the
+ * NIC.  the payload is then copied without summing.
+ */
+
+static inline
+uint32_t
+source_csum_partial (
+	const pgm_sock_t*    const restrict sock,
+	const void*	     const restrict addr,
+	const uint16_t			    len
+	)
+{
+	if (PGM_CHECKSUM_UDP_TRUSTED == sock->tx_checksum)
+		return 0;
+	return pgm_csum_partial (addr, len, 0);
+}
+
+static inline
+uint32_t
+source_csum_partial_copy (
+	const pgm_sock_t*    const restrict sock,
+	const void*	     const restrict src,
+	void*		     const restrict dst,
+	const uint16_t			    len
+	)
+{
+	if (PGM_CHECKSUM_UDP_TRUSTED == sock->tx_checksum) {
+		memcpy (dst, src, len);
+		return 0;
+	}
+	return pgm_csum_partial_copy_nt (src, dst, len, 0);
+}
+
+static inline
+uint16_t
+source_csum_fold (
+	const pgm_sock_t*	sock,
+	const uint32_t		unfolded_header,
+	const uint32_t		unfolded_odata,
+	const uint16_t		header_len
+	)
+{
+	if (PGM_CHECKSUM_UDP_TRUSTED == sock->tx_checksum)
+		return 0;
+	return pgm_csum_fold (pgm_csum_block_add (unfolded_header, unfolded_odata, header_len));
+}
+
+/* copy of one caller buffer with its unfolded checksum, as precomputed by the
+ * caller with pgm_csum_payload() when csum is not NULL.
+ */
+
+static inline
+uint32_t
+source_csum_copy_buffer (
+	const pgm_sock_t*    const restrict sock,
+	const uint32_t*	     const restrict csum,
+	const void*	     const restrict src,
+	void*		     const restrict dst,
+	const uint16_t			    len
+	)
+{
+	if (NULL != csum) {
+		memcpy (dst, src, len);
+		return *csum;
+	}
+	return source_csum_partial_copy (sock, src, dst, len);
+}
+
+/* OPT_PARITY_PRM flags announced in SPMs, zero to omit the option.
+ */
+
+static inline
+uint8_t
+source_parity_prm (
+	const pgm_sock_t*	sock
+	)
+{
+	const bool has_proactive = sock->use_proactive_parity &&
+				   (!sock->use_adaptive_fec || sock->rs_proactive_h > 0);
+	return (has_proactive ? PGM_PARITY_PRM_PRO : 0) |
+	       (sock->use_ondemand_parity ? PGM_PARITY_PRM_OND : 0);
+}
+
+/* adaptive FEC, called at the end of each transmission group by the sending thread.
+ * every PGM_FEC_ADAPT_TGS groups the packet loss reported by NAKs and the ACKer
+ * feedback is smoothed into a loss fraction, proactive parity then covers twice the
+ * expected loss per group up to the configured ceiling.  a clean link sends none.
+ *
+ * returns the count of proactive parity packets for the group.
+ */
+
+static
+uint8_t
+fec_adapt (
+	pgm_sock_t*		sock
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (sock->use_adaptive_fec);
+
+	if (++sock->fec_tg_count < PGM_FEC_ADAPT_TGS)
+		return sock->rs_proactive_h;
+	sock->fec_tg_count = 0;
+
+	const uint32_t nak_count = pgm_atomic_read32 (&sock->fec_nak_count);
+	const uint32_t lost = nak_count - sock->fec_nak_last;
+	sock->fec_nak_last = nak_count;
+	const uint32_t sent = PGM_FEC_ADAPT_TGS * sock->rs_k;
+	uint32_t sample = lost >= sent ? 0xffff : (lost << 16) / sent;
+	const uint32_t feedback_loss = pgm_atomic_read32 (&sock->fec_feedback_loss);
+	if (feedback_loss > sample)
+		sample = feedback_loss;
+	sock->fec_loss = (3 * sock->fec_loss + sample) >> 2;
+
+	const uint32_t h = (2 * sock->fec_loss * sock->rs_k + 0xffff) >> 16;
+	const uint8_t rs_proactive_h = (uint8_t)MIN(h, sock->rs_proactive_max_h);
+	if (rs_proactive_h != sock->rs_proactive_h) {
+		pgm_trace (PGM_LOG_ROLE_FEC,_("Proactive parity %u of %u packets per transmission group."),
+			(unsigned)rs_proactive_h, (unsigned)sock->rs_proactive_max_h);
+		const bool is_announced = (0 == rs_proactive_h) != (0 == sock->rs_proactive_h);
+		sock->rs_proactive_h = rs_proactive_h;
+/* announce starting or stopping proactive parity with the next SPM */
+		if (is_announced)
+			reset_heartbeat_spm (sock, pgm_time_update_now());
+	}
+	return rs_proactive_h;
+}
+
 /* prototype of function to send pro-active parity NAKs.
  */
 
@@ -121,6 +301,13 @@ pgm_schedule_proactive_nak (
 	)
 {
 	pgm_return_val_if_fail (NULL != sock, FALSE);
+	if (sock->use_adaptive_fec &&
+	    0 == fec_adapt (sock))
+		return TRUE;
+/* encoded off the send path, falls back to the repair path when backlogged */
+	if (sock->use_fec_worker &&
+	    pgm_txw_parity_submit (sock->window, nak_tg_sqn))
+		return TRUE;
 	const bool status = pgm_txw_retransmit_push (sock->window,
 						     nak_tg_sqn | sock->rs_proactive_h,
 						     TRUE /* is_parity */,
@@ -128,9 +315,36 @@ pgm_schedule_proactive_nak (
 	return status;
 }
 
+/* send a sliding window repair after every repair interval of original data, covering
+ * the preceding window of packets.  the repair is discarded rather than blocking the
+ * source API, later repairs cover the same data.
+ */
+
+static
+void
+send_sw_repair (
+	pgm_sock_t*		sock,
+	const uint32_t		odata_sqn
+	)
+{
+	struct pgm_sk_buff_t* skb;
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (sock->use_sliding_fec);
+
+	if ((odata_sqn + 1) % sock->sw_interval)
+		return;
+	skb = pgm_txw_sw_encode (sock->window, odata_sqn, sock->sw_window, sock->sw_key++);
+	if (PGM_UNLIKELY(NULL == skb))
+		return;
+	if (!send_rdata (sock, &sock->cumulative_stats[PGM_STATS_TX], skb))
+		pgm_trace (PGM_LOG_ROLE_FEC,_("Sliding window repair #%" PRIu32 " discarded on blocked send."), odata_sqn);
+	pgm_free_skb (skb);
+}
+
 /* a deferred request for RDATA, now processing in the timer thread, we check the transmit
- * window to see if the packet exists and forward on, maintaining a lock until the queue is
- * empty.
+ * window to see if the packet exists and forward on, without a lock against the source API.
  *
  * returns TRUE on success, returns FALSE if operation would block.
  */
@@ -155,15 +369,55 @@ pgm_on_deferred_nak (
  * provides the extra offset value.
  */
 
+/* proactive parity from the FEC worker goes ahead, the ready queue owns the skbuff.
+ */
+	if (sock->use_fec_worker) {
+		skb = pgm_txw_parity_try_peek (sock->window);
+		if (skb) {
+			if (!send_rdata (sock, &sock->cumulative_stats[PGM_STATS_RX], skb)) {
+				pgm_notify_send (&sock->rdata_notify);
+				return FALSE;
+			}
+			pgm_txw_parity_remove_head (sock->window);
+			return TRUE;
+		}
+	}
+
 /* peek from the retransmit queue so we can eliminate duplicate NAKs up until the repair packet
- * has been retransmitted.
+ * has been retransmitted.  the queue holds a reference so the window may advance concurrently.
+ *
+ * a run of selective requests is sent as one batch, congestion control meters per packet.
  */
-	pgm_spinlock_lock (&sock->txw_spinlock);
+	if (!sock->use_pgmcc) {
+		struct pgm_sk_buff_t* skbv[ PGM_RDATA_BATCH ];
+		unsigned count = pgm_txw_retransmit_try_peekv (sock->window, skbv, PGM_RDATA_BATCH);
+/* zero-copy ODATA still in flight is repaired from a copy by send_rdata() */
+		for (unsigned i = 0; i < count; i++)
+			if (PGM_UNLIKELY(skbv[i]->is_zc_pending)) {
+				count = i;
+				break;
+			}
+		if (count > 1) {
+			for (unsigned i = 0; i < count; i++)
+				skbv[i] = pgm_skb_get (skbv[i]);
+			const unsigned sent = send_rdatav (sock, &sock->cumulative_stats[PGM_STATS_RX], skbv, count);
+			for (unsigned i = 0; i < count; i++) {
+				if (i < sent)
+					pgm_txw_retransmit_remove_head (sock->window);
+				pgm_free_skb (skbv[i]);
+			}
+			if (sent < count) {
+				pgm_notify_send (&sock->rdata_notify);
+				return FALSE;
+			}
+			return TRUE;
+		}
+	}
+
 	skb = pgm_txw_retransmit_try_peek (sock->window);
 	if (skb) {
 		skb = pgm_skb_get (skb);
-		pgm_spinlock_unlock (&sock->txw_spinlock);
-		if (!send_rdata (sock, skb)) {
+		if (!send_rdata (sock, &sock->cumulative_stats[PGM_STATS_RX], skb)) {
 			pgm_free_skb (skb);
 			pgm_notify_send (&sock->rdata_notify);
 			return FALSE;
@@ -171,8 +425,7 @@ pgm_on_deferred_nak (
 		pgm_free_skb (skb);
 /* now remove sequence number from retransmit queue, re-enabling NAK processing for this sequence number */
 		pgm_txw_retransmit_remove_head (sock->window);
-	} else
-		pgm_spinlock_unlock (&sock->txw_spinlock);
+	}
 	return TRUE;
 }
 
@@ -216,7 +469,8 @@ pgm_on_spmr (
 }
 
 /* Process opt_pgmcc_feedback PGM option that ships attached to ACK or NAK.
- * Contents use to elect best ACKer.
+ * Contents use to elect best ACKer from the candidate table, the peer round
+ * trip time in milliseconds is returned in rtt.
  *
  * returns TRUE if peer is the elected ACKer.
  */
@@ -226,7 +480,8 @@ bool
 on_opt_pgmcc_feedback (
 	pgm_sock_t*           	       const restrict sock,
 	const struct pgm_sk_buff_t*    const restrict skb,
-	const struct pgm_opt_pgmcc_feedback* restrict opt_pgmcc_feedback
+	const struct pgm_opt_pgmcc_feedback* restrict opt_pgmcc_feedback,
+	uint32_t*			     restrict rtt_ms
 	)
 {
 	struct sockaddr_storage peer_nla;
@@ -240,31 +495,221 @@ on_opt_pgmcc_feedback (
 	const uint16_t opt_loss_rate = pgm_ntohs (opt_pgmcc_feedback->opt_loss_rate);
 
 	const uint32_t rtt = (uint32_t)(pgm_to_msecs (skb->tstamp) - opt_tstamp);
-	const uint64_t peer_loss = rtt * rtt * opt_loss_rate;
+	*rtt_ms = rtt;
 
 	pgm_nla_to_sockaddr (&opt_pgmcc_feedback->opt_nla_afi, (struct sockaddr*)&peer_nla);
 
-/* ACKer elections */
-	if (PGM_UNLIKELY(pgm_sockaddr_is_addr_unspecified ((const struct sockaddr*)&sock->acker_nla)))
-	{
-		pgm_trace (PGM_LOG_ROLE_CONGESTION_CONTROL,_("Elected first ACKer"));
-		memcpy (&sock->acker_nla, &peer_nla, pgm_sockaddr_storage_len (&peer_nla));
+/* ACKer elections, the elected worst receiver loss drives adaptive FEC */
+	if (!pgm_cc_on_feedback (sock, (const struct sockaddr*)&peer_nla, skb->tstamp, rtt, opt_loss_rate))
+		return FALSE;
+	if (sock->use_adaptive_fec)
+		pgm_atomic_write32 (&sock->fec_feedback_loss, opt_loss_rate);
+	return TRUE;
+}
+
+/* returns TRUE if the group NLA of a NAK names the send group, or a unicast
+ * receiver of PGM_UNICAST_FANOUT that sees its own address as the group.
+ */
+
+static
+bool
+is_nak_group (
+	const pgm_sock_t*      const restrict sock,
+	const struct sockaddr* const restrict nak_grp_nla
+	)
+{
+	if (PGM_LIKELY(0 == pgm_sockaddr_cmp (nak_grp_nla, (const struct sockaddr*)&sock->send_gsr.gsr_group)))
+		return TRUE;
+	for (unsigned i = 0; i < sock->fanout_req.fr_len; i++)
+		if (0 == pgm_sockaddr_cmp (nak_grp_nla, (const struct sockaddr*)&sock->fanout_req.fr_addr[i]))
+			return TRUE;
+	return FALSE;
+}
+
+/* copy a repair from the transmit window to buf as RDATA advertising trail and send
+ * it to one receiver by unicast, counted as a selective retransmission unless the
+ * send would block.
+ *
+ * returns the result of pgm_sendto().
+ */
+
+static
+ssize_t
+send_rdata_unicast (
+	pgm_sock_t*		     const restrict sock,
+	const struct pgm_sk_buff_t*  const restrict skb,
+	const uint32_t				    trail,
+	const struct sockaddr*	     const restrict addr,
+	char*			     const restrict buf
+	)
+{
+	const size_t tpdu_length = (char*)skb->tail - (char*)skb->head;
+	memcpy (buf, skb->head, tpdu_length);
+	struct pgm_header* header = (struct pgm_header*)buf;
+	struct pgm_data* rdata = (struct pgm_data*)(header + 1);
+	header->pgm_type	= PGM_RDATA;
+	rdata->data_trail	= pgm_htonl (trail);
+	header->pgm_checksum	= 0;
+	header->pgm_checksum	= pgm_csum_fold (pgm_csum_partial (buf, (uint16_t)tpdu_length, 0));
+	const ssize_t sent = pgm_sendto (sock,
+					 FALSE,			/* already rate limited */
+					 NULL,
+					 FALSE,			/* regular socket */
+					 buf,
+					 tpdu_length,
+					 addr,
+					 pgm_sockaddr_len (addr));
+	if (sent < 0) {
+		const int save_errno = pgm_get_last_sock_error();
+		if (PGM_LIKELY(PGM_SOCK_EAGAIN == save_errno || PGM_SOCK_ENOBUFS == save_errno))
+			return sent;
+	}
+	pgm_stats_add (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_SELECTIVE_BYTES_RETRANSMITTED, pgm_ntohs (header->pgm_tsdu_length));
+	pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_SELECTIVE_MSGS_RETRANSMITTED);
+	pgm_stats_add (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_BYTES_SENT, tpdu_length + sock->iphdr_len);
+	return sent;
+}
+
+/* PGM_NAK_LIMIT entry of the receiver at addr, a new receiver takes a free entry
+ * or that of the least recently NAKing receiver.  caller holds receiver_mutex.
+ */
+
+static
+struct pgm_nak_limit_t*
+nak_limit_find (
+	pgm_sock_t*		const restrict sock,
+	const struct sockaddr*	const restrict addr,
+	const pgm_time_t			now
+	)
+{
+	struct pgm_nak_limit_t* entry = NULL;
+	for (unsigned i = 0; i < sock->nak_limit_len; i++) {
+		struct pgm_nak_limit_t* receiver = &sock->nak_limit[ i ];
+		if (0 == pgm_sockaddr_cmp ((const struct sockaddr*)&receiver->stat.ns_addr, addr))
+			return receiver;
+		if (NULL == entry || pgm_time_after (entry->refill, receiver->refill))
+			entry = receiver;
 	}
-	else if (peer_loss > sock->acker_loss &&
-		 0 != pgm_sockaddr_cmp ((const struct sockaddr*)&peer_nla, (const struct sockaddr*)&sock->acker_nla))
+	if (sock->nak_limit_len < PGM_NAK_LIMIT_RECEIVERS)
+		entry = &sock->nak_limit[ sock->nak_limit_len++ ];
+	memset (entry, 0, sizeof (struct pgm_nak_limit_t));
+	memcpy (&entry->stat.ns_addr, addr, pgm_sockaddr_len (addr));
+	entry->credit = (uint64_t)sock->nak_limit_req.nl_burst * PGM_NAK_LIMIT_UNIT;
+	entry->refill = now;
+	return entry;
+}
+
+/* charge the sequences of one NAK to the token bucket of its receiver, trimming the
+ * list to those within the limit.  refused sequences count towards demotion, a
+ * receiver within the limit for nl_restore is forgiven.
+ *
+ * returns TRUE if the receiver is demoted.
+ */
+
+static
+bool
+nak_limit_admit (
+	pgm_sock_t*		  const restrict sock,
+	const struct sockaddr*	  const restrict addr,
+	struct pgm_sqn_list_t*	  const restrict sqn_list,
+	const bool				 is_parity,
+	const pgm_time_t			 now
+	)
+{
+	const struct pgm_nak_limit_req_t* nl = &sock->nak_limit_req;
+	struct pgm_nak_limit_t* entry = nak_limit_find (sock, addr, now);
+
+	if (nl->nl_restore &&
+	    entry->strikes > 0 &&
+	    now - entry->last_refused >= nl->nl_restore)
 	{
-		pgm_trace (PGM_LOG_ROLE_CONGESTION_CONTROL,_("Elected new ACKer"));
-		memcpy (&sock->acker_nla, &peer_nla, pgm_sockaddr_storage_len (&peer_nla));
+		if (entry->stat.ns_is_demoted) {
+			char saddr[INET6_ADDRSTRLEN];
+			pgm_sockaddr_ntop (addr, saddr, sizeof(saddr));
+			pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Receiver %s restored within its NAK limit."), saddr);
+		}
+		entry->strikes = 0;
+		entry->stat.ns_is_demoted = FALSE;
+	}
+
+/* refill bounded so that the product cannot overflow */
+	if (pgm_time_after (now, entry->refill)) {
+		const pgm_time_t elapsed = MIN(now - entry->refill, pgm_secs (3600));
+		const uint64_t depth = (uint64_t)nl->nl_burst * PGM_NAK_LIMIT_UNIT;
+		entry->credit = MIN(depth, entry->credit + elapsed * nl->nl_rate);
+		entry->refill = now;
 	}
 
-/* update ACKer state */
-	if (0 == pgm_sockaddr_cmp ((const struct sockaddr*)&peer_nla, (const struct sockaddr*)&sock->acker_nla))
+	const unsigned admitted = (unsigned)MIN((uint64_t)sqn_list->len, entry->credit / PGM_NAK_LIMIT_UNIT);
+	const unsigned refused  = sqn_list->len - admitted;
+	entry->credit -= admitted * PGM_NAK_LIMIT_UNIT;
+	entry->stat.ns_sqns += sqn_list->len;
+	if (0 == refused)
+		return entry->stat.ns_is_demoted;
+
+	sqn_list->len = admitted;
+	entry->stat.ns_refused += refused;
+	entry->strikes += refused;
+	entry->last_refused = now;
+	pgm_stats_add (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_NAKS_RATE_LIMITED, refused);
+	pgm_stats_add (&sock->cumulative_stats[PGM_STATS_RX], is_parity ? PGM_PC_SOURCE_PARITY_NAKS_IGNORED : PGM_PC_SOURCE_SELECTIVE_NAKS_IGNORED, refused);
+	if (nl->nl_demote &&
+	    !entry->stat.ns_is_demoted &&
+	    entry->strikes >= nl->nl_demote)
 	{
-		sock->acker_loss = peer_loss;
-		return TRUE;
+		char saddr[INET6_ADDRSTRLEN];
+		pgm_sockaddr_ntop (addr, saddr, sizeof(saddr));
+		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Receiver %s demoted to %s after %u sequences over its NAK limit."),
+			saddr,
+			PGM_NAK_LIMIT_IGNORE == nl->nl_action ? "ignored NAKs" : "unicast repair",
+			entry->strikes);
+		entry->stat.ns_is_demoted = TRUE;
+		entry->stat.ns_demotions++;
+		pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_RECEIVERS_DEMOTED);
 	}
+	return entry->stat.ns_is_demoted;
+}
 
-	return FALSE;
+/* repair a demoted receiver by unicast RDATA without an NCF to the group, which
+ * would suppress the NAKs of other receivers for data they will not see.
+ * sequences beyond the repair rate are left for the receiver to repeat.
+ */
+
+static
+void
+nak_limit_repair (
+	pgm_sock_t*		     const restrict sock,
+	const struct sockaddr*	     const restrict addr,
+	const struct pgm_sqn_list_t* const restrict sqn_list
+	)
+{
+	struct sockaddr_storage dst;
+	char* buf = pgm_alloca (sock->max_tpdu);
+
+	memset (&dst, 0, sizeof (dst));
+	memcpy (&dst, addr, pgm_sockaddr_len (addr));
+/* receivers listen for unicast on the unicast encapsulation port */
+	if (sock->udp_encap_ucast_port)
+		((struct sockaddr_in*)&dst)->sin_port = pgm_htons (sock->udp_encap_ucast_port);
+
+	const uint32_t trail = pgm_txw_repair_trail (sock->window);
+	for (uint_fast8_t i = 0; i < sqn_list->len; i++)
+	{
+		struct pgm_sk_buff_t* skb = pgm_txw_get_repair (sock->window, sqn_list->sqn[i]);
+		if (NULL == skb)
+			continue;
+		const size_t tpdu_length = (char*)skb->tail - (char*)skb->head;
+		if (sock->is_controlled_rdata &&
+		    !pgm_rate_check2 (&sock->rate_control, &sock->rdata_rate_control, tpdu_length, TRUE))
+		{
+			pgm_free_skb (skb);
+			break;
+		}
+		const ssize_t sent = send_rdata_unicast (sock, skb, trail, (const struct sockaddr*)&dst, buf);
+		pgm_free_skb (skb);
+		if (sent < 0)
+			break;
+	}
 }
 
 /* NAK requesting RDATA transmission for a sending sock, only valid if
@@ -283,7 +728,8 @@ PGM_GNUC_INTERNAL
 bool
 pgm_on_nak (
 	pgm_sock_t*           const restrict sock,
-	struct pgm_sk_buff_t* const restrict skb
+	struct pgm_sk_buff_t* const restrict skb,
+	const struct sockaddr* const restrict src_addr
 	)
 {
 	const struct pgm_nak	*nak;
@@ -291,29 +737,31 @@ pgm_on_nak (
 	struct sockaddr_storage	 nak_src_nla, nak_grp_nla;
 	const uint32_t		*nak_list = NULL;
 	uint_fast8_t		 nak_list_len = 0;
+	const struct pgm_opt_catchup *opt_catchup = NULL;
 	struct pgm_sqn_list_t	 sqn_list;
 
 /* pre-conditions */
 	pgm_assert (NULL != sock);
 	pgm_assert (NULL != skb);
+	pgm_assert (NULL != src_addr);
 
-	pgm_debug ("pgm_on_nak (sock:%p skb:%p)",
-		(const void*)sock, (const void*)skb);
+	pgm_debug ("pgm_on_nak (sock:%p skb:%p src-addr:%p)",
+		(const void*)sock, (const void*)skb, (const void*)src_addr);
 
 	const bool is_parity = skb->pgm_header->pgm_options & PGM_OPT_PARITY;
 	if (is_parity) {
-		sock->cumulative_stats[PGM_PC_SOURCE_PARITY_NAKS_RECEIVED]++;
+		pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_PARITY_NAKS_RECEIVED);
 		if (!sock->use_ondemand_parity) {
 			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Parity NAK rejected as on-demand parity is not enabled."));
-			sock->cumulative_stats[PGM_PC_SOURCE_MALFORMED_NAKS]++;
+			pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_MALFORMED_NAKS);
 			return FALSE;
 		}
 	} else
-		sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_NAKS_RECEIVED]++;
+		pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_SELECTIVE_NAKS_RECEIVED);
 
 	if (PGM_UNLIKELY(!pgm_verify_nak (skb))) {
 		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Malformed NAK rejected on verification."));
-		sock->cumulative_stats[PGM_PC_SOURCE_MALFORMED_NAKS]++;
+		pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_MALFORMED_NAKS);
 		return FALSE;
 	}
 
@@ -327,18 +775,18 @@ pgm_on_nak (
 		char saddr[INET6_ADDRSTRLEN];
 		pgm_sockaddr_ntop ((struct sockaddr*)&nak_src_nla, saddr, sizeof(saddr));
 		pgm_trace (PGM_LOG_ROLE_NETWORK,_("NAK rejected for unmatched NLA: %s"), saddr);
-		sock->cumulative_stats[PGM_PC_SOURCE_MALFORMED_NAKS]++;
+		pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_MALFORMED_NAKS);
 		return FALSE;
 	}
 
 /* NAK_GRP_NLA containers our sock multicast group */ 
 	pgm_nla_to_sockaddr ((AF_INET6 == nak_src_nla.ss_family) ? &nak6->nak6_grp_nla_afi : &nak->nak_grp_nla_afi, (struct sockaddr*)&nak_grp_nla);
-	if (PGM_UNLIKELY(pgm_sockaddr_cmp ((struct sockaddr*)&nak_grp_nla, (struct sockaddr*)&sock->send_gsr.gsr_group) != 0))
+	if (PGM_UNLIKELY(!is_nak_group (sock, (struct sockaddr*)&nak_grp_nla)))
 	{
 		char sgroup[INET6_ADDRSTRLEN];
 		pgm_sockaddr_ntop ((struct sockaddr*)&nak_src_nla, sgroup, sizeof(sgroup));
 		pgm_trace (PGM_LOG_ROLE_NETWORK,_("NAK rejected as targeted for different multicast group: %s"), sgroup);
-		sock->cumulative_stats[PGM_PC_SOURCE_MALFORMED_NAKS]++;
+		pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_MALFORMED_NAKS);
 		return FALSE;
 	}
 
@@ -351,32 +799,33 @@ pgm_on_nak (
 /* check NAK list */
 	if (skb->pgm_header->pgm_options & PGM_OPT_PRESENT)
 	{
-		const struct pgm_opt_header *opt_header;
-		const struct pgm_opt_length *opt_len;
-
-		opt_len = (AF_INET6 == nak_src_nla.ss_family) ?
-				(const struct pgm_opt_length*)(nak6 + 1) :
-				(const struct pgm_opt_length*)(nak  + 1);
-		if (PGM_UNLIKELY(opt_len->opt_type != PGM_OPT_LENGTH)) {
-			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Malformed NAK rejected on unexpected primary PGM option type."));
-			sock->cumulative_stats[PGM_PC_SOURCE_MALFORMED_NAKS]++;
+		const struct pgm_opt_nak_list* opt_nak_list;
+		const void* opt_start;
+
+		opt_start = (AF_INET6 == nak_src_nla.ss_family) ?
+				(const void*)(nak6 + 1) :
+				(const void*)(nak  + 1);
+		if (PGM_UNLIKELY(!pgm_parse_options (skb, opt_start))) {
+			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Malformed NAK rejected on option extensions."));
+			pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_MALFORMED_NAKS);
 			return FALSE;
 		}
-		if (PGM_UNLIKELY(opt_len->opt_length != sizeof(struct pgm_opt_length))) {
-			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Malformed NAK rejected on length of length option header."));
-			sock->cumulative_stats[PGM_PC_SOURCE_MALFORMED_NAKS]++;
+		opt_nak_list = pgm_opt_body (skb, pgm_opt_desc_const (skb)->opt_nak_list);
+		if (NULL != opt_nak_list) {
+			nak_list = opt_nak_list->opt_sqn;
+			nak_list_len = pgm_opt_nak_list_len (skb);
+		}
+		opt_catchup = pgm_opt_body (skb, pgm_opt_desc_const (skb)->opt_catchup);
+	}
+
+/* catch-up streams are unicast, neither confirmed nor counted as loss */
+	if (NULL != opt_catchup) {
+		if (PGM_UNLIKELY(is_parity)) {
+			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Malformed NAK rejected on catch-up of parity."));
+			pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_MALFORMED_NAKS);
 			return FALSE;
 		}
-/* TODO: check for > 16 options & past packet end */
-		opt_header = (const struct pgm_opt_header*)opt_len;
-		do {
-			opt_header = (const struct pgm_opt_header*)((const char*)opt_header + opt_header->opt_length);
-			if ((opt_header->opt_type & PGM_OPT_MASK) == PGM_OPT_NAK_LIST) {
-				nak_list = ((const struct pgm_opt_nak_list*)(opt_header + 1))->opt_sqn;
-				nak_list_len = ( opt_header->opt_length - sizeof(struct pgm_opt_header) - sizeof(uint8_t) ) / sizeof(uint32_t);
-				break;
-			}
-		} while (!(opt_header->opt_type & PGM_OPT_END));
+		return on_catchup (sock, sqn_list.sqn[0], opt_catchup);
 	}
 
 /* nak list numbers */
@@ -390,6 +839,38 @@ pgm_on_nak (
 		sqn_list.sqn[sqn_list.len++] = pgm_ntohl (*nak_list);
 		nak_list++;
 	}
+	pgm_evtrace (PGM_EV_NAK_RECEIVED, &sock->tsi, sqn_list.sqn[0], sqn_list.len);
+
+/* per-receiver limit, refused sequences are left for the receiver to repeat */
+	if (NULL != sock->nak_limit &&
+	    nak_limit_admit (sock, src_addr, &sqn_list, is_parity, skb->tstamp))
+	{
+		if (PGM_NAK_LIMIT_IGNORE == sock->nak_limit_req.nl_action || is_parity) {
+			pgm_stats_add (&sock->cumulative_stats[PGM_STATS_RX], is_parity ? PGM_PC_SOURCE_PARITY_NAKS_IGNORED : PGM_PC_SOURCE_SELECTIVE_NAKS_IGNORED, sqn_list.len);
+			return TRUE;
+		}
+		nak_limit_repair (sock, src_addr, &sqn_list);
+		return TRUE;
+	}
+	if (PGM_UNLIKELY(0 == sqn_list.len))
+		return TRUE;
+
+/* packets reported lost for adaptive FEC, a parity request carries the count less one */
+	if (sock->use_adaptive_fec) {
+		uint32_t lost = sqn_list.len;
+		if (is_parity) {
+			const uint32_t tg_sqn_mask = 0xffffffff << sock->tg_sqn_shift;
+			for (uint_fast8_t i = 0; i < sqn_list.len; i++)
+				lost += sqn_list.sqn[i] & ~tg_sqn_mask;
+		}
+		pgm_atomic_add32 (&sock->fec_nak_count, lost);
+	}
+
+/* hold requests for the aggregation window, confirmed and queued together */
+	if (sock->nak_pending) {
+		nak_aggregate (sock, &sqn_list, is_parity);
+		return TRUE;
+	}
 
 /* send NAK confirm packet immediately, then defer to timer thread for a.s.a.p
  * delivery of the actual RDATA packets.  blocking send for NCF is ignored as RDATA
@@ -400,128 +881,711 @@ pgm_on_nak (
 	else
 		send_ncf (sock, (struct sockaddr*)&nak_src_nla, (struct sockaddr*)&nak_grp_nla, sqn_list.sqn[0], is_parity);
 
-/* queue retransmit requests */
-	for (uint_fast8_t i = 0; i < sqn_list.len; i++) {
-		const bool push_status = pgm_txw_retransmit_push (sock->window, sqn_list.sqn[i], is_parity, sock->tg_sqn_shift);
-		if (PGM_UNLIKELY(!push_status)) {
-			pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Failed to push retransmit request for #%" PRIu32), sqn_list.sqn[i]);
+/* queue retransmit requests, selective requests by run of consecutive sequence numbers */
+	if (is_parity) {
+		for (uint_fast8_t i = 0; i < sqn_list.len; i++) {
+			const bool push_status = pgm_txw_retransmit_push (sock->window, sqn_list.sqn[i], is_parity, sock->tg_sqn_shift);
+			if (PGM_UNLIKELY(!push_status)) {
+				pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Failed to push retransmit request for #%" PRIu32), sqn_list.sqn[i]);
+			}
 		}
+		return TRUE;
+	}
+	for (uint_fast8_t i = 0; i < sqn_list.len; ) {
+		uint_fast8_t j = i + 1;
+		while (j < sqn_list.len && sqn_list.sqn[j] == sqn_list.sqn[j - 1] + 1)
+			j++;
+		const unsigned run_len = (unsigned)(j - i);
+		const unsigned pushed = pgm_txw_retransmit_push_range (sock->window, sqn_list.sqn[i], run_len);
+		if (PGM_UNLIKELY(pushed < run_len)) {
+			pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Failed to push %u of %u retransmit requests from #%" PRIu32),
+				run_len - pushed, run_len, sqn_list.sqn[i]);
+		}
+		i = j;
 	}
 	return TRUE;
 }
 
-/* Null-NAK, or N-NAK propogated by a DLR for hand waving excitement
+/* PGM_CATCHUP request of a late joining receiver, replaces any stream already
+ * serving the same receiver.  requests are ignored when PGM_CATCHUP_RATE is not
+ * set or every stream is busy, the receiver falls back to NAKs.
  *
- * if NNAK is valid, returns TRUE.  on error, FALSE is returned.
+ * returns TRUE on valid request, FALSE on malformed request.
  */
 
-PGM_GNUC_INTERNAL
+static
 bool
-pgm_on_nnak (
-	pgm_sock_t*           const restrict sock,
-	struct pgm_sk_buff_t* const restrict skb
+on_catchup (
+	pgm_sock_t*		     const restrict sock,
+	const uint32_t				    first,
+	const struct pgm_opt_catchup* const restrict opt_catchup
 	)
 {
-	const struct pgm_nak	*nnak;
-	const struct pgm_nak6	*nnak6;
-	struct sockaddr_storage	 nnak_src_nla, nnak_grp_nla;
-	uint_fast8_t		 nnak_list_len = 0;
+	struct sockaddr_storage	 addr;
+	struct pgm_catchup_t	*session = NULL;
 
 /* pre-conditions */
 	pgm_assert (NULL != sock);
-	pgm_assert (NULL != skb);
-
-	pgm_debug ("pgm_on_nnak (sock:%p skb:%p)",
-		(void*)sock, (void*)skb);
-
-	sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_NNAK_PACKETS_RECEIVED]++;
-
-	if (PGM_UNLIKELY(!pgm_verify_nnak (skb))) {
-		sock->cumulative_stats[PGM_PC_SOURCE_NNAK_ERRORS]++;
-		return FALSE;
-	}
-
-	nnak  = (struct pgm_nak *)skb->data;
-	nnak6 = (struct pgm_nak6*)skb->data;
-		
-/* NAK_SRC_NLA contains our sock unicast NLA */
-	pgm_nla_to_sockaddr (&nnak->nak_src_nla_afi, (struct sockaddr*)&nnak_src_nla);
+	pgm_assert (NULL != opt_catchup);
 
-	if (PGM_UNLIKELY(pgm_sockaddr_cmp ((struct sockaddr*)&nnak_src_nla, (struct sockaddr*)&sock->send_addr) != 0))
+	const uint32_t count = pgm_ntohl (opt_catchup->catchup_count);
+	const uint16_t nla_afi = pgm_ntohs (opt_catchup->opt_nla_afi);
+	if (PGM_UNLIKELY(0 == count || count > ((UINT32_MAX/2)-1) ||
+			 (AFI_IP != nla_afi && AFI_IP6 != nla_afi)))
 	{
-		sock->cumulative_stats[PGM_PC_SOURCE_NNAK_ERRORS]++;
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Malformed NAK rejected on catch-up option."));
+		pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_MALFORMED_NAKS);
 		return FALSE;
 	}
-
-/* NAK_GRP_NLA containers our sock multicast group */ 
-	pgm_nla_to_sockaddr ((AF_INET6 == nnak_src_nla.ss_family) ? &nnak6->nak6_grp_nla_afi : &nnak->nak_grp_nla_afi, (struct sockaddr*)&nnak_grp_nla);
-	if (PGM_UNLIKELY(pgm_sockaddr_cmp ((struct sockaddr*)&nnak_grp_nla, (struct sockaddr*)&sock->send_gsr.gsr_group) != 0))
-	{
-		sock->cumulative_stats[PGM_PC_SOURCE_NNAK_ERRORS]++;
-		return FALSE;
+	if (NULL == sock->catchup) {
+		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Catch-up request ignored as PGM_CATCHUP_RATE is not set."));
+		pgm_stats_add (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_SELECTIVE_NAKS_IGNORED, count);
+		return TRUE;
 	}
 
-/* check NNAK list */
-	if (skb->pgm_header->pgm_options & PGM_OPT_PRESENT)
-	{
-		const struct pgm_opt_length* opt_len = (AF_INET6 == nnak_src_nla.ss_family) ?
-							(const struct pgm_opt_length*)(nnak6 + 1) :
-							(const struct pgm_opt_length*)(nnak + 1);
-		if (PGM_UNLIKELY(opt_len->opt_type != PGM_OPT_LENGTH)) {
-			sock->cumulative_stats[PGM_PC_SOURCE_NNAK_ERRORS]++;
-			return FALSE;
+	memset (&addr, 0, sizeof (addr));
+	pgm_nla_to_sockaddr (&opt_catchup->opt_nla_afi, (struct sockaddr*)&addr);
+/* receivers listen for unicast on the unicast encapsulation port */
+	if (sock->udp_encap_ucast_port)
+		((struct sockaddr_in*)&addr)->sin_port = pgm_htons (sock->udp_encap_ucast_port);
+
+	pgm_sock_mutex_lock (sock, &sock->catchup_mutex);
+	for (unsigned i = 0; i < sock->catchup_len; i++)
+		if (0 == pgm_sockaddr_cmp ((struct sockaddr*)&sock->catchup[ i ].addr, (struct sockaddr*)&addr)) {
+			session = &sock->catchup[ i ];
+			break;
 		}
-		if (PGM_UNLIKELY(opt_len->opt_length != sizeof(struct pgm_opt_length))) {
-			sock->cumulative_stats[PGM_PC_SOURCE_NNAK_ERRORS]++;
-			return FALSE;
-		}
-/* TODO: check for > 16 options & past packet end */
-		const struct pgm_opt_header* opt_header = (const struct pgm_opt_header*)opt_len;
-		do {
-			opt_header = (const struct pgm_opt_header*)((const char*)opt_header + opt_header->opt_length);
-			if ((opt_header->opt_type & PGM_OPT_MASK) == PGM_OPT_NAK_LIST) {
-				nnak_list_len = ( opt_header->opt_length - sizeof(struct pgm_opt_header) - sizeof(uint8_t) ) / sizeof(uint32_t);
-				break;
-			}
-		} while (!(opt_header->opt_type & PGM_OPT_END));
+	if (NULL == session && sock->catchup_len < PGM_CATCHUP_MAX)
+		session = &sock->catchup[ sock->catchup_len++ ];
+	if (NULL == session) {
+		pgm_sock_mutex_unlock (sock, &sock->catchup_mutex);
+		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Catch-up request ignored with %u streams active."), PGM_CATCHUP_MAX);
+		pgm_stats_add (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_SELECTIVE_NAKS_IGNORED, count);
+		return TRUE;
 	}
-
-	sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_NNAKS_RECEIVED] += 1 + nnak_list_len;
+	memcpy (&session->addr, &addr, sizeof (addr));
+	session->next = first;
+	session->end  = first + count;
+	pgm_sock_mutex_unlock (sock, &sock->catchup_mutex);
+
+	pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Catch-up of %" PRIu32 " sequences from #%" PRIu32 "."), count, first);
+	pgm_sock_mutex_lock (sock, &sock->timer_mutex);
+	source_wake_timer (sock, pgm_time_update_now());
+	pgm_sock_mutex_unlock (sock, &sock->timer_mutex);
 	return TRUE;
 }
 
-/* ACK, sent upstream by one selected ACKER for congestion control feedback.
+/* poll the primary writing the transmit window store for PGM_STANDBY, taking over the
+ * store once the primary process has exited or the store stalls beyond sb_timeout.
+ * the window resumes after the last stored sequence and repairs from the store, the
+ * SPM due on return announces this host as the source NLA.
  *
- * if ACK is valid, returns TRUE.  on error, FALSE is returned.
+ * returns time of the next poll, or 0 once the session is taken over.
  */
 
 PGM_GNUC_INTERNAL
-bool
-pgm_on_ack (
-	pgm_sock_t*           const restrict sock,
-	struct pgm_sk_buff_t* const restrict skb
+pgm_time_t
+pgm_on_standby (
+	pgm_sock_t* const	sock,
+	const pgm_time_t	now
 	)
 {
-	const struct pgm_ack	*ack;
-	bool			 is_acker = FALSE;
-	uint32_t		 ack_bitmap;
-	unsigned		 new_acks;
+	uint32_t lead, spm_sqn, sqns;
+	uint16_t max_tpdu;
+	pgm_tsi_t tsi;
 
 /* pre-conditions */
 	pgm_assert (NULL != sock);
-	pgm_assert (NULL != skb);
+	pgm_assert (NULL != sock->standby);
+
+	if (!pgm_txw_store_resume (sock->standby, &lead, &spm_sqn))
+		lead = spm_sqn = 0;
+	if (lead != sock->standby_lead || spm_sqn != sock->standby_spm_sqn) {
+		sock->standby_lead	= lead;
+		sock->standby_spm_sqn	= spm_sqn;
+		sock->standby_progress	= now;
+	}
+	const bool is_stalled = (0 != sock->standby_req.sb_timeout &&
+				 pgm_time_after_eq (now, sock->standby_progress + pgm_usecs (sock->standby_req.sb_timeout)));
+	if (!is_stalled && pgm_txw_store_is_owned (sock->standby))
+		return now + pgm_usecs (sock->standby_req.sb_ivl);
+
+	pgm_error_t* store_error = NULL;
+	pgm_txw_store_geometry (sock->standby, &tsi, &sqns, &max_tpdu);
+	struct pgm_txw_store_t* store = pgm_txw_store_open (sock->txw_store_req.ts_path,
+							    &sock->tsi,
+							    sock->max_tpdu,
+							    sqns,
+							    &store_error);
+	if (PGM_UNLIKELY(NULL == store)) {
+		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Standby cannot take over transmit window store: %s"),
+			   store_error ? store_error->message : "(null)");
+		pgm_error_free (store_error);
+		return now + pgm_usecs (sock->standby_req.sb_ivl);
+	}
+	pgm_txw_store_close (sock->standby);
+	sock->standby = NULL;
+	if (pgm_txw_store_resume (store, &lead, &spm_sqn)) {
+		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Standby taking over %s primary after #%" PRIu32 "."),
+			   is_stalled ? "stalled" : "exited", lead);
+		sock->spm_sqn = spm_sqn + 1;
+	}
+	pgm_txw_set_store (sock->window, store);
+	sock->txw_store = store;
+	sock->next_ambient_spm = now;
+/* full barrier, the window and store precede release of the send calls */
+	(void)pgm_atomic_exchange32 (&sock->is_standby, 0);
+	return 0;
+}
 
-	pgm_debug ("pgm_on_ack (sock:%p skb:%p)",
-		(const void*)sock, (const void*)skb);
+/* send one batch of each catch-up stream as unicast RDATA within PGM_CATCHUP_RATE.
+ * packets are copied out of the transmit window so that the shared skbuff is
+ * not rewritten outside of the repair path, sequences no longer retained are
+ * skipped and left to NAKs.
+ *
+ * returns time of the next batch, or 0 when every stream is complete.
+ */
 
-	sock->cumulative_stats[PGM_PC_SOURCE_ACK_PACKETS_RECEIVED]++;
+PGM_GNUC_INTERNAL
+pgm_time_t
+pgm_on_catchup (
+	pgm_sock_t* const	sock
+	)
+{
+	char*		buf;
+	pgm_time_t	expiry = 0;
+	size_t		blocklen = 0;
 
-	if (PGM_UNLIKELY(!pgm_verify_ack (skb))) {
-		sock->cumulative_stats[PGM_PC_SOURCE_ACK_ERRORS]++;
-		return FALSE;
-	}
+/* pre-conditions */
+	pgm_assert (NULL != sock);
 
+	pgm_debug ("pgm_on_catchup (sock:%p)", (const void*)sock);
+
+	buf = pgm_alloca (sock->max_tpdu);
+	pgm_sock_mutex_lock (sock, &sock->catchup_mutex);
+	for (unsigned i = 0; i < sock->catchup_len && 0 == blocklen; )
+	{
+		struct pgm_catchup_t* session = &sock->catchup[ i ];
+		const uint32_t trail = pgm_txw_repair_trail (sock->window);
+		if (pgm_uint32_lt (session->next, trail))
+			session->next = trail;
+		for (unsigned j = 0; j < PGM_CATCHUP_BATCH && pgm_uint32_lt (session->next, session->end); j++)
+		{
+			struct pgm_sk_buff_t* skb = pgm_txw_get_repair (sock->window, session->next);
+			if (NULL == skb) {
+				if (pgm_uint32_gt (session->next, pgm_txw_lead_atomic (sock->window)))
+					session->end = session->next;
+				else
+					session->next++;
+				continue;
+			}
+			const size_t tpdu_length = (char*)skb->tail - (char*)skb->head;
+			if (!pgm_rate_check (&sock->catchup_rate_control, tpdu_length, TRUE)) {
+				pgm_free_skb (skb);
+				blocklen = tpdu_length;
+				break;
+			}
+			const ssize_t sent = send_rdata_unicast (sock, skb, trail, (struct sockaddr*)&session->addr, buf);
+			pgm_free_skb (skb);
+			if (sent < 0) {
+				const int save_errno = pgm_get_last_sock_error();
+				if (PGM_LIKELY(PGM_SOCK_EAGAIN == save_errno || PGM_SOCK_ENOBUFS == save_errno)) {
+					blocklen = tpdu_length;
+					break;
+				}
+			}
+			session->next++;
+		}
+/* completed streams take the place of the last */
+		if (!pgm_uint32_lt (session->next, session->end)) {
+			pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Catch-up stream complete at #%" PRIu32 "."), session->end);
+			if (i != --sock->catchup_len)
+				memcpy (session, &sock->catchup[ sock->catchup_len ], sizeof (struct pgm_catchup_t));
+		} else
+			i++;
+	}
+	if (sock->catchup_len)
+		expiry = pgm_time_update_now() + (blocklen ? pgm_rate_remaining (&sock->catchup_rate_control, blocklen) : 0);
+	pgm_sock_mutex_unlock (sock, &sock->catchup_mutex);
+	return expiry;
+}
+
+/* NAK aggregation of PGM_NAK_AGGREGATE_IVL, requests from every receiver within the
+ * window are sorted by sequence so that the oldest data, closest to leaving the
+ * transmit window, is repaired first.  duplicates collapse to one NCF entry and one
+ * retransmit request.  with on-demand parity a transmission group is repaired with
+ * parity when fewer packets cover every NAK than the distinct sequences requested,
+ * as each NAK originates from one receiver.
+ */
+
+static
+int
+nak_req_cmp (
+	const void*		a,
+	const void*		b
+	)
+{
+	const struct pgm_nak_req_t* req_a = a;
+	const struct pgm_nak_req_t* req_b = b;
+
+/* serial number order, parity requests carry the group lead */
+	const int32_t delta = (int32_t)(req_a->sqn - req_b->sqn);
+	if (delta)
+		return delta < 0 ? -1 : 1;
+	return (int)req_b->is_parity - (int)req_a->is_parity;
+}
+
+/* broadcast NCF list, a single sequence as a plain NCF.
+ */
+
+static
+void
+nak_aggregate_ncf (
+	pgm_sock_t*		     const restrict sock,
+	struct pgm_sqn_list_t* const restrict sqn_list,
+	const bool				is_parity
+	)
+{
+	if (0 == sqn_list->len)
+		return;
+	if (1 == sqn_list->len)
+		send_ncf (sock, (struct sockaddr*)&sock->send_addr, (struct sockaddr*)&sock->send_gsr.gsr_group, sqn_list->sqn[0], is_parity);
+	else
+		send_ncf_list (sock, (struct sockaddr*)&sock->send_addr, (struct sockaddr*)&sock->send_gsr.gsr_group, sqn_list, is_parity);
+	sqn_list->len = 0;
+}
+
+/* queue a run of selective repairs.
+ */
+
+static inline
+void
+nak_aggregate_push_range (
+	pgm_sock_t*	const	sock,
+	const uint32_t		first,
+	const uint32_t		count
+	)
+{
+	if (0 == count)
+		return;
+	const unsigned pushed = pgm_txw_retransmit_push_range (sock->window, first, count);
+	if (PGM_UNLIKELY(pushed < count)) {
+		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Failed to push %u of %u retransmit requests from #%" PRIu32),
+			(unsigned)count - pushed, (unsigned)count, first);
+	}
+}
+
+/* confirm and queue all pending requests, called with nak_mutex held.
+ */
+
+static
+void
+nak_aggregate_flush (
+	pgm_sock_t* const	sock
+	)
+{
+	struct pgm_sqn_list_t selective = { .len = 0 }, parity = { .len = 0 };
+	uint32_t run_first = 0, run_len = 0;
+	uint32_t last_sqn = 0;
+	bool has_last = FALSE;
+
+	const uint32_t tg_sqn_mask = 0xffffffff << sock->tg_sqn_shift;
+	const struct pgm_nak_req_t* req = sock->nak_pending;
+	const struct pgm_nak_req_t* const end = req + sock->nak_pending_len;
+
+	pgm_debug ("nak_aggregate_flush (sock:%p len:%u)", (const void*)sock, sock->nak_pending_len);
+
+	qsort (sock->nak_pending, sock->nak_pending_len, sizeof (struct pgm_nak_req_t), nak_req_cmp);
+
+	while (req < end)
+	{
+/* one transmission group at a time */
+		const uint32_t tg_sqn = req->sqn & tg_sqn_mask;
+		const struct pgm_nak_req_t* tg_end = req;
+		bool has_parity = FALSE;
+		unsigned tg_count = 0, distinct = 0;
+		for (uint32_t last = 0; tg_end < end && tg_sqn == (tg_end->sqn & tg_sqn_mask); tg_end++)
+		{
+			if (tg_end->is_parity) {
+				has_parity = TRUE;
+			} else if (0 == distinct || tg_end->sqn != last) {
+				distinct++;
+				last = tg_end->sqn;
+			}
+			tg_count = MAX(tg_count, tg_end->tg_count);
+		}
+
+		if (has_parity || (sock->use_ondemand_parity && tg_count < distinct))
+		{
+			const uint32_t nak_sqn = tg_sqn | (tg_count - 1);
+			nak_aggregate_push_range (sock, run_first, run_len);
+			run_len = 0;
+			parity.sqn[ parity.len++ ] = nak_sqn;
+			if (PGM_N_ELEMENTS(parity.sqn) == parity.len)
+				nak_aggregate_ncf (sock, &parity, TRUE);
+			if (PGM_UNLIKELY(!pgm_txw_retransmit_push (sock->window, nak_sqn, TRUE, sock->tg_sqn_shift))) {
+				pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Failed to push retransmit request for #%" PRIu32), nak_sqn);
+			}
+			req = tg_end;
+			continue;
+		}
+
+		for (; req < tg_end; req++)
+		{
+			if (has_last && req->sqn == last_sqn)
+				continue;
+			has_last = TRUE;
+			last_sqn = req->sqn;
+			selective.sqn[ selective.len++ ] = req->sqn;
+			if (PGM_N_ELEMENTS(selective.sqn) == selective.len)
+				nak_aggregate_ncf (sock, &selective, FALSE);
+			if (run_len && req->sqn == run_first + run_len) {
+				run_len++;
+			} else {
+				nak_aggregate_push_range (sock, run_first, run_len);
+				run_first = req->sqn;
+				run_len = 1;
+			}
+		}
+	}
+	nak_aggregate_push_range (sock, run_first, run_len);
+	nak_aggregate_ncf (sock, &selective, FALSE);
+	nak_aggregate_ncf (sock, &parity, TRUE);
+
+	sock->nak_pending_len = 0;
+	sock->nak_aggregate_expiry = 0;
+}
+
+/* add the sequences of one NAK to the aggregation window, flushing first when
+ * they do not fit.
+ */
+
+static
+void
+nak_aggregate (
+	pgm_sock_t*		     const restrict sock,
+	const struct pgm_sqn_list_t* const restrict sqn_list,
+	const bool				    is_parity
+	)
+{
+	const uint32_t tg_sqn_mask = 0xffffffff << sock->tg_sqn_shift;
+
+	pgm_sock_mutex_lock (sock, &sock->nak_mutex);
+	if (sock->nak_pending_len + sqn_list->len > PGM_NAK_AGGREGATE_MAX)
+		nak_aggregate_flush (sock);
+	for (uint_fast8_t i = 0; i < sqn_list->len; i++)
+	{
+		struct pgm_nak_req_t* req = &sock->nak_pending[ sock->nak_pending_len++ ];
+		req->is_parity = is_parity;
+		if (is_parity) {
+			req->sqn      = sqn_list->sqn[i] & tg_sqn_mask;
+			req->tg_count = (uint8_t)((sqn_list->sqn[i] & ~tg_sqn_mask) + 1);
+			continue;
+		}
+		req->sqn      = sqn_list->sqn[i];
+		req->tg_count = 0;
+		for (uint_fast8_t j = 0; j < sqn_list->len; j++)
+			if ((sqn_list->sqn[j] & tg_sqn_mask) == (req->sqn & tg_sqn_mask))
+				req->tg_count++;
+	}
+	if (0 == sock->nak_aggregate_expiry) {
+		sock->nak_aggregate_expiry = pgm_time_update_now() + sock->nak_aggregate_ivl;
+		pgm_sock_mutex_lock (sock, &sock->timer_mutex);
+		source_wake_timer (sock, sock->nak_aggregate_expiry);
+		pgm_sock_mutex_unlock (sock, &sock->timer_mutex);
+	}
+	pgm_sock_mutex_unlock (sock, &sock->nak_mutex);
+}
+
+/* timer expiry of the NAK aggregation window.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_on_nak_aggregate_expiry (
+	pgm_sock_t* const	sock
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+
+	pgm_debug ("pgm_on_nak_aggregate_expiry (sock:%p)", (const void*)sock);
+
+	pgm_sock_mutex_lock (sock, &sock->nak_mutex);
+	if (sock->nak_pending_len &&
+	    pgm_time_after_eq (pgm_time_update_now(), sock->nak_aggregate_expiry))
+	{
+		nak_aggregate_flush (sock);
+	}
+	pgm_sock_mutex_unlock (sock, &sock->nak_mutex);
+}
+
+/* Null-NAK, or N-NAK propogated by a DLR for hand waving excitement
+ *
+ * if NNAK is valid, returns TRUE.  on error, FALSE is returned.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_on_nnak (
+	pgm_sock_t*           const restrict sock,
+	struct pgm_sk_buff_t* const restrict skb
+	)
+{
+	const struct pgm_nak	*nnak;
+	const struct pgm_nak6	*nnak6;
+	struct sockaddr_storage	 nnak_src_nla, nnak_grp_nla;
+	uint_fast8_t		 nnak_list_len = 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != skb);
+
+	pgm_debug ("pgm_on_nnak (sock:%p skb:%p)",
+		(void*)sock, (void*)skb);
+
+	pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_SELECTIVE_NNAK_PACKETS_RECEIVED);
+
+	if (PGM_UNLIKELY(!pgm_verify_nnak (skb))) {
+		pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_NNAK_ERRORS);
+		return FALSE;
+	}
+
+	nnak  = (struct pgm_nak *)skb->data;
+	nnak6 = (struct pgm_nak6*)skb->data;
+		
+/* NAK_SRC_NLA contains our sock unicast NLA */
+	pgm_nla_to_sockaddr (&nnak->nak_src_nla_afi, (struct sockaddr*)&nnak_src_nla);
+
+	if (PGM_UNLIKELY(pgm_sockaddr_cmp ((struct sockaddr*)&nnak_src_nla, (struct sockaddr*)&sock->send_addr) != 0))
+	{
+		pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_NNAK_ERRORS);
+		return FALSE;
+	}
+
+/* NAK_GRP_NLA containers our sock multicast group */ 
+	pgm_nla_to_sockaddr ((AF_INET6 == nnak_src_nla.ss_family) ? &nnak6->nak6_grp_nla_afi : &nnak->nak_grp_nla_afi, (struct sockaddr*)&nnak_grp_nla);
+	if (PGM_UNLIKELY(!is_nak_group (sock, (struct sockaddr*)&nnak_grp_nla)))
+	{
+		pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_NNAK_ERRORS);
+		return FALSE;
+	}
+
+/* check NNAK list */
+	if (skb->pgm_header->pgm_options & PGM_OPT_PRESENT)
+	{
+		const void* opt_start = (AF_INET6 == nnak_src_nla.ss_family) ?
+						(const void*)(nnak6 + 1) :
+						(const void*)(nnak + 1);
+		if (PGM_UNLIKELY(!pgm_parse_options (skb, opt_start))) {
+			pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_NNAK_ERRORS);
+			return FALSE;
+		}
+		nnak_list_len = pgm_opt_nak_list_len (skb);
+	}
+
+	pgm_stats_add (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_SELECTIVE_NNAKS_RECEIVED, 1 + nnak_list_len);
+	return TRUE;
+}
+
+/* ACK with OPT_ACK_TRAIL, a receiver reports its contiguous lead.  reporters
+ * silent for PGM_ACK_TRAIL_EXPIRY_IVLS report intervals are forgotten, the
+ * transmit window releases only data held by the slowest remaining reporter
+ * and only with at least at_receivers reporting.
+ *
+ * returns TRUE on valid report, FALSE on malformed report.
+ */
+
+static
+bool
+on_ack_trail (
+	pgm_sock_t*			const restrict sock,
+	const uint32_t				       lead,
+	const struct pgm_opt_ack_trail* const restrict opt_ack_trail,
+	const pgm_time_t			       now
+	)
+{
+	struct sockaddr_storage	 addr;
+	struct pgm_ack_trail_t	*reporter = NULL;
+	uint32_t		 trail;
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != opt_ack_trail);
+
+	const uint16_t nla_afi = pgm_ntohs (opt_ack_trail->opt_nla_afi);
+	if (PGM_UNLIKELY(AFI_IP != nla_afi && AFI_IP6 != nla_afi)) {
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Malformed ACK rejected on trail option."));
+		pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_ACK_ERRORS);
+		return FALSE;
+	}
+	if (NULL == sock->ack_trail) {
+		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("ACK trail report ignored as PGM_ACK_TRAIL is not set."));
+		return TRUE;
+	}
+
+	memset (&addr, 0, sizeof (addr));
+	pgm_nla_to_sockaddr (&opt_ack_trail->opt_nla_afi, (struct sockaddr*)&addr);
+
+/* find the reporter, forgetting silent reporters */
+	for (unsigned i = 0; i < sock->ack_trail_len; )
+	{
+		struct pgm_ack_trail_t* r = &sock->ack_trail[ i ];
+		if (0 == pgm_sockaddr_cmp ((struct sockaddr*)&r->addr, (struct sockaddr*)&addr)) {
+			reporter = r;
+		} else if (pgm_time_after_eq (now, r->expiry)) {
+			pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("ACK trail reporter expired at #%" PRIu32 "."), r->lead);
+			if (i != --sock->ack_trail_len)
+				memcpy (r, &sock->ack_trail[ sock->ack_trail_len ], sizeof (struct pgm_ack_trail_t));
+			continue;
+		}
+		i++;
+	}
+	if (NULL == reporter) {
+		if (sock->ack_trail_len == PGM_ACK_TRAIL_MAX) {
+			pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("ACK trail report ignored with %u receivers reporting."), PGM_ACK_TRAIL_MAX);
+			return TRUE;
+		}
+		reporter = &sock->ack_trail[ sock->ack_trail_len++ ];
+		memcpy (&reporter->addr, &addr, sizeof (addr));
+		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("New ACK trail reporter at #%" PRIu32 "."), lead);
+	}
+	reporter->lead   = lead;
+	reporter->expiry = now + (PGM_ACK_TRAIL_EXPIRY_IVLS * pgm_usecs (sock->ack_trail_req.at_ivl));
+
+	if (sock->ack_trail_len < MAX(1, sock->ack_trail_req.at_receivers)) {
+		pgm_txw_update_ack_trail (sock->window, FALSE, 0);
+		return TRUE;
+	}
+	trail = sock->ack_trail[ 0 ].lead;
+	for (unsigned i = 1; i < sock->ack_trail_len; i++)
+		if (pgm_uint32_lt (sock->ack_trail[ i ].lead, trail))
+			trail = sock->ack_trail[ i ].lead;
+	pgm_txw_update_ack_trail (sock->window, TRUE, trail);
+	return TRUE;
+}
+
+/* OPT_CREDIT report of PGM_CREDIT, the receiver can take its read rate plus its
+ * unused window over one report interval.  the election set keeps the slowest
+ * reporters, a faster newcomer is ignored once it is full, and the ODATA rate is
+ * limited to its slowest member.
+ *
+ * returns TRUE on valid report, FALSE on malformed report.
+ */
+
+static
+bool
+on_credit (
+	pgm_sock_t*		     const restrict sock,
+	const struct pgm_opt_credit* const restrict opt_credit,
+	const pgm_time_t			    now
+	)
+{
+	struct sockaddr_storage	 addr;
+	struct pgm_credit_t	*reporter = NULL;
+	ssize_t			 rate;
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != opt_credit);
+
+	const uint16_t nla_afi = pgm_ntohs (opt_credit->opt_nla_afi);
+	if (PGM_UNLIKELY(AFI_IP != nla_afi && AFI_IP6 != nla_afi)) {
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Malformed ACK rejected on credit option."));
+		pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_ACK_ERRORS);
+		return FALSE;
+	}
+	if (NULL == sock->credit || !sock->is_controlled_odata) {
+		pgm_trace (PGM_LOG_ROLE_RATE_CONTROL,_("Credit report ignored as PGM_CREDIT is not set."));
+		return TRUE;
+	}
+
+	memset (&addr, 0, sizeof (addr));
+	pgm_nla_to_sockaddr (&opt_credit->opt_nla_afi, (struct sockaddr*)&addr);
+	rate = (ssize_t)MIN((uint64_t)pgm_ntohl (opt_credit->opt_read_rate) +
+			    ((uint64_t)pgm_ntohl (opt_credit->opt_free_sqns) * sock->max_tpdu * UINT64_C(1000000)) / sock->credit_req.cr_ivl,
+			    (uint64_t)SSIZE_MAX);
+
+/* find the reporter and the fastest member, forgetting silent reporters */
+	const unsigned set_len = sock->credit_req.cr_receivers ? sock->credit_req.cr_receivers : PGM_CREDIT_MAX;
+	struct pgm_credit_t* fastest = NULL;
+	for (unsigned i = 0; i < sock->credit_len; )
+	{
+		struct pgm_credit_t* r = &sock->credit[ i ];
+		if (0 == pgm_sockaddr_cmp ((struct sockaddr*)&r->addr, (struct sockaddr*)&addr)) {
+			reporter = r;
+		} else if (pgm_time_after_eq (now, r->expiry)) {
+			pgm_trace (PGM_LOG_ROLE_RATE_CONTROL,_("Credit reporter expired at %" PRIzd " bytes per second."), r->rate);
+			if (i != --sock->credit_len)
+				memcpy (r, &sock->credit[ sock->credit_len ], sizeof (struct pgm_credit_t));
+			continue;
+		} else if (NULL == fastest || r->rate > fastest->rate) {
+			fastest = r;
+		}
+		i++;
+	}
+	if (NULL == reporter) {
+		if (sock->credit_len < set_len) {
+			reporter = &sock->credit[ sock->credit_len++ ];
+		} else if (NULL != fastest && rate < fastest->rate) {
+			reporter = fastest;
+		} else {
+			return TRUE;
+		}
+		memcpy (&reporter->addr, &addr, sizeof (addr));
+		pgm_trace (PGM_LOG_ROLE_RATE_CONTROL,_("New credit reporter at %" PRIzd " bytes per second."), rate);
+	}
+	reporter->rate   = rate;
+	reporter->expiry = now + (PGM_CREDIT_EXPIRY_IVLS * pgm_usecs (sock->credit_req.cr_ivl));
+
+	rate = sock->credit[ 0 ].rate;
+	for (unsigned i = 1; i < sock->credit_len; i++)
+		if (sock->credit[ i ].rate < rate)
+			rate = sock->credit[ i ].rate;
+	sock->credit_rate = rate;
 	if (!sock->use_pgmcc)
+		pgm_rate_set (&sock->odata_rate_control,
+			      MAX(MIN(rate, sock->odata_max_rte), (ssize_t)sock->max_tpdu),
+			      sock->use_pacing,
+			      sock->max_tpdu);
+	return TRUE;
+}
+
+/* ACK, sent upstream by one selected ACKER for congestion control feedback,
+ * or by a receiver of PGM_ACK_TRAIL reporting its contiguous lead, or of
+ * PGM_CREDIT reporting its credit.
+ *
+ * if ACK is valid, returns TRUE.  on error, FALSE is returned.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_on_ack (
+	pgm_sock_t*           const restrict sock,
+	struct pgm_sk_buff_t* const restrict skb
+	)
+{
+	const struct pgm_ack	*ack;
+	bool			 is_acker = FALSE;
+	uint32_t		 ack_bitmap;
+	unsigned		 new_acks;
+	uint32_t		 rtt = 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != skb);
+
+	pgm_debug ("pgm_on_ack (sock:%p skb:%p)",
+		(const void*)sock, (const void*)skb);
+
+	pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_ACK_PACKETS_RECEIVED);
+
+	if (PGM_UNLIKELY(!pgm_verify_ack (skb))) {
+		pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_ACK_ERRORS);
+		return FALSE;
+	}
+
+	if (!sock->use_pgmcc && NULL == sock->ack_trail && NULL == sock->credit)
 		return FALSE;
 
 	ack = (struct pgm_ack*)skb->data;
@@ -529,29 +1593,28 @@ pgm_on_ack (
 /* check PGMCC feedback option for new elections */
 	if (skb->pgm_header->pgm_options & PGM_OPT_PRESENT)
 	{
-		const struct pgm_opt_header *opt_header;
-		const struct pgm_opt_length *opt_len;
+		const struct pgm_opt_pgmcc_feedback* opt_pgmcc_feedback;
+		const struct pgm_opt_ack_trail* opt_ack_trail;
+		const struct pgm_opt_credit* opt_credit;
 
-		opt_len = (const struct pgm_opt_length*)(ack + 1);
-		if (PGM_UNLIKELY(opt_len->opt_type != PGM_OPT_LENGTH)) {
+		if (PGM_UNLIKELY(!pgm_parse_options (skb, ack + 1))) {
 			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Malformed ACK rejected."));
 			return FALSE;
 		}
-		if (PGM_UNLIKELY(opt_len->opt_length != sizeof(struct pgm_opt_length))) {
-			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Malformed ACK rejected."));
-			return FALSE;
-		}
-		opt_header = (const struct pgm_opt_header*)opt_len;
-		do {
-			opt_header = (const struct pgm_opt_header*)((const char*)opt_header + opt_header->opt_length);
-			if ((opt_header->opt_type & PGM_OPT_MASK) == PGM_OPT_PGMCC_FEEDBACK) {
-				const struct pgm_opt_pgmcc_feedback* opt_pgmcc_feedback = (const struct pgm_opt_pgmcc_feedback*)(opt_header + 1);
-				is_acker = on_opt_pgmcc_feedback (sock, skb, opt_pgmcc_feedback);
-				break;	/* ignore other options */
-			}
-		} while (!(opt_header->opt_type & PGM_OPT_END));
+		opt_ack_trail = pgm_opt_body (skb, pgm_opt_desc_const (skb)->opt_ack_trail);
+		if (NULL != opt_ack_trail)
+			return on_ack_trail (sock, pgm_ntohl (ack->ack_rx_max), opt_ack_trail, skb->tstamp);
+		opt_credit = pgm_opt_body (skb, pgm_opt_desc_const (skb)->opt_credit);
+		if (NULL != opt_credit)
+			return on_credit (sock, opt_credit, skb->tstamp);
+		opt_pgmcc_feedback = pgm_opt_body (skb, pgm_opt_desc_const (skb)->opt_pgmcc_feedback);
+		if (NULL != opt_pgmcc_feedback && sock->use_pgmcc)
+			is_acker = on_opt_pgmcc_feedback (sock, skb, opt_pgmcc_feedback, &rtt);
 	}
 
+	if (!sock->use_pgmcc)
+		return FALSE;
+
 /* ignore ACKs from other receivers or sessions */
 	if (!is_acker)
 		return TRUE;
@@ -585,10 +1648,7 @@ pgm_on_ack (
 	{
 		if (pgm_uint32_lte (ack_rx_max, sock->suspended_sqn))
 		{
-			pgm_trace (PGM_LOG_ROLE_CONGESTION_CONTROL,_("PGMCC window token manipulation suspended due to congestion (T:%u W:%u)"),
-				   pgm_fp8tou (sock->tokens), pgm_fp8tou (sock->cwnd_size));
-			const uint_fast32_t token_inc = pgm_fp8mul (pgm_fp8 (new_acks), pgm_fp8 (1) + pgm_fp8div (pgm_fp8 (1), sock->cwnd_size));
-			sock->tokens = MIN( sock->tokens + token_inc, sock->cwnd_size );
+			sock->cc->on_ack (sock, skb->tstamp, new_acks, rtt, TRUE);
 			goto notify_tx;
 		}
 		sock->is_congested = FALSE;
@@ -597,58 +1657,44 @@ pgm_on_ack (
 /* count outstanding lost sequences */
 	const unsigned total_lost = _pgm_popcount (~sock->ack_bitmap);
 
-/* no detected data loss at ACKer, increase congestion window size */
+/* no detected data loss at ACKer */
 	if (0 == total_lost)
 	{
-		uint_fast32_t n, token_inc;
-
 		new_acks += sock->acks_after_loss;
 		sock->acks_after_loss = 0;
-		n = pgm_fp8 (new_acks);
-		token_inc = 0;
-
-/* slow-start phase, exponential increase to SSTHRESH */
-		if (sock->cwnd_size < sock->ssthresh) {
-			const uint_fast32_t d = MIN( n, sock->ssthresh - sock->cwnd_size );
-			n -= d;
-			token_inc	 = d + d;
-			sock->cwnd_size += d;
-		}
-
-		const uint_fast32_t iw = pgm_fp8div (pgm_fp8 (1), sock->cwnd_size);
-
-/* linear window increase */
-		token_inc	+= pgm_fp8mul (n, pgm_fp8 (1) + iw);
-		sock->cwnd_size += pgm_fp8mul (n, iw);
-		sock->tokens	 = MIN( sock->tokens + token_inc, sock->cwnd_size );
-//		pgm_trace (PGM_LOG_ROLE_CONGESTION_CONTROL,_("PGMCC++ (T:%u W:%u)"),
-//			   pgm_fp8tou (sock->tokens), pgm_fp8tou (sock->cwnd_size));
+		sock->cc->on_ack (sock, skb->tstamp, new_acks, rtt, FALSE);
 	}
 	else
 	{
 /* Look for an unacknowledged data packet which is followed by at least three
- * acknowledged data packets, then the packet is assumed to be lost and PGMCC
- * reacts by halving the window.
+ * acknowledged data packets, then the packet is assumed to be lost.
  *
  * Common value will be 0xfffffff7.
  */
 		sock->acks_after_loss += new_acks;
 		if (sock->acks_after_loss >= 3)
 		{
+			const unsigned acks_after_loss = sock->acks_after_loss;
 			sock->acks_after_loss = 0;
 			sock->suspended_sqn = ack_rx_max;
 			sock->is_congested = TRUE;
-			sock->cwnd_size = pgm_fp8div (sock->cwnd_size, pgm_fp8 (2));
-			if (sock->cwnd_size > sock->tokens)
-				sock->tokens = 0;
-			else
-				sock->tokens -= sock->cwnd_size;
 			sock->ack_bitmap = 0xffffffff;
-			pgm_trace (PGM_LOG_ROLE_CONGESTION_CONTROL,_("PGMCC congestion, half window size (T:%u W:%u)"),
-				   pgm_fp8tou (sock->tokens), pgm_fp8tou (sock->cwnd_size));
+			sock->cc->on_loss (sock, acks_after_loss);
 		}
 	}
 
+/* follow the algorithm pacing rate capped at the configured ODATA rate and receiver credit */
+	if (sock->is_controlled_odata)
+	{
+		const ssize_t pacing_rate = sock->cc->pacing_rate (sock);
+		const ssize_t odata_max_rte = sock->credit_rate ? MIN(sock->credit_rate, sock->odata_max_rte) : sock->odata_max_rte;
+		if (pacing_rate > 0)
+			pgm_rate_set (&sock->odata_rate_control,
+				      MAX(MIN(pacing_rate, odata_max_rte), (ssize_t)sock->max_tpdu),
+				      sock->use_pacing,
+				      sock->max_tpdu);
+	}
+
 /* token is now available so notify tx thread that transmission time is available */
 notify_tx:
 	if (is_congestion_limited &&
@@ -687,22 +1733,32 @@ pgm_send_spm (
 	pgm_debug ("pgm_send_spm (sock:%p flags:%d)",
 		(const void*)sock, flags);
 
+/* sample once, adaptive FEC may change the announcement concurrently */
+	const uint8_t parity_prm = source_parity_prm (sock);
+
 	tpdu_length = sizeof(struct pgm_header);
 	if (AF_INET == sock->send_gsr.gsr_group.ss_family)
 		tpdu_length += sizeof(struct pgm_spm);
 	else
 		tpdu_length += sizeof(struct pgm_spm6);
-	if (sock->use_proactive_parity ||
-	    sock->use_ondemand_parity ||
+	if (parity_prm ||
+	    sock->use_sliding_fec ||
+	    sock->compact_tsdu ||
 	    sock->is_pending_crqst ||
 	    PGM_OPT_FIN == flags)
 	{
 		tpdu_length += sizeof(struct pgm_opt_length);
 /* forward error correction */
-		if (sock->use_proactive_parity ||
-		    sock->use_ondemand_parity)
+		if (parity_prm)
 			tpdu_length += sizeof(struct pgm_opt_header) +
 				       sizeof(struct pgm_opt_parity_prm);
+		if (sock->use_sliding_fec)
+			tpdu_length += sizeof(struct pgm_opt_header) +
+				       sizeof(struct pgm_opt_sw_prm);
+/* compact original data */
+		if (sock->compact_tsdu)
+			tpdu_length += sizeof(struct pgm_opt_header) +
+				       sizeof(struct pgm_opt_compact);
 /* congestion report request */
 		if (sock->is_pending_crqst)
 			tpdu_length += sizeof(struct pgm_opt_header) +
@@ -725,15 +1781,16 @@ pgm_send_spm (
 
 /* SPM */
 	spm->spm_sqn		= pgm_htonl (sock->spm_sqn);
-	spm->spm_trail		= pgm_htonl (pgm_txw_trail_atomic (sock->window));
+	spm->spm_trail		= pgm_htonl (pgm_txw_repair_trail (sock->window));
 	spm->spm_lead		= pgm_htonl (pgm_txw_lead_atomic (sock->window));
 	spm->spm_reserved	= 0;
 /* our nla */
 	pgm_sockaddr_to_nla ((struct sockaddr*)&sock->send_addr, (char*)&spm->spm_nla_afi);
 
 /* PGM options */
-	if (sock->use_proactive_parity ||
-	    sock->use_ondemand_parity ||
+	if (parity_prm ||
+	    sock->use_sliding_fec ||
+	    sock->compact_tsdu ||
 	    sock->is_pending_crqst ||
 	    PGM_OPT_FIN == flags)
 	{
@@ -753,8 +1810,7 @@ pgm_send_spm (
 		last_opt_header = opt_header = (struct pgm_opt_header*)(opt_len + 1);
 
 /* OPT_PARITY_PRM */
-		if (sock->use_proactive_parity ||
-		    sock->use_ondemand_parity)
+		if (parity_prm)
 		{
 			struct pgm_opt_parity_prm *opt_parity_prm;
 
@@ -764,21 +1820,53 @@ pgm_send_spm (
 			opt_header->opt_type	= PGM_OPT_PARITY_PRM;
 			opt_header->opt_length	= sizeof(struct pgm_opt_header) + sizeof(struct pgm_opt_parity_prm);
 			opt_parity_prm = (struct pgm_opt_parity_prm*)(opt_header + 1);
-			opt_parity_prm->opt_reserved = (sock->use_proactive_parity ? PGM_PARITY_PRM_PRO : 0) |
-						       (sock->use_ondemand_parity ? PGM_PARITY_PRM_OND : 0);
+			opt_parity_prm->opt_reserved = parity_prm;
 			opt_parity_prm->parity_prm_tgs = pgm_htonl (sock->rs_k);
 			last_opt_header = opt_header;
 			opt_header = (struct pgm_opt_header*)(opt_parity_prm + 1);
 		}
 
-/* OPT_CRQST */
-		if (sock->is_pending_crqst)
+/* OPT_SW_PRM */
+		if (sock->use_sliding_fec)
 		{
-			struct pgm_opt_crqst *opt_crqst;
+			struct pgm_opt_sw_prm *opt_sw_prm;
 
 			header->pgm_options |= PGM_OPT_NETWORK;
 			opt_total_length += sizeof(struct pgm_opt_header) +
-					    sizeof(struct pgm_opt_crqst);
+					    sizeof(struct pgm_opt_sw_prm);
+			opt_header->opt_type	= PGM_OPT_SW_PRM;
+			opt_header->opt_length	= sizeof(struct pgm_opt_header) + sizeof(struct pgm_opt_sw_prm);
+			opt_sw_prm = (struct pgm_opt_sw_prm*)(opt_header + 1);
+			opt_sw_prm->opt_reserved = 0;
+			opt_sw_prm->sw_prm_window = sock->sw_window;
+			last_opt_header = opt_header;
+			opt_header = (struct pgm_opt_header*)(opt_sw_prm + 1);
+		}
+
+/* OPT_COMPACT */
+		if (sock->compact_tsdu)
+		{
+			struct pgm_opt_compact *opt_compact;
+
+			opt_total_length += sizeof(struct pgm_opt_header) +
+					    sizeof(struct pgm_opt_compact);
+			opt_header->opt_type	= PGM_OPT_COMPACT;
+			opt_header->opt_length	= sizeof(struct pgm_opt_header) + sizeof(struct pgm_opt_compact);
+			opt_compact = (struct pgm_opt_compact*)(opt_header + 1);
+			opt_compact->opt_reserved = 0;
+			opt_compact->compact_reserved = 0;
+			last_opt_header = opt_header;
+			opt_header = (struct pgm_opt_header*)(opt_compact + 1);
+		}
+
+/* OPT_CRQST */
+		if (sock->is_pending_crqst)
+		{
+			struct pgm_opt_crqst *opt_crqst;
+
+			header->pgm_options |= PGM_OPT_NETWORK;
+			opt_total_length += sizeof(struct pgm_opt_header) +
+					    sizeof(struct pgm_opt_crqst);
 			opt_header->opt_type	= PGM_OPT_CRQST;
 			opt_header->opt_length	= sizeof(struct pgm_opt_header) + sizeof(struct pgm_opt_crqst);
 			opt_crqst = (struct pgm_opt_crqst*)(opt_header + 1);
@@ -831,8 +1919,10 @@ pgm_send_spm (
 	}
 
 /* advance SPM sequence only on successful transmission */
+	if (sock->txw_store)
+		pgm_txw_store_spm (sock->txw_store, sock->spm_sqn);
 	sock->spm_sqn++;
-	pgm_atomic_add32 (&sock->cumulative_stats[PGM_PC_SOURCE_BYTES_SENT], (uint32_t)tpdu_length);
+	pgm_stats_add (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_BYTES_SENT, tpdu_length);
 	return TRUE;
 }
 
@@ -917,7 +2007,7 @@ send_ncf (
 		return FALSE;
 /* fall through silently on other errors */
 			
-	pgm_atomic_add32 (&sock->cumulative_stats[PGM_PC_SOURCE_BYTES_SENT], (uint32_t)tpdu_length);
+	pgm_stats_add (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_BYTES_SENT, tpdu_length);
 	return TRUE;
 }
 
@@ -1032,7 +2122,7 @@ send_ncf_list (
 		return FALSE;
 /* fall through silently on other errors */
 
-	pgm_atomic_add32 (&sock->cumulative_stats[PGM_PC_SOURCE_BYTES_SENT], (uint32_t)tpdu_length);
+	pgm_stats_add (&sock->cumulative_stats[PGM_STATS_RX], PGM_PC_SOURCE_BYTES_SENT, tpdu_length);
 	return TRUE;
 }
 
@@ -1046,7 +2136,7 @@ reset_heartbeat_spm (
 	const pgm_time_t	now
 	)
 {
-	pgm_mutex_lock (&sock->timer_mutex);
+	pgm_sock_mutex_lock (sock, &sock->timer_mutex);
 	const pgm_time_t next_poll = sock->next_poll;
 	const pgm_time_t spm_heartbeat_interval = sock->spm_heartbeat_interval[ sock->spm_heartbeat_state = 1 ];
 	sock->next_heartbeat_spm = now + spm_heartbeat_interval;
@@ -1057,14 +2147,510 @@ reset_heartbeat_spm (
 			pgm_notify_send (&sock->pending_notify);
 			sock->is_pending_read = TRUE;
 		}
+		if (sock->use_timer_thread)
+			pgm_notify_send (&sock->timer_notify);
 	}
-	pgm_mutex_unlock (&sock->timer_mutex);
+	pgm_sock_mutex_unlock (sock, &sock->timer_mutex);
 }
 
 /* state helper for resuming sends
  */
 #define STATE(x)	(sock->pkt_dontwait_state.x)
 
+#if defined(HAVE_LINUX_ERRQUEUE_H) && defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+#	define SOURCE_ZEROCOPY
+#endif
+#if defined(HAVE_LINUX_ERRQUEUE_H) && defined(HAVE_LINUX_NET_TSTAMP_H) && defined(SO_TIMESTAMPING)
+#	define SOURCE_TX_TIMESTAMPING
+#endif
+
+#ifdef SOURCE_TX_TIMESTAMPING
+/* link layer bytes that may precede the IP header of a returned datagram */
+#	define PGM_TX_TSTAMP_MAX_LL	64
+
+/* returns TRUE with the ODATA sequence of this socket in a datagram returned with its
+ * transmit time stamp, located by an IP header whose length spans the remainder.
+ */
+
+static
+bool
+tx_tstamp_sqn (
+	const pgm_sock_t* const restrict sock,
+	const char*	  const restrict buf,
+	const size_t			 len,
+	uint32_t*	  const restrict sqn
+	)
+{
+	const uint8_t protocol = (0 != sock->udp_encap_ucast_port) ? IPPROTO_UDP : (uint8_t)pgm_ipproto_pgm;
+	const size_t encap_len = (0 != sock->udp_encap_ucast_port) ? sizeof (struct pgm_udphdr) : 0;
+
+	for (size_t offset = 0; offset <= PGM_TX_TSTAMP_MAX_LL && offset + 40 <= len; offset += 2)
+	{
+		const uint8_t* ip = (const uint8_t*)buf + offset;
+		size_t iphdr_len, total_len;
+		uint16_t word;
+		if (4 == (ip[0] >> 4) && protocol == ip[9]) {
+			memcpy (&word, ip + 2, sizeof (word));
+			iphdr_len = (ip[0] & 0x0f) * 4;
+			total_len = pgm_ntohs (word);
+		} else if (6 == (ip[0] >> 4) && protocol == ip[6]) {
+			memcpy (&word, ip + 4, sizeof (word));
+			iphdr_len = 40;
+			total_len = iphdr_len + pgm_ntohs (word);
+		} else
+			continue;
+		if (total_len != len - offset ||
+		    iphdr_len + encap_len + sizeof (struct pgm_header) + sizeof (struct pgm_data) > total_len)
+			continue;
+
+		struct pgm_header header;
+		struct pgm_data data;
+		memcpy (&header, ip + iphdr_len + encap_len, sizeof (header));
+		memcpy (&data, ip + iphdr_len + encap_len + sizeof (header), sizeof (data));
+		if (PGM_ODATA != header.pgm_type ||
+		    sock->tsi.sport != header.pgm_sport ||
+		    0 != memcmp (&sock->tsi.gsi, header.pgm_gsi, sizeof (pgm_gsi_t)))
+			return FALSE;
+		*sqn = pgm_ntohl (data.data_sqn);
+		return TRUE;
+	}
+	return FALSE;
+}
+
+/* convert a kernel or NIC transmit time to time since the pgm_send() call of skb by the
+ * delay to the system clock, both clocks read at the same instant.
+ *
+ * returns 0 when not present or implausible.
+ */
+
+static inline
+pgm_time_t
+tx_tstamp_delay (
+	const struct pgm_sk_buff_t* const restrict skb,
+	const struct timespec*	    const restrict ts,
+	const pgm_time_t			   now,
+	const pgm_time_t			   realtime
+	)
+{
+	const pgm_time_t kernel_time = (pgm_time_t)ts->tv_sec * 1000000 + (pgm_time_t)ts->tv_nsec / 1000;
+	if (0 == kernel_time || pgm_time_after (kernel_time, realtime))
+		return 0;
+	const pgm_time_t wire_tstamp = now - (realtime - kernel_time);
+	return pgm_time_after (wire_tstamp, skb->tstamp) ? wire_tstamp - skb->tstamp : 0;
+}
+
+/* record one transmit time stamp of ODATA in the histogram of its stage, the
+ * datagram must still be in the transmit window, read as producer.
+ */
+
+static
+void
+tx_tstamp_record (
+	pgm_sock_t*		     const restrict sock,
+	const size_t				    len,
+	const uint32_t				    stage,
+	const struct scm_timestamping* const restrict tss
+	)
+{
+	uint32_t sqn;
+
+	if (!tx_tstamp_sqn (sock, sock->tx_tstamp_buf, len, &sqn))
+		return;
+	const struct pgm_sk_buff_t* skb = pgm_txw_peek (sock->window, sqn);
+	if (NULL == skb)
+		return;
+
+	struct timespec ts;
+	clock_gettime (CLOCK_REALTIME, &ts);
+	const pgm_time_t now = pgm_time_update_now();
+	const pgm_time_t realtime = (pgm_time_t)ts.tv_sec * 1000000 + (pgm_time_t)ts.tv_nsec / 1000;
+	const pgm_time_t software_delay = tx_tstamp_delay (skb, &tss->ts[0], now, realtime);
+	const pgm_time_t hardware_delay = tx_tstamp_delay (skb, &tss->ts[2], now, realtime);
+
+/* entering the qdisc, leaving the driver, leaving the NIC */
+	if (SCM_TSTAMP_SCHED == stage) {
+		if (software_delay) {
+			PGM_HISTOGRAM_SAMPLED_TIMES("Tx.OdataSchedTime", sqn, software_delay);
+		}
+	} else if (SCM_TSTAMP_SND == stage) {
+		if (software_delay) {
+			PGM_HISTOGRAM_SAMPLED_TIMES("Tx.OdataSoftwareTime", sqn, software_delay);
+		}
+		if (hardware_delay) {
+			PGM_HISTOGRAM_SAMPLED_TIMES("Tx.OdataHardwareTime", sqn, hardware_delay);
+		}
+	}
+}
+#endif /* SOURCE_TX_TIMESTAMPING */
+
+#if defined(SOURCE_ZEROCOPY) || defined(SOURCE_TX_TIMESTAMPING)
+/* drain the error queue of the data socket, releasing skbuff references of zero-copy
+ * sends completed by the kernel and recording transmit time stamps of ODATA.
+ */
+
+static
+void
+errqueue_reap (
+	pgm_sock_t*	const	sock
+	)
+{
+	char control[ 256 ];
+	struct iovec iov;
+
+#ifdef SOURCE_TX_TIMESTAMPING
+	if (sock->tx_timestamping && NULL == sock->tx_tstamp_buf)
+		sock->tx_tstamp_buf = pgm_malloc (PGM_TX_TSTAMP_MAX_LL + sock->max_tpdu);
+	iov.iov_base = sock->tx_tstamp_buf;
+	iov.iov_len  = sock->tx_tstamp_buf ? PGM_TX_TSTAMP_MAX_LL + sock->max_tpdu : 0;
+#else
+	iov.iov_base = NULL;
+	iov.iov_len  = 0;
+#endif
+
+	for (;;)
+	{
+		struct msghdr msg;
+		memset (&msg, 0, sizeof(msg));
+		msg.msg_iov	   = &iov;
+		msg.msg_iovlen	   = 1;
+		msg.msg_control	   = control;
+		msg.msg_controllen = sizeof(control);
+		const ssize_t len = recvmsg (sock->send_sock, &msg, MSG_ERRQUEUE | MSG_DONTWAIT);
+		if (len < 0)
+			break;
+		const struct sock_extended_err* serr = NULL;
+		const void* tss = NULL;
+		for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+		     cmsg != NULL;
+		     cmsg = CMSG_NXTHDR(&msg, cmsg))
+		{
+			if ((IPPROTO_IP == cmsg->cmsg_level && IP_RECVERR == cmsg->cmsg_type) ||
+			    (IPPROTO_IPV6 == cmsg->cmsg_level && IPV6_RECVERR == cmsg->cmsg_type))
+				serr = (const void*)CMSG_DATA(cmsg);
+#ifdef SOURCE_TX_TIMESTAMPING
+			else if (SOL_SOCKET == cmsg->cmsg_level && SCM_TIMESTAMPING == cmsg->cmsg_type)
+				tss = (const void*)CMSG_DATA(cmsg);
+#endif
+		}
+		if (NULL == serr)
+			continue;
+#ifdef SOURCE_ZEROCOPY
+		if (0 == serr->ee_errno && SO_EE_ORIGIN_ZEROCOPY == serr->ee_origin) {
+			const uint32_t mask = PGM_ZEROCOPY_MAX_PENDING - 1;
+/* inclusive range of completed send calls */
+			for (uint32_t id = serr->ee_info; id != serr->ee_data + 1; id++) {
+				struct pgm_sk_buff_t** skb = &sock->zc_skb[ id & mask ];
+				if (PGM_LIKELY(NULL != *skb)) {
+					(*skb)->is_zc_pending = 0;
+					pgm_free_skb (*skb);
+					*skb = NULL;
+				}
+			}
+			continue;
+		}
+#endif
+#ifdef SOURCE_TX_TIMESTAMPING
+		if (SO_EE_ORIGIN_TIMESTAMPING == serr->ee_origin && NULL != tss && NULL != sock->tx_tstamp_buf)
+			tx_tstamp_record (sock, (size_t)len, serr->ee_info, tss);
+#endif
+		(void)tss;
+	}
+#ifdef SOURCE_ZEROCOPY
+	if (NULL != sock->zc_skb) {
+		const uint32_t mask = PGM_ZEROCOPY_MAX_PENDING - 1;
+		while (sock->zc_tail != sock->zc_head && NULL == sock->zc_skb[ sock->zc_tail & mask ])
+			sock->zc_tail++;
+	}
+#endif
+}
+#endif
+
+/* collect transmit time stamps of ODATA sent so far.
+ */
+
+static inline
+void
+tx_tstamp_reap (
+	pgm_sock_t*	const	sock
+	)
+{
+#ifdef SOURCE_TX_TIMESTAMPING
+	if (PGM_UNLIKELY(sock->tx_timestamping))
+		errqueue_reap (sock);
+#else
+	(void)sock;
+#endif
+}
+
+/* send the pending batch of ODATA TPDUs held in the resume state, releasing
+ * each reference once sent.  with use_zerocopy an additional reference is
+ * held per datagram until the kernel completes transmission.
+ *
+ * returns TRUE when the batch is complete, returns FALSE when blocked with
+ * save_errno set, the batch may be resumed by calling again.
+ */
+
+static
+bool
+send_odata_batch (
+	pgm_sock_t*	const restrict sock,
+	const bool		       use_zerocopy,
+	size_t*		const restrict bytes_sent,
+	unsigned*	const restrict packets_sent,
+	size_t*		const restrict data_bytes_sent,
+	int*		const restrict save_errno
+	)
+{
+	struct pgm_iovec iov[ PGM_MAX_FRAGMENTS ];
+	const unsigned skbv_offset = STATE(skbv_offset);
+	PGM_PROFILE_BEGIN (send_start);
+
+	while (STATE(skbv_offset) < STATE(skbv_len))
+	{
+		const unsigned count = STATE(skbv_len) - STATE(skbv_offset);
+		int flags = 0;
+#ifdef SOURCE_ZEROCOPY
+		if (use_zerocopy) {
+			errqueue_reap (sock);
+/* copy when too many sends are outstanding */
+			if (sock->zc_head - sock->zc_tail + count <= PGM_ZEROCOPY_MAX_PENDING)
+				flags = MSG_ZEROCOPY;
+		}
+#else
+		(void)use_zerocopy;
+#endif
+		for (unsigned i = 0; i < count; i++) {
+			struct pgm_sk_buff_t* skb = STATE(skbv)[ STATE(skbv_offset) + i ];
+			pgm_assert ((char*)skb->tail > (char*)skb->head);
+			iov[i].iov_base = skb->head;
+			iov[i].iov_len  = (char*)skb->tail - (char*)skb->head;
+/* marked before the send such that a concurrent repair never rewrites the header in place */
+			if (flags)
+				skb->is_zc_pending = 1;
+		}
+		ssize_t sent = pgm_sendtov (sock,
+					    !STATE(is_rate_limited),	/* rate limited on blocking */
+					    &sock->odata_rate_control,
+					    FALSE,			/* regular socket */
+					    iov,
+					    count,
+					    (struct sockaddr*)&sock->send_gsr.gsr_group,
+					    pgm_sockaddr_len((struct sockaddr*)&sock->send_gsr.gsr_group),
+					    flags);
+		const unsigned done = (sent < 0) ? 1 : (unsigned)sent;
+#ifdef SOURCE_ZEROCOPY
+		for (unsigned i = (sent > 0) ? done : 0; i < count; i++)
+			STATE(skbv)[ STATE(skbv_offset) + i ]->is_zc_pending = 0;
+#endif
+		if (sent < 0) {
+			*save_errno = pgm_get_last_sock_error();
+			if (PGM_LIKELY(PGM_SOCK_EAGAIN == *save_errno || PGM_SOCK_ENOBUFS == *save_errno))
+			{
+				sock->is_apdu_eagain = TRUE;
+				sock->blocklen = iov[0].iov_len + sock->iphdr_len;
+				return FALSE;
+			}
+/* fall through silently on other errors, skipping the failed packet */
+		}
+
+		for (unsigned i = 0; i < done; i++)
+		{
+			struct pgm_sk_buff_t* skb = STATE(skbv)[ STATE(skbv_offset)++ ];
+			if (PGM_LIKELY(sent > 0)) {
+				*bytes_sent += iov[i].iov_len + sock->iphdr_len;	/* as counted at IP layer */
+				(*packets_sent)++;					/* IP packets */
+				*data_bytes_sent += skb->len;
+#ifdef SOURCE_ZEROCOPY
+				if (flags & MSG_ZEROCOPY)
+					sock->zc_skb[ sock->zc_head++ & (PGM_ZEROCOPY_MAX_PENDING - 1) ] = pgm_skb_get (skb);
+#endif
+			}
+
+/* check for end of transmission group */
+			if (sock->use_proactive_parity) {
+				const uint32_t odata_sqn   = pgm_ntohl (skb->pgm_data->data_sqn);
+				const uint32_t tg_sqn_mask = 0xffffffff << sock->tg_sqn_shift;
+				if (!((odata_sqn + 1) & ~tg_sqn_mask))
+					pgm_schedule_proactive_nak (sock, odata_sqn & tg_sqn_mask);
+			}
+			if (sock->use_sliding_fec)
+				send_sw_repair (sock, pgm_ntohl (skb->pgm_data->data_sqn));
+			pgm_free_skb (skb);
+		}
+	}
+	tx_tstamp_reap (sock);
+	PGM_PROFILE_END (PGM_PROFILE_SEND_ODATA, send_start, STATE(skbv_offset) - skbv_offset);
+	return TRUE;
+}
+
+/* build the ODATA header template of invariant fields with the partial checksum
+ * for each setting of PGM_OPT_PRESENT, sequence numbers and TSDU length zero.
+ */
+
+static
+void
+source_build_odata_template (
+	pgm_sock_t* const	sock
+	)
+{
+	struct pgm_odata_tmpl_t* tmpl = &sock->odata_tmpl;
+	memset (tmpl, 0, sizeof (struct pgm_odata_tmpl_t));
+	memcpy (tmpl->header.pgm_gsi, &sock->tsi.gsi, sizeof(pgm_gsi_t));
+	tmpl->header.pgm_sport	= sock->tsi.sport;
+	tmpl->header.pgm_dport	= sock->dport;
+	tmpl->header.pgm_type	= PGM_ODATA;
+	tmpl->unfolded_header	= pgm_csum_partial (&tmpl->header, sizeof (struct pgm_header), 0);
+	tmpl->header.pgm_options = PGM_OPT_PRESENT;
+	tmpl->unfolded_header_opt = pgm_csum_partial (&tmpl->header, sizeof (struct pgm_header), 0);
+	tmpl->header.pgm_options = 0;
+}
+
+/* write the PGM header and ODATA of one packet from the socket template,
+ * options follow and are added to the returned checksum by the caller.
+ *
+ * returns the partial checksum of the PGM header and ODATA.
+ */
+
+static inline
+uint32_t
+source_odata_header (
+	pgm_sock_t*	      const restrict sock,
+	struct pgm_sk_buff_t* const restrict skb,
+	const uint16_t			     tsdu_length,
+	const bool			     has_options
+	)
+{
+	const struct pgm_odata_tmpl_t* tmpl = &sock->odata_tmpl;
+	uint32_t unfolded_header;
+
+	skb->pgm_header	= (struct pgm_header*)skb->head;
+	skb->pgm_data	= (struct pgm_data*)(skb->pgm_header + 1);
+	memcpy (skb->pgm_header, &tmpl->header, sizeof (struct pgm_header));
+	if (has_options)
+		skb->pgm_header->pgm_options = PGM_OPT_PRESENT;
+	skb->pgm_header->pgm_tsdu_length = pgm_htons (tsdu_length);
+	skb->pgm_data->data_sqn		= pgm_htonl (pgm_txw_next_lead(sock->window));
+	skb->pgm_data->data_trail	= pgm_htonl (pgm_txw_repair_trail(sock->window));
+
+/* incremental update of the template checksum, RFC 1624 */
+	unfolded_header = has_options ? tmpl->unfolded_header_opt : tmpl->unfolded_header;
+	unfolded_header = add32_with_carry (unfolded_header, skb->pgm_header->pgm_tsdu_length);
+	unfolded_header = add32_with_carry (unfolded_header, skb->pgm_data->data_sqn);
+	return add32_with_carry (unfolded_header, skb->pgm_data->data_trail);
+}
+
+/* encode a standard ODATA packet as PGM_CDATA, without options or with only one
+ * fragment option, each sequence number within 64K of the packet sequence
+ * number.  The checksum of the standard encoding is carried unchanged.
+ *
+ * returns the compact length, or 0 if ineligible.
+ */
+
+static
+size_t
+source_compact_encode (
+	const pgm_sock_t* const restrict sock,
+	const void*	  const restrict tpdu,
+	const size_t			 tpdu_length,
+	char*		  const restrict buf
+	)
+{
+	const struct pgm_header* header = tpdu;
+	const struct pgm_data* odata = (const struct pgm_data*)(header + 1);
+	struct pgm_compact_header* compact = (struct pgm_compact_header*)buf;
+	const uint16_t tsdu_length = pgm_ntohs (header->pgm_tsdu_length);
+	const uint32_t sqn = pgm_ntohl (odata->data_sqn);
+	const uint32_t trail_delta = sqn - pgm_ntohl (odata->data_trail);
+	size_t header_len = sizeof(struct pgm_header) + sizeof(struct pgm_data);
+	size_t compact_len = sizeof(struct pgm_compact_header);
+
+	if (PGM_ODATA != header->pgm_type ||
+	    tsdu_length > sock->compact_tsdu ||
+	    trail_delta > UINT16_MAX)
+		return 0;
+	if (header->pgm_options) {
+		const struct pgm_opt_length* opt_len = (const struct pgm_opt_length*)(odata + 1);
+		const struct pgm_opt_header* opt_header = (const struct pgm_opt_header*)(opt_len + 1);
+		const struct pgm_opt_fragment* opt_fragment = (const struct pgm_opt_fragment*)(opt_header + 1);
+		const size_t opt_total_length = sizeof(struct pgm_opt_length) +
+						sizeof(struct pgm_opt_header) +
+						sizeof(struct pgm_opt_fragment);
+		if (PGM_OPT_PRESENT != header->pgm_options ||
+		    tpdu_length != header_len + opt_total_length + tsdu_length ||
+		    PGM_OPT_LENGTH != opt_len->opt_type ||
+		    opt_total_length != pgm_ntohs (opt_len->opt_total_length) ||
+		    (PGM_OPT_FRAGMENT | PGM_OPT_END) != opt_header->opt_type ||
+		    opt_header->opt_length != sizeof(struct pgm_opt_header) + sizeof(struct pgm_opt_fragment) ||
+		    0 != opt_header->opt_reserved ||
+		    0 != opt_fragment->opt_reserved)
+			return 0;
+		const uint32_t first_delta = sqn - pgm_ntohl (opt_fragment->opt_sqn);
+		const uint32_t frag_off = pgm_ntohl (opt_fragment->opt_frag_off);
+		const uint32_t frag_len = pgm_ntohl (opt_fragment->opt_frag_len);
+		if (first_delta > UINT16_MAX ||
+		    frag_off > UINT16_MAX ||
+		    frag_len > UINT16_MAX)
+			return 0;
+		struct pgm_compact_fragment* cfrag = (struct pgm_compact_fragment*)(compact + 1);
+		cfrag->cfrag_sqn = pgm_htons ((uint16_t)first_delta);
+		cfrag->cfrag_off = pgm_htons ((uint16_t)frag_off);
+		cfrag->cfrag_len = pgm_htons ((uint16_t)frag_len);
+		header_len  += opt_total_length;
+		compact_len += sizeof(struct pgm_compact_fragment);
+	} else if (tpdu_length != header_len + tsdu_length)
+		return 0;
+
+	compact->pgm_sport	 = header->pgm_sport;
+	compact->pgm_dport	 = header->pgm_dport;
+	compact->pgm_type	 = PGM_CDATA;
+	compact->pgm_options	 = header->pgm_options;
+	compact->pgm_checksum	 = header->pgm_checksum;
+	compact->cdata_sqn	 = pgm_htons ((uint16_t)sqn);
+	compact->cdata_trail	 = pgm_htons ((uint16_t)trail_delta);
+	compact->pgm_tsdu_length = header->pgm_tsdu_length;
+	memcpy (buf + compact_len, (const char*)tpdu + header_len, tsdu_length);
+	return compact_len + tsdu_length;
+}
+
+/* send original data to the send group, as PGM_CDATA when eligible.
+ *
+ * returns tpdu_length on success, as for the standard encoding.
+ */
+
+static
+ssize_t
+source_sendto_odata (
+	pgm_sock_t* const restrict sock,
+	const bool		   use_rate_limit,
+	const void* const restrict tpdu,
+	const size_t		   tpdu_length
+	)
+{
+	if (sock->compact_tsdu) {
+		char* buf = pgm_alloca (tpdu_length);
+		const size_t compact_length = source_compact_encode (sock, tpdu, tpdu_length, buf);
+		if (compact_length) {
+			const ssize_t sent = pgm_sendto (sock,
+							 use_rate_limit,
+							 &sock->odata_rate_control,
+							 FALSE,			/* regular socket */
+							 buf,
+							 compact_length,
+							 (struct sockaddr*)&sock->send_gsr.gsr_group,
+							 pgm_sockaddr_len((struct sockaddr*)&sock->send_gsr.gsr_group));
+			return sent < 0 ? sent : (ssize_t)tpdu_length;
+		}
+	}
+	return pgm_sendto (sock,
+			   use_rate_limit,
+			   &sock->odata_rate_control,
+			   FALSE,			/* regular socket */
+			   tpdu,
+			   tpdu_length,
+			   (struct sockaddr*)&sock->send_gsr.gsr_group,
+			   pgm_sockaddr_len((struct sockaddr*)&sock->send_gsr.gsr_group));
+}
+
 /* send one PGM data packet, transmit window owned memory.
  *
  * On success, returns PGM_IO_STATUS_NORMAL and the number of data bytes pushed
@@ -1083,6 +2669,7 @@ int
 send_odata (
 	pgm_sock_t*           const restrict sock,
 	struct pgm_sk_buff_t* const restrict skb,
+	const uint32_t*		    restrict csum,	/* precomputed payload checksum or NULL */
 	size_t*			    restrict bytes_written
 	)
 {
@@ -1097,6 +2684,8 @@ send_odata (
 	pgm_debug ("send_odata (sock:%p skb:%p bytes-written:%p)",
 		(void*)sock, (void*)skb, (void*)bytes_written);
 
+	PGM_PROFILE_BEGIN (send_start);
+
 	const uint16_t    tsdu_length  = skb->len;
 	const sa_family_t pgmcc_family = sock->use_pgmcc ? sock->family : 0;
 	const size_t      tpdu_length  = tsdu_length + pgm_pkt_offset (FALSE, pgmcc_family);
@@ -1112,20 +2701,8 @@ send_odata (
 	STATE(skb)->sock = sock;
 	STATE(skb)->tstamp = pgm_time_update_now();
 
-	STATE(skb)->pgm_header = (struct pgm_header*)STATE(skb)->head;
-	STATE(skb)->pgm_data   = (struct pgm_data*)(STATE(skb)->pgm_header + 1);
-	memcpy (STATE(skb)->pgm_header->pgm_gsi, &sock->tsi.gsi, sizeof(pgm_gsi_t));
-	STATE(skb)->pgm_header->pgm_sport	= sock->tsi.sport;
-	STATE(skb)->pgm_header->pgm_dport	= sock->dport;
-	STATE(skb)->pgm_header->pgm_type        = PGM_ODATA;
-        STATE(skb)->pgm_header->pgm_options     = sock->use_pgmcc ? PGM_OPT_PRESENT : 0;
-        STATE(skb)->pgm_header->pgm_tsdu_length = pgm_htons (tsdu_length);
-
-/* ODATA */
-        STATE(skb)->pgm_data->data_sqn		= pgm_htonl (pgm_txw_next_lead(sock->window));
-        STATE(skb)->pgm_data->data_trail	= pgm_htonl (pgm_txw_trail(sock->window));
-
-        STATE(skb)->pgm_header->pgm_checksum    = 0;
+/* PGM header and ODATA from the socket template */
+	uint32_t unfolded_header = source_odata_header (sock, STATE(skb), tsdu_length, sock->use_pgmcc);
 	data = STATE(skb)->pgm_data + 1;
 /* congestion control option header indicating elected peer for ACKs. */
 	if (sock->use_pgmcc) {
@@ -1152,14 +2729,13 @@ send_odata (
 		data = (char*)opt_header + opt_header->opt_length;
 	}
 	const size_t   pgm_header_len		= (char*)data - (char*)STATE(skb)->pgm_header;
-	const uint32_t unfolded_header		= pgm_csum_partial (STATE(skb)->pgm_header, (uint16_t)pgm_header_len, 0);
-	STATE(unfolded_odata)			= pgm_csum_partial (data, (uint16_t)tsdu_length, 0);
-        STATE(skb)->pgm_header->pgm_checksum	= pgm_csum_fold (pgm_csum_block_add (unfolded_header, STATE(unfolded_odata), (uint16_t)pgm_header_len));
+	if (sock->use_pgmcc)
+		unfolded_header = add32_with_carry (unfolded_header, pgm_csum_partial (STATE(skb)->pgm_data + 1, (uint16_t)((char*)data - (char*)(STATE(skb)->pgm_data + 1)), 0));
+	STATE(unfolded_odata)			= csum ? *csum : source_csum_partial (sock, data, (uint16_t)tsdu_length);
+        STATE(skb)->pgm_header->pgm_checksum	= source_csum_fold (sock, unfolded_header, STATE(unfolded_odata), (uint16_t)pgm_header_len);
 
 /* add to transmit window, skb::data set to payload */
-	pgm_spinlock_lock (&sock->txw_spinlock);
 	pgm_txw_add (sock->window, STATE(skb));
-	pgm_spinlock_unlock (&sock->txw_spinlock);
 
 /* check rate limit at last moment */
 	STATE(is_rate_limited) = FALSE;
@@ -1192,14 +2768,10 @@ retry_send:
 		return PGM_IO_STATUS_CONGESTION;	/* peer expiration to re-elect ACKer */
 	}
 
-	sent = pgm_sendto (sock,
-			   !STATE(is_rate_limited),	/* rate limit on blocking */
-			   &sock->odata_rate_control,
-			   FALSE,			/* regular socket */
-			   STATE(skb)->head,
-			   tpdu_length,
-			   (struct sockaddr*)&sock->send_gsr.gsr_group,
-			   pgm_sockaddr_len((struct sockaddr*)&sock->send_gsr.gsr_group));
+	sent = source_sendto_odata (sock,
+			            !STATE(is_rate_limited),	/* rate limit on blocking */
+			            STATE(skb)->head,
+			            tpdu_length);
 	if (sent < 0) {
 		const int save_errno = pgm_get_last_sock_error();
 		if (PGM_LIKELY(PGM_SOCK_EAGAIN == save_errno || PGM_SOCK_ENOBUFS == save_errno))
@@ -1217,20 +2789,23 @@ retry_send:
 
 /* success */
 	sock->is_apdu_eagain = FALSE;
+/* send call to wire, restarted when resuming a blocked send */
+	PGM_HISTOGRAM_SAMPLED_TIMES("Tx.OdataSendTime", pgm_ntohl (STATE(skb)->pgm_data->data_sqn), pgm_time_update_now() - STATE(skb)->tstamp);
+	tx_tstamp_reap (sock);
 /* SPM heartbeats decay from last sent data packet */
 	reset_heartbeat_spm (sock, STATE(skb)->tstamp);
 /* congestion control: remove token from bucket */
 	if (sock->use_pgmcc) {
-		sock->tokens -= pgm_fp8 (1);
+		sock->cc->on_send (sock);
 		sock->ack_expiry = STATE(skb)->tstamp + sock->ack_expiry_ivl;
 	}
 /* save unfolded odata for retransmissions */
 	pgm_txw_set_unfolded_checksum (STATE(skb), STATE(unfolded_odata));
 /* increment socket statistics */
 	if (PGM_LIKELY((size_t)sent == tpdu_length)) {
-		sock->cumulative_stats[PGM_PC_SOURCE_DATA_BYTES_SENT] += tsdu_length;
-		sock->cumulative_stats[PGM_PC_SOURCE_DATA_MSGS_SENT]  ++;
-		pgm_atomic_add32 (&sock->cumulative_stats[PGM_PC_SOURCE_BYTES_SENT], (uint32_t)(tpdu_length + sock->iphdr_len));
+		pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_DATA_BYTES_SENT, tsdu_length);
+		pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_DATA_MSGS_SENT);
+		pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_BYTES_SENT, tpdu_length + sock->iphdr_len);
 	}
 /* check for end of transmission group for pro-active packets */
 	if (sock->use_proactive_parity) {
@@ -1239,27 +2814,38 @@ retry_send:
 		if (!((odata_sqn + 1) & ~tg_sqn_mask))
 			pgm_schedule_proactive_nak (sock, odata_sqn & tg_sqn_mask);
 	}
+	if (sock->use_sliding_fec)
+		send_sw_repair (sock, pgm_ntohl (STATE(skb)->pgm_data->data_sqn));
 /* remove applications reference to skbuff */
 	pgm_free_skb (STATE(skb));
 	if (bytes_written)
 		*bytes_written = tsdu_length;
+	PGM_PROFILE_END (PGM_PROFILE_SEND_ODATA, send_start, 1);
 	return PGM_IO_STATUS_NORMAL;
 }
 
-/* send one PGM original data packet, callee owned memory.
+/* send one PGM original data packet, callee owned memory.  with batch_count the
+ * TSDU holds that many length-prefixed messages and is marked with OPT_BATCH.
+ * template body, use_pgmcc and use_fec are constant in each specialisation below
+ * so disabled features compile out of the per-packet path.
  *
  * on success, returns PGM_IO_STATUS_NORMAL, on block for non-blocking sockets
  * returns PGM_IO_STATUS_WOULD_BLOCK, returns PGM_IO_STATUS_RATE_LIMITED if
  * packet size exceeds the current rate limit.
  */
 
-static
+static inline
+PGM_GNUC_ALWAYS_INLINE
 int
-send_odata_copy (
+_send_odata_copy (
 	pgm_sock_t*      const restrict	sock,
 	const void*	       restrict	tsdu,
 	const uint16_t			tsdu_length,
-	size_t*		       restrict	bytes_written
+	const uint16_t			batch_count,	/* 0 = not coalesced */
+	size_t*		       restrict	bytes_written,
+	const bool			use_pgmcc,	/* use_pgmcc or FALSE */
+	const bool			use_fec,	/* FALSE when no FEC is enabled */
+	const unsigned			priority	/* class of pgm_send_priority(), 0 = pgm_send() */
 	)
 {
 	void	*data;
@@ -1270,11 +2856,15 @@ send_odata_copy (
 	pgm_assert (tsdu_length <= sock->max_tsdu);
 	if (PGM_LIKELY(tsdu_length)) pgm_assert (NULL != tsdu);
 
-	pgm_debug ("send_odata_copy (sock:%p tsdu:%p tsdu_length:%u bytes-written:%p)",
-		(void*)sock, tsdu, tsdu_length, (void*)bytes_written);
+	pgm_debug ("send_odata_copy (sock:%p tsdu:%p tsdu_length:%u batch-count:%u bytes-written:%p)",
+		(void*)sock, tsdu, tsdu_length, batch_count, (void*)bytes_written);
 
-	const sa_family_t pgmcc_family = sock->use_pgmcc ? sock->family : 0;
-	const size_t      tpdu_length  = tsdu_length + pgm_pkt_offset (FALSE, pgmcc_family);
+	PGM_PROFILE_BEGIN (send_start);
+
+	const sa_family_t pgmcc_family = use_pgmcc ? sock->family : 0;
+	const size_t      header_length = pgm_pkt_offset (FALSE, pgmcc_family) +
+					  (batch_count ? source_batch_opt_length (sock) : 0);
+	const size_t      tpdu_length  = tsdu_length + header_length;
 
 /* continue if blocked mid-apdu, updating timestamp */
 	if (sock->is_apdu_eagain) {
@@ -1282,65 +2872,80 @@ send_odata_copy (
 		goto retry_send;
 	}
 
-	STATE(skb) = pgm_alloc_skb (sock->max_tpdu);
+	STATE(skb) = pgm_skb_pool_alloc (sock->txw_skb_pool, sock->max_tpdu);
 	STATE(skb)->sock = sock;
 	STATE(skb)->tstamp = pgm_time_update_now();
-	pgm_skb_reserve (STATE(skb), (uint16_t)pgm_pkt_offset (FALSE, pgmcc_family));
+	STATE(priority) = priority;
+	pgm_skb_reserve (STATE(skb), (uint16_t)header_length);
 	pgm_skb_put (STATE(skb), (uint16_t)tsdu_length);
 
-	STATE(skb)->pgm_header	= (struct pgm_header*)STATE(skb)->head;
-	STATE(skb)->pgm_data	= (struct pgm_data*)(STATE(skb)->pgm_header + 1);
-	memcpy (STATE(skb)->pgm_header->pgm_gsi, &sock->tsi.gsi, sizeof(pgm_gsi_t));
-	STATE(skb)->pgm_header->pgm_sport	= sock->tsi.sport;
-	STATE(skb)->pgm_header->pgm_dport	= sock->dport;
-	STATE(skb)->pgm_header->pgm_type	= PGM_ODATA;
-	STATE(skb)->pgm_header->pgm_options	= sock->use_pgmcc ? PGM_OPT_PRESENT : 0;
-	STATE(skb)->pgm_header->pgm_tsdu_length = pgm_htons (tsdu_length);
-
-/* ODATA */
-	STATE(skb)->pgm_data->data_sqn		= pgm_htonl (pgm_txw_next_lead(sock->window));
-	STATE(skb)->pgm_data->data_trail	= pgm_htonl (pgm_txw_trail(sock->window));
-
-	STATE(skb)->pgm_header->pgm_checksum	= 0;
+/* PGM header and ODATA from the socket template */
+	uint32_t unfolded_header = source_odata_header (sock, STATE(skb), tsdu_length, use_pgmcc || batch_count);
 	data = STATE(skb)->pgm_data + 1;
-/* congestion control option header indicating elected peer for ACKs. */
-	if (sock->use_pgmcc) {
+	if (use_pgmcc || batch_count) {
 		struct pgm_opt_header		*opt_header;
 		struct pgm_opt_length		*opt_len;
-		struct pgm_opt_pgmcc_data	*pgmcc_data;
-		const size_t opt_pgmcc_data_len = ((AF_INET6 == sock->acker_nla.ss_family) ?
-							sizeof (struct pgm_opt6_pgmcc_data) :
-							sizeof (struct pgm_opt_pgmcc_data));
 		opt_len = data;
 		opt_len->opt_type	= PGM_OPT_LENGTH;
 		opt_len->opt_length	= sizeof (struct pgm_opt_length);
-		opt_len->opt_total_length = pgm_htons ((uint16_t)(sizeof (struct pgm_opt_length) +
-							sizeof (struct pgm_opt_header) +
-							opt_pgmcc_data_len));
 		opt_header = (struct pgm_opt_header*)(opt_len + 1);
-		opt_header->opt_type	= PGM_OPT_PGMCC_DATA | PGM_OPT_END;
-		opt_header->opt_length	= sizeof (struct pgm_opt_header) +
-						opt_pgmcc_data_len;
-		pgmcc_data  = (struct pgm_opt_pgmcc_data *)(opt_header + 1);
-		pgmcc_data->opt_reserved = 0;
-		pgmcc_data->opt_tstamp = pgm_htonl ((uint32_t)pgm_to_msecs (STATE(skb)->tstamp));
+/* congestion control option header indicating elected peer for ACKs. */
+		if (use_pgmcc) {
+			struct pgm_opt_pgmcc_data	*pgmcc_data;
+			const size_t opt_pgmcc_data_len = ((AF_INET6 == sock->acker_nla.ss_family) ?
+								sizeof (struct pgm_opt6_pgmcc_data) :
+								sizeof (struct pgm_opt_pgmcc_data));
+			opt_header->opt_type	= batch_count ? PGM_OPT_PGMCC_DATA : (PGM_OPT_PGMCC_DATA | PGM_OPT_END);
+			opt_header->opt_length	= sizeof (struct pgm_opt_header) +
+							opt_pgmcc_data_len;
+			pgmcc_data  = (struct pgm_opt_pgmcc_data *)(opt_header + 1);
+			pgmcc_data->opt_reserved = 0;
+			pgmcc_data->opt_tstamp = pgm_htonl ((uint32_t)pgm_to_msecs (STATE(skb)->tstamp));
 /* acker nla */
-		pgm_sockaddr_to_nla ((struct sockaddr*)&sock->acker_nla, (char*)&pgmcc_data->opt_nla_afi);
-		data = (char*)opt_header + opt_header->opt_length;
+			pgm_sockaddr_to_nla ((struct sockaddr*)&sock->acker_nla, (char*)&pgmcc_data->opt_nla_afi);
+			opt_header = (struct pgm_opt_header*)((char*)opt_header + opt_header->opt_length);
+		}
+/* coalesced messages */
+		if (batch_count) {
+			struct pgm_opt_batch		*opt_batch;
+			opt_header->opt_type	= PGM_OPT_BATCH | PGM_OPT_END;
+			opt_header->opt_length	= sizeof (struct pgm_opt_header) +
+							sizeof (struct pgm_opt_batch);
+			opt_batch = (struct pgm_opt_batch*)(opt_header + 1);
+			opt_batch->opt_reserved	  = 0;
+			opt_batch->batch_reserved = 0;
+			opt_batch->batch_count	  = pgm_htons (batch_count);
+			opt_header = (struct pgm_opt_header*)((char*)opt_header + opt_header->opt_length);
+		}
+		opt_len->opt_total_length = pgm_htons ((uint16_t)((char*)opt_header - (char*)opt_len));
+		data = opt_header;
+		unfolded_header = add32_with_carry (unfolded_header, pgm_csum_partial (opt_len, (uint16_t)((char*)opt_header - (char*)opt_len), 0));
 	}
 	const size_t   pgm_header_len		= (char*)data - (char*)STATE(skb)->pgm_header;
-	const uint32_t unfolded_header		= pgm_csum_partial (STATE(skb)->pgm_header, (uint16_t)pgm_header_len, 0);
-	STATE(unfolded_odata)			= pgm_csum_partial_copy (tsdu, data, (uint16_t)tsdu_length, 0);
-	STATE(skb)->pgm_header->pgm_checksum	= pgm_csum_fold (pgm_csum_block_add (unfolded_header, STATE(unfolded_odata), (uint16_t)pgm_header_len));
+	STATE(unfolded_odata)			= source_csum_partial_copy (sock, tsdu, data, (uint16_t)tsdu_length);
+	STATE(skb)->pgm_header->pgm_checksum	= source_csum_fold (sock, unfolded_header, STATE(unfolded_odata), (uint16_t)pgm_header_len);
 
 /* add to transmit window, skb::data set to payload */
-	pgm_spinlock_lock (&sock->txw_spinlock);
 	pgm_txw_add (sock->window, STATE(skb));
-	pgm_spinlock_unlock (&sock->txw_spinlock);
 
-/* check rate limit at last moment */
+/* check rate limit at last moment, a priority class is charged to the total
+ * without waiting behind original data.
+ */
 	STATE(is_rate_limited) = FALSE;
-	if (sock->is_nonblocking && sock->is_controlled_odata)
+	if (priority)
+	{
+		if (!pgm_rate_check_priority (&sock->rate_control,			/* total rate limit */
+					      &sock->priority_rate_control[priority],	/* class limit */
+					      tpdu_length,
+					      sock->is_nonblocking))
+		{
+			sock->is_apdu_eagain = TRUE;
+			sock->blocklen = tpdu_length + sock->iphdr_len;
+			return PGM_IO_STATUS_RATE_LIMITED;
+		}
+		STATE(is_rate_limited) = TRUE;
+	}
+	else if (sock->is_nonblocking && sock->is_controlled_odata)
 	{
 		if (!pgm_rate_check2 (&sock->rate_control,		/* total rate limit */
 				      &sock->odata_rate_control,	/* original data limit */
@@ -1356,7 +2961,7 @@ send_odata_copy (
 retry_send:
 
 /* congestion control: early exit on empty token bucket */
-	if (sock->use_pgmcc && 
+	if (use_pgmcc && 
 	    sock->tokens < pgm_fp8 (1))
 	{
 //		pgm_trace (PGM_LOG_ROLE_CONGESTION_CONTROL,_("Token limit reached."));
@@ -1365,14 +2970,20 @@ retry_send:
 		return PGM_IO_STATUS_CONGESTION;
 	}
 
-	sent = pgm_sendto (sock,
-			   !STATE(is_rate_limited),	/* rate limit on blocking */
-			   &sock->odata_rate_control,
-			   FALSE,			/* regular socket */
-			   STATE(skb)->head,
-			   tpdu_length,
-			   (struct sockaddr*)&sock->send_gsr.gsr_group,
-			   pgm_sockaddr_len((struct sockaddr*)&sock->send_gsr.gsr_group));
+	if (PGM_UNLIKELY(STATE(priority)))
+		sent = pgm_sendto_tos (sock,
+				       FALSE,			/* charged above */
+				       NULL,
+				       sock->priority_req[STATE(priority)].pr_tos,
+				       STATE(skb)->head,
+				       tpdu_length,
+				       (struct sockaddr*)&sock->send_gsr.gsr_group,
+				       pgm_sockaddr_len((struct sockaddr*)&sock->send_gsr.gsr_group));
+	else
+		sent = source_sendto_odata (sock,
+				            !STATE(is_rate_limited),	/* rate limit on blocking */
+				            STATE(skb)->head,
+				            tpdu_length);
 	if (sent < 0) {
 		const int save_errno = pgm_get_last_sock_error();
 		if (PGM_LIKELY(PGM_SOCK_EAGAIN == save_errno || PGM_SOCK_ENOBUFS == save_errno))
@@ -1381,7 +2992,7 @@ retry_send:
 			sock->blocklen = tpdu_length + sock->iphdr_len;
 			if (PGM_SOCK_ENOBUFS == save_errno)
 				return PGM_IO_STATUS_RATE_LIMITED;
-			if (sock->use_pgmcc)
+			if (use_pgmcc)
 				pgm_notify_clear (&sock->ack_notify);
 			return PGM_IO_STATUS_WOULD_BLOCK;
 		}
@@ -1390,11 +3001,14 @@ retry_send:
 
 /* success */
 	sock->is_apdu_eagain = FALSE;
+/* send call to wire, restarted when resuming a blocked send */
+	PGM_HISTOGRAM_SAMPLED_TIMES("Tx.OdataSendTime", pgm_ntohl (STATE(skb)->pgm_data->data_sqn), pgm_time_update_now() - STATE(skb)->tstamp);
+	tx_tstamp_reap (sock);
 /* SPM heartbeats decay from last sent data packet */
 	reset_heartbeat_spm (sock, STATE(skb)->tstamp);
 /* congestion control: remove token from bucket */
-	if (sock->use_pgmcc) {
-		sock->tokens -= pgm_fp8 (1);
+	if (use_pgmcc) {
+		sock->cc->on_send (sock);
 		pgm_trace (PGM_LOG_ROLE_CONGESTION_CONTROL,_("PGMCC tokens-- (T:%u W:%u)"),
 		 	   pgm_fp8tou (sock->tokens), pgm_fp8tou (sock->cwnd_size));
 		sock->ack_expiry = STATE(skb)->tstamp + sock->ack_expiry_ivl;
@@ -1403,45 +3017,134 @@ retry_send:
 	pgm_txw_set_unfolded_checksum (STATE(skb), STATE(unfolded_odata));
 /* increment socket statistics */
 	if (PGM_LIKELY((size_t)sent == tpdu_length)) {
-		sock->cumulative_stats[PGM_PC_SOURCE_DATA_BYTES_SENT] += tsdu_length;
-		sock->cumulative_stats[PGM_PC_SOURCE_DATA_MSGS_SENT]  ++;
-		pgm_atomic_add32 (&sock->cumulative_stats[PGM_PC_SOURCE_BYTES_SENT], (uint32_t)(tpdu_length + sock->iphdr_len));
+		pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_DATA_BYTES_SENT, tsdu_length);
+		pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_DATA_MSGS_SENT);
+		pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_BYTES_SENT, tpdu_length + sock->iphdr_len);
 	}
 /* check for end of transmission group for pro-active packets */
-	if (sock->use_proactive_parity) {
+	if (use_fec && sock->use_proactive_parity) {
 		const uint32_t odata_sqn = pgm_ntohl (STATE(skb)->pgm_data->data_sqn);
 		const uint32_t tg_sqn_mask = 0xffffffff << sock->tg_sqn_shift;
 		if (!((odata_sqn + 1) & ~tg_sqn_mask))
 			pgm_schedule_proactive_nak (sock, odata_sqn & tg_sqn_mask);
 	}
+	if (use_fec && sock->use_sliding_fec)
+		send_sw_repair (sock, pgm_ntohl (STATE(skb)->pgm_data->data_sqn));
 
 /* return data payload length sent */
 	if (bytes_written)
 		*bytes_written = tsdu_length;
+	PGM_PROFILE_END (PGM_PROFILE_SEND_ODATA, send_start, 1);
 	return PGM_IO_STATUS_NORMAL;
 }
 
-/* send one PGM original data packet, callee owned scatter/gather io vector
- *
- *    ⎢ DATA₀ ⎢
- *    ⎢ DATA₁ ⎢ → send_odatav() →  ⎢ TSDU₀ ⎢ → libc
- *    ⎢   ⋮   ⎢
- *
- * on success, returns PGM_IO_STATUS_NORMAL, on block for non-blocking sockets
- * returns PGM_IO_STATUS_WOULD_BLOCK, returns PGM_IO_STATUS_RATE_LIMITED if
- * packet size exceeds the current rate limit.
+/* generic send path, any socket configuration.
  */
 
 static
 int
-send_odatav (
-	pgm_sock_t*		const restrict sock,
-	const struct pgm_iovec* const restrict vector,
-	const unsigned			       count,		/* number of items in vector */
-	size_t*		 	      restrict bytes_written
-	)
-{
-	char		*dst;
+send_odata_copy_generic (
+	pgm_sock_t*      const restrict	sock,
+	const void*	       restrict	tsdu,
+	const uint16_t			tsdu_length,
+	const uint16_t			batch_count,
+	size_t*		       restrict	bytes_written
+	)
+{
+	return _send_odata_copy (sock, tsdu, tsdu_length, batch_count, bytes_written, sock->use_pgmcc, TRUE, 0);
+}
+
+/* send path without congestion control or FEC.
+ */
+
+static
+int
+send_odata_copy_plain (
+	pgm_sock_t*      const restrict	sock,
+	const void*	       restrict	tsdu,
+	const uint16_t			tsdu_length,
+	const uint16_t			batch_count,
+	size_t*		       restrict	bytes_written
+	)
+{
+	return _send_odata_copy (sock, tsdu, tsdu_length, batch_count, bytes_written, FALSE, FALSE, 0);
+}
+
+/* send path of a priority class, any socket configuration.
+ */
+
+static
+int
+send_odata_copy_priority (
+	pgm_sock_t*      const restrict	sock,
+	const void*	       restrict	tsdu,
+	const uint16_t			tsdu_length,
+	const unsigned			priority,
+	size_t*		       restrict	bytes_written
+	)
+{
+	return _send_odata_copy (sock, tsdu, tsdu_length, 0, bytes_written, sock->use_pgmcc, TRUE, priority);
+}
+
+/* send one PGM original data packet through the path bound to the socket.
+ */
+
+static inline
+int
+send_odata_copy (
+	pgm_sock_t*      const restrict	sock,
+	const void*	       restrict	tsdu,
+	const uint16_t			tsdu_length,
+	const uint16_t			batch_count,	/* 0 = not coalesced */
+	size_t*		       restrict	bytes_written
+	)
+{
+	pgm_assert (NULL != sock->odata_copy);
+	return sock->odata_copy (sock, tsdu, tsdu_length, batch_count, bytes_written);
+}
+
+/* bind the original data send path matching the socket configuration, which
+ * is fixed once bound, and build the ODATA header template.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_source_select_send (
+	pgm_sock_t* const	sock
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+
+	source_build_odata_template (sock);
+	const bool use_fec = sock->use_proactive_parity || sock->use_sliding_fec;
+	sock->odata_copy = (sock->use_pgmcc || use_fec) ? send_odata_copy_generic : send_odata_copy_plain;
+	pgm_debug ("pgm_source_select_send (sock:%p) %s", (const void*)sock,
+		(sock->use_pgmcc || use_fec) ? "generic" : "plain");
+}
+
+/* send one PGM original data packet, callee owned scatter/gather io vector
+ *
+ *    ⎢ DATA₀ ⎢
+ *    ⎢ DATA₁ ⎢ → send_odatav() →  ⎢ TSDU₀ ⎢ → libc
+ *    ⎢   ⋮   ⎢
+ *
+ * on success, returns PGM_IO_STATUS_NORMAL, on block for non-blocking sockets
+ * returns PGM_IO_STATUS_WOULD_BLOCK, returns PGM_IO_STATUS_RATE_LIMITED if
+ * packet size exceeds the current rate limit.
+ */
+
+static
+int
+send_odatav (
+	pgm_sock_t*		const restrict sock,
+	const struct pgm_iovec* const restrict vector,
+	const uint32_t*		      restrict csums,		/* precomputed checksums of vector or NULL */
+	const unsigned			       count,		/* number of items in vector */
+	size_t*		 	      restrict bytes_written
+	)
+{
+	char		*dst;
 	size_t		 tpdu_length;
 	ssize_t		 sent;
 
@@ -1454,7 +3157,9 @@ send_odatav (
 		(const void*)sock, (const void*)vector, count, (const void*)bytes_written);
 
 	if (PGM_UNLIKELY(0 == count))
-		return send_odata_copy (sock, NULL, 0, bytes_written);
+		return send_odata_copy (sock, NULL, 0, 0, bytes_written);
+
+	PGM_PROFILE_BEGIN (send_start);
 
 /* continue if blocked on send */
 	if (sock->is_apdu_eagain) {
@@ -1475,14 +3180,14 @@ send_odatav (
 	}
 	pgm_return_val_if_fail (STATE(tsdu_length) <= sock->max_tsdu, PGM_IO_STATUS_ERROR);
 
-	STATE(skb) = pgm_alloc_skb (sock->max_tpdu);
+	STATE(skb) = pgm_skb_pool_alloc (sock->txw_skb_pool, sock->max_tpdu);
 	STATE(skb)->sock = sock;
 	STATE(skb)->tstamp = pgm_time_update_now();
 	const sa_family_t pgmcc_family = sock->use_pgmcc ? sock->family : 0;
 	pgm_skb_reserve (STATE(skb), (uint16_t)pgm_pkt_offset (FALSE, pgmcc_family));
 	pgm_skb_put (STATE(skb), (uint16_t)STATE(tsdu_length));
 
-	STATE(skb)->pgm_header  = (struct pgm_header*)STATE(skb)->data;
+	STATE(skb)->pgm_header  = (struct pgm_header*)STATE(skb)->head;
 	STATE(skb)->pgm_data    = (struct pgm_data*)(STATE(skb)->pgm_header + 1);
 	memcpy (STATE(skb)->pgm_header->pgm_gsi, &sock->tsi.gsi, sizeof(pgm_gsi_t));
 	STATE(skb)->pgm_header->pgm_sport	= sock->tsi.sport;
@@ -1493,7 +3198,7 @@ send_odatav (
 
 /* ODATA */
 	STATE(skb)->pgm_data->data_sqn		= pgm_htonl (pgm_txw_next_lead(sock->window));
-	STATE(skb)->pgm_data->data_trail	= pgm_htonl (pgm_txw_trail(sock->window));
+	STATE(skb)->pgm_data->data_trail	= pgm_htonl (pgm_txw_repair_trail(sock->window));
 
 	STATE(skb)->pgm_header->pgm_checksum	= 0;
 	const size_t   pgm_header_len		= (char*)(STATE(skb)->pgm_data + 1) - (char*)STATE(skb)->pgm_header;
@@ -1501,21 +3206,19 @@ send_odatav (
 
 /* unroll first iteration to make friendly branch prediction */
 	dst			= (char*)(STATE(skb)->pgm_data + 1);
-	STATE(unfolded_odata)	= pgm_csum_partial_copy ((const char*)vector[0].iov_base, dst, (uint16_t)vector[0].iov_len, 0);
+	STATE(unfolded_odata)	= source_csum_copy_buffer (sock, csums, (const char*)vector[0].iov_base, dst, (uint16_t)vector[0].iov_len);
 
 /* iterate over one or more vector elements to perform scatter/gather checksum & copy */
 	for (unsigned i = 1; i < count; i++) {
 		dst += vector[i-1].iov_len;
-		const uint32_t unfolded_element = pgm_csum_partial_copy ((const char*)vector[i].iov_base, dst, (uint16_t)vector[i].iov_len, 0);
+		const uint32_t unfolded_element = source_csum_copy_buffer (sock, csums ? &csums[i] : NULL, (const char*)vector[i].iov_base, dst, (uint16_t)vector[i].iov_len);
 		STATE(unfolded_odata) = pgm_csum_block_add (STATE(unfolded_odata), unfolded_element, (uint16_t)vector[i-1].iov_len);
 	}
 
-	STATE(skb)->pgm_header->pgm_checksum	= pgm_csum_fold (pgm_csum_block_add (unfolded_header, STATE(unfolded_odata), (uint16_t)pgm_header_len));
+	STATE(skb)->pgm_header->pgm_checksum	= source_csum_fold (sock, unfolded_header, STATE(unfolded_odata), (uint16_t)pgm_header_len);
 
 /* add to transmit window, skb::data set to payload */
-	pgm_spinlock_lock (&sock->txw_spinlock);
 	pgm_txw_add (sock->window, STATE(skb));
-	pgm_spinlock_unlock (&sock->txw_spinlock);
 
 	pgm_assert ((char*)STATE(skb)->tail > (char*)STATE(skb)->head);
 	tpdu_length = (char*)STATE(skb)->tail - (char*)STATE(skb)->head;
@@ -1537,14 +3240,10 @@ send_odatav (
 	}
 
 retry_send:
-	sent = pgm_sendto (sock,
-			   !STATE(is_rate_limited),	/* rate limit on blocking */
-			   &sock->odata_rate_control,
-			   FALSE,			/* regular socket */
-			   STATE(skb)->head,
-			   tpdu_length,
-			   (struct sockaddr*)&sock->send_gsr.gsr_group,
-			   pgm_sockaddr_len((struct sockaddr*)&sock->send_gsr.gsr_group));
+	sent = source_sendto_odata (sock,
+			            !STATE(is_rate_limited),	/* rate limit on blocking */
+			            STATE(skb)->head,
+			            tpdu_length);
 	if (sent < 0) {
 		const int save_errno = pgm_get_last_sock_error();
 		if (PGM_LIKELY(PGM_SOCK_EAGAIN == save_errno || PGM_SOCK_ENOBUFS == save_errno))
@@ -1562,15 +3261,18 @@ retry_send:
 
 /* success */
 	sock->is_apdu_eagain = FALSE;
+/* send call to wire, restarted when resuming a blocked send */
+	PGM_HISTOGRAM_SAMPLED_TIMES("Tx.OdataSendTime", pgm_ntohl (STATE(skb)->pgm_data->data_sqn), pgm_time_update_now() - STATE(skb)->tstamp);
+	tx_tstamp_reap (sock);
 /* SPM heartbeats decay from last sent data packet */
 	reset_heartbeat_spm (sock, STATE(skb)->tstamp);
 /* save unfolded odata for retransmissions */
 	pgm_txw_set_unfolded_checksum (STATE(skb), STATE(unfolded_odata));
 /* increment socket statistics */
 	if (PGM_LIKELY((size_t)sent == STATE(skb)->len)) {
-		sock->cumulative_stats[PGM_PC_SOURCE_DATA_BYTES_SENT] += STATE(tsdu_length);
-		sock->cumulative_stats[PGM_PC_SOURCE_DATA_MSGS_SENT]  ++;
-		pgm_atomic_add32 (&sock->cumulative_stats[PGM_PC_SOURCE_BYTES_SENT], (uint32_t)(tpdu_length + sock->iphdr_len));
+		pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_DATA_BYTES_SENT, STATE(tsdu_length));
+		pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_DATA_MSGS_SENT);
+		pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_BYTES_SENT, tpdu_length + sock->iphdr_len);
 	}
 /* check for end of transmission group */
 	if (sock->use_proactive_parity) {
@@ -1579,15 +3281,20 @@ retry_send:
 		if (!((odata_sqn + 1) & ~tg_sqn_mask))
 			pgm_schedule_proactive_nak (sock, odata_sqn & tg_sqn_mask);
 	}
+	if (sock->use_sliding_fec)
+		send_sw_repair (sock, pgm_ntohl (STATE(skb)->pgm_data->data_sqn));
 
 /* return data payload length sent */
 	if (bytes_written)
 		*bytes_written = STATE(tsdu_length);
+	PGM_PROFILE_END (PGM_PROFILE_SEND_ODATA, send_start, 1);
 	return PGM_IO_STATUS_NORMAL;
 }
 
 /* send PGM original data, callee owned memory.  if larger than maximum TPDU
- * size will be fragmented.
+ * size will be fragmented.  a compressed APDU carries opt_compress in every
+ * TPDU, the uncompressed length is returned in bytes_written.  a conflated
+ * APDU carries opt_conflate and must fit one TPDU.
  *
  * on success, returns PGM_IO_STATUS_NORMAL, on block for non-blocking sockets
  * returns PGM_IO_STATUS_WOULD_BLOCK, returns PGM_IO_STATUS_RATE_LIMITED if
@@ -1600,6 +3307,8 @@ send_apdu (
 	pgm_sock_t* 	 const restrict	sock,
 	const void*	       restrict	apdu,
 	const size_t			apdu_length,
+	const struct pgm_opt_compress* restrict opt_compress,	/* NULL = uncompressed */
+	const struct pgm_opt_conflate* restrict opt_conflate,	/* NULL = no key */
 	size_t*		       restrict	bytes_written
 	)
 {
@@ -1611,22 +3320,30 @@ send_apdu (
 	pgm_assert (NULL != sock);
 	pgm_assert (NULL != apdu);
 
+	PGM_PROFILE_BEGIN (send_start);
 	const sa_family_t pgmcc_family = sock->use_pgmcc ? sock->family : 0;
+	const size_t compress_length = opt_compress ? sizeof(struct pgm_opt_header) + sizeof(struct pgm_opt_compress) : 0;
+	const size_t conflate_length = opt_conflate ? sizeof(struct pgm_opt_header) + sizeof(struct pgm_opt_conflate) : 0;
+	const size_t max_tsdu = source_max_tsdu (sock, TRUE) - compress_length - conflate_length;
 
 /* continue if blocked mid-apdu */
 	if (sock->is_apdu_eagain)
 		goto retry_send;
 
-/* if non-blocking calculate total wire size and check rate limit */
+/* if non-blocking calculate total wire size and check rate limit, a queued APDU
+ * is owned by the send queue and instead rate limited per fragment, as is a large
+ * APDU that may exceed the bucket depth.
+ */
 	STATE(is_rate_limited) = FALSE;
-	if (sock->is_nonblocking && sock->is_controlled_odata)
+	if (sock->is_nonblocking && sock->is_controlled_odata && !sock->sendq_max &&
+	    apdu_length <= PGM_MAX_APDU)
 	{
-		const size_t header_length = pgm_pkt_offset (TRUE, pgmcc_family);
+		const size_t header_length = pgm_pkt_offset (TRUE, pgmcc_family) + compress_length + conflate_length;
 		size_t tpdu_length = 0;
 		size_t offset_	   = 0;
 
 		do {
-			const uint_fast16_t tsdu_length = (uint_fast16_t)MIN( source_max_tsdu (sock, TRUE), apdu_length - offset_ );
+			const uint_fast16_t tsdu_length = (uint_fast16_t)MIN( max_tsdu, apdu_length - offset_ );
 			tpdu_length += sock->iphdr_len + header_length + tsdu_length;
 			offset_ += tsdu_length;
 		} while (offset_ < apdu_length);
@@ -1652,10 +3369,10 @@ send_apdu (
 		ssize_t			 sent;
 
 /* retrieve packet storage from transmit window */
-		header_length = pgm_pkt_offset (TRUE, pgmcc_family);
-		STATE(tsdu_length) = MIN( source_max_tsdu (sock, TRUE), apdu_length - STATE(data_bytes_offset) );
+		header_length = pgm_pkt_offset (TRUE, pgmcc_family) + compress_length + conflate_length;
+		STATE(tsdu_length) = MIN( max_tsdu, apdu_length - STATE(data_bytes_offset) );
 
-		STATE(skb) = pgm_alloc_skb (sock->max_tpdu);
+		STATE(skb) = pgm_skb_pool_alloc (sock->txw_skb_pool, sock->max_tpdu);
 		STATE(skb)->sock = sock;
 		STATE(skb)->tstamp = pgm_time_update_now();
 		pgm_skb_reserve (STATE(skb), (uint16_t)header_length);
@@ -1672,17 +3389,33 @@ send_apdu (
 
 /* ODATA */
 		STATE(skb)->pgm_data->data_sqn		= pgm_htonl (pgm_txw_next_lead(sock->window));
-		STATE(skb)->pgm_data->data_trail	= pgm_htonl (pgm_txw_trail(sock->window));
+		STATE(skb)->pgm_data->data_trail	= pgm_htonl (pgm_txw_repair_trail(sock->window));
 
 /* OPT_LENGTH */
 		opt_len					= (struct pgm_opt_length*)(STATE(skb)->pgm_data + 1);
 		opt_len->opt_type			= PGM_OPT_LENGTH;
 		opt_len->opt_length			= sizeof(struct pgm_opt_length);
 		opt_len->opt_total_length		= pgm_htons ((uint16_t)(sizeof(struct pgm_opt_length) +
+									compress_length +
+									conflate_length +
 									sizeof(struct pgm_opt_header) +
 									sizeof(struct pgm_opt_fragment)));
-/* OPT_FRAGMENT */
 		opt_header				= (struct pgm_opt_header*)(opt_len + 1);
+/* OPT_COMPRESS */
+		if (opt_compress) {
+			opt_header->opt_type		= PGM_OPT_COMPRESS;
+			opt_header->opt_length		= (uint8_t)compress_length;
+			memcpy (opt_header + 1, opt_compress, sizeof(struct pgm_opt_compress));
+			opt_header = (struct pgm_opt_header*)((char*)opt_header + compress_length);
+		}
+/* OPT_CONFLATE */
+		if (opt_conflate) {
+			opt_header->opt_type		= PGM_OPT_CONFLATE;
+			opt_header->opt_length		= (uint8_t)conflate_length;
+			memcpy (opt_header + 1, opt_conflate, sizeof(struct pgm_opt_conflate));
+			opt_header = (struct pgm_opt_header*)((char*)opt_header + conflate_length);
+		}
+/* OPT_FRAGMENT */
 		opt_header->opt_type			= PGM_OPT_FRAGMENT | PGM_OPT_END;
 		opt_header->opt_length			= sizeof(struct pgm_opt_header) +
 						  	  sizeof(struct pgm_opt_fragment);
@@ -1696,25 +3429,19 @@ send_apdu (
 		STATE(skb)->pgm_header->pgm_checksum	= 0;
 		const size_t   pgm_header_len		= (char*)(STATE(skb)->pgm_opt_fragment + 1) - (char*)STATE(skb)->pgm_header;
 		const uint32_t unfolded_header		= pgm_csum_partial (STATE(skb)->pgm_header, (uint16_t)pgm_header_len, 0);
-		STATE(unfolded_odata)			= pgm_csum_partial_copy ((const char*)apdu + STATE(data_bytes_offset), STATE(skb)->pgm_opt_fragment + 1, (uint16_t)STATE(tsdu_length), 0);
-		STATE(skb)->pgm_header->pgm_checksum	= pgm_csum_fold (pgm_csum_block_add (unfolded_header, STATE(unfolded_odata), (uint16_t)pgm_header_len));
+		STATE(unfolded_odata)			= source_csum_partial_copy (sock, (const char*)apdu + STATE(data_bytes_offset), STATE(skb)->pgm_opt_fragment + 1, (uint16_t)STATE(tsdu_length));
+		STATE(skb)->pgm_header->pgm_checksum	= source_csum_fold (sock, unfolded_header, STATE(unfolded_odata), (uint16_t)pgm_header_len);
 
 /* add to transmit window, skb::data set to payload */
-		pgm_spinlock_lock (&sock->txw_spinlock);
 		pgm_txw_add (sock->window, STATE(skb));
-		pgm_spinlock_unlock (&sock->txw_spinlock);
 
 retry_send:
 		pgm_assert ((char*)STATE(skb)->tail > (char*)STATE(skb)->head);
 		tpdu_length = (char*)STATE(skb)->tail - (char*)STATE(skb)->head;
-		sent = pgm_sendto (sock,
-				   !STATE(is_rate_limited),	/* rate limit on blocking */
-			   	   &sock->odata_rate_control,
-				   FALSE,			/* regular socket */
-				   STATE(skb)->head,
-				   tpdu_length,
-				   (struct sockaddr*)&sock->send_gsr.gsr_group,
-				   pgm_sockaddr_len((struct sockaddr*)&sock->send_gsr.gsr_group));
+		sent = source_sendto_odata (sock,
+				            !STATE(is_rate_limited),	/* rate limit on blocking */
+				            STATE(skb)->head,
+				            tpdu_length);
 		if (sent < 0) {
 			save_errno = pgm_get_last_sock_error();
 			if (PGM_LIKELY(PGM_SOCK_EAGAIN == save_errno || PGM_SOCK_ENOBUFS == save_errno))
@@ -1728,6 +3455,8 @@ retry_send:
 
 /* save unfolded odata for retransmissions */
 		pgm_txw_set_unfolded_checksum (STATE(skb), STATE(unfolded_odata));
+		PGM_HISTOGRAM_SAMPLED_TIMES("Tx.OdataSendTime", pgm_ntohl (STATE(skb)->pgm_data->data_sqn), pgm_time_update_now() - STATE(skb)->tstamp);
+		tx_tstamp_reap (sock);
 
 		if (PGM_LIKELY((size_t)sent == tpdu_length)) {
 			bytes_sent += tpdu_length + sock->iphdr_len;	/* as counted at IP layer */
@@ -1744,6 +3473,8 @@ retry_send:
 			if (!((odata_sqn + 1) & ~tg_sqn_mask))
 				pgm_schedule_proactive_nak (sock, odata_sqn & tg_sqn_mask);
 		}
+		if (sock->use_sliding_fec)
+			send_sw_repair (sock, pgm_ntohl (STATE(skb)->pgm_data->data_sqn));
 
 	} while ( STATE(data_bytes_offset)  < apdu_length);
 	pgm_assert( STATE(data_bytes_offset) == apdu_length );
@@ -1753,19 +3484,20 @@ retry_send:
 /* SPM heartbeats decay from last sent data packet */
 	reset_heartbeat_spm (sock, STATE(skb)->tstamp);
 /* increment socket statistics */
-	pgm_atomic_add32 (&sock->cumulative_stats[PGM_PC_SOURCE_BYTES_SENT], (uint32_t)bytes_sent);
-	sock->cumulative_stats[PGM_PC_SOURCE_DATA_MSGS_SENT]  += packets_sent;
-	sock->cumulative_stats[PGM_PC_SOURCE_DATA_BYTES_SENT] += data_bytes_sent;
+	pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_BYTES_SENT, bytes_sent);
+	pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_DATA_MSGS_SENT, packets_sent);
+	pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_DATA_BYTES_SENT, data_bytes_sent);
 	if (bytes_written)
 		*bytes_written = apdu_length;
+	PGM_PROFILE_END (PGM_PROFILE_SEND_ODATA, send_start, packets_sent);
 	return PGM_IO_STATUS_NORMAL;
 
 blocked:
 	if (bytes_sent) {
 		reset_heartbeat_spm (sock, STATE(skb)->tstamp);
-		pgm_atomic_add32 (&sock->cumulative_stats[PGM_PC_SOURCE_BYTES_SENT], (uint32_t)bytes_sent);
-		sock->cumulative_stats[PGM_PC_SOURCE_DATA_MSGS_SENT]  += packets_sent;
-		sock->cumulative_stats[PGM_PC_SOURCE_DATA_BYTES_SENT] += data_bytes_sent;
+		pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_BYTES_SENT, bytes_sent);
+		pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_DATA_MSGS_SENT, packets_sent);
+		pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_DATA_BYTES_SENT, data_bytes_sent);
 	}
 	if (PGM_SOCK_ENOBUFS == save_errno)
 		return PGM_IO_STATUS_RATE_LIMITED;
@@ -1774,201 +3506,893 @@ blocked:
 	return PGM_IO_STATUS_WOULD_BLOCK;
 }
 
-/* Send one APDU, whether it fits within one TPDU or more.
+/* send one APDU of at most PGM_MAX_APDU bytes compressed with OPT_COMPRESS when
+ * smaller by at least the option, and by OPT_FRAGMENT for an APDU that fits one
+ * TPDU, otherwise as is.  the compressed APDU is held by the socket whilst
+ * blocked, the same APDU must be repeated to resume.  opt_conflate is carried
+ * either way.
  *
- * on success, returns PGM_IO_STATUS_NORMAL, on block for non-blocking sockets
- * returns PGM_IO_STATUS_WOULD_BLOCK, returns PGM_IO_STATUS_RATE_LIMITED if
- * packet size exceeds the current rate limit.
+ * on success, returns PGM_IO_STATUS_NORMAL, otherwise as send_apdu().
  */
 
+static
 int
-pgm_send (
-	pgm_sock_t* 	 const restrict sock,
+send_apdu_compressed (
+	pgm_sock_t* 	 const restrict	sock,
 	const void*	       restrict	apdu,
 	const size_t			apdu_length,
-	size_t*	       	       restrict	bytes_written
+	const struct pgm_opt_conflate* restrict opt_conflate,	/* NULL = no key */
+	size_t*		       restrict	bytes_written
 	)
 {
-	pgm_debug ("pgm_send (sock:%p apdu:%p apdu-length:%" PRIzu " bytes-written:%p)",
-		(void*)sock, apdu, apdu_length, (void*)bytes_written);
+	struct pgm_opt_compress opt_compress;
+	int status;
 
-/* parameters */
-	pgm_return_val_if_fail (NULL != sock, PGM_IO_STATUS_ERROR);
-	if (PGM_LIKELY(apdu_length)) pgm_return_val_if_fail (NULL != apdu, PGM_IO_STATUS_ERROR);
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != sock->compress_buf);
+	pgm_assert_cmpuint (apdu_length, <=, PGM_MAX_APDU);
+
+	if (!sock->is_apdu_eagain) {
+		const size_t overhead = sizeof(struct pgm_opt_header) + sizeof(struct pgm_opt_compress) +
+					(opt_conflate ? sizeof(struct pgm_opt_header) + sizeof(struct pgm_opt_conflate) : 0) +
+					(apdu_length <= sock->max_tsdu ? sock->max_tsdu - sock->max_tsdu_fragment : 0);
+		sock->compress_len = (apdu_length > overhead) ?
+			pgm_compress (sock->compress, apdu, apdu_length, sock->compress_buf, apdu_length - overhead) : 0;
+	}
+	if (0 == sock->compress_len)
+		return (apdu_length <= sock->max_tsdu && NULL == opt_conflate) ?
+			send_odata_copy (sock, apdu, (uint16_t)apdu_length, 0, bytes_written) :
+			send_apdu (sock, apdu, apdu_length, NULL, opt_conflate, bytes_written);
+
+	opt_compress.opt_reserved	= 0;
+	opt_compress.compress_type	= (uint8_t)sock->compress_req.cr_type;
+	opt_compress.compress_dict_id	= pgm_htons ((uint16_t)sock->compress_req.cr_dict_id);
+	opt_compress.compress_apdu_len	= pgm_htonl ((uint32_t)apdu_length);
+	status = send_apdu (sock, sock->compress_buf, sock->compress_len, &opt_compress, opt_conflate, NULL);
+	if (PGM_IO_STATUS_NORMAL == status) {
+		sock->compress_len = 0;
+		if (bytes_written)
+			*bytes_written = apdu_length;
+	}
+	return status;
+}
 
-/* shutdown */
-	if (PGM_UNLIKELY(!pgm_rwlock_reader_trylock (&sock->lock)))
-		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
+/* fill opt_conflate for an APDU holding a key that fits one TPDU with the
+ * option, linking the last APDU sent of the same key.
+ *
+ * returns TRUE if the APDU is to carry the option, FALSE to send as is.
+ */
 
-/* state */
-	if (PGM_UNLIKELY(!sock->is_bound ||
-	    sock->is_destroyed ||
-	    apdu_length > sock->max_apdu))
-	{
-		pgm_rwlock_reader_unlock (&sock->lock);
-		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
-	}
+static
+bool
+source_conflate_opt (
+	pgm_sock_t*		const restrict sock,
+	const void*		      restrict apdu,
+	const size_t			       apdu_length,
+	struct pgm_opt_conflate*      restrict opt_conflate,
+	uint64_t*		      restrict key
+	)
+{
+	uint32_t prev_sqn;
 
-/* source */
-	pgm_mutex_lock (&sock->source_mutex);
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != sock->conflate);
+	pgm_assert (NULL != opt_conflate);
+	pgm_assert (NULL != key);
 
-/* pass on non-fragment calls */
-	if (apdu_length <= sock->max_tsdu)
-	{
-		const int status = send_odata_copy (sock, apdu, (uint16_t)apdu_length, bytes_written);
-		pgm_mutex_unlock (&sock->source_mutex);
-		pgm_rwlock_reader_unlock (&sock->lock);
-		return status;
-	}
-	else
-	{
-		const int status = send_apdu (sock, apdu, (uint16_t)apdu_length, bytes_written);
-		pgm_mutex_unlock (&sock->source_mutex);
-		pgm_rwlock_reader_unlock (&sock->lock);
-		return status;
-	}
+	if (apdu_length + sizeof(struct pgm_opt_header) + sizeof(struct pgm_opt_conflate) > sock->max_tsdu_fragment ||
+	    !pgm_conflate_key (&sock->conflate_req, apdu, apdu_length, key))
+		return FALSE;
+	if (!pgm_conflate_lookup (sock->conflate, *key, &prev_sqn))
+		prev_sqn = pgm_txw_next_lead (sock->window);
+
+	memset (opt_conflate, 0, sizeof(struct pgm_opt_conflate));
+	opt_conflate->conflate_prev_sqn = pgm_htonl (prev_sqn);
+	memcpy (opt_conflate->conflate_key, key, sizeof(opt_conflate->conflate_key));
+	return TRUE;
 }
 
-/* send PGM original data, callee owned scatter/gather IO vector.  if larger than maximum TPDU
- * size will be fragmented.
- *
- * is_one_apdu = true:
- *
- *    ⎢ DATA₀ ⎢
- *    ⎢ DATA₁ ⎢ → pgm_sendv() →  ⎢ ⋯ TSDU₁ TSDU₀ ⎢ → libc
- *    ⎢   ⋮   ⎢
- *
- * is_one_apdu = false:
- *
- *    ⎢ APDU₀ ⎢                  ⎢ ⋯ TSDU₁,₀ TSDU₀,₀ ⎢
- *    ⎢ APDU₁ ⎢ → pgm_sendv() →  ⎢ ⋯ TSDU₁,₁ TSDU₀,₁ ⎢ → libc
- *    ⎢   ⋮   ⎢                  ⎢     ⋮       ⋮     ⎢
+/* send the pending coalesced messages as one TPDU marked with OPT_BATCH.  the
+ * messages are held until sent so that a blocked send resumes on the next call.
  *
- * on success, returns PGM_IO_STATUS_NORMAL, on block for non-blocking sockets
- * returns PGM_IO_STATUS_WOULD_BLOCK, returns PGM_IO_STATUS_RATE_LIMITED if
- * packet size exceeds the current rate limit.
+ * on success, returns PGM_IO_STATUS_NORMAL, otherwise as send_odata_copy().
  */
 
+static
 int
-pgm_sendv (
-	pgm_sock_t*		const restrict sock,
-	const struct pgm_iovec* const restrict vector,
-	const unsigned			       count,		/* number of items in vector */
-	const bool			       is_one_apdu,	/* true  = vector = apdu, false = vector::iov_base = apdu */
-        size_t*                       restrict bytes_written
+send_batch_pending (
+	pgm_sock_t* const	sock
 	)
 {
-	unsigned	packets_sent = 0;
-	size_t		bytes_sent = 0;
-	size_t		data_bytes_sent = 0;
-	int		save_errno;
-
-	pgm_debug ("pgm_sendv (sock:%p vector:%p count:%u is-one-apdu:%s bytes-written:%p)",
-		(const void*)sock,
-		(const void*)vector,
-		count,
-		is_one_apdu ? "TRUE" : "FALSE",
-		(const void*)bytes_written);
+	int status;
 
-	pgm_return_val_if_fail (NULL != sock, PGM_IO_STATUS_ERROR);
-	pgm_return_val_if_fail (count <= PGM_MAX_FRAGMENTS, PGM_IO_STATUS_ERROR);
-	if (PGM_LIKELY(count)) pgm_return_val_if_fail (NULL != vector, PGM_IO_STATUS_ERROR);
-	if (PGM_UNLIKELY(!pgm_rwlock_reader_trylock (&sock->lock)))
-		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
-	if (PGM_UNLIKELY(!sock->is_bound ||
-	    sock->is_destroyed))
-	{
-		pgm_rwlock_reader_unlock (&sock->lock);
-		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
-	}
+/* pre-conditions */
+	pgm_assert (NULL != sock);
 
-	pgm_mutex_lock (&sock->source_mutex);
+	if (0 == sock->batch_count)
+		return PGM_IO_STATUS_NORMAL;
 
-/* pass on zero length as cannot count vector lengths */
-	if (PGM_UNLIKELY(0 == count))
-	{
-		const int status = send_odata_copy (sock, NULL, 0, bytes_written);
-		pgm_mutex_unlock (&sock->source_mutex);
-		pgm_rwlock_reader_unlock (&sock->lock);
+	status = send_odata_copy (sock, sock->batch_buf, sock->batch_len, sock->batch_count, NULL);
+	if (PGM_IO_STATUS_NORMAL != status)
 		return status;
-	}
 
-	const sa_family_t pgmcc_family = sock->use_pgmcc ? sock->family : 0;
+	sock->batch_len = sock->batch_count = 0;
+	pgm_sock_mutex_lock (sock, &sock->timer_mutex);
+	sock->batch_expiry = 0;
+	pgm_sock_mutex_unlock (sock, &sock->timer_mutex);
+	return PGM_IO_STATUS_NORMAL;
+}
 
-/* continue if blocked mid-apdu */
-	if (sock->is_apdu_eagain) {
-		if (is_one_apdu) {
-			if (STATE(apdu_length) <= sock->max_tsdu)
-			{
-				const int status = send_odatav (sock, vector, count, bytes_written);
-				pgm_mutex_unlock (&sock->source_mutex);
-				pgm_rwlock_reader_unlock (&sock->lock);
-				return status;
-			}
-			else
-				goto retry_one_apdu_send;
-		} else {
-			goto retry_send;
-		}
-	}
+/* pull the next timer poll forward to expiry, waking the rx or timer thread.
+ * called with the timer lock held.
+ */
 
-/* calculate (total) APDU length */
-	STATE(apdu_length)	= 0;
-	for (unsigned i = 0; i < count; i++)
+static
+void
+source_wake_timer (
+	pgm_sock_t*const	sock,
+	const pgm_time_t	expiry
+	)
+{
+	if (pgm_time_after( sock->next_poll, expiry ))
 	{
-#ifdef TRANSPORT_DEBUG
-		if (PGM_LIKELY(vector[i].iov_len)) {
-			pgm_assert( vector[i].iov_base );
-		}
-#endif
-		if (!is_one_apdu &&
-		    vector[i].iov_len > sock->max_apdu)
-		{
-			pgm_mutex_unlock (&sock->source_mutex);
-			pgm_rwlock_reader_unlock (&sock->lock);
-			pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
+		sock->next_poll = expiry;
+		if (!sock->is_pending_read) {
+			pgm_notify_send (&sock->pending_notify);
+			sock->is_pending_read = TRUE;
 		}
-		STATE(apdu_length) += vector[i].iov_len;
+		if (sock->use_timer_thread)
+			pgm_notify_send (&sock->timer_notify);
 	}
+}
 
-/* pass on non-fragment calls */
-	if (is_one_apdu) {
-		if (STATE(apdu_length) <= sock->max_tsdu) {
-			const int status = send_odatav (sock, vector, count, bytes_written);
-			pgm_mutex_unlock (&sock->source_mutex);
-			pgm_rwlock_reader_unlock (&sock->lock);
-			return status;
-		} else if (STATE(apdu_length) > sock->max_apdu) {
-			pgm_mutex_unlock (&sock->source_mutex);
-			pgm_rwlock_reader_unlock (&sock->lock);
-			pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
-		}
-	}
+/* schedule the timer to send messages coalesced from now.
+ */
 
-/* non-fragmented packets can be forwarded onto basic send() */
-	if (!is_one_apdu)
-	{
-		for (STATE(data_pkt_offset) = 0; STATE(data_pkt_offset) < count; STATE(data_pkt_offset)++)
-		{
-			int	status;
-			size_t	wrote_bytes;
-retry_send:
-			status = send_apdu (sock,
-					    vector[STATE(data_pkt_offset)].iov_base,
-					    vector[STATE(data_pkt_offset)].iov_len,
-					    &wrote_bytes);
-			switch (status) {
-			case PGM_IO_STATUS_NORMAL:
+static
+void
+schedule_batch_flush (
+	pgm_sock_t*const	sock,
+	const pgm_time_t	now
+	)
+{
+	pgm_sock_mutex_lock (sock, &sock->timer_mutex);
+	sock->batch_expiry = now + sock->batch_req.br_ivl;
+	source_wake_timer (sock, sock->batch_expiry);
+	pgm_sock_mutex_unlock (sock, &sock->timer_mutex);
+}
+
+/* schedule the timer to retry the blocked head of the send queue, after the
+ * rate limit allows it or a short interval for the kernel or congestion window.
+ */
+
+static
+void
+schedule_sendq_retry (
+	pgm_sock_t*const	sock,
+	const int		status
+	)
+{
+	pgm_time_t retry_ivl = PGM_SENDQ_RETRY_IVL;
+
+	if (PGM_IO_STATUS_RATE_LIMITED == status) {
+		const pgm_time_t remaining = pgm_rate_remaining2 (&sock->rate_control, &sock->odata_rate_control, sock->blocklen);
+		if (remaining > 0)
+			retry_ivl = remaining;
+	}
+
+	pgm_sock_mutex_lock (sock, &sock->timer_mutex);
+	sock->sendq_expiry = pgm_time_update_now() + retry_ivl;
+	source_wake_timer (sock, sock->sendq_expiry);
+	pgm_sock_mutex_unlock (sock, &sock->timer_mutex);
+}
+
+/* send queued APDUs in order until the queue is empty or the head blocks, the
+ * head is sent from its copy so a blocked send resumes on the next call.  the
+ * notify channel is raised when the queue empties or regains space after full.
+ *
+ * on success, returns PGM_IO_STATUS_NORMAL with the queue empty, otherwise as
+ * send_apdu() with the retry scheduled on the timer.
+ */
+
+static
+int
+send_sendq_pending (
+	pgm_sock_t* const	sock
+	)
+{
+	const bool was_full = sock->sendq_len == sock->sendq_max;
+	unsigned completed = 0;
+	int status = PGM_IO_STATUS_NORMAL;
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+
+	while (sock->sendq_len)
+	{
+		struct pgm_sendq_msg_t* msg = sock->sendq[ sock->sendq_head ];
+		status = (msg->len <= sock->max_tsdu) ?
+				send_odata_copy (sock, msg->data, (uint16_t)msg->len, 0, NULL) :
+				send_apdu (sock, msg->data, msg->len, NULL, NULL, NULL);
+		if (PGM_IO_STATUS_NORMAL != status)
+			break;
+		pgm_free (msg);
+		sock->sendq[ sock->sendq_head ] = NULL;
+		if (++sock->sendq_head == sock->sendq_max)
+			sock->sendq_head = 0;
+		sock->sendq_len--;
+		completed++;
+	}
+
+	if (PGM_IO_STATUS_NORMAL != status) {
+		if (PGM_IO_STATUS_ERROR != status)
+			schedule_sendq_retry (sock, status);
+	} else {
+		pgm_sock_mutex_lock (sock, &sock->timer_mutex);
+		sock->sendq_expiry = 0;
+		pgm_sock_mutex_unlock (sock, &sock->timer_mutex);
+	}
+
+	if (completed && (was_full || 0 == sock->sendq_len))
+		pgm_notify_send (&sock->sendq_notify);
+	return status;
+}
+
+/* send one APDU through the send queue: behind pending APDUs it is copied onto
+ * the tail, otherwise sent directly and copied only should the send block.
+ *
+ * returns PGM_IO_STATUS_NORMAL with the APDU sent or queued, on a full queue
+ * returns the status blocking its head, no state is held for the caller.
+ */
+
+static
+int
+send_queued (
+	pgm_sock_t* const restrict	sock,
+	const void*	  restrict	apdu,
+	const size_t			apdu_length,
+	size_t*		  restrict	bytes_written
+	)
+{
+	int status = PGM_IO_STATUS_NORMAL;
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (sock->sendq_max > 0);
+
+/* coalesced messages are sent first */
+	if (PGM_UNLIKELY(sock->batch_count)) {
+		status = send_batch_pending (sock);
+		if (PGM_IO_STATUS_NORMAL != status)
+			return status;
+	}
+
+	if (sock->sendq_len)
+		status = send_sendq_pending (sock);
+
+	if (PGM_IO_STATUS_NORMAL == status)
+	{
+		status = (apdu_length <= sock->max_tsdu) ?
+				send_odata_copy (sock, apdu, (uint16_t)apdu_length, 0, bytes_written) :
+				send_apdu (sock, apdu, apdu_length, NULL, NULL, bytes_written);
+		if (PGM_IO_STATUS_NORMAL == status || PGM_IO_STATUS_ERROR == status)
+			return status;
+/* blocked, the copy becomes the head and resumes the send */
+		schedule_sendq_retry (sock, status);
+	}
+	else if (PGM_IO_STATUS_ERROR == status)
+	{
+		return status;
+	}
+	else if (sock->sendq_len == sock->sendq_max)
+	{
+		pgm_notify_clear (&sock->sendq_notify);
+		return status;
+	}
+
+	struct pgm_sendq_msg_t* msg = pgm_malloc (sizeof (struct pgm_sendq_msg_t) + apdu_length);
+	msg->len = apdu_length;
+	if (PGM_LIKELY(apdu_length))
+		memcpy (msg->data, apdu, apdu_length);
+	sock->sendq[ (sock->sendq_head + sock->sendq_len++) % sock->sendq_max ] = msg;
+	pgm_notify_clear (&sock->sendq_notify);
+	if (bytes_written)
+		*bytes_written = apdu_length;
+	return PGM_IO_STATUS_NORMAL;
+}
+
+/* send one published TSDU, sequence, header and checksum are completed here
+ * under source_mutex, the payload checksum was folded by the producer.  the
+ * socket is blocking, a transient kernel refusal is retried.
+ */
+
+static
+void
+send_odata_published (
+	pgm_sock_t*	      const restrict sock,
+	struct pgm_sk_buff_t* const restrict skb
+	)
+{
+	ssize_t sent;
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != skb);
+
+	PGM_PROFILE_BEGIN (send_start);
+	const uint16_t tsdu_length    = skb->len;
+	const size_t   tpdu_length    = tsdu_length + pgm_pkt_offset (FALSE, 0);
+	const uint32_t unfolded_odata = pgm_txw_get_unfolded_checksum (skb);
+
+	skb->tstamp = pgm_time_update_now();
+	const uint32_t unfolded_header = source_odata_header (sock, skb, tsdu_length, FALSE);
+	skb->pgm_header->pgm_checksum = source_csum_fold (sock, unfolded_header, unfolded_odata, sizeof (struct pgm_header) + sizeof (struct pgm_data));
+
+/* window takes the producer reference */
+	pgm_txw_add (sock->window, skb);
+
+	for (;;) {
+		sent = source_sendto_odata (sock,
+				            TRUE,			/* rate limit on blocking */
+				            skb->head,
+				            tpdu_length);
+		if (sent >= 0)
+			break;
+		const int save_errno = pgm_get_last_sock_error();
+		if (PGM_SOCK_EAGAIN != save_errno && PGM_SOCK_ENOBUFS != save_errno)
+			break;				/* other errors fall through silently */
+		pgm_thread_yield();
+	}
+
+	PGM_HISTOGRAM_SAMPLED_TIMES("Tx.OdataSendTime", pgm_ntohl (skb->pgm_data->data_sqn), pgm_time_update_now() - skb->tstamp);
+	tx_tstamp_reap (sock);
+	reset_heartbeat_spm (sock, skb->tstamp);
+	if (PGM_LIKELY((size_t)sent == tpdu_length)) {
+		pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_DATA_BYTES_SENT, tsdu_length);
+		pgm_stats_inc (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_DATA_MSGS_SENT);
+		pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_BYTES_SENT, tpdu_length + sock->iphdr_len);
+	}
+	if (sock->use_proactive_parity) {
+		const uint32_t odata_sqn = pgm_ntohl (skb->pgm_data->data_sqn);
+		const uint32_t tg_sqn_mask = 0xffffffff << sock->tg_sqn_shift;
+		if (!((odata_sqn + 1) & ~tg_sqn_mask))
+			pgm_schedule_proactive_nak (sock, odata_sqn & tg_sqn_mask);
+	}
+	if (sock->use_sliding_fec)
+		send_sw_repair (sock, pgm_ntohl (skb->pgm_data->data_sqn));
+	PGM_PROFILE_END (PGM_PROFILE_SEND_ODATA, send_start, 1);
+}
+
+/* returns TRUE if the slot holds the TSDU of ticket, slots count the laps
+ * published modulo the laps of one cycle of tickets.
+ */
+
+static inline
+bool
+mp_is_published (
+	const pgm_sock_t*		const restrict sock,
+	const struct pgm_mp_slot_t*	const restrict slot,
+	const uint32_t				       ticket
+	)
+{
+	const uint32_t lap_mask = UINT32_MAX / sock->mp_len;
+	return 0 == ((pgm_atomic_read32 (&slot->published) - (ticket / sock->mp_len + 1)) & lap_mask);
+}
+
+/* send every contiguous published TSDU from the commit cursor in ticket order,
+ * caller holds source_mutex.
+ */
+
+static
+void
+mp_commit (
+	pgm_sock_t* const	sock
+	)
+{
+	for (;;)
+	{
+		const uint32_t ticket = pgm_atomic_read32 (&sock->mp_commit);
+		struct pgm_mp_slot_t* slot = &sock->mp_ring[ ticket & (sock->mp_len - 1) ];
+		if (!mp_is_published (sock, slot, ticket))
+			break;
+		struct pgm_sk_buff_t* skb = slot->skb;
+		slot->skb = NULL;
+/* release the slot to producers of the next lap */
+		pgm_atomic_inc32 (&sock->mp_commit);
+		send_odata_published (sock, skb);
+	}
+}
+
+/* publish one TSDU from any number of concurrent threads.  a ticket from an
+ * atomic add on the reservation cursor orders the TSDU, the copy and payload
+ * checksum proceed without a lock and the slot is published.  whichever
+ * producer next holds source_mutex sends every contiguous published TSDU, and
+ * each call returns once its own ticket has been committed, preserving order
+ * against any other send by the same thread.
+ *
+ * returns PGM_IO_STATUS_NORMAL.
+ */
+
+static
+int
+send_odata_mp (
+	pgm_sock_t*	 const restrict	sock,
+	const void*	       restrict	tsdu,
+	const uint16_t			tsdu_length,
+	size_t*		       restrict	bytes_written
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != sock->mp_ring);
+	pgm_assert (tsdu_length <= sock->max_tsdu);
+	if (PGM_LIKELY(tsdu_length)) pgm_assert (NULL != tsdu);
+
+	pgm_debug ("send_odata_mp (sock:%p tsdu:%p tsdu_length:%u bytes-written:%p)",
+		(void*)sock, tsdu, tsdu_length, (void*)bytes_written);
+
+	struct pgm_sk_buff_t* skb = pgm_skb_pool_alloc (sock->txw_skb_pool, sock->max_tpdu);
+	skb->sock = sock;
+	pgm_skb_reserve (skb, (uint16_t)pgm_pkt_offset (FALSE, 0));
+	pgm_skb_put (skb, tsdu_length);
+	pgm_txw_set_unfolded_checksum (skb, source_csum_partial_copy (sock, tsdu, skb->data, tsdu_length));
+
+	const uint32_t ticket = pgm_atomic_exchange_and_add32 (&sock->mp_reserve, 1);
+	struct pgm_mp_slot_t* slot = &sock->mp_ring[ ticket & (sock->mp_len - 1) ];
+/* wait for the slot of the previous lap to be committed */
+	while ((uint32_t)(ticket - pgm_atomic_read32 (&sock->mp_commit)) >= sock->mp_len)
+		pgm_thread_yield();
+	slot->skb = skb;
+	pgm_atomic_inc32 (&slot->published);
+
+	while ((int32_t)(pgm_atomic_read32 (&sock->mp_commit) - ticket) <= 0)
+	{
+		pgm_sock_mutex_lock (sock, &sock->source_mutex);
+		mp_commit (sock);
+		pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+/* an earlier ticket is still being copied */
+		if ((int32_t)(pgm_atomic_read32 (&sock->mp_commit) - ticket) <= 0)
+			pgm_thread_yield();
+	}
+
+	if (bytes_written)
+		*bytes_written = tsdu_length;
+	return PGM_IO_STATUS_NORMAL;
+}
+
+/* Send one APDU, whether it fits within one TPDU or more.  With PGM_SEND_QUEUE
+ * a blocked APDU is copied and queued, blocking only once the queue is full.
+ * With PGM_MULTI_PRODUCER one TPDU APDUs on a blocking socket are published
+ * concurrently by send_odata_mp().  Otherwise with PGM_COMPRESS APDUs are
+ * compressed by send_apdu_compressed().
+ *
+ * on success, returns PGM_IO_STATUS_NORMAL, on block for non-blocking sockets
+ * returns PGM_IO_STATUS_WOULD_BLOCK, returns PGM_IO_STATUS_RATE_LIMITED if
+ * packet size exceeds the current rate limit.
+ */
+
+int
+pgm_send (
+	pgm_sock_t* 	 const restrict sock,
+	const void*	       restrict	apdu,
+	const size_t			apdu_length,
+	size_t*	       	       restrict	bytes_written
+	)
+{
+	pgm_debug ("pgm_send (sock:%p apdu:%p apdu-length:%" PRIzu " bytes-written:%p)",
+		(void*)sock, apdu, apdu_length, (void*)bytes_written);
+
+/* parameters */
+	pgm_return_val_if_fail (NULL != sock, PGM_IO_STATUS_ERROR);
+	if (PGM_LIKELY(apdu_length)) pgm_return_val_if_fail (NULL != apdu, PGM_IO_STATUS_ERROR);
+
+/* shutdown */
+	if (PGM_UNLIKELY(!pgm_sock_reader_trylock (sock)))
+		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
+
+/* state */
+	if (PGM_UNLIKELY(!sock->is_bound ||
+	    sock->is_destroyed ||
+	    apdu_length > sock->max_apdu))
+	{
+		pgm_sock_reader_unlock (sock);
+		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
+	}
+
+/* standby until the primary fails */
+	if (PGM_UNLIKELY(sock->is_standby)) {
+		pgm_sock_reader_unlock (sock);
+		return PGM_IO_STATUS_WOULD_BLOCK;
+	}
+
+/* concurrent producers */
+	if (NULL != sock->mp_ring &&
+	    apdu_length <= sock->max_tsdu &&
+	    !sock->is_nonblocking &&
+	    !sock->is_apdu_eagain)
+	{
+		const int status = send_odata_mp (sock, apdu, (uint16_t)apdu_length, bytes_written);
+		pgm_sock_reader_unlock (sock);
+		return status;
+	}
+
+/* source */
+	pgm_sock_mutex_lock (sock, &sock->source_mutex);
+
+/* completion through the send queue */
+	if (sock->sendq_max)
+	{
+		const int status = send_queued (sock, apdu, apdu_length, bytes_written);
+		pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+		pgm_sock_reader_unlock (sock);
+		return status;
+	}
+
+/* coalesced messages are sent first */
+	if (PGM_UNLIKELY(sock->batch_count)) {
+		const int status = send_batch_pending (sock);
+		if (PGM_IO_STATUS_NORMAL != status) {
+			pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+			pgm_sock_reader_unlock (sock);
+			return status;
+		}
+	}
+
+/* last-value keyed, the key table follows completed sends */
+	if (NULL != sock->conflate)
+	{
+		struct pgm_opt_conflate opt_conflate;
+		uint64_t key;
+		if (source_conflate_opt (sock, apdu, apdu_length, &opt_conflate, &key)) {
+			const int status = (NULL != sock->compress_buf) ?
+				send_apdu_compressed (sock, apdu, apdu_length, &opt_conflate, bytes_written) :
+				send_apdu (sock, apdu, apdu_length, NULL, &opt_conflate, bytes_written);
+			if (PGM_IO_STATUS_NORMAL == status)
+				pgm_conflate_insert (sock->conflate, key, STATE(first_sqn));
+			pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+			pgm_sock_reader_unlock (sock);
+			return status;
+		}
+	}
+
+/* compressed whole */
+	if (NULL != sock->compress_buf && apdu_length <= PGM_MAX_APDU)
+	{
+		const int status = send_apdu_compressed (sock, apdu, apdu_length, NULL, bytes_written);
+		pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+		pgm_sock_reader_unlock (sock);
+		return status;
+	}
+
+/* pass on non-fragment calls */
+	if (apdu_length <= sock->max_tsdu)
+	{
+		const int status = send_odata_copy (sock, apdu, (uint16_t)apdu_length, 0, bytes_written);
+		pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+		pgm_sock_reader_unlock (sock);
+		return status;
+	}
+	else
+	{
+		const int status = send_apdu (sock, apdu, apdu_length, NULL, NULL, bytes_written);
+		pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+		pgm_sock_reader_unlock (sock);
+		return status;
+	}
+}
+
+/* Send one TPDU APDU in priority class 1 to 3, set by PGM_PRIORITY_CLASS.  The
+ * class bucket is paced on its own and overdrafts the socket total, so urgent
+ * messages never wait behind original data, and the datagram carries the
+ * class traffic class.  Queued, coalesced and compressed messages are passed
+ * over, a class of 0 is plain pgm_send().
+ *
+ * on success, returns PGM_IO_STATUS_NORMAL, on block for non-blocking sockets
+ * returns PGM_IO_STATUS_WOULD_BLOCK, including while an APDU of another class
+ * is blocked, returns PGM_IO_STATUS_RATE_LIMITED if the class budget is spent.
+ */
+
+int
+pgm_send_priority (
+	pgm_sock_t* 	 const restrict sock,
+	const void*	       restrict	apdu,
+	const size_t			apdu_length,
+	const unsigned			priority,
+	size_t*	       	       restrict	bytes_written
+	)
+{
+	pgm_debug ("pgm_send_priority (sock:%p apdu:%p apdu-length:%" PRIzu " priority:%u bytes-written:%p)",
+		(void*)sock, apdu, apdu_length, priority, (void*)bytes_written);
+
+	if (0 == priority)
+		return pgm_send (sock, apdu, apdu_length, bytes_written);
+
+/* parameters */
+	pgm_return_val_if_fail (NULL != sock, PGM_IO_STATUS_ERROR);
+	pgm_return_val_if_fail (priority < PGM_PRIORITY_CLASSES, PGM_IO_STATUS_ERROR);
+	if (PGM_LIKELY(apdu_length)) pgm_return_val_if_fail (NULL != apdu, PGM_IO_STATUS_ERROR);
+
+/* shutdown */
+	if (PGM_UNLIKELY(!pgm_sock_reader_trylock (sock)))
+		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
+
+/* state */
+	if (PGM_UNLIKELY(!sock->is_bound ||
+	    sock->is_destroyed ||
+	    apdu_length > sock->max_tsdu ||
+	    0 == sock->priority_req[priority].pr_max_rte))
+	{
+		pgm_sock_reader_unlock (sock);
+		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
+	}
+
+/* standby until the primary fails */
+	if (PGM_UNLIKELY(sock->is_standby)) {
+		pgm_sock_reader_unlock (sock);
+		return PGM_IO_STATUS_WOULD_BLOCK;
+	}
+
+/* source */
+	pgm_sock_mutex_lock (sock, &sock->source_mutex);
+
+/* the blocked TPDU of another call completes first */
+	if (PGM_UNLIKELY(sock->is_apdu_eagain && STATE(priority) != priority))
+	{
+		pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+		pgm_sock_reader_unlock (sock);
+		return PGM_IO_STATUS_WOULD_BLOCK;
+	}
+
+	const int status = send_odata_copy_priority (sock, apdu, (uint16_t)apdu_length, priority, bytes_written);
+	pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+	pgm_sock_reader_unlock (sock);
+	return status;
+}
+
+/* send PGM original data, callee owned scatter/gather IO vector.  if larger than maximum TPDU
+ * size will be fragmented.
+ *
+ * is_one_apdu = true:
+ *
+ *    ⎢ DATA₀ ⎢
+ *    ⎢ DATA₁ ⎢ → pgm_sendv() →  ⎢ ⋯ TSDU₁ TSDU₀ ⎢ → libc
+ *    ⎢   ⋮   ⎢
+ *
+ * is_one_apdu = false:
+ *
+ *    ⎢ APDU₀ ⎢                  ⎢ ⋯ TSDU₁,₀ TSDU₀,₀ ⎢
+ *    ⎢ APDU₁ ⎢ → pgm_sendv() →  ⎢ ⋯ TSDU₁,₁ TSDU₀,₁ ⎢ → libc
+ *    ⎢   ⋮   ⎢                  ⎢     ⋮       ⋮     ⎢
+ *
+ * on success, returns PGM_IO_STATUS_NORMAL, on block for non-blocking sockets
+ * returns PGM_IO_STATUS_WOULD_BLOCK, returns PGM_IO_STATUS_RATE_LIMITED if
+ * packet size exceeds the current rate limit.
+ */
+
+int
+pgm_sendv (
+	pgm_sock_t*		const restrict sock,
+	const struct pgm_iovec* const restrict vector,
+	const unsigned			       count,		/* number of items in vector */
+	const bool			       is_one_apdu,	/* true  = vector = apdu, false = vector::iov_base = apdu */
+        size_t*                       restrict bytes_written
+	)
+{
+	return _pgm_sendv (sock, vector, NULL, count, is_one_apdu, bytes_written);
+}
+
+/* unfolded checksum of an application buffer for pgm_sendv_csum() and
+ * pgm_send_skbv_csum(), valid for any socket.
+ */
+
+uint32_t
+pgm_csum_payload (
+	const void*		buf,
+	const size_t		len
+	)
+{
+	pgm_return_val_if_fail (len <= UINT16_MAX, 0);
+	if (PGM_LIKELY(len)) pgm_return_val_if_fail (NULL != buf, 0);
+	return pgm_csum_partial (buf, (uint16_t)len, 0);
+}
+
+/* as pgm_sendv() with the unfolded checksum of each vector element precomputed by
+ * pgm_csum_payload(), such that identical data published on many sockets is summed
+ * once.  a checksum is used where its element is one whole part of a TSDU of an
+ * APDU, otherwise as for APDUs of is_one_apdu false the element is summed again.
+ */
+
+int
+pgm_sendv_csum (
+	pgm_sock_t*		const restrict sock,
+	const struct pgm_iovec* const restrict vector,
+	const uint32_t*		const restrict csums,		/* length count */
+	const unsigned			       count,
+	const bool			       is_one_apdu,
+        size_t*                       restrict bytes_written
+	)
+{
+	if (PGM_LIKELY(count)) pgm_return_val_if_fail (NULL != csums, PGM_IO_STATUS_ERROR);
+	return _pgm_sendv (sock, vector, csums, count, is_one_apdu, bytes_written);
+}
+
+/* precomputed checksum of the vector element when copied whole at its start.
+ */
+
+static inline
+const uint32_t*
+source_whole_buffer (
+	const struct pgm_iovec* const restrict vector,
+	const uint32_t*		const restrict csums,
+	const unsigned			       index,
+	const size_t			       offset,
+	const size_t			       copy_length
+	)
+{
+	if (NULL == csums || 0 != offset || copy_length != vector[index].iov_len)
+		return NULL;
+	return &csums[index];
+}
+
+static
+int
+_pgm_sendv (
+	pgm_sock_t*		const restrict sock,
+	const struct pgm_iovec* const restrict vector,
+	const uint32_t*		      restrict csums,		/* precomputed checksums of vector or NULL */
+	const unsigned			       count,		/* number of items in vector */
+	const bool			       is_one_apdu,	/* true  = vector = apdu, false = vector::iov_base = apdu */
+        size_t*                       restrict bytes_written
+	)
+{
+	unsigned	packets_sent = 0;
+	size_t		bytes_sent = 0;
+	size_t		data_bytes_sent = 0;
+	int		save_errno;
+
+	pgm_debug ("pgm_sendv (sock:%p vector:%p count:%u is-one-apdu:%s bytes-written:%p)",
+		(const void*)sock,
+		(const void*)vector,
+		count,
+		is_one_apdu ? "TRUE" : "FALSE",
+		(const void*)bytes_written);
+
+	pgm_return_val_if_fail (NULL != sock, PGM_IO_STATUS_ERROR);
+	pgm_return_val_if_fail (count <= PGM_MAX_FRAGMENTS, PGM_IO_STATUS_ERROR);
+	if (PGM_LIKELY(count)) pgm_return_val_if_fail (NULL != vector, PGM_IO_STATUS_ERROR);
+	if (PGM_UNLIKELY(!pgm_sock_reader_trylock (sock)))
+		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
+	if (PGM_UNLIKELY(!sock->is_bound ||
+	    sock->is_destroyed))
+	{
+		pgm_sock_reader_unlock (sock);
+		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
+	}
+
+/* standby until the primary fails */
+	if (PGM_UNLIKELY(sock->is_standby)) {
+		pgm_sock_reader_unlock (sock);
+		return PGM_IO_STATUS_WOULD_BLOCK;
+	}
+
+	pgm_sock_mutex_lock (sock, &sock->source_mutex);
+
+/* coalesced messages are sent first */
+	if (PGM_UNLIKELY(sock->batch_count)) {
+		const int status = send_batch_pending (sock);
+		if (PGM_IO_STATUS_NORMAL != status) {
+			pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+			pgm_sock_reader_unlock (sock);
+			return status;
+		}
+	}
+
+/* and queued APDUs */
+	if (PGM_UNLIKELY(sock->sendq_len)) {
+		const int status = send_sendq_pending (sock);
+		if (PGM_IO_STATUS_NORMAL != status) {
+			pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+			pgm_sock_reader_unlock (sock);
+			return status;
+		}
+	}
+
+/* pass on zero length as cannot count vector lengths */
+	if (PGM_UNLIKELY(0 == count))
+	{
+		const int status = send_odata_copy (sock, NULL, 0, 0, bytes_written);
+		pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+		pgm_sock_reader_unlock (sock);
+		return status;
+	}
+
+	const sa_family_t pgmcc_family = sock->use_pgmcc ? sock->family : 0;
+
+/* continue if blocked mid-apdu */
+	if (sock->is_apdu_eagain) {
+		if (is_one_apdu) {
+			if (STATE(apdu_length) <= sock->max_tsdu)
+			{
+				const int status = send_odatav (sock, vector, csums, count, bytes_written);
+				pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+				pgm_sock_reader_unlock (sock);
+				return status;
+			}
+			else
+				goto retry_one_apdu_send;
+		} else {
+			goto retry_send;
+		}
+	}
+
+/* calculate (total) APDU length */
+	STATE(apdu_length)	= 0;
+	for (unsigned i = 0; i < count; i++)
+	{
+#ifdef TRANSPORT_DEBUG
+		if (PGM_LIKELY(vector[i].iov_len)) {
+			pgm_assert( vector[i].iov_base );
+		}
+#endif
+		if (!is_one_apdu &&
+		    vector[i].iov_len > sock->max_apdu)
+		{
+			pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+			pgm_sock_reader_unlock (sock);
+			pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
+		}
+		STATE(apdu_length) += vector[i].iov_len;
+	}
+
+/* pass on non-fragment calls */
+	if (is_one_apdu) {
+		if (STATE(apdu_length) <= sock->max_tsdu) {
+			const int status = send_odatav (sock, vector, csums, count, bytes_written);
+			pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+			pgm_sock_reader_unlock (sock);
+			return status;
+		} else if (STATE(apdu_length) > sock->max_apdu) {
+			pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+			pgm_sock_reader_unlock (sock);
+			pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
+		}
+	}
+
+/* non-fragmented packets can be forwarded onto basic send() */
+	if (!is_one_apdu)
+	{
+		for (STATE(data_pkt_offset) = 0; STATE(data_pkt_offset) < count; STATE(data_pkt_offset)++)
+		{
+			int	status;
+			size_t	wrote_bytes;
+retry_send:
+			if (NULL != sock->compress_buf && vector[STATE(data_pkt_offset)].iov_len <= PGM_MAX_APDU)
+				status = send_apdu_compressed (sock,
+							       vector[STATE(data_pkt_offset)].iov_base,
+							       vector[STATE(data_pkt_offset)].iov_len,
+							       NULL,
+							       &wrote_bytes);
+			else
+				status = send_apdu (sock,
+						    vector[STATE(data_pkt_offset)].iov_base,
+						    vector[STATE(data_pkt_offset)].iov_len,
+						    NULL,
+						    NULL,
+						    &wrote_bytes);
+			switch (status) {
+			case PGM_IO_STATUS_NORMAL:
 				break;
 			case PGM_IO_STATUS_WOULD_BLOCK:
 			case PGM_IO_STATUS_RATE_LIMITED:
 				sock->is_apdu_eagain = TRUE;
-				pgm_mutex_unlock (&sock->source_mutex);
-				pgm_rwlock_reader_unlock (&sock->lock);
+				pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+				pgm_sock_reader_unlock (sock);
 				return status;
 			case PGM_IO_STATUS_ERROR:
-				pgm_mutex_unlock (&sock->source_mutex);
-				pgm_rwlock_reader_unlock (&sock->lock);
+				pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+				pgm_sock_reader_unlock (sock);
 				return status;
 			default:
 				pgm_assert_not_reached();
@@ -1979,8 +4403,8 @@ retry_send:
 		sock->is_apdu_eagain = FALSE;
 		if (bytes_written)
 			*bytes_written = data_bytes_sent;
-		pgm_mutex_unlock (&sock->source_mutex);
-		pgm_rwlock_reader_unlock (&sock->lock);
+		pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+		pgm_sock_reader_unlock (sock);
 		return PGM_IO_STATUS_NORMAL;
 	}
 
@@ -2004,8 +4428,8 @@ retry_send:
 				      sock->is_nonblocking))
 		{
 			sock->blocklen = tpdu_length;
-			pgm_mutex_unlock (&sock->source_mutex);
-			pgm_rwlock_reader_unlock (&sock->lock);
+			pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+			pgm_sock_reader_unlock (sock);
 			return PGM_IO_STATUS_RATE_LIMITED;
 		}
 		STATE(is_rate_limited) = TRUE;
@@ -2018,58 +4442,64 @@ retry_send:
 	STATE(first_sqn)		= pgm_txw_next_lead(sock->window);
 
 	do {
-		size_t			 tpdu_length, header_length;
-		struct pgm_opt_header	*opt_header;
-		struct pgm_opt_length	*opt_len;
-		const char		*src;
-		char			*dst;
-		size_t			 src_length, dst_length, copy_length;
-		ssize_t			 sent;
+/* build a batch of fragments into the transmit window, stamped as one as the batch
+ * leaves with one system call.
+ */
+		const pgm_time_t now	= pgm_time_update_now();
+		STATE(skbv_len)		= 0;
+		STATE(skbv_offset)	= 0;
+		do {
+			size_t			 header_length;
+			struct pgm_opt_header	*opt_header;
+			struct pgm_opt_length	*opt_len;
+			const char		*src;
+			char			*dst;
+			size_t			 src_length, dst_length, copy_length;
 
 /* retrieve packet storage from transmit window */
-		header_length = pgm_pkt_offset (TRUE, pgmcc_family);
-		STATE(tsdu_length) = MIN( source_max_tsdu (sock, TRUE), STATE(apdu_length) - STATE(data_bytes_offset) );
-		STATE(skb) = pgm_alloc_skb (sock->max_tpdu);
-		STATE(skb)->sock = sock;
-		STATE(skb)->tstamp = pgm_time_update_now();
-		pgm_skb_reserve (STATE(skb), (uint16_t)header_length);
-		pgm_skb_put (STATE(skb), (uint16_t)STATE(tsdu_length));
-
-		STATE(skb)->pgm_header  = (struct pgm_header*)STATE(skb)->head;
-		STATE(skb)->pgm_data    = (struct pgm_data*)(STATE(skb)->pgm_header + 1);
-		memcpy (STATE(skb)->pgm_header->pgm_gsi, &sock->tsi.gsi, sizeof(pgm_gsi_t));
-		STATE(skb)->pgm_header->pgm_sport	= sock->tsi.sport;
-		STATE(skb)->pgm_header->pgm_dport	= sock->dport;
-		STATE(skb)->pgm_header->pgm_type	= PGM_ODATA;
-		STATE(skb)->pgm_header->pgm_options	= PGM_OPT_PRESENT;
-		STATE(skb)->pgm_header->pgm_tsdu_length = pgm_htons ((uint16_t)STATE(tsdu_length));
+			header_length = pgm_pkt_offset (TRUE, pgmcc_family);
+			STATE(tsdu_length) = MIN( source_max_tsdu (sock, TRUE), STATE(apdu_length) - STATE(data_bytes_offset) );
+			STATE(skb) = pgm_skb_pool_alloc (sock->txw_skb_pool, sock->max_tpdu);
+			STATE(skb)->sock = sock;
+			STATE(skb)->tstamp = now;
+			pgm_skb_reserve (STATE(skb), (uint16_t)header_length);
+			pgm_skb_put (STATE(skb), (uint16_t)STATE(tsdu_length));
+
+			STATE(skb)->pgm_header  = (struct pgm_header*)STATE(skb)->head;
+			STATE(skb)->pgm_data    = (struct pgm_data*)(STATE(skb)->pgm_header + 1);
+			memcpy (STATE(skb)->pgm_header->pgm_gsi, &sock->tsi.gsi, sizeof(pgm_gsi_t));
+			STATE(skb)->pgm_header->pgm_sport	= sock->tsi.sport;
+			STATE(skb)->pgm_header->pgm_dport	= sock->dport;
+			STATE(skb)->pgm_header->pgm_type	= PGM_ODATA;
+			STATE(skb)->pgm_header->pgm_options	= PGM_OPT_PRESENT;
+			STATE(skb)->pgm_header->pgm_tsdu_length = pgm_htons ((uint16_t)STATE(tsdu_length));
 
 /* ODATA */
-		STATE(skb)->pgm_data->data_sqn		= pgm_htonl (pgm_txw_next_lead(sock->window));
-		STATE(skb)->pgm_data->data_trail	= pgm_htonl (pgm_txw_trail(sock->window));
+			STATE(skb)->pgm_data->data_sqn		= pgm_htonl (pgm_txw_next_lead(sock->window));
+			STATE(skb)->pgm_data->data_trail	= pgm_htonl (pgm_txw_repair_trail(sock->window));
 
 /* OPT_LENGTH */
-		opt_len					= (struct pgm_opt_length*)(STATE(skb)->pgm_data + 1);
-		opt_len->opt_type			= PGM_OPT_LENGTH;
-		opt_len->opt_length			= sizeof(struct pgm_opt_length);
-		opt_len->opt_total_length		= pgm_htons ((uint16_t)(sizeof(struct pgm_opt_length) +
-									sizeof(struct pgm_opt_header) +
-									sizeof(struct pgm_opt_fragment)));
+			opt_len					= (struct pgm_opt_length*)(STATE(skb)->pgm_data + 1);
+			opt_len->opt_type			= PGM_OPT_LENGTH;
+			opt_len->opt_length			= sizeof(struct pgm_opt_length);
+			opt_len->opt_total_length		= pgm_htons ((uint16_t)(sizeof(struct pgm_opt_length) +
+										sizeof(struct pgm_opt_header) +
+										sizeof(struct pgm_opt_fragment)));
 /* OPT_FRAGMENT */
-		opt_header				= (struct pgm_opt_header*)(opt_len + 1);
-		opt_header->opt_type			= PGM_OPT_FRAGMENT | PGM_OPT_END;
-		opt_header->opt_length			= sizeof(struct pgm_opt_header) +
-							  sizeof(struct pgm_opt_fragment);
-		STATE(skb)->pgm_opt_fragment			= (struct pgm_opt_fragment*)(opt_header + 1);
-		STATE(skb)->pgm_opt_fragment->opt_reserved	= 0;
-		STATE(skb)->pgm_opt_fragment->opt_sqn		= pgm_htonl (STATE(first_sqn));
-		STATE(skb)->pgm_opt_fragment->opt_frag_off	= pgm_htonl ((uint32_t)STATE(data_bytes_offset));
-		STATE(skb)->pgm_opt_fragment->opt_frag_len	= pgm_htonl ((uint32_t)STATE(apdu_length));
+			opt_header				= (struct pgm_opt_header*)(opt_len + 1);
+			opt_header->opt_type			= PGM_OPT_FRAGMENT | PGM_OPT_END;
+			opt_header->opt_length			= sizeof(struct pgm_opt_header) +
+								  sizeof(struct pgm_opt_fragment);
+			STATE(skb)->pgm_opt_fragment			= (struct pgm_opt_fragment*)(opt_header + 1);
+			STATE(skb)->pgm_opt_fragment->opt_reserved	= 0;
+			STATE(skb)->pgm_opt_fragment->opt_sqn		= pgm_htonl (STATE(first_sqn));
+			STATE(skb)->pgm_opt_fragment->opt_frag_off	= pgm_htonl ((uint32_t)STATE(data_bytes_offset));
+			STATE(skb)->pgm_opt_fragment->opt_frag_len	= pgm_htonl ((uint32_t)STATE(apdu_length));
 
 /* checksum & copy */
-		STATE(skb)->pgm_header->pgm_checksum	= 0;
-		const size_t   pgm_header_len		= (char*)(STATE(skb)->pgm_opt_fragment + 1) - (char*)STATE(skb)->pgm_header;
-		const uint32_t unfolded_header		= pgm_csum_partial (STATE(skb)->pgm_header, (uint16_t)pgm_header_len, 0);
+			STATE(skb)->pgm_header->pgm_checksum	= 0;
+			const size_t   pgm_header_len		= (char*)(STATE(skb)->pgm_opt_fragment + 1) - (char*)STATE(skb)->pgm_header;
+			const uint32_t unfolded_header		= pgm_csum_partial (STATE(skb)->pgm_header, (uint16_t)pgm_header_len, 0);
 
 /* iterate over one or more vector elements to perform scatter/gather checksum & copy
  *
@@ -2077,111 +4507,226 @@ retry_send:
  * STATE(vector_offset) - current offset into current vector element
  * STATE(unfolded_odata)- checksum accumulator
  */
-		src		= (const char*)vector[STATE(vector_index)].iov_base + STATE(vector_offset);
-		dst		= (char*)(STATE(skb)->pgm_opt_fragment + 1);
-		src_length	= vector[STATE(vector_index)].iov_len - STATE(vector_offset);
-		dst_length	= 0;
-		copy_length	= MIN( STATE(tsdu_length), src_length );
-		STATE(unfolded_odata)	= pgm_csum_partial_copy (src, dst, (uint16_t)copy_length, 0);
+			src		= (const char*)vector[STATE(vector_index)].iov_base + STATE(vector_offset);
+			dst		= (char*)(STATE(skb)->pgm_opt_fragment + 1);
+			src_length	= vector[STATE(vector_index)].iov_len - STATE(vector_offset);
+			dst_length	= 0;
+			copy_length	= MIN( STATE(tsdu_length), src_length );
+			STATE(unfolded_odata)	= source_csum_copy_buffer (sock, source_whole_buffer (vector, csums, STATE(vector_index), STATE(vector_offset), copy_length), src, dst, (uint16_t)copy_length);
 
-		for(;;)
-		{
-			if (copy_length == src_length) {
+			for(;;)
+			{
+				if (copy_length == src_length) {
 /* application packet complete */
-				STATE(vector_index)++;
-				STATE(vector_offset) = 0;
-			} else {
+					STATE(vector_index)++;
+					STATE(vector_offset) = 0;
+				} else {
 /* data still remaining */
-				STATE(vector_offset) += copy_length;
-			}
+					STATE(vector_offset) += copy_length;
+				}
 
-			dst_length += copy_length;
+				dst_length += copy_length;
 
 /* sock packet complete */
-			if (dst_length == STATE(tsdu_length))
-				break;
-
-			src		= (const char*)vector[STATE(vector_index)].iov_base + STATE(vector_offset);
-			dst	       += copy_length;
-			src_length	= vector[STATE(vector_index)].iov_len - STATE(vector_offset);
-			copy_length	= MIN( STATE(tsdu_length) - dst_length, src_length );
-			const uint32_t unfolded_element = pgm_csum_partial_copy (src, dst, (uint16_t)copy_length, 0);
-			STATE(unfolded_odata) = pgm_csum_block_add (STATE(unfolded_odata), unfolded_element, (uint16_t)dst_length);
-		}
+				if (dst_length == STATE(tsdu_length))
+					break;
+
+				src		= (const char*)vector[STATE(vector_index)].iov_base + STATE(vector_offset);
+				dst	       += copy_length;
+				src_length	= vector[STATE(vector_index)].iov_len - STATE(vector_offset);
+				copy_length	= MIN( STATE(tsdu_length) - dst_length, src_length );
+				const uint32_t unfolded_element = source_csum_copy_buffer (sock, source_whole_buffer (vector, csums, STATE(vector_index), STATE(vector_offset), copy_length), src, dst, (uint16_t)copy_length);
+				STATE(unfolded_odata) = pgm_csum_block_add (STATE(unfolded_odata), unfolded_element, (uint16_t)dst_length);
+			}
 
-		STATE(skb)->pgm_header->pgm_checksum = pgm_csum_fold (pgm_csum_block_add (unfolded_header, STATE(unfolded_odata), (uint16_t)pgm_header_len));
+			STATE(skb)->pgm_header->pgm_checksum = source_csum_fold (sock, unfolded_header, STATE(unfolded_odata), (uint16_t)pgm_header_len);
 
 /* add to transmit window, skb::data set to payload */
-		pgm_spinlock_lock (&sock->txw_spinlock);
-		pgm_txw_add (sock->window, STATE(skb));
-		pgm_spinlock_unlock (&sock->txw_spinlock);
+			pgm_txw_add (sock->window, STATE(skb));
 
+/* save unfolded odata for retransmissions */
+			pgm_txw_set_unfolded_checksum (STATE(skb), STATE(unfolded_odata));
+			STATE(skbv)[ STATE(skbv_len)++ ] = pgm_skb_get (STATE(skb));
+			STATE(data_bytes_offset) += STATE(tsdu_length);
+		} while (STATE(data_bytes_offset) < STATE(apdu_length) &&
+			 STATE(skbv_len) < PGM_MAX_FRAGMENTS);
+
+/* send batch with one system call */
 retry_one_apdu_send:
-		tpdu_length = (char*)STATE(skb)->tail - (char*)STATE(skb)->head;
-		sent = pgm_sendto (sock,
-				   !STATE(is_rate_limited),	/* rate limited on blocking */
-			   	   &sock->odata_rate_control,
-				   FALSE,			/* regular socket */
-				   STATE(skb)->head,
-				   tpdu_length,
-				   (struct sockaddr*)&sock->send_gsr.gsr_group,
-				   pgm_sockaddr_len((struct sockaddr*)&sock->send_gsr.gsr_group));
-		if (sent < 0) {
-			save_errno = pgm_get_last_sock_error();
-			if (PGM_LIKELY(PGM_SOCK_EAGAIN == save_errno || PGM_SOCK_ENOBUFS == save_errno))
-			{
-				sock->is_apdu_eagain = TRUE;
-				sock->blocklen = tpdu_length + sock->iphdr_len;
-				goto blocked;
-			}
-/* fall through silently on other errors */
+		if (!send_odata_batch (sock, FALSE, &bytes_sent, &packets_sent, &data_bytes_sent, &save_errno))
+			goto blocked;
+	} while ( STATE(data_bytes_offset)  < STATE(apdu_length) );
+	pgm_assert( STATE(data_bytes_offset) == STATE(apdu_length) );
+
+/* success */
+	sock->is_apdu_eagain = FALSE;
+/* SPM heartbeats decay from last sent data packet */
+	reset_heartbeat_spm (sock, STATE(skb)->tstamp);
+/* increment socket statistics */
+	pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_BYTES_SENT, bytes_sent);
+	pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_DATA_MSGS_SENT, packets_sent);
+	pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_DATA_BYTES_SENT, data_bytes_sent);
+	if (bytes_written)
+		*bytes_written = STATE(apdu_length);
+	pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+	pgm_sock_reader_unlock (sock);
+	return PGM_IO_STATUS_NORMAL;
+
+blocked:
+	if (bytes_sent) {
+		reset_heartbeat_spm (sock, STATE(skb)->tstamp);
+		pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_BYTES_SENT, bytes_sent);
+		pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_DATA_MSGS_SENT, packets_sent);
+		pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_DATA_BYTES_SENT, data_bytes_sent);
+	}
+	pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+	pgm_sock_reader_unlock (sock);
+	if (PGM_SOCK_ENOBUFS == save_errno)
+		return PGM_IO_STATUS_RATE_LIMITED;
+	if (sock->use_pgmcc)
+		pgm_notify_clear (&sock->ack_notify);
+	return PGM_IO_STATUS_WOULD_BLOCK;
+}
+
+/* add one vector of caller built TSDUs to the transmit window as ODATA, with
+ * fragment headers when is_one_apdu, pending send in the resume state.
+ */
+
+static
+void
+source_add_skbv (
+	pgm_sock_t*            const restrict sock,
+	struct pgm_sk_buff_t** const restrict vector,
+	const uint32_t*	             restrict csums,		/* precomputed payload checksums or NULL */
+	const unsigned			      count,
+	const bool			      is_one_apdu
+	)
+{
+/* share one time stamp */
+	const pgm_time_t now = pgm_time_update_now();
+	for (STATE(vector_index) = 0; STATE(vector_index) < count; STATE(vector_index)++)
+	{
+		STATE(tsdu_length) = vector[STATE(vector_index)]->len;
+		
+		STATE(skb) = pgm_skb_get(vector[STATE(vector_index)]);
+		STATE(skb)->sock = sock;
+		STATE(skb)->tstamp = now;
+
+		STATE(skb)->pgm_header = (struct pgm_header*)STATE(skb)->head;
+		STATE(skb)->pgm_data   = (struct pgm_data*)(STATE(skb)->pgm_header + 1);
+		memcpy (STATE(skb)->pgm_header->pgm_gsi, &sock->tsi.gsi, sizeof(pgm_gsi_t));
+		STATE(skb)->pgm_header->pgm_sport	= sock->tsi.sport;
+		STATE(skb)->pgm_header->pgm_dport	= sock->dport;
+		STATE(skb)->pgm_header->pgm_type	= PGM_ODATA;
+		STATE(skb)->pgm_header->pgm_options	= is_one_apdu ? PGM_OPT_PRESENT : 0;
+		STATE(skb)->pgm_header->pgm_tsdu_length = pgm_htons ((uint16_t)STATE(tsdu_length));
+
+/* ODATA */
+		STATE(skb)->pgm_data->data_sqn		= pgm_htonl (pgm_txw_next_lead(sock->window));
+		STATE(skb)->pgm_data->data_trail	= pgm_htonl (pgm_txw_repair_trail(sock->window));
+
+		if (is_one_apdu)
+		{
+			struct pgm_opt_header	*opt_header;
+			struct pgm_opt_length	*opt_len;
+
+/* OPT_LENGTH */
+			opt_len					= (struct pgm_opt_length*)(STATE(skb)->pgm_data + 1);
+			opt_len->opt_type			= PGM_OPT_LENGTH;
+			opt_len->opt_length			= sizeof(struct pgm_opt_length);
+			opt_len->opt_total_length		= pgm_htons ((uint16_t)(sizeof(struct pgm_opt_length) +
+										sizeof(struct pgm_opt_header) +
+										sizeof(struct pgm_opt_fragment)));
+/* OPT_FRAGMENT */
+			opt_header				= (struct pgm_opt_header*)(opt_len + 1);
+			opt_header->opt_type			= PGM_OPT_FRAGMENT | PGM_OPT_END;
+			opt_header->opt_length			= sizeof(struct pgm_opt_header) +
+								  sizeof(struct pgm_opt_fragment);
+			STATE(skb)->pgm_opt_fragment			= (struct pgm_opt_fragment*)(opt_header + 1);
+			STATE(skb)->pgm_opt_fragment->opt_reserved	= 0;
+			STATE(skb)->pgm_opt_fragment->opt_sqn		= pgm_htonl (STATE(first_sqn));
+			STATE(skb)->pgm_opt_fragment->opt_frag_off	= pgm_htonl ((uint32_t)STATE(data_bytes_offset));
+			STATE(skb)->pgm_opt_fragment->opt_frag_len	= pgm_htonl ((uint32_t)STATE(apdu_length));
+
+			pgm_assert (STATE(skb)->data == (STATE(skb)->pgm_opt_fragment + 1));
+		}
+		else
+		{
+			pgm_assert (STATE(skb)->data == (STATE(skb)->pgm_data + 1));
 		}
 
+/* TODO: the assembly checksum & copy routine is faster than memcpy & pgm_cksum on >= opteron hardware */
+		STATE(skb)->pgm_header->pgm_checksum	= 0;
+		pgm_assert ((char*)STATE(skb)->data > (char*)STATE(skb)->pgm_header);
+		const size_t header_length		= (char*)STATE(skb)->data - (char*)STATE(skb)->pgm_header;
+		const uint32_t unfolded_header		= pgm_csum_partial (STATE(skb)->pgm_header, (uint16_t)header_length, 0);
+		STATE(unfolded_odata)			= csums ? csums[STATE(vector_index)] : source_csum_partial (sock, (char*)STATE(skb)->data, (uint16_t)STATE(tsdu_length));
+		STATE(skb)->pgm_header->pgm_checksum	= source_csum_fold (sock, unfolded_header, STATE(unfolded_odata), (uint16_t)header_length);
+
+/* add to transmit window, skb::data set to payload */
+		pgm_txw_add (sock->window, STATE(skb));
+
 /* save unfolded odata for retransmissions */
 		pgm_txw_set_unfolded_checksum (STATE(skb), STATE(unfolded_odata));
+		STATE(skbv)[ STATE(vector_index) ] = STATE(skb);
+		STATE(data_bytes_offset) += STATE(tsdu_length);
+	}
 
-		if (PGM_LIKELY((size_t)sent == tpdu_length)) {
-			bytes_sent += tpdu_length + sock->iphdr_len;	/* as counted at IP layer */
-			packets_sent++;					/* IP packets */
-			data_bytes_sent += STATE(tsdu_length);
-		}
+	STATE(skbv_len)		= count;
+	STATE(skbv_offset)	= 0;
+}
 
-		STATE(data_bytes_offset) += STATE(tsdu_length);
+/* send the pending vector of pgm_send_skbv() or pgm_send_file(), counting the
+ * statistics of what was sent.
+ *
+ * returns PGM_IO_STATUS_NORMAL once complete, PGM_IO_STATUS_WOULD_BLOCK or
+ * PGM_IO_STATUS_RATE_LIMITED when blocked, resumed by calling again.
+ */
+
+static
+int
+send_skbv_pending (
+	pgm_sock_t*	const restrict sock,
+	const bool		       is_one_apdu,
+	size_t*		      restrict bytes_written
+	)
+{
+	unsigned	packets_sent = 0;
+	size_t		bytes_sent = 0;
+	size_t		data_bytes_sent = 0;
+	int		save_errno;
 
-/* check for end of transmission group */
-		if (sock->use_proactive_parity) {
-			const uint32_t odata_sqn = pgm_ntohl (STATE(skb)->pgm_data->data_sqn);
-			const uint32_t tg_sqn_mask = 0xffffffff << sock->tg_sqn_shift;
-			if (!((odata_sqn + 1) & ~tg_sqn_mask))
-				pgm_schedule_proactive_nak (sock, odata_sqn & tg_sqn_mask);
-		}
+	if (!send_odata_batch (sock, sock->use_zerocopy, &bytes_sent, &packets_sent, &data_bytes_sent, &save_errno))
+		goto blocked;
 
-	} while ( STATE(data_bytes_offset)  < STATE(apdu_length) );
-	pgm_assert( STATE(data_bytes_offset) == STATE(apdu_length) );
+#ifdef TRANSPORT_DEBUG
+	if (is_one_apdu)
+	{
+		pgm_assert( STATE(data_bytes_offset) == STATE(apdu_length) );
+	}
+#else
+	(void)is_one_apdu;
+#endif
 
 /* success */
 	sock->is_apdu_eagain = FALSE;
 /* SPM heartbeats decay from last sent data packet */
 	reset_heartbeat_spm (sock, STATE(skb)->tstamp);
 /* increment socket statistics */
-	pgm_atomic_add32 (&sock->cumulative_stats[PGM_PC_SOURCE_BYTES_SENT], (uint32_t)bytes_sent);
-	sock->cumulative_stats[PGM_PC_SOURCE_DATA_MSGS_SENT]  += packets_sent;
-	sock->cumulative_stats[PGM_PC_SOURCE_DATA_BYTES_SENT] += data_bytes_sent;
+	pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_BYTES_SENT, bytes_sent);
+	pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_DATA_MSGS_SENT, packets_sent);
+	pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_DATA_BYTES_SENT, data_bytes_sent);
 	if (bytes_written)
-		*bytes_written = STATE(apdu_length);
-	pgm_mutex_unlock (&sock->source_mutex);
-	pgm_rwlock_reader_unlock (&sock->lock);
+		*bytes_written = data_bytes_sent;
 	return PGM_IO_STATUS_NORMAL;
 
 blocked:
 	if (bytes_sent) {
 		reset_heartbeat_spm (sock, STATE(skb)->tstamp);
-		pgm_atomic_add32 (&sock->cumulative_stats[PGM_PC_SOURCE_BYTES_SENT], (uint32_t)bytes_sent);
-		sock->cumulative_stats[PGM_PC_SOURCE_DATA_MSGS_SENT]  += packets_sent;
-		sock->cumulative_stats[PGM_PC_SOURCE_DATA_BYTES_SENT] += data_bytes_sent;
+		pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_BYTES_SENT, bytes_sent);
+		pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_DATA_MSGS_SENT, packets_sent);
+		pgm_stats_add (&sock->cumulative_stats[PGM_STATS_TX], PGM_PC_SOURCE_DATA_BYTES_SENT, data_bytes_sent);
 	}
-	pgm_mutex_unlock (&sock->source_mutex);
-	pgm_rwlock_reader_unlock (&sock->lock);
 	if (PGM_SOCK_ENOBUFS == save_errno)
 		return PGM_IO_STATUS_RATE_LIMITED;
 	if (sock->use_pgmcc)
@@ -2209,11 +4754,38 @@ pgm_send_skbv (
 	size_t*		 	     restrict bytes_written
 	)
 {
-	unsigned	packets_sent = 0;
-	size_t		bytes_sent = 0;
-	size_t		data_bytes_sent = 0;
-	int		save_errno;
+	return _pgm_send_skbv (sock, vector, NULL, count, is_one_apdu, bytes_written);
+}
+
+/* as pgm_send_skbv() with the unfolded checksum of each TSDU precomputed by
+ * pgm_csum_payload(), the payload is then not read by the send path.
+ */
+
+int
+pgm_send_skbv_csum (
+	pgm_sock_t*            const restrict sock,
+	struct pgm_sk_buff_t** const restrict vector,
+	const uint32_t*	       const restrict csums,		/* length count */
+	const unsigned			      count,
+	const bool			      is_one_apdu,
+	size_t*		 	     restrict bytes_written
+	)
+{
+	if (PGM_LIKELY(count)) pgm_return_val_if_fail (NULL != csums, PGM_IO_STATUS_ERROR);
+	return _pgm_send_skbv (sock, vector, csums, count, is_one_apdu, bytes_written);
+}
 
+static
+int
+_pgm_send_skbv (
+	pgm_sock_t*            const restrict sock,
+	struct pgm_sk_buff_t** const restrict vector,		/* array of skb pointers vs. array of skbs */
+	const uint32_t*	             restrict csums,		/* precomputed payload checksums or NULL */
+	const unsigned			      count,
+	const bool			      is_one_apdu,	/* true: vector = apdu, false: vector::iov_base = apdu */
+	size_t*		 	     restrict bytes_written
+	)
+{
 	pgm_debug ("pgm_send_skbv (sock:%p vector:%p count:%u is-one-apdu:%s bytes-written:%p)",
 		(const void*)sock,
 		(const void*)vector,
@@ -2222,233 +4794,578 @@ pgm_send_skbv (
 		(const void*)bytes_written);
 
 	pgm_return_val_if_fail (NULL != sock, PGM_IO_STATUS_ERROR);
-	pgm_return_val_if_fail (count <= PGM_MAX_FRAGMENTS, PGM_IO_STATUS_ERROR);
-	if (PGM_LIKELY(count)) pgm_return_val_if_fail (NULL != vector, PGM_IO_STATUS_ERROR);
-	if (PGM_UNLIKELY(!pgm_rwlock_reader_trylock (&sock->lock)))
+	pgm_return_val_if_fail (count <= PGM_MAX_FRAGMENTS, PGM_IO_STATUS_ERROR);
+	if (PGM_LIKELY(count)) pgm_return_val_if_fail (NULL != vector, PGM_IO_STATUS_ERROR);
+	if (PGM_UNLIKELY(!pgm_sock_reader_trylock (sock)))
+		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
+	if (PGM_UNLIKELY(!sock->is_bound ||
+	    sock->is_destroyed))
+	{
+		pgm_sock_reader_unlock (sock);
+		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
+	}
+
+/* standby until the primary fails */
+	if (PGM_UNLIKELY(sock->is_standby)) {
+		pgm_sock_reader_unlock (sock);
+		return PGM_IO_STATUS_WOULD_BLOCK;
+	}
+
+	pgm_sock_mutex_lock (sock, &sock->source_mutex);
+
+/* coalesced messages are sent first */
+	if (PGM_UNLIKELY(sock->batch_count)) {
+		const int status = send_batch_pending (sock);
+		if (PGM_IO_STATUS_NORMAL != status) {
+			pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+			pgm_sock_reader_unlock (sock);
+			return status;
+		}
+	}
+
+/* and queued APDUs */
+	if (PGM_UNLIKELY(sock->sendq_len)) {
+		const int status = send_sendq_pending (sock);
+		if (PGM_IO_STATUS_NORMAL != status) {
+			pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+			pgm_sock_reader_unlock (sock);
+			return status;
+		}
+	}
+
+/* pass on zero length as cannot count vector lengths */
+	if (PGM_UNLIKELY(0 == count))
+	{
+		const int status = send_odata_copy (sock, NULL, 0, 0, bytes_written);
+		pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+		pgm_sock_reader_unlock (sock);
+		return status;
+	}
+/* zero-copy sends require the skbuff reference of the batch path */
+	else if (1 == count && !sock->use_zerocopy)
+	{
+		const int status = send_odata (sock, vector[0], csums, bytes_written);
+		pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+		pgm_sock_reader_unlock (sock);
+		return status;
+	}
+
+	const sa_family_t pgmcc_family = sock->use_pgmcc ? sock->family : 0;
+
+/* continue if blocked mid-apdu */
+	if (sock->is_apdu_eagain)
+		goto retry_send;
+
+	STATE(is_rate_limited) = FALSE;
+	if (sock->is_nonblocking && sock->is_controlled_odata)
+	{
+		size_t total_tpdu_length = 0;
+
+		for (unsigned i = 0; i < count; i++)
+			total_tpdu_length += sock->iphdr_len + pgm_pkt_offset (is_one_apdu, pgmcc_family) + vector[i]->len;
+
+		if (!pgm_rate_check2 (&sock->rate_control,
+				      &sock->odata_rate_control,
+				      total_tpdu_length - sock->iphdr_len,	/* includes 1 × IP header len */
+				      sock->is_nonblocking))
+		{
+			sock->blocklen = total_tpdu_length;
+			pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+			pgm_sock_reader_unlock (sock);
+			return PGM_IO_STATUS_RATE_LIMITED;
+		}
+		STATE(is_rate_limited) = TRUE;
+	}
+
+	if (is_one_apdu)
+	{
+		STATE(apdu_length)	= 0;
+		STATE(first_sqn)	= pgm_txw_next_lead(sock->window);
+		for (unsigned i = 0; i < count; i++)
+		{
+			if (PGM_UNLIKELY(vector[i]->len > sock->max_tsdu_fragment)) {
+				pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+				pgm_sock_reader_unlock (sock);
+				return PGM_IO_STATUS_ERROR;
+			}
+			STATE(apdu_length) += vector[i]->len;
+		}
+		if (PGM_UNLIKELY(STATE(apdu_length) > sock->max_apdu)) {
+			pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+			pgm_sock_reader_unlock (sock);
+			return PGM_IO_STATUS_ERROR;
+		}
+	}
+
+/* the complete vector is sent with one system call */
+	source_add_skbv (sock, vector, csums, count, is_one_apdu);
+retry_send:
+	{
+		const int status = send_skbv_pending (sock, is_one_apdu, bytes_written);
+		pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+		pgm_sock_reader_unlock (sock);
+		return status;
+	}
+}
+
+/* positioned read of the whole length, retried on signals and short reads.
+ *
+ * returns TRUE on success, FALSE on error or end of file with errno set.
+ */
+
+static
+bool
+file_read (
+	const int		fd,
+	void*	       restrict	buf,
+	size_t			len,
+	uint64_t		offset
+	)
+{
+	while (len > 0)
+	{
+#ifndef _WIN32
+		const ssize_t bytes_read = pread (fd, buf, len, (off_t)offset);
+#else
+		if (-1 == _lseeki64 (fd, (__int64)offset, SEEK_SET))
+			return FALSE;
+		const int bytes_read = _read (fd, buf, (unsigned)len);
+#endif
+		if (bytes_read < 0) {
+			if (EINTR == errno)
+				continue;
+			return FALSE;
+		}
+		if (0 == bytes_read) {
+			errno = EINVAL;		/* range beyond end of file */
+			return FALSE;
+		}
+		buf     = (char*)buf + bytes_read;
+		len    -= (size_t)bytes_read;
+		offset += (uint64_t)bytes_read;
+	}
+	return TRUE;
+}
+
+/* send length bytes of file descriptor fd from offset as one APDU, read directly
+ * into the transmit window skbuffs so the payload is never copied through an
+ * application buffer.  With PGM_ZEROCOPY the datagrams are sent from the
+ * skbuffs without a kernel copy, repairs are sent from the same skbuffs.  A
+ * larger file is sent as consecutive calls of at most max APDU bytes each.
+ *
+ * on success, returns PGM_IO_STATUS_NORMAL, on block for non-blocking sockets
+ * returns PGM_IO_STATUS_WOULD_BLOCK, returns PGM_IO_STATUS_RATE_LIMITED if
+ * packet size exceeds the current rate limit.  a blocked call is repeated with
+ * the same arguments, the file is read once.  returns PGM_IO_STATUS_ERROR if the
+ * range cannot be read, errno set.
+ */
+
+int
+pgm_send_file (
+	pgm_sock_t*	 const restrict sock,
+	const int			fd,
+	const uint64_t			offset,
+	const size_t			length,
+	size_t*		       restrict	bytes_written
+	)
+{
+	struct pgm_sk_buff_t* skbv[ PGM_MAX_FRAGMENTS ];
+
+	pgm_debug ("pgm_send_file (sock:%p fd:%d offset:%" PRIu64 " length:%" PRIzu " bytes-written:%p)",
+		(const void*)sock, fd, offset, length, (const void*)bytes_written);
+
+/* parameters */
+	pgm_return_val_if_fail (NULL != sock, PGM_IO_STATUS_ERROR);
+	pgm_return_val_if_fail (fd >= 0, PGM_IO_STATUS_ERROR);
+	pgm_return_val_if_fail (length > 0, PGM_IO_STATUS_ERROR);
+
+/* shutdown */
+	if (PGM_UNLIKELY(!pgm_sock_reader_trylock (sock)))
+		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
+
+/* state */
+	if (PGM_UNLIKELY(!sock->is_bound ||
+	    sock->is_destroyed ||
+	    length > sock->max_apdu ||
+	    length > PGM_MAX_FRAGMENTS * (size_t)sock->max_tsdu_fragment))
+	{
+		pgm_sock_reader_unlock (sock);
+		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
+	}
+
+/* standby until the primary fails */
+	if (PGM_UNLIKELY(sock->is_standby)) {
+		pgm_sock_reader_unlock (sock);
+		return PGM_IO_STATUS_WOULD_BLOCK;
+	}
+
+	pgm_sock_mutex_lock (sock, &sock->source_mutex);
+
+/* coalesced messages are sent first */
+	if (PGM_UNLIKELY(sock->batch_count)) {
+		const int status = send_batch_pending (sock);
+		if (PGM_IO_STATUS_NORMAL != status) {
+			pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+			pgm_sock_reader_unlock (sock);
+			return status;
+		}
+	}
+
+/* and queued APDUs */
+	if (PGM_UNLIKELY(sock->sendq_len)) {
+		const int status = send_sendq_pending (sock);
+		if (PGM_IO_STATUS_NORMAL != status) {
+			pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+			pgm_sock_reader_unlock (sock);
+			return status;
+		}
+	}
+
+/* continue if blocked mid-apdu */
+	if (sock->is_apdu_eagain)
+		goto retry_send;
+
+	const unsigned count = (unsigned)((length + sock->max_tsdu_fragment - 1) / sock->max_tsdu_fragment);
+	const size_t header_length = pgm_pkt_offset (TRUE, 0);
+
+	STATE(is_rate_limited) = FALSE;
+	if (sock->is_nonblocking && sock->is_controlled_odata)
+	{
+		const size_t total_tpdu_length = count * (sock->iphdr_len + header_length) + length;
+		if (!pgm_rate_check2 (&sock->rate_control,
+				      &sock->odata_rate_control,
+				      total_tpdu_length - sock->iphdr_len,	/* includes 1 × IP header len */
+				      sock->is_nonblocking))
+		{
+			sock->blocklen = total_tpdu_length;
+			pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+			pgm_sock_reader_unlock (sock);
+			return PGM_IO_STATUS_RATE_LIMITED;
+		}
+		STATE(is_rate_limited) = TRUE;
+	}
+
+/* read every fragment before any joins the window */
+	size_t fragment_offset = 0;
+	for (unsigned i = 0; i < count; i++)
+	{
+		const uint16_t tsdu_length = (uint16_t)MIN(length - fragment_offset, sock->max_tsdu_fragment);
+		skbv[i] = pgm_skb_pool_alloc (sock->txw_skb_pool, sock->max_tpdu);
+		pgm_skb_reserve (skbv[i], (uint16_t)header_length);
+		pgm_skb_put (skbv[i], tsdu_length);
+		if (!file_read (fd, skbv[i]->data, tsdu_length, offset + fragment_offset)) {
+			const int save_errno = errno;
+			for (unsigned j = 0; j <= i; j++)
+				pgm_free_skb (skbv[j]);
+			pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+			pgm_sock_reader_unlock (sock);
+			errno = save_errno;
+			return PGM_IO_STATUS_ERROR;
+		}
+		fragment_offset += tsdu_length;
+	}
+
+	STATE(apdu_length)	 = length;
+	STATE(first_sqn)	 = pgm_txw_next_lead(sock->window);
+	STATE(data_bytes_offset) = 0;
+/* references pass to the transmit window */
+	source_add_skbv (sock, skbv, NULL, count, TRUE);
+retry_send:
+	{
+		const int status = send_skbv_pending (sock, TRUE, bytes_written);
+		pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+		pgm_sock_reader_unlock (sock);
+		return status;
+	}
+}
+
+/* Coalesce one small APDU with others into a single TPDU marked with OPT_BATCH,
+ * receivers deliver each as its own message.  Pending messages are sent when the
+ * next would overflow PGM_SEND_BATCH br_size, on expiry of br_ivl, by
+ * pgm_send_flush(), or ahead of any other send call.  APDUs too large to share a
+ * TPDU, and all APDUs when coalescing is disabled, are sent as by pgm_send().
+ * pgm_close() discards pending messages.
+ *
+ * on success, returns PGM_IO_STATUS_NORMAL with the APDU accepted, on block for
+ * non-blocking sockets returns PGM_IO_STATUS_WOULD_BLOCK, returns
+ * PGM_IO_STATUS_RATE_LIMITED if packet size exceeds the current rate limit, the
+ * call is then repeated with the same APDU.
+ */
+
+int
+pgm_send_batch (
+	pgm_sock_t* 	 const restrict sock,
+	const void*	       restrict	apdu,
+	const size_t			apdu_length,
+	size_t*	       	       restrict	bytes_written
+	)
+{
+	int status = PGM_IO_STATUS_NORMAL;
+
+	pgm_debug ("pgm_send_batch (sock:%p apdu:%p apdu-length:%" PRIzu " bytes-written:%p)",
+		(void*)sock, apdu, apdu_length, (void*)bytes_written);
+
+/* parameters */
+	pgm_return_val_if_fail (NULL != sock, PGM_IO_STATUS_ERROR);
+	if (PGM_LIKELY(apdu_length)) pgm_return_val_if_fail (NULL != apdu, PGM_IO_STATUS_ERROR);
+
+/* shutdown */
+	if (PGM_UNLIKELY(!pgm_sock_reader_trylock (sock)))
+		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
+
+/* state */
+	if (PGM_UNLIKELY(!sock->is_bound ||
+	    sock->is_destroyed ||
+	    apdu_length > sock->max_apdu))
+	{
+		pgm_sock_reader_unlock (sock);
+		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
+	}
+
+/* standby until the primary fails */
+	if (PGM_UNLIKELY(sock->is_standby)) {
+		pgm_sock_reader_unlock (sock);
+		return PGM_IO_STATUS_WOULD_BLOCK;
+	}
+
+/* source */
+	pgm_sock_mutex_lock (sock, &sock->source_mutex);
+
+	const size_t frame_length = sizeof (uint16_t) + apdu_length;
+
+/* queued APDUs are sent first */
+	if (PGM_UNLIKELY(sock->sendq_len))
+		status = send_sendq_pending (sock);
+
+/* resume a blocked send of pending messages, or make room */
+	if (PGM_IO_STATUS_NORMAL == status &&
+	    sock->batch_count &&
+	    (sock->is_apdu_eagain || sock->batch_len + frame_length > sock->batch_max))
+	{
+		status = send_batch_pending (sock);
+	}
+
+	if (PGM_IO_STATUS_NORMAL != status)
+	{
+		;
+	}
+	else if (frame_length > sock->batch_max)
+	{
+		status = (apdu_length <= sock->max_tsdu) ?
+				send_odata_copy (sock, apdu, (uint16_t)apdu_length, 0, bytes_written) :
+				send_apdu (sock, apdu, apdu_length, NULL, NULL, bytes_written);
+	}
+	else
+	{
+		const uint16_t msg_length = pgm_htons ((uint16_t)apdu_length);
+		char* frame = sock->batch_buf + sock->batch_len;
+		memcpy (frame, &msg_length, sizeof (msg_length));
+		if (PGM_LIKELY(apdu_length))
+			memcpy (frame + sizeof (msg_length), apdu, apdu_length);
+		sock->batch_len += (uint16_t)frame_length;
+		if (0 == sock->batch_count++ && sock->batch_req.br_ivl)
+			schedule_batch_flush (sock, pgm_time_update_now());
+		if (bytes_written)
+			*bytes_written = apdu_length;
+/* send once full, the APDU is already accepted should this block */
+		if (sock->batch_len + sizeof (uint16_t) >= sock->batch_max)
+			(void)send_batch_pending (sock);
+	}
+
+	pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+	pgm_sock_reader_unlock (sock);
+	return status;
+}
+
+/* Send messages coalesced by pgm_send_batch() without waiting on size or timer.
+ *
+ * on success, returns PGM_IO_STATUS_NORMAL with the total length of APDUs sent
+ * saved into bytes_written, on block for non-blocking sockets returns
+ * PGM_IO_STATUS_WOULD_BLOCK, returns PGM_IO_STATUS_RATE_LIMITED if packet size
+ * exceeds the current rate limit.
+ */
+
+int
+pgm_send_flush (
+	pgm_sock_t* 	 const restrict sock,
+	size_t*	       	       restrict	bytes_written
+	)
+{
+	pgm_debug ("pgm_send_flush (sock:%p bytes-written:%p)",
+		(void*)sock, (void*)bytes_written);
+
+/* parameters */
+	pgm_return_val_if_fail (NULL != sock, PGM_IO_STATUS_ERROR);
+
+/* shutdown */
+	if (PGM_UNLIKELY(!pgm_sock_reader_trylock (sock)))
 		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
+
+/* state */
 	if (PGM_UNLIKELY(!sock->is_bound ||
 	    sock->is_destroyed))
 	{
-		pgm_rwlock_reader_unlock (&sock->lock);
+		pgm_sock_reader_unlock (sock);
 		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
 	}
 
-	pgm_mutex_lock (&sock->source_mutex);
-
-/* pass on zero length as cannot count vector lengths */
-	if (PGM_UNLIKELY(0 == count))
-	{
-		const int status = send_odata_copy (sock, NULL, 0, bytes_written);
-		pgm_mutex_unlock (&sock->source_mutex);
-		pgm_rwlock_reader_unlock (&sock->lock);
-		return status;
-	}
-	else if (1 == count)
-	{
-		const int status = send_odata (sock, vector[0], bytes_written);
-		pgm_mutex_unlock (&sock->source_mutex);
-		pgm_rwlock_reader_unlock (&sock->lock);
-		return status;
+/* standby until the primary fails */
+	if (PGM_UNLIKELY(sock->is_standby)) {
+		pgm_sock_reader_unlock (sock);
+		return PGM_IO_STATUS_WOULD_BLOCK;
 	}
 
-	const sa_family_t pgmcc_family = sock->use_pgmcc ? sock->family : 0;
+/* source */
+	pgm_sock_mutex_lock (sock, &sock->source_mutex);
+	const size_t apdu_bytes = sock->batch_len - sock->batch_count * sizeof (uint16_t);
+	const int status = send_batch_pending (sock);
+	if (PGM_IO_STATUS_NORMAL == status && bytes_written)
+		*bytes_written = apdu_bytes;
+	pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+	pgm_sock_reader_unlock (sock);
+	return status;
+}
 
-/* continue if blocked mid-apdu */
-	if (sock->is_apdu_eagain)
-		goto retry_send;
+/* timer expiration of messages coalesced by pgm_send_batch().
+ *
+ * returns TRUE on success, returns FALSE on blocked send.
+ */
 
-	STATE(is_rate_limited) = FALSE;
-	if (sock->is_nonblocking && sock->is_controlled_odata)
-	{
-		size_t total_tpdu_length = 0;
+PGM_GNUC_INTERNAL
+bool
+pgm_on_batch_expiry (
+	pgm_sock_t* const	sock
+	)
+{
+	int status = PGM_IO_STATUS_NORMAL;
 
-		for (unsigned i = 0; i < count; i++)
-			total_tpdu_length += sock->iphdr_len + pgm_pkt_offset (is_one_apdu, pgmcc_family) + vector[i]->len;
+/* pre-conditions */
+	pgm_assert (NULL != sock);
 
-		if (!pgm_rate_check2 (&sock->rate_control,
-				      &sock->odata_rate_control,
-				      total_tpdu_length - sock->iphdr_len,	/* includes 1 × IP header len */
-				      sock->is_nonblocking))
-		{
-			sock->blocklen = total_tpdu_length;
-			pgm_mutex_unlock (&sock->source_mutex);
-			pgm_rwlock_reader_unlock (&sock->lock);
-			return PGM_IO_STATUS_RATE_LIMITED;
-		}
-		STATE(is_rate_limited) = TRUE;
-	}
+	pgm_debug ("pgm_on_batch_expiry (sock:%p)", (const void*)sock);
 
-	if (is_one_apdu)
+	pgm_sock_mutex_lock (sock, &sock->source_mutex);
+	if (sock->batch_count &&
+	    pgm_time_after_eq (pgm_time_update_now(), sock->batch_expiry))
 	{
-		STATE(apdu_length)	= 0;
-		STATE(first_sqn)	= pgm_txw_next_lead(sock->window);
-		for (unsigned i = 0; i < count; i++)
-		{
-			if (PGM_UNLIKELY(vector[i]->len > sock->max_tsdu_fragment)) {
-				pgm_mutex_unlock (&sock->source_mutex);
-				pgm_rwlock_reader_unlock (&sock->lock);
-				return PGM_IO_STATUS_ERROR;
-			}
-			STATE(apdu_length) += vector[i]->len;
-		}
-		if (PGM_UNLIKELY(STATE(apdu_length) > sock->max_apdu)) {
-			pgm_mutex_unlock (&sock->source_mutex);
-			pgm_rwlock_reader_unlock (&sock->lock);
-			return PGM_IO_STATUS_ERROR;
-		}
+		status = send_batch_pending (sock);
 	}
+	pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+	return PGM_IO_STATUS_NORMAL == status;
+}
 
-	for (STATE(vector_index) = 0; STATE(vector_index) < count; STATE(vector_index)++)
-	{
-		size_t		tpdu_length;
-		ssize_t		sent;
-
-		STATE(tsdu_length) = vector[STATE(vector_index)]->len;
-		
-		STATE(skb) = pgm_skb_get(vector[STATE(vector_index)]);
-		STATE(skb)->sock = sock;
-		STATE(skb)->tstamp = pgm_time_update_now();
-
-		STATE(skb)->pgm_header = (struct pgm_header*)STATE(skb)->head;
-		STATE(skb)->pgm_data   = (struct pgm_data*)(STATE(skb)->pgm_header + 1);
-		memcpy (STATE(skb)->pgm_header->pgm_gsi, &sock->tsi.gsi, sizeof(pgm_gsi_t));
-		STATE(skb)->pgm_header->pgm_sport	= sock->tsi.sport;
-		STATE(skb)->pgm_header->pgm_dport	= sock->dport;
-		STATE(skb)->pgm_header->pgm_type	= PGM_ODATA;
-		STATE(skb)->pgm_header->pgm_options	= is_one_apdu ? PGM_OPT_PRESENT : 0;
-		STATE(skb)->pgm_header->pgm_tsdu_length = pgm_htons ((uint16_t)STATE(tsdu_length));
-
-/* ODATA */
-		STATE(skb)->pgm_data->data_sqn		= pgm_htonl (pgm_txw_next_lead(sock->window));
-		STATE(skb)->pgm_data->data_trail	= pgm_htonl (pgm_txw_trail(sock->window));
-
-		if (is_one_apdu)
-		{
-			struct pgm_opt_header	*opt_header;
-			struct pgm_opt_length	*opt_len;
-
-/* OPT_LENGTH */
-			opt_len					= (struct pgm_opt_length*)(STATE(skb)->pgm_data + 1);
-			opt_len->opt_type			= PGM_OPT_LENGTH;
-			opt_len->opt_length			= sizeof(struct pgm_opt_length);
-			opt_len->opt_total_length		= pgm_htons ((uint16_t)(sizeof(struct pgm_opt_length) +
-										sizeof(struct pgm_opt_header) +
-										sizeof(struct pgm_opt_fragment)));
-/* OPT_FRAGMENT */
-			opt_header				= (struct pgm_opt_header*)(opt_len + 1);
-			opt_header->opt_type			= PGM_OPT_FRAGMENT | PGM_OPT_END;
-			opt_header->opt_length			= sizeof(struct pgm_opt_header) +
-								  sizeof(struct pgm_opt_fragment);
-			STATE(skb)->pgm_opt_fragment			= (struct pgm_opt_fragment*)(opt_header + 1);
-			STATE(skb)->pgm_opt_fragment->opt_reserved	= 0;
-			STATE(skb)->pgm_opt_fragment->opt_sqn		= pgm_htonl (STATE(first_sqn));
-			STATE(skb)->pgm_opt_fragment->opt_frag_off	= pgm_htonl ((uint32_t)STATE(data_bytes_offset));
-			STATE(skb)->pgm_opt_fragment->opt_frag_len	= pgm_htonl ((uint32_t)STATE(apdu_length));
+/* timer retry of APDUs queued by PGM_SEND_QUEUE, a blocked head is rescheduled
+ * rather than failing the dispatch.
+ *
+ * returns the time of the next retry, returns 0 with the queue empty.
+ */
 
-			pgm_assert (STATE(skb)->data == (STATE(skb)->pgm_opt_fragment + 1));
-		}
-		else
-		{
-			pgm_assert (STATE(skb)->data == (STATE(skb)->pgm_data + 1));
-		}
+PGM_GNUC_INTERNAL
+pgm_time_t
+pgm_on_sendq_expiry (
+	pgm_sock_t* const	sock
+	)
+{
+	pgm_time_t sendq_expiry;
 
-/* TODO: the assembly checksum & copy routine is faster than memcpy & pgm_cksum on >= opteron hardware */
-		STATE(skb)->pgm_header->pgm_checksum	= 0;
-		pgm_assert ((char*)STATE(skb)->data > (char*)STATE(skb)->pgm_header);
-		const size_t header_length		= (char*)STATE(skb)->data - (char*)STATE(skb)->pgm_header;
-		const uint32_t unfolded_header		= pgm_csum_partial (STATE(skb)->pgm_header, (uint16_t)header_length, 0);
-		STATE(unfolded_odata)			= pgm_csum_partial ((char*)STATE(skb)->data, (uint16_t)STATE(tsdu_length), 0);
-		STATE(skb)->pgm_header->pgm_checksum	= pgm_csum_fold (pgm_csum_block_add (unfolded_header, STATE(unfolded_odata), (uint16_t)header_length));
+/* pre-conditions */
+	pgm_assert (NULL != sock);
 
-/* add to transmit window, skb::data set to payload */
-		pgm_spinlock_lock (&sock->txw_spinlock);
-		pgm_txw_add (sock->window, STATE(skb));
-		pgm_spinlock_unlock (&sock->txw_spinlock);
-retry_send:
-		pgm_assert ((char*)STATE(skb)->tail > (char*)STATE(skb)->head);
-		tpdu_length = (char*)STATE(skb)->tail - (char*)STATE(skb)->head;
-		sent = pgm_sendto (sock,
-				   !STATE(is_rate_limited),	/* rate limited on blocking */
-			   	   &sock->odata_rate_control,
-				   FALSE,			/* regular socket */
-				   STATE(skb)->head,
-				   tpdu_length,
-				   (struct sockaddr*)&sock->send_gsr.gsr_group,
-				   pgm_sockaddr_len((struct sockaddr*)&sock->send_gsr.gsr_group));
-		if (sent < 0) {
-			save_errno = pgm_get_last_sock_error();
-			if (PGM_LIKELY(PGM_SOCK_EAGAIN == save_errno || PGM_SOCK_ENOBUFS == save_errno))
-			{
-				sock->is_apdu_eagain = TRUE;
-				sock->blocklen = tpdu_length + sock->iphdr_len;
-				goto blocked;
-			}
-/* fall through silently on other errors */
-		}
+	pgm_debug ("pgm_on_sendq_expiry (sock:%p)", (const void*)sock);
 
-/* save unfolded odata for retransmissions */
-		pgm_txw_set_unfolded_checksum (STATE(skb), STATE(unfolded_odata));
+	pgm_sock_mutex_lock (sock, &sock->source_mutex);
+	if (sock->sendq_len)
+		(void)send_sendq_pending (sock);
+	pgm_sock_mutex_lock (sock, &sock->timer_mutex);
+	sendq_expiry = sock->sendq_expiry;
+	pgm_sock_mutex_unlock (sock, &sock->timer_mutex);
+	pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+	return sendq_expiry;
+}
 
-		if (PGM_LIKELY((size_t)sent == tpdu_length)) {
-			bytes_sent += tpdu_length + sock->iphdr_len;	/* as counted at IP layer */
-			packets_sent++;					/* IP packets */
-			data_bytes_sent += STATE(tsdu_length);
-		}
+/* cleanup resuming send state helper 
+ */
+#undef STATE
 
-		pgm_free_skb (STATE(skb));
-		STATE(data_bytes_offset) += STATE(tsdu_length);
+/* convert a sent odata/rdata or a new parity packet to RDATA with the current trail.
+ * header is the TPDU of skb, in place or a copy.
+ */
 
-/* check for end of transmission group */
-		if (sock->use_proactive_parity) {
-			const uint32_t odata_sqn   = pgm_ntohl (STATE(skb)->pgm_data->data_sqn);
-			const uint32_t tg_sqn_mask = 0xffffffff << sock->tg_sqn_shift;
-			if (!((odata_sqn + 1) & ~tg_sqn_mask))
-				pgm_schedule_proactive_nak (sock, odata_sqn & tg_sqn_mask);
-		}
+static
+void
+rdata_update_header (
+	pgm_sock_t*	      const restrict sock,
+	struct pgm_sk_buff_t* const restrict skb,
+	struct pgm_header*    const restrict header
+	)
+{
+	const size_t		 tpdu_length = (char*)skb->tail - (char*)skb->head;
+	struct pgm_data		*rdata;
 
-	}
-#ifdef TRANSPORT_DEBUG
-	if (is_one_apdu)
+/* update previous odata/rdata contents */
+	rdata				= (struct pgm_data*)(header + 1);
+	if (PGM_LIKELY(0 != header->pgm_checksum &&
+		       !(header->pgm_options & PGM_OPT_PARITY)))
 	{
-		pgm_assert( STATE(data_bytes_offset) == STATE(apdu_length) );
+/* a sent odata/rdata packet only changes in type and trail, adjust the
+ * existing checksum (RFC 1624) instead of summing the header again.
+ */
+		uint16_t old_type, new_type;
+		const uint32_t old_trail	= rdata->data_trail;
+		memcpy (&old_type, &header->pgm_type, sizeof (old_type));
+		header->pgm_type		= PGM_RDATA;
+		rdata->data_trail		= pgm_htonl (pgm_txw_repair_trail(sock->window));
+		memcpy (&new_type, &header->pgm_type, sizeof (new_type));
+		const uint32_t new_trail	= rdata->data_trail;
+		const uint32_t sum		= (uint16_t)~header->pgm_checksum +
+						  (uint16_t)~old_type + new_type +
+						  (uint16_t)~(old_trail >> 16) + (uint16_t)~old_trail +
+						  (new_trail >> 16) + (uint16_t)new_trail;
+		header->pgm_checksum		= pgm_csum_fold (sum);
 	}
-#endif
-
-/* success */
-	sock->is_apdu_eagain = FALSE;
-/* SPM heartbeats decay from last sent data packet */
-	reset_heartbeat_spm (sock, STATE(skb)->tstamp);
-/* increment socket statistics */
-	pgm_atomic_add32 (&sock->cumulative_stats[PGM_PC_SOURCE_BYTES_SENT], (uint32_t)bytes_sent);
-	sock->cumulative_stats[PGM_PC_SOURCE_DATA_MSGS_SENT]  += packets_sent;
-	sock->cumulative_stats[PGM_PC_SOURCE_DATA_BYTES_SENT] += data_bytes_sent;
-	if (bytes_written)
-		*bytes_written = data_bytes_sent;
-	pgm_mutex_unlock (&sock->source_mutex);
-	pgm_rwlock_reader_unlock (&sock->lock);
-	return PGM_IO_STATUS_NORMAL;
+	else
+	{
+		header->pgm_type		= PGM_RDATA;
+/* parity packets are constructed by the transmit window without ports */
+		header->pgm_sport		= sock->tsi.sport;
+		header->pgm_dport		= sock->dport;
+/* RDATA */
+		rdata->data_trail		= pgm_htonl (pgm_txw_repair_trail(sock->window));
 
-blocked:
-	if (bytes_sent) {
-		reset_heartbeat_spm (sock, STATE(skb)->tstamp);
-		pgm_atomic_add32 (&sock->cumulative_stats[PGM_PC_SOURCE_BYTES_SENT], (uint32_t)bytes_sent);
-		sock->cumulative_stats[PGM_PC_SOURCE_DATA_MSGS_SENT]  += packets_sent;
-		sock->cumulative_stats[PGM_PC_SOURCE_DATA_BYTES_SENT] += data_bytes_sent;
+		header->pgm_checksum		= 0;
+		const size_t header_length	= tpdu_length - pgm_ntohs(header->pgm_tsdu_length);
+		const uint32_t unfolded_header	= pgm_csum_partial (header, (uint16_t)header_length, 0);
+		const uint32_t unfolded_odata	= pgm_txw_get_unfolded_checksum (skb);
+		header->pgm_checksum		= source_csum_fold (sock, unfolded_header, unfolded_odata, (uint16_t)header_length);
 	}
-	pgm_mutex_unlock (&sock->source_mutex);
-	pgm_rwlock_reader_unlock (&sock->lock);
-	if (PGM_SOCK_ENOBUFS == save_errno)
-		return PGM_IO_STATUS_RATE_LIMITED;
-	if (sock->use_pgmcc)
-		pgm_notify_clear (&sock->ack_notify);
-	return PGM_IO_STATUS_WOULD_BLOCK;
 }
 
-/* cleanup resuming send state helper 
+/* account a sent repair packet, the SPM heartbeat is reset by the caller.
  */
-#undef STATE
 
-/* send repair packet.
+static inline
+void
+rdata_sent (
+	pgm_sock_t*	      const restrict sock,
+	pgm_stats_t*	      const restrict stats,
+	struct pgm_sk_buff_t* const restrict skb,
+	const pgm_time_t		     now
+	)
+{
+	const size_t tpdu_length = (char*)skb->tail - (char*)skb->head;
+
+	if (sock->use_pgmcc) {
+		sock->cc->on_send (sock);
+		sock->ack_expiry = now + sock->ack_expiry_ivl;
+	}
+	pgm_txw_inc_retransmit_count (skb);
+	pgm_stats_add (stats, PGM_PC_SOURCE_SELECTIVE_BYTES_RETRANSMITTED, pgm_ntohs(skb->pgm_header->pgm_tsdu_length));
+	pgm_stats_inc (stats, PGM_PC_SOURCE_SELECTIVE_MSGS_RETRANSMITTED);	/* impossible to determine APDU count */
+	pgm_stats_add (stats, PGM_PC_SOURCE_BYTES_SENT, tpdu_length + sock->iphdr_len);
+	pgm_evtrace (PGM_EV_RDATA_SENT, &sock->tsi, skb->sequence, 0);
+}
+
+/* send repair packet, counted in the statistics block of the calling context.
  *
  * on success, TRUE is returned.  on error, FALSE is returned.
  */
@@ -2457,16 +5374,17 @@ static
 bool
 send_rdata (
 	pgm_sock_t*	      restrict sock,
+	pgm_stats_t*	      restrict stats,
 	struct pgm_sk_buff_t* restrict skb
 	)
 {
 	size_t			 tpdu_length;
 	struct pgm_header	*header;
-	struct pgm_data		*rdata;
 	ssize_t			 sent;
 
 /* pre-conditions */
 	pgm_assert (NULL != sock);
+	pgm_assert (NULL != stats);
 	pgm_assert (NULL != skb);
 	pgm_assert ((char*)skb->tail > (char*)skb->head);
 
@@ -2483,19 +5401,6 @@ send_rdata (
 		return FALSE;
 	}
 
-/* update previous odata/rdata contents */
-	header				= skb->pgm_header;
-	rdata				= skb->pgm_data;
-	header->pgm_type		= PGM_RDATA;
-/* RDATA */
-        rdata->data_trail		= pgm_htonl (pgm_txw_trail(sock->window));
-
-        header->pgm_checksum		= 0;
-	const size_t header_length	= tpdu_length - pgm_ntohs(header->pgm_tsdu_length);
-	const uint32_t unfolded_header	= pgm_csum_partial (header, (uint16_t)header_length, 0);
-	const uint32_t unfolded_odata	= pgm_txw_get_unfolded_checksum (skb);
-	header->pgm_checksum		= pgm_csum_fold (pgm_csum_block_add (unfolded_header, unfolded_odata, (uint16_t)header_length));
-
 /* congestion control */
 	if (sock->use_pgmcc &&
 	    sock->tokens < pgm_fp8 (1))
@@ -2505,6 +5410,14 @@ send_rdata (
 		return FALSE;
 	}
 
+/* the kernel may still be transmitting a zero-copy ODATA from the skbuff */
+	if (PGM_UNLIKELY(skb->is_zc_pending)) {
+		header = pgm_alloca (tpdu_length);
+		memcpy (header, skb->head, tpdu_length);
+	} else
+		header = skb->pgm_header;
+	rdata_update_header (sock, skb, header);
+
 	sent = pgm_sendto (sock,
 			   FALSE,			/* already rate limited */
 			   &sock->rdata_rate_control,
@@ -2524,24 +5437,97 @@ send_rdata (
 	}
 
 	const pgm_time_t now = pgm_time_update_now();
-
-	if (sock->use_pgmcc) {
-		sock->tokens -= pgm_fp8 (1);
-		sock->ack_expiry = now + sock->ack_expiry_ivl;
-	}
+	rdata_sent (sock, stats, skb, now);
 
 /* re-set spm timer: we are already in the timer thread, no need to prod timers
  */
-	pgm_mutex_lock (&sock->timer_mutex);
+	pgm_sock_mutex_lock (sock, &sock->timer_mutex);
 	sock->spm_heartbeat_state = 1;
 	sock->next_heartbeat_spm = now + sock->spm_heartbeat_interval[sock->spm_heartbeat_state++];
-	pgm_mutex_unlock (&sock->timer_mutex);
-
-	pgm_txw_inc_retransmit_count (skb);
-	sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_BYTES_RETRANSMITTED] += pgm_ntohs(header->pgm_tsdu_length);
-	sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_MSGS_RETRANSMITTED]++;	/* impossible to determine APDU count */
-	pgm_atomic_add32 (&sock->cumulative_stats[PGM_PC_SOURCE_BYTES_SENT], (uint32_t)(tpdu_length + sock->iphdr_len));
+	pgm_sock_mutex_unlock (sock, &sock->timer_mutex);
 	return TRUE;
 }
 
+/* send a batch of selective repair packets with one rate limit charge and one
+ * sendmmsg() or GSO call, counted in the statistics block of the calling context.
+ *
+ * returns count of packets sent from the start of skbv, zero when blocked.
+ */
+
+static
+unsigned
+send_rdatav (
+	pgm_sock_t*	      restrict sock,
+	pgm_stats_t*	      restrict stats,
+	struct pgm_sk_buff_t**const restrict skbv,
+	const unsigned		       count
+	)
+{
+	struct pgm_iovec	iov[ PGM_RDATA_BATCH ];
+	size_t			tpdu_length = 0;
+	ssize_t			sent;
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != stats);
+	pgm_assert (NULL != skbv);
+	pgm_assert (count > 0 && count <= PGM_RDATA_BATCH);
+	pgm_assert (!sock->use_pgmcc);
+
+	for (unsigned i = 0; i < count; i++) {
+		pgm_assert ((char*)skbv[i]->tail > (char*)skbv[i]->head);
+		iov[i].iov_base = skbv[i]->head;
+		iov[i].iov_len  = (char*)skbv[i]->tail - (char*)skbv[i]->head;
+		tpdu_length += iov[i].iov_len;
+	}
+
+/* rate check including rdata specific limits, the bucket charges one IP header */
+	if (sock->is_controlled_rdata &&
+	    !pgm_rate_check2 (&sock->rate_control,
+			      &sock->rdata_rate_control,
+			      tpdu_length + (count - 1) * sock->iphdr_len,
+			      sock->is_nonblocking))
+	{
+		sock->blocklen = tpdu_length + count * sock->iphdr_len;
+		return 0;
+	}
+
+	for (unsigned i = 0; i < count; i++) {
+		pgm_assert (!skbv[i]->is_zc_pending);
+		rdata_update_header (sock, skbv[i], skbv[i]->pgm_header);
+	}
+
+	sent = pgm_sendtov (sock,
+			    FALSE,			/* already rate limited */
+			    &sock->rdata_rate_control,
+			    TRUE,			/* with router alert */
+			    iov,
+			    count,
+			    (struct sockaddr*)&sock->send_gsr.gsr_group,
+			    pgm_sockaddr_len((struct sockaddr*)&sock->send_gsr.gsr_group),
+			    0);
+	if (sent < 0) {
+		const int save_errno = pgm_get_last_sock_error();
+		if (PGM_LIKELY(PGM_SOCK_EAGAIN == save_errno || PGM_SOCK_ENOBUFS == save_errno))
+		{
+			sock->blocklen = iov[0].iov_len + sock->iphdr_len;
+			return 0;
+		}
+/* fall through silently on other errors, dropping the batch as per send_rdata() */
+		sent = count;
+	}
+	else if ((unsigned)sent < count)
+		sock->blocklen = iov[ sent ].iov_len + sock->iphdr_len;
+
+	const pgm_time_t now = pgm_time_update_now();
+	for (unsigned i = 0; i < (unsigned)sent; i++)
+		rdata_sent (sock, stats, skbv[i], now);
+
+	pgm_sock_mutex_lock (sock, &sock->timer_mutex);
+	sock->spm_heartbeat_state = 1;
+	sock->next_heartbeat_spm = now + sock->spm_heartbeat_interval[sock->spm_heartbeat_state++];
+	pgm_sock_mutex_unlock (sock, &sock->timer_mutex);
+	return (unsigned)sent;
+}
+
 /* eof */
@@ -63,6 +63,14 @@ static gboolean mock_is_valid_spmr = TRUE;
 static gboolean mock_is_valid_ack = TRUE;
 static gboolean mock_is_valid_nak = TRUE;
 static gboolean mock_is_valid_nnak = TRUE;
+static gboolean mock_is_send_blocked = FALSE;
+static unsigned mock_sendto_count = 0;
+static int mock_sendto_type = -1;
+static unsigned mock_selective_push_count = 0;
+static unsigned mock_parity_push_count = 0;
+static unsigned mock_retransmit_batch = 0;
+static unsigned mock_remove_head_count = 0;
+static unsigned mock_sendtov_count = 0;
 
 
 #define pgm_txw_get_unfolded_checksum	mock_pgm_txw_get_unfolded_checksum
@@ -71,8 +79,22 @@ static gboolean mock_is_valid_nnak = TRUE;
 #define pgm_txw_add			mock_pgm_txw_add
 #define pgm_txw_peek			mock_pgm_txw_peek
 #define pgm_txw_retransmit_push		mock_pgm_txw_retransmit_push
+#define pgm_txw_retransmit_push_range	mock_pgm_txw_retransmit_push_range
+#define pgm_txw_get_repair		mock_pgm_txw_get_repair
 #define pgm_txw_retransmit_try_peek	mock_pgm_txw_retransmit_try_peek
+#define pgm_txw_retransmit_try_peekv	mock_pgm_txw_retransmit_try_peekv
 #define pgm_txw_retransmit_remove_head	mock_pgm_txw_retransmit_remove_head
+#define pgm_txw_parity_submit		mock_pgm_txw_parity_submit
+#define pgm_txw_parity_try_peek		mock_pgm_txw_parity_try_peek
+#define pgm_txw_parity_remove_head	mock_pgm_txw_parity_remove_head
+#define pgm_txw_sw_encode		mock_pgm_txw_sw_encode
+#define pgm_txw_store_spm		mock_pgm_txw_store_spm
+#define pgm_txw_store_open		mock_pgm_txw_store_open
+#define pgm_txw_store_close		mock_pgm_txw_store_close
+#define pgm_txw_store_resume		mock_pgm_txw_store_resume
+#define pgm_txw_store_geometry		mock_pgm_txw_store_geometry
+#define pgm_txw_store_is_owned		mock_pgm_txw_store_is_owned
+#define pgm_txw_set_store		mock_pgm_txw_set_store
 #define pgm_rs_encode			mock_pgm_rs_encode
 #define pgm_rate_check			mock_pgm_rate_check
 #define pgm_verify_spmr			mock_pgm_verify_spmr
@@ -81,9 +103,11 @@ static gboolean mock_is_valid_nnak = TRUE;
 #define pgm_verify_nnak			mock_pgm_verify_nnak
 #define pgm_compat_csum_partial		mock_pgm_compat_csum_partial
 #define pgm_compat_csum_partial_copy	mock_pgm_compat_csum_partial_copy
+#define pgm_compat_csum_partial_copy_nt	mock_pgm_compat_csum_partial_copy_nt
 #define pgm_csum_block_add		mock_pgm_csum_block_add
 #define pgm_csum_fold			mock_pgm_csum_fold
 #define pgm_sendto_hops			mock_pgm_sendto_hops
+#define pgm_sendtov			mock_pgm_sendtov
 #define pgm_time_update_now		mock_pgm_time_update_now
 #define pgm_setsockopt			mock_pgm_setsockopt
 
@@ -122,10 +146,12 @@ generate_sock (void)
 	sock->iphdr_len = sizeof(struct pgm_ip);
 	sock->spm_heartbeat_interval = g_malloc0 (sizeof(guint) * (2+2));
 	sock->spm_heartbeat_interval[0] = pgm_secs(1);
-	pgm_spinlock_init (&sock->txw_spinlock);
 	pgm_mutex_init (&sock->source_mutex);
 	pgm_mutex_init (&sock->timer_mutex);
+	pgm_mutex_init (&sock->nak_mutex);
+	pgm_mutex_init (&sock->catchup_mutex);
 	pgm_rwlock_init (&sock->lock);
+	pgm_source_select_send (sock);
 	return sock;
 }
 
@@ -196,6 +222,11 @@ generate_spmr (void)
 	return skb;
 }
 
+/* IP source of generated NAKs */
+static const struct sockaddr_in skb_addr = {
+	.sin_family		= AF_INET
+};
+
 static
 struct pgm_sk_buff_t*
 generate_single_nak (void)
@@ -281,6 +312,51 @@ generate_nak_list (void)
 	return skb;
 }
 
+static
+struct pgm_sk_buff_t*
+generate_catchup_nak (void)
+{
+	struct pgm_sk_buff_t* skb = pgm_alloc_skb (TEST_MAX_TPDU);
+	const guint16 header_length = sizeof(struct pgm_header) + sizeof(struct pgm_nak) +
+				      sizeof(struct pgm_opt_length) +
+				      sizeof(struct pgm_opt_header) + sizeof(struct pgm_opt_catchup);
+	pgm_skb_reserve (skb, sizeof(struct pgm_header));
+	memset (skb->head, 0, header_length);
+	skb->pgm_header = (struct pgm_header*)skb->head;
+	skb->pgm_header->pgm_type = PGM_NAK;
+	skb->pgm_header->pgm_options = PGM_OPT_PRESENT;
+	struct pgm_nak *nak = (struct pgm_nak*)(skb->pgm_header + 1);
+	nak->nak_sqn = g_htonl (1000);
+	struct sockaddr_in nla = {
+		.sin_family		= AF_INET,
+		.sin_addr.s_addr	= inet_addr("127.0.0.2")
+	};
+	pgm_sockaddr_to_nla ((struct sockaddr*)&nla, (char*)&nak->nak_src_nla_afi);
+	struct sockaddr_in group = {
+		.sin_family		= AF_INET,
+		.sin_addr.s_addr	= inet_addr("239.192.0.1")
+	};
+	pgm_sockaddr_to_nla ((struct sockaddr*)&group, (char*)&nak->nak_grp_nla_afi);
+	struct pgm_opt_length* opt_len = (struct pgm_opt_length*)(nak + 1);
+	opt_len->opt_type = PGM_OPT_LENGTH;
+	opt_len->opt_length = sizeof(struct pgm_opt_length);
+	opt_len->opt_total_length = g_htons (   sizeof(struct pgm_opt_length) +
+						sizeof(struct pgm_opt_header) +
+						sizeof(struct pgm_opt_catchup) );
+	struct pgm_opt_header* opt_header = (struct pgm_opt_header*)(opt_len + 1);
+	opt_header->opt_type = PGM_OPT_CATCHUP | PGM_OPT_END;
+	opt_header->opt_length = sizeof(struct pgm_opt_header) + sizeof(struct pgm_opt_catchup);
+	struct pgm_opt_catchup* opt_catchup = (struct pgm_opt_catchup*)(opt_header + 1);
+	opt_catchup->catchup_count = g_htonl (500);
+	struct sockaddr_in receiver = {
+		.sin_family		= AF_INET,
+		.sin_addr.s_addr	= inet_addr("127.0.0.3")
+	};
+	pgm_sockaddr_to_nla ((struct sockaddr*)&receiver, (char*)&opt_catchup->opt_nla_afi);
+	pgm_skb_put (skb, header_length);
+	return skb;
+}
+
 static
 struct pgm_sk_buff_t*
 generate_parity_nak_list (void)
@@ -324,9 +400,37 @@ mock_pgm_txw_retransmit_push (
 		sequence,
 		is_parity ? "YES" : "NO",
 		tg_sqn_shift);
+	if (is_parity)
+		mock_parity_push_count++;
+	else
+		mock_selective_push_count++;
 	return TRUE;
 }
 
+unsigned
+mock_pgm_txw_retransmit_push_range (
+	pgm_txw_t* const		window,
+	const uint32_t			first,
+	const uint32_t			count
+	)
+{
+	g_debug ("mock_pgm_txw_retransmit_push_range (window:%p first:%" G_GUINT32_FORMAT " count:%" G_GUINT32_FORMAT ")",
+		(gpointer)window,
+		first,
+		count);
+	mock_selective_push_count += count;
+	return count;
+}
+
+struct pgm_sk_buff_t*
+mock_pgm_txw_get_repair (
+	pgm_txw_t* const		window,
+	const uint32_t			sequence
+	)
+{
+	return NULL;
+}
+
 void
 mock_pgm_txw_set_unfolded_checksum (
 	struct pgm_sk_buff_t*const skb,
@@ -360,6 +464,21 @@ mock_pgm_txw_retransmit_try_peek (
 	return generate_odata (); 
 }
 
+unsigned
+mock_pgm_txw_retransmit_try_peekv (
+	pgm_txw_t* const		window,
+	struct pgm_sk_buff_t**const	skbv,
+	const unsigned			count
+	)
+{
+	g_debug ("mock_pgm_txw_retransmit_try_peekv (window:%p skbv:%p count:%u)",
+		(gpointer)window, (gpointer)skbv, count);
+	const unsigned n = MIN(count, mock_retransmit_batch);
+	for (unsigned i = 0; i < n; i++)
+		skbv[i] = generate_odata ();
+	return n;
+}
+
 void
 mock_pgm_txw_retransmit_remove_head (
 	pgm_txw_t* const		window
@@ -367,6 +486,130 @@ mock_pgm_txw_retransmit_remove_head (
 {
 	g_debug ("mock_pgm_txw_retransmit_remove_head (window:%p)",
 		(gpointer)window);
+	mock_remove_head_count++;
+}
+
+bool
+mock_pgm_txw_parity_submit (
+	pgm_txw_t* const		window,
+	const uint32_t			tg_sqn
+	)
+{
+	g_debug ("mock_pgm_txw_parity_submit (window:%p tg-sqn:%" G_GUINT32_FORMAT ")",
+		(gpointer)window,
+		tg_sqn);
+	return TRUE;
+}
+
+struct pgm_sk_buff_t*
+mock_pgm_txw_parity_try_peek (
+	pgm_txw_t* const		window
+	)
+{
+	g_debug ("mock_pgm_txw_parity_try_peek (window:%p)",
+		(gpointer)window);
+	return NULL;
+}
+
+void
+mock_pgm_txw_parity_remove_head (
+	pgm_txw_t* const		window
+	)
+{
+	g_debug ("mock_pgm_txw_parity_remove_head (window:%p)",
+		(gpointer)window);
+}
+
+struct pgm_sk_buff_t*
+mock_pgm_txw_sw_encode (
+	pgm_txw_t* const		window,
+	const uint32_t			lead,
+	const uint8_t			count,
+	const uint16_t			key
+	)
+{
+	g_debug ("mock_pgm_txw_sw_encode (window:%p lead:%" G_GUINT32_FORMAT " count:%u key:%u)",
+		(gpointer)window,
+		lead, (unsigned)count, (unsigned)key);
+	return NULL;
+}
+
+PGM_GNUC_INTERNAL
+void
+mock_pgm_txw_store_spm (
+	struct pgm_txw_store_t*const	store,
+	const uint32_t			spm_sqn
+	)
+{
+}
+
+static bool mock_is_owned = TRUE;
+static struct pgm_txw_store_t* mock_store = (struct pgm_txw_store_t*)0x1;
+
+PGM_GNUC_INTERNAL
+struct pgm_txw_store_t*
+mock_pgm_txw_store_open (
+	const char*		path,
+	const pgm_tsi_t*	tsi,
+	const uint16_t		max_tpdu,
+	uint32_t		sqns,
+	pgm_error_t**		error
+	)
+{
+	return mock_store;
+}
+
+PGM_GNUC_INTERNAL
+void
+mock_pgm_txw_store_close (
+	struct pgm_txw_store_t*	store
+	)
+{
+}
+
+PGM_GNUC_INTERNAL
+bool
+mock_pgm_txw_store_resume (
+	const struct pgm_txw_store_t*const store,
+	uint32_t*		lead,
+	uint32_t*		spm_sqn
+	)
+{
+	*lead = 99;
+	*spm_sqn = 9;
+	return TRUE;
+}
+
+PGM_GNUC_INTERNAL
+void
+mock_pgm_txw_store_geometry (
+	const struct pgm_txw_store_t*const store,
+	pgm_tsi_t*		tsi,
+	uint32_t*		sqns,
+	uint16_t*		max_tpdu
+	)
+{
+	memset (tsi, 0, sizeof (pgm_tsi_t));
+	*sqns = 1024;
+	*max_tpdu = TEST_MAX_TPDU;
+}
+
+PGM_GNUC_INTERNAL
+bool
+mock_pgm_txw_store_is_owned (
+	const struct pgm_txw_store_t*const store
+	)
+{
+	return mock_is_owned;
+}
+
+PGM_GNUC_INTERNAL
+void
+mock_pgm_txw_set_store (
+	pgm_txw_t*const		window,
+	struct pgm_txw_store_t*const store
+	)
+{
 }
 
 void
@@ -447,6 +690,16 @@ mock_pgm_compat_csum_partial_copy (
 {
 	return 0x0;
 }
+uint32_t
+mock_pgm_compat_csum_partial_copy_nt (
+	const void*			src,
+	void*				dst,
+	uint16_t			len,
+	uint32_t			csum
+	)
+{
+	return 0x0;
+}
 
 uint32_t
 mock_pgm_csum_block_add (
@@ -492,9 +745,45 @@ mock_pgm_sendto_hops (
 		(unsigned)len,
 		saddr,
 		tolen);
+	if (mock_is_send_blocked) {
+		errno = EAGAIN;
+		return -1;
+	}
+	mock_sendto_count++;
+	mock_sendto_type = ((const struct pgm_header*)buf)->pgm_type;
 	return len;
 }
 
+PGM_GNUC_INTERNAL
+ssize_t
+mock_pgm_sendtov (
+	pgm_sock_t*			sock,
+	bool				use_rate_limit,
+	pgm_rate_t*			minor_rate_control,
+	bool				use_router_alert,
+	const struct pgm_iovec*		vector,
+	unsigned			count,
+	const struct sockaddr*		to,
+	socklen_t			tolen,
+	int				flags
+	)
+{
+	char saddr[INET6_ADDRSTRLEN];
+	pgm_sockaddr_ntop (to, saddr, sizeof(saddr));
+	g_debug ("mock_pgm_sendtov (sock:%p use-rate-limit:%s minor-rate-control:%p use-router-alert:%s vector:%p count:%u to:%s tolen:%d flags:%d)",
+		(gpointer)sock,
+		use_rate_limit ? "YES" : "NO",
+		(gpointer)minor_rate_control,
+		use_router_alert ? "YES" : "NO",
+		(gconstpointer)vector,
+		count,
+		saddr,
+		tolen,
+		flags);
+	mock_sendtov_count++;
+	return count;
+}
+
 /** time module */
 static pgm_time_t _mock_pgm_time_update_now (void);
 pgm_time_update_func mock_pgm_time_update_now = _mock_pgm_time_update_now;
@@ -583,6 +872,20 @@ START_TEST (test_send_pass_002)
 }
 END_TEST
 
+/* standby would block */
+START_TEST (test_send_pass_003)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	sock->is_standby = 1;
+	const gsize apdu_length = 100;
+	guint8 buffer[ apdu_length ];
+	gsize bytes_written;
+	fail_unless (PGM_IO_STATUS_WOULD_BLOCK == pgm_send (sock, buffer, apdu_length, &bytes_written), "send not would-block");
+}
+END_TEST
+
 START_TEST (test_send_fail_001)
 {
 	guint8 buffer[ TEST_TXW_SQNS * TEST_MAX_TPDU ];
@@ -592,6 +895,154 @@ START_TEST (test_send_fail_001)
 }
 END_TEST
 
+/* target:
+ *	void
+ *	pgm_source_select_send (
+ *		pgm_sock_t*	sock
+ *		)
+ */
+
+START_TEST (test_select_send_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	fail_unless (send_odata_copy_plain == sock->odata_copy, "plain path not selected");
+	sock->use_pgmcc = TRUE;
+	pgm_source_select_send (sock);
+	fail_unless (send_odata_copy_generic == sock->odata_copy, "generic path not selected");
+	sock->use_pgmcc = FALSE;
+	sock->use_sliding_fec = TRUE;
+	pgm_source_select_send (sock);
+	fail_unless (send_odata_copy_generic == sock->odata_copy, "generic path not selected");
+}
+END_TEST
+
+/* target:
+ *	PGMIOStatus
+ *	pgm_send_batch (
+ *		pgm_sock_t*	sock,
+ *		gconstpointer		apdu,
+ *		gsize			apdu_length,
+ *		gsize*			bytes_written
+ *		)
+ */
+
+START_TEST (test_send_batch_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	sock->batch_max = 160;
+	sock->batch_buf = g_malloc0 (sock->batch_max);
+	const gsize apdu_length = 50;
+	guint8 buffer[ apdu_length ];
+	gsize bytes_written;
+	memset (buffer, 0, sizeof(buffer));
+/* coalesced: 52, 104, 156 bytes pending */
+	for (unsigned i = 0; i < 3; i++) {
+		fail_unless (PGM_IO_STATUS_NORMAL == pgm_send_batch (sock, buffer, apdu_length, &bytes_written), "send_batch not normal");
+		fail_unless ((gssize)apdu_length == bytes_written, "send_batch underrun");
+		fail_unless (1 + i == sock->batch_count, "message not coalesced");
+	}
+/* full, pending messages sent first */
+	fail_unless (PGM_IO_STATUS_NORMAL == pgm_send_batch (sock, buffer, apdu_length, &bytes_written), "send_batch not normal");
+	fail_unless (1 == sock->batch_count && 52 == sock->batch_len, "pending messages not sent");
+	fail_unless (PGM_IO_STATUS_NORMAL == pgm_send_flush (sock, &bytes_written), "send_flush not normal");
+	fail_unless ((gssize)apdu_length == bytes_written, "send_flush underrun");
+	fail_unless (0 == sock->batch_count && 0 == sock->batch_len, "messages not flushed");
+}
+END_TEST
+
+/* disabled, sent as pgm_send() */
+START_TEST (test_send_batch_pass_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	const gsize apdu_length = 100;
+	guint8 buffer[ apdu_length ];
+	gsize bytes_written;
+	fail_unless (PGM_IO_STATUS_NORMAL == pgm_send_batch (sock, buffer, apdu_length, &bytes_written), "send_batch not normal");
+	fail_unless ((gssize)apdu_length == bytes_written, "send_batch underrun");
+	fail_unless (0 == sock->batch_count, "message coalesced");
+}
+END_TEST
+
+START_TEST (test_send_batch_fail_001)
+{
+	guint8 buffer[ 100 ];
+	const gsize apdu_length = 100;
+	gsize bytes_written;
+	fail_unless (PGM_IO_STATUS_ERROR == pgm_send_batch (NULL, buffer, apdu_length, &bytes_written), "send_batch not error");
+}
+END_TEST
+
+/* target:
+ *	PGMIOStatus
+ *	pgm_send (
+ *		pgm_sock_t*	sock,
+ *		gconstpointer		apdu,
+ *		gsize			apdu_length,
+ *		gsize*			bytes_written
+ *		)
+ * with PGM_SEND_QUEUE
+ */
+
+START_TEST (test_send_queue_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	sock->sendq_max = 2;
+	sock->sendq = g_new0 (struct pgm_sendq_msg_t*, sock->sendq_max);
+	fail_unless (0 == pgm_notify_init (&sock->sendq_notify), "pgm_notify_init failed");
+	const gsize apdu_length = 100;
+	guint8 buffer[ apdu_length ];
+	gsize bytes_written;
+	memset (buffer, 0, sizeof(buffer));
+/* blocked sends are queued */
+	mock_is_send_blocked = TRUE;
+	for (unsigned i = 0; i < 2; i++) {
+		fail_unless (PGM_IO_STATUS_NORMAL == pgm_send (sock, buffer, apdu_length, &bytes_written), "send not normal");
+		fail_unless ((gssize)apdu_length == bytes_written, "send underrun");
+		fail_unless (1 + i == sock->sendq_len, "APDU not queued");
+	}
+	fail_unless (0 != sock->sendq_expiry, "retry not scheduled");
+/* full */
+	fail_unless (PGM_IO_STATUS_WOULD_BLOCK == pgm_send (sock, buffer, apdu_length, &bytes_written), "send not would-block");
+	fail_unless (2 == sock->sendq_len, "APDU queued on full");
+/* drained ahead of the next APDU */
+	mock_is_send_blocked = FALSE;
+	fail_unless (PGM_IO_STATUS_NORMAL == pgm_send (sock, buffer, apdu_length, &bytes_written), "send not normal");
+	fail_unless (0 == sock->sendq_len, "queue not drained");
+	fail_unless (0 == sock->sendq_expiry, "retry not cancelled");
+	fail_unless (0 == pgm_on_sendq_expiry (sock), "retry pending");
+}
+END_TEST
+
+/* timer drains the queue */
+START_TEST (test_send_queue_pass_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	sock->sendq_max = 4;
+	sock->sendq = g_new0 (struct pgm_sendq_msg_t*, sock->sendq_max);
+	fail_unless (0 == pgm_notify_init (&sock->sendq_notify), "pgm_notify_init failed");
+	const gsize apdu_length = 16000;
+	guint8 buffer[ apdu_length ];
+	gsize bytes_written;
+	memset (buffer, 0, sizeof(buffer));
+	mock_is_send_blocked = TRUE;
+	fail_unless (PGM_IO_STATUS_NORMAL == pgm_send (sock, buffer, apdu_length, &bytes_written), "send not normal");
+	fail_unless (1 == sock->sendq_len, "APDU not queued");
+	fail_unless (0 != pgm_on_sendq_expiry (sock), "retry not pending");
+	mock_is_send_blocked = FALSE;
+	fail_unless (0 == pgm_on_sendq_expiry (sock), "retry pending");
+	fail_unless (0 == sock->sendq_len, "queue not drained");
+}
+END_TEST
+
 /* target:
  *	PGMIOStatus
  *	pgm_sendv (
@@ -752,6 +1203,46 @@ START_TEST (test_send_skbv_fail_001)
 }
 END_TEST
 
+/* target:
+ *	PGMIOStatus
+ *	pgm_send_skbv_csum (
+ *		pgm_sock_t*	sock,
+ *		struct pgm_sk_buff_t*	vector[],
+ *		const uint32_t		csums[],
+ *		guint			count,
+ *		gboolean		is_one_apdu,
+ *		gsize*			bytes_written
+ *		)
+ */
+
+START_TEST (test_send_skbv_csum_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	struct pgm_sk_buff_t* skb = NULL;
+	skb = generate_skb ();
+	fail_if (NULL == skb, "generate_skb failed");
+	const uint32_t csum = pgm_csum_payload (skb->data, skb->len);
+	gsize apdu_length = (gsize)skb->len;
+	gsize bytes_written;
+	fail_unless (PGM_IO_STATUS_NORMAL == pgm_send_skbv_csum (sock, &skb, &csum, 1, TRUE, &bytes_written), "send not normal");
+	fail_unless (apdu_length == bytes_written, "send underrun");
+}
+END_TEST
+
+START_TEST (test_send_skbv_csum_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	struct pgm_sk_buff_t* skb = generate_skb ();
+	fail_if (NULL == skb, "generate_skb failed");
+	gsize bytes_written;
+	fail_unless (PGM_IO_STATUS_ERROR == pgm_send_skbv_csum (sock, &skb, NULL, 1, TRUE, &bytes_written), "send not error");
+}
+END_TEST
+
 /* target:
  *	gboolean
  *	pgm_send_spm (
@@ -768,6 +1259,40 @@ START_TEST (test_send_spm_pass_001)
 }
 END_TEST
 
+/* target:
+ *	uint8_t
+ *	fec_adapt (
+ *		pgm_sock_t*	sock
+ *		)
+ */
+
+/* parity follows reported loss and stops on a clean link */
+START_TEST (test_fec_adapt_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->use_proactive_parity = sock->use_adaptive_fec = TRUE;
+	sock->rs_n = 12;
+	sock->rs_k = 8;
+	sock->rs_proactive_max_h = 4;
+	for (unsigned i = 0; i < PGM_FEC_ADAPT_TGS; i++)
+		fail_unless (0 == fec_adapt (sock), "parity on clean link");
+	fail_unless (0 == source_parity_prm (sock), "proactive parity announced");
+/* one in eight packets lost */
+	for (unsigned i = 0; i < 4; i++) {
+		sock->fec_nak_count += PGM_FEC_ADAPT_TGS;
+		for (unsigned j = 0; j < PGM_FEC_ADAPT_TGS; j++)
+			(void)fec_adapt (sock);
+	}
+	fail_unless (sock->rs_proactive_h > 0 && sock->rs_proactive_h <= 2, "parity not adapted to loss");
+	fail_unless (PGM_PARITY_PRM_PRO == source_parity_prm (sock), "proactive parity not announced");
+/* loss ceases */
+	for (unsigned i = 0; i < 32 * PGM_FEC_ADAPT_TGS; i++)
+		(void)fec_adapt (sock);
+	fail_unless (0 == sock->rs_proactive_h, "parity on recovered link");
+}
+END_TEST
+
 START_TEST (test_send_spm_fail_001)
 {
 	pgm_send_spm (NULL, 0);
@@ -775,6 +1300,106 @@ START_TEST (test_send_spm_fail_001)
 }
 END_TEST
 
+/* target:
+ *	bool
+ *	send_rdata (
+ *		pgm_sock_t*		sock,
+ *		pgm_stats_t*		stats,
+ *		struct pgm_sk_buff_t*	skb
+ *		)
+ */
+
+/* target:
+ *	pgm_time_t
+ *	pgm_on_standby (
+ *		pgm_sock_t*		sock,
+ *		const pgm_time_t	now
+ *		)
+ */
+
+/* primary running, then exited */
+START_TEST (test_on_standby_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	sock->is_standby = 1;
+	sock->standby = mock_store;
+	sock->standby_req.sb_ivl = 1000;
+	mock_is_owned = TRUE;
+	fail_unless (pgm_secs(1) + pgm_msecs(1) == pgm_on_standby (sock, pgm_secs(1)), "poll not scheduled");
+	fail_unless (sock->is_standby, "took over");
+	fail_unless (99 == sock->standby_lead, "progress not recorded");
+	mock_is_owned = FALSE;
+	fail_unless (0 == pgm_on_standby (sock, pgm_secs(2)), "not taken over");
+	fail_if (sock->is_standby, "still standby");
+	fail_unless (mock_store == sock->txw_store, "store not opened");
+	fail_unless (10 == sock->spm_sqn, "spm sequence not resumed");
+}
+END_TEST
+
+/* primary running without progress beyond sb_timeout */
+START_TEST (test_on_standby_pass_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	sock->is_standby = 1;
+	sock->standby = mock_store;
+	sock->standby_req.sb_ivl = 1000;
+	sock->standby_req.sb_timeout = 500000;
+	mock_is_owned = TRUE;
+	fail_if (0 == pgm_on_standby (sock, pgm_secs(1)), "taken over");
+	fail_if (0 == pgm_on_standby (sock, pgm_secs(1) + pgm_msecs(400)), "taken over");
+	fail_unless (0 == pgm_on_standby (sock, pgm_secs(1) + pgm_msecs(500)), "not taken over");
+	fail_if (sock->is_standby, "still standby");
+}
+END_TEST
+
+/* sent odata is rewritten in place as rdata */
+START_TEST (test_send_rdata_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	struct pgm_sk_buff_t* skb = generate_odata ();
+	skb->pgm_header->pgm_sport = sock->tsi.sport;
+	skb->pgm_header->pgm_dport = sock->dport;
+	skb->pgm_header->pgm_checksum = g_htons (0x1234);
+	sock->window->trail = 42;
+	fail_unless (TRUE == send_rdata (sock, &sock->cumulative_stats[PGM_STATS_RX], skb), "send_rdata failed");
+	fail_unless (PGM_RDATA == skb->pgm_header->pgm_type, "type not rdata");
+	fail_unless (42 == g_ntohl (skb->pgm_data->data_trail), "trail not updated");
+	fail_unless (sock->tsi.sport == skb->pgm_header->pgm_sport, "sport changed");
+	fail_unless (sock->dport == skb->pgm_header->pgm_dport, "dport changed");
+}
+END_TEST
+
+/* zero-copy odata still in flight is repaired from a copy */
+START_TEST (test_send_rdata_pass_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	struct pgm_sk_buff_t* skb = generate_odata ();
+	skb->pgm_header->pgm_sport = sock->tsi.sport;
+	skb->pgm_header->pgm_dport = sock->dport;
+	skb->pgm_header->pgm_checksum = g_htons (0x1234);
+	skb->is_zc_pending = 1;
+	sock->window->trail = 42;
+	mock_sendto_type = -1;
+	fail_unless (TRUE == send_rdata (sock, &sock->cumulative_stats[PGM_STATS_RX], skb), "send_rdata failed");
+	fail_unless (PGM_RDATA == mock_sendto_type, "rdata not sent");
+	fail_unless (PGM_ODATA == skb->pgm_header->pgm_type, "in-flight odata rewritten");
+	fail_unless (0x1234 == g_ntohs (skb->pgm_header->pgm_checksum), "in-flight checksum rewritten");
+}
+END_TEST
+
+START_TEST (test_send_rdata_fail_001)
+{
+	send_rdata (NULL, NULL, NULL);
+	fail ("reached");
+}
+END_TEST
+
 /* target:
  *	void
  *	pgm_on_deferred_nak (
@@ -790,6 +1415,21 @@ START_TEST (test_on_deferred_nak_pass_001)
 }
 END_TEST
 	
+/* run of selective requests sent as one batch */
+START_TEST (test_on_deferred_nak_pass_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	mock_retransmit_batch = PGM_RDATA_BATCH + 1;
+	mock_remove_head_count = mock_sendtov_count = 0;
+	fail_unless (TRUE == pgm_on_deferred_nak (sock), "on_deferred_nak failed");
+	mock_retransmit_batch = 0;
+	fail_unless (1 == mock_sendtov_count, "not one batch");
+	fail_unless (PGM_RDATA_BATCH == mock_remove_head_count, "batch not removed");
+	fail_unless (PGM_RDATA_BATCH == sock->cumulative_stats[PGM_STATS_RX].counters[PGM_PC_SOURCE_SELECTIVE_MSGS_RETRANSMITTED], "batch not counted");
+}
+END_TEST
+
 START_TEST (test_on_deferred_nak_fail_001)
 {
 	pgm_on_deferred_nak (NULL);
@@ -858,7 +1498,8 @@ END_TEST
  *	gboolean
  *	pgm_on_nak (
  *		pgm_sock_t*	sock,
- *		struct pgm_sk_buff_t*	skb
+ *		struct pgm_sk_buff_t*	skb,
+ *		const struct sockaddr*	src_addr
  *	)
  */
 
@@ -870,7 +1511,7 @@ START_TEST (test_on_nak_pass_001)
 	struct pgm_sk_buff_t* skb = generate_single_nak ();
 	fail_if (NULL == skb, "generate_single_nak failed");
 	skb->sock = sock;
-	fail_unless (TRUE == pgm_on_nak (sock, skb), "on_nak failed");
+	fail_unless (TRUE == pgm_on_nak (sock, skb, (struct sockaddr*)&skb_addr), "on_nak failed");
 }
 END_TEST
 
@@ -882,7 +1523,7 @@ START_TEST (test_on_nak_pass_002)
 	struct pgm_sk_buff_t* skb = generate_nak_list ();
 	fail_if (NULL == skb, "generate_nak_list failed");
 	skb->sock = sock;
-	fail_unless (TRUE == pgm_on_nak (sock, skb), "on_nak failed");
+	fail_unless (TRUE == pgm_on_nak (sock, skb, (struct sockaddr*)&skb_addr), "on_nak failed");
 }
 END_TEST
 
@@ -895,7 +1536,7 @@ START_TEST (test_on_nak_pass_003)
 	struct pgm_sk_buff_t* skb = generate_parity_nak ();
 	fail_if (NULL == skb, "generate_parity_nak failed");
 	skb->sock = sock;
-	fail_unless (TRUE == pgm_on_nak (sock, skb), "on_nak failed");
+	fail_unless (TRUE == pgm_on_nak (sock, skb, (struct sockaddr*)&skb_addr), "on_nak failed");
 }
 END_TEST
 
@@ -908,7 +1549,46 @@ START_TEST (test_on_nak_pass_004)
 	struct pgm_sk_buff_t* skb = generate_parity_nak_list ();
 	fail_if (NULL == skb, "generate_parity_nak_list failed");
 	skb->sock = sock;
-	fail_unless (TRUE == pgm_on_nak (sock, skb), "on_nak failed");
+	fail_unless (TRUE == pgm_on_nak (sock, skb, (struct sockaddr*)&skb_addr), "on_nak failed");
+}
+END_TEST
+
+/* catch-up request without PGM_CATCHUP_RATE, neither confirmed nor repaired */
+START_TEST (test_on_nak_pass_005)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	struct pgm_sk_buff_t* skb = generate_catchup_nak ();
+	fail_if (NULL == skb, "generate_catchup_nak failed");
+	skb->sock = sock;
+	mock_sendto_count = mock_selective_push_count = 0;
+	fail_unless (TRUE == pgm_on_nak (sock, skb, (struct sockaddr*)&skb_addr), "on_nak failed");
+	fail_unless (0 == mock_sendto_count, "NCF sent");
+	fail_unless (0 == mock_selective_push_count, "repair queued");
+}
+END_TEST
+
+/* catch-up request opens a unicast stream */
+START_TEST (test_on_nak_pass_006)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->catchup = g_new0 (struct pgm_catchup_t, PGM_CATCHUP_MAX);
+	struct pgm_sk_buff_t* skb = generate_catchup_nak ();
+	fail_if (NULL == skb, "generate_catchup_nak failed");
+	skb->sock = sock;
+	mock_sendto_count = mock_selective_push_count = 0;
+	fail_unless (TRUE == pgm_on_nak (sock, skb, (struct sockaddr*)&skb_addr), "on_nak failed");
+	fail_unless (0 == mock_sendto_count, "NCF sent");
+	fail_unless (0 == mock_selective_push_count, "repair queued");
+	fail_unless (1 == sock->catchup_len, "stream not added");
+	fail_unless (1000 == sock->catchup[0].next, "first sequence");
+	fail_unless (1500 == sock->catchup[0].end, "last sequence");
+/* repeated request replaces the stream */
+	skb = generate_catchup_nak ();
+	skb->sock = sock;
+	fail_unless (TRUE == pgm_on_nak (sock, skb, (struct sockaddr*)&skb_addr), "on_nak failed");
+	fail_unless (1 == sock->catchup_len, "stream duplicated");
 }
 END_TEST
 
@@ -920,17 +1600,73 @@ START_TEST (test_on_nak_fail_001)
 	fail_if (NULL == skb, "generate_single_nak failed");
 	skb->sock = sock;
 	mock_is_valid_nak = FALSE;
-	fail_unless (FALSE == pgm_on_nak (sock, skb), "on_nak failed");
+	fail_unless (FALSE == pgm_on_nak (sock, skb, (struct sockaddr*)&skb_addr), "on_nak failed");
 }
 END_TEST
 
 START_TEST (test_on_nak_fail_002)
 {
-	pgm_on_nak (NULL, NULL);
+	pgm_on_nak (NULL, NULL, NULL);
 	fail ("reached");
 }
 END_TEST
 
+/* target:
+ *	void
+ *	pgm_on_nak_aggregate_expiry (
+ *		pgm_sock_t*	sock
+ *	)
+ */
+
+/* duplicate requests share one NCF list and one repair run */
+START_TEST (test_on_nak_aggregate_expiry_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->nak_aggregate_ivl = pgm_msecs (1);
+	sock->nak_pending = g_new0 (struct pgm_nak_req_t, PGM_NAK_AGGREGATE_MAX);
+	struct pgm_sk_buff_t* skbv[] = { generate_single_nak (), generate_single_nak (), generate_nak_list () };
+	mock_sendto_count = mock_selective_push_count = mock_parity_push_count = 0;
+	for (unsigned i = 0; i < G_N_ELEMENTS(skbv); i++) {
+		skbv[i]->sock = sock;
+		fail_unless (TRUE == pgm_on_nak (sock, skbv[i], (struct sockaddr*)&skb_addr), "on_nak failed");
+	}
+	fail_unless (0 == mock_sendto_count, "NCF not held");
+	fail_unless (0 == mock_selective_push_count, "repair not held");
+	fail_unless (1 + 1 + 62 == sock->nak_pending_len, "pending length");
+	sock->nak_aggregate_expiry = 1;
+	pgm_on_nak_aggregate_expiry (sock);
+	fail_unless (1 == mock_sendto_count, "one NCF list");
+	fail_unless (62 == mock_selective_push_count, "duplicate repairs");
+	fail_unless (0 == sock->nak_pending_len, "pending not flushed");
+	fail_unless (0 == sock->nak_aggregate_expiry, "expiry not reset");
+}
+END_TEST
+
+/* single losses of different receivers in one transmission group repaired by parity */
+START_TEST (test_on_nak_aggregate_expiry_pass_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->use_ondemand_parity = TRUE;
+	sock->tg_sqn_shift = 2;
+	sock->nak_aggregate_ivl = pgm_msecs (1);
+	sock->nak_pending = g_new0 (struct pgm_nak_req_t, PGM_NAK_AGGREGATE_MAX);
+	mock_sendto_count = mock_selective_push_count = mock_parity_push_count = 0;
+	for (unsigned i = 1; i < 3; i++) {
+		struct pgm_sk_buff_t* skb = generate_single_nak ();
+		((struct pgm_nak*)skb->data)->nak_sqn = g_htonl (i);
+		skb->sock = sock;
+		fail_unless (TRUE == pgm_on_nak (sock, skb, (struct sockaddr*)&skb_addr), "on_nak failed");
+	}
+	sock->nak_aggregate_expiry = 1;
+	pgm_on_nak_aggregate_expiry (sock);
+	fail_unless (1 == mock_sendto_count, "one parity NCF");
+	fail_unless (1 == mock_parity_push_count, "parity repair");
+	fail_unless (0 == mock_selective_push_count, "selective repair");
+}
+END_TEST
+
 /* target:
  *	gboolean
  *	pgm_on_nnak (
@@ -1158,8 +1894,27 @@ make_test_suite (void)
 	tcase_add_checked_fixture (tc_send, mock_setup, NULL);
 	tcase_add_test (tc_send, test_send_pass_001);
 	tcase_add_test (tc_send, test_send_pass_002);
+	tcase_add_test (tc_send, test_send_pass_003);
 	tcase_add_test (tc_send, test_send_fail_001);
 
+	TCase* tc_select_send = tcase_create ("select-send");
+	suite_add_tcase (s, tc_select_send);
+	tcase_add_checked_fixture (tc_select_send, mock_setup, NULL);
+	tcase_add_test (tc_select_send, test_select_send_pass_001);
+
+	TCase* tc_send_batch = tcase_create ("send-batch");
+	suite_add_tcase (s, tc_send_batch);
+	tcase_add_checked_fixture (tc_send_batch, mock_setup, NULL);
+	tcase_add_test (tc_send_batch, test_send_batch_pass_001);
+	tcase_add_test (tc_send_batch, test_send_batch_pass_002);
+	tcase_add_test (tc_send_batch, test_send_batch_fail_001);
+
+	TCase* tc_send_queue = tcase_create ("send-queue");
+	suite_add_tcase (s, tc_send_queue);
+	tcase_add_checked_fixture (tc_send_queue, mock_setup, NULL);
+	tcase_add_test (tc_send_queue, test_send_queue_pass_001);
+	tcase_add_test (tc_send_queue, test_send_queue_pass_002);
+
 	TCase* tc_sendv = tcase_create ("sendv");
 	suite_add_tcase (s, tc_sendv);
 	tcase_add_checked_fixture (tc_sendv, mock_setup, NULL);
@@ -1175,19 +1930,42 @@ make_test_suite (void)
 	tcase_add_test (tc_send_skbv, test_send_skbv_pass_001);
 	tcase_add_test (tc_send_skbv, test_send_skbv_pass_002);
 	tcase_add_test (tc_send_skbv, test_send_skbv_fail_001);
+	tcase_add_test (tc_send_skbv, test_send_skbv_csum_pass_001);
+	tcase_add_test (tc_send_skbv, test_send_skbv_csum_fail_001);
 
 	TCase* tc_send_spm = tcase_create ("send-spm");
 	suite_add_tcase (s, tc_send_spm);
 	tcase_add_checked_fixture (tc_send_spm, mock_setup, NULL);
 	tcase_add_test (tc_send_spm, test_send_spm_pass_001);
+
+	TCase* tc_fec_adapt = tcase_create ("fec-adapt");
+	suite_add_tcase (s, tc_fec_adapt);
+	tcase_add_checked_fixture (tc_fec_adapt, mock_setup, NULL);
+	tcase_add_test (tc_fec_adapt, test_fec_adapt_pass_001);
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_send_spm, test_send_spm_fail_001, SIGABRT);
 #endif
 
+	TCase* tc_on_standby = tcase_create ("on-standby");
+	suite_add_tcase (s, tc_on_standby);
+	tcase_add_checked_fixture (tc_on_standby, mock_setup, NULL);
+	tcase_add_test (tc_on_standby, test_on_standby_pass_001);
+	tcase_add_test (tc_on_standby, test_on_standby_pass_002);
+
+	TCase* tc_send_rdata = tcase_create ("send-rdata");
+	suite_add_tcase (s, tc_send_rdata);
+	tcase_add_checked_fixture (tc_send_rdata, mock_setup, NULL);
+	tcase_add_test (tc_send_rdata, test_send_rdata_pass_001);
+	tcase_add_test (tc_send_rdata, test_send_rdata_pass_002);
+#ifndef PGM_CHECK_NOFORK
+	tcase_add_test_raise_signal (tc_send_rdata, test_send_rdata_fail_001, SIGABRT);
+#endif
+
 	TCase* tc_on_deferred_nak = tcase_create ("on-deferred-nak");
 	suite_add_tcase (s, tc_on_deferred_nak);
 	tcase_add_checked_fixture (tc_on_deferred_nak, mock_setup, NULL);
 	tcase_add_test (tc_on_deferred_nak, test_on_deferred_nak_pass_001);
+	tcase_add_test (tc_on_deferred_nak, test_on_deferred_nak_pass_002);
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_on_deferred_nak, test_on_deferred_nak_fail_001, SIGABRT);
 #endif
@@ -1209,7 +1987,15 @@ make_test_suite (void)
 	tcase_add_test (tc_on_nak, test_on_nak_pass_002);
 	tcase_add_test (tc_on_nak, test_on_nak_pass_003);
 	tcase_add_test (tc_on_nak, test_on_nak_pass_004);
+	tcase_add_test (tc_on_nak, test_on_nak_pass_005);
+	tcase_add_test (tc_on_nak, test_on_nak_pass_006);
 	tcase_add_test (tc_on_nak, test_on_nak_fail_001);
+
+	TCase* tc_on_nak_aggregate_expiry = tcase_create ("on-nak-aggregate-expiry");
+	suite_add_tcase (s, tc_on_nak_aggregate_expiry);
+	tcase_add_checked_fixture (tc_on_nak_aggregate_expiry, mock_setup, NULL);
+	tcase_add_test (tc_on_nak_aggregate_expiry, test_on_nak_aggregate_expiry_pass_001);
+	tcase_add_test (tc_on_nak_aggregate_expiry, test_on_nak_aggregate_expiry_pass_002);
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_on_nak, test_on_nak_fail_002, SIGABRT);
 #endif
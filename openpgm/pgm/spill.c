@@ -0,0 +1,329 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * Spill log of unread APDUs: when a slow consumer lets the receive window
+ * fill, complete APDUs at the trailing edge are appended to a bounded ring in
+ * an unlinked, memory-mapped file instead of being lost, and replayed in order
+ * ahead of the window.  The window keeps advancing with the network.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <errno.h>
+#include <stdio.h>
+#ifndef _WIN32
+#	include <fcntl.h>
+#	include <unistd.h>
+#	include <sys/mman.h>
+#endif
+#include <impl/i18n.h>
+#include <impl/framework.h>
+
+
+//#define SPILL_DEBUG
+
+#ifndef SPILL_DEBUG
+#	define PGM_DISABLE_ASSERT
+#endif
+
+#define SPILL_ALIGN(x)		(((x) + 7) & ~(size_t)7)
+
+/* one record per message as delivered, each fragment of the message kept as a
+ * segment so the replayed vector matches the original.  records are 8 byte
+ * aligned, a tail too short for a header or a zero size wraps to the start.
+ */
+
+struct pgm_spill_record_t {
+	uint32_t		size;		/* bytes including header, 0 = wrap */
+	uint16_t		count;		/* segments */
+	uint16_t		__padding;
+	uint32_t		sequence;
+	uint32_t		__padding2;
+	pgm_time_t		tstamp;
+	pgm_time_t		wire_tstamp;
+	pgm_sock_t*		sock;
+	pgm_tsi_t		tsi;
+	uint16_t		len[];		/* segment lengths followed by data */
+};
+
+struct pgm_spill_t {
+	char*			base;
+	size_t			size;		/* bytes mapped */
+	uint64_t		head;		/* next read, both offsets only increase */
+	uint64_t		tail;		/* next append */
+};
+
+static inline
+size_t
+spill_record_size (
+	const struct pgm_msgv_t* const	msgv
+	)
+{
+	size_t len = sizeof(struct pgm_spill_record_t) + (msgv->msgv_len * sizeof(uint16_t));
+	for (unsigned i = 0; i < msgv->msgv_len; i++)
+		len += msgv->msgv_skb[i]->len;
+	return SPILL_ALIGN(len);
+}
+
+/* create a log of size bytes, rounded up to a page, in an unlinked file of
+ * directory dir, or P_tmpdir for NULL.  the disk blocks are reserved up front
+ * so writing through the mapping cannot fault on a full disk.
+ *
+ * on success returns the new log, on failure returns NULL setting error.
+ */
+
+PGM_GNUC_INTERNAL
+struct pgm_spill_t*
+pgm_spill_create (
+	const char* const	dir,
+	const uint64_t		size,
+	pgm_error_t**		error
+	)
+{
+#ifndef _WIN32
+	char path[1024], errbuf[1024];
+	const size_t page_len = (size_t)sysconf (_SC_PAGESIZE);
+	const size_t len = (size_t)((size + page_len - 1) & ~(uint64_t)(page_len - 1));
+	struct pgm_spill_t* spill;
+	void* base;
+	int fd, save_errno;
+
+/* pre-conditions */
+	pgm_assert_cmpuint (size, >, 0);
+
+	pgm_snprintf_s (path, sizeof (path), _TRUNCATE, "%s/pgm-spill-XXXXXX", dir ? dir : P_tmpdir);
+	fd = mkstemp (path);
+	if (-1 == fd) {
+		save_errno = errno;
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_RECV,
+			     pgm_error_from_errno (save_errno),
+			     _("Creating spill log %s: %s"),
+			     path,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		return NULL;
+	}
+	unlink (path);
+	save_errno = posix_fallocate (fd, 0, (off_t)len);
+/* file systems without allocation are left sparse */
+	if (EOPNOTSUPP == save_errno)
+		save_errno = (-1 == ftruncate (fd, (off_t)len)) ? errno : 0;
+	if (0 != save_errno) {
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_RECV,
+			     pgm_error_from_errno (save_errno),
+			     _("Reserving %" PRIzu " bytes of spill log %s: %s"),
+			     len, path,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		close (fd);
+		return NULL;
+	}
+	base = mmap (NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	save_errno = errno;
+	close (fd);
+	if (MAP_FAILED == base) {
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_RECV,
+			     pgm_error_from_errno (save_errno),
+			     _("Mapping spill log %s: %s"),
+			     path,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		return NULL;
+	}
+/* read and written front to back */
+	madvise (base, len, MADV_SEQUENTIAL);
+
+	spill = pgm_new0 (struct pgm_spill_t, 1);
+	spill->base = base;
+	spill->size = len;
+	pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Spill log of %" PRIzu " bytes at %s."), len, path);
+	return spill;
+#else
+	pgm_set_error (error,
+		     PGM_ERROR_DOMAIN_RECV,
+		     PGM_ERROR_NOSYS,
+		     _("Spill log not supported on this platform."));
+	return NULL;
+#endif /* _WIN32 */
+}
+
+PGM_GNUC_INTERNAL
+void
+pgm_spill_destroy (
+	struct pgm_spill_t* const	spill
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != spill);
+
+#ifndef _WIN32
+	munmap (spill->base, spill->size);
+#endif
+	pgm_free (spill);
+}
+
+PGM_GNUC_INTERNAL
+bool
+pgm_spill_is_empty (
+	const struct pgm_spill_t* const	spill
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != spill);
+
+	return spill->head == spill->tail;
+}
+
+/* record at the read offset, skipping the wrap.
+ */
+
+static inline
+const struct pgm_spill_record_t*
+spill_peek (
+	const struct pgm_spill_t* const	spill,
+	uint64_t* const			head
+	)
+{
+	size_t offset = (size_t)(*head % spill->size);
+	if (spill->size - offset < sizeof(struct pgm_spill_record_t) ||
+	    0 == ((const struct pgm_spill_record_t*)(spill->base + offset))->size)
+	{
+		*head += spill->size - offset;
+		offset = 0;
+	}
+	return (const struct pgm_spill_record_t*)(spill->base + offset);
+}
+
+PGM_GNUC_INTERNAL
+pgm_time_t
+pgm_spill_next_tstamp (
+	const struct pgm_spill_t* const	spill
+	)
+{
+	uint64_t head;
+
+/* pre-conditions */
+	pgm_assert (NULL != spill);
+
+	if (pgm_spill_is_empty (spill))
+		return 0;
+	head = spill->head;
+	return spill_peek (spill, &head)->tstamp;
+}
+
+/* append the message of msgv, its skbuffs are not referenced.
+ *
+ * returns TRUE on success, FALSE if the log is full.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_spill_append (
+	struct pgm_spill_t*	  const restrict spill,
+	const struct pgm_msgv_t* const restrict msgv
+	)
+{
+	const size_t len = spill_record_size (msgv);
+	size_t offset, wrap = 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != spill);
+	pgm_assert (NULL != msgv);
+	pgm_assert_cmpuint (msgv->msgv_len, >, 0);
+
+/* restart an empty log at the front to keep records contiguous */
+	if (pgm_spill_is_empty (spill))
+		spill->head = spill->tail = 0;
+	offset = (size_t)(spill->tail % spill->size);
+	if (spill->size - offset < len)
+		wrap = spill->size - offset;
+	if (wrap + len > spill->size - (size_t)(spill->tail - spill->head))
+		return FALSE;
+	if (wrap) {
+		if (wrap >= sizeof(struct pgm_spill_record_t))
+			((struct pgm_spill_record_t*)(spill->base + offset))->size = 0;
+		spill->tail += wrap;
+		offset = 0;
+	}
+
+	struct pgm_spill_record_t* record = (struct pgm_spill_record_t*)(spill->base + offset);
+	const struct pgm_sk_buff_t* first = msgv->msgv_skb[0];
+	char* data = (char*)&record->len[ msgv->msgv_len ];
+	record->size		= (uint32_t)len;
+	record->count		= (uint16_t)msgv->msgv_len;
+	record->sequence	= first->sequence;
+	record->tstamp		= first->tstamp;
+	record->wire_tstamp	= first->wire_tstamp;
+	record->sock		= first->sock;
+	record->tsi		= first->tsi;
+	for (unsigned i = 0; i < msgv->msgv_len; i++) {
+		const struct pgm_sk_buff_t* skb = msgv->msgv_skb[i];
+		record->len[i] = skb->len;
+		memcpy (data, skb->data, skb->len);
+		data += skb->len;
+	}
+	spill->tail += len;
+	return TRUE;
+}
+
+/* replace msgv with the oldest message of the log, one new skbuff per segment
+ * owned by the caller.
+ *
+ * returns count of bytes read, or -1 if the log is empty.
+ */
+
+PGM_GNUC_INTERNAL
+ssize_t
+pgm_spill_read (
+	struct pgm_spill_t* const restrict spill,
+	struct pgm_msgv_t*  const restrict msgv
+	)
+{
+	const struct pgm_spill_record_t* record;
+	const char* data;
+	ssize_t bytes_read = 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != spill);
+	pgm_assert (NULL != msgv);
+
+	if (pgm_spill_is_empty (spill))
+		return -1;
+
+	record = spill_peek (spill, &spill->head);
+	data = (const char*)&record->len[ record->count ];
+	for (unsigned i = 0; i < record->count; i++) {
+		struct pgm_sk_buff_t* skb = pgm_alloc_skb (record->len[i]);
+		skb->sock		= record->sock;
+		skb->tstamp		= record->tstamp;
+		skb->wire_tstamp	= record->wire_tstamp;
+		skb->tsi		= record->tsi;
+		skb->sequence		= record->sequence;
+		pgm_skb_put (skb, record->len[i]);
+		memcpy (skb->data, data, record->len[i]);
+		data += record->len[i];
+		msgv->msgv_skb[i] = skb;
+		bytes_read += record->len[i];
+	}
+	msgv->msgv_len = record->count;
+	spill->head += record->size;
+	return bytes_read;
+}
+
+/* eof */
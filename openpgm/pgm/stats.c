@@ -0,0 +1,126 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * statistics counter blocks summed on read.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <string.h>
+#include <impl/framework.h>
+#include <impl/receiver.h>
+#include <impl/source.h>
+
+
+//#define STATS_DEBUG
+
+PGM_STATIC_ASSERT(PGM_PC_SOURCE_MAX <= PGM_STATS_COUNTERS);
+PGM_STATIC_ASSERT(PGM_PC_RECEIVER_MAX <= PGM_STATS_COUNTERS);
+PGM_STATIC_ASSERT(0 == sizeof(pgm_stats_t) % PGM_CACHELINE_SIZE);
+
+
+/* copy one block consistent against its writer.
+ */
+
+static inline
+void
+stats_copy (
+	const pgm_stats_t* restrict	stats,
+	uint64_t*	   restrict	counters
+	)
+{
+#if PGM_STATS_USE_SEQUENCE
+	uint32_t sequence;
+	do {
+		while ((sequence = stats->sequence) & 1)
+			;
+		pgm_stats_barrier();
+		for (unsigned i = 0; i < PGM_STATS_COUNTERS; i++)
+			counters[ i ] = stats->counters[ i ];
+		pgm_stats_barrier();
+	} while (sequence != stats->sequence);
+#else
+	for (unsigned i = 0; i < PGM_STATS_COUNTERS; i++)
+		counters[ i ] = stats->counters[ i ];
+#endif
+}
+
+/* sum one counter across len blocks.
+ */
+
+PGM_GNUC_INTERNAL
+uint64_t
+pgm_stats_read (
+	const pgm_stats_t*	stats,
+	const unsigned		len,
+	const unsigned		counter
+	)
+{
+	uint64_t value = 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != stats);
+	pgm_assert (counter < PGM_STATS_COUNTERS);
+
+	for (unsigned i = 0; i < len; i++)
+	{
+#if PGM_STATS_USE_SEQUENCE
+		uint32_t sequence;
+		uint64_t block_value;
+		do {
+			while ((sequence = stats[ i ].sequence) & 1)
+				;
+			pgm_stats_barrier();
+			block_value = stats[ i ].counters[ counter ];
+			pgm_stats_barrier();
+		} while (sequence != stats[ i ].sequence);
+		value += block_value;
+#else
+		value += stats[ i ].counters[ counter ];
+#endif
+	}
+	return value;
+}
+
+/* sum every counter across len blocks into PGM_STATS_COUNTERS values.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_stats_snapshot (
+	const pgm_stats_t* restrict	stats,
+	const unsigned			len,
+	uint64_t*	   restrict	counters
+	)
+{
+	uint64_t block[ PGM_STATS_COUNTERS ];
+
+/* pre-conditions */
+	pgm_assert (NULL != stats);
+	pgm_assert (NULL != counters);
+
+	memset (counters, 0, PGM_STATS_COUNTERS * sizeof(uint64_t));
+	for (unsigned i = 0; i < len; i++) {
+		stats_copy (&stats[ i ], block);
+		for (unsigned j = 0; j < PGM_STATS_COUNTERS; j++)
+			counters[ j ] += block[ j ];
+	}
+}
+
+/* eof */
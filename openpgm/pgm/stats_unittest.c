@@ -0,0 +1,147 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * unit tests for statistics counter blocks.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <check.h>
+
+#ifdef _WIN32
+#	define PGM_CHECK_NOFORK		1
+#endif
+
+
+/* mock state */
+
+
+/* mock functions for external references */
+
+
+#define STATS_DEBUG
+#include "stats.c"
+
+
+/* target:
+ *	uint64_t
+ *	pgm_stats_read (
+ *		const pgm_stats_t*	stats,
+ *		const unsigned		len,
+ *		const unsigned		counter
+ *	)
+ */
+
+START_TEST (test_read_pass_001)
+{
+	pgm_stats_t stats[PGM_STATS_BLOCKS];
+	memset (stats, 0, sizeof(stats));
+	pgm_stats_inc (&stats[PGM_STATS_TX], PGM_PC_SOURCE_DATA_MSGS_SENT);
+	pgm_stats_add (&stats[PGM_STATS_TX], PGM_PC_SOURCE_BYTES_SENT, 1500);
+	pgm_stats_add (&stats[PGM_STATS_RX], PGM_PC_SOURCE_BYTES_SENT, 100);
+	fail_unless (1 == pgm_stats_read (stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_DATA_MSGS_SENT), "count mismatch");
+	fail_unless (1600 == pgm_stats_read (stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_BYTES_SENT), "sum mismatch");
+	fail_unless (1500 == pgm_stats_read (stats, 1, PGM_PC_SOURCE_BYTES_SENT), "block mismatch");
+	fail_unless (0 == pgm_stats_read (stats, PGM_STATS_BLOCKS, PGM_PC_SOURCE_CKSUM_ERRORS), "untouched counter");
+	fail_unless (0 == (stats[PGM_STATS_TX].sequence & 1), "sequence odd");
+}
+END_TEST
+
+/* counters are 64-bit */
+START_TEST (test_read_pass_002)
+{
+	pgm_stats_t stats;
+	memset (&stats, 0, sizeof(stats));
+	pgm_stats_add (&stats, PGM_PC_RECEIVER_BYTES_RECEIVED, UINT32_MAX);
+	pgm_stats_add (&stats, PGM_PC_RECEIVER_BYTES_RECEIVED, UINT32_MAX);
+	fail_unless (UINT64_C(2) * UINT32_MAX == pgm_stats_read (&stats, 1, PGM_PC_RECEIVER_BYTES_RECEIVED), "counter wrapped");
+}
+END_TEST
+
+/* target:
+ *	void
+ *	pgm_stats_snapshot (
+ *		const pgm_stats_t*	stats,
+ *		const unsigned		len,
+ *		uint64_t*		counters
+ *	)
+ */
+
+START_TEST (test_snapshot_pass_001)
+{
+	pgm_stats_t stats[PGM_STATS_BLOCKS];
+	uint64_t counters[PGM_STATS_COUNTERS];
+	memset (stats, 0, sizeof(stats));
+	memset (counters, 0xff, sizeof(counters));
+	for (unsigned i = 0; i < PGM_STATS_COUNTERS; i++) {
+		pgm_stats_add (&stats[PGM_STATS_TX], i, i);
+		pgm_stats_add (&stats[PGM_STATS_RX], i, 1000);
+	}
+	pgm_stats_snapshot (stats, PGM_STATS_BLOCKS, counters);
+	for (unsigned i = 0; i < PGM_STATS_COUNTERS; i++)
+		fail_unless (1000 + i == counters[i], "sum mismatch");
+	pgm_stats_snapshot (stats, 0, counters);
+	for (unsigned i = 0; i < PGM_STATS_COUNTERS; i++)
+		fail_unless (0 == counters[i], "counters not cleared");
+}
+END_TEST
+
+
+static
+Suite*
+make_test_suite (void)
+{
+	Suite* s;
+
+	s = suite_create (__FILE__);
+
+	TCase* tc_read = tcase_create ("read");
+	suite_add_tcase (s, tc_read);
+	tcase_add_test (tc_read, test_read_pass_001);
+	tcase_add_test (tc_read, test_read_pass_002);
+
+	TCase* tc_snapshot = tcase_create ("snapshot");
+	suite_add_tcase (s, tc_snapshot);
+	tcase_add_test (tc_snapshot, test_snapshot_pass_001);
+	return s;
+}
+
+static
+Suite*
+make_master_suite (void)
+{
+	Suite* s = suite_create ("Master");
+	return s;
+}
+
+int
+main (void)
+{
+	SRunner* sr = srunner_create (make_master_suite ());
+	srunner_add_suite (sr, make_test_suite ());
+	srunner_run_all (sr, CK_ENV);
+	int number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof */
@@ -451,7 +451,7 @@ on_io_data (
                 goto out;
 
 /* search for TSI peer context or create a new one */
-        pgm_peer_t* sender = pgm_hashtable_lookup (sock->peers_hashtable, &skb->tsi);
+        pgm_peer_t* sender = pgm_peertable_lookup (sock->peers_hashtable, &skb->tsi);
         if (sender == NULL)
         {
 		printf ("new peer, tsi %s, local nla %s\n",
@@ -463,7 +463,7 @@ on_io_data (
 		((struct sockaddr_in*)&peer->nla)->sin_addr.s_addr = INADDR_ANY;
 		memcpy (&peer->local_nla, &src_addr, src_addr_len);
 
-		pgm_hashtable_insert (sock->peers_hashtable, &peer->tsi, peer);
+		pgm_peertable_insert (sock->peers_hashtable, &peer->tsi, peer);
 		sender = peer;
         }
 
@@ -555,7 +555,7 @@ fake_pgm_bind3 (
 
 /* create peer list */
         if (sock->can_recv_data) {
-                sock->peers_hashtable = pgm_hashtable_new (pgm_tsi_hash, pgm_tsi_equal);
+                sock->peers_hashtable = pgm_peertable_new ();
                 pgm_assert (NULL != sock->peers_hashtable);
         }
 
@@ -830,7 +830,7 @@ fake_pgm_close (
                 sock->send_sock = INVALID_SOCKET;
         }
 	if (sock->peers_hashtable) {
-		pgm_hashtable_destroy (sock->peers_hashtable);
+		pgm_peertable_destroy (sock->peers_hashtable);
                 sock->peers_hashtable = NULL;
         }
         if (sock->peers_list) {
@@ -841,6 +841,12 @@ fake_pgm_close (
                         sock->peers_list = next;
                 } while (sock->peers_list);
         }
+	pgm_peers_reclaim_all (sock);
+        if (sock->peers_heap) {
+                pgm_free (sock->peers_heap);
+                sock->peers_heap = NULL;
+                sock->peers_heap_len = sock->peers_heap_alloc = 0;
+        }
 	if (INVALID_SOCKET != sock->send_with_router_alert_sock) {
                 puts ("Closing send with router alert socket.");
                 closesocket (sock->send_with_router_alert_sock);
@@ -1253,9 +1259,7 @@ brokn_send_apdu_unlocked (
                 skb->pgm_header->pgm_checksum    = pgm_csum_fold (pgm_csum_block_add (unfolded_header, unfolded_odata, pgm_header_len));
 
 /* add to transmit window */
-		pgm_spinlock_lock (&sock->txw_spinlock);
                 pgm_txw_add (sock->window, skb);
-		pgm_spinlock_unlock (&sock->txw_spinlock);
 
 /* do not send send packet */
 		if (packets != 1)
@@ -1689,7 +1693,7 @@ net_send_spmr (
 	pgm_sock_t* sock = sess->sock;
 
 /* check that the peer exists */
-	pgm_peer_t* peer = pgm_hashtable_lookup (sock->peers_hashtable, tsi);
+	pgm_peer_t* peer = pgm_peertable_lookup (sock->peers_hashtable, tsi);
 	struct sockaddr_storage peer_nla;
 	pgm_gsi_t* peer_gsi;
 	guint16 peer_sport;
@@ -1777,7 +1781,7 @@ net_send_ncf (
 
 /* check that the peer exists */
 	pgm_sock_t* sock = sess->sock;
-	pgm_peer_t* peer = pgm_hashtable_lookup (sock->peers_hashtable, tsi);
+	pgm_peer_t* peer = pgm_peertable_lookup (sock->peers_hashtable, tsi);
 	if (peer == NULL) {
 		printf ("FAILED: peer \"%s\" not found\n", pgm_tsi_print (tsi));
 		return;
@@ -1876,7 +1880,7 @@ net_send_nak (
 
 /* check that the peer exists */
 	pgm_sock_t* sock = sess->sock;
-	pgm_peer_t* peer = pgm_hashtable_lookup (sock->peers_hashtable, tsi);
+	pgm_peer_t* peer = pgm_peertable_lookup (sock->peers_hashtable, tsi);
 	if (peer == NULL) {
 		printf ("FAILED: peer \"%s\" not found\n", pgm_tsi_print(tsi));
 		return;
@@ -190,7 +190,9 @@ pgm_spinlock_init (
 {
 	pgm_assert (NULL != spinlock);
 
-#ifdef USE_TICKET_SPINLOCK
+#if defined( USE_MCS_SPINLOCK )
+	pgm_mcs_init (&spinlock->mcs_lock);
+#elif defined( USE_TICKET_SPINLOCK )
 	pgm_ticket_init (&spinlock->ticket_lock);
 #elif defined( HAVE_PTHREAD_SPINLOCK )
 	posix_check_cmd (pthread_spin_init (&spinlock->pthread_spinlock, PTHREAD_PROCESS_PRIVATE));
@@ -209,7 +211,9 @@ pgm_spinlock_free (
 {
 	pgm_assert (NULL != spinlock);
 
-#ifdef USE_TICKET_SPINLOCK
+#if defined( USE_MCS_SPINLOCK )
+	pgm_mcs_free (&spinlock->mcs_lock);
+#elif defined( USE_TICKET_SPINLOCK )
 	pgm_ticket_free (&spinlock->ticket_lock);
 #elif defined( HAVE_PTHREAD_SPINLOCK )
 /* ignore return value */
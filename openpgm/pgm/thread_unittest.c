@@ -29,6 +29,15 @@
 
 /* mock state */
 
+#define CONTENTION_THREADS	4
+#define CONTENTION_ITERATIONS	100000
+
+struct contention_t {
+	pgm_spinlock_t		spinlock;
+	pgm_rwlock_t		rwlock;
+	volatile uint32_t	counter;
+};
+
 
 /* mock functions for external references */
 
@@ -427,6 +436,101 @@ START_TEST (test_rwlock_writer_trylock_pass_001)
 }
 END_TEST
 
+/* contention microbenchmark, every thread increments the counter under the
+ * lock.  build with USE_MCS_SPINLOCK to compare queued against ticket locks.
+ */
+
+static
+gpointer
+spinlock_contention_thread (
+	gpointer	data
+	)
+{
+	struct contention_t* contention = data;
+	for (unsigned i = 0; i < CONTENTION_ITERATIONS; i++) {
+		pgm_spinlock_lock (&contention->spinlock);
+		contention->counter++;
+		pgm_spinlock_unlock (&contention->spinlock);
+	}
+	return NULL;
+}
+
+/* one write in eight, readers check the counter is stable under the lock */
+static
+gpointer
+rwlock_contention_thread (
+	gpointer	data
+	)
+{
+	struct contention_t* contention = data;
+	unsigned torn = 0;
+	for (unsigned i = 0; i < CONTENTION_ITERATIONS; i++) {
+		if (0 == (i % 8)) {
+			pgm_rwlock_writer_lock (&contention->rwlock);
+			contention->counter++;
+			pgm_rwlock_writer_unlock (&contention->rwlock);
+		} else {
+			pgm_rwlock_reader_lock (&contention->rwlock);
+			const uint32_t counter = contention->counter;
+			if (counter != contention->counter)
+				torn++;
+			pgm_rwlock_reader_unlock (&contention->rwlock);
+		}
+	}
+	return GUINT_TO_POINTER(torn);
+}
+
+static
+double
+run_contention (
+	GThreadFunc		func,
+	struct contention_t*	contention,
+	unsigned*		torn
+	)
+{
+	GThread* threads[CONTENTION_THREADS];
+	*torn = 0;
+	GTimer* timer = g_timer_new ();
+	for (unsigned i = 0; i < CONTENTION_THREADS; i++)
+		threads[i] = g_thread_create (func, contention, TRUE, NULL);
+	for (unsigned i = 0; i < CONTENTION_THREADS; i++)
+		*torn += GPOINTER_TO_UINT(g_thread_join (threads[i]));
+	const double elapsed = g_timer_elapsed (timer, NULL);
+	g_timer_destroy (timer);
+	return elapsed;
+}
+
+START_TEST (test_spinlock_contention_pass_001)
+{
+	struct contention_t contention;
+	unsigned torn;
+	if (!g_thread_supported ()) g_thread_init (NULL);
+	pgm_spinlock_init (&contention.spinlock);
+	contention.counter = 0;
+	const double elapsed = run_contention (spinlock_contention_thread, &contention, &torn);
+	fail_unless (CONTENTION_THREADS * CONTENTION_ITERATIONS == contention.counter, "lost update");
+	g_message ("spinlock: %u threads, %.1f ns per lock",
+		   CONTENTION_THREADS, (elapsed * 1e9) / (CONTENTION_THREADS * CONTENTION_ITERATIONS));
+	pgm_spinlock_free (&contention.spinlock);
+}
+END_TEST
+
+START_TEST (test_rwlock_contention_pass_001)
+{
+	struct contention_t contention;
+	unsigned torn;
+	if (!g_thread_supported ()) g_thread_init (NULL);
+	pgm_rwlock_init (&contention.rwlock);
+	contention.counter = 0;
+	const double elapsed = run_contention (rwlock_contention_thread, &contention, &torn);
+	fail_unless (CONTENTION_THREADS * (CONTENTION_ITERATIONS / 8) == contention.counter, "lost update");
+	fail_unless (0 == torn, "write under read lock");
+	g_message ("rwlock: %u threads, %.1f ns per lock",
+		   CONTENTION_THREADS, (elapsed * 1e9) / (CONTENTION_THREADS * CONTENTION_ITERATIONS));
+	pgm_rwlock_free (&contention.rwlock);
+}
+END_TEST
+
 static
 Suite*
 make_test_suite (void)
@@ -515,6 +619,12 @@ make_spinlock_suite (void)
 	suite_add_tcase (s, tc_trylock);
 	tcase_add_test (tc_trylock, test_spinlock_trylock_pass_001);
 
+	TCase* tc_contention = tcase_create ("contention");
+	tcase_add_checked_fixture (tc_contention, mock_setup, mock_teardown);
+	suite_add_tcase (s, tc_contention);
+	tcase_add_test (tc_contention, test_spinlock_contention_pass_001);
+	tcase_set_timeout (tc_contention, 60);
+
 	return s;
 }
 
@@ -566,6 +676,12 @@ make_rwlock_suite (void)
 	suite_add_tcase (s, tc_writer_trylock);
 	tcase_add_test (tc_writer_trylock, test_rwlock_writer_trylock_pass_001);
 
+	TCase* tc_contention = tcase_create ("contention");
+	tcase_add_checked_fixture (tc_contention, mock_setup, mock_teardown);
+	suite_add_tcase (s, tc_contention);
+	tcase_add_test (tc_contention, test_rwlock_contention_pass_001);
+	tcase_set_timeout (tc_contention, 60);
+
 	return s;
 }
 
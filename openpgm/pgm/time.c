@@ -175,6 +175,7 @@ static pgm_time_t		pgm_rtc_update (void);
 static uint_fast32_t		tsc_khz PGM_GNUC_READ_MOSTLY = 0;
 static uint_fast32_t		tsc_ns_mul PGM_GNUC_READ_MOSTLY = 0;
 static uint_fast32_t		tsc_us_mul PGM_GNUC_READ_MOSTLY = 0;
+static bool			tsc_use_rdtscp PGM_GNUC_READ_MOSTLY = FALSE;
 
 static inline
 void
@@ -223,7 +224,7 @@ us_to_tsc (
 }
 
 #	ifndef _WIN32
-static bool			pgm_tsc_init (pgm_error_t**);
+static bool			pgm_tsc_init (const pgm_cpu_t*const, pgm_error_t**);
 #	endif
 static pgm_time_t		pgm_tsc_update (void);
 #endif
@@ -372,24 +373,15 @@ pgm_time_init (
 	{
 		char	*rdtsc_frequency;
 
-#ifdef HAVE_PROC_CPUINFO
-/* attempt to parse clock ticks from kernel
+/* RDTSCP waits for all preceding instructions to execute before reading the counter */
+		pgm_cpu_t	cpu;
+		pgm_cpuid (&cpu);
+		tsc_use_rdtscp = cpu.has_rdtscp;
+
+/* nb: the cpu MHz of /proc/cpuinfo is the current core frequency, not the TSC rate,
+ * the kernel TSC is instead calibrated against the monotonic clock.
  */
-		FILE	*fp = fopen ("/proc/cpuinfo", "r");
-		if (fp)
-		{
-			char buffer[1024];
-			while (!feof(fp) && fgets (buffer, sizeof(buffer), fp))
-			{
-				if (strstr (buffer, "cpu MHz")) {
-					const char *p = strchr (buffer, ':');
-					if (p) tsc_khz = atoi (p + 1) * 1000;
-					break;
-				}
-			}
-			fclose (fp);
-		}
-#elif defined(_WIN32)
+#if defined(_WIN32)
 /* core frequency HKLM/Hardware/Description/System/CentralProcessor/0/~Mhz
  */
 		HKEY hKey;
@@ -471,8 +463,25 @@ pgm_time_init (
 			tsc_khz = (uint_fast32_t)(kdata->value.i32 * 1000);
 			kstat_close (kc);
 		}
+#elif defined(__linux__)
+/* TSC rate as calibrated by the kernel, exported on some kernels and hypervisor guests */
+		FILE* fp = fopen ("/sys/devices/system/cpu/cpu0/tsc_freq_khz", "r");
+		if (fp) {
+			unsigned long khz;
+			if (1 == fscanf (fp, "%lu", &khz) && khz > 0) {
+				tsc_khz = (uint_fast32_t)khz;
+				pgm_minor (_("Kernel reports TSC frequency %lu KHz"), khz);
+			}
+			fclose (fp);
+		}
 #endif /* !_WIN32 */
 
+/* nominal rate from the processor skips the calibration benchmark */
+		if (0 == tsc_khz && cpu.tsc_khz > 0) {
+			tsc_khz = cpu.tsc_khz;
+			pgm_minor (_("Processor reports TSC frequency %u KHz"), (unsigned)cpu.tsc_khz);
+		}
+
 /* e.g. export RDTSC_FREQUENCY=3200.000000
  *
  * Value can be used to override kernel tick rate as well as internal calibration
@@ -484,17 +493,17 @@ pgm_time_init (
 		}
 
 #ifndef _WIN32
-/* calibrate */
-		if (0 >= tsc_khz) {
-			pgm_error_t* sub_error = NULL;
-			if (!pgm_tsc_init (&sub_error)) {
-				pgm_propagate_error (error, sub_error);
-				goto err_cleanup;
-			}
+/* verify and calibrate */
+		pgm_error_t* sub_error = NULL;
+		if (!pgm_tsc_init (&cpu, &sub_error)) {
+			pgm_propagate_error (error, sub_error);
+			goto err_cleanup;
 		}
 #endif
-		pgm_minor (_("TSC frequency set at %u KHz"), (unsigned)(tsc_khz));
-		set_tsc_mul (tsc_khz);
+		if (pgm_time_update_now == pgm_tsc_update) {
+			pgm_minor (_("TSC frequency set at %u KHz%s"), (unsigned)(tsc_khz), tsc_use_rdtscp ? " using RDTSCP" : "");
+			set_tsc_mul (tsc_khz);
+		}
 	}
 #endif /* HAVE_RDTSC */
 
@@ -799,9 +808,46 @@ pgm_rdtsc (void)
 #	endif
 }
 
+/* read TSC after all preceding instructions have executed, RDTSCP is not
+ * re-ordered before an earlier load like RDTSC.
+ */
+
+static inline
+pgm_time_t
+pgm_rdtscp (void)
+{
+#	ifndef _MSC_VER
+
+	uint32_t lo, hi, aux;
+
+	__asm volatile ("rdtscp" : "=a" (lo), "=d" (hi), "=c" (aux));
+	return (pgm_time_t)hi << 32 | lo;
+
+#	else
+
+	unsigned aux;
+	return (pgm_time_t)__rdtscp (&aux);
+
+#	endif
+}
+
 #	ifndef _WIN32
-/* determine ratio of ticks to nano-seconds, use /dev/rtc for high accuracy
- * millisecond timer and convert.
+/* fall back to a stable system clock
+ */
+
+static
+void
+pgm_tsc_fallback (void)
+{
+/* force both to stable clocks even though one might be OK */
+	pgm_time_update_now	= pgm_gettimeofday_update;
+	pgm_time_since_epoch	= pgm_time_conv;
+}
+
+/* verify the TSC is invariant, i.e. ticks at a constant rate across P-state
+ * changes and does not stop in deep C-states, then unless already provided
+ * determine the ratio of ticks to micro-seconds against the monotonic clock,
+ * or a nanosleep() benchmark without clock_gettime().
  *
  * WARNING: time is relative to start of timer.
  */
@@ -809,24 +855,26 @@ pgm_rdtsc (void)
 static
 bool
 pgm_tsc_init (
+	const pgm_cpu_t*const		cpu,
 	PGM_GNUC_UNUSED pgm_error_t**	error
 	)
 {
+	if (!cpu->has_invariant_tsc) {
+		pgm_warn (_("Processor reports no invariant Time Stamp Counter (TSC)."));
+		pgm_tsc_fallback();
+		return TRUE;
+	}
+
 #		ifdef HAVE_PROC_CPUINFO
-/* Test for constant TSC from kernel
+/* Test for constant TSC from kernel, cpuid may be virtualized
  */
 	FILE	*fp = fopen ("/proc/cpuinfo", "r");
-	char	buffer[1024], *flags = NULL;
-	int	tmp_tsc_mhz = 0;
-	bool	ret = FALSE;
+	char	buffer[4096], *flags = NULL;
 	if (fp)
 	{
 		while (!feof(fp) && fgets (buffer, sizeof(buffer), fp))
 		{
-			if (strstr (buffer, "cpu MHz")) {
-				const char *p = strchr (buffer, ':');
-				if (p) tmp_tsc_mhz = atoi (p + 1) * 1000;
-			} else if (strstr (buffer, "flags")) {
+			if (strstr (buffer, "flags")) {
 				flags = strchr (buffer, ':');
 				break;
 			}
@@ -835,23 +883,37 @@ pgm_tsc_init (
 	}
 	if (!flags || !strstr (flags, " tsc")) {
 		pgm_warn (_("Linux kernel reports no Time Stamp Counter (TSC)."));
-/* force both to stable clocks even though one might be OK */
-		pgm_time_update_now	= pgm_gettimeofday_update;
-		ret = TRUE;
-	} else if (!strstr (flags, " constant_tsc")) {
+		pgm_tsc_fallback();
+		return TRUE;
+	} else if (!strstr (flags, " constant_tsc") || !strstr (flags, " nonstop_tsc")) {
 		pgm_warn (_("Linux kernel reports non-constant Time Stamp Counter (TSC)."));
-/* force both to stable clocks even though one might be OK */
-		pgm_time_update_now	= pgm_gettimeofday_update;
-		ret = TRUE;
+		pgm_tsc_fallback();
+		return TRUE;
 	}
+#		endif /* HAVE_PROC_CPUINFO */
 
-/* Only return in case the kernel doesn't report 0 as cpu MHz */
-	if ((tmp_tsc_mhz != 0) && ret)
+/* frequency from system or environment */
+	if (tsc_khz > 0)
 		return TRUE;
 
-#		endif /* HAVE_PROC_CPUINFO */
-
 	pgm_time_t		start, stop, elapsed;
+#		ifdef HAVE_CLOCK_GETTIME
+/* a short interval suffices as the elapsed time is measured not assumed */
+	const pgm_time_t	calibration_nsec = msecs_to_nsecs (100);
+	struct timespec		req = {
+					.tv_sec  = 0,
+					.tv_nsec = (long)calibration_nsec
+				}, ts_start, ts_stop;
+
+	pgm_info (_("Measuring the TSC against the monotonic clock..."));
+
+	clock_gettime (CLOCK_MONOTONIC, &ts_start);
+	start = pgm_rdtsc();
+	while (-1 == nanosleep (&req, &req) && EINTR == errno);
+	stop = pgm_rdtsc();
+	clock_gettime (CLOCK_MONOTONIC, &ts_stop);
+	const pgm_time_t elapsed_nsec = secs_to_nsecs (ts_stop.tv_sec - ts_start.tv_sec) + ts_stop.tv_nsec - ts_start.tv_nsec;
+#		else
 	const pgm_time_t	calibration_usec = secs_to_usecs (4);
 	struct timespec		req = {
 					.tv_sec  = 4,
@@ -863,6 +925,7 @@ pgm_tsc_init (
 	start = pgm_rdtsc();
 	while (-1 == nanosleep (&req, &req) && EINTR == errno);
 	stop = pgm_rdtsc();
+#		endif
 
 	if (stop < start)
 	{
@@ -870,13 +933,15 @@ pgm_tsc_init (
 			   "non-monotonic time response rendering the TSC unsuitable for high resolution "
 			   "timing.  To prevent the start delay from this benchmark and use a stable clock "
 			   "source set the environment variable PGM_TIMER to GTOD."));
-/* force both to stable clocks even though one might be OK */
-		pgm_time_update_now = pgm_gettimeofday_update;
+		pgm_tsc_fallback();
 		return TRUE;
 	}
 
-/* TODO: this math needs to be scaled to reduce rounding errors */
 	elapsed = stop - start;
+#		ifdef HAVE_CLOCK_GETTIME
+	tsc_khz = (uint_fast32_t)((elapsed * 1000000) / elapsed_nsec);
+#		else
+/* TODO: this math needs to be scaled to reduce rounding errors */
 	if (elapsed > calibration_usec) {
 /* cpu > 1 Ghz */
 		tsc_khz = (elapsed * 1000) / calibration_usec;
@@ -884,12 +949,13 @@ pgm_tsc_init (
 /* cpu < 1 Ghz */
 		tsc_khz = -( (calibration_usec * 1000) / elapsed );
 	}
+#		endif
 
 	pgm_info (_("Finished RDTSC test. To prevent the startup delay from this benchmark, "
 		   "set the environment variable RDTSC_FREQUENCY to %" PRIuFAST32 " on this "
 		   "system. This value is dependent upon the CPU clock speed and "
 		   "architecture and should be determined separately for each server."),
-		   tsc_khz);
+		   tsc_khz / 1000);
 	return TRUE;
 }
 #	endif
@@ -904,7 +970,7 @@ pgm_time_t
 pgm_tsc_update (void)
 {
 	static pgm_time_t	last = 0;
-	const pgm_time_t	now = tsc_to_us (pgm_rdtsc());
+	const pgm_time_t	now = tsc_to_us (tsc_use_rdtscp ? pgm_rdtscp() : pgm_rdtsc());
 
 	if (PGM_UNLIKELY(now < last))
 		return last;
@@ -22,11 +22,21 @@
 #ifdef HAVE_CONFIG_H
 #	include <config.h>
 #endif
+#include <errno.h>
+#ifdef HAVE_SYS_TIMERFD_H
+#	include <sys/timerfd.h>
+#endif
+#ifdef HAVE_KQUEUE
+#	include <sys/types.h>
+#	include <sys/event.h>
+#	include <sys/time.h>
+#endif
 #include <impl/i18n.h>
 #include <impl/framework.h>
 #include <impl/timer.h>
 #include <impl/receiver.h>
 #include <impl/source.h>
+#include <impl/net.h>
 
 
 //#define TIMER_DEBUG
@@ -53,8 +63,12 @@ pgm_timer_prepare (
 
 	now = pgm_time_update_now();
 
-	if (sock->can_send_data)
+	if (sock->is_standby)
+		expiration = now + pgm_usecs (sock->standby_req.sb_ivl);
+	else if (sock->can_send_data)
 		expiration = sock->next_ambient_spm;
+	else if (sock->rx_shm)
+		expiration = now + sock->rx_shm_ivl;
 	else
 		expiration = now + sock->peer_expiry;
 
@@ -87,10 +101,36 @@ pgm_timer_check (
 	pgm_timer_lock (sock);
 	expired = pgm_time_after_eq (now, sock->next_poll);
 	pgm_timer_unlock (sock);
+/* a pass for another socket of the timer pool or an application call collects an
+ * ambient SPM within the slack rather than waking again for it.
+ */
+	if (!expired && sock->can_send_data)
+		expired = pgm_time_after_eq (now + sock->spm_ambient_interval / PGM_SPM_AMBIENT_SLACK, sock->next_ambient_spm);
 	return expired;
 }
 
-/* return next timer expiration in microseconds (μs)
+/* next ambient SPM after now, jittered by sock::rand_.
+ */
+
+PGM_GNUC_INTERNAL
+pgm_time_t
+pgm_timer_next_ambient_spm (
+	pgm_sock_t* const	sock,
+	const pgm_time_t	now
+	)
+{
+	const int32_t jitter = (int32_t)(sock->spm_ambient_interval / PGM_SPM_AMBIENT_JITTER);
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+
+	if (0 == jitter)
+		return now + sock->spm_ambient_interval;
+	return now + sock->spm_ambient_interval + pgm_rand_int_range (&sock->rand_, -jitter, jitter);
+}
+
+/* return next timer expiration in microseconds (μs), lock-free where
+ * pgm_timer_next_poll() permits.
  */
 
 PGM_GNUC_INTERNAL
@@ -105,21 +145,73 @@ pgm_timer_expiration (
 /* pre-conditions */
 	pgm_assert (NULL != sock);
 
-	pgm_timer_lock (sock);
-	expiration = pgm_time_after (sock->next_poll, now) ? pgm_to_usecs (sock->next_poll - now) : 0;
-	pgm_timer_unlock (sock);
+	const pgm_time_t next_poll = pgm_timer_next_poll (sock);
+	expiration = pgm_time_after (next_poll, now) ? pgm_to_usecs (next_poll - now) : 0;
 	return expiration;
 }
 
+#ifdef PGM_HAVE_TIMER_FD
+/* arm the PGM_TIMER_FD descriptor and the EVFILT_TIMER event of pgm_kqueue_ctl()
+ * at the next timer expiration with microsecond resolution.  re-arming resets the
+ * timerfd expiration count so the descriptor polls readable only once due, an
+ * unchanged expiration is not re-armed.  the one-shot kqueue timer is collected
+ * as it fires and always re-armed.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_timer_arm (
+	pgm_sock_t* const	sock
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+
+	const pgm_time_t next_poll = pgm_timer_next_poll (sock);
+	const pgm_time_t now = pgm_time_update_now();
+	const pgm_time_t usecs = pgm_time_after (next_poll, now) ? next_poll - now : 0;
+#ifdef HAVE_SYS_TIMERFD_H
+	if (INVALID_SOCKET != sock->timer_fd &&
+	    next_poll != sock->timer_fd_expiry)
+	{
+		struct itimerspec its;
+		memset (&its, 0, sizeof(its));
+		its.it_value.tv_sec  = (time_t)(usecs / 1000000UL);
+		its.it_value.tv_nsec = (long)(usecs % 1000000UL) * 1000L;
+/* zero disarms, expire immediately instead */
+		if (0 == usecs)
+			its.it_value.tv_nsec = 1;
+		if (PGM_UNLIKELY(SOCKET_ERROR == timerfd_settime (sock->timer_fd, 0, &its, NULL)))
+			pgm_debug ("timerfd_settime returned errno=%i", errno);
+		else
+			sock->timer_fd_expiry = next_poll;
+	}
+#endif
+#ifdef HAVE_KQUEUE
+	if (INVALID_SOCKET != sock->timer_kq)
+	{
+		struct kevent kev;
+#	ifdef NOTE_USECONDS
+		EV_SET(&kev, (uintptr_t)sock, EVFILT_TIMER, EV_ADD | EV_ONESHOT, NOTE_USECONDS, (intptr_t)usecs, sock);
+#	else
+		EV_SET(&kev, (uintptr_t)sock, EVFILT_TIMER, EV_ADD | EV_ONESHOT, 0, (intptr_t)((usecs + 999) / 1000), sock);
+#	endif
+		if (PGM_UNLIKELY(SOCKET_ERROR == kevent (sock->timer_kq, &kev, 1, NULL, 0, NULL)))
+			pgm_debug ("kevent returned errno=%i", errno);
+	}
+#endif
+}
+#endif /* PGM_HAVE_TIMER_FD */
+
 /* call all timers, assume that time_now has been updated by either pgm_timer_prepare
  * or pgm_timer_check and no other method calls here.
  * 
  * returns TRUE on success, returns FALSE on blocked send-in-receive operation.
  */
 
-PGM_GNUC_INTERNAL
+static
 bool
-pgm_timer_dispatch (
+timer_dispatch (
 	pgm_sock_t* const	sock
 	)
 {
@@ -137,10 +229,50 @@ pgm_timer_dispatch (
 		if (!pgm_check_peer_state (sock, now))
 			return FALSE;
 		next_expiration = pgm_min_receiver_expiry (sock, now + sock->peer_expiry);
+
+/* designated local repairer advertisement */
+		if (sock->dlr_sqns)
+		{
+			if (pgm_time_after_eq (now, sock->next_dlr_poll) &&
+			    !pgm_send_dlr_poll (sock, now))
+				return FALSE;
+			next_expiration = MIN(next_expiration, sock->next_dlr_poll);
+		}
+
+/* same-host store has no wake-up, waiting receivers poll */
+		if (sock->rx_shm)
+			next_expiration = MIN(next_expiration, now + sock->rx_shm_ivl);
+	}
+
+/* datagrams held by test impairment, received datagrams are released by the next read */
+	if (PGM_UNLIKELY(NULL != sock->rx_impair || NULL != sock->tx_impair))
+	{
+		if (NULL != sock->tx_impair)
+			pgm_sendto_impaired (sock, now);
+		const pgm_time_t rx_impair_expiry = sock->rx_impair ? pgm_impair_expiry (sock->rx_impair) : 0;
+		const pgm_time_t tx_impair_expiry = sock->tx_impair ? pgm_impair_expiry (sock->tx_impair) : 0;
+		if (0 != rx_impair_expiry)
+			next_expiration = next_expiration > 0 ? MIN(next_expiration, rx_impair_expiry) : rx_impair_expiry;
+		if (0 != tx_impair_expiry)
+			next_expiration = next_expiration > 0 ? MIN(next_expiration, tx_impair_expiry) : tx_impair_expiry;
 	}
 
 	if (sock->can_send_data)
 	{
+/* a standby only polls the primary, the ambient SPM is held off until take over */
+		if (PGM_UNLIKELY(sock->is_standby))
+		{
+			const pgm_time_t standby_expiry = pgm_on_standby (sock, now);
+			if (0 != standby_expiry) {
+				sock->next_ambient_spm = pgm_timer_next_ambient_spm (sock, now);
+				next_expiration = next_expiration > 0 ? MIN(next_expiration, standby_expiry) : standby_expiry;
+				pgm_sock_mutex_lock (sock, &sock->timer_mutex);
+				sock->next_poll = next_expiration;
+				pgm_sock_mutex_unlock (sock, &sock->timer_mutex);
+				return TRUE;
+			}
+		}
+
 /* reset congestion control on ACK timeout */
 		if (sock->use_pgmcc &&
 		    sock->tokens < pgm_fp8 (1) &&
@@ -148,14 +280,8 @@ pgm_timer_dispatch (
 		{
 			if (pgm_time_after_eq (now, sock->ack_expiry))
 			{
-#ifdef DEBUG_PGMCC
-char nows[1024];
-time_t t = time (NULL);
-struct tm* tmp = localtime (&t);
-strftime (nows, sizeof(nows), "%Y-%m-%d %H:%M:%S", tmp);
-printf ("ACK timeout, T:%u W:%u\n", pgm_fp8tou(sock->tokens), pgm_fp8tou(sock->cwnd_size));
-#endif
-				sock->tokens = sock->cwnd_size = pgm_fp8 (1);
+				pgm_evtrace (PGM_EV_ACK_TIMEOUT, &sock->tsi, 0, pgm_fp8tou (sock->cwnd_size));
+				sock->cc->on_timeout (sock);
 				sock->ack_bitmap = 0xffffffff;
 				sock->ack_expiry = 0;
 
@@ -165,24 +291,74 @@ printf ("ACK timeout, T:%u W:%u\n", pgm_fp8tou(sock->tokens), pgm_fp8tou(sock->c
 			next_expiration = next_expiration > 0 ? MIN(next_expiration, sock->ack_expiry) : sock->ack_expiry;
 		}
 
+/* flush messages coalesced by pgm_send_batch() */
+		if (sock->batch_max)
+		{
+			pgm_sock_mutex_lock (sock, &sock->timer_mutex);
+			const pgm_time_t batch_expiry = sock->batch_expiry;
+			pgm_sock_mutex_unlock (sock, &sock->timer_mutex);
+			if (0 != batch_expiry) {
+				if (pgm_time_after_eq (now, batch_expiry)) {
+					if (!pgm_on_batch_expiry (sock))
+						return FALSE;
+				} else
+					next_expiration = next_expiration > 0 ? MIN(next_expiration, batch_expiry) : batch_expiry;
+			}
+		}
+
+/* confirm and queue NAKs held by PGM_NAK_AGGREGATE_IVL */
+		if (sock->nak_pending)
+		{
+			pgm_sock_mutex_lock (sock, &sock->nak_mutex);
+			const pgm_time_t nak_aggregate_expiry = sock->nak_aggregate_expiry;
+			pgm_sock_mutex_unlock (sock, &sock->nak_mutex);
+			if (0 != nak_aggregate_expiry) {
+				if (pgm_time_after_eq (now, nak_aggregate_expiry))
+					pgm_on_nak_aggregate_expiry (sock);
+				else
+					next_expiration = next_expiration > 0 ? MIN(next_expiration, nak_aggregate_expiry) : nak_aggregate_expiry;
+			}
+		}
+
+/* stream catch-up ranges of PGM_CATCHUP_RATE */
+		if (sock->catchup)
+		{
+			const pgm_time_t catchup_expiry = pgm_on_catchup (sock);
+			if (0 != catchup_expiry)
+				next_expiration = next_expiration > 0 ? MIN(next_expiration, catchup_expiry) : catchup_expiry;
+		}
+
+/* retry APDUs blocked in the send queue */
+		if (sock->sendq_max)
+		{
+			pgm_sock_mutex_lock (sock, &sock->timer_mutex);
+			pgm_time_t sendq_expiry = sock->sendq_expiry;
+			pgm_sock_mutex_unlock (sock, &sock->timer_mutex);
+			if (0 != sendq_expiry && pgm_time_after_eq (now, sendq_expiry))
+				sendq_expiry = pgm_on_sendq_expiry (sock);
+			if (0 != sendq_expiry)
+				next_expiration = next_expiration > 0 ? MIN(next_expiration, sendq_expiry) : sendq_expiry;
+		}
+
 /* SPM broadcast */
-		pgm_mutex_lock (&sock->timer_mutex);
+		pgm_sock_mutex_lock (sock, &sock->timer_mutex);
 		const unsigned spm_heartbeat_state = sock->spm_heartbeat_state;
 		const pgm_time_t next_heartbeat_spm = sock->next_heartbeat_spm;
-		pgm_mutex_unlock (&sock->timer_mutex);
+		pgm_sock_mutex_unlock (sock, &sock->timer_mutex);
 
 /* no lock needed on ambient */
 		const pgm_time_t next_ambient_spm = sock->next_ambient_spm;
 		pgm_time_t next_spm = spm_heartbeat_state ? MIN(next_heartbeat_spm, next_ambient_spm) : next_ambient_spm;
+		const bool is_ambient_due = pgm_time_after_eq (now + sock->spm_ambient_interval / PGM_SPM_AMBIENT_SLACK, next_ambient_spm);
 
-		if (pgm_time_after_eq (now, next_spm) &&
+		if ((is_ambient_due || pgm_time_after_eq (now, next_spm)) &&
 		   !pgm_send_spm (sock, 0))
 			return FALSE;
 
 /* ambient timing not so important so base next event off current time */
-		if (pgm_time_after_eq (now, next_ambient_spm))
+		if (is_ambient_due)
 		{
-			sock->next_ambient_spm = now + sock->spm_ambient_interval;
+			sock->next_ambient_spm = pgm_timer_next_ambient_spm (sock, now);
 			next_spm = spm_heartbeat_state ? MIN(next_heartbeat_spm, sock->next_ambient_spm) : sock->next_ambient_spm;
 		}
 
@@ -200,7 +376,7 @@ printf ("ACK timeout, T:%u W:%u\n", pgm_fp8tou(sock->tokens), pgm_fp8tou(sock->c
 				}
 			} while (pgm_time_after_eq (now, new_heartbeat_spm));
 /* check for reset heartbeat */
-			pgm_mutex_lock (&sock->timer_mutex);
+			pgm_sock_mutex_lock (sock, &sock->timer_mutex);
 			if (next_heartbeat_spm == sock->next_heartbeat_spm) {
 				sock->spm_heartbeat_state = new_heartbeat_state;
 				sock->next_heartbeat_spm  = new_heartbeat_spm;
@@ -208,16 +384,16 @@ printf ("ACK timeout, T:%u W:%u\n", pgm_fp8tou(sock->tokens), pgm_fp8tou(sock->c
 			} else
 				next_spm = MIN(sock->next_ambient_spm, sock->next_heartbeat_spm);
 			sock->next_poll = next_expiration > 0 ? MIN(next_expiration, next_spm) : next_spm;
-			pgm_mutex_unlock (&sock->timer_mutex);
+			pgm_sock_mutex_unlock (sock, &sock->timer_mutex);
 			return TRUE;
 		}
 
 		next_expiration = next_expiration > 0 ? MIN(next_expiration, next_spm) : next_spm;
 
 /* check for reset */
-		pgm_mutex_lock (&sock->timer_mutex);
+		pgm_sock_mutex_lock (sock, &sock->timer_mutex);
 		sock->next_poll = sock->next_poll > now ? MIN(sock->next_poll, next_expiration) : next_expiration;
-		pgm_mutex_unlock (&sock->timer_mutex);
+		pgm_sock_mutex_unlock (sock, &sock->timer_mutex);
 	}
 	else
 		sock->next_poll = next_expiration;
@@ -225,4 +401,19 @@ printf ("ACK timeout, T:%u W:%u\n", pgm_fp8tou(sock->tokens), pgm_fp8tou(sock->c
 	return TRUE;
 }
 
+/* timer_dispatch() accounted as one stage.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_timer_dispatch (
+	pgm_sock_t* const	sock
+	)
+{
+	PGM_PROFILE_BEGIN (timer_start);
+	const bool status = timer_dispatch (sock);
+	PGM_PROFILE_END (PGM_PROFILE_TIMER, timer_start, 0);
+	return status;
+}
+
 /* eof */
@@ -48,6 +48,13 @@
 #define pgm_min_receiver_expiry		mock_pgm_min_receiver_expiry
 #define pgm_check_peer_state		mock_pgm_check_peer_state
 #define pgm_send_spm			mock_pgm_send_spm
+#define pgm_on_batch_expiry		mock_pgm_on_batch_expiry
+#define pgm_on_sendq_expiry		mock_pgm_on_sendq_expiry
+#define pgm_on_catchup			mock_pgm_on_catchup
+#define pgm_on_standby			mock_pgm_on_standby
+#define pgm_sendto_impaired		mock_pgm_sendto_impaired
+#define pgm_send_dlr_poll		mock_pgm_send_dlr_poll
+#define pgm_rand_int_range		mock_pgm_rand_int_range
 
 
 #define TIMER_DEBUG
@@ -221,6 +228,81 @@ mock_pgm_send_spm (
 	return TRUE;
 }
 
+PGM_GNUC_INTERNAL
+bool
+mock_pgm_on_batch_expiry (
+	pgm_sock_t*		sock
+	)
+{
+	g_assert (NULL != sock);
+	return TRUE;
+}
+
+PGM_GNUC_INTERNAL
+pgm_time_t
+mock_pgm_on_sendq_expiry (
+	pgm_sock_t*		sock
+	)
+{
+	g_assert (NULL != sock);
+	return 0;
+}
+
+PGM_GNUC_INTERNAL
+pgm_time_t
+mock_pgm_on_catchup (
+	pgm_sock_t*		sock
+	)
+{
+	g_assert (NULL != sock);
+	return 0;
+}
+
+PGM_GNUC_INTERNAL
+pgm_time_t
+mock_pgm_on_standby (
+	pgm_sock_t*		sock,
+	const pgm_time_t	now
+	)
+{
+	g_assert (NULL != sock);
+	return 0;
+}
+
+PGM_GNUC_INTERNAL
+void
+mock_pgm_sendto_impaired (
+	pgm_sock_t*		sock,
+	const pgm_time_t	now
+	)
+{
+	g_assert (NULL != sock);
+}
+
+PGM_GNUC_INTERNAL
+bool
+mock_pgm_send_dlr_poll (
+	pgm_sock_t*		sock,
+	const pgm_time_t	now
+	)
+{
+	g_assert (NULL != sock);
+	sock->next_dlr_poll = now + sock->dlr_ivl;
+	return TRUE;
+}
+
+PGM_GNUC_INTERNAL
+int32_t
+mock_pgm_rand_int_range (
+	pgm_rand_t*		r,
+	int32_t			begin,
+	int32_t			end
+	)
+{
+	g_assert (NULL != r);
+	return begin;
+}
+
 
 /* target:
  *	bool
@@ -0,0 +1,289 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * PACKET_MMAP receive: a TPACKET_V3 ring on an AF_PACKET socket bound to one
+ * interface carries the unfragmented IPv4 PGM datagrams the kernel would
+ * otherwise copy to the raw receive sockets one recvmsg() at a time.  Blocks
+ * of datagrams are handed over when full or on timeout and returned to the
+ * kernel once every datagram has been read.  The raw receive sockets discard
+ * everything whilst the ring is open, fragments are not reassembled.
+ *
+ * Copyright (c) 2006-2011 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <impl/framework.h>
+#include <impl/socket.h>
+
+#ifdef HAVE_LINUX_IF_PACKET_H
+#	include <errno.h>
+#	include <unistd.h>
+#	include <sys/mman.h>
+#	include <sys/socket.h>
+#	include <netinet/in.h>
+#	include <linux/filter.h>
+#	include <linux/if_ether.h>
+#	include <linux/if_packet.h>
+
+
+//#define TPACKET_DEBUG
+
+#ifndef TPACKET_DEBUG
+#	define PGM_DISABLE_ASSERT
+#endif
+
+#define PGM_TPACKET_FRAME_SIZE		2048
+
+struct pgm_recv_tpacket_t {
+	int				fd;			/* AF_PACKET socket */
+	char*				ring;
+	size_t				ring_len;
+	unsigned			block_size;
+	unsigned			blocks;
+	unsigned			block;			/* block next read */
+	unsigned			remaining;		/* datagrams left in block, 0 = not yet handed over */
+	const char*			next;			/* next datagram header in block */
+	SOCKET				recv_sock[PGM_MAX_RECV_SOCKETS];
+	unsigned			recv_sock_len;
+};
+
+
+/* admit PGM/IP datagrams received by the host, unfragmented, the sole check
+ * on the ring and the prefix of any PGM_RECV_FILTER program on it.  loads are
+ * relative to the IP header, packet sockets of SOCK_DGRAM see no link header.
+ *
+ * returns count of instructions, PGM_TPACKET_FILTER_INSNS.
+ */
+
+PGM_GNUC_INTERNAL
+unsigned
+pgm_recv_tpacket_filter_prefix (
+	struct sock_filter* const	insns
+	)
+{
+	unsigned n = 0;
+
+#define STMT(c, k)		(insns[n++] = (struct sock_filter)BPF_STMT((c), (k)))
+#define JUMP(c, k, t, f)	(insns[n++] = (struct sock_filter)BPF_JUMP((c), (k), (t), (f)))
+	STMT (BPF_LD | BPF_W | BPF_ABS, SKF_AD_OFF + SKF_AD_PKTTYPE);
+	JUMP (BPF_JMP | BPF_JEQ | BPF_K, PACKET_OUTGOING, 5, 0);
+	JUMP (BPF_JMP | BPF_JEQ | BPF_K, PACKET_OTHERHOST, 4, 0);
+	STMT (BPF_LD | BPF_B | BPF_ABS, 9);
+	JUMP (BPF_JMP | BPF_JEQ | BPF_K, IPPROTO_PGM, 0, 2);
+	STMT (BPF_LD | BPF_H | BPF_ABS, 6);
+	JUMP (BPF_JMP | BPF_JSET | BPF_K, 0x3fff, 0, 1);
+	STMT (BPF_RET | BPF_K, 0);
+#undef JUMP
+#undef STMT
+	pgm_assert (PGM_TPACKET_FILTER_INSNS == n);
+	return n;
+}
+
+/* create the AF_PACKET socket, admit PGM/IP, map the TPACKET_V3 ring and bind
+ * to the interface, then close the raw receive sockets of sock to datagrams.
+ *
+ * returns new receive path, or NULL on failure setting errno.
+ */
+
+PGM_GNUC_INTERNAL
+struct pgm_recv_tpacket_t*
+pgm_recv_tpacket_new (
+	const pgm_sock_t* const			sock,
+	const struct pgm_tpacket_req_t* const	req
+	)
+{
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != req);
+	pgm_assert (0 != req->tr_interface);
+
+	struct pgm_recv_tpacket_t* tp = pgm_new0 (struct pgm_recv_tpacket_t, 1);
+	tp->block_size	= req->tr_block_size ? req->tr_block_size : PGM_TPACKET_DEFAULT_BLOCK_SIZE;
+	tp->blocks	= req->tr_blocks ? req->tr_blocks : PGM_TPACKET_DEFAULT_BLOCKS;
+	tp->fd = socket (AF_PACKET, SOCK_DGRAM, htons (ETH_P_IP));
+	if (tp->fd < 0)
+		goto err_destroy;
+
+/* filter before the ring exists such that no foreign datagram is queued */
+	struct sock_filter insns[PGM_TPACKET_FILTER_INSNS + 1];
+	struct sock_fprog prog;
+	prog.len	= (unsigned short)pgm_recv_tpacket_filter_prefix (insns);
+	insns[prog.len++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, UINT32_MAX);
+	prog.filter	= insns;
+	const int version = TPACKET_V3;
+	if (0 != setsockopt (tp->fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) ||
+	    0 != setsockopt (tp->fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)))
+		goto err_destroy;
+
+	struct tpacket_req3 tr;
+	memset (&tr, 0, sizeof(tr));
+	tr.tp_block_size	= tp->block_size;
+	tr.tp_block_nr		= tp->blocks;
+	tr.tp_frame_size	= PGM_TPACKET_FRAME_SIZE;
+	tr.tp_frame_nr		= (tp->block_size / PGM_TPACKET_FRAME_SIZE) * tp->blocks;
+	tr.tp_retire_blk_tov	= req->tr_timeout ? req->tr_timeout : PGM_TPACKET_DEFAULT_TIMEOUT;
+	if (0 != setsockopt (tp->fd, SOL_PACKET, PACKET_RX_RING, &tr, sizeof(tr)))
+		goto err_destroy;
+	tp->ring_len = (size_t)tp->block_size * tp->blocks;
+	tp->ring = mmap (NULL, tp->ring_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, tp->fd, 0);
+	if (MAP_FAILED == tp->ring) {
+		tp->ring = NULL;
+		goto err_destroy;
+	}
+
+	struct sockaddr_ll sll;
+	memset (&sll, 0, sizeof(sll));
+	sll.sll_family		= AF_PACKET;
+	sll.sll_protocol	= htons (ETH_P_IP);
+	sll.sll_ifindex		= (int)req->tr_interface;
+	if (0 != bind (tp->fd, (struct sockaddr*)&sll, sizeof(sll)))
+		goto err_destroy;
+
+/* the raw sockets still join groups and would queue a second copy of each datagram */
+	static struct sock_filter drop = BPF_STMT(BPF_RET | BPF_K, 0);
+	prog.len	= 1;
+	prog.filter	= &drop;
+	for (unsigned i = 0; i <= sock->recv_sock_extra_len; i++)
+	{
+		const SOCKET recv_sock = (0 == i) ? sock->recv_sock : sock->recv_sock_extra[i - 1];
+		if (0 != setsockopt (recv_sock, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)))
+			goto err_destroy;
+		tp->recv_sock[tp->recv_sock_len++] = recv_sock;
+	}
+	return tp;
+
+err_destroy:
+	{
+		const int save_errno = errno;
+		pgm_recv_tpacket_destroy (tp);
+		errno = save_errno;
+	}
+	return NULL;
+}
+
+/* the raw receive sockets are reopened before the ring is unmapped.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_recv_tpacket_destroy (
+	struct pgm_recv_tpacket_t* const	tp
+	)
+{
+	pgm_assert (NULL != tp);
+
+	const int v = 0;
+	for (unsigned i = 0; i < tp->recv_sock_len; i++)
+		setsockopt (tp->recv_sock[i], SOL_SOCKET, SO_DETACH_FILTER, &v, sizeof(v));
+	if (tp->ring)
+		munmap (tp->ring, tp->ring_len);
+	if (tp->fd >= 0)
+		close (tp->fd);
+	pgm_free (tp);
+}
+
+/* copy the next datagram into skb from the IP header as the raw receive
+ * sockets provide, returning the block to the kernel after its last.
+ *
+ * on success returns packet length, with no datagram returns -1 setting
+ * PGM_SOCK_EAGAIN.
+ */
+
+PGM_GNUC_INTERNAL
+ssize_t
+pgm_recv_tpacket_recv (
+	struct pgm_recv_tpacket_t* const restrict	tp,
+	struct pgm_sk_buff_t*	   const restrict	skb,
+	struct sockaddr*	   const restrict	src_addr,
+	struct sockaddr*	   const restrict	dst_addr
+	)
+{
+	pgm_assert (NULL != tp);
+	pgm_assert (NULL != skb);
+	pgm_assert (NULL != src_addr);
+	pgm_assert (NULL != dst_addr);
+
+	for (;;)
+	{
+		struct tpacket_block_desc* bd = (struct tpacket_block_desc*)(tp->ring + (size_t)tp->block * tp->block_size);
+		if (0 == tp->remaining) {
+			if (!(__atomic_load_n (&bd->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER)) {
+				pgm_set_last_sock_error (PGM_SOCK_EAGAIN);
+				return -1;
+			}
+			tp->remaining	= bd->hdr.bh1.num_pkts;
+			tp->next	= (const char*)bd + bd->hdr.bh1.offset_to_first_pkt;
+		}
+		ssize_t copied = -1;
+
+		if (PGM_LIKELY(tp->remaining > 0)) {
+			const struct tpacket3_hdr* hdr = (const struct tpacket3_hdr*)tp->next;
+			const struct pgm_ip* ip = (const struct pgm_ip*)(tp->next + hdr->tp_net);
+			const size_t len = hdr->tp_snaplen;
+			if (PGM_LIKELY(len >= sizeof(struct pgm_ip))) {
+				const size_t ip_len = MIN(len, (size_t)ntohs (ip->ip_len));
+				const size_t data_len = MIN(ip_len, (size_t)((char*)skb->end - (char*)skb->head));
+				memcpy (skb->head, ip, data_len);
+				copied = (ssize_t)data_len;
+
+				struct sockaddr_in s4;
+				memset (&s4, 0, sizeof(s4));
+				s4.sin_family		= AF_INET;
+				s4.sin_addr		= ip->ip_src;
+				memcpy (src_addr, &s4, sizeof(s4));
+				s4.sin_addr		= ip->ip_dst;
+				memcpy (dst_addr, &s4, sizeof(s4));
+			}
+			tp->next += hdr->tp_next_offset;
+			tp->remaining--;
+		}
+
+		if (0 == tp->remaining) {
+			__atomic_store_n (&bd->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+			tp->block = (tp->block + 1) % tp->blocks;
+		}
+		if (PGM_LIKELY(copied > 0))
+			return copied;
+	}
+}
+
+PGM_GNUC_INTERNAL
+bool
+pgm_recv_tpacket_is_pending (
+	const struct pgm_recv_tpacket_t* const	tp
+	)
+{
+	pgm_assert (NULL != tp);
+	if (tp->remaining > 0)
+		return TRUE;
+	const struct tpacket_block_desc* bd = (const struct tpacket_block_desc*)(tp->ring + (size_t)tp->block * tp->block_size);
+	return 0 != (__atomic_load_n (&bd->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER);
+}
+
+PGM_GNUC_INTERNAL
+SOCKET
+pgm_recv_tpacket_get_socket (
+	const struct pgm_recv_tpacket_t* const	tp
+	)
+{
+	pgm_assert (NULL != tp);
+	return tp->fd;
+}
+
+#endif /* HAVE_LINUX_IF_PACKET_H */
+
+/* eof */
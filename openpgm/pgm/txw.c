@@ -33,6 +33,62 @@
 #	define PGM_DISABLE_ASSERT
 #endif
 
+/* retransmit state word */
+#define PGM_TXW_WAITING_RETRANSMIT	0x80000000U	/* in retransmit queue */
+#define PGM_TXW_PKT_CNT_REQUESTED	0x000000ffU	/* # parity packets to send */
+
+/* retransmit request ring length, power of 2 */
+#define PGM_TXW_MIN_REQUESTS		64
+#define PGM_TXW_MAX_REQUESTS		4096
+
+/* sequences referenced per peek_active section of a range request */
+#define PGM_TXW_RANGE_BATCH		64
+
+/* bounded multiple-producer single-consumer ring cell, stamp is the ring position the
+ * cell is next to be written for, plus one when the skbuff is published.
+ */
+
+struct pgm_txw_request_t {
+	volatile uint32_t		stamp;
+	struct pgm_sk_buff_t*		skb;
+};
+
+/* completed transmission groups queued from the source API beyond this many fall back
+ * to parity encoded on the repair path.
+ */
+#define PGM_TXW_MAX_PARITY_JOBS		64
+
+/* FEC worker: the source API queues references to each completed transmission group,
+ * the worker thread encodes the proactive parity packets and publishes them for the
+ * repair path to send.  the Reed-Solomon generator matrix is only read.
+ */
+
+struct pgm_txw_parity_job_t {
+	pgm_list_t			link_;
+	uint32_t			tg_sqn;
+/* C90 and older */
+	struct pgm_sk_buff_t*		odata[1];
+};
+
+struct pgm_txw_parity_t {
+	pgm_txw_t*			window;
+	pgm_notify_t*			notify;			/* repair path wakeup */
+	uint8_t				h;			/* parity packets per group */
+	uint8_t				rs_h;			/* first parity index */
+
+	pgm_mutex_t			mutex;
+	pgm_cond_t			cond;
+	pgm_queue_t			jobs;
+	pgm_queue_t			ready;			/* encoded parity skbuffs */
+	volatile uint32_t		ready_len;		/* read without lock */
+	bool				is_shutdown;
+#ifndef _WIN32
+	pthread_t			thread;
+#else
+	HANDLE				thread;
+#endif
+};
+
 
 /* testing function: is TSI null
  *
@@ -56,6 +112,19 @@ pgm_tsi_is_null (
 	return (0 == u->l[0] && 0 == u->l[1]);
 }
 
+/* pdata index of a sequence, a mask for power-of-two windows.
+ */
+
+static inline
+uint_fast32_t
+_pgm_txw_index (
+	const pgm_txw_t*const	window,
+	const uint32_t		sequence
+	)
+{
+	return PGM_LIKELY(window->mask) ? (sequence & window->mask) : (sequence % window->alloc);
+}
+
 /* returns the pointer at the given index of the window.  responsibility
  * is with the caller to verify a single user ownership.
  */
@@ -77,7 +146,7 @@ _pgm_txw_peek (
 
 	if (pgm_uint32_gte (sequence, window->trail) && pgm_uint32_lte (sequence, window->lead))
 	{
-		const uint_fast32_t index_ = sequence % pgm_txw_max_length (window);
+		const uint_fast32_t index_ = _pgm_txw_index (window, sequence);
 		skb = window->pdata[index_];
 		pgm_assert (NULL != skb);
 		pgm_assert (pgm_skb_is_valid (skb));
@@ -89,6 +158,34 @@ _pgm_txw_peek (
 	return skb;
 }
 
+/* reference to the entry at the given index of the window from outside the source
+ * API.  the producer advances the trail before checking peek_active and readers raise
+ * peek_active before checking the trail, both with a full barrier, so either the
+ * entry is seen as evicted or its release waits until the reference is taken.
+ *
+ * returns referenced skbuff, or NULL if not in the window.
+ */
+
+static inline
+struct pgm_sk_buff_t*
+_pgm_txw_get (
+	pgm_txw_t*const		window,
+	const uint32_t		sequence
+	)
+{
+	struct pgm_sk_buff_t* skb;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+
+	pgm_atomic_inc32 (&window->peek_active);
+	skb = _pgm_txw_peek (window, sequence);
+	if (skb)
+		pgm_skb_get (skb);
+	pgm_atomic_dec32 (&window->peek_active);
+	return skb;
+}
+
 /* testing function: can a request be peeked from the retransmit queue.
  *
  * returns TRUE if request is available, returns FALSE if not available.
@@ -145,18 +242,29 @@ pgm_txw_retransmit_is_empty (
 	)
 {
 	pgm_assert (NULL != window);
-	return pgm_queue_is_empty (&window->retransmit_queue);
+	return (pgm_queue_is_empty (&window->retransmit_queue) &&
+		window->request_tail == pgm_atomic_read32 (&window->request_head) &&
+		(NULL == window->parity || 0 == pgm_atomic_read32 (&window->parity->ready_len)));
 }
 
 
 /* globals */
 
 static void pgm_txw_remove_tail (pgm_txw_t*const);
+static void pgm_txw_remove_tail_range (pgm_txw_t*const, const uint32_t);
+static bool pgm_txw_retransmit_enqueue (pgm_txw_t*const restrict, struct pgm_sk_buff_t*const restrict);
+static void pgm_txw_retransmit_drain (pgm_txw_t*const);
+static void pgm_txw_retransmit_pop (pgm_txw_t*const);
 static bool pgm_txw_retransmit_push_parity (pgm_txw_t*const, const uint32_t, const uint8_t);
 static bool pgm_txw_retransmit_push_selective (pgm_txw_t*const, const uint32_t);
+static bool pgm_txw_retransmit_mark_selective (pgm_txw_t*const restrict, struct pgm_sk_buff_t*const restrict);
+static struct pgm_sk_buff_t* pgm_txw_store_get (pgm_txw_t*const, const uint32_t);
+static void pgm_txw_encode_parity (pgm_txw_t*const restrict, struct pgm_sk_buff_t**const restrict, const uint32_t, const uint8_t, struct pgm_sk_buff_t*const restrict);
+static void pgm_txw_parity_stop (pgm_txw_t*const);
 
 
-/* constructor for transmit window.  zero-length windows are not permitted.
+/* constructor for transmit window.  zero-length windows are not permitted.  with forward
+ * error correction tpdu_size is required for parity packets however the window is sized.
  *
  * returns pointer to window.
  */
@@ -171,7 +279,8 @@ pgm_txw_create (
 	const ssize_t		max_rte,	/* max bandwidth */
 	const bool		use_fec,
 	const uint8_t		rs_n,
-	const uint8_t		rs_k
+	const uint8_t		rs_k,
+	const pgm_mem_policy_t*const policy	/* NULL = heap */
 	)
 {
 	pgm_txw_t* window;
@@ -179,7 +288,6 @@ pgm_txw_create (
 /* pre-conditions */
 	pgm_assert (NULL != tsi);
 	if (sqns) {
-		pgm_assert_cmpuint (tpdu_size, ==, 0);
 		pgm_assert_cmpuint (sqns, >, 0);
 		pgm_assert_cmpuint (sqns & PGM_UINT32_SIGN_BIT, ==, 0);
 		pgm_assert_cmpuint (secs, ==, 0);
@@ -203,7 +311,7 @@ pgm_txw_create (
 /* calculate transmit window parameters */
 	pgm_assert (sqns || (tpdu_size && secs && max_rte));
 	const unsigned alloc_sqns = sqns ? sqns : (unsigned)( (secs * max_rte) / tpdu_size );
-	window = pgm_malloc0 (sizeof(pgm_txw_t) + ( alloc_sqns * sizeof(struct pgm_sk_buff_t*) ));
+	window = pgm_malloc0_policy (sizeof(pgm_txw_t) + ( alloc_sqns * sizeof(struct pgm_sk_buff_t*) ), policy);
 	window->tsi = tsi;
 
 /* empty state for transmission group boundaries to align.
@@ -213,9 +321,22 @@ pgm_txw_create (
 	window->lead = -1;
 	window->trail = window->lead + 1;
 
+/* retransmit request ring, each cell ready for its own position */
+	uint32_t request_len = PGM_TXW_MIN_REQUESTS;
+	while (request_len < alloc_sqns && request_len < PGM_TXW_MAX_REQUESTS)
+		request_len <<= 1;
+	window->request = pgm_new0 (struct pgm_txw_request_t, request_len);
+	for (uint_fast32_t i = 0; i < request_len; i++)
+		window->request[i].stamp = (uint32_t)i;
+	window->request_mask = request_len - 1;
+
+/* reed-solomon parity and sliding window repair buffers */
+	window->max_tpdu = tpdu_size;
+
 /* reed-solomon forward error correction */
 	if (use_fec) {
-		window->parity_buffer = pgm_alloc_skb (tpdu_size);
+		pgm_assert_cmpuint (tpdu_size, >, 0);
+		window->parity_buffer = pgm_alloc_skb_subsys (tpdu_size, PGM_MEM_SUBSYS_FEC);
 		window->tg_sqn_shift = pgm_power2_log2 (rs_k);
 		pgm_rs_create (&window->rs, rs_n, rs_k);
 		window->is_fec_enabled = 1;
@@ -223,6 +344,7 @@ pgm_txw_create (
 
 /* pointer array */
 	window->alloc = alloc_sqns;
+	window->mask = (alloc_sqns > 1 && 0 == (alloc_sqns & (alloc_sqns - 1))) ? alloc_sqns - 1 : 0;
 
 /* post-conditions */
 	pgm_assert_cmpuint (pgm_txw_max_length (window), ==, alloc_sqns);
@@ -250,9 +372,20 @@ pgm_txw_shutdown (
 
 	pgm_debug ("shutdown (window:%p)", (const void*)window);
 
+/* worker holds references to transmission groups */
+	if (window->parity) {
+		pgm_txw_parity_stop (window);
+	}
+
+/* references held by the retransmit queue */
+	pgm_txw_retransmit_drain (window);
+	while (!pgm_queue_is_empty (&window->retransmit_queue)) {
+		pgm_txw_retransmit_pop (window);
+	}
+
 /* contents of window */
-	while (!pgm_txw_is_empty (window)) {
-		pgm_txw_remove_tail (window);
+	if (!pgm_txw_is_empty (window)) {
+		pgm_txw_remove_tail_range (window, pgm_txw_length (window));
 	}
 
 /* window must now be empty */
@@ -271,7 +404,75 @@ pgm_txw_shutdown (
 	}
 
 /* window */
-	pgm_free (window);
+	pgm_free (window->request);
+	pgm_free_policy (window);
+}
+
+/* attach a store retaining sent packets beyond the window, before the first packet
+ * is added.  a store holding a previous session resumes the sequence space after
+ * its lead.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_txw_set_store (
+	pgm_txw_t*		const restrict window,
+	struct pgm_txw_store_t*	const restrict store
+	)
+{
+	uint32_t lead, spm_sqn;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (NULL != store);
+	pgm_assert (pgm_txw_is_empty (window));
+
+	if (pgm_txw_store_resume (store, &lead, &spm_sqn)) {
+		window->lead  = lead;
+		window->trail = window->lead + 1;
+	}
+	window->store_trail = pgm_txw_store_trail (store);
+	window->store = store;
+
+	pgm_debug ("set_store (window:%p store:%p trail:%" PRIu32 " lead:%" PRIu32 ")",
+		(const void*)window, (const void*)store, window->store_trail, window->lead);
+}
+
+/* enable early release of entries acknowledged by every reporting receiver
+ * once retention has passed since they were sent.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_txw_set_retention (
+	pgm_txw_t* const	window,
+	const pgm_time_t	retention
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != window);
+
+	window->ack_trail_retention = retention;
+}
+
+/* publish the sequence held by every reporting receiver, any thread.  an
+ * invalid trail suspends early release.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_txw_update_ack_trail (
+	pgm_txw_t* const	window,
+	const bool		is_valid,
+	const uint32_t		sequence
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != window);
+
+	if (is_valid)
+		pgm_atomic_write32 (&window->ack_trail, sequence);
+	pgm_atomic_write32 (&window->has_ack_trail, is_valid ? 1 : 0);
 }
 
 /* add skb to transmit window, taking ownership.  window does not grow.
@@ -309,29 +510,58 @@ pgm_txw_add (
 
 	pgm_debug ("add (window:%p skb:%p)", (const char*)window, (const char*)skb);
 
+/* release entries every reporting receiver holds, skb::tstamp is the send time */
+	if (pgm_atomic_read32 (&window->has_ack_trail) &&
+	    pgm_time_after (skb->tstamp, window->ack_trail_retention))
+	{
+		(void)pgm_txw_release (window,
+				       pgm_atomic_read32 (&window->ack_trail),
+				       skb->tstamp - window->ack_trail_retention);
+	}
+
 	if (pgm_txw_is_full (window))
 	{
 /* transmit window advancement scheme dependent action here */
 		pgm_txw_remove_tail (window);
 	}
+/* memory budget reached, release one entry per addition such that the window
+ * stops growing, transmission groups are kept whole for parity.
+ */
+	else if (PGM_UNLIKELY(pgm_budget_is_exceeded (window->budget)) &&
+		 !window->is_fec_enabled &&
+		 !pgm_txw_is_empty (window))
+	{
+		pgm_txw_remove_tail (window);
+	}
+
+/* release unused ring store, parity encoding pads source packets in place */
+	if (PGM_UNLIKELY(NULL != skb->pool && NULL != skb->pool->ring) && !window->is_fec_enabled)
+		pgm_skb_pool_trim (skb);
 
 /* generate new sequence number */
-	pgm_atomic_inc32 (&window->lead);
-	skb->sequence = window->lead;
+	skb->sequence = pgm_txw_next_lead (window);
 
 /* add skb to window */
-	const uint_fast32_t index_ = skb->sequence % pgm_txw_max_length (window);
+	const uint_fast32_t index_ = _pgm_txw_index (window, skb->sequence);
 	window->pdata[index_] = skb;
 
+/* persist for repairs beyond the window */
+	if (NULL != window->store)
+		pgm_atomic_write32 (&window->store_trail, pgm_txw_store_append (window->store, skb));
+
 /* statistics */
 	window->size += skb->len;
 
+/* publish to the consumer */
+	pgm_atomic_inc32 (&window->lead);
+
 /* post-conditions */
 	pgm_assert_cmpuint (pgm_txw_length (window), >, 0);
 	pgm_assert_cmpuint (pgm_txw_length (window), <=, pgm_txw_max_length (window));
 }
 
-/* peek an entry from the window for retransmission.
+/* peek an entry from the window without taking a reference, safe only for the
+ * producer or a window without concurrent additions.
  *
  * returns pointer to skbuff on success, returns NULL on invalid parameters.
  */
@@ -357,49 +587,122 @@ pgm_txw_remove_tail (
 	pgm_txw_t* const	window
 	)
 {
-	struct pgm_sk_buff_t	*skb;
-	pgm_txw_state_t		*state;
-
 	pgm_debug ("pgm_txw_remove_tail (window:%p)", (const void*)window);
 
 /* pre-conditions */
 	pgm_assert (NULL != window);
 	pgm_assert (!pgm_txw_is_empty (window));
 
-	skb = _pgm_txw_peek (window, pgm_txw_trail (window));
-	pgm_assert (NULL != skb);
-	pgm_assert (pgm_skb_is_valid (skb));
-	pgm_assert (pgm_tsi_is_null (&skb->tsi));
+	pgm_txw_remove_tail_range (window, 1);
+}
 
-	state = (pgm_txw_state_t*)&skb->cb;
-	if (state->waiting_retransmit) {
-		pgm_queue_unlink (&window->retransmit_queue, (pgm_list_t*)skb);
-		state->waiting_retransmit = 0;
-	}
+/* remove count entries from the trailing edge of the transmit window, the
+ * trail is advanced once and the skbuffs are returned to their pools together.
+ */
+
+static
+void
+pgm_txw_remove_tail_range (
+	pgm_txw_t* const	window,
+	const uint32_t		count
+	)
+{
+	struct pgm_sk_buff_t	*released = NULL;
+	size_t			 size = 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert_cmpuint (count, <=, pgm_txw_length (window));
+
+	const uint32_t trail = pgm_txw_trail (window);
+	for (uint32_t sequence = trail; sequence != trail + count; sequence++)
+	{
+		const struct pgm_sk_buff_t* skb = _pgm_txw_peek (window, sequence);
+		pgm_assert (NULL != skb);
+		pgm_assert (pgm_skb_is_valid (skb));
+		pgm_assert (pgm_tsi_is_null (&skb->tsi));
+
+		const pgm_txw_state_t* state = (const pgm_txw_state_t*)&skb->cb;
 
 /* statistics */
-	window->size -= skb->len;
-	if (state->retransmit_count > 0) {
-		PGM_HISTOGRAM_COUNTS("Tx.RetransmitCount", state->retransmit_count);
-	}
-	if (state->nak_elimination_count > 0) {
-		PGM_HISTOGRAM_COUNTS("Tx.NakEliminationCount", state->nak_elimination_count);
+		size += skb->len;
+		if (state->retransmit_count > 0) {
+			PGM_HISTOGRAM_COUNTS("Tx.RetransmitCount", state->retransmit_count);
+		}
+		if (state->nak_elimination_count > 0) {
+			PGM_HISTOGRAM_COUNTS("Tx.NakEliminationCount", state->nak_elimination_count);
+		}
 	}
+	window->size -= size;
 
-/* remove reference to skb */
-	if (PGM_UNLIKELY(pgm_mem_gc_friendly)) {
-		const uint_fast32_t index_ = skb->sequence % pgm_txw_max_length (window);
-		window->pdata[index_] = NULL;
-	}
-	pgm_free_skb (skb);
+/* advance trailing pointer, then wait for a consumer reference on these entries to be taken,
+ * a queued retransmit request keeps its own reference and is discarded by the consumer.
+ */
+	pgm_atomic_add32 (&window->trail, count);
+	while (pgm_atomic_read32 (&window->peek_active))
+		pgm_thread_yield ();
 
-/* advance trailing pointer */
-	pgm_atomic_inc32 (&window->trail);
+/* remove references to skbs */
+	for (uint32_t sequence = trail; sequence != trail + count; sequence++)
+	{
+		const uint_fast32_t index_ = _pgm_txw_index (window, sequence);
+		struct pgm_sk_buff_t* skb = window->pdata[index_];
+		if (PGM_UNLIKELY(pgm_mem_gc_friendly))
+			window->pdata[index_] = NULL;
+		pgm_free_skb_deferred (skb, &released);
+	}
+	pgm_skb_pool_release_list (released);
 
 /* post-conditions */
 	pgm_assert (!pgm_txw_is_full (window));
 }
 
+/* release entries of the trailing edge up to and including sequence, as
+ * acknowledged by every reporting receiver, that were sent no later than
+ * expiry.  with FEC only whole transmission groups are released so that
+ * on-demand parity can still be encoded.  source API only.
+ *
+ * returns count of entries released.
+ */
+
+PGM_GNUC_INTERNAL
+unsigned
+pgm_txw_release (
+	pgm_txw_t* const	window,
+	uint32_t		sequence,
+	const pgm_time_t	expiry
+	)
+{
+	unsigned count = 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+
+	pgm_debug ("release (window:%p sequence:%" PRIu32 " expiry:%" PGM_TIME_FORMAT ")",
+		(const void*)window, sequence, expiry);
+
+	if (window->is_fec_enabled) {
+		const uint32_t tg_sqn_mask = 0xffffffff << window->tg_sqn_shift;
+		sequence = ((sequence + 1) & tg_sqn_mask) - 1;
+	}
+	if (pgm_uint32_gt (sequence, window->lead))
+		sequence = window->lead;
+
+	while (count < pgm_txw_length (window) &&
+	       pgm_uint32_lte (window->trail + count, sequence))
+	{
+		const struct pgm_sk_buff_t* skb = _pgm_txw_peek (window, window->trail + count);
+		pgm_assert (NULL != skb);
+		if (pgm_time_after (skb->tstamp, expiry))
+			break;
+		pgm_prefetch (_pgm_txw_peek (window, window->trail + count + 1));
+		count++;
+	}
+	if (count > 0)
+		pgm_txw_remove_tail_range (window, count);
+	return count;
+}
+
 /* Try to add a sequence number to the retransmit queue, ignore if
  * already there or no longer in the transmit window.
  *
@@ -430,7 +733,7 @@ pgm_txw_retransmit_push (
 		(const void*)window, sequence, is_parity ? "TRUE" : "FALSE", tg_sqn_shift);
 
 /* early elimination */
-	if (pgm_txw_is_empty (window))
+	if (pgm_txw_is_empty (window) && NULL == window->store)
 		return FALSE;
 
 	if (is_parity)
@@ -453,6 +756,7 @@ pgm_txw_retransmit_push_parity (
 {
 	struct pgm_sk_buff_t	*skb;
 	pgm_txw_state_t		*state;
+	uint32_t		 retransmit, pkt_cnt_requested;
 
 /* pre-conditions */
 	pgm_assert (NULL != window);
@@ -461,7 +765,7 @@ pgm_txw_retransmit_push_parity (
 	const uint32_t tg_sqn_mask = 0xffffffff << tg_sqn_shift;
 	const uint32_t nak_tg_sqn  = sequence &  tg_sqn_mask;	/* left unshifted */
 	const uint32_t nak_pkt_cnt = sequence & ~tg_sqn_mask;
-	skb = _pgm_txw_peek (window, nak_tg_sqn);
+	skb = _pgm_txw_get (window, nak_tg_sqn);
 
 	if (NULL == skb) {
 		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Transmission group lead #%" PRIu32 " not in window."), nak_tg_sqn);
@@ -472,30 +776,29 @@ pgm_txw_retransmit_push_parity (
 	pgm_assert (pgm_tsi_is_null (&skb->tsi));
 	state = (pgm_txw_state_t*)&skb->cb;
 
-/* check if request can be eliminated */
-	if (state->waiting_retransmit)
+	for (;;)
 	{
-		pgm_assert (NULL != ((const pgm_list_t*)skb)->next);
-		pgm_assert (NULL != ((const pgm_list_t*)skb)->prev);
-		if (state->pkt_cnt_requested < nak_pkt_cnt) {
+		retransmit = pgm_atomic_read32 (&state->retransmit);
+		pkt_cnt_requested = retransmit & PGM_TXW_PKT_CNT_REQUESTED;
+
+/* check if request can be eliminated */
+		if (retransmit & PGM_TXW_WAITING_RETRANSMIT)
+		{
 /* more parity packets requested than currently scheduled, simply bump up the count */
-			state->pkt_cnt_requested = nak_pkt_cnt;
+			if (pkt_cnt_requested < nak_pkt_cnt &&
+			    !pgm_atomic_compare_and_exchange32 (&state->retransmit, PGM_TXW_WAITING_RETRANSMIT | nak_pkt_cnt, retransmit))
+				continue;
+			pgm_atomic_inc32 (&state->nak_elimination_count);
+			pgm_free_skb (skb);
+			return FALSE;
 		}
-		state->nak_elimination_count++;
-		return FALSE;
-	}
-	else
-	{
-		pgm_assert (((const pgm_list_t*)skb)->next == NULL);
-		pgm_assert (((const pgm_list_t*)skb)->prev == NULL);
+		pkt_cnt_requested = (pkt_cnt_requested + 1) & PGM_TXW_PKT_CNT_REQUESTED;
+		if (pgm_atomic_compare_and_exchange32 (&state->retransmit, PGM_TXW_WAITING_RETRANSMIT | pkt_cnt_requested, retransmit))
+			break;
 	}
 
 /* new request */
-	state->pkt_cnt_requested++;
-	pgm_queue_push_head_link (&window->retransmit_queue, (pgm_list_t*)skb);
-	pgm_assert (!pgm_queue_is_empty (&window->retransmit_queue));
-	state->waiting_retransmit = 1;
-	return TRUE;
+	return pgm_txw_retransmit_enqueue (window, skb);
 }
 
 static
@@ -506,38 +809,233 @@ pgm_txw_retransmit_push_selective (
 	)
 {
 	struct pgm_sk_buff_t	*skb;
-	pgm_txw_state_t		*state;
 
 /* pre-conditions */
 	pgm_assert (NULL != window);
 
-	skb = _pgm_txw_peek (window, sequence);
+	skb = pgm_txw_get_repair (window, sequence);
 	if (NULL == skb) {
 		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Requested packet #%" PRIu32 " not in window."), sequence);
 		return FALSE;
 	}
+	return pgm_txw_retransmit_mark_selective (window, skb);
+}
+
+/* reference the packet of a sequence from the window, or read it back from the
+ * store when older than the window.  the caller frees the skbuff.
+ *
+ * returns skbuff, or NULL if not retained.
+ */
+
+PGM_GNUC_INTERNAL
+struct pgm_sk_buff_t*
+pgm_txw_get_repair (
+	pgm_txw_t* const	window,
+	const uint32_t		sequence
+	)
+{
+	struct pgm_sk_buff_t	*skb;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+
+	skb = _pgm_txw_get (window, sequence);
+	if (NULL == skb && NULL != window->store)
+		skb = pgm_txw_store_get (window, sequence);
+	return skb;
+}
+
+/* Selective requests for the run of sequence numbers [first, first + count), each
+ * batch of entries is referenced under a single peek_active section.
+ *
+ * returns count of requests added to queue.
+ */
+
+PGM_GNUC_INTERNAL
+unsigned
+pgm_txw_retransmit_push_range (
+	pgm_txw_t* const	window,
+	const uint32_t		first,
+	const uint32_t		count
+	)
+{
+	struct pgm_sk_buff_t* skbv[ PGM_TXW_RANGE_BATCH ];
+	unsigned pushed = 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+
+	pgm_debug ("retransmit_push_range (window:%p first:%" PRIu32 " count:%" PRIu32 ")",
+		(const void*)window, first, count);
+
+	if (pgm_txw_is_empty (window) && NULL == window->store)
+		return 0;
+
+	for (uint32_t offset = 0; offset < count; )
+	{
+		const unsigned batch = (unsigned)MIN(count - offset, PGM_TXW_RANGE_BATCH);
+		unsigned skbc = 0, i = 0;
+/* older than the window, read back from the store outside of the peek section */
+		if (NULL != window->store) {
+			const uint32_t trail = pgm_txw_trail_atomic (window);
+			for (; i < batch && pgm_uint32_lt (first + offset + i, trail); i++) {
+				struct pgm_sk_buff_t* skb = pgm_txw_store_get (window, first + offset + i);
+				if (NULL != skb)
+					skbv[ skbc++ ] = skb;
+			}
+		}
+		pgm_atomic_inc32 (&window->peek_active);
+		for (; i < batch; i++) {
+			struct pgm_sk_buff_t* skb = _pgm_txw_peek (window, first + offset + i);
+			if (NULL != skb)
+				skbv[ skbc++ ] = pgm_skb_get (skb);
+		}
+		pgm_atomic_dec32 (&window->peek_active);
+		if (skbc < batch)
+			pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Requested %u packets from #%" PRIu32 " not in window."),
+				batch - skbc, first + offset);
+		for (i = 0; i < skbc; i++)
+			if (pgm_txw_retransmit_mark_selective (window, skbv[ i ]))
+				pushed++;
+		offset += batch;
+	}
+	return pushed;
+}
+
+/* read back an entry older than the window from the store, the skbuff is owned by
+ * the caller and is not shared with later requests of the same sequence.
+ *
+ * returns skbuff, or NULL if not retained.
+ */
+
+static
+struct pgm_sk_buff_t*
+pgm_txw_store_get (
+	pgm_txw_t* const	window,
+	const uint32_t		sequence
+	)
+{
+	struct pgm_sk_buff_t* skb;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (NULL != window->store);
+
+	skb = pgm_txw_store_load (window->store, sequence);
+	if (NULL == skb)
+		return NULL;
+	pgm_assert (pgm_skb_is_valid (skb));
+/* payload checksum for a header summed again */
+	if (0 == skb->pgm_header->pgm_checksum)
+		pgm_txw_set_unfolded_checksum (skb, pgm_csum_partial (skb->data, (uint16_t)skb->len, 0));
+	return skb;
+}
+
+/* move a referenced skbuff to waiting retransmit unless already waiting, the
+ * reference is consumed.
+ */
+
+static
+bool
+pgm_txw_retransmit_mark_selective (
+	pgm_txw_t*	      const restrict window,
+	struct pgm_sk_buff_t* const restrict skb
+	)
+{
+	pgm_txw_state_t		*state;
+	uint32_t		 retransmit;
 
 	pgm_assert (pgm_skb_is_valid (skb));
 	pgm_assert (pgm_tsi_is_null (&skb->tsi));
 	state = (pgm_txw_state_t*)&skb->cb;
 
-/* check if request can be eliminated */
-	if (state->waiting_retransmit) {
-		pgm_assert (!pgm_queue_is_empty (&window->retransmit_queue));
-		state->nak_elimination_count++;
-		return FALSE;
-	}
+	do {
+		retransmit = pgm_atomic_read32 (&state->retransmit);
 
-	pgm_assert (((const pgm_list_t*)skb)->next == NULL);
-	pgm_assert (((const pgm_list_t*)skb)->prev == NULL);
+/* check if request can be eliminated */
+		if (retransmit & PGM_TXW_WAITING_RETRANSMIT) {
+			pgm_atomic_inc32 (&state->nak_elimination_count);
+			pgm_free_skb (skb);
+			return FALSE;
+		}
+	} while (!pgm_atomic_compare_and_exchange32 (&state->retransmit, retransmit | PGM_TXW_WAITING_RETRANSMIT, retransmit));
 
 /* new request */
-	pgm_queue_push_head_link (&window->retransmit_queue, (pgm_list_t*)skb);
-	pgm_assert (!pgm_queue_is_empty (&window->retransmit_queue));
-	state->waiting_retransmit = 1;
+	return pgm_txw_retransmit_enqueue (window, skb);
+}
+
+/* publish a referenced skbuff to the repair path, any number of NAK paths may call
+ * concurrently.  the winner of the cell position writes the skbuff and then bumps the
+ * stamp, the RMW ordering the pointer store before the publication.
+ *
+ * returns FALSE if the request ring is full, returns TRUE if queued.
+ */
+
+static
+bool
+pgm_txw_retransmit_enqueue (
+	pgm_txw_t*	      const restrict window,
+	struct pgm_sk_buff_t* const restrict skb
+	)
+{
+	struct pgm_txw_request_t* cell;
+	uint32_t head;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (NULL != skb);
+
+	head = pgm_atomic_read32 (&window->request_head);
+	for (;;)
+	{
+		cell = &window->request[head & window->request_mask];
+		const int32_t dif = (int32_t)(pgm_atomic_read32 (&cell->stamp) - head);
+		if (0 == dif) {
+			if (pgm_atomic_compare_and_exchange32 (&window->request_head, head + 1, head))
+				break;
+		} else if (dif < 0) {
+/* ring full, back out the waiting state, receivers repeat the NAK on NCF timeout */
+			pgm_txw_state_t*const state = (pgm_txw_state_t*const)&skb->cb;
+			uint32_t retransmit;
+			do {
+				retransmit = pgm_atomic_read32 (&state->retransmit);
+			} while (!pgm_atomic_compare_and_exchange32 (&state->retransmit, retransmit & ~PGM_TXW_WAITING_RETRANSMIT, retransmit));
+			pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Retransmit request ring full for #%" PRIu32 "."), skb->sequence);
+			pgm_free_skb (skb);
+			return FALSE;
+		}
+		head = pgm_atomic_read32 (&window->request_head);
+	}
+
+	cell->skb = skb;
+	pgm_atomic_inc32 (&cell->stamp);
 	return TRUE;
 }
 
+/* move published requests to the retransmit queue, consumer only.  the cell is returned
+ * to producers one lap ahead.
+ */
+
+static
+void
+pgm_txw_retransmit_drain (
+	pgm_txw_t* const	window
+	)
+{
+	for (;;)
+	{
+		struct pgm_txw_request_t*const cell = &window->request[window->request_tail & window->request_mask];
+		if (pgm_atomic_read32 (&cell->stamp) != window->request_tail + 1)
+			break;
+		struct pgm_sk_buff_t*const skb = cell->skb;
+		pgm_assert (((const pgm_list_t*)skb)->next == NULL);
+		pgm_assert (((const pgm_list_t*)skb)->prev == NULL);
+		pgm_queue_push_head_link (&window->retransmit_queue, (pgm_list_t*)skb);
+		pgm_atomic_add32 (&cell->stamp, window->request_mask);
+		window->request_tail++;
+	}
+}
+
 /* try to peek a request from the retransmit queue
  *
  * return pointer of first skb in queue, or return NULL if the queue is empty.
@@ -551,49 +1049,154 @@ pgm_txw_retransmit_try_peek (
 {
 	struct pgm_sk_buff_t	 *skb;
 	pgm_txw_state_t		 *state;
-	bool			  is_var_pktlen = FALSE;
-	bool			  is_op_encoded = FALSE;
-	uint16_t		  parity_length = 0;
-	const pgm_gf8_t		**src;
-	void			 *data;
+	struct pgm_sk_buff_t	**odata;
 
 /* pre-conditions */
 	pgm_assert (NULL != window);
 
-	src = pgm_newa (const pgm_gf8_t*, window->rs.k);
+	odata = pgm_newa (struct pgm_sk_buff_t*, window->rs.k);
 
 	pgm_debug ("retransmit_try_peek (window:%p)", (const void*)window);
 
-/* no lock required to detect presence of a request */
-	skb = (struct pgm_sk_buff_t*)pgm_queue_peek_tail_link (&window->retransmit_queue);
-	if (PGM_UNLIKELY(NULL == skb)) {
-		pgm_debug ("retransmit queue empty on peek.");
-		return NULL;
+	pgm_txw_retransmit_drain (window);
+
+/* discard requests for packets evicted since being queued */
+	for (;;)
+	{
+		skb = (struct pgm_sk_buff_t*)pgm_queue_peek_tail_link (&window->retransmit_queue);
+		if (PGM_UNLIKELY(NULL == skb)) {
+			pgm_debug ("retransmit queue empty on peek.");
+			return NULL;
+		}
+		if (PGM_LIKELY(pgm_uint32_gte (skb->sequence, pgm_txw_repair_trail (window))))
+			break;
+		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Retransmit sqn #%" PRIu32 " no longer in window."), skb->sequence);
+		pgm_txw_retransmit_pop (window);
 	}
 
 	pgm_assert (pgm_skb_is_valid (skb));
 	state = (pgm_txw_state_t*)&skb->cb;
 
-	if (!state->waiting_retransmit) {
-		pgm_assert (((const pgm_list_t*)skb)->next == NULL);
-		pgm_assert (((const pgm_list_t*)skb)->prev == NULL);
-	}
-/* packet payload still in transit */
-	if (PGM_UNLIKELY(1 != pgm_atomic_read32 (&skb->users))) {
+/* packet payload still in transit, references beyond window and retransmit queue */
+	if (PGM_UNLIKELY(2 < pgm_atomic_read32 (&skb->users))) {
 		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Retransmit sqn #%" PRIu32 " is still in transit in transmit thread."), skb->sequence);
 		return NULL;
 	}
-	if (!state->pkt_cnt_requested) {
+	if (!(pgm_atomic_read32 (&state->retransmit) & PGM_TXW_PKT_CNT_REQUESTED)) {
 		return skb;
 	}
 
-/* generate parity packet to satisify request */	
-	const uint8_t rs_h = state->pkt_cnt_sent % (window->rs.n - window->rs.k);
+/* generate parity packet to satisify request, the parity index is carried in
+ * the low bits of the sequence number and must not collide with the range
+ * reserved for the FEC worker.
+ */
+	const uint8_t rs_max = MIN(window->rs.k, window->rs.n - window->rs.k);
+	const uint8_t rs_ondemand = (NULL != window->parity && window->parity->rs_h > 0) ? window->parity->rs_h : rs_max;
+	const uint8_t rs_h = state->pkt_cnt_sent % rs_ondemand;
 	const uint32_t tg_sqn_mask = 0xffffffff << window->tg_sqn_shift;
 	const uint32_t tg_sqn = skb->sequence & tg_sqn_mask;
 	for (uint_fast8_t i = 0; i < window->rs.k; i++)
 	{
-		const struct pgm_sk_buff_t* odata_skb = pgm_txw_peek (window, tg_sqn + i);
+		odata[i] = _pgm_txw_get (window, tg_sqn + i);
+		if (PGM_UNLIKELY(NULL == odata[i])) {
+/* transmission group partially evicted */
+			pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Transmission group #%" PRIu32 " no longer in window."), tg_sqn);
+			while (i--)
+				pgm_free_skb (odata[i]);
+			pgm_txw_retransmit_pop (window);
+			return NULL;
+		}
+	}
+	skb = window->parity_buffer;
+	pgm_txw_encode_parity (window, odata, tg_sqn, rs_h, skb);
+	for (uint_fast8_t i = 0; i < window->rs.k; i++)
+		pgm_free_skb (odata[i]);
+	return skb;
+}
+
+/* try to peek a run of selective requests from the retransmit queue, stopping at the first
+ * request for parity or a packet still in transit.  requests stay queued and are removed with
+ * pgm_txw_retransmit_remove_head() once sent, in order.
+ *
+ * returns count of skbs stored in skbv, zero if the head request cannot be batched.
+ */
+
+PGM_GNUC_INTERNAL
+unsigned
+pgm_txw_retransmit_try_peekv (
+	pgm_txw_t*	      const restrict window,
+	struct pgm_sk_buff_t**const restrict skbv,
+	const unsigned			     count
+	)
+{
+	unsigned n = 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (NULL != skbv);
+	pgm_assert (count > 0);
+
+	pgm_debug ("retransmit_try_peekv (window:%p skbv:%p count:%u)",
+		(const void*)window, (const void*)skbv, count);
+
+	pgm_txw_retransmit_drain (window);
+
+/* discard requests for packets evicted since being queued */
+	const uint32_t trail = pgm_txw_repair_trail (window);
+	for (;;)
+	{
+		const struct pgm_sk_buff_t*const skb = (const struct pgm_sk_buff_t*)pgm_queue_peek_tail_link (&window->retransmit_queue);
+		if (NULL == skb)
+			return 0;
+		if (PGM_LIKELY(pgm_uint32_gte (skb->sequence, trail)))
+			break;
+		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Retransmit sqn #%" PRIu32 " no longer in window."), skb->sequence);
+		pgm_txw_retransmit_pop (window);
+	}
+
+	for (pgm_list_t* link = pgm_queue_peek_tail_link (&window->retransmit_queue);
+	     NULL != link && n < count;
+	     link = link->prev)
+	{
+		struct pgm_sk_buff_t*const skb = (struct pgm_sk_buff_t*)link;
+		const pgm_txw_state_t*const state = (const pgm_txw_state_t*)&skb->cb;
+		pgm_assert (pgm_skb_is_valid (skb));
+		if (!pgm_uint32_gte (skb->sequence, trail) ||
+		    2 < pgm_atomic_read32 (&skb->users) ||
+		    pgm_atomic_read32 (&state->retransmit) & PGM_TXW_PKT_CNT_REQUESTED)
+			break;
+		skbv[ n++ ] = skb;
+	}
+	return n;
+}
+
+/* encode parity packet rs_h of transmission group tg_sqn into skb from references to
+ * the k original data packets, the PGM header is completed by send_rdata().
+ */
+
+static
+void
+pgm_txw_encode_parity (
+	pgm_txw_t*	      const restrict window,
+	struct pgm_sk_buff_t**const restrict odata,	/* length rs_t::k */
+	const uint32_t			     tg_sqn,
+	const uint8_t			     rs_h,
+	struct pgm_sk_buff_t* const restrict skb
+	)
+{
+	bool			  is_var_pktlen = FALSE;
+	bool			  is_op_encoded = FALSE;
+	uint16_t		  parity_length = 0;
+	const pgm_gf8_t		**src;
+	uint16_t		 *lens;
+	void			 *data;
+
+	src  = pgm_newa (const pgm_gf8_t*, window->rs.k);
+	lens = pgm_newa (uint16_t, window->rs.k);
+
+	for (uint_fast8_t i = 0; i < window->rs.k; i++)
+	{
+		const struct pgm_sk_buff_t* odata_skb = odata[i];
 		const uint16_t odata_tsdu_length = pgm_ntohs (odata_skb->pgm_header->pgm_tsdu_length);
 		if (!parity_length)
 		{
@@ -607,13 +1210,13 @@ pgm_txw_retransmit_try_peek (
 		}
 
 		src[i] = odata_skb->data;
+		lens[i] = odata_tsdu_length;
 		if (odata_skb->pgm_header->pgm_options & PGM_OPT_PRESENT) {
 			is_op_encoded = TRUE;
 		}
 	}
 
 /* construct basic PGM header to be completed by send_rdata() */
-	skb = window->parity_buffer;
 	skb->data = skb->tail = skb->head = skb + 1;
 
 /* space for PGM header */
@@ -624,27 +1227,14 @@ pgm_txw_retransmit_try_peek (
 	memcpy (skb->pgm_header->pgm_gsi, &window->tsi->gsi, sizeof(pgm_gsi_t));
 	skb->pgm_header->pgm_options = PGM_OPT_PARITY;
 
-/* append actual TSDU length if variable length packets, zero pad as necessary.
+/* append actual TSDU length if variable length packets, the original data is
+ * not padded but encoded as zero to the longest TSDU of the group.
  */
+	const uint16_t max_tsdu_length = parity_length;
 	if (is_var_pktlen)
 	{
 		skb->pgm_header->pgm_options |= PGM_OPT_VAR_PKTLEN;
-
-		for (uint_fast8_t i = 0; i < window->rs.k; i++)
-		{
-			struct pgm_sk_buff_t* odata_skb = pgm_txw_peek (window, tg_sqn + i);
-			const uint16_t odata_tsdu_length = pgm_ntohs (odata_skb->pgm_header->pgm_tsdu_length);
-
-			pgm_assert (odata_tsdu_length == odata_skb->len);
-			pgm_assert (parity_length >= odata_tsdu_length);
-
-			if (!odata_skb->zero_padded) {
-				memset (odata_skb->tail, 0, parity_length - odata_tsdu_length);
-				*(uint16_t*)((char*)odata_skb->data + parity_length) = odata_tsdu_length;
-				odata_skb->zero_padded = 1;
-			}
-		}
-		parity_length += 2;
+		parity_length += sizeof(uint16_t);
 	}
 
 	skb->pgm_header->pgm_tsdu_length = pgm_htons (parity_length);
@@ -681,13 +1271,14 @@ pgm_txw_retransmit_try_peek (
 
 		for (uint_fast8_t i = 0; i < window->rs.k; i++)
 		{
-			const struct pgm_sk_buff_t* odata_skb = pgm_txw_peek (window, tg_sqn + i);
+			const struct pgm_sk_buff_t* odata_skb = odata[i];
 
-			if (odata_skb->pgm_opt_fragment)
+/* single fragment APDUs are read as unfragmented by receivers */
+			if (odata_skb->pgm_opt_fragment &&
+			    pgm_ntohl (odata_skb->of_apdu_len) != odata_skb->len)
 			{
 				pgm_assert (odata_skb->pgm_header->pgm_options & PGM_OPT_PRESENT);
-/* skip three bytes of header */
-				opt_src[i] = (pgm_gf8_t*)((char*)odata_skb->pgm_opt_fragment + sizeof (struct pgm_opt_header));
+				opt_src[i] = (pgm_gf8_t*)odata_skb->pgm_opt_fragment;
 			}
 			else
 			{
@@ -721,22 +1312,119 @@ pgm_txw_retransmit_try_peek (
 		pgm_rs_encode (&window->rs,
 				opt_src,
 				window->rs.k + rs_h,
-				(pgm_gf8_t*)((char*)opt_fragment + sizeof(struct pgm_opt_header)),
-				sizeof(struct pgm_opt_fragment) - sizeof(struct pgm_opt_header));
+				(pgm_gf8_t*)opt_fragment,
+				sizeof(struct pgm_opt_fragment));
 
 		data = opt_fragment + 1;
 	}
 
+/* encode payload with its partial checksum, the payload runs to skb::tail */
+	pgm_assert ((char*)data + parity_length == (char*)skb->tail);
+	uint32_t csum = pgm_rs_encode_csum (&window->rs,
+					    src,
+					    is_var_pktlen ? lens : NULL,
+					    window->rs.k + rs_h,
+					    data,
+					    max_tsdu_length);
+
+/* encode the TSDU lengths that follow the virtual zero padding */
+	if (is_var_pktlen)
+	{
+		const pgm_gf8_t** len_src = pgm_newa (const pgm_gf8_t*, window->rs.k);
+		pgm_gf8_t* len_dst = (pgm_gf8_t*)data + max_tsdu_length;
+		for (uint_fast8_t i = 0; i < window->rs.k; i++)
+			len_src[i] = (const pgm_gf8_t*)&lens[i];
+		pgm_rs_encode (&window->rs,
+				len_src,
+				window->rs.k + rs_h,
+				len_dst,
+				sizeof(uint16_t));
+		csum = pgm_csum_block_add (csum, pgm_csum_partial (len_dst, sizeof(uint16_t), 0), max_tsdu_length);
+	}
+	pgm_txw_set_unfolded_checksum (skb, csum);
+}
+
+/* encode a sliding window repair of the count packets ending at sequence lead, clipped
+ * at the trailing edge, with coefficients of key.  source API only, the producer owns
+ * every entry in the window.
+ *
+ * returns new skbuff to be completed by send_rdata(), or NULL if lead is not in the window.
+ */
+
+PGM_GNUC_INTERNAL
+struct pgm_sk_buff_t*
+pgm_txw_sw_encode (
+	pgm_txw_t* const	window,
+	const uint32_t		lead,		/* last covered packet */
+	const uint8_t		count,
+	const uint16_t		key
+	)
+{
+	struct pgm_sk_buff_t	 *skb, *odata_skb;
+	struct pgm_opt_length	 *opt_len;
+	struct pgm_opt_header	 *opt_header;
+	struct pgm_opt_sw_repair *opt_sw_repair;
+	pgm_gf8_t		 *data;
+	uint32_t		  first_sqn;
+	uint16_t		  max_length = 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert_cmpuint (count, >, 0);
+	pgm_assert_cmpuint (count, <=, PGM_RLC_MAX_WINDOW);
+
+	if (NULL == _pgm_txw_peek (window, lead))
+		return NULL;
+	first_sqn = lead - count + 1;
+	if (pgm_uint32_lt (first_sqn, window->trail))
+		first_sqn = window->trail;
+	const uint8_t n = (uint8_t)(lead - first_sqn + 1);
+
+	for (uint_fast8_t i = 0; i < n; i++) {
+		odata_skb = _pgm_txw_peek (window, first_sqn + i);
+		if (odata_skb->len > max_length)
+			max_length = odata_skb->len;
+	}
+
+	const uint16_t opt_total_length = sizeof(struct pgm_opt_length) +
+					  sizeof(struct pgm_opt_header) +
+					  sizeof(struct pgm_opt_sw_repair);
+	const uint16_t repair_length = PGM_RLC_SYMBOL_HEADER + max_length;
+
+	skb = pgm_alloc_skb (window->max_tpdu);
+	pgm_skb_put (skb, sizeof(struct pgm_header) + sizeof(struct pgm_data) + opt_total_length + repair_length);
+
+/* construct basic PGM header to be completed by send_rdata() */
+	skb->pgm_header		= skb->data;
+	skb->pgm_data		= (void*)( skb->pgm_header + 1 );
+	memcpy (skb->pgm_header->pgm_gsi, &window->tsi->gsi, sizeof(pgm_gsi_t));
+	skb->pgm_header->pgm_options	 = PGM_OPT_PRESENT;
+	skb->pgm_header->pgm_tsdu_length = pgm_htons (repair_length);
+	skb->pgm_data->data_sqn		 = pgm_htonl (lead);
+
+	opt_len				= (void*)( skb->pgm_data + 1 );
+	opt_len->opt_type		= PGM_OPT_LENGTH;
+	opt_len->opt_length		= sizeof(struct pgm_opt_length);
+	opt_len->opt_total_length	= pgm_htons (opt_total_length);
+	opt_header			= (struct pgm_opt_header*)(opt_len + 1);
+	opt_header->opt_type		= PGM_OPT_SW_REPAIR | PGM_OPT_END;
+	opt_header->opt_length		= sizeof(struct pgm_opt_header) + sizeof(struct pgm_opt_sw_repair);
+	opt_header->opt_reserved	= 0;
+	opt_sw_repair			= (struct pgm_opt_sw_repair*)(opt_header + 1);
+	opt_sw_repair->opt_reserved	= 0;
+	opt_sw_repair->sw_repair_count	= n;
+	opt_sw_repair->sw_repair_key	= pgm_htons (key);
+
 /* encode payload */
-	pgm_rs_encode (&window->rs,
-			src,
-			window->rs.k + rs_h,
-			data,
-			parity_length);
+	data = (pgm_gf8_t*)(opt_sw_repair + 1);
+	memset (data, 0, repair_length);
+	for (uint_fast8_t i = 0; i < n; i++) {
+		odata_skb = _pgm_txw_peek (window, first_sqn + i);
+		pgm_rlc_encode (data, pgm_rlc_coefficient (key, first_sqn + i), odata_skb);
+	}
 
 /* calculate partial checksum */
-	const uint16_t tsdu_length = pgm_ntohs (skb->pgm_header->pgm_tsdu_length);
-	state->unfolded_checksum = pgm_csum_partial ((char*)skb->tail - tsdu_length, tsdu_length, 0);
+	pgm_txw_set_unfolded_checksum (skb, pgm_csum_partial (data, repair_length, 0));
 	return skb;
 }
 
@@ -763,26 +1451,297 @@ pgm_txw_retransmit_remove_head (
 	pgm_assert (pgm_skb_is_valid (skb));
 	pgm_assert (pgm_tsi_is_null (&skb->tsi));
 	state = (pgm_txw_state_t*)&skb->cb;
-	if (!state->waiting_retransmit)
-	{
-		pgm_assert (((const pgm_list_t*)skb)->next == NULL);
-		pgm_assert (((const pgm_list_t*)skb)->prev == NULL);
-	}
-	if (state->pkt_cnt_requested)
+	const uint32_t retransmit = pgm_atomic_read32 (&state->retransmit);
+	pgm_assert (retransmit & PGM_TXW_WAITING_RETRANSMIT);
+	if (retransmit & PGM_TXW_PKT_CNT_REQUESTED)
 	{
 		state->pkt_cnt_sent++;
 
-/* remove if all requested parity packets have been sent */
-		if (state->pkt_cnt_sent == state->pkt_cnt_requested) {
+/* remove if all requested parity packets have been sent, a NAK raising the count
+ * meanwhile fails the exchange and keeps the request queued.
+ */
+		if (state->pkt_cnt_sent == (uint8_t)(retransmit & PGM_TXW_PKT_CNT_REQUESTED) &&
+		    pgm_atomic_compare_and_exchange32 (&state->retransmit, retransmit & ~PGM_TXW_WAITING_RETRANSMIT, retransmit))
+		{
 			pgm_queue_pop_tail_link (&window->retransmit_queue);
-			state->waiting_retransmit = 0;
+			pgm_free_skb (skb);
 		}
 	}
 	else	/* selective request */
 	{
-		pgm_queue_pop_tail_link (&window->retransmit_queue);
-		state->waiting_retransmit = 0;
+		pgm_txw_retransmit_pop (window);
+	}
+}
+
+/* remove head entry from retransmit queue, re-enabling NAK processing
+ * for the entry and releasing the queue reference.
+ */
+
+static
+void
+pgm_txw_retransmit_pop (
+	pgm_txw_t* const	window
+	)
+{
+	struct pgm_sk_buff_t* skb = (struct pgm_sk_buff_t*)pgm_queue_pop_tail_link (&window->retransmit_queue);
+	pgm_txw_state_t* state = (pgm_txw_state_t*)&skb->cb;
+	uint32_t retransmit;
+	do {
+		retransmit = pgm_atomic_read32 (&state->retransmit);
+	} while (!pgm_atomic_compare_and_exchange32 (&state->retransmit, retransmit & ~PGM_TXW_WAITING_RETRANSMIT, retransmit));
+	pgm_free_skb (skb);
+}
+
+/* FEC worker thread: encode the proactive parity of each queued transmission group
+ * into fresh skbuffs, publish to the ready queue and wake the repair path.
+ */
+
+static
+#ifndef _WIN32
+void*
+#else
+unsigned
+__stdcall
+#endif
+pgm_txw_parity_routine (
+	void*			arg
+	)
+{
+	struct pgm_txw_parity_t* parity = (struct pgm_txw_parity_t*)arg;
+	pgm_txw_t* window = parity->window;
+#ifndef _MSC_VER
+	struct pgm_sk_buff_t* skbs[ parity->h ];
+#else
+	struct pgm_sk_buff_t** skbs = pgm_newa (struct pgm_sk_buff_t*, parity->h);
+#endif
+
+	pgm_affinity_apply (PGM_THREAD_FEC);
+
+	pgm_mutex_lock (&parity->mutex);
+	for (;;)
+	{
+		while (!parity->is_shutdown && pgm_queue_is_empty (&parity->jobs))
+#ifndef _WIN32
+			pgm_cond_wait (&parity->cond, &parity->mutex.pthread_mutex);
+#else
+			pgm_cond_wait (&parity->cond, &parity->mutex.win32_crit);
+#endif
+		if (parity->is_shutdown)
+			break;
+		struct pgm_txw_parity_job_t* job = (struct pgm_txw_parity_job_t*)pgm_queue_pop_tail_link (&parity->jobs);
+		pgm_mutex_unlock (&parity->mutex);
+
+		for (uint_fast8_t i = 0; i < parity->h; i++) {
+			skbs[i] = pgm_alloc_skb_subsys (window->max_tpdu, PGM_MEM_SUBSYS_FEC);
+			pgm_txw_encode_parity (window, job->odata, job->tg_sqn, parity->rs_h + i, skbs[i]);
+		}
+		for (uint_fast8_t i = 0; i < window->rs.k; i++)
+			pgm_free_skb (job->odata[i]);
+		pgm_free (job);
+
+		pgm_mutex_lock (&parity->mutex);
+		for (uint_fast8_t i = 0; i < parity->h; i++)
+			pgm_queue_push_head_link (&parity->ready, (pgm_list_t*)skbs[i]);
+		pgm_atomic_add32 (&parity->ready_len, parity->h);
+		pgm_notify_send (parity->notify);
+	}
+	pgm_mutex_unlock (&parity->mutex);
+	return 0;
+}
+
+/* start a FEC worker thread encoding h proactive parity packets per transmission group
+ * queued with pgm_txw_parity_submit(), notify is sent as parity becomes ready to send.
+ * parity indexes are taken from the top of the range so repair path parity, which counts
+ * up from zero, starts distinct.
+ *
+ * returns TRUE on success, returns FALSE if the thread cannot be created.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_txw_parity_start (
+	pgm_txw_t*    const restrict window,
+	const uint8_t		     h,
+	pgm_notify_t* const restrict notify
+	)
+{
+	struct pgm_txw_parity_t* parity;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (window->is_fec_enabled);
+	pgm_assert (NULL == window->parity);
+	pgm_assert (NULL != notify);
+	pgm_assert_cmpuint (h, >, 0);
+
+/* parity index is carried in the low bits of the sequence number */
+	const uint8_t rs_tgs = window->rs.n - window->rs.k;
+	const uint8_t rs_max = MIN(window->rs.k, rs_tgs);
+
+	parity = pgm_new0_subsys (struct pgm_txw_parity_t, 1, PGM_MEM_SUBSYS_FEC);
+	parity->window	= window;
+	parity->notify	= notify;
+	parity->h	= MIN(h, rs_max);
+	parity->rs_h	= rs_max - parity->h;
+	pgm_mutex_init (&parity->mutex);
+	pgm_cond_init (&parity->cond);
+
+#ifndef _WIN32
+	const int status = pthread_create (&parity->thread, NULL, &pgm_txw_parity_routine, parity);
+	if (0 != status)
+#else
+	parity->thread = (HANDLE)_beginthreadex (NULL, 0, &pgm_txw_parity_routine, parity, 0, NULL);
+	if (0 == parity->thread)
+#endif
+	{
+		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Creating FEC worker thread failed."));
+		pgm_cond_free (&parity->cond);
+		pgm_mutex_free (&parity->mutex);
+		pgm_free (parity);
+		return FALSE;
 	}
+	window->parity = parity;
+	return TRUE;
+}
+
+/* stop the FEC worker and release queued transmission groups and unsent parity.
+ */
+
+static
+void
+pgm_txw_parity_stop (
+	pgm_txw_t* const	window
+	)
+{
+	struct pgm_txw_parity_t* parity = window->parity;
+	pgm_list_t* link;
+
+	pgm_mutex_lock (&parity->mutex);
+	parity->is_shutdown = TRUE;
+	pgm_cond_signal (&parity->cond);
+	pgm_mutex_unlock (&parity->mutex);
+#ifndef _WIN32
+	pthread_join (parity->thread, NULL);
+#else
+	WaitForSingleObject (parity->thread, INFINITE);
+	CloseHandle (parity->thread);
+#endif
+
+	while (NULL != (link = pgm_queue_pop_tail_link (&parity->jobs))) {
+		struct pgm_txw_parity_job_t* job = (struct pgm_txw_parity_job_t*)link;
+		for (uint_fast8_t i = 0; i < window->rs.k; i++)
+			pgm_free_skb (job->odata[i]);
+		pgm_free (job);
+	}
+	while (NULL != (link = pgm_queue_pop_tail_link (&parity->ready)))
+		pgm_free_skb ((struct pgm_sk_buff_t*)link);
+
+	pgm_cond_free (&parity->cond);
+	pgm_mutex_free (&parity->mutex);
+	pgm_free (parity);
+	window->parity = NULL;
+}
+
+/* queue completed transmission group tg_sqn for proactive parity, called by the source API
+ * only.  references are taken to the original data packets, so the group may be evicted
+ * from the window before it is encoded.
+ *
+ * returns TRUE if queued, returns FALSE without a worker, if the group is no longer
+ * complete in the window, or when the worker is backlogged.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_txw_parity_submit (
+	pgm_txw_t* const	window,
+	const uint32_t		tg_sqn
+	)
+{
+	struct pgm_txw_parity_t* parity;
+	struct pgm_txw_parity_job_t* job;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+
+	parity = window->parity;
+	if (NULL == parity)
+		return FALSE;
+
+	job = pgm_malloc0_subsys (sizeof(struct pgm_txw_parity_job_t) + ((window->rs.k - 1) * sizeof(struct pgm_sk_buff_t*)), PGM_MEM_CLASS_GENERAL, PGM_MEM_SUBSYS_FEC);
+	job->tg_sqn = tg_sqn;
+	for (uint_fast8_t i = 0; i < window->rs.k; i++)
+	{
+		job->odata[i] = _pgm_txw_get (window, tg_sqn + i);
+		if (PGM_UNLIKELY(NULL == job->odata[i])) {
+			pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Transmission group #%" PRIu32 " no longer in window."), tg_sqn);
+			while (i--)
+				pgm_free_skb (job->odata[i]);
+			pgm_free (job);
+			return FALSE;
+		}
+	}
+
+	pgm_mutex_lock (&parity->mutex);
+	if (PGM_UNLIKELY(parity->jobs.length >= PGM_TXW_MAX_PARITY_JOBS)) {
+		pgm_mutex_unlock (&parity->mutex);
+		for (uint_fast8_t i = 0; i < window->rs.k; i++)
+			pgm_free_skb (job->odata[i]);
+		pgm_free (job);
+		return FALSE;
+	}
+	pgm_queue_push_head_link (&parity->jobs, &job->link_);
+	pgm_cond_signal (&parity->cond);
+	pgm_mutex_unlock (&parity->mutex);
+	return TRUE;
+}
+
+/* peek the next encoded proactive parity packet, repair path only.  the ready queue
+ * owns the skbuff until pgm_txw_parity_remove_head().
+ *
+ * returns pointer to skbuff, or NULL if none are ready.
+ */
+
+PGM_GNUC_INTERNAL
+struct pgm_sk_buff_t*
+pgm_txw_parity_try_peek (
+	pgm_txw_t* const	window
+	)
+{
+	struct pgm_txw_parity_t* parity;
+	struct pgm_sk_buff_t* skb;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+
+	parity = window->parity;
+	if (NULL == parity || 0 == pgm_atomic_read32 (&parity->ready_len))
+		return NULL;
+	pgm_mutex_lock (&parity->mutex);
+	skb = (struct pgm_sk_buff_t*)pgm_queue_peek_tail_link (&parity->ready);
+	pgm_mutex_unlock (&parity->mutex);
+	return skb;
+}
+
+PGM_GNUC_INTERNAL
+void
+pgm_txw_parity_remove_head (
+	pgm_txw_t* const	window
+	)
+{
+	struct pgm_txw_parity_t* parity;
+	struct pgm_sk_buff_t* skb;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (NULL != window->parity);
+
+	parity = window->parity;
+	pgm_mutex_lock (&parity->mutex);
+	skb = (struct pgm_sk_buff_t*)pgm_queue_pop_tail_link (&parity->ready);
+	pgm_mutex_unlock (&parity->mutex);
+	pgm_assert (NULL != skb);
+	pgm_atomic_dec32 (&parity->ready_len);
+	pgm_free_skb (skb);
 }
 
 /* eof */
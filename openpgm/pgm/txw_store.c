@@ -0,0 +1,785 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * memory-mapped transmit window history.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <errno.h>
+#include <string.h>
+#ifndef _WIN32
+#	include <fcntl.h>
+#	include <signal.h>
+#	include <unistd.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#endif
+#include <impl/i18n.h>
+#include <impl/framework.h>
+
+
+//#define TXW_STORE_DEBUG
+
+/* The store file is a header page then a power of 2 count of fixed size records,
+ * the record of a sequence at its index modulo the count, so the file is appended
+ * in sequence order and indexed by sequence without a separate table.  Every
+ * transmitted data packet is written from the PGM header as sent, repairs beyond
+ * the transmit window are read back from the page cache on demand and the operating
+ * system pages and prefetches as the file is read.
+ *
+ * A record is being rewritten whilst its sequence reads one beyond the sequence the
+ * payload will hold, readers verify the sequence before and after the copy.  The
+ * header lead is published after the record is complete.
+ *
+ * Same-host receivers attach the file read-only and copy records as they are appended,
+ * without locks: the record sequence is read before and after the copy.
+ *
+ * The file survives the process: a source reopening it with the same TSI, TPDU size
+ * and record count resumes the sequence space after the last stored packet and serves
+ * repairs of the earlier session.  Records are not synchronised to disk, a host
+ * failure may lose them.
+ *
+ * The header names the writing process so a standby source attached read-only on the
+ * same host takes over the session, through the same resume, once the writer exits.
+ */
+
+#define TXW_STORE_MAGIC			0x50475357U	/* "PGSW" */
+#define TXW_STORE_VERSION		1
+#define TXW_STORE_HEADER_LEN		4096
+#define TXW_STORE_ALIGN			8
+#define TXW_STORE_ROUND(x)		(((x) + (TXW_STORE_ALIGN - 1)) & ~(size_t)(TXW_STORE_ALIGN - 1))
+/* half the sequence space for serial number arithmetic */
+#define TXW_STORE_MAX_SQNS		(1U << 30)
+
+struct txw_store_header_t {
+	uint32_t		magic;
+	uint32_t		version;
+	uint32_t		sqns;			/* record count, power of 2 */
+	uint16_t		max_tpdu;
+	uint16_t		reserved;
+	pgm_tsi_t		tsi;
+	volatile uint32_t	lead;
+	volatile uint32_t	trail;			/* lead + 1 = empty */
+	volatile uint32_t	spm_sqn;		/* last SPM sent */
+	volatile uint32_t	owner;			/* process id of the writer, 0 = unknown */
+};
+
+struct txw_store_record_t {
+	volatile uint32_t	sequence;		/* sequence + 1 whilst written */
+	uint16_t		len;			/* TPDU bytes */
+	uint16_t		reserved;
+};
+
+PGM_STATIC_ASSERT(sizeof(struct txw_store_header_t) <= TXW_STORE_HEADER_LEN);
+
+struct pgm_txw_store_t {
+	char*				base;
+	size_t				size;
+	struct txw_store_header_t*	header;
+	char*				records;
+	size_t				stride;			/* record and TPDU, aligned */
+	uint32_t			mask;			/* sqns - 1 */
+	uint16_t			max_tpdu;
+#ifdef _WIN32
+	HANDLE				file;
+	HANDLE				mapping;
+#endif
+};
+
+
+/* order record loads against the payload copy of a reader without write access.
+ */
+
+static inline
+void
+txw_store_barrier (void)
+{
+#if defined( __GNUC__ ) && ( __GNUC__ * 100 + __GNUC_MINOR__ >= 401 )
+	__sync_synchronize();
+#elif defined( __sun )
+	membar_consumer();
+#elif defined( _WIN32 )
+	MemoryBarrier();
+#endif
+}
+
+static inline
+struct txw_store_record_t*
+txw_store_record (
+	const struct pgm_txw_store_t*const	store,
+	const uint32_t				sequence
+	)
+{
+	return (struct txw_store_record_t*)(store->records + ((size_t)(sequence & store->mask) * store->stride));
+}
+
+static inline
+bool
+txw_store_is_empty (
+	const struct txw_store_header_t*const	header
+	)
+{
+	return pgm_atomic_read32 (&header->trail) == (uint32_t)(pgm_atomic_read32 (&header->lead) + 1);
+}
+
+/* returns TRUE if the mapped file holds a store of the same session and geometry
+ * with the lead record intact.
+ */
+
+static
+bool
+txw_store_is_valid (
+	const struct pgm_txw_store_t*const restrict	store,
+	const pgm_tsi_t*		 const restrict	tsi,
+	const uint32_t					sqns
+	)
+{
+	const struct txw_store_header_t* header = store->header;
+
+	if (TXW_STORE_MAGIC != header->magic ||
+	    TXW_STORE_VERSION != header->version ||
+	    sqns != header->sqns ||
+	    store->max_tpdu != header->max_tpdu ||
+	    !pgm_tsi_equal (tsi, &header->tsi))
+		return FALSE;
+	if (txw_store_is_empty (header))
+		return TRUE;
+	if ((uint32_t)(header->lead - header->trail) >= sqns)
+		return FALSE;
+	return (header->lead == txw_store_record (store, header->lead)->sequence);
+}
+
+/* open or create the store at path retaining sqns packets of up to max_tpdu bytes,
+ * history is kept if the file was written by the same TSI with the same geometry.
+ *
+ * returns store on success, returns NULL on error with error set.
+ */
+
+PGM_GNUC_INTERNAL
+struct pgm_txw_store_t*
+pgm_txw_store_open (
+	const char*	  restrict	path,
+	const pgm_tsi_t*  restrict	tsi,
+	const uint16_t			max_tpdu,
+	uint32_t			sqns,		/* 0 = default */
+	pgm_error_t**	  restrict	error
+	)
+{
+	struct pgm_txw_store_t* store;
+	void* base;
+
+/* pre-conditions */
+	pgm_assert (NULL != path);
+	pgm_assert (NULL != tsi);
+	pgm_assert_cmpuint (max_tpdu, >, 0);
+
+	if (0 == sqns)
+		sqns = PGM_TXW_STORE_DEFAULT_SQNS;
+	if (sqns > TXW_STORE_MAX_SQNS)
+		sqns = TXW_STORE_MAX_SQNS;
+	sqns = (uint32_t)pgm_nearest_power (1, sqns);
+
+	store = pgm_new0 (struct pgm_txw_store_t, 1);
+	store->max_tpdu	= max_tpdu;
+	store->stride	= TXW_STORE_ROUND(sizeof (struct txw_store_record_t) + max_tpdu);
+	store->mask	= sqns - 1;
+	store->size	= TXW_STORE_HEADER_LEN + ((size_t)sqns * store->stride);
+
+#ifndef _WIN32
+	const int fd = open (path, O_RDWR | O_CREAT, 0644);
+	if (-1 == fd) {
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_errno (save_errno),
+			     _("Opening transmit window store %s: %s"),
+			     path,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		goto err_free;
+	}
+	struct stat st;
+	if (-1 == fstat (fd, &st) ||
+	    ((size_t)st.st_size != store->size && -1 == ftruncate (fd, store->size)))
+	{
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_errno (save_errno),
+			     _("Sizing transmit window store %s: %s"),
+			     path,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		close (fd);
+		goto err_free;
+	}
+	base = mmap (NULL, store->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close (fd);
+	if (MAP_FAILED == base) {
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_errno (save_errno),
+			     _("Mapping transmit window store %s: %s"),
+			     path,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		goto err_free;
+	}
+#else
+	store->file = CreateFileA (path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL,
+				   OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (INVALID_HANDLE_VALUE == store->file) {
+		const DWORD save_errno = GetLastError();
+		char winstr[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_win_errno (save_errno),
+			     _("Opening transmit window store %s: %s"),
+			     path,
+			     pgm_win_strerror (winstr, sizeof (winstr), save_errno));
+		goto err_free;
+	}
+	store->mapping = CreateFileMappingA (store->file, NULL, PAGE_READWRITE,
+					     (DWORD)((uint64_t)store->size >> 32), (DWORD)store->size, NULL);
+	if (NULL == store->mapping) {
+		const DWORD save_errno = GetLastError();
+		char winstr[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_win_errno (save_errno),
+			     _("Creating file mapping %s: %s"),
+			     path,
+			     pgm_win_strerror (winstr, sizeof (winstr), save_errno));
+		CloseHandle (store->file);
+		goto err_free;
+	}
+	base = MapViewOfFile (store->mapping, FILE_MAP_WRITE, 0, 0, store->size);
+	if (NULL == base) {
+		const DWORD save_errno = GetLastError();
+		char winstr[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_win_errno (save_errno),
+			     _("Mapping view of file %s: %s"),
+			     path,
+			     pgm_win_strerror (winstr, sizeof (winstr), save_errno));
+		CloseHandle (store->mapping);
+		CloseHandle (store->file);
+		goto err_free;
+	}
+#endif /* _WIN32 */
+
+	store->base	= base;
+	store->header	= (struct txw_store_header_t*)base;
+	store->records	= (char*)base + TXW_STORE_HEADER_LEN;
+
+	if (!txw_store_is_valid (store, tsi, sqns)) {
+		struct txw_store_header_t* header = store->header;
+		memset (header, 0, TXW_STORE_HEADER_LEN);
+		header->magic	 = TXW_STORE_MAGIC;
+		header->version	 = TXW_STORE_VERSION;
+		header->sqns	 = sqns;
+		header->max_tpdu = max_tpdu;
+		memcpy (&header->tsi, tsi, sizeof (pgm_tsi_t));
+		pgm_txw_store_reset (store);
+	}
+#ifndef _WIN32
+	pgm_atomic_write32 (&store->header->owner, (uint32_t)getpid());
+#else
+	pgm_atomic_write32 (&store->header->owner, (uint32_t)GetCurrentProcessId());
+#endif
+	pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Transmit window store %s of %" PRIu32 " sequences in %" PRIzu " bytes."),
+		path, sqns, store->size);
+	return store;
+
+err_free:
+	pgm_free (store);
+	return NULL;
+}
+
+/* attach read-only to the store at path written by a source on the same host, the
+ * geometry is read from the header.
+ *
+ * returns store on success, returns NULL on error with error set.
+ */
+
+PGM_GNUC_INTERNAL
+struct pgm_txw_store_t*
+pgm_txw_store_attach (
+	const char*	  restrict	path,
+	pgm_error_t**	  restrict	error
+	)
+{
+	struct pgm_txw_store_t* store;
+	const struct txw_store_header_t* header;
+	size_t size;
+	void* base;
+
+/* pre-conditions */
+	pgm_assert (NULL != path);
+
+	store = pgm_new0 (struct pgm_txw_store_t, 1);
+
+#ifndef _WIN32
+	const int fd = open (path, O_RDONLY);
+	if (-1 == fd) {
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_errno (save_errno),
+			     _("Opening transmit window store %s: %s"),
+			     path,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		goto err_free;
+	}
+	struct stat st;
+	if (-1 == fstat (fd, &st)) {
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_errno (save_errno),
+			     _("Sizing transmit window store %s: %s"),
+			     path,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		close (fd);
+		goto err_free;
+	}
+	size = (size_t)st.st_size;
+	if (size < TXW_STORE_HEADER_LEN) {
+		close (fd);
+		goto err_invalid;
+	}
+	base = mmap (NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+	close (fd);
+	if (MAP_FAILED == base) {
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_errno (save_errno),
+			     _("Mapping transmit window store %s: %s"),
+			     path,
+			     pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		goto err_free;
+	}
+#else
+/* the source holds write access */
+	store->file = CreateFileA (path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+				   OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (INVALID_HANDLE_VALUE == store->file) {
+		const DWORD save_errno = GetLastError();
+		char winstr[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_win_errno (save_errno),
+			     _("Opening transmit window store %s: %s"),
+			     path,
+			     pgm_win_strerror (winstr, sizeof (winstr), save_errno));
+		goto err_free;
+	}
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx (store->file, &file_size) ||
+	    file_size.QuadPart < TXW_STORE_HEADER_LEN)
+	{
+		CloseHandle (store->file);
+		goto err_invalid;
+	}
+	size = (size_t)file_size.QuadPart;
+	store->mapping = CreateFileMappingA (store->file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (NULL == store->mapping) {
+		const DWORD save_errno = GetLastError();
+		char winstr[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_win_errno (save_errno),
+			     _("Creating file mapping %s: %s"),
+			     path,
+			     pgm_win_strerror (winstr, sizeof (winstr), save_errno));
+		CloseHandle (store->file);
+		goto err_free;
+	}
+	base = MapViewOfFile (store->mapping, FILE_MAP_READ, 0, 0, size);
+	if (NULL == base) {
+		const DWORD save_errno = GetLastError();
+		char winstr[1024];
+		pgm_set_error (error,
+			     PGM_ERROR_DOMAIN_SOCKET,
+			     pgm_error_from_win_errno (save_errno),
+			     _("Mapping view of file %s: %s"),
+			     path,
+			     pgm_win_strerror (winstr, sizeof (winstr), save_errno));
+		CloseHandle (store->mapping);
+		CloseHandle (store->file);
+		goto err_free;
+	}
+#endif /* _WIN32 */
+
+	store->base	= base;
+	store->size	= size;
+	store->header	= (struct txw_store_header_t*)base;
+	store->records	= (char*)base + TXW_STORE_HEADER_LEN;
+
+	header = store->header;
+	if (TXW_STORE_MAGIC != header->magic ||
+	    TXW_STORE_VERSION != header->version ||
+	    0 == header->sqns ||
+	    0 != (header->sqns & (header->sqns - 1)) ||
+	    header->sqns > TXW_STORE_MAX_SQNS ||
+	    0 == header->max_tpdu)
+	{
+		pgm_txw_store_close (store);
+		store = NULL;
+		goto err_invalid;
+	}
+	store->max_tpdu	= header->max_tpdu;
+	store->stride	= TXW_STORE_ROUND(sizeof (struct txw_store_record_t) + store->max_tpdu);
+	store->mask	= header->sqns - 1;
+	if (size != TXW_STORE_HEADER_LEN + ((size_t)header->sqns * store->stride)) {
+		pgm_txw_store_close (store);
+		store = NULL;
+		goto err_invalid;
+	}
+	pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Attached transmit window store %s of %" PRIu32 " sequences."),
+		path, header->sqns);
+	return store;
+
+err_invalid:
+	pgm_set_error (error,
+		     PGM_ERROR_DOMAIN_SOCKET,
+		     PGM_ERROR_INVAL,
+		     _("Transmit window store %s is not valid."),
+		     path);
+err_free:
+	pgm_free (store);
+	return NULL;
+}
+
+PGM_GNUC_INTERNAL
+void
+pgm_txw_store_close (
+	struct pgm_txw_store_t*		store
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != store);
+
+#ifndef _WIN32
+	munmap (store->base, store->size);
+#else
+	UnmapViewOfFile (store->base);
+	CloseHandle (store->mapping);
+	CloseHandle (store->file);
+#endif
+	pgm_free (store);
+}
+
+/* discard stored history, the sequence space restarts from zero.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_txw_store_reset (
+	struct pgm_txw_store_t*const	store
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != store);
+
+	pgm_atomic_write32 (&store->header->lead, UINT32_MAX);
+	pgm_atomic_write32 (&store->header->trail, 0);
+	pgm_atomic_write32 (&store->header->spm_sqn, 0);
+}
+
+/* returns TRUE with the last stored sequence and SPM sequence number of a previous
+ * session, returns FALSE if the store is empty.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_txw_store_resume (
+	const struct pgm_txw_store_t*const restrict	store,
+	uint32_t*			   restrict	lead,
+	uint32_t*			   restrict	spm_sqn
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != store);
+	pgm_assert (NULL != lead);
+	pgm_assert (NULL != spm_sqn);
+
+	if (txw_store_is_empty (store->header))
+		return FALSE;
+	*lead	 = pgm_atomic_read32 (&store->header->lead);
+	*spm_sqn = pgm_atomic_read32 (&store->header->spm_sqn);
+	return TRUE;
+}
+
+/* append the packet of skb::sequence as sent, from the PGM header to skb::tail.
+ * called by the source API only, sequences are appended in order.
+ *
+ * returns the oldest retained sequence.
+ */
+
+PGM_GNUC_INTERNAL
+uint32_t
+pgm_txw_store_append (
+	struct pgm_txw_store_t*     const restrict store,
+	const struct pgm_sk_buff_t* const restrict skb
+	)
+{
+	struct txw_store_header_t* header;
+	struct txw_store_record_t* record;
+	uint32_t trail;
+
+/* pre-conditions */
+	pgm_assert (NULL != store);
+	pgm_assert (NULL != skb);
+	pgm_assert (NULL != skb->pgm_header);
+
+	const size_t tpdu_length = (const char*)skb->tail - (const char*)skb->pgm_header;
+	pgm_assert_cmpuint (tpdu_length, <=, store->max_tpdu);
+
+	header = store->header;
+	record = txw_store_record (store, skb->sequence);
+
+/* invalidate the record for readers before rewriting, exchange is a full barrier */
+	(void)pgm_atomic_exchange32 (&record->sequence, skb->sequence + 1);
+	memcpy (record + 1, skb->pgm_header, tpdu_length);
+	record->len = (uint16_t)tpdu_length;
+	(void)pgm_atomic_exchange32 (&record->sequence, skb->sequence);
+
+/* a gap in the sequence space restarts the history */
+	trail = pgm_atomic_read32 (&header->trail);
+	if (PGM_UNLIKELY(skb->sequence != (uint32_t)(pgm_atomic_read32 (&header->lead) + 1)))
+		trail = skb->sequence;
+	else if ((uint32_t)(skb->sequence - trail) > store->mask)
+		trail = skb->sequence - store->mask;
+	pgm_atomic_write32 (&header->trail, trail);
+	pgm_atomic_write32 (&header->lead, skb->sequence);
+	return trail;
+}
+
+/* read back a stored packet into a new skbuff, data pointers as the transmit window,
+ * any thread may call concurrently with the source API.
+ *
+ * returns skbuff, or NULL if the sequence is not retained or was overwritten whilst
+ * being read.
+ */
+
+PGM_GNUC_INTERNAL
+struct pgm_sk_buff_t*
+pgm_txw_store_load (
+	struct pgm_txw_store_t*const	store,
+	const uint32_t			sequence
+	)
+{
+	struct txw_store_record_t* record;
+	struct pgm_sk_buff_t* skb;
+
+/* pre-conditions */
+	pgm_assert (NULL != store);
+
+	if (txw_store_is_empty (store->header) ||
+	    !pgm_uint32_gte (sequence, pgm_atomic_read32 (&store->header->trail)) ||
+	    !pgm_uint32_lte (sequence, pgm_atomic_read32 (&store->header->lead)))
+		return NULL;
+
+	record = txw_store_record (store, sequence);
+	if (pgm_atomic_read32 (&record->sequence) != sequence)
+		return NULL;
+	const uint16_t tpdu_length = record->len;
+	if (PGM_UNLIKELY(tpdu_length < sizeof(struct pgm_header) + sizeof(struct pgm_data) ||
+			 tpdu_length > store->max_tpdu))
+		return NULL;
+
+	skb = pgm_alloc_skb (store->max_tpdu);
+	memcpy (skb->head, record + 1, tpdu_length);
+/* exchange as full barrier, a changed sequence is a record overwritten during the copy */
+	if (PGM_UNLIKELY(sequence != pgm_atomic_exchange_and_add32 (&record->sequence, 0))) {
+		pgm_free_skb (skb);
+		return NULL;
+	}
+
+	skb->sequence	= sequence;
+	skb->pgm_header	= skb->head;
+	skb->pgm_data	= (void*)( skb->pgm_header + 1 );
+	const uint16_t tsdu_length = pgm_ntohs (skb->pgm_header->pgm_tsdu_length);
+	if (PGM_UNLIKELY(tsdu_length > tpdu_length - (sizeof(struct pgm_header) + sizeof(struct pgm_data)))) {
+		pgm_free_skb (skb);
+		return NULL;
+	}
+	skb->tail	= (char*)skb->head + tpdu_length;
+	skb->data	= (char*)skb->tail - tsdu_length;
+	skb->len	= tsdu_length;
+	return skb;
+}
+
+/* returns the oldest retained sequence.
+ */
+
+PGM_GNUC_INTERNAL
+uint32_t
+pgm_txw_store_trail (
+	const struct pgm_txw_store_t*const	store
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != store);
+
+	return pgm_atomic_read32 (&store->header->trail);
+}
+
+/* returns TRUE with the oldest and newest stored sequences, returns FALSE if the
+ * store is empty or was recreated by a source of another geometry.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_txw_store_extent (
+	const struct pgm_txw_store_t*const restrict	store,
+	uint32_t*			   restrict	trail,
+	uint32_t*			   restrict	lead
+	)
+{
+	const struct txw_store_header_t* header;
+
+/* pre-conditions */
+	pgm_assert (NULL != store);
+	pgm_assert (NULL != trail);
+	pgm_assert (NULL != lead);
+
+	header = store->header;
+	if (PGM_UNLIKELY(store->mask + 1 != header->sqns ||
+			 store->max_tpdu != header->max_tpdu))
+		return FALSE;
+	*lead	= pgm_atomic_read32 (&header->lead);
+	*trail	= pgm_atomic_read32 (&header->trail);
+	return (*trail != (uint32_t)(*lead + 1));
+}
+
+/* copy the packet of sequence as sent, from the PGM header, into buf of len bytes.
+ * lock-free and without write access to the store.
+ *
+ * returns packet length, or 0 if the sequence is not present, larger than len or
+ * was overwritten whilst being copied.
+ */
+
+PGM_GNUC_INTERNAL
+size_t
+pgm_txw_store_copy (
+	const struct pgm_txw_store_t*const restrict	store,
+	const uint32_t					sequence,
+	void*				   restrict	buf,
+	const size_t					len
+	)
+{
+	const struct txw_store_record_t* record;
+
+/* pre-conditions */
+	pgm_assert (NULL != store);
+	pgm_assert (NULL != buf);
+
+	record = txw_store_record (store, sequence);
+	if (pgm_atomic_read32 (&record->sequence) != sequence)
+		return 0;
+	txw_store_barrier();
+	const uint16_t tpdu_length = record->len;
+	if (PGM_UNLIKELY(tpdu_length < sizeof(struct pgm_header) + sizeof(struct pgm_data) ||
+			 tpdu_length > store->max_tpdu ||
+			 tpdu_length > len))
+		return 0;
+	memcpy (buf, record + 1, tpdu_length);
+	txw_store_barrier();
+	if (PGM_UNLIKELY(pgm_atomic_read32 (&record->sequence) != sequence))
+		return 0;
+	return tpdu_length;
+}
+
+/* record the sequence number of the last SPM sent for a resuming source.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_txw_store_spm (
+	struct pgm_txw_store_t*const	store,
+	const uint32_t			spm_sqn
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != store);
+
+	pgm_atomic_write32 (&store->header->spm_sqn, spm_sqn);
+}
+
+/* read the session and geometry of an attached store.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_txw_store_geometry (
+	const struct pgm_txw_store_t*const restrict	store,
+	pgm_tsi_t*			   restrict	tsi,
+	uint32_t*			   restrict	sqns,
+	uint16_t*			   restrict	max_tpdu
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != store);
+	pgm_assert (NULL != tsi);
+	pgm_assert (NULL != sqns);
+	pgm_assert (NULL != max_tpdu);
+
+	memcpy (tsi, &store->header->tsi, sizeof (pgm_tsi_t));
+	*sqns	  = store->header->sqns;
+	*max_tpdu = store->header->max_tpdu;
+}
+
+/* returns TRUE if the process that last opened the store for writing is running or
+ * is not known, the writer is on the same host.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_txw_store_is_owned (
+	const struct pgm_txw_store_t*const	store
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != store);
+
+	const uint32_t owner = pgm_atomic_read32 (&store->header->owner);
+	if (0 == owner)
+		return TRUE;
+#ifndef _WIN32
+	return !(-1 == kill ((pid_t)owner, 0) && ESRCH == errno);
+#else
+	HANDLE process = OpenProcess (SYNCHRONIZE, FALSE, (DWORD)owner);
+	if (NULL == process)
+		return FALSE;
+	const DWORD status = WaitForSingleObject (process, 0);
+	CloseHandle (process);
+	return (WAIT_TIMEOUT == status);
+#endif
+}
+
+/* eof */
@@ -0,0 +1,447 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * unit tests for memory-mapped transmit window history.
+ *
+ * Copyright (c) 2010 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <check.h>
+
+#include "impl/framework.h"
+
+#ifdef _WIN32
+#	define PGM_CHECK_NOFORK		1
+#endif
+
+
+/* mock state */
+#define TEST_FILE		"txw-store-unittest.dat"
+#define TEST_MAX_TPDU		1500
+
+static const pgm_tsi_t		test_tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+
+#define TXW_STORE_DEBUG
+#include "txw_store.c"
+
+
+/* sent data packet of sequence carrying an 8 byte payload of the sequence */
+static
+struct pgm_sk_buff_t*
+generate_skb (
+	const uint32_t		sequence
+	)
+{
+	const uint16_t header_length = sizeof(struct pgm_header) + sizeof(struct pgm_data);
+	const uint16_t tsdu_length = 8;
+	struct pgm_sk_buff_t* skb = pgm_alloc_skb (TEST_MAX_TPDU);
+	pgm_skb_reserve (skb, header_length);
+	memset (skb->head, 0, header_length);
+	skb->pgm_header = (struct pgm_header*)skb->head;
+	skb->pgm_data   = (struct pgm_data*)(skb->pgm_header + 1);
+	skb->pgm_header->pgm_type = PGM_ODATA;
+	skb->pgm_header->pgm_tsdu_length = g_htons (tsdu_length);
+	skb->pgm_data->data_sqn = g_htonl (sequence);
+	pgm_skb_put (skb, tsdu_length);
+	memset (skb->data, (int)(sequence & 0xff), tsdu_length);
+	skb->sequence = sequence;
+	return skb;
+}
+
+static
+void
+append_range (
+	struct pgm_txw_store_t*	store,
+	const uint32_t		first,
+	const uint32_t		count
+	)
+{
+	for (uint32_t i = 0; i < count; i++) {
+		struct pgm_sk_buff_t* skb = generate_skb (first + i);
+		pgm_txw_store_append (store, skb);
+		pgm_free_skb (skb);
+	}
+}
+
+/* target:
+ *	struct pgm_txw_store_t*
+ *	pgm_txw_store_open (
+ *		const char*		path,
+ *		const pgm_tsi_t*	tsi,
+ *		const uint16_t		max_tpdu,
+ *		uint32_t		sqns,
+ *		pgm_error_t**		error
+ *	)
+ */
+
+START_TEST (test_open_pass_001)
+{
+	pgm_error_t* err = NULL;
+	uint32_t lead, spm_sqn;
+	unlink (TEST_FILE);
+	struct pgm_txw_store_t* store = pgm_txw_store_open (TEST_FILE, &test_tsi, TEST_MAX_TPDU, 0, &err);
+	fail_if (NULL == store, "open failed");
+	fail_unless (PGM_TXW_STORE_DEFAULT_SQNS - 1 == store->mask, "default sqns");
+	fail_unless (FALSE == pgm_txw_store_resume (store, &lead, &spm_sqn), "new store not empty");
+	fail_unless (0 == pgm_txw_store_trail (store), "trail not zero");
+	pgm_txw_store_close (store);
+	unlink (TEST_FILE);
+}
+END_TEST
+
+/* sqns rounded up to a power of 2 */
+START_TEST (test_open_pass_002)
+{
+	pgm_error_t* err = NULL;
+	unlink (TEST_FILE);
+	struct pgm_txw_store_t* store = pgm_txw_store_open (TEST_FILE, &test_tsi, TEST_MAX_TPDU, 100, &err);
+	fail_if (NULL == store, "open failed");
+	fail_unless (127 == store->mask, "sqns not rounded");
+	pgm_txw_store_close (store);
+	unlink (TEST_FILE);
+}
+END_TEST
+
+START_TEST (test_open_fail_001)
+{
+	pgm_error_t* err = NULL;
+	fail_unless (NULL == pgm_txw_store_open ("/nonexistent/txw.dat", &test_tsi, TEST_MAX_TPDU, 0, &err), "open succeeded");
+	fail_if (NULL == err, "error not set");
+	pgm_error_free (err);
+}
+END_TEST
+
+/* target:
+ *	uint32_t
+ *	pgm_txw_store_append (
+ *		struct pgm_txw_store_t*		store,
+ *		const struct pgm_sk_buff_t*	skb
+ *	)
+ *
+ *	struct pgm_sk_buff_t*
+ *	pgm_txw_store_load (
+ *		struct pgm_txw_store_t*		store,
+ *		const uint32_t			sequence
+ *	)
+ */
+
+START_TEST (test_append_pass_001)
+{
+	pgm_error_t* err = NULL;
+	unlink (TEST_FILE);
+	struct pgm_txw_store_t* store = pgm_txw_store_open (TEST_FILE, &test_tsi, TEST_MAX_TPDU, 16, &err);
+	fail_if (NULL == store, "open failed");
+	append_range (store, 0, 4);
+	struct pgm_sk_buff_t* skb = pgm_txw_store_load (store, 2);
+	fail_if (NULL == skb, "load failed");
+	fail_unless (2 == skb->sequence, "sequence");
+	fail_unless (8 == skb->len, "tsdu length");
+	fail_unless ((char*)skb->pgm_header == (char*)skb->head, "pgm header");
+	fail_unless ((char*)skb->data == (char*)(skb->pgm_data + 1), "data offset");
+	fail_unless (2 == g_ntohl (skb->pgm_data->data_sqn), "data_sqn");
+	fail_unless (2 == ((const uint8_t*)skb->data)[7], "payload");
+	pgm_free_skb (skb);
+	fail_unless (NULL == pgm_txw_store_load (store, 4), "load beyond lead");
+	pgm_txw_store_close (store);
+	unlink (TEST_FILE);
+}
+END_TEST
+
+/* wrapping evicts the oldest sequences */
+START_TEST (test_append_pass_002)
+{
+	pgm_error_t* err = NULL;
+	unlink (TEST_FILE);
+	struct pgm_txw_store_t* store = pgm_txw_store_open (TEST_FILE, &test_tsi, TEST_MAX_TPDU, 4, &err);
+	fail_if (NULL == store, "open failed");
+	append_range (store, 0, 10);
+	fail_unless (6 == pgm_txw_store_trail (store), "trail not advanced");
+	fail_unless (NULL == pgm_txw_store_load (store, 5), "evicted sequence loaded");
+	struct pgm_sk_buff_t* skb = pgm_txw_store_load (store, 6);
+	fail_if (NULL == skb, "load failed");
+	fail_unless (6 == ((const uint8_t*)skb->data)[0], "payload");
+	pgm_free_skb (skb);
+	pgm_txw_store_close (store);
+	unlink (TEST_FILE);
+}
+END_TEST
+
+/* a gap in the sequence space restarts the history */
+START_TEST (test_append_pass_003)
+{
+	pgm_error_t* err = NULL;
+	unlink (TEST_FILE);
+	struct pgm_txw_store_t* store = pgm_txw_store_open (TEST_FILE, &test_tsi, TEST_MAX_TPDU, 16, &err);
+	fail_if (NULL == store, "open failed");
+	append_range (store, 0, 4);
+	append_range (store, 100, 1);
+	fail_unless (100 == pgm_txw_store_trail (store), "trail not reset");
+	fail_unless (NULL == pgm_txw_store_load (store, 3), "stale sequence loaded");
+	pgm_txw_store_close (store);
+	unlink (TEST_FILE);
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_txw_store_resume (
+ *		const struct pgm_txw_store_t*	store,
+ *		uint32_t*			lead,
+ *		uint32_t*			spm_sqn
+ *	)
+ */
+
+START_TEST (test_resume_pass_001)
+{
+	pgm_error_t* err = NULL;
+	uint32_t lead, spm_sqn;
+	unlink (TEST_FILE);
+	struct pgm_txw_store_t* store = pgm_txw_store_open (TEST_FILE, &test_tsi, TEST_MAX_TPDU, 16, &err);
+	fail_if (NULL == store, "open failed");
+	append_range (store, 0, 5);
+	pgm_txw_store_spm (store, 42);
+	pgm_txw_store_close (store);
+	store = pgm_txw_store_open (TEST_FILE, &test_tsi, TEST_MAX_TPDU, 16, &err);
+	fail_if (NULL == store, "reopen failed");
+	fail_unless (TRUE == pgm_txw_store_resume (store, &lead, &spm_sqn), "resume failed");
+	fail_unless (4 == lead, "lead");
+	fail_unless (42 == spm_sqn, "spm_sqn");
+	struct pgm_sk_buff_t* skb = pgm_txw_store_load (store, 0);
+	fail_if (NULL == skb, "history lost");
+	pgm_free_skb (skb);
+	pgm_txw_store_close (store);
+	unlink (TEST_FILE);
+}
+END_TEST
+
+/* different session */
+START_TEST (test_resume_fail_001)
+{
+	pgm_error_t* err = NULL;
+	uint32_t lead, spm_sqn;
+	const pgm_tsi_t other_tsi = { { 1, 2, 3, 4, 5, 6 }, 1001 };
+	unlink (TEST_FILE);
+	struct pgm_txw_store_t* store = pgm_txw_store_open (TEST_FILE, &test_tsi, TEST_MAX_TPDU, 16, &err);
+	fail_if (NULL == store, "open failed");
+	append_range (store, 0, 5);
+	pgm_txw_store_close (store);
+	store = pgm_txw_store_open (TEST_FILE, &other_tsi, TEST_MAX_TPDU, 16, &err);
+	fail_if (NULL == store, "reopen failed");
+	fail_unless (FALSE == pgm_txw_store_resume (store, &lead, &spm_sqn), "resumed other session");
+	fail_unless (NULL == pgm_txw_store_load (store, 0), "loaded other session");
+	pgm_txw_store_close (store);
+	unlink (TEST_FILE);
+}
+END_TEST
+
+/* different geometry */
+START_TEST (test_resume_fail_002)
+{
+	pgm_error_t* err = NULL;
+	uint32_t lead, spm_sqn;
+	unlink (TEST_FILE);
+	struct pgm_txw_store_t* store = pgm_txw_store_open (TEST_FILE, &test_tsi, TEST_MAX_TPDU, 16, &err);
+	fail_if (NULL == store, "open failed");
+	append_range (store, 0, 5);
+	pgm_txw_store_close (store);
+	store = pgm_txw_store_open (TEST_FILE, &test_tsi, TEST_MAX_TPDU, 32, &err);
+	fail_if (NULL == store, "reopen failed");
+	fail_unless (FALSE == pgm_txw_store_resume (store, &lead, &spm_sqn), "resumed other geometry");
+	pgm_txw_store_close (store);
+	unlink (TEST_FILE);
+}
+END_TEST
+
+/* target:
+ *	struct pgm_txw_store_t*
+ *	pgm_txw_store_attach (
+ *		const char*		path,
+ *		pgm_error_t**		error
+ *	)
+ *
+ *	size_t
+ *	pgm_txw_store_copy (
+ *		const struct pgm_txw_store_t*	store,
+ *		const uint32_t			sequence,
+ *		void*				buf,
+ *		const size_t			len
+ *	)
+ */
+
+START_TEST (test_attach_pass_001)
+{
+	pgm_error_t* err = NULL;
+	uint32_t trail, lead;
+	char buf[ TEST_MAX_TPDU ];
+	unlink (TEST_FILE);
+	struct pgm_txw_store_t* store = pgm_txw_store_open (TEST_FILE, &test_tsi, TEST_MAX_TPDU, 4, &err);
+	fail_if (NULL == store, "open failed");
+	struct pgm_txw_store_t* reader = pgm_txw_store_attach (TEST_FILE, &err);
+	fail_if (NULL == reader, "attach failed");
+	fail_unless (3 == reader->mask, "geometry");
+	fail_unless (FALSE == pgm_txw_store_extent (reader, &trail, &lead), "new store not empty");
+	append_range (store, 0, 6);
+	fail_unless (TRUE == pgm_txw_store_extent (reader, &trail, &lead), "extent failed");
+	fail_unless (2 == trail && 5 == lead, "extent");
+	const size_t len = pgm_txw_store_copy (reader, 3, buf, sizeof(buf));
+	fail_unless (sizeof(struct pgm_header) + sizeof(struct pgm_data) + 8 == len, "copy length");
+	fail_unless (3 == g_ntohl (((struct pgm_data*)(buf + sizeof(struct pgm_header)))->data_sqn), "data_sqn");
+	fail_unless (0 == pgm_txw_store_copy (reader, 1, buf, sizeof(buf)), "evicted sequence copied");
+	fail_unless (0 == pgm_txw_store_copy (reader, 3, buf, 8), "copy beyond buffer");
+	pgm_txw_store_close (reader);
+	pgm_txw_store_close (store);
+	unlink (TEST_FILE);
+}
+END_TEST
+
+START_TEST (test_attach_fail_001)
+{
+	pgm_error_t* err = NULL;
+	fail_unless (NULL == pgm_txw_store_attach ("/nonexistent/txw.dat", &err), "attach succeeded");
+	fail_if (NULL == err, "error not set");
+	pgm_error_free (err);
+}
+END_TEST
+
+/* not a store */
+START_TEST (test_attach_fail_002)
+{
+	pgm_error_t* err = NULL;
+	char page[ TXW_STORE_HEADER_LEN ];
+	unlink (TEST_FILE);
+	FILE* fp = fopen (TEST_FILE, "wb");
+	fail_if (NULL == fp, "fopen failed");
+	memset (page, 0, sizeof(page));
+	fwrite (page, 1, sizeof(page), fp);
+	fclose (fp);
+	fail_unless (NULL == pgm_txw_store_attach (TEST_FILE, &err), "attach succeeded");
+	fail_if (NULL == err, "error not set");
+	pgm_error_free (err);
+	unlink (TEST_FILE);
+}
+END_TEST
+
+
+/* standby reads the geometry of the primary */
+START_TEST (test_geometry_pass_001)
+{
+	pgm_error_t* err = NULL;
+	pgm_tsi_t tsi;
+	uint32_t sqns;
+	uint16_t max_tpdu;
+	unlink (TEST_FILE);
+	struct pgm_txw_store_t* store = pgm_txw_store_open (TEST_FILE, &test_tsi, TEST_MAX_TPDU, 4, &err);
+	fail_if (NULL == store, "open failed");
+	struct pgm_txw_store_t* reader = pgm_txw_store_attach (TEST_FILE, &err);
+	fail_if (NULL == reader, "attach failed");
+	pgm_txw_store_geometry (reader, &tsi, &sqns, &max_tpdu);
+	fail_unless (pgm_tsi_equal (&test_tsi, &tsi), "tsi");
+	fail_unless (4 == sqns, "sqns");
+	fail_unless (TEST_MAX_TPDU == max_tpdu, "max_tpdu");
+	pgm_txw_store_close (reader);
+	pgm_txw_store_close (store);
+	unlink (TEST_FILE);
+}
+END_TEST
+
+START_TEST (test_is_owned_pass_001)
+{
+	pgm_error_t* err = NULL;
+	unlink (TEST_FILE);
+	struct pgm_txw_store_t* store = pgm_txw_store_open (TEST_FILE, &test_tsi, TEST_MAX_TPDU, 4, &err);
+	fail_if (NULL == store, "open failed");
+	struct pgm_txw_store_t* reader = pgm_txw_store_attach (TEST_FILE, &err);
+	fail_if (NULL == reader, "attach failed");
+	fail_unless (TRUE == pgm_txw_store_is_owned (reader), "writer not running");
+/* owner not known */
+	store->header->owner = 0;
+	fail_unless (TRUE == pgm_txw_store_is_owned (reader), "unknown writer not running");
+	pgm_txw_store_close (reader);
+	pgm_txw_store_close (store);
+	unlink (TEST_FILE);
+}
+END_TEST
+
+static
+Suite*
+make_test_suite (void)
+{
+	Suite* s;
+
+	s = suite_create (__FILE__);
+
+	TCase* tc_open = tcase_create ("open");
+	suite_add_tcase (s, tc_open);
+	tcase_add_test (tc_open, test_open_pass_001);
+	tcase_add_test (tc_open, test_open_pass_002);
+	tcase_add_test (tc_open, test_open_fail_001);
+
+	TCase* tc_append = tcase_create ("append");
+	suite_add_tcase (s, tc_append);
+	tcase_add_test (tc_append, test_append_pass_001);
+	tcase_add_test (tc_append, test_append_pass_002);
+	tcase_add_test (tc_append, test_append_pass_003);
+
+	TCase* tc_resume = tcase_create ("resume");
+	suite_add_tcase (s, tc_resume);
+	tcase_add_test (tc_resume, test_resume_pass_001);
+	tcase_add_test (tc_resume, test_resume_fail_001);
+	tcase_add_test (tc_resume, test_resume_fail_002);
+
+	TCase* tc_attach = tcase_create ("attach");
+	suite_add_tcase (s, tc_attach);
+	tcase_add_test (tc_attach, test_attach_pass_001);
+	tcase_add_test (tc_attach, test_attach_fail_001);
+	tcase_add_test (tc_attach, test_attach_fail_002);
+
+	TCase* tc_geometry = tcase_create ("geometry");
+	suite_add_tcase (s, tc_geometry);
+	tcase_add_test (tc_geometry, test_geometry_pass_001);
+
+	TCase* tc_is_owned = tcase_create ("is-owned");
+	suite_add_tcase (s, tc_is_owned);
+	tcase_add_test (tc_is_owned, test_is_owned_pass_001);
+	return s;
+}
+
+static
+Suite*
+make_master_suite (void)
+{
+	Suite* s = suite_create ("Master");
+	return s;
+}
+
+int
+main (void)
+{
+	pgm_messages_init();
+	SRunner* sr = srunner_create (make_master_suite ());
+	srunner_add_suite (sr, make_test_suite ());
+	srunner_run_all (sr, CK_ENV);
+	int number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	pgm_messages_shutdown();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof */
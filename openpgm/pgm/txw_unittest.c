@@ -37,6 +37,7 @@
 #define pgm_rs_create			mock_pgm_rs_create
 #define pgm_rs_destroy			mock_pgm_rs_destroy
 #define pgm_rs_encode			mock_pgm_rs_encode
+#define pgm_rs_encode_csum		mock_pgm_rs_encode_csum
 #define pgm_compat_csum_partial		mock_pgm_compat_csum_partial
 #define pgm_histogram_init		mock_pgm_histogram_init
 
@@ -72,6 +73,19 @@ mock_pgm_rs_encode(
 {
 }
 
+uint32_t
+mock_pgm_rs_encode_csum(
+	pgm_rs_t*		rs,
+	const pgm_gf8_t**	src,
+	const uint16_t*		lens,
+	const uint8_t		offset,
+	pgm_gf8_t*		dst,
+	const uint16_t		len
+        )
+{
+	return 0;
+}
+
 /** checksum module */
 uint32_t
 mock_pgm_compat_csum_partial (
@@ -93,7 +107,7 @@ mock_pgm_histogram_init (
 void
 mock_pgm_histogram_add (
 	pgm_histogram_t*	histogram,
-	int			value
+	uint64_t		value
 	)
 {
 }
@@ -151,7 +165,8 @@ generate_valid_skb (void)
  *		const guint		max_rte,
  *		const gboolean		use_fec,
  *		const guint		rs_n,
- *		const guint		rs_k
+ *		const guint		rs_k,
+ *		const pgm_mem_policy_t*const policy
  *		)
  */
 
@@ -159,7 +174,7 @@ generate_valid_skb (void)
 START_TEST (test_create_pass_001)
 {
 	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
-	fail_if (NULL == pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0), "create failed");
+	fail_if (NULL == pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0, NULL), "create failed");
 }
 END_TEST
 
@@ -167,7 +182,7 @@ END_TEST
 START_TEST (test_create_pass_002)
 {
 	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
-	fail_if (NULL == pgm_txw_create (&tsi, 1500, 0, 60, 800000, FALSE, 0, 0), "create failed");
+	fail_if (NULL == pgm_txw_create (&tsi, 1500, 0, 60, 800000, FALSE, 0, 0, NULL), "create failed");
 }
 END_TEST
 
@@ -175,7 +190,7 @@ END_TEST
 START_TEST (test_create_pass_003)
 {
 	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
-	fail_if (NULL == pgm_txw_create (&tsi, 9000, 0, 60, 800000, FALSE, 0, 0), "create failed");
+	fail_if (NULL == pgm_txw_create (&tsi, 9000, 0, 60, 800000, FALSE, 0, 0, NULL), "create failed");
 }
 END_TEST
 
@@ -183,7 +198,38 @@ END_TEST
 START_TEST (test_create_pass_004)
 {
 	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
-	fail_if (NULL == pgm_txw_create (&tsi, UINT16_MAX, 0, 60, 800000, FALSE, 0, 0), "create failed");
+	fail_if (NULL == pgm_txw_create (&tsi, UINT16_MAX, 0, 60, 800000, FALSE, 0, 0, NULL), "create failed");
+}
+END_TEST
+
+/* power-of-two windows index by mask */
+START_TEST (test_create_pass_005)
+{
+	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 1024, 0, 0, FALSE, 0, 0, NULL);
+	fail_if (NULL == window, "create failed");
+	fail_unless (1023 == window->mask, "mask not set");
+	pgm_txw_shutdown (window);
+	window = pgm_txw_create (&tsi, 0, 1000, 0, 0, FALSE, 0, 0, NULL);
+	fail_if (NULL == window, "create failed");
+	fail_unless (0 == window->mask, "mask set");
+	pgm_txw_shutdown (window);
+}
+END_TEST
+
+/* page policy */
+START_TEST (test_create_pass_006)
+{
+	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const pgm_mem_policy_t policy = { .pages = PGM_MEM_PAGES_TRANSPARENT, .node = -1 };
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 1024, 0, 0, FALSE, 0, 0, &policy);
+	fail_if (NULL == window, "create failed");
+	fail_unless (0 == ((uintptr_t)window & (PGM_CACHELINE_SIZE - 1)), "unaligned window");
+	fail_unless (1024 == pgm_txw_max_length (window), "max_length failed");
+	struct pgm_sk_buff_t* skb = generate_valid_skb ();
+	pgm_txw_add (window, skb);
+	fail_unless (skb == pgm_txw_peek (window, window->trail), "peek failed");
+	pgm_txw_shutdown (window);
 }
 END_TEST
 
@@ -191,7 +237,7 @@ END_TEST
 START_TEST (test_create_fail_001)
 {
 	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
-	const pgm_txw_t* window = pgm_txw_create (&tsi, 0, 0, 60, 800000, FALSE, 0, 0);
+	const pgm_txw_t* window = pgm_txw_create (&tsi, 0, 0, 60, 800000, FALSE, 0, 0, NULL);
 	fail ("reached");
 }
 END_TEST
@@ -200,7 +246,7 @@ END_TEST
 START_TEST (test_create_fail_002)
 {
 	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
-	const pgm_txw_t* window = pgm_txw_create (&tsi, 0, 0, 0, 800000, FALSE, 0, 0);
+	const pgm_txw_t* window = pgm_txw_create (&tsi, 0, 0, 0, 800000, FALSE, 0, 0, NULL);
 	fail ("reached");
 }
 END_TEST
@@ -209,7 +255,7 @@ END_TEST
 START_TEST (test_create_fail_003)
 {
 	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
-	const pgm_txw_t* window = pgm_txw_create (&tsi, 0, 0, 60, 0, FALSE, 0, 0);
+	const pgm_txw_t* window = pgm_txw_create (&tsi, 0, 0, 60, 0, FALSE, 0, 0, NULL);
 	fail ("reached");
 }
 END_TEST
@@ -218,7 +264,7 @@ END_TEST
 START_TEST (test_create_fail_004)
 {
 	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
-	const pgm_txw_t* window = pgm_txw_create (NULL, 0, 0, 0, 0, FALSE, 0, 0);
+	const pgm_txw_t* window = pgm_txw_create (NULL, 0, 0, 0, 0, FALSE, 0, 0, NULL);
 	fail ("reached");
 }
 END_TEST
@@ -233,7 +279,7 @@ END_TEST
 START_TEST (test_shutdown_pass_001)
 {
 	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
-	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0);
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0, NULL);
 	fail_if (NULL == window, "create failed");
 	pgm_txw_shutdown (window);
 }
@@ -258,7 +304,7 @@ END_TEST
 START_TEST (test_add_pass_001)
 {
 	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
-	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0);
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0, NULL);
 	fail_if (NULL == window, "create failed");
 	struct pgm_sk_buff_t* skb = generate_valid_skb ();
 	fail_if (NULL == skb, "generate_valid_skb failed");
@@ -267,11 +313,73 @@ START_TEST (test_add_pass_001)
 }
 END_TEST
 
+/* ring store skbuffs trimmed on add and reclaimed as the window advances */
+START_TEST (test_add_pass_002)
+{
+	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const guint16 header_length = sizeof(struct pgm_header) + sizeof(struct pgm_data);
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 8, 0, 0, FALSE, 0, 0, NULL);
+	fail_if (NULL == window, "create failed");
+	pgm_skb_pool_t* pool = pgm_skb_pool_new_ring (1500, 16384, NULL);
+	fail_if (NULL == pool, "pgm_skb_pool_new_ring failed");
+	for (unsigned i = 0; i < 1000; i++) {
+		struct pgm_sk_buff_t* skb = pgm_skb_pool_alloc (pool, 1500);
+		fail_unless (pool == skb->pool, "ring exhausted");
+		skb->sock = (pgm_sock_t*)0x1;
+		pgm_skb_reserve (skb, header_length);
+		memset (skb->head, 0, header_length);
+		skb->pgm_header = (struct pgm_header*)skb->head;
+		skb->pgm_data   = (struct pgm_data*)(skb->pgm_header + 1);
+		skb->pgm_header->pgm_type = PGM_ODATA;
+		skb->pgm_header->pgm_tsdu_length = g_htons (100);
+		pgm_skb_put (skb, 100);
+		pgm_txw_add (window, skb);
+		fail_unless (skb->truesize < sizeof(struct pgm_sk_buff_t) + header_length + 100 + 32, "not trimmed");
+		fail_unless (pgm_skb_is_valid (skb), "invalid skb");
+	}
+	fail_unless (pool->ring_used <= 8 * (sizeof(struct pgm_sk_buff_t) + header_length + 100 + 32), "not reclaimed");
+	pgm_txw_shutdown (window);
+	fail_unless (0 == pool->ring_used, "not reclaimed");
+	pgm_skb_pool_destroy (pool);
+}
+END_TEST
+
+/* entries held by every reporting receiver are released once past retention */
+START_TEST (test_add_pass_003)
+{
+	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0, NULL);
+	fail_if (NULL == window, "create failed");
+	pgm_txw_set_retention (window, 100);
+	for (unsigned i = 0; i < 10; i++) {
+		struct pgm_sk_buff_t* skb = generate_valid_skb ();
+		skb->tstamp = 1000 + (i * 10);
+		pgm_txw_add (window, skb);
+	}
+	fail_unless (10 == pgm_txw_length (window), "length not 10");
+/* acknowledged up to #5, only #0 .. #4 sent at least 100us before */
+	pgm_txw_update_ack_trail (window, TRUE, window->trail + 5);
+	struct pgm_sk_buff_t* skb = generate_valid_skb ();
+	skb->tstamp = 1140;
+	const uint32_t trail = window->trail;
+	pgm_txw_add (window, skb);
+	fail_unless (trail + 5 == window->trail, "trail not advanced by 5");
+	fail_unless (6 == pgm_txw_length (window), "length not 6");
+/* suspended */
+	pgm_txw_update_ack_trail (window, FALSE, 0);
+	skb = generate_valid_skb ();
+	skb->tstamp = 2000;
+	pgm_txw_add (window, skb);
+	fail_unless (7 == pgm_txw_length (window), "length not 7");
+	pgm_txw_shutdown (window);
+}
+END_TEST
+
 /* null skb */
 START_TEST (test_add_fail_001)
 {
 	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
-	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0);
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0, NULL);
 	fail_if (NULL == window, "create failed");
 	pgm_txw_add (window, NULL);
 	fail ("reached");
@@ -292,7 +400,7 @@ END_TEST
 START_TEST (test_add_fail_003)
 {
 	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
-	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0);
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0, NULL);
 	fail_if (NULL == window, "create failed");
 	char buffer[1500];
 	memset (buffer, 0, sizeof(buffer));
@@ -312,7 +420,7 @@ END_TEST
 START_TEST (test_peek_pass_001)
 {
 	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
-	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0);
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0, NULL);
 	fail_if (NULL == window, "create failed");
 	struct pgm_sk_buff_t* skb = generate_valid_skb ();
 	fail_if (NULL == skb, "generate_valid_skb failed");
@@ -334,7 +442,7 @@ END_TEST
 START_TEST (test_peek_fail_002)
 {
 	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
-	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0);
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0, NULL);
 	fail_if (NULL == window, "create failed");
 	fail_unless (NULL == pgm_txw_peek (window, window->trail), "peek failed");
 	pgm_txw_shutdown (window);
@@ -348,7 +456,7 @@ START_TEST (test_max_length_pass_001)
 {
 	const guint window_length = 100;
 	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
-	pgm_txw_t* window = pgm_txw_create (&tsi, 0, window_length, 0, 0, FALSE, 0, 0);
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, window_length, 0, 0, FALSE, 0, 0, NULL);
 	fail_if (NULL == window, "create failed");
 	fail_unless (window_length == pgm_txw_max_length (window), "max_length failed");
 	pgm_txw_shutdown (window);
@@ -367,7 +475,7 @@ END_TEST
 START_TEST (test_length_pass_001)
 {
 	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
-	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0);
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0, NULL);
 	fail_if (NULL == window, "create failed");
 	fail_unless (0 == pgm_txw_length (window), "length failed");
 	struct pgm_sk_buff_t* skb = generate_valid_skb ();
@@ -390,7 +498,7 @@ END_TEST
 START_TEST (test_size_pass_001)
 {
 	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
-	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0);
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0, NULL);
 	fail_if (NULL == window, "create failed");
 	fail_unless (0 == pgm_txw_size (window), "size failed");
 	struct pgm_sk_buff_t* skb = generate_valid_skb ();
@@ -413,7 +521,7 @@ END_TEST
 START_TEST (test_is_empty_pass_001)
 {
 	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
-	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0);
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0, NULL);
 	fail_if (NULL == window, "create failed");
 	fail_unless (pgm_txw_is_empty (window), "is_empty failed");
 	struct pgm_sk_buff_t* skb = generate_valid_skb ();
@@ -436,7 +544,7 @@ END_TEST
 START_TEST (test_is_full_pass_001)
 {
 	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
-	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 1, 0, 0, FALSE, 0, 0);
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 1, 0, 0, FALSE, 0, 0, NULL);
 	fail_if (NULL == window, "create failed");
 	fail_if (pgm_txw_is_full (window), "is_full failed");
 	struct pgm_sk_buff_t* skb = generate_valid_skb ();
@@ -459,7 +567,7 @@ END_TEST
 START_TEST (test_lead_pass_001)
 {
 	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
-	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0);
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0, NULL);
 	fail_if (NULL == window, "create failed");
 	guint32 lead = pgm_txw_lead (window);
 	struct pgm_sk_buff_t* skb = generate_valid_skb ();
@@ -483,7 +591,7 @@ START_TEST (test_next_lead_pass_001)
 {
 	const guint window_length = 100;
 	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
-	pgm_txw_t* window = pgm_txw_create (&tsi, 0, window_length, 0, 0, FALSE, 0, 0);
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, window_length, 0, 0, FALSE, 0, 0, NULL);
 	fail_if (NULL == window, "create failed");
 	guint32 next_lead = pgm_txw_next_lead (window);
 	struct pgm_sk_buff_t* skb = generate_valid_skb ();
@@ -506,7 +614,7 @@ END_TEST
 START_TEST (test_trail_pass_001)
 {
 	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
-	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 1, 0, 0, FALSE, 0, 0);
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 1, 0, 0, FALSE, 0, 0, NULL);
 	fail_if (NULL == window, "create failed");
 /* does not advance with adding skb */
 	guint32 trail = pgm_txw_trail (window);
@@ -543,7 +651,7 @@ END_TEST
 START_TEST (test_retransmit_push_pass_001)
 {
 	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
-	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0);
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0, NULL);
 	fail_if (NULL == window, "create failed");
 /* empty window invalidates all requests */
 	fail_unless (FALSE == pgm_txw_retransmit_push (window, window->trail, FALSE, 0), "retransmit_push failed");
@@ -558,6 +666,59 @@ START_TEST (test_retransmit_push_pass_001)
 }
 END_TEST
 
+/* eliminated requests are counted, completing the repair re-enables the sequence */
+START_TEST (test_retransmit_push_pass_002)
+{
+	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0, NULL);
+	fail_if (NULL == window, "create failed");
+	struct pgm_sk_buff_t* skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	pgm_txw_add (window, skb);
+	const pgm_txw_state_t* state = (const pgm_txw_state_t*)&skb->cb;
+	fail_unless (TRUE == pgm_txw_retransmit_push (window, window->trail, FALSE, 0), "retransmit_push failed");
+	fail_unless (FALSE == pgm_txw_retransmit_push (window, window->trail, FALSE, 0), "retransmit_push failed");
+	fail_unless (FALSE == pgm_txw_retransmit_push (window, window->trail, FALSE, 0), "retransmit_push failed");
+	fail_unless (2 == state->nak_elimination_count, "nak_elimination_count failed");
+	fail_unless (skb == pgm_txw_retransmit_try_peek (window), "retransmit_try_peek failed");
+	pgm_txw_retransmit_remove_head (window);
+	fail_unless (pgm_txw_retransmit_is_empty (window), "retransmit_is_empty failed");
+	fail_unless (TRUE == pgm_txw_retransmit_push (window, window->trail, FALSE, 0), "retransmit_push failed");
+	pgm_txw_shutdown (window);
+}
+END_TEST
+
+/* requests beyond the window are read back from the store */
+START_TEST (test_retransmit_push_pass_003)
+{
+	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const char* path = "txw-unittest-store.dat";
+	pgm_error_t* err = NULL;
+	unlink (path);
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 4, 0, 0, FALSE, 0, 0, NULL);
+	fail_if (NULL == window, "create failed");
+	struct pgm_txw_store_t* store = pgm_txw_store_open (path, &tsi, 1500, 16, &err);
+	fail_if (NULL == store, "store open failed");
+	pgm_txw_set_store (window, store);
+	for (unsigned i = 0; i < 8; i++) {
+		struct pgm_sk_buff_t* skb = generate_valid_skb ();
+		fail_if (NULL == skb, "generate_valid_skb failed");
+		pgm_txw_add (window, skb);
+	}
+	fail_unless (4 == pgm_txw_trail (window), "trail");
+	fail_unless (0 == pgm_txw_repair_trail (window), "repair trail");
+	fail_unless (TRUE == pgm_txw_retransmit_push (window, 1, FALSE, 0), "retransmit_push failed");
+	struct pgm_sk_buff_t* skb = pgm_txw_retransmit_try_peek (window);
+	fail_if (NULL == skb, "retransmit_try_peek failed");
+	fail_unless (1 == skb->sequence, "sequence");
+	fail_unless (1000 == skb->len, "tsdu length");
+	pgm_txw_retransmit_remove_head (window);
+	pgm_txw_shutdown (window);
+	pgm_txw_store_close (store);
+	unlink (path);
+}
+END_TEST
+
 START_TEST (test_retransmit_push_fail_001)
 {
 	const bool answer = pgm_txw_retransmit_push (NULL, 0, FALSE, 0);
@@ -565,6 +726,40 @@ START_TEST (test_retransmit_push_fail_001)
 }
 END_TEST
 
+/* target:
+ *	unsigned
+ *	pgm_txw_retransmit_push_range (
+ *		pgm_txw_t* const	window,
+ *		const uint32_t		first,
+ *		const uint32_t		count
+ *		)
+ */
+
+/* run overlapping the lead only pushes the sequences in the window, repeats are eliminated */
+START_TEST (test_retransmit_push_range_pass_001)
+{
+	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0, NULL);
+	fail_if (NULL == window, "create failed");
+	for (unsigned i = 0; i < 3; i++) {
+		struct pgm_sk_buff_t* skb = generate_valid_skb ();
+		fail_if (NULL == skb, "generate_valid_skb failed");
+		pgm_txw_add (window, skb);
+	}
+	fail_unless (3 == pgm_txw_retransmit_push_range (window, window->trail, 5), "retransmit_push_range failed");
+	fail_unless (0 == pgm_txw_retransmit_push_range (window, window->trail, 3), "retransmit_push_range failed");
+	fail_unless (FALSE == pgm_txw_retransmit_push (window, window->trail + 1, FALSE, 0), "retransmit_push failed");
+	pgm_txw_shutdown (window);
+}
+END_TEST
+
+START_TEST (test_retransmit_push_range_fail_001)
+{
+	const unsigned answer = pgm_txw_retransmit_push_range (NULL, 0, 1);
+	fail ("reached");
+}
+END_TEST
+
 /* target:
  *	struct pgm_sk_buff_t*
  *	pgm_txw_retransmit_try_peek (
@@ -575,7 +770,7 @@ END_TEST
 START_TEST (test_retransmit_try_peek_pass_001)
 {
 	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
-	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0);
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0, NULL);
 	fail_if (NULL == window, "create failed");
 	struct pgm_sk_buff_t* skb = generate_valid_skb ();
 	fail_if (NULL == skb, "generate_valid_skb failed");
@@ -604,7 +799,7 @@ END_TEST
 START_TEST (test_retransmit_remove_head_pass_001)
 {
 	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
-	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0);
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0, NULL);
 	fail_if (NULL == window, "create failed");
 	struct pgm_sk_buff_t* skb = generate_valid_skb ();
 	fail_if (NULL == skb, "generate_valid_skb failed");
@@ -628,13 +823,73 @@ END_TEST
 START_TEST (test_retransmit_remove_head_fail_002)
 {
 	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
-	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0);
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, FALSE, 0, 0, NULL);
 	fail_if (NULL == window, "create failed");
 	pgm_txw_retransmit_remove_head (window);
 	fail ("reached");
 }
 END_TEST
 
+/* target:
+ *	bool
+ *	pgm_txw_parity_submit (
+ *		pgm_txw_t* const	window,
+ *		const uint32_t		tg_sqn
+ *		)
+ */
+
+/* without a worker the transmission group is left to the repair path */
+START_TEST (test_parity_submit_pass_001)
+{
+	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	pgm_txw_t* window = pgm_txw_create (&tsi, 1500, 100, 0, 0, TRUE, 255, 4, NULL);
+	fail_if (NULL == window, "create failed");
+	fail_unless (FALSE == pgm_txw_parity_submit (window, 0), "parity_submit failed");
+	fail_unless (NULL == pgm_txw_parity_try_peek (window), "parity_try_peek failed");
+	pgm_txw_shutdown (window);
+}
+END_TEST
+
+/* worker publishes h parity packets from the top of the parity index range */
+START_TEST (test_parity_submit_pass_002)
+{
+	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	pgm_notify_t notify;
+	pgm_txw_t* window = pgm_txw_create (&tsi, 1500, 100, 0, 0, TRUE, 255, 4, NULL);
+	fail_if (NULL == window, "create failed");
+/* reed-solomon module is mocked */
+	window->rs.n = 255;
+	window->rs.k = 4;
+	fail_unless (0 == pgm_notify_init (&notify), "notify_init failed");
+	fail_unless (TRUE == pgm_txw_parity_start (window, 2, &notify), "parity_start failed");
+	for (unsigned i = 0; i < 4; i++) {
+		struct pgm_sk_buff_t* skb = generate_valid_skb ();
+		fail_if (NULL == skb, "generate_valid_skb failed");
+		pgm_txw_add (window, skb);
+	}
+	fail_unless (TRUE == pgm_txw_parity_submit (window, 0), "parity_submit failed");
+	for (unsigned i = 2; i < 4; i++) {
+		struct pgm_sk_buff_t* skb;
+		for (unsigned retry = 0; NULL == (skb = pgm_txw_parity_try_peek (window)) && retry < 1000; retry++)
+			g_usleep (1000);
+		fail_if (NULL == skb, "parity_try_peek failed");
+		fail_unless (PGM_OPT_PARITY & skb->pgm_header->pgm_options, "not parity");
+		fail_unless (i == g_ntohl (skb->pgm_data->data_sqn), "parity index mismatch");
+		pgm_txw_parity_remove_head (window);
+	}
+	fail_unless (NULL == pgm_txw_parity_try_peek (window), "parity_try_peek failed");
+	pgm_txw_shutdown (window);
+	pgm_notify_destroy (&notify);
+}
+END_TEST
+
+START_TEST (test_parity_submit_fail_001)
+{
+	const bool answer = pgm_txw_parity_submit (NULL, 0);
+	fail ("reached");
+}
+END_TEST
+
 static
 Suite*
 make_test_suite (void)
@@ -649,6 +904,8 @@ make_test_suite (void)
 	tcase_add_test (tc_create, test_create_pass_002);
 	tcase_add_test (tc_create, test_create_pass_003);
 	tcase_add_test (tc_create, test_create_pass_004);
+	tcase_add_test (tc_create, test_create_pass_005);
+	tcase_add_test (tc_create, test_create_pass_006);
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_create, test_create_fail_001, SIGABRT);
 	tcase_add_test_raise_signal (tc_create, test_create_fail_002, SIGABRT);
@@ -666,6 +923,8 @@ make_test_suite (void)
 	TCase* tc_add = tcase_create ("add");
 	suite_add_tcase (s, tc_add);
 	tcase_add_test (tc_add, test_add_pass_001);
+	tcase_add_test (tc_add, test_add_pass_002);
+	tcase_add_test (tc_add, test_add_pass_003);
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_add, test_add_fail_001, SIGABRT);
 	tcase_add_test_raise_signal (tc_add, test_add_fail_002, SIGABRT);
@@ -739,10 +998,19 @@ make_test_suite (void)
 	TCase* tc_retransmit_push = tcase_create ("retransmit-push");
 	suite_add_tcase (s, tc_retransmit_push);
 	tcase_add_test (tc_retransmit_push, test_retransmit_push_pass_001);
+	tcase_add_test (tc_retransmit_push, test_retransmit_push_pass_002);
+	tcase_add_test (tc_retransmit_push, test_retransmit_push_pass_003);
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_retransmit_push, test_retransmit_push_fail_001, SIGABRT);
 #endif
 
+	TCase* tc_retransmit_push_range = tcase_create ("retransmit-push-range");
+	suite_add_tcase (s, tc_retransmit_push_range);
+	tcase_add_test (tc_retransmit_push_range, test_retransmit_push_range_pass_001);
+#ifndef PGM_CHECK_NOFORK
+	tcase_add_test_raise_signal (tc_retransmit_push_range, test_retransmit_push_range_fail_001, SIGABRT);
+#endif
+
 	TCase* tc_retransmit_try_peek = tcase_create ("retransmit-try-peek");
 	suite_add_tcase (s, tc_retransmit_try_peek);
 	tcase_add_test (tc_retransmit_try_peek, test_retransmit_try_peek_pass_001);
@@ -758,6 +1026,105 @@ make_test_suite (void)
 	tcase_add_test_raise_signal (tc_retransmit_remove_head, test_retransmit_remove_head_fail_002, SIGABRT);
 #endif
 
+	TCase* tc_parity_submit = tcase_create ("parity-submit");
+	suite_add_tcase (s, tc_parity_submit);
+	tcase_add_test (tc_parity_submit, test_parity_submit_pass_001);
+	tcase_add_test (tc_parity_submit, test_parity_submit_pass_002);
+#ifndef PGM_CHECK_NOFORK
+	tcase_add_test_raise_signal (tc_parity_submit, test_parity_submit_fail_001, SIGABRT);
+#endif
+
+	return s;
+}
+
+/* performance: modulo against mask indexing, recycling one skbuff per slot */
+
+static unsigned perf_sqns = 0;
+
+static
+void
+mock_setup_modulo (void)
+{
+	perf_sqns = 1000;
+}
+
+static
+void
+mock_setup_pow2 (void)
+{
+	perf_sqns = 1024;
+}
+
+START_TEST (test_perf_add)
+{
+	const unsigned iterations = 1000;
+	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, perf_sqns, 0, 0, FALSE, 0, 0, NULL);
+	fail_if (NULL == window, "create failed");
+	struct pgm_sk_buff_t** skbs = g_new (struct pgm_sk_buff_t*, perf_sqns);
+	for (unsigned i = 0; i < perf_sqns; i++) {
+		skbs[i] = pgm_skb_get (generate_valid_skb ());
+		pgm_txw_add (window, skbs[i]);
+	}
+/* full window, each add removes the trail which is the same skbuff */
+	GTimer* timer = g_timer_new ();
+	for (unsigned i = iterations; i; i--)
+		for (unsigned j = 0; j < perf_sqns; j++)
+			pgm_txw_add (window, pgm_skb_get (skbs[j]));
+	const gdouble elapsed = g_timer_elapsed (timer, NULL);
+	g_message ("add/%u: elapsed time %.0f us, unit time %.1f ns",
+		perf_sqns,
+		elapsed * 1e6,
+		(elapsed * 1e9) / (iterations * perf_sqns));
+	g_timer_destroy (timer);
+	pgm_txw_shutdown (window);
+	for (unsigned i = 0; i < perf_sqns; i++)
+		pgm_free_skb (skbs[i]);
+	g_free (skbs);
+}
+END_TEST
+
+START_TEST (test_perf_peek)
+{
+	const unsigned iterations = 1000;
+	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, perf_sqns, 0, 0, FALSE, 0, 0, NULL);
+	fail_if (NULL == window, "create failed");
+	for (unsigned i = 0; i < perf_sqns; i++)
+		pgm_txw_add (window, generate_valid_skb ());
+	GTimer* timer = g_timer_new ();
+	for (unsigned i = iterations; i; i--)
+		for (uint32_t j = 0; j < perf_sqns; j++)
+			fail_if (NULL == pgm_txw_peek (window, window->trail + j), "peek failed");
+	const gdouble elapsed = g_timer_elapsed (timer, NULL);
+	g_message ("peek/%u: elapsed time %.0f us, unit time %.1f ns",
+		perf_sqns,
+		elapsed * 1e6,
+		(elapsed * 1e9) / (iterations * perf_sqns));
+	g_timer_destroy (timer);
+	pgm_txw_shutdown (window);
+}
+END_TEST
+
+static
+Suite*
+make_perf_suite (void)
+{
+	Suite* s;
+
+	s = suite_create ("Window indexing performance");
+
+	TCase* tc_modulo = tcase_create ("modulo");
+	suite_add_tcase (s, tc_modulo);
+	tcase_add_checked_fixture (tc_modulo, mock_setup_modulo, NULL);
+	tcase_add_test (tc_modulo, test_perf_add);
+	tcase_add_test (tc_modulo, test_perf_peek);
+
+	TCase* tc_pow2 = tcase_create ("pow2");
+	suite_add_tcase (s, tc_pow2);
+	tcase_add_checked_fixture (tc_pow2, mock_setup_pow2, NULL);
+	tcase_add_test (tc_pow2, test_perf_add);
+	tcase_add_test (tc_pow2, test_perf_peek);
 	return s;
 }
 
@@ -774,6 +1141,7 @@ main (void)
 {
 	SRunner* sr = srunner_create (make_master_suite ());
 	srunner_add_suite (sr, make_test_suite ());
+	srunner_add_suite (sr, make_perf_suite ());
 	srunner_run_all (sr, CK_ENV);
 	int number_failed = srunner_ntests_failed (sr);
 	srunner_free (sr);
@@ -0,0 +1,532 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * io_uring receive engine: a ring of receive operations kept in flight on
+ * the receive sockets, completions are reaped from shared memory without a
+ * system call and replacement operations are submitted in batches.  File
+ * writes of the recorder are submitted on a ring of their own.
+ *
+ * Copyright (c) 2006-2011 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <impl/framework.h>
+#include <impl/socket.h>
+
+#ifdef HAVE_LINUX_IO_URING_H
+#	include <errno.h>
+#	include <unistd.h>
+#	include <sys/mman.h>
+#	include <sys/socket.h>
+#	include <sys/syscall.h>
+#	include <linux/io_uring.h>
+
+
+//#define URING_DEBUG
+
+#ifndef URING_DEBUG
+#	define PGM_DISABLE_ASSERT
+#endif
+
+/* control message space per receive operation, as recvskb_batch() */
+#define PGM_URING_AUX_LEN		256
+
+/* submit replacement receive operations once this fraction of the ring is idle */
+#define PGM_URING_SUBMIT_SHIFT		2
+
+/* no receive operation awaiting replacement */
+#define PGM_URING_NO_SLOT		UINT_MAX
+
+/* submission and completion rings of one io_uring instance */
+struct uring_t {
+	int				fd;
+
+/* submission queue */
+	unsigned*			sq_head;
+	unsigned*			sq_tail;
+	unsigned			sq_mask;
+	unsigned*			sq_array;
+	struct io_uring_sqe*		sqes;
+
+/* completion queue */
+	unsigned*			cq_head;
+	unsigned*			cq_tail;
+	unsigned			cq_mask;
+	struct io_uring_cqe*		cqes;
+
+	void*				sq_ring;
+	size_t				sq_ring_len;
+	void*				cq_ring;
+	size_t				cq_ring_len;
+	size_t				sqes_len;
+};
+
+struct pgm_recv_uring_t {
+	struct uring_t			ring;
+	unsigned			depth;			/* receive operations */
+	unsigned			to_submit;		/* prepared, not yet submitted */
+	unsigned			last_slot;		/* completed, returned to caller */
+
+/* per receive operation */
+	SOCKET*				sock;
+	struct pgm_sk_buff_t**		skb;
+	struct msghdr*			msg;
+	struct pgm_iovec*		iov;
+	struct sockaddr_storage*	addr;
+	char*				aux;
+	uint16_t			max_tpdu;
+};
+
+struct pgm_write_uring_t {
+	struct uring_t			ring;
+	unsigned			depth;
+	unsigned			in_flight;		/* submitted, not yet reaped */
+};
+
+
+static
+int
+uring_setup (
+	const unsigned			entries,
+	struct io_uring_params*		p
+	)
+{
+	return (int)syscall (__NR_io_uring_setup, entries, p);
+}
+
+static
+int
+uring_enter (
+	const int			fd,
+	const unsigned			to_submit,
+	const unsigned			min_complete,
+	const unsigned			flags
+	)
+{
+	return (int)syscall (__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+/* map the submission and completion rings of a new io_uring instance.
+ *
+ * returns TRUE on success, returns FALSE on failure setting errno.
+ */
+
+static
+bool
+uring_map (
+	struct uring_t* const		ring,
+	const unsigned			entries
+	)
+{
+	struct io_uring_params p;
+	memset (&p, 0, sizeof(p));
+	ring->fd = uring_setup (entries, &p);
+	if (ring->fd < 0)
+		return FALSE;
+
+	ring->sq_ring_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+	ring->cq_ring_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+	if (p.features & IORING_FEAT_SINGLE_MMAP)
+		ring->sq_ring_len = ring->cq_ring_len = MAX(ring->sq_ring_len, ring->cq_ring_len);
+	ring->sq_ring = mmap (NULL, ring->sq_ring_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+	if (MAP_FAILED == ring->sq_ring)
+		goto err_close;
+	if (p.features & IORING_FEAT_SINGLE_MMAP) {
+		ring->cq_ring = ring->sq_ring;
+	} else {
+		ring->cq_ring = mmap (NULL, ring->cq_ring_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+		if (MAP_FAILED == ring->cq_ring)
+			goto err_unmap_sq;
+	}
+	ring->sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+	ring->sqes = mmap (NULL, ring->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+	if (MAP_FAILED == ring->sqes)
+		goto err_unmap_cq;
+
+	char* sq = ring->sq_ring;
+	char* cq = ring->cq_ring;
+	ring->sq_head	= (unsigned*)(sq + p.sq_off.head);
+	ring->sq_tail	= (unsigned*)(sq + p.sq_off.tail);
+	ring->sq_mask	= *(unsigned*)(sq + p.sq_off.ring_mask);
+	ring->sq_array	= (unsigned*)(sq + p.sq_off.array);
+	ring->cq_head	= (unsigned*)(cq + p.cq_off.head);
+	ring->cq_tail	= (unsigned*)(cq + p.cq_off.tail);
+	ring->cq_mask	= *(unsigned*)(cq + p.cq_off.ring_mask);
+	ring->cqes	= (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+	return TRUE;
+
+err_unmap_cq:
+	if (ring->cq_ring != ring->sq_ring)
+		munmap (ring->cq_ring, ring->cq_ring_len);
+err_unmap_sq:
+	munmap (ring->sq_ring, ring->sq_ring_len);
+err_close:
+	{
+		const int save_errno = errno;
+		close (ring->fd);
+		errno = save_errno;
+	}
+	return FALSE;
+}
+
+static
+void
+uring_unmap (
+	struct uring_t* const		ring
+	)
+{
+	munmap (ring->sqes, ring->sqes_len);
+	if (ring->cq_ring != ring->sq_ring)
+		munmap (ring->cq_ring, ring->cq_ring_len);
+	munmap (ring->sq_ring, ring->sq_ring_len);
+	close (ring->fd);
+}
+
+/* prepare a receive operation on the buffer of a slot, the submission
+ * queue cannot overflow as operations never exceed the ring depth.
+ */
+
+static
+void
+uring_prep_recvmsg (
+	struct pgm_recv_uring_t* const	rx,
+	const unsigned			slot
+	)
+{
+	struct msghdr* msg	= &rx->msg[slot];
+	rx->iov[slot].iov_base	= rx->skb[slot]->head;
+	rx->iov[slot].iov_len	= rx->max_tpdu;
+	msg->msg_name		= &rx->addr[slot];
+	msg->msg_namelen	= sizeof(struct sockaddr_storage);
+	msg->msg_iov		= (void*)&rx->iov[slot];
+	msg->msg_iovlen		= 1;
+	msg->msg_control	= rx->aux + (slot * PGM_URING_AUX_LEN);
+	msg->msg_controllen	= PGM_URING_AUX_LEN;
+	msg->msg_flags		= 0;
+
+	const unsigned tail = *rx->ring.sq_tail;
+	const unsigned index = tail & rx->ring.sq_mask;
+	struct io_uring_sqe* sqe = &rx->ring.sqes[index];
+	memset (sqe, 0, sizeof(struct io_uring_sqe));
+	sqe->opcode	= IORING_OP_RECVMSG;
+	sqe->fd		= rx->sock[slot];
+	sqe->addr	= (uint64_t)(uintptr_t)msg;
+	sqe->len	= 1;
+	sqe->user_data	= slot;
+	rx->ring.sq_array[index] = index;
+	__atomic_store_n (rx->ring.sq_tail, tail + 1, __ATOMIC_RELEASE);
+	rx->to_submit++;
+}
+
+static
+int
+uring_submit (
+	struct pgm_recv_uring_t* const	rx
+	)
+{
+	if (0 == rx->to_submit)
+		return 0;
+	const int submitted = uring_enter (rx->ring.fd, rx->to_submit, 0, 0);
+	if (submitted > 0)
+		rx->to_submit -= submitted;
+	return submitted;
+}
+
+/* create an io_uring instance with depth receive operations distributed
+ * round-robin across the receive sockets of sock.  operations are submitted
+ * on the first receive call such that completions are processed by the
+ * receiving thread.
+ *
+ * returns new engine, or NULL on failure setting errno.
+ */
+
+PGM_GNUC_INTERNAL
+struct pgm_recv_uring_t*
+pgm_recv_uring_new (
+	pgm_sock_t* const	sock,
+	const unsigned		depth
+	)
+{
+	pgm_assert (NULL != sock);
+	pgm_assert (depth > 0);
+	pgm_assert (depth <= PGM_MAX_URING_DEPTH);
+
+	char* p = pgm_malloc0 (sizeof(struct pgm_recv_uring_t) +
+			       depth * (sizeof(struct sockaddr_storage) +
+				        sizeof(struct msghdr) +
+				        sizeof(SOCKET) +
+				        sizeof(struct pgm_sk_buff_t*) +
+				        sizeof(struct pgm_iovec) +
+				        PGM_URING_AUX_LEN));
+	struct pgm_recv_uring_t* rx = (struct pgm_recv_uring_t*)p;
+	p += sizeof(struct pgm_recv_uring_t);
+	rx->addr	= (struct sockaddr_storage*)p;	p += depth * sizeof(struct sockaddr_storage);
+	rx->msg		= (struct msghdr*)p;		p += depth * sizeof(struct msghdr);
+	rx->sock	= (SOCKET*)p;			p += depth * sizeof(SOCKET);
+	rx->skb		= (struct pgm_sk_buff_t**)p;	p += depth * sizeof(struct pgm_sk_buff_t*);
+	rx->iov		= (struct pgm_iovec*)p;		p += depth * sizeof(struct pgm_iovec);
+	rx->aux		= p;
+	rx->depth	= depth;
+	rx->max_tpdu	= sock->max_tpdu;
+	rx->last_slot	= PGM_URING_NO_SLOT;
+
+	if (!uring_map (&rx->ring, depth)) {
+		pgm_free (rx);
+		return NULL;
+	}
+
+	for (unsigned i = 0; i < depth; i++) {
+		const unsigned j = i % (1 + sock->recv_sock_extra_len);
+		rx->sock[i] = (0 == j) ? sock->recv_sock : sock->recv_sock_extra[j - 1];
+		rx->skb[i]  = pgm_skb_pool_alloc (sock->skb_pool, sock->max_tpdu);
+		uring_prep_recvmsg (rx, i);
+	}
+	return rx;
+}
+
+/* closing the instance cancels operations still in flight before the
+ * buffers are released.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_recv_uring_destroy (
+	struct pgm_recv_uring_t* const	rx
+	)
+{
+	pgm_assert (NULL != rx);
+
+	uring_unmap (&rx->ring);
+	for (unsigned i = 0; i < rx->depth; i++)
+		pgm_free_skb (rx->skb[i]);
+	pgm_free (rx);
+}
+
+/* reap one completed datagram, exchanging the filled buffer with *skb such
+ * that the operation is re-armed with the spare buffer of the caller.  *msg
+ * references the completed message header until the next call.
+ *
+ * on success returns datagram length, on error or with no completion returns
+ * -1 setting errno, PGM_SOCK_EAGAIN when empty.
+ */
+
+PGM_GNUC_INTERNAL
+ssize_t
+pgm_recv_uring_recvmsg (
+	struct pgm_recv_uring_t* const restrict	rx,
+	struct pgm_sk_buff_t* restrict* const	skb,
+	struct msghdr**		 const restrict	msg
+	)
+{
+	pgm_assert (NULL != rx);
+	pgm_assert (NULL != skb);
+	pgm_assert (NULL != *skb);
+	pgm_assert (NULL != msg);
+
+/* re-arm the slot returned by the previous call now its header has been consumed */
+	if (PGM_URING_NO_SLOT != rx->last_slot) {
+		uring_prep_recvmsg (rx, rx->last_slot);
+		rx->last_slot = PGM_URING_NO_SLOT;
+		if (rx->to_submit >= (rx->depth >> PGM_URING_SUBMIT_SHIFT))
+			uring_submit (rx);
+	}
+
+	for (;;)
+	{
+		const unsigned head = *rx->ring.cq_head;
+		if (head == __atomic_load_n (rx->ring.cq_tail, __ATOMIC_ACQUIRE)) {
+/* idle operations must be in flight before the caller waits */
+			if (uring_submit (rx) < 0)
+				return -1;
+			pgm_set_last_sock_error (PGM_SOCK_EAGAIN);
+			return -1;
+		}
+		const struct io_uring_cqe* cqe = &rx->ring.cqes[head & rx->ring.cq_mask];
+		const unsigned slot = (unsigned)cqe->user_data;
+		const int res = cqe->res;
+		__atomic_store_n (rx->ring.cq_head, head + 1, __ATOMIC_RELEASE);
+		pgm_assert (slot < rx->depth);
+
+		if (PGM_UNLIKELY(res < 0)) {
+			uring_prep_recvmsg (rx, slot);
+			if (-EAGAIN == res || -EINTR == res || -ECANCELED == res)
+				continue;
+			pgm_set_last_sock_error (-res);
+			return -1;
+		}
+
+		struct pgm_sk_buff_t* filled = rx->skb[slot];
+		rx->skb[slot] = *skb;
+		*skb = filled;
+		*msg = &rx->msg[slot];
+		rx->last_slot = slot;
+		return res;
+	}
+}
+
+PGM_GNUC_INTERNAL
+bool
+pgm_recv_uring_is_pending (
+	const struct pgm_recv_uring_t* const	rx
+	)
+{
+	pgm_assert (NULL != rx);
+	return *rx->ring.cq_head != __atomic_load_n (rx->ring.cq_tail, __ATOMIC_ACQUIRE);
+}
+
+PGM_GNUC_INTERNAL
+SOCKET
+pgm_recv_uring_get_socket (
+	const struct pgm_recv_uring_t* const	rx
+	)
+{
+	pgm_assert (NULL != rx);
+	return rx->ring.fd;
+}
+
+/* create an io_uring instance for up to depth file writes in flight.
+ *
+ * returns new instance, or NULL on failure setting errno.
+ */
+
+PGM_GNUC_INTERNAL
+struct pgm_write_uring_t*
+pgm_write_uring_new (
+	const unsigned		depth
+	)
+{
+	pgm_assert (depth > 0);
+
+	struct pgm_write_uring_t* wr = pgm_new0 (struct pgm_write_uring_t, 1);
+	if (!uring_map (&wr->ring, depth)) {
+		const int save_errno = errno;
+		pgm_free (wr);
+		errno = save_errno;
+		return NULL;
+	}
+	wr->depth = depth;
+	return wr;
+}
+
+/* writes still in flight are cancelled, the caller waits on them first.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_write_uring_destroy (
+	struct pgm_write_uring_t* const	wr
+	)
+{
+	pgm_assert (NULL != wr);
+
+	uring_unmap (&wr->ring);
+	pgm_free (wr);
+}
+
+/* submit a positioned vectored write, iov must remain valid until its
+ * completion is reaped.
+ *
+ * returns TRUE on success, returns FALSE on failure setting errno.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_write_uring_writev (
+	struct pgm_write_uring_t* const restrict wr,
+	const int				 fd,
+	const struct pgm_iovec*	  const restrict iov,
+	const unsigned				 iovcnt,
+	const uint64_t				 offset,
+	const uint64_t				 user_data
+	)
+{
+	pgm_assert (NULL != wr);
+	pgm_assert (NULL != iov);
+	pgm_assert (wr->in_flight < wr->depth);
+
+	const unsigned tail = *wr->ring.sq_tail;
+	const unsigned index = tail & wr->ring.sq_mask;
+	struct io_uring_sqe* sqe = &wr->ring.sqes[index];
+	memset (sqe, 0, sizeof(struct io_uring_sqe));
+	sqe->opcode	= IORING_OP_WRITEV;
+	sqe->fd		= fd;
+	sqe->addr	= (uint64_t)(uintptr_t)iov;
+	sqe->len	= iovcnt;
+	sqe->off	= offset;
+	sqe->user_data	= user_data;
+	wr->ring.sq_array[index] = index;
+	__atomic_store_n (wr->ring.sq_tail, tail + 1, __ATOMIC_RELEASE);
+	if (uring_enter (wr->ring.fd, 1, 0, 0) < 1) {
+/* withdraw the entry */
+		__atomic_store_n (wr->ring.sq_tail, tail, __ATOMIC_RELEASE);
+		return FALSE;
+	}
+	wr->in_flight++;
+	return TRUE;
+}
+
+/* reap one completed write, with is_wait blocking until one completes.
+ *
+ * returns TRUE with user_data and res, the byte count or negated errno, of the
+ * write, returns FALSE when none has completed or none is in flight.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_write_uring_reap (
+	struct pgm_write_uring_t* const restrict wr,
+	const bool				 is_wait,
+	uint64_t*		  const restrict user_data,
+	int*			  const restrict res
+	)
+{
+	pgm_assert (NULL != wr);
+	pgm_assert (NULL != user_data);
+	pgm_assert (NULL != res);
+
+	for (;;)
+	{
+		const unsigned head = *wr->ring.cq_head;
+		if (head != __atomic_load_n (wr->ring.cq_tail, __ATOMIC_ACQUIRE)) {
+			const struct io_uring_cqe* cqe = &wr->ring.cqes[head & wr->ring.cq_mask];
+			*user_data = cqe->user_data;
+			*res	   = cqe->res;
+			__atomic_store_n (wr->ring.cq_head, head + 1, __ATOMIC_RELEASE);
+			wr->in_flight--;
+			return TRUE;
+		}
+		if (!is_wait || 0 == wr->in_flight)
+			return FALSE;
+		if (uring_enter (wr->ring.fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && EINTR != errno)
+			return FALSE;
+	}
+}
+
+PGM_GNUC_INTERNAL
+unsigned
+pgm_write_uring_in_flight (
+	const struct pgm_write_uring_t* const	wr
+	)
+{
+	pgm_assert (NULL != wr);
+	return wr->in_flight;
+}
+
+#endif /* HAVE_LINUX_IO_URING_H */
+
+/* eof */
@@ -0,0 +1,631 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * RDMA unreliable datagram multicast transport: datagrams of the socket to its
+ * groups are posted to and completed from one UD queue pair of a RoCE or
+ * InfiniBand device, bypassing the kernel network stack.  Unicast datagrams,
+ * NAKs to a source and every sender without RDMA continue through the
+ * regular sockets.
+ *
+ * Copyright (c) 2006-2011 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <impl/framework.h>
+#include <impl/socket.h>
+
+#ifdef HAVE_INFINIBAND_VERBS_H
+#	include <errno.h>
+#	include <fcntl.h>
+#	include <infiniband/verbs.h>
+
+
+//#define VERBS_DEBUG
+
+#ifndef VERBS_DEBUG
+#	define PGM_DISABLE_ASSERT
+#endif
+
+/* global route header preceding every received datagram */
+#define PGM_VERBS_GRH_LEN		40
+
+/* completions dequeued per call */
+#define PGM_VERBS_RESULTS		16
+
+/* send work requests posted per call */
+#define PGM_VERBS_SEND_BATCH		64
+
+/* sends between signalled completions, each completion reclaims as many slots */
+#define PGM_VERBS_MAX_SIGNAL		16
+
+/* destination queue pair of a multicast send */
+#define PGM_VERBS_MCAST_QPN		0xffffff
+
+/* One registered region holds a receive slot and a send slot per work request,
+ * registration pins the pages once such that no operation registers memory.
+ * Receive slots are posted at creation and reposted as each completion is
+ * copied into the skbuff of the caller, as the receive window holds skbuffs
+ * indefinitely.  Datagrams are sent inline where the device permits, otherwise
+ * from the send slot, and only every tx_signal-th send requests a completion.
+ *
+ * Receive completions are polled by the receiving thread without a system call.
+ * Only when the queue is found empty is a notification armed, its completion
+ * channel descriptor is waited upon beside the receive sockets.
+ */
+
+struct pgm_verbs_t {
+	struct ibv_context*		context;
+	struct ibv_pd*			pd;
+	struct ibv_comp_channel*	channel;
+	struct ibv_cq*			rx_cq;
+	struct ibv_cq*			tx_cq;
+	struct ibv_qp*			qp;
+	struct ibv_ah*			ah;			/* send group, NULL for a receiver */
+	struct ibv_mr*			mr;
+	char*				region;
+	size_t				region_len;
+	size_t				slot_len;
+	unsigned			depth;
+	uint32_t			qkey;
+	uint16_t			mlid;
+	uint32_t			max_inline;
+
+/* receive */
+	struct ibv_wc			rx_wc[PGM_VERBS_RESULTS];
+	unsigned			rx_wc_len;
+	unsigned			rx_wc_index;
+	bool				is_armed;
+
+/* send, from the application and timer threads */
+	pgm_spinlock_t			tx_lock;
+	unsigned			tx_head;		/* next send slot */
+	unsigned			tx_outstanding;		/* posted, completion not yet reclaimed */
+	unsigned			tx_signal;
+};
+
+
+/* RoCE v2 addresses an IPv4 group as the IPv4-mapped GID, an IPv6 group is its
+ * own GID.
+ */
+
+static
+void
+verbs_group_to_gid (
+	const struct sockaddr* restrict	group,
+	union ibv_gid*	       restrict	gid
+	)
+{
+	memset (gid, 0, sizeof(union ibv_gid));
+	if (AF_INET6 == group->sa_family) {
+		struct sockaddr_in6 s6;
+		memcpy (&s6, group, sizeof(s6));
+		memcpy (gid->raw, &s6.sin6_addr, sizeof(struct in6_addr));
+	} else {
+		struct sockaddr_in s4;
+		memcpy (&s4, group, sizeof(s4));
+		gid->raw[10] = gid->raw[11] = 0xff;
+		memcpy (&gid->raw[12], &s4.sin_addr, sizeof(struct in_addr));
+	}
+}
+
+static
+void
+verbs_gid_to_sockaddr (
+	const uint8_t*	 restrict	raw,
+	struct sockaddr* restrict	sa
+	)
+{
+	static const uint8_t v4_prefix[12] = { 0,0,0,0, 0,0,0,0, 0,0,0xff,0xff };
+	if (0 == memcmp (raw, v4_prefix, sizeof(v4_prefix))) {
+		struct sockaddr_in s4;
+		memset (&s4, 0, sizeof(s4));
+		s4.sin_family = AF_INET;
+		memcpy (&s4.sin_addr, &raw[12], sizeof(struct in_addr));
+		memcpy (sa, &s4, sizeof(s4));
+	} else {
+		struct sockaddr_in6 s6;
+		memset (&s6, 0, sizeof(s6));
+		s6.sin6_family = AF_INET6;
+		memcpy (&s6.sin6_addr, raw, sizeof(struct in6_addr));
+		memcpy (sa, &s6, sizeof(s6));
+	}
+}
+
+/* source and destination of a received datagram, RoCE v2 over IPv4 places the
+ * IPv4 header in the last 20 bytes of the global route header.
+ */
+
+static
+void
+verbs_grh_addr (
+	const char*	 restrict	grh,
+	struct sockaddr* restrict	src_addr,
+	struct sockaddr* restrict	dst_addr
+	)
+{
+	const uint8_t* ip = (const uint8_t*)grh + PGM_VERBS_GRH_LEN - 20;
+	if (6 != ((const uint8_t*)grh)[0] >> 4 && 0x45 == ip[0]) {
+		struct sockaddr_in s4;
+		memset (&s4, 0, sizeof(s4));
+		s4.sin_family = AF_INET;
+		memcpy (&s4.sin_addr, ip + 12, sizeof(struct in_addr));
+		memcpy (src_addr, &s4, sizeof(s4));
+		memcpy (&s4.sin_addr, ip + 16, sizeof(struct in_addr));
+		memcpy (dst_addr, &s4, sizeof(s4));
+		return;
+	}
+	const struct ibv_grh* g = (const struct ibv_grh*)grh;
+	verbs_gid_to_sockaddr (g->sgid.raw, src_addr);
+	verbs_gid_to_sockaddr (g->dgid.raw, dst_addr);
+}
+
+static
+bool
+verbs_post_recv (
+	struct pgm_verbs_t* const	verbs,
+	const unsigned			slot
+	)
+{
+	struct ibv_sge sge = {
+		.addr	= (uintptr_t)(verbs->region + (size_t)slot * verbs->slot_len),
+		.length	= (uint32_t)verbs->slot_len,
+		.lkey	= verbs->mr->lkey
+	};
+	struct ibv_recv_wr wr = {
+		.wr_id		= slot,
+		.sg_list	= &sge,
+		.num_sge	= 1
+	}, *bad_wr;
+	return (0 == ibv_post_recv (verbs->qp, &wr, &bad_wr));
+}
+
+/* create the queue pair with the socket multicast loop setting, without where
+ * the device cannot block its own multicast.
+ */
+
+static
+struct ibv_qp*
+verbs_create_qp (
+	struct pgm_verbs_t* const	verbs,
+	const bool			use_multicast_loop
+	)
+{
+	struct ibv_qp_init_attr_ex attr;
+	memset (&attr, 0, sizeof(attr));
+	attr.send_cq		= verbs->tx_cq;
+	attr.recv_cq		= verbs->rx_cq;
+	attr.cap.max_send_wr	= verbs->depth;
+	attr.cap.max_recv_wr	= verbs->depth;
+	attr.cap.max_send_sge	= 1;
+	attr.cap.max_recv_sge	= 1;
+	attr.cap.max_inline_data = 256;
+	attr.qp_type		= IBV_QPT_UD;
+	attr.comp_mask		= IBV_QP_INIT_ATTR_PD;
+	attr.pd			= verbs->pd;
+	if (!use_multicast_loop) {
+		attr.comp_mask	   |= IBV_QP_INIT_ATTR_CREATE_FLAGS;
+		attr.create_flags   = IBV_QP_CREATE_BLOCK_SELF_MCAST_LB;
+	}
+	struct ibv_qp* qp = ibv_create_qp_ex (verbs->context, &attr);
+	if (NULL == qp && !use_multicast_loop) {
+		attr.comp_mask	    = IBV_QP_INIT_ATTR_PD;
+		attr.create_flags   = 0;
+		qp = ibv_create_qp_ex (verbs->context, &attr);
+	}
+	if (NULL == qp) {
+		attr.cap.max_inline_data = 0;
+		qp = ibv_create_qp_ex (verbs->context, &attr);
+	}
+	if (NULL != qp)
+		verbs->max_inline = attr.cap.max_inline_data;
+	return qp;
+}
+
+/* open the device, create the queue pair through to ready-to-send, post every
+ * receive slot, attach the joined groups and address the send group.
+ *
+ * returns new transport, or NULL on failure setting errno.
+ */
+
+PGM_GNUC_INTERNAL
+struct pgm_verbs_t*
+pgm_verbs_new (
+	const pgm_sock_t* const			sock,
+	const struct pgm_verbs_req_t* const	req
+	)
+{
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != req);
+	pgm_assert (0 != req->vr_port);
+
+	struct pgm_verbs_t* verbs = pgm_new0 (struct pgm_verbs_t, 1);
+	verbs->depth		= req->vr_depth ? req->vr_depth : PGM_VERBS_DEFAULT_DEPTH;
+	verbs->qkey		= req->vr_qkey ? req->vr_qkey : PGM_VERBS_DEFAULT_QKEY;
+	verbs->mlid		= (uint16_t)req->vr_mlid;
+	verbs->tx_signal	= MAX(1, MIN(PGM_VERBS_MAX_SIGNAL, verbs->depth / 4));
+	verbs->slot_len		= PGM_VERBS_GRH_LEN + sock->max_tpdu;
+	pgm_spinlock_init (&verbs->tx_lock);
+
+	int num_devices = 0;
+	struct ibv_device** list = ibv_get_device_list (&num_devices);
+	if (NULL == list)
+		goto err_destroy;
+	struct ibv_device* device = NULL;
+	for (int i = 0; i < num_devices; i++)
+		if ('\0' == req->vr_device[0] ||
+		    0 == strncmp (ibv_get_device_name (list[i]), req->vr_device, sizeof(req->vr_device)))
+		{
+			device = list[i];
+			break;
+		}
+	if (NULL != device)
+		verbs->context = ibv_open_device (device);
+	ibv_free_device_list (list);
+	if (NULL == verbs->context) {
+		if (NULL == device)
+			errno = ENODEV;
+		goto err_destroy;
+	}
+
+	verbs->pd = ibv_alloc_pd (verbs->context);
+	if (NULL == verbs->pd)
+		goto err_destroy;
+	verbs->channel = ibv_create_comp_channel (verbs->context);
+	if (NULL == verbs->channel)
+		goto err_destroy;
+	const int flags = fcntl (verbs->channel->fd, F_GETFL);
+	if (flags < 0 || fcntl (verbs->channel->fd, F_SETFL, flags | O_NONBLOCK) < 0)
+		goto err_destroy;
+	verbs->rx_cq = ibv_create_cq (verbs->context, (int)verbs->depth, NULL, verbs->channel, 0);
+	verbs->tx_cq = ibv_create_cq (verbs->context, (int)verbs->depth, NULL, NULL, 0);
+	if (NULL == verbs->rx_cq || NULL == verbs->tx_cq)
+		goto err_destroy;
+
+/* receive slots then send slots */
+	verbs->region_len = 2 * (size_t)verbs->depth * verbs->slot_len;
+	verbs->region = pgm_malloc0 (verbs->region_len);
+	verbs->mr = ibv_reg_mr (verbs->pd, verbs->region, verbs->region_len, IBV_ACCESS_LOCAL_WRITE);
+	if (NULL == verbs->mr)
+		goto err_destroy;
+
+	verbs->qp = verbs_create_qp (verbs, sock->use_multicast_loop);
+	if (NULL == verbs->qp)
+		goto err_destroy;
+	struct ibv_qp_attr attr;
+	int retval;
+	memset (&attr, 0, sizeof(attr));
+	attr.qp_state	= IBV_QPS_INIT;
+	attr.pkey_index	= 0;
+	attr.port_num	= (uint8_t)req->vr_port;
+	attr.qkey	= verbs->qkey;
+	retval = ibv_modify_qp (verbs->qp, &attr, IBV_QP_STATE | IBV_QP_PKEY_INDEX | IBV_QP_PORT | IBV_QP_QKEY);
+	if (0 == retval) {
+		memset (&attr, 0, sizeof(attr));
+		attr.qp_state	= IBV_QPS_RTR;
+		retval = ibv_modify_qp (verbs->qp, &attr, IBV_QP_STATE);
+	}
+	if (0 == retval) {
+		memset (&attr, 0, sizeof(attr));
+		attr.qp_state	= IBV_QPS_RTS;
+		attr.sq_psn	= 0;
+		retval = ibv_modify_qp (verbs->qp, &attr, IBV_QP_STATE | IBV_QP_SQ_PSN);
+	}
+	if (0 != retval) {
+		errno = retval;
+		goto err_destroy;
+	}
+
+	for (unsigned i = 0; i < verbs->depth; i++)
+		if (!verbs_post_recv (verbs, i))
+			goto err_destroy;
+	if (0 != ibv_req_notify_cq (verbs->rx_cq, 0))
+		goto err_destroy;
+	verbs->is_armed = TRUE;
+
+	if (sock->can_recv_data)
+		for (unsigned i = 0; i < sock->recv_gsr_len; i++)
+			if (!pgm_verbs_join (verbs, (const struct sockaddr*)&sock->recv_gsr[i].gsr_group))
+				goto err_destroy;
+
+	if (sock->can_send_data)
+	{
+		struct ibv_ah_attr ah_attr;
+		memset (&ah_attr, 0, sizeof(ah_attr));
+		ah_attr.is_global	= 1;
+		verbs_group_to_gid ((const struct sockaddr*)&sock->send_gsr.gsr_group, &ah_attr.grh.dgid);
+		ah_attr.grh.sgid_index	= (uint8_t)req->vr_gid_index;
+		ah_attr.grh.hop_limit	= (uint8_t)sock->hops;
+		ah_attr.dlid		= verbs->mlid;
+		ah_attr.port_num	= (uint8_t)req->vr_port;
+		verbs->ah = ibv_create_ah (verbs->pd, &ah_attr);
+		if (NULL == verbs->ah)
+			goto err_destroy;
+	}
+	return verbs;
+
+err_destroy:
+	{
+		const int save_errno = errno;
+		pgm_verbs_destroy (verbs);
+		errno = save_errno;
+	}
+	return NULL;
+}
+
+/* destroying the queue pair detaches every group before the region is deregistered.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_verbs_destroy (
+	struct pgm_verbs_t* const	verbs
+	)
+{
+	pgm_assert (NULL != verbs);
+
+	if (verbs->ah)
+		ibv_destroy_ah (verbs->ah);
+	if (verbs->qp)
+		ibv_destroy_qp (verbs->qp);
+	if (verbs->mr)
+		ibv_dereg_mr (verbs->mr);
+	if (verbs->region)
+		pgm_free (verbs->region);
+	if (verbs->tx_cq)
+		ibv_destroy_cq (verbs->tx_cq);
+	if (verbs->rx_cq) {
+		if (!verbs->is_armed) {
+			struct ibv_cq* cq;
+			void* cq_context;
+			while (0 == ibv_get_cq_event (verbs->channel, &cq, &cq_context))
+				ibv_ack_cq_events (cq, 1);
+		}
+		ibv_destroy_cq (verbs->rx_cq);
+	}
+	if (verbs->channel)
+		ibv_destroy_comp_channel (verbs->channel);
+	if (verbs->pd)
+		ibv_dealloc_pd (verbs->pd);
+	if (verbs->context)
+		ibv_close_device (verbs->context);
+	pgm_spinlock_free (&verbs->tx_lock);
+	pgm_free (verbs);
+}
+
+/* attach the queue pair to a group, the multicast LID applies to InfiniBand.
+ *
+ * returns TRUE on success, FALSE on failure setting errno.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_verbs_join (
+	struct pgm_verbs_t*    const restrict	verbs,
+	const struct sockaddr* const restrict	group
+	)
+{
+	pgm_assert (NULL != verbs);
+	pgm_assert (NULL != group);
+
+	union ibv_gid gid;
+	verbs_group_to_gid (group, &gid);
+	const int retval = ibv_attach_mcast (verbs->qp, &gid, verbs->mlid);
+	if (0 != retval) {
+		errno = retval;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+PGM_GNUC_INTERNAL
+bool
+pgm_verbs_leave (
+	struct pgm_verbs_t*    const restrict	verbs,
+	const struct sockaddr* const restrict	group
+	)
+{
+	pgm_assert (NULL != verbs);
+	pgm_assert (NULL != group);
+
+	union ibv_gid gid;
+	verbs_group_to_gid (group, &gid);
+	const int retval = ibv_detach_mcast (verbs->qp, &gid, verbs->mlid);
+	if (0 != retval) {
+		errno = retval;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/* reclaim send slots of signalled completions, each covering tx_signal sends.
+ */
+
+static
+void
+verbs_reclaim (
+	struct pgm_verbs_t* const	verbs
+	)
+{
+	struct ibv_wc wc[PGM_VERBS_RESULTS];
+	int n;
+	while ((n = ibv_poll_cq (verbs->tx_cq, PGM_VERBS_RESULTS, wc)) > 0) {
+		const unsigned reclaimed = (unsigned)n * verbs->tx_signal;
+		verbs->tx_outstanding = (reclaimed < verbs->tx_outstanding) ? verbs->tx_outstanding - reclaimed : 0;
+	}
+}
+
+/* post a vector of datagrams to the send group, each inline or copied to a send
+ * slot, as one chain of work requests.
+ *
+ * returns number of datagrams posted, with every slot outstanding returns -1
+ * setting PGM_SOCK_EAGAIN, on error returns -1 setting errno.
+ */
+
+PGM_GNUC_INTERNAL
+ssize_t
+pgm_verbs_sendv (
+	struct pgm_verbs_t*	const restrict	verbs,
+	const struct pgm_iovec*	const restrict	vector,
+	const unsigned				count
+	)
+{
+	pgm_assert (NULL != verbs);
+	pgm_assert (NULL != verbs->ah);
+	pgm_assert (NULL != vector);
+	pgm_assert (count > 0);
+
+	struct ibv_send_wr wr[PGM_VERBS_SEND_BATCH];
+	struct ibv_sge sge[PGM_VERBS_SEND_BATCH];
+
+	pgm_spinlock_lock (&verbs->tx_lock);
+	if (verbs->tx_outstanding + count > verbs->depth)
+		verbs_reclaim (verbs);
+	const unsigned len = MIN(MIN(count, verbs->depth - verbs->tx_outstanding), PGM_VERBS_SEND_BATCH);
+	if (0 == len) {
+		pgm_spinlock_unlock (&verbs->tx_lock);
+		pgm_set_last_sock_error (PGM_SOCK_EAGAIN);
+		return -1;
+	}
+	memset (wr, 0, len * sizeof(struct ibv_send_wr));
+	for (unsigned i = 0; i < len; i++)
+	{
+		const unsigned slot = (verbs->tx_head + i) & (verbs->depth - 1);
+		pgm_assert (vector[i].iov_len <= verbs->slot_len - PGM_VERBS_GRH_LEN);
+		sge[i].length = (uint32_t)vector[i].iov_len;
+		if (vector[i].iov_len <= verbs->max_inline) {
+			sge[i].addr	= (uintptr_t)vector[i].iov_base;
+			sge[i].lkey	= 0;
+			wr[i].send_flags = IBV_SEND_INLINE;
+		} else {
+			char* buf = verbs->region + (size_t)(verbs->depth + slot) * verbs->slot_len;
+			memcpy (buf, vector[i].iov_base, vector[i].iov_len);
+			sge[i].addr	= (uintptr_t)buf;
+			sge[i].lkey	= verbs->mr->lkey;
+		}
+		if ((verbs->tx_signal - 1) == (slot & (verbs->tx_signal - 1)))
+			wr[i].send_flags |= IBV_SEND_SIGNALED;
+		wr[i].wr_id		= slot;
+		wr[i].next		= (i + 1 < len) ? &wr[i + 1] : NULL;
+		wr[i].sg_list		= &sge[i];
+		wr[i].num_sge		= 1;
+		wr[i].opcode		= IBV_WR_SEND;
+		wr[i].wr.ud.ah		= verbs->ah;
+		wr[i].wr.ud.remote_qpn	= PGM_VERBS_MCAST_QPN;
+		wr[i].wr.ud.remote_qkey	= verbs->qkey;
+	}
+	struct ibv_send_wr* bad_wr = NULL;
+	const int retval = ibv_post_send (verbs->qp, wr, &bad_wr);
+	const unsigned posted = (0 == retval) ? len : (unsigned)(bad_wr - wr);
+	verbs->tx_head	      += posted;
+	verbs->tx_outstanding += posted;
+	pgm_spinlock_unlock (&verbs->tx_lock);
+	if (0 == posted) {
+		errno = retval;
+		return -1;
+	}
+	return (ssize_t)posted;
+}
+
+/* copy the next received datagram following its global route header into skb
+ * and repost the slot.  the completion notification is armed once the queue is
+ * found empty, and re-polled to close the race.
+ *
+ * on success returns packet length, with no datagram returns -1 setting
+ * PGM_SOCK_EAGAIN.
+ */
+
+PGM_GNUC_INTERNAL
+ssize_t
+pgm_verbs_recv (
+	struct pgm_verbs_t*	const restrict	verbs,
+	struct pgm_sk_buff_t*	const restrict	skb,
+	struct sockaddr*	const restrict	src_addr,
+	struct sockaddr*	const restrict	dst_addr
+	)
+{
+	pgm_assert (NULL != verbs);
+	pgm_assert (NULL != skb);
+	pgm_assert (NULL != src_addr);
+	pgm_assert (NULL != dst_addr);
+
+	for (;;)
+	{
+		if (verbs->rx_wc_index == verbs->rx_wc_len)
+		{
+			int n = ibv_poll_cq (verbs->rx_cq, PGM_VERBS_RESULTS, verbs->rx_wc);
+			if (n <= 0) {
+				struct ibv_cq* cq;
+				void* cq_context;
+				while (0 == ibv_get_cq_event (verbs->channel, &cq, &cq_context)) {
+					ibv_ack_cq_events (cq, 1);
+					verbs->is_armed = FALSE;
+				}
+				if (!verbs->is_armed && 0 == ibv_req_notify_cq (verbs->rx_cq, 0)) {
+					verbs->is_armed = TRUE;
+					n = ibv_poll_cq (verbs->rx_cq, PGM_VERBS_RESULTS, verbs->rx_wc);
+				}
+			}
+			if (n <= 0) {
+				verbs->rx_wc_len = verbs->rx_wc_index = 0;
+				pgm_set_last_sock_error (PGM_SOCK_EAGAIN);
+				return -1;
+			}
+			verbs->rx_wc_len   = (unsigned)n;
+			verbs->rx_wc_index = 0;
+		}
+
+		const struct ibv_wc* wc = &verbs->rx_wc[ verbs->rx_wc_index++ ];
+		const unsigned slot = (unsigned)wc->wr_id;
+		const char* grh = verbs->region + (size_t)slot * verbs->slot_len;
+		ssize_t copied = -1;
+
+		if (PGM_LIKELY(IBV_WC_SUCCESS == wc->status && wc->byte_len > PGM_VERBS_GRH_LEN)) {
+			const size_t len = MIN((size_t)wc->byte_len - PGM_VERBS_GRH_LEN, (size_t)((char*)skb->end - (char*)skb->head));
+			memcpy (skb->head, grh + PGM_VERBS_GRH_LEN, len);
+			verbs_grh_addr (grh, src_addr, dst_addr);
+			copied = (ssize_t)len;
+		}
+		verbs_post_recv (verbs, slot);
+		if (PGM_LIKELY(copied > 0))
+			return copied;
+	}
+}
+
+PGM_GNUC_INTERNAL
+bool
+pgm_verbs_is_pending (
+	const struct pgm_verbs_t* const	verbs
+	)
+{
+	pgm_assert (NULL != verbs);
+	return verbs->rx_wc_index < verbs->rx_wc_len;
+}
+
+PGM_GNUC_INTERNAL
+SOCKET
+pgm_verbs_get_socket (
+	const struct pgm_verbs_t* const	verbs
+	)
+{
+	pgm_assert (NULL != verbs);
+	return verbs->channel->fd;
+}
+
+#endif /* HAVE_INFINIBAND_VERBS_H */
+
+/* eof */
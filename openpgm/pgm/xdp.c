@@ -0,0 +1,426 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * AF_XDP kernel-bypass receive: an XDP program steers IPv4 PGM/UDP or PGM/IP
+ * datagrams of the socket from one device queue into a UMEM ring, bypassing
+ * the kernel network stack.  Everything else, including fragments, packets
+ * with IP options and IPv6, passes to the kernel and the regular receive
+ * sockets.
+ *
+ * Copyright (c) 2006-2011 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <impl/framework.h>
+#include <impl/socket.h>
+
+#ifdef HAVE_LINUX_IF_XDP_H
+#	include <errno.h>
+#	include <unistd.h>
+#	include <sys/mman.h>
+#	include <sys/socket.h>
+#	include <sys/syscall.h>
+#	include <netinet/in.h>
+#	include <linux/bpf.h>
+#	include <linux/if_link.h>
+#	include <linux/if_xdp.h>
+
+
+//#define XDP_DEBUG
+
+#ifndef XDP_DEBUG
+#	define PGM_DISABLE_ASSERT
+#endif
+
+#ifndef SOL_XDP
+#	define SOL_XDP			283
+#endif
+
+#define PGM_XDP_ETH_HLEN		14
+#define PGM_XDP_ETH_P_IP		0x0800
+#define PGM_XDP_MAX_INSNS		32
+
+struct pgm_xdp_ring_t {
+	unsigned*			producer;
+	unsigned*			consumer;
+	void*				desc;
+	unsigned			mask;
+	void*				map;
+	size_t				map_len;
+};
+
+struct pgm_recv_xdp_t {
+	int				xsk_fd;			/* AF_XDP socket */
+	int				map_fd;			/* XSKMAP, queue to socket */
+	int				prog_fd;
+	int				link_fd;		/* attachment, detaches on close */
+	char*				umem;
+	size_t				umem_len;
+	unsigned			frame_size;
+	bool				is_udp_encap;
+	struct pgm_xdp_ring_t		rx;
+	struct pgm_xdp_ring_t		fill;
+	struct pgm_xdp_ring_t		comp;
+};
+
+
+static
+int
+xdp_bpf (
+	const int			cmd,
+	union bpf_attr*			attr
+	)
+{
+	return (int)syscall (__NR_bpf, cmd, attr, sizeof(union bpf_attr));
+}
+
+/* assemble the steering program: redirect option-less, unfragmented IPv4
+ * datagrams of PGM protocol, or UDP to either encapsulation port, into the
+ * XSKMAP entry of the receiving queue, pass everything else.
+ */
+
+static
+int
+xdp_prog_load (
+	const int			map_fd,
+	const bool			is_udp_encap,
+	const in_port_t			ucast_port,
+	const in_port_t			mcast_port
+	)
+{
+	struct bpf_insn insns[PGM_XDP_MAX_INSNS];
+	unsigned to_pass[8], n_pass = 0, to_redirect = 0, n = 0;
+
+#define INSN(c, d, s, o, i) \
+	(insns[n++] = (struct bpf_insn){ .code = (c), .dst_reg = (d), .src_reg = (s), .off = (o), .imm = (i) })
+#define JMP_PASS(c, d, s, i) \
+	(to_pass[n_pass++] = n, INSN((c), (d), (s), 0, (i)))
+
+	INSN (BPF_LDX | BPF_W | BPF_MEM,   BPF_REG_2, BPF_REG_1, offsetof(struct xdp_md, data), 0);
+	INSN (BPF_LDX | BPF_W | BPF_MEM,   BPF_REG_3, BPF_REG_1, offsetof(struct xdp_md, data_end), 0);
+	INSN (BPF_ALU64 | BPF_MOV | BPF_X, BPF_REG_4, BPF_REG_2, 0, 0);
+	INSN (BPF_ALU64 | BPF_ADD | BPF_K, BPF_REG_4, 0, 0, PGM_XDP_ETH_HLEN + 20 + 8);
+	JMP_PASS (BPF_JMP | BPF_JGT | BPF_X, BPF_REG_4, BPF_REG_3, 0);
+	INSN (BPF_LDX | BPF_H | BPF_MEM,   BPF_REG_5, BPF_REG_2, 12, 0);
+	JMP_PASS (BPF_JMP | BPF_JNE | BPF_K, BPF_REG_5, 0, htons (PGM_XDP_ETH_P_IP));
+	INSN (BPF_LDX | BPF_B | BPF_MEM,   BPF_REG_5, BPF_REG_2, PGM_XDP_ETH_HLEN, 0);
+	JMP_PASS (BPF_JMP | BPF_JNE | BPF_K, BPF_REG_5, 0, 0x45);
+	INSN (BPF_LDX | BPF_H | BPF_MEM,   BPF_REG_5, BPF_REG_2, PGM_XDP_ETH_HLEN + 6, 0);
+	INSN (BPF_ALU64 | BPF_AND | BPF_K, BPF_REG_5, 0, 0, htons (0x3fff));
+	JMP_PASS (BPF_JMP | BPF_JNE | BPF_K, BPF_REG_5, 0, 0);
+	INSN (BPF_LDX | BPF_B | BPF_MEM,   BPF_REG_5, BPF_REG_2, PGM_XDP_ETH_HLEN + 9, 0);
+	if (is_udp_encap) {
+		JMP_PASS (BPF_JMP | BPF_JNE | BPF_K, BPF_REG_5, 0, IPPROTO_UDP);
+		INSN (BPF_LDX | BPF_H | BPF_MEM,   BPF_REG_5, BPF_REG_2, PGM_XDP_ETH_HLEN + 20 + 2, 0);
+		to_redirect = n;
+		INSN (BPF_JMP | BPF_JEQ | BPF_K,   BPF_REG_5, 0, 0, htons (mcast_port));
+		JMP_PASS (BPF_JMP | BPF_JNE | BPF_K, BPF_REG_5, 0, htons (ucast_port));
+	} else {
+		JMP_PASS (BPF_JMP | BPF_JNE | BPF_K, BPF_REG_5, 0, IPPROTO_PGM);
+	}
+/* redirect: bpf_redirect_map (map, rx_queue_index, XDP_PASS) */
+	if (to_redirect)
+		insns[to_redirect].off = (int16_t)(n - to_redirect - 1);
+	INSN (BPF_LDX | BPF_W | BPF_MEM,   BPF_REG_2, BPF_REG_1, offsetof(struct xdp_md, rx_queue_index), 0);
+	INSN (BPF_LD | BPF_DW | BPF_IMM,   BPF_REG_1, BPF_PSEUDO_MAP_FD, 0, map_fd);
+	INSN (0, 0, 0, 0, 0);
+	INSN (BPF_ALU64 | BPF_MOV | BPF_K, BPF_REG_3, 0, 0, XDP_PASS);
+	INSN (BPF_JMP | BPF_CALL,          0, 0, 0, BPF_FUNC_redirect_map);
+	INSN (BPF_JMP | BPF_EXIT,          0, 0, 0, 0);
+/* pass */
+	for (unsigned i = 0; i < n_pass; i++)
+		insns[to_pass[i]].off = (int16_t)(n - to_pass[i] - 1);
+	INSN (BPF_ALU64 | BPF_MOV | BPF_K, BPF_REG_0, 0, 0, XDP_PASS);
+	INSN (BPF_JMP | BPF_EXIT,          0, 0, 0, 0);
+#undef JMP_PASS
+#undef INSN
+	pgm_assert (n <= PGM_XDP_MAX_INSNS);
+
+	static const char license[] = "LGPL";
+	union bpf_attr attr;
+	memset (&attr, 0, sizeof(attr));
+	attr.prog_type	= BPF_PROG_TYPE_XDP;
+	attr.insn_cnt	= n;
+	attr.insns	= (uint64_t)(uintptr_t)insns;
+	attr.license	= (uint64_t)(uintptr_t)license;
+	return xdp_bpf (BPF_PROG_LOAD, &attr);
+}
+
+static
+bool
+xdp_ring_map (
+	const int			fd,
+	struct pgm_xdp_ring_t* const	ring,
+	const struct xdp_ring_offset*	off,
+	const unsigned			entries,
+	const size_t			desc_len,
+	const off_t			pgoff
+	)
+{
+	ring->map_len = off->desc + entries * desc_len;
+	ring->map = mmap (NULL, ring->map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, pgoff);
+	if (MAP_FAILED == ring->map) {
+		ring->map = NULL;
+		return FALSE;
+	}
+	ring->producer	= (unsigned*)((char*)ring->map + off->producer);
+	ring->consumer	= (unsigned*)((char*)ring->map + off->consumer);
+	ring->desc	= (char*)ring->map + off->desc;
+	ring->mask	= entries - 1;
+	return TRUE;
+}
+
+/* return a frame to the kernel, the fill ring holds every frame so cannot overflow.
+ */
+
+static inline
+void
+xdp_fill (
+	struct pgm_recv_xdp_t* const	xdp,
+	const uint64_t			addr
+	)
+{
+	const unsigned prod = *xdp->fill.producer;
+	((uint64_t*)xdp->fill.desc)[prod & xdp->fill.mask] = addr & ~((uint64_t)xdp->frame_size - 1);
+	__atomic_store_n (xdp->fill.producer, prod + 1, __ATOMIC_RELEASE);
+}
+
+/* create the UMEM, AF_XDP socket, XSKMAP and steering program, and attach the
+ * program to the device for the encapsulation ports or protocol of sock.
+ *
+ * returns new receive path, or NULL on failure setting errno.
+ */
+
+PGM_GNUC_INTERNAL
+struct pgm_recv_xdp_t*
+pgm_recv_xdp_new (
+	const pgm_sock_t* const			sock,
+	const struct pgm_xdp_req_t* const	req
+	)
+{
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != req);
+	pgm_assert (0 != req->xr_interface);
+
+	const unsigned frames = req->xr_frames ? req->xr_frames : PGM_XDP_DEFAULT_FRAMES;
+	struct pgm_recv_xdp_t* xdp = pgm_new0 (struct pgm_recv_xdp_t, 1);
+	xdp->xsk_fd = xdp->map_fd = xdp->prog_fd = xdp->link_fd = -1;
+	xdp->is_udp_encap = (0 != sock->udp_encap_ucast_port);
+/* aligned chunks of 2048 or 4096 bytes holding the link header and one TPDU */
+	xdp->frame_size = (sock->max_tpdu + PGM_XDP_ETH_HLEN + XDP_PACKET_HEADROOM <= 2048) ? 2048 : 4096;
+	xdp->umem_len = (size_t)frames * xdp->frame_size;
+	xdp->umem = mmap (NULL, xdp->umem_len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+	if (MAP_FAILED == xdp->umem) {
+		xdp->umem = NULL;
+		goto err_destroy;
+	}
+
+	xdp->xsk_fd = socket (AF_XDP, SOCK_RAW, 0);
+	if (xdp->xsk_fd < 0)
+		goto err_destroy;
+	struct xdp_umem_reg mr;
+	memset (&mr, 0, sizeof(mr));
+	mr.addr		= (uint64_t)(uintptr_t)xdp->umem;
+	mr.len		= xdp->umem_len;
+	mr.chunk_size	= xdp->frame_size;
+	const int entries = (int)frames;
+	if (0 != setsockopt (xdp->xsk_fd, SOL_XDP, XDP_UMEM_REG, &mr, sizeof(mr)) ||
+	    0 != setsockopt (xdp->xsk_fd, SOL_XDP, XDP_UMEM_FILL_RING, &entries, sizeof(entries)) ||
+	    0 != setsockopt (xdp->xsk_fd, SOL_XDP, XDP_UMEM_COMPLETION_RING, &entries, sizeof(entries)) ||
+	    0 != setsockopt (xdp->xsk_fd, SOL_XDP, XDP_RX_RING, &entries, sizeof(entries)))
+		goto err_destroy;
+
+	struct xdp_mmap_offsets off;
+	socklen_t optlen = sizeof(off);
+	if (0 != getsockopt (xdp->xsk_fd, SOL_XDP, XDP_MMAP_OFFSETS, &off, &optlen) ||
+	    !xdp_ring_map (xdp->xsk_fd, &xdp->rx,   &off.rx, frames, sizeof(struct xdp_desc), XDP_PGOFF_RX_RING) ||
+	    !xdp_ring_map (xdp->xsk_fd, &xdp->fill, &off.fr, frames, sizeof(uint64_t), XDP_UMEM_PGOFF_FILL_RING) ||
+	    !xdp_ring_map (xdp->xsk_fd, &xdp->comp, &off.cr, frames, sizeof(uint64_t), XDP_UMEM_PGOFF_COMPLETION_RING))
+		goto err_destroy;
+	for (unsigned i = 0; i < frames; i++)
+		xdp_fill (xdp, (uint64_t)i * xdp->frame_size);
+
+	struct sockaddr_xdp sxdp;
+	memset (&sxdp, 0, sizeof(sxdp));
+	sxdp.sxdp_family	= AF_XDP;
+	sxdp.sxdp_ifindex	= req->xr_interface;
+	sxdp.sxdp_queue_id	= req->xr_queue;
+	sxdp.sxdp_flags		= (req->xr_flags & PGM_XDP_GENERIC) ? XDP_COPY : 0;
+	if (0 != bind (xdp->xsk_fd, (struct sockaddr*)&sxdp, sizeof(sxdp)))
+		goto err_destroy;
+
+	union bpf_attr attr;
+	memset (&attr, 0, sizeof(attr));
+	attr.map_type		= BPF_MAP_TYPE_XSKMAP;
+	attr.key_size		= sizeof(uint32_t);
+	attr.value_size		= sizeof(uint32_t);
+	attr.max_entries	= req->xr_queue + 1;
+	xdp->map_fd = xdp_bpf (BPF_MAP_CREATE, &attr);
+	if (xdp->map_fd < 0)
+		goto err_destroy;
+	const uint32_t key = req->xr_queue, value = (uint32_t)xdp->xsk_fd;
+	memset (&attr, 0, sizeof(attr));
+	attr.map_fd	= xdp->map_fd;
+	attr.key	= (uint64_t)(uintptr_t)&key;
+	attr.value	= (uint64_t)(uintptr_t)&value;
+	if (0 != xdp_bpf (BPF_MAP_UPDATE_ELEM, &attr))
+		goto err_destroy;
+
+	xdp->prog_fd = xdp_prog_load (xdp->map_fd, xdp->is_udp_encap, sock->udp_encap_ucast_port, sock->udp_encap_mcast_port);
+	if (xdp->prog_fd < 0)
+		goto err_destroy;
+	memset (&attr, 0, sizeof(attr));
+	attr.link_create.prog_fd	= xdp->prog_fd;
+	attr.link_create.target_ifindex	= req->xr_interface;
+	attr.link_create.attach_type	= BPF_XDP;
+	attr.link_create.flags		= (req->xr_flags & PGM_XDP_GENERIC) ? XDP_FLAGS_SKB_MODE : 0;
+	xdp->link_fd = xdp_bpf (BPF_LINK_CREATE, &attr);
+	if (xdp->link_fd < 0)
+		goto err_destroy;
+	return xdp;
+
+err_destroy:
+	{
+		const int save_errno = errno;
+		pgm_recv_xdp_destroy (xdp);
+		errno = save_errno;
+	}
+	return NULL;
+}
+
+/* closing the link detaches the program before the rings are unmapped.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_recv_xdp_destroy (
+	struct pgm_recv_xdp_t* const	xdp
+	)
+{
+	pgm_assert (NULL != xdp);
+
+	if (xdp->link_fd >= 0)
+		close (xdp->link_fd);
+	if (xdp->prog_fd >= 0)
+		close (xdp->prog_fd);
+	if (xdp->map_fd >= 0)
+		close (xdp->map_fd);
+	if (xdp->comp.map)
+		munmap (xdp->comp.map, xdp->comp.map_len);
+	if (xdp->fill.map)
+		munmap (xdp->fill.map, xdp->fill.map_len);
+	if (xdp->rx.map)
+		munmap (xdp->rx.map, xdp->rx.map_len);
+	if (xdp->xsk_fd >= 0)
+		close (xdp->xsk_fd);
+	if (xdp->umem)
+		munmap (xdp->umem, xdp->umem_len);
+	pgm_free (xdp);
+}
+
+/* copy the next steered datagram into skb, from the PGM header for UDP
+ * encapsulation or the IP header otherwise as the receive sockets provide,
+ * and return the frame to the kernel.
+ *
+ * on success returns packet length, with no datagram returns -1 setting
+ * PGM_SOCK_EAGAIN.
+ */
+
+PGM_GNUC_INTERNAL
+ssize_t
+pgm_recv_xdp_recv (
+	struct pgm_recv_xdp_t*	const restrict	xdp,
+	struct pgm_sk_buff_t*	const restrict	skb,
+	struct sockaddr*	const restrict	src_addr,
+	struct sockaddr*	const restrict	dst_addr
+	)
+{
+	pgm_assert (NULL != xdp);
+	pgm_assert (NULL != skb);
+	pgm_assert (NULL != src_addr);
+	pgm_assert (NULL != dst_addr);
+
+	for (;;)
+	{
+		const unsigned cons = *xdp->rx.consumer;
+		if (cons == __atomic_load_n (xdp->rx.producer, __ATOMIC_ACQUIRE)) {
+			pgm_set_last_sock_error (PGM_SOCK_EAGAIN);
+			return -1;
+		}
+		const struct xdp_desc* desc = &((const struct xdp_desc*)xdp->rx.desc)[cons & xdp->rx.mask];
+		const uint64_t addr = desc->addr;
+		const char* frame = xdp->umem + addr;
+		size_t len = desc->len;
+		ssize_t copied = -1;
+
+/* the program only steers option-less IPv4 */
+		if (PGM_LIKELY(len >= PGM_XDP_ETH_HLEN + 20)) {
+			const struct pgm_ip* ip = (const struct pgm_ip*)(frame + PGM_XDP_ETH_HLEN);
+			const size_t ip_len = MIN(len - PGM_XDP_ETH_HLEN, (size_t)ntohs (ip->ip_len));
+			const char* data = (const char*)ip;
+			size_t data_len = ip_len;
+			if (xdp->is_udp_encap) {
+				data += 20 + 8;
+				data_len = (ip_len > 20 + 8) ? ip_len - 20 - 8 : 0;
+			}
+			data_len = MIN(data_len, (size_t)((char*)skb->end - (char*)skb->head));
+			memcpy (skb->head, data, data_len);
+			copied = (ssize_t)data_len;
+
+			struct sockaddr_in s4;
+			memset (&s4, 0, sizeof(s4));
+			s4.sin_family		= AF_INET;
+			s4.sin_addr		= ip->ip_src;
+			if (xdp->is_udp_encap)
+				memcpy (&s4.sin_port, (const char*)ip + 20, sizeof(s4.sin_port));
+			memcpy (src_addr, &s4, sizeof(s4));
+			s4.sin_port		= 0;
+			s4.sin_addr		= ip->ip_dst;
+			memcpy (dst_addr, &s4, sizeof(s4));
+		}
+
+		__atomic_store_n (xdp->rx.consumer, cons + 1, __ATOMIC_RELEASE);
+		xdp_fill (xdp, addr);
+		if (PGM_LIKELY(copied > 0))
+			return copied;
+	}
+}
+
+PGM_GNUC_INTERNAL
+bool
+pgm_recv_xdp_is_pending (
+	const struct pgm_recv_xdp_t* const	xdp
+	)
+{
+	pgm_assert (NULL != xdp);
+	return *xdp->rx.consumer != __atomic_load_n (xdp->rx.producer, __ATOMIC_ACQUIRE);
+}
+
+PGM_GNUC_INTERNAL
+SOCKET
+pgm_recv_xdp_get_socket (
+	const struct pgm_recv_xdp_t* const	xdp
+	)
+{
+	pgm_assert (NULL != xdp);
+	return xdp->xsk_fd;
+}
+
+#endif /* HAVE_LINUX_IF_XDP_H */
+
+/* eof */